@@ -219,60 +219,36 @@ capture_interface_list(int *err, char **err_str, void (*update_cb)(void))
     return if_list;
 }
 
-/* XXX - We parse simple text output to get our interface list.  Should
- * we use "real" data serialization instead, e.g. via XML? */
-if_capabilities_t *
-capture_get_if_capabilities(const gchar *ifname, gboolean monitor_mode,
-                            char **err_str, void (*update_cb)(void))
+/*
+ * Capabilities fetched ahead of time by capture_prefetch_if_capabilities(),
+ * keyed by capture_if_capabilities_key().  Each entry is handed out once,
+ * by capture_get_if_capabilities(), so later calls get fresh information.
+ */
+static GHashTable *prefetched_if_capabilities = NULL;
+
+static gchar *
+capture_if_capabilities_key(const gchar *ifname, gboolean monitor_mode)
+{
+    return g_strdup_printf("%c%s", monitor_mode ? 'I' : '-', ifname);
+}
+
+/*
+ * Parse "n_lines" lines of the capabilities dumpcap printed for an
+ * interface.
+ */
+static if_capabilities_t *
+parse_if_capabilities(gchar **raw_list, guint n_lines, char **err_str)
 {
     if_capabilities_t *caps;
     GList              *linktype_list = NULL;
-    int                 err, i;
-    gchar              *data, *primary_msg, *secondary_msg;
-    gchar             **raw_list, **lt_parts;
+    guint               i;
+    gchar             **lt_parts;
     data_link_info_t   *data_link_info;
 
-    g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_MESSAGE, "Capture Interface Capabilities ...");
-
-#ifdef HAVE_EXTCAP
-    /* see if the interface is from extcap */
-    caps = extcap_get_if_dlts(ifname, err_str);
-    if (caps != NULL)
-        return caps;
-
-    /* return if the extcap interface generated an error */
-    if (err_str != NULL && *err_str != NULL)
-        return NULL;
-#endif /* HAVE_EXTCAP */
-
-    /* Try to get our interface list */
-    err = sync_if_capabilities_open(ifname, monitor_mode, &data,
-                                    &primary_msg, &secondary_msg, update_cb);
-    if (err != 0) {
-        g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_MESSAGE, "Capture Interface Capabilities failed, error %d, %s (%s)!",
-              err, primary_msg ? primary_msg : "no message",
-              secondary_msg ? secondary_msg : "no secondary message");
-        if (err_str) {
-            *err_str = primary_msg;
-        } else {
-            g_free(primary_msg);
-        }
-        g_free(secondary_msg);
-        return NULL;
-    }
-
-    /* Split our lines */
-#ifdef _WIN32
-    raw_list = g_strsplit(data, "\r\n", 0);
-#else
-    raw_list = g_strsplit(data, "\n", 0);
-#endif
-    g_free(data);
-
     /*
      * First line is 0 if monitor mode isn't supported, 1 if it is.
      */
-    if (raw_list[0] == NULL || *raw_list[0] == '\0') {
+    if (n_lines == 0 || *raw_list[0] == '\0') {
         g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_MESSAGE, "Capture Interface Capabilities returned no information!");
         if (err_str) {
             *err_str = g_strdup("Dumpcap returned no interface capability information");
@@ -307,7 +283,7 @@ capture_get_if_capabilities(const gchar *ifname, gboolean monitor_mode,
     /*
      * The rest are link-layer types.
      */
-    for (i = 1; raw_list[i] != NULL; i++) {
+    for (i = 1; i < n_lines; i++) {
         /* ...and what if the interface name has a tab in it, Mr. Clever Programmer? */
         lt_parts = g_strsplit(raw_list[i], "\t", 3);
         if (lt_parts[0] == NULL || lt_parts[1] == NULL || lt_parts[2] == NULL) {
@@ -322,10 +298,10 @@ capture_get_if_capabilities(const gchar *ifname, gboolean monitor_mode,
             data_link_info->description = g_strdup(lt_parts[2]);
         else
             data_link_info->description = NULL;
+        g_strfreev(lt_parts);
 
         linktype_list = g_list_append(linktype_list, data_link_info);
     }
-    g_strfreev(raw_list);
 
     /* Check to see if we built a list */
     if (linktype_list == NULL) {
@@ -339,6 +315,193 @@ capture_get_if_capabilities(const gchar *ifname, gboolean monitor_mode,
     return caps;
 }
 
+/* XXX - We parse simple text output to get our interface list.  Should
+ * we use "real" data serialization instead, e.g. via XML? */
+if_capabilities_t *
+capture_get_if_capabilities(const gchar *ifname, gboolean monitor_mode,
+                            char **err_str, void (*update_cb)(void))
+{
+    if_capabilities_t *caps;
+    int                 err;
+    gchar              *data, *primary_msg, *secondary_msg;
+    gchar             **raw_list;
+    gchar              *key;
+    gpointer            orig_key, value;
+
+    g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_MESSAGE, "Capture Interface Capabilities ...");
+
+#ifdef HAVE_EXTCAP
+    /* see if the interface is from extcap */
+    caps = extcap_get_if_dlts(ifname, err_str);
+    if (caps != NULL)
+        return caps;
+
+    /* return if the extcap interface generated an error */
+    if (err_str != NULL && *err_str != NULL)
+        return NULL;
+#endif /* HAVE_EXTCAP */
+
+    /* Did we already get them along with those of other interfaces? */
+    if (prefetched_if_capabilities != NULL) {
+        key = capture_if_capabilities_key(ifname, monitor_mode);
+        if (g_hash_table_lookup_extended(prefetched_if_capabilities, key,
+                                         &orig_key, &value)) {
+            g_hash_table_steal(prefetched_if_capabilities, key);
+            g_free(orig_key);
+            g_free(key);
+            return (if_capabilities_t *)value;
+        }
+        g_free(key);
+    }
+
+    /* Try to get our interface list */
+    err = sync_if_capabilities_open(ifname, monitor_mode, &data,
+                                    &primary_msg, &secondary_msg, update_cb);
+    if (err != 0) {
+        g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_MESSAGE, "Capture Interface Capabilities failed, error %d, %s (%s)!",
+              err, primary_msg ? primary_msg : "no message",
+              secondary_msg ? secondary_msg : "no secondary message");
+        if (err_str) {
+            *err_str = primary_msg;
+        } else {
+            g_free(primary_msg);
+        }
+        g_free(secondary_msg);
+        return NULL;
+    }
+
+    /* Split our lines */
+#ifdef _WIN32
+    raw_list = g_strsplit(data, "\r\n", 0);
+#else
+    raw_list = g_strsplit(data, "\n", 0);
+#endif
+    g_free(data);
+
+    caps = parse_if_capabilities(raw_list, g_strv_length(raw_list), err_str);
+    g_strfreev(raw_list);
+    return caps;
+}
+
+static void
+free_prefetched_if_capabilities(gpointer value)
+{
+    free_if_capabilities((if_capabilities_t *)value);
+}
+
+void
+capture_prefetch_if_capabilities(GList *if_list,
+                                 gboolean (*monitor_mode_cb)(const gchar *ifname),
+                                 void (*update_cb)(void))
+{
+    GPtrArray   *ifnames;
+    GArray      *monitor_modes;
+    GList       *if_entry;
+    if_info_t   *if_info;
+    gboolean     monitor_mode;
+    int          err;
+    gchar       *data, *primary_msg, *secondary_msg;
+    gchar      **raw_list;
+    guint        i, first, block;
+    const gchar *block_ifname;
+    if_capabilities_t *caps;
+
+    /* Throw away whatever wasn't used from last time. */
+    if (prefetched_if_capabilities != NULL) {
+        g_hash_table_destroy(prefetched_if_capabilities);
+        prefetched_if_capabilities = NULL;
+    }
+
+    ifnames = g_ptr_array_new();
+    monitor_modes = g_array_new(FALSE, FALSE, sizeof(gboolean));
+    for (if_entry = if_list; if_entry != NULL; if_entry = g_list_next(if_entry)) {
+        if_info = (if_info_t *)if_entry->data;
+#ifdef HAVE_EXTCAP
+        /* extcap interfaces aren't dumpcap's to describe */
+        if (if_info->extcap != NULL && strlen(if_info->extcap) > 0)
+            continue;
+#endif
+        /* Don't go knocking on remote hosts' doors for every interface */
+        if (strstr(if_info->name, "rpcap:"))
+            continue;
+        monitor_mode = monitor_mode_cb ? monitor_mode_cb(if_info->name) : FALSE;
+        g_ptr_array_add(ifnames, if_info->name);
+        g_array_append_val(monitor_modes, monitor_mode);
+    }
+
+    /* With fewer than two interfaces, there's nothing to be saved. */
+    if (ifnames->len < 2) {
+        g_ptr_array_free(ifnames, TRUE);
+        g_array_free(monitor_modes, TRUE);
+        return;
+    }
+
+    g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_MESSAGE, "Capture Interface Capabilities for %u interfaces ...", ifnames->len);
+
+    err = sync_if_capabilities_list_open(ifnames->len, (const gchar **)ifnames->pdata,
+                                         (const gboolean *)(void *)monitor_modes->data,
+                                         &data, &primary_msg, &secondary_msg,
+                                         update_cb);
+    if (err != 0) {
+        /* Each interface will be asked about separately, and any error reported then. */
+        g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_MESSAGE, "Capture Interface Capabilities failed, error %d, %s (%s)!",
+              err, primary_msg ? primary_msg : "no message",
+              secondary_msg ? secondary_msg : "no secondary message");
+        g_free(primary_msg);
+        g_free(secondary_msg);
+        g_ptr_array_free(ifnames, TRUE);
+        g_array_free(monitor_modes, TRUE);
+        return;
+    }
+
+    /* Split our lines */
+#ifdef _WIN32
+    raw_list = g_strsplit(data, "\r\n", 0);
+#else
+    raw_list = g_strsplit(data, "\n", 0);
+#endif
+    g_free(data);
+
+    prefetched_if_capabilities = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                       g_free,
+                                                       free_prefetched_if_capabilities);
+
+    /*
+     * Each interface's capabilities follow a line with a tab and the
+     * interface's name, in the order we asked for them; interfaces whose
+     * capabilities couldn't be obtained have nothing after that line,
+     * and aren't cached.
+     */
+    block_ifname = NULL;
+    block = 0;
+    first = 0;
+    for (i = 0; ; i++) {
+        if (raw_list[i] == NULL || raw_list[i][0] == '\t') {
+            if (block_ifname != NULL && i > first && *raw_list[first] != '\0') {
+                caps = parse_if_capabilities(&raw_list[first], i - first, NULL);
+                if (caps != NULL) {
+                    g_hash_table_insert(prefetched_if_capabilities,
+                                        capture_if_capabilities_key(block_ifname,
+                                                                    g_array_index(monitor_modes, gboolean, block - 1)),
+                                        caps);
+                }
+            }
+            if (raw_list[i] == NULL || block >= ifnames->len)
+                break;
+            block_ifname = &raw_list[i][1];
+            if (strcmp(block_ifname, (const gchar *)g_ptr_array_index(ifnames, block)) != 0) {
+                /* Not what we asked for; don't trust the rest. */
+                break;
+            }
+            block++;
+            first = i + 1;
+        }
+    }
+    g_strfreev(raw_list);
+    g_ptr_array_free(ifnames, TRUE);
+    g_array_free(monitor_modes, TRUE);
+}
+
 #ifdef HAVE_PCAP_REMOTE
 void add_interface_to_remote_list(if_info_t *if_info)
 {
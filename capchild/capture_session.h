@@ -56,6 +56,7 @@ typedef struct _capture_session {
 #ifndef _WIN32
     uid_t owner;                    /**< owner of the cfile */
     gid_t group;                    /**< group of the cfile */
+    int shm_fd;                     /**< if not -1, capture ring for the child to put packets in */
 #endif
     gboolean session_started;
     capture_options *capture_opts;  /**< options for this capture */
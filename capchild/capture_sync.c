@@ -138,6 +138,7 @@ capture_session_init(capture_session *cap_session, struct _capture_file *cf)
 #ifndef _WIN32
     cap_session->owner                           = getuid();
     cap_session->group                           = getgid();
+    cap_session->shm_fd                          = -1;
 #endif
     cap_session->session_started                 = FALSE;
 }
@@ -378,6 +379,7 @@ sync_pipe_start(capture_options *capture_opts, capture_session *cap_session, voi
     char errmsg[1024+1];
     int sync_pipe[2];                       /* pipe used to send messages from child to parent */
     enum PIPES { PIPE_READ, PIPE_WRITE };   /* Constants 0 and 1 for PIPE_READ and PIPE_WRITE */
+    char sshm_fd[ARGV_NUMBER_LEN];
 #endif
     int sync_pipe_read_fd;
     int argc;
@@ -559,6 +561,15 @@ sync_pipe_start(capture_options *capture_opts, capture_session *cap_session, voi
 #endif
 #endif
 
+#ifndef _WIN32
+    /* the child inherits the capture ring, if there is one */
+    if (cap_session->shm_fd != -1) {
+        argv = sync_pipe_add_arg(argv, &argc, "--sync-shm");
+        g_snprintf(sshm_fd, ARGV_NUMBER_LEN, "%d", cap_session->shm_fd);
+        argv = sync_pipe_add_arg(argv, &argc, sshm_fd);
+    }
+#endif
+
     if (capture_opts->save_file) {
         argv = sync_pipe_add_arg(argv, &argc, "-w");
         argv = sync_pipe_add_arg(argv, &argc, capture_opts->save_file);
@@ -1350,6 +1361,53 @@ sync_if_capabilities_open(const gchar *ifname, gboolean monitor_mode,
     return sync_pipe_run_command(argv, data, primary_msg, secondary_msg, update_cb);
 }
 
+/*
+ * Get the capabilities of "count" interfaces using one dumpcap run,
+ * rather than starting dumpcap once for each.  Each interface's
+ * capabilities, in the format that sync_if_capabilities_open() returns,
+ * are preceded by a line with a tab and the interface name; if they
+ * couldn't be obtained, nothing follows that line.
+ *
+ * Success and failure are reported as for sync_if_capabilities_open().
+ */
+int
+sync_if_capabilities_list_open(guint count, const gchar **ifnames,
+                               const gboolean *monitor_modes,
+                               gchar **data, gchar **primary_msg,
+                               gchar **secondary_msg, void (*update_cb)(void))
+{
+    int argc;
+    char **argv;
+    guint i;
+
+    g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_DEBUG, "sync_if_capabilities_list_open");
+
+    argv = init_pipe_args(&argc);
+
+    if (!argv) {
+        *primary_msg = g_strdup("We don't know where to find dumpcap.");
+        *secondary_msg = NULL;
+        *data = NULL;
+        return -1;
+    }
+
+    /* Ask for the capabilities of each interface; -I applies to the -i before it */
+    for (i = 0; i < count; i++) {
+        argv = sync_pipe_add_arg(argv, &argc, "-i");
+        argv = sync_pipe_add_arg(argv, &argc, ifnames[i]);
+        if (monitor_modes[i])
+            argv = sync_pipe_add_arg(argv, &argc, "-I");
+    }
+    argv = sync_pipe_add_arg(argv, &argc, "-L");
+
+#ifndef DEBUG_CHILD
+    /* Run dumpcap in capture child mode */
+    argv = sync_pipe_add_arg(argv, &argc, "-Z");
+    argv = sync_pipe_add_arg(argv, &argc, SIGNAL_PIPE_CTRL_ID_NONE);
+#endif
+    return sync_pipe_run_command(argv, data, primary_msg, secondary_msg, update_cb);
+}
+
 /*
  * Start getting interface statistics using dumpcap.  On success, read_fd
  * contains the file descriptor for the pipe's stdout, *msg is unchanged,
@@ -1844,6 +1902,10 @@ sync_pipe_input_cb(gint source, gpointer user_data)
     case SP_DROPS:
         capture_input_drops(cap_session, (guint32)strtoul(buffer, NULL, 10));
         break;
+    case SP_STATS:
+        /* only of interest to whoever's debugging the capture */
+        g_log(LOG_DOMAIN_CAPTURE, G_LOG_LEVEL_DEBUG, "sync_pipe_input_cb: statistics %s", buffer);
+        break;
     default:
         g_assert_not_reached();
     }
@@ -73,6 +73,13 @@ sync_if_capabilities_open(const gchar *ifname, gboolean monitor_mode,
                           gchar **data, gchar **primary_msg,
                           gchar **secondary_msg, void (*update_cb)(void));
 
+/** Get the capabilities of several interfaces using a single dumpcap run */
+extern int
+sync_if_capabilities_list_open(guint count, const gchar **ifnames,
+                               const gboolean *monitor_modes,
+                               gchar **data, gchar **primary_msg,
+                               gchar **secondary_msg, void (*update_cb)(void));
+
 /** Start getting interface statistics using dumpcap. */
 extern int
 sync_interface_stats_open(int *read_fd, int *fork_child, gchar **msg, void (*update_cb)(void));
@@ -94,6 +94,8 @@
 #include <wsutil/report_err.h>
 #include <wsutil/str_util.h>
 #include <wsutil/file_util.h>
+#include <wsutil/clopts_common.h>
+#include <wsutil/cmdarg_err.h>
 
 #ifdef HAVE_LIBGCRYPT
 #include <wsutil/wsgcrypt.h>
@@ -271,15 +273,17 @@ GError *parse_err = NULL;
 #define HASH_BUF_SIZE (1024 * 1024)
 
 
-static gchar file_sha1[HASH_STR_SIZE];
-static gchar file_rmd160[HASH_STR_SIZE];
-static gchar file_md5[HASH_STR_SIZE];
-
 #define FILE_HASH_OPT "H"
 #else
 #define FILE_HASH_OPT ""
 #endif /* HAVE_LIBGCRYPT */
 
+/* Number of records to read at a time */
+#define READ_BATCH_SIZE 64
+
+/* Number of files to process at once (-j) */
+static int num_jobs = 1;
+
 /*
  * If we have at least two packets with time stamps, and they're not in
  * order - i.e., the later packet has a time stamp older than the earlier
@@ -324,8 +328,28 @@ typedef struct _capture_info {
   order_t        order;
 
   int           *encap_counts;           /* array of per_packet encap counts; array has one entry per wtap_encap type */
+
+#ifdef HAVE_LIBGCRYPT
+  gchar          file_sha1[HASH_STR_SIZE];
+  gchar          file_rmd160[HASH_STR_SIZE];
+  gchar          file_md5[HASH_STR_SIZE];
+#endif
 } capture_info;
 
+/*
+ * A file to be reported on.  Files can be processed concurrently, by a
+ * pool of threads, but they're reported in the order given; anything
+ * that goes wrong is saved up in "errors" until the file's turn comes.
+ */
+typedef struct {
+  const char    *filename;
+  gboolean       opened;                 /* FALSE if wtap_open_offline() failed */
+  int            status;                 /* from process_cap_file() */
+  GString       *errors;                 /* messages for the standard error */
+  capture_info   cf_info;
+  gboolean       done;
+} capinfos_job_t;
+
 
 static void
 enable_all_infos(void)
@@ -553,9 +577,9 @@ print_stats(const gchar *filename, capture_info *cf_info)
   }
 #ifdef HAVE_LIBGCRYPT
   if (cap_file_hashes) {
-    printf     ("SHA1:                %s\n", file_sha1);
-    printf     ("RIPEMD160:           %s\n", file_rmd160);
-    printf     ("MD5:                 %s\n", file_md5);
+    printf     ("SHA1:                %s\n", cf_info->file_sha1);
+    printf     ("RIPEMD160:           %s\n", cf_info->file_rmd160);
+    printf     ("MD5:                 %s\n", cf_info->file_md5);
   }
 #endif /* HAVE_LIBGCRYPT */
   if (cap_order)          printf     ("Strict time order:   %s\n", order_string(cf_info->order));
@@ -773,17 +797,17 @@ print_stats_table(const gchar *filename, capture_info *cf_info)
   if (cap_file_hashes) {
     putsep();
     putquote();
-    printf("%s", file_sha1);
+    printf("%s", cf_info->file_sha1);
     putquote();
 
     putsep();
     putquote();
-    printf("%s", file_rmd160);
+    printf("%s", cf_info->file_rmd160);
     putquote();
 
     putsep();
     putquote();
-    printf("%s", file_md5);
+    printf("%s", cf_info->file_md5);
     putquote();
   }
 #endif /* HAVE_LIBGCRYPT */
@@ -806,21 +830,27 @@ print_stats_table(const gchar *filename, capture_info *cf_info)
   printf("\n");
 }
 
+/*
+ * Gather the infos for a file into cf_info, which the caller reports and
+ * then frees with free_cap_file_info().  Nothing is printed here, as we
+ * may be one of several threads; error messages are appended to errors.
+ */
 static int
-process_cap_file(wtap *wth, const char *filename)
+process_cap_file(wtap *wth, const char *filename, capture_info *cf_info,
+                 GString *errors)
 {
   int                   status = 0;
   int                   err;
   gchar                *err_info;
   gint64                size;
-  gint64                data_offset;
+  wtap_batch_rec       *recs;
+  guint                 nrecs, i;
 
   guint32               packet = 0;
   gint64                bytes  = 0;
   guint32               snaplen_min_inferred = 0xffffffff;
   guint32               snaplen_max_inferred =          0;
   const struct wtap_pkthdr *phdr;
-  capture_info          cf_info;
   gboolean              have_times = TRUE;
   double                start_time = 0;
   double                stop_time  = 0;
@@ -832,78 +862,92 @@ process_cap_file(wtap *wth, const char *filename)
   gchar                *p;
 
 
-  cf_info.encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
+  cf_info->comment = NULL;
+  cf_info->encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
+
+  /*
+   * None of our infos need the packet data, so, if the file type lets
+   * us, only read the record headers and skip over the data.
+   */
+  wtap_set_batch_headers_only(wth, TRUE);
 
   /* Tally up data that we need to parse through the file to find */
-  while (wtap_read(wth, &err, &err_info, &data_offset))  {
-    phdr = wtap_phdr(wth);
-    if (phdr->presence_flags & WTAP_HAS_TS) {
-      prev_time = cur_time;
-      cur_time = nstime_to_sec(&phdr->ts);
-      if (packet == 0) {
-        start_time = cur_time;
-        stop_time  = cur_time;
-        prev_time  = cur_time;
-      }
-      if (cur_time < prev_time) {
-        order = NOT_IN_ORDER;
-      }
-      if (cur_time < start_time) {
-        start_time = cur_time;
-      }
-      if (cur_time > stop_time) {
-        stop_time = cur_time;
+  recs = g_new(wtap_batch_rec, READ_BATCH_SIZE);
+  wtap_batch_recs_init(recs, READ_BATCH_SIZE);
+  do {
+    nrecs = wtap_read_batch(wth, recs, READ_BATCH_SIZE, &err, &err_info);
+    for (i = 0; i < nrecs; i++) {
+      phdr = &recs[i].phdr;
+      if (phdr->presence_flags & WTAP_HAS_TS) {
+        prev_time = cur_time;
+        cur_time = nstime_to_sec(&phdr->ts);
+        if (packet == 0) {
+          start_time = cur_time;
+          stop_time  = cur_time;
+          prev_time  = cur_time;
+        }
+        if (cur_time < prev_time) {
+          order = NOT_IN_ORDER;
+        }
+        if (cur_time < start_time) {
+          start_time = cur_time;
+        }
+        if (cur_time > stop_time) {
+          stop_time = cur_time;
+        }
+      } else {
+        have_times = FALSE; /* at least one packet has no time stamp */
+        if (order != NOT_IN_ORDER)
+          order = ORDER_UNKNOWN;
       }
-    } else {
-      have_times = FALSE; /* at least one packet has no time stamp */
-      if (order != NOT_IN_ORDER)
-        order = ORDER_UNKNOWN;
-    }
 
-    if (phdr->rec_type == REC_TYPE_PACKET) {
-      bytes+=phdr->len;
-      packet++;
-
-      /* If caplen < len for a rcd, then presumably           */
-      /* 'Limit packet capture length' was done for this rcd. */
-      /* Keep track as to the min/max actual snapshot lengths */
-      /*  seen for this file.                                 */
-      if (phdr->caplen < phdr->len) {
-        if (phdr->caplen < snaplen_min_inferred)
-          snaplen_min_inferred = phdr->caplen;
-        if (phdr->caplen > snaplen_max_inferred)
-          snaplen_max_inferred = phdr->caplen;
-      }
+      if (phdr->rec_type == REC_TYPE_PACKET) {
+        bytes+=phdr->len;
+        packet++;
+
+        /* If caplen < len for a rcd, then presumably           */
+        /* 'Limit packet capture length' was done for this rcd. */
+        /* Keep track as to the min/max actual snapshot lengths */
+        /*  seen for this file.                                 */
+        if (phdr->caplen < phdr->len) {
+          if (phdr->caplen < snaplen_min_inferred)
+            snaplen_min_inferred = phdr->caplen;
+          if (phdr->caplen > snaplen_max_inferred)
+            snaplen_max_inferred = phdr->caplen;
+        }
 
-      /* Per-packet encapsulation */
-      if (wtap_file_encap(wth) == WTAP_ENCAP_PER_PACKET) {
-        if ((phdr->pkt_encap > 0) && (phdr->pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
-          cf_info.encap_counts[phdr->pkt_encap] += 1;
-        } else {
-          fprintf(stderr, "capinfos: Unknown per-packet encapsulation %d in frame %u of file \"%s\"\n",
-                  phdr->pkt_encap, packet, filename);
+        /* Per-packet encapsulation */
+        if (wtap_file_encap(wth) == WTAP_ENCAP_PER_PACKET) {
+          if ((phdr->pkt_encap > 0) && (phdr->pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
+            cf_info->encap_counts[phdr->pkt_encap] += 1;
+          } else {
+            g_string_append_printf(errors, "capinfos: Unknown per-packet encapsulation %d in frame %u of file \"%s\"\n",
+                    phdr->pkt_encap, packet, filename);
+          }
         }
       }
     }
-
-  } /* while */
+  } while (nrecs == READ_BATCH_SIZE); /* a short batch means EOF or an error */
+  wtap_batch_recs_cleanup(recs, READ_BATCH_SIZE);
+  g_free(recs);
 
   if (err != 0) {
-    fprintf(stderr,
+    g_string_append_printf(errors,
         "capinfos: An error occurred after reading %u packets from \"%s\": %s.\n",
         packet, filename, wtap_strerror(err));
     if (err == WTAP_ERR_SHORT_READ) {
         /* Don't give up completely with this one. */
         status = 1;
-        fprintf(stderr,
+        g_string_append_printf(errors,
           "  (will continue anyway, checksums might be incorrect)\n");
     } else {
         if (err_info != NULL) {
-            fprintf(stderr, "(%s)\n", err_info);
+            g_string_append_printf(errors, "(%s)\n", err_info);
             g_free(err_info);
         }
 
-        g_free(cf_info.encap_counts);
+        g_free(cf_info->encap_counts);
+        cf_info->encap_counts = NULL;
         return 1;
     }
   }
@@ -911,69 +955,70 @@ process_cap_file(wtap *wth, const char *filename)
   /* File size */
   size = wtap_file_size(wth, &err);
   if (size == -1) {
-    fprintf(stderr,
+    g_string_append_printf(errors,
         "capinfos: Can't get size of \"%s\": %s.\n",
         filename, g_strerror(err));
-    g_free(cf_info.encap_counts);
+    g_free(cf_info->encap_counts);
+    cf_info->encap_counts = NULL;
     return 1;
   }
 
-  cf_info.filesize = size;
+  cf_info->filesize = size;
 
   /* File Type */
-  cf_info.file_type = wtap_file_type_subtype(wth);
-  cf_info.iscompressed = wtap_iscompressed(wth);
+  cf_info->file_type = wtap_file_type_subtype(wth);
+  cf_info->iscompressed = wtap_iscompressed(wth);
 
   /* File Encapsulation */
-  cf_info.file_encap = wtap_file_encap(wth);
+  cf_info->file_encap = wtap_file_encap(wth);
 
   /* Packet size limit (snaplen) */
-  cf_info.snaplen = wtap_snapshot_length(wth);
-  if (cf_info.snaplen > 0)
-    cf_info.snap_set = TRUE;
+  cf_info->snaplen = wtap_snapshot_length(wth);
+  if (cf_info->snaplen > 0)
+    cf_info->snap_set = TRUE;
   else
-    cf_info.snap_set = FALSE;
+    cf_info->snap_set = FALSE;
 
-  cf_info.snaplen_min_inferred = snaplen_min_inferred;
-  cf_info.snaplen_max_inferred = snaplen_max_inferred;
+  cf_info->snaplen_min_inferred = snaplen_min_inferred;
+  cf_info->snaplen_max_inferred = snaplen_max_inferred;
 
   /* # of packets */
-  cf_info.packet_count = packet;
+  cf_info->packet_count = packet;
 
   /* File Times */
-  cf_info.times_known = have_times;
-  cf_info.start_time = start_time;
-  cf_info.stop_time = stop_time;
-  cf_info.duration = stop_time-start_time;
-  cf_info.know_order = know_order;
-  cf_info.order = order;
+  cf_info->times_known = have_times;
+  cf_info->start_time = start_time;
+  cf_info->stop_time = stop_time;
+  cf_info->duration = stop_time-start_time;
+  cf_info->know_order = know_order;
+  cf_info->order = order;
 
   /* Number of packet bytes */
-  cf_info.packet_bytes = bytes;
+  cf_info->packet_bytes = bytes;
 
-  cf_info.data_rate   = 0.0;
-  cf_info.packet_rate = 0.0;
-  cf_info.packet_size = 0.0;
+  cf_info->data_rate   = 0.0;
+  cf_info->packet_rate = 0.0;
+  cf_info->packet_size = 0.0;
 
   if (packet > 0) {
-    if (cf_info.duration > 0.0) {
-      cf_info.data_rate   = (double)bytes  / (stop_time-start_time); /* Data rate per second */
-      cf_info.packet_rate = (double)packet / (stop_time-start_time); /* packet rate per second */
+    if (cf_info->duration > 0.0) {
+      cf_info->data_rate   = (double)bytes  / (stop_time-start_time); /* Data rate per second */
+      cf_info->packet_rate = (double)packet / (stop_time-start_time); /* packet rate per second */
     }
-    cf_info.packet_size = (double)bytes / packet;                  /* Avg packet size      */
+    cf_info->packet_size = (double)bytes / packet;                  /* Avg packet size      */
   }
 
-  cf_info.comment = NULL;
+  cf_info->comment = NULL;
   shb_inf = wtap_file_get_shb_info(wth);
   if (shb_inf) {
     /* opt_comment is always 0-terminated by pcapng_read_section_header_block */
-    cf_info.comment = g_strdup(shb_inf->opt_comment);
+    cf_info->comment = g_strdup(shb_inf->opt_comment);
   }
   g_free(shb_inf);
-  if (cf_info.comment) {
+  if (cf_info->comment) {
     /* multi-line comments would conflict with the formatting that capinfos uses
        we replace linefeeds with spaces */
-    p = cf_info.comment;
+    p = cf_info->comment;
     while (*p != '\0') {
       if (*p == '\n')
         *p = ' ';
@@ -981,18 +1026,16 @@ process_cap_file(wtap *wth, const char *filename)
     }
   }
 
-  if (long_report) {
-    print_stats(filename, &cf_info);
-  } else {
-    print_stats_table(filename, &cf_info);
-  }
-
-  g_free(cf_info.encap_counts);
-  g_free(cf_info.comment);
-
   return status;
 }
 
+static void
+free_cap_file_info(capture_info *cf_info)
+{
+  g_free(cf_info->encap_counts);
+  g_free(cf_info->comment);
+}
+
 static void
 print_usage(FILE *output)
 {
@@ -1047,6 +1090,7 @@ print_usage(FILE *output)
   fprintf(output, "  -h display this help and exit\n");
   fprintf(output, "  -C cancel processing if file open fails (default is to continue)\n");
   fprintf(output, "  -A generate all infos (default)\n");
+  fprintf(output, "  -j <jobs> process up to <jobs> files at once (default 1)\n");
   fprintf(output, "\n");
   fprintf(output, "Options are processed from left to right order with later options superceding\n");
   fprintf(output, "or adding to earlier options.\n");
@@ -1071,6 +1115,27 @@ failure_message(const char *msg_format _U_, va_list ap _U_)
 }
 #endif
 
+/*
+ * Report an error in command-line arguments.
+ */
+static void
+capinfos_cmdarg_err(const char *fmt, va_list ap)
+{
+  fprintf(stderr, "capinfos: ");
+  vfprintf(stderr, fmt, ap);
+  fprintf(stderr, "\n");
+}
+
+/*
+ * Report additional information for an error in command-line arguments.
+ */
+static void
+capinfos_cmdarg_err_cont(const char *fmt, va_list ap)
+{
+  vfprintf(stderr, fmt, ap);
+  fprintf(stderr, "\n");
+}
+
 #ifdef HAVE_LIBGCRYPT
 static void
 hash_to_str(const unsigned char *hash, size_t length, char *str) {
@@ -1108,36 +1173,104 @@ get_capinfos_runtime_info(GString *str)
 #endif
 }
 
+#ifdef HAVE_LIBGCRYPT
+static void
+hash_file(const char *filename, capture_info *cf_info)
+{
+  FILE  *fh;
+  char  *hash_buf;
+  gcry_md_hd_t hd = NULL;
+  size_t hash_bytes;
+
+  g_strlcpy(cf_info->file_sha1, "<unknown>", HASH_STR_SIZE);
+  g_strlcpy(cf_info->file_rmd160, "<unknown>", HASH_STR_SIZE);
+  g_strlcpy(cf_info->file_md5, "<unknown>", HASH_STR_SIZE);
+
+  /* Each file gets its own handle, so that files can be hashed concurrently */
+  gcry_md_open(&hd, GCRY_MD_SHA1, 0);
+  if (!hd)
+    return;
+  gcry_md_enable(hd, GCRY_MD_RMD160);
+  gcry_md_enable(hd, GCRY_MD_MD5);
+
+  fh = ws_fopen(filename, "rb");
+  if (fh) {
+    hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
+    while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
+      gcry_md_write(hd, hash_buf, hash_bytes);
+    }
+    gcry_md_final(hd);
+    hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, cf_info->file_sha1);
+    hash_to_str(gcry_md_read(hd, GCRY_MD_RMD160), HASH_SIZE_RMD160, cf_info->file_rmd160);
+    hash_to_str(gcry_md_read(hd, GCRY_MD_MD5), HASH_SIZE_MD5, cf_info->file_md5);
+    g_free(hash_buf);
+    fclose(fh);
+  }
+  gcry_md_close(hd);
+}
+#endif /* HAVE_LIBGCRYPT */
+
+/* Open a file and gather its infos; run by the thread pool, if there is one */
+static void
+run_job(gpointer data, gpointer user_data)
+{
+  capinfos_job_t *job = (capinfos_job_t *)data;
+  GAsyncQueue    *done_queue = (GAsyncQueue *)user_data;
+  wtap           *wth;
+  int             err;
+  gchar          *err_info;
+
+  job->errors = g_string_new("");
+  job->status = 0;
+
+#ifdef HAVE_LIBGCRYPT
+  if (cap_file_hashes)
+    hash_file(job->filename, &job->cf_info);
+#endif /* HAVE_LIBGCRYPT */
+
+  wth = wtap_open_offline(job->filename, WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+  job->opened = (wth != NULL);
+  if (!wth) {
+    g_string_append_printf(job->errors, "capinfos: Can't open %s: %s\n",
+        job->filename, wtap_strerror(err));
+    if (err_info != NULL) {
+      g_string_append_printf(job->errors, "(%s)\n", err_info);
+      g_free(err_info);
+    }
+  } else {
+    job->status = process_cap_file(wth, job->filename, &job->cf_info, job->errors);
+    wtap_close(wth);
+  }
+
+  if (done_queue != NULL)
+    g_async_queue_push(done_queue, job);
+}
+
 int
 main(int argc, char *argv[])
 {
   GString *comp_info_str;
   GString *runtime_info_str;
-  wtap  *wth;
-  int    err;
-  gchar *err_info;
   int    opt;
   int    overall_error_status;
+  int    num_files;
+  capinfos_job_t *jobs, *job;
+  GThreadPool    *pool = NULL;
+  GAsyncQueue    *done_queue = NULL;
   static const struct option long_options[] = {
       {(char *)"help", no_argument, NULL, 'h'},
       {(char *)"version", no_argument, NULL, 'v'},
       {0, 0, 0, 0 }
   };
 
-  int status = 0;
 #ifdef HAVE_PLUGINS
   char  *init_progfile_dir_error;
 #endif
-#ifdef HAVE_LIBGCRYPT
-  FILE  *fh;
-  char  *hash_buf = NULL;
-  gcry_md_hd_t hd = NULL;
-  size_t hash_bytes;
-#endif
-
   /* Set the C-language locale to the native environment. */
   setlocale(LC_ALL, "");
 
+  cmdarg_err_init(capinfos_cmdarg_err, capinfos_cmdarg_err_cont);
+
   /* Get the compile-time version information string */
   comp_info_str = get_compiled_version_info(NULL, get_capinfos_compiled_info);
 
@@ -1240,7 +1373,7 @@ main(int argc, char *argv[])
   g_option_context_free(ctx);
 
 #endif /* USE_GOPTION */
-  while ((opt = getopt_long(argc, argv, "tEcs" FILE_HASH_OPT "dluaeyizvhxokCALTMRrSNqQBmb", long_options, NULL)) !=-1) {
+  while ((opt = getopt_long(argc, argv, "tEcs" FILE_HASH_OPT "dluaeyizvhxokCALTMRrSNqQBmbj:", long_options, NULL)) !=-1) {
 
     switch (opt) {
 
@@ -1334,6 +1467,10 @@ main(int argc, char *argv[])
         continue_after_wtap_open_offline_failure = FALSE;
         break;
 
+      case 'j':
+        num_jobs = get_positive_int(optarg, "number of jobs");
+        break;
+
       case 'A':
         enable_all_infos();
         break;
@@ -1415,66 +1552,70 @@ main(int argc, char *argv[])
   }
 
 #ifdef HAVE_LIBGCRYPT
-  if (cap_file_hashes) {
+  if (cap_file_hashes)
     gcry_check_version(NULL);
-    gcry_md_open(&hd, GCRY_MD_SHA1, 0);
-    if (hd) {
-      gcry_md_enable(hd, GCRY_MD_RMD160);
-      gcry_md_enable(hd, GCRY_MD_MD5);
-    }
-    hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
-  }
 #endif
 
   overall_error_status = 0;
 
-  for (opt = optind; opt < argc; opt++) {
+  num_files = argc - optind;
+  jobs = g_new0(capinfos_job_t, num_files);
+  for (opt = 0; opt < num_files; opt++)
+    jobs[opt].filename = argv[optind + opt];
 
-#ifdef HAVE_LIBGCRYPT
-    g_strlcpy(file_sha1, "<unknown>", HASH_STR_SIZE);
-    g_strlcpy(file_rmd160, "<unknown>", HASH_STR_SIZE);
-    g_strlcpy(file_md5, "<unknown>", HASH_STR_SIZE);
-
-    if (cap_file_hashes) {
-      fh = ws_fopen(argv[opt], "rb");
-      if (fh && hd) {
-        while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
-          gcry_md_write(hd, hash_buf, hash_bytes);
-        }
-        gcry_md_final(hd);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, file_sha1);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_RMD160), HASH_SIZE_RMD160, file_rmd160);
-        hash_to_str(gcry_md_read(hd, GCRY_MD_MD5), HASH_SIZE_MD5, file_md5);
+  if (num_jobs > 1 && num_files > 1) {
+#if !GLIB_CHECK_VERSION(2,31,0)
+    g_thread_init(NULL);
+#endif
+    done_queue = g_async_queue_new();
+    pool = g_thread_pool_new(run_job, done_queue, num_jobs, TRUE, NULL);
+    for (opt = 0; opt < num_files; opt++)
+      g_thread_pool_push(pool, &jobs[opt], NULL);
+  }
+
+  for (opt = 0; opt < num_files; opt++) {
+    job = &jobs[opt];
+
+    if (pool != NULL) {
+      /* Wait for this file; note any others that finish meanwhile */
+      while (!job->done) {
+        capinfos_job_t *done_job = (capinfos_job_t *)g_async_queue_pop(done_queue);
+        done_job->done = TRUE;
       }
-      if (fh) fclose(fh);
-      if (hd) gcry_md_reset(hd);
+    } else {
+      run_job(job, NULL);
     }
-#endif /* HAVE_LIBGCRYPT */
 
-    wth = wtap_open_offline(argv[opt], WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+    fputs(job->errors->str, stderr);
+    g_string_free(job->errors, TRUE);
 
-    if (!wth) {
-      fprintf(stderr, "capinfos: Can't open %s: %s\n", argv[opt],
-          wtap_strerror(err));
-      if (err_info != NULL) {
-        fprintf(stderr, "(%s)\n", err_info);
-        g_free(err_info);
-      }
+    if (!job->opened) {
       overall_error_status = 1; /* remember that an error has occurred */
       if (!continue_after_wtap_open_offline_failure)
         exit(1); /* error status */
+      continue;
     }
 
-    if (wth) {
-      if ((opt > optind) && (long_report))
+    if (job->cf_info.encap_counts != NULL) {
+      /* We got the infos, even if something went wrong on the way */
+      if ((opt > 0) && (long_report))
         printf("\n");
-      status = process_cap_file(wth, argv[opt]);
-
-      wtap_close(wth);
-      if (status)
-        exit(status);
+      if (long_report) {
+        print_stats(job->filename, &job->cf_info);
+      } else {
+        print_stats_table(job->filename, &job->cf_info);
+      }
     }
+    free_cap_file_info(&job->cf_info);
+    if (job->status)
+      exit(job->status);
+  }
+
+  if (pool != NULL) {
+    g_thread_pool_free(pool, FALSE, TRUE);
+    g_async_queue_unref(done_queue);
   }
+  g_free(jobs);
 
   return overall_error_status;
 }
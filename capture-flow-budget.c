@@ -0,0 +1,416 @@
+/* capture-flow-budget.c
+ * Keeping only the start of each flow in a capture
+ *
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/pint.h>
+
+#include "capture-flow-budget.h"
+
+/* where the network layer starts, for the link-layer types we handle */
+typedef enum {
+    FB_LINK_ETHERNET,   /* Ethernet, possibly with VLAN tags */
+    FB_LINK_SLL,        /* Linux cooked capture */
+    FB_LINK_NULL,       /* BSD loopback, 4-byte address family */
+    FB_LINK_RAW         /* raw IPv4 or IPv6 */
+} fb_link_t;
+
+/* Both directions of a flow have the same key: the endpoint with the
+   lower address (and port) is always "a". */
+typedef struct {
+    guint8  addr_a[16];
+    guint8  addr_b[16];
+    guint16 port_a;
+    guint16 port_b;
+    guint8  proto;
+    guint8  addr_len;
+} flow_key;
+
+typedef struct {
+    flow_key key;
+    guint32  hash;      /* 0 if the entry is unused */
+    guint32  last_seen;
+    guint32  bytes;
+    guint32  packets;
+} flow_entry;
+
+/* number of flows tracked; a power of 2 */
+#define FLOW_TABLE_SIZE     65536
+/* number of entries looked at for a flow before one is evicted */
+#define FLOW_TABLE_PROBES   8
+
+struct flow_budget {
+    fb_link_t   link;
+    guint       max_bytes;
+    guint       max_packets;
+    flow_entry *table;
+};
+
+#define TH_FIN  0x01
+#define TH_SYN  0x02
+#define TH_RST  0x04
+#define TH_ACK  0x10
+
+#define IP_PROTO_TCP    6
+#define IP_PROTO_UDP    17
+
+/* raw IP, as pcap files and pipes call it */
+#define LINKTYPE_RAW    101
+#define LINKTYPE_IPV4   228
+#define LINKTYPE_IPV6   229
+
+gboolean
+capture_flow_budget_parse(const char *arg, guint *max_bytes,
+                          guint *max_packets)
+{
+    char          *p;
+    unsigned long  bytes, packets = 0;
+
+    if (!g_ascii_isdigit(*arg))
+        return FALSE;
+    bytes = strtoul(arg, &p, 10);
+    if (bytes > G_MAXINT)
+        return FALSE;
+    if (*p == ':') {
+        if (!g_ascii_isdigit(p[1]))
+            return FALSE;
+        packets = strtoul(p + 1, &p, 10);
+        if (packets > G_MAXINT)
+            return FALSE;
+    }
+    if (*p != '\0' || (bytes == 0 && packets == 0))
+        return FALSE;
+    *max_bytes = (guint)bytes;
+    *max_packets = (guint)packets;
+    return TRUE;
+}
+
+flow_budget *
+capture_flow_budget_new(int linktype, guint max_bytes, guint max_packets)
+{
+    flow_budget *fb;
+    fb_link_t    link;
+
+    switch (linktype) {
+
+    case DLT_EN10MB:
+        link = FB_LINK_ETHERNET;
+        break;
+
+#ifdef DLT_LINUX_SLL
+    case DLT_LINUX_SLL:
+        link = FB_LINK_SLL;
+        break;
+#endif
+
+    case DLT_NULL:
+#ifdef DLT_LOOP
+    case DLT_LOOP:
+#endif
+        link = FB_LINK_NULL;
+        break;
+
+    case DLT_RAW:
+    case LINKTYPE_RAW:
+    case LINKTYPE_IPV4:
+    case LINKTYPE_IPV6:
+        link = FB_LINK_RAW;
+        break;
+
+    default:
+        return NULL;
+    }
+
+    fb = g_new(flow_budget, 1);
+    fb->link = link;
+    fb->max_bytes = max_bytes;
+    fb->max_packets = max_packets;
+    fb->table = g_new0(flow_entry, FLOW_TABLE_SIZE);
+    return fb;
+}
+
+void
+capture_flow_budget_free(flow_budget *fb)
+{
+    if (fb == NULL)
+        return;
+    g_free(fb->table);
+    g_free(fb);
+}
+
+/*
+ * Find the offset of the IP header in a packet, or return FALSE if it's
+ * not IPv4 or IPv6.
+ */
+static gboolean
+find_ip_header(fb_link_t link, const u_char *pd, guint caplen, guint *offset)
+{
+    guint  off;
+    guint  ethertype;
+
+    switch (link) {
+
+    case FB_LINK_ETHERNET:
+        off = 12;
+        for (;;) {
+            if (caplen < off + 2)
+                return FALSE;
+            ethertype = pntoh16(&pd[off]);
+            if (ethertype != 0x8100 && ethertype != 0x88a8 && ethertype != 0x9100)
+                break;
+            off += 4;   /* skip the VLAN tag */
+        }
+        off += 2;
+        if (ethertype != 0x0800 && ethertype != 0x86dd)
+            return FALSE;
+        break;
+
+    case FB_LINK_SLL:
+        if (caplen < 16)
+            return FALSE;
+        ethertype = pntoh16(&pd[14]);
+        if (ethertype != 0x0800 && ethertype != 0x86dd)
+            return FALSE;
+        off = 16;
+        break;
+
+    case FB_LINK_NULL:
+        off = 4;
+        break;
+
+    default:
+        off = 0;
+        break;
+    }
+    *offset = off;
+    return TRUE;
+}
+
+/*
+ * Fill in the key for a packet's flow, and the offset of the end of its
+ * TCP or UDP header and its TCP flags.  Returns FALSE if the packet isn't
+ * part of a TCP or UDP flow.
+ */
+static gboolean
+get_flow(const flow_budget *fb, const u_char *pd, guint caplen,
+         flow_key *key, guint *hdr_end, guint8 *tcp_flags)
+{
+    guint         off;
+    guint8        proto;
+    const guint8 *src, *dst;
+    guint         addr_len;
+    guint16       sport, dport;
+    int           order;
+
+    if (!find_ip_header(fb->link, pd, caplen, &off) || caplen < off + 1)
+        return FALSE;
+
+    switch (pd[off] >> 4) {
+
+    case 4:
+        if (caplen < off + 20)
+            return FALSE;
+        /* not the first fragment, so there's no TCP or UDP header */
+        if ((pntoh16(&pd[off + 6]) & 0x1fff) != 0)
+            return FALSE;
+        proto = pd[off + 9];
+        src = &pd[off + 12];
+        dst = &pd[off + 16];
+        addr_len = 4;
+        off += (pd[off] & 0x0f) * 4;
+        break;
+
+    case 6:
+    {
+        int ext;
+
+        if (caplen < off + 40)
+            return FALSE;
+        proto = pd[off + 6];
+        src = &pd[off + 8];
+        dst = &pd[off + 24];
+        addr_len = 16;
+        off += 40;
+        /* skip a few extension headers */
+        for (ext = 0; ext < 8; ext++) {
+            if (proto != 0 && proto != 43 && proto != 44 && proto != 51 &&
+                proto != 60)
+                break;
+            if (caplen < off + 8)
+                return FALSE;
+            if (proto == 44) {
+                /* not the first fragment, so there's no TCP or UDP header */
+                if ((pntoh16(&pd[off + 2]) & 0xfff8) != 0)
+                    return FALSE;
+                proto = pd[off];
+                off += 8;
+            } else if (proto == 51) {
+                proto = pd[off];
+                off += (pd[off + 1] + 2) * 4;
+            } else {
+                proto = pd[off];
+                off += (pd[off + 1] + 1) * 8;
+            }
+        }
+        break;
+    }
+
+    default:
+        return FALSE;
+    }
+
+    if (proto == IP_PROTO_TCP) {
+        if (caplen < off + 20)
+            return FALSE;
+        *tcp_flags = pd[off + 13];
+        *hdr_end = off + (pd[off + 12] >> 4) * 4;
+    } else if (proto == IP_PROTO_UDP) {
+        if (caplen < off + 8)
+            return FALSE;
+        *tcp_flags = 0;
+        *hdr_end = off + 8;
+    } else {
+        return FALSE;
+    }
+    sport = pntoh16(&pd[off]);
+    dport = pntoh16(&pd[off + 2]);
+
+    memset(key, 0, sizeof *key);
+    key->proto = proto;
+    key->addr_len = (guint8)addr_len;
+    order = memcmp(src, dst, addr_len);
+    if (order < 0 || (order == 0 && sport <= dport)) {
+        memcpy(key->addr_a, src, addr_len);
+        memcpy(key->addr_b, dst, addr_len);
+        key->port_a = sport;
+        key->port_b = dport;
+    } else {
+        memcpy(key->addr_a, dst, addr_len);
+        memcpy(key->addr_b, src, addr_len);
+        key->port_a = dport;
+        key->port_b = sport;
+    }
+    return TRUE;
+}
+
+/* FNV-1a; never 0, which marks an unused entry */
+static guint32
+flow_hash(const flow_key *key)
+{
+    const guint8 *p = (const guint8 *)key;
+    guint32       h = 2166136261U;
+    size_t        i;
+
+    for (i = 0; i < sizeof *key; i++) {
+        h ^= p[i];
+        h *= 16777619U;
+    }
+    return h != 0 ? h : 1;
+}
+
+/*
+ * Find the entry for a flow, making one if it isn't in the table; *is_new
+ * is set if it wasn't.
+ */
+static flow_entry *
+lookup_flow(flow_budget *fb, const flow_key *key, guint32 now,
+            gboolean *is_new)
+{
+    guint32     hash = flow_hash(key);
+    flow_entry *entry, *victim = NULL;
+    guint       i;
+
+    for (i = 0; i < FLOW_TABLE_PROBES; i++) {
+        entry = &fb->table[(hash + i) & (FLOW_TABLE_SIZE - 1)];
+        if (entry->hash == 0) {
+            victim = entry;
+            break;
+        }
+        if (entry->hash == hash && memcmp(&entry->key, key, sizeof *key) == 0) {
+            entry->last_seen = now;
+            *is_new = FALSE;
+            return entry;
+        }
+        if (victim == NULL || (gint32)(entry->last_seen - victim->last_seen) < 0)
+            victim = entry;
+    }
+
+    victim->key = *key;
+    victim->hash = hash;
+    victim->last_seen = now;
+    victim->bytes = 0;
+    victim->packets = 0;
+    *is_new = TRUE;
+    return victim;
+}
+
+guint
+capture_flow_budget_length(flow_budget *fb, const u_char *pd,
+                           guint len, guint caplen, time_t secs)
+{
+    flow_key    key;
+    guint       hdr_end;
+    guint8      tcp_flags;
+    flow_entry *entry;
+    gboolean    is_new;
+
+    if (!get_flow(fb, pd, caplen, &key, &hdr_end, &tcp_flags))
+        return caplen;
+
+    entry = lookup_flow(fb, &key, (guint32)secs, &is_new);
+
+    /* a new connection reusing the addresses and ports of an old one */
+    if (!is_new && (tcp_flags & (TH_SYN|TH_ACK)) == TH_SYN) {
+        entry->bytes = 0;
+        entry->packets = 0;
+    }
+
+    if ((fb->max_bytes == 0 || entry->bytes < fb->max_bytes) &&
+        (fb->max_packets == 0 || entry->packets < fb->max_packets)) {
+        entry->bytes = len < G_MAXUINT32 - entry->bytes ? entry->bytes + len : G_MAXUINT32;
+        entry->packets++;
+        return caplen;
+    }
+
+    if (tcp_flags & (TH_SYN|TH_FIN|TH_RST))
+        return MIN(hdr_end, caplen);
+    return 0;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
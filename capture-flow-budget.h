@@ -0,0 +1,88 @@
+/* capture-flow-budget.h
+ * Definitions for keeping only the start of each flow in a capture
+ *
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CAPTURE_FLOW_BUDGET_H__
+#define __CAPTURE_FLOW_BUDGET_H__
+
+#include <time.h>
+
+#include <glib.h>
+#include <pcap.h>
+
+/*
+ * A flow budget keeps only the start of each TCP or UDP flow, a flow
+ * being both directions of traffic between one pair of addresses and
+ * ports.  Once a flow has used up its budget of bytes or of packets, its
+ * packets are dropped, except for TCP segments with SYN, FIN or RST set,
+ * which are kept up to the end of their TCP header so that the end of the
+ * flow is still seen.  Everything other than TCP and UDP over IPv4 and
+ * IPv6, including IP fragments after the first, is kept whole.
+ *
+ * Flows are tracked in a fixed-size hash table; when there's no room for
+ * a new flow, the least recently seen of the flows it would collide with
+ * is forgotten, and gets a new budget if it's seen again.  A TCP SYN
+ * without ACK starts a new flow, with a new budget, as well.
+ */
+typedef struct flow_budget flow_budget;
+
+/*
+ * Parse a budget given as "<bytes>[:<packets>]", 0 meaning no limit.
+ * Returns FALSE if it's not valid, or if it doesn't limit anything.
+ */
+gboolean
+capture_flow_budget_parse(const char *arg, guint *max_bytes,
+                          guint *max_packets);
+
+/*
+ * Create a flow budget for packets of link-layer type linktype.  Returns
+ * NULL if flows can't be found in packets of that type.
+ */
+flow_budget *
+capture_flow_budget_new(int linktype, guint max_bytes, guint max_packets);
+
+/*
+ * Get the number of bytes of a packet to keep, which is at most caplen;
+ * 0 means the packet is to be dropped.  len is the packet's length on
+ * the wire and secs its time stamp.
+ */
+guint
+capture_flow_budget_length(flow_budget *fb, const u_char *pd,
+                           guint len, guint caplen, time_t secs);
+
+void
+capture_flow_budget_free(flow_budget *fb);
+
+#endif /* __CAPTURE_FLOW_BUDGET_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
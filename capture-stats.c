@@ -0,0 +1,78 @@
+/* capture-stats.c
+ * Histograms of dumpcap's capture statistics
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "capture-stats.h"
+
+void
+capture_hist_clear(capture_hist *hist)
+{
+    memset(hist, 0, sizeof *hist);
+}
+
+void
+capture_hist_add(capture_hist *hist, guint64 value)
+{
+    guint bucket = 0;
+
+    while (value >> bucket != 0 && bucket < CAPTURE_HIST_BUCKETS - 1)
+        bucket++;
+    hist->buckets[bucket]++;
+    hist->count++;
+    hist->sum += value;
+    if (value > hist->max)
+        hist->max = value;
+}
+
+void
+capture_hist_format(GString *str, const char *name, const capture_hist *hist)
+{
+    guint used = CAPTURE_HIST_BUCKETS;
+    guint i;
+
+    while (used > 1 && hist->buckets[used - 1] == 0)
+        used--;
+    g_string_append_printf(str, "%s=%" G_GINT64_MODIFIER "u,%" G_GINT64_MODIFIER "u,%" G_GINT64_MODIFIER "u,",
+                           name, hist->count, hist->sum, hist->max);
+    for (i = 0; i < used; i++) {
+        g_string_append_printf(str, i == 0 ? "%" G_GINT64_MODIFIER "u" : "/%" G_GINT64_MODIFIER "u",
+                               hist->buckets[i]);
+    }
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,69 @@
+/* capture-stats.h
+ * Definitions for the histograms of dumpcap's capture statistics
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CAPTURE_STATS_H__
+#define __CAPTURE_STATS_H__
+
+#include <glib.h>
+
+/*
+ * A histogram of non-negative values, such as latencies in microseconds
+ * or the number of packets a read returned, in power-of-2 buckets:
+ * bucket 0 counts values of 0, and bucket i values from 2^(i-1) up to
+ * 2^i - 1, with the last bucket also counting everything bigger.
+ */
+#define CAPTURE_HIST_BUCKETS    32
+
+typedef struct {
+    guint64 count;
+    guint64 sum;
+    guint64 max;
+    guint64 buckets[CAPTURE_HIST_BUCKETS];
+} capture_hist;
+
+void
+capture_hist_clear(capture_hist *hist);
+
+void
+capture_hist_add(capture_hist *hist, guint64 value);
+
+/*
+ * Append "name=count,sum,max,b0/b1/.../bn" to str, leaving out the
+ * empty buckets at the end, so that a program can parse it.
+ */
+void
+capture_hist_format(GString *str, const char *name, const capture_hist *hist);
+
+#endif /* __CAPTURE_STATS_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,272 @@
+/* capture-tee.c
+ * Writing copies of a capture to other files and pipes
+ *
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <signal.h>
+#endif
+
+#include <glib.h>
+
+#include <wsutil/file_util.h>
+
+#include "pcapio.h"
+#include "packet_ring.h"
+#include "capture-tee.h"
+
+#ifndef PCAP_NETMASK_UNKNOWN
+#define PCAP_NETMASK_UNKNOWN    0xffffffff
+#endif
+
+/* bytes of packet data a sink can fall behind by before it loses packets */
+#define TEE_RING_BYTES      (16 * 1024 * 1024)
+/* packets written between checks for the end of the capture */
+#define TEE_BATCH           256
+/* microseconds a writer thread sleeps when it has nothing to write */
+#define TEE_IDLE_SLEEP      1000
+
+struct tee_sink {
+    gchar              *path;
+    int                 snaplen;        /* 0 - that of the capture */
+    gchar              *filter;         /* or NULL */
+    FILE               *fp;
+    struct bpf_program  code;           /* the compiled filter, if any */
+    packet_ring        *ring;
+    GThread            *tid;
+    gint                stop;           /* set when the capture is over */
+    guint               dropped;        /* by capture_tee_put() */
+    int                 err;            /* by the writer thread */
+    guint64             bytes_written;  /* by the writer thread */
+};
+
+tee_sink *
+capture_tee_new(const char *path)
+{
+    tee_sink *sink = g_new0(tee_sink, 1);
+
+    sink->path = g_strdup(path);
+    return sink;
+}
+
+void
+capture_tee_set_snaplen(tee_sink *sink, int snaplen)
+{
+    sink->snaplen = snaplen;
+}
+
+void
+capture_tee_set_filter(tee_sink *sink, const char *filter)
+{
+    g_free(sink->filter);
+    sink->filter = g_strdup(filter);
+}
+
+/* write one packet taken from the ring, if it passes the filter */
+static void
+tee_write_packet(u_char *user, const struct pcap_pkthdr *phdr, const u_char *pd)
+{
+    tee_sink *sink = (tee_sink *) (void *) user;
+
+    if (sink->err != 0)
+        return;
+    if (sink->code.bf_insns != NULL &&
+        bpf_filter(sink->code.bf_insns, pd, phdr->len, phdr->caplen) == 0)
+        return;
+    libpcap_write_packet(sink->fp, phdr->ts.tv_sec, (guint32)phdr->ts.tv_usec,
+                         phdr->caplen, phdr->len, pd,
+                         &sink->bytes_written, &sink->err);
+}
+
+static gpointer
+tee_writer_thread(gpointer data)
+{
+    tee_sink *sink = (tee_sink *)data;
+    gboolean  stopping, unflushed = FALSE;
+#ifndef _WIN32
+    sigset_t  sigs;
+
+    /* If a reader goes away, fail the writes rather than have the
+       SIGPIPE stop the whole capture. */
+    sigemptyset(&sigs);
+    sigaddset(&sigs, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigs, NULL);
+#endif
+
+    for (;;) {
+        /* Look at the flag before the ring, so that packets put into the
+           ring before the flag was set are still written. */
+        stopping = g_atomic_int_get(&sink->stop);
+        if (packet_ring_get(sink->ring, TEE_BATCH, tee_write_packet,
+                            (u_char *)sink) != 0) {
+            unflushed = TRUE;
+            continue;
+        }
+        if (stopping)
+            break;
+        /* Caught up; let a reader on a pipe see what's been written. */
+        if (unflushed) {
+            if (sink->err == 0 && fflush(sink->fp) == EOF)
+                sink->err = errno;
+            unflushed = FALSE;
+        }
+        g_usleep(TEE_IDLE_SLEEP);
+    }
+    return NULL;
+}
+
+gboolean
+capture_tee_start(tee_sink *sink, int linktype, int snaplen,
+                  gboolean ts_nsecs, char *errmsg, size_t errmsg_len)
+{
+    pcap_t *pcap_h;
+    int     err;
+
+    if (sink->snaplen == 0 || sink->snaplen > snaplen)
+        sink->snaplen = snaplen;
+
+    if (sink->filter != NULL) {
+        pcap_h = pcap_open_dead(linktype, sink->snaplen);
+        if (pcap_h == NULL) {
+            g_snprintf(errmsg, (gulong) errmsg_len,
+                       "Can't compile the capture filter for \"%s\" (out of memory).",
+                       sink->path);
+            return FALSE;
+        }
+        /*
+         * Sigh.  Older versions of libpcap don't properly declare the
+         * third argument to pcap_compile() as a const pointer.  Cast
+         * away the warning.
+         */
+        if (pcap_compile(pcap_h, &sink->code, (char *)sink->filter, 1,
+                         PCAP_NETMASK_UNKNOWN) < 0) {
+            g_snprintf(errmsg, (gulong) errmsg_len,
+                       "Invalid capture filter \"%s\" for \"%s\": %s.",
+                       sink->filter, sink->path, pcap_geterr(pcap_h));
+            pcap_close(pcap_h);
+            return FALSE;
+        }
+        pcap_close(pcap_h);
+    }
+
+    sink->fp = ws_fopen(sink->path, "wb");
+    if (sink->fp == NULL) {
+        g_snprintf(errmsg, (gulong) errmsg_len,
+                   "The file to which a copy of the capture would be written "
+                   "(\"%s\") could not be opened: %s.",
+                   sink->path, g_strerror(errno));
+        return FALSE;
+    }
+    if (!libpcap_write_file_header(sink->fp, linktype, sink->snaplen, ts_nsecs,
+                                   &sink->bytes_written, &err)) {
+        g_snprintf(errmsg, (gulong) errmsg_len,
+                   "Error writing to \"%s\": %s.", sink->path, g_strerror(err));
+        fclose(sink->fp);
+        sink->fp = NULL;
+        return FALSE;
+    }
+
+    sink->ring = packet_ring_new(0, TEE_RING_BYTES);
+#if GLIB_CHECK_VERSION(2,31,0)
+    sink->tid = g_thread_new("Tee write", tee_writer_thread, sink);
+#else
+    sink->tid = g_thread_create(tee_writer_thread, sink, TRUE, NULL);
+#endif
+    return TRUE;
+}
+
+void
+capture_tee_put(tee_sink *sink, const struct pcap_pkthdr *phdr,
+                const u_char *pd)
+{
+    struct pcap_pkthdr truncated_hdr;
+
+    if (phdr->caplen > (guint)sink->snaplen) {
+        truncated_hdr = *phdr;
+        truncated_hdr.caplen = sink->snaplen;
+        phdr = &truncated_hdr;
+    }
+    if (!packet_ring_put(sink->ring, phdr, pd))
+        sink->dropped++;
+}
+
+gboolean
+capture_tee_stop(tee_sink *sink, char *errmsg, size_t errmsg_len)
+{
+    if (sink->tid == NULL)
+        return TRUE;
+
+    g_atomic_int_set(&sink->stop, 1);
+    g_thread_join(sink->tid);
+    sink->tid = NULL;
+    packet_ring_free(sink->ring);
+    sink->ring = NULL;
+
+    if (fclose(sink->fp) == EOF && sink->err == 0)
+        sink->err = errno;
+    sink->fp = NULL;
+
+    if (sink->err != 0) {
+        g_snprintf(errmsg, (gulong) errmsg_len,
+                   "Error writing to \"%s\": %s.", sink->path,
+                   g_strerror(sink->err));
+        return FALSE;
+    }
+    if (sink->dropped != 0) {
+        g_snprintf(errmsg, (gulong) errmsg_len,
+                   "%u packets weren't written to \"%s\" because it wasn't keeping up.",
+                   sink->dropped, sink->path);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void
+capture_tee_free(tee_sink *sink)
+{
+    if (sink == NULL)
+        return;
+    if (sink->code.bf_insns != NULL)
+        pcap_freecode(&sink->code);
+    g_free(sink->filter);
+    g_free(sink->path);
+    g_free(sink);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,95 @@
+/* capture-tee.h
+ * Definitions for writing copies of a capture to other files and pipes
+ *
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CAPTURE_TEE_H__
+#define __CAPTURE_TEE_H__
+
+#include <glib.h>
+#include <pcap.h>
+
+/*
+ * A tee sink gets a copy of every packet dumpcap keeps, which it writes
+ * to a file or pipe of its own in pcap format, optionally cut down to a
+ * snapshot length of its own and only if it matches a capture filter of
+ * its own.  Each sink has a writer thread and a packet_ring feeding it,
+ * so a sink that can't keep up loses packets rather than holding up the
+ * capture.
+ */
+typedef struct tee_sink tee_sink;
+
+/*
+ * Make a sink for the file or pipe "path"; it's opened by
+ * capture_tee_start().
+ */
+tee_sink *
+capture_tee_new(const char *path);
+
+/* Set a sink's snapshot length, 0 meaning that of the capture. */
+void
+capture_tee_set_snaplen(tee_sink *sink, int snaplen);
+
+/* Set a sink's capture filter. */
+void
+capture_tee_set_filter(tee_sink *sink, const char *filter);
+
+/*
+ * Open a sink, write its file header for packets of link-layer type
+ * linktype captured with snapshot length snaplen, and start its writer
+ * thread.  Returns FALSE, with a message in errmsg, on failure.
+ */
+gboolean
+capture_tee_start(tee_sink *sink, int linktype, int snaplen,
+                  gboolean ts_nsecs, char *errmsg, size_t errmsg_len);
+
+/*
+ * Hand a packet to a started sink; only ever call this from one thread.
+ */
+void
+capture_tee_put(tee_sink *sink, const struct pcap_pkthdr *phdr,
+                const u_char *pd);
+
+/*
+ * Write out the packets a sink still has, stop its writer thread and
+ * close it.  Returns FALSE, with a message in errmsg, if it lost packets
+ * or failed to write them.
+ */
+gboolean
+capture_tee_stop(tee_sink *sink, char *errmsg, size_t errmsg_len);
+
+void
+capture_tee_free(tee_sink *sink);
+
+#endif /* __CAPTURE_TEE_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
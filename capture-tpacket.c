@@ -0,0 +1,328 @@
+/* capture-tpacket.c
+ * Capturing with Linux TPACKET_V3 memory-mapped rings
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include "capture-tpacket.h"
+
+#ifdef HAVE_TPACKET_V3
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/filter.h>
+
+/*
+ * Blocks are handed over when they're full or when the oldest packet in
+ * them has waited TPACKET_BLOCK_TIMEOUT milliseconds, so that packets
+ * don't sit in a partly filled block when traffic is light.  The frame
+ * size is only used by the kernel to check the ring's geometry; with
+ * TPACKET_V3 packets are packed into the blocks back to back.
+ */
+#define TPACKET_BLOCK_SIZE      (1 << 20)
+#define TPACKET_FRAME_SIZE      2048
+#define TPACKET_MIN_BLOCKS      4
+#define TPACKET_BLOCK_TIMEOUT   60
+
+/* Tag Control Information and TPID put back in front of the EtherType */
+#define VLAN_TAG_LEN            4
+
+struct tpacket_ring {
+    int                 fd;
+    guint8             *map;
+    size_t              map_len;
+    unsigned int        block_nr;
+    unsigned int        cur_block;
+    unsigned int        last_blocks;    /* blocks ready at the last tpacket_ring_dispatch() */
+    int                 snaplen;
+    guint32             received;       /* as of the last tpacket_ring_stats() */
+    guint32             dropped;
+    u_char             *vlan_buf;       /* packet with its VLAN tag put back */
+};
+
+/* A filter that rejects everything, for until the real one is installed */
+static struct sock_filter reject_all[] = {
+    BPF_STMT(BPF_RET | BPF_K, 0)
+};
+
+static void
+tpacket_errmsg(char *errmsg, size_t errmsg_len, const char *what)
+{
+    g_snprintf(errmsg, (gulong) errmsg_len, "%s failed: %s", what,
+               g_strerror(errno));
+}
+
+tpacket_ring *
+tpacket_ring_open(const char *ifname, int snaplen, int buffer_size,
+                  int fanout_group, char *errmsg, size_t errmsg_len)
+{
+    tpacket_ring        *ring;
+    int                  version = TPACKET_V3;
+    struct tpacket_req3  req;
+    struct sockaddr_ll   sll;
+    struct sock_fprog    prog;
+    unsigned int         ifindex;
+    int                  fanout_arg;
+
+    ifindex = if_nametoindex(ifname);
+    if (ifindex == 0) {
+        g_snprintf(errmsg, (gulong) errmsg_len,
+                   "There is no interface named \"%s\".", ifname);
+        return NULL;
+    }
+
+    ring = g_new0(tpacket_ring, 1);
+    ring->snaplen = snaplen;
+    ring->block_nr = (unsigned int)MAX(buffer_size, TPACKET_MIN_BLOCKS) *
+        ((1024 * 1024) / TPACKET_BLOCK_SIZE);
+    ring->vlan_buf = (u_char *)g_malloc(snaplen + VLAN_TAG_LEN);
+
+    ring->fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (ring->fd == -1) {
+        tpacket_errmsg(errmsg, errmsg_len, "socket(AF_PACKET)");
+        goto fail;
+    }
+
+    /* Don't let anything in before the capture filter is installed. */
+    prog.len = G_N_ELEMENTS(reject_all);
+    prog.filter = reject_all;
+    if (setsockopt(ring->fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof prog) == -1) {
+        tpacket_errmsg(errmsg, errmsg_len, "Setting the initial filter");
+        goto fail;
+    }
+
+    if (setsockopt(ring->fd, SOL_PACKET, PACKET_VERSION, &version, sizeof version) == -1) {
+        tpacket_errmsg(errmsg, errmsg_len, "Selecting TPACKET_V3");
+        goto fail;
+    }
+
+    memset(&req, 0, sizeof req);
+    req.tp_block_size = TPACKET_BLOCK_SIZE;
+    req.tp_block_nr = ring->block_nr;
+    req.tp_frame_size = TPACKET_FRAME_SIZE;
+    req.tp_frame_nr = (TPACKET_BLOCK_SIZE / TPACKET_FRAME_SIZE) * ring->block_nr;
+    req.tp_retire_blk_tov = TPACKET_BLOCK_TIMEOUT;
+    if (setsockopt(ring->fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof req) == -1) {
+        tpacket_errmsg(errmsg, errmsg_len, "Setting up the receive ring");
+        goto fail;
+    }
+
+    ring->map_len = (size_t)TPACKET_BLOCK_SIZE * ring->block_nr;
+    ring->map = (guint8 *)mmap(NULL, ring->map_len, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, ring->fd, 0);
+    if (ring->map == MAP_FAILED) {
+        ring->map = NULL;
+        tpacket_errmsg(errmsg, errmsg_len, "Mapping the receive ring");
+        goto fail;
+    }
+
+    memset(&sll, 0, sizeof sll);
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_ALL);
+    sll.sll_ifindex = (int)ifindex;
+    if (bind(ring->fd, (struct sockaddr *)&sll, sizeof sll) == -1) {
+        tpacket_errmsg(errmsg, errmsg_len, "Binding to the interface");
+        goto fail;
+    }
+
+    if (fanout_group != -1) {
+        /* Spread packets over the group by flow, putting fragmented IP
+           datagrams back together first so their fragments stay together. */
+        fanout_arg = (fanout_group & 0xffff) | (PACKET_FANOUT_HASH << 16);
+#ifdef PACKET_FANOUT_FLAG_DEFRAG
+        fanout_arg |= PACKET_FANOUT_FLAG_DEFRAG << 16;
+#endif
+        if (setsockopt(ring->fd, SOL_PACKET, PACKET_FANOUT, &fanout_arg, sizeof fanout_arg) == -1) {
+            tpacket_errmsg(errmsg, errmsg_len, "Joining the fanout group");
+            goto fail;
+        }
+    }
+
+    return ring;
+
+fail:
+    tpacket_ring_close(ring);
+    return NULL;
+}
+
+gboolean
+tpacket_ring_set_filter(tpacket_ring *ring, const struct bpf_program *fcode,
+                        char *errmsg, size_t errmsg_len)
+{
+    struct sock_fprog prog;
+
+    prog.len = (unsigned short)fcode->bf_len;
+    prog.filter = (struct sock_filter *)fcode->bf_insns;
+    if (setsockopt(ring->fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof prog) == -1) {
+        tpacket_errmsg(errmsg, errmsg_len, "Installing the capture filter");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* The kernel takes VLAN tags out of the packets and hands them over
+   separately; put them back where they were. */
+static const u_char *
+tpacket_restore_vlan_tag(tpacket_ring *ring, const struct tpacket3_hdr *hdr,
+                         const u_char *data, struct pcap_pkthdr *phdr)
+{
+    guint16 tpid = ETH_P_8021Q;
+    guint32 caplen = phdr->caplen;
+
+    if (caplen < 2 * ETH_ALEN)
+        return data;
+
+#ifdef TP_STATUS_VLAN_TPID_VALID
+    if (hdr->tp_status & TP_STATUS_VLAN_TPID_VALID)
+        tpid = hdr->hv1.tp_vlan_tpid;
+#endif
+    memcpy(ring->vlan_buf, data, 2 * ETH_ALEN);
+    ring->vlan_buf[2 * ETH_ALEN] = tpid >> 8;
+    ring->vlan_buf[2 * ETH_ALEN + 1] = tpid & 0xff;
+    ring->vlan_buf[2 * ETH_ALEN + 2] = hdr->hv1.tp_vlan_tci >> 8;
+    ring->vlan_buf[2 * ETH_ALEN + 3] = hdr->hv1.tp_vlan_tci & 0xff;
+    memcpy(ring->vlan_buf + 2 * ETH_ALEN + VLAN_TAG_LEN, data + 2 * ETH_ALEN,
+           caplen - 2 * ETH_ALEN);
+
+    phdr->len += VLAN_TAG_LEN;
+    phdr->caplen = MIN(caplen + VLAN_TAG_LEN, (guint32)ring->snaplen);
+    return ring->vlan_buf;
+}
+
+int
+tpacket_ring_dispatch(tpacket_ring *ring, int timeout, pcap_handler cb,
+                      u_char *user, char *errmsg, size_t errmsg_len)
+{
+    struct tpacket_block_desc *bd;
+    struct tpacket3_hdr       *hdr;
+    struct pcap_pkthdr         phdr;
+    const u_char              *data;
+    struct pollfd              pfd;
+    unsigned int               blocks, i;
+    int                        count = 0;
+
+    bd = (struct tpacket_block_desc *)(ring->map + (size_t)ring->cur_block * TPACKET_BLOCK_SIZE);
+    if (!(bd->hdr.bh1.block_status & TP_STATUS_USER)) {
+        pfd.fd = ring->fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, timeout) == -1) {
+            if (errno == EINTR)
+                return 0;
+            tpacket_errmsg(errmsg, errmsg_len, "poll");
+            return -1;
+        }
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            g_snprintf(errmsg, (gulong) errmsg_len, "The interface went down.");
+            return -1;
+        }
+    }
+
+    /* Hand over at most one ring's worth of blocks, so that we get back
+       to our caller now and then even if packets keep coming. */
+    for (blocks = 0; blocks < ring->block_nr &&
+                     (bd->hdr.bh1.block_status & TP_STATUS_USER); blocks++) {
+        hdr = (struct tpacket3_hdr *)((guint8 *)bd + bd->hdr.bh1.offset_to_first_pkt);
+        for (i = 0; i < bd->hdr.bh1.num_pkts; i++) {
+            phdr.ts.tv_sec = hdr->tp_sec;
+            phdr.ts.tv_usec = hdr->tp_nsec;
+            phdr.caplen = MIN(hdr->tp_snaplen, (guint32)ring->snaplen);
+            phdr.len = hdr->tp_len;
+            data = (const u_char *)hdr + hdr->tp_mac;
+#ifdef TP_STATUS_VLAN_VALID
+            if (hdr->hv1.tp_vlan_tci != 0 || (hdr->tp_status & TP_STATUS_VLAN_VALID))
+#else
+            if (hdr->hv1.tp_vlan_tci != 0)
+#endif
+                data = tpacket_restore_vlan_tag(ring, hdr, data, &phdr);
+
+            cb(user, &phdr, data);
+            count++;
+            hdr = (struct tpacket3_hdr *)((guint8 *)hdr + hdr->tp_next_offset);
+        }
+
+        /* Make sure we're done with the block before the kernel gets it
+           back. */
+        __sync_synchronize();
+        bd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+
+        ring->cur_block = (ring->cur_block + 1) % ring->block_nr;
+        bd = (struct tpacket_block_desc *)(ring->map + (size_t)ring->cur_block * TPACKET_BLOCK_SIZE);
+    }
+    ring->last_blocks = blocks;
+    return count;
+}
+
+void
+tpacket_ring_fill(tpacket_ring *ring, guint *ready, guint *total)
+{
+    *ready = ring->last_blocks;
+    *total = ring->block_nr;
+}
+
+gboolean
+tpacket_ring_stats(tpacket_ring *ring, guint32 *received, guint32 *dropped)
+{
+    struct tpacket_stats_v3 st;
+    socklen_t               len = sizeof st;
+
+    /* The kernel resets its counters every time they're read. */
+    if (getsockopt(ring->fd, SOL_PACKET, PACKET_STATISTICS, &st, &len) == -1)
+        return FALSE;
+    ring->received += st.tp_packets;
+    ring->dropped += st.tp_drops;
+    *received = ring->received;
+    *dropped = ring->dropped;
+    return TRUE;
+}
+
+void
+tpacket_ring_close(tpacket_ring *ring)
+{
+    if (ring->map != NULL)
+        munmap(ring->map, ring->map_len);
+    if (ring->fd != -1)
+        close(ring->fd);
+    g_free(ring->vlan_buf);
+    g_free(ring);
+}
+
+#endif /* HAVE_TPACKET_V3 */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
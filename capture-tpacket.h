@@ -0,0 +1,114 @@
+/* capture-tpacket.h
+ * Definitions for capturing with Linux TPACKET_V3 memory-mapped rings
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CAPTURE_TPACKET_H__
+#define __CAPTURE_TPACKET_H__
+
+#ifdef __linux__
+#include <linux/if_packet.h>
+#ifdef TPACKET3_HDRLEN
+#define HAVE_TPACKET_V3
+#endif
+#endif
+
+#ifdef HAVE_TPACKET_V3
+
+#include <glib.h>
+#include <pcap.h>
+
+/*
+ * A TPACKET_V3 ring is an AF_PACKET socket whose receive buffer is a
+ * ring of large blocks mapped into our address space.  The kernel fills
+ * a block with as many packets as fit, or as arrive before a timeout,
+ * and then hands the whole block over; the packets are passed to the
+ * callback straight out of the block, without being copied.
+ *
+ * Rings on the same interface can be put in a fanout group, in which
+ * case the kernel spreads the interface's packets over them by flow, so
+ * that several capturing processes can share the load of one interface.
+ */
+typedef struct tpacket_ring tpacket_ring;
+
+/*
+ * Open a ring on interface "ifname" for Ethernet frames, with about
+ * buffer_size MiB of blocks, keeping at most snaplen bytes of each
+ * packet.  If fanout_group isn't -1, join that fanout group.  Returns
+ * NULL, with a message in errmsg, on failure.
+ */
+tpacket_ring *
+tpacket_ring_open(const char *ifname, int snaplen, int buffer_size,
+                  int fanout_group, char *errmsg, size_t errmsg_len);
+
+/*
+ * Install a compiled capture filter on the ring.  Returns FALSE, with a
+ * message in errmsg, on failure.
+ */
+gboolean
+tpacket_ring_set_filter(tpacket_ring *ring, const struct bpf_program *fcode,
+                        char *errmsg, size_t errmsg_len);
+
+/*
+ * Wait up to timeout milliseconds for a block of packets and pass each
+ * packet of each block that's ready to cb, in the same way pcap_dispatch()
+ * does except that the time stamp's tv_usec is in nanoseconds.  Returns
+ * the number of packets passed to cb, or -1, with a message in errmsg,
+ * on error.
+ */
+int
+tpacket_ring_dispatch(tpacket_ring *ring, int timeout, pcap_handler cb,
+                      u_char *user, char *errmsg, size_t errmsg_len);
+
+/*
+ * Get the number of packets the kernel has received on the ring and the
+ * number it had to drop because the ring was full, since it was opened.
+ */
+gboolean
+tpacket_ring_stats(tpacket_ring *ring, guint32 *received, guint32 *dropped);
+
+/*
+ * Get the number of blocks that were ready for us when the last
+ * tpacket_ring_dispatch() was called, and the number of blocks in the
+ * ring; the closer the first gets to the second, the closer the kernel
+ * came to having to drop packets.
+ */
+void
+tpacket_ring_fill(tpacket_ring *ring, guint *ready, guint *total);
+
+void
+tpacket_ring_close(tpacket_ring *ring);
+
+#endif /* HAVE_TPACKET_V3 */
+
+#endif /* __CAPTURE_TPACKET_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,217 @@
+/* capture-truncate.c
+ * Rule-based truncation of captured packets
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "capture-truncate.h"
+
+#ifndef PCAP_NETMASK_UNKNOWN
+#define PCAP_NETMASK_UNKNOWN    0xffffffff
+#endif
+
+gboolean
+capture_truncate_parse_rule(const char *arg, truncate_rule *rule)
+{
+    char          *p;
+    unsigned long  length;
+
+    if (!g_ascii_isdigit(*arg))
+        return FALSE;
+    length = strtoul(arg, &p, 10);
+    if (length > G_MAXINT)
+        return FALSE;
+    if (*p == ':')
+        p++;
+    else if (*p != '\0')
+        return FALSE;
+    rule->length = (guint)length;
+    rule->filter = g_strdup(p);
+    return TRUE;
+}
+
+/*
+ * Append the compiled filter "code" to "insns" as one block of the
+ * combined program: each return that accepts the packet is made to
+ * return "keep" or, if keep is 0, to go on to whatever follows the
+ * block, and each return that rejects it is made to go on to what
+ * follows, if reject_next is TRUE.  Returns FALSE if the filter returns
+ * anything other than a constant.
+ */
+static gboolean
+append_block(GArray *insns, const struct bpf_program *code, guint keep,
+             gboolean reject_next)
+{
+    guint           i;
+    struct bpf_insn insn;
+
+    for (i = 0; i < code->bf_len; i++) {
+        insn = code->bf_insns[i];
+        if (BPF_CLASS(insn.code) == BPF_RET) {
+            if (BPF_RVAL(insn.code) != BPF_K)
+                return FALSE;
+            if ((insn.k != 0 && keep == 0) || (insn.k == 0 && reject_next)) {
+                /* jump past the end of the block */
+                insn.code = BPF_JMP | BPF_JA;
+                insn.jt = insn.jf = 0;
+                insn.k = code->bf_len - i - 1;
+            } else if (insn.k != 0) {
+                insn.k = keep;
+            }
+        }
+        g_array_append_val(insns, insn);
+    }
+    return TRUE;
+}
+
+static void
+set_program(struct bpf_program *prog, GArray *insns)
+{
+    prog->bf_len = insns->len;
+    prog->bf_insns = (struct bpf_insn *)(void *)g_array_free(insns, FALSE);
+}
+
+gboolean
+capture_truncate_compile(const GArray *rules, int linktype, int snaplen,
+                         struct bpf_program *prog,
+                         char *errmsg, size_t errmsg_len)
+{
+    pcap_t             *pcap_h;
+    GArray             *insns;
+    guint               i;
+    truncate_rule      *rule;
+    struct bpf_program  code;
+    struct bpf_insn     ret = BPF_STMT(BPF_RET | BPF_K, 0);
+    guint               keep;
+    gboolean            ok;
+
+    pcap_h = pcap_open_dead(linktype, snaplen);
+    if (pcap_h == NULL) {
+        g_snprintf(errmsg, (gulong) errmsg_len,
+                   "Can't compile truncation rules (out of memory).");
+        return FALSE;
+    }
+
+    insns = g_array_new(FALSE, FALSE, sizeof (struct bpf_insn));
+    ret.k = (guint)snaplen;
+    for (i = 0; i < rules->len; i++) {
+        rule = &g_array_index(rules, truncate_rule, i);
+        keep = (rule->length == 0 || rule->length > (guint)snaplen) ?
+               (guint)snaplen : rule->length;
+        if (rule->filter[0] == '\0') {
+            /* matches everything; any later rules would never be used */
+            ret.k = keep;
+            break;
+        }
+        /*
+         * Sigh.  Older versions of libpcap don't properly declare the
+         * third argument to pcap_compile() as a const pointer.  Cast
+         * away the warning.
+         */
+        if (pcap_compile(pcap_h, &code, (char *)rule->filter, 1,
+                         PCAP_NETMASK_UNKNOWN) < 0) {
+            g_snprintf(errmsg, (gulong) errmsg_len,
+                       "Invalid filter in truncation rule \"%u:%s\": %s.",
+                       rule->length, rule->filter, pcap_geterr(pcap_h));
+            g_array_free(insns, TRUE);
+            pcap_close(pcap_h);
+            return FALSE;
+        }
+        ok = append_block(insns, &code, keep, TRUE);
+#ifdef HAVE_PCAP_FREECODE
+        pcap_freecode(&code);
+#endif
+        if (!ok) {
+            g_snprintf(errmsg, (gulong) errmsg_len,
+                       "The filter in truncation rule \"%u:%s\" can't be used.",
+                       rule->length, rule->filter);
+            g_array_free(insns, TRUE);
+            pcap_close(pcap_h);
+            return FALSE;
+        }
+    }
+    g_array_append_val(insns, ret);
+    pcap_close(pcap_h);
+
+    set_program(prog, insns);
+    return TRUE;
+}
+
+gboolean
+capture_truncate_chain(const struct bpf_program *filter,
+                       const struct bpf_program *truncate,
+                       struct bpf_program *prog)
+{
+    GArray *insns;
+
+    insns = g_array_sized_new(FALSE, FALSE, sizeof (struct bpf_insn),
+                              filter->bf_len + truncate->bf_len);
+    /* packets the filter accepts go on to the rules */
+    if (!append_block(insns, filter, 0, FALSE)) {
+        g_array_free(insns, TRUE);
+        return FALSE;
+    }
+    g_array_append_vals(insns, truncate->bf_insns, truncate->bf_len);
+
+    set_program(prog, insns);
+    return TRUE;
+}
+
+guint
+capture_truncate_length(const struct bpf_program *truncate, const u_char *pd,
+                        guint len, guint caplen)
+{
+    guint keep;
+
+    /*
+     * The program only returns 0 if a rule's filter looked past the end
+     * of the captured data, e.g. because the packet was already truncated
+     * by the kernel; leave it alone then.
+     */
+    keep = bpf_filter(truncate->bf_insns, pd, len, caplen);
+    return (keep == 0 || keep > caplen) ? caplen : keep;
+}
+
+void
+capture_truncate_free(struct bpf_program *prog)
+{
+    g_free(prog->bf_insns);
+    prog->bf_insns = NULL;
+    prog->bf_len = 0;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
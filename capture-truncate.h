@@ -0,0 +1,100 @@
+/* capture-truncate.h
+ * Definitions for rule-based truncation of captured packets
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CAPTURE_TRUNCATE_H__
+#define __CAPTURE_TRUNCATE_H__
+
+#include <glib.h>
+#include <pcap.h>
+
+/*
+ * Truncation rules say how much of each packet to keep: the first rule
+ * whose capture filter matches a packet gives its length, and packets no
+ * rule matches are kept up to the snapshot length.
+ *
+ * The rules are compiled into a single BPF program that returns the
+ * number of bytes to keep, which is what kernel packet filters return;
+ * chained after the capture filter, it lets the kernel do the truncation
+ * where it supports that.  The same program is run in userspace on every
+ * packet as well, for where it doesn't.
+ */
+typedef struct {
+    guint   length;     /* bytes to keep, 0 for the whole packet */
+    gchar  *filter;     /* capture filter, "" to match every packet */
+} truncate_rule;
+
+/*
+ * Parse a rule given as "<length>[:<capture filter>]".  Returns FALSE if
+ * it's not valid.  The filter is only checked when the rules are
+ * compiled, and must be freed with g_free().
+ */
+gboolean
+capture_truncate_parse_rule(const char *arg, truncate_rule *rule);
+
+/*
+ * Compile an array of truncate_rules for packets of link-layer type
+ * linktype captured with snapshot length snaplen.  Returns FALSE, with a
+ * message in errmsg, on failure.
+ */
+gboolean
+capture_truncate_compile(const GArray *rules, int linktype, int snaplen,
+                         struct bpf_program *prog,
+                         char *errmsg, size_t errmsg_len);
+
+/*
+ * Make a program that runs the compiled capture filter "filter" and then,
+ * for the packets it accepts, the compiled truncation rules "truncate".
+ * Returns FALSE if the capture filter can't be chained onto.
+ */
+gboolean
+capture_truncate_chain(const struct bpf_program *filter,
+                       const struct bpf_program *truncate,
+                       struct bpf_program *prog);
+
+/*
+ * Get the number of bytes of a packet to keep, which is at most caplen.
+ */
+guint
+capture_truncate_length(const struct bpf_program *truncate, const u_char *pd,
+                        guint len, guint caplen);
+
+/*
+ * Free a program made by capture_truncate_compile() or
+ * capture_truncate_chain().
+ */
+void
+capture_truncate_free(struct bpf_program *prog);
+
+#endif /* __CAPTURE_TRUNCATE_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -220,8 +220,11 @@ gboolean capture_info_new_file(const char *new_filename)
         g_warning("capture_info_new_file: %d (%s)", err, err_msg);
         g_free (err_msg);
         return FALSE;
-    } else
-        return TRUE;
+    }
+
+    /* dumpcap is still writing it */
+    wtap_set_file_growing(info_data.wtap);
+    return TRUE;
 }
 
 
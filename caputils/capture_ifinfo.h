@@ -117,6 +117,18 @@ extern if_capabilities_t *
 capture_get_if_capabilities(const char *devname, gboolean monitor_mode,
                             char **err_str, void (*update_cb)(void));
 
+/**
+ * Fetch the linktype lists for all the interfaces in "if_list" from a
+ * single child process, so that the capture_get_if_capabilities() calls
+ * that follow for each of them don't each need one.  "monitor_mode_cb",
+ * if not NULL, says whether an interface will be asked about in monitor
+ * mode.
+ */
+extern void
+capture_prefetch_if_capabilities(GList *if_list,
+                                 gboolean (*monitor_mode_cb)(const char *ifname),
+                                 void (*update_cb)(void));
+
 void free_if_capabilities(if_capabilities_t *caps);
 
 void add_interface_to_remote_list(if_info_t *if_info);
@@ -0,0 +1,271 @@
+/* capture_shm.c
+ * Shared-memory ring that passes captured packets
+ * from dumpcap to the program that started it
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "caputils/capture_shm.h"
+
+#ifdef HAVE_CAPTURE_SHM
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <wsutil/file_util.h>
+
+#define CAPTURE_SHM_MAGIC       0x57534852      /* "WSHR" */
+#define CAPTURE_SHM_VERSION     1
+
+/* Each packet is preceded by its length, so that the reader can skip it;
+   a length of CAPTURE_SHM_WRAP means the rest of the area is unused and
+   the next packet is at the start. */
+#define CAPTURE_SHM_WRAP        0xffffffff
+#define CAPTURE_SHM_ALIGN(n)    (((n) + 7) & ~7U)
+#define CAPTURE_SHM_ENTRY_HDR   8
+
+typedef struct {
+    guint32         magic;
+    guint32         version;
+    guint32         data_size;      /* a power of 2 */
+    volatile gint   put_pos;        /* only written by dumpcap */
+    volatile gint   got_pos;        /* only written by the reader */
+    volatile gint   overrun;        /* set by dumpcap once a packet doesn't fit */
+} capture_shm_header;
+
+/* The packet area starts this far into the mapping */
+#define CAPTURE_SHM_DATA_OFFSET 64
+
+struct capture_shm {
+    int                 fd;
+    guint8             *map;
+    size_t              map_len;
+    capture_shm_header *hdr;
+    guint8             *data;
+    guint32             data_size;
+};
+
+static capture_shm *
+capture_shm_map(int fd, size_t map_len, int *err)
+{
+    capture_shm *shm;
+    void        *map;
+
+    map = mmap(NULL, map_len, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        *err = errno;
+        return NULL;
+    }
+    shm = g_new(capture_shm, 1);
+    shm->fd = fd;
+    shm->map = (guint8 *)map;
+    shm->map_len = map_len;
+    shm->hdr = (capture_shm_header *)map;
+    shm->data = shm->map + CAPTURE_SHM_DATA_OFFSET;
+    shm->data_size = (guint32)(map_len - CAPTURE_SHM_DATA_OFFSET);
+    return shm;
+}
+
+capture_shm *
+capture_shm_create(size_t size, int *err)
+{
+    gchar       *path;
+    int          fd;
+    guint32      data_size = 4096;
+    capture_shm *shm;
+
+    while (data_size < size && data_size < (1U << 30))
+        data_size <<= 1;
+
+    /*
+     * The ring is an unlinked file that dumpcap inherits; its pages are
+     * only ever written back if memory gets short.
+     */
+    path = g_build_filename(g_get_tmp_dir(), "wireshark_shm_XXXXXX", NULL);
+    fd = g_mkstemp(path);
+    if (fd == -1) {
+        *err = errno;
+        g_free(path);
+        return NULL;
+    }
+    ws_unlink(path);
+    g_free(path);
+    if (ftruncate(fd, CAPTURE_SHM_DATA_OFFSET + data_size) == -1 ||
+        fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) & ~FD_CLOEXEC) == -1) {
+        *err = errno;
+        ws_close(fd);
+        return NULL;
+    }
+    shm = capture_shm_map(fd, CAPTURE_SHM_DATA_OFFSET + data_size, err);
+    if (shm == NULL) {
+        ws_close(fd);
+        return NULL;
+    }
+    shm->hdr->magic = CAPTURE_SHM_MAGIC;
+    shm->hdr->version = CAPTURE_SHM_VERSION;
+    shm->hdr->data_size = data_size;
+    g_atomic_int_set(&shm->hdr->put_pos, 0);
+    g_atomic_int_set(&shm->hdr->got_pos, 0);
+    g_atomic_int_set(&shm->hdr->overrun, 0);
+    return shm;
+}
+
+capture_shm *
+capture_shm_attach(int fd, int *err)
+{
+    ws_statb64   st;
+    capture_shm *shm;
+
+    if (ws_fstat64(fd, &st) == -1) {
+        *err = errno;
+        return NULL;
+    }
+    if (st.st_size <= CAPTURE_SHM_DATA_OFFSET) {
+        *err = EINVAL;
+        return NULL;
+    }
+    shm = capture_shm_map(fd, (size_t)st.st_size, err);
+    if (shm == NULL)
+        return NULL;
+    if (shm->hdr->magic != CAPTURE_SHM_MAGIC ||
+        shm->hdr->version != CAPTURE_SHM_VERSION ||
+        shm->hdr->data_size != shm->data_size ||
+        (shm->data_size & (shm->data_size - 1)) != 0) {
+        *err = EINVAL;
+        munmap(shm->map, shm->map_len);
+        g_free(shm);
+        return NULL;
+    }
+    return shm;
+}
+
+int
+capture_shm_fd(const capture_shm *shm)
+{
+    return shm->fd;
+}
+
+void
+capture_shm_free(capture_shm *shm)
+{
+    munmap(shm->map, shm->map_len);
+    ws_close(shm->fd);
+    g_free(shm);
+}
+
+gboolean
+capture_shm_put(capture_shm *shm, const capture_shm_record *rec,
+                const guint8 *pd)
+{
+    guint32  put_pos, got_pos, offset, room_at_end, needed, total;
+    guint8  *entry;
+    guint32  rec_len;
+
+    if (g_atomic_int_get(&shm->hdr->overrun))
+        return FALSE;
+
+    put_pos = (guint32)g_atomic_int_get(&shm->hdr->put_pos);
+    got_pos = (guint32)g_atomic_int_get(&shm->hdr->got_pos);
+    offset = put_pos & (shm->data_size - 1);
+    room_at_end = shm->data_size - offset;
+    needed = CAPTURE_SHM_ALIGN(CAPTURE_SHM_ENTRY_HDR + sizeof *rec + rec->caplen);
+    /* a packet that doesn't fit before the end goes at the start */
+    total = needed <= room_at_end ? needed : room_at_end + needed;
+    if (total > shm->data_size - (put_pos - got_pos)) {
+        g_atomic_int_set(&shm->hdr->overrun, 1);
+        return FALSE;
+    }
+
+    if (needed > room_at_end) {
+        *(guint32 *)(void *)(shm->data + offset) = CAPTURE_SHM_WRAP;
+        offset = 0;
+    }
+    entry = shm->data + offset;
+    rec_len = needed;
+    memcpy(entry, &rec_len, sizeof rec_len);
+    memcpy(entry + CAPTURE_SHM_ENTRY_HDR, rec, sizeof *rec);
+    memcpy(entry + CAPTURE_SHM_ENTRY_HDR + sizeof *rec, pd, rec->caplen);
+
+    /* publish it */
+    g_atomic_int_set(&shm->hdr->put_pos, (gint)(put_pos + total));
+    return TRUE;
+}
+
+gboolean
+capture_shm_peek(capture_shm *shm, capture_shm_record *rec, const guint8 **pd)
+{
+    guint32  put_pos, got_pos, offset, skipped = 0;
+    guint32  rec_len;
+    guint8  *entry;
+
+    put_pos = (guint32)g_atomic_int_get(&shm->hdr->put_pos);
+    got_pos = (guint32)g_atomic_int_get(&shm->hdr->got_pos);
+    if (put_pos == got_pos)
+        return FALSE;
+
+    offset = got_pos & (shm->data_size - 1);
+    memcpy(&rec_len, shm->data + offset, sizeof rec_len);
+    if (rec_len == CAPTURE_SHM_WRAP) {
+        skipped = shm->data_size - offset;
+        offset = 0;
+        memcpy(&rec_len, shm->data, sizeof rec_len);
+    }
+    entry = shm->data + offset;
+    memcpy(rec, entry + CAPTURE_SHM_ENTRY_HDR, sizeof *rec);
+    rec->rec_len = skipped + rec_len;
+    *pd = entry + CAPTURE_SHM_ENTRY_HDR + sizeof *rec;
+    return TRUE;
+}
+
+void
+capture_shm_remove(capture_shm *shm, const capture_shm_record *rec)
+{
+    guint32 got_pos = (guint32)g_atomic_int_get(&shm->hdr->got_pos);
+
+    g_atomic_int_set(&shm->hdr->got_pos, (gint)(got_pos + rec->rec_len));
+}
+
+gboolean
+capture_shm_overrun(capture_shm *shm)
+{
+    return g_atomic_int_get(&shm->hdr->overrun) != 0;
+}
+
+#endif /* HAVE_CAPTURE_SHM */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
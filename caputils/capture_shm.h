@@ -0,0 +1,139 @@
+/* capture_shm.h
+ * Definitions for the shared-memory ring that passes captured packets
+ * from dumpcap to the program that started it
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CAPTURE_SHM_H__
+#define __CAPTURE_SHM_H__
+
+#include <glib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#if defined(HAVE_LIBPCAP) && !defined(_WIN32)
+
+#define HAVE_CAPTURE_SHM
+
+/*
+ * The program that starts dumpcap can create a capture ring in memory
+ * shared with it and pass it on dumpcap's command line.  dumpcap then
+ * puts a copy of each packet it writes to the capture file in the ring,
+ * and the program, when the sync pipe tells it how many new packets
+ * there are, takes them out of the ring rather than reading them back
+ * from the file.
+ *
+ * dumpcap never waits for room in the ring.  If the reader falls so far
+ * behind that a packet doesn't fit, dumpcap stops using the ring for the
+ * rest of the capture, and the reader has to go back to reading the
+ * file once it has emptied the ring.
+ */
+typedef struct capture_shm capture_shm;
+
+/* Default size of the ring's packet area */
+#define CAPTURE_SHM_DEFAULT_SIZE    (16 * 1024 * 1024)
+
+/* A packet in the ring */
+typedef struct {
+    gint64   file_offset;   /* where it starts in the capture file */
+    gint64   secs;          /* time stamp */
+    guint32  nsecs;
+    guint32  caplen;
+    guint32  len;
+    guint32  interface_id;
+    gint32   linktype;      /* the interface's DLT_ value */
+    guint32  rec_len;       /* internal: bytes used in the ring, with padding */
+} capture_shm_record;
+
+/*
+ * Reader: create a ring with a packet area of about size bytes, to be
+ * passed to dumpcap as capture_shm_fd().  Returns NULL, with *err set to
+ * an errno value, on failure.
+ */
+capture_shm *
+capture_shm_create(size_t size, int *err);
+
+/*
+ * Writer: map the ring passed as file descriptor fd.  Returns NULL, with
+ * *err set to an errno value, on failure.
+ */
+capture_shm *
+capture_shm_attach(int fd, int *err);
+
+/* The file descriptor through which the ring is shared */
+int
+capture_shm_fd(const capture_shm *shm);
+
+/* Unmap the ring and close its file descriptor */
+void
+capture_shm_free(capture_shm *shm);
+
+/*
+ * Writer: put a packet in the ring.  Returns FALSE if it doesn't fit, in
+ * which case this and all later packets are left out of the ring.
+ */
+gboolean
+capture_shm_put(capture_shm *shm, const capture_shm_record *rec,
+                const guint8 *pd);
+
+/*
+ * Reader: get the oldest packet in the ring, without removing it; *pd is
+ * set to point to its data in the ring.  Returns FALSE if the ring is
+ * empty.
+ */
+gboolean
+capture_shm_peek(capture_shm *shm, capture_shm_record *rec, const guint8 **pd);
+
+/*
+ * Reader: remove the packet capture_shm_peek() got, once its data is no
+ * longer needed.
+ */
+void
+capture_shm_remove(capture_shm *shm, const capture_shm_record *rec);
+
+/*
+ * Reader: returns TRUE if the writer has stopped using the ring because
+ * a packet didn't fit.
+ */
+gboolean
+capture_shm_overrun(capture_shm *shm);
+
+#endif /* HAVE_LIBPCAP && !_WIN32 */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CAPTURE_SHM_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
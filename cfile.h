@@ -26,8 +26,10 @@
 #include <epan/epan.h>
 #include <epan/column-info.h>
 #include <epan/dfilter/dfilter.h>
+#include <epan/field_store.h>
 #include <epan/frame_data.h>
 #include <epan/frame_data_sequence.h>
+#include <epan/proto_stack_store.h>
 #include <wiretap/wtap.h>
 
 #ifdef __cplusplus
@@ -55,6 +57,37 @@ typedef enum {
   SD_BACKWARD
 } search_direction;
 
+/*
+ * Running totals over the frames in a capture file, for the summary and
+ * packet range code.  They're kept up to date as frames are read,
+ * filtered, marked and ignored, so that those don't have to look at
+ * every frame.
+ */
+typedef struct {
+  gboolean     valid;           /* FALSE if they have to be recomputed */
+  gboolean     marked_times_valid; /* FALSE if marked_start/stop have to be recomputed */
+  guint64      bytes;           /* Bytes in all frames */
+  guint32      count_ts;        /* Time-stamped frames */
+  double       start_time;      /* Earliest time stamp, in seconds */
+  double       stop_time;       /* Latest time stamp, in seconds */
+  guint32      displayed_count; /* Frames that passed the display filter */
+  guint32      displayed_count_ts;
+  guint64      displayed_bytes;
+  double       displayed_start;
+  double       displayed_stop;
+  guint32      displayed_plus_dependents_count;
+  guint32      displayed_marked_count;
+  guint32      displayed_ignored_count;
+  guint32      displayed_ignored_marked_count;
+  guint32      marked_count_ts;
+  guint64      marked_bytes;
+  double       marked_start;
+  double       marked_stop;
+  guint32      ignored_marked_count;
+  guint32      first_marked;    /* No frame before this one is marked */
+  guint32      last_marked;     /* No frame after this one is marked */
+} frame_tally_t;
+
 #ifdef WANT_PACKET_EDITOR
 /* XXX, where this struct should go? */
 typedef struct {
@@ -69,6 +102,7 @@ typedef struct _capture_file {
   gchar       *filename;        /* Name of capture file */
   gchar       *source;          /* Temp file source, e.g. "Pipe from elsewhere" */
   gboolean     is_tempfile;     /* Is capture file a temporary file? */
+  gchar      **set_filenames;   /* Files read as one capture, NULL-terminated, or NULL */
   gboolean     unsaved_changes; /* Does the capture file have changes that have not been saved? */
   gint64       f_datalen;       /* Size of capture file data (uncompressed) */
   guint16      cd_t;            /* File type of capture file */
@@ -82,6 +116,7 @@ typedef struct _capture_file {
   guint32      marked_count;    /* Number of marked frames */
   guint32      ignored_count;   /* Number of ignored frames */
   guint32      ref_time_count;  /* Number of time referenced frames */
+  frame_tally_t frame_tally;    /* Running totals over the frames */
   gboolean     drops_known;     /* TRUE if we know how many packets were dropped */
   guint32      drops;           /* Dropped packets */
   nstime_t     elapsed_time;    /* Elapsed time */
@@ -91,6 +126,8 @@ typedef struct _capture_file {
   dfilter_t   *rfcode;          /* Compiled read filter program */
   dfilter_t   *dfcode;          /* Compiled display filter program */
   gchar       *dfilter;         /* Display filter string */
+  field_store_t *field_store;   /* Values of selected fields, or NULL */
+  proto_stack_store_t *proto_stacks; /* Protocols in each dissected frame */
   gboolean     redissecting;    /* TRUE if currently redissecting (cf_redissect_packets) */
   /* search */
   gchar       *sfilter;         /* Filter, hex value, or string being searched */
@@ -107,6 +144,8 @@ typedef struct _capture_file {
   /* packet data */
   struct wtap_pkthdr phdr;                /* Packet header */
   Buffer       buf;             /* Packet data */
+  guint32      last_read;       /* Frame last read by cf_read_record_r() */
+  guint32      read_ahead_to;   /* Last frame read ahead into the record cache */
   /* frames */
   frame_data_sequence *frames;  /* Sequence of frames, if we're keeping that information */
   guint32      first_displayed; /* Frame number of first frame displayed */
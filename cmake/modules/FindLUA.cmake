@@ -6,6 +6,7 @@
 #  LUA_INCLUDE_DIRS - Where to find lua.h
 #  LUA_DLL_DIR      - (Windows) Path to the Lua DLL.
 #  LUA_DLL          - (Windows) Name of the Lua DLL.
+#  LUA_IS_LUAJIT    - If true, the library found is LuaJIT (ENABLE_LUAJIT)
 #
 # Note that the expected include convention is
 #  #include "lua.h"
@@ -18,14 +19,22 @@ INCLUDE(FindWSWinLibs)
 FindWSWinLibs("lua5*" "LUA_HINTS")
 
 find_package(PkgConfig)
-pkg_search_module(LUA lua)
+if(ENABLE_LUAJIT)
+  # LuaJIT implements the Lua 5.1 API, so it's looked for in place of Lua
+  pkg_search_module(LUA luajit)
+  set(_lua_path_suffixes include/luajit-2.1 include/luajit-2.0)
+  set(_lua_library_names luajit-5.1 luajit51 luajit)
+else()
+  pkg_search_module(LUA lua)
+  set(_lua_path_suffixes include/lua52 include/lua5.2 include/lua51 include/lua5.1 include/lua include)
+endif()
 
 FIND_PATH(LUA_INCLUDE_DIR lua.h
   HINTS
     "${LUA_INCLUDEDIR}"
     "$ENV{LUA_DIR}"
   ${LUA_HINTS}
-  PATH_SUFFIXES include/lua52 include/lua5.2 include/lua51 include/lua5.1 include/lua include
+  PATH_SUFFIXES ${_lua_path_suffixes}
   PATHS
   ~/Library/Frameworks
   /Library/Frameworks
@@ -51,9 +60,18 @@ if ( LUA_INCLUDE_DIR STREQUAL LUA_INC_SUFFIX )
 endif()
 message("LUA INCLUDE SUFFIX: ${LUA_INC_SUFFIX}")
 
+if(ENABLE_LUAJIT)
+  if(LUA_INCLUDE_DIR AND EXISTS "${LUA_INCLUDE_DIR}/luajit.h")
+    set(LUA_IS_LUAJIT TRUE)
+  else()
+    set(LUA_IS_LUAJIT FALSE)
+  endif()
+else()
+  set(_lua_library_names lua${LUA_INC_SUFFIX} lua52 lua5.2 lua51 lua5.1 lua)
+endif()
 
 FIND_LIBRARY(LUA_LIBRARY
-  NAMES lua${LUA_INC_SUFFIX} lua52 lua5.2 lua51 lua5.1 lua
+  NAMES ${_lua_library_names}
   HINTS
     "${LUA_LIBDIR}"
     "$ENV{LUA_DIR}"
@@ -39,6 +39,7 @@
 #include "color_filters.h"
 #include "file.h"
 #include <epan/dfilter/dfilter.h>
+#include <epan/epan_dissect.h>
 #include <epan/prefs.h>
 
 #include "ui/simple_dialog.h"
@@ -58,6 +59,13 @@ static GSList *color_filter_list = NULL;
 static GSList *color_filter_deleted_list = NULL;
 static GSList *color_filter_valid_list   = NULL;
 
+/* The enabled filters in color_filter_list as one dfilter set, so
+ * that fields used by several of them are only looked up once per
+ * packet, and the filter each member of the set came from.  Built
+ * when it's first needed after color_filter_list has changed. */
+static dfilter_set_t *color_filter_set = NULL;
+static GPtrArray *color_filter_set_members = NULL;
+
 /* Color Filters can en-/disabled. */
 static gboolean filters_enabled = TRUE;
 
@@ -66,6 +74,35 @@ static gboolean filters_enabled = TRUE;
  */
 static gboolean tmp_colors_set = FALSE;
 
+/* color_filter_list, or a filter in it, has changed */
+static void
+color_filter_set_invalidate(void)
+{
+    dfilter_set_free(color_filter_set);
+    color_filter_set = NULL;
+    if (color_filter_set_members != NULL) {
+        g_ptr_array_free(color_filter_set_members, TRUE);
+        color_filter_set_members = NULL;
+    }
+}
+
+static void
+color_filter_set_build(void)
+{
+    GSList         *curr;
+    color_filter_t *colorf;
+
+    color_filter_set = dfilter_set_new();
+    color_filter_set_members = g_ptr_array_new();
+    for (curr = color_filter_list; curr != NULL; curr = g_slist_next(curr)) {
+        colorf = (color_filter_t *)curr->data;
+        if ( (!colorf->disabled) && (colorf->c_colorfilter != NULL) ) {
+            dfilter_set_add(color_filter_set, colorf->c_colorfilter);
+            g_ptr_array_add(color_filter_set_members, colorf);
+        }
+    }
+}
+
 /* Create a new filter */
 color_filter_t *
 color_filter_new(const gchar *name,          /* The name of the filter to create */
@@ -85,6 +122,7 @@ color_filter_new(const gchar *name,          /* The name of the filter to create
     colorf->c_colorfilter       = NULL;
     colorf->color_edit_dlg_info = NULL;
     colorf->selected            = FALSE;
+    colorf->hits                = 0;
     return colorf;
 }
 
@@ -175,7 +213,7 @@ color_filters_set_tmp(guint8 filt_nr, gchar *filter, gboolean disabled)
              * or if we found a matching filter string which need to be cleared
              */
             tmpfilter = ( (filter==NULL) || (i!=filt_nr) ) ? "frame" : filter;
-            if (!dfilter_compile(tmpfilter, &compiled_filter, &err_msg)) {
+            if (!dfilter_compile_cached(tmpfilter, &compiled_filter, &err_msg)) {
                 simple_dialog(ESD_TYPE_ERROR, ESD_BTN_OK,
                               "Could not compile color filter name: \"%s\""
                               " text: \"%s\".\n%s", name, filter, err_msg);
@@ -188,6 +226,7 @@ color_filters_set_tmp(guint8 filt_nr, gchar *filter, gboolean disabled)
                 colorf->filter_text = g_strdup(tmpfilter);
                 colorf->c_colorfilter = compiled_filter;
                 colorf->disabled = ((i!=filt_nr) ? TRUE : disabled);
+                color_filter_set_invalidate();
                 /* Remember that there are now temporary coloring filters set */
                 if( filter )
                     tmp_colors_set = TRUE;
@@ -258,6 +297,7 @@ color_filter_clone(color_filter_t *colorf)
     new_colorf->c_colorfilter       = NULL;
     new_colorf->color_edit_dlg_info = NULL;
     new_colorf->selected            = FALSE;
+    new_colorf->hits                = colorf->hits;
 
     return new_colorf;
 }
@@ -297,6 +337,8 @@ color_filters_init(void)
     if (!read_users_filters(&color_filter_list))
         /* if that failed, try to read the global filters */
         color_filters_read_globals(&color_filter_list);
+
+    color_filter_set_invalidate();
 }
 
 void
@@ -314,13 +356,21 @@ color_filters_reload(void)
     if (!read_users_filters(&color_filter_list))
         /* if that failed, try to read the global filters */
         color_filters_read_globals(&color_filter_list);
+
+    color_filter_set_invalidate();
 }
 
 void
 color_filters_cleanup(void)
 {
+    GSList *curr;
+
     /* delete the previously deleted filters */
     color_filter_list_delete(&color_filter_deleted_list);
+
+    /* the hit counts are for the file that's being closed */
+    for (curr = color_filter_list; curr != NULL; curr = g_slist_next(curr))
+        ((color_filter_t *)curr->data)->hits = 0;
 }
 
 static void
@@ -344,7 +394,7 @@ color_filter_compile_cb(gpointer filter_arg, gpointer unused _U_)
     gchar *err_msg;
 
     g_assert(colorf->c_colorfilter == NULL);
-    if (!dfilter_compile(colorf->filter_text, &colorf->c_colorfilter, &err_msg)) {
+    if (!dfilter_compile_cached(colorf->filter_text, &colorf->c_colorfilter, &err_msg)) {
         simple_dialog(ESD_TYPE_ERROR, ESD_BTN_OK,
                       "Could not compile color filter name: \"%s\" text: \"%s\".\n%s",
                       colorf->filter_name, colorf->filter_text, err_msg);
@@ -362,7 +412,7 @@ color_filter_validate_cb(gpointer filter_arg, gpointer unused _U_)
     gchar *err_msg;
 
     g_assert(colorf->c_colorfilter == NULL);
-    if (!dfilter_compile(colorf->filter_text, &colorf->c_colorfilter, &err_msg)) {
+    if (!dfilter_compile_cached(colorf->filter_text, &colorf->c_colorfilter, &err_msg)) {
         simple_dialog(ESD_TYPE_ERROR, ESD_BTN_OK,
                       "Removing color filter name: \"%s\" text: \"%s\".\n%s",
                       colorf->filter_name, colorf->filter_text, err_msg);
@@ -396,6 +446,8 @@ color_filters_apply(GSList *tmp_cfl, GSList *edit_cfl)
 
     /* compile all filter */
     g_slist_foreach(color_filter_list, color_filter_compile_cb, NULL);
+
+    color_filter_set_invalidate();
 }
 
 gboolean
@@ -417,45 +469,36 @@ color_filters_enable(gboolean enable)
 }
 
 
-/* prepare the epan_dissect_t for the filter */
-static void
-prime_edt(gpointer data, gpointer user_data)
-{
-    color_filter_t *colorf = (color_filter_t *)data;
-    epan_dissect_t *edt    = (epan_dissect_t *)user_data;
-
-    if (colorf->c_colorfilter != NULL)
-        epan_dissect_prime_dfilter(edt, colorf->c_colorfilter);
-}
-
-/* Prime the epan_dissect_t with all the compiler
+/* Prime the epan_dissect_t with all the enabled
  * color filters in 'color_filter_list'. */
 void
 color_filters_prime_edt(epan_dissect_t *edt)
 {
-    if (color_filters_used())
-        g_slist_foreach(color_filter_list, prime_edt, edt);
+    if (color_filters_used()) {
+        if (color_filter_set == NULL)
+            color_filter_set_build();
+
+        dfilter_set_prime_proto_tree(color_filter_set, edt->tree);
+    }
 }
 
 /* * Return the color_t for later use */
 const color_filter_t *
 color_filters_colorize_packet(epan_dissect_t *edt)
 {
-    GSList         *curr;
-    color_filter_t *colorf;
+    int match;
 
     /* If we have color filters, "search" for the matching one. */
     if (color_filters_used()) {
-        curr = color_filter_list;
-
-        while(curr != NULL) {
-            colorf = (color_filter_t *)curr->data;
-            if ( (!colorf->disabled) &&
-                 (colorf->c_colorfilter != NULL) &&
-                 dfilter_apply_edt(colorf->c_colorfilter, edt)) {
-                return colorf;
-            }
-            curr = g_slist_next(curr);
+        if (color_filter_set == NULL)
+            color_filter_set_build();
+
+        match = dfilter_set_apply_first(color_filter_set, edt->tree);
+        if (match >= 0) {
+            color_filter_t *colorf = (color_filter_t *)g_ptr_array_index(color_filter_set_members, match);
+
+            colorf->hits++;
+            return colorf;
         }
     }
 
@@ -574,7 +617,7 @@ read_filters_file(FILE *f, gpointer user_data)
             dfilter_t *temp_dfilter;
             gchar *err_msg;
 
-            if (!dfilter_compile(filter_exp, &temp_dfilter, &err_msg)) {
+            if (!dfilter_compile_cached(filter_exp, &temp_dfilter, &err_msg)) {
                 g_warning("Could not compile \"%s\" in colorfilters file.\n%s",
                           name, err_msg);
                 g_free(err_msg);
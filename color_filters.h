@@ -41,6 +41,7 @@ typedef struct _color_filter {
     color_t    fg_color;            /* foreground color for packets that match */
     gboolean   disabled;            /* set if the filter is disabled */
     gboolean   selected;            /* set if the filter is selected in the color dialog box */
+    guint64    hits;                /* packets this filter was the first match for */
 
                                     /* only used inside of color_filters.c */
     struct epan_dfilter *c_colorfilter;  /* compiled filter expression */
@@ -56,7 +57,7 @@ void color_filters_init(void);
 /** Reload the color filters */
 void color_filters_reload(void);
 
-/** Cleanup remaining color filter zombies */
+/** Cleanup remaining color filter zombies and reset the hit counts */
 void color_filters_cleanup(void);
 
 /** Color filters currently used?
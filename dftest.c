@@ -28,9 +28,14 @@
 #include <string.h>
 #include <errno.h>
 
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
 #include <glib.h>
 
 #include <epan/epan.h>
+#include <epan/epan_dissect.h>
 #include <epan/timestamp.h>
 #include <epan/prefs.h>
 #include <epan/dfilter/dfilter.h>
@@ -41,7 +46,15 @@
 #include <wsutil/filesystem.h>
 #include <wsutil/privileges.h>
 #include <wsutil/report_err.h>
+#include <wsutil/time_util.h>
+
+#include <wiretap/wtap.h>
 
+#ifndef HAVE_GETOPT_LONG
+#include "wsutil/wsgetopt.h"
+#endif
+
+#include "frame_tvbuff.h"
 #include "ui/util.h"
 #include "register.h"
 
@@ -51,6 +64,114 @@ static void open_failure_message(const char *filename, int err,
 static void read_failure_message(const char *filename, int err);
 static void write_failure_message(const char *filename, int err);
 
+/* For epan_get_frame_ts(); we only keep the frames dissection looks back at */
+static frame_data	ref_frame;
+static frame_data	*ref;
+static frame_data	prev_dis_frame;
+static frame_data	*prev_dis;
+
+static const nstime_t *
+dftest_get_frame_ts(void *data _U_, guint32 frame_num)
+{
+	if (ref && ref->num == frame_num)
+		return &ref->abs_ts;
+
+	if (prev_dis && prev_dis->num == frame_num)
+		return &prev_dis->abs_ts;
+
+	return NULL;
+}
+
+/*
+ * Dissect every packet in the file and apply the filter to it, adding
+ * the time spent in dfilter_apply_edt() to *filter_ns; returns FALSE
+ * on a read error.
+ */
+static gboolean
+filter_file(const char *fname, dfilter_t *df, guint32 *packets,
+	    guint32 *matches, guint64 *filter_ns)
+{
+	wtap		*wth;
+	int		err;
+	gchar		*err_info;
+	gint64		data_offset;
+	epan_t		*epan;
+	epan_dissect_t	edt;
+	frame_data	fdata;
+	nstime_t	elapsed_time;
+	guint32		cum_bytes = 0;
+	guint32		framenum = 0;
+	guint64		start;
+
+	wth = wtap_open_offline(fname, WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+	if (wth == NULL) {
+		fprintf(stderr, "dftest: can't open \"%s\": %s\n", fname,
+			wtap_strerror(err));
+		g_free(err_info);
+		return FALSE;
+	}
+
+	epan = epan_new();
+	epan->data = NULL;
+	epan->get_frame_ts = dftest_get_frame_ts;
+	epan->get_interface_name = NULL;
+	epan->get_user_comment = NULL;
+
+	ref = NULL;
+	prev_dis = NULL;
+	nstime_set_zero(&elapsed_time);
+
+	epan_dissect_init(&edt, epan, TRUE, FALSE);
+
+	while (wtap_read(wth, &err, &err_info, &data_offset)) {
+		struct wtap_pkthdr *whdr = wtap_phdr(wth);
+
+		framenum++;
+		frame_data_init(&fdata, framenum, whdr, data_offset, cum_bytes);
+		epan_dissect_prime_dfilter(&edt, df);
+
+		frame_data_set_before_dissect(&fdata, &elapsed_time, &ref, prev_dis);
+		if (ref == &fdata) {
+			ref_frame = fdata;
+			ref = &ref_frame;
+		}
+
+		epan_dissect_run_with_taps(&edt, wtap_file_type_subtype(wth), whdr,
+			frame_tvbuff_new(&fdata, wtap_buf_ptr(wth)), &fdata, NULL);
+
+		start = monotonic_time_ns();
+		if (dfilter_apply_edt(df, &edt))
+			(*matches)++;
+		*filter_ns += monotonic_time_ns() - start;
+
+		frame_data_set_after_dissect(&fdata, &cum_bytes);
+		prev_dis_frame = fdata;
+		prev_dis = &prev_dis_frame;
+
+		epan_dissect_reset(&edt);
+		frame_data_destroy(&fdata);
+	}
+	*packets += framenum;
+
+	epan_dissect_cleanup(&edt);
+	epan_free(epan);
+	wtap_close(wth);
+
+	if (err != 0) {
+		fprintf(stderr, "dftest: error reading \"%s\": %s\n", fname,
+			wtap_strerror(err));
+		g_free(err_info);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+print_usage(FILE *output)
+{
+	fprintf(output, "Usage: dftest [-r <file> [-n <runs>]] <filter>\n");
+}
+
 int
 main(int argc, char **argv)
 {
@@ -61,6 +182,32 @@ main(int argc, char **argv)
 	int		pf_open_errno, pf_read_errno;
 	dfilter_t	*df;
 	gchar		*err_msg;
+	const char	*fname = NULL;
+	int		runs = 1;
+	int		opt, run;
+	guint32		packets = 0, matches = 0;
+	guint64		filter_ns = 0;
+
+	while ((opt = getopt(argc, argv, "hn:r:")) != -1) {
+		switch (opt) {
+		case 'n':
+			runs = atoi(optarg);
+			if (runs < 1) {
+				fprintf(stderr, "dftest: the number of runs must be at least 1\n");
+				exit(1);
+			}
+			break;
+		case 'r':
+			fname = optarg;
+			break;
+		case 'h':
+			print_usage(stdout);
+			exit(0);
+		default:
+			print_usage(stderr);
+			exit(1);
+		}
+	}
 
 	/*
 	 * Get credential information for later use.
@@ -134,13 +281,13 @@ main(int argc, char **argv)
 	prefs_apply_all();
 
 	/* Check for filter on command line */
-	if (argc <= 1) {
-		fprintf(stderr, "Usage: dftest <filter>\n");
+	if (optind >= argc) {
+		print_usage(stderr);
 		exit(1);
 	}
 
 	/* Get filter text */
-	text = get_args_as_string(argc, argv, 1);
+	text = get_args_as_string(argc, argv, optind);
 
 	printf("Filter: \"%s\"\n", text);
 
@@ -154,10 +301,29 @@ main(int argc, char **argv)
 
 	printf("\n");
 
-	if (df == NULL)
+	if (df == NULL) {
 		printf("Filter is empty\n");
-	else
+	}
+	else if (fname == NULL) {
 		dfilter_dump(df);
+	}
+	else {
+		/* Count and time every instruction over all the runs */
+		dfilter_set_profiling(df, TRUE);
+		for (run = 0; run < runs; run++) {
+			if (!filter_file(fname, df, &packets, &matches, &filter_ns)) {
+				dfilter_free(df);
+				epan_cleanup();
+				exit(2);
+			}
+		}
+
+		printf("Runs: %d\n", runs);
+		printf("Packets: %u, matched: %u\n", packets, matches);
+		printf("Filter time: %" G_GINT64_MODIFIER "u ns, %.1f ns per packet\n\n",
+			filter_ns, packets ? (double)filter_ns / packets : 0.0);
+		dfilter_dump_profile(df);
+	}
 
 	dfilter_free(df);
 	epan_cleanup();
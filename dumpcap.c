@@ -92,11 +92,18 @@
 #include "caputils/capture_ifinfo.h"
 #include "caputils/capture-pcap-util.h"
 #include "caputils/capture-pcap-util-int.h"
+#include "caputils/capture_shm.h"
 #ifdef _WIN32
 #include "caputils/capture-wpcap.h"
 #endif /* _WIN32 */
 
 #include "pcapio.h"
+#include "packet_ring.h"
+#include "capture-tpacket.h"
+#include "capture-stats.h"
+#include "capture-truncate.h"
+#include "capture-flow-budget.h"
+#include "capture-tee.h"
 
 #ifdef _WIN32
 #include <wsutil/unicode-utils.h>
@@ -150,9 +157,18 @@ FILE *debug_log;   /* for logging debug messages to  */
                    /*  is defined                    */
 #endif
 
-static GAsyncQueue *pcap_queue;
-static gint64 pcap_queue_bytes;
-static gint64 pcap_queue_packets;
+/*
+ * With a thread per interface, each thread puts the packets it captures
+ * in its interface's packet ring and the main thread takes them out and
+ * writes them.  When all the rings are empty, the main thread sets
+ * pcap_queue_waiting and waits on pcap_queue_cond; a capture thread that
+ * finds the flag set after putting a packet in its ring signals the
+ * condition, so that the mutex is only taken when the main thread is
+ * idle.
+ */
+static GMutex *pcap_queue_mtx;
+static GCond *pcap_queue_cond;
+static volatile gint pcap_queue_waiting;
 static gint64 pcap_queue_byte_limit = 0;
 static gint64 pcap_queue_packet_limit = 0;
 
@@ -280,6 +296,13 @@ typedef struct _pcap_options {
     guint32                      received;
     guint32                      dropped;
     guint32                      flushed;
+    guint32                      queue_drops;            /**< those of dropped that didn't fit in queue */
+    guint                        queue_packets_max;      /**< most packets there have been in queue */
+    guint                        queue_bytes_max;        /**< most bytes there have been in queue */
+    capture_hist                 read_batch;             /**< packets got by each read that got any */
+#ifdef HAVE_TPACKET_V3
+    capture_hist                 kernel_fill;            /**< percentage of tpacket's blocks ready at each read */
+#endif
     pcap_t                      *pcap_h;
 #ifdef MUST_DO_SELECT
     int                          pcap_fd;                /**< pcap file descriptor */
@@ -311,6 +334,17 @@ typedef struct _pcap_options {
 #endif
     cap_pipe_state_t cap_pipe_state;
     cap_pipe_err_t cap_pipe_err;
+    guchar                      *cap_pipe_rbuf;          /**< Buffer cap_pipe_dispatch_buffered reads into, or NULL */
+    size_t                       cap_pipe_rbuf_start;    /**< Start of the first record not yet processed */
+    size_t                       cap_pipe_rbuf_end;      /**< End of the data read */
+#ifdef HAVE_TPACKET_V3
+    tpacket_ring                *tpacket;                /**< ring to read from instead of pcap_h, or NULL */
+#endif
+    packet_ring                 *queue;                  /**< packets captured by this interface's thread */
+    gboolean                     in_merge_heap;          /**< TRUE if queue's oldest packet is in merge_heap */
+    guint64                      merge_time;             /**< its time stamp, in nanoseconds, if so */
+    struct bpf_program           truncate;               /**< compiled truncation rules, if there are any */
+    flow_budget                 *flow_budget;            /**< per-flow budget, if there is one */
 
 #if defined(_WIN32)
     GMutex                      *cap_pipe_read_mtx;
@@ -336,12 +370,6 @@ typedef struct _loop_data {
     guint32   autostop_files;
 } loop_data;
 
-typedef struct _pcap_queue_element {
-    pcap_options       *pcap_opts;
-    struct pcap_pkthdr  phdr;
-    u_char             *pd;
-} pcap_queue_element;
-
 /*
  * Standard secondary message for unexpected errors.
  */
@@ -392,6 +420,35 @@ static gboolean need_timeout_workaround;
 
 #define WRITER_THREAD_TIMEOUT 100000 /* usecs */
 
+/* Size of the buffer records are read into from a pipe or socket; room
+   for several of the largest records, so that a busy pipe is drained in
+   large reads */
+#define CAP_PIPE_RBUF_SIZE (4 * (WTAP_MAX_PACKET_SIZE + sizeof(struct pcaprec_modified_hdr)))
+
+/* Largest record that can be read from a pipe or socket */
+#define CAP_PIPE_MAX_RECORD (WTAP_MAX_PACKET_SIZE + sizeof(struct pcaprec_modified_hdr))
+
+/* Size we ask the kernel to make a FIFO we capture from, e.g. one an
+   extcap tool writes to, so that a fast writer isn't put to sleep every
+   64KB and we get more in each read */
+#define CAP_PIPE_FIFO_SIZE (1024 * 1024)
+
+/* Most packets the main thread writes from one packet ring at a time */
+#define WRITER_THREAD_BATCH 64
+
+/*
+ * With --merge-window, the main thread writes the packets from all the
+ * packet rings in time stamp order.  merge_heap is a min-heap, ordered
+ * by time stamp, of the interfaces whose rings have packets in them; a
+ * packet is written once every ring has one, so that nothing older can
+ * still turn up, or once it's merge_window milliseconds older than the
+ * newest time stamp seen or the current time, whichever is later.
+ */
+static guint merge_window = 0;
+static pcap_options **merge_heap = NULL;
+static guint merge_heap_len = 0;
+static guint64 merge_newest = 0;        /* newest time stamp seen, in nanoseconds */
+
 static void
 console_log_handler(const char *log_domain, GLogLevelFlags log_level,
                     const char *message, gpointer user_data _U_);
@@ -400,6 +457,41 @@ console_log_handler(const char *log_domain, GLogLevelFlags log_level,
 static capture_options global_capture_opts;
 static gboolean quiet = FALSE;
 static gboolean use_threads = FALSE;
+
+#define LONGOPT_TPACKET_V3      (MIN_NON_CAPTURE_LONGOPT+0)
+#define LONGOPT_FANOUT_GROUP    (MIN_NON_CAPTURE_LONGOPT+1)
+#define LONGOPT_FSYNC           (MIN_NON_CAPTURE_LONGOPT+2)
+#define LONGOPT_RING_COMPRESS   (MIN_NON_CAPTURE_LONGOPT+3)
+#define LONGOPT_RING_COMPRESS_THREADS (MIN_NON_CAPTURE_LONGOPT+4)
+#define LONGOPT_RING_INDEX      (MIN_NON_CAPTURE_LONGOPT+5)
+#define LONGOPT_TRUNCATE        (MIN_NON_CAPTURE_LONGOPT+6)
+#define LONGOPT_SYNC_SHM        (MIN_NON_CAPTURE_LONGOPT+7)
+#define LONGOPT_MERGE_WINDOW    (MIN_NON_CAPTURE_LONGOPT+8)
+#define LONGOPT_STATS_INTERVAL  (MIN_NON_CAPTURE_LONGOPT+9)
+#define LONGOPT_FLOW_BUDGET     (MIN_NON_CAPTURE_LONGOPT+10)
+#define LONGOPT_TEE             (MIN_NON_CAPTURE_LONGOPT+11)
+#define LONGOPT_TEE_SNAPLEN     (MIN_NON_CAPTURE_LONGOPT+12)
+#define LONGOPT_TEE_FILTER      (MIN_NON_CAPTURE_LONGOPT+13)
+
+static gboolean sync_on_close = FALSE;  /* sync each output file to disk before closing it */
+static guint sync_interval = 0;         /* if not 0, also sync every sync_interval seconds */
+static guint stats_interval = 0;        /* if not 0, report statistics every stats_interval seconds */
+static capture_hist write_latency;      /* microseconds to write each packet, if stats_interval isn't 0 */
+static capture_hist switch_latency;     /* microseconds to switch to each new ring buffer file */
+static ringbuf_compression ring_compression = RINGBUF_COMPRESS_NONE; /* compress finished ring buffer files */
+static guint ring_compress_threads = 1; /* threads compressing/indexing finished files */
+static gboolean ring_index = FALSE;     /* write a frame index for each finished file */
+static GArray *truncate_rules = NULL;   /* truncate_rules saying how much of each packet to keep, or NULL */
+static guint flow_budget_bytes = 0;     /* with --flow-budget, bytes to keep of each flow (0 - any) */
+static guint flow_budget_packets = 0;   /* with --flow-budget, packets to keep of each flow (0 - any) */
+static GPtrArray *tee_sinks = NULL;     /* tee_sinks getting copies of the packets, or NULL */
+#ifdef HAVE_CAPTURE_SHM
+static capture_shm *sync_shm = NULL;    /* capture ring shared with our parent, or NULL */
+#endif
+#ifdef HAVE_TPACKET_V3
+static gboolean use_tpacket = FALSE;
+static int tpacket_fanout_group = -1;
+#endif
 static guint64 start_time;
 
 static void capture_loop_write_packet_cb(u_char *pcap_opts_p, const struct pcap_pkthdr *phdr,
@@ -414,6 +506,7 @@ static void WS_MSVC_NORETURN exit_main(int err) G_GNUC_NORETURN;
 static void report_new_capture_file(const char *filename);
 static void report_packet_count(unsigned int packet_count);
 static void report_packet_drops(guint32 received, guint32 pcap_drops, guint32 drops, guint32 flushed, guint32 ps_ifdrop, gchar *name);
+static void report_capture_stats(capture_options *capture_opts);
 static void report_capture_error(const char *error_msg, const char *secondary_error_msg);
 static void report_cfilter_error(capture_options *capture_opts, guint i, const char *errmsg);
 
@@ -471,6 +564,16 @@ create_timestamp(void) {
     return timestamp;
 }
 
+/* Microseconds since start, a create_timestamp() value; 0 if the clock
+   has been set back since */
+static guint64
+elapsed_since(guint64 start)
+{
+    guint64 now = create_timestamp();
+
+    return now > start ? now - start : 0;
+}
+
 static void
 print_usage(FILE *output)
 {
@@ -528,13 +631,58 @@ print_usage(FILE *output)
     fprintf(output, "  --capture-comment <comment>\n");
     fprintf(output, "                           add a capture comment to the output file\n");
     fprintf(output, "                           (only for pcapng)\n");
+    fprintf(output, "  --fsync <policy>         when to sync output files to disk:\n");
+    fprintf(output, "                           never (default), close - before closing each file,\n");
+    fprintf(output, "                           NUM - before closing each file and every NUM secs\n");
+    fprintf(output, "  --ring-compress <method> with -b, compress each file once it's finished:\n");
+    fprintf(output, "                           "
+#ifdef HAVE_LIBZ
+                    "gzip"
+#endif
+#if defined(HAVE_LIBZ) && defined(HAVE_ZSTD)
+                    " or "
+#endif
+#ifdef HAVE_ZSTD
+                    "zstd"
+#endif
+                    "\n");
+    fprintf(output, "  --ring-compress-threads <n>\n");
+    fprintf(output, "                           threads compressing/indexing finished files (def: 1)\n");
+    fprintf(output, "  --ring-index             with -b, write a frame index for each finished file\n");
+    fprintf(output, "\n");
+    fprintf(output, "Truncation:\n");
+    fprintf(output, "  --truncate <length>[:<capture filter>]\n");
+    fprintf(output, "                           keep only <length> bytes (0 - all) of packets\n");
+    fprintf(output, "                           matching the filter (def: all packets);\n");
+    fprintf(output, "                           may be repeated, the first matching rule is used\n");
+    fprintf(output, "  --flow-budget <bytes>[:<packets>]\n");
+    fprintf(output, "                           keep only the first <bytes> bytes and <packets>\n");
+    fprintf(output, "                           packets (0 - any) of each TCP or UDP flow; SYN,\n");
+    fprintf(output, "                           FIN and RST segments are always kept\n");
+    fprintf(output, "\n");
+    fprintf(output, "Tee output:\n");
+    fprintf(output, "  --tee <file>             also write the packets kept, in pcap format, to\n");
+    fprintf(output, "                           <file> (a file or pipe); may be repeated\n");
+    fprintf(output, "  --tee-snaplen <snaplen>  packet snapshot length for the preceding --tee\n");
+    fprintf(output, "  --tee-filter <capture filter>\n");
+    fprintf(output, "                           capture filter for the preceding --tee\n");
     fprintf(output, "\n");
     fprintf(output, "Miscellaneous:\n");
     fprintf(output, "  -N <packet_limit>        maximum number of packets buffered within dumpcap\n");
+    fprintf(output, "                           for each interface\n");
     fprintf(output, "  -C <byte_limit>          maximum number of bytes used for buffering packets\n");
-    fprintf(output, "                           within dumpcap\n");
+    fprintf(output, "                           within dumpcap for each interface\n");
     fprintf(output, "  -t                       use a separate thread per interface\n");
+    fprintf(output, "  --merge-window <ms>      with several interfaces, write packets in time stamp\n");
+    fprintf(output, "                           order, holding them for up to <ms> milliseconds\n");
+#ifdef HAVE_TPACKET_V3
+    fprintf(output, "  --tpacket-v3             read Ethernet interfaces through TPACKET_V3 rings\n");
+    fprintf(output, "  --fanout-group <id>      with --tpacket-v3, share each interface's packets\n");
+    fprintf(output, "                           with other dumpcaps in fanout group <id>\n");
+#endif
     fprintf(output, "  -q                       don't report packet capture counts\n");
+    fprintf(output, "  --stats-interval <secs>  report per-interface and writer statistics\n");
+    fprintf(output, "                           every <secs> seconds\n");
     fprintf(output, "  -v                       print version information and exit\n");
     fprintf(output, "  -h                       display this help and exit\n");
     fprintf(output, "\n");
@@ -1395,11 +1543,6 @@ print_machine_readable_if_capabilities(if_capabilities_t *caps)
     data_link_info_t *data_link_info;
     const gchar *desc_str;
 
-    if (capture_child) {
-        /* Let our parent know we succeeded. */
-        pipe_write_block(2, SP_SUCCESS, NULL);
-    }
-
     if (caps->can_set_rfmon)
         printf("1\n");
     else
@@ -2001,6 +2144,13 @@ cap_pipe_open_live(char *pipename,
                 pcap_opts->cap_pipe_err = PIPERR;
                 return;
             }
+#ifdef F_SETPIPE_SZ
+            /* Not fatal if it fails; we're just limited to the default. */
+            if (fcntl(fd, F_SETPIPE_SZ, CAP_PIPE_FIFO_SIZE) == -1) {
+                g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG,
+                      "cap_pipe_open_live: can't resize pipe: %s", g_strerror(errno));
+            }
+#endif
         } else if (S_ISSOCK(pipe_stat.st_mode)) {
             fd = socket(AF_UNIX, SOCK_STREAM, 0);
             if (fd == -1) {
@@ -2300,146 +2450,203 @@ error:
 }
 
 
-/* We read one record from the pipe, take care of byte order in the record
- * header, write the record to the capture file, and update capture statistics. */
+/* We read as much as there is from the pipe, up to the size of the
+ * buffer, and then, for each complete record in the buffer, take care of
+ * byte order in the record header, write the record to the capture file
+ * straight from the buffer, and update capture statistics.  A partial
+ * record at the end is kept for the next call, and is only moved to the
+ * start of the buffer when there's no longer room after it for the
+ * largest record. */
 static int
-cap_pipe_dispatch(loop_data *ld, pcap_options *pcap_opts, guchar *data, char *errmsg, int errmsgl)
+cap_pipe_dispatch_buffered(loop_data *ld, pcap_options *pcap_opts, char *errmsg, int errmsgl)
+{
+    struct pcap_pkthdr  phdr;
+    struct pcaprec_hdr  rechdr;
+    size_t              hdr_len;
+    size_t              left;
+    ssize_t             b;
+    int                 inpkts = 0;
+#ifdef _WIN32
+    wchar_t            *err_str;
+#endif
+
+#ifdef LOG_CAPTURE_VERBOSE
+    g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG, "cap_pipe_dispatch_buffered");
+#endif
+
+    if (pcap_opts->cap_pipe_rbuf == NULL)
+        pcap_opts->cap_pipe_rbuf = (guchar *)g_malloc(CAP_PIPE_RBUF_SIZE);
+
+    /* If everything's been processed, start again at the beginning of
+       the buffer; if there's a partial record and not enough room after
+       it, move it there.  Then fill up the rest. */
+    left = pcap_opts->cap_pipe_rbuf_end - pcap_opts->cap_pipe_rbuf_start;
+    if (left == 0) {
+        pcap_opts->cap_pipe_rbuf_start = 0;
+        pcap_opts->cap_pipe_rbuf_end = 0;
+    } else if (pcap_opts->cap_pipe_rbuf_start != 0 &&
+               CAP_PIPE_RBUF_SIZE - pcap_opts->cap_pipe_rbuf_start < CAP_PIPE_MAX_RECORD) {
+        memmove(pcap_opts->cap_pipe_rbuf,
+                pcap_opts->cap_pipe_rbuf + pcap_opts->cap_pipe_rbuf_start, left);
+        pcap_opts->cap_pipe_rbuf_start = 0;
+        pcap_opts->cap_pipe_rbuf_end = left;
+    }
+    b = cap_pipe_read(pcap_opts->cap_pipe_fd,
+                      (char *)pcap_opts->cap_pipe_rbuf + pcap_opts->cap_pipe_rbuf_end,
+                      CAP_PIPE_RBUF_SIZE - pcap_opts->cap_pipe_rbuf_end,
+                      pcap_opts->from_cap_socket);
+    if (b == 0) {
+        pcap_opts->cap_pipe_err = PIPEOF;
+        return -1;
+    }
+    if (b < 0) {
+#ifdef _WIN32
+        FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_IGNORE_INSERTS,
+                      NULL, GetLastError(), 0, (LPTSTR) &err_str, 0, NULL);
+        g_snprintf(errmsg, errmsgl,
+                   "Error reading from pipe: %s (error %d)",
+                   utf_16to8(err_str), GetLastError());
+        LocalFree(err_str);
+#else
+        g_snprintf(errmsg, errmsgl, "Error reading from pipe: %s",
+                   g_strerror(errno));
+#endif
+        pcap_opts->cap_pipe_err = PIPERR;
+        return -1;
+    }
+    pcap_opts->cap_pipe_rbuf_end += b;
+
+    hdr_len = pcap_opts->cap_pipe_modified ?
+        sizeof(struct pcaprec_modified_hdr) : sizeof(struct pcaprec_hdr);
+    while (ld->go) {
+        left = pcap_opts->cap_pipe_rbuf_end - pcap_opts->cap_pipe_rbuf_start;
+        if (left < hdr_len)
+            break;
+
+        /* Take care of byte order in a copy of the header, so that it
+           can be looked at again if the data isn't all here yet. */
+        memcpy(&rechdr, pcap_opts->cap_pipe_rbuf + pcap_opts->cap_pipe_rbuf_start,
+               sizeof rechdr);
+        cap_pipe_adjust_header(pcap_opts->cap_pipe_byte_swapped, &pcap_opts->cap_pipe_hdr,
+                               &rechdr);
+        if (rechdr.incl_len > WTAP_MAX_PACKET_SIZE) {
+            g_snprintf(errmsg, errmsgl, "Frame %u too long (%d bytes)",
+                       ld->packet_count+1, rechdr.incl_len);
+            pcap_opts->cap_pipe_err = PIPERR;
+            return -1;
+        }
+        if (left < hdr_len + rechdr.incl_len)
+            break;
+
+        /* Fill in a "struct pcap_pkthdr", and process the packet. */
+        phdr.ts.tv_sec = rechdr.ts_sec;
+        phdr.ts.tv_usec = rechdr.ts_usec;
+        phdr.caplen = rechdr.incl_len;
+        phdr.len = rechdr.orig_len;
+
+        if (use_threads) {
+            capture_loop_queue_packet_cb((u_char *)pcap_opts, &phdr,
+                                         pcap_opts->cap_pipe_rbuf + pcap_opts->cap_pipe_rbuf_start + hdr_len);
+        } else {
+            capture_loop_write_packet_cb((u_char *)pcap_opts, &phdr,
+                                         pcap_opts->cap_pipe_rbuf + pcap_opts->cap_pipe_rbuf_start + hdr_len);
+        }
+        pcap_opts->cap_pipe_rbuf_start += hdr_len + rechdr.incl_len;
+        inpkts++;
+    }
+    return inpkts;
+}
+
+#ifdef _WIN32
+/* We read one record from the pipe through the reader thread, take care
+ * of byte order in the record header, write the record to the capture
+ * file, and update capture statistics. */
+static int
+cap_pipe_dispatch_thread(loop_data *ld, pcap_options *pcap_opts, guchar *data, char *errmsg, int errmsgl)
 {
     struct pcap_pkthdr  phdr;
     enum { PD_REC_HDR_READ, PD_DATA_READ, PD_PIPE_EOF, PD_PIPE_ERR,
            PD_ERR } result;
-#ifdef _WIN32
 #if !GLIB_CHECK_VERSION(2,31,18)
     GTimeVal  wait_time;
 #endif
     gpointer  q_status;
     wchar_t  *err_str;
-#endif
-    ssize_t   b;
 
 #ifdef LOG_CAPTURE_VERBOSE
-    g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG, "cap_pipe_dispatch");
+    g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG, "cap_pipe_dispatch_thread");
 #endif
 
     switch (pcap_opts->cap_pipe_state) {
 
     case STATE_EXPECT_REC_HDR:
-#ifdef _WIN32
         if (g_mutex_trylock(pcap_opts->cap_pipe_read_mtx)) {
-#endif
 
             pcap_opts->cap_pipe_state = STATE_READ_REC_HDR;
             pcap_opts->cap_pipe_bytes_to_read = pcap_opts->cap_pipe_modified ?
                 sizeof(struct pcaprec_modified_hdr) : sizeof(struct pcaprec_hdr);
             pcap_opts->cap_pipe_bytes_read = 0;
 
-#ifdef _WIN32
             pcap_opts->cap_pipe_buf = (char *) &pcap_opts->cap_pipe_rechdr;
             g_async_queue_push(pcap_opts->cap_pipe_pending_q, pcap_opts->cap_pipe_buf);
             g_mutex_unlock(pcap_opts->cap_pipe_read_mtx);
         }
-#endif
         /* Fall through */
 
     case STATE_READ_REC_HDR:
-#ifdef _WIN32
-        if (pcap_opts->from_cap_socket)
-#endif
-        {
-            b = cap_pipe_read(pcap_opts->cap_pipe_fd, ((char *)&pcap_opts->cap_pipe_rechdr)+pcap_opts->cap_pipe_bytes_read,
-                 pcap_opts->cap_pipe_bytes_to_read - pcap_opts->cap_pipe_bytes_read, pcap_opts->from_cap_socket);
-            if (b <= 0) {
-                if (b == 0)
-                    result = PD_PIPE_EOF;
-                else
-                    result = PD_PIPE_ERR;
-                break;
-            }
-            pcap_opts->cap_pipe_bytes_read += b;
-        }
-#ifdef _WIN32
-        else {
 #if GLIB_CHECK_VERSION(2,31,18)
-            q_status = g_async_queue_timeout_pop(pcap_opts->cap_pipe_done_q, PIPE_READ_TIMEOUT);
+        q_status = g_async_queue_timeout_pop(pcap_opts->cap_pipe_done_q, PIPE_READ_TIMEOUT);
 #else
-            g_get_current_time(&wait_time);
-            g_time_val_add(&wait_time, PIPE_READ_TIMEOUT);
-            q_status = g_async_queue_timed_pop(pcap_opts->cap_pipe_done_q, &wait_time);
+        g_get_current_time(&wait_time);
+        g_time_val_add(&wait_time, PIPE_READ_TIMEOUT);
+        q_status = g_async_queue_timed_pop(pcap_opts->cap_pipe_done_q, &wait_time);
 #endif
-            if (pcap_opts->cap_pipe_err == PIPEOF) {
-                result = PD_PIPE_EOF;
-                break;
-            } else if (pcap_opts->cap_pipe_err == PIPERR) {
-                result = PD_PIPE_ERR;
-                break;
-            }
-            if (!q_status) {
-                return 0;
-            }
+        if (pcap_opts->cap_pipe_err == PIPEOF) {
+            result = PD_PIPE_EOF;
+            break;
+        } else if (pcap_opts->cap_pipe_err == PIPERR) {
+            result = PD_PIPE_ERR;
+            break;
+        }
+        if (!q_status) {
+            return 0;
         }
-#endif
         if (pcap_opts->cap_pipe_bytes_read < pcap_opts->cap_pipe_bytes_to_read)
             return 0;
         result = PD_REC_HDR_READ;
         break;
 
     case STATE_EXPECT_DATA:
-#ifdef _WIN32
         if (g_mutex_trylock(pcap_opts->cap_pipe_read_mtx)) {
-#endif
 
             pcap_opts->cap_pipe_state = STATE_READ_DATA;
             pcap_opts->cap_pipe_bytes_to_read = pcap_opts->cap_pipe_rechdr.hdr.incl_len;
             pcap_opts->cap_pipe_bytes_read = 0;
 
-#ifdef _WIN32
             pcap_opts->cap_pipe_buf = (char *) data;
             g_async_queue_push(pcap_opts->cap_pipe_pending_q, pcap_opts->cap_pipe_buf);
             g_mutex_unlock(pcap_opts->cap_pipe_read_mtx);
         }
-#endif
         /* Fall through */
 
     case STATE_READ_DATA:
-#ifdef _WIN32
-        if (pcap_opts->from_cap_socket)
-#endif
-        {
-            b = cap_pipe_read(pcap_opts->cap_pipe_fd,
-                              data+pcap_opts->cap_pipe_bytes_read,
-                              pcap_opts->cap_pipe_bytes_to_read - pcap_opts->cap_pipe_bytes_read,
-                              pcap_opts->from_cap_socket);
-            if (b <= 0) {
-                if (b == 0)
-                    result = PD_PIPE_EOF;
-                else
-                    result = PD_PIPE_ERR;
-                break;
-            }
-            pcap_opts->cap_pipe_bytes_read += b;
-        }
-#ifdef _WIN32
-        else {
-
 #if GLIB_CHECK_VERSION(2,31,18)
-            q_status = g_async_queue_timeout_pop(pcap_opts->cap_pipe_done_q, PIPE_READ_TIMEOUT);
+        q_status = g_async_queue_timeout_pop(pcap_opts->cap_pipe_done_q, PIPE_READ_TIMEOUT);
 #else
-            g_get_current_time(&wait_time);
-            g_time_val_add(&wait_time, PIPE_READ_TIMEOUT);
-            q_status = g_async_queue_timed_pop(pcap_opts->cap_pipe_done_q, &wait_time);
+        g_get_current_time(&wait_time);
+        g_time_val_add(&wait_time, PIPE_READ_TIMEOUT);
+        q_status = g_async_queue_timed_pop(pcap_opts->cap_pipe_done_q, &wait_time);
 #endif /* GLIB_CHECK_VERSION(2,31,18) */
-            if (pcap_opts->cap_pipe_err == PIPEOF) {
-                result = PD_PIPE_EOF;
-                break;
-            } else if (pcap_opts->cap_pipe_err == PIPERR) {
-                result = PD_PIPE_ERR;
-                break;
-            }
-            if (!q_status) {
-                return 0;
-            }
+        if (pcap_opts->cap_pipe_err == PIPEOF) {
+            result = PD_PIPE_EOF;
+            break;
+        } else if (pcap_opts->cap_pipe_err == PIPERR) {
+            result = PD_PIPE_ERR;
+            break;
+        }
+        if (!q_status) {
+            return 0;
         }
-#endif /* _WIN32 */
         if (pcap_opts->cap_pipe_bytes_read < pcap_opts->cap_pipe_bytes_to_read)
             return 0;
         result = PD_DATA_READ;
@@ -2492,17 +2699,12 @@ cap_pipe_dispatch(loop_data *ld, pcap_options *pcap_opts, guchar *data, char *er
         return -1;
 
     case PD_PIPE_ERR:
-#ifdef _WIN32
         FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_IGNORE_INSERTS,
                       NULL, GetLastError(), 0, (LPTSTR) &err_str, 0, NULL);
         g_snprintf(errmsg, errmsgl,
                    "Error reading from pipe: %s (error %d)",
                    utf_16to8(err_str), GetLastError());
         LocalFree(err_str);
-#else
-        g_snprintf(errmsg, errmsgl, "Error reading from pipe: %s",
-                   g_strerror(errno));
-#endif
         /* Fall through */
     case PD_ERR:
         break;
@@ -2512,6 +2714,20 @@ cap_pipe_dispatch(loop_data *ld, pcap_options *pcap_opts, guchar *data, char *er
     /* Return here rather than inside the switch to prevent GCC warning */
     return -1;
 }
+#endif /* _WIN32 */
+
+/* Read and process records from a pipe or socket.  Returns the number of
+   packets processed, or -1 on end of file or error. */
+static int
+cap_pipe_dispatch(loop_data *ld, pcap_options *pcap_opts, guchar *data _U_, char *errmsg, int errmsgl)
+{
+#ifdef _WIN32
+    /* Windows pipes are read by a separate thread, one record at a time. */
+    if (!pcap_opts->from_cap_socket)
+        return cap_pipe_dispatch_thread(ld, pcap_opts, data, errmsg, errmsgl);
+#endif
+    return cap_pipe_dispatch_buffered(ld, pcap_opts, errmsg, errmsgl);
+}
 
 
 /** Open the capture input file (pcap or capture pipe).
@@ -2598,6 +2814,13 @@ capture_loop_open_input(capture_options *capture_opts, loop_data *ld,
         pcap_opts->received = 0;
         pcap_opts->dropped = 0;
         pcap_opts->flushed = 0;
+        pcap_opts->queue_drops = 0;
+        pcap_opts->queue_packets_max = 0;
+        pcap_opts->queue_bytes_max = 0;
+        capture_hist_clear(&pcap_opts->read_batch);
+#ifdef HAVE_TPACKET_V3
+        capture_hist_clear(&pcap_opts->kernel_fill);
+#endif
         pcap_opts->pcap_h = NULL;
 #ifdef MUST_DO_SELECT
         pcap_opts->pcap_fd = -1;
@@ -2625,6 +2848,17 @@ capture_loop_open_input(capture_options *capture_opts, loop_data *ld,
         pcap_opts->cap_pipe_bytes_read = 0;
         pcap_opts->cap_pipe_state = STATE_EXPECT_REC_HDR;
         pcap_opts->cap_pipe_err = PIPOK;
+        pcap_opts->cap_pipe_rbuf = NULL;
+        pcap_opts->cap_pipe_rbuf_start = 0;
+        pcap_opts->cap_pipe_rbuf_end = 0;
+#ifdef HAVE_TPACKET_V3
+        pcap_opts->tpacket = NULL;
+#endif
+        pcap_opts->queue = NULL;
+        pcap_opts->in_merge_heap = FALSE;
+        pcap_opts->truncate.bf_len = 0;
+        pcap_opts->truncate.bf_insns = NULL;
+        pcap_opts->flow_budget = NULL;
 #ifdef _WIN32
 #if GLIB_CHECK_VERSION(2,31,0)
         pcap_opts->cap_pipe_read_mtx = g_malloc(sizeof(GMutex));
@@ -2702,6 +2936,35 @@ capture_loop_open_input(capture_options *capture_opts, loop_data *ld,
                 return FALSE;
             }
             pcap_opts->linktype = get_pcap_linktype(pcap_opts->pcap_h, interface_opts.name);
+
+#ifdef HAVE_TPACKET_V3
+            if (use_tpacket) {
+                /* The ring hands us what the interface saw, which is only
+                   the same as what libpcap would for Ethernet.  We keep
+                   the pcap_t open for the link-layer type, compiling the
+                   capture filter and promiscuous mode, but read from
+                   the ring. */
+                if (pcap_opts->linktype != DLT_EN10MB) {
+                    g_snprintf(errmsg, (gulong) errmsg_len,
+                               "TPACKET_V3 capture is only supported on Ethernet interfaces, and %s isn't one.",
+                               interface_opts.console_display_name);
+                    return FALSE;
+                }
+                pcap_opts->tpacket = tpacket_ring_open(interface_opts.name,
+                                                       interface_opts.has_snaplen ? interface_opts.snaplen : WTAP_MAX_PACKET_SIZE,
+#ifdef HAVE_PCAP_CREATE
+                                                       interface_opts.buffer_size,
+#else
+                                                       DEFAULT_CAPTURE_BUFFER_SIZE,
+#endif
+                                                       tpacket_fanout_group,
+                                                       errmsg, errmsg_len);
+                if (pcap_opts->tpacket == NULL) {
+                    return FALSE;
+                }
+                pcap_opts->ts_nsec = TRUE;
+            }
+#endif
         } else {
             /* We couldn't open "iface" as a network device. */
             /* Try to open it as a pipe */
@@ -2784,12 +3047,29 @@ static void capture_loop_close_input(loop_data *ld)
             cap_pipe_close(pcap_opts->cap_pipe_fd, pcap_opts->from_cap_socket);
             pcap_opts->cap_pipe_fd = -1;
         }
+        g_free(pcap_opts->cap_pipe_rbuf);
+        pcap_opts->cap_pipe_rbuf = NULL;
 #ifdef _WIN32
         if (pcap_opts->cap_pipe_h != INVALID_HANDLE_VALUE) {
             CloseHandle(pcap_opts->cap_pipe_h);
             pcap_opts->cap_pipe_h = INVALID_HANDLE_VALUE;
         }
 #endif
+#ifdef HAVE_TPACKET_V3
+        if (pcap_opts->tpacket != NULL) {
+            tpacket_ring_close(pcap_opts->tpacket);
+            pcap_opts->tpacket = NULL;
+        }
+#endif
+        if (pcap_opts->queue != NULL) {
+            packet_ring_free(pcap_opts->queue);
+            pcap_opts->queue = NULL;
+        }
+        if (pcap_opts->truncate.bf_insns != NULL) {
+            capture_truncate_free(&pcap_opts->truncate);
+        }
+        capture_flow_budget_free(pcap_opts->flow_budget);
+        pcap_opts->flow_budget = NULL;
         /* if open, close the pcap "input file" */
         if (pcap_opts->pcap_h != NULL) {
             g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG, "capture_loop_close_input: closing %p", (void *)pcap_opts->pcap_h);
@@ -2809,15 +3089,24 @@ static void capture_loop_close_input(loop_data *ld)
 
 /* init the capture filter */
 static initfilter_status_t
-capture_loop_init_filter(pcap_t *pcap_h, gboolean from_cap_pipe,
+capture_loop_init_filter(pcap_options *pcap_opts,
                          const gchar * name, const gchar * cfilter)
 {
+    pcap_t            *pcap_h = pcap_opts->pcap_h;
     struct bpf_program fcode;
+    struct bpf_program chained;
+    struct bpf_program *installed;
+    gboolean           ok;
+#ifdef HAVE_TPACKET_V3
+    struct bpf_insn    reject_all = BPF_STMT(BPF_RET | BPF_K, 0);
+    struct bpf_program reject_code;
+    char               errmsg[MSG_MAX_LENGTH+1];
+#endif
 
     g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG, "capture_loop_init_filter: %s", cfilter);
 
     /* capture filters only work on real interfaces */
-    if (cfilter && !from_cap_pipe) {
+    if (cfilter && !pcap_opts->from_cap_pipe) {
         /* A capture filter was specified; set it up. */
         if (!compile_capture_filter(name, pcap_h, &fcode, cfilter)) {
             /* Treat this specially - our caller might try to compile this
@@ -2825,21 +3114,82 @@ capture_loop_init_filter(pcap_t *pcap_h, gboolean from_cap_pipe,
                the display and capture filter syntaxes are different. */
             return INITFILTER_BAD_FILTER;
         }
-        if (pcap_setfilter(pcap_h, &fcode) < 0) {
+
+        /* If there are truncation rules, try to have them done along
+           with the filter; if that can't be done, they're only done when
+           we get the packets. */
+        chained.bf_insns = NULL;
+        if (pcap_opts->truncate.bf_insns != NULL)
+            capture_truncate_chain(&fcode, &pcap_opts->truncate, &chained);
+        installed = chained.bf_insns != NULL ? &chained : &fcode;
+#ifdef HAVE_TPACKET_V3
+        if (pcap_opts->tpacket != NULL) {
+            /* The filter goes on the ring, and the pcap_t, which we don't
+               read from, gets one that keeps anything from piling up in
+               it. */
+            ok = tpacket_ring_set_filter(pcap_opts->tpacket, installed,
+                                         errmsg, sizeof errmsg);
+            if (!ok && installed == &chained) {
+                ok = tpacket_ring_set_filter(pcap_opts->tpacket, &fcode,
+                                             errmsg, sizeof errmsg);
+            }
+            if (chained.bf_insns != NULL)
+                capture_truncate_free(&chained);
 #ifdef HAVE_PCAP_FREECODE
             pcap_freecode(&fcode);
 #endif
-            return INITFILTER_OTHER_ERROR;
+            if (!ok) {
+                g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_WARNING, "%s", errmsg);
+                return INITFILTER_OTHER_ERROR;
+            }
+            reject_code.bf_len = 1;
+            reject_code.bf_insns = &reject_all;
+            if (pcap_setfilter(pcap_h, &reject_code) < 0) {
+                return INITFILTER_OTHER_ERROR;
+            }
+            return INITFILTER_NO_ERROR;
+        }
+#endif
+        ok = pcap_setfilter(pcap_h, installed) == 0;
+        if (!ok && installed == &chained) {
+            /* e.g. too long for the kernel */
+            ok = pcap_setfilter(pcap_h, &fcode) == 0;
         }
+        if (chained.bf_insns != NULL)
+            capture_truncate_free(&chained);
 #ifdef HAVE_PCAP_FREECODE
         pcap_freecode(&fcode);
 #endif
+        if (!ok) {
+            return INITFILTER_OTHER_ERROR;
+        }
     }
 
     return INITFILTER_NO_ERROR;
 }
 
 
+/* get the statistics of a network interface, from the ring we're reading
+   from if there is one */
+static int
+capture_loop_get_stats(pcap_options *pcap_opts, struct pcap_stat *stats)
+{
+#ifdef HAVE_TPACKET_V3
+    guint32 received, dropped;
+
+    if (pcap_opts->tpacket != NULL) {
+        if (!tpacket_ring_stats(pcap_opts->tpacket, &received, &dropped))
+            return -1;
+        stats->ps_recv = received;
+        stats->ps_drop = dropped;
+        stats->ps_ifdrop = 0;
+        return 0;
+    }
+#endif
+    return pcap_stats(pcap_opts->pcap_h, stats);
+}
+
+
 /* set up to write to the already-opened capture output file/files */
 static gboolean
 capture_loop_init_output(capture_options *capture_opts, loop_data *ld, char *errmsg, int errmsg_len)
@@ -2863,10 +3213,7 @@ capture_loop_init_output(capture_options *capture_opts, loop_data *ld, char *err
     if (capture_opts->multi_files_on) {
         ld->pdh = ringbuf_init_libpcap_fdopen(&err);
     } else {
-        ld->pdh = ws_fdopen(ld->save_file_fd, "wb");
-        if (ld->pdh == NULL) {
-            err = errno;
-        }
+        ld->pdh = pcapio_fdopen(ld->save_file_fd, &err);
     }
     if (ld->pdh) {
         if (capture_opts->use_pcapng) {
@@ -2922,7 +3269,9 @@ capture_loop_init_output(capture_options *capture_opts, loop_data *ld, char *err
                                                    pcap_opts->ts_nsec, &ld->bytes_written, &err);
         }
         if (!successful) {
-            fclose(ld->pdh);
+            int close_err;
+
+            pcapio_close(ld->pdh, &close_err);
             ld->pdh = NULL;
         }
     }
@@ -2953,6 +3302,77 @@ capture_loop_init_output(capture_options *capture_opts, loop_data *ld, char *err
     return TRUE;
 }
 
+/* Append the statistics for an interface to str as name=value pairs;
+   stats is what the kernel or libpcap counted, or NULL if that isn't
+   known. */
+static void
+capture_loop_format_stats(GString *str, pcap_options *pcap_opts, const struct pcap_stat *stats)
+{
+    g_string_append_printf(str, "interface=%u received=%u", pcap_opts->interface_id,
+                           pcap_opts->received);
+    if (stats != NULL)
+        g_string_append_printf(str, " kernel_drops=%u if_drops=%u", stats->ps_drop, stats->ps_ifdrop);
+    g_string_append_printf(str, " queue_drops=%u write_drops=%u flushed=%u"
+                           " queue_packets_max=%u queue_bytes_max=%u ",
+                           pcap_opts->queue_drops, pcap_opts->dropped - pcap_opts->queue_drops,
+                           pcap_opts->flushed, pcap_opts->queue_packets_max,
+                           pcap_opts->queue_bytes_max);
+    capture_hist_format(str, "read_batch", &pcap_opts->read_batch);
+#ifdef HAVE_TPACKET_V3
+    if (pcap_opts->tpacket != NULL) {
+        g_string_append_c(str, ' ');
+        capture_hist_format(str, "kernel_ring_pct", &pcap_opts->kernel_fill);
+    }
+#endif
+}
+
+/* Append the statistics that aren't for any one interface to str */
+static void
+capture_loop_format_global_stats(GString *str)
+{
+    g_string_append_printf(str, "packets=%d bytes_written=%" G_GINT64_MODIFIER "u ",
+                           global_ld.packet_count, global_ld.bytes_written);
+    capture_hist_format(str, "write_us", &write_latency);
+    g_string_append_c(str, ' ');
+    capture_hist_format(str, "switch_us", &switch_latency);
+}
+
+/* Write an interface statistics block for interface i, with the standard
+   counters as options and all of ours in the comment. */
+static gboolean
+capture_loop_write_stats_block(loop_data *ld, guint i, pcap_options *pcap_opts,
+                               const struct pcap_stat *stats, guint64 end_time, int *err)
+{
+    guint64   isb_ifrecv, isb_ifdrop, isb_osdrop;
+    GString  *comment;
+    gboolean  successful;
+
+    if (stats != NULL) {
+        isb_ifrecv = pcap_opts->received;
+        isb_ifdrop = stats->ps_drop + pcap_opts->dropped + pcap_opts->flushed;
+        isb_osdrop = stats->ps_drop;
+    } else {
+        isb_ifrecv = G_MAXUINT64;
+        isb_ifdrop = G_MAXUINT64;
+        isb_osdrop = G_MAXUINT64;
+    }
+    comment = g_string_new("Counters provided by dumpcap\n");
+    capture_loop_format_stats(comment, pcap_opts, stats);
+    successful = pcapng_write_interface_statistics_block(ld->pdh,
+                                                         i,
+                                                         &ld->bytes_written,
+                                                         comment->str,
+                                                         start_time,
+                                                         end_time,
+                                                         isb_ifrecv,
+                                                         isb_ifdrop,
+                                                         isb_osdrop,
+                                                         pcap_opts->received,
+                                                         err);
+    g_string_free(comment, TRUE);
+    return successful;
+}
+
 static gboolean
 capture_loop_close_output(capture_options *capture_opts, loop_data *ld, int *err_close)
 {
@@ -2960,6 +3380,7 @@ capture_loop_close_output(capture_options *capture_opts, loop_data *ld, int *err
     unsigned int  i;
     pcap_options *pcap_opts;
     guint64       end_time = create_timestamp();
+    int           close_err;
 
     g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG, "capture_loop_close_output");
 
@@ -2970,36 +3391,19 @@ capture_loop_close_output(capture_options *capture_opts, loop_data *ld, int *err
             for (i = 0; i < global_ld.pcaps->len; i++) {
                 pcap_opts = g_array_index(global_ld.pcaps, pcap_options *, i);
                 if (!pcap_opts->from_cap_pipe) {
-                    guint64 isb_ifrecv, isb_ifdrop;
                     struct pcap_stat stats;
 
-                    if (pcap_stats(pcap_opts->pcap_h, &stats) >= 0) {
-                        isb_ifrecv = pcap_opts->received;
-                        isb_ifdrop = stats.ps_drop + pcap_opts->dropped + pcap_opts->flushed;
-                   } else {
-                        isb_ifrecv = G_MAXUINT64;
-                        isb_ifdrop = G_MAXUINT64;
-                    }
-                    pcapng_write_interface_statistics_block(ld->pdh,
-                                                            i,
-                                                            &ld->bytes_written,
-                                                            "Counters provided by dumpcap",
-                                                            start_time,
-                                                            end_time,
-                                                            isb_ifrecv,
-                                                            isb_ifdrop,
-                                                            err_close);
+                    capture_loop_write_stats_block(ld, i, pcap_opts,
+                                                   capture_loop_get_stats(pcap_opts, &stats) >= 0 ? &stats : NULL,
+                                                   end_time, err_close);
                 }
             }
         }
-        if (fclose(ld->pdh) == EOF) {
-            if (err_close != NULL) {
-                *err_close = errno;
-            }
+        if (sync_on_close && !pcapio_sync(ld->pdh, err_close)) {
+            pcapio_close(ld->pdh, &close_err);
             return (FALSE);
-        } else {
-            return (TRUE);
         }
+        return pcapio_close(ld->pdh, err_close);
     }
 }
 
@@ -3018,7 +3422,7 @@ static int
 capture_loop_dispatch(loop_data *ld,
                       char *errmsg, int errmsg_len, pcap_options *pcap_opts)
 {
-    int    inpkts;
+    int    inpkts = 0;
     gint   packet_count_before;
     guchar pcap_data[WTAP_MAX_PACKET_SIZE];
 #ifndef _WIN32
@@ -3053,6 +3457,25 @@ capture_loop_dispatch(loop_data *ld,
         }
 #endif
     }
+#ifdef HAVE_TPACKET_V3
+    else if (pcap_opts->tpacket != NULL)
+    {
+        /* dispatch from a TPACKET_V3 ring; the writing callback gets the
+           packets straight out of the ring's blocks */
+        inpkts = tpacket_ring_dispatch(pcap_opts->tpacket, CAP_READ_TIMEOUT,
+                                       use_threads ? capture_loop_queue_packet_cb : capture_loop_write_packet_cb,
+                                       (u_char *)pcap_opts, errmsg, errmsg_len);
+        if (inpkts < 0) {
+            report_capture_error(errmsg, "");
+            ld->go = FALSE;
+        } else if (inpkts > 0) {
+            guint ready, total;
+
+            tpacket_ring_fill(pcap_opts->tpacket, &ready, &total);
+            capture_hist_add(&pcap_opts->kernel_fill, (guint64)ready * 100 / total);
+        }
+    }
+#endif
     else
     {
         /* dispatch from pcap */
@@ -3183,6 +3606,9 @@ capture_loop_dispatch(loop_data *ld,
 #ifdef LOG_CAPTURE_VERBOSE
     g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG, "capture_loop_dispatch: %d new packet%s", inpkts, plurality(inpkts, "", "s"));
 #endif
+    /* how many packets had piled up since the last read */
+    if (inpkts > 0)
+        capture_hist_add(&pcap_opts->read_batch, (guint64)inpkts);
 
     return ld->packet_count - packet_count_before;
 }
@@ -3254,9 +3680,17 @@ capture_loop_open_output(capture_options *capture_opts, int *save_file_fd,
         else {
             if (capture_opts->multi_files_on) {
                 /* ringbuffer is enabled */
+                ringbuf_set_post_processing(ring_compression, ring_index,
+                                            capture_opts->use_pcapng ? WTAP_FILE_TYPE_SUBTYPE_PCAPNG :
+                                            (global_ld.pcaps->len != 0 &&
+                                             g_array_index(global_ld.pcaps, pcap_options *, 0)->ts_nsec) ?
+                                            WTAP_FILE_TYPE_SUBTYPE_PCAP_NSEC : WTAP_FILE_TYPE_SUBTYPE_PCAP,
+                                            ring_compress_threads);
                 *save_file_fd = ringbuf_init(capfile_name,
                                              (capture_opts->has_ring_num_files) ? capture_opts->ring_num_files : 0,
-                                             capture_opts->group_read_access);
+                                             capture_opts->group_read_access,
+                                             (capture_opts->has_autostop_filesize) ? (guint64)capture_opts->autostop_filesize * 1000 : 0,
+                                             sync_on_close);
 
                 /* we need the ringbuf name */
                 if (*save_file_fd != -1) {
@@ -3348,6 +3782,8 @@ do_file_switch_or_stop(capture_options *capture_opts,
     pcap_options      *pcap_opts;
     interface_options  interface_opts;
     gboolean           successful;
+    gboolean           switched;
+    guint64            switch_start;
 
     if (capture_opts->multi_files_on) {
         if (cnd_autostop_files != NULL &&
@@ -3358,8 +3794,11 @@ do_file_switch_or_stop(capture_options *capture_opts,
         }
 
         /* Switch to the next ringbuffer file */
-        if (ringbuf_switch_file(&global_ld.pdh, &capture_opts->save_file,
-                                &global_ld.save_file_fd, &global_ld.err)) {
+        switch_start = create_timestamp();
+        switched = ringbuf_switch_file(&global_ld.pdh, &capture_opts->save_file,
+                                       &global_ld.save_file_fd, &global_ld.err);
+        capture_hist_add(&switch_latency, elapsed_since(switch_start));
+        if (switched) {
 
             /* File switch succeeded: reset the conditions */
             global_ld.bytes_written = 0;
@@ -3406,7 +3845,9 @@ do_file_switch_or_stop(capture_options *capture_opts,
                                                        pcap_opts->ts_nsec, &global_ld.bytes_written, &global_ld.err);
             }
             if (!successful) {
-                fclose(global_ld.pdh);
+                int close_err;
+
+                pcapio_close(global_ld.pdh, &close_err);
                 global_ld.pdh = NULL;
                 global_ld.go = FALSE;
                 return FALSE;
@@ -3454,6 +3895,167 @@ pcap_read_handler(void* arg)
     return (NULL);
 }
 
+/* Write up to WRITER_THREAD_BATCH packets from each interface's packet
+   ring; returns the number written. */
+static int
+capture_loop_write_queued(void)
+{
+    pcap_options *pcap_opts;
+    guint         i;
+    int           inpkts = 0;
+
+    for (i = 0; i < global_ld.pcaps->len; i++) {
+        pcap_opts = g_array_index(global_ld.pcaps, pcap_options *, i);
+        inpkts += packet_ring_get(pcap_opts->queue, WRITER_THREAD_BATCH,
+                                  capture_loop_write_packet_cb,
+                                  (u_char *)pcap_opts);
+    }
+    return inpkts;
+}
+
+/* Time stamp of a packet, in nanoseconds */
+static guint64
+capture_loop_packet_time(pcap_options *pcap_opts, const struct pcap_pkthdr *phdr)
+{
+    return (guint64)phdr->ts.tv_sec * 1000000000 +
+           (pcap_opts->ts_nsec ? (guint64)phdr->ts.tv_usec : (guint64)phdr->ts.tv_usec * 1000);
+}
+
+static void
+merge_heap_sift_up(guint i)
+{
+    pcap_options *pcap_opts = merge_heap[i];
+    guint         parent;
+
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (merge_heap[parent]->merge_time <= pcap_opts->merge_time)
+            break;
+        merge_heap[i] = merge_heap[parent];
+        i = parent;
+    }
+    merge_heap[i] = pcap_opts;
+}
+
+static void
+merge_heap_sift_down(guint i)
+{
+    pcap_options *pcap_opts = merge_heap[i];
+    guint         child;
+
+    while ((child = 2 * i + 1) < merge_heap_len) {
+        if (child + 1 < merge_heap_len &&
+            merge_heap[child + 1]->merge_time < merge_heap[child]->merge_time)
+            child++;
+        if (pcap_opts->merge_time <= merge_heap[child]->merge_time)
+            break;
+        merge_heap[i] = merge_heap[child];
+        i = child;
+    }
+    merge_heap[i] = pcap_opts;
+}
+
+/* Write the packets from the packet rings that are ready to go out, in
+   time stamp order, or all of them if flush is TRUE; returns the number
+   written. */
+static int
+capture_loop_write_ordered(gboolean flush)
+{
+    pcap_options             *pcap_opts;
+    const struct pcap_pkthdr *phdr;
+    guint64                   now;
+    guint                     i;
+    int                       inpkts = 0;
+
+    if (merge_heap == NULL)
+        merge_heap = g_new(pcap_options *, global_ld.pcaps->len);
+
+    /* add the interfaces whose rings have had packets put in them */
+    for (i = 0; i < global_ld.pcaps->len; i++) {
+        pcap_opts = g_array_index(global_ld.pcaps, pcap_options *, i);
+        if (!pcap_opts->in_merge_heap &&
+            (phdr = packet_ring_peek(pcap_opts->queue)) != NULL) {
+            pcap_opts->merge_time = capture_loop_packet_time(pcap_opts, phdr);
+            if (pcap_opts->merge_time > merge_newest)
+                merge_newest = pcap_opts->merge_time;
+            pcap_opts->in_merge_heap = TRUE;
+            merge_heap[merge_heap_len++] = pcap_opts;
+            merge_heap_sift_up(merge_heap_len - 1);
+        }
+    }
+
+    now = MAX(create_timestamp() * 1000, merge_newest);
+    while (merge_heap_len != 0 &&
+           inpkts < (int)(WRITER_THREAD_BATCH * global_ld.pcaps->len)) {
+        pcap_opts = merge_heap[0];
+        if (!flush && merge_heap_len < global_ld.pcaps->len &&
+            pcap_opts->merge_time + (guint64)merge_window * 1000000 > now)
+            break;
+        inpkts += packet_ring_get(pcap_opts->queue, 1,
+                                  capture_loop_write_packet_cb,
+                                  (u_char *)pcap_opts);
+        phdr = packet_ring_peek(pcap_opts->queue);
+        if (phdr != NULL) {
+            pcap_opts->merge_time = capture_loop_packet_time(pcap_opts, phdr);
+            if (pcap_opts->merge_time > merge_newest)
+                merge_newest = pcap_opts->merge_time;
+        } else {
+            pcap_opts->in_merge_heap = FALSE;
+            merge_heap[0] = merge_heap[--merge_heap_len];
+        }
+        if (merge_heap_len != 0)
+            merge_heap_sift_down(0);
+    }
+    return inpkts;
+}
+
+/* Wait up to WRITER_THREAD_TIMEOUT for a packet to be put in an empty
+   packet ring, or, with --merge-window, in one that has no packets held
+   back in merge_heap. */
+static void
+capture_loop_wait_queued(void)
+{
+    pcap_options *pcap_opts;
+    guint         i, packets, bytes;
+    glong         timeout = WRITER_THREAD_TIMEOUT;
+#if GLIB_CHECK_VERSION(2,31,18)
+    gint64        end_time;
+#else
+    GTimeVal      end_time;
+#endif
+
+    /* don't hold back packets much longer than the merge window */
+    if (merge_heap_len != 0 && (glong)merge_window * 1000 < timeout)
+        timeout = (glong)merge_window * 1000;
+#if GLIB_CHECK_VERSION(2,31,18)
+    end_time = g_get_monotonic_time() + timeout;
+#else
+    g_get_current_time(&end_time);
+    g_time_val_add(&end_time, timeout);
+#endif
+
+    g_mutex_lock(pcap_queue_mtx);
+    g_atomic_int_set(&pcap_queue_waiting, 1);
+    /* A packet put in before the flag was set has to be seen here. */
+    for (i = 0; i < global_ld.pcaps->len; i++) {
+        pcap_opts = g_array_index(global_ld.pcaps, pcap_options *, i);
+        if (pcap_opts->in_merge_heap)
+            continue;
+        packet_ring_fill(pcap_opts->queue, &packets, &bytes);
+        if (packets != 0)
+            break;
+    }
+    if (i == global_ld.pcaps->len) {
+#if GLIB_CHECK_VERSION(2,31,18)
+        g_cond_wait_until(pcap_queue_cond, pcap_queue_mtx, end_time);
+#else
+        g_cond_timed_wait(pcap_queue_cond, pcap_queue_mtx, &end_time);
+#endif
+    }
+    g_atomic_int_set(&pcap_queue_waiting, 0);
+    g_mutex_unlock(pcap_queue_mtx);
+}
+
 /* Do the low-level work of a capture.
    Returns TRUE if it succeeds, FALSE otherwise. */
 static gboolean
@@ -3464,6 +4066,8 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
 #else
     struct timeval     upd_time, cur_time;
 #endif
+    guint64            sync_time;
+    guint64            stats_time;
     int                err_close;
     int                inpkts;
     condition         *cnd_file_duration     = NULL;
@@ -3512,13 +4116,32 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
     for (i = 0; i < capture_opts->ifaces->len; i++) {
         pcap_opts = g_array_index(global_ld.pcaps, pcap_options *, i);
         interface_opts = g_array_index(capture_opts->ifaces, interface_options, i);
+        /* compile the truncation rules for the interface's link-layer type */
+        if (truncate_rules != NULL &&
+            !capture_truncate_compile(truncate_rules, pcap_opts->linktype,
+                                      pcap_opts->from_cap_pipe ? (int)pcap_opts->cap_pipe_hdr.snaplen :
+                                                                 pcap_snapshot(pcap_opts->pcap_h),
+                                      &pcap_opts->truncate, errmsg, sizeof(errmsg))) {
+            goto error;
+        }
+        if (flow_budget_bytes != 0 || flow_budget_packets != 0) {
+            pcap_opts->flow_budget = capture_flow_budget_new(pcap_opts->linktype,
+                                                             flow_budget_bytes,
+                                                             flow_budget_packets);
+            if (pcap_opts->flow_budget == NULL) {
+                g_snprintf(errmsg, sizeof(errmsg),
+                           "Flows can't be found in packets from interface '%s', so --flow-budget can't be used with it.",
+                           interface_opts.name);
+                goto error;
+            }
+        }
         /* init the input filter from the network interface (capture pipe will do nothing) */
         /*
          * When remote capturing WinPCap crashes when the capture filter
          * is NULL. This might be a bug in WPCap. Therefore we provide an empty
          * string.
          */
-        switch (capture_loop_init_filter(pcap_opts->pcap_h, pcap_opts->from_cap_pipe,
+        switch (capture_loop_init_filter(pcap_opts,
                                          interface_opts.name,
                                          interface_opts.cfilter?interface_opts.cfilter:"")) {
 
@@ -3539,6 +4162,28 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
         }
     }
 
+    /* start the tee sinks; they all get pcap files, so every interface
+       must have the same link-layer type */
+    if (tee_sinks != NULL) {
+        pcap_opts = g_array_index(global_ld.pcaps, pcap_options *, 0);
+        for (i = 1; i < global_ld.pcaps->len; i++) {
+            if (g_array_index(global_ld.pcaps, pcap_options *, i)->linktype != pcap_opts->linktype) {
+                g_snprintf(errmsg, sizeof(errmsg),
+                           "--tee can only be used if all the interfaces have the same link-layer type.");
+                goto error;
+            }
+        }
+        for (i = 0; i < tee_sinks->len; i++) {
+            if (!capture_tee_start((tee_sink *)g_ptr_array_index(tee_sinks, i),
+                                   pcap_opts->linktype,
+                                   pcap_opts->from_cap_pipe ? (int)pcap_opts->cap_pipe_hdr.snaplen :
+                                                              pcap_snapshot(pcap_opts->pcap_h),
+                                   pcap_opts->ts_nsec, errmsg, sizeof(errmsg))) {
+                goto error;
+            }
+        }
+    }
+
     /* If we're supposed to write to a capture file, open it for output
        (temporary/specified name/ringbuffer) */
     if (capture_opts->saving_to_file) {
@@ -3601,14 +4246,28 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
     gettimeofday(&upd_time, NULL);
 #endif
     start_time = create_timestamp();
+    sync_time = start_time;
+    stats_time = start_time;
     g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO, "Capture loop running.");
 
     /* WOW, everything is prepared! */
     /* please fasten your seat belts, we will enter now the actual capture loop */
     if (use_threads) {
-        pcap_queue = g_async_queue_new();
-        pcap_queue_bytes = 0;
-        pcap_queue_packets = 0;
+#if GLIB_CHECK_VERSION(2,31,0)
+        pcap_queue_mtx = g_new(GMutex, 1);
+        g_mutex_init(pcap_queue_mtx);
+        pcap_queue_cond = g_new(GCond, 1);
+        g_cond_init(pcap_queue_cond);
+#else
+        pcap_queue_mtx = g_mutex_new();
+        pcap_queue_cond = g_cond_new();
+#endif
+        pcap_queue_waiting = 0;
+        for (i = 0; i < global_ld.pcaps->len; i++) {
+            pcap_opts = g_array_index(global_ld.pcaps, pcap_options *, i);
+            pcap_opts->queue = packet_ring_new((guint)pcap_queue_packet_limit,
+                                               (guint)pcap_queue_byte_limit);
+        }
         for (i = 0; i < global_ld.pcaps->len; i++) {
             pcap_opts = g_array_index(global_ld.pcaps, pcap_options *, i);
 #if GLIB_CHECK_VERSION(2,31,0)
@@ -3622,38 +4281,12 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
     while (global_ld.go) {
         /* dispatch incoming packets */
         if (use_threads) {
-            pcap_queue_element *queue_element;
-#if GLIB_CHECK_VERSION(2,31,18)
-
-            g_async_queue_lock(pcap_queue);
-            queue_element = (pcap_queue_element *)g_async_queue_timeout_pop_unlocked(pcap_queue, WRITER_THREAD_TIMEOUT);
-#else
-            GTimeVal write_thread_time;
-
-            g_get_current_time(&write_thread_time);
-            g_time_val_add(&write_thread_time, WRITER_THREAD_TIMEOUT);
-            g_async_queue_lock(pcap_queue);
-            queue_element = (pcap_queue_element *)g_async_queue_timed_pop_unlocked(pcap_queue, &write_thread_time);
-#endif
-            if (queue_element) {
-                pcap_queue_bytes -= queue_element->phdr.caplen;
-                pcap_queue_packets -= 1;
-            }
-            g_async_queue_unlock(pcap_queue);
-            if (queue_element) {
-                g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
-                      "Dequeued a packet of length %d captured on interface %d.",
-                      queue_element->phdr.caplen, queue_element->pcap_opts->interface_id);
-
-                capture_loop_write_packet_cb((u_char *) queue_element->pcap_opts,
-                                             &queue_element->phdr,
-                                             queue_element->pd);
-                g_free(queue_element->pd);
-                g_free(queue_element);
-                inpkts = 1;
-            } else {
-                inpkts = 0;
-            }
+            if (merge_window != 0)
+                inpkts = capture_loop_write_ordered(FALSE);
+            else
+                inpkts = capture_loop_write_queued();
+            if (inpkts == 0)
+                capture_loop_wait_queued();
         } else {
             pcap_opts = g_array_index(global_ld.pcaps, pcap_options *, 0);
             inpkts = capture_loop_dispatch(&global_ld, errmsg,
@@ -3726,6 +4359,23 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
                 global_ld.inpkts_to_sync_pipe = 0;
             }
 
+            /* sync the capture file to disk if it's time to */
+            if (sync_interval != 0 && global_ld.pdh != NULL &&
+                create_timestamp() - sync_time >= (guint64)sync_interval * 1000000) {
+                sync_time = create_timestamp();
+                if (!pcapio_sync(global_ld.pdh, &global_ld.err)) {
+                    global_ld.go = FALSE;
+                    continue;
+                }
+            }
+
+            /* report statistics if it's time to */
+            if (stats_interval != 0 &&
+                create_timestamp() - stats_time >= (guint64)stats_interval * 1000000) {
+                stats_time = create_timestamp();
+                report_capture_stats(capture_opts);
+            }
+
             /* check capture duration condition */
             if (cnd_autostop_duration != NULL && cnd_eval(cnd_autostop_duration)) {
                 /* The maximum capture time has elapsed; stop the capture. */
@@ -3745,8 +4395,6 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
 
     g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO, "Capture loop stopping ...");
     if (use_threads) {
-        pcap_queue_element *queue_element;
-
         for (i = 0; i < global_ld.pcaps->len; i++) {
             pcap_opts = g_array_index(global_ld.pcaps, pcap_options *, i);
             g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO, "Waiting for thread of interface %u...",
@@ -3755,32 +4403,36 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
             g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO, "Thread of interface %u terminated.",
                   pcap_opts->interface_id);
         }
-        while (1) {
-            g_async_queue_lock(pcap_queue);
-            queue_element = (pcap_queue_element *)g_async_queue_try_pop_unlocked(pcap_queue);
-            if (queue_element) {
-                pcap_queue_bytes -= queue_element->phdr.caplen;
-                pcap_queue_packets -= 1;
-            }
-            g_async_queue_unlock(pcap_queue);
-            if (queue_element == NULL) {
-                break;
-            }
-            g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
-                  "Dequeued a packet of length %d captured on interface %d.",
-                  queue_element->phdr.caplen, queue_element->pcap_opts->interface_id);
-            capture_loop_write_packet_cb((u_char *)queue_element->pcap_opts,
-                                         &queue_element->phdr,
-                                         queue_element->pd);
-            g_free(queue_element->pd);
-            g_free(queue_element);
-            global_ld.inpkts_to_sync_pipe += 1;
+        while ((inpkts = merge_window != 0 ? capture_loop_write_ordered(TRUE)
+                                           : capture_loop_write_queued()) > 0) {
+            global_ld.inpkts_to_sync_pipe += inpkts;
             if (capture_opts->output_to_pipe) {
                 fflush(global_ld.pdh);
             }
         }
+        g_free(merge_heap);
+        merge_heap = NULL;
+        merge_heap_len = 0;
+#if GLIB_CHECK_VERSION(2,31,0)
+        g_cond_clear(pcap_queue_cond);
+        g_free(pcap_queue_cond);
+        g_mutex_clear(pcap_queue_mtx);
+        g_free(pcap_queue_mtx);
+#else
+        g_cond_free(pcap_queue_cond);
+        g_mutex_free(pcap_queue_mtx);
+#endif
     }
 
+    /* every packet has been handed to the tee sinks; let them finish */
+    if (tee_sinks != NULL) {
+        for (i = 0; i < tee_sinks->len; i++) {
+            if (!capture_tee_stop((tee_sink *)g_ptr_array_index(tee_sinks, i),
+                                  errmsg, sizeof(errmsg))) {
+                g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_WARNING, "%s", errmsg);
+            }
+        }
+    }
 
     /* delete stop conditions */
     if (cnd_file_duration != NULL)
@@ -3890,7 +4542,7 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
              * platforms; initialize it to 0 to handle that.
              */
             stats->ps_ifdrop = 0;
-            if (pcap_stats(pcap_opts->pcap_h, stats) >= 0) {
+            if (capture_loop_get_stats(pcap_opts, stats) >= 0) {
                 *stats_known = TRUE;
                 /* Let the parent process know. */
                 pcap_dropped += stats->ps_drop;
@@ -3931,6 +4583,15 @@ error:
         }
     }
     capture_opts->save_file = NULL;
+    if (tee_sinks != NULL) {
+        char tee_errmsg[MSG_MAX_LENGTH+1];
+
+        /* errmsg says what went wrong; that's what gets reported */
+        for (i = 0; i < tee_sinks->len; i++) {
+            capture_tee_stop((tee_sink *)g_ptr_array_index(tee_sinks, i),
+                             tee_errmsg, sizeof(tee_errmsg));
+        }
+    }
     if (cfilter_error)
         report_cfilter_error(capture_opts, error_index, errmsg);
     else
@@ -4007,6 +4668,44 @@ capture_loop_get_errmsg(char *errmsg, int errmsglen, const char *fname,
 }
 
 
+/* apply the truncation rules to a packet; returns the header to use,
+   which is phdr if it's not to be truncated and truncated_hdr if it is */
+static const struct pcap_pkthdr *
+capture_loop_truncate_packet(pcap_options *pcap_opts, const struct pcap_pkthdr *phdr,
+                             const u_char *pd, struct pcap_pkthdr *truncated_hdr)
+{
+    guint keep;
+
+    /* If the kernel already did it, this finds nothing more to do */
+    keep = capture_truncate_length(&pcap_opts->truncate, pd, phdr->len, phdr->caplen);
+    if (keep == phdr->caplen)
+        return phdr;
+    *truncated_hdr = *phdr;
+    truncated_hdr->caplen = keep;
+    return truncated_hdr;
+}
+
+/* apply the flow budget to a packet; returns the header to use, which is
+   phdr if all of it is to be kept and truncated_hdr if only some of it is,
+   or NULL if it's to be dropped */
+static const struct pcap_pkthdr *
+capture_loop_budget_packet(pcap_options *pcap_opts, const struct pcap_pkthdr *phdr,
+                           const u_char *pd, struct pcap_pkthdr *truncated_hdr)
+{
+    guint keep;
+
+    keep = capture_flow_budget_length(pcap_opts->flow_budget, pd, phdr->len,
+                                      phdr->caplen, phdr->ts.tv_sec);
+    if (keep == 0)
+        return NULL;
+    if (keep == phdr->caplen)
+        return phdr;
+    if (phdr != truncated_hdr)
+        *truncated_hdr = *phdr;
+    truncated_hdr->caplen = keep;
+    return truncated_hdr;
+}
+
 /* one packet was captured, process it */
 static void
 capture_loop_write_packet_cb(u_char *pcap_opts_p, const struct pcap_pkthdr *phdr,
@@ -4015,6 +4714,7 @@ capture_loop_write_packet_cb(u_char *pcap_opts_p, const struct pcap_pkthdr *phdr
     pcap_options *pcap_opts = (pcap_options *) (void *) pcap_opts_p;
     int           err;
     guint         ts_mul    = pcap_opts->ts_nsec ? 1000000000 : 1000000;
+    struct pcap_pkthdr truncated_hdr;
 
     /* We may be called multiple times from pcap_dispatch(); if we've set
        the "stop capturing" flag, ignore this packet, as we're not
@@ -4024,8 +4724,28 @@ capture_loop_write_packet_cb(u_char *pcap_opts_p, const struct pcap_pkthdr *phdr
         return;
     }
 
+    /* Packets taken from an interface's ring were truncated when they
+       were put there. */
+    if (pcap_opts->truncate.bf_insns != NULL && !use_threads)
+        phdr = capture_loop_truncate_packet(pcap_opts, phdr, pd, &truncated_hdr);
+    if (pcap_opts->flow_budget != NULL && !use_threads) {
+        phdr = capture_loop_budget_packet(pcap_opts, phdr, pd, &truncated_hdr);
+        if (phdr == NULL)
+            return;
+    }
+
+    /* With threads, this is only ever called from the main thread. */
+    if (tee_sinks != NULL) {
+        guint i;
+
+        for (i = 0; i < tee_sinks->len; i++)
+            capture_tee_put((tee_sink *)g_ptr_array_index(tee_sinks, i), phdr, pd);
+    }
+
     if (global_ld.pdh) {
         gboolean successful;
+        gint64   offset = (gint64)global_ld.bytes_written;
+        guint64  write_start = stats_interval != 0 ? create_timestamp() : 0;
 
         /* We're supposed to write the packet to a file; do so.
            If this fails, set "ld->go" to FALSE, to stop the capture, and set
@@ -4046,6 +4766,8 @@ capture_loop_write_packet_cb(u_char *pcap_opts_p, const struct pcap_pkthdr *phdr
                                               pd,
                                               &global_ld.bytes_written, &err);
         }
+        if (stats_interval != 0)
+            capture_hist_add(&write_latency, elapsed_since(write_start));
         if (!successful) {
             global_ld.go = FALSE;
             global_ld.err = err;
@@ -4055,6 +4777,27 @@ capture_loop_write_packet_cb(u_char *pcap_opts_p, const struct pcap_pkthdr *phdr
             g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
                   "Wrote a packet of length %d captured on interface %u.",
                    phdr->caplen, pcap_opts->interface_id);
+#endif
+            if (global_capture_opts.multi_files_on) {
+                ringbuf_index_packet(offset, phdr->ts.tv_sec,
+                                     pcap_opts->ts_nsec ? (int)phdr->ts.tv_usec : (int)phdr->ts.tv_usec * 1000,
+                                     phdr->caplen, phdr->len);
+            }
+#ifdef HAVE_CAPTURE_SHM
+            if (sync_shm != NULL) {
+                capture_shm_record rec;
+
+                /* hand our parent a copy, so it doesn't have to read it back */
+                rec.file_offset = offset;
+                rec.secs = phdr->ts.tv_sec;
+                rec.nsecs = pcap_opts->ts_nsec ? (guint32)phdr->ts.tv_usec : (guint32)phdr->ts.tv_usec * 1000;
+                rec.caplen = phdr->caplen;
+                rec.len = phdr->len;
+                rec.interface_id = pcap_opts->interface_id;
+                rec.linktype = pcap_opts->linktype;
+                rec.rec_len = 0;
+                capture_shm_put(sync_shm, &rec, pd);
+            }
 #endif
             global_ld.packet_count++;
             pcap_opts->received++;
@@ -4072,8 +4815,8 @@ capture_loop_queue_packet_cb(u_char *pcap_opts_p, const struct pcap_pkthdr *phdr
                              const u_char *pd)
 {
     pcap_options       *pcap_opts = (pcap_options *) (void *) pcap_opts_p;
-    pcap_queue_element *queue_element;
-    gboolean            limit_reached;
+    guint               queue_packets, queue_bytes;
+    struct pcap_pkthdr  truncated_hdr;
 
     /* We may be called multiple times from pcap_dispatch(); if we've set
        the "stop capturing" flag, ignore this packet, as we're not
@@ -4083,49 +4826,43 @@ capture_loop_queue_packet_cb(u_char *pcap_opts_p, const struct pcap_pkthdr *phdr
         return;
     }
 
-    queue_element = (pcap_queue_element *)g_malloc(sizeof(pcap_queue_element));
-    if (queue_element == NULL) {
-       pcap_opts->dropped++;
-       return;
-    }
-    queue_element->pcap_opts = pcap_opts;
-    queue_element->phdr = *phdr;
-    queue_element->pd = (u_char *)g_malloc(phdr->caplen);
-    if (queue_element->pd == NULL) {
-        pcap_opts->dropped++;
-        g_free(queue_element);
-        return;
-    }
-    memcpy(queue_element->pd, pd, phdr->caplen);
-    g_async_queue_lock(pcap_queue);
-    if (((pcap_queue_byte_limit == 0) || (pcap_queue_bytes < pcap_queue_byte_limit)) &&
-        ((pcap_queue_packet_limit == 0) || (pcap_queue_packets < pcap_queue_packet_limit))) {
-        limit_reached = FALSE;
-        g_async_queue_push_unlocked(pcap_queue, queue_element);
-        pcap_queue_bytes += phdr->caplen;
-        pcap_queue_packets += 1;
-    } else {
-        limit_reached = TRUE;
+    if (pcap_opts->truncate.bf_insns != NULL)
+        phdr = capture_loop_truncate_packet(pcap_opts, phdr, pd, &truncated_hdr);
+    if (pcap_opts->flow_budget != NULL) {
+        phdr = capture_loop_budget_packet(pcap_opts, phdr, pd, &truncated_hdr);
+        if (phdr == NULL)
+            return;
     }
-    g_async_queue_unlock(pcap_queue);
-    if (limit_reached) {
+
+    /* If the main thread isn't keeping up and the ring is full, the
+       packet is dropped; those drops are reported as dumpcap's own. */
+    if (!packet_ring_put(pcap_opts->queue, phdr, pd)) {
         pcap_opts->dropped++;
-        g_free(queue_element->pd);
-        g_free(queue_element);
+        pcap_opts->queue_drops++;
         g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
               "Dropped a packet of length %d captured on interface %u.",
               phdr->caplen, pcap_opts->interface_id);
-    } else {
-        pcap_opts->received++;
-        g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
-              "Queued a packet of length %d captured on interface %u.",
-              phdr->caplen, pcap_opts->interface_id);
+        return;
+    }
+    pcap_opts->received++;
+    if (g_atomic_int_get(&pcap_queue_waiting)) {
+        g_mutex_lock(pcap_queue_mtx);
+        g_cond_signal(pcap_queue_cond);
+        g_mutex_unlock(pcap_queue_mtx);
     }
-    /* I don't want to hold the mutex over the debug output. So the
-       output may be wrong */
     g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
-          "Queue size is now %" G_GINT64_MODIFIER "d bytes (%" G_GINT64_MODIFIER "d packets)",
-          pcap_queue_bytes, pcap_queue_packets);
+          "Queued a packet of length %d captured on interface %u.",
+          phdr->caplen, pcap_opts->interface_id);
+    /* The main thread may be taking packets out, so this may be
+       out of date */
+    packet_ring_fill(pcap_opts->queue, &queue_packets, &queue_bytes);
+    g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
+          "Queue size is now %u bytes (%u packets)",
+          queue_bytes, queue_packets);
+    if (queue_packets > pcap_opts->queue_packets_max)
+        pcap_opts->queue_packets_max = queue_packets;
+    if (queue_bytes > pcap_opts->queue_bytes_max)
+        pcap_opts->queue_bytes_max = queue_bytes;
 }
 
 static int
@@ -4217,6 +4954,22 @@ main(int argc, char *argv[])
         {(char *)"help", no_argument, NULL, 'h'},
         {(char *)"version", no_argument, NULL, 'v'},
         LONGOPT_CAPTURE_COMMON
+#ifdef HAVE_TPACKET_V3
+        {(char *)"tpacket-v3", no_argument, NULL, LONGOPT_TPACKET_V3},
+        {(char *)"fanout-group", required_argument, NULL, LONGOPT_FANOUT_GROUP},
+#endif
+        {(char *)"fsync", required_argument, NULL, LONGOPT_FSYNC},
+        {(char *)"ring-compress", required_argument, NULL, LONGOPT_RING_COMPRESS},
+        {(char *)"ring-compress-threads", required_argument, NULL, LONGOPT_RING_COMPRESS_THREADS},
+        {(char *)"ring-index", no_argument, NULL, LONGOPT_RING_INDEX},
+        {(char *)"truncate", required_argument, NULL, LONGOPT_TRUNCATE},
+        {(char *)"flow-budget", required_argument, NULL, LONGOPT_FLOW_BUDGET},
+        {(char *)"tee", required_argument, NULL, LONGOPT_TEE},
+        {(char *)"tee-snaplen", required_argument, NULL, LONGOPT_TEE_SNAPLEN},
+        {(char *)"tee-filter", required_argument, NULL, LONGOPT_TEE_FILTER},
+        {(char *)"sync-shm", required_argument, NULL, LONGOPT_SYNC_SHM},
+        {(char *)"merge-window", required_argument, NULL, LONGOPT_MERGE_WINDOW},
+        {(char *)"stats-interval", required_argument, NULL, LONGOPT_STATS_INTERVAL},
         {0, 0, 0, 0 }
     };
 
@@ -4668,6 +5421,117 @@ main(int argc, char *argv[])
         case 'N':
             pcap_queue_packet_limit = get_positive_int(optarg, "packet_limit");
             break;
+#ifdef HAVE_TPACKET_V3
+        case LONGOPT_TPACKET_V3:
+            use_tpacket = TRUE;
+            break;
+        case LONGOPT_FANOUT_GROUP:
+            tpacket_fanout_group = get_natural_int(optarg, "fanout group");
+            if (tpacket_fanout_group > 0xffff) {
+                cmdarg_err("The fanout group must be between 0 and 65535.");
+                exit_main(1);
+            }
+            use_tpacket = TRUE;
+            break;
+#endif
+        case LONGOPT_FSYNC:
+            if (strcmp(optarg, "never") == 0) {
+                sync_on_close = FALSE;
+                sync_interval = 0;
+            } else if (strcmp(optarg, "close") == 0) {
+                sync_on_close = TRUE;
+                sync_interval = 0;
+            } else {
+                sync_on_close = TRUE;
+                sync_interval = get_positive_int(optarg, "fsync interval");
+            }
+            break;
+        case LONGOPT_RING_COMPRESS:
+#ifdef HAVE_LIBZ
+            if (strcmp(optarg, "gzip") == 0) {
+                ring_compression = RINGBUF_COMPRESS_GZIP;
+                break;
+            }
+#endif
+#ifdef HAVE_ZSTD
+            if (strcmp(optarg, "zstd") == 0) {
+                ring_compression = RINGBUF_COMPRESS_ZSTD;
+                break;
+            }
+#endif
+            cmdarg_err("\"%s\" isn't a supported compression method.", optarg);
+            exit_main(1);
+            break;
+        case LONGOPT_RING_COMPRESS_THREADS:
+            ring_compress_threads = get_positive_int(optarg, "number of compression threads");
+            break;
+        case LONGOPT_RING_INDEX:
+            ring_index = TRUE;
+            break;
+        case LONGOPT_TRUNCATE:
+        {
+            truncate_rule rule;
+
+            if (!capture_truncate_parse_rule(optarg, &rule)) {
+                cmdarg_err("\"%s\" isn't a valid truncation rule; it should be <length>[:<capture filter>].",
+                           optarg);
+                exit_main(1);
+            }
+            if (truncate_rules == NULL)
+                truncate_rules = g_array_new(FALSE, FALSE, sizeof (truncate_rule));
+            g_array_append_val(truncate_rules, rule);
+            break;
+        }
+        case LONGOPT_FLOW_BUDGET:
+            if (!capture_flow_budget_parse(optarg, &flow_budget_bytes, &flow_budget_packets)) {
+                cmdarg_err("\"%s\" isn't a valid flow budget; it should be <bytes>[:<packets>], not both 0.",
+                           optarg);
+                exit_main(1);
+            }
+            break;
+        case LONGOPT_TEE:
+            if (tee_sinks == NULL)
+                tee_sinks = g_ptr_array_new();
+            g_ptr_array_add(tee_sinks, capture_tee_new(optarg));
+            break;
+        case LONGOPT_TEE_SNAPLEN:
+        case LONGOPT_TEE_FILTER:
+        {
+            tee_sink *sink;
+
+            if (tee_sinks == NULL) {
+                cmdarg_err("--%s must follow the --tee it applies to.",
+                           opt == LONGOPT_TEE_SNAPLEN ? "tee-snaplen" : "tee-filter");
+                exit_main(1);
+            }
+            sink = (tee_sink *)g_ptr_array_index(tee_sinks, tee_sinks->len - 1);
+            if (opt == LONGOPT_TEE_SNAPLEN)
+                capture_tee_set_snaplen(sink, get_positive_int(optarg, "tee snapshot length"));
+            else
+                capture_tee_set_filter(sink, optarg);
+            break;
+        }
+        case LONGOPT_MERGE_WINDOW:
+            merge_window = get_positive_int(optarg, "merge window");
+            break;
+        case LONGOPT_STATS_INTERVAL:
+            stats_interval = get_positive_int(optarg, "statistics interval");
+            break;
+        case LONGOPT_SYNC_SHM:        /* capture ring from our parent (hidden feature) */
+#ifdef HAVE_CAPTURE_SHM
+        {
+            int shm_err;
+
+            /* If this fails, our parent finds the ring empty and reads
+               the packets from the file instead. */
+            sync_shm = capture_shm_attach(get_natural_int(optarg, "capture ring"), &shm_err);
+            if (sync_shm == NULL) {
+                g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_WARNING,
+                      "Can't use the capture ring: %s", g_strerror(shm_err));
+            }
+        }
+#endif
+            break;
         default:
             cmdarg_err("Invalid Option: %s", argv[optind-1]);
             /* FALLTHROUGH */
@@ -4726,6 +5590,9 @@ main(int argc, char *argv[])
         if (global_capture_opts.ifaces->len > 1) {
             use_threads = TRUE;
             global_capture_opts.use_pcapng = TRUE;
+        } else if (merge_window != 0) {
+            /* there's nothing to merge */
+            merge_window = 0;
         }
 
         if (global_capture_opts.capture_comment &&
@@ -4753,6 +5620,19 @@ main(int argc, char *argv[])
 #endif
             }
         }
+        if (!global_capture_opts.multi_files_on &&
+            (ring_compression != RINGBUF_COMPRESS_NONE || ring_index)) {
+            cmdarg_err("--ring-compress and --ring-index only apply to ring buffer files; ignoring them.");
+            ring_compression = RINGBUF_COMPRESS_NONE;
+            ring_index = FALSE;
+        }
+#ifdef HAVE_CAPTURE_SHM
+        /* the packets in the ring are only for a single file */
+        if (global_capture_opts.multi_files_on && sync_shm != NULL) {
+            capture_shm_free(sync_shm);
+            sync_shm = NULL;
+        }
+#endif
     }
 
     /*
@@ -4869,6 +5749,20 @@ main(int argc, char *argv[])
         if_capabilities_t *caps;
         gchar *err_str;
         guint  ii;
+        gboolean batch;
+
+        /*
+         * When asked for the machine-readable capabilities of more than
+         * one interface, put a line with a tab and the interface name
+         * before each interface's, and leave them out for interfaces
+         * whose capabilities can't be obtained, rather than giving up on
+         * all the others.
+         */
+        batch = machine_readable && global_capture_opts.ifaces->len > 1;
+        if (batch && capture_child) {
+            /* Let our parent know we succeeded. */
+            pipe_write_block(2, SP_SUCCESS, NULL);
+        }
 
         for (ii = 0; ii < global_capture_opts.ifaces->len; ii++) {
             interface_options interface_opts;
@@ -4877,6 +5771,17 @@ main(int argc, char *argv[])
 
             caps = get_if_capabilities(interface_opts.name,
                                        interface_opts.monitor_mode, &err_str);
+            if (batch) {
+                printf("\t%s\n", interface_opts.name);
+                if (caps == NULL) {
+                    g_free(err_str);
+                    continue;
+                }
+                if (caps->data_link_types == NULL) {
+                    free_if_capabilities(caps);
+                    continue;
+                }
+            }
             if (caps == NULL) {
                 cmdarg_err("The capabilities of the capture device \"%s\" could not be obtained (%s).\n"
                            "Please check to make sure you have sufficient permissions, and that\n"
@@ -4888,10 +5793,13 @@ main(int argc, char *argv[])
                 cmdarg_err("The capture device \"%s\" has no data link types.", interface_opts.name);
                 exit_main(2);
             }
-            if (machine_readable)      /* tab-separated values to stdout */
-                /* XXX: We need to change the format and adopt consumers */
+            if (machine_readable) {    /* tab-separated values to stdout */
+                if (!batch && capture_child) {
+                    /* Let our parent know we succeeded. */
+                    pipe_write_block(2, SP_SUCCESS, NULL);
+                }
                 print_machine_readable_if_capabilities(caps);
-            else
+            } else
                 /* XXX: We might want to print also the interface name */
                 capture_opts_print_if_capabilities(caps, interface_opts.name,
                                                    interface_opts.monitor_mode);
@@ -5137,6 +6045,51 @@ report_packet_drops(guint32 received, guint32 pcap_drops, guint32 drops, guint32
     }
 }
 
+/* Send our parent, or print, one line of statistics */
+static void
+report_capture_stats_line(const char *stats_str)
+{
+    if (capture_child) {
+        g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_DEBUG, "Statistics: %s", stats_str);
+        pipe_write_block(2, SP_STATS, stats_str);
+    } else {
+        fprintf(stderr, "Statistics: %s\n", stats_str);
+        /* stderr could be line buffered */
+        fflush(stderr);
+    }
+}
+
+/* Report the statistics for each interface and for writing, and, if
+   we're writing pcapng, put them in the file as well. */
+static void
+report_capture_stats(capture_options *capture_opts)
+{
+    GString          *str = g_string_new("");
+    guint64           now = create_timestamp();
+    guint             i;
+    pcap_options     *pcap_opts;
+    struct pcap_stat  stats;
+    gboolean          stats_known;
+
+    for (i = 0; i < global_ld.pcaps->len; i++) {
+        pcap_opts = g_array_index(global_ld.pcaps, pcap_options *, i);
+        stats_known = !pcap_opts->from_cap_pipe &&
+                      capture_loop_get_stats(pcap_opts, &stats) >= 0;
+        g_string_truncate(str, 0);
+        capture_loop_format_stats(str, pcap_opts, stats_known ? &stats : NULL);
+        report_capture_stats_line(str->str);
+        if (capture_opts->use_pcapng && global_ld.pdh != NULL && !pcap_opts->from_cap_pipe &&
+            !capture_loop_write_stats_block(&global_ld, i, pcap_opts,
+                                            stats_known ? &stats : NULL, now,
+                                            &global_ld.err)) {
+            global_ld.go = FALSE;
+        }
+    }
+    g_string_truncate(str, 0);
+    capture_loop_format_global_stats(str);
+    report_capture_stats_line(str->str);
+    g_string_free(str, TRUE);
+}
 
 /************************************************************************************************/
 /* signal_pipe handling */
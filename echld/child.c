@@ -25,6 +25,7 @@
 
 
 #include "echld-int.h"
+#include <wiretap/frame_index.h>
 // echld_
 
 typedef struct _child {
@@ -57,6 +58,11 @@ typedef struct _child {
 //	capture_file cfile;
 	dfilter_t* df;
 
+	// the open file, and its frame index
+	wtap* wth;
+	wtap_frame_index* fidx;
+	gboolean fidx_is_new;
+
 } echld_child_t;
 
 static echld_epan_stuff_t* stuff = NULL;
@@ -221,8 +227,8 @@ static echld_bool_t param_set_cwd(char* val , char** err ) {
 static unsigned packet_count = 0;
 static char* param_get_packet_count(char** err) {
 
-	if (child.state != CAPTURING && child.state != READING) {
-		*err = g_strdup("Must be reading or in-capture for packet_count");
+	if (child.state != CAPTURING && child.state != READING && child.state != DONE) {
+		*err = g_strdup("Must be reading, in-capture or done for packet_count");
 		return NULL;
 	}
 	return g_strdup_printf("%d",packet_count);
@@ -360,10 +366,38 @@ static char* param_get_params(char** err _U_) {
 	return paramset_get_params_list(child_params,PARAM_LIST_FMT);
 }
 
+/*
+ * A file is opened once and stays open, with its frame index, until the
+ * child goes away, so that a long-lived child can answer requests about
+ * any of its frames without reading the file again.  If the file has a
+ * valid frame index sidecar, it is used and the file isn't read at all;
+ * otherwise the index is built by child_file_read() and saved.
+ */
 static void child_open_file(char* filename) {
+	int err;
+	gchar* err_info = NULL;
+
 	CHILD_DBG((2,"CMD open file filename='%s'",filename));
-	child_err(ECHLD_ERR_UNIMPLEMENTED,child.reqh_id,"open file not implemented yet!");
+
+	child.wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, TRUE);
+	if (!child.wth) {
+		child_err(ECHLD_ERR_CANNOT_OPEN_FILE,child.reqh_id,"cannot open file '%s': %s",filename,wtap_strerror(err));
+		g_free(err_info);
+		return;
+	}
+
+	g_free(child.cf_name);
+	child.cf_name = g_strdup(filename);
+	packet_count = 0;
+
+	child.fidx = wtap_frame_index_open(filename, wtap_file_type_subtype(child.wth));
+	child.fidx_is_new = (child.fidx == NULL);
+	if (child.fidx_is_new) {
+		child.fidx = wtap_frame_index_new(wtap_file_type_subtype(child.wth));
+	}
+
 	child.state = READING;
+	CHILD_RESP(NULL,ECHLD_FILE_OPENED);
 }
 
 static void child_open_interface(char* intf, char* pars) {
@@ -632,8 +666,46 @@ static int child_dumpcap_read(void) {
 	return FALSE;
 }
 
+#define CHILD_READ_BATCH 1024
+
+/* read the next batch of records of the open file into its frame index,
+   so that requests from the parent are still served while it's read */
 static void child_file_read(void) {
+	int err = 0;
+	gchar* err_info = NULL;
+	gint64 data_offset;
+	int i;
 
+	if (!child.wth) return;
+
+	if (!child.fidx_is_new) {
+		packet_count = wtap_frame_index_count(child.fidx);
+		goto done;
+	}
+
+	for (i = 0; i < CHILD_READ_BATCH; i++) {
+		if (!wtap_read(child.wth, &err, &err_info, &data_offset)) {
+			if (err != 0) {
+				child_err(ECHLD_ERR_OTHER,child.reqh_id,"error reading '%s': %s",child.cf_name,wtap_strerror(err));
+				g_free(err_info);
+				child.state = ERRORED;
+				return;
+			}
+
+			/* the index is only an optimization, so failing to save it is not an error */
+			wtap_frame_index_write(child.fidx, child.cf_name, &err);
+			goto done;
+		}
+
+		wtap_frame_index_add(child.fidx, data_offset, wtap_phdr(child.wth));
+		packet_count++;
+	}
+	return;
+
+done:
+	CHILD_DBG((2,"file read packet_count=%d",packet_count));
+	child.state = DONE;
+	CHILD_RESP(NULL,ECHLD_EOF);
 }
 
 int echld_child_loop(void) {
@@ -671,7 +743,8 @@ int echld_child_loop(void) {
 		if (step <= 20) CHILD_DBG((4,"child_loop: select()ing step=%d",step++));
 #endif
 		timeout.tv_sec = 0;
-		timeout.tv_usec = 999999;
+		/* don't wait between batches of a file being read */
+		timeout.tv_usec = child.state == READING ? 0 : 999999;
 
 		nfds = select(FD_SETSIZE, &rfds, &wfds, &efds, &timeout);
 #ifdef DEBUG_CHILD
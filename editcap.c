@@ -63,6 +63,7 @@
 #endif
 
 #include "wtap.h"
+#include "frame_index.h"
 
 #ifndef HAVE_GETOPT_LONG
 #include "wsutil/wsgetopt.h"
@@ -86,6 +87,7 @@
 #include <wsutil/report_err.h>
 #include <wsutil/strnatcmp.h>
 #include <wsutil/md5.h>
+#include <wsutil/xxhash64.h>
 #include <wsutil/plugins.h>
 #include <wsutil/crash_info.h>
 #include <wsutil/ws_version_info.h>
@@ -103,21 +105,43 @@ struct select_item {
 
 /*
  * Duplicate frame detection
+ *
+ * The frames in the window are remembered by a 64-bit hash of their
+ * data, in a ring buffer ordered from oldest to newest that's also a
+ * chained hash table keyed on that hash, so looking for a duplicate
+ * takes the same time however large the window is.
  */
 typedef struct _fd_hash_t {
-    md5_byte_t digest[16];
+    guint64    hash;
     guint32    len;
     nstime_t   time;
+    gint32     next;    /* next entry in the same hash bucket, or -1 */
 } fd_hash_t;
 
 #define DEFAULT_DUP_DEPTH       5   /* Used with -d */
-#define MAX_DUP_DEPTH     1000000   /* the maximum window (and actual size of fd_hash[]) for de-duplication */
+#define MAX_DUP_DEPTH     1000000   /* the maximum window (and size of fd_hash[]) for de-duplication */
+
+static fd_hash_t *fd_hash;            /* ring of the frames in the window */
+static gint32    *fd_hash_buckets;    /* first entry of each hash bucket, or -1 */
+static guint32    fd_hash_mask;       /* number of buckets - 1 */
+static int        fd_hash_size;       /* number of entries in the ring */
+static int        fd_hash_oldest;     /* index of the oldest entry */
+static int        fd_hash_count;      /* number of entries in use */
+static int        dup_window    = DEFAULT_DUP_DEPTH;
+
+static int        ignored_bytes  = 0;  /* Used with -I */
+
+/* Byte ranges to ignore when comparing frames (--dup-mask) */
+typedef struct {
+    guint32 offset;
+    guint32 len;
+} dup_mask_t;
 
-static fd_hash_t fd_hash[MAX_DUP_DEPTH];
-static int       dup_window    = DEFAULT_DUP_DEPTH;
-static int       cur_dup_entry = 0;
+static dup_mask_t *dup_masks;
+static int         num_dup_masks;
+static guint8     *dup_mask_buf;
 
-static int       ignored_bytes  = 0;  /* Used with -I */
+static md5_byte_t  dup_md5[16];       /* MD5 of the last frame checked, with -v */
 
 #define ONE_BILLION 1000000000
 
@@ -148,6 +172,10 @@ typedef struct _chop_t {
     int off_end_neg;
 } chop_t;
 
+#define LONGOPT_FRAME_INDEX 128
+#define LONGOPT_DUP_MASK    129
+#define LONGOPT_TIME_ORDERED 130
+
 #define MAX_SELECTIONS 512
 static struct select_item     selectfrm[MAX_SELECTIONS];
 static int                    max_selected              = -1;
@@ -320,6 +348,459 @@ selected(int recno)
   return 0;
 }
 
+/* Return the first selected packet at or after recno, or 0 if there's none */
+static guint32
+next_selected(guint32 recno)
+{
+    int     i;
+    guint32 first, second, next = 0;
+
+    for (i = 0; i <= max_selected; i++) {
+        first = (guint32) selectfrm[i].first;
+        second = selectfrm[i].inclusive ? (guint32) selectfrm[i].second : first;
+        if (second < recno)
+            continue;
+        first = MAX(first, recno);
+        if (next == 0 || first < next)
+            next = first;
+    }
+
+    return next;
+}
+
+/*
+ * Read the next packet to process.
+ *
+ * If we have a frame index for the input file, and we're only keeping the
+ * selected packets or the packets in a time range, go straight to the next
+ * such packet rather than reading all the packets in between.  If we're
+ * building a frame index, add every packet we read to it.
+ */
+static gboolean
+read_next_packet(wtap *wth, wtap_frame_index *fidx, gboolean fidx_seek,
+                 guint32 *count, int *err, gchar **err_info,
+                 gint64 *data_offset)
+{
+    guint32  recno;
+    nstime_t ts;
+
+    if (fidx_seek) {
+        recno = *count;
+        for (;;) {
+            if (keep_em && max_selected >= 0)
+                recno = next_selected(recno);
+            if (!wtap_frame_index_get(fidx, recno, data_offset, &ts, NULL, NULL)) {
+                /* No more selected packets in the file. */
+                *err = 0;
+                *err_info = NULL;
+                return FALSE;
+            }
+            /* The packet's own time stamp is checked once it's read */
+            if (!check_startstop ||
+                (ts.secs >= starttime && ts.secs < stoptime))
+                break;
+            recno++;
+        }
+        *count = recno;
+        return wtap_read_at(wth, *data_offset, err, err_info);
+    }
+
+    if (!wtap_read(wth, err, err_info, data_offset))
+        return FALSE;
+
+    if (fidx != NULL)
+        wtap_frame_index_add(fidx, *data_offset, wtap_phdr(wth));
+    return TRUE;
+}
+
+/*
+ * Report a failure to write a frame, or, if frame is 0, to finish
+ * writing the file.
+ */
+static void
+report_dump_error(int err, gchar *err_info, guint32 frame,
+                  const char *infile, const char *outfile)
+{
+    if (frame == 0) {
+        fprintf(stderr, "editcap: Error writing to %s: %s\n",
+                outfile, wtap_strerror(err));
+        return;
+    }
+
+    switch (err) {
+    case WTAP_ERR_UNWRITABLE_ENCAP:
+        /*
+         * This is a problem with the particular frame we're
+         * writing and the file type and subtype we're
+         * writing; note that, and report the frame number
+         * and file type/subtype.
+         */
+        fprintf(stderr,
+                "editcap: Frame %u of \"%s\" has a network type that can't be saved in a \"%s\" file.\n",
+                frame, infile,
+                wtap_file_type_subtype_string(out_file_type_subtype));
+        break;
+
+    case WTAP_ERR_PACKET_TOO_LARGE:
+        /*
+         * This is a problem with the particular frame we're
+         * writing and the file type and subtype we're
+         * writing; note that, and report the frame number
+         * and file type/subtype.
+         */
+        fprintf(stderr,
+                "editcap: Frame %u of \"%s\" is too large for a \"%s\" file.\n",
+                frame, infile,
+                wtap_file_type_subtype_string(out_file_type_subtype));
+        break;
+
+    case WTAP_ERR_UNWRITABLE_REC_TYPE:
+        /*
+         * This is a problem with the particular record we're
+         * writing and the file type and subtype we're
+         * writing; note that, and report the record number
+         * and file type/subtype.
+         */
+        fprintf(stderr,
+                "editcap: Record %u of \"%s\" has a record type that can't be saved in a \"%s\" file.\n",
+                frame, infile,
+                wtap_file_type_subtype_string(out_file_type_subtype));
+        break;
+
+    case WTAP_ERR_UNWRITABLE_REC_DATA:
+        /*
+         * This is a problem with the particular record we're
+         * writing and the file type and subtype we're
+         * writing; note that, and report the record number
+         * and file type/subtype.
+         */
+        fprintf(stderr,
+                "editcap: Record %u of \"%s\" has data that can't be saved in a \"%s\" file.\n(%s)\n",
+                frame, infile,
+                wtap_file_type_subtype_string(out_file_type_subtype),
+                err_info != NULL ? err_info : "no information supplied");
+        g_free(err_info);
+        break;
+
+    default:
+        fprintf(stderr, "editcap: Error writing to %s: %s\n",
+                outfile, wtap_strerror(err));
+        break;
+    }
+}
+
+/*
+ * Threaded processing (-j)
+ *
+ * A reader thread reads the input file in batches of records, the main
+ * thread does the editing, in order, since duplicate removal, -S and -E
+ * depend on the packets before, and each output file gets a writer thread
+ * of its own, so that when splitting with -c or -i a file can still be
+ * being written while the next ones are filled.  Batches are recycled
+ * through free queues, which bounds the memory used.
+ */
+#define PIPE_BATCH_RECS     256     /* records handed between threads at once */
+#define PIPE_BATCHES        32      /* batches each side of the main thread */
+
+typedef struct {
+    wtap_batch_rec  recs[PIPE_BATCH_RECS];
+    guint32         frames[PIPE_BATCH_RECS]; /* "count" read, "read_count" written */
+    guint           nrecs;
+    guint           snapshot_length;    /* of the input file, once it was read */
+    gboolean        last;               /* last batch of the input or output file */
+    int             err;                /* read error, on the last input batch */
+    gchar          *err_info;
+} pipe_batch_t;
+
+typedef struct {
+    wtap_dumper    *pdh;
+    gchar          *filename;
+    GAsyncQueue    *batches;            /* to write, up to one with "last" set */
+    GThread        *thread;
+    volatile gint   failed;
+    int             err;
+    gchar          *err_info;
+    guint32         err_frame;          /* 0 if it's closing the file that failed */
+} pipe_writer_t;
+
+typedef struct {
+    wtap             *wth;
+    wtap_frame_index *fidx;
+    gboolean          fidx_seek;
+} pipe_reader_t;
+
+static int           max_writers = 0;   /* -j; 0 to do everything in the main thread */
+static GPtrArray    *pipe_all_batches;
+static GAsyncQueue  *pipe_in_free;
+static GAsyncQueue  *pipe_in_full;
+static GAsyncQueue  *pipe_out_free;
+static pipe_reader_t pipe_reader;
+static GThread      *pipe_reader_thread;
+static pipe_batch_t *pipe_in_batch;     /* being edited */
+static guint         pipe_in_next;      /* next record of it */
+static pipe_batch_t *pipe_out_batch;    /* being filled for pipe_writer */
+static pipe_writer_t *pipe_writer;      /* for the current output file */
+static GQueue       *pipe_writers;      /* still running, oldest first */
+
+static gpointer
+pipe_read_thread(gpointer data)
+{
+    pipe_reader_t *rd = (pipe_reader_t *)data;
+    guint32 count = 1;
+    pipe_batch_t *batch;
+    wtap_batch_rec *rec;
+    struct wtap_pkthdr *phdr;
+    gint64 data_offset;
+    guint i, n;
+
+    do {
+        batch = (pipe_batch_t *)g_async_queue_pop(pipe_in_free);
+        if (rd->fidx_seek) {
+            /* Go from one selected packet to the next */
+            for (i = 0; i < PIPE_BATCH_RECS; i++) {
+                if (!read_next_packet(rd->wth, rd->fidx, TRUE, &count,
+                                      &batch->err, &batch->err_info, &data_offset))
+                    break;
+                rec = &batch->recs[i];
+                phdr = wtap_phdr(rd->wth);
+                rec->phdr = *phdr;
+                ws_buffer_assure_space(&rec->buf, phdr->caplen);
+                memcpy(ws_buffer_start_ptr(&rec->buf), wtap_buf_ptr(rd->wth),
+                       phdr->caplen);
+                batch->frames[i] = count++;
+            }
+        } else {
+            n = wtap_read_batch(rd->wth, batch->recs, PIPE_BATCH_RECS,
+                                &batch->err, &batch->err_info);
+            for (i = 0; i < n; i++) {
+                rec = &batch->recs[i];
+                if (rd->fidx != NULL)
+                    wtap_frame_index_add(rd->fidx, rec->data_offset, &rec->phdr);
+                batch->frames[i] = count++;
+            }
+        }
+        batch->nrecs = i;
+        batch->snapshot_length = wtap_snapshot_length(rd->wth);
+        batch->last = (i < PIPE_BATCH_RECS);
+        g_async_queue_push(pipe_in_full, batch);
+    } while (!batch->last);
+
+    return NULL;
+}
+
+static void
+pipe_start(wtap *wth, wtap_frame_index *fidx, gboolean fidx_seek)
+{
+    pipe_batch_t *batch;
+    int i;
+
+#if !GLIB_CHECK_VERSION(2,31,0)
+    g_thread_init(NULL);
+#endif
+    pipe_all_batches = g_ptr_array_new();
+    pipe_in_free = g_async_queue_new();
+    pipe_in_full = g_async_queue_new();
+    pipe_out_free = g_async_queue_new();
+    pipe_writers = g_queue_new();
+    for (i = 0; i < 2 * PIPE_BATCHES; i++) {
+        batch = g_new0(pipe_batch_t, 1);
+        wtap_batch_recs_init(batch->recs, PIPE_BATCH_RECS);
+        g_ptr_array_add(pipe_all_batches, batch);
+        g_async_queue_push(i < PIPE_BATCHES ? pipe_in_free : pipe_out_free, batch);
+    }
+
+    pipe_reader.wth = wth;
+    pipe_reader.fidx = fidx;
+    pipe_reader.fidx_seek = fidx_seek;
+#if GLIB_CHECK_VERSION(2,31,0)
+    pipe_reader_thread = g_thread_new("editcap reader", pipe_read_thread, &pipe_reader);
+#else
+    pipe_reader_thread = g_thread_create(pipe_read_thread, &pipe_reader, TRUE, NULL);
+#endif
+}
+
+/*
+ * Get the next packet from the reader thread; returns FALSE, with the
+ * reader's err and err_info, at the end of the input.
+ */
+static gboolean
+pipe_read_packet(guint32 *count, const struct wtap_pkthdr **phdr, guint8 **buf,
+                 guint *snapshot_length, int *err, gchar **err_info)
+{
+    pipe_batch_t *batch = pipe_in_batch;
+
+    for (;;) {
+        if (batch == NULL) {
+            batch = (pipe_batch_t *)g_async_queue_pop(pipe_in_full);
+            pipe_in_batch = batch;
+            pipe_in_next = 0;
+        }
+        if (pipe_in_next < batch->nrecs)
+            break;
+        if (batch->last) {
+            *err = batch->err;
+            *err_info = batch->err_info;
+            return FALSE;
+        }
+        g_async_queue_push(pipe_in_free, batch);
+        pipe_in_batch = batch = NULL;
+    }
+
+    *count = batch->frames[pipe_in_next];
+    *phdr = &batch->recs[pipe_in_next].phdr;
+    *buf = ws_buffer_start_ptr(&batch->recs[pipe_in_next].buf);
+    *snapshot_length = batch->snapshot_length;
+    pipe_in_next++;
+    return TRUE;
+}
+
+static gpointer
+pipe_write_thread(gpointer data)
+{
+    pipe_writer_t *writer = (pipe_writer_t *)data;
+    pipe_batch_t *batch;
+    gboolean last;
+    guint i;
+    int err;
+
+    do {
+        batch = (pipe_batch_t *)g_async_queue_pop(writer->batches);
+        /* After a failure, just hand the batches back */
+        for (i = 0; i < batch->nrecs && !g_atomic_int_get(&writer->failed); i++) {
+            if (!wtap_dump(writer->pdh, &batch->recs[i].phdr,
+                           ws_buffer_start_ptr(&batch->recs[i].buf),
+                           &writer->err, &writer->err_info)) {
+                writer->err_frame = batch->frames[i];
+                g_atomic_int_set(&writer->failed, TRUE);
+            }
+        }
+        last = batch->last;
+        batch->nrecs = 0;
+        batch->last = FALSE;
+        g_async_queue_push(pipe_out_free, batch);
+    } while (!last);
+
+    if (!wtap_dump_close(writer->pdh, &err) && !writer->failed) {
+        writer->err = err;
+        writer->err_frame = 0;
+        g_atomic_int_set(&writer->failed, TRUE);
+    }
+    return NULL;
+}
+
+/*
+ * Wait for a writer to finish its file, and give up if it couldn't.
+ */
+static void
+pipe_writer_finish(pipe_writer_t *writer, const char *infile)
+{
+    g_thread_join(writer->thread);
+    if (writer->failed) {
+        report_dump_error(writer->err, writer->err_info, writer->err_frame,
+                          infile, writer->filename);
+        exit(2);
+    }
+    g_async_queue_unref(writer->batches);
+    g_free(writer->filename);
+    g_free(writer);
+}
+
+/*
+ * Hand a newly opened output file to a writer thread of its own, once
+ * there are fewer than -j writers busy with the files before it.
+ */
+static void
+pipe_writer_start(wtap_dumper *pdh, const char *filename, const char *infile)
+{
+    pipe_writer_t *writer;
+
+    while (g_queue_get_length(pipe_writers) >= (guint)max_writers)
+        pipe_writer_finish((pipe_writer_t *)g_queue_pop_head(pipe_writers), infile);
+
+    writer = g_new0(pipe_writer_t, 1);
+    writer->pdh = pdh;
+    writer->filename = g_strdup(filename);
+    writer->batches = g_async_queue_new();
+#if GLIB_CHECK_VERSION(2,31,0)
+    writer->thread = g_thread_new("editcap writer", pipe_write_thread, writer);
+#else
+    writer->thread = g_thread_create(pipe_write_thread, writer, TRUE, NULL);
+#endif
+    g_queue_push_tail(pipe_writers, writer);
+    pipe_writer = writer;
+}
+
+static void
+pipe_write_packet(const struct wtap_pkthdr *phdr, const guint8 *buf,
+                  guint32 frame, const char *infile)
+{
+    pipe_batch_t *batch = pipe_out_batch;
+    wtap_batch_rec *rec;
+
+    if (g_atomic_int_get(&pipe_writer->failed)) {
+        /* Give up now, rather than once the rest of the file is edited */
+        report_dump_error(pipe_writer->err, pipe_writer->err_info,
+                          pipe_writer->err_frame, infile, pipe_writer->filename);
+        exit(2);
+    }
+
+    if (batch == NULL)
+        batch = pipe_out_batch = (pipe_batch_t *)g_async_queue_pop(pipe_out_free);
+
+    rec = &batch->recs[batch->nrecs];
+    rec->phdr = *phdr;
+    ws_buffer_assure_space(&rec->buf, phdr->caplen);
+    memcpy(ws_buffer_start_ptr(&rec->buf), buf, phdr->caplen);
+    batch->frames[batch->nrecs++] = frame;
+
+    if (batch->nrecs == PIPE_BATCH_RECS) {
+        g_async_queue_push(pipe_writer->batches, batch);
+        pipe_out_batch = NULL;
+    }
+}
+
+/*
+ * Tell the current writer that its file is complete; it closes the file
+ * when it's written the rest of it.
+ */
+static void
+pipe_close_file(void)
+{
+    pipe_batch_t *batch = pipe_out_batch;
+
+    if (batch == NULL)
+        batch = (pipe_batch_t *)g_async_queue_pop(pipe_out_free);
+    batch->last = TRUE;
+    g_async_queue_push(pipe_writer->batches, batch);
+    pipe_out_batch = NULL;
+    pipe_writer = NULL;
+}
+
+/*
+ * Wait for the reader and all the writers to finish.
+ */
+static void
+pipe_stop(const char *infile)
+{
+    guint i;
+
+    g_thread_join(pipe_reader_thread);
+    while (!g_queue_is_empty(pipe_writers))
+        pipe_writer_finish((pipe_writer_t *)g_queue_pop_head(pipe_writers), infile);
+    g_queue_free(pipe_writers);
+
+    for (i = 0; i < pipe_all_batches->len; i++) {
+        pipe_batch_t *batch = (pipe_batch_t *)g_ptr_array_index(pipe_all_batches, i);
+
+        wtap_batch_recs_cleanup(batch->recs, PIPE_BATCH_RECS);
+        g_free(batch);
+    }
+    g_ptr_array_free(pipe_all_batches, TRUE);
+    g_async_queue_unref(pipe_in_free);
+    g_async_queue_unref(pipe_in_full);
+    g_async_queue_unref(pipe_out_free);
+}
+
 static void
 set_time_adjustment(char *optarg_str_p)
 {
@@ -532,111 +1013,154 @@ set_rel_time(char *optarg_str_p)
     relative_time_window.nsecs = (int)val;
 }
 
-static gboolean
-is_duplicate(guint8* fd, guint32 len) {
+static void
+dup_init(void)
+{
     int i;
-    md5_state_t ms;
+    guint32 nbuckets;
 
-    /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
-    guint32 new_len;
-    guint8 *new_fd;
+    /*
+     * A frame is compared with the dup_window - 1 frames before it;
+     * with -w, the window is as many frames as fit in the ring.
+     */
+    fd_hash_size = dup_window > 1 ? dup_window - 1 : 0;
+    fd_hash = g_new(fd_hash_t, fd_hash_size > 0 ? fd_hash_size : 1);
+    fd_hash_oldest = 0;
+    fd_hash_count = 0;
+
+    /* Keep the buckets no more than half full */
+    for (nbuckets = 16; nbuckets < (guint32)fd_hash_size * 2; nbuckets <<= 1)
+        ;
+    fd_hash_buckets = g_new(gint32, nbuckets);
+    for (i = 0; i < (int)nbuckets; i++)
+        fd_hash_buckets[i] = -1;
+    fd_hash_mask = nbuckets - 1;
+}
 
-    new_fd  = &fd[ignored_bytes];
-    new_len = len - (ignored_bytes);
+static void
+dup_remove_oldest(void)
+{
+    gint32 *linkp = &fd_hash_buckets[fd_hash[fd_hash_oldest].hash & fd_hash_mask];
 
-    cur_dup_entry++;
-    if (cur_dup_entry >= dup_window)
-        cur_dup_entry = 0;
+    while (*linkp != fd_hash_oldest)
+        linkp = &fd_hash[*linkp].next;
+    *linkp = fd_hash[fd_hash_oldest].next;
 
-    /* Calculate our digest */
-    md5_init(&ms);
-    md5_append(&ms, new_fd, new_len);
-    md5_finish(&ms, fd_hash[cur_dup_entry].digest);
+    fd_hash_oldest++;
+    if (fd_hash_oldest >= fd_hash_size)
+        fd_hash_oldest = 0;
+    fd_hash_count--;
+}
+
+static void
+dup_add(guint64 hash, guint32 len, const nstime_t *current)
+{
+    int i;
+    gint32 *bucket;
 
-    fd_hash[cur_dup_entry].len = len;
+    if (fd_hash_size == 0)
+        return;
+    if (fd_hash_count == fd_hash_size)
+        dup_remove_oldest();
+
+    i = (fd_hash_oldest + fd_hash_count) % fd_hash_size;
+    bucket = &fd_hash_buckets[hash & fd_hash_mask];
+    fd_hash[i].hash = hash;
+    fd_hash[i].len = len;
+    if (current != NULL)
+        fd_hash[i].time = *current;
+    else
+        nstime_set_unset(&fd_hash[i].time);
+    fd_hash[i].next = *bucket;
+    *bucket = i;
+    fd_hash_count++;
+}
 
-    /* Look for duplicates */
-    for (i = 0; i < dup_window; i++) {
-        if (i == cur_dup_entry)
-            continue;
+/*
+ * Hash a frame's data, leaving out the bytes to be ignored with -I and
+ * --dup-mask; with -v, also get its MD5 for the report.
+ */
+static guint64
+dup_hash(guint8 *fd, guint32 len)
+{
+    int i;
+    md5_state_t ms;
 
-        if (fd_hash[i].len == fd_hash[cur_dup_entry].len
-            && memcmp(fd_hash[i].digest, fd_hash[cur_dup_entry].digest, 16) == 0) {
-            return TRUE;
+    if (num_dup_masks > 0) {
+        memcpy(dup_mask_buf, fd, len);
+        for (i = 0; i < num_dup_masks; i++) {
+            if (dup_masks[i].offset < len)
+                memset(&dup_mask_buf[dup_masks[i].offset], 0,
+                       MIN(dup_masks[i].len, len - dup_masks[i].offset));
         }
+        fd = dup_mask_buf;
+    }
+
+    /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
+    if (len > (guint32)ignored_bytes) {
+        fd  = &fd[ignored_bytes];
+        len = len - (ignored_bytes);
+    } else {
+        len = 0;
     }
 
-    return FALSE;
+    if (verbose) {
+        md5_init(&ms);
+        md5_append(&ms, fd, len);
+        md5_finish(&ms, dup_md5);
+    }
+
+    return xxhash64(fd, len, 0);
 }
 
 static gboolean
-is_duplicate_rel_time(guint8* fd, guint32 len, const nstime_t *current) {
-    int i;
-    md5_state_t ms;
-
-    /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
-    guint32 new_len;
-    guint8 *new_fd;
+is_duplicate(guint8* fd, guint32 len) {
+    guint64 hash = dup_hash(fd, len);
+    gint32 i;
+    gboolean dup = FALSE;
 
-    new_fd  = &fd[ignored_bytes];
-    new_len = len - (ignored_bytes);
+    /* Look for duplicates */
+    for (i = fd_hash_buckets[hash & fd_hash_mask]; i != -1; i = fd_hash[i].next) {
+        if (fd_hash[i].hash == hash && fd_hash[i].len == len) {
+            dup = TRUE;
+            break;
+        }
+    }
 
-    cur_dup_entry++;
-    if (cur_dup_entry >= dup_window)
-        cur_dup_entry = 0;
+    /* Duplicates go in the window too */
+    dup_add(hash, len, NULL);
 
-    /* Calculate our digest */
-    md5_init(&ms);
-    md5_append(&ms, new_fd, new_len);
-    md5_finish(&ms, fd_hash[cur_dup_entry].digest);
+    return dup;
+}
 
-    fd_hash[cur_dup_entry].len = len;
-    fd_hash[cur_dup_entry].time.secs = current->secs;
-    fd_hash[cur_dup_entry].time.nsecs = current->nsecs;
+static gboolean
+is_duplicate_rel_time(guint8* fd, guint32 len, const nstime_t *current) {
+    guint64 hash = dup_hash(fd, len);
+    gint32 i;
+    gboolean dup = FALSE;
 
     /*
-     * Look for relative time related duplicates.
-     * This is hopefully a reasonably efficient mechanism for
-     * finding duplicates by rel time in the fd_hash[] cache.
-     * We check starting from the most recently added hash
-     * entries and work backwards towards older packets.
-     * This approach allows the dup test to be terminated
-     * when the relative time of a cached entry is found to
-     * be beyond the dup time window.
-     *
-     * Of course this assumes that the input trace file is
-     * "well-formed" in the sense that the packet timestamps are
-     * in strict chronologically increasing order (which is NOT
-     * always the case!!).
-     *
-     * The fd_hash[] table was deliberately created large (1,000,000).
-     * Looking for time related duplicates in large trace files with
-     * non-fractional dup time window values can potentially take
-     * a long time to complete.
+     * Forget the frames that are now further back than the dup time
+     * window.  This assumes that the input trace file is "well-formed"
+     * in the sense that the packet timestamps are in strict
+     * chronologically increasing order (which is NOT always the case!!);
+     * if they aren't, we may forget some frames early, or look at some
+     * that are too old, which the check below catches.
      */
-
-    for (i = cur_dup_entry - 1;; i--) {
+    while (fd_hash_count > 0) {
         nstime_t delta;
-        int cmp;
-
-        if (i < 0)
-            i = dup_window - 1;
 
-        if (i == cur_dup_entry) {
-            /*
-             * We've decremented back to where we started.
-             * Check no more!
-             */
+        nstime_delta(&delta, current, &fd_hash[fd_hash_oldest].time);
+        if (nstime_cmp(&delta, &relative_time_window) <= 0)
             break;
-        }
+        dup_remove_oldest();
+    }
 
-        if (nstime_is_unset(&(fd_hash[i].time))) {
-            /*
-             * We've decremented to an unused fd_hash[] entry.
-             * Check no more!
-             */
-            break;
-        }
+    for (i = fd_hash_buckets[hash & fd_hash_mask]; i != -1; i = fd_hash[i].next) {
+        nstime_t delta;
+
+        if (fd_hash[i].hash != hash || fd_hash[i].len != len)
+            continue;
 
         nstime_delta(&delta, current, &fd_hash[i].time);
 
@@ -646,38 +1170,55 @@ is_duplicate_rel_time(guint8* fd, guint32 len, const nstime_t *current) {
              * has an absolute timestamp less than the cached packet
              * that it is being compared to.  This is NOT a normal
              * situation since trace files usually have packets in
-             * chronological order (oldest to newest).
-             *
-             * There are several possible ways to deal with this:
-             * 1. 'continue' dup checking with the next cached frame.
-             * 2. 'break' from looking for a duplicate of the current frame.
-             * 3. Take the absolute value of the delta and see if that
-             * falls within the specifed dup time window.
-             *
-             * Currently this code does option 1.  But it would pretty
-             * easy to add yet-another-editcap-option to select one of
-             * the other behaviors for dealing with out-of-sequence
-             * packets.
+             * chronological order (oldest to newest).  Don't count
+             * it as a duplicate.
              */
             continue;
         }
 
-        cmp = nstime_cmp(&delta, &relative_time_window);
-
-        if (cmp > 0) {
-            /*
-             * The delta time indicates that we are now looking at
-             * cached packets beyond the specified dup time window.
-             * Check no more!
-             */
+        if (nstime_cmp(&delta, &relative_time_window) <= 0) {
+            dup = TRUE;
             break;
-        } else if (fd_hash[i].len == fd_hash[cur_dup_entry].len
-                   && memcmp(fd_hash[i].digest, fd_hash[cur_dup_entry].digest, 16) == 0) {
-            return TRUE;
         }
     }
 
-    return FALSE;
+    dup_add(hash, len, current);
+
+    return dup;
+}
+
+/*
+ * Parse a --dup-mask argument, <offset>:<length>.
+ */
+static void
+add_dup_mask(const char *arg)
+{
+    unsigned long offset, len;
+    char *p;
+    const char *lenp;
+
+    offset = strtoul(arg, &p, 10);
+    if (p == arg || *p != ':') {
+        fprintf(stderr, "editcap: \"%s\" isn't a valid <offset>:<length> to mask\n",
+                arg);
+        exit(1);
+    }
+    lenp = p + 1;
+    len = strtoul(lenp, &p, 10);
+    if (p == lenp || *p != '\0' || len == 0 ||
+        offset > WTAP_MAX_PACKET_SIZE || len > WTAP_MAX_PACKET_SIZE) {
+        fprintf(stderr, "editcap: \"%s\" isn't a valid <offset>:<length> to mask\n",
+                arg);
+        exit(1);
+    }
+
+    dup_masks = (dup_mask_t *)g_realloc(dup_masks,
+                                        (num_dup_masks + 1) * sizeof (dup_mask_t));
+    dup_masks[num_dup_masks].offset = (guint32)offset;
+    dup_masks[num_dup_masks].len = (guint32)len;
+    num_dup_masks++;
+    if (dup_mask_buf == NULL)
+        dup_mask_buf = (guint8 *)g_malloc(WTAP_MAX_PACKET_SIZE);
 }
 
 static void
@@ -691,10 +1232,16 @@ print_usage(FILE *output)
     fprintf(output, "\n");
     fprintf(output, "Packet selection:\n");
     fprintf(output, "  -r                     keep the selected packets; default is to delete them.\n");
+    fprintf(output, "  --frame-index          use the frame index sidecar file (<infile>.wsidx) to go\n");
+    fprintf(output, "                         straight to the packets kept with -r, or create it if\n");
+    fprintf(output, "                         there is no up to date one.\n");
     fprintf(output, "  -A <start time>        only output packets whose timestamp is after (or equal\n");
     fprintf(output, "                         to) the given time (format as YYYY-MM-DD hh:mm:ss).\n");
     fprintf(output, "  -B <stop time>         only output packets whose timestamp is before the\n");
     fprintf(output, "                         given time (format as YYYY-MM-DD hh:mm:ss).\n");
+    fprintf(output, "  --time-ordered         the packets in the input file are in time order; with\n");
+    fprintf(output, "                         -A or -B, go straight to the start time and stop at\n");
+    fprintf(output, "                         the stop time.\n");
     fprintf(output, "\n");
     fprintf(output, "Duplicate packet removal:\n");
     fprintf(output, "  -d                     remove packet if duplicate (window == %d).\n", DEFAULT_DUP_DEPTH);
@@ -708,12 +1255,16 @@ print_usage(FILE *output)
     fprintf(output, "                         (e.g. 0.000001).\n");
     fprintf(output, "\n");
     fprintf(output, "  -I <bytes to ignore>   ignore the specified bytes at the beginning of\n");
-    fprintf(output, "                         the frame during MD5 hash calculation\n");
+    fprintf(output, "                         the frame when comparing packets\n");
     fprintf(output, "                         Useful to remove duplicated packets taken on\n");
     fprintf(output, "                         several routers(differents mac addresses for \n");
     fprintf(output, "                         example)\n");
     fprintf(output, "                         e.g. -I 26 in case of Ether/IP/ will ignore \n");
     fprintf(output, "                         ether(14) and IP header(20 - 4(src ip) - 4(dst ip)).\n");
+    fprintf(output, "  --dup-mask <offset>:<length>\n");
+    fprintf(output, "                         ignore <length> bytes starting <offset> bytes into\n");
+    fprintf(output, "                         the frame when comparing packets, e.g. a TTL or\n");
+    fprintf(output, "                         checksum; can be given more than once.\n");
     fprintf(output, "\n");
     fprintf(output, "           NOTE: The use of the 'Duplicate packet removal' options with\n");
     fprintf(output, "           other editcap options except -v may not always work as expected.\n");
@@ -752,6 +1303,9 @@ print_usage(FILE *output)
     fprintf(output, "  -i <seconds per file>  split the packet output to different files based on\n");
     fprintf(output, "                         uniform time intervals with a maximum of\n");
     fprintf(output, "                         <seconds per file> each.\n");
+    fprintf(output, "  -j <files>             read, edit and write the packets in separate threads,\n");
+    fprintf(output, "                         writing up to <files> of the files split with -c or\n");
+    fprintf(output, "                         -i at the same time.\n");
     fprintf(output, "  -F <capture type>      set the output file type; default is pcapng. An empty\n");
     fprintf(output, "                         \"-F\" option will list the file types.\n");
     fprintf(output, "  -T <encap type>        set the output file encapsulation type; default is the\n");
@@ -884,6 +1438,9 @@ main(int argc, char *argv[])
     static const struct option long_options[] = {
         {(char *)"help", no_argument, NULL, 'h'},
         {(char *)"version", no_argument, NULL, 'V'},
+        {(char *)"frame-index", no_argument, NULL, LONGOPT_FRAME_INDEX},
+        {(char *)"dup-mask", required_argument, NULL, LONGOPT_DUP_MASK},
+        {(char *)"time-ordered", no_argument, NULL, LONGOPT_TIME_ORDERED},
         {0, 0, 0, 0 }
     };
 
@@ -897,6 +1454,7 @@ main(int argc, char *argv[])
     gint64        data_offset;
     int           err_type;
     guint8       *buf;
+    guint         snapshot_length;
     guint32       read_count         = 0;
     int           split_packet_count = 0;
     int           written_count      = 0;
@@ -907,7 +1465,12 @@ main(int argc, char *argv[])
     nstime_t      block_start;
     gchar        *fprefix            = NULL;
     gchar        *fsuffix            = NULL;
+    gboolean      use_frame_index    = FALSE;
+    wtap_frame_index *fidx           = NULL;
+    gboolean      fidx_seek          = FALSE;
+    gboolean      time_ordered       = FALSE;
 
+    const struct wtap_pkthdr    *in_phdr;
     const struct wtap_pkthdr    *phdr;
     struct wtap_pkthdr           snap_phdr;
     wtapng_iface_descriptions_t *idb_inf;
@@ -963,7 +1526,7 @@ main(int argc, char *argv[])
 #endif
 
     /* Process the options */
-    while ((opt = getopt_long(argc, argv, "A:B:c:C:dD:E:F:hi:I:Lrs:S:t:T:vVw:", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "A:B:c:C:dD:E:F:hi:I:j:Lrs:S:t:T:vVw:", long_options, NULL)) != -1) {
         switch (opt) {
         case 'A':
         {
@@ -1119,6 +1682,15 @@ main(int argc, char *argv[])
             }
             break;
 
+        case 'j':
+            max_writers = (int)strtol(optarg, &p, 10);
+            if (p == optarg || *p != '\0' || max_writers <= 0) {
+                fprintf(stderr, "editcap: \"%s\" isn't a valid number of output files\n",
+                        optarg);
+                exit(1);
+            }
+            break;
+
         case 'L':
             adjlen = TRUE;
             break;
@@ -1166,6 +1738,18 @@ main(int argc, char *argv[])
             exit(0);
             break;
 
+        case LONGOPT_FRAME_INDEX:
+            use_frame_index = TRUE;
+            break;
+
+        case LONGOPT_TIME_ORDERED:
+            time_ordered = TRUE;
+            break;
+
+        case LONGOPT_DUP_MASK:
+            add_dup_mask(optarg);
+            break;
+
         case 'w':
             dup_detect = FALSE;
             dup_detect_by_time = TRUE;
@@ -1224,7 +1808,8 @@ main(int argc, char *argv[])
         exit(1);
     }
 
-    wth = wtap_open_offline(argv[optind], WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+    /* If we might seek to packets using a frame index, we need random access */
+    wth = wtap_open_offline(argv[optind], WTAP_TYPE_AUTO, &err, &err_info, use_frame_index);
 
     if (!wth) {
         fprintf(stderr, "editcap: Can't open %s: %s\n", argv[optind],
@@ -1257,18 +1842,77 @@ main(int argc, char *argv[])
             if (add_selection(argv[i]) == FALSE)
                 break;
 
+        if (use_frame_index) {
+            fidx = wtap_frame_index_open(argv[optind], wtap_file_type_subtype(wth));
+            if (fidx != NULL) {
+                /*
+                 * We can only skip packets if we're keeping just the
+                 * selected ones, or the ones in a time range; duplicate
+                 * detection has to look at every packet anyway.
+                 */
+                fidx_seek = ((keep_em && max_selected >= 0) || check_startstop) &&
+                            !dup_detect && !dup_detect_by_time;
+                if (!fidx_seek) {
+                    wtap_frame_index_free(fidx);
+                    fidx = NULL;
+                } else if (verbose) {
+                    fprintf(stderr, "editcap: Using frame index for %s (%u packets)\n",
+                            argv[optind], wtap_frame_index_count(fidx));
+                }
+            } else {
+                /* Build one, to be written out once we've read the file */
+                fidx = wtap_frame_index_new(wtap_file_type_subtype(wth));
+            }
+        }
+
         if (dup_detect || dup_detect_by_time) {
-            for (i = 0; i < dup_window; i++) {
-                memset(&fd_hash[i].digest, 0, 16);
-                fd_hash[i].len = 0;
-                nstime_set_unset(&fd_hash[i].time);
+            dup_init();
+        }
+
+        /*
+         * If the packets are in time order, go straight to the first one
+         * in the time range, unless we need to look at the ones before
+         * it, to number the selected packets, to find duplicates, or to
+         * index them all.
+         */
+        if (time_ordered && check_startstop && fidx == NULL &&
+            max_selected < 0 && !dup_detect && !dup_detect_by_time) {
+            nstime_t start_ts;
+            guint32  recno;
+
+            start_ts.secs = starttime;
+            start_ts.nsecs = 0;
+            if (wtap_seek_to_time(wth, NULL, &start_ts, &recno, &err, &err_info)) {
+                if (recno != 0)
+                    count = recno;
+                if (verbose)
+                    fprintf(stderr, "editcap: Skipped to the start time in %s\n",
+                            argv[optind]);
+            } else if (err != 0) {
+                fprintf(stderr, "editcap: Can't seek in %s: %s\n",
+                        argv[optind], wtap_strerror(err));
+                if (err_info != NULL) {
+                    fprintf(stderr, "(%s)\n", err_info);
+                    g_free(err_info);
+                }
+                exit(2);
             }
         }
 
-        while (wtap_read(wth, &err, &err_info, &data_offset)) {
+        if (max_writers > 0)
+            pipe_start(wth, fidx, fidx_seek);
+
+        while (max_writers > 0 ?
+               pipe_read_packet(&count, &in_phdr, &buf, &snapshot_length, &err, &err_info) :
+               read_next_packet(wth, fidx, fidx_seek, &count, &err, &err_info, &data_offset)) {
             read_count++;
 
-            phdr = wtap_phdr(wth);
+            if (max_writers == 0) {
+                in_phdr = wtap_phdr(wth);
+                buf = wtap_buf_ptr(wth);
+                snapshot_length = wtap_snapshot_length(wth);
+            }
+            phdr = in_phdr;
 
             if (read_count == 1) {  /* the first packet */
                 if (split_packet_count > 0 || secs_per_block > 0) {
@@ -1287,7 +1931,7 @@ main(int argc, char *argv[])
                 }
 
                 pdh = wtap_dump_open_ng(filename, out_file_type_subtype, out_frame_type,
-                                        snaplen ? MIN(snaplen, wtap_snapshot_length(wth)) : wtap_snapshot_length(wth),
+                                        snaplen ? MIN(snaplen, snapshot_length) : snapshot_length,
                                         FALSE /* compressed */, shb_hdr, idb_inf, &err);
 
                 if (pdh == NULL) {
@@ -1295,10 +1939,12 @@ main(int argc, char *argv[])
                             filename, wtap_strerror(err));
                     exit(2);
                 }
+                if (use_frame_index)
+                    wtap_dump_set_frame_index(pdh, filename);
+                if (max_writers > 0)
+                    pipe_writer_start(pdh, filename, argv[optind]);
             }
 
-            buf = wtap_buf_ptr(wth);
-
             /*
              * Not all packets have time stamps. Only process the time
              * stamp if we have one.
@@ -1314,7 +1960,9 @@ main(int argc, char *argv[])
                            || (phdr->ts.secs - block_start.secs == secs_per_block
                                && phdr->ts.nsecs >= block_start.nsecs )) { /* time for the next file */
 
-                        if (!wtap_dump_close(pdh, &err)) {
+                        if (max_writers > 0) {
+                            pipe_close_file();
+                        } else if (!wtap_dump_close(pdh, &err)) {
                             fprintf(stderr, "editcap: Error writing to %s: %s\n",
                                     filename, wtap_strerror(err));
                             exit(2);
@@ -1328,7 +1976,7 @@ main(int argc, char *argv[])
                             fprintf(stderr, "Continuing writing in file %s\n", filename);
 
                         pdh = wtap_dump_open_ng(filename, out_file_type_subtype, out_frame_type,
-                                                snaplen ? MIN(snaplen, wtap_snapshot_length(wth)) : wtap_snapshot_length(wth),
+                                                snaplen ? MIN(snaplen, snapshot_length) : snapshot_length,
                                                 FALSE /* compressed */, shb_hdr, idb_inf, &err);
 
                         if (pdh == NULL) {
@@ -1336,6 +1984,10 @@ main(int argc, char *argv[])
                                     filename, wtap_strerror(err));
                             exit(2);
                         }
+                        if (use_frame_index)
+                            wtap_dump_set_frame_index(pdh, filename);
+                        if (max_writers > 0)
+                            pipe_writer_start(pdh, filename, argv[optind]);
                     }
                 }
             }
@@ -1343,7 +1995,9 @@ main(int argc, char *argv[])
             if (split_packet_count > 0) {
                 /* time for the next file? */
                 if (written_count > 0 && written_count % split_packet_count == 0) {
-                    if (!wtap_dump_close(pdh, &err)) {
+                    if (max_writers > 0) {
+                        pipe_close_file();
+                    } else if (!wtap_dump_close(pdh, &err)) {
                         fprintf(stderr, "editcap: Error writing to %s: %s\n",
                                 filename, wtap_strerror(err));
                         exit(2);
@@ -1357,13 +2011,17 @@ main(int argc, char *argv[])
                         fprintf(stderr, "Continuing writing in file %s\n", filename);
 
                     pdh = wtap_dump_open_ng(filename, out_file_type_subtype, out_frame_type,
-                                            snaplen ? MIN(snaplen, wtap_snapshot_length(wth)) : wtap_snapshot_length(wth),
+                                            snaplen ? MIN(snaplen, snapshot_length) : snapshot_length,
                                             FALSE /* compressed */, shb_hdr, idb_inf, &err);
                     if (pdh == NULL) {
                         fprintf(stderr, "editcap: Can't open or create %s: %s\n",
                                 filename, wtap_strerror(err));
                         exit(2);
                     }
+                    if (use_frame_index)
+                        wtap_dump_set_frame_index(pdh, filename);
+                    if (max_writers > 0)
+                        pipe_writer_start(pdh, filename, argv[optind]);
                 }
             }
 
@@ -1376,6 +2034,17 @@ main(int argc, char *argv[])
                     ts_okay = (phdr->ts.secs >= starttime) && (phdr->ts.secs < stoptime);
                 else
                     ts_okay = FALSE;
+
+                /*
+                 * If the packets are in time order, none of the rest
+                 * are in it either, unless we have to read them all
+                 * to index them.
+                 */
+                if (time_ordered && max_writers == 0 &&
+                    (fidx == NULL || fidx_seek) &&
+                    (phdr->presence_flags & WTAP_HAS_TS) &&
+                    phdr->ts.secs >= stoptime)
+                    break;
             } else {
                 /*
                  * No selected timeframe, so all packets are "in the
@@ -1393,7 +2062,7 @@ main(int argc, char *argv[])
                 /* We simply write it, perhaps after truncating it; we could
                  * do other things, like modify it. */
 
-                phdr = wtap_phdr(wth);
+                phdr = in_phdr;
 
                 if (snaplen != 0) {
                     if (phdr->caplen > snaplen) {
@@ -1513,7 +2182,7 @@ main(int argc, char *argv[])
                                     count, phdr->caplen);
                             for (i = 0; i < 16; i++)
                                 fprintf(stderr, "%02x",
-                                        (unsigned char)fd_hash[cur_dup_entry].digest[i]);
+                                        (unsigned char)dup_md5[i]);
                             fprintf(stderr, "\n");
                         }
                         duplicate_count++;
@@ -1525,7 +2194,7 @@ main(int argc, char *argv[])
                                     count, phdr->caplen);
                             for (i = 0; i < 16; i++)
                                 fprintf(stderr, "%02x",
-                                        (unsigned char)fd_hash[cur_dup_entry].digest[i]);
+                                        (unsigned char)dup_md5[i]);
                             fprintf(stderr, "\n");
                         }
                     }
@@ -1545,7 +2214,7 @@ main(int argc, char *argv[])
                                         count, phdr->caplen);
                                 for (i = 0; i < 16; i++)
                                     fprintf(stderr, "%02x",
-                                            (unsigned char)fd_hash[cur_dup_entry].digest[i]);
+                                            (unsigned char)dup_md5[i]);
                                 fprintf(stderr, "\n");
                             }
                             duplicate_count++;
@@ -1557,7 +2226,7 @@ main(int argc, char *argv[])
                                         count, phdr->caplen);
                                 for (i = 0; i < 16; i++)
                                     fprintf(stderr, "%02x",
-                                            (unsigned char)fd_hash[cur_dup_entry].digest[i]);
+                                            (unsigned char)dup_md5[i]);
                                 fprintf(stderr, "\n");
                             }
                         }
@@ -1614,67 +2283,11 @@ main(int argc, char *argv[])
                     }
                 }
 
-                if (!wtap_dump(pdh, phdr, buf, &err, &err_info)) {
-                    switch (err) {
-                    case WTAP_ERR_UNWRITABLE_ENCAP:
-                        /*
-                         * This is a problem with the particular frame we're
-                         * writing and the file type and subtype we're
-                         * writing; note that, and report the frame number
-                         * and file type/subtype.
-                         */
-                        fprintf(stderr,
-                                "editcap: Frame %u of \"%s\" has a network type that can't be saved in a \"%s\" file.\n",
-                                read_count, argv[optind],
-                                wtap_file_type_subtype_string(out_file_type_subtype));
-                        break;
-
-                    case WTAP_ERR_PACKET_TOO_LARGE:
-                        /*
-                         * This is a problem with the particular frame we're
-                         * writing and the file type and subtype we're
-                         * writing; note that, and report the frame number
-                         * and file type/subtype.
-                         */
-                        fprintf(stderr,
-                                "editcap: Frame %u of \"%s\" is too large for a \"%s\" file.\n",
-                                read_count, argv[optind],
-                                wtap_file_type_subtype_string(out_file_type_subtype));
-                        break;
-
-                    case WTAP_ERR_UNWRITABLE_REC_TYPE:
-                        /*
-                         * This is a problem with the particular record we're
-                         * writing and the file type and subtype we're
-                         * writing; note that, and report the record number
-                         * and file type/subtype.
-                         */
-                        fprintf(stderr,
-                                "editcap: Record %u of \"%s\" has a record type that can't be saved in a \"%s\" file.\n",
-                                read_count, argv[optind],
-                                wtap_file_type_subtype_string(out_file_type_subtype));
-                        break;
-
-                    case WTAP_ERR_UNWRITABLE_REC_DATA:
-                        /*
-                         * This is a problem with the particular record we're
-                         * writing and the file type and subtype we're
-                         * writing; note that, and report the record number
-                         * and file type/subtype.
-                         */
-                        fprintf(stderr,
-                                "editcap: Record %u of \"%s\" has data that can't be saved in a \"%s\" file.\n(%s)\n",
-                                read_count, argv[optind],
-                                wtap_file_type_subtype_string(out_file_type_subtype),
-                                err_info != NULL ? err_info : "no information supplied");
-                        g_free(err_info);
-                        break;
-
-                    default:
-                        fprintf(stderr, "editcap: Error writing to %s: %s\n",
-                                filename, wtap_strerror(err));
-                        break;
-                    }
+                if (max_writers > 0) {
+                    pipe_write_packet(phdr, buf, read_count, argv[optind]);
+                } else if (!wtap_dump(pdh, phdr, buf, &err, &err_info)) {
+                    report_dump_error(err, err_info, read_count, argv[optind],
+                                      filename);
                     exit(2);
                 }
                 written_count++;
@@ -1682,9 +2295,31 @@ main(int argc, char *argv[])
             count++;
         }
 
+        if (max_writers > 0) {
+            /* Let the last file be finished, and wait for all of them */
+            if (pdh != NULL)
+                pipe_close_file();
+            pipe_stop(argv[optind]);
+        }
+
         g_free(fprefix);
         g_free(fsuffix);
 
+        if (fidx != NULL && !fidx_seek && err == 0) {
+            /* We read the whole file; save the frame index we built. */
+            int idx_err;
+
+            if (!wtap_frame_index_write(fidx, argv[optind], &idx_err))
+                fprintf(stderr, "editcap: Can't write the frame index for %s: %s\n",
+                        argv[optind], g_strerror(idx_err));
+            /* For a compressed file, save where we can start inflating, too. */
+            if (!wtap_fast_seek_save(wth, argv[optind], &idx_err))
+                fprintf(stderr, "editcap: Can't write the seek index for %s: %s\n",
+                        argv[optind], g_strerror(idx_err));
+        }
+        wtap_frame_index_free(fidx);
+        fidx = NULL;
+
         if (err != 0) {
             /* Print a message noting that the read failed somewhere along the
              * line. */
@@ -1711,12 +2346,15 @@ main(int argc, char *argv[])
                         filename, wtap_strerror(err));
                 exit(2);
             }
+            if (use_frame_index)
+                wtap_dump_set_frame_index(pdh, filename);
         }
 
         g_free(idb_inf);
         idb_inf = NULL;
 
-        if (!wtap_dump_close(pdh, &err)) {
+        /* With -j, a writer thread has closed any file opened in the loop */
+        if ((max_writers == 0 || read_count == 0) && !wtap_dump_close(pdh, &err)) {
             fprintf(stderr, "editcap: Error writing to %s: %s\n", filename,
                     wtap_strerror(err));
             exit(2);
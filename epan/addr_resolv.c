@@ -28,6 +28,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 
 /*
  * Win32 doesn't have SIGALRM (and it's the OS where name lookup calls
@@ -140,31 +141,30 @@
 #define ENAME_IPXNETS   "ipxnets"
 #define ENAME_MANUF     "manuf"
 #define ENAME_SERVICES  "services"
+#define ENAME_RESOLV_CACHE "resolved_hosts"
+
+/* How long a name DNS gave us is used from the resolver cache, in seconds */
+#define RESOLV_CACHE_TTL (24*60*60)
 
 #define HASHETHSIZE      2048
 #define HASHHOSTSIZE     2048
 #define HASHIPXNETSIZE    256
-#define SUBNETLENGTHSIZE   32  /*1-32 inc.*/
-
-/* hash table used for IPv4 lookup */
-
-#define HASH_IPV4_ADDRESS(addr) (g_htonl(addr) & (HASHHOSTSIZE - 1))
-
 
-typedef struct sub_net_hashipv4 {
-    guint             addr;
-    guint8            flags;          /* B0 dummy_entry, B1 resolve, B2 If the address is used in the trace */
-    struct sub_net_hashipv4   *next;
-    gchar             ip[16];
-    gchar             name[MAXNAMELEN];
-} sub_net_hashipv4_t;
+/*
+ * A path-compressed binary trie, for finding the longest prefix of an
+ * address that has a name, in one walk down from the root.  Each node
+ * holds the prefix it stands for; nodes that only join two subtrees
+ * have no name.  Used for the ranges of well-known MAC addresses from
+ * the manuf file and for the subnets file.
+ */
+#define PREFIX_TRIE_MAX_BYTES 16
 
-/* Array of entries of subnets of different lengths */
-typedef struct {
-    gsize        mask_length;      /*1-32*/
-    guint32      mask;             /* e.g. 255.255.255.*/
-    sub_net_hashipv4_t** subnet_addresses; /* Hash table of subnet addresses */
-} subnet_length_entry_t;
+typedef struct prefix_trie_node {
+    guint8                   prefix[PREFIX_TRIE_MAX_BYTES]; /* bits past the prefix are zero */
+    guint                    bits;      /* length of the prefix, in bits */
+    gchar                   *name;      /* NULL for a junction */
+    struct prefix_trie_node *child[2];  /* by the bit after the prefix */
+} prefix_trie_node_t;
 
 
 #if 0
@@ -243,12 +243,12 @@ static port_type    cb_proto = PT_NONE;
 
 
 static GHashTable *manuf_hashtable = NULL;
-static GHashTable *wka_hashtable = NULL;
+static prefix_trie_node_t *wka_trie = NULL;
 static GHashTable *eth_hashtable = NULL;
 static GHashTable *serv_port_hashtable = NULL;
 
-static subnet_length_entry_t subnet_length_entries[SUBNETLENGTHSIZE]; /* Ordered array of entries */
-static gboolean have_subnet_entry = FALSE;
+static prefix_trie_node_t *subnet_trie = NULL;
+static prefix_trie_node_t *subnet6_trie = NULL;
 
 static gboolean new_resolved_objects = FALSE;
 
@@ -408,6 +408,121 @@ typedef struct {
  *  Miscellaneous functions
  */
 
+/* Bit number bit, counting from the most significant bit of addr[0] */
+static inline guint
+prefix_bit(const guint8 *addr, guint bit)
+{
+    return (addr[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+/* The number of leading bits, up to max_bits, that a and b have in common */
+static guint
+prefix_common_bits(const guint8 *a, const guint8 *b, guint max_bits)
+{
+    guint  bits = 0;
+    guint8 diff;
+
+    while (bits < max_bits) {
+        diff = a[bits >> 3] ^ b[bits >> 3];
+        if (diff != 0) {
+            while ((diff & 0x80) == 0) {
+                diff <<= 1;
+                bits++;
+            }
+            break;
+        }
+        bits += 8;
+    }
+    return MIN(bits, max_bits);
+}
+
+static prefix_trie_node_t *
+prefix_trie_new_node(const guint8 *addr, guint bits, const gchar *name)
+{
+    prefix_trie_node_t *node = g_new0(prefix_trie_node_t, 1);
+    guint               len = (bits + 7) / 8;
+
+    memcpy(node->prefix, addr, len);
+    if ((bits & 7) != 0)
+        node->prefix[len - 1] &= (guint8)(0xFF << (8 - (bits & 7)));
+    node->bits = bits;
+    node->name = g_strdup(name);
+    return node;
+}
+
+/*
+ * Give the first bits bits of addr a name.  If that prefix already has
+ * one, it's replaced if replace is TRUE and kept otherwise.
+ */
+static void
+prefix_trie_insert(prefix_trie_node_t **root, const guint8 *addr, guint bits,
+        const gchar *name, gboolean replace)
+{
+    prefix_trie_node_t **link = root;
+    prefix_trie_node_t  *node, *junction;
+    guint                common;
+
+    g_assert(bits <= PREFIX_TRIE_MAX_BYTES * 8);
+
+    while ((node = *link) != NULL) {
+        common = prefix_common_bits(node->prefix, addr, MIN(node->bits, bits));
+        if (common < node->bits) {
+            /* The new prefix leaves the path to this node here */
+            if (common == bits) {
+                junction = prefix_trie_new_node(addr, bits, name);
+            } else {
+                junction = prefix_trie_new_node(addr, common, NULL);
+                junction->child[prefix_bit(addr, common)] = prefix_trie_new_node(addr, bits, name);
+            }
+            junction->child[prefix_bit(node->prefix, common)] = node;
+            *link = junction;
+            return;
+        }
+        if (node->bits == bits) {
+            if (node->name == NULL || replace) {
+                g_free(node->name);
+                node->name = g_strdup(name);
+            }
+            return;
+        }
+        link = &node->child[prefix_bit(addr, node->bits)];
+    }
+    *link = prefix_trie_new_node(addr, bits, name);
+}
+
+/*
+ * The node for the longest prefix of addr, which is addr_bits long, that
+ * has a name, or NULL if none has; the node's bits member is the length
+ * of the prefix.
+ */
+static const prefix_trie_node_t *
+prefix_trie_lookup(const prefix_trie_node_t *node, const guint8 *addr, guint addr_bits)
+{
+    const prefix_trie_node_t *best = NULL;
+
+    while (node != NULL && node->bits <= addr_bits &&
+            prefix_common_bits(node->prefix, addr, node->bits) == node->bits) {
+        if (node->name != NULL)
+            best = node;
+        if (node->bits == addr_bits)
+            break;
+        node = node->child[prefix_bit(addr, node->bits)];
+    }
+    return best;
+}
+
+static void
+prefix_trie_free(prefix_trie_node_t *node)
+{
+    if (node == NULL)
+        return;
+
+    prefix_trie_free(node->child[0]);
+    prefix_trie_free(node->child[1]);
+    g_free(node->name);
+    g_free(node);
+}
+
 static int
 fgetline(char **buf, int *size, FILE *fp)
 {
@@ -452,7 +567,6 @@ fgetline(char **buf, int *size, FILE *fp)
  *  Local function definitions
  */
 static subnet_entry_t subnet_lookup(const guint32 addr);
-static void subnet_entry_set(guint32 subnet_addr, const guint32 mask_length, const gchar* name);
 
 
 static void
@@ -798,6 +912,180 @@ fill_dummy_ip4(const guint addr, hashipv4_t* volatile tp)
     }
 }
 
+/* Fill in an IP6 structure with info from subnets file or just with the
+ * string form of the address.
+ */
+static void
+fill_dummy_ip6(hashipv6_t* volatile tp)
+{
+    const prefix_trie_node_t *subnet;
+
+    if ((tp->flags & DUMMY_ADDRESS_ENTRY) == DUMMY_ADDRESS_ENTRY)
+        return; /* already done */
+
+    tp->flags = tp->flags | DUMMY_ADDRESS_ENTRY; /* Overwrite if we get async DNS reply */
+
+    /* Do we have a subnet for this address? */
+    subnet = prefix_trie_lookup(subnet6_trie, tp->addr.bytes, 128);
+    if (subnet != NULL) {
+        /* Print name, then the address with the subnet prefix cleared,
+         * e.g. "lab::1" for 2001:db8::1 in a 2001:db8::/32 named "lab".
+         */
+        struct e_in6_addr host_addr;
+        gchar buffer[MAX_IP6_STR_LEN];
+        guint i;
+
+        for (i = 0; i < 16; i++) {
+            if ((i + 1) * 8 <= subnet->bits)
+                host_addr.bytes[i] = 0;
+            else if (i * 8 >= subnet->bits)
+                host_addr.bytes[i] = tp->addr.bytes[i];
+            else
+                host_addr.bytes[i] = tp->addr.bytes[i] & (0xFF >> (subnet->bits - i * 8));
+        }
+        ip6_to_str_buf(&host_addr, buffer);
+        g_snprintf(tp->name, MAXNAMELEN, "%s%s", subnet->name, buffer);
+    } else {
+        g_strlcpy(tp->name, tp->ip6, MAXNAMELEN);
+    }
+}
+
+/*
+ * Names looked up with DNS, in this run and earlier ones, so that a new
+ * session can show them without asking again.  They're kept, by the
+ * text form of the address, in the personal configuration directory.
+ */
+typedef struct {
+    gchar  *name;
+    time_t  expires;
+} resolv_cache_entry_t;
+
+static GHashTable *resolv_cache = NULL;
+static gboolean    resolv_cache_changed = FALSE;
+
+static void
+resolv_cache_entry_free(gpointer data)
+{
+    resolv_cache_entry_t *entry = (resolv_cache_entry_t *)data;
+
+    g_free(entry->name);
+    g_free(entry);
+}
+
+static void
+resolv_cache_insert(const char *addr, const char *name, time_t expires)
+{
+    resolv_cache_entry_t *entry;
+
+    entry = g_new(resolv_cache_entry_t, 1);
+    entry->name = g_strdup(name);
+    entry->expires = expires;
+    g_hash_table_replace(resolv_cache, g_strdup(addr), entry);
+}
+
+static void
+resolv_cache_load(void)
+{
+    char   *path;
+    FILE   *fp;
+    char   *line = NULL;
+    int     size = 0;
+    char   *addr, *name, *expires_str;
+    time_t  now = time(NULL);
+    time_t  expires;
+
+    resolv_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, resolv_cache_entry_free);
+    resolv_cache_changed = FALSE;
+
+    path = get_persconffile_path(ENAME_RESOLV_CACHE, FALSE);
+    fp = ws_fopen(path, "r");
+    g_free(path);
+    if (fp == NULL)
+        return;
+
+    while (fgetline(&line, &size, fp) >= 0) {
+        if (line[0] == '#')
+            continue;
+        if ((addr = strtok(line, "\t")) == NULL ||
+            (name = strtok(NULL, "\t")) == NULL ||
+            (expires_str = strtok(NULL, "\t")) == NULL)
+            continue;
+        expires = (time_t)g_ascii_strtoull(expires_str, NULL, 10);
+        if (expires <= now) {
+            /* drop it the next time the cache is written */
+            resolv_cache_changed = TRUE;
+            continue;
+        }
+        resolv_cache_insert(addr, name, expires);
+    }
+    g_free(line);
+    fclose(fp);
+}
+
+static void
+resolv_cache_write_entry(gpointer key, gpointer value, gpointer user_data)
+{
+    resolv_cache_entry_t *entry = (resolv_cache_entry_t *)value;
+    FILE *fp = (FILE *)user_data;
+
+    fprintf(fp, "%s\t%s\t%" G_GUINT64_FORMAT "\n", (const char *)key, entry->name,
+            (guint64)entry->expires);
+}
+
+static void
+resolv_cache_save(void)
+{
+    char *path;
+    FILE *fp;
+
+    if (resolv_cache == NULL)
+        return;
+
+    if (resolv_cache_changed) {
+        path = get_persconffile_path(ENAME_RESOLV_CACHE, FALSE);
+        fp = ws_fopen(path, "w");
+        g_free(path);
+        if (fp != NULL) {
+            fputs("# Host names Wireshark has looked up: address, name, and the time\n"
+                  "# (in seconds since the Epoch) after which the name is looked up again.\n", fp);
+            g_hash_table_foreach(resolv_cache, resolv_cache_write_entry, fp);
+            fclose(fp);
+        }
+    }
+
+    g_hash_table_destroy(resolv_cache);
+    resolv_cache = NULL;
+    resolv_cache_changed = FALSE;
+}
+
+#ifdef ASYNC_DNS
+/* Remember a name DNS gave us for the address in text form addr */
+static void
+resolv_cache_add(const char *addr, const char *name)
+{
+    if (resolv_cache == NULL || name[0] == '\0')
+        return;
+
+    resolv_cache_insert(addr, name, time(NULL) + RESOLV_CACHE_TTL);
+    resolv_cache_changed = TRUE;
+}
+#endif /* ASYNC_DNS */
+
+/* The name cached for the address in text form addr, if it hasn't expired */
+static const gchar *
+resolv_cache_lookup(const char *addr)
+{
+    resolv_cache_entry_t *entry;
+
+    if (resolv_cache == NULL)
+        return NULL;
+
+    entry = (resolv_cache_entry_t *)g_hash_table_lookup(resolv_cache, addr);
+    if (entry == NULL || entry->expires <= time(NULL))
+        return NULL;
+    return entry->name;
+}
+
 #ifdef HAVE_C_ARES
 
 static void
@@ -815,6 +1103,7 @@ c_ares_ghba_cb(
 
     async_dns_queue_msg_t *caqm = (async_dns_queue_msg_t *)arg;
     char **p;
+    char addr_str[MAX_IP6_STR_LEN];
 
     if (!caqm) return;
     /* XXX, what to do if async_dns_in_flight == 0? */
@@ -834,6 +1123,18 @@ c_ares_ghba_cb(
                     break;
             }
         }
+        switch(caqm->family) {
+            case AF_INET:
+                ip_to_str_buf((const guint8 *)&caqm->addr.ip4, addr_str, sizeof addr_str);
+                resolv_cache_add(addr_str, he->h_name);
+                break;
+            case AF_INET6:
+                ip6_to_str_buf(&caqm->addr.ip6, addr_str);
+                resolv_cache_add(addr_str, he->h_name);
+                break;
+            default:
+                break;
+        }
     }
     g_free(caqm);
 }
@@ -850,6 +1151,11 @@ new_ipv4(const guint addr)
     return tp;
 }
 
+/* Address lookups done, and how many of them found the address already
+ * in ipv4_hash_table or ipv6_hash_table */
+static guint64 host_lookups = 0;
+static guint64 host_lookup_hits = 0;
+
 static hashipv4_t *
 host_lookup(const guint addr, gboolean *found)
 {
@@ -857,11 +1163,13 @@ host_lookup(const guint addr, gboolean *found)
 
     *found = TRUE;
 
+    host_lookups++;
     tp = (hashipv4_t *)g_hash_table_lookup(ipv4_hash_table, GUINT_TO_POINTER(addr));
     if(tp == NULL){
         tp = new_ipv4(addr);
         g_hash_table_insert(ipv4_hash_table, GUINT_TO_POINTER(addr), tp);
     }else{
+        host_lookup_hits++;
         if ((tp->flags & DUMMY_AND_RESOLVE_FLGS) ==  DUMMY_ADDRESS_ENTRY){
             goto try_resolv;
         }
@@ -873,8 +1181,16 @@ host_lookup(const guint addr, gboolean *found)
 
 try_resolv:
     if (gbl_resolv_flags.network_name && gbl_resolv_flags.use_external_net_name_resolver) {
+        const gchar *cached;
+
         tp->flags = tp->flags|TRIED_RESOLVE_ADDRESS;
 
+        /* Use what DNS told us about it last time, if that's still fresh */
+        if ((cached = resolv_cache_lookup(tp->ip)) != NULL) {
+            g_strlcpy(tp->name, cached, MAXNAMELEN);
+            return tp;
+        }
+
 #ifdef ASYNC_DNS
         if (gbl_resolv_flags.concurrent_dns &&
                 name_resolve_concurrency > 0 &&
@@ -923,6 +1239,7 @@ host_lookup6(const struct e_in6_addr *addr, gboolean *found)
 
     *found = TRUE;
 
+    host_lookups++;
     tp = (hashipv6_t *)g_hash_table_lookup(ipv6_hash_table, addr);
     if(tp == NULL){
         struct e_in6_addr *addr_key;
@@ -932,6 +1249,7 @@ host_lookup6(const struct e_in6_addr *addr, gboolean *found)
         memcpy(addr_key, addr, 16);
         g_hash_table_insert(ipv6_hash_table, addr_key, tp);
     }else{
+        host_lookup_hits++;
         if ((tp->flags & DUMMY_AND_RESOLVE_FLGS) ==  DUMMY_ADDRESS_ENTRY){
             goto try_resolv;
         }
@@ -944,7 +1262,15 @@ host_lookup6(const struct e_in6_addr *addr, gboolean *found)
 try_resolv:
     if (gbl_resolv_flags.network_name &&
             gbl_resolv_flags.use_external_net_name_resolver) {
+        const gchar *cached;
+
         tp->flags = tp->flags|TRIED_RESOLVE_ADDRESS;
+
+        /* Use what DNS told us about it last time, if that's still fresh */
+        if ((cached = resolv_cache_lookup(tp->ip6)) != NULL) {
+            g_strlcpy(tp->name, cached, MAXNAMELEN);
+            return tp;
+        }
 #ifdef INET6
 
 #ifdef HAVE_C_ARES
@@ -959,11 +1285,7 @@ try_resolv:
             /* XXX found is set to TRUE, which seems a bit odd, but I'm not
              * going to risk changing the semantics.
              */
-            if ((tp->flags & DUMMY_ADDRESS_ENTRY) == 0){
-                g_strlcpy(tp->name, tp->ip6, MAXNAMELEN);
-                ip6_to_str_buf(addr, tp->name);
-                tp->flags = tp->flags | DUMMY_ADDRESS_ENTRY;
-            }
+            fill_dummy_ip6(tp);
             return tp;
         }
 #endif /* HAVE_C_ARES */
@@ -972,15 +1294,19 @@ try_resolv:
     }
 
     /* unknown host or DNS timeout */
-    if ((tp->flags & DUMMY_ADDRESS_ENTRY) == 0) {
-        tp->flags = tp->flags | DUMMY_ADDRESS_ENTRY;
-        g_strlcpy(tp->name, tp->ip6, MAXNAMELEN);
-    }
+    fill_dummy_ip6(tp);
     *found = FALSE;
     return tp;
 
 } /* host_lookup6 */
 
+void
+host_name_lookup_get_stats(guint64 *lookups, guint64 *hits)
+{
+    *lookups = host_lookups;
+    *hits = host_lookup_hits;
+}
+
 static const gchar *
 solve_address_to_name(const address *addr)
 {
@@ -1265,7 +1591,6 @@ get_ethbyaddr(const guint8 *addr)
 static void
 add_manuf_name(const guint8 *addr, unsigned int mask, gchar *name)
 {
-    guint8 *wka_key;
     int    *manuf_key;
 
     /*
@@ -1292,13 +1617,9 @@ add_manuf_name(const guint8 *addr, unsigned int mask, gchar *name)
         return;
     } /* mask == 0 */
 
-    /* This is a range of well-known addresses; add it to the appropriate
-       well-known-address table, creating that table if necessary. */
-
-    wka_key = (guint8 *)g_malloc(6);
-    memcpy(wka_key, addr, 6);
-
-    g_hash_table_insert(wka_hashtable, wka_key, g_strdup(name));
+    /* This is a range of well-known addresses; add it to the
+       well-known-address trie. */
+    prefix_trie_insert(&wka_trie, addr, mask, name, TRUE);
 
 } /* add_manuf_name */
 
@@ -1342,32 +1663,23 @@ manuf_name_lookup(const guint8 *addr)
 
 } /* manuf_name_lookup */
 
-static gchar *
-wka_name_lookup(const guint8 *addr, const unsigned int mask)
+/*
+ * Name an address in a range of well-known addresses with the name of the
+ * range followed by the bits of the address past the range's prefix.
+ */
+static void
+wka_name_fill(hashether_t *tp, const gchar *name, guint bits)
 {
-    guint8     masked_addr[6];
-    guint      num;
-    gint       i;
-    gchar     *name;
+    const guint8 *addr = tp->addr;
+    guint         i = bits / 8;
+    gulong        len;
 
-    if(wka_hashtable == NULL){
-        return NULL;
+    len = g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x",
+            name, addr[i] & (0xFF >> (bits % 8)));
+    for (i++; i < 6 && len < MAXNAMELEN; i++) {
+        len += g_snprintf(tp->resolved_name + len, (gulong)(MAXNAMELEN - len), ":%02x", addr[i]);
     }
-    /* Get the part of the address covered by the mask. */
-    for (i = 0, num = mask; num >= 8; i++, num -= 8)
-        masked_addr[i] = addr[i];   /* copy octets entirely covered by the mask */
-    /* Mask out the first masked octet */
-    masked_addr[i] = addr[i] & (0xFF << (8 - num));
-    i++;
-    /* Zero out completely-masked-out octets */
-    for (; i < 6; i++)
-        masked_addr[i] = 0;
-
-    name = (gchar *)g_hash_table_lookup(wka_hashtable, masked_addr);
-
-    return name;
-
-} /* wka_name_lookup */
+} /* wka_name_fill */
 
 static guint
 eth_addr_hash(gconstpointer key)
@@ -1389,7 +1701,6 @@ initialize_ethers(void)
     guint    mask;
 
     /* hash table initialization */
-    wka_hashtable   = g_hash_table_new_full(eth_addr_hash, eth_addr_cmp, g_free, g_free);
     manuf_hashtable = g_hash_table_new_full(g_int_hash, g_int_equal, g_free, g_free);
     eth_hashtable   = g_hash_table_new_full(eth_addr_hash, eth_addr_cmp, NULL, g_free);
 
@@ -1430,10 +1741,8 @@ eth_name_lookup_cleanup(void)
         g_hash_table_destroy(manuf_hashtable);
         manuf_hashtable = NULL;
     }
-    if(wka_hashtable) {
-        g_hash_table_destroy(wka_hashtable);
-        wka_hashtable = NULL;
-    }
+    prefix_trie_free(wka_trie);
+    wka_trie = NULL;
 
     if(eth_hashtable) {
         g_hash_table_destroy(eth_hashtable);
@@ -1453,52 +1762,18 @@ eth_addr_resolve(hashether_t *tp) {
         tp->status = HASHETHER_STATUS_RESOLVED_NAME;
         return tp;
     } else {
-        guint         mask;
+        const prefix_trie_node_t *wka;
         gchar        *name;
         address       ether_addr;
 
         /* Unknown name.  Try looking for it in the well-known-address
-           tables for well-known address ranges smaller than 2^24. */
-        mask = 7;
-        for (;;) {
-            /* Only the topmost 5 bytes participate fully */
-            if ((name = wka_name_lookup(addr, mask+40)) != NULL) {
-                g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x",
-                        name, addr[5] & (0xFF >> mask));
-                tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
-                return tp;
-            }
-            if (mask == 0)
-                break;
-            mask--;
-        }
-
-        mask = 7;
-        for (;;) {
-            /* Only the topmost 4 bytes participate fully */
-            if ((name = wka_name_lookup(addr, mask+32)) != NULL) {
-                g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x:%02x",
-                        name, addr[4] & (0xFF >> mask), addr[5]);
-                tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
-                return tp;
-            }
-            if (mask == 0)
-                break;
-            mask--;
-        }
-
-        mask = 7;
-        for (;;) {
-            /* Only the topmost 3 bytes participate fully */
-            if ((name = wka_name_lookup(addr, mask+24)) != NULL) {
-                g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x:%02x:%02x",
-                        name, addr[3] & (0xFF >> mask), addr[4], addr[5]);
-                tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
-                return tp;
-            }
-            if (mask == 0)
-                break;
-            mask--;
+           ranges; those smaller than 2^24 addresses come before the
+           manufacturer table, the larger ones after it. */
+        wka = prefix_trie_lookup(wka_trie, addr, 48);
+        if (wka != NULL && wka->bits >= 24) {
+            wka_name_fill(tp, wka->name, wka->bits);
+            tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
+            return tp;
         }
 
         /* Now try looking in the manufacturer table. */
@@ -1509,47 +1784,10 @@ eth_addr_resolve(hashether_t *tp) {
             return tp;
         }
 
-        /* Now try looking for it in the well-known-address
-           tables for well-known address ranges larger than 2^24. */
-        mask = 7;
-        for (;;) {
-            /* Only the topmost 2 bytes participate fully */
-            if ((name = wka_name_lookup(addr, mask+16)) != NULL) {
-                g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x:%02x:%02x:%02x",
-                        name, addr[2] & (0xFF >> mask), addr[3], addr[4],
-                        addr[5]);
-                tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
-                return tp;
-            }
-            if (mask == 0)
-                break;
-            mask--;
-        }
-
-        mask = 7;
-        for (;;) {
-            /* Only the topmost byte participates fully */
-            if ((name = wka_name_lookup(addr, mask+8)) != NULL) {
-                g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x:%02x:%02x:%02x:%02x",
-                        name, addr[1] & (0xFF >> mask), addr[2], addr[3],
-                        addr[4], addr[5]);
-                tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
-                return tp;
-            }
-            if (mask == 0)
-                break;
-            mask--;
-        }
-
-        for (mask = 7; mask > 0; mask--) {
-            /* Not even the topmost byte participates fully */
-            if ((name = wka_name_lookup(addr, mask)) != NULL) {
-                g_snprintf(tp->resolved_name, MAXNAMELEN, "%s_%02x:%02x:%02x:%02x:%02x:%02x",
-                        name, addr[0] & (0xFF >> mask), addr[1], addr[2],
-                        addr[3], addr[4], addr[5]);
-                tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
-                return tp;
-            }
+        if (wka != NULL) {
+            wka_name_fill(tp, wka->name, wka->bits);
+            tp->status = HASHETHER_STATUS_RESOLVED_DUMMY;
+            return tp;
         }
 
         /* No match whatsoever. */
@@ -2118,15 +2356,15 @@ get_addrinfo_list(void) {
  * <line> = <comment> | <entry> | <whitespace>
  * <comment> = <whitespace>#<any>
  * <entry> = <subnet_definition> <whitespace> <subnet_name> [<comment>|<whitespace><any>]
- * <subnet_definition> = <ipv4_address> / <subnet_mask_length>
- * <ipv4_address> is a full address; it will be masked to get the subnet-ID.
- * <subnet_mask_length> is a decimal 1-31
+ * <subnet_definition> = <ip_address> / <subnet_mask_length>
+ * <ip_address> is a full IPv4 or IPv6 address; it will be masked to get
+ *   the subnet-ID.
+ * <subnet_mask_length> is a decimal 1-31 for IPv4 and 1-127 for IPv6
  * <subnet_name> is a string containing no whitespace.
  * <whitespace> = (space | tab)+
  * Any malformed entries are ignored.
  * Any trailing data after the subnet_name is ignored.
- *
- * XXX Support IPv6
+ * If a subnet is defined more than once, the first definition is used.
  */
 static gboolean
 read_subnets_file (const char *subnetspath)
@@ -2135,7 +2373,9 @@ read_subnets_file (const char *subnetspath)
     char *line = NULL;
     int size = 0;
     gchar *cp, *cp2;
-    guint32 host_addr; /* IPv4 ONLY */
+    guint32 host_addr;
+    struct e_in6_addr host_addr6;
+    gboolean is_ipv6;
     int mask_length;
 
     if ((hf = ws_fopen(subnetspath, "r")) == NULL)
@@ -2149,7 +2389,7 @@ read_subnets_file (const char *subnetspath)
             continue; /* no tokens in the line */
 
 
-        /* Expected format is <IP4 address>/<subnet length> */
+        /* Expected format is <IP address>/<subnet length> */
         cp2 = strchr(cp, '/');
         if(NULL == cp2) {
             /* No length */
@@ -2158,20 +2398,28 @@ read_subnets_file (const char *subnetspath)
         *cp2 = '\0'; /* Cut token */
         ++cp2    ;
 
-        /* Check if this is a valid IPv4 address */
-        if (!str_to_ip(cp, &host_addr)) {
+        /* Check if this is a valid IPv4 or IPv6 address */
+        if (str_to_ip(cp, &host_addr)) {
+            is_ipv6 = FALSE;
+        } else if (str_to_ip6(cp, &host_addr6)) {
+            is_ipv6 = TRUE;
+        } else {
             continue; /* no */
         }
 
         mask_length = atoi(cp2);
-        if(0 >= mask_length || mask_length > 31) {
+        if(0 >= mask_length || mask_length > (is_ipv6 ? 127 : 31)) {
             continue; /* invalid mask length */
         }
 
         if ((cp = strtok(NULL, " \t")) == NULL)
             continue; /* no subnet name */
 
-        subnet_entry_set(host_addr, (guint32)mask_length, cp);
+        if (is_ipv6) {
+            prefix_trie_insert(&subnet6_trie, host_addr6.bytes, (guint)mask_length, cp, FALSE);
+        } else {
+            prefix_trie_insert(&subnet_trie, (const guint8 *)&host_addr, (guint)mask_length, cp, FALSE);
+        }
     }
     g_free(line);
 
@@ -2183,41 +2431,15 @@ static subnet_entry_t
 subnet_lookup(const guint32 addr)
 {
     subnet_entry_t subnet_entry;
-    guint32 i;
-
-    /* Search mask lengths linearly, longest first */
-
-    i = SUBNETLENGTHSIZE;
-    while(have_subnet_entry && i > 0) {
-        guint32 masked_addr;
-        subnet_length_entry_t* length_entry;
+    const prefix_trie_node_t *node;
 
-        /* Note that we run from 31 (length 32)  to 0 (length 1)  */
-        --i;
-        g_assert(i < SUBNETLENGTHSIZE);
-
-
-        length_entry = &subnet_length_entries[i];
-
-        if(NULL != length_entry->subnet_addresses) {
-            sub_net_hashipv4_t * tp;
-            guint32 hash_idx;
-
-            masked_addr = addr & length_entry->mask;
-            hash_idx = HASH_IPV4_ADDRESS(masked_addr);
-
-            tp = length_entry->subnet_addresses[hash_idx];
-            while(tp != NULL && tp->addr != masked_addr) {
-                tp = tp->next;
-            }
-
-            if(NULL != tp) {
-                subnet_entry.mask = length_entry->mask;
-                subnet_entry.mask_length = i + 1; /* Length is offset + 1 */
-                subnet_entry.name = tp->name;
-                return subnet_entry;
-            }
-        }
+    /* addr is in network byte order, so its bytes are in prefix order */
+    node = prefix_trie_lookup(subnet_trie, (const guint8 *)&addr, 32);
+    if (node != NULL) {
+        subnet_entry.mask = g_htonl(ip_get_subnet_mask(node->bits));
+        subnet_entry.mask_length = node->bits;
+        subnet_entry.name = node->name;
+        return subnet_entry;
     }
 
     subnet_entry.mask = 0;
@@ -2227,62 +2449,10 @@ subnet_lookup(const guint32 addr)
     return subnet_entry;
 }
 
-/* Add a subnet-definition - name pair to the set.
- * The definition is taken by masking the address passed in with the mask of the
- * given length.
- */
-static void
-subnet_entry_set(guint32 subnet_addr, const guint32 mask_length, const gchar* name)
-{
-    subnet_length_entry_t* entry;
-    sub_net_hashipv4_t * tp;
-    gsize hash_idx;
-
-    g_assert(mask_length > 0 && mask_length <= 32);
-
-    entry = &subnet_length_entries[mask_length - 1];
-
-    subnet_addr &= entry->mask;
-
-    hash_idx = HASH_IPV4_ADDRESS(subnet_addr);
-
-    if(NULL == entry->subnet_addresses) {
-        entry->subnet_addresses = (sub_net_hashipv4_t**) g_malloc0(sizeof(sub_net_hashipv4_t*) * HASHHOSTSIZE);
-    }
-
-    if(NULL != (tp = entry->subnet_addresses[hash_idx])) {
-        if(tp->addr == subnet_addr) {
-            return;    /* XXX provide warning that an address was repeated? */
-        } else {
-            sub_net_hashipv4_t * new_tp = g_new(sub_net_hashipv4_t, 1);
-            tp->next = new_tp;
-            tp = new_tp;
-        }
-    } else {
-        tp = entry->subnet_addresses[hash_idx] = g_new(sub_net_hashipv4_t, 1);
-    }
-
-    tp->next = NULL;
-    tp->addr = subnet_addr;
-    /* Clear DUMMY_ADDRESS_ENTRY */
-    tp->flags = tp->flags & 0xfe; /*Never used again...*/
-    g_strlcpy(tp->name, name, MAXNAMELEN); /* This is longer than subnet names can actually be */
-    have_subnet_entry = TRUE;
-}
-
 static void
 subnet_name_lookup_init(void)
 {
     gchar* subnetspath;
-    guint32 i;
-
-    for(i = 0; i < SUBNETLENGTHSIZE; ++i) {
-        guint32 length = i + 1;
-
-        subnet_length_entries[i].subnet_addresses  = NULL;
-        subnet_length_entries[i].mask_length  = length;
-        subnet_length_entries[i].mask = g_htonl(ip_get_subnet_mask(length));
-    }
 
     subnetspath = get_persconffile_path(ENAME_SUBNETS, FALSE);
     if (!read_subnets_file(subnetspath) && errno != ENOENT) {
@@ -2300,16 +2470,6 @@ subnet_name_lookup_init(void)
     g_free(subnetspath);
 }
 
-static void
-cleanup_subnet_entry(sub_net_hashipv4_t* entry)
-{
-    if ((entry != NULL) && (entry->next != NULL)) {
-        cleanup_subnet_entry(entry->next);
-    }
-
-    g_free(entry);
-}
-
 /*
  *  External Functions
  */
@@ -2335,6 +2495,13 @@ addr_resolve_pref_init(module_t *nameres)
             " capture file name resolution blocks and DNS packets in the capture.",
             &gbl_resolv_flags.network_name);
 
+    /* These only change how addresses and ports are shown (and hence what
+     * filters on resolved names match); the View menu toggles them without
+     * dissecting the packets again, too. */
+    prefs_set_preference_effect(nameres, "mac_name", PREF_EFFECT_DISPLAY|PREF_EFFECT_FILTER);
+    prefs_set_preference_effect(nameres, "transport_name", PREF_EFFECT_DISPLAY|PREF_EFFECT_FILTER);
+    prefs_set_preference_effect(nameres, "network_name", PREF_EFFECT_DISPLAY|PREF_EFFECT_FILTER);
+
     prefs_register_bool_preference(nameres, "use_external_name_resolver",
             "Use an external network name resolver",
             "Use your system's configured name resolver"
@@ -2486,6 +2653,8 @@ host_name_lookup_process(void) {
             if (ret == 0) {
                 if (ans->status == adns_s_ok) {
                     add_ipv4_name(almsg->ip4_addr, *ans->rrs.str);
+                    ip_to_str_buf((const guint8 *)&almsg->ip4_addr, addr_str, sizeof addr_str);
+                    resolv_cache_add(addr_str, *ans->rrs.str);
                 }
                 dequeue = TRUE;
             }
@@ -2686,6 +2855,8 @@ host_name_lookup_init(void)
     g_assert(ipv6_hash_table == NULL);
     ipv6_hash_table = g_hash_table_new_full(ipv6_oat_hash, ipv6_equal, g_free, g_free);
 
+    resolv_cache_load();
+
     /*
      * Load the global hosts file, if we have one.
      */
@@ -2785,9 +2956,10 @@ host_name_lookup_init(void)
 void
 host_name_lookup_cleanup(void)
 {
-    guint32 i, j;
     _host_name_lookup_cleanup();
 
+    resolv_cache_save();
+
     if(ipxnet_hash_table){
         g_hash_table_destroy(ipxnet_hash_table);
         ipxnet_hash_table = NULL;
@@ -2803,20 +2975,10 @@ host_name_lookup_cleanup(void)
         ipv6_hash_table = NULL;
     }
 
-    for(i = 0; i < SUBNETLENGTHSIZE; ++i) {
-        if (subnet_length_entries[i].subnet_addresses != NULL) {
-            for (j = 0; j < HASHHOSTSIZE; j++) {
-                if (subnet_length_entries[i].subnet_addresses[j] != NULL)
-                {
-                    cleanup_subnet_entry(subnet_length_entries[i].subnet_addresses[j]);
-                }
-            }
-            g_free(subnet_length_entries[i].subnet_addresses);
-            subnet_length_entries[i].subnet_addresses = NULL;
-        }
-    }
-
-    have_subnet_entry = FALSE;
+    prefix_trie_free(subnet_trie);
+    subnet_trie = NULL;
+    prefix_trie_free(subnet6_trie);
+    subnet6_trie = NULL;
     new_resolved_objects = FALSE;
 }
 
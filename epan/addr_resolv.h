@@ -163,6 +163,11 @@ extern void addr_resolve_pref_init(struct pref_module *nameres);
  */
 WS_DLL_PUBLIC gboolean host_name_lookup_process(void);
 
+/** How many IPv4 and IPv6 addresses have been looked up, and how many of
+ *  those lookups found the address already in the host name tables.
+ */
+WS_DLL_PUBLIC void host_name_lookup_get_stats(guint64 *lookups, guint64 *hits);
+
 /* get_hostname returns the host name or "%d.%d.%d.%d" if not found */
 WS_DLL_PUBLIC const gchar *get_hostname(const guint addr);
 
@@ -172,7 +172,9 @@ cmp_address(const address *addr1, const address *addr2) {
  * Given two addresses, return "true" if they're equal, "false" otherwise.
  * Addresses are equal only if they have the same type; if the type is
  * AT_NONE, they are then equal, otherwise they must have the same
- * amount of data and the data must be the same.
+ * amount of data and the data must be the same.  Interned addresses
+ * (see intern.h) with the same data share it, so they compare equal
+ * without looking at the data.
  *
  * @param addr1 [in] The first address to compare.
  * @param addr2 [in] The second address to compare.
@@ -183,7 +185,9 @@ addresses_equal(const address *addr1, const address *addr2) {
     if (addr1->type == addr2->type
             && ( addr1->type == AT_NONE
                  || ( addr1->len == addr2->len
-                      && memcmp(addr1->data, addr2->data, addr1->len) == 0
+                      && ( addr1->data == addr2->data
+                           || memcmp(addr1->data, addr2->data, addr1->len) == 0
+                           )
                       )
                  )
             ) return TRUE;
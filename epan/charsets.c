@@ -22,6 +22,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #include <epan/proto.h>
@@ -71,22 +73,54 @@
  * Octets with the highest bit set will be converted to the Unicode
  * REPLACEMENT CHARACTER.
  */
+
+/*
+ * Most strings in packets are plain ASCII, which is already UTF-8; the
+ * single-octet decoders below copy runs of it as they are, found with
+ * ws_ascii_span(), and only look at the other octets one at a time.
+ */
+static inline gint
+ascii_run(const guint8 *ptr, gint length)
+{
+    return length > 0 ? (gint) ws_ascii_span(ptr, (size_t) length) : 0;
+}
+
+/* A copy of length octets that are all ASCII */
+static guint8 *
+ascii_dup(wmem_allocator_t *scope, const guint8 *ptr, gint length)
+{
+    guint8 *buf;
+
+    buf = (guint8 *) wmem_alloc(scope, length+1);
+    memcpy(buf, ptr, length);
+    buf[length] = '\0';
+    return buf;
+}
+
 guint8 *
 get_ascii_string(wmem_allocator_t *scope, const guint8 *ptr, gint length)
 {
     wmem_strbuf_t *str;
+    gint           run;
+
+    run = ascii_run(ptr, length);
+    if (run == length)
+        return ascii_dup(scope, ptr, length);
 
     str = wmem_strbuf_sized_new(scope, length+1, 0);
 
-    while (length > 0) {
-        guint8 ch = *ptr;
+    for (;;) {
+        wmem_strbuf_append_len(str, (const gchar *) ptr, run);
+        ptr += run;
+        length -= run;
+        if (length <= 0)
+            break;
 
-        if (ch < 0x80)
-            wmem_strbuf_append_c(str, ch);
-        else
-            wmem_strbuf_append_unichar(str, UNREPL);
+        /* This octet has the high-order bit set */
+        wmem_strbuf_append_unichar(str, UNREPL);
         ptr++;
         length--;
+        run = ascii_run(ptr, length);
     }
 
     return (guint8 *) wmem_strbuf_finalize(str);
@@ -101,25 +135,31 @@ guint8 *
 get_8859_1_string(wmem_allocator_t *scope, const guint8 *ptr, gint length)
 {
     wmem_strbuf_t *str;
+    gint           run;
+
+    run = ascii_run(ptr, length);
+    if (run == length)
+        return ascii_dup(scope, ptr, length);
 
     str = wmem_strbuf_sized_new(scope, length+1, 0);
 
-    while (length > 0) {
-        guint8 ch = *ptr;
+    for (;;) {
+        wmem_strbuf_append_len(str, (const gchar *) ptr, run);
+        ptr += run;
+        length -= run;
+        if (length <= 0)
+            break;
 
-        if (ch < 0x80)
-            wmem_strbuf_append_c(str, ch);
-        else {
-            /*
-             * Note: we assume here that the code points
-             * 0x80-0x9F are used for C1 control characters,
-             * and thus have the same value as the corresponding
-             * Unicode code points.
-             */
-            wmem_strbuf_append_unichar(str, ch);
-        }
+        /*
+         * Note: we assume here that the code points
+         * 0x80-0x9F are used for C1 control characters,
+         * and thus have the same value as the corresponding
+         * Unicode code points.
+         */
+        wmem_strbuf_append_unichar(str, *ptr);
         ptr++;
         length--;
+        run = ascii_run(ptr, length);
     }
 
     return (guint8 *) wmem_strbuf_finalize(str);
@@ -485,18 +525,25 @@ guint8 *
 get_unichar2_string(wmem_allocator_t *scope, const guint8 *ptr, gint length, const gunichar2 table[0x80])
 {
     wmem_strbuf_t *str;
+    gint           run;
+
+    run = ascii_run(ptr, length);
+    if (run == length)
+        return ascii_dup(scope, ptr, length);
 
     str = wmem_strbuf_sized_new(scope, length+1, 0);
 
-    while (length > 0) {
-        guint8 ch = *ptr;
+    for (;;) {
+        wmem_strbuf_append_len(str, (const gchar *) ptr, run);
+        ptr += run;
+        length -= run;
+        if (length <= 0)
+            break;
 
-        if (ch < 0x80)
-            wmem_strbuf_append_c(str, ch);
-        else
-            wmem_strbuf_append_unichar(str, table[ch-0x80]);
+        wmem_strbuf_append_unichar(str, table[*ptr-0x80]);
         ptr++;
         length--;
+        run = ascii_run(ptr, length);
     }
 
     return (guint8 *) wmem_strbuf_finalize(str);
@@ -1021,19 +1068,19 @@ EBCDIC_to_ASCII1(guint8 c)
 guint8 *
 get_ebcdic_string(wmem_allocator_t *scope, const guint8 *ptr, gint length)
 {
-    wmem_strbuf_t *str;
+    guint8 *buf;
+    gint    i;
 
-    str = wmem_strbuf_sized_new(scope, length+1, 0);
+    if (length < 0)
+        length = 0;
 
-    while (length > 0) {
-        guint8 ch = *ptr;
+    /* The table maps everything to ASCII, one octet for one octet */
+    buf = (guint8 *) wmem_alloc(scope, length+1);
+    for (i = 0; i < length; i++)
+        buf[i] = EBCDIC_translate_ASCII[ptr[i]];
+    buf[length] = '\0';
 
-        wmem_strbuf_append_unichar(str, EBCDIC_translate_ASCII[ch]);
-        ptr++;
-        length--;
-    }
-
-    return (guint8 *) wmem_strbuf_finalize(str);
+    return buf;
 }
 
 /*
@@ -33,15 +33,6 @@ static GHashTable *circuit_hashtable = NULL;
 
 static guint32 new_index;
 
-/*
- * Protocol-specific data attached to a circuit_t structure - protocol
- * index and opaque pointer.
- */
-typedef struct _circuit_proto_data {
-	int	proto;
-	void	*proto_data;
-} circuit_proto_data;
-
 /*
  * Compute the hash value for a circuit.
  */
@@ -207,68 +198,23 @@ close_circuit(circuit_t *circuit, guint32 last_frame)
 		circuit->last_frame = last_frame;
 }
 
-static gint
-p_compare(gconstpointer a, gconstpointer b)
-{
-	const circuit_proto_data *ap = (const circuit_proto_data *)a;
-	const circuit_proto_data *bp = (const circuit_proto_data *)b;
-
-	if (ap->proto > bp->proto)
-		return 1;
-	else if (ap->proto == bp->proto)
-		return 0;
-	else
-		return -1;
-}
-
 void
 circuit_add_proto_data(circuit_t *conv, int proto, void *proto_data)
 {
-	circuit_proto_data *p1 = wmem_new(wmem_file_scope(), circuit_proto_data);
-
-	p1->proto = proto;
-	p1->proto_data = proto_data;
-
-	/* Add it to the list of items for this circuit. */
-
-	conv->data_list = g_slist_insert_sorted(conv->data_list, (gpointer *)p1,
-	    p_compare);
+	proto_data_vec_add(wmem_file_scope(), &conv->data_list, proto, 0,
+	    proto_data);
 }
 
 void *
 circuit_get_proto_data(circuit_t *conv, int proto)
 {
-	circuit_proto_data temp, *p1;
-	GSList *item;
-
-	temp.proto = proto;
-	temp.proto_data = NULL;
-
-	item = g_slist_find_custom(conv->data_list, (gpointer *)&temp,
-	    p_compare);
-
-	if (item != NULL) {
-		p1 = (circuit_proto_data *)item->data;
-		return p1->proto_data;
-	}
-
-	return NULL;
+	return proto_data_vec_get(conv->data_list, proto, 0);
 }
 
 void
 circuit_delete_proto_data(circuit_t *conv, int proto)
 {
-	circuit_proto_data temp;
-	GSList *item;
-
-	temp.proto = proto;
-	temp.proto_data = NULL;
-
-	item = g_slist_find_custom(conv->data_list, (gpointer *)&temp,
-	    p_compare);
-
-	if (item != NULL)
-		conv->data_list = g_slist_remove(conv->data_list, item);
+	proto_data_vec_remove(conv->data_list, proto, 0);
 }
 
 void
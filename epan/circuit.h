@@ -43,7 +43,7 @@ typedef struct circuit {
 	guint32 first_frame;		/**< # of first frame for that circuit */
 	guint32 last_frame;			/**< # of last frame for that circuit */
 	guint32	index;				/**< unique ID for circuit */
-	GSList *data_list;			/**< list of data associated with circuit */
+	proto_data_vec *data_list;	/**< data associated with circuit */
 	dissector_handle_t dissector_handle; /**< handle for protocol dissector client associated with circuit */
 	guint	options;			/**< wildcard flags */
 	circuit_key *key_ptr;		/**< pointer to the key for this circuit */
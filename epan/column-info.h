@@ -61,6 +61,8 @@ struct epan_column_info {
   int                *col_fence;            /**< Stuff in column buffer before this index is immutable */
   col_expr_t          col_expr;             /**< Column expressions and values */
   gboolean            writable;             /**< writable or not @todo Are we still writing to the columns? */
+  gboolean           *col_used;             /**< Whether anything uses the column's contents */
+  gboolean           *fmt_used;             /**< Whether any column with a given format is used */
 };
 
 #ifdef __cplusplus
@@ -67,10 +67,16 @@ col_setup(column_info *cinfo, const gint num_cols)
   cinfo->col_fence             = g_new(int, num_cols);
   cinfo->col_expr.col_expr     = g_new(const gchar*, num_cols + 1);
   cinfo->col_expr.col_expr_val = g_new(gchar*, num_cols + 1);
+  cinfo->col_used              = g_new(gboolean, num_cols);
+  cinfo->fmt_used              = g_new(gboolean, NUM_COL_FMTS);
 
+  for (i = 0; i < num_cols; i++) {
+    cinfo->col_used[i] = TRUE;
+  }
   for (i = 0; i < NUM_COL_FMTS; i++) {
     cinfo->col_first[i] = -1;
     cinfo->col_last[i] = -1;
+    cinfo->fmt_used[i] = TRUE;
   }
 }
 
@@ -129,6 +135,8 @@ col_cleanup(column_info *cinfo)
   /* XXX - see above */
   g_free((gchar **)cinfo->col_expr.col_expr);
   g_free(cinfo->col_expr.col_expr_val);
+  g_free(cinfo->col_used);
+  g_free(cinfo->fmt_used);
 }
 
 /* Initialize the data structures for constructing column data. */
@@ -166,12 +174,56 @@ col_set_writable(column_info *cinfo, const gboolean writable)
     cinfo->writable = writable;
 }
 
+/* Recompute which formats have a column that is used */
+static void
+col_update_fmt_used(column_info *cinfo)
+{
+  int i, el;
+
+  for (el = 0; el < NUM_COL_FMTS; el++) {
+    cinfo->fmt_used[el] = FALSE;
+    if (cinfo->col_first[el] < 0)
+      continue;
+    for (i = cinfo->col_first[el]; i <= cinfo->col_last[el]; i++) {
+      if (cinfo->fmt_matx[i][el] && cinfo->col_used[i]) {
+        cinfo->fmt_used[el] = TRUE;
+        break;
+      }
+    }
+  }
+}
+
+void
+col_set_used(column_info *cinfo, const gint col, const gboolean used)
+{
+  if (!cinfo || col < 0 || col >= cinfo->num_cols)
+    return;
+
+  cinfo->col_used[col] = used;
+  col_update_fmt_used(cinfo);
+}
+
+void
+col_set_all_used(column_info *cinfo, const gboolean used)
+{
+  int i;
+
+  if (!cinfo)
+    return;
+
+  for (i = 0; i < cinfo->num_cols; i++)
+    cinfo->col_used[i] = used;
+  col_update_fmt_used(cinfo);
+}
+
 /* Checks to see if a particular packet information element is needed for the packet list */
 #define CHECK_COL(cinfo, el) \
     /* We are constructing columns, and they're writable */ \
     (COL_GET_WRITABLE(cinfo) && \
       /* There is at least one column in that format */ \
-    ((cinfo)->col_first[el] >= 0))
+    ((cinfo)->col_first[el] >= 0) && \
+      /* and something is going to read it */ \
+    (cinfo)->fmt_used[el])
 
 /* Sets the fence for a column to be at the end of the column. */
 void
@@ -307,6 +359,7 @@ void col_custom_set_edt(epan_dissect_t *edt, column_info *cinfo)
   for (i = cinfo->col_first[COL_CUSTOM];
        i <= cinfo->col_last[COL_CUSTOM]; i++) {
     if (cinfo->fmt_matx[i][COL_CUSTOM] &&
+        cinfo->col_used[i] &&
         cinfo->col_custom_field[i] &&
         cinfo->col_custom_field_ids[i]) {
         cinfo->col_data[i] = cinfo->col_buf[i];
@@ -807,113 +860,203 @@ col_has_time_fmt(column_info *cinfo, const gint col)
           (cinfo->fmt_matx[col][COL_DELTA_TIME_DIS]));
 }
 
+/* Which calendar fields an absolute time column shows */
+typedef enum {
+  ABS_TIME_HMS,   /* 12:34:56 */
+  ABS_TIME_YMD,   /* 2015-01-02 12:34:56 */
+  ABS_TIME_YDOY,  /* 2015/002 12:34:56 */
+  NUM_ABS_TIME_STYLES
+} abs_time_style_e;
+
+/*
+ * Packets mostly arrive in timestamp order and many of them share a
+ * second, so each absolute time style remembers the whole seconds it
+ * formatted last, in local time and in UTC, and only the fraction gets
+ * formatted for the packets after it.
+ */
+typedef struct {
+  gboolean valid;
+  time_t   secs;
+  size_t   len;
+  gchar    str[COL_MAX_LEN];
+} abs_time_cache_t;
+
+static abs_time_cache_t abs_time_cache[NUM_ABS_TIME_STYLES][2];
+
+/*
+ * localtime() looks the time up in the time zone rules every time it's
+ * called.  The offset from UTC only changes on a minute boundary, so
+ * keep the minute the last conversion fell in and fill in the seconds
+ * for times in the same minute.
+ */
+typedef struct {
+  gboolean  valid;
+  time_t    minute_start;
+  struct tm tm;
+} tm_cache_t;
+
+static tm_cache_t tm_cache[2];
+
+static struct tm *
+cached_time(time_t then, gboolean local)
+{
+  tm_cache_t *cache = &tm_cache[local ? 1 : 0];
+  struct tm *tmp;
+
+  if (cache->valid && then >= cache->minute_start &&
+      then - cache->minute_start < 60) {
+    cache->tm.tm_sec = (int)(then - cache->minute_start);
+    return &cache->tm;
+  }
+
+  if (local)
+    tmp = localtime(&then);
+  else
+    tmp = gmtime(&then);
+  if (tmp == NULL)
+    return NULL;
+
+  cache->tm = *tmp;
+  if (tmp->tm_sec < 60) {
+    cache->minute_start = then - tmp->tm_sec;
+    cache->valid = TRUE;
+  } else {
+    /* A leap second; don't let it stretch the minute */
+    cache->valid = FALSE;
+  }
+  return &cache->tm;
+}
+
+static int
+get_tsprecision(const frame_data *fd)
+{
+  switch (timestamp_get_precision()) {
+  case TS_PREC_FIXED_SEC:
+    return WTAP_TSPREC_SEC;
+  case TS_PREC_FIXED_DSEC:
+    return WTAP_TSPREC_DSEC;
+  case TS_PREC_FIXED_CSEC:
+    return WTAP_TSPREC_CSEC;
+  case TS_PREC_FIXED_MSEC:
+    return WTAP_TSPREC_MSEC;
+  case TS_PREC_FIXED_USEC:
+    return WTAP_TSPREC_USEC;
+  case TS_PREC_FIXED_NSEC:
+    return WTAP_TSPREC_NSEC;
+  case TS_PREC_AUTO:
+    return fd->tsprec;
+  default:
+    g_assert_not_reached();
+    return WTAP_TSPREC_SEC;
+  }
+}
+
+/* Append "." and the first digits of nsecs, with leading zeroes */
+static gchar *
+put_fraction(gchar *p, gint32 nsecs, int digits)
+{
+  static const gint32 divisors[] = {
+    1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1
+  };
+  guint32 value;
+  int i;
+
+  if (nsecs < 0 || nsecs >= 1000000000) {
+    /* Bogus timestamp; show it the way printf does */
+    return p + g_snprintf(p, 16, ".%0*d", digits, nsecs / divisors[digits]);
+  }
+
+  value = nsecs / divisors[digits];
+  *p++ = '.';
+  for (i = digits - 1; i >= 0; i--) {
+    p[i] = '0' + value % 10;
+    value /= 10;
+  }
+  return p + digits;
+}
+
 static void
-set_abs_ymd_time(const frame_data *fd, gchar *buf, gboolean local)
+set_abs_time_style(const frame_data *fd, gchar *buf, gboolean local,
+                   abs_time_style_e style)
 {
+  abs_time_cache_t *cache = &abs_time_cache[style][local ? 1 : 0];
   struct tm *tmp;
-  time_t then;
-  int tsprecision;
+  gchar *p;
 
-  if (fd->flags.has_ts) {
-    then = fd->abs_ts.secs;
-    if (local)
-      tmp = localtime(&then);
-    else
-      tmp = gmtime(&then);
-  } else
-    tmp = NULL;
-  if (tmp != NULL) {
-    switch (timestamp_get_precision()) {
-    case TS_PREC_FIXED_SEC:
-      tsprecision = WTAP_TSPREC_SEC;
-      break;
-    case TS_PREC_FIXED_DSEC:
-      tsprecision = WTAP_TSPREC_DSEC;
-      break;
-    case TS_PREC_FIXED_CSEC:
-      tsprecision = WTAP_TSPREC_CSEC;
-      break;
-    case TS_PREC_FIXED_MSEC:
-      tsprecision = WTAP_TSPREC_MSEC;
-      break;
-    case TS_PREC_FIXED_USEC:
-      tsprecision = WTAP_TSPREC_USEC;
-      break;
-    case TS_PREC_FIXED_NSEC:
-      tsprecision = WTAP_TSPREC_NSEC;
-      break;
-    case TS_PREC_AUTO:
-      tsprecision = fd->tsprec;
-      break;
-    default:
-      g_assert_not_reached();
+  if (!fd->flags.has_ts) {
+    buf[0] = '\0';
+    return;
+  }
+
+  if (!cache->valid || cache->secs != fd->abs_ts.secs) {
+    tmp = cached_time(fd->abs_ts.secs, local);
+    if (tmp == NULL) {
+      buf[0] = '\0';
+      return;
     }
-    switch (tsprecision) {
-    case WTAP_TSPREC_SEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d-%02d-%02d %02d:%02d:%02d",
-        tmp->tm_year + 1900,
-        tmp->tm_mon + 1,
-        tmp->tm_mday,
+    switch (style) {
+    case ABS_TIME_HMS:
+      g_snprintf(cache->str, sizeof cache->str, "%02d:%02d:%02d",
         tmp->tm_hour,
         tmp->tm_min,
         tmp->tm_sec);
       break;
-    case WTAP_TSPREC_DSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d-%02d-%02d %02d:%02d:%02d.%01d",
-        tmp->tm_year + 1900,
-        tmp->tm_mon + 1,
-        tmp->tm_mday,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 100000000);
-      break;
-    case WTAP_TSPREC_CSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d-%02d-%02d %02d:%02d:%02d.%02d",
-        tmp->tm_year + 1900,
-        tmp->tm_mon + 1,
-        tmp->tm_mday,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 10000000);
-      break;
-    case WTAP_TSPREC_MSEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d-%02d-%02d %02d:%02d:%02d.%03d",
-        tmp->tm_year + 1900,
-        tmp->tm_mon + 1,
-        tmp->tm_mday,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000000);
-      break;
-    case WTAP_TSPREC_USEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d-%02d-%02d %02d:%02d:%02d.%06d",
+    case ABS_TIME_YMD:
+      g_snprintf(cache->str, sizeof cache->str, "%04d-%02d-%02d %02d:%02d:%02d",
         tmp->tm_year + 1900,
         tmp->tm_mon + 1,
         tmp->tm_mday,
         tmp->tm_hour,
         tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000);
+        tmp->tm_sec);
       break;
-    case WTAP_TSPREC_NSEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d-%02d-%02d %02d:%02d:%02d.%09d",
+    case ABS_TIME_YDOY:
+      g_snprintf(cache->str, sizeof cache->str, "%04d/%03d %02d:%02d:%02d",
         tmp->tm_year + 1900,
-        tmp->tm_mon + 1,
-        tmp->tm_mday,
+        tmp->tm_yday + 1,
         tmp->tm_hour,
         tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs);
+        tmp->tm_sec);
       break;
     default:
       g_assert_not_reached();
     }
-  } else {
-    buf[0] = '\0';
+    cache->secs = fd->abs_ts.secs;
+    cache->len = strlen(cache->str);
+    cache->valid = TRUE;
   }
+
+  /* The whole seconds are short enough to leave room for any fraction */
+  memcpy(buf, cache->str, cache->len);
+  p = buf + cache->len;
+  switch (get_tsprecision(fd)) {
+  case WTAP_TSPREC_SEC:
+    break;
+  case WTAP_TSPREC_DSEC:
+    p = put_fraction(p, fd->abs_ts.nsecs, 1);
+    break;
+  case WTAP_TSPREC_CSEC:
+    p = put_fraction(p, fd->abs_ts.nsecs, 2);
+    break;
+  case WTAP_TSPREC_MSEC:
+    p = put_fraction(p, fd->abs_ts.nsecs, 3);
+    break;
+  case WTAP_TSPREC_USEC:
+    p = put_fraction(p, fd->abs_ts.nsecs, 6);
+    break;
+  case WTAP_TSPREC_NSEC:
+    p = put_fraction(p, fd->abs_ts.nsecs, 9);
+    break;
+  default:
+    g_assert_not_reached();
+  }
+  *p = '\0';
+}
+
+static void
+set_abs_ymd_time(const frame_data *fd, gchar *buf, gboolean local)
+{
+  set_abs_time_style(fd, buf, local, ABS_TIME_YMD);
 }
 
 static void
@@ -939,104 +1082,7 @@ col_set_utc_ymd_time(const frame_data *fd, column_info *cinfo, const int col)
 static void
 set_abs_ydoy_time(const frame_data *fd, gchar *buf, gboolean local)
 {
-  struct tm *tmp;
-  time_t then;
-  int tsprecision;
-
-  if (fd->flags.has_ts) {
-    then = fd->abs_ts.secs;
-    if (local)
-      tmp = localtime(&then);
-    else
-      tmp = gmtime(&then);
-  } else
-    tmp = NULL;
-  if (tmp != NULL) {
-    switch (timestamp_get_precision()) {
-    case TS_PREC_FIXED_SEC:
-      tsprecision = WTAP_TSPREC_SEC;
-      break;
-    case TS_PREC_FIXED_DSEC:
-      tsprecision = WTAP_TSPREC_DSEC;
-      break;
-    case TS_PREC_FIXED_CSEC:
-      tsprecision = WTAP_TSPREC_CSEC;
-      break;
-    case TS_PREC_FIXED_MSEC:
-      tsprecision = WTAP_TSPREC_MSEC;
-      break;
-    case TS_PREC_FIXED_USEC:
-      tsprecision = WTAP_TSPREC_USEC;
-      break;
-    case TS_PREC_FIXED_NSEC:
-      tsprecision = WTAP_TSPREC_NSEC;
-      break;
-    case TS_PREC_AUTO:
-      tsprecision = fd->tsprec;
-      break;
-    default:
-      g_assert_not_reached();
-    }
-    switch (tsprecision) {
-    case WTAP_TSPREC_SEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d/%03d %02d:%02d:%02d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec);
-      break;
-    case WTAP_TSPREC_DSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d/%03d %02d:%02d:%02d.%01d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 100000000);
-      break;
-    case WTAP_TSPREC_CSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%04d/%03d %02d:%02d:%02d.%02d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 10000000);
-      break;
-    case WTAP_TSPREC_MSEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d/%03d %02d:%02d:%02d.%03d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000000);
-      break;
-    case WTAP_TSPREC_USEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d/%03d %02d:%02d:%02d.%06d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000);
-      break;
-    case WTAP_TSPREC_NSEC:
-      g_snprintf(buf, COL_MAX_LEN, "%04d/%03d %02d:%02d:%02d.%09d",
-        tmp->tm_year + 1900,
-        tmp->tm_yday + 1,
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs);
-      break;
-    default:
-      g_assert_not_reached();
-    }
-  } else {
-    buf[0] = '\0';
-  }
+  set_abs_time_style(fd, buf, local, ABS_TIME_YDOY);
 }
 
 static void
@@ -1377,93 +1423,7 @@ col_set_delta_time_dis(const frame_data *fd, column_info *cinfo, const int col)
 static void
 set_abs_time(const frame_data *fd, gchar *buf, gboolean local)
 {
-  struct tm *tmp;
-  time_t then;
-  int tsprecision;
-
-  if (fd->flags.has_ts) {
-    then = fd->abs_ts.secs;
-    if (local)
-      tmp = localtime(&then);
-    else
-      tmp = gmtime(&then);
-  } else
-    tmp = NULL;
-  if (tmp != NULL) {
-    switch (timestamp_get_precision()) {
-    case TS_PREC_FIXED_SEC:
-      tsprecision = WTAP_TSPREC_SEC;
-      break;
-    case TS_PREC_FIXED_DSEC:
-      tsprecision = WTAP_TSPREC_DSEC;
-      break;
-    case TS_PREC_FIXED_CSEC:
-      tsprecision = WTAP_TSPREC_CSEC;
-      break;
-    case TS_PREC_FIXED_MSEC:
-      tsprecision = WTAP_TSPREC_MSEC;
-      break;
-    case TS_PREC_FIXED_USEC:
-      tsprecision = WTAP_TSPREC_USEC;
-      break;
-    case TS_PREC_FIXED_NSEC:
-      tsprecision = WTAP_TSPREC_NSEC;
-      break;
-    case TS_PREC_AUTO:
-      tsprecision = fd->tsprec;
-      break;
-    default:
-      g_assert_not_reached();
-    }
-    switch (tsprecision) {
-    case WTAP_TSPREC_SEC:
-      g_snprintf(buf, COL_MAX_LEN,"%02d:%02d:%02d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec);
-      break;
-    case WTAP_TSPREC_DSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%02d:%02d:%02d.%01d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 100000000);
-      break;
-    case WTAP_TSPREC_CSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%02d:%02d:%02d.%02d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 10000000);
-      break;
-    case WTAP_TSPREC_MSEC:
-      g_snprintf(buf, COL_MAX_LEN,"%02d:%02d:%02d.%03d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000000);
-      break;
-    case WTAP_TSPREC_USEC:
-      g_snprintf(buf, COL_MAX_LEN,"%02d:%02d:%02d.%06d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs / 1000);
-      break;
-    case WTAP_TSPREC_NSEC:
-      g_snprintf(buf, COL_MAX_LEN, "%02d:%02d:%02d.%09d",
-        tmp->tm_hour,
-        tmp->tm_min,
-        tmp->tm_sec,
-        fd->abs_ts.nsecs);
-      break;
-    default:
-      g_assert_not_reached();
-    }
-
-  } else {
-    *buf = '\0';
-  }
+  set_abs_time_style(fd, buf, local, ABS_TIME_HMS);
 }
 
 static void
@@ -2122,6 +2082,8 @@ col_fill_in(packet_info *pinfo, const gboolean fill_col_exprs, const gboolean fi
     return;
 
   for (i = 0; i < pinfo->cinfo->num_cols; i++) {
+    if (!pinfo->cinfo->col_used[i])
+      continue;
     if (col_based_on_frame_data(pinfo->cinfo, i)) {
       if (fill_fd_colums)
         col_fill_in_frame_data(pinfo->fd, pinfo->cinfo, i, fill_col_exprs);
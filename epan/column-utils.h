@@ -157,6 +157,28 @@ WS_DLL_PUBLIC void	col_fill_in(packet_info *pinfo, const gboolean fill_col_exprs
  */
 WS_DLL_PUBLIC void	col_fill_in_error(column_info *cinfo, frame_data *fdata, const gboolean fill_col_exprs, const gboolean fill_fd_colums);
 
+/** Say whether anything (output, sorting, a tap) will read a column.
+ * Columns start out used; ones that aren't used aren't filled in, and
+ * the col_ routines are no-ops for a format that only unused columns
+ * have, so dissectors don't spend time formatting text nobody reads.
+ *
+ * Internal, don't use this in dissectors!
+ *
+ * @param cinfo the current packet row
+ * @param col the column
+ * @param used TRUE if something reads the column, FALSE if not
+ */
+WS_DLL_PUBLIC void	col_set_used(column_info *cinfo, const gint col, const gboolean used);
+
+/** Say whether anything will read any of the columns; see col_set_used().
+ *
+ * Internal, don't use this in dissectors!
+ *
+ * @param cinfo the current packet row
+ * @param used TRUE if something reads the columns, FALSE if not
+ */
+WS_DLL_PUBLIC void	col_set_all_used(column_info *cinfo, const gboolean used);
+
 /* Utility routines used by packet*.c */
 
 /** Are the columns writable?
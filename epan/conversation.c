@@ -29,6 +29,7 @@
 #include "packet.h"
 #include "to_str.h"
 #include "conversation.h"
+#include "intern.h"
 
 /* define DEBUG_CONVERSATION for pretty debug printing */
 /* #define DEBUG_CONVERSATION */
@@ -39,25 +40,44 @@ int _debug_conversation_indent = 0;
 #endif
 
 /*
- * Hash table for conversations with no wildcards.
+ * The conversation tables for one dissection session.
  */
-static GHashTable *conversation_hashtable_exact = NULL;
+struct conversation_tables {
+	/*
+	 * Hash table for conversations with no wildcards.
+	 */
+	conversation_hashtable_t *hashtable_exact;
 
-/*
- * Hash table for conversations with one wildcard address.
- */
-static GHashTable *conversation_hashtable_no_addr2 = NULL;
+	/*
+	 * Hash table for conversations with one wildcard address.
+	 */
+	conversation_hashtable_t *hashtable_no_addr2;
 
-/*
- * Hash table for conversations with one wildcard port.
- */
-static GHashTable *conversation_hashtable_no_port2 = NULL;
+	/*
+	 * Hash table for conversations with one wildcard port.
+	 */
+	conversation_hashtable_t *hashtable_no_port2;
 
-/*
- * Hash table for conversations with one wildcard address and port.
- */
-static GHashTable *conversation_hashtable_no_addr2_or_port2 = NULL;
+	/*
+	 * Hash table for conversations with one wildcard address and port.
+	 */
+	conversation_hashtable_t *hashtable_no_addr2_or_port2;
+
+	/*
+	 * Linked list of conversation keys, so we can, before freeing them all,
+	 * free the address data allocations associated with them.
+	 */
+	conversation_key *keys;
+
+	guint32 new_index;
 
+	/*
+	 * Bumped whenever a conversation's dissector is set, so callers
+	 * can tell whether a conversation dissector lookup could give a
+	 * different answer than it did before.
+	 */
+	guint32 dissector_generation;
+};
 
 #ifdef __NOT_USED__
 typedef struct conversation_key {
@@ -69,22 +89,199 @@ typedef struct conversation_key {
 	guint32	port2;
 } conversation_key;
 #endif
+
+/*
+ * The conversation tables currently used for conversation lookups and
+ * creation, i.e. those of the session being dissected.  There are none
+ * before conversation_init() is first called or after
+ * conversation_cleanup().
+ */
+static conversation_tables_t *conversation_tables_current = NULL;
+
 /*
- * Linked list of conversation keys, so we can, before freeing them all,
- * free the address data allocations associated with them.
+ * The conversation hash tables are open-addressing tables with linear
+ * probing rather than GHashTables; each slot holds the key's hash value
+ * along with the key and the head of the conversation chain for that key,
+ * so a lookup usually touches a single slot and only dereferences the key
+ * of an entry whose hash value matches.  The set of conversations is
+ * typically large and lookups happen for nearly every packet, so avoiding
+ * GHashTable's separate node allocations and pointer chasing matters.
  */
-static conversation_key *conversation_keys;
+typedef struct _conversation_hashtable_slot {
+	guint hash;			/* hash value of key */
+	conversation_key *key;		/* NULL if the slot is empty */
+	conversation_t *chain_head;	/* first conversation with that key */
+} conversation_hashtable_slot;
+
+struct conversation_hashtable {
+	conversation_hashtable_slot *slots;
+	guint mask;			/* number of slots - 1 */
+	guint count;			/* number of slots in use */
+	GHashFunc hash_func;
+	GEqualFunc match_func;
+};
+
+/* Initial number of slots; must be a power of 2. */
+#define CONVERSATION_HASHTABLE_INITIAL_SIZE	256
+
+/* Grow the table once it is more than 3/4 full. */
+#define CONVERSATION_HASHTABLE_NEEDS_GROWTH(table) \
+	(((table)->count + 1) * 4 > ((table)->mask + 1) * 3)
+
+static conversation_hashtable_t *
+conversation_hashtable_new(GHashFunc hash_func, GEqualFunc match_func)
+{
+	conversation_hashtable_t *table = g_new(conversation_hashtable_t, 1);
+
+	table->slots = g_new0(conversation_hashtable_slot, CONVERSATION_HASHTABLE_INITIAL_SIZE);
+	table->mask = CONVERSATION_HASHTABLE_INITIAL_SIZE - 1;
+	table->count = 0;
+	table->hash_func = hash_func;
+	table->match_func = match_func;
+
+	return table;
+}
 
-static guint32 new_index;
+static void free_data_list(gpointer value);
 
 /*
- * Protocol-specific data attached to a conversation_t structure - protocol
- * index and opaque pointer.
+ * Destroy a table, freeing the proto_data of the conversations at the
+ * head of each chain as the GHashTable value destroy function used to do.
  */
-typedef struct _conv_proto_data {
-	int	proto;
-	void	*proto_data;
-} conv_proto_data;
+static void
+conversation_hashtable_destroy(conversation_hashtable_t *table)
+{
+	guint i;
+
+	for (i = 0; i <= table->mask; i++) {
+		if (table->slots[i].key != NULL)
+			free_data_list(table->slots[i].chain_head);
+	}
+	g_free(table->slots);
+	g_free(table);
+}
+
+/*
+ * Return the slot holding key, or the empty slot at which key would
+ * be inserted.
+ */
+static inline conversation_hashtable_slot *
+conversation_hashtable_find_slot(const conversation_hashtable_t *table,
+    const conversation_key *key, guint hash)
+{
+	guint i = hash & table->mask;
+	conversation_hashtable_slot *slot;
+
+	for (;;) {
+		slot = &table->slots[i];
+		if (slot->key == NULL)
+			return slot;
+		if (slot->hash == hash && table->match_func(slot->key, key))
+			return slot;
+		i = (i + 1) & table->mask;
+	}
+}
+
+static void
+conversation_hashtable_grow(conversation_hashtable_t *table)
+{
+	conversation_hashtable_slot *old_slots = table->slots;
+	guint old_size = table->mask + 1;
+	guint i, j;
+
+	table->mask = old_size * 2 - 1;
+	table->slots = g_new0(conversation_hashtable_slot, old_size * 2);
+
+	/* The cached hash values mean we never have to rehash the keys. */
+	for (i = 0; i < old_size; i++) {
+		if (old_slots[i].key == NULL)
+			continue;
+		for (j = old_slots[i].hash & table->mask;
+		     table->slots[j].key != NULL;
+		     j = (j + 1) & table->mask)
+			;
+		table->slots[j] = old_slots[i];
+	}
+	g_free(old_slots);
+}
+
+static conversation_t *
+conversation_hashtable_lookup(const conversation_hashtable_t *table,
+    const conversation_key *key)
+{
+	return conversation_hashtable_find_slot(table, key,
+	    table->hash_func(key))->chain_head;
+}
+
+/*
+ * Set the conversation chain for key, replacing any existing one.
+ * The key must stay valid for as long as it's in the table.
+ */
+static void
+conversation_hashtable_insert(conversation_hashtable_t *table,
+    conversation_key *key, conversation_t *chain_head)
+{
+	guint hash = table->hash_func(key);
+	conversation_hashtable_slot *slot;
+
+	if (CONVERSATION_HASHTABLE_NEEDS_GROWTH(table))
+		conversation_hashtable_grow(table);
+
+	slot = conversation_hashtable_find_slot(table, key, hash);
+	if (slot->key == NULL)
+		table->count++;
+	slot->hash = hash;
+	slot->key = key;
+	slot->chain_head = chain_head;
+}
+
+/*
+ * Remove key from the table without freeing anything.
+ */
+static void
+conversation_hashtable_steal(conversation_hashtable_t *table,
+    const conversation_key *key)
+{
+	conversation_hashtable_slot *slot;
+	guint i, j, ideal;
+
+	slot = conversation_hashtable_find_slot(table, key, table->hash_func(key));
+	if (slot->key == NULL)
+		return;
+	table->count--;
+
+	/*
+	 * Backward-shift the entries following the removed one, so that
+	 * lookups never have to skip over deleted slots.
+	 */
+	i = (guint)(slot - table->slots);
+	for (j = (i + 1) & table->mask; table->slots[j].key != NULL; j = (j + 1) & table->mask) {
+		ideal = table->slots[j].hash & table->mask;
+		if (((j - ideal) & table->mask) >= ((j - i) & table->mask)) {
+			table->slots[i] = table->slots[j];
+			i = j;
+		}
+	}
+	table->slots[i].key = NULL;
+	table->slots[i].chain_head = NULL;
+}
+
+guint
+conversation_hashtable_size(const conversation_hashtable_t *table)
+{
+	return table->count;
+}
+
+void
+conversation_hashtable_foreach(const conversation_hashtable_t *table, GHFunc func, gpointer user_data)
+{
+	guint i;
+
+	for (i = 0; i <= table->mask; i++) {
+		if (table->slots[i].key != NULL)
+			func(table->slots[i].key, table->slots[i].chain_head, user_data);
+	}
+}
 
 /*
  * Creates a new conversation with known endpoints based on a conversation
@@ -173,6 +370,8 @@ conversation_create_from_template(conversation_t *conversation, const address *a
        * the handler of the new conversation as well.
        */
       new_conversation_from_template->dissector_handle = conversation->dissector_handle;
+      if (conversation->dissector_handle != NULL)
+         conversation_tables_get_required()->dissector_generation++;
 
       return new_conversation_from_template;
    }
@@ -457,18 +656,42 @@ conversation_match_no_addr2_or_port2(gconstpointer v, gconstpointer w)
 	return 0;
 }
 
+conversation_tables_t *
+conversation_tables_get_current(void)
+{
+	return conversation_tables_current;
+}
+
+conversation_tables_t *
+conversation_tables_set_current(conversation_tables_t *tables)
+{
+	conversation_tables_t *prev_tables = conversation_tables_current;
+
+	conversation_tables_current = tables;
+	return prev_tables;
+}
+
+/*
+ * Return the current conversation tables, for code that adds to or
+ * changes them and so can't do without them.
+ */
+static conversation_tables_t *
+conversation_tables_get_required(void)
+{
+	DISSECTOR_ASSERT_HINT(conversation_tables_current != NULL,
+	    "No conversation tables: conversation_init() (or epan_new()) hasn't been called, or the session has been freed");
+	return conversation_tables_current;
+}
+
 /*
- * Free the proto_data.  The conversation itself is wmem-allocated with
- * file scope.
+ * Forget the proto_data.  It and the conversation itself are
+ * wmem-allocated with file scope.
  */
 static void
 free_data_list(gpointer value)
 {
 	conversation_t *conv = (conversation_t *)value;
 
-	/* TODO: file scoped wmem_list? There's no singly-linked wmem_ list */
-	g_slist_free(conv->data_list);
-
 	/* Not really necessary, but... */
 	conv->data_list = NULL;
 
@@ -480,29 +703,32 @@ free_data_list(gpointer value)
 void
 conversation_cleanup(void)
 {
+	conversation_tables_t *tables = conversation_tables_get_current();
+
+	if (tables == NULL)
+		return;
+
 	/*  Clean up the hash tables, but only after freeing any proto_data
 	 *  that may be hanging off the conversations.
 	 *  The conversation keys are wmem-allocated with file scope so we
 	 *  don't have to clean them up.
 	 */
-	conversation_keys = NULL;
-	if (conversation_hashtable_exact != NULL) {
-		g_hash_table_destroy(conversation_hashtable_exact);
+	tables->keys = NULL;
+	if (tables->hashtable_exact != NULL) {
+		conversation_hashtable_destroy(tables->hashtable_exact);
 	}
-	if (conversation_hashtable_no_addr2 != NULL) {
-		g_hash_table_destroy(conversation_hashtable_no_addr2);
+	if (tables->hashtable_no_addr2 != NULL) {
+		conversation_hashtable_destroy(tables->hashtable_no_addr2);
 	}
-	if (conversation_hashtable_no_port2 != NULL) {
-		g_hash_table_destroy(conversation_hashtable_no_port2);
+	if (tables->hashtable_no_port2 != NULL) {
+		conversation_hashtable_destroy(tables->hashtable_no_port2);
 	}
-	if (conversation_hashtable_no_addr2_or_port2 != NULL) {
-		g_hash_table_destroy(conversation_hashtable_no_addr2_or_port2);
+	if (tables->hashtable_no_addr2_or_port2 != NULL) {
+		conversation_hashtable_destroy(tables->hashtable_no_addr2_or_port2);
 	}
 
-	conversation_hashtable_exact = NULL;
-	conversation_hashtable_no_addr2 = NULL;
-	conversation_hashtable_no_port2 = NULL;
-	conversation_hashtable_no_addr2_or_port2 = NULL;
+	g_free(tables);
+	conversation_tables_set_current(NULL);
 }
 
 /*
@@ -512,6 +738,8 @@ conversation_cleanup(void)
 void
 conversation_init(void)
 {
+	conversation_tables_t *tables = g_new0(conversation_tables_t, 1);
+
 	/*
 	 * Free up any space allocated for conversation protocol data
 	 * areas.
@@ -520,23 +748,25 @@ conversation_init(void)
 	 * pointed to by conversation data structures that were freed
 	 * above.
 	 */
-	conversation_hashtable_exact =
-	    g_hash_table_new_full(conversation_hash_exact,
-	      conversation_match_exact, NULL, free_data_list);
-	conversation_hashtable_no_addr2 =
-	    g_hash_table_new_full(conversation_hash_no_addr2,
-	      conversation_match_no_addr2, NULL, free_data_list);
-	conversation_hashtable_no_port2 =
-	    g_hash_table_new_full(conversation_hash_no_port2,
-	      conversation_match_no_port2, NULL, free_data_list);
-	conversation_hashtable_no_addr2_or_port2 =
-	    g_hash_table_new_full(conversation_hash_no_addr2_or_port2,
-	      conversation_match_no_addr2_or_port2, NULL, free_data_list);
+	tables->hashtable_exact =
+	    conversation_hashtable_new(conversation_hash_exact,
+	      conversation_match_exact);
+	tables->hashtable_no_addr2 =
+	    conversation_hashtable_new(conversation_hash_no_addr2,
+	      conversation_match_no_addr2);
+	tables->hashtable_no_port2 =
+	    conversation_hashtable_new(conversation_hash_no_port2,
+	      conversation_match_no_port2);
+	tables->hashtable_no_addr2_or_port2 =
+	    conversation_hashtable_new(conversation_hash_no_addr2_or_port2,
+	      conversation_match_no_addr2_or_port2);
 
 	/*
 	 * Start the conversation indices over at 0.
 	 */
-	new_index = 0;
+	tables->new_index = 0;
+
+	conversation_tables_set_current(tables);
 }
 
 /*
@@ -546,17 +776,17 @@ conversation_init(void)
  * Mostly adapted from the old conversation_new().
  */
 static void
-conversation_insert_into_hashtable(GHashTable *hashtable, conversation_t *conv)
+conversation_insert_into_hashtable(conversation_hashtable_t *hashtable, conversation_t *conv)
 {
 	conversation_t *chain_head, *chain_tail, *cur, *prev;
 
-	chain_head = (conversation_t *)g_hash_table_lookup(hashtable, conv->key_ptr);
+	chain_head = conversation_hashtable_lookup(hashtable, conv->key_ptr);
 
 	if (NULL==chain_head) {
 		/* New entry */
 		conv->next = NULL;
 		conv->last = conv;
-		g_hash_table_insert(hashtable, conv->key_ptr, conv);
+		conversation_hashtable_insert(hashtable, conv->key_ptr, conv);
 		DPRINT(("created a new conversation chain"));
 	}
 	else {
@@ -585,7 +815,7 @@ conversation_insert_into_hashtable(GHashTable *hashtable, conversation_t *conv)
 				conv->next = chain_head;
 				conv->last = chain_tail;
 				chain_head->last = NULL;
-				g_hash_table_insert(hashtable, conv->key_ptr, conv);
+				conversation_hashtable_insert(hashtable, conv->key_ptr, conv);
 			}
 			else {
 				/* Inserting into the middle of the chain */
@@ -602,21 +832,20 @@ conversation_insert_into_hashtable(GHashTable *hashtable, conversation_t *conv)
  * taking into account ordering and hash chains and all that good stuff.
  */
 static void
-conversation_remove_from_hashtable(GHashTable *hashtable, conversation_t *conv)
+conversation_remove_from_hashtable(conversation_hashtable_t *hashtable, conversation_t *conv)
 {
 	conversation_t *chain_head, *cur, *prev;
 
-	chain_head = (conversation_t *)g_hash_table_lookup(hashtable, conv->key_ptr);
+	chain_head = conversation_hashtable_lookup(hashtable, conv->key_ptr);
 
 	if (conv == chain_head) {
 		/* We are currently the front of the chain */
 		if (NULL == conv->next) {
 			/* We are the only conversation in the chain, no need to
-			 * update next pointer, but do not call
-			 * g_hash_table_remove() either because the conv data
-			 * will be re-inserted. The memory is released when
-			 * conversion_cleanup() is called. */
-			g_hash_table_steal(hashtable, conv->key_ptr);
+			 * update next pointer, but do not free the conv data
+			 * either because it will be re-inserted. The memory is
+			 * released when conversion_cleanup() is called. */
+			conversation_hashtable_steal(hashtable, conv->key_ptr);
 		}
 		else {
 			/* Update the head of the chain */
@@ -628,7 +857,7 @@ conversation_remove_from_hashtable(GHashTable *hashtable, conversation_t *conv)
 			else
 				chain_head->latest_found = conv->latest_found;
 
-			g_hash_table_insert(hashtable, chain_head->key_ptr, chain_head);
+			conversation_hashtable_insert(hashtable, chain_head->key_ptr, chain_head);
 		}
 	}
 	else {
@@ -674,7 +903,8 @@ conversation_new(const guint32 setup_frame, const address *addr1, const address
 	DISSECTOR_ASSERT(!(options | CONVERSATION_TEMPLATE) || ((options | (NO_ADDR2 | NO_PORT2 | NO_PORT2_FORCE))) &&
 				"A conversation template may not be constructed without wildcard options");
 */
-	GHashTable* hashtable;
+	conversation_tables_t *tables = conversation_tables_get_required();
+	conversation_hashtable_t* hashtable;
 	conversation_t *conversation=NULL;
 	conversation_key *new_key;
 
@@ -684,23 +914,23 @@ conversation_new(const guint32 setup_frame, const address *addr1, const address
 
 	if (options & NO_ADDR2) {
 		if (options & (NO_PORT2|NO_PORT2_FORCE)) {
-			hashtable = conversation_hashtable_no_addr2_or_port2;
+			hashtable = tables->hashtable_no_addr2_or_port2;
 		} else {
-			hashtable = conversation_hashtable_no_addr2;
+			hashtable = tables->hashtable_no_addr2;
 		}
 	} else {
 		if (options & (NO_PORT2|NO_PORT2_FORCE)) {
-			hashtable = conversation_hashtable_no_port2;
+			hashtable = tables->hashtable_no_port2;
 		} else {
-			hashtable = conversation_hashtable_exact;
+			hashtable = tables->hashtable_exact;
 		}
 	}
 
 	new_key = wmem_new(wmem_file_scope(), struct conversation_key);
-	new_key->next = conversation_keys;
-	conversation_keys = new_key;
-	WMEM_COPY_ADDRESS(wmem_file_scope(), &new_key->addr1, addr1);
-	WMEM_COPY_ADDRESS(wmem_file_scope(), &new_key->addr2, addr2);
+	new_key->next = tables->keys;
+	tables->keys = new_key;
+	intern_address(&new_key->addr1, addr1);
+	intern_address(&new_key->addr2, addr2);
 	new_key->ptype = ptype;
 	new_key->port1 = port1;
 	new_key->port2 = port2;
@@ -708,7 +938,7 @@ conversation_new(const guint32 setup_frame, const address *addr1, const address
 	conversation = wmem_new(wmem_file_scope(), conversation_t);
 	memset(conversation, 0, sizeof(conversation_t));
 
-	conversation->index = new_index;
+	conversation->index = tables->new_index;
 	conversation->setup_frame = conversation->last_frame = setup_frame;
 	conversation->data_list = NULL;
 
@@ -719,7 +949,7 @@ conversation_new(const guint32 setup_frame, const address *addr1, const address
 	conversation->options = options;
 	conversation->key_ptr = new_key;
 
-	new_index++;
+	tables->new_index++;
 
 	DINDENT();
 	conversation_insert_into_hashtable(hashtable, conversation);
@@ -735,6 +965,8 @@ conversation_new(const guint32 setup_frame, const address *addr1, const address
 void
 conversation_set_port2(conversation_t *conv, const guint32 port)
 {
+   conversation_tables_t *tables = conversation_tables_get_required();
+
    DISSECTOR_ASSERT_HINT(!(conv->options & CONVERSATION_TEMPLATE),
             "Use the conversation_create_from_template function when the CONVERSATION_TEMPLATE bit is set in the options mask");
 
@@ -748,16 +980,16 @@ conversation_set_port2(conversation_t *conv, const guint32 port)
 
 	DINDENT();
 	if (conv->options & NO_ADDR2) {
-		conversation_remove_from_hashtable(conversation_hashtable_no_addr2_or_port2, conv);
+		conversation_remove_from_hashtable(tables->hashtable_no_addr2_or_port2, conv);
 	} else {
-		conversation_remove_from_hashtable(conversation_hashtable_no_port2, conv);
+		conversation_remove_from_hashtable(tables->hashtable_no_port2, conv);
 	}
 	conv->options &= ~NO_PORT2;
 	conv->key_ptr->port2  = port;
 	if (conv->options & NO_ADDR2) {
-		conversation_insert_into_hashtable(conversation_hashtable_no_addr2, conv);
+		conversation_insert_into_hashtable(tables->hashtable_no_addr2, conv);
 	} else {
-		conversation_insert_into_hashtable(conversation_hashtable_exact, conv);
+		conversation_insert_into_hashtable(tables->hashtable_exact, conv);
 	}
 	DENDENT();
 }
@@ -769,6 +1001,7 @@ conversation_set_port2(conversation_t *conv, const guint32 port)
 void
 conversation_set_addr2(conversation_t *conv, const address *addr)
 {
+	conversation_tables_t *tables = conversation_tables_get_required();
 	char* addr_str;
 	DISSECTOR_ASSERT_HINT(!(conv->options & CONVERSATION_TEMPLATE),
 			"Use the conversation_create_from_template function when the CONVERSATION_TEMPLATE bit is set in the options mask");
@@ -785,16 +1018,16 @@ conversation_set_addr2(conversation_t *conv, const address *addr)
 
 	DINDENT();
 	if (conv->options & NO_PORT2) {
-		conversation_remove_from_hashtable(conversation_hashtable_no_addr2_or_port2, conv);
+		conversation_remove_from_hashtable(tables->hashtable_no_addr2_or_port2, conv);
 	} else {
-		conversation_remove_from_hashtable(conversation_hashtable_no_port2, conv);
+		conversation_remove_from_hashtable(tables->hashtable_no_port2, conv);
 	}
 	conv->options &= ~NO_ADDR2;
-	WMEM_COPY_ADDRESS(wmem_file_scope(), &conv->key_ptr->addr2, addr);
+	intern_address(&conv->key_ptr->addr2, addr);
 	if (conv->options & NO_PORT2) {
-		conversation_insert_into_hashtable(conversation_hashtable_no_port2, conv);
+		conversation_insert_into_hashtable(tables->hashtable_no_port2, conv);
 	} else {
-		conversation_insert_into_hashtable(conversation_hashtable_exact, conv);
+		conversation_insert_into_hashtable(tables->hashtable_exact, conv);
 	}
 	DENDENT();
 }
@@ -804,7 +1037,7 @@ conversation_set_addr2(conversation_t *conv, const address *addr)
  * {addr1, port1, addr2, port2} and set up before frame_num.
  */
 static conversation_t *
-conversation_lookup_hashtable(GHashTable *hashtable, const guint32 frame_num, const address *addr1, const address *addr2,
+conversation_lookup_hashtable(conversation_hashtable_t *hashtable, const guint32 frame_num, const address *addr1, const address *addr2,
     const port_type ptype, const guint32 port1, const guint32 port2)
 {
 	conversation_t* convo=NULL;
@@ -822,7 +1055,7 @@ conversation_lookup_hashtable(GHashTable *hashtable, const guint32 frame_num, co
 	key.port1 = port1;
 	key.port2 = port2;
 
-	chain_head = (conversation_t *)g_hash_table_lookup(hashtable, &key);
+	chain_head = conversation_hashtable_lookup(hashtable, &key);
 
 	if (chain_head && (chain_head->setup_frame <= frame_num)) {
 		match = chain_head;
@@ -887,8 +1120,13 @@ conversation_t *
 find_conversation(const guint32 frame_num, const address *addr_a, const address *addr_b, const port_type ptype,
     const guint32 port_a, const guint32 port_b, const guint options)
 {
+   conversation_tables_t *tables = conversation_tables_get_current();
    conversation_t *conversation;
 
+   /* With no conversation tables there are no conversations to find */
+   if (tables == NULL)
+      return NULL;
+
    /*
     * First try an exact match, if we have two addresses and ports.
     */
@@ -899,14 +1137,14 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
        */
       DPRINT(("trying exact match"));
       conversation =
-         conversation_lookup_hashtable(conversation_hashtable_exact,
+         conversation_lookup_hashtable(tables->hashtable_exact,
          frame_num, addr_a, addr_b, ptype,
          port_a, port_b);
       /* Didn't work, try the other direction */
       if (conversation == NULL) {
 	      DPRINT(("trying opposite direction"));
 	      conversation =
-		 conversation_lookup_hashtable(conversation_hashtable_exact,
+		 conversation_lookup_hashtable(tables->hashtable_exact,
 		 frame_num, addr_b, addr_a, ptype,
 		 port_b, port_a);
       }
@@ -915,7 +1153,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
           * TCP/UDP ports are in TCP/IP.
           */
          conversation =
-            conversation_lookup_hashtable(conversation_hashtable_exact,
+            conversation_lookup_hashtable(tables->hashtable_exact,
             frame_num, addr_b, addr_a, ptype,
             port_a, port_b);
       }
@@ -940,14 +1178,14 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
        */
       DPRINT(("trying wildcarded dest address"));
       conversation =
-         conversation_lookup_hashtable(conversation_hashtable_no_addr2,
+         conversation_lookup_hashtable(tables->hashtable_no_addr2,
          frame_num, addr_a, addr_b, ptype, port_a, port_b);
       if ((conversation == NULL) && (addr_a->type == AT_FC)) {
          /* In Fibre channel, OXID & RXID are never swapped as
           * TCP/UDP ports are in TCP/IP.
           */
          conversation =
-            conversation_lookup_hashtable(conversation_hashtable_no_addr2,
+            conversation_lookup_hashtable(tables->hashtable_no_addr2,
             frame_num, addr_b, addr_a, ptype,
             port_a, port_b);
       }
@@ -992,7 +1230,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
       if (!(options & NO_ADDR_B)) {
          DPRINT(("trying dest addr:port as source addr:port with wildcarded dest addr"));
          conversation =
-            conversation_lookup_hashtable(conversation_hashtable_no_addr2,
+            conversation_lookup_hashtable(tables->hashtable_no_addr2,
             frame_num, addr_b, addr_a, ptype, port_b, port_a);
          if (conversation != NULL) {
             /*
@@ -1036,14 +1274,14 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
        */
       DPRINT(("trying wildcarded dest port"));
       conversation =
-         conversation_lookup_hashtable(conversation_hashtable_no_port2,
+         conversation_lookup_hashtable(tables->hashtable_no_port2,
          frame_num, addr_a, addr_b, ptype, port_a, port_b);
       if ((conversation == NULL) && (addr_a->type == AT_FC)) {
          /* In Fibre channel, OXID & RXID are never swapped as
           * TCP/UDP ports are in TCP/IP
           */
          conversation =
-            conversation_lookup_hashtable(conversation_hashtable_no_port2,
+            conversation_lookup_hashtable(tables->hashtable_no_port2,
             frame_num, addr_b, addr_a, ptype, port_a, port_b);
       }
       if (conversation != NULL) {
@@ -1087,7 +1325,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
       if (!(options & NO_PORT_B)) {
          DPRINT(("trying dest addr:port as source addr:port and wildcarded dest port"));
          conversation =
-            conversation_lookup_hashtable(conversation_hashtable_no_port2,
+            conversation_lookup_hashtable(tables->hashtable_no_port2,
             frame_num, addr_b, addr_a, ptype, port_b, port_a);
          if (conversation != NULL) {
             /*
@@ -1126,7 +1364,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
     */
    DPRINT(("trying wildcarding dest addr:port"));
    conversation =
-      conversation_lookup_hashtable(conversation_hashtable_no_addr2_or_port2,
+      conversation_lookup_hashtable(tables->hashtable_no_addr2_or_port2,
       frame_num, addr_a, addr_b, ptype, port_a, port_b);
    if (conversation != NULL) {
       /*
@@ -1173,11 +1411,11 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
    DPRINT(("trying dest addr:port as source addr:port and wildcarding dest addr:port"));
    if (addr_a->type == AT_FC)
       conversation =
-      conversation_lookup_hashtable(conversation_hashtable_no_addr2_or_port2,
+      conversation_lookup_hashtable(tables->hashtable_no_addr2_or_port2,
       frame_num, addr_b, addr_a, ptype, port_a, port_b);
    else
       conversation =
-      conversation_lookup_hashtable(conversation_hashtable_no_addr2_or_port2,
+      conversation_lookup_hashtable(tables->hashtable_no_addr2_or_port2,
       frame_num, addr_b, addr_a, ptype, port_b, port_a);
    if (conversation != NULL) {
       /*
@@ -1213,76 +1451,46 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
    return NULL;
 }
 
-static gint
-p_compare(gconstpointer a, gconstpointer b)
-{
-	const conv_proto_data *ap = (const conv_proto_data *)a;
-	const conv_proto_data *bp = (const conv_proto_data *)b;
-
-	if (ap->proto > bp->proto)
-		return 1;
-	else if (ap->proto == bp->proto)
-		return 0;
-	else
-		return -1;
-}
-
+/*
+ * Conversation data is stored in a proto_data_vec with file scope and a
+ * key of 0.
+ */
 void
 conversation_add_proto_data(conversation_t *conv, const int proto, void *proto_data)
 {
-	conv_proto_data *p1 = wmem_new(wmem_file_scope(), conv_proto_data);
-
-	p1->proto = proto;
-	p1->proto_data = proto_data;
-
-	/* Add it to the list of items for this conversation. */
-
-	conv->data_list = g_slist_insert_sorted(conv->data_list, (gpointer *)p1,
-	    p_compare);
+	proto_data_vec_add(wmem_file_scope(), &conv->data_list, proto, 0,
+	    proto_data);
 }
 
 void *
 conversation_get_proto_data(const conversation_t *conv, const int proto)
 {
-	conv_proto_data temp, *p1;
-	GSList *item;
-
-	temp.proto = proto;
-	temp.proto_data = NULL;
-
-	item = g_slist_find_custom(conv->data_list, (gpointer *)&temp,
-	    p_compare);
-
-	if (item != NULL) {
-		p1 = (conv_proto_data *)item->data;
-		return p1->proto_data;
-	}
-
-	return NULL;
+	return proto_data_vec_get(conv->data_list, proto, 0);
 }
 
 void
 conversation_delete_proto_data(conversation_t *conv, const int proto)
 {
-	conv_proto_data temp;
-	GSList *item;
-
-	temp.proto = proto;
-	temp.proto_data = NULL;
-
-	item = g_slist_find_custom(conv->data_list, (gpointer *)&temp,
-	    p_compare);
-
-	while(item){
-		conv->data_list = g_slist_remove(conv->data_list, item->data);
-		item=item->next;
-	}
+	while (proto_data_vec_remove(conv->data_list, proto, 0))
+		;
 }
 
 void
 conversation_set_dissector(conversation_t *conversation, const dissector_handle_t handle)
 {
+	conversation_tables_t *tables = conversation_tables_get_current();
+
 	conversation->dissector_handle = handle;
+	if (tables != NULL)
+		tables->dissector_generation++;
+}
+
+guint32
+conversation_dissector_generation(void)
+{
+	conversation_tables_t *tables = conversation_tables_get_current();
+
+	return tables ? tables->dissector_generation : 0;
 }
 
 /*
@@ -1364,28 +1572,36 @@ find_or_create_conversation(packet_info *pinfo)
 	return conv;
 }
 
-GHashTable *
+conversation_hashtable_t *
 get_conversation_hashtable_exact(void)
 {
-	return conversation_hashtable_exact;
+	conversation_tables_t *tables = conversation_tables_get_current();
+
+	return tables ? tables->hashtable_exact : NULL;
 }
 
-GHashTable *
+conversation_hashtable_t *
 get_conversation_hashtable_no_addr2(void)
 {
-	return conversation_hashtable_no_addr2;
+	conversation_tables_t *tables = conversation_tables_get_current();
+
+	return tables ? tables->hashtable_no_addr2 : NULL;
 }
 
-GHashTable *
+conversation_hashtable_t *
 get_conversation_hashtable_no_port2(void)
 {
-	return conversation_hashtable_no_port2;
+	conversation_tables_t *tables = conversation_tables_get_current();
+
+	return tables ? tables->hashtable_no_port2 : NULL;
 }
 
-GHashTable *
+conversation_hashtable_t *
 get_conversation_hashtable_no_addr2_or_port2(void)
 {
-	return conversation_hashtable_no_addr2_or_port2;
+	conversation_tables_t *tables = conversation_tables_get_current();
+
+	return tables ? tables->hashtable_no_addr2_or_port2 : NULL;
 }
 
 /*
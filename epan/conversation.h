@@ -78,7 +78,7 @@ typedef struct conversation {
 	guint32 setup_frame;		/** frame number that setup this conversation */
 	/* Assume that setup_frame is also the lowest frame number for now. */
 	guint32 last_frame;		/** highest frame number in this conversation */
-	GSList *data_list;			/** list of data associated with conversation */
+	proto_data_vec *data_list;	/** data associated with conversation */
 	dissector_handle_t dissector_handle;
 								/** handle for protocol dissector client associated with conversation */
 	guint	options;			/** wildcard flags */
@@ -86,16 +86,39 @@ typedef struct conversation {
 } conversation_t;
 
 /**
- * Destroy all existing conversations
+ * The set of conversation tables (hash tables, key list and index counter)
+ * belonging to one dissection session.
+ */
+typedef struct conversation_tables conversation_tables_t;
+
+/**
+ * Destroy all existing conversations in the current conversation tables,
+ * and the tables themselves.
  */
 extern void conversation_cleanup(void);
 
 /**
  * Initialize some variables every time a file is loaded or re-loaded.
- * Create a new hash table for the conversations in the new file.
+ * Create a new set of conversation tables for the conversations in the
+ * new file and make it the current one.
  */
 extern void conversation_init(void);
 
+/**
+ * Return the conversation tables used for conversation lookups and
+ * creation, or NULL if there are none.  find_conversation() finds
+ * nothing when there are none; creating or changing a conversation then
+ * is a bug.
+ */
+WS_DLL_PUBLIC conversation_tables_t *conversation_tables_get_current(void);
+
+/**
+ * Make the given conversation tables the ones used for conversation
+ * lookups and creation, and return the previously current ones so that
+ * they can be restored later.
+ */
+WS_DLL_PUBLIC conversation_tables_t *conversation_tables_set_current(conversation_tables_t *tables);
+
 /*
  * Given two address/port pairs for a packet, create a new conversation
  * to contain packets between those address/port pairs.
@@ -161,6 +184,14 @@ WS_DLL_PUBLIC void conversation_delete_proto_data(conversation_t *conv, const in
 
 WS_DLL_PUBLIC void conversation_set_dissector(conversation_t *conversation,
     const dissector_handle_t handle);
+
+/**
+ * Returns a value that changes whenever any conversation's dissector is
+ * set.  If it hasn't changed, try_conversation_dissector() won't find a
+ * dissector for addresses and ports for which it didn't find one before.
+ */
+WS_DLL_PUBLIC guint32 conversation_dissector_generation(void);
+
 /**
  * Given two address/port pairs for a packet, search for a matching
  * conversation and, if found and it has a conversation dissector,
@@ -181,17 +212,33 @@ try_conversation_dissector(const address *addr_a, const address *addr_b, const p
 extern void conversation_set_port2(conversation_t *conv, const guint32 port);
 extern void conversation_set_addr2(conversation_t *conv, const address *addr);
 
+/**
+ * A conversation hash table, mapping a conversation key to the chain of
+ * conversations with that key.
+ */
+typedef struct conversation_hashtable conversation_hashtable_t;
+
+/** Return the number of keys in a conversation hash table. */
+WS_DLL_PUBLIC
+guint conversation_hashtable_size(const conversation_hashtable_t *table);
+
+/** Call func for every key in a conversation hash table, passing the
+ *  conversation_key and the first conversation_t of its chain.
+ */
+WS_DLL_PUBLIC
+void conversation_hashtable_foreach(const conversation_hashtable_t *table, GHFunc func, gpointer user_data);
+
 WS_DLL_PUBLIC
-GHashTable *get_conversation_hashtable_exact(void);
+conversation_hashtable_t *get_conversation_hashtable_exact(void);
 
 WS_DLL_PUBLIC
-GHashTable *get_conversation_hashtable_no_addr2(void);
+conversation_hashtable_t *get_conversation_hashtable_no_addr2(void);
 
 WS_DLL_PUBLIC
-GHashTable * get_conversation_hashtable_no_port2(void);
+conversation_hashtable_t *get_conversation_hashtable_no_port2(void);
 
 WS_DLL_PUBLIC
-GHashTable *get_conversation_hashtable_no_addr2_or_port2(void);
+conversation_hashtable_t *get_conversation_hashtable_no_addr2_or_port2(void);
 
 
 #ifdef __cplusplus
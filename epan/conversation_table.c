@@ -32,6 +32,8 @@
 
 #include "stat_tap_ui.h"
 
+#include <wsutil/hyperloglog.h>
+
 GList *cmd_string_list_ = NULL;
 
 struct register_ct {
@@ -221,62 +223,238 @@ register_ct_t *get_conversation_table_by_num(guint table_num)
     return (register_ct_t *) g_slist_nth_data(registered_ct_tables, table_num);
 }
 
-/** Compute the hash value for two given address/port pairs.
- * (Parameter type is gconstpointer for GHashTable compatibility.)
- *
- * @param v Conversation Key. MUST point to a conv_key_t struct.
- * @return Computed key hash.
+/*
+ * The index of a table's items: an open-addressing hash table with
+ * linear probing.  Each slot holds the hash of an item's key and the
+ * item's position in conv_array plus one, or 0 if the slot is empty.
+ * Keys are compared against the items themselves, so nothing is
+ * allocated per item and the stored hash lets the table grow, and most
+ * mismatches be rejected, without looking at the items.
  */
-static guint
-conversation_hash(gconstpointer v)
+#define CONV_INDEX_INITIAL_SIZE 1024
+
+/*
+ * An approximate table also keeps its items in a min-heap by weight -
+ * packets counted plus err_frames - so that the one to replace is at the
+ * top, and a sketch of the keys it has seen.
+ */
+#define CONV_INDEX_DISTINCT_PRECISION 14
+
+struct _conv_index_t {
+    guint32 *hashes;
+    guint32 *slots;
+    guint32  mask;
+    guint32  count;
+
+    guint32 *heap;          /* item positions, lightest first */
+    guint32 *heap_pos;      /* each item's position in heap */
+    guint64 *weight;        /* each item's weight */
+    guint32  heap_len;
+    hyperloglog_t *distinct;
+};
+
+static struct _conv_index_t *
+conv_index_new(guint max_items)
+{
+    struct _conv_index_t *ci = g_new0(struct _conv_index_t, 1);
+
+    ci->hashes = g_new0(guint32, CONV_INDEX_INITIAL_SIZE);
+    ci->slots = g_new0(guint32, CONV_INDEX_INITIAL_SIZE);
+    ci->mask = CONV_INDEX_INITIAL_SIZE - 1;
+    if (max_items != 0) {
+        ci->heap = g_new(guint32, max_items);
+        ci->heap_pos = g_new(guint32, max_items);
+        ci->weight = g_new(guint64, max_items);
+        ci->distinct = hyperloglog_new(CONV_INDEX_DISTINCT_PRECISION);
+    }
+    return ci;
+}
+
+static void
+conv_index_free(struct _conv_index_t *ci)
+{
+    g_free(ci->hashes);
+    g_free(ci->slots);
+    g_free(ci->heap);
+    g_free(ci->heap_pos);
+    g_free(ci->weight);
+    hyperloglog_free(ci->distinct);
+    g_free(ci);
+}
+
+/* Spread the bits of a key's hash so that the low ones pick the slot. */
+static inline guint32
+conv_index_mix(guint32 hash_val)
+{
+    hash_val *= 0x9E3779B1U;
+    return hash_val ^ (hash_val >> 16);
+}
+
+static void
+conv_index_insert(struct _conv_index_t *ci, guint32 hash_val, guint32 item_idx)
+{
+    guint32 i;
+
+    /* Keep the table at most half full so that probes stay short. */
+    if ((ci->count + 1) * 2 > ci->mask + 1) {
+        guint32 *old_hashes = ci->hashes;
+        guint32 *old_slots = ci->slots;
+        guint32 old_size = ci->mask + 1;
+        guint32 j;
+
+        ci->mask = old_size * 2 - 1;
+        ci->hashes = g_new0(guint32, old_size * 2);
+        ci->slots = g_new0(guint32, old_size * 2);
+        for (j = 0; j < old_size; j++) {
+            if (old_slots[j] == 0)
+                continue;
+            for (i = old_hashes[j] & ci->mask; ci->slots[i] != 0; i = (i + 1) & ci->mask)
+                ;
+            ci->hashes[i] = old_hashes[j];
+            ci->slots[i] = old_slots[j];
+        }
+        g_free(old_hashes);
+        g_free(old_slots);
+    }
+
+    for (i = hash_val & ci->mask; ci->slots[i] != 0; i = (i + 1) & ci->mask)
+        ;
+    ci->hashes[i] = hash_val;
+    ci->slots[i] = item_idx + 1;
+    ci->count++;
+}
+
+static void
+conv_index_remove(struct _conv_index_t *ci, guint32 hash_val, guint32 item_idx)
+{
+    guint32 i, j, home;
+
+    for (i = hash_val & ci->mask; ci->slots[i] != item_idx + 1; i = (i + 1) & ci->mask)
+        ;
+
+    /*
+     * Close the gap: move back any later entry of the run that can't be
+     * found from its home slot once slot i is empty.
+     */
+    for (j = (i + 1) & ci->mask; ci->slots[j] != 0; j = (j + 1) & ci->mask) {
+        home = ci->hashes[j] & ci->mask;
+        if (((j - home) & ci->mask) >= ((j - i) & ci->mask)) {
+            ci->hashes[i] = ci->hashes[j];
+            ci->slots[i] = ci->slots[j];
+            i = j;
+        }
+    }
+    ci->slots[i] = 0;
+    ci->count--;
+}
+
+/* Add a new item of an approximate table to its heap. */
+static void
+conv_index_heap_push(struct _conv_index_t *ci, guint32 item_idx, guint64 weight)
+{
+    guint32 pos = ci->heap_len++;
+    guint32 parent;
+
+    ci->weight[item_idx] = weight;
+    while (pos > 0) {
+        parent = (pos - 1) / 2;
+        if (ci->weight[ci->heap[parent]] <= weight)
+            break;
+        ci->heap[pos] = ci->heap[parent];
+        ci->heap_pos[ci->heap[pos]] = pos;
+        pos = parent;
+    }
+    ci->heap[pos] = item_idx;
+    ci->heap_pos[item_idx] = pos;
+}
+
+/* Count packets against an item of an approximate table. */
+static void
+conv_index_heap_count(struct _conv_index_t *ci, guint32 item_idx, guint64 frames)
+{
+    guint32 pos = ci->heap_pos[item_idx];
+    guint32 child;
+    guint64 weight;
+
+    weight = ci->weight[item_idx] += frames;
+    for (;;) {
+        child = 2 * pos + 1;
+        if (child >= ci->heap_len)
+            break;
+        if (child + 1 < ci->heap_len &&
+            ci->weight[ci->heap[child + 1]] < ci->weight[ci->heap[child]])
+            child++;
+        if (ci->weight[ci->heap[child]] >= weight)
+            break;
+        ci->heap[pos] = ci->heap[child];
+        ci->heap_pos[ci->heap[pos]] = pos;
+        pos = child;
+    }
+    ci->heap[pos] = item_idx;
+    ci->heap_pos[item_idx] = pos;
+}
+
+/*
+ * Compute the hash value for a conversation, with its addresses and
+ * ports in the table's order.
+ */
+static guint32
+conversation_hash(const address *addr1, const address *addr2,
+    guint32 port1, guint32 port2, conv_id_t conv_id)
 {
-    const conv_key_t *key = (const conv_key_t *)v;
     guint hash_val;
 
     hash_val = 0;
-    ADD_ADDRESS_TO_HASH(hash_val, &key->addr1);
-    hash_val += key->port1;
-    ADD_ADDRESS_TO_HASH(hash_val, &key->addr2);
-    hash_val += key->port2;
-    hash_val ^= key->conv_id;
+    ADD_ADDRESS_TO_HASH(hash_val, addr1);
+    hash_val += port1;
+    ADD_ADDRESS_TO_HASH(hash_val, addr2);
+    hash_val += port2;
+    hash_val ^= conv_id;
 
-    return hash_val;
+    return conv_index_mix(hash_val);
 }
 
-/** Compare two conversation keys for an exact match.
- * (Parameter types are gconstpointer for GHashTable compatibility.)
- *
- * @param key1 First conversation. MUST point to a conv_key_t struct.
- * @param key2 Second conversation. MUST point to a conv_key_t struct.
- * @return TRUE if conversations are equal, FALSE otherwise.
+/*
+ * A wider hash of a conversation, for counting the distinct ones an
+ * approximate table sees.
  */
-static gboolean
-conversation_equal(gconstpointer key1, gconstpointer key2)
-{
-    const conv_key_t *ck1 = (const conv_key_t *)key1;
-    const conv_key_t *ck2 = (const conv_key_t *)key2;
-
-    if (ck1->conv_id == ck2->conv_id)
-    {
-        if (ck1->port1 == ck2->port1 &&
-            ck1->port2 == ck2->port2 &&
-            ADDRESSES_EQUAL(&ck1->addr1, &ck2->addr1) &&
-            ADDRESSES_EQUAL(&ck1->addr2, &ck2->addr2)) {
-            return TRUE;
-        }
+static guint64
+conversation_hash64(const address *addr1, const address *addr2,
+    guint32 port1, guint32 port2, conv_id_t conv_id)
+{
+    guint64 hash_val;
 
-        if (ck1->port2 == ck2->port1 &&
-            ck1->port1 == ck2->port2 &&
-            ADDRESSES_EQUAL(&ck1->addr2, &ck2->addr1) &&
-            ADDRESSES_EQUAL(&ck1->addr1, &ck2->addr2)) {
-            return TRUE;
-        }
+    hash_val = 0;
+    hash_val = add_address_to_hash64(hash_val, addr1);
+    hash_val += port1;
+    hash_val = add_address_to_hash64(hash_val, addr2);
+    hash_val += port2;
+    hash_val ^= conv_id;
+
+    return hash_val;
+}
+
+guint64
+conversation_table_distinct(conv_hash_t *ch, double *error)
+{
+    guint64 estimate;
+
+    if (error) {
+        *error = 0.0;
+    }
+    if (!ch || !ch->conv_array) {
+        return 0;
+    }
+    if (ch->hashtable->distinct == NULL) {
+        return ch->conv_array->len;
     }
 
-    /*
-     * The addresses, ports, or conversation IDs don't match.
-     */
-    return FALSE;
+    if (error) {
+        *error = hyperloglog_error(ch->hashtable->distinct);
+    }
+    /* There are at least as many as the table holds. */
+    estimate = hyperloglog_estimate(ch->hashtable->distinct);
+    return MAX(estimate, ch->conv_array->len);
 }
 
 void
@@ -298,7 +476,7 @@ reset_conversation_table_data(conv_hash_t *ch)
     }
 
     if (ch->hashtable != NULL) {
-        g_hash_table_destroy(ch->hashtable);
+        conv_index_free(ch->hashtable);
     }
 
     ch->conv_array=NULL;
@@ -322,7 +500,7 @@ void reset_hostlist_table_data(conv_hash_t *ch)
     }
 
     if (ch->hashtable != NULL) {
-        g_hash_table_destroy(ch->hashtable);
+        conv_index_free(ch->hashtable);
     }
 
     ch->conv_array=NULL;
@@ -589,6 +767,101 @@ add_conversation_table_data(conv_hash_t *ch, const address *src, const address *
     add_conversation_table_data_with_conv_id(ch, src, dst, src_port, dst_port, CONV_ID_UNSET, num_frames, num_bytes, ts, abs_ts, ct_info, ptype);
 }
 
+/*
+ * Find the item for a conversation, with its addresses and ports in the
+ * table's order, adding one that starts at ts if there isn't one yet.
+ * Its position in conv_array is returned in *item_idx.
+ */
+static conv_item_t *
+conversation_table_item(conv_hash_t *ch, const address *addr1, const address *addr2,
+    guint32 port1, guint32 port2, conv_id_t conv_id, nstime_t *ts, nstime_t *abs_ts,
+    ct_dissector_info_t *ct_info, port_type ptype, guint32 *item_idx)
+{
+    conv_item_t *conv_item;
+    conv_item_t new_conv_item;
+    guint32 hash_val = conversation_hash(addr1, addr2, port1, port2, conv_id);
+    guint32 i;
+
+    /* if we don't have any entries at all yet */
+    if (ch->conv_array == NULL) {
+        ch->conv_array = g_array_sized_new(FALSE, FALSE, sizeof(conv_item_t), 10000);
+        ch->hashtable = conv_index_new(ch->max_items);
+    } else {
+        /* try to find it among the existing known conversations */
+        for (i = hash_val & ch->hashtable->mask; ch->hashtable->slots[i] != 0;
+             i = (i + 1) & ch->hashtable->mask) {
+            if (ch->hashtable->hashes[i] != hash_val)
+                continue;
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, ch->hashtable->slots[i] - 1);
+            if (conv_item->conv_id == conv_id &&
+                conv_item->src_port == port1 &&
+                conv_item->dst_port == port2 &&
+                ADDRESSES_EQUAL(&conv_item->src_address, addr1) &&
+                ADDRESSES_EQUAL(&conv_item->dst_address, addr2)) {
+                *item_idx = ch->hashtable->slots[i] - 1;
+                return conv_item;
+            }
+        }
+    }
+
+    /* we don't know what conversation this is so it has to be a new one
+       and we have to allocate it and append it to the end of the list */
+    COPY_ADDRESS(&new_conv_item.src_address, addr1);
+    COPY_ADDRESS(&new_conv_item.dst_address, addr2);
+    new_conv_item.dissector_info = ct_info;
+    new_conv_item.ptype = ptype;
+    new_conv_item.src_port = port1;
+    new_conv_item.dst_port = port2;
+    new_conv_item.conv_id = conv_id;
+    new_conv_item.rx_frames = 0;
+    new_conv_item.tx_frames = 0;
+    new_conv_item.rx_bytes = 0;
+    new_conv_item.tx_bytes = 0;
+    new_conv_item.err_frames = 0;
+    new_conv_item.modified = TRUE;
+
+    if (ts) {
+        memcpy(&new_conv_item.start_time, ts, sizeof(new_conv_item.start_time));
+        memcpy(&new_conv_item.stop_time, ts, sizeof(new_conv_item.stop_time));
+        memcpy(&new_conv_item.start_abs_time, abs_ts, sizeof(new_conv_item.start_abs_time));
+    } else {
+        nstime_set_unset(&new_conv_item.start_abs_time);
+        nstime_set_unset(&new_conv_item.start_time);
+        nstime_set_unset(&new_conv_item.stop_time);
+    }
+
+    if (ch->max_items != 0) {
+        hyperloglog_add(ch->hashtable->distinct, conversation_hash64(addr1, addr2, port1, port2, conv_id));
+
+        if (ch->conv_array->len >= ch->max_items) {
+            /* The table is full; replace the lightest conversation. */
+            *item_idx = ch->hashtable->heap[0];
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, *item_idx);
+            conv_index_remove(ch->hashtable,
+                    conversation_hash(&conv_item->src_address, &conv_item->dst_address,
+                                      conv_item->src_port, conv_item->dst_port, conv_item->conv_id),
+                    *item_idx);
+            g_free((gpointer)conv_item->src_address.data);
+            g_free((gpointer)conv_item->dst_address.data);
+
+            new_conv_item.err_frames = ch->hashtable->weight[*item_idx];
+            *conv_item = new_conv_item;
+            conv_index_insert(ch->hashtable, hash_val, *item_idx);
+            return conv_item;
+        }
+    }
+
+    g_array_append_val(ch->conv_array, new_conv_item);
+    *item_idx = ch->conv_array->len - 1;
+    conv_index_insert(ch->hashtable, hash_val, *item_idx);
+    if (ch->max_items != 0) {
+        conv_index_heap_push(ch->hashtable, *item_idx, 0);
+    }
+    conv_item = &g_array_index(ch->conv_array, conv_item_t, *item_idx);
+
+    return conv_item;
+}
+
 void
 add_conversation_table_data_with_conv_id(
     conv_hash_t *ch,
@@ -606,20 +879,22 @@ add_conversation_table_data_with_conv_id(
 {
     const address *addr1, *addr2;
     guint32 port1, port2;
-    conv_item_t *conv_item = NULL;
-    unsigned int conversation_idx = 0;
+    gboolean from_addr1;
+    conv_item_t *conv_item;
+    guint32 item_idx;
 
-    if (src_port > dst_port) {
-        addr1 = src;
-        addr2 = dst;
-        port1 = src_port;
-        port2 = dst_port;
-    } else if (src_port < dst_port) {
-        addr2 = src;
-        addr1 = dst;
-        port2 = src_port;
-        port1 = dst_port;
-    } else if (CMP_ADDRESS(src, dst) < 0) {
+    /*
+     * Put the addresses and ports in the table's order, noting whether
+     * this packet goes from the first to the second so that they don't
+     * need comparing again.  (If the source and destination are the same,
+     * it counts as going from the first to the second.)
+     */
+    if (src_port != dst_port) {
+        from_addr1 = (src_port > dst_port);
+    } else {
+        from_addr1 = (CMP_ADDRESS(src, dst) <= 0);
+    }
+    if (from_addr1) {
         addr1 = src;
         addr2 = dst;
         port1 = src_port;
@@ -631,81 +906,20 @@ add_conversation_table_data_with_conv_id(
         port1 = dst_port;
     }
 
-    /* if we don't have any entries at all yet */
-    if (ch->conv_array == NULL) {
-        ch->conv_array = g_array_sized_new(FALSE, FALSE, sizeof(conv_item_t), 10000);
-
-        ch->hashtable = g_hash_table_new_full(conversation_hash,
-                                              conversation_equal, /* key_equal_func */
-                                              g_free,             /* key_destroy_func */
-                                              NULL);              /* value_destroy_func */
-
-    } else {
-        /* try to find it among the existing known conversations */
-        conv_key_t existing_key;
-        gpointer conversation_idx_hash_val;
-
-        existing_key.addr1 = *addr1;
-        existing_key.addr2 = *addr2;
-        existing_key.port1 = port1;
-        existing_key.port2 = port2;
-        existing_key.conv_id = conv_id;
-        if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-            conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
-        }
-    }
-
-    /* if we still don't know what conversation this is it has to be a new one
-       and we have to allocate it and append it to the end of the list */
-    if (conv_item == NULL) {
-        conv_key_t *new_key;
-        conv_item_t new_conv_item;
-
-        COPY_ADDRESS(&new_conv_item.src_address, addr1);
-        COPY_ADDRESS(&new_conv_item.dst_address, addr2);
-        new_conv_item.dissector_info = ct_info;
-        new_conv_item.ptype = ptype;
-        new_conv_item.src_port = port1;
-        new_conv_item.dst_port = port2;
-        new_conv_item.conv_id = conv_id;
-        new_conv_item.rx_frames = 0;
-        new_conv_item.tx_frames = 0;
-        new_conv_item.rx_bytes = 0;
-        new_conv_item.tx_bytes = 0;
-        new_conv_item.modified = TRUE;
-
-        if (ts) {
-            memcpy(&new_conv_item.start_time, ts, sizeof(new_conv_item.start_time));
-            memcpy(&new_conv_item.stop_time, ts, sizeof(new_conv_item.stop_time));
-            memcpy(&new_conv_item.start_abs_time, abs_ts, sizeof(new_conv_item.start_abs_time));
-        } else {
-            nstime_set_unset(&new_conv_item.start_abs_time);
-            nstime_set_unset(&new_conv_item.start_time);
-            nstime_set_unset(&new_conv_item.stop_time);
-        }
-        g_array_append_val(ch->conv_array, new_conv_item);
-        conversation_idx = ch->conv_array->len - 1;
-        conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
-
-        /* ct->conversations address is not a constant but src/dst_address.data are */
-        new_key = g_new(conv_key_t, 1);
-        SET_ADDRESS(&new_key->addr1, conv_item->src_address.type, conv_item->src_address.len, conv_item->src_address.data);
-        SET_ADDRESS(&new_key->addr2, conv_item->dst_address.type, conv_item->dst_address.len, conv_item->dst_address.data);
-        new_key->port1 = port1;
-        new_key->port2 = port2;
-        new_key->conv_id = conv_id;
-        g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(conversation_idx));
-    }
+    conv_item = conversation_table_item(ch, addr1, addr2, port1, port2, conv_id, ts, abs_ts, ct_info, ptype, &item_idx);
 
     /* update the conversation struct */
     conv_item->modified = TRUE;
-    if ( (!CMP_ADDRESS(src, addr1)) && (!CMP_ADDRESS(dst, addr2)) && (src_port==port1) && (dst_port==port2) ) {
+    if (from_addr1) {
         conv_item->tx_frames += num_frames;
         conv_item->tx_bytes += num_bytes;
     } else {
         conv_item->rx_frames += num_frames;
         conv_item->rx_bytes += num_bytes;
     }
+    if (ch->max_items != 0) {
+        conv_index_heap_count(ch->hashtable, item_idx, num_frames);
+    }
 
     if (ts) {
         if (nstime_cmp(ts, &conv_item->stop_time) > 0) {
@@ -718,95 +932,114 @@ add_conversation_table_data_with_conv_id(
 }
 
 /*
- * Compute the hash value for a given address/port pairs if the match
- * is to be exact.
+ * Compute the hash value for an endpoint's address and port.
  */
-static guint
-host_hash(gconstpointer v)
+static guint32
+host_hash(const address *addr, guint32 port)
 {
-    const host_key_t *key = (const host_key_t *)v;
     guint hash_val;
 
     hash_val = 0;
-    ADD_ADDRESS_TO_HASH(hash_val, &key->myaddress);
-    hash_val += key->port;
-    return hash_val;
+    ADD_ADDRESS_TO_HASH(hash_val, addr);
+    hash_val += port;
+    return conv_index_mix(hash_val);
 }
 
 /*
- * Compare two host keys for an exact match.
+ * A wider hash of an endpoint, for counting the distinct ones an
+ * approximate table sees.
  */
-static gint
-host_match(gconstpointer v, gconstpointer w)
+static guint64
+host_hash64(const address *addr, guint32 port)
 {
-    const host_key_t *v1 = (const host_key_t *)v;
-    const host_key_t *v2 = (const host_key_t *)w;
+    guint64 hash_val;
 
-    if (v1->port == v2->port &&
-        ADDRESSES_EQUAL(&v1->myaddress, &v2->myaddress)) {
-        return 1;
-    }
-    /*
-     * The addresses or the ports don't match.
-     */
-    return 0;
+    hash_val = 0;
+    hash_val = add_address_to_hash64(hash_val, addr);
+    hash_val += port;
+    return hash_val;
 }
 
-void
-add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboolean sender, int num_frames, int num_bytes, hostlist_dissector_info_t *host_info, port_type port_type_val)
+/*
+ * Find the item for an endpoint, adding one if there isn't one yet.
+ * Its position in conv_array is returned in *item_idx.
+ */
+static hostlist_talker_t *
+hostlist_table_item(conv_hash_t *ch, const address *addr, guint32 port,
+    hostlist_dissector_info_t *host_info, port_type port_type_val, guint32 *item_idx)
 {
-    hostlist_talker_t *talker=NULL;
-    int talker_idx=0;
+    hostlist_talker_t *talker;
+    hostlist_talker_t host;
+    guint32 hash_val = host_hash(addr, port);
+    guint32 i;
 
-    /* XXX should be optimized to allocate n extra entries at a time
-       instead of just one */
     /* if we don't have any entries at all yet */
     if(ch->conv_array==NULL){
         ch->conv_array=g_array_sized_new(FALSE, FALSE, sizeof(hostlist_talker_t), 10000);
-        ch->hashtable = g_hash_table_new_full(host_hash,
-                                              host_match, /* key_equal_func */
-                                              g_free,     /* key_destroy_func */
-                                              NULL);      /* value_destroy_func */
+        ch->hashtable = conv_index_new(ch->max_items);
     }
     else {
         /* try to find it among the existing known conversations */
-        host_key_t existing_key;
-        gpointer talker_idx_hash_val;
-
-        existing_key.myaddress = *addr;
-        existing_key.port = port;
-
-        if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &talker_idx_hash_val)) {
-            talker = &g_array_index(ch->conv_array, hostlist_talker_t, GPOINTER_TO_UINT(talker_idx_hash_val));
+        for (i = hash_val & ch->hashtable->mask; ch->hashtable->slots[i] != 0;
+             i = (i + 1) & ch->hashtable->mask) {
+            if (ch->hashtable->hashes[i] != hash_val)
+                continue;
+            talker = &g_array_index(ch->conv_array, hostlist_talker_t, ch->hashtable->slots[i] - 1);
+            if (talker->port == port && ADDRESSES_EQUAL(&talker->myaddress, addr)) {
+                *item_idx = ch->hashtable->slots[i] - 1;
+                return talker;
+            }
         }
     }
 
-    /* if we still don't know what talker this is it has to be a new one
+    /* we don't know what talker this is so it has to be a new one
        and we have to allocate it and append it to the end of the list */
-    if(talker==NULL){
-        host_key_t *new_key;
-        hostlist_talker_t host;
-
-        COPY_ADDRESS(&host.myaddress, addr);
-        host.dissector_info = host_info;
-        host.ptype=port_type_val;
-        host.port=port;
-        host.rx_frames=0;
-        host.tx_frames=0;
-        host.rx_bytes=0;
-        host.tx_bytes=0;
-        host.modified = TRUE;
-
-        g_array_append_val(ch->conv_array, host);
-        talker_idx= ch->conv_array->len - 1;
-        talker=&g_array_index(ch->conv_array, hostlist_talker_t, talker_idx);
-
-        /* hl->hosts address is not a constant but address.data is */
-        new_key = g_new(host_key_t,1);
-        SET_ADDRESS(&new_key->myaddress, talker->myaddress.type, talker->myaddress.len, talker->myaddress.data);
-        new_key->port = port;
-        g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(talker_idx));
+    COPY_ADDRESS(&host.myaddress, addr);
+    host.dissector_info = host_info;
+    host.ptype=port_type_val;
+    host.port=port;
+    host.rx_frames=0;
+    host.tx_frames=0;
+    host.rx_bytes=0;
+    host.tx_bytes=0;
+    host.err_frames=0;
+    host.modified = TRUE;
+
+    if (ch->max_items != 0) {
+        hyperloglog_add(ch->hashtable->distinct, host_hash64(addr, port));
+
+        if (ch->conv_array->len >= ch->max_items) {
+            /* The table is full; replace the lightest endpoint. */
+            *item_idx = ch->hashtable->heap[0];
+            talker = &g_array_index(ch->conv_array, hostlist_talker_t, *item_idx);
+            conv_index_remove(ch->hashtable, host_hash(&talker->myaddress, talker->port), *item_idx);
+            g_free((gpointer)talker->myaddress.data);
+
+            host.err_frames = ch->hashtable->weight[*item_idx];
+            *talker = host;
+            conv_index_insert(ch->hashtable, hash_val, *item_idx);
+            return talker;
+        }
+    }
+
+    g_array_append_val(ch->conv_array, host);
+    *item_idx = ch->conv_array->len - 1;
+    conv_index_insert(ch->hashtable, hash_val, *item_idx);
+    if (ch->max_items != 0) {
+        conv_index_heap_push(ch->hashtable, *item_idx, 0);
     }
+    talker=&g_array_index(ch->conv_array, hostlist_talker_t, *item_idx);
+
+    return talker;
+}
+
+void
+add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboolean sender, int num_frames, int num_bytes, hostlist_dissector_info_t *host_info, port_type port_type_val)
+{
+    hostlist_talker_t *talker;
+    guint32 item_idx;
+
+    talker = hostlist_table_item(ch, addr, port, host_info, port_type_val, &item_idx);
 
     /* if this is a new talker we need to initialize the struct */
     talker->modified = TRUE;
@@ -819,6 +1052,9 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
         talker->rx_frames+=num_frames;
         talker->rx_bytes+=num_bytes;
     }
+    if (ch->max_items != 0) {
+        conv_index_heap_count(ch->hashtable, item_idx, num_frames);
+    }
 }
 
 /*
@@ -57,13 +57,25 @@ typedef enum {
     CONV_DIR_ANY_FROM_B
 } conv_direction_e;
 
+struct _conv_index_t;
+
 /** Conversation hash + value storage
- * Hash table keys are conv_key_t. Hash table values are indexes into conv_array.
+ * The index is an open-addressing hash of conv_array's items by their
+ * addresses, ports and conversation ID (conv_key_t or host_key_t).
+ *
+ * If max_items is set (before the first item is added) the table is
+ * approximate: it holds at most max_items items, and a new conversation
+ * or endpoint replaces the one with the fewest packets, so memory stays
+ * fixed however many there are ("Space-Saving").  Any item with more than
+ * 1/max_items of the packets is kept.  An item's counts may miss up to its
+ * err_frames packets, from before it was added, and the number of
+ * distinct items seen is estimated; see conversation_table_distinct().
  */
 typedef struct _conversation_hash_t {
-    GHashTable  *hashtable;       /**< conversations hash table */
+    struct _conv_index_t *hashtable; /**< index of conv_array by key */
     GArray      *conv_array;      /**< array of conversation values */
     void        *user_data;       /**< "GUI" specifics (if necessary) */
+    guint        max_items;       /**< if not 0, the size of an approximate table */
 } conv_hash_t;
 
 /** Key for hash lookups */
@@ -119,6 +131,7 @@ typedef struct _conversation_item_t {
     guint64             tx_frames;      /**< number of transmitted packets */
     guint64             rx_bytes;       /**< number of received bytes */
     guint64             tx_bytes;       /**< number of transmitted bytes */
+    guint64             err_frames;     /**< most packets the counts may miss (approximate tables) */
 
     nstime_t            start_time;     /**< relative start time for the conversation */
     nstime_t            stop_time;      /**< relative stop time for the conversation */
@@ -138,6 +151,7 @@ typedef struct _hostlist_talker_t {
     guint64 tx_frames;      /**< number of transmitted packets */
     guint64 rx_bytes;       /**< number of received bytes */
     guint64 tx_bytes;       /**< number of transmitted bytes */
+    guint64 err_frames;     /**< most packets the counts may miss (approximate tables) */
 
     gboolean modified;      /**< new to redraw the row */
 
@@ -237,6 +251,17 @@ WS_DLL_PUBLIC void reset_conversation_table_data(conv_hash_t *ch);
  */
 WS_DLL_PUBLIC void reset_hostlist_table_data(conv_hash_t *ch);
 
+/** Get the number of distinct conversations or endpoints a table has seen.
+ * That's the number of items in it unless it's approximate, when it's an
+ * estimate.
+ *
+ * @param ch the table
+ * @param error if not NULL, set to the estimate's relative standard error
+ * (0 if it's exact)
+ * @return the number of conversations or endpoints
+ */
+WS_DLL_PUBLIC guint64 conversation_table_distinct(conv_hash_t *ch, double *error);
+
 /** Initialize dissector conversation for stats and (possibly) GUI.
  *
  * @param opt_arg filter string to compare with dissector
@@ -217,15 +217,15 @@ static INT AirPDcapRsnaMicCheck(
  * @param id [IN] id of the association (composed by BSSID and MAC of
  * the station)
  * @return
- * - index of the Security Association structure if found
- * - -1, if the specified addresses pair BSSID-STA MAC has not been found
+ * - the Security Association structure if found
+ * - NULL, if the specified addresses pair BSSID-STA MAC has not been found
  */
-static INT AirPDcapGetSa(
+static PAIRPDCAP_SEC_ASSOCIATION AirPDcapGetSa(
     PAIRPDCAP_CONTEXT ctx,
     AIRPDCAP_SEC_ASSOCIATION_ID *id)
     ;
 
-static INT AirPDcapStoreSa(
+static PAIRPDCAP_SEC_ASSOCIATION AirPDcapStoreSa(
     PAIRPDCAP_CONTEXT ctx,
     AIRPDCAP_SEC_ASSOCIATION_ID *id)
     ;
@@ -477,17 +477,14 @@ AirPDcapGetSaPtr(
     PAIRPDCAP_CONTEXT ctx,
     AIRPDCAP_SEC_ASSOCIATION_ID *id)
 {
-    int sa_index;
+    PAIRPDCAP_SEC_ASSOCIATION sa;
 
     /* search for a cached Security Association for supplied BSSID and STA MAC  */
-    if ((sa_index=AirPDcapGetSa(ctx, id))==-1) {
+    if ((sa=AirPDcapGetSa(ctx, id))==NULL) {
         /* create a new Security Association if it doesn't currently exist      */
-        if ((sa_index=AirPDcapStoreSa(ctx, id))==-1) {
-            return NULL;
-        }
+        sa=AirPDcapStoreSa(ctx, id);
     }
-    /* get the Security Association structure   */
-    return &ctx->sa[sa_index];
+    return sa;
 }
 
 static INT AirPDcapScanForGroupKey(
@@ -925,15 +922,46 @@ AirPDcapRecurseCleanSA(
 }
 
 static void
-AirPDcapCleanSecAssoc(
-    PAIRPDCAP_CONTEXT ctx)
+AirPDcapFreeSa(
+    gpointer data)
+{
+    PAIRPDCAP_SEC_ASSOCIATION sa = (PAIRPDCAP_SEC_ASSOCIATION)data;
+
+    /* To iterate is human, to recurse, divine */
+    AirPDcapRecurseCleanSA(sa);
+    g_free(sa);
+}
+
+static guint
+AirPDcapSaIdHash(
+    gconstpointer key)
 {
-    PAIRPDCAP_SEC_ASSOCIATION psa;
+    const AIRPDCAP_SEC_ASSOCIATION_ID *id = (const AIRPDCAP_SEC_ASSOCIATION_ID *)key;
+    guint hash = 0;
     int i;
 
-    for (psa = ctx->sa, i = 0; i < AIRPDCAP_MAX_SEC_ASSOCIATIONS_NR; i++, psa++) {
-        /* To iterate is human, to recurse, divine */
-        AirPDcapRecurseCleanSA(psa);
+    for (i = 0; i < AIRPDCAP_MAC_LEN; i++)
+        hash = (hash << 5) - hash + id->bssid[i];
+    for (i = 0; i < AIRPDCAP_MAC_LEN; i++)
+        hash = (hash << 5) - hash + id->sta[i];
+    return hash;
+}
+
+static gboolean
+AirPDcapSaIdEqual(
+    gconstpointer key1,
+    gconstpointer key2)
+{
+    return memcmp(key1, key2, sizeof(AIRPDCAP_SEC_ASSOCIATION_ID)) == 0;
+}
+
+static void
+AirPDcapCleanSecAssoc(
+    PAIRPDCAP_CONTEXT ctx)
+{
+    if (ctx->sa != NULL) {
+        g_hash_table_destroy(ctx->sa);
+        ctx->sa = NULL;
     }
 }
 
@@ -998,13 +1026,12 @@ INT AirPDcapInitContext(
     }
 
     AirPDcapCleanKeys(ctx);
+    AirPDcapCleanSecAssoc(ctx);
 
-    ctx->first_free_index=0;
-    ctx->index=-1;
-    ctx->sa_index=-1;
     ctx->pkt_ssid_len = 0;
 
-    memset(ctx->sa, 0, AIRPDCAP_MAX_SEC_ASSOCIATIONS_NR * sizeof(AIRPDCAP_SEC_ASSOCIATION));
+    /* the key of each entry is the saId member of its value */
+    ctx->sa = g_hash_table_new_full(AirPDcapSaIdHash, AirPDcapSaIdEqual, NULL, AirPDcapFreeSa);
 
     AIRPDCAP_DEBUG_PRINT_LINE("AirPDcapInitContext", "Context initialized!", AIRPDCAP_DEBUG_LEVEL_5);
     AIRPDCAP_DEBUG_TRACE_END("AirPDcapInitContext");
@@ -1025,10 +1052,6 @@ INT AirPDcapDestroyContext(
     AirPDcapCleanKeys(ctx);
     AirPDcapCleanSecAssoc(ctx);
 
-    ctx->first_free_index=0;
-    ctx->index=-1;
-    ctx->sa_index=-1;
-
     AIRPDCAP_DEBUG_PRINT_LINE("AirPDcapDestroyContext", "Context destroyed!", AIRPDCAP_DEBUG_LEVEL_5);
     AIRPDCAP_DEBUG_TRACE_END("AirPDcapDestroyContext");
     return AIRPDCAP_RET_SUCCESS;
@@ -1614,72 +1637,36 @@ AirPDcapValidateKey(
     return ret;
 }
 
-static INT
+static PAIRPDCAP_SEC_ASSOCIATION
 AirPDcapGetSa(
     PAIRPDCAP_CONTEXT ctx,
     AIRPDCAP_SEC_ASSOCIATION_ID *id)
 {
-    INT sa_index;
-
-    if (ctx->sa_index!=-1) {
-        /* at least one association was stored                               */
-        /* search for the association from sa_index to 0 (most recent added) */
-        for (sa_index=ctx->sa_index; sa_index>=0; sa_index--) {
-            if (ctx->sa[sa_index].used) {
-                if (memcmp(id, &(ctx->sa[sa_index].saId), sizeof(AIRPDCAP_SEC_ASSOCIATION_ID))==0) {
-                    ctx->index=sa_index;
-                    return sa_index;
-                }
-            }
-        }
-    }
+    if (ctx->sa == NULL)
+        return NULL;
 
-    return -1;
+    return (PAIRPDCAP_SEC_ASSOCIATION)g_hash_table_lookup(ctx->sa, id);
 }
 
-static INT
+static PAIRPDCAP_SEC_ASSOCIATION
 AirPDcapStoreSa(
     PAIRPDCAP_CONTEXT ctx,
     AIRPDCAP_SEC_ASSOCIATION_ID *id)
 {
-    INT last_free;
-
-    if (ctx->sa[ctx->first_free_index].used) {
-        /* last addition was in the middle of the array (and the first_free_index was just incremented by 1)   */
-        /* search for a free space from the first_free_index to AIRPDCAP_STA_INFOS_NR (to avoid free blocks in */
-        /*              the middle)                                                                            */
-        for (last_free=ctx->first_free_index; last_free<AIRPDCAP_MAX_SEC_ASSOCIATIONS_NR; last_free++)
-            if (!ctx->sa[last_free].used)
-                break;
-
-        if (last_free>=AIRPDCAP_MAX_SEC_ASSOCIATIONS_NR) {
-            /* there is no empty space available. FAILURE */
-            return -1;
-        }
-
-        /* store first free space index */
-        ctx->first_free_index=last_free;
-    }
-
-    /* use this info */
-    ctx->index=ctx->first_free_index;
+    PAIRPDCAP_SEC_ASSOCIATION sa;
 
-    /* reset the info structure */
-    memset(ctx->sa+ctx->index, 0, sizeof(AIRPDCAP_SEC_ASSOCIATION));
+    if (ctx->sa == NULL)
+        return NULL;
 
-    ctx->sa[ctx->index].used=1;
+    sa = g_new0(AIRPDCAP_SEC_ASSOCIATION, 1);
+    sa->used=1;
 
     /* set the info structure */
-    memcpy(&(ctx->sa[ctx->index].saId), id, sizeof(AIRPDCAP_SEC_ASSOCIATION_ID));
-
-    /* increment by 1 the first_free_index (heuristic) */
-    ctx->first_free_index++;
+    memcpy(&(sa->saId), id, sizeof(AIRPDCAP_SEC_ASSOCIATION_ID));
 
-    /* set the sa_index if the added index is greater the the sa_index */
-    if (ctx->index > ctx->sa_index)
-        ctx->sa_index=ctx->index;
+    g_hash_table_insert(ctx->sa, &sa->saId, sa);
 
-    return ctx->index;
+    return sa;
 }
 
 /*
@@ -65,7 +65,6 @@
 #define	AIRPDCAP_RET_SUCCESS_HANDSHAKE  	 -1
 
 #define	AIRPDCAP_MAX_KEYS_NR	        	 64
-#define	AIRPDCAP_MAX_SEC_ASSOCIATIONS_NR	256
 
 /*	Decryption algorithms fields size definition (bytes)		*/
 #define	AIRPDCAP_WPA_NONCE_LEN		         32
@@ -153,16 +152,16 @@ typedef struct _AIRPDCAP_SEC_ASSOCIATION {
 } AIRPDCAP_SEC_ASSOCIATION, *PAIRPDCAP_SEC_ASSOCIATION;
 
 typedef struct _AIRPDCAP_CONTEXT {
-	AIRPDCAP_SEC_ASSOCIATION sa[AIRPDCAP_MAX_SEC_ASSOCIATIONS_NR];
-	INT sa_index;
+	/**
+	 * Security associations, keyed by their BSSID/STA pair. Each one is
+	 * allocated separately, so pointers to it stay valid as more are added.
+	 */
+	GHashTable *sa;
 	AIRPDCAP_KEY_ITEM keys[AIRPDCAP_MAX_KEYS_NR];
 	size_t keys_nr;
 
         CHAR pkt_ssid[AIRPDCAP_WPA_SSID_MAX_LEN];
         size_t pkt_ssid_len;
-
-	INT index;
-	INT first_free_index;
 } AIRPDCAP_CONTEXT, *PAIRPDCAP_CONTEXT;
 
 /************************************************************************/
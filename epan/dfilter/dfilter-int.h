@@ -27,17 +27,38 @@
 #include <epan/proto.h>
 #include <stdio.h>
 
+typedef struct _prefilter_node prefilter_node;
+
+/* What dfilter_set_profiling() collects */
+typedef struct {
+	guint64		count;		/* times run */
+	guint64		true_count;	/* times it left the accumulator TRUE */
+	guint64		ns;
+} dfvm_insn_profile_t;
+
+typedef struct {
+	guint64		applies;
+	guint64		matches;
+	guint64		ns;
+	dfvm_insn_profile_t *insns;	/* indexed by instruction ID */
+} dfvm_profile_t;
+
 /* Passed back to user */
 struct epan_dfilter {
 	GPtrArray	*insns;
 	GPtrArray	*consts;
+	guint		ref_count;
 	guint		num_registers;
 	guint		max_registers;
 	GList		**registers;
 	gboolean	*attempted_load;
+	gboolean	*borrowed;	/* register belongs to a dfvm_field_cache_t */
 	int		*interesting_fields;
 	int		num_interesting_fields;
 	GPtrArray	*deprecated;
+	prefilter_node	*prefilter;	/* decided before dissection, or NULL */
+	int		*cutoff_protos;	/* ending with -1, or NULL */
+	dfvm_profile_t	*profile;	/* NULL unless profiling */
 };
 
 typedef struct {
@@ -49,6 +70,8 @@ typedef struct {
 	GPtrArray	*consts;
 	GHashTable	*loaded_fields;
 	GHashTable	*interesting_fields;
+	GSList		*known_loaded;	/* registers sure to hold a value here */
+	GSList		*loaded_ranges;	/* MK_RANGE results, for reuse */
 	int		next_insn_id;
 	int		next_const_id;
 	int		next_register;
@@ -26,9 +26,12 @@
 #include "dfilter-int.h"
 #include "syntax-tree.h"
 #include "gencode.h"
+#include "optimize.h"
+#include "prefilter.h"
 #include "semcheck.h"
 #include "dfvm.h"
 #include <epan/epan_dissect.h>
+#include <wiretap/wtap.h>
 #include "dfilter.h"
 #include "dfilter-macro.h"
 
@@ -42,6 +45,31 @@ int     df_lex(void);
 /* Holds the singular instance of our Lemon parser object */
 static void*	ParserObj = NULL;
 
+/*
+ * Filters compiled with dfilter_compile_cached(), keyed on the
+ * macro-expanded filter text.  Each entry holds a reference to its
+ * dfilter_t; entries nobody else holds a reference to are dropped,
+ * oldest first, once there are more than DFILTER_CACHE_MAX of them.
+ */
+#define DFILTER_CACHE_MAX	64
+
+typedef struct {
+	gchar		*text;
+	dfilter_t	*df;
+	guint		generation;	/* proto_registrar_generation() at compile time */
+	GList		*link;		/* in dfilter_cache_lru */
+} dfilter_cache_entry_t;
+
+static GHashTable	*dfilter_cache = NULL;
+static GQueue		dfilter_cache_lru = G_QUEUE_INIT;	/* least recently used first */
+static guint64		dfilter_cache_lookups = 0;
+static guint64		dfilter_cache_hits = 0;
+
+struct epan_dfilter_set {
+	GPtrArray		*filters;	/* dfilter_t *, NULL matches everything */
+	dfvm_field_cache_t	cache;
+};
+
 /*
  * XXX - if we're using a version of Flex that supports reentrant lexical
  * analyzers, we should put this into the lexical analyzer's state.
@@ -97,6 +125,12 @@ dfilter_cleanup(void)
 		DfilterFree(ParserObj, g_free);
 	}
 
+	/* Drop the cache's references to compiled filters */
+	if (dfilter_cache) {
+		g_hash_table_destroy(dfilter_cache);
+		dfilter_cache = NULL;
+	}
+
 	/* Clean up the syntax-tree sub-sub-system */
 	sttype_cleanup();
 }
@@ -107,6 +141,7 @@ dfilter_new(void)
 	dfilter_t	*df;
 
 	df = g_new0(dfilter_t, 1);
+	df->ref_count = 1;
 	df->insns = NULL;
 	df->deprecated = NULL;
 
@@ -128,6 +163,50 @@ free_insns(GPtrArray *insns)
 	g_ptr_array_free(insns, TRUE);
 }
 
+/* Work out which protocols have to be dissected for all of the fields
+ * a filter refers to to be there; returns NULL if it's not that simple. */
+static int *
+cutoff_protocols(const int *fields, int num_fields)
+{
+	GArray			*protos;
+	header_field_info	*hfinfo;
+	int			i, proto_id;
+	guint			j;
+
+	if (num_fields == 0) {
+		return NULL;
+	}
+
+	protos = g_array_new(FALSE, FALSE, sizeof(int));
+	for (i = 0; i < num_fields; i++) {
+		hfinfo = proto_registrar_get_nth(fields[i]);
+		/* These are made up from what the whole dissection did */
+		if (strncmp(hfinfo->abbrev, "_ws.", 4) == 0 ||
+		    strcmp(hfinfo->abbrev, "frame.protocols") == 0 ||
+		    strncmp(hfinfo->abbrev, "frame.coloring_rule", 19) == 0) {
+			g_array_free(protos, TRUE);
+			return NULL;
+		}
+		if (proto_registrar_is_protocol(fields[i])) {
+			proto_id = fields[i];
+		}
+		else {
+			proto_id = proto_registrar_get_parent(fields[i]);
+		}
+		for (j = 0; j < protos->len; j++) {
+			if (g_array_index(protos, int, j) == proto_id) {
+				break;
+			}
+		}
+		if (j == protos->len) {
+			g_array_append_val(protos, proto_id);
+		}
+	}
+	proto_id = -1;
+	g_array_append_val(protos, proto_id);
+	return (int *)g_array_free(protos, FALSE);
+}
+
 void
 dfilter_free(dfilter_t *df)
 {
@@ -136,6 +215,10 @@ dfilter_free(dfilter_t *df)
 	if (!df)
 		return;
 
+	/* Still in use by someone else (or still cached)? */
+	if (--df->ref_count > 0)
+		return;
+
 	if (df->insns) {
 		free_insns(df->insns);
 	}
@@ -145,6 +228,10 @@ dfilter_free(dfilter_t *df)
 
 	g_free(df->interesting_fields);
 
+	prefilter_free(df->prefilter);
+
+	g_free(df->cutoff_protos);
+
 	/* clear registers */
 	for (i = 0; i < df->max_registers; i++) {
 		if (df->registers[i]) {
@@ -160,8 +247,11 @@ dfilter_free(dfilter_t *df)
 		g_ptr_array_free(df->deprecated, TRUE);
 	}
 
+	dfilter_set_profiling(df, FALSE);
+
 	g_free(df->registers);
 	g_free(df->attempted_load);
+	g_free(df->borrowed);
 	g_free(df);
 }
 
@@ -207,31 +297,20 @@ dfwork_free(dfwork_t *dfw)
 	g_free(dfw);
 }
 
-gboolean
-dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
+/* Compile text that has already had macros expanded */
+static gboolean
+dfilter_compile_expanded(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 {
 	int		token;
 	dfilter_t	*dfilter;
 	dfwork_t	*dfw;
+	prefilter_node	*prefilter;
 	gboolean failure = FALSE;
 	const char	*depr_test;
 	guint		i;
 	/* XXX, GHashTable */
 	GPtrArray	*deprecated;
 
-	g_assert(dfp);
-
-	if (!text) {
-		*dfp = NULL;
-		if (err_msg != NULL)
-			*err_msg = g_strdup("BUG: NULL text pointer passed to dfilter_compile()");
-		return FALSE;
-	}
-
-	if ( !( text = dfilter_macro_apply(text, err_msg) ) ) {
-		return FALSE;
-	}
-
 	dfw = dfwork_new();
 
 	/*
@@ -329,23 +408,35 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 			goto FAILURE;
 		}
 
+		/* Rewrite the tree into something cheaper to run */
+		dfw_optimize(dfw);
+
+		/* Pull out what can be decided without dissecting, while
+		 * the tree is still intact */
+		prefilter = dfw_prefilter(dfw);
+
 		/* Create bytecode */
 		dfw_gencode(dfw);
 
 		/* Tuck away the bytecode in the dfilter_t */
 		dfilter = dfilter_new();
+		dfilter->prefilter = prefilter;
 		dfilter->insns = dfw->insns;
 		dfilter->consts = dfw->consts;
 		dfw->insns = NULL;
 		dfw->consts = NULL;
 		dfilter->interesting_fields = dfw_interesting_fields(dfw,
 			&dfilter->num_interesting_fields);
+		dfilter->cutoff_protos = cutoff_protocols(
+			dfilter->interesting_fields,
+			dfilter->num_interesting_fields);
 
 		/* Initialize run-time space */
 		dfilter->num_registers = dfw->first_constant;
 		dfilter->max_registers = dfw->next_register;
 		dfilter->registers = g_new0(GList*, dfilter->max_registers);
 		dfilter->attempted_load = g_new0(gboolean, dfilter->max_registers);
+		dfilter->borrowed = g_new0(gboolean, dfilter->max_registers);
 
 		/* Initialize constants */
 		dfvm_init_const(dfilter);
@@ -359,7 +450,6 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 	/* SUCCESS */
 	global_dfw = NULL;
 	dfwork_free(dfw);
-	wmem_free(NULL, (char*)text);
 	return TRUE;
 
 FAILURE:
@@ -390,6 +480,137 @@ FAILURE:
 	return FALSE;
 }
 
+gboolean
+dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
+{
+	const gchar	*expanded;
+	gboolean	ret;
+
+	g_assert(dfp);
+
+	if (!text) {
+		*dfp = NULL;
+		if (err_msg != NULL)
+			*err_msg = g_strdup("BUG: NULL text pointer passed to dfilter_compile()");
+		return FALSE;
+	}
+
+	if ( !( expanded = dfilter_macro_apply(text, err_msg) ) ) {
+		return FALSE;
+	}
+
+	ret = dfilter_compile_expanded(expanded, dfp, err_msg);
+	wmem_free(NULL, (char*)expanded);
+	return ret;
+}
+
+static void
+dfilter_cache_entry_free(gpointer data)
+{
+	dfilter_cache_entry_t *entry = (dfilter_cache_entry_t *)data;
+
+	g_queue_delete_link(&dfilter_cache_lru, entry->link);
+	dfilter_free(entry->df);
+	g_free(entry->text);
+	g_free(entry);
+}
+
+/* Drop entries that only the cache is using, oldest first, until
+ * there's room for one more. */
+static void
+dfilter_cache_trim(void)
+{
+	GList			*link, *next;
+	dfilter_cache_entry_t	*entry;
+
+	for (link = dfilter_cache_lru.head;
+	    link != NULL && g_hash_table_size(dfilter_cache) >= DFILTER_CACHE_MAX;
+	    link = next) {
+		next = link->next;
+		entry = (dfilter_cache_entry_t *)link->data;
+		if (entry->df->ref_count == 1) {
+			g_hash_table_remove(dfilter_cache, entry->text);
+		}
+	}
+}
+
+gboolean
+dfilter_compile_cached(const gchar *text, dfilter_t **dfp, gchar **err_msg)
+{
+	const gchar		*expanded;
+	gchar			*key;
+	dfilter_cache_entry_t	*entry;
+	dfilter_t		*df;
+	guint			generation;
+
+	g_assert(dfp);
+
+	if (!text) {
+		return dfilter_compile(text, dfp, err_msg);
+	}
+
+	if ( !( expanded = dfilter_macro_apply(text, err_msg) ) ) {
+		*dfp = NULL;
+		return FALSE;
+	}
+	key = g_strstrip(g_strdup(expanded));
+	wmem_free(NULL, (char*)expanded);
+
+	if (dfilter_cache == NULL) {
+		dfilter_cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+				NULL, dfilter_cache_entry_free);
+	}
+
+	generation = proto_registrar_generation();
+	dfilter_cache_lookups++;
+	entry = (dfilter_cache_entry_t *)g_hash_table_lookup(dfilter_cache, key);
+	if (entry != NULL) {
+		if (entry->generation == generation) {
+			/* Hit; make it the most recently used */
+			dfilter_cache_hits++;
+			g_queue_unlink(&dfilter_cache_lru, entry->link);
+			g_queue_push_tail_link(&dfilter_cache_lru, entry->link);
+			entry->df->ref_count++;
+			*dfp = entry->df;
+			g_free(key);
+			return TRUE;
+		}
+		/* Fields have come or gone since it was compiled */
+		g_hash_table_remove(dfilter_cache, key);
+	}
+
+	if (!dfilter_compile_expanded(key, &df, err_msg)) {
+		g_free(key);
+		*dfp = NULL;
+		return FALSE;
+	}
+
+	/* Don't bother caching the null filter */
+	if (df != NULL) {
+		dfilter_cache_trim();
+		entry = g_new(dfilter_cache_entry_t, 1);
+		entry->text = key;
+		entry->df = df;
+		entry->generation = generation;
+		g_queue_push_tail(&dfilter_cache_lru, entry);
+		entry->link = dfilter_cache_lru.tail;
+		g_hash_table_insert(dfilter_cache, key, entry);
+		df->ref_count++;
+	}
+	else {
+		g_free(key);
+	}
+	*dfp = df;
+	return TRUE;
+}
+
+void
+dfilter_cache_get_stats(guint64 *lookups, guint64 *hits)
+{
+	*lookups = dfilter_cache_lookups;
+	*hits = dfilter_cache_hits;
+}
+
 
 gboolean
 dfilter_apply(dfilter_t *df, proto_tree *tree)
@@ -403,6 +624,127 @@ dfilter_apply_edt(dfilter_t *df, epan_dissect_t* edt)
 	return dfvm_apply(df, edt->tree);
 }
 
+gboolean
+dfilter_prefilter_packet(const dfilter_t *df, guint32 frame_num,
+		const struct wtap_pkthdr *phdr, const guint8 *data)
+{
+	if (df->prefilter == NULL || phdr->rec_type != REC_TYPE_PACKET) {
+		return TRUE;
+	}
+	return prefilter_apply(df->prefilter, frame_num, phdr->len,
+			phdr->caplen, data);
+}
+
+gboolean
+dfilter_prefilter_stored(const dfilter_t *df, const field_store_t *fs,
+		guint32 frame_num, guint32 len, guint32 caplen)
+{
+	if (df->prefilter == NULL) {
+		return TRUE;
+	}
+	return prefilter_apply_stored(df->prefilter, fs, frame_num, len,
+			caplen);
+}
+
+dfilter_set_t *
+dfilter_set_new(void)
+{
+	dfilter_set_t *set;
+
+	set = g_new0(dfilter_set_t, 1);
+	set->filters = g_ptr_array_new();
+	return set;
+}
+
+guint
+dfilter_set_add(dfilter_set_t *set, dfilter_t *df)
+{
+	if (df != NULL) {
+		df->ref_count++;
+		dfvm_field_cache_add(&set->cache, df);
+	}
+	g_ptr_array_add(set->filters, df);
+	return set->filters->len - 1;
+}
+
+guint
+dfilter_set_count(const dfilter_set_t *set)
+{
+	return set->filters->len;
+}
+
+void
+dfilter_set_apply(dfilter_set_t *set, proto_tree *tree,
+		const guint32 *wanted, guint32 *matches)
+{
+	guint		i;
+	dfilter_t	*df;
+
+	memset(matches, 0, DFILTER_SET_MASK_WORDS(set->filters->len) * sizeof(guint32));
+	for (i = 0; i < set->filters->len; i++) {
+		if (wanted != NULL && !DFILTER_SET_MASK_TEST(wanted, i)) {
+			continue;
+		}
+		df = (dfilter_t *)g_ptr_array_index(set->filters, i);
+		if (df == NULL || dfvm_apply_cached(df, tree, &set->cache)) {
+			matches[i / 32] |= 1U << (i % 32);
+		}
+	}
+	dfvm_field_cache_reset(&set->cache);
+}
+
+int
+dfilter_set_apply_first(dfilter_set_t *set, proto_tree *tree)
+{
+	guint		i;
+	dfilter_t	*df;
+
+	for (i = 0; i < set->filters->len; i++) {
+		df = (dfilter_t *)g_ptr_array_index(set->filters, i);
+		if (df == NULL || dfvm_apply_cached(df, tree, &set->cache)) {
+			break;
+		}
+	}
+	dfvm_field_cache_reset(&set->cache);
+	return i < set->filters->len ? (int)i : -1;
+}
+
+void
+dfilter_set_prime_proto_tree(const dfilter_set_t *set, proto_tree *tree)
+{
+	guint		i;
+	dfilter_t	*df;
+
+	for (i = 0; i < set->filters->len; i++) {
+		df = (dfilter_t *)g_ptr_array_index(set->filters, i);
+		if (df != NULL) {
+			dfilter_prime_proto_tree(df, tree);
+		}
+	}
+}
+
+void
+dfilter_set_free(dfilter_set_t *set)
+{
+	guint	i;
+
+	if (!set)
+		return;
+
+	for (i = 0; i < set->filters->len; i++) {
+		dfilter_free((dfilter_t *)g_ptr_array_index(set->filters, i));
+	}
+	g_ptr_array_free(set->filters, TRUE);
+	dfvm_field_cache_free(&set->cache);
+	g_free(set);
+}
+
+const int *
+dfilter_get_cutoff_protocols(const dfilter_t *df)
+{
+	return df->cutoff_protos;
+}
+
 
 void
 dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree)
@@ -430,6 +772,8 @@ dfilter_dump(dfilter_t *df)
 
 	dfvm_dump(stdout, df);
 
+	printf("Prefilter: %s\n", df->prefilter ? "yes" : "no");
+
 	if (df->deprecated && df->deprecated->len) {
 		printf("\nDeprecated tokens: ");
 		for (i = 0; i < df->deprecated->len; i++) {
@@ -439,3 +783,23 @@ dfilter_dump(dfilter_t *df)
 		printf("\n");
 	}
 }
+
+void
+dfilter_set_profiling(dfilter_t *df, gboolean enable)
+{
+	if (enable && df->profile == NULL) {
+		df->profile = g_new0(dfvm_profile_t, 1);
+		df->profile->insns = g_new0(dfvm_insn_profile_t, df->insns->len);
+	}
+	else if (!enable && df->profile != NULL) {
+		g_free(df->profile->insns);
+		g_free(df->profile);
+		df->profile = NULL;
+	}
+}
+
+void
+dfilter_dump_profile(dfilter_t *df)
+{
+	dfvm_dump_profile(stdout, df);
+}
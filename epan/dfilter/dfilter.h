@@ -34,6 +34,8 @@ extern "C" {
 #endif /* __cplusplus */
 
 struct epan_dissect;
+struct wtap_pkthdr;
+struct _field_store;
 
 /* Module-level initialization */
 void
@@ -61,8 +63,28 @@ WS_DLL_PUBLIC
 gboolean
 dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg);
 
+/* Like dfilter_compile(), but if the same filter text (after macro
+ * expansion, and ignoring leading and trailing white space) has been
+ * compiled with this before, and no fields have been registered or
+ * unregistered since, hand back the same compiled filter rather than
+ * compiling it again.
+ *
+ * The dfilter_t is shared, so it must not be changed; it must still be
+ * released with dfilter_free().
+ */
+WS_DLL_PUBLIC
+gboolean
+dfilter_compile_cached(const gchar *text, dfilter_t **dfp, gchar **err_msg);
+
+/* How many times dfilter_compile_cached() has looked for a filter in the
+ * cache, and how many times it found one it could use. */
+WS_DLL_PUBLIC
+void
+dfilter_cache_get_stats(guint64 *lookups, guint64 *hits);
+
 /* Frees all memory used by dfilter, and frees
- * the dfilter itself. */
+ * the dfilter itself, or, if it came from dfilter_compile_cached() and
+ * is still being used elsewhere, just drops this reference to it. */
 WS_DLL_PUBLIC
 void
 dfilter_free(dfilter_t *df);
@@ -76,6 +98,40 @@ dfilter_apply_edt(dfilter_t *df, struct epan_dissect *edt);
 gboolean
 dfilter_apply(dfilter_t *df, proto_tree *tree);
 
+/* Check a packet against the parts of a compiled dfilter that only look
+ * at the frame number, the frame lengths and slices of the raw frame
+ * data.  Returns FALSE if the packet can't possibly match the filter,
+ * so that there's no need to dissect it to find out; TRUE if it might.
+ *
+ * Skipping the dissection of a packet is only safe when nothing else
+ * depends on it being dissected, e.g. when rescanning packets that have
+ * all been dissected before and with no taps that want to see every
+ * packet. */
+WS_DLL_PUBLIC
+gboolean
+dfilter_prefilter_packet(const dfilter_t *df, guint32 frame_num,
+		const struct wtap_pkthdr *phdr, const guint8 *data);
+
+/* Like dfilter_prefilter_packet(), but for a packet that isn't at hand
+ * and has been dissected before: relations on the fields in a field
+ * store (which may be NULL) are decided from the values recorded there,
+ * equality tests on fields with a frame index from the index, and
+ * slices of the raw data are left undecided.  The same caveats about
+ * skipping the dissection apply. */
+WS_DLL_PUBLIC
+gboolean
+dfilter_prefilter_stored(const dfilter_t *df, const struct _field_store *fs,
+		guint32 frame_num, guint32 len, guint32 caplen);
+
+/* Return the protocols that have to be dissected for every field the
+ * filter refers to to be filled in, as an array of protocol IDs ending
+ * with -1 suitable for epan_dissect_set_cutoff(), or NULL if the filter
+ * refers to something that only exists once the whole packet has been
+ * dissected (e.g. frame.protocols).  The array belongs to the dfilter. */
+WS_DLL_PUBLIC
+const int *
+dfilter_get_cutoff_protocols(const dfilter_t *df);
+
 /* Prime a proto_tree using the fields/protocols used in a dfilter. */
 void
 dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree);
@@ -84,11 +140,82 @@ WS_DLL_PUBLIC
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df);
 
+/* A set of compiled filters that are all run against the same packets,
+ * e.g. the coloring rules, or the filters of all tap listeners.  A field
+ * more than one of the filters refers to is only looked up in the
+ * proto_tree once per packet, whichever filters it is used by.
+ *
+ * Like a dfilter_t, a set can only be applied by one thread at a time. */
+typedef struct epan_dfilter_set dfilter_set_t;
+
+/* Number of guint32s needed for a bitmask with a bit per filter */
+#define DFILTER_SET_MASK_WORDS(n)	(((n) + 31) / 32)
+
+/* Is the bit for filter i set in a bitmask? */
+#define DFILTER_SET_MASK_TEST(mask, i)	(((mask)[(i) / 32] >> ((i) % 32)) & 1)
+
+/* Create an empty filter set */
+WS_DLL_PUBLIC
+dfilter_set_t *
+dfilter_set_new(void);
+
+/* Add a filter to a set, which takes its own reference to it (so the
+ * caller must still dfilter_free() its own), and return its index in
+ * the set.  A NULL filter matches every packet. */
+WS_DLL_PUBLIC
+guint
+dfilter_set_add(dfilter_set_t *set, dfilter_t *df);
+
+/* Return the number of filters in a set */
+WS_DLL_PUBLIC
+guint
+dfilter_set_count(const dfilter_set_t *set);
+
+/* Run the filters in a set against a tree, and set the bits in matches
+ * (which must have DFILTER_SET_MASK_WORDS(dfilter_set_count(set))
+ * elements) of the ones that match.  If wanted isn't NULL, only the
+ * filters with their bit set in it are run. */
+WS_DLL_PUBLIC
+void
+dfilter_set_apply(dfilter_set_t *set, proto_tree *tree,
+		const guint32 *wanted, guint32 *matches);
+
+/* Run the filters in a set against a tree in the order they were added,
+ * stopping at the first one that matches; return its index, or -1 if
+ * none matches. */
+WS_DLL_PUBLIC
+int
+dfilter_set_apply_first(dfilter_set_t *set, proto_tree *tree);
+
+/* Prime a proto_tree using the fields/protocols used in all the filters
+ * in a set. */
+WS_DLL_PUBLIC
+void
+dfilter_set_prime_proto_tree(const dfilter_set_t *set, proto_tree *tree);
+
+/* Free a filter set, dropping its references to its filters */
+WS_DLL_PUBLIC
+void
+dfilter_set_free(dfilter_set_t *set);
+
 /* Print bytecode of dfilter to stdout */
 WS_DLL_PUBLIC
 void
 dfilter_dump(dfilter_t *df);
 
+/* Count and time each instruction of the filter every time it's
+ * applied, or stop doing so and forget the counts.  Applying a filter
+ * that's being profiled is a good deal slower. */
+WS_DLL_PUBLIC
+void
+dfilter_set_profiling(dfilter_t *df, gboolean enable);
+
+/* Print the bytecode of dfilter to stdout, with the counts and times
+ * collected since profiling was turned on */
+WS_DLL_PUBLIC
+void
+dfilter_dump_profile(dfilter_t *df);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -20,9 +20,12 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "dfvm.h"
 
 #include <ftypes/ftypes-int.h>
+#include <wsutil/time_util.h>
 
 dfvm_insn_t*
 dfvm_insn_new(dfvm_opcode_t op)
@@ -48,6 +51,9 @@ dfvm_value_free(dfvm_value_t *v)
 		case DRANGE:
 			drange_free(v->value.drange);
 			break;
+		case UINT32_SET:
+			g_array_free(v->value.uint32_set, TRUE);
+			break;
 		default:
 			/* nothing */
 			;
@@ -97,6 +103,7 @@ dfvm_dump(FILE *f, dfilter_t *df)
 	char		*value_str;
 	GSList		*range_list;
 	drange_node	*range_item;
+	guint		i;
 
         /* First dump the constant initializations */
         fprintf(f, "Constants:\n");
@@ -282,35 +289,152 @@ dfvm_dump(FILE *f, dfilter_t *df)
 						id, arg1->value.numeric);
 				break;
 
+			case FIELD_EQ_U32:
+				fprintf(f, "%05d FIELD_EQ_U32\t%s == %u\n",
+					id, arg1->value.hfinfo->abbrev, arg2->value.numeric);
+				break;
+
+			case FIELD_NE_U32:
+				fprintf(f, "%05d FIELD_NE_U32\t%s != %u\n",
+					id, arg1->value.hfinfo->abbrev, arg2->value.numeric);
+				break;
+
+			case FIELD_GT_U32:
+				fprintf(f, "%05d FIELD_GT_U32\t%s > %u\n",
+					id, arg1->value.hfinfo->abbrev, arg2->value.numeric);
+				break;
+
+			case FIELD_GE_U32:
+				fprintf(f, "%05d FIELD_GE_U32\t%s >= %u\n",
+					id, arg1->value.hfinfo->abbrev, arg2->value.numeric);
+				break;
+
+			case FIELD_LT_U32:
+				fprintf(f, "%05d FIELD_LT_U32\t%s < %u\n",
+					id, arg1->value.hfinfo->abbrev, arg2->value.numeric);
+				break;
+
+			case FIELD_LE_U32:
+				fprintf(f, "%05d FIELD_LE_U32\t%s <= %u\n",
+					id, arg1->value.hfinfo->abbrev, arg2->value.numeric);
+				break;
+
+			case FIELD_IN_U32:
+				fprintf(f, "%05d FIELD_IN_U32\t%s in {",
+					id, arg1->value.hfinfo->abbrev);
+				for (i = 0; i < arg2->value.uint32_set->len; i++) {
+					fprintf(f, i ? " %u" : "%u",
+					    g_array_index(arg2->value.uint32_set, guint32, i));
+				}
+				fprintf(f, "}\n");
+				break;
+
 			default:
 				g_assert_not_reached();
 				break;
 		}
 	}
+
+	fprintf(f, "\nDispatch: %s\n",
+		dfvm_threaded_dispatch() ? "threaded" : "switch");
 }
 
-/* Reads a field from the proto_tree and loads the fvalues into a register,
- * if that field has not already been read. */
-static gboolean
-read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
+/* Indexed by dfvm_opcode_t */
+static const char *const opcode_names[] = {
+	"IF-TRUE-GOTO",
+	"IF-FALSE-GOTO",
+	"CHECK_EXISTS",
+	"NOT",
+	"RETURN",
+	"READ_TREE",
+	"PUT_FVALUE",
+	"ANY_EQ",
+	"ANY_NE",
+	"ANY_GT",
+	"ANY_GE",
+	"ANY_LT",
+	"ANY_LE",
+	"ANY_BITWISE_AND",
+	"ANY_CONTAINS",
+	"ANY_MATCHES",
+	"MK_RANGE",
+	"CALL_FUNCTION",
+	"FIELD_EQ_U32",
+	"FIELD_NE_U32",
+	"FIELD_GT_U32",
+	"FIELD_GE_U32",
+	"FIELD_LT_U32",
+	"FIELD_LE_U32",
+	"FIELD_IN_U32"
+};
+
+void
+dfvm_dump_profile(FILE *f, dfilter_t *df)
 {
-	GPtrArray	*finfos;
-	field_info	*finfo;
-	int		i, len;
-	GList		*fvalues = NULL;
-	gboolean	found_something = FALSE;
+	dfvm_profile_t		*profile = df->profile;
+	dfvm_insn_profile_t	*ip;
+	dfvm_insn_t		*insn;
+	const char		*what;
+	guint64			field_ns = 0;
+	guint			id;
+
+	if (profile == NULL) {
+		return;
+	}
 
-	/* Already loaded in this run of the dfilter? */
-	if (df->attempted_load[reg]) {
-		if (df->registers[reg]) {
-			return TRUE;
-		}
-		else {
-			return FALSE;
+	fprintf(f, "Instruction profile:\n");
+	fprintf(f, "  ID  %-16s %12s %7s %14s %10s  %s\n",
+		"Instruction", "Count", "True %", "Total ns", "Avg ns", "Operand");
+	for (id = 0; id < df->insns->len; id++) {
+		insn = (dfvm_insn_t *)g_ptr_array_index(df->insns, id);
+		ip = &profile->insns[id];
+
+		switch (insn->op) {
+			case CHECK_EXISTS:
+			case READ_TREE:
+			case FIELD_EQ_U32:
+			case FIELD_NE_U32:
+			case FIELD_GT_U32:
+			case FIELD_GE_U32:
+			case FIELD_LT_U32:
+			case FIELD_LE_U32:
+			case FIELD_IN_U32:
+				what = insn->arg1->value.hfinfo->abbrev;
+				field_ns += ip->ns;
+				break;
+			case CALL_FUNCTION:
+				what = insn->arg1->value.funcdef->name;
+				break;
+			default:
+				what = "";
+				break;
 		}
+
+		fprintf(f, "%05u %-16s %12" G_GINT64_MODIFIER "u %6.1f%% %14" G_GINT64_MODIFIER "u %10.1f  %s\n",
+			id, opcode_names[insn->op], ip->count,
+			ip->count ? 100.0 * ip->true_count / ip->count : 0.0,
+			ip->ns, ip->count ? (double)ip->ns / ip->count : 0.0,
+			what);
 	}
 
-	df->attempted_load[reg] = TRUE;
+	fprintf(f, "\nApplied %" G_GINT64_MODIFIER "u times, matched %" G_GINT64_MODIFIER "u (%.1f%%)\n",
+		profile->applies, profile->matches,
+		profile->applies ? 100.0 * profile->matches / profile->applies : 0.0);
+	fprintf(f, "Time: %" G_GINT64_MODIFIER "u ns, %.1f ns per apply, %.1f%% of it reading fields\n",
+		profile->ns,
+		profile->applies ? (double)profile->ns / profile->applies : 0.0,
+		profile->ns ? 100.0 * field_ns / profile->ns : 0.0);
+}
+
+/* Makes a list of the fvalues of all the instances of a field (and
+ * of any other fields with the same name) in the proto_tree. */
+static GList *
+load_fvalues(proto_tree *tree, header_field_info *hfinfo)
+{
+	GPtrArray	*finfos;
+	field_info	*finfo;
+	int		i, len;
+	GList		*fvalues = NULL;
 
 	while (hfinfo) {
 		finfos = proto_get_finfo_ptr_array(tree, hfinfo->id);
@@ -318,9 +442,6 @@ read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
 			hfinfo = hfinfo->same_name_next;
 			continue;
 		}
-		else {
-			found_something = TRUE;
-		}
 
 		len = finfos->len;
 		for (i = 0; i < len; i++) {
@@ -331,12 +452,44 @@ read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
 		hfinfo = hfinfo->same_name_next;
 	}
 
-	if (!found_something) {
-		return FALSE;
+	return fvalues;
+}
+
+/* Reads a field from the proto_tree and loads the fvalues into a register,
+ * if that field has not already been read. */
+static gboolean
+read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg,
+		dfvm_field_cache_t *cache)
+{
+	guint		slot;
+
+	/* Already loaded in this run of the dfilter? */
+	if (df->attempted_load[reg]) {
+		if (df->registers[reg]) {
+			return TRUE;
+		}
+		else {
+			return FALSE;
+		}
 	}
 
-	df->registers[reg] = fvalues;
-	return TRUE;
+	df->attempted_load[reg] = TRUE;
+
+	/* Already loaded by another filter in the same set? */
+	if (cache != NULL && (guint)hfinfo->id < cache->slot_of_len &&
+			(slot = cache->slot_of[hfinfo->id]) != 0) {
+		slot--;
+		if (!cache->loaded[slot]) {
+			cache->values[slot] = load_fvalues(tree, hfinfo);
+			cache->loaded[slot] = TRUE;
+		}
+		df->registers[reg] = cache->values[slot];
+		df->borrowed[reg] = TRUE;
+		return df->registers[reg] != NULL;
+	}
+
+	df->registers[reg] = load_fvalues(tree, hfinfo);
+	return df->registers[reg] != NULL;
 }
 
 
@@ -349,6 +502,85 @@ put_fvalue(dfilter_t *df, fvalue_t *fv, int reg)
 
 typedef gboolean (*FvalueCmpFunc)(const fvalue_t*, const fvalue_t*);
 
+static gboolean
+uint32_set_contains(const GArray *set, guint32 value)
+{
+	const guint32	*values = (const guint32 *)set->data;
+	guint		lo = 0, hi = set->len, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (values[mid] == value) {
+			return TRUE;
+		}
+		if (values[mid] < value) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	return FALSE;
+}
+
+static gboolean
+uint32_test(dfvm_opcode_t op, guint32 value, const dfvm_value_t *arg)
+{
+	switch (op) {
+		case FIELD_EQ_U32:
+			return value == arg->value.numeric;
+		case FIELD_NE_U32:
+			return value != arg->value.numeric;
+		case FIELD_GT_U32:
+			return value > arg->value.numeric;
+		case FIELD_GE_U32:
+			return value >= arg->value.numeric;
+		case FIELD_LT_U32:
+			return value < arg->value.numeric;
+		case FIELD_LE_U32:
+			return value <= arg->value.numeric;
+		case FIELD_IN_U32:
+			return uint32_set_contains(arg->value.uint32_set, value);
+		default:
+			g_assert_not_reached();
+			return FALSE;
+	}
+}
+
+/* Compares the values of a field straight from the proto_tree, rather
+ * than going through READ_TREE's list of fvalues and the ftype's
+ * comparison functions. gencode.c only does this for fields whose
+ * values are all in fvalue_t's "uinteger" or "ipv4" members. */
+static gboolean
+field_uint32_test(proto_tree *tree, dfvm_opcode_t op,
+		header_field_info *hfinfo, const dfvm_value_t *arg)
+{
+	GPtrArray	*finfos;
+	field_info	*finfo;
+	guint32		value;
+	guint		i;
+
+	while (hfinfo) {
+		finfos = proto_get_finfo_ptr_array(tree, hfinfo->id);
+		if (finfos != NULL) {
+			for (i = 0; i < finfos->len; i++) {
+				finfo = (field_info *)g_ptr_array_index(finfos, i);
+				if (hfinfo->type == FT_IPv4) {
+					value = finfo->value.value.ipv4.addr;
+				}
+				else {
+					value = finfo->value.value.uinteger;
+				}
+				if (uint32_test(op, value, arg)) {
+					return TRUE;
+				}
+			}
+		}
+		hfinfo = hfinfo->same_name_next;
+	}
+	return FALSE;
+}
+
 static gboolean
 any_test(dfilter_t *df, FvalueCmpFunc cmp, int reg1, int reg2)
 {
@@ -379,7 +611,12 @@ free_register_overhead(dfilter_t* df)
 
 	for (i = 0; i < df->num_registers; i++) {
 		df->attempted_load[i] = FALSE;
-		if (df->registers[i]) {
+		if (df->borrowed[i]) {
+			/* The dfvm_field_cache_t frees these */
+			df->borrowed[i] = FALSE;
+			df->registers[i] = NULL;
+		}
+		else if (df->registers[i]) {
 			g_list_free(df->registers[i]);
 			df->registers[i] = NULL;
 		}
@@ -388,13 +625,19 @@ free_register_overhead(dfilter_t* df)
 
 /* Takes the list of fvalue_t's in a register, uses fvalue_slice()
  * to make a new list of fvalue_t's (which are ranges, or byte-slices),
- * and puts the new list into a new register. */
+ * and puts the new list into a new register, if that hasn't already
+ * been done in this run of the dfilter. */
 static void
 mk_range(dfilter_t *df, int from_reg, int to_reg, drange_t *d_range)
 {
 	GList		*from_list, *to_list;
 	fvalue_t	*old_fv, *new_fv;
 
+	if (df->attempted_load[to_reg]) {
+		return;
+	}
+	df->attempted_load[to_reg] = TRUE;
+
 	to_list = NULL;
 	from_list = df->registers[from_reg];
 
@@ -415,158 +658,445 @@ mk_range(dfilter_t *df, int from_reg, int to_reg, drange_t *d_range)
 
 
 
+static gboolean
+check_exists(proto_tree *tree, header_field_info *hfinfo)
+{
+	while (hfinfo) {
+		if (proto_check_for_protocol_or_field(tree, hfinfo->id)) {
+			return TRUE;
+		}
+		hfinfo = hfinfo->same_name_next;
+	}
+	return FALSE;
+}
+
+static gboolean
+call_function(dfilter_t *df, const dfvm_insn_t *insn)
+{
+	GList	*param1 = NULL;
+	GList	*param2 = NULL;
+
+	if (insn->arg3) {
+		param1 = df->registers[insn->arg3->value.numeric];
+	}
+	if (insn->arg4) {
+		param2 = df->registers[insn->arg4->value.numeric];
+	}
+	return insn->arg1->value.funcdef->function(param1, param2,
+			&df->registers[insn->arg2->value.numeric]);
+}
+
+/* Runs one instruction that isn't a jump or a RETURN, for
+ * dfvm_apply_profiled(); returns the new accumulator. */
+static gboolean
+exec_insn(dfilter_t *df, proto_tree *tree, dfvm_field_cache_t *cache,
+		const dfvm_insn_t *insn, gboolean accum)
+{
+	dfvm_value_t	*arg1 = insn->arg1;
+	dfvm_value_t	*arg2 = insn->arg2;
+	int		reg1 = 0, reg2 = 0;
+
+	switch (insn->op) {
+		case CHECK_EXISTS:
+			return check_exists(tree, arg1->value.hfinfo);
+		case READ_TREE:
+			return read_tree(df, tree, arg1->value.hfinfo,
+					arg2->value.numeric, cache);
+		case CALL_FUNCTION:
+			return call_function(df, insn);
+		case MK_RANGE:
+			mk_range(df, arg1->value.numeric, arg2->value.numeric,
+					insn->arg3->value.drange);
+			return accum;
+		case NOT:
+			return !accum;
+		case FIELD_EQ_U32:
+		case FIELD_NE_U32:
+		case FIELD_GT_U32:
+		case FIELD_GE_U32:
+		case FIELD_LT_U32:
+		case FIELD_LE_U32:
+		case FIELD_IN_U32:
+			return field_uint32_test(tree, insn->op,
+					arg1->value.hfinfo, arg2);
+		default:
+			break;
+	}
+
+	reg1 = arg1->value.numeric;
+	reg2 = arg2->value.numeric;
+	switch (insn->op) {
+		case ANY_EQ:
+			return any_test(df, fvalue_eq, reg1, reg2);
+		case ANY_NE:
+			return any_test(df, fvalue_ne, reg1, reg2);
+		case ANY_GT:
+			return any_test(df, fvalue_gt, reg1, reg2);
+		case ANY_GE:
+			return any_test(df, fvalue_ge, reg1, reg2);
+		case ANY_LT:
+			return any_test(df, fvalue_lt, reg1, reg2);
+		case ANY_LE:
+			return any_test(df, fvalue_le, reg1, reg2);
+		case ANY_BITWISE_AND:
+			return any_test(df, fvalue_bitwise_and, reg1, reg2);
+		case ANY_CONTAINS:
+			return any_test(df, fvalue_contains, reg1, reg2);
+		case ANY_MATCHES:
+			return any_test(df, fvalue_matches, reg1, reg2);
+		default:
+			g_assert_not_reached();
+			return FALSE;
+	}
+}
+
+/* dfvm_apply_cached() with dfilter_set_profiling() on: a plain loop
+ * that counts and times each instruction.  The clock is read once per
+ * instruction, so the time of one instruction includes the bookkeeping
+ * for the one before it. */
+static gboolean
+dfvm_apply_profiled(dfilter_t *df, proto_tree *tree, dfvm_field_cache_t *cache)
+{
+	dfvm_profile_t		*profile = df->profile;
+	dfvm_insn_profile_t	*insn_profile;
+	dfvm_insn_t		**insns;
+	dfvm_insn_t		*insn;
+	gboolean		accum = TRUE;
+	int			id, next;
+	guint64			start, before, now;
+
+	insns = (dfvm_insn_t **)df->insns->pdata;
+	id = 0;
+	start = before = monotonic_time_ns();
+
+	for (;;) {
+		insn = insns[id];
+		next = id + 1;
+
+		switch (insn->op) {
+			case RETURN:
+				free_register_overhead(df);
+				break;
+			case IF_TRUE_GOTO:
+				if (accum) {
+					next = insn->arg1->value.numeric;
+				}
+				break;
+			case IF_FALSE_GOTO:
+				if (!accum) {
+					next = insn->arg1->value.numeric;
+				}
+				break;
+			default:
+				accum = exec_insn(df, tree, cache, insn, accum);
+				break;
+		}
+
+		now = monotonic_time_ns();
+		insn_profile = &profile->insns[id];
+		insn_profile->count++;
+		if (accum) {
+			insn_profile->true_count++;
+		}
+		insn_profile->ns += now - before;
+		before = now;
+
+		if (insn->op == RETURN) {
+			break;
+		}
+		id = next;
+	}
+
+	profile->applies++;
+	if (accum) {
+		profile->matches++;
+	}
+	profile->ns += now - start;
+	return accum;
+}
+
+/*
+ * With compilers that support taking the address of a label (GCC, and
+ * clang, which also defines __GNUC__) each instruction's code jumps
+ * straight to the code for the next instruction through a table indexed
+ * by opcode: "threaded" dispatch.  That gives every instruction its own
+ * indirect branch, which the CPU predicts far better than the single
+ * shared branch at the top of a switch.  Otherwise, and if
+ * DFVM_NO_THREADED_DISPATCH is defined, we use the switch.
+ *
+ * The instruction bodies are the same either way; DFVM_OP() starts one,
+ * DFVM_NEXT() goes on to the following instruction and DFVM_JUMP() to
+ * instruction number "id".
+ *
+ * Label addresses and "goto *" are GNU extensions, so the table and the
+ * jump are marked with __extension__; otherwise -pedantic warns about
+ * them, and -Werror makes that an error.  The jump is wrapped in a
+ * statement expression, as __extension__ only applies to expressions
+ * and declarations.
+ */
+#if defined(__GNUC__) && !defined(DFVM_NO_THREADED_DISPATCH)
+#define DFVM_THREADED_DISPATCH
+#endif
+
+#ifdef DFVM_THREADED_DISPATCH
+#define DFVM_OP(op)	case op: L_##op:
+#define DFVM_JUMP()	do { \
+				insn = insns[id]; \
+				arg1 = insn->arg1; \
+				arg2 = insn->arg2; \
+				__extension__ ({ goto *dispatch_table[insn->op]; }); \
+			} while (0)
+#define DFVM_NEXT()	do { id++; DFVM_JUMP(); } while (0)
+#else
+#define DFVM_OP(op)	case op:
+#define DFVM_JUMP()	continue
+#define DFVM_NEXT()	id++; continue
+#endif
+
+gboolean
+dfvm_threaded_dispatch(void)
+{
+#ifdef DFVM_THREADED_DISPATCH
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
 gboolean
 dfvm_apply(dfilter_t *df, proto_tree *tree)
 {
-	int		id, length;
+	return dfvm_apply_cached(df, tree, NULL);
+}
+
+gboolean
+dfvm_apply_cached(dfilter_t *df, proto_tree *tree, dfvm_field_cache_t *cache)
+{
+	int		id;
 	gboolean	accum = TRUE;
+	dfvm_insn_t	**insns;
 	dfvm_insn_t	*insn;
 	dfvm_value_t	*arg1;
 	dfvm_value_t	*arg2;
 	dfvm_value_t	*arg3 = NULL;
-	dfvm_value_t	*arg4 = NULL;
-	header_field_info	*hfinfo;
-	GList		*param1;
-	GList		*param2;
+#ifdef DFVM_THREADED_DISPATCH
+	__extension__ static const void *const dispatch_table[] = {
+		&&L_IF_TRUE_GOTO,
+		&&L_IF_FALSE_GOTO,
+		&&L_CHECK_EXISTS,
+		&&L_NOT,
+		&&L_RETURN,
+		&&L_READ_TREE,
+		&&L_PUT_FVALUE,
+		&&L_ANY_EQ,
+		&&L_ANY_NE,
+		&&L_ANY_GT,
+		&&L_ANY_GE,
+		&&L_ANY_LT,
+		&&L_ANY_LE,
+		&&L_ANY_BITWISE_AND,
+		&&L_ANY_CONTAINS,
+		&&L_ANY_MATCHES,
+		&&L_MK_RANGE,
+		&&L_CALL_FUNCTION,
+		&&L_FIELD_EQ_U32,
+		&&L_FIELD_NE_U32,
+		&&L_FIELD_GT_U32,
+		&&L_FIELD_GE_U32,
+		&&L_FIELD_LT_U32,
+		&&L_FIELD_LE_U32,
+		&&L_FIELD_IN_U32
+	};
+#endif
 
 	g_assert(tree);
 
-	length = df->insns->len;
+	if (G_UNLIKELY(df->profile != NULL)) {
+		return dfvm_apply_profiled(df, tree, cache);
+	}
 
-	for (id = 0; id < length; id++) {
+	/* Every program ends with a RETURN, so there's no need to check
+	 * for running off the end. */
+	insns = (dfvm_insn_t **)df->insns->pdata;
+	id = 0;
 
-	  AGAIN:
-		insn = (dfvm_insn_t	*)g_ptr_array_index(df->insns, id);
+	for (;;) {
+		insn = insns[id];
 		arg1 = insn->arg1;
 		arg2 = insn->arg2;
 
 		switch (insn->op) {
-			case CHECK_EXISTS:
-				hfinfo = arg1->value.hfinfo;
-				while(hfinfo) {
-					accum = proto_check_for_protocol_or_field(tree,
-							hfinfo->id);
-					if (accum) {
-						break;
-					}
-					else {
-						hfinfo = hfinfo->same_name_next;
-					}
-				}
-				break;
+			DFVM_OP(CHECK_EXISTS)
+				accum = check_exists(tree, arg1->value.hfinfo);
+				DFVM_NEXT();
 
-			case READ_TREE:
+			DFVM_OP(READ_TREE)
 				accum = read_tree(df, tree,
-						arg1->value.hfinfo, arg2->value.numeric);
-				break;
+						arg1->value.hfinfo, arg2->value.numeric,
+						cache);
+				DFVM_NEXT();
 
-			case CALL_FUNCTION:
-				arg3 = insn->arg3;
-				arg4 = insn->arg4;
-				param1 = NULL;
-				param2 = NULL;
-				if (arg3) {
-					param1 = df->registers[arg3->value.numeric];
-				}
-				if (arg4) {
-					param2 = df->registers[arg4->value.numeric];
-				}
-				accum = arg1->value.funcdef->function(param1, param2,
-						&df->registers[arg2->value.numeric]);
-				break;
+			DFVM_OP(CALL_FUNCTION)
+				accum = call_function(df, insn);
+				DFVM_NEXT();
 
-			case MK_RANGE:
+			DFVM_OP(MK_RANGE)
 				arg3 = insn->arg3;
 				mk_range(df,
 						arg1->value.numeric, arg2->value.numeric,
 						arg3->value.drange);
-				break;
+				DFVM_NEXT();
 
-			case ANY_EQ:
+			DFVM_OP(ANY_EQ)
 				accum = any_test(df, fvalue_eq,
 						arg1->value.numeric, arg2->value.numeric);
-				break;
+				DFVM_NEXT();
 
-			case ANY_NE:
+			DFVM_OP(ANY_NE)
 				accum = any_test(df, fvalue_ne,
 						arg1->value.numeric, arg2->value.numeric);
-				break;
+				DFVM_NEXT();
 
-			case ANY_GT:
+			DFVM_OP(ANY_GT)
 				accum = any_test(df, fvalue_gt,
 						arg1->value.numeric, arg2->value.numeric);
-				break;
+				DFVM_NEXT();
 
-			case ANY_GE:
+			DFVM_OP(ANY_GE)
 				accum = any_test(df, fvalue_ge,
 						arg1->value.numeric, arg2->value.numeric);
-				break;
+				DFVM_NEXT();
 
-			case ANY_LT:
+			DFVM_OP(ANY_LT)
 				accum = any_test(df, fvalue_lt,
 						arg1->value.numeric, arg2->value.numeric);
-				break;
+				DFVM_NEXT();
 
-			case ANY_LE:
+			DFVM_OP(ANY_LE)
 				accum = any_test(df, fvalue_le,
 						arg1->value.numeric, arg2->value.numeric);
-				break;
+				DFVM_NEXT();
 
-			case ANY_BITWISE_AND:
+			DFVM_OP(ANY_BITWISE_AND)
 				accum = any_test(df, fvalue_bitwise_and,
 						arg1->value.numeric, arg2->value.numeric);
-				break;
+				DFVM_NEXT();
 
-			case ANY_CONTAINS:
+			DFVM_OP(ANY_CONTAINS)
 				accum = any_test(df, fvalue_contains,
 						arg1->value.numeric, arg2->value.numeric);
-				break;
+				DFVM_NEXT();
 
-			case ANY_MATCHES:
+			DFVM_OP(ANY_MATCHES)
 				accum = any_test(df, fvalue_matches,
 						arg1->value.numeric, arg2->value.numeric);
-				break;
-
-			case NOT:
+				DFVM_NEXT();
+
+			DFVM_OP(FIELD_EQ_U32)
+			DFVM_OP(FIELD_NE_U32)
+			DFVM_OP(FIELD_GT_U32)
+			DFVM_OP(FIELD_GE_U32)
+			DFVM_OP(FIELD_LT_U32)
+			DFVM_OP(FIELD_LE_U32)
+			DFVM_OP(FIELD_IN_U32)
+				accum = field_uint32_test(tree, insn->op,
+						arg1->value.hfinfo, arg2);
+				DFVM_NEXT();
+
+			DFVM_OP(NOT)
 				accum = !accum;
-				break;
+				DFVM_NEXT();
 
-			case RETURN:
+			DFVM_OP(RETURN)
 				free_register_overhead(df);
 				return accum;
 
-			case IF_TRUE_GOTO:
+			DFVM_OP(IF_TRUE_GOTO)
 				if (accum) {
 					id = arg1->value.numeric;
-					goto AGAIN;
+					DFVM_JUMP();
 				}
-				break;
+				DFVM_NEXT();
 
-			case IF_FALSE_GOTO:
+			DFVM_OP(IF_FALSE_GOTO)
 				if (!accum) {
 					id = arg1->value.numeric;
-					goto AGAIN;
+					DFVM_JUMP();
 				}
-				break;
-
-			case PUT_FVALUE:
-#if 0
-                                /* These were handled in the constants initialization */
-				accum = put_fvalue(df,
-						arg1->value.fvalue, arg2->value.numeric);
-				break;
-#endif
+				DFVM_NEXT();
 
+			DFVM_OP(PUT_FVALUE)
+				/* These were handled in the constants initialization */
 			default:
 				g_assert_not_reached();
 				break;
 		}
+		break;
 	}
 
 	g_assert_not_reached();
 	return FALSE; /* to appease the compiler */
 }
 
+void
+dfvm_field_cache_add(dfvm_field_cache_t *cache, const dfilter_t *df)
+{
+	guint			i, old_len;
+	dfvm_insn_t		*insn;
+	header_field_info	*hfinfo;
+
+	for (i = 0; i < df->insns->len; i++) {
+		insn = (dfvm_insn_t *)g_ptr_array_index(df->insns, i);
+		if (insn->op != READ_TREE) {
+			continue;
+		}
+		hfinfo = insn->arg1->value.hfinfo;
+
+		if ((guint)hfinfo->id >= cache->slot_of_len) {
+			old_len = cache->slot_of_len;
+			cache->slot_of_len = hfinfo->id + 1;
+			cache->slot_of = g_renew(guint, cache->slot_of,
+					cache->slot_of_len);
+			memset(cache->slot_of + old_len, 0,
+					(cache->slot_of_len - old_len) * sizeof(guint));
+		}
+		if (cache->slot_of[hfinfo->id] != 0) {
+			continue;
+		}
+
+		cache->num_slots++;
+		cache->slot_of[hfinfo->id] = cache->num_slots;
+		cache->values = g_renew(GList *, cache->values, cache->num_slots);
+		cache->loaded = g_renew(gboolean, cache->loaded, cache->num_slots);
+		cache->values[cache->num_slots - 1] = NULL;
+		cache->loaded[cache->num_slots - 1] = FALSE;
+	}
+}
+
+void
+dfvm_field_cache_reset(dfvm_field_cache_t *cache)
+{
+	guint	i;
+
+	for (i = 0; i < cache->num_slots; i++) {
+		if (cache->loaded[i]) {
+			g_list_free(cache->values[i]);
+			cache->values[i] = NULL;
+			cache->loaded[i] = FALSE;
+		}
+	}
+}
+
+void
+dfvm_field_cache_free(dfvm_field_cache_t *cache)
+{
+	dfvm_field_cache_reset(cache);
+	g_free(cache->slot_of);
+	g_free(cache->values);
+	g_free(cache->loaded);
+	memset(cache, 0, sizeof *cache);
+}
+
 void
 dfvm_init_const(dfilter_t *df)
 {
@@ -36,7 +36,8 @@ typedef enum {
 	REGISTER,
 	INTEGER,
 	DRANGE,
-	FUNCTION_DEF
+	FUNCTION_DEF,
+	UINT32_SET
 } dfvm_value_type_t;
 
 typedef struct {
@@ -48,11 +49,14 @@ typedef struct {
 		drange_t		*drange;
 		header_field_info	*hfinfo;
         df_func_def_t   *funcdef;
+		GArray			*uint32_set;	/* sorted guint32's */
 	} value;
 
 } dfvm_value_t;
 
 
+/* dfvm_apply()'s dispatch_table has an entry for each of these,
+ * in the same order. */
 typedef enum {
 
 	IF_TRUE_GOTO,
@@ -72,7 +76,18 @@ typedef enum {
 	ANY_CONTAINS,
 	ANY_MATCHES,
 	MK_RANGE,
-    CALL_FUNCTION
+    CALL_FUNCTION,
+
+	/* Test the 32-bit unsigned integer or IPv4 address values
+	 * of an hfinfo straight from the proto_tree, against a
+	 * constant or a set of constants. */
+	FIELD_EQ_U32,
+	FIELD_NE_U32,
+	FIELD_GT_U32,
+	FIELD_GE_U32,
+	FIELD_LT_U32,
+	FIELD_LE_U32,
+	FIELD_IN_U32
 
 } dfvm_opcode_t;
 
@@ -97,9 +112,44 @@ dfvm_value_new(dfvm_value_type_t type);
 void
 dfvm_dump(FILE *f, dfilter_t *df);
 
+/* Dump the instructions with the counts and times collected while
+ * profiling. */
+void
+dfvm_dump_profile(FILE *f, dfilter_t *df);
+
 gboolean
 dfvm_apply(dfilter_t *df, proto_tree *tree);
 
+/* Field values read from the tree once and shared by all the filters
+ * in a dfilter set for the packet being filtered. */
+typedef struct {
+	guint		*slot_of;	/* indexed by field ID; slot + 1, or 0 */
+	guint		slot_of_len;
+	guint		num_slots;
+	GList		**values;	/* indexed by slot */
+	gboolean	*loaded;	/* indexed by slot */
+} dfvm_field_cache_t;
+
+/* Like dfvm_apply(), but take fields listed in the cache from there,
+ * reading them into it if no other filter has yet. */
+gboolean
+dfvm_apply_cached(dfilter_t *df, proto_tree *tree, dfvm_field_cache_t *cache);
+
+/* Give every field the filter reads a slot in the cache. */
+void
+dfvm_field_cache_add(dfvm_field_cache_t *cache, const dfilter_t *df);
+
+/* Forget the values read for the last packet. */
+void
+dfvm_field_cache_reset(dfvm_field_cache_t *cache);
+
+void
+dfvm_field_cache_free(dfvm_field_cache_t *cache);
+
+/* TRUE if dfvm_apply() was built to use threaded dispatch */
+gboolean
+dfvm_threaded_dispatch(void);
+
 void
 dfvm_init_const(dfilter_t *df);
 
@@ -197,6 +197,26 @@ gint drange_get_total_length(drange_t * dr) { return dr->total_length; }
 gint drange_get_min_start_offset(drange_t * dr) { return dr->min_start_offset; }
 gint drange_get_max_start_offset(drange_t * dr) { return dr->max_start_offset; }
 
+gboolean
+drange_equal(drange_t * a, drange_t * b)
+{
+  GSList *la, *lb;
+  drange_node *na, *nb;
+
+  for (la = a->range_list, lb = b->range_list; la && lb;
+       la = la->next, lb = lb->next) {
+    na = (drange_node *)la->data;
+    nb = (drange_node *)lb->data;
+    if (na->start_offset != nb->start_offset || na->ending != nb->ending)
+      return FALSE;
+    if (na->ending == DRANGE_NODE_END_T_LENGTH && na->length != nb->length)
+      return FALSE;
+    if (na->ending == DRANGE_NODE_END_T_OFFSET && na->end_offset != nb->end_offset)
+      return FALSE;
+  }
+  return la == NULL && lb == NULL;
+}
+
 static void
 update_drange_with_node(drange_t *dr, drange_node *drnode)
 {
@@ -94,6 +94,9 @@ gint drange_get_total_length(drange_t* dr);
 gint drange_get_min_start_offset(drange_t* dr);
 gint drange_get_max_start_offset(drange_t* dr);
 
+/* TRUE if both dranges select the same bytes */
+gboolean drange_equal(drange_t* a, drange_t* b);
+
 /* drange mutators */
 void drange_append_drange_node(drange_t* dr, drange_node* drnode);
 void drange_prepend_drange_node(drange_t* dr, drange_node* drnode);
@@ -35,6 +35,26 @@ gencode(dfwork_t *dfw, stnode_t *st_node);
 static int
 gen_entity(dfwork_t *dfw, stnode_t *st_arg, dfvm_value_t **p_jmp);
 
+/* A range already made from a register, and where it was put. */
+typedef struct {
+	int		from_reg;
+	drange_t	*drange;
+	int		reg;
+} loaded_range_t;
+
+/* Record the FIELD_IDs of hfinfo, and of any others with the same name,
+ * in the hash of interesting fields. */
+static void
+dfw_add_interesting_fields(dfwork_t *dfw, header_field_info *hfinfo)
+{
+	while (hfinfo) {
+		g_hash_table_insert(dfw->interesting_fields,
+		    GINT_TO_POINTER(hfinfo->id),
+		    GUINT_TO_POINTER(TRUE));
+		hfinfo = hfinfo->same_name_next;
+	}
+}
+
 static void
 dfw_append_insn(dfwork_t *dfw, dfvm_insn_t *insn)
 {
@@ -51,9 +71,38 @@ dfw_append_const(dfwork_t *dfw, dfvm_insn_t *insn)
 	g_ptr_array_add(dfw->consts, insn);
 }
 
+/* dfw->known_loaded lists the registers that are sure to have been
+ * loaded, with at least one value, whenever the code being generated
+ * now is run; there's no need to load those again. What's in the list
+ * only holds while the tests generated so far are true, so it has to
+ * be cut back to what it was before a test whenever code can go on
+ * running after that test fails. */
+static gboolean
+dfw_is_known_loaded(dfwork_t *dfw, int reg)
+{
+	return g_slist_find(dfw->known_loaded, GINT_TO_POINTER(reg)) != NULL;
+}
+
+static void
+dfw_set_known_loaded(dfwork_t *dfw, int reg)
+{
+	dfw->known_loaded = g_slist_prepend(dfw->known_loaded,
+			GINT_TO_POINTER(reg));
+}
+
+static void
+dfw_restore_known_loaded(dfwork_t *dfw, GSList *saved)
+{
+	while (dfw->known_loaded != saved) {
+		dfw->known_loaded = g_slist_delete_link(dfw->known_loaded,
+				dfw->known_loaded);
+	}
+}
+
 /* returns register number */
 static int
-dfw_append_read_tree(dfwork_t *dfw, header_field_info *hfinfo)
+dfw_append_read_tree(dfwork_t *dfw, header_field_info *hfinfo,
+		dfvm_value_t **p_jmp)
 {
 	dfvm_insn_t	*insn;
 	dfvm_value_t	*val1, *val2;
@@ -85,6 +134,12 @@ dfw_append_read_tree(dfwork_t *dfw, header_field_info *hfinfo)
 		added_new_hfinfo = TRUE;
 	}
 
+	if (dfw_is_known_loaded(dfw, reg)) {
+		/* Nothing to do; and as it can't fail, there's
+		 * nothing for the caller to jump away on either. */
+		return reg;
+	}
+
 	insn = dfvm_insn_new(READ_TREE);
 	val1 = dfvm_value_new(HFINFO);
 	val1->value.hfinfo = hfinfo;
@@ -95,14 +150,17 @@ dfw_append_read_tree(dfwork_t *dfw, header_field_info *hfinfo)
 	insn->arg2 = val2;
 	dfw_append_insn(dfw, insn);
 
+	insn = dfvm_insn_new(IF_FALSE_GOTO);
+	g_assert(p_jmp);
+	*p_jmp = dfvm_value_new(INSN_NUMBER);
+	insn->arg1 = *p_jmp;
+	dfw_append_insn(dfw, insn);
+
+	/* Anything after the IF_FALSE_GOTO only runs if the read worked */
+	dfw_set_known_loaded(dfw, reg);
+
 	if (added_new_hfinfo) {
-		while (hfinfo) {
-			/* Record the FIELD_ID in hash of interesting fields. */
-			g_hash_table_insert(dfw->interesting_fields,
-			    GINT_TO_POINTER(hfinfo->id),
-			    GUINT_TO_POINTER(TRUE));
-			hfinfo = hfinfo->same_name_next;
-		}
+		dfw_add_interesting_fields(dfw, hfinfo);
 	}
 
 	return reg;
@@ -137,12 +195,39 @@ dfw_append_mk_range(dfwork_t *dfw, stnode_t *node, dfvm_value_t **p_jmp)
 	stnode_t                *entity;
 	dfvm_insn_t		*insn;
 	dfvm_value_t		*val;
+	drange_t		*drange;
+	GSList			*l;
+	loaded_range_t		*lr = NULL;
 
 	entity = sttype_range_entity(node);
 
 	/* XXX, check if p_jmp logic is OK */
 	hf_reg = gen_entity(dfw, entity, p_jmp);
 
+	/* The same range of the same field always gives the same
+	 * bytes, so make it just once and share the register. */
+	drange = sttype_range_drange(node);
+	for (l = dfw->loaded_ranges; l; l = l->next) {
+		lr = (loaded_range_t *)l->data;
+		if (lr->from_reg == hf_reg && drange_equal(lr->drange, drange)) {
+			break;
+		}
+	}
+	if (l) {
+		reg = lr->reg;
+		if (dfw_is_known_loaded(dfw, reg)) {
+			return reg;
+		}
+	}
+	else {
+		reg = dfw->next_register++;
+		lr = g_new(loaded_range_t, 1);
+		lr->from_reg = hf_reg;
+		lr->drange = drange;
+		lr->reg = reg;
+		dfw->loaded_ranges = g_slist_prepend(dfw->loaded_ranges, lr);
+	}
+
 	insn = dfvm_insn_new(MK_RANGE);
 
 	val = dfvm_value_new(REGISTER);
@@ -150,17 +235,17 @@ dfw_append_mk_range(dfwork_t *dfw, stnode_t *node, dfvm_value_t **p_jmp)
 	insn->arg1 = val;
 
 	val = dfvm_value_new(REGISTER);
-	reg =dfw->next_register++;
 	val->value.numeric = reg;
 	insn->arg2 = val;
 
 	val = dfvm_value_new(DRANGE);
-	val->value.drange = sttype_range_drange(node);
+	val->value.drange = drange;
 	insn->arg3 = val;
 
 	sttype_range_remove_drange(node);
 
 	dfw_append_insn(dfw, insn);
+	dfw_set_known_loaded(dfw, reg);
 
 	return reg;
 }
@@ -277,6 +362,295 @@ gen_relation(dfwork_t *dfw, dfvm_opcode_t op, stnode_t *st_arg1, stnode_t *st_ar
 	}
 }
 
+/* Can the values of this field, and of any others with the same name,
+ * be tested as guint32's straight from the proto_tree? If so, hand
+ * back the first field of that name. */
+static gboolean
+hfinfo_is_uint32(header_field_info **p_hfinfo)
+{
+	header_field_info	*hfinfo = *p_hfinfo;
+	ftenum_t		ftype = hfinfo->type;
+
+	switch (ftype) {
+		case FT_UINT8:
+		case FT_UINT16:
+		case FT_UINT24:
+		case FT_UINT32:
+		case FT_FRAMENUM:
+		case FT_IPv4:
+			break;
+		default:
+			return FALSE;
+	}
+
+	/* Rewind to find the first field of this name. */
+	while (hfinfo->same_name_prev_id != -1) {
+		hfinfo = proto_registrar_get_nth(hfinfo->same_name_prev_id);
+	}
+	*p_hfinfo = hfinfo;
+
+	while (hfinfo) {
+		if (hfinfo->type != ftype) {
+			return FALSE;
+		}
+		hfinfo = hfinfo->same_name_next;
+	}
+	return TRUE;
+}
+
+/* Is this test a comparison between such a field and a constant? If so,
+ * hand back the field, the constant, and the FIELD_*_U32 opcode for the
+ * comparison written with the field on the left. */
+static gboolean
+uint32_relation(stnode_t *st_node, dfvm_opcode_t *p_op,
+		header_field_info **p_hfinfo, guint32 *p_value)
+{
+	test_op_t		st_op;
+	stnode_t		*st_arg1, *st_arg2, *st_field, *st_fvalue;
+	header_field_info	*hfinfo;
+	fvalue_t		*fv;
+	gboolean		swapped;
+
+	sttype_test_get(st_node, &st_op, &st_arg1, &st_arg2);
+
+	switch (st_op) {
+		case TEST_OP_EQ:
+		case TEST_OP_NE:
+		case TEST_OP_GT:
+		case TEST_OP_GE:
+		case TEST_OP_LT:
+		case TEST_OP_LE:
+			break;
+		default:
+			return FALSE;
+	}
+
+	if (stnode_type_id(st_arg1) == STTYPE_FIELD &&
+	    stnode_type_id(st_arg2) == STTYPE_FVALUE) {
+		st_field = st_arg1;
+		st_fvalue = st_arg2;
+		swapped = FALSE;
+	}
+	else if (stnode_type_id(st_arg1) == STTYPE_FVALUE &&
+	    stnode_type_id(st_arg2) == STTYPE_FIELD) {
+		st_field = st_arg2;
+		st_fvalue = st_arg1;
+		swapped = TRUE;
+	}
+	else {
+		return FALSE;
+	}
+
+	hfinfo = (header_field_info*)stnode_data(st_field);
+	fv = (fvalue_t *)stnode_data(st_fvalue);
+	if (fvalue_type_ftenum(fv) != hfinfo->type || !hfinfo_is_uint32(&hfinfo)) {
+		return FALSE;
+	}
+
+	if (hfinfo->type == FT_IPv4) {
+		/* A netmask makes it a test of a range of addresses. */
+		if (fv->value.ipv4.nmask != 0xffffffff) {
+			return FALSE;
+		}
+		*p_value = fv->value.ipv4.addr;
+	}
+	else {
+		*p_value = fvalue_get_uinteger(fv);
+	}
+
+	switch (st_op) {
+		case TEST_OP_EQ:
+			*p_op = FIELD_EQ_U32;
+			break;
+		case TEST_OP_NE:
+			*p_op = FIELD_NE_U32;
+			break;
+		case TEST_OP_GT:
+			*p_op = swapped ? FIELD_LT_U32 : FIELD_GT_U32;
+			break;
+		case TEST_OP_GE:
+			*p_op = swapped ? FIELD_LE_U32 : FIELD_GE_U32;
+			break;
+		case TEST_OP_LT:
+			*p_op = swapped ? FIELD_GT_U32 : FIELD_LT_U32;
+			break;
+		case TEST_OP_LE:
+			*p_op = swapped ? FIELD_GE_U32 : FIELD_LE_U32;
+			break;
+		default:
+			g_assert_not_reached();
+	}
+	*p_hfinfo = hfinfo;
+	return TRUE;
+}
+
+static void
+dfw_append_field_uint32(dfwork_t *dfw, dfvm_opcode_t op,
+		header_field_info *hfinfo, dfvm_value_t *val2)
+{
+	dfvm_insn_t	*insn;
+	dfvm_value_t	*val1;
+
+	insn = dfvm_insn_new(op);
+	val1 = dfvm_value_new(HFINFO);
+	val1->value.hfinfo = hfinfo;
+	insn->arg1 = val1;
+	insn->arg2 = val2;
+	dfw_append_insn(dfw, insn);
+
+	dfw_add_interesting_fields(dfw, hfinfo);
+}
+
+/* Generate a FIELD_*_U32 test for a relation, if it is one of those
+ * uint32_relation() accepts. */
+static gboolean
+gen_uint32_relation(dfwork_t *dfw, stnode_t *st_node)
+{
+	dfvm_opcode_t		op;
+	header_field_info	*hfinfo;
+	guint32			value;
+	dfvm_value_t		*val;
+
+	if (!uint32_relation(st_node, &op, &hfinfo, &value)) {
+		return FALSE;
+	}
+
+	val = dfvm_value_new(INTEGER);
+	val->value.numeric = value;
+	dfw_append_field_uint32(dfw, op, hfinfo, val);
+	return TRUE;
+}
+
+static int
+uint32_compare(gconstpointer a, gconstpointer b)
+{
+	guint32	ua = *(const guint32 *)a;
+	guint32	ub = *(const guint32 *)b;
+
+	return ua < ub ? -1 : (ua > ub ? 1 : 0);
+}
+
+/* "f == 1 or f == 2 or ..." is a test of whether f is in the set of
+ * those constants. Look for other operands of an "or" that test the
+ * same field for equality as operands[first] does, and if there are
+ * any, generate one FIELD_IN_U32 test for all of them and mark them
+ * used. */
+static gboolean
+gen_uint32_set(dfwork_t *dfw, GPtrArray *operands, guint first,
+		gboolean *used)
+{
+	dfvm_opcode_t		op;
+	header_field_info	*hfinfo, *hfinfo_j;
+	guint32			value;
+	GArray			*set;
+	dfvm_value_t		*val;
+	guint			i, j;
+
+	if (!uint32_relation((stnode_t *)g_ptr_array_index(operands, first),
+			&op, &hfinfo, &value) || op != FIELD_EQ_U32) {
+		return FALSE;
+	}
+
+	set = g_array_new(FALSE, FALSE, sizeof(guint32));
+	g_array_append_val(set, value);
+	for (j = first + 1; j < operands->len; j++) {
+		if (!used[j] &&
+		    uint32_relation((stnode_t *)g_ptr_array_index(operands, j),
+			    &op, &hfinfo_j, &value) &&
+		    op == FIELD_EQ_U32 && hfinfo_j == hfinfo) {
+			g_array_append_val(set, value);
+			used[j] = TRUE;
+		}
+	}
+
+	if (set->len == 1) {
+		g_array_free(set, TRUE);
+		return FALSE;
+	}
+	used[first] = TRUE;
+
+	/* Sort, and drop duplicates, for the binary search in dfvm.c */
+	g_array_sort(set, uint32_compare);
+	for (i = 0, j = 1; j < set->len; j++) {
+		if (g_array_index(set, guint32, j) != g_array_index(set, guint32, i)) {
+			i++;
+			g_array_index(set, guint32, i) = g_array_index(set, guint32, j);
+		}
+	}
+	g_array_set_size(set, i + 1);
+
+	val = dfvm_value_new(UINT32_SET);
+	val->value.uint32_set = set;
+	dfw_append_field_uint32(dfw, FIELD_IN_U32, hfinfo, val);
+	return TRUE;
+}
+
+static void
+collect_or_chain(stnode_t *st_node, GPtrArray *operands)
+{
+	test_op_t	st_op;
+	stnode_t	*st_arg1, *st_arg2;
+
+	sttype_test_get(st_node, &st_op, &st_arg1, &st_arg2);
+	if (st_op == TEST_OP_OR) {
+		collect_or_chain(st_arg1, operands);
+		collect_or_chain(st_arg2, operands);
+	}
+	else {
+		g_ptr_array_add(operands, st_node);
+	}
+}
+
+/* Generate "a or b or c ...": each operand in turn, with a jump to the
+ * end as soon as one of them is true. */
+static void
+gen_or(dfwork_t *dfw, stnode_t *st_node)
+{
+	GPtrArray	*operands, *jmps;
+	gboolean	*used;
+	GSList		*known_loaded;
+	dfvm_insn_t	*insn;
+	dfvm_value_t	*val1;
+	guint		i, j;
+
+	operands = g_ptr_array_new();
+	collect_or_chain(st_node, operands);
+	used = g_new0(gboolean, operands->len);
+	jmps = g_ptr_array_new();
+	known_loaded = dfw->known_loaded;
+
+	for (i = 0; i < operands->len; i++) {
+		if (used[i]) {
+			continue;
+		}
+		if (!gen_uint32_set(dfw, operands, i, used)) {
+			gencode(dfw, (stnode_t *)g_ptr_array_index(operands, i));
+			used[i] = TRUE;
+		}
+		/* The next operand only runs if this one was false */
+		dfw_restore_known_loaded(dfw, known_loaded);
+
+		for (j = i + 1; j < operands->len && used[j]; j++)
+			;
+		if (j < operands->len) {
+			insn = dfvm_insn_new(IF_TRUE_GOTO);
+			val1 = dfvm_value_new(INSN_NUMBER);
+			insn->arg1 = val1;
+			dfw_append_insn(dfw, insn);
+			g_ptr_array_add(jmps, val1);
+		}
+	}
+
+	for (i = 0; i < jmps->len; i++) {
+		val1 = (dfvm_value_t *)g_ptr_array_index(jmps, i);
+		val1->value.numeric = dfw->next_insn_id;
+	}
+
+	g_ptr_array_free(jmps, TRUE);
+	g_free(used);
+	g_ptr_array_free(operands, TRUE);
+}
+
 /* Parse an entity, returning the reg that it gets put into.
  * p_jmp will be set if it has to be set by the calling code; it should
  * be set to the place to jump to, to return to the calling code,
@@ -292,13 +666,7 @@ gen_entity(dfwork_t *dfw, stnode_t *st_arg, dfvm_value_t **p_jmp)
 
 	if (e_type == STTYPE_FIELD) {
 		hfinfo = (header_field_info*)stnode_data(st_arg);
-		reg = dfw_append_read_tree(dfw, hfinfo);
-
-		insn = dfvm_insn_new(IF_FALSE_GOTO);
-		g_assert(p_jmp);
-		*p_jmp = dfvm_value_new(INSN_NUMBER);
-		insn->arg1 = *p_jmp;
-		dfw_append_insn(dfw, insn);
+		reg = dfw_append_read_tree(dfw, hfinfo, p_jmp);
 	}
 	else if (e_type == STTYPE_FVALUE) {
 		reg = dfw_append_put_fvalue(dfw, (fvalue_t *)stnode_data(st_arg));
@@ -324,6 +692,7 @@ gen_test(dfwork_t *dfw, stnode_t *st_node)
 	stnode_t	*st_arg1, *st_arg2;
 	dfvm_value_t	*val1;
 	dfvm_insn_t	*insn;
+	GSList		*known_loaded;
 
 	header_field_info	*hfinfo;
 
@@ -347,18 +716,13 @@ gen_test(dfwork_t *dfw, stnode_t *st_node)
 			insn->arg1 = val1;
 			dfw_append_insn(dfw, insn);
 
-			/* Record the FIELD_ID in hash of interesting fields. */
-			while (hfinfo) {
-				g_hash_table_insert(dfw->interesting_fields,
-					GINT_TO_POINTER(hfinfo->id),
-					GUINT_TO_POINTER(TRUE));
-				hfinfo = hfinfo->same_name_next;
-			}
-
+			dfw_add_interesting_fields(dfw, hfinfo);
 			break;
 
 		case TEST_OP_NOT:
+			known_loaded = dfw->known_loaded;
 			gencode(dfw, st_arg1);
+			dfw_restore_known_loaded(dfw, known_loaded);
 			insn = dfvm_insn_new(NOT);
 			dfw_append_insn(dfw, insn);
 			break;
@@ -376,39 +740,43 @@ gen_test(dfwork_t *dfw, stnode_t *st_node)
 			break;
 
 		case TEST_OP_OR:
-			gencode(dfw, st_arg1);
-
-			insn = dfvm_insn_new(IF_TRUE_GOTO);
-			val1 = dfvm_value_new(INSN_NUMBER);
-			insn->arg1 = val1;
-			dfw_append_insn(dfw, insn);
-
-			gencode(dfw, st_arg2);
-			val1->value.numeric = dfw->next_insn_id;
+			gen_or(dfw, st_node);
 			break;
 
 		case TEST_OP_EQ:
-			gen_relation(dfw, ANY_EQ, st_arg1, st_arg2);
+			if (!gen_uint32_relation(dfw, st_node)) {
+				gen_relation(dfw, ANY_EQ, st_arg1, st_arg2);
+			}
 			break;
 
 		case TEST_OP_NE:
-			gen_relation(dfw, ANY_NE, st_arg1, st_arg2);
+			if (!gen_uint32_relation(dfw, st_node)) {
+				gen_relation(dfw, ANY_NE, st_arg1, st_arg2);
+			}
 			break;
 
 		case TEST_OP_GT:
-			gen_relation(dfw, ANY_GT, st_arg1, st_arg2);
+			if (!gen_uint32_relation(dfw, st_node)) {
+				gen_relation(dfw, ANY_GT, st_arg1, st_arg2);
+			}
 			break;
 
 		case TEST_OP_GE:
-			gen_relation(dfw, ANY_GE, st_arg1, st_arg2);
+			if (!gen_uint32_relation(dfw, st_node)) {
+				gen_relation(dfw, ANY_GE, st_arg1, st_arg2);
+			}
 			break;
 
 		case TEST_OP_LT:
-			gen_relation(dfw, ANY_LT, st_arg1, st_arg2);
+			if (!gen_uint32_relation(dfw, st_node)) {
+				gen_relation(dfw, ANY_LT, st_arg1, st_arg2);
+			}
 			break;
 
 		case TEST_OP_LE:
-			gen_relation(dfw, ANY_LE, st_arg1, st_arg2);
+			if (!gen_uint32_relation(dfw, st_node)) {
+				gen_relation(dfw, ANY_LE, st_arg1, st_arg2);
+			}
 			break;
 
 		case TEST_OP_BITWISE_AND:
@@ -456,6 +824,12 @@ dfw_gencode(dfwork_t *dfw)
 	gencode(dfw, dfw->st_root);
 	dfw_append_insn(dfw, dfvm_insn_new(RETURN));
 
+	g_slist_free(dfw->known_loaded);
+	dfw->known_loaded = NULL;
+	g_slist_foreach(dfw->loaded_ranges, (GFunc)g_free, NULL);
+	g_slist_free(dfw->loaded_ranges);
+	dfw->loaded_ranges = NULL;
+
 	/* fixup goto */
 	length = dfw->insns->len;
 
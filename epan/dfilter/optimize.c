@@ -0,0 +1,298 @@
+/*
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 2001 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include "dfilter-int.h"
+#include "optimize.h"
+#include "syntax-tree.h"
+#include "sttype-range.h"
+#include "sttype-test.h"
+#include "sttype-function.h"
+#include "ftypes/ftypes.h"
+
+/*
+ * The passes here only ever rewrite a test into an equivalent one.
+ * That's possible because nothing a test does has side effects: the
+ * same test on the same proto_tree always gives the same answer, so
+ * the operands of "and" and "or" can be run in any order, and an
+ * operand that repeats an earlier one can be dropped.
+ */
+
+/* Rough relative cost of the code generated for each kind of node. */
+#define COST_CHECK_EXISTS	1
+#define COST_READ_TREE		2
+#define COST_MK_RANGE		2
+#define COST_CALL_FUNCTION	4
+#define COST_COMPARE		1
+#define COST_CONTAINS		8
+#define COST_MATCHES		16
+
+static stnode_t *
+optimize_test(stnode_t *node);
+
+static int
+entity_cost(stnode_t *node)
+{
+	GSList	*params;
+	int	cost;
+
+	switch (stnode_type_id(node)) {
+		case STTYPE_FIELD:
+			return COST_READ_TREE;
+
+		case STTYPE_RANGE:
+			return entity_cost(sttype_range_entity(node)) + COST_MK_RANGE;
+
+		case STTYPE_FUNCTION:
+			cost = COST_CALL_FUNCTION;
+			params = sttype_function_params(node);
+			while (params) {
+				cost += entity_cost((stnode_t *)params->data);
+				params = params->next;
+			}
+			return cost;
+
+		default:
+			/* Constants are loaded once, when the filter is
+			 * compiled, so they cost nothing per packet. */
+			return 0;
+	}
+}
+
+static int
+test_cost(stnode_t *node)
+{
+	test_op_t	op;
+	stnode_t	*arg1, *arg2;
+
+	sttype_test_get(node, &op, &arg1, &arg2);
+
+	switch (op) {
+		case TEST_OP_EXISTS:
+			return COST_CHECK_EXISTS;
+
+		case TEST_OP_NOT:
+			return test_cost(arg1) + 1;
+
+		case TEST_OP_AND:
+		case TEST_OP_OR:
+			return test_cost(arg1) + test_cost(arg2);
+
+		case TEST_OP_CONTAINS:
+			return entity_cost(arg1) + entity_cost(arg2) + COST_CONTAINS;
+
+		case TEST_OP_MATCHES:
+			return entity_cost(arg1) + entity_cost(arg2) + COST_MATCHES;
+
+		default:
+			return entity_cost(arg1) + entity_cost(arg2) + COST_COMPARE;
+	}
+}
+
+/* Are two (sub)trees certain to give the same result? FALSE
+ * doesn't mean they don't, just that we can't tell. */
+static gboolean
+node_equal(stnode_t *a, stnode_t *b)
+{
+	test_op_t	op_a, op_b;
+	stnode_t	*a1, *a2, *b1, *b2;
+	fvalue_t	*fv_a, *fv_b;
+	ftenum_t	ftype;
+	GSList		*params_a, *params_b;
+
+	if (a == NULL || b == NULL) {
+		return a == b;
+	}
+	if (stnode_type_id(a) != stnode_type_id(b)) {
+		return FALSE;
+	}
+
+	switch (stnode_type_id(a)) {
+		case STTYPE_TEST:
+			sttype_test_get(a, &op_a, &a1, &a2);
+			sttype_test_get(b, &op_b, &b1, &b2);
+			return op_a == op_b && node_equal(a1, b1) &&
+				node_equal(a2, b2);
+
+		case STTYPE_FIELD:
+			return stnode_data(a) == stnode_data(b);
+
+		case STTYPE_FVALUE:
+			fv_a = (fvalue_t *)stnode_data(a);
+			fv_b = (fvalue_t *)stnode_data(b);
+			ftype = fvalue_type_ftenum(fv_a);
+			return ftype == fvalue_type_ftenum(fv_b) &&
+				ftype_can_eq(ftype) && fvalue_eq(fv_a, fv_b);
+
+		case STTYPE_RANGE:
+			return node_equal(sttype_range_entity(a),
+					sttype_range_entity(b)) &&
+				drange_equal(sttype_range_drange(a),
+					sttype_range_drange(b));
+
+		case STTYPE_FUNCTION:
+			if (sttype_function_funcdef(a) != sttype_function_funcdef(b)) {
+				return FALSE;
+			}
+			params_a = sttype_function_params(a);
+			params_b = sttype_function_params(b);
+			while (params_a && params_b) {
+				if (!node_equal((stnode_t *)params_a->data,
+						(stnode_t *)params_b->data)) {
+					return FALSE;
+				}
+				params_a = params_a->next;
+				params_b = params_b->next;
+			}
+			return params_a == NULL && params_b == NULL;
+
+		default:
+			return FALSE;
+	}
+}
+
+/* Take apart a chain of tests joined by the same "and" or "or"
+ * operator, so that "a and (b and c) and d" gives the operands a, b,
+ * c and d (each one optimized in turn) and the three nodes that
+ * joined them. */
+static void
+collect_chain(stnode_t *node, test_op_t chain_op, GPtrArray *operands,
+		GPtrArray *joins)
+{
+	test_op_t	op;
+	stnode_t	*arg1, *arg2;
+
+	sttype_test_get(node, &op, &arg1, &arg2);
+	if (op == chain_op) {
+		sttype_test_set2_args(node, NULL, NULL);
+		g_ptr_array_add(joins, node);
+		collect_chain(arg1, chain_op, operands, joins);
+		collect_chain(arg2, chain_op, operands, joins);
+	}
+	else {
+		g_ptr_array_add(operands, optimize_test(node));
+	}
+}
+
+static stnode_t *
+optimize_chain(stnode_t *node, test_op_t chain_op)
+{
+	GPtrArray	*operands, *joins;
+	stnode_t	*result, *join;
+	gpointer	tmp_node;
+	int		*costs, tmp_cost;
+	guint		i, j;
+
+	operands = g_ptr_array_new();
+	joins = g_ptr_array_new();
+	collect_chain(node, chain_op, operands, joins);
+
+	/* "a and a" is just "a", and so is "a or a". */
+	for (i = 0; i < operands->len; i++) {
+		j = i + 1;
+		while (j < operands->len) {
+			if (node_equal((stnode_t *)g_ptr_array_index(operands, i),
+					(stnode_t *)g_ptr_array_index(operands, j))) {
+				stnode_free((stnode_t *)g_ptr_array_index(operands, j));
+				g_ptr_array_remove_index(operands, j);
+			}
+			else {
+				j++;
+			}
+		}
+	}
+
+	/* Put the cheapest operands first, so that the expensive ones
+	 * only run when the cheap ones couldn't decide the result. The
+	 * sort is stable; operands of equal cost stay in the order the
+	 * user wrote them. */
+	costs = g_new(int, operands->len);
+	for (i = 0; i < operands->len; i++) {
+		costs[i] = test_cost((stnode_t *)g_ptr_array_index(operands, i));
+	}
+	for (i = 1; i < operands->len; i++) {
+		for (j = i; j > 0 && costs[j - 1] > costs[j]; j--) {
+			tmp_cost = costs[j];
+			costs[j] = costs[j - 1];
+			costs[j - 1] = tmp_cost;
+			tmp_node = operands->pdata[j];
+			operands->pdata[j] = operands->pdata[j - 1];
+			operands->pdata[j - 1] = tmp_node;
+		}
+	}
+	g_free(costs);
+
+	/* Join the operands back together, left to right. */
+	result = (stnode_t *)g_ptr_array_index(operands, 0);
+	for (i = 1; i < operands->len; i++) {
+		join = (stnode_t *)g_ptr_array_index(joins, i - 1);
+		sttype_test_set2_args(join, result,
+				(stnode_t *)g_ptr_array_index(operands, i));
+		result = join;
+	}
+
+	/* Any joins left over are for operands dropped as duplicates. */
+	for (i = operands->len - 1; i < joins->len; i++) {
+		stnode_free((stnode_t *)g_ptr_array_index(joins, i));
+	}
+
+	g_ptr_array_free(operands, TRUE);
+	g_ptr_array_free(joins, TRUE);
+	return result;
+}
+
+static stnode_t *
+optimize_test(stnode_t *node)
+{
+	test_op_t	op, op1;
+	stnode_t	*arg1, *inner;
+
+	sttype_test_get(node, &op, &arg1, NULL);
+
+	switch (op) {
+		case TEST_OP_NOT:
+			arg1 = optimize_test(arg1);
+			sttype_test_get(arg1, &op1, &inner, NULL);
+			if (op1 == TEST_OP_NOT) {
+				/* "not not a" is just "a" */
+				sttype_test_set2_args(arg1, NULL, NULL);
+				sttype_test_set2_args(node, NULL, NULL);
+				stnode_free(arg1);
+				stnode_free(node);
+				return inner;
+			}
+			sttype_test_set2_args(node, arg1, NULL);
+			return node;
+
+		case TEST_OP_AND:
+		case TEST_OP_OR:
+			return optimize_chain(node, op);
+
+		default:
+			return node;
+	}
+}
+
+void
+dfw_optimize(dfwork_t *dfw)
+{
+	dfw->st_root = optimize_test(dfw->st_root);
+}
@@ -0,0 +1,527 @@
+/*
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 2001 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "dfilter-int.h"
+#include "prefilter.h"
+#include "syntax-tree.h"
+#include "sttype-range.h"
+#include "sttype-test.h"
+#include "ftypes/ftypes.h"
+
+#include <epan/field_store.h>
+
+/*
+ * A few fields have values that are known before a packet is
+ * dissected: the frame number and lengths, and slices of the raw
+ * frame ("frame[12:2]"). Each relation on one of those fields and a
+ * constant can be evaluated directly; everything else in the filter is
+ * unknown until dissection. Evaluating the filter with that three-valued
+ * logic tells us when a packet can't possibly pass, so the caller can
+ * skip dissecting it.
+ *
+ * Fields further up the stack, such as ip.src or tcp.port, can't be
+ * found in the raw data: tunnels and encapsulations mean they can turn
+ * up at offsets that no fixed header layout predicts, and "ip.src == x"
+ * is true if any IP header in the packet has that source.  Relations on
+ * them are kept anyway, as they can be decided for packets whose value
+ * of the field was recorded in a field store the first time round, and
+ * equality tests on a field with a frame index (such as tcp.stream) can
+ * be decided for any packet that has been dissected before.
+ */
+
+typedef enum {
+	PF_AND,
+	PF_OR,
+	PF_NOT,
+	PF_FRAME_NUMBER,
+	PF_FRAME_LEN,
+	PF_FRAME_CAP_LEN,
+	PF_FRAME_BYTES,
+	PF_FIELD
+} pf_type_t;
+
+struct _prefilter_node {
+	pf_type_t	type;
+	test_op_t	op;		/* field on the left */
+	guint32		value;		/* PF_FRAME_NUMBER/LEN/CAP_LEN */
+	guint32		offset;		/* PF_FRAME_BYTES */
+	guint32		length;		/* PF_FRAME_BYTES */
+	GByteArray	*bytes;		/* PF_FRAME_BYTES */
+	int		hfid;		/* PF_FIELD */
+	guint64		value64;	/* PF_FIELD */
+	guint64		mask;		/* PF_FIELD */
+	gboolean	is_signed;	/* PF_FIELD */
+	prefilter_node	*left;		/* NULL means "unknown" */
+	prefilter_node	*right;
+};
+
+/* What we know about the packet being tested */
+typedef struct {
+	guint32		frame_num;
+	guint32		len;
+	guint32		caplen;
+	const guint8	*data;		/* or NULL */
+	const field_store_t *fs;	/* or NULL */
+	gboolean	dissected;	/* frame indexes cover it */
+} pf_packet_t;
+
+typedef enum {
+	PF_RESULT_FALSE,
+	PF_RESULT_TRUE,
+	PF_RESULT_UNKNOWN
+} pf_result_t;
+
+static prefilter_node *
+pf_node_new(pf_type_t type)
+{
+	prefilter_node	*pf = g_new0(prefilter_node, 1);
+
+	pf->type = type;
+	return pf;
+}
+
+static gboolean
+is_field(stnode_t *node, const char *abbrev)
+{
+	header_field_info	*hfinfo;
+
+	if (stnode_type_id(node) != STTYPE_FIELD) {
+		return FALSE;
+	}
+	hfinfo = (header_field_info *)stnode_data(node);
+	return strcmp(hfinfo->abbrev, abbrev) == 0 &&
+		hfinfo->same_name_next == NULL &&
+		hfinfo->same_name_prev_id == -1;
+}
+
+/* Swap the operands of a relation */
+static test_op_t
+mirror_op(test_op_t op)
+{
+	switch (op) {
+		case TEST_OP_GT:
+			return TEST_OP_LT;
+		case TEST_OP_GE:
+			return TEST_OP_LE;
+		case TEST_OP_LT:
+			return TEST_OP_GT;
+		case TEST_OP_LE:
+			return TEST_OP_GE;
+		default:
+			return op;
+	}
+}
+
+/* A relation between a field that a field store can hold and a constant */
+static prefilter_node *
+pf_build_field_relation(test_op_t op, stnode_t *st_field, fvalue_t *fv)
+{
+	header_field_info	*hfinfo;
+	prefilter_node		*pf;
+	guint64			value;
+
+	hfinfo = (header_field_info *)stnode_data(st_field);
+	if (hfinfo->same_name_next != NULL || hfinfo->same_name_prev_id != -1 ||
+	    fvalue_type_ftenum(fv) != hfinfo->type ||
+	    !field_store_value(fv, &value)) {
+		return NULL;
+	}
+
+	pf = pf_node_new(PF_FIELD);
+	pf->op = op;
+	pf->hfid = hfinfo->id;
+	pf->value64 = value;
+	pf->mask = G_GUINT64_CONSTANT(0xffffffffffffffff);
+	pf->is_signed = field_store_type_is_signed(hfinfo->type);
+	if (hfinfo->type == FT_IPv4) {
+		/* "ip.src == 10.0.0.0/8" tests the masked address; only
+		 * equality makes sense for that. */
+		if (op != TEST_OP_EQ && op != TEST_OP_NE &&
+		    fv->value.ipv4.nmask != 0xffffffff) {
+			prefilter_free(pf);
+			return NULL;
+		}
+		pf->mask = fv->value.ipv4.nmask;
+		pf->value64 &= pf->mask;
+	}
+	return pf;
+}
+
+static prefilter_node *
+pf_build_relation(test_op_t op, stnode_t *st_arg1, stnode_t *st_arg2)
+{
+	prefilter_node	*pf;
+	stnode_t	*st_entity, *st_fvalue;
+	fvalue_t	*fv;
+	drange_t	*drange;
+	drange_node	*rn;
+	pf_type_t	type;
+
+	if (stnode_type_id(st_arg2) == STTYPE_FVALUE) {
+		st_entity = st_arg1;
+		st_fvalue = st_arg2;
+	}
+	else if (stnode_type_id(st_arg1) == STTYPE_FVALUE) {
+		st_entity = st_arg2;
+		st_fvalue = st_arg1;
+		op = mirror_op(op);
+	}
+	else {
+		return NULL;
+	}
+	fv = (fvalue_t *)stnode_data(st_fvalue);
+
+	if (stnode_type_id(st_entity) == STTYPE_RANGE) {
+		/* A single slice at a fixed offset from the start */
+		if ((op != TEST_OP_EQ && op != TEST_OP_NE) ||
+		    !is_field(sttype_range_entity(st_entity), "frame") ||
+		    fvalue_type_ftenum(fv) != FT_BYTES) {
+			return NULL;
+		}
+		drange = sttype_range_drange(st_entity);
+		if (g_slist_length(drange->range_list) != 1) {
+			return NULL;
+		}
+		rn = (drange_node *)drange->range_list->data;
+		if (rn->ending != DRANGE_NODE_END_T_LENGTH ||
+		    rn->start_offset < 0 || rn->length <= 0) {
+			return NULL;
+		}
+
+		pf = pf_node_new(PF_FRAME_BYTES);
+		pf->op = op;
+		pf->offset = rn->start_offset;
+		pf->length = rn->length;
+		pf->bytes = g_byte_array_new();
+		g_byte_array_append(pf->bytes, fv->value.bytes->data,
+		    fv->value.bytes->len);
+		return pf;
+	}
+
+	if (stnode_type_id(st_entity) != STTYPE_FIELD) {
+		return NULL;
+	}
+
+	if (is_field(st_entity, "frame.number")) {
+		type = PF_FRAME_NUMBER;
+	}
+	else if (is_field(st_entity, "frame.len")) {
+		type = PF_FRAME_LEN;
+	}
+	else if (is_field(st_entity, "frame.cap_len")) {
+		type = PF_FRAME_CAP_LEN;
+	}
+	else {
+		return pf_build_field_relation(op, st_entity, fv);
+	}
+	switch (op) {
+		case TEST_OP_EQ:
+		case TEST_OP_NE:
+		case TEST_OP_GT:
+		case TEST_OP_GE:
+		case TEST_OP_LT:
+		case TEST_OP_LE:
+			break;
+		default:
+			return NULL;
+	}
+
+	pf = pf_node_new(type);
+	pf->op = op;
+	pf->value = fvalue_get_uinteger(fv);
+	return pf;
+}
+
+static prefilter_node *
+pf_build(stnode_t *st_node)
+{
+	test_op_t	st_op;
+	stnode_t	*st_arg1, *st_arg2;
+	prefilter_node	*pf, *left, *right;
+	header_field_info *hfinfo;
+
+	sttype_test_get(st_node, &st_op, &st_arg1, &st_arg2);
+
+	switch (st_op) {
+		case TEST_OP_AND:
+		case TEST_OP_OR:
+			left = pf_build(st_arg1);
+			right = pf_build(st_arg2);
+			if (left == NULL && right == NULL) {
+				return NULL;
+			}
+			pf = pf_node_new(st_op == TEST_OP_AND ? PF_AND : PF_OR);
+			pf->left = left;
+			pf->right = right;
+			return pf;
+
+		case TEST_OP_NOT:
+			left = pf_build(st_arg1);
+			if (left == NULL) {
+				return NULL;
+			}
+			pf = pf_node_new(PF_NOT);
+			pf->left = left;
+			return pf;
+
+		case TEST_OP_EXISTS:
+			if (stnode_type_id(st_arg1) != STTYPE_FIELD) {
+				return NULL;
+			}
+			hfinfo = (header_field_info *)stnode_data(st_arg1);
+			if (hfinfo->same_name_next != NULL ||
+			    hfinfo->same_name_prev_id != -1) {
+				return NULL;
+			}
+			pf = pf_node_new(PF_FIELD);
+			pf->op = TEST_OP_EXISTS;
+			pf->hfid = hfinfo->id;
+			return pf;
+
+		case TEST_OP_EQ:
+		case TEST_OP_NE:
+		case TEST_OP_GT:
+		case TEST_OP_GE:
+		case TEST_OP_LT:
+		case TEST_OP_LE:
+			return pf_build_relation(st_op, st_arg1, st_arg2);
+
+		default:
+			return NULL;
+	}
+}
+
+prefilter_node *
+dfw_prefilter(dfwork_t *dfw)
+{
+	return pf_build(dfw->st_root);
+}
+
+static pf_result_t
+pf_result(gboolean b)
+{
+	return b ? PF_RESULT_TRUE : PF_RESULT_FALSE;
+}
+
+static pf_result_t
+pf_compare(test_op_t op, guint32 a, guint32 b)
+{
+	switch (op) {
+		case TEST_OP_EQ:
+			return pf_result(a == b);
+		case TEST_OP_NE:
+			return pf_result(a != b);
+		case TEST_OP_GT:
+			return pf_result(a > b);
+		case TEST_OP_GE:
+			return pf_result(a >= b);
+		case TEST_OP_LT:
+			return pf_result(a < b);
+		case TEST_OP_LE:
+			return pf_result(a <= b);
+		default:
+			g_assert_not_reached();
+			return PF_RESULT_UNKNOWN;
+	}
+}
+
+static pf_result_t
+pf_compare64(test_op_t op, gboolean is_signed, guint64 a, guint64 b)
+{
+	int	cmp;
+
+	if (is_signed) {
+		cmp = (gint64)a < (gint64)b ? -1 : (gint64)a > (gint64)b;
+	}
+	else {
+		cmp = a < b ? -1 : a > b;
+	}
+	switch (op) {
+		case TEST_OP_EQ:
+			return pf_result(cmp == 0);
+		case TEST_OP_NE:
+			return pf_result(cmp != 0);
+		case TEST_OP_GT:
+			return pf_result(cmp > 0);
+		case TEST_OP_GE:
+			return pf_result(cmp >= 0);
+		case TEST_OP_LT:
+			return pf_result(cmp < 0);
+		case TEST_OP_LE:
+			return pf_result(cmp <= 0);
+		default:
+			g_assert_not_reached();
+			return PF_RESULT_UNKNOWN;
+	}
+}
+
+static pf_result_t
+pf_eval_field(const prefilter_node *pf, const pf_packet_t *pkt)
+{
+	guint64	value;
+	const field_frame_index_t *ffi;
+
+	if (pkt->dissected && pf->op == TEST_OP_EQ &&
+	    pf->value64 <= G_MAXUINT32 &&
+	    (ffi = field_frame_index_find(pf->hfid)) != NULL) {
+		return pf_result(field_frame_index_has(ffi,
+		    (guint32)pf->value64, pkt->frame_num));
+	}
+	if (pkt->fs == NULL) {
+		return PF_RESULT_UNKNOWN;
+	}
+	switch (field_store_get(pkt->fs, pf->hfid, pkt->frame_num, &value)) {
+		case FIELD_STORE_PRESENT:
+			if (pf->op == TEST_OP_EXISTS) {
+				return PF_RESULT_TRUE;
+			}
+			return pf_compare64(pf->op, pf->is_signed,
+			    value & pf->mask, pf->value64);
+		default:
+			/* A field that wasn't there the first time round
+			 * can still turn up later, e.g. in data reassembled
+			 * from frames that hadn't been seen yet, so leave
+			 * the frame to the real filter. */
+			return PF_RESULT_UNKNOWN;
+	}
+}
+
+static pf_result_t
+pf_eval(const prefilter_node *pf, const pf_packet_t *pkt)
+{
+	pf_result_t	left, right;
+	gboolean	equal;
+
+	if (pf == NULL) {
+		return PF_RESULT_UNKNOWN;
+	}
+
+	switch (pf->type) {
+		case PF_AND:
+			left = pf_eval(pf->left, pkt);
+			if (left == PF_RESULT_FALSE) {
+				return PF_RESULT_FALSE;
+			}
+			right = pf_eval(pf->right, pkt);
+			if (right == PF_RESULT_FALSE) {
+				return PF_RESULT_FALSE;
+			}
+			if (left == PF_RESULT_TRUE && right == PF_RESULT_TRUE) {
+				return PF_RESULT_TRUE;
+			}
+			return PF_RESULT_UNKNOWN;
+
+		case PF_OR:
+			left = pf_eval(pf->left, pkt);
+			if (left == PF_RESULT_TRUE) {
+				return PF_RESULT_TRUE;
+			}
+			right = pf_eval(pf->right, pkt);
+			if (right == PF_RESULT_TRUE) {
+				return PF_RESULT_TRUE;
+			}
+			if (left == PF_RESULT_FALSE && right == PF_RESULT_FALSE) {
+				return PF_RESULT_FALSE;
+			}
+			return PF_RESULT_UNKNOWN;
+
+		case PF_NOT:
+			left = pf_eval(pf->left, pkt);
+			if (left == PF_RESULT_UNKNOWN) {
+				return PF_RESULT_UNKNOWN;
+			}
+			return pf_result(left == PF_RESULT_FALSE);
+
+		case PF_FRAME_NUMBER:
+			return pf_compare(pf->op, pkt->frame_num, pf->value);
+
+		case PF_FRAME_LEN:
+			return pf_compare(pf->op, pkt->len, pf->value);
+
+		case PF_FRAME_CAP_LEN:
+			return pf_compare(pf->op, pkt->caplen, pf->value);
+
+		case PF_FRAME_BYTES:
+			if (pkt->data == NULL || pf->offset > pkt->caplen ||
+			    pf->length > pkt->caplen - pf->offset) {
+				/* Leave slices past the end of the
+				 * captured data to the real filter. */
+				return PF_RESULT_UNKNOWN;
+			}
+			equal = pf->length == pf->bytes->len &&
+				memcmp(pkt->data + pf->offset, pf->bytes->data,
+				    pf->length) == 0;
+			return pf_result(pf->op == TEST_OP_EQ ? equal : !equal);
+
+		case PF_FIELD:
+			return pf_eval_field(pf, pkt);
+	}
+
+	g_assert_not_reached();
+	return PF_RESULT_UNKNOWN;
+}
+
+gboolean
+prefilter_apply(const prefilter_node *pf, guint32 frame_num, guint32 len,
+		guint32 caplen, const guint8 *data)
+{
+	pf_packet_t	pkt;
+
+	pkt.frame_num = frame_num;
+	pkt.len = len;
+	pkt.caplen = caplen;
+	pkt.data = data;
+	pkt.fs = NULL;
+	pkt.dissected = FALSE;
+	return pf_eval(pf, &pkt) != PF_RESULT_FALSE;
+}
+
+gboolean
+prefilter_apply_stored(const prefilter_node *pf, const field_store_t *fs,
+		guint32 frame_num, guint32 len, guint32 caplen)
+{
+	pf_packet_t	pkt;
+
+	pkt.frame_num = frame_num;
+	pkt.len = len;
+	pkt.caplen = caplen;
+	pkt.data = NULL;
+	pkt.fs = fs;
+	pkt.dissected = TRUE;
+	return pf_eval(pf, &pkt) != PF_RESULT_FALSE;
+}
+
+void
+prefilter_free(prefilter_node *pf)
+{
+	if (pf == NULL) {
+		return;
+	}
+	prefilter_free(pf->left);
+	prefilter_free(pf->right);
+	if (pf->bytes) {
+		g_byte_array_free(pf->bytes, TRUE);
+	}
+	g_free(pf);
+}
@@ -0,0 +1,50 @@
+/*
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 2001 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef PREFILTER_H
+#define PREFILTER_H
+
+#include <epan/field_store.h>
+
+/* Build the part of a filter that can be decided from the frame number,
+ * the lengths and the raw bytes of a packet, or from the field values
+ * recorded in a field store, without dissecting it.
+ * Must be called after semcheck and before gencode. Returns NULL if no
+ * part of the filter can be decided that way. */
+prefilter_node *
+dfw_prefilter(dfwork_t *dfw);
+
+/* FALSE if a packet certainly doesn't match the filter that pf was
+ * built from; TRUE if it might. */
+gboolean
+prefilter_apply(const prefilter_node *pf, guint32 frame_num,
+		guint32 len, guint32 caplen, const guint8 *data);
+
+/* The same, for a packet that has been dissected before, deciding
+ * relations on fields from the values recorded in a field store (or
+ * NULL) and from frame indexes instead of from the raw packet data. */
+gboolean
+prefilter_apply_stored(const prefilter_node *pf, const field_store_t *fs,
+		guint32 frame_num, guint32 len, guint32 caplen);
+
+void
+prefilter_free(prefilter_node *pf);
+
+#endif
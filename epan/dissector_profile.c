@@ -0,0 +1,196 @@
+/* dissector_profile.c
+ * Timing dissectors per protocol
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include <wsutil/time_util.h>
+
+#include "dissector_profile.h"
+
+/*
+ * One frame per dissector call in progress.  Calls nested deeper than
+ * this aren't timed on their own; their time goes to the deepest frame.
+ */
+#define PROFILE_MAX_DEPTH	128
+
+typedef struct {
+	dissector_profile_t *profile;
+	guint64              start_ns;
+	guint64              child_ns;	/* spent in the calls this one made */
+	gboolean             outermost;	/* the protocol isn't further down */
+} profile_frame_t;
+
+static gboolean        profiling = FALSE;
+static GHashTable     *profiles = NULL;	/* proto_id -> dissector_profile_t */
+static profile_frame_t profile_stack[PROFILE_MAX_DEPTH];
+static int             profile_depth = 0;
+
+void
+set_dissector_profiling(gboolean enable)
+{
+	if (enable && profiles == NULL)
+		profiles = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+
+	if (!enable)
+		dissector_profile_unwind();
+
+	profiling = enable;
+}
+
+gboolean
+dissector_profiling_is_active(void)
+{
+	return profiling;
+}
+
+void
+dissector_profile_reset(void)
+{
+	profile_depth = 0;
+	if (profiles != NULL)
+		g_hash_table_remove_all(profiles);
+}
+
+typedef struct {
+	dissector_profile_func func;
+	void                  *user_data;
+} profile_foreach_t;
+
+static void
+profile_foreach_func(gpointer key _U_, gpointer value, gpointer user_data)
+{
+	profile_foreach_t *info = (profile_foreach_t *)user_data;
+
+	info->func((const dissector_profile_t *)value, info->user_data);
+}
+
+void
+dissector_profile_foreach(dissector_profile_func func, void *user_data)
+{
+	profile_foreach_t info;
+
+	if (profiles == NULL)
+		return;
+
+	info.func = func;
+	info.user_data = user_data;
+	g_hash_table_foreach(profiles, profile_foreach_func, &info);
+}
+
+/*
+ * Start timing a call of one of proto_id's dissectors.  Returns the
+ * frame to hand to dissector_profile_leave(), or -1 if the call isn't
+ * timed on its own.
+ */
+int
+dissector_profile_enter(int proto_id)
+{
+	dissector_profile_t *profile;
+	profile_frame_t     *frame;
+	int                  i;
+
+	profile = (dissector_profile_t *)g_hash_table_lookup(profiles, GINT_TO_POINTER(proto_id));
+	if (profile == NULL) {
+		profile = g_new0(dissector_profile_t, 1);
+		profile->proto_id = proto_id;
+		g_hash_table_insert(profiles, GINT_TO_POINTER(proto_id), profile);
+	}
+	profile->calls++;
+
+	if (profile_depth == PROFILE_MAX_DEPTH)
+		return -1;
+
+	frame = &profile_stack[profile_depth];
+	frame->profile = profile;
+	frame->child_ns = 0;
+	frame->outermost = TRUE;
+	for (i = 0; i < profile_depth; i++) {
+		if (profile_stack[i].profile == profile) {
+			frame->outermost = FALSE;
+			break;
+		}
+	}
+	frame->start_ns = monotonic_time_ns();
+
+	return profile_depth++;
+}
+
+/* Charge the innermost frame with the time up to now and drop it */
+static void
+profile_pop(guint64 now)
+{
+	profile_frame_t *frame = &profile_stack[--profile_depth];
+	guint64          elapsed = now - frame->start_ns;
+
+	frame->profile->self_ns += elapsed > frame->child_ns ? elapsed - frame->child_ns : 0;
+	if (frame->outermost)
+		frame->profile->total_ns += elapsed;
+	if (profile_depth > 0)
+		profile_stack[profile_depth - 1].child_ns += elapsed;
+}
+
+void
+dissector_profile_leave(int frame, gboolean rejected)
+{
+	guint64 now;
+
+	if (frame < 0 || frame >= profile_depth)
+		return;
+
+	/* Frames above this one were left by an exception */
+	now = monotonic_time_ns();
+	while (profile_depth > frame)
+		profile_pop(now);
+
+	if (rejected)
+		profile_stack[frame].profile->rejected++;
+}
+
+/* Close every frame, e.g. after an exception got out of the top-level
+ * dissector */
+void
+dissector_profile_unwind(void)
+{
+	guint64 now;
+
+	if (profile_depth == 0)
+		return;
+
+	now = monotonic_time_ns();
+	while (profile_depth > 0)
+		profile_pop(now);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -0,0 +1,94 @@
+/* dissector_profile.h
+ * Definitions for timing dissectors per protocol
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __DISSECTOR_PROFILE_H__
+#define __DISSECTOR_PROFILE_H__
+
+#include <glib.h>
+
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @file
+ * Dissector profiling: how often the dissectors of each protocol were
+ * called, and how long they took.  Calls through dissector handles and
+ * tries of heuristic dissectors are both counted.
+ *
+ * "Self" time is the time spent in a protocol's own dissectors, not
+ * counting the dissectors they called; it adds up to the total time
+ * spent dissecting.  "Total" time includes the dissectors called, once
+ * per outermost call when a protocol is nested in itself.
+ *
+ * When a dissector throws an exception, the dissectors the exception
+ * passes through are charged up to the time the dissector that catches
+ * it returns.
+ */
+
+typedef struct _dissector_profile_t {
+	int     proto_id;
+	guint64 calls;     /**< Calls of the protocol's dissectors */
+	guint64 rejected;  /**< Calls in which the dissector rejected the data */
+	guint64 self_ns;   /**< Nanoseconds in the protocol's own code */
+	guint64 total_ns;  /**< Nanoseconds including the dissectors it called */
+} dissector_profile_t;
+
+typedef void (*dissector_profile_func)(const dissector_profile_t *profile, void *user_data);
+
+/** Start or stop timing dissectors.  The counts so far are kept. */
+WS_DLL_PUBLIC void set_dissector_profiling(gboolean enable);
+
+/** Are dissectors being timed? */
+WS_DLL_PUBLIC gboolean dissector_profiling_is_active(void);
+
+/** Forget the counts so far.  init_dissection() does this as well. */
+WS_DLL_PUBLIC void dissector_profile_reset(void);
+
+/** Call func for each protocol that has been called since the last
+ * reset, in no particular order. */
+WS_DLL_PUBLIC void dissector_profile_foreach(dissector_profile_func func, void *user_data);
+
+/* For internal use by packet.c */
+extern int dissector_profile_enter(int proto_id);
+extern void dissector_profile_leave(int frame, gboolean rejected);
+extern void dissector_profile_unwind(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __DISSECTOR_PROFILE_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -150,9 +150,9 @@ dissect_file_record(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree,
 			proto_tree_set_visible(fh_tree, old_visible);
 		}
 
-		if(pinfo->fd->pfd != 0){
+		if(proto_data_vec_count(pinfo->fd->pfd) != 0){
 			proto_item *ppd_item;
-			guint num_entries = g_slist_length(pinfo->fd->pfd);
+			guint num_entries = proto_data_vec_count(pinfo->fd->pfd);
 			guint i;
 			ppd_item = proto_tree_add_uint(fh_tree, hf_file_num_p_prot_data, tvb, 0, 0, num_entries);
 			PROTO_ITEM_SET_GENERATED(ppd_item);
@@ -123,8 +123,13 @@ typedef struct _diam_vnd_t {
 	GArray *vs_avps;
 	value_string_ext *vs_avps_ext;
 	GArray *vs_cmds;
+	GPtrArray *avps_by_code;	/* the vendor's AVPs, indexed by code */
 } diam_vnd_t;
 
+/* AVPs with codes below this are also found through their vendor's
+ * avps_by_code, rather than only through dictionary.avps */
+#define DIAM_AVP_INDEX_MAX	65536
+
 struct _diam_avp_t {
 	guint32 code;
 	diam_vnd_t *vendor;
@@ -188,11 +193,12 @@ typedef struct _proto_avp_t {
 
 static const char *simple_avp(diam_ctx_t *, diam_avp_t *, tvbuff_t *, diam_sub_dis_t *);
 
-static diam_vnd_t unknown_vendor = { 0xffffffff, NULL, NULL, NULL };
-static diam_vnd_t no_vnd = { 0, NULL, NULL, NULL };
+static diam_vnd_t unknown_vendor = { 0xffffffff, NULL, NULL, NULL, NULL };
+static diam_vnd_t no_vnd = { 0, NULL, NULL, NULL, NULL };
 static diam_avp_t unknown_avp = {0, &unknown_vendor, simple_avp, simple_avp, -1, -1, NULL };
 static GArray *all_cmds;
 static diam_dictionary_t dictionary = { NULL, NULL, NULL, NULL };
+static diam_vnd_t *last_vendor = NULL;	/* last vendor looked up by dissect_diameter_avp() */
 static struct _build_dict build_dict;
 static const value_string *vnd_short_vs;
 static dissector_handle_t data_handle;
@@ -582,7 +588,24 @@ dissect_diameter_avp(diam_ctx_t *c, tvbuff_t *tvb, int offset, diam_sub_dis_t *d
 	k[2].length = 0;
 	k[2].key = NULL;
 
-	a = (diam_avp_t *)wmem_tree_lookup32_array(dictionary.avps,k);
+	/*
+	 * Most AVPs are found with their vendor (the last one seen, or no
+	 * vendor at all, most of the time) and an index into its table; the
+	 * tree only has to be searched for the rest.
+	 */
+	a = NULL;
+	vendor = NULL;
+	if (vendorid == 0) {
+		vendor = &no_vnd;
+	} else if (last_vendor != NULL && last_vendor->code == vendorid) {
+		vendor = last_vendor;
+	} else if ((vendor = (diam_vnd_t *)wmem_tree_lookup32(dictionary.vnds,vendorid)) != NULL) {
+		last_vendor = vendor;
+	}
+	if (vendor != NULL && vendor->avps_by_code != NULL && code < vendor->avps_by_code->len)
+		a = (diam_avp_t *)g_ptr_array_index(vendor->avps_by_code, code);
+	if (!a)
+		a = (diam_avp_t *)wmem_tree_lookup32_array(dictionary.avps,k);
 
 	len &= 0x00ffffff;
 	pad_len =  (len % 4) ? 4 - (len % 4) : 0 ;
@@ -590,12 +613,9 @@ dissect_diameter_avp(diam_ctx_t *c, tvbuff_t *tvb, int offset, diam_sub_dis_t *d
 	if (!a) {
 		a = &unknown_avp;
 
-		if (vendor_flag) {
-			if (! (vendor = (diam_vnd_t *)wmem_tree_lookup32(dictionary.vnds,vendorid) ))
-				vendor = &unknown_vendor;
-		} else {
-			vendor = &no_vnd;
-		}
+		/* vendor was looked up above */
+		if (!vendor)
+			vendor = &unknown_vendor;
 	} else {
 		vendor = (diam_vnd_t *)a->vendor;
 	}
@@ -1079,6 +1099,8 @@ dissect_diameter_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, voi
 	nstime_t ns;
 	diam_sub_dis_t *diam_sub_dis_inf = wmem_new0(wmem_packet_scope(), diam_sub_dis_t);
 
+	/* Load the dictionary and register our fields, if not done yet */
+	DISSECTOR_ASSERT(proto_registrar_get_byname("diameter.code"));
 
 	diam_sub_dis_inf->application_id = tvb_get_ntohl(tvb,8);
 
@@ -1806,6 +1828,7 @@ dictionary_load(void)
 			vnd->vs_cmds = g_array_new(TRUE,TRUE,sizeof(value_string));
 			vnd->vs_avps = g_array_new(TRUE,TRUE,sizeof(value_string));
 			vnd->vs_avps_ext = NULL;
+			vnd->avps_by_code = NULL;
 			wmem_tree_insert32(dictionary.vnds,vnd->code,vnd);
 			g_hash_table_insert(vendors,v->name,vnd);
 		}
@@ -1917,6 +1940,14 @@ dictionary_load(void)
 
 				wmem_tree_insert32_array(dictionary.avps,k,avp);
 			}
+
+			if (vnd != &unknown_vendor && a->code < DIAM_AVP_INDEX_MAX) {
+				if (vnd->avps_by_code == NULL)
+					vnd->avps_by_code = g_ptr_array_new();
+				if (a->code >= vnd->avps_by_code->len)
+					g_ptr_array_set_size(vnd->avps_by_code, a->code + 1);
+				g_ptr_array_index(vnd->avps_by_code, a->code) = avp;
+			}
 		}
 	}
 	g_hash_table_destroy(build_dict.types);
@@ -1927,13 +1958,12 @@ dictionary_load(void)
 }
 
 /*
- * This does most of the registration work; see proto_register_diameter()
+ * This does the field registration work; see register_diameter_fields()
  * for the reason why we split it off.
  */
 static void
-real_proto_register_diameter(void)
+real_register_diameter_fields(void)
 {
-	module_t *diameter_module;
 	expert_module_t* expert_diameter;
 	guint i, ett_length;
 
@@ -2085,14 +2115,44 @@ real_proto_register_diameter(void)
 		g_ptr_array_add(build_dict.ett, ett_base[i]);
 	}
 
-	proto_diameter = proto_register_protocol ("Diameter Protocol", "DIAMETER", "diameter");
-
 	proto_register_field_array(proto_diameter, (hf_register_info *)wmem_array_get_raw(build_dict.hf), wmem_array_get_count(build_dict.hf));
 	proto_register_subtree_array((gint **)build_dict.ett->pdata, build_dict.ett->len);
 	expert_diameter = expert_register_protocol(proto_diameter);
 	expert_register_field_array(expert_diameter, ei, array_length(ei));
 
 	g_ptr_array_free(build_dict.ett,TRUE);
+}
+
+/*
+ * Loading the dictionary is the bulk of our startup time, so it's done,
+ * and the fields registered, only when a "diameter." field is first looked
+ * up, by a display filter or by the dissector itself.
+ */
+static void
+register_diameter_fields(const char* unused _U_)
+{
+	/*
+	 * The hf_base[] array for Diameter refers to a variable
+	 * that is set by dictionary_load(), so we need to call
+	 * dictionary_load() before hf_base[] is initialized.
+	 *
+	 * To ensure that, we call dictionary_load() and then
+	 * call a routine that defines hf_base[] and does all
+	 * the registration work.
+	 */
+	dictionary_load();
+	real_register_diameter_fields();
+}
+
+void
+proto_register_diameter(void)
+{
+	module_t *diameter_module;
+
+	proto_diameter = proto_register_protocol ("Diameter Protocol", "DIAMETER", "diameter");
+
+	/* The dictionary and the fields are loaded on first use */
+	proto_register_prefix("diameter", register_diameter_fields);
 
 	/* Allow dissector to find be found by name. */
 	new_register_dissector("diameter", dissect_diameter, proto_diameter);
@@ -2150,22 +2210,6 @@ real_proto_register_diameter(void)
 
 	/* Register tap */
 	diameter_tap = register_tap("diameter");
-}
-
-void
-proto_register_diameter(void)
-{
-	/*
-	 * The hf_base[] array for Diameter refers to a variable
-	 * that is set by dictionary_load(), so we need to call
-	 * dictionary_load() before hf_base[] is initialized.
-	 *
-	 * To ensure that, we call dictionary_load() and then
-	 * call a routine that defines hf_base[] and does all
-	 * the registration work.
-	 */
-	dictionary_load();
-	real_proto_register_diameter();
 } /* proto_register_diameter */
 
 void
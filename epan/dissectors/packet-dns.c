@@ -431,7 +431,7 @@ typedef struct _dns_transaction_t {
 
 /* Structure containing conversation specific information */
 typedef struct _dns_conv_info_t {
-  wmem_tree_t *pdus;
+  wmem_map_t *pdus;     /* latest request seen for each transaction ID */
 } dns_conv_info_t;
 
 /* DNS structs and definitions */
@@ -1088,6 +1088,82 @@ qname_labels_count(const guchar* name, guint name_len)
     return labels;
 }
 
+/*
+ * Names already expanded in the packet being dissected, by the message
+ * and the offset they start at, so that following a compression pointer
+ * to a name that's been seen before doesn't walk its labels (and any
+ * further pointers) again.  The map is in packet scope and forgotten
+ * when that's freed.
+ */
+typedef struct {
+  tvbuff_t *tvb;
+  int       dns_data_offset;
+  int       offset;
+} dns_name_cache_key_t;
+
+/* How many pointer targets within one name are remembered */
+#define DNS_NAME_CACHE_TARGETS 8
+
+static wmem_map_t *dns_name_cache = NULL;
+
+static guint
+dns_name_cache_hash(gconstpointer k)
+{
+  const dns_name_cache_key_t *key = (const dns_name_cache_key_t *)k;
+
+  return GPOINTER_TO_UINT(key->tvb) ^ ((guint)key->dns_data_offset << 16) ^
+         ((guint)key->offset * 2654435761U);
+}
+
+static gboolean
+dns_name_cache_equal(gconstpointer k1, gconstpointer k2)
+{
+  const dns_name_cache_key_t *key1 = (const dns_name_cache_key_t *)k1;
+  const dns_name_cache_key_t *key2 = (const dns_name_cache_key_t *)k2;
+
+  return key1->tvb == key2->tvb && key1->dns_data_offset == key2->dns_data_offset &&
+         key1->offset == key2->offset;
+}
+
+static gboolean
+dns_name_cache_forget(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_,
+    void *user_data _U_)
+{
+  dns_name_cache = NULL;
+  return FALSE;
+}
+
+static const guchar *
+dns_name_cache_lookup(tvbuff_t *tvb, int dns_data_offset, int offset)
+{
+  dns_name_cache_key_t key;
+
+  if (dns_name_cache == NULL) {
+    return NULL;
+  }
+  key.tvb             = tvb;
+  key.dns_data_offset = dns_data_offset;
+  key.offset          = offset;
+  return (const guchar *)wmem_map_lookup(dns_name_cache, &key);
+}
+
+static void
+dns_name_cache_add(tvbuff_t *tvb, int dns_data_offset, int offset, const guchar *name)
+{
+  dns_name_cache_key_t *key;
+
+  if (dns_name_cache == NULL) {
+    dns_name_cache = wmem_map_new(wmem_packet_scope(), dns_name_cache_hash,
+                                  dns_name_cache_equal);
+    wmem_register_callback(wmem_packet_scope(), dns_name_cache_forget, NULL);
+  }
+  key = wmem_new(wmem_packet_scope(), dns_name_cache_key_t);
+  key->tvb             = tvb;
+  key->dns_data_offset = dns_data_offset;
+  key->offset          = offset;
+  wmem_map_insert(dns_name_cache, key, (void *)name);
+}
+
 /* This function returns the number of bytes consumed and the expanded string
  * in *name.
  * The string is allocated with wmem_packet_scope scope and does not need to be freed.
@@ -1105,6 +1181,14 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
   int     component_len;
   int     indir_offset;
   int     maxname;
+  const guchar *cached;
+  int     targets[DNS_NAME_CACHE_TARGETS];     /* pointer targets followed */
+  guchar *target_names[DNS_NAME_CACHE_TARGETS]; /* where they start in *name */
+  int     num_targets     = 0;
+  int     i;
+  /* Names with bitstring labels, which aren't separated by a '.', and
+     names limited by max_len, which may stop short, aren't cached */
+  gboolean cacheable      = (max_len == 0);
 
   const int min_len = 1;        /* Minimum length of encoded name (for root) */
         /* If we're about to return a value (probably negative) which is less
@@ -1162,6 +1246,8 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
             int label_len;
             int print_len;
 
+            cacheable = FALSE;
+
             bit_count = tvb_get_guint8(tvb, offset);
             offset++;
             label_len = (bit_count - 1) / 8 + 1;
@@ -1246,12 +1332,46 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
           return len;
         }
 
+        if (cacheable) {
+          /* Have we expanded the name there already? */
+          cached = dns_name_cache_lookup(tvb, dns_data_offset, indir_offset);
+          if (cached != NULL) {
+            if (*cached != '\0' && np != *name && maxname > 0) {
+              *np++ = '.';
+              maxname--;
+            }
+            while (*cached != '\0' && maxname > 0) {
+              *np++ = *cached++;
+              maxname--;
+            }
+            goto name_done;
+          }
+          if (num_targets < DNS_NAME_CACHE_TARGETS) {
+            targets[num_targets]      = indir_offset;
+            target_names[num_targets] = np;
+            num_targets++;
+          }
+        }
+
         offset = indir_offset;
         break;   /* now continue processing from there */
     }
   }
 
+name_done:
   *np = '\0';
+
+  /* Remember the name, and the names at the pointer targets, unless the
+     name had to be cut short */
+  if (cacheable && maxname > 0) {
+    dns_name_cache_add(tvb, dns_data_offset, start_offset, *name);
+    for (i = 0; i < num_targets; i++) {
+      if (target_names[i] != *name && *target_names[i] == '.') {
+        target_names[i]++;
+      }
+      dns_name_cache_add(tvb, dns_data_offset, targets[i], target_names[i]);
+    }
+  }
   /* If "len" is negative, we haven't seen a pointer, and thus haven't
      set the length, so set it. */
   if (len < 0) {
@@ -3656,7 +3776,6 @@ dissect_dns_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
   conversation_t    *conversation;
   dns_conv_info_t   *dns_info;
   dns_transaction_t *dns_trans;
-  wmem_tree_key_t    key[3];
   struct DnsTap     *dns_stats;
   guint              qtype = 0;
   guint              qclass = 0;
@@ -3715,17 +3834,18 @@ dissect_dns_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
      * it to the list of information structures.
      */
     dns_info = wmem_new(wmem_file_scope(), dns_conv_info_t);
-    dns_info->pdus=wmem_tree_new(wmem_file_scope());
+    dns_info->pdus=wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
     conversation_add_proto_data(conversation, proto_dns, dns_info);
   }
 
-  key[0].length = 1;
-  key[0].key = &id;
-  key[1].length = 1;
-  key[1].key = &pinfo->fd->num;
-  key[2].length = 0;
-  key[2].key = NULL;
-
+  /*
+   * On the first pass, a response goes with the latest request with its
+   * ID in the conversation; a new request with an ID replaces the old
+   * one in the map, so it never holds more than one per ID.  Which
+   * transaction a message belongs to is remembered with the frame, by
+   * ID in case a TCP segment holds more than one message, for when it's
+   * dissected again.
+   */
   if (!pinfo->fd->flags.visited) {
     if (!(flags&F_RESPONSE)) {
       /* This is a request */
@@ -3734,22 +3854,18 @@ dissect_dns_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
       dns_trans->rep_frame=0;
       dns_trans->req_time=pinfo->fd->abs_ts;
       dns_trans->id = id;
-      wmem_tree_insert32_array(dns_info->pdus, key, (void *)dns_trans);
+      wmem_map_insert(dns_info->pdus, GUINT_TO_POINTER(id), (void *)dns_trans);
     } else {
-      dns_trans=(dns_transaction_t *)wmem_tree_lookup32_array_le(dns_info->pdus, key);
+      dns_trans=(dns_transaction_t *)wmem_map_lookup(dns_info->pdus, GUINT_TO_POINTER(id));
       if (dns_trans) {
-        if (dns_trans->id != id) {
-          dns_trans = NULL;
-        } else {
-          dns_trans->rep_frame=pinfo->fd->num;
-        }
+        dns_trans->rep_frame=pinfo->fd->num;
       }
     }
-  } else {
-    dns_trans=(dns_transaction_t *)wmem_tree_lookup32_array_le(dns_info->pdus, key);
-    if (dns_trans && dns_trans->id != id) {
-      dns_trans = NULL;
+    if (dns_trans) {
+      p_add_proto_data(wmem_file_scope(), pinfo, proto_dns, id, dns_trans);
     }
+  } else {
+    dns_trans=(dns_transaction_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_dns, id);
   }
   if (!dns_trans) {
     /* create a "fake" pana_trans structure */
@@ -4032,20 +4148,27 @@ static void dns_stats_tree_init(stats_tree* st)
         st_node_response_stats, FALSE);
 }
 
+/* Names of the pivots' nodes, only made when a value is first seen */
+static const stat_node_vals_t st_vals_qr = { dns_qr_vals, "Unknown qr (%d)" };
+static const stat_node_vals_t st_vals_qtypes = { dns_types_description_vals, "Unknown packet type (%d)" };
+static const stat_node_vals_t st_vals_qclasses = { dns_classes, "Unknown class (%d)" };
+static const stat_node_vals_t st_vals_rcodes = { rcode_vals, "Unknown rcode (%d)" };
+static const stat_node_vals_t st_vals_opcodes = { opcode_vals, "Unknown opcode (%d)" };
+
 static int dns_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* edt _U_, const void* p)
 {
     struct DnsTap *pi = (struct DnsTap *)p;
     tick_stat_node(st, st_str_packets, 0, FALSE);
-    stats_tree_tick_pivot(st, st_node_packet_qr,
-            val_to_str(pi->packet_qr, dns_qr_vals, "Unknown qr (%d)"));
-    stats_tree_tick_pivot(st, st_node_packet_qtypes,
-            val_to_str(pi->packet_qtype, dns_types_description_vals, "Unknown packet type (%d)"));
-    stats_tree_tick_pivot(st, st_node_packet_qclasses,
-            val_to_str(pi->packet_qclass, dns_classes, "Unknown class (%d)"));
-    stats_tree_tick_pivot(st, st_node_packet_rcodes,
-            val_to_str(pi->packet_rcode, rcode_vals, "Unknown rcode (%d)"));
-    stats_tree_tick_pivot(st, st_node_packet_opcodes,
-            val_to_str(pi->packet_opcode, opcode_vals, "Unknown opcode (%d)"));
+    stats_tree_tick_pivot_int(st, st_node_packet_qr, pi->packet_qr,
+            stats_tree_vals_name, &st_vals_qr);
+    stats_tree_tick_pivot_int(st, st_node_packet_qtypes, pi->packet_qtype,
+            stats_tree_vals_name, &st_vals_qtypes);
+    stats_tree_tick_pivot_int(st, st_node_packet_qclasses, pi->packet_qclass,
+            stats_tree_vals_name, &st_vals_qclasses);
+    stats_tree_tick_pivot_int(st, st_node_packet_rcodes, pi->packet_rcode,
+            stats_tree_vals_name, &st_vals_rcodes);
+    stats_tree_tick_pivot_int(st, st_node_packet_opcodes, pi->packet_opcode,
+            stats_tree_vals_name, &st_vals_opcodes);
     avg_stat_node_add_value(st, st_str_packets_avg_size, 0, FALSE,
             pi->payload_size);
 
@@ -185,7 +185,7 @@ dtls_init(void)
   module_t *dtls_module = prefs_find_module("dtls");
   pref_t   *keys_list_pref;
 
-  ssl_common_init(&dtls_master_key_map, &dtls_keylog_file,
+  ssl_common_init(&dtls_master_key_map,
                   &dtls_decrypted_data, &dtls_compressed_data);
   reassembly_table_init (&dtls_reassembly_table, &addresses_reassembly_table_functions);
 
@@ -54,6 +54,7 @@
 
 #include <epan/packet.h>
 #include <epan/conversation.h>
+#include <epan/intern.h>
 #include <epan/prefs.h>
 #include <epan/expert.h>
 #include <epan/sminmpec.h>
@@ -2010,6 +2011,57 @@ static gint ett_gtp_ies[NUM_GTP_IES];
 
 static guint8 gtp_version = 0;
 
+/*
+ * What GTP-C has told us about each tunnel endpoint, so that the user
+ * plane (T-PDUs), which carries nothing but the TEID, can be tied to the
+ * subscriber.  A TEID that's set up again gets a new entry that points
+ * to the old one, so that a frame is matched with the setup that came
+ * before it however often the file is dissected.
+ */
+typedef struct gtp_teid_session {
+    struct gtp_teid_session *prev;        /* earlier setup of the TEID */
+    guint32                  setup_frame; /* GTP-C message that set up the TEID */
+    const gchar             *imsi;        /* interned; NULL if not known */
+} gtp_teid_session_t;
+
+static wmem_map_t *gtp_teid_sessions = NULL;
+
+/* IMSI of the GTP-C message being dissected, if it's known yet */
+static const gchar *gtp_msg_imsi = NULL;
+
+static void
+gtp_teid_session_add(packet_info *pinfo, guint32 teid)
+{
+    gtp_teid_session_t *session, *prev;
+
+    if (pinfo->fd->flags.visited)
+        return;
+
+    prev = (gtp_teid_session_t *)wmem_map_lookup(gtp_teid_sessions, GUINT_TO_POINTER(teid));
+    if (prev != NULL && prev->setup_frame == pinfo->fd->num) {
+        /* Set up more than once in this message */
+        session = prev;
+    } else {
+        session = wmem_new(wmem_file_scope(), gtp_teid_session_t);
+        session->prev = prev;
+        session->setup_frame = pinfo->fd->num;
+        wmem_map_insert(gtp_teid_sessions, GUINT_TO_POINTER(teid), session);
+    }
+    session->imsi = intern_string(gtp_msg_imsi);
+}
+
+/* The setup of teid in effect at frame_num, if GTP-C has set it up */
+static const gtp_teid_session_t *
+gtp_teid_session_lookup(guint32 teid, guint32 frame_num)
+{
+    const gtp_teid_session_t *session;
+
+    session = (const gtp_teid_session_t *)wmem_map_lookup(gtp_teid_sessions, GUINT_TO_POINTER(teid));
+    while (session != NULL && session->setup_frame > frame_num)
+        session = session->prev;
+    return session;
+}
+
 #define BCD2CHAR(d)         ((d) | 0x30)
 
 static gchar *
@@ -3262,7 +3314,7 @@ decode_gtp_imsi(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree * tr
     /* const gchar *imsi_str; */
 
     /* Octets 2 - 9 IMSI */
-    /* imsi_str = */ dissect_e212_imsi(tvb, pinfo, tree,  offset+1, 8, FALSE);
+    gtp_msg_imsi = dissect_e212_imsi(tvb, pinfo, tree,  offset+1, 8, FALSE);
 
     return 9;
 }
@@ -3280,8 +3332,8 @@ decode_gtp_rai(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
                             val_to_str_ext_const(GTP_EXT_RAI, &gtp_val_ext, "Unknown message"));
 
     dissect_e212_mcc_mnc(tvb, pinfo, ext_tree_rai, offset+1, E212_RAI, TRUE);
-    proto_tree_add_item(ext_tree_rai, hf_gtp_rai_lac, tvb, offset + 4, 2, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_rai, hf_gtp_rai_rac, tvb, offset + 6, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_rai, hf_gtp_rai_lac, tvb, offset + 4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_rai, hf_gtp_rai_rac, tvb, offset + 6, ENC_BIG_ENDIAN);
 
     return 7;
 }
@@ -3486,7 +3538,7 @@ static int
 decode_gtp_sel_mode(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree * tree)
 {
 
-    proto_tree_add_item(tree, hf_gtp_sel_mode, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(tree, hf_gtp_sel_mode, tvb, offset, ENC_BIG_ENDIAN);
     return 2;
 }
 
@@ -3494,7 +3546,7 @@ decode_gtp_sel_mode(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_t
  * UMTS:        29.060 v4.0, chapter 7.7.13, page 50
  */
 static int
-decode_gtp_16(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree * tree)
+decode_gtp_16(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree * tree)
 {
 
     guint16 ext_flow_label;
@@ -3509,6 +3561,7 @@ decode_gtp_16(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
     case 1:
         teid_data = tvb_get_ntohl(tvb, offset + 1);
         proto_tree_add_uint(tree, hf_gtp_teid_data, tvb, offset+1, 4, teid_data);
+        gtp_teid_session_add(pinfo, teid_data);
 
         return 5;
     default:
@@ -3522,7 +3575,7 @@ decode_gtp_16(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
  * UMTS:        29.060 v4.0, chapter 7.7.14, page 42
  */
 static int
-decode_gtp_17(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree * tree)
+decode_gtp_17(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree * tree)
 {
 
     guint16 flow_sig;
@@ -3536,6 +3589,7 @@ decode_gtp_17(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
     case 1:
         teid_cp = tvb_get_ntohl(tvb, offset + 1);
         proto_tree_add_uint(tree, hf_gtp_teid_cp, tvb, offset, 5, teid_cp);
+        gtp_teid_session_add(pinfo, teid_cp);
         return 5;
     default:
         proto_tree_add_text(tree, tvb, offset, 1, "Flow label signalling/TEID control plane : GTP version not supported");
@@ -3547,7 +3601,7 @@ decode_gtp_17(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
  * UMTS:        29.060 v4.0, chapter 7.7.15, page 51
  */
 static int
-decode_gtp_18(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree * tree)
+decode_gtp_18(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree * tree)
 {
 
     guint16     flow_ii;
@@ -3559,7 +3613,7 @@ decode_gtp_18(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
         ext_tree_flow_ii = proto_tree_add_subtree(tree, tvb, offset, 4, ett_gtp_ies[GTP_EXT_FLOW_II], NULL,
                         val_to_str_ext_const(GTP_EXT_FLOW_II, &gtp_val_ext, "Unknown message"));
 
-        proto_tree_add_item(ext_tree_flow_ii, hf_gtp_nsapi, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_flow_ii, hf_gtp_nsapi, tvb, offset + 1, ENC_BIG_ENDIAN);
 
         flow_ii = tvb_get_ntohs(tvb, offset + 2);
         proto_tree_add_uint(ext_tree_flow_ii, hf_gtp_flow_ii, tvb, offset + 2, 2, flow_ii);
@@ -3569,10 +3623,11 @@ decode_gtp_18(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
         ext_tree_flow_ii = proto_tree_add_subtree(tree, tvb, offset, 6, ett_gtp_flow_ii, NULL,
                 val_to_str_ext_const(GTP_EXT_TEID_II, &gtpv1_val_ext, "Unknown message"));
 
-        proto_tree_add_item(ext_tree_flow_ii, hf_gtp_nsapi, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_flow_ii, hf_gtp_nsapi, tvb, offset + 1, ENC_BIG_ENDIAN);
 
         teid_ii = tvb_get_ntohl(tvb, offset + 2);
         proto_tree_add_uint(ext_tree_flow_ii, hf_gtp_teid_ii, tvb, offset + 2, 4, teid_ii);
+        gtp_teid_session_add(pinfo, teid_ii);
 
         return 6;
     default:
@@ -3623,7 +3678,7 @@ decode_gtp_nsapi(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree
                             val_to_str_ext_const(GTP_EXT_NSAPI, &gtp_val_ext, "Unknown message"));
 
     nsapi = tvb_get_guint8(tvb, offset + 1) & 0x0F;
-    proto_tree_add_item(ext_tree, hf_gtp_nsapi, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_nsapi, tvb, offset + 1, ENC_BIG_ENDIAN);
     proto_item_append_text(te, ": %u",nsapi);
 
     return 2;
@@ -3690,11 +3745,11 @@ decode_gtp_rab_cntxt(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
     ext_tree_rab_cntxt = proto_tree_add_subtree(tree, tvb, offset, 10, ett_gtp_ies[GTP_EXT_RAB_CNTXT], NULL,
                         val_to_str_ext_const(GTP_EXT_RAB_CNTXT, &gtp_val_ext, "Unknown message"));
 
-    proto_tree_add_item(ext_tree_rab_cntxt, hf_gtp_nsapi,       tvb, offset + 1, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_rab_cntxt, hf_gtp_rab_gtpu_dn, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_rab_cntxt, hf_gtp_rab_gtpu_up, tvb, offset + 4, 2, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_rab_cntxt, hf_gtp_rab_pdu_dn,  tvb, offset + 6, 2, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_rab_cntxt, hf_gtp_rab_pdu_up,  tvb, offset + 8, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_rab_cntxt, hf_gtp_nsapi,       tvb, offset + 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_rab_cntxt, hf_gtp_rab_gtpu_dn, tvb, offset + 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_rab_cntxt, hf_gtp_rab_gtpu_up, tvb, offset + 4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_rab_cntxt, hf_gtp_rab_pdu_dn,  tvb, offset + 6, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_rab_cntxt, hf_gtp_rab_pdu_up,  tvb, offset + 8, ENC_BIG_ENDIAN);
 
     return 10;
 }
@@ -3757,7 +3812,7 @@ decode_gtp_pkt_flow_id(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, prot
     te = proto_tree_add_uint_format(tree, hf_gtp_pkt_flow_id, tvb, offset, 3, pkt_flow_id, "Packet Flow ID for NSAPI(%u) : %u", nsapi, pkt_flow_id);
     ext_tree_pkt_flow_id = proto_item_add_subtree(te, ett_gtp_pkt_flow_id);
 
-    proto_tree_add_item(ext_tree_pkt_flow_id, hf_gtp_nsapi, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_pkt_flow_id, hf_gtp_nsapi, tvb, offset + 1, ENC_BIG_ENDIAN);
     proto_tree_add_uint_format(ext_tree_pkt_flow_id, hf_gtp_pkt_flow_id, tvb,
                                offset + 2, 1, pkt_flow_id, "%s : %u", val_to_str_ext_const(GTP_EXT_PKT_FLOW_ID, &gtp_val_ext, "Unknown message"), pkt_flow_id);
 
@@ -3857,10 +3912,10 @@ decode_gtp_ra_prio_lcs(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, prot
                     "%s : ", val_to_str_ext_const(GTP_EXT_RA_PRIO_LCS, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
-    proto_tree_add_item(ext_tree, hf_gtp_ra_prio_lcs, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ra_prio_lcs, tvb, offset, ENC_BIG_ENDIAN);
 
     return 3 + length;
 
@@ -3920,7 +3975,7 @@ decode_gtp_user_addr(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
                              val_to_str_const(pdp_org, pdp_org_type, "Unknown PDP Organization"),
                              val_to_str_const(pdp_typ, pdp_type, "Unknown PDP Type"));
 
-    proto_tree_add_item(ext_tree_user, hf_gtp_length, tvb, offset + 1, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_user, hf_gtp_length, tvb, offset + 1, ENC_BIG_ENDIAN);
     proto_tree_add_uint(ext_tree_user, hf_gtp_user_addr_pdp_org,  tvb, offset + 3, 1, pdp_org);
     proto_tree_add_uint(ext_tree_user, hf_gtp_user_addr_pdp_type, tvb, offset + 4, 1, pdp_typ);
 
@@ -3932,7 +3987,7 @@ decode_gtp_user_addr(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
     } else if (length > 2) {
         switch (pdp_typ) {
         case 0x21:
-            proto_tree_add_item(ext_tree_user, hf_gtp_user_ipv4, tvb, offset + 5, 4, ENC_BIG_ENDIAN);
+            proto_tree_add_item_ipv4(ext_tree_user, hf_gtp_user_ipv4, tvb, offset + 5, ENC_BIG_ENDIAN);
             proto_item_append_text(te, " : %s", tvb_ip_to_str(tvb, offset + 5));
             break;
         case 0x57:
@@ -3940,7 +3995,7 @@ decode_gtp_user_addr(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
             proto_item_append_text(te, " : %s", tvb_ip6_to_str(tvb, offset + 5));
             break;
         case 0x8d:
-            proto_tree_add_item(ext_tree_user, hf_gtp_user_ipv4, tvb, offset + 5, 4, ENC_BIG_ENDIAN);
+            proto_tree_add_item_ipv4(ext_tree_user, hf_gtp_user_ipv4, tvb, offset + 5, ENC_BIG_ENDIAN);
             proto_tree_add_item(ext_tree_user, hf_gtp_user_ipv6, tvb, offset + 9, 16, ENC_NA);
             proto_item_append_text(te, " : %s / %s", tvb_ip_to_str(tvb, offset + 5),
                                    tvb_ip6_to_str(tvb, offset + 9));
@@ -3991,7 +4046,7 @@ decode_quintuplet(tvbuff_t * tvb, int offset, proto_tree * tree, guint16 count)
         proto_tree_add_item(ext_tree_quint, hf_gtp_rand, tvb, offset + q_offset, 16, ENC_NA);
         q_offset = q_offset + 16;
         xres_len = tvb_get_guint8(tvb, offset + q_offset);
-        proto_tree_add_item(ext_tree_quint, hf_gtp_xres_length, tvb, offset + q_offset, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_quint, hf_gtp_xres_length, tvb, offset + q_offset, ENC_BIG_ENDIAN);
         q_offset++;
         proto_tree_add_item(ext_tree_quint, hf_gtp_xres, tvb, offset + q_offset, xres_len, ENC_NA);
         q_offset = q_offset + xres_len;
@@ -4000,7 +4055,7 @@ decode_quintuplet(tvbuff_t * tvb, int offset, proto_tree * tree, guint16 count)
         proto_tree_add_item(ext_tree_quint, hf_gtp_quintuplet_integrity_key, tvb, offset + q_offset, 16, ENC_NA);
         q_offset = q_offset + 16;
         auth_len = tvb_get_guint8(tvb, offset + q_offset);
-        proto_tree_add_item(ext_tree_quint, hf_gtp_authentication_length, tvb, offset + q_offset, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_quint, hf_gtp_authentication_length, tvb, offset + q_offset, ENC_BIG_ENDIAN);
         q_offset++;
         proto_tree_add_item(ext_tree_quint, hf_gtp_auth, tvb, offset + q_offset, auth_len, ENC_NA);
 
@@ -4040,55 +4095,55 @@ decode_gtp_mm_cntxt(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree
     sec_mode = (tvb_get_guint8(tvb, offset + 4) >> 6) & 0x03;
     count = (tvb_get_guint8(tvb, offset + 4) >> 3) & 0x07;
 
-    proto_tree_add_item(ext_tree_mm, hf_gtp_length, tvb, offset + 1, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_mm, hf_gtp_length, tvb, offset + 1, ENC_BIG_ENDIAN);
     if (gtp_version == 0)
         sec_mode = 1;
 
 
     switch (sec_mode) {
     case 0:                     /* Used cipher value, UMTS keys and Quintuplets */
-        proto_tree_add_item(ext_tree_mm, hf_gtp_cksn_ksi,         tvb, offset + 3, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_mm, hf_gtp_security_mode,    tvb, offset + 4, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_mm, hf_gtp_no_of_vectors,    tvb, offset + 4, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_mm, hf_gtp_cipher_algorithm, tvb, offset + 4, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_cksn_ksi,         tvb, offset + 3, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_security_mode,    tvb, offset + 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_no_of_vectors,    tvb, offset + 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_cipher_algorithm, tvb, offset + 4, ENC_BIG_ENDIAN);
         proto_tree_add_item(ext_tree_mm, hf_gtp_ciphering_key_ck, tvb, offset + 5, 16, ENC_NA);
         proto_tree_add_item(ext_tree_mm, hf_gtp_integrity_key_ik, tvb, offset + 21, 16, ENC_NA);
-        proto_tree_add_item(ext_tree_mm, hf_gtp_quintuplets_length, tvb, offset + 37, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(ext_tree_mm, hf_gtp_quintuplets_length, tvb, offset + 37, ENC_BIG_ENDIAN);
 
         offset = offset + decode_quintuplet(tvb, offset + 39, ext_tree_mm, count) + 39;
 
 
         break;
     case 1:                     /* GSM key and triplets */
-        proto_tree_add_item(ext_tree_mm, hf_gtp_cksn, tvb, offset + 3, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_cksn, tvb, offset + 3, ENC_BIG_ENDIAN);
         if (gtp_version != 0)
-            proto_tree_add_item(ext_tree_mm, hf_gtp_security_mode, tvb, offset + 4, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_security_mode, tvb, offset + 4, ENC_BIG_ENDIAN);
 
-        proto_tree_add_item(ext_tree_mm, hf_gtp_no_of_vectors,    tvb, offset + 4, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_mm, hf_gtp_cipher_algorithm, tvb, offset + 4, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_no_of_vectors,    tvb, offset + 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_cipher_algorithm, tvb, offset + 4, ENC_BIG_ENDIAN);
         proto_tree_add_item(ext_tree_mm, hf_gtp_ciphering_key_kc, tvb, offset + 5, 8, ENC_NA);
 
         offset = offset + decode_triplet(tvb, offset + 13, ext_tree_mm, count) + 13;
 
         break;
     case 2:                     /* UMTS key and quintuplets */
-        proto_tree_add_item(ext_tree_mm, hf_gtp_ksi, tvb, offset + 3, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_mm, hf_gtp_security_mode, tvb, offset + 4, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_mm, hf_gtp_no_of_vectors, tvb, offset + 4, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_ksi, tvb, offset + 3, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_security_mode, tvb, offset + 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_no_of_vectors, tvb, offset + 4, ENC_BIG_ENDIAN);
         proto_tree_add_item(ext_tree_mm, hf_gtp_ciphering_key_ck, tvb, offset + 5, 16, ENC_NA);
         proto_tree_add_item(ext_tree_mm, hf_gtp_integrity_key_ik, tvb, offset + 21, 16, ENC_NA);
-       proto_tree_add_item(ext_tree_mm, hf_gtp_quintuplets_length, tvb, offset + 37, 2, ENC_BIG_ENDIAN);
+       proto_tree_add_item_uint16(ext_tree_mm, hf_gtp_quintuplets_length, tvb, offset + 37, ENC_BIG_ENDIAN);
 
         offset = offset + decode_quintuplet(tvb, offset + 39, ext_tree_mm, count) + 39;
 
         break;
     case 3:                     /* GSM key and quintuplets */
-        proto_tree_add_item(ext_tree_mm, hf_gtp_cksn,             tvb, offset + 3, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_mm, hf_gtp_security_mode,    tvb, offset + 4, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_mm, hf_gtp_no_of_vectors,    tvb, offset + 4, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_mm, hf_gtp_cipher_algorithm, tvb, offset + 4, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_cksn,             tvb, offset + 3, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_security_mode,    tvb, offset + 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_no_of_vectors,    tvb, offset + 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_mm, hf_gtp_cipher_algorithm, tvb, offset + 4, ENC_BIG_ENDIAN);
         proto_tree_add_item(ext_tree_mm, hf_gtp_ciphering_key_kc, tvb, offset + 5, 8, ENC_NA);
-        proto_tree_add_item(ext_tree_mm, hf_gtp_quintuplets_length, tvb, offset + 13, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(ext_tree_mm, hf_gtp_quintuplets_length, tvb, offset + 13, ENC_BIG_ENDIAN);
 
         offset = offset + decode_quintuplet(tvb, offset + 15, ext_tree_mm, count) + 15;
 
@@ -4136,7 +4191,7 @@ decode_gtp_mm_cntxt(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree
  */
 
     con_len = tvb_get_ntohs(tvb, offset);
-    proto_tree_add_item(ext_tree_mm, hf_gtp_container_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_mm, hf_gtp_container_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     if (con_len > 0) {
@@ -4798,8 +4853,8 @@ decode_gtp_pdp_cntxt(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
     proto_tree_add_item(ext_tree_pdp, hf_gtp_vplmn_address_allowed, tvb, offset + 3, 1, ENC_NA);
     proto_tree_add_item(ext_tree_pdp, hf_gtp_activity_status_indicator, tvb, offset + 3, 1, ENC_NA);
     proto_tree_add_item(ext_tree_pdp, hf_gtp_reordering_required, tvb, offset + 3, 1, ENC_NA);
-    proto_tree_add_item(ext_tree_pdp, hf_gtp_nsapi, tvb, offset + 3, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_pdp, hf_gtp_pdp_cntxt_sapi, tvb, offset + 4, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_nsapi, tvb, offset + 3, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_pdp_cntxt_sapi, tvb, offset + 4, ENC_BIG_ENDIAN);
 
     switch (gtp_version) {
     case 0:
@@ -4818,20 +4873,20 @@ decode_gtp_pdp_cntxt(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
         break;
     }
 
-    proto_tree_add_item(ext_tree_pdp, hf_gtp_sequence_number_down, tvb, offset, 2, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_pdp, hf_gtp_sequence_number_up, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_pdp, hf_gtp_send_n_pdu_number, tvb, offset + 4, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_pdp, hf_gtp_receive_n_pdu_number, tvb, offset + 5, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_pdp, hf_gtp_sequence_number_down, tvb, offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_pdp, hf_gtp_sequence_number_up, tvb, offset + 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_send_n_pdu_number, tvb, offset + 4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_receive_n_pdu_number, tvb, offset + 5, ENC_BIG_ENDIAN);
 
     switch (gtp_version) {
     case 0:
-        proto_tree_add_item(ext_tree_pdp, hf_gtp_uplink_flow_label_signalling, tvb, offset + 6, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(ext_tree_pdp, hf_gtp_uplink_flow_label_signalling, tvb, offset + 6, ENC_BIG_ENDIAN);
         offset = offset + 8;
         break;
     case 1:
-        proto_tree_add_item(ext_tree_pdp, hf_gtp_ulink_teid_cp,   tvb, offset + 6, 4, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_pdp, hf_gtp_ulink_teid_data, tvb, offset + 10, 4, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_pdp, hf_gtp_pdp_context_identifier, tvb, offset + 14, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint32(ext_tree_pdp, hf_gtp_ulink_teid_cp,   tvb, offset + 6, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint32(ext_tree_pdp, hf_gtp_ulink_teid_data, tvb, offset + 10, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_pdp_context_identifier, tvb, offset + 14, ENC_BIG_ENDIAN);
         offset = offset + 15;
         break;
     default:
@@ -4841,14 +4896,14 @@ decode_gtp_pdp_cntxt(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
     pdp_type_num = tvb_get_guint8(tvb, offset + 1);
     pdp_addr_len = tvb_get_guint8(tvb, offset + 2);
 
-    proto_tree_add_item(ext_tree_pdp, hf_gtp_pdp_organization, tvb, offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_pdp, hf_gtp_pdp_type, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_pdp, hf_gtp_pdp_address_length, tvb, offset + 2, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_pdp_organization, tvb, offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_pdp_type, tvb, offset + 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_pdp_address_length, tvb, offset + 2, ENC_BIG_ENDIAN);
 
     if (pdp_addr_len > 0) {
         switch (pdp_type_num) {
         case 0x21:
-            proto_tree_add_item(ext_tree_pdp, hf_gtp_pdp_address_ipv4, tvb, offset + 3, 4, ENC_BIG_ENDIAN);
+            proto_tree_add_item_ipv4(ext_tree_pdp, hf_gtp_pdp_address_ipv4, tvb, offset + 3, ENC_BIG_ENDIAN);
             break;
         case 0x57:
             proto_tree_add_item(ext_tree_pdp, hf_gtp_pdp_address_ipv6, tvb, offset + 3, 16, ENC_NA);
@@ -4861,11 +4916,11 @@ decode_gtp_pdp_cntxt(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
     offset = offset + 3 + pdp_addr_len;
 
     ggsn_addr_len = tvb_get_guint8(tvb, offset);
-    proto_tree_add_item(ext_tree_pdp, hf_gtp_ggsn_address_length, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_ggsn_address_length, tvb, offset, ENC_BIG_ENDIAN);
 
     switch (ggsn_addr_len) {
     case 4:
-        proto_tree_add_item(ext_tree_pdp, hf_gtp_ggsn_address_for_control_plane, tvb, offset + 1, 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_ipv4(ext_tree_pdp, hf_gtp_ggsn_address_for_control_plane, tvb, offset + 1, ENC_BIG_ENDIAN);
         break;
     case 16:
         proto_tree_add_item(ext_tree_pdp, hf_gtp_ggsn_address_for_user_traffic, tvb, offset + 1, 16, ENC_BIG_ENDIAN);
@@ -4879,11 +4934,11 @@ decode_gtp_pdp_cntxt(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
     if (gtp_version == 1) {
 
         ggsn_addr_len = tvb_get_guint8(tvb, offset);
-        proto_tree_add_item(ext_tree_pdp, hf_gtp_ggsn_2_address_length, tvb, offset, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_ggsn_2_address_length, tvb, offset, ENC_BIG_ENDIAN);
 
         switch (ggsn_addr_len) {
         case 4:
-            proto_tree_add_item(ext_tree_pdp, hf_gtp_ggsn_2_address_ipv4, tvb, offset + 1, 4, ENC_BIG_ENDIAN);
+            proto_tree_add_item_ipv4(ext_tree_pdp, hf_gtp_ggsn_2_address_ipv4, tvb, offset + 1, ENC_BIG_ENDIAN);
             break;
         case 16:
             proto_tree_add_item(ext_tree_pdp, hf_gtp_ggsn_2_address_ipv6, tvb, offset + 1, 16, ENC_NA);
@@ -4896,7 +4951,7 @@ decode_gtp_pdp_cntxt(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
     }
 
     apn_len = tvb_get_guint8(tvb, offset);
-    proto_tree_add_item(ext_tree_pdp, hf_gtp_apn_length, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_apn_length, tvb, offset, ENC_BIG_ENDIAN);
     decode_apn(tvb, offset + 1, apn_len, ext_tree_pdp, NULL);
 
     offset = offset + 1 + apn_len;
@@ -4916,13 +4971,13 @@ decode_gtp_pdp_cntxt(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
         pdp_type_num = tvb_get_guint8(tvb, offset);
         pdp_addr_len = tvb_get_guint8(tvb, offset + 1);
 
-        proto_tree_add_item(ext_tree_pdp, hf_gtp_pdp_type, tvb, offset, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_pdp, hf_gtp_pdp_address_length, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_pdp_type, tvb, offset, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ext_tree_pdp, hf_gtp_pdp_address_length, tvb, offset + 1, ENC_BIG_ENDIAN);
 
         if (pdp_addr_len > 0) {
             switch (pdp_type_num) {
             case 0x21:
-                proto_tree_add_item(ext_tree_pdp, hf_gtp_pdp_address_ipv4, tvb, offset + 2, 4, ENC_NA);
+                proto_tree_add_item_ipv4(ext_tree_pdp, hf_gtp_pdp_address_ipv4, tvb, offset + 2, ENC_NA);
                 break;
             case 0x57:
                 proto_tree_add_item(ext_tree_pdp, hf_gtp_pdp_address_ipv6, tvb, offset + 2, 16, ENC_NA);
@@ -4952,7 +5007,7 @@ decode_gtp_apn(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
     ext_tree_apn = proto_tree_add_subtree(tree, tvb, offset, length + 3, ett_gtp_ies[GTP_EXT_APN], &te,
                                 val_to_str_ext_const(GTP_EXT_APN, &gtp_val_ext, "Unknown field"));
 
-    proto_tree_add_item(ext_tree_apn, hf_gtp_apn_length, tvb, offset + 1, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_apn, hf_gtp_apn_length, tvb, offset + 1, ENC_BIG_ENDIAN);
     decode_apn(tvb, offset + 3, length, ext_tree_apn, te);
 
     return 3 + length;
@@ -5009,26 +5064,26 @@ decode_gtp_gsn_addr(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_t
 
     switch (length) {
     case 4:
-        proto_tree_add_item(ext_tree_gsn_addr, hf_gtp_gsn_address_length, tvb, offset + 1, 2, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ext_tree_gsn_addr, hf_gtp_gsn_ipv4, tvb, offset + 3, 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(ext_tree_gsn_addr, hf_gtp_gsn_address_length, tvb, offset + 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_ipv4(ext_tree_gsn_addr, hf_gtp_gsn_ipv4, tvb, offset + 3, ENC_BIG_ENDIAN);
         proto_item_append_text(te, "%s", tvb_ip_to_str(tvb, offset + 3));
         break;
     case 5:
-        proto_tree_add_item(ext_tree_gsn_addr, hf_gtp_gsn_address_information_element_length, tvb, offset + 1, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(ext_tree_gsn_addr, hf_gtp_gsn_address_information_element_length, tvb, offset + 1, ENC_BIG_ENDIAN);
         addr_type = tvb_get_guint8(tvb, offset + 3) & 0xC0;
         proto_tree_add_uint(ext_tree_gsn_addr, hf_gtp_gsn_addr_type, tvb, offset + 3, 1, addr_type);
         addr_len = tvb_get_guint8(tvb, offset + 3) & 0x3F;
         proto_tree_add_uint(ext_tree_gsn_addr, hf_gtp_gsn_addr_len, tvb, offset + 3, 1, addr_len);
-        proto_tree_add_item(ext_tree_gsn_addr, hf_gtp_gsn_ipv4, tvb, offset + 4, 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_ipv4(ext_tree_gsn_addr, hf_gtp_gsn_ipv4, tvb, offset + 4, ENC_BIG_ENDIAN);
         proto_item_append_text(te, "%s", tvb_ip_to_str(tvb, offset + 4));
         break;
     case 16:
-        proto_tree_add_item(ext_tree_gsn_addr, hf_gtp_gsn_address_length, tvb, offset + 1, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(ext_tree_gsn_addr, hf_gtp_gsn_address_length, tvb, offset + 1, ENC_BIG_ENDIAN);
         proto_tree_add_item(ext_tree_gsn_addr, hf_gtp_gsn_ipv6, tvb, offset + 3, 16, ENC_NA);
         proto_item_append_text(te, "%s", tvb_ip6_to_str(tvb, offset + 3));
         break;
     case 17:
-        proto_tree_add_item(ext_tree_gsn_addr, hf_gtp_gsn_address_information_element_length, tvb, offset + 1, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(ext_tree_gsn_addr, hf_gtp_gsn_address_information_element_length, tvb, offset + 1, ENC_BIG_ENDIAN);
         addr_type = tvb_get_guint8(tvb, offset + 3) & 0xC0;
         proto_tree_add_uint(ext_tree_gsn_addr, hf_gtp_gsn_addr_type, tvb, offset + 3, 1, addr_type);
         addr_len = tvb_get_guint8(tvb, offset + 3) & 0x3F;
@@ -5100,13 +5155,13 @@ decode_gtp_auth_qui(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_t
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, length + 1, ett_gtp_quint, NULL, "Quintuplet");
     offset++;
 
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     proto_tree_add_item(ext_tree, hf_gtp_rand, tvb, offset, 16, ENC_NA);
     offset = offset + 16;
     xres_len = tvb_get_guint8(tvb, offset);
-    proto_tree_add_item(ext_tree, hf_gtp_xres_length, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_xres_length, tvb, offset, ENC_BIG_ENDIAN);
     offset++;
     proto_tree_add_item(ext_tree, hf_gtp_xres, tvb, offset, xres_len, ENC_NA);
     offset = offset + xres_len;
@@ -5115,7 +5170,7 @@ decode_gtp_auth_qui(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_t
     proto_tree_add_item(ext_tree, hf_gtp_quintuplet_integrity_key, tvb, offset, 16, ENC_NA);
     offset = offset + 16;
     auth_len = tvb_get_guint8(tvb, offset);
-    proto_tree_add_item(ext_tree, hf_gtp_authentication_length, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_authentication_length, tvb, offset, ENC_BIG_ENDIAN);
     offset++;
     proto_tree_add_item(ext_tree, hf_gtp_auth, tvb, offset, auth_len, ENC_NA);
 
@@ -5146,7 +5201,7 @@ decode_gtp_tft(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
     tft_code = (tft_flags >> 5) & 0x07;
     no_packet_filters = tft_flags & 0x0F;
 
-    proto_tree_add_item(ext_tree_tft, hf_gtp_tft_length, tvb, offset + 1, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_tft, hf_gtp_tft_length, tvb, offset + 1, ENC_BIG_ENDIAN);
 
     ext_tree_tft_flags = proto_tree_add_subtree(ext_tree_tft, tvb, offset + 3, 1, ett_gtp_tft_flags, NULL, "TFT flags");
     proto_tree_add_uint(ext_tree_tft_flags, hf_gtp_tft_code,   tvb, offset + 3, 1, tft_flags);
@@ -5157,7 +5212,7 @@ decode_gtp_tft(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
 
     for (i = 0; i < no_packet_filters; i++) {
 
-        tee = proto_tree_add_item(ext_tree_tft, hf_gtp_tft_packet_filter_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+        tee = proto_tree_add_item_uint8(ext_tree_tft, hf_gtp_tft_packet_filter_id, tvb, offset, ENC_BIG_ENDIAN);
         ext_tree_tft_pf = proto_item_add_subtree(tee, ett_gtp_tft_pf);
         offset++;
 
@@ -5167,7 +5222,7 @@ decode_gtp_tft(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
             pf_len = tvb_get_guint8(tvb, offset + 1);
 
             proto_tree_add_uint(ext_tree_tft_pf, hf_gtp_tft_eval, tvb, offset, 1, pf_eval);
-            proto_tree_add_item(ext_tree_tft_pf, hf_gtp_tft_content_length, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(ext_tree_tft_pf, hf_gtp_tft_content_length, tvb, offset + 1, ENC_BIG_ENDIAN);
 
             offset = offset + 2;
             pf_offset = 0;
@@ -5175,7 +5230,7 @@ decode_gtp_tft(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
             while (pf_offset < pf_len) {
 
                 pf_content_id = tvb_get_guint8(tvb, offset + pf_offset);
-                pf_item = proto_tree_add_item(ext_tree_tft_pf, hf_gtp_tft_content_id, tvb, offset + pf_offset, 1, ENC_BIG_ENDIAN);
+                pf_item = proto_tree_add_item_uint8(ext_tree_tft_pf, hf_gtp_tft_content_id, tvb, offset + pf_offset, ENC_BIG_ENDIAN);
 
                 switch (pf_content_id) {
                     /* address IPv4 and mask = 8 bytes */
@@ -5283,7 +5338,7 @@ decode_gtp_target_id(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree
 
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_TARGET_ID], NULL, "Target Identification");
     offset = offset + 1;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* Quote from specification:
      * The Target Identification information element contains the identification of a target RNC. Octets 4-n shall contain a
@@ -5297,19 +5352,19 @@ decode_gtp_target_id(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree
     dissect_e212_mcc_mnc(tvb, pinfo, ext_tree, offset, E212_NONE, TRUE);
     offset+=3;
     /* Octet 7-8 LAC */
-    proto_tree_add_item(ext_tree, hf_gtp_rai_lac, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_rai_lac, tvb, offset, ENC_BIG_ENDIAN);
     offset+=2;
     /* Octet 9 RAC */
-    proto_tree_add_item(ext_tree, hf_gtp_rai_rac, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_rai_rac, tvb, offset, ENC_BIG_ENDIAN);
     offset++;
     /* Octet 10-11 RNC-ID*/
-    proto_tree_add_item(ext_tree, hf_gtp_target_rnc_id, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_target_rnc_id, tvb, offset, ENC_BIG_ENDIAN);
     offset+=2;
     /* If the optional Extended RNC-ID is not included, then the length variable 'n' = 8 and the overall length of the IE is 11
      * octets. Otherwise, 'n' = 10 and the overall length of the IE is 13 octets
      */
     if(length == 10){
-        proto_tree_add_item(ext_tree, hf_gtp_target_ext_rnc_id, tvb, offset, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(ext_tree, hf_gtp_target_ext_rnc_id, tvb, offset, ENC_BIG_ENDIAN);
     }
 
     return 3 + length;
@@ -5331,7 +5386,7 @@ decode_gtp_utran_cont(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_UTRAN_CONT], NULL, "UTRAN transparent Container");
 
     offset = offset + 1;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     proto_tree_add_item(ext_tree, hf_gtp_utran_field, tvb, offset, length, ENC_NA);
 
@@ -5355,8 +5410,8 @@ decode_gtp_rab_setup(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
 
     ext_tree_rab_setup = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_rab_setup, NULL, "Radio Access Bearer Setup Information");
 
-    proto_tree_add_item(ext_tree_rab_setup, hf_gtp_rab_setup_length, tvb, offset + 1, 2, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree_rab_setup, hf_gtp_nsapi, tvb, offset + 3, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_rab_setup, hf_gtp_rab_setup_length, tvb, offset + 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree_rab_setup, hf_gtp_nsapi, tvb, offset + 3, ENC_BIG_ENDIAN);
 
     if (length > 1) {
 
@@ -5366,7 +5421,7 @@ decode_gtp_rab_setup(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
 
         switch (length) {
         case 12:
-            proto_tree_add_item(ext_tree_rab_setup, hf_gtp_rnc_ipv4, tvb, offset + 8, 4, ENC_BIG_ENDIAN);
+            proto_tree_add_item_ipv4(ext_tree_rab_setup, hf_gtp_rnc_ipv4, tvb, offset + 8, ENC_BIG_ENDIAN);
             break;
         case 24:
             proto_tree_add_item(ext_tree_rab_setup, hf_gtp_rnc_ipv6, tvb, offset + 8, 16, ENC_NA);
@@ -5464,7 +5519,7 @@ decode_gtp_chrg_addr(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
 
     switch (length) {
     case 4:
-        proto_tree_add_item(ext_tree_chrg_addr, hf_gtp_chrg_ipv4, tvb, offset + 3, 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_ipv4(ext_tree_chrg_addr, hf_gtp_chrg_ipv4, tvb, offset + 3, ENC_BIG_ENDIAN);
         proto_item_append_text(te, "%s", tvb_ip_to_str(tvb, offset + 3));
         break;
     case 16:
@@ -5498,7 +5553,7 @@ decode_gtp_ran_tr_cont(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tr
                         "%s : ", val_to_str_ext_const(GTP_EXT_RAN_TR_CONT, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     next_tvb = tvb_new_subset_length(tvb, offset, length);
@@ -5528,7 +5583,7 @@ decode_gtp_pdp_cont_prio(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_
                         "%s : ", val_to_str_ext_const(GTP_EXT_PDP_CONT_PRIO, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -5552,7 +5607,7 @@ decode_gtp_add_rab_setup_inf(tvbuff_t * tvb, int offset, packet_info * pinfo _U_
                     "%s : ", val_to_str_ext_const(GTP_EXT_ADD_RAB_SETUP_INF, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -5577,7 +5632,7 @@ decode_gtp_ssgn_no(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tr
                     "%s : ", val_to_str_ext_const(GTP_EXT_SSGN_NO, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -5601,7 +5656,7 @@ decode_gtp_common_flgs(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, prot
                 "%s : ", val_to_str_ext_const(GTP_EXT_COMMON_FLGS, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length,                   tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length,                   tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* Dual Address Bearer Flag */
     proto_tree_add_item(ext_tree, hf_gtp_cmn_flg_dual_addr_bearer_flg, tvb, offset, 1, ENC_BIG_ENDIAN);
@@ -5639,7 +5694,7 @@ decode_gtp_apn_res(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree *
                 "%s : ", val_to_str_ext_const(GTP_EXT_APN_RES, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree_apn_res, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_apn_res, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     /* Restriction Type value */
@@ -5671,7 +5726,7 @@ decode_gtp_rat_type(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree
                         val_to_str_ext_const(GTP_EXT_RAT_TYPE, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree_rat_type, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_rat_type, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     /* RAT Type value */
@@ -5701,7 +5756,7 @@ gchar *dissect_radius_user_loc(proto_tree * tree, tvbuff_t * tvb, packet_info* p
     guint16 length = tvb_reported_length(tvb);
 
     /* Geographic Location Type */
-    proto_tree_add_item(tree, hf_gtp_ext_geo_loc_type, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(tree, hf_gtp_ext_geo_loc_type, tvb, offset, ENC_BIG_ENDIAN);
     geo_loc_type = tvb_get_guint8(tvb, offset);
     offset++;
 
@@ -5722,7 +5777,7 @@ gchar *dissect_radius_user_loc(proto_tree * tree, tvbuff_t * tvb, packet_info* p
             /* Use gsm_a's function to dissect Geographic Location by faking disc ( last 4) */
             be_cell_id_aux(tvb, tree, pinfo, offset, length - 1, NULL, 0, 4);
             offset = offset + 5;
-            proto_tree_add_item(tree, hf_gtp_ext_sac, tvb, offset, 2, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint16(tree, hf_gtp_ext_sac, tvb, offset, ENC_BIG_ENDIAN);
             break;
         case 2:
             /* Geographic Location field included and it holds the Routing
@@ -5732,9 +5787,9 @@ gchar *dissect_radius_user_loc(proto_tree * tree, tvbuff_t * tvb, packet_info* p
              */
             dissect_e212_mcc_mnc(tvb, pinfo, tree, offset, E212_RAI, TRUE);
             offset+=3;
-            proto_tree_add_item(tree, hf_gtp_rai_lac, tvb, offset, 2, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint16(tree, hf_gtp_rai_lac, tvb, offset, ENC_BIG_ENDIAN);
             offset+=2;
-            proto_tree_add_item(tree, hf_gtp_rai_rac, tvb, offset, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(tree, hf_gtp_rai_rac, tvb, offset, ENC_BIG_ENDIAN);
             break;
         case 128:
             /* Geographic Location field included and it holds the Tracking
@@ -5743,7 +5798,7 @@ gchar *dissect_radius_user_loc(proto_tree * tree, tvbuff_t * tvb, packet_info* p
              */
             dissect_e212_mcc_mnc(tvb, pinfo, tree, offset, E212_NONE, TRUE);
             offset+=3;
-            proto_tree_add_item(tree, hf_gtp_tac, tvb, offset, 2, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint16(tree, hf_gtp_tac, tvb, offset, ENC_BIG_ENDIAN);
             break;
         case 129:
             /* Geographic Location field included and it holds the E-UTRAN Cell
@@ -5752,7 +5807,7 @@ gchar *dissect_radius_user_loc(proto_tree * tree, tvbuff_t * tvb, packet_info* p
              */
             dissect_e212_mcc_mnc(tvb, pinfo, tree, offset, E212_NONE, TRUE);
             offset+=3;
-            proto_tree_add_item(tree, hf_gtp_eci, tvb, offset, 4, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint32(tree, hf_gtp_eci, tvb, offset, ENC_BIG_ENDIAN);
             break;
         case 130:
             /* Geographic Location field included and it holds the Tracking
@@ -5763,11 +5818,11 @@ gchar *dissect_radius_user_loc(proto_tree * tree, tvbuff_t * tvb, packet_info* p
              */
             dissect_e212_mcc_mnc(tvb, pinfo, tree, offset, E212_NONE, TRUE);
             offset+=3;
-            proto_tree_add_item(tree, hf_gtp_tac, tvb, offset, 2, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint16(tree, hf_gtp_tac, tvb, offset, ENC_BIG_ENDIAN);
             offset += 2;
             dissect_e212_mcc_mnc(tvb, pinfo, tree, offset, E212_NONE, TRUE);
             offset+=3;
-            proto_tree_add_item(tree, hf_gtp_eci, tvb, offset, 4, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint32(tree, hf_gtp_eci, tvb, offset, ENC_BIG_ENDIAN);
             break;
         default:
             proto_tree_add_text(tree, tvb, offset, length - 1, "Unknown Location type data");
@@ -5794,11 +5849,11 @@ decode_gtp_usr_loc_inf(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tr
                 val_to_str_ext_const(GTP_EXT_USR_LOC_INF, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     /* Geographic Location Type */
-    proto_tree_add_item(ext_tree, hf_gtp_ext_geo_loc_type, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ext_geo_loc_type, tvb, offset, ENC_BIG_ENDIAN);
     geo_loc_type = tvb_get_guint8(tvb, offset);
     offset++;
 
@@ -5819,7 +5874,7 @@ decode_gtp_usr_loc_inf(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tr
             /* Use gsm_a's function to dissect Geographic Location by faking disc ( last 4) */
             be_cell_id_aux(tvb, ext_tree, pinfo, offset, length - 1, NULL, 0, 4);
             offset = offset + 5;
-            proto_tree_add_item(ext_tree, hf_gtp_ext_sac, tvb, offset, 2, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_sac, tvb, offset, ENC_BIG_ENDIAN);
             break;
         case 2:
             /* Geographic Location field included and it holds the Routing
@@ -5831,9 +5886,9 @@ decode_gtp_usr_loc_inf(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tr
 
             dissect_e212_mcc_mnc(tvb, pinfo, rai_tree, offset, E212_RAI, TRUE);
             offset+=3;
-            proto_tree_add_item(rai_tree, hf_gtp_rai_lac, tvb, offset, 2, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint16(rai_tree, hf_gtp_rai_lac, tvb, offset, ENC_BIG_ENDIAN);
             offset+=2;
-            proto_tree_add_item(rai_tree, hf_gtp_rai_rac, tvb, offset, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(rai_tree, hf_gtp_rai_rac, tvb, offset, ENC_BIG_ENDIAN);
             break;
         default:
             proto_tree_add_text(tree, tvb, offset, length - 1, "Unknown Location type data");
@@ -5876,7 +5931,7 @@ decode_gtp_ms_time_zone(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, pro
                     "%s: ", val_to_str_ext_const(GTP_EXT_MS_TIME_ZONE, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     /* 3GPP TS 23.040 version 6.6.0 Release 6
@@ -5923,7 +5978,7 @@ decode_gtp_imeisv(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tre
                         val_to_str_ext_const(GTP_EXT_IMEISV, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_imeisv, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_imeisv, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     /* IMEI(SV)
@@ -5957,7 +6012,7 @@ decode_gtp_camel_chg_inf_con(tvbuff_t * tvb, int offset, packet_info * pinfo _U_
                     val_to_str_ext_const(GTP_EXT_CAMEL_CHG_INF_CON, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -5982,7 +6037,7 @@ decode_gtp_mbms_ue_ctx(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, prot
                 val_to_str_ext_const(GTP_EXT_MBMS_UE_CTX, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6013,7 +6068,7 @@ decode_gtp_tmgi(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree * tr
                 val_to_str_ext_const(GTP_EXT_TMGI, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     ti = proto_tree_add_item(ext_tree, hf_gtp_tmgi, tvb, offset, length, ENC_NA);
@@ -6041,7 +6096,7 @@ decode_gtp_rim_ra(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tre
                             val_to_str_ext_const(GTP_EXT_RIM_RA, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* To dissect the Address the Routing Address discriminator must be known */
     /*
@@ -6069,7 +6124,7 @@ decode_gtp_mbms_prot_conf_opt(tvbuff_t * tvb, int offset, packet_info * pinfo _U
                     val_to_str_ext_const(GTP_EXT_MBMS_PROT_CONF_OPT, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6089,8 +6144,8 @@ dissect_gtp_mbms_ses_dur(tvbuff_t * tvb, packet_info * pinfo _U_, proto_tree * t
 
     int offset = 0;
 
-    proto_tree_add_item(tree, hf_gtp_mbms_ses_dur_days, tvb, offset, 3, ENC_BIG_ENDIAN);
-    proto_tree_add_item(tree, hf_gtp_mbms_ses_dur_s,    tvb, offset, 3, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint24(tree, hf_gtp_mbms_ses_dur_days, tvb, offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint24(tree, hf_gtp_mbms_ses_dur_s,    tvb, offset, ENC_BIG_ENDIAN);
 
     return 3;
 
@@ -6108,7 +6163,7 @@ decode_gtp_mbms_ses_dur(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, pro
                 val_to_str_ext_const(GTP_EXT_MBMS_SES_DUR, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* The MBMS Session Duration is defined in 3GPP TS 23.246 [26].
      * The MBMS Session Duration information element indicates the estimated
@@ -6124,8 +6179,8 @@ decode_gtp_mbms_ses_dur(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, pro
      * for which the maximum allowed value is 18 days. For the whole session duration the seconds
      * and days are added together and the maximum session duration is 19 days.
      */
-    proto_tree_add_item(ext_tree, hf_gtp_mbms_ses_dur_days, tvb, offset, 3, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree, hf_gtp_mbms_ses_dur_s, tvb, offset, 3, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint24(ext_tree, hf_gtp_mbms_ses_dur_days, tvb, offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint24(ext_tree, hf_gtp_mbms_ses_dur_s, tvb, offset, ENC_BIG_ENDIAN);
 
     return 3 + length;
 
@@ -6162,7 +6217,7 @@ dissect_gtp_3gpp_mbms_service_area(tvbuff_t *tvb, packet_info *pinfo _U_, proto_
      * The length of an MBMS service area code is 2 octets.
      */
     for (i = 0; i < no_of_mbms_sa_codes; i++) {
-        proto_tree_add_item(tree, hf_gtp_mbms_sa_code, tvb, offset, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(tree, hf_gtp_mbms_sa_code, tvb, offset, ENC_BIG_ENDIAN);
         offset = offset + 2;
     }
 
@@ -6182,7 +6237,7 @@ decode_gtp_mbms_sa(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree *
                 val_to_str_ext_const(GTP_EXT_MBMS_SA, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     next_tvb = tvb_new_subset_length(tvb, offset, length-3);
     dissect_gtp_3gpp_mbms_service_area(next_tvb, pinfo, ext_tree, NULL);
@@ -6207,7 +6262,7 @@ decode_gtp_src_rnc_pdp_ctx_inf(tvbuff_t * tvb, int offset, packet_info * pinfo _
                     val_to_str_ext_const(GTP_EXT_SRC_RNC_PDP_CTX_INF, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6232,7 +6287,7 @@ decode_gtp_add_trs_inf(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, prot
                     val_to_str_ext_const(GTP_EXT_ADD_TRS_INF, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6257,7 +6312,7 @@ decode_gtp_hop_count(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
                 val_to_str_ext_const(GTP_EXT_HOP_COUNT, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6282,7 +6337,7 @@ decode_gtp_sel_plmn_id(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tr
                                 val_to_str_ext_const(GTP_EXT_SEL_PLMN_ID, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     dissect_e212_mcc_mnc(tvb, pinfo, ext_tree, offset, E212_NONE, FALSE);
@@ -6305,7 +6360,7 @@ decode_gtp_mbms_ses_id(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, prot
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_MBMS_SES_ID], NULL, val_to_str_ext_const(GTP_EXT_MBMS_SES_ID, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6337,10 +6392,10 @@ decode_gtp_mbms_2g_3g_ind(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, p
                 val_to_str_ext_const(GTP_EXT_MBMS_2G_3G_IND, &gtp_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* MBMS 2G/3G Indicator */
-    proto_tree_add_item(ext_tree, hf_gtp_mbs_2g_3g_ind, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_mbs_2g_3g_ind, tvb, offset, ENC_BIG_ENDIAN);
 
     return 3 + length;
 
@@ -6361,7 +6416,7 @@ decode_gtp_enh_nsapi(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_ENH_NSAPI], NULL, val_to_str_ext_const(GTP_EXT_ENH_NSAPI, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6386,7 +6441,7 @@ decode_gtp_add_mbms_trs_inf(tvbuff_t * tvb, int offset, packet_info * pinfo _U_,
                             val_to_str_ext_const(GTP_EXT_ADD_MBMS_TRS_INF, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6411,7 +6466,7 @@ decode_gtp_mbms_ses_id_rep_no(tvbuff_t * tvb, int offset, packet_info * pinfo _U
                                         val_to_str_ext_const(GTP_EXT_MBMS_SES_ID_REP_NO, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6452,7 +6507,7 @@ decode_gtp_mbms_time_to_data_tr(tvbuff_t * tvb, int offset, packet_info * pinfo
                         val_to_str_ext_const(GTP_EXT_MBMS_TIME_TO_DATA_TR, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data
      * The MBMS Time To Data Transfer is defined in 3GPP TS 23.246 [26].
@@ -6495,7 +6550,7 @@ decode_gtp_ps_ho_req_ctx(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, pr
                 val_to_str_ext_const(GTP_EXT_PS_HO_REQ_CTX, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6520,7 +6575,7 @@ decode_gtp_bss_cont(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_t
                     val_to_str_ext_const(GTP_EXT_BSS_CONT, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6548,7 +6603,7 @@ decode_gtp_cell_id(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tr
                                 val_to_str_ext_const(GTP_EXT_CELL_ID, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6580,7 +6635,7 @@ decode_gtp_pdu_no(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tre
                                             val_to_str_ext_const(GTP_EXT_PDU_NO, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6605,13 +6660,13 @@ decode_gtp_bssgp_cause(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, prot
                                         val_to_str_ext_const(GTP_EXT_BSSGP_CAUSE, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     /*
      * The BSSGP Cause information element contains the cause as defined in 3GPP TS 48.018
      */
-    proto_tree_add_item(ext_tree, hf_gtp_bssgp_cause, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_bssgp_cause, tvb, offset, ENC_BIG_ENDIAN);
 
     return 3 + length;
 
@@ -6631,7 +6686,7 @@ decode_gtp_mbms_bearer_cap(tvbuff_t * tvb, int offset, packet_info * pinfo _U_,
                                     val_to_str_ext_const(GTP_EXT_REQ_MBMS_BEARER_CAP, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
 #if 0 /* Fix Dead Store Warning */
     offset = offset + 2;
 #endif
@@ -6666,13 +6721,13 @@ decode_gtp_rim_ra_disc(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, prot
                                 val_to_str_ext_const(GTP_EXT_RIM_ROUTING_ADDR_DISC, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* Octet 4 bits 4 - 1 is coded according to 3GPP TS 48.018 [20]
      * RIM Routing Information IE octet 3 bits 4 - 1.
      * Bits 8 - 5 are coded "0000".
      */
-    proto_tree_add_item(ext_tree, hf_gtp_bssgp_ra_discriminator, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_bssgp_ra_discriminator, tvb, offset, ENC_BIG_ENDIAN);
 
     return 3 + length;
 
@@ -6692,7 +6747,7 @@ decode_gtp_lst_set_up_pfc(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, p
                                         val_to_str_ext_const(GTP_EXT_LIST_OF_SETUP_PFCS, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6718,7 +6773,7 @@ decode_gtp_ps_handover_xid(tvbuff_t * tvb, int offset, packet_info * pinfo, prot
                                         val_to_str_ext_const(GTP_EXT_PS_HANDOVER_XIP_PAR, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     sapi = tvb_get_guint8(tvb, offset) & 0x0F;
@@ -6754,7 +6809,7 @@ decode_gtp_ms_inf_chg_rep_act(tvbuff_t * tvb, int offset, packet_info * pinfo _U
                                         val_to_str_ext_const(GTP_EXT_MS_INF_CHG_REP_ACT, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6777,13 +6832,13 @@ decode_gtp_direct_tnl_flg(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, p
                                         val_to_str_ext_const(GTP_EXT_DIRECT_TUNNEL_FLGS, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
 
     /* TODO add decoding of data */
-    proto_tree_add_item(ext_tree, hf_gtp_ext_ei,   tvb, offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree, hf_gtp_ext_gcsi, tvb, offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree, hf_gtp_ext_dti,  tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ext_ei,   tvb, offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ext_gcsi, tvb, offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ext_dti,  tvb, offset, ENC_BIG_ENDIAN);
     offset++;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6806,7 +6861,7 @@ decode_gtp_corrl_id(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_t
                     val_to_str_ext_const(GTP_EXT_CORRELATION_ID, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
     /* TODO add decoding of data */
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6835,13 +6890,13 @@ decode_gtp_bearer_cntrl_mod(tvbuff_t * tvb, int offset, packet_info * pinfo _U_,
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length,  ett_gtp_ies[GTP_EXT_BEARER_CONTROL_MODE], NULL,
                                         val_to_str_ext_const(GTP_EXT_BEARER_CONTROL_MODE, &gtpv1_val_ext, "Unknown"));
 
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
-    proto_tree_add_item(ext_tree, hf_gtp_bcm, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_bcm, tvb, offset, ENC_BIG_ENDIAN);
 
     return 3 + length;
 
@@ -6859,10 +6914,10 @@ decode_gtp_mbms_flow_id(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, pro
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_MBMS_FLOW_ID], NULL,
                                         val_to_str_ext_const(GTP_EXT_MBMS_FLOW_ID, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     /* 4-n MBMS Flow Identifier */
@@ -6885,10 +6940,10 @@ decode_gtp_mbms_ip_mcast_dist(tvbuff_t * tvb, int offset, packet_info * pinfo _U
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_MBMS_IP_MCAST_DIST], NULL,
                                     val_to_str_ext_const(GTP_EXT_MBMS_IP_MCAST_DIST, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6916,14 +6971,14 @@ decode_gtp_mbms_dist_ack(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, pr
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_MBMS_DIST_ACK], NULL,
                                     val_to_str_ext_const(GTP_EXT_MBMS_DIST_ACK, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     /* Distribution Indication values */
-    proto_tree_add_item(ext_tree, hf_gtp_mbms_dist_indic, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_mbms_dist_indic, tvb, offset, ENC_BIG_ENDIAN);
 
     return 3 + length;
 }
@@ -6940,10 +6995,10 @@ decode_gtp_reliable_irat_ho_inf(tvbuff_t * tvb, int offset, packet_info * pinfo
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_RELIABLE_IRAT_HO_INF], NULL,
                                         val_to_str_ext_const(GTP_EXT_RELIABLE_IRAT_HO_INF, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -6963,10 +7018,10 @@ decode_gtp_rfsp_index(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_RFSP_INDEX], NULL,
                                         val_to_str_ext_const(GTP_EXT_RFSP_INDEX, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     rfsp = tvb_get_ntohs(tvb, offset);
@@ -6991,9 +7046,9 @@ decode_gtp_fqdn(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree
 
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, length + 3, ett_gtp_ies[GTP_EXT_FQDN], NULL,
                                     val_to_str_ext_const(GTP_EXT_FQDN, &gtp_val_ext, "Unknown field"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
-    proto_tree_add_item(ext_tree, hf_gtp_fqdn_length, tvb, offset + 1, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_fqdn_length, tvb, offset + 1, ENC_BIG_ENDIAN);
     decode_fqdn(tvb, offset + 3, length, ext_tree);
 
     return 3 + length;
@@ -7012,14 +7067,14 @@ decode_gtp_evolved_allc_rtn_p1(tvbuff_t * tvb, int offset, packet_info * pinfo _
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_EVO_ALLO_RETE_P1], NULL,
                                         val_to_str_ext_const(GTP_EXT_EVO_ALLO_RETE_P1, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id,      tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id,      tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
 
     proto_tree_add_item(ext_tree, hf_gtp_earp_pvi,   tvb, offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree, hf_gtp_earp_pl,    tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_earp_pl,    tvb, offset, ENC_BIG_ENDIAN);
     proto_tree_add_item(ext_tree, hf_gtp_earp_pci,   tvb, offset, 1, ENC_BIG_ENDIAN);
 
     return 3 + length;
@@ -7040,17 +7095,17 @@ decode_gtp_evolved_allc_rtn_p2(tvbuff_t * tvb, int offset, packet_info * pinfo _
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_EVO_ALLO_RETE_P2], NULL,
                                         val_to_str_ext_const(GTP_EXT_EVO_ALLO_RETE_P2, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
-    proto_tree_add_item(ext_tree, hf_gtp_nsapi, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_nsapi, tvb, offset, ENC_BIG_ENDIAN);
     offset++;
 
     proto_tree_add_item(ext_tree, hf_gtp_earp_pvi, tvb, offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree, hf_gtp_earp_pl,  tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_earp_pl,  tvb, offset, ENC_BIG_ENDIAN);
     proto_tree_add_item(ext_tree, hf_gtp_earp_pci, tvb, offset, 1, ENC_BIG_ENDIAN);
 
     return 3 + length;
@@ -7070,10 +7125,10 @@ decode_gtp_extended_common_flgs(tvbuff_t * tvb, int offset, packet_info * pinfo
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_EXTENDED_COMMON_FLGS], NULL,
                                         val_to_str_ext_const(GTP_EXT_EXTENDED_COMMON_FLGS, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7093,10 +7148,10 @@ decode_gtp_uci(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_UCI], NULL,
                                         val_to_str_ext_const(GTP_EXT_UCI, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7117,10 +7172,10 @@ decode_gtp_csg_inf_rep_act(tvbuff_t * tvb, int offset, packet_info * pinfo _U_,
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_CSG_INF_REP_ACT], NULL,
                                             val_to_str_ext_const(GTP_EXT_CSG_INF_REP_ACT, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id,      tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id,      tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7140,10 +7195,10 @@ decode_gtp_csg_id(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tre
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_CSG_ID], NULL,
                                             val_to_str_ext_const(GTP_EXT_CSG_ID, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7162,10 +7217,10 @@ decode_gtp_cmi(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tree *
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_CMI], NULL,
                                         val_to_str_ext_const(GTP_EXT_CMI, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7185,10 +7240,10 @@ decode_gtp_apn_ambr(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_t
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_RELIABLE_IRAT_HO_INF], NULL,
                                         val_to_str_ext_const(GTP_EXT_AMBR, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     /* APN Aggregate Maximum Bit Rate (APN-AMBR) is defined in clause 9.9.4.2 of 3GPP TS 24.301 [42], but shall be
@@ -7218,7 +7273,7 @@ decode_gtp_ue_network_cap(tvbuff_t * tvb, int offset, packet_info * pinfo, proto
                                         val_to_str_ext_const(GTP_EXT_UE_NETWORK_CAP, &gtpv1_val_ext, "Unknown"));
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     de_emm_ue_net_cap(tvb, ext_tree, pinfo, offset, length, NULL, 0);
@@ -7239,10 +7294,10 @@ decode_gtp_ue_ambr(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tr
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_APN_AMBR_WITH_NSAPI], NULL,
                                         val_to_str_ext_const(GTP_EXT_APN_AMBR_WITH_NSAPI, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
     /* 4 to 7 Subscribed UE-AMBR for Uplink */
@@ -7287,13 +7342,13 @@ decode_gtp_apn_ambr_with_nsapi(tvbuff_t * tvb, int offset, packet_info * pinfo _
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_UE_AMBR], NULL,
                                         val_to_str_ext_const(GTP_EXT_UE_AMBR, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
-    proto_tree_add_item(ext_tree, hf_gtp_nsapi, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_nsapi, tvb, offset + 1, ENC_BIG_ENDIAN);
     offset++;
 
     /* 5 to 8 Authorized APN-AMBR for Uplink */
@@ -7329,15 +7384,15 @@ decode_gtp_ggsn_back_off_time(tvbuff_t * tvb, int offset, packet_info * pinfo _U
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_GGSN_BACK_OFF_TIME], NULL,
                                         val_to_str_ext_const(GTP_EXT_GGSN_BACK_OFF_TIME, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
 
     /* 4 Timer unit Timer value */
-    proto_tree_add_item(ext_tree, hf_gtp_ext_ggsn_back_off_time_units, tvb, offset, 2, ENC_BIG_ENDIAN);
-    proto_tree_add_item(ext_tree, hf_gtp_ext_ggsn_back_off_timer, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_ggsn_back_off_time_units, tvb, offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_ggsn_back_off_timer, tvb, offset, ENC_BIG_ENDIAN);
 
     return 3 + length;
 }
@@ -7355,10 +7410,10 @@ decode_gtp_sig_pri_ind(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, prot
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_SIG_PRI_IND], NULL,
                                     val_to_str_ext_const(GTP_EXT_SIG_PRI_IND, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7378,10 +7433,10 @@ decode_gtp_sig_pri_ind_w_nsapi(tvbuff_t * tvb, int offset, packet_info * pinfo _
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_SIG_PRI_IND_W_NSAPI], NULL,
                                             val_to_str_ext_const(GTP_EXT_SIG_PRI_IND_W_NSAPI, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7406,14 +7461,14 @@ decode_gtp_higher_br_16mb_flg(tvbuff_t * tvb, int offset, packet_info * pinfo _U
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_HIGHER_BR_16MB_FLG], NULL,
                                           val_to_str_ext_const(GTP_EXT_HIGHER_BR_16MB_FLG, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
 
     /* Higher bitrates than 16 Mbps flag */
-    proto_tree_add_item(ext_tree, hf_gtp_higher_br_16mb_flg, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_higher_br_16mb_flg, tvb, offset, ENC_BIG_ENDIAN);
 
     return 3 + length;
 }
@@ -7432,10 +7487,10 @@ decode_gtp_max_mbr_apn_ambr(tvbuff_t * tvb, int offset, packet_info * pinfo _U_,
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_MAX_MBR_APN_AMBR], NULL,
                                     val_to_str_ext_const(GTP_EXT_MAX_MBR_APN_AMBR, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset = offset + 2;
 
         /* Max MBR/APN-AMBR for uplink */
@@ -7467,10 +7522,10 @@ decode_gtp_add_mm_ctx_srvcc(tvbuff_t * tvb, int offset, packet_info * pinfo _U_,
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_ADD_MM_CTX_SRVCC], NULL,
                                         val_to_str_ext_const(GTP_EXT_ADD_MM_CTX_SRVCC, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7491,10 +7546,10 @@ decode_gtp_add_flgs_srvcc(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, p
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_ADD_FLGS_SRVCC], NULL,
                                         val_to_str_ext_const(GTP_EXT_ADD_FLGS_SRVCC, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7513,10 +7568,10 @@ decode_gtp_stn_sr(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_tre
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_STN_SR], NULL,
                                         val_to_str_ext_const(GTP_EXT_STN_SR, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7537,10 +7592,10 @@ decode_gtp_c_msisdn(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_t
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_C_MSISDN], NULL,
                                         val_to_str_ext_const(GTP_EXT_C_MSISDN, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7559,10 +7614,10 @@ decode_gtp_ext_ranap_cause(tvbuff_t * tvb, int offset, packet_info * pinfo _U_,
     length = tvb_get_ntohs(tvb, offset + 1);
     ext_tree = proto_tree_add_subtree(tree, tvb, offset, 3 + length, ett_gtp_ies[GTP_EXT_EXT_RANAP_CAUSE], NULL,
                                         val_to_str_ext_const(GTP_EXT_EXT_RANAP_CAUSE, &gtpv1_val_ext, "Unknown"));
-    proto_tree_add_item(ext_tree, hf_gtp_ie_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_ie_id, tvb, offset, ENC_BIG_ENDIAN);
 
     offset++;
-    proto_tree_add_item(ext_tree, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
 
     proto_tree_add_expert(ext_tree, pinfo, &ei_gtp_undecoded, tvb, offset, length);
@@ -7660,12 +7715,12 @@ decode_gtp_data_req(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree
 
     /* Octet 4 Number of Data Records */
     no = tvb_get_guint8(tvb, offset);
-    proto_tree_add_item(ext_tree, hf_gtp_number_of_data_records, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ext_tree, hf_gtp_number_of_data_records, tvb, offset, ENC_BIG_ENDIAN);
     offset++;
 
     /* Octet 5 Data Record Format */
     format   = tvb_get_guint8(tvb, offset);
-    fmt_item = proto_tree_add_item(ext_tree, hf_gtp_data_record_format, tvb, offset, 1, ENC_BIG_ENDIAN);
+    fmt_item = proto_tree_add_item_uint8(ext_tree, hf_gtp_data_record_format, tvb, offset, ENC_BIG_ENDIAN);
     offset++;
     /* The value range is 1-255 in decimal. The value '0' should not be used.
      * Only the values 1-10 and 51-255 can be used for standards purposes.
@@ -7695,10 +7750,10 @@ decode_gtp_data_req(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree
 
         ver_tree = proto_tree_add_subtree_format(ext_tree, tvb, offset, 2, ett_gtp_cdr_ver, NULL,
                                 "Data record format version: AppId %u Rel %u.%u.0", app_id,rel_id,ver_id);
-        proto_tree_add_item(ver_tree, hf_gtp_cdr_app, tvb, offset, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(ver_tree, hf_gtp_cdr_rel, tvb, offset, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ver_tree, hf_gtp_cdr_app, tvb, offset, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ver_tree, hf_gtp_cdr_rel, tvb, offset, ENC_BIG_ENDIAN);
         offset++;
-        proto_tree_add_item(ver_tree, hf_gtp_cdr_ver, tvb, offset, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(ver_tree, hf_gtp_cdr_ver, tvb, offset, ENC_BIG_ENDIAN);
         offset++;
         for(i = 0; i < no; ++i) {
             cdr_length = tvb_get_ntohs(tvb, offset);
@@ -7782,11 +7837,11 @@ decode_gtp_node_addr(tvbuff_t * tvb, int offset, packet_info * pinfo _U_, proto_
     ext_tree_node_addr = proto_tree_add_subtree(tree, tvb, offset, 3 + length,
                                 ett_gtp_node_addr, &te, "Node address: ");
 
-    proto_tree_add_item(ext_tree_node_addr, hf_gtp_node_address_length, tvb, offset + 1, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_node_addr, hf_gtp_node_address_length, tvb, offset + 1, ENC_BIG_ENDIAN);
 
     switch (length) {
     case 4:
-        proto_tree_add_item(ext_tree_node_addr, hf_gtp_node_ipv4, tvb, offset + 3, 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_ipv4(ext_tree_node_addr, hf_gtp_node_ipv4, tvb, offset + 3, ENC_BIG_ENDIAN);
         proto_item_append_text(te, "%s", tvb_ip_to_str(tvb, offset + 3));
         break;
     case 16:
@@ -7821,7 +7876,7 @@ decode_gtp_priv_ext(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree
 
     offset++;
     length = tvb_get_ntohs(tvb, offset);
-    proto_tree_add_item(ext_tree_priv_ext, hf_gtp_ext_length, tvb, offset, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(ext_tree_priv_ext, hf_gtp_ext_length, tvb, offset, ENC_BIG_ENDIAN);
     offset += 2;
     if (length >= 2) {
         ext_id = tvb_get_ntohs(tvb, offset);
@@ -7871,7 +7926,8 @@ dissect_gtp_common(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree)
     guint8           control_field;
     gtp_msg_hash_t  *gcrp             = NULL;
     conversation_t  *conversation;
-    gtp_conv_info_t *gtp_info;
+    gtp_conv_info_t *gtp_info         = NULL;
+    const gtp_teid_session_t *session;
 
     /* Do we have enough bytes for the version and message type? */
     if (!tvb_bytes_exist(tvb, 0, 2)) {
@@ -7901,27 +7957,34 @@ dissect_gtp_common(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree)
     col_clear(pinfo->cinfo, COL_INFO);
 
     /*
-    * Do we have a conversation for this connection?
-    */
-    conversation = find_or_create_conversation(pinfo);
+     * The conversation is only used to match requests with responses,
+     * so don't look it up for user plane T-PDUs, which are most of the
+     * traffic in a capture of the user plane.
+     */
+    if (octet != GTP_MSG_TPDU) {
+        /*
+        * Do we have a conversation for this connection?
+        */
+        conversation = find_or_create_conversation(pinfo);
 
-    /*
-    * Do we already know this conversation?
-    */
-    gtp_info = (gtp_conv_info_t *)conversation_get_proto_data(conversation, proto_gtp);
-    if (gtp_info == NULL) {
-        /* No.  Attach that information to the conversation, and add
-        * it to the list of information structures.
+        /*
+        * Do we already know this conversation?
         */
-        gtp_info = (gtp_conv_info_t *)g_malloc(sizeof(gtp_conv_info_t));
-        /*Request/response matching tables*/
-        gtp_info->matched = g_hash_table_new(gtp_sn_hash, gtp_sn_equal_matched);
-        gtp_info->unmatched = g_hash_table_new(gtp_sn_hash, gtp_sn_equal_unmatched);
+        gtp_info = (gtp_conv_info_t *)conversation_get_proto_data(conversation, proto_gtp);
+        if (gtp_info == NULL) {
+            /* No.  Attach that information to the conversation, and add
+            * it to the list of information structures.
+            */
+            gtp_info = (gtp_conv_info_t *)g_malloc(sizeof(gtp_conv_info_t));
+            /*Request/response matching tables*/
+            gtp_info->matched = g_hash_table_new(gtp_sn_hash, gtp_sn_equal_matched);
+            gtp_info->unmatched = g_hash_table_new(gtp_sn_hash, gtp_sn_equal_unmatched);
 
-        conversation_add_proto_data(conversation, proto_gtp, gtp_info);
+            conversation_add_proto_data(conversation, proto_gtp, gtp_info);
 
-        gtp_info->next = gtp_info_items;
-        gtp_info_items = gtp_info;
+            gtp_info->next = gtp_info_items;
+            gtp_info_items = gtp_info;
+        }
     }
 
     gtp_hdr->flags = tvb_get_guint8(tvb, offset);
@@ -8056,7 +8119,7 @@ dissect_gtp_common(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree)
             break;
         case 1:
             gtp_hdr->teid = tvb_get_ntohl(tvb, offset);
-            proto_tree_add_item(gtp_tree, hf_gtp_teid, tvb, offset, 4, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint32(gtp_tree, hf_gtp_teid, tvb, offset, ENC_BIG_ENDIAN);
             offset += 4;
 
             set_actual_length(tvb, offset + gtp_hdr->length);
@@ -8089,7 +8152,7 @@ dissect_gtp_common(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree)
                         ext_hdr_length = tvb_get_guint8(tvb, offset);
                         tf = proto_tree_add_item(gtp_tree, hf_gtp_ext_hdr, tvb, offset, ext_hdr_length*4, ENC_NA);
                         ext_tree = proto_item_add_subtree(tf, ett_gtp_ext_hdr);
-                        ext_hdr_len_item = proto_tree_add_item(ext_tree, hf_gtp_ext_hdr_length, tvb, offset,1, ENC_BIG_ENDIAN);
+                        ext_hdr_len_item = proto_tree_add_item_uint8(ext_tree, hf_gtp_ext_hdr_length, tvb, offset, ENC_BIG_ENDIAN);
                         if (ext_hdr_length == 0) {
                             expert_add_info_format(pinfo, ext_hdr_len_item, &ei_gtp_ext_length_mal,
                                                    "Extension header length is zero");
@@ -8123,7 +8186,7 @@ dissect_gtp_common(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree)
                                 proto_item* ext_item;
 
                                 ext_hdr_pdcpsn = tvb_get_ntohs(tvb, offset);
-                                ext_item = proto_tree_add_item(ext_tree, hf_gtp_ext_hdr_pdcpsn, tvb, offset, 2, ENC_BIG_ENDIAN);
+                                ext_item = proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_hdr_pdcpsn, tvb, offset, ENC_BIG_ENDIAN);
                                 if (ext_hdr_pdcpsn & 0x700) {
                                     expert_add_info(pinfo, ext_item, &ei_gtp_ext_hdr_pdcpsn);
                                 }
@@ -8143,7 +8206,7 @@ dissect_gtp_common(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree)
                              */
                             if (ext_hdr_length == 1) {
                                 /* UDP Port of source */
-                                proto_tree_add_item(ext_tree, hf_gtp_ext_hdr_udp_port, tvb, offset, 2, ENC_BIG_ENDIAN);
+                                proto_tree_add_item_uint16(ext_tree, hf_gtp_ext_hdr_udp_port, tvb, offset, ENC_BIG_ENDIAN);
                             } else {
                                 /* Bad length */
                                 expert_add_info_format(pinfo, ext_tree, &ei_gtp_ext_length_warn, "The length field for the UDP Port Extension header should be 1.");
@@ -8176,7 +8239,16 @@ dissect_gtp_common(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree)
         }
     }
 
+    /* The subscriber, if GTP-C has set up the TEID in the header */
+    session = NULL;
+    if (gtp_hdr->teid > 0)
+        session = gtp_teid_session_lookup((guint32)gtp_hdr->teid, pinfo->fd->num);
+
     if (gtp_hdr->message != GTP_MSG_TPDU) {
+        /* A response doesn't repeat the IMSI, but is sent to the
+         * control plane TEID the request set up */
+        gtp_msg_imsi = session ? session->imsi : NULL;
+
         /* Dissect IEs */
         mandatory = 0;      /* check order of GTP fields against ETSI */
         while (tvb_reported_length_remaining(tvb, offset) > 0) {
@@ -8217,6 +8289,9 @@ dissect_gtp_common(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree)
     }
     proto_item_set_end (ti, tvb, offset);
 
+    if (gtp_hdr->message == GTP_MSG_TPDU && session != NULL)
+        gtp_hdr->imsi = session->imsi;
+
     if ((gtp_hdr->message == GTP_MSG_TPDU) && dissect_tpdu_as == GTP_TPDU_AS_TPDU) {
         if(tvb_reported_length_remaining(tvb, offset) > 0){
             proto_tree_add_text(tree, tvb, offset, -1, "T-PDU Data %u bytes", tvb_reported_length_remaining(tvb, offset));
@@ -8328,6 +8403,9 @@ gtp_reinit(void)
     }
 
     gtp_info_items = NULL;
+
+    /* The old map went away with the old file scope */
+    gtp_teid_sessions = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
 }
 
 void
@@ -37,6 +37,7 @@ typedef struct _gtp_hdr {
   guint8 message; /* Message type */
   guint16 length; /* Length of header */
   gint64 teid; /* Tunnel End-point ID */
+  const gchar *imsi; /* For a T-PDU, the subscriber whose tunnel GTP-C set up with the TEID; NULL if not seen */
 } gtp_hdr_t;
 
 /* definitions of GTP messages */
@@ -298,7 +298,7 @@ static void process_header(tvbuff_t *tvb, int offset, int next_offset,
 			   packet_info *pinfo, proto_tree *tree,
 			   headers_t *eh_ptr, http_conv_t *conv_data,
 			   int http_type);
-static gint find_header_hf_value(tvbuff_t *tvb, int offset, guint header_len);
+static gint find_header_hf_value(const guchar *name, guint header_len);
 static gboolean check_auth_ntlmssp(proto_item *hdr_item, tvbuff_t *tvb,
 				   packet_info *pinfo, gchar *value);
 static gboolean check_auth_basic(proto_item *hdr_item, tvbuff_t *tvb,
@@ -529,6 +529,17 @@ http_stats_tree_init(stats_tree* st)
 	st_node_other = stats_tree_create_node(st, st_str_other, st_node_packets,FALSE);
 }
 
+/* Names the node for a response code, when it's first seen */
+static gchar *
+http_stats_tree_code_name(guint32 code, const void *data _U_)
+{
+	const gchar *str = try_val_to_str(code, vals_status_code);
+
+	if (str)
+		return g_strdup_printf("%u %s", code, str);
+	return g_strdup_printf("%u Unknown (%d)", code, code);
+}
+
 /* HTTP/Packet Counter stats packet function */
 static int
 http_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* edt _U_, const void* p)
@@ -537,7 +548,6 @@ http_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* e
 	guint i = v->response_code;
 	int resp_grp;
 	const gchar *resp_str;
-	gchar str[64];
 
 	tick_stat_node(st, st_str_packets, 0, FALSE);
 
@@ -566,9 +576,7 @@ http_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* e
 
 		tick_stat_node(st, resp_str, st_node_responses, FALSE);
 
-		g_snprintf(str, sizeof(str), "%u %s", i,
-			   val_to_str(i, vals_status_code, "Unknown (%d)"));
-		tick_stat_node(st, str, resp_grp, FALSE);
+		tick_stat_node_int(st, i, http_stats_tree_code_name, NULL, resp_grp, FALSE);
 	} else if (v->request_method) {
 		stats_tree_tick_pivot(st,st_node_requests,v->request_method);
 	} else {
@@ -2307,6 +2315,16 @@ static const header_info headers[] = {
 	{ "X-Forwarded-For", &hf_http_x_forwarded_for, HDR_NO_SPECIAL },
 };
 
+/* None of the names in headers[] is longer than this */
+#define MAX_KNOWN_HEADER_NAME_LEN	32
+
+/*
+ * Map from the lower-cased names in headers[] to their index + 1, so
+ * that each header line costs one lookup rather than a comparison with
+ * every known name.
+ */
+static GHashTable *header_info_hash = NULL;
+
 /*
  *
  */
@@ -2398,7 +2416,7 @@ process_header(tvbuff_t *tvb, int offset, int next_offset,
 	line_end_offset = offset + linelen;
 	header_len = colon_offset - offset;
 	header_name = wmem_strndup(wmem_packet_scope(), &line[0], header_len);
-	hf_index = find_header_hf_value(tvb, offset, header_len);
+	hf_index = find_header_hf_value(line, header_len);
 
 	/*
 	 * Skip whitespace after the colon.
@@ -2679,18 +2697,22 @@ process_header(tvbuff_t *tvb, int offset, int next_offset,
 
 /* Returns index of header tag in headers */
 static gint
-find_header_hf_value(tvbuff_t *tvb, int offset, guint header_len)
+find_header_hf_value(const guchar *name, guint header_len)
 {
+	gchar lower_name[MAX_KNOWN_HEADER_NAME_LEN + 1];
 	guint i;
 
-	for (i = 0; i < array_length(headers); i++) {
-		if (header_len == strlen(headers[i].name) &&
-			tvb_strncaseeql(tvb, offset,
-				    headers[i].name, header_len) == 0)
-			return i;
+	if (header_len > MAX_KNOWN_HEADER_NAME_LEN)
+		return -1;
+
+	for (i = 0; i < header_len; i++) {
+		if (name[i] == '\0')
+			return -1;
+		lower_name[i] = g_ascii_tolower(name[i]);
 	}
+	lower_name[header_len] = '\0';
 
-	return -1;
+	return GPOINTER_TO_INT(g_hash_table_lookup(header_info_hash, lower_name)) - 1;
 }
 
 /*
@@ -3243,6 +3265,7 @@ proto_register_http(void)
 	module_t *http_module;
 	expert_module_t* expert_http;
 	uat_t* headers_uat;
+	guint i;
 
 	proto_http = proto_register_protocol("Hypertext Transfer Protocol",
 	    "HTTP", "http");
@@ -3253,6 +3276,17 @@ proto_register_http(void)
 
 	http_handle = new_register_dissector("http", dissect_http, proto_http);
 
+	/*
+	 * There is no g_hash_table_destroy as the lifetime is the same as
+	 * the lifetime of Wireshark.
+	 */
+	header_info_hash = g_hash_table_new(g_str_hash, g_str_equal);
+	for (i = 0; i < array_length(headers); i++) {
+		g_assert(strlen(headers[i].name) <= MAX_KNOWN_HEADER_NAME_LEN);
+		g_hash_table_insert(header_info_hash,
+		    g_ascii_strdown(headers[i].name, -1), GINT_TO_POINTER(i + 1));
+	}
+
 	http_module = prefs_register_protocol(proto_http, reinit_http);
 	prefs_register_bool_preference(http_module, "desegment_headers",
 	    "Reassemble HTTP headers spanning multiple TCP segments",
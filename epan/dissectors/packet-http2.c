@@ -137,6 +137,12 @@ typedef struct {
 void proto_register_http2(void);
 void proto_reg_handoff_http2(void);
 
+/* Decompressed header fields are stored in the format given in
+   inflate_http2_header_block.  The same ones show up over and over
+   (e.g. on every gRPC call), so each distinct one is stored only once
+   per capture file and shared by all the frames that have it. */
+static wmem_map_t *http2_hdrcache_map = NULL;
+
 
 /* Heuristic dissection */
 static gboolean global_http2_heur = FALSE;
@@ -363,6 +369,38 @@ static const value_string http2_settings_vals[] = {
     { 0, NULL }
 };
 
+static guint
+http2_hdrcache_length(gconstpointer v)
+{
+    const guint8 *data = (const guint8 *)v;
+    guint32 namelen, valuelen;
+
+    namelen = pntoh32(data);
+    valuelen = pntoh32(data + 4 + namelen);
+
+    return 4 + namelen + 4 + valuelen;
+}
+
+static guint
+http2_hdrcache_hash(gconstpointer key)
+{
+    return wmem_strong_hash((const guint8 *)key, http2_hdrcache_length(key));
+}
+
+static gboolean
+http2_hdrcache_equal(gconstpointer lhs, gconstpointer rhs)
+{
+    guint len = http2_hdrcache_length(lhs);
+
+    return len == http2_hdrcache_length(rhs) && memcmp(lhs, rhs, len) == 0;
+}
+
+static void
+http2_init(void)
+{
+    http2_hdrcache_map = wmem_map_new(wmem_file_scope(), http2_hdrcache_hash, http2_hdrcache_equal);
+}
+
 static gboolean
 hd_inflate_del_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_, void *user_data)
 {
@@ -580,15 +618,13 @@ process_http2_header_repr_info(wmem_array_t *headers,
 
         if(header_repr_info->complete) {
             if(header_repr_info->type == HTTP2_HD_HEADER_TABLE_SIZE_UPDATE) {
-                http2_header_t *out;
-
-                out = wmem_new(wmem_file_scope(), http2_header_t);
+                http2_header_t out;
 
-                out->type = header_repr_info->type;
-                out->length = i - start;
-                out->table.header_table_size = header_repr_info->integer;
+                out.type = header_repr_info->type;
+                out.length = i - start;
+                out.table.header_table_size = header_repr_info->integer;
 
-                wmem_array_append(headers, out, 1);
+                wmem_array_append_one(headers, out);
 
                 reset_http2_header_repr_info(header_repr_info);
                 /* continue to decode header table size update or
@@ -668,17 +704,15 @@ inflate_http2_header_block(tvbuff_t *tvb, packet_info *pinfo, guint offset,
             rv -= process_http2_header_repr_info(headers, header_repr_info, headbuf - rv, rv);
 
             if(inflate_flags & NGHTTP2_HD_INFLATE_EMIT) {
-                char *str;
+                char *str, *cached;
                 guint32 len;
-                http2_header_t *out;
+                http2_header_t out;
 
-                out = wmem_new(wmem_file_scope(), http2_header_t);
+                out.type = header_repr_info->type;
+                out.length = rv;
+                out.table.data.index = header_repr_info->integer;
 
-                out->type = header_repr_info->type;
-                out->length = rv;
-                out->table.data.index = header_repr_info->integer;
-
-                out->table.data.datalen = (guint)(4 + nv.namelen + 4 + nv.valuelen);
+                out.table.data.datalen = (guint)(4 + nv.namelen + 4 + nv.valuelen);
 
                 /* Prepare buffer... with the following format
                    name length (uint32)
@@ -686,7 +720,7 @@ inflate_http2_header_block(tvbuff_t *tvb, packet_info *pinfo, guint offset,
                    value length (uint32)
                    value (string)
                 */
-                str = wmem_alloc_array(wmem_file_scope(), char, out->table.data.datalen);
+                str = wmem_alloc_array(wmem_packet_scope(), char, out.table.data.datalen);
 
                 /* nv.namelen and nv.valuelen are of size_t.  In order
                    to get length in 4 bytes, we have to copy it to
@@ -699,9 +733,16 @@ inflate_http2_header_block(tvbuff_t *tvb, packet_info *pinfo, guint offset,
                 phton32(&str[4 + nv.namelen], len);
                 memcpy(&str[4 + nv.namelen + 4], nv.value, nv.valuelen);
 
-                out->table.data.data = str;
+                cached = (char *)wmem_map_lookup(http2_hdrcache_map, str);
+
+                if(!cached) {
+                    cached = (char *)wmem_memdup(wmem_file_scope(), str, out.table.data.datalen);
+                    wmem_map_insert(http2_hdrcache_map, cached, cached);
+                }
+
+                out.table.data.data = cached;
 
-                wmem_array_append(headers, out, 1);
+                wmem_array_append_one(headers, out);
 
                 reset_http2_header_repr_info(header_repr_info);
             }
@@ -738,7 +779,6 @@ inflate_http2_header_block(tvbuff_t *tvb, packet_info *pinfo, guint offset,
     for(i = 0; i < wmem_array_get_count(headers); ++i) {
         http2_header_t *in;
         tvbuff_t *next_tvb;
-        char *str;
 
         in = (http2_header_t*)wmem_array_index(headers, i);
 
@@ -746,14 +786,11 @@ inflate_http2_header_block(tvbuff_t *tvb, packet_info *pinfo, guint offset,
             continue;
         }
 
-        str = (char *)g_malloc(in->table.data.datalen);
-        memcpy(str, in->table.data.data, in->table.data.datalen);
-
         header_len += in->table.data.datalen;
 
-        /* Now setup the tvb buffer to have the new data */
-        next_tvb = tvb_new_child_real_data(tvb, str, in->table.data.datalen, in->table.data.datalen);
-        tvb_set_free_cb(next_tvb, g_free);
+        /* Now setup the tvb buffer to have the new data; the cached
+           copy lives as long as the capture file, no need to copy it */
+        next_tvb = tvb_new_child_real_data(tvb, (const guint8 *)in->table.data.data, in->table.data.datalen, in->table.data.datalen);
         tvb_composite_append(header_tvb, next_tvb);
     }
 
@@ -1838,6 +1875,8 @@ proto_register_http2(void)
         &global_http2_heur);
 
     new_register_dissector("http2", dissect_http2, proto_http2);
+
+    register_init_routine(&http2_init);
 }
 
 void
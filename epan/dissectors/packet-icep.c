@@ -64,6 +64,7 @@ void proto_reg_handoff_icep(void);
 
 /* fixed values taken from the standard */
 static const guint8 icep_magic[] = { 'I', 'c', 'e', 'P' };
+static const heur_precheck_t icep_precheck = { 0, 0, icep_magic, 4 };
 #define ICEP_HEADER_SIZE                14
 #define ICEP_MIN_REPLY_SIZE              5
 #define ICEP_MIN_PARAMS_SIZE             6
@@ -1341,6 +1342,8 @@ void proto_reg_handoff_icep(void)
 
         heur_dissector_add("tcp", dissect_icep_tcp, proto_icep);
         heur_dissector_add("udp", dissect_icep_udp, proto_icep);
+        heur_dissector_set_precheck("tcp", dissect_icep_tcp, proto_icep, &icep_precheck);
+        heur_dissector_set_precheck("udp", dissect_icep_udp, proto_icep, &icep_precheck);
 
         icep_prefs_initialized = TRUE;
     }
@@ -845,7 +845,7 @@ dissect_ipopt_security(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
                            "%s (%u bytes)", optp->name, optlen);
   dissect_ipopt_type(tvb, curr_offset, field_tree, &IP_OPT_TYPES);
   curr_offset++;
-  tf_sub = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, curr_offset, 1, ENC_NA);
+  tf_sub = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, curr_offset, ENC_NA);
   if (optlen > IPOLEN_MAX)
     expert_add_info(pinfo, tf_sub, &ei_ip_opt_len_invalid);
   curr_offset++;
@@ -856,11 +856,11 @@ dissect_ipopt_security(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
     val = tvb_get_ntohs(tvb, curr_offset);
     if (try_val_to_str(val, secl_rfc791_vals)) {
       /* Dissect as RFC 791 */
-      proto_tree_add_item(field_tree, hf_ip_opt_sec_rfc791_sec,
-                          tvb, curr_offset, 2, ENC_BIG_ENDIAN);
+      proto_tree_add_item_uint16(field_tree, hf_ip_opt_sec_rfc791_sec,
+                                 tvb, curr_offset, ENC_BIG_ENDIAN);
       curr_offset += 2;
-      proto_tree_add_item(field_tree, hf_ip_opt_sec_rfc791_comp,
-                          tvb, curr_offset, 2, ENC_BIG_ENDIAN);
+      proto_tree_add_item_uint16(field_tree, hf_ip_opt_sec_rfc791_comp,
+                                 tvb, curr_offset, ENC_BIG_ENDIAN);
       curr_offset += 2;
       proto_tree_add_item(field_tree, hf_ip_opt_sec_rfc791_hr,
                           tvb, curr_offset, 2, ENC_ASCII|ENC_NA);
@@ -872,7 +872,7 @@ dissect_ipopt_security(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
   }
 
   /* Dissect as RFC 108 */
-  proto_tree_add_item(field_tree, hf_ip_opt_sec_cl, tvb, curr_offset, 1, ENC_BIG_ENDIAN);
+  proto_tree_add_item_uint8(field_tree, hf_ip_opt_sec_cl, tvb, curr_offset, ENC_BIG_ENDIAN);
   curr_offset++;
   if ((curr_offset - offset) >= optlen) {
     return;
@@ -912,11 +912,11 @@ dissect_ipopt_ext_security(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
                            *optp->subtree_index, NULL, "%s (%u bytes)", optp->name, optlen);
   dissect_ipopt_type(tvb, curr_offset, field_tree, &IP_OPT_TYPES);
   curr_offset++;
-  tf_sub = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, curr_offset, 1, ENC_NA);
+  tf_sub = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, curr_offset, ENC_NA);
   if (optlen > IPOLEN_MAX)
     expert_add_info(pinfo, tf_sub, &ei_ip_opt_len_invalid);
   curr_offset++;
-  proto_tree_add_item(field_tree, hf_ip_opt_ext_sec_add_sec_info_format_code, tvb, curr_offset, 1, ENC_BIG_ENDIAN);
+  proto_tree_add_item_uint8(field_tree, hf_ip_opt_ext_sec_add_sec_info_format_code, tvb, curr_offset, ENC_BIG_ENDIAN);
   curr_offset++;
   remaining = optlen - (curr_offset - offset);
   if (remaining > 0) {
@@ -959,19 +959,19 @@ dissect_ipopt_cipso(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
   field_tree = proto_tree_add_subtree_format(opt_tree, tvb, offset, optlen, *optp->subtree_index, &tf,
                            "%s (%u bytes)", optp->name, optlen);
   dissect_ipopt_type(tvb, offset, field_tree, &IP_OPT_TYPES);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, offset + 1, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, offset + 1, ENC_NA);
   if (optlen > IPOLEN_MAX)
     expert_add_info(pinfo, tf, &ei_ip_opt_len_invalid);
 
   offset += 2;
 
-  proto_tree_add_item(field_tree, hf_ip_cipso_doi, tvb, offset, 4, ENC_BIG_ENDIAN);
+  proto_tree_add_item_uint32(field_tree, hf_ip_cipso_doi, tvb, offset, ENC_BIG_ENDIAN);
   offset += 4;
 
   /* loop through all of the tags in the CIPSO option */
   while (offset < offset_max) {
     tagtype = tvb_get_guint8(tvb, offset);
-    tag_item = proto_tree_add_item(field_tree, hf_ip_cipso_tag_type, tvb, offset, 1, ENC_NA);
+    tag_item = proto_tree_add_item_uint8(field_tree, hf_ip_cipso_tag_type, tvb, offset, ENC_NA);
 
     if ((offset + 1) < offset_max)
       taglen = tvb_get_guint8(tvb, offset + 1);
@@ -994,7 +994,7 @@ dissect_ipopt_cipso(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
       /* skip past alignment octet */
       offset += 3;
 
-      proto_tree_add_item(field_tree, hf_ip_cipso_sensitivity_level, tvb, offset, 1, ENC_NA);
+      proto_tree_add_item_uint8(field_tree, hf_ip_cipso_sensitivity_level, tvb, offset, ENC_NA);
       offset += 1;
 
       if (taglen > 4) {
@@ -1059,7 +1059,7 @@ dissect_ipopt_cipso(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
       offset += 3;
 
       /* sensitivity level */
-      proto_tree_add_item(field_tree, hf_ip_cipso_sensitivity_level, tvb, offset, 1, ENC_NA);
+      proto_tree_add_item_uint8(field_tree, hf_ip_cipso_sensitivity_level, tvb, offset, ENC_NA);
       offset += 1;
 
       if (taglen > 4) {
@@ -1091,7 +1091,7 @@ dissect_ipopt_cipso(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
       offset += 3;
 
       /* sensitivity level */
-      proto_tree_add_item(field_tree, hf_ip_cipso_sensitivity_level, tvb, offset, 1, ENC_NA);
+      proto_tree_add_item_uint8(field_tree, hf_ip_cipso_sensitivity_level, tvb, offset, ENC_NA);
       offset += 1;
 
       if (taglen > 4) {
@@ -1189,11 +1189,11 @@ dissect_ipopt_route(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
   field_tree = proto_tree_add_subtree_format(opt_tree, tvb, offset, optlen, *optp->subtree_index, NULL,
                            "%s (%u bytes)", optp->name, optlen);
   dissect_ipopt_type(tvb, offset, field_tree, &IP_OPT_TYPES);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, offset + 1, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, offset + 1, ENC_NA);
   if (optlen > IPOLEN_MAX)
     expert_add_info(pinfo, tf, &ei_ip_opt_len_invalid);
   ptr = tvb_get_guint8(tvb, offset + 2);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_ptr, tvb, offset + 2, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_ptr, tvb, offset + 2, ENC_NA);
   if ((ptr < (optp->optlen + 1)) || (ptr & 3)) {
     if (ptr < (optp->optlen + 1)) {
       expert_add_info(pinfo, tf, &ei_ip_opt_ptr_before_address);
@@ -1268,11 +1268,11 @@ dissect_ipopt_record_route(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
   field_tree = proto_tree_add_subtree_format(opt_tree, tvb, offset, optlen, *optp->subtree_index, NULL,
                            "%s (%u bytes)", optp->name, optlen);
   dissect_ipopt_type(tvb, offset, field_tree, &IP_OPT_TYPES);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, offset + 1, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, offset + 1, ENC_NA);
   if (optlen > IPOLEN_MAX)
     expert_add_info(pinfo, tf, &ei_ip_opt_len_invalid);
   ptr = tvb_get_guint8(tvb, offset + 2);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_ptr, tvb, offset + 2, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_ptr, tvb, offset + 2, ENC_NA);
 
   if ((ptr < (optp->optlen + 1)) || (ptr & 3)) {
     if (ptr < (optp->optlen + 1)) {
@@ -1326,10 +1326,10 @@ dissect_ipopt_sid(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
   field_tree = proto_tree_add_subtree_format(opt_tree, tvb, offset, optlen, *optp->subtree_index, NULL,
                            "%s (%u bytes): %u", optp->name, optlen, tvb_get_ntohs(tvb, offset + 2));
   dissect_ipopt_type(tvb, offset, field_tree, &IP_OPT_TYPES);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, offset + 1, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, offset + 1, ENC_NA);
   if (optlen != (guint)optp->optlen)
     expert_add_info(pinfo, tf, &ei_ip_opt_len_invalid);
-  proto_tree_add_item(field_tree, hf_ip_opt_sid, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
+  proto_tree_add_item_uint16(field_tree, hf_ip_opt_sid, tvb, offset + 2, ENC_BIG_ENDIAN);
 }
 
 /* RFC 1063: MTU Probe and MTU Reply */
@@ -1344,10 +1344,10 @@ dissect_ipopt_mtu(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
   field_tree = proto_tree_add_subtree_format(opt_tree, tvb, offset, optlen, *optp->subtree_index, NULL,
                            "%s (%u bytes): %u", optp->name, optlen, tvb_get_ntohs(tvb, offset + 2));
   dissect_ipopt_type(tvb, offset, field_tree, &IP_OPT_TYPES);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, offset + 1, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, offset + 1, ENC_NA);
   if (optlen != (guint)optp->optlen)
     expert_add_info(pinfo, tf, &ei_ip_opt_len_invalid);
-  proto_tree_add_item(field_tree, hf_ip_opt_mtu, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
+  proto_tree_add_item_uint16(field_tree, hf_ip_opt_mtu, tvb, offset + 2, ENC_BIG_ENDIAN);
 }
 
 /* RFC 1393: Traceroute */
@@ -1362,14 +1362,14 @@ dissect_ipopt_tr(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
   field_tree = proto_tree_add_subtree_format(opt_tree, tvb, offset, optlen, *optp->subtree_index, NULL,
                            "%s (%u bytes)", optp->name, optlen);
   dissect_ipopt_type(tvb, offset, field_tree, &IP_OPT_TYPES);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, offset + 1, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, offset + 1, ENC_NA);
   if (optlen != (guint)optp->optlen)
     expert_add_info(pinfo, tf, &ei_ip_opt_len_invalid);
 
-  proto_tree_add_item(field_tree, hf_ip_opt_id_number, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
-  proto_tree_add_item(field_tree, hf_ip_opt_ohc, tvb, offset + 4, 2, ENC_BIG_ENDIAN);
-  proto_tree_add_item(field_tree, hf_ip_opt_rhc, tvb, offset + 6, 2, ENC_BIG_ENDIAN);
-  proto_tree_add_item(field_tree, hf_ip_opt_originator, tvb, offset + 8, 4, ENC_BIG_ENDIAN);
+  proto_tree_add_item_uint16(field_tree, hf_ip_opt_id_number, tvb, offset + 2, ENC_BIG_ENDIAN);
+  proto_tree_add_item_uint16(field_tree, hf_ip_opt_ohc, tvb, offset + 4, ENC_BIG_ENDIAN);
+  proto_tree_add_item_uint16(field_tree, hf_ip_opt_rhc, tvb, offset + 6, ENC_BIG_ENDIAN);
+  proto_tree_add_item_ipv4(field_tree, hf_ip_opt_originator, tvb, offset + 8, ENC_BIG_ENDIAN);
 }
 
 static const value_string ipopt_timestamp_flag_vals[] = {
@@ -1393,7 +1393,7 @@ dissect_ipopt_timestamp(const ip_tcp_opt *optp, tvbuff_t *tvb,
   field_tree = proto_tree_add_subtree_format(opt_tree, tvb, offset, optlen, *optp->subtree_index, NULL,
                            "%s (%u bytes)", optp->name, optlen);
   dissect_ipopt_type(tvb, offset, field_tree, &IP_OPT_TYPES);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, offset + 1, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, offset + 1, ENC_NA);
   if (optlen > IPOLEN_MAX)
     expert_add_info(pinfo, tf, &ei_ip_opt_len_invalid);
   optoffset += 2;   /* skip past type and length */
@@ -1409,9 +1409,9 @@ dissect_ipopt_timestamp(const ip_tcp_opt *optp, tvbuff_t *tvb,
   ptr--;    /* ptr is 1-origin */
 
   flg = tvb_get_guint8(tvb, offset + optoffset);
-  proto_tree_add_item(field_tree, hf_ip_opt_overflow, tvb, offset + optoffset, 1, ENC_NA);
+  proto_tree_add_item_uint8(field_tree, hf_ip_opt_overflow, tvb, offset + optoffset, ENC_NA);
   flg &= 0xF;
-  proto_tree_add_item(field_tree, hf_ip_opt_flag, tvb, offset + optoffset, 1, ENC_NA);
+  proto_tree_add_item_uint8(field_tree, hf_ip_opt_flag, tvb, offset + optoffset, ENC_NA);
   optoffset++;
   optlen--;
 
@@ -1427,7 +1427,7 @@ dissect_ipopt_timestamp(const ip_tcp_opt *optp, tvbuff_t *tvb,
       optoffset += 4;
       optlen -= 4;
 
-      proto_tree_add_item(field_tree, hf_ip_opt_time_stamp, tvb, offset + optoffset, 4, ENC_BIG_ENDIAN);
+      proto_tree_add_item_uint32(field_tree, hf_ip_opt_time_stamp, tvb, offset + optoffset, ENC_BIG_ENDIAN);
       optoffset += 4;
       optlen -= 4;
     } else {
@@ -1435,7 +1435,7 @@ dissect_ipopt_timestamp(const ip_tcp_opt *optp, tvbuff_t *tvb,
         proto_tree_add_expert(field_tree, pinfo, &ei_ip_subopt_too_long, tvb, offset + optoffset, optlen);
         break;
       }
-      proto_tree_add_item(field_tree, hf_ip_opt_time_stamp, tvb, offset + optoffset, 4, ENC_BIG_ENDIAN);
+      proto_tree_add_item_uint32(field_tree, hf_ip_opt_time_stamp, tvb, offset + optoffset, ENC_BIG_ENDIAN);
       optoffset += 4;
       optlen -= 4;
     }
@@ -1464,10 +1464,10 @@ dissect_ipopt_ra(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
                            rval_to_str(value, ra_rvals, "Unknown (%u)"),
                            value);
   dissect_ipopt_type(tvb, offset, field_tree, &IP_OPT_TYPES);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, offset + 1, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, offset + 1, ENC_NA);
   if (optlen != (guint)optp->optlen)
     expert_add_info(pinfo, tf, &ei_ip_opt_len_invalid);
-  proto_tree_add_item(field_tree, hf_ip_opt_ra, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
+  proto_tree_add_item_uint16(field_tree, hf_ip_opt_ra, tvb, offset + 2, ENC_BIG_ENDIAN);
 }
 
 /* RFC 1770: Selective Directed Broadcast */
@@ -1482,11 +1482,11 @@ dissect_ipopt_sdb(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
   field_tree = proto_tree_add_subtree_format(opt_tree, tvb, offset, optlen, *optp->subtree_index, NULL,
                            "%s (%u bytes)", optp->name, optlen);
   dissect_ipopt_type(tvb, offset, field_tree, &IP_OPT_TYPES);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, offset + 1, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, offset + 1, ENC_NA);
   if (optlen > IPOLEN_MAX)
     expert_add_info(pinfo, tf, &ei_ip_opt_len_invalid);
   for (offset += 2, optlen -= 2; optlen >= 4; offset += 4, optlen -= 4)
-    proto_tree_add_item(field_tree, hf_ip_opt_addr, tvb, offset, 4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_ipv4(field_tree, hf_ip_opt_addr, tvb, offset, ENC_BIG_ENDIAN);
 
   if (optlen > 0)
     proto_tree_add_item(field_tree, hf_ip_opt_padding, tvb, offset, optlen, ENC_NA);
@@ -1540,14 +1540,14 @@ dissect_ipopt_qs(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
                            function);
 
   dissect_ipopt_type(tvb, offset, field_tree, &IP_OPT_TYPES);
-  tf = proto_tree_add_item(field_tree, hf_ip_opt_len, tvb, offset + 1, 1, ENC_NA);
+  tf = proto_tree_add_item_uint8(field_tree, hf_ip_opt_len, tvb, offset + 1, ENC_NA);
   if (optlen != (guint)optp->optlen)
     expert_add_info(pinfo, tf, &ei_ip_opt_len_invalid);
-  proto_tree_add_item(field_tree, hf_ip_opt_qs_func, tvb, offset + 2, 1, ENC_NA);
+  proto_tree_add_item_uint8(field_tree, hf_ip_opt_qs_func, tvb, offset + 2, ENC_NA);
 
   if (function == QS_RATE_REQUEST) {
-    proto_tree_add_item(field_tree, hf_ip_opt_qs_rate, tvb, offset + 2, 1, ENC_NA);
-    proto_tree_add_item(field_tree, hf_ip_opt_qs_ttl, tvb, offset + 3, 1, ENC_NA);
+    proto_tree_add_item_uint8(field_tree, hf_ip_opt_qs_rate, tvb, offset + 2, ENC_NA);
+    proto_tree_add_item_uint8(field_tree, hf_ip_opt_qs_ttl, tvb, offset + 3, ENC_NA);
     ttl_diff = (iph->ip_ttl - tvb_get_guint8(tvb, offset + 3) % 256);
     ti = proto_tree_add_uint_format_value(field_tree, hf_ip_opt_qs_ttl_diff,
                                           tvb, offset + 3, 1, ttl_diff,
@@ -1556,15 +1556,15 @@ dissect_ipopt_qs(const ip_tcp_opt *optp, tvbuff_t *tvb, int offset,
     proto_item_append_text(tf, ", %s, QS TTL %u, QS TTL diff %u",
                            val_to_str_ext(rate, &qs_rate_vals_ext, "Unknown (%u)"),
                            tvb_get_guint8(tvb, offset + 3), ttl_diff);
-    proto_tree_add_item(field_tree, hf_ip_opt_qs_nonce, tvb, offset + 4, 4, ENC_BIG_ENDIAN);
-    proto_tree_add_item(field_tree, hf_ip_opt_qs_reserved, tvb, offset + 4, 4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint32(field_tree, hf_ip_opt_qs_nonce, tvb, offset + 4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint32(field_tree, hf_ip_opt_qs_reserved, tvb, offset + 4, ENC_BIG_ENDIAN);
   } else if (function == QS_RATE_REPORT) {
-    proto_tree_add_item(field_tree, hf_ip_opt_qs_rate, tvb, offset + 2, 1, ENC_NA);
+    proto_tree_add_item_uint8(field_tree, hf_ip_opt_qs_rate, tvb, offset + 2, ENC_NA);
     proto_item_append_text(tf, ", %s",
                            val_to_str_ext(rate, &qs_rate_vals_ext, "Unknown (%u)"));
-    proto_tree_add_item(field_tree, hf_ip_opt_qs_unused, tvb, offset + 3, 1, ENC_NA);
-    proto_tree_add_item(field_tree, hf_ip_opt_qs_nonce, tvb, offset + 4, 4, ENC_BIG_ENDIAN);
-    proto_tree_add_item(field_tree, hf_ip_opt_qs_reserved, tvb, offset + 4, 4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_ip_opt_qs_unused, tvb, offset + 3, ENC_NA);
+    proto_tree_add_item_uint32(field_tree, hf_ip_opt_qs_nonce, tvb, offset + 4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint32(field_tree, hf_ip_opt_qs_reserved, tvb, offset + 4, ENC_BIG_ENDIAN);
   }
 }
 
@@ -1991,7 +1991,7 @@ dissect_ip(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree)
   ti = proto_tree_add_item(tree, proto_ip, tvb, offset, hlen, ENC_NA);
   ip_tree = proto_item_add_subtree(ti, ett_ip);
 
-  proto_tree_add_item(ip_tree, hf_ip_version, tvb, offset, 1, ENC_NA);
+  proto_tree_add_item_uint8(ip_tree, hf_ip_version, tvb, offset, ENC_NA);
 
   /* if IP is not referenced from any filters we don't need to worry about
      generating any tree items.  We must do this after we created the actual
@@ -2033,8 +2033,8 @@ dissect_ip(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree)
                                                      ecn_vals, "Unknown ECN"));
 
       field_tree = proto_item_add_subtree(tf, ett_ip_dsfield);
-      proto_tree_add_item(field_tree, hf_ip_dsfield_dscp, tvb, offset + 1, 1, ENC_NA);
-      proto_tree_add_item(field_tree, hf_ip_dsfield_ecn, tvb, offset + 1, 1, ENC_NA);
+      proto_tree_add_item_uint8(field_tree, hf_ip_dsfield_dscp, tvb, offset + 1, ENC_NA);
+      proto_tree_add_item_uint8(field_tree, hf_ip_dsfield_ecn, tvb, offset + 1, ENC_NA);
     } else {
       tf = proto_tree_add_uint_format_value(ip_tree, hf_ip_tos, tvb, offset + 1, 1,
                                       iph->ip_tos,
@@ -2044,7 +2044,7 @@ dissect_ip(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree)
                                                        iptos_vals, "Unknown"));
 
       field_tree = proto_item_add_subtree(tf, ett_ip_tos);
-      proto_tree_add_item(field_tree, hf_ip_tos_precedence, tvb, offset + 1, 1, ENC_NA);
+      proto_tree_add_item_uint8(field_tree, hf_ip_tos_precedence, tvb, offset + 1, ENC_NA);
       proto_tree_add_item(field_tree, hf_ip_tos_delay, tvb, offset + 1, 1, ENC_NA);
       proto_tree_add_item(field_tree, hf_ip_tos_throughput, tvb, offset + 1, 1, ENC_NA);
       proto_tree_add_item(field_tree, hf_ip_tos_reliability, tvb, offset + 1, 1, ENC_NA);
@@ -2137,14 +2137,14 @@ dissect_ip(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree)
 
   iph->ip_ttl = tvb_get_guint8(tvb, offset + 8);
   if (tree) {
-    ttl_item = proto_tree_add_item(ip_tree, hf_ip_ttl, tvb, offset + 8, 1, ENC_BIG_ENDIAN);
+    ttl_item = proto_tree_add_item_uint8(ip_tree, hf_ip_ttl, tvb, offset + 8, ENC_BIG_ENDIAN);
   } else {
     ttl_item = NULL;
   }
 
   iph->ip_p = tvb_get_guint8(tvb, offset + 9);
   if (tree) {
-    proto_tree_add_item(ip_tree, hf_ip_proto, tvb, offset + 9, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ip_tree, hf_ip_proto, tvb, offset + 9, ENC_BIG_ENDIAN);
   }
 
   iph->ip_sum = tvb_get_ntohs(tvb, offset + 10);
@@ -257,6 +257,56 @@ static extra_esp_sa_records_t extra_esp_sa_records;
 static uat_t * esp_uat = NULL;
 static guint num_sa_uat = 0;
 
+/* Which SA (if any) matched each protocol/address/SPI combination seen,
+   so that the wildcard matching is only done for the first packet of each.
+   Emptied whenever the SAs change. */
+typedef struct {
+  gint protocol;
+  guint32 spi;
+  guint8 src[16];
+  guint8 dst[16];
+} esp_sa_cache_key_t;
+
+static GHashTable *esp_sa_cache = NULL;
+
+/* Bumped whenever the SAs change, so that payloads decrypted with
+   the previous ones aren't reused. */
+static guint esp_sa_generation = 0;
+
+/* A payload decrypted on an earlier pass, attached to the frame */
+typedef struct {
+  guint sa_generation;
+  gint len;
+  guint8 *data;
+} esp_decrypted_data_t;
+
+static guint
+esp_sa_cache_hash(gconstpointer k)
+{
+  const esp_sa_cache_key_t *key = (const esp_sa_cache_key_t *)k;
+  guint hash = key->spi;
+  guint i;
+
+  for (i = 0; i < sizeof(key->src); i++)
+    hash = (hash << 5) - hash + key->src[i] + key->dst[i];
+
+  return hash;
+}
+
+static gboolean
+esp_sa_cache_equal(gconstpointer k1, gconstpointer k2)
+{
+  return memcmp(k1, k2, sizeof(esp_sa_cache_key_t)) == 0;
+}
+
+static void
+esp_sa_changed(void)
+{
+  if (esp_sa_cache)
+    g_hash_table_remove_all(esp_sa_cache);
+  esp_sa_generation++;
+}
+
 /*
    Name : static gint compute_ascii_key(gchar **ascii_key, gchar *key)
    Description : Allocate memory for the key and transform the key if it is hexadecimal
@@ -465,6 +515,8 @@ void esp_sa_record_add_from_dissector(guint8 protocol, const gchar *srcIP, const
 
    /* Parse keys */
    uat_esp_sa_record_update_cb(record, NULL);
+
+   esp_sa_changed();
 }
 
 /*************************************/
@@ -991,7 +1043,7 @@ filter_spi_match(gchar *spi, gchar *filter)
 
 
 /*
-   Name : static goolean get_esp_sa(g_esp_sa_database *sad, gint protocol_typ, gchar *src,  gchar *dst,  gint spi,
+   Name : static goolean get_esp_sa(g_esp_sa_database *sad, gint protocol_typ, const address *src, const address *dst, gint spi,
            gint *encryption_algo,
            gint *authentication_algo,
            gchar **encryption_key,
@@ -1006,8 +1058,8 @@ filter_spi_match(gchar *spi, gchar *filter)
    Params:
       - g_esp_sa_database *sad : the Security Association Database
       - gint *pt_protocol_typ : the protocol type
-      - gchar *src : the source address
-      - gchar *dst : the destination address
+      - const address *src : the source address
+      - const address *dst : the destination address
       - gchar *spi : the spi of the SA
       - gint *encryption_algo : the Encryption Algorithm to apply the packet
       - gint *authentication_algo : the Authentication Algorithm to apply to the packet
@@ -1021,29 +1073,16 @@ filter_spi_match(gchar *spi, gchar *filter)
                                       *cipher_hd and set this to TRUE.
 
 */
-static gboolean
-get_esp_sa(gint protocol_typ, gchar *src,  gchar *dst,  gint spi,
-           gint *encryption_algo,
-           gint *authentication_algo,
-           gchar **encryption_key,
-           guint *encryption_key_len,
-           gchar **authentication_key,
-           guint *authentication_key_len,
-           gcry_cipher_hd_t **cipher_hd,
-           gboolean **cipher_hd_created
-  )
+static uat_esp_sa_record_t *
+find_esp_sa(gint protocol_typ, gchar *src, gchar *dst, gint spi)
 {
-  gboolean found = FALSE;
   guint i, j;
   gchar spi_string[IPSEC_SPI_LEN_MAX];
 
   g_snprintf(spi_string, IPSEC_SPI_LEN_MAX,"0x%08x", spi);
 
-  *cipher_hd = NULL;
-  *cipher_hd_created = NULL;
-
   /* Check each known SA in turn */
-  for (i = 0, j=0; (found == FALSE) && ((i < num_sa_uat) || (j < extra_esp_sa_records.num_records)); )
+  for (i = 0, j=0; (i < num_sa_uat) || (j < extra_esp_sa_records.num_records); )
   {
     /* Get the next record to try */
     uat_esp_sa_record_t *record;
@@ -1059,43 +1098,75 @@ get_esp_sa(gint protocol_typ, gchar *src,  gchar *dst,  gint spi,
     if((protocol_typ == record->protocol)
        && filter_address_match(src, record->srcIP, protocol_typ)
        && filter_address_match(dst, record->dstIP, protocol_typ)
-       && filter_spi_match(spi_string, record->spi))
+       && filter_spi_match(spi_string, record->spi)
+       /* Bad keys; XXX - report this */
+       && (record->authentication_key_length != -1)
+       && (record->encryption_key_length != -1))
     {
-      found = TRUE;
+      return record;
+    }
+  }
 
-      *encryption_algo = record->encryption_algo;
-      *authentication_algo = record->authentication_algo;
-      *authentication_key = record->authentication_key;
-      if (record->authentication_key_length == -1)
-      {
-        /* Bad key; XXX - report this */
-        *authentication_key_len = 0;
-        found = FALSE;
-      }
-      else {
-        *authentication_key_len = record->authentication_key_length;
-      }
+  return NULL;
+}
 
-      *encryption_key = record->encryption_key;
-      if (record->encryption_key_length == -1)
-      {
-        /* Bad key; XXX - report this */
-        *encryption_key_len = 0;
-        found = FALSE;
-      }
-      else {
-        *encryption_key_len = record->encryption_key_length;
-      }
+static gboolean
+get_esp_sa(gint protocol_typ, const address *src, const address *dst, gint spi,
+           gint *encryption_algo,
+           gint *authentication_algo,
+           gchar **encryption_key,
+           guint *encryption_key_len,
+           gchar **authentication_key,
+           guint *authentication_key_len,
+           gcry_cipher_hd_t **cipher_hd,
+           gboolean **cipher_hd_created
+  )
+{
+  uat_esp_sa_record_t *record;
+  esp_sa_cache_key_t key;
+  gpointer value;
 
-      /* Tell the caller whether cypher_hd has been created yet and a pointer.
-         Pass pointer to created flag so that caller can set if/when
-         it opens the cypher_hd. */
-      *cipher_hd = &record->cipher_hd;
-      *cipher_hd_created = &record->cipher_hd_created;
-    }
+  *cipher_hd = NULL;
+  *cipher_hd_created = NULL;
+
+  memset(&key, 0, sizeof(key));
+  key.protocol = protocol_typ;
+  key.spi = spi;
+  if (src->len <= (int)sizeof(key.src) && dst->len <= (int)sizeof(key.dst)) {
+    memcpy(key.src, src->data, src->len);
+    memcpy(key.dst, dst->data, dst->len);
   }
 
-  return found;
+  if (!esp_sa_cache)
+    esp_sa_cache = g_hash_table_new_full(esp_sa_cache_hash, esp_sa_cache_equal, g_free, NULL);
+
+  if (g_hash_table_lookup_extended(esp_sa_cache, &key, NULL, &value)) {
+    record = (uat_esp_sa_record_t *)value;
+  } else {
+    record = find_esp_sa(protocol_typ,
+                         address_to_str(wmem_packet_scope(), src),
+                         address_to_str(wmem_packet_scope(), dst), spi);
+    if (protocol_typ != IPSEC_SA_UNKNOWN)
+      g_hash_table_insert(esp_sa_cache, g_memdup(&key, sizeof(key)), record);
+  }
+
+  if (record == NULL)
+    return FALSE;
+
+  *encryption_algo = record->encryption_algo;
+  *authentication_algo = record->authentication_algo;
+  *authentication_key = record->authentication_key;
+  *authentication_key_len = record->authentication_key_length;
+  *encryption_key = record->encryption_key;
+  *encryption_key_len = record->encryption_key_length;
+
+  /* Tell the caller whether cypher_hd has been created yet and a pointer.
+     Pass pointer to created flag so that caller can set if/when
+     it opens the cypher_hd. */
+  *cipher_hd = &record->cipher_hd;
+  *cipher_hd_created = &record->cipher_hd_created;
+
+  return TRUE;
 }
 #endif
 
@@ -1301,9 +1372,6 @@ dissect_esp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
 #ifdef HAVE_LIBGCRYPT
   gint i;
 
-  /* Packet Variables related */
-  gchar *ip_src = NULL;
-  gchar *ip_dst = NULL;
 #endif
 
   guint32 spi = 0;
@@ -1316,6 +1384,7 @@ dissect_esp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
 #ifdef HAVE_LIBGCRYPT
   gboolean null_encryption_decode_heuristic = FALSE;
   guint8 *decrypted_data = NULL;
+  esp_decrypted_data_t *cached_data = NULL;
   guint8 *authenticator_data = NULL;
   guint8 *esp_data = NULL;
   tvbuff_t *tvb_decrypted;
@@ -1423,10 +1492,6 @@ dissect_esp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
       protocol_typ = IPSEC_SA_IPV6;
     }
 
-    /* Create strings for src, dst addresses */
-    ip_src = address_to_str(wmem_packet_scope(), &pinfo->src);
-    ip_dst = address_to_str(wmem_packet_scope(), &pinfo->dst);
-
     /* Get the SPI */
     if (tvb_length(tvb) >= 4)
     {
@@ -1439,7 +1504,7 @@ dissect_esp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
       be called every times an ESP Payload is found.
     */
 
-    if((sad_is_present = get_esp_sa(protocol_typ, ip_src, ip_dst, spi,
+    if((sad_is_present = get_esp_sa(protocol_typ, &pinfo->src, &pinfo->dst, spi,
                                     &esp_crypt_algo, &esp_auth_algo,
                                     &esp_crypt_key, &esp_crypt_key_len, &esp_auth_key, &esp_auth_key_len,
                                     &cipher_hd, &cipher_hd_created)))
@@ -1967,6 +2032,22 @@ dissect_esp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
         }
 
         if (decrypt_using_libgcrypt)
+        {
+          /* Reuse what an earlier pass decrypted with the same SAs */
+          cached_data = (esp_decrypted_data_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_esp, pinfo->curr_layer_num);
+          if (cached_data &&
+              ((cached_data->sa_generation != esp_sa_generation) || (cached_data->len != decrypted_len_alloc + esp_iv_len)))
+          {
+            cached_data = NULL;
+          }
+        }
+
+        if (cached_data)
+        {
+          decrypted_data = (guint8 *)g_memdup(cached_data->data, cached_data->len);
+          decrypt_ok = TRUE;
+        }
+        else if (decrypt_using_libgcrypt)
         {
           /* Allocate Buffers for Encrypted and Decrypted data  */
           decrypted_data = (guint8 *) g_malloc ((decrypted_len_alloc + esp_iv_len)* sizeof(guint8));
@@ -2050,6 +2131,17 @@ dissect_esp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
 
             /* Decryption has finished */
             decrypt_ok = TRUE;
+
+            /* Keep it for later passes */
+            cached_data = (esp_decrypted_data_t *)p_get_proto_data(wmem_file_scope(), pinfo, proto_esp, pinfo->curr_layer_num);
+            if (!cached_data)
+            {
+              cached_data = wmem_new(wmem_file_scope(), esp_decrypted_data_t);
+              p_add_proto_data(wmem_file_scope(), pinfo, proto_esp, pinfo->curr_layer_num, cached_data);
+            }
+            cached_data->sa_generation = esp_sa_generation;
+            cached_data->len = decrypted_len_alloc + esp_iv_len;
+            cached_data->data = (guint8 *)wmem_memdup(wmem_file_scope(), decrypted_data, cached_data->len);
           }
         }
       }
@@ -2319,6 +2411,8 @@ static void ipsec_init_protocol(void)
   }
   extra_esp_sa_records.num_records = 0;
 
+  esp_sa_changed();
+
   /* Destroy any existing hashes. */
   if (esp_sequence_analysis_hash) {
       g_hash_table_destroy(esp_sequence_analysis_hash);
@@ -2530,7 +2624,7 @@ proto_register_ipsec(void)
             uat_esp_sa_record_copy_cb,      /* copy callback */
             uat_esp_sa_record_update_cb,    /* update callback */
             uat_esp_sa_record_free_cb,      /* free callback */
-            NULL,                           /* post update callback */
+            esp_sa_changed,                 /* post update callback */
             esp_uat_flds);                  /* UAT field definitions */
 
   prefs_register_uat_preference(esp_module,
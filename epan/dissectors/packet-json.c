@@ -61,11 +61,8 @@ static header_field_info hfi_json_object JSON_HFI_INIT =
 static header_field_info hfi_json_member JSON_HFI_INIT =
 	{ "Member", "json.member", FT_NONE, BASE_NONE, NULL, 0x00, "JSON object member", HFILL };
 
-#if 0
-/* XXX */
 static header_field_info hfi_json_member_key JSON_HFI_INIT =
-	{ "Key", "json.member.key", FT_NONE, BASE_NONE, NULL, 0x00, NULL, HFILL };
-#endif
+	{ "Key", "json.key", FT_STRING, STR_UNICODE, NULL, 0x00, "JSON object member key", HFILL };
 
 static header_field_info hfi_json_value_string JSON_HFI_INIT = /* FT_STRINGZ? */
 	{ "String value", "json.value.string", FT_STRING, STR_UNICODE, NULL, 0x00, "JSON string value", HFILL };
@@ -202,6 +199,8 @@ static void before_member(void *tvbparse_data, const void *wanted_data _U_, tvbp
 	wmem_stack_push(data->stack, subtree);
 }
 
+static char *json_string_unescape(tvbparse_elem_t *tok);
+
 static void after_member(void *tvbparse_data, const void *wanted_data _U_, tvbparse_elem_t *tok) {
 	json_parser_data_t *data = (json_parser_data_t *) tvbparse_data;
 
@@ -211,11 +210,20 @@ static void after_member(void *tvbparse_data, const void *wanted_data _U_, tvbpa
 		tvbparse_elem_t *key_tok = tok->sub;
 
 		if (key_tok && key_tok->id == JSON_TOKEN_STRING) {
-			char *key = tvb_get_string_enc(wmem_packet_scope(), key_tok->tvb, key_tok->offset, key_tok->len, ENC_ASCII);
+			/* don't format keys nobody is going to see or filter on */
+			if (PTREE_DATA(tree)->visible) {
+				char *key = tvb_get_string_enc(wmem_packet_scope(), key_tok->tvb, key_tok->offset, key_tok->len, ENC_ASCII);
+
+				proto_item_append_text(tree, " Key: %s", key);
+			}
+
+			if (key_tok->len >= 2 && proto_field_is_referenced(tree, hfi_json_member_key.id)) {
+				proto_item *ti;
 
-			proto_item_append_text(tree, " Key: %s", key);
+				ti = proto_tree_add_string(tree, &hfi_json_member_key, key_tok->tvb, key_tok->offset, key_tok->len, json_string_unescape(key_tok));
+				PROTO_ITEM_SET_HIDDEN(ti);
+			}
 		}
-		/* XXX, &hfi_json_member_key */
 	}
 }
 
@@ -400,6 +408,10 @@ static void after_value(void *tvbparse_data, const void *wanted_data _U_, tvbpar
 
 	switch (value_id) {
 		case JSON_TOKEN_STRING:
+			/* unescaping is the expensive part, skip it if the value isn't wanted */
+			if (!proto_field_is_referenced(tree, hfi_json_value_string.id))
+				break;
+
 			if (tok->len >= 2)
 				proto_tree_add_string(tree, &hfi_json_value_string, tok->tvb, tok->offset, tok->len, json_string_unescape(tok));
 			else
@@ -572,17 +584,25 @@ static void init_json_parser(void) {
 static gboolean
 dissect_json_heur(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data)
 {
-	/* We expect no more than 1024 tokens */
-	const guint max_tokens = 1024;
 	guint len = tvb_captured_length(tvb);
-	guint8* buf = tvb_get_string_enc(wmem_packet_scope(), tvb, 0, len, ENC_ASCII);
+	const char* buf = (const char *)tvb_get_ptr(tvb, 0, len);
+	int num_tokens;
 
 	jsmn_parser p;
+	jsmntok_t* t;
+
+	/* Without a token array jsmn just counts the tokens, which sizes the
+	 * array for the real pass (that also matches the brackets) whatever
+	 * the size of the payload */
+	jsmn_init(&p);
+	if ((num_tokens = jsmn_parse(&p, buf, len, NULL, 0)) < 0) {
+		return FALSE;
+	}
 
-	jsmntok_t* t = (jsmntok_t*)wmem_alloc_array(wmem_packet_scope(), jsmntok_t, max_tokens);
+	t = (jsmntok_t*)wmem_alloc_array(wmem_packet_scope(), jsmntok_t, num_tokens ? num_tokens : 1);
 
 	jsmn_init(&p);
-	if (jsmn_parse(&p, buf, len, t, max_tokens) < 0) {
+	if (jsmn_parse(&p, buf, len, t, num_tokens) < 0) {
 		return FALSE;
 	}
 	return (dissect_json(tvb, pinfo, tree, data) != 0);
@@ -603,7 +623,7 @@ proto_register_json(void)
 		&hfi_json_array,
 		&hfi_json_object,
 		&hfi_json_member,
-		/* &hfi_json_member_key, */
+		&hfi_json_member_key,
 		&hfi_json_value_string,
 		&hfi_json_value_number,
 		&hfi_json_value_false,
@@ -380,8 +380,8 @@ dissect_pw_ach(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
         ti = proto_tree_add_item(tree, proto_pw_ach, tvb, 0, 4, ENC_NA);
         mpls_pw_ach_tree = proto_item_add_subtree(ti, ett_mpls_pw_ach);
 
-        proto_tree_add_item(mpls_pw_ach_tree, hf_mpls_pw_ach_ver,
-                            tvb, 0, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(mpls_pw_ach_tree, hf_mpls_pw_ach_ver,
+                                  tvb, 0, ENC_BIG_ENDIAN);
 
         res = tvb_get_guint8(tvb, 1);
         ti = proto_tree_add_uint(mpls_pw_ach_tree, hf_mpls_pw_ach_res,
@@ -458,13 +458,13 @@ dissect_pw_mcw(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
         ti = proto_tree_add_item(tree, proto_pw_mcw, tvb, 0, 4, ENC_NA);
         mpls_pw_mcw_tree = proto_item_add_subtree(ti, ett_mpls_pw_mcw);
 
-        proto_tree_add_item(mpls_pw_mcw_tree, hf_mpls_pw_mcw_flags,
-                            tvb, 0, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(mpls_pw_mcw_tree, hf_mpls_pw_mcw_flags,
+                                   tvb, 0, ENC_BIG_ENDIAN);
         /* bits 4 to 7 and FRG bits are displayed together */
-        proto_tree_add_item(mpls_pw_mcw_tree, hf_mpls_pw_mcw_length,
-                            tvb, 1, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(mpls_pw_mcw_tree, hf_mpls_pw_mcw_sequence_number,
-                            tvb, 2, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(mpls_pw_mcw_tree, hf_mpls_pw_mcw_length,
+                                  tvb, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(mpls_pw_mcw_tree, hf_mpls_pw_mcw_sequence_number,
+                                   tvb, 2, ENC_BIG_ENDIAN);
     }
     next_tvb = tvb_new_subset_remaining(tvb, 4);
     call_dissector(dissector_data, next_tvb, pinfo, tree);
@@ -517,25 +517,25 @@ dissect_mpls(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
                 proto_item_append_text(ti, ", Label: %u", label);
             }
             if (label <= MPLS_LABEL_MAX_RESERVED){
-                proto_tree_add_item(mpls_tree, hf_mpls_label_special, tvb,
-                                    offset, 4, ENC_BIG_ENDIAN);
+                proto_tree_add_item_uint32(mpls_tree, hf_mpls_label_special, tvb,
+                                           offset, ENC_BIG_ENDIAN);
                 proto_item_append_text(ti, " (%s)",
                                        val_to_str_const(label, special_labels, "Reserved - Unknown"));
             } else {
-                proto_tree_add_item(mpls_tree, hf_mpls_label, tvb, offset, 4,
-                                    ENC_BIG_ENDIAN);
+                proto_tree_add_item_uint32(mpls_tree, hf_mpls_label, tvb, offset,
+                                           ENC_BIG_ENDIAN);
             }
 
-            proto_tree_add_item(mpls_tree, hf_mpls_exp, tvb, offset, 4,
-                                ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint32(mpls_tree, hf_mpls_exp, tvb, offset,
+                                       ENC_BIG_ENDIAN);
             proto_item_append_text(ti, ", Exp: %u", exp);
 
-            proto_tree_add_item(mpls_tree, hf_mpls_bos , tvb, offset, 4,
-                                ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint32(mpls_tree, hf_mpls_bos , tvb, offset,
+                                       ENC_BIG_ENDIAN);
             proto_item_append_text(ti, ", S: %u", bos);
 
-            proto_tree_add_item(mpls_tree, hf_mpls_ttl, tvb, offset, 4,
-                                ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint32(mpls_tree, hf_mpls_ttl, tvb, offset,
+                                       ENC_BIG_ENDIAN);
             proto_item_append_text(ti, ", TTL: %u", ttl);
         }
 
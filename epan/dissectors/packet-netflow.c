@@ -308,6 +308,8 @@ typedef struct _v9_v10_tmplt {
     guint32  src_id;   /* SourceID in NetFlow V9, Observation Domain ID in IPFIX */
     guint16  tmplt_id;
     guint    length;
+    gboolean variable_length;                    /* some field is variable length */
+    gboolean cace_fields;                        /* some field carries CACE process info */
     guint16  field_count[TF_NUM];                /* 0:scopes; 1:entries  */
     v9_v10_tmplt_entry_t *fields_p[TF_NUM_EXT];  /* 0:scopes; 1:entries; n:vendor_entries  */
 } v9_v10_tmplt_t;
@@ -2677,6 +2679,14 @@ dissect_v9_v10_data(tvbuff_t *tvb, packet_info *pinfo, proto_tree *pdutree, int
         }
         PROTO_ITEM_SET_GENERATED(ti);
 
+        /* Without a tree there is nothing to show for a record, and if   */
+        /* each one has the template's length we can just count them.     */
+        /* CACE fields are still dissected for their process info.        */
+        if ((pdutree == NULL) && !tmplt_p->variable_length && !tmplt_p->cace_fields) {
+            *flows_seen += length / tmplt_p->length;
+            return (0);
+        }
+
         /* Note: If the flow contains variable length fields then          */
         /*       tmplt_p->length will be less then actual length of the flow. */
         while (length >= tmplt_p->length) {
@@ -6145,6 +6155,11 @@ dissect_v9_v10_template_fields(tvbuff_t *tvb, packet_info *pinfo _U_, proto_tree
             tmplt_p->fields_p[fields_type][i].pen_str = pen_str;
             if (length != VARIABLE_LENGTH) { /* Don't include "variable length" in the total */
                 tmplt_p->length    += length;
+            } else {
+                tmplt_p->variable_length = TRUE;
+            }
+            if (pen == VENDOR_CACE) {
+                tmplt_p->cace_fields = TRUE;
             }
         }
 
@@ -151,12 +151,30 @@ static void per_check_items(guint32 cnt, int min_len, int max_len, asn1_ctx_t *a
 	}
 }
 
+/* Read num_bits (at most 32) bits starting bit_offset bits into buf */
+static guint32
+per_buf_get_bits(const guint8 *buf, guint32 bit_offset, int num_bits)
+{
+	guint32 val = 0;
+	int avail, take;
+
+	while (num_bits > 0) {
+		avail = 8 - (bit_offset & 0x07);
+		take = MIN(avail, num_bits);
+		val = (val << take) | ((buf[bit_offset >> 3] >> (avail - take)) & ((1 << take) - 1));
+		bit_offset += take;
+		num_bits -= take;
+	}
+	return val;
+}
+
 static tvbuff_t *new_octet_aligned_subset(tvbuff_t *tvb, guint32 offset, asn1_ctx_t *actx, guint32 length)
 {
 	tvbuff_t *sub_tvb = NULL;
 	guint32 boffset = offset >> 3;
 	unsigned int i, shift0, shift1;
-	guint8 octet0, octet1, *buf;
+	const guint8 *src;
+	guint8 *buf;
 	guint32 actual_length;
 
 	/*  XXX - why are we doing this?  Shouldn't we throw an exception if we've
@@ -170,11 +188,10 @@ static tvbuff_t *new_octet_aligned_subset(tvbuff_t *tvb, guint32 offset, asn1_ct
 		shift1 = offset & 0x07;
 		shift0 = 8 - shift1;
 		buf = (guint8 *)wmem_alloc(actx->pinfo->pool, actual_length);
-		octet0 = tvb_get_guint8(tvb, boffset);
+		/* the last octet straddles into the one after the string */
+		src = tvb_get_ptr(tvb, boffset, actual_length + 1);
 		for (i=0; i<actual_length; i++) {
-			octet1 = octet0;
-			octet0 = tvb_get_guint8(tvb, boffset + i + 1);
-			buf[i] = (octet1 << shift1) | (octet0 >> shift0);
+			buf[i] = (src[i] << shift1) | (src[i + 1] >> shift0);
 		}
 		sub_tvb = tvb_new_child_real_data(tvb, buf, actual_length, length);
 		add_new_data_source(actx->pinfo, sub_tvb, "Unaligned OCTET STRING");
@@ -296,8 +313,6 @@ dissect_per_length_determinant(tvbuff_t *tvb, guint32 offset, asn1_ctx_t *actx _
 	guint32 len;
 	proto_item *pi;
 	int num_bits;
-	int i, bit, str_length, str_index;
-	gboolean tmp;
 
 	if(!length){
 		length=&len;
@@ -309,79 +324,31 @@ dissect_per_length_determinant(tvbuff_t *tvb, guint32 offset, asn1_ctx_t *actx _
 		byte=tvb_get_guint8(tvb, offset>>3);
 		offset+=8;
 	}else{
-		char *str;
 		guint32 val;
 
-		val = 0;
-
-		/* prepare the string (max number of bits + quartet separators + prepended space) */
-		str_length = 256+64+1;
-		str=(char *)wmem_alloc(wmem_packet_scope(), str_length+1);
-		str_index = 0;
-
-		str_length = g_snprintf(str, str_length+1, " ");
-		for(bit=0;bit<((int)(offset&0x07));bit++){
-			if(bit&&(!(bit%4))){
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			if (str_index < str_length) str[str_index++] = '.';
-		}
-		/* read the bits for the int */
+		/* read the whole determinant at once rather than a bit at a time */
 		num_bits = 8;
-		for(i=0;i<num_bits;i++){
-			if(bit&&(!(bit%4))){
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			if(bit&&(!(bit%8))){
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			bit++;
-			offset=dissect_per_boolean(tvb, offset, actx, tree, -1, &tmp);
-			val<<=1;
-			if(tmp){
-				val|=1;
-				if (str_index < str_length) str[str_index++] = '1';
-				if (i==0) { /* bit 8 is 1, so not a single byte length */
-					num_bits = 16;
-				}
-				else if (i==1 && val==3) { /* bits 8 and 7 both 1, so unconstrained */
-					*length = 0;
-					dissect_per_not_decoded_yet(tree, actx->pinfo, tvb, "10.9 Unconstrained");
-					return offset;
-				}
-			} else {
-				if (str_index < str_length) str[str_index++] = '0';
-			}
+		val = tvb_get_bits8(tvb, offset, 8);
+		if ((val & 0xc0) == 0xc0) {
+			/* bits 8 and 7 both 1, so unconstrained */
+			*length = 0;
+			dissect_per_not_decoded_yet(tree, actx->pinfo, tvb, "10.9 Unconstrained");
+			return offset + 2;
 		}
-		str[str_index] = '\0'; /* Terminate string */
-		if((val&0x80)==0 && num_bits==8){
-			*length = val;
-			if(hf_index!=-1){
-				pi = proto_tree_add_uint(tree, hf_index, tvb, (offset>>3)-1, 1, *length);
-				if (display_internal_per_fields)
-					proto_item_append_text(pi," %s", str);
-				else
-					PROTO_ITEM_SET_HIDDEN(pi);
-			}
-
-			return offset;
+		if (val & 0x80) {
+			/* bit 8 is 1, so not a single byte length */
+			num_bits = 16;
+			val = tvb_get_bits16(tvb, offset, 16, ENC_BIG_ENDIAN);
 		}
-		else if (num_bits==16) {
-			*length = val&0x3fff;
-			if(hf_index!=-1){
-				pi = proto_tree_add_uint(tree, hf_index, tvb, (offset>>3)-1, 1, *length);
-				if (display_internal_per_fields)
-					proto_item_append_text(pi," %s", str);
-				else
-					PROTO_ITEM_SET_HIDDEN(pi);
-			}
-
-			return offset;
+		*length = val&0x3fff;
+		if(hf_index!=-1){
+			pi = proto_tree_add_uint(tree, hf_index, tvb, ((offset+num_bits)>>3)-1, 1, *length);
+			if (display_internal_per_fields)
+				proto_item_append_text(pi,"  %s", decode_bits_in_field(offset&0x07, num_bits, val));
+			else
+				PROTO_ITEM_SET_HIDDEN(pi);
 		}
-		*length = 0;
-		dissect_per_not_decoded_yet(tree, actx->pinfo, tvb, "10.9 Unaligned");
-		return offset;
-
+		return offset + num_bits;
 	}
 
 	/* 10.9.3.6 */
@@ -414,7 +381,7 @@ dissect_per_length_determinant(tvbuff_t *tvb, guint32 offset, asn1_ctx_t *actx _
 static guint32
 dissect_per_normally_small_nonnegative_whole_number(tvbuff_t *tvb, guint32 offset, asn1_ctx_t *actx, proto_tree *tree, int hf_index, guint32 *length)
 {
-	gboolean small_number, length_bit;
+	gboolean small_number;
 	guint32 len, length_determinant;
 	proto_item *pi;
 
@@ -426,16 +393,9 @@ DEBUG_ENTRY("dissect_per_normally_small_nonnegative_whole_number");
 	offset=dissect_per_boolean(tvb, offset, actx, tree, hf_per_small_number_bit, &small_number);
 	if (!display_internal_per_fields) PROTO_ITEM_SET_HIDDEN(actx->created_item);
 	if(!small_number){
-		int i;
 		/* 10.6.1 */
-		*length=0;
-		for(i=0;i<6;i++){
-			offset=dissect_per_boolean(tvb, offset, actx, tree, -1, &length_bit);
-			*length<<=1;
-			if (length_bit) {
-				*length|=1;
-			}
-		}
+		*length=tvb_get_bits8(tvb, offset, 6);
+		offset+=6;
 		if(hf_index!=-1){
 			pi = proto_tree_add_uint(tree, hf_index, tvb, (offset-6)>>3, (offset%8<6)?2:1, *length);
 			if (!display_internal_per_fields) PROTO_ITEM_SET_HIDDEN(pi);
@@ -574,6 +534,8 @@ dissect_per_restricted_character_string_sorted(tvbuff_t *tvb, guint32 offset, as
 	guint32 length;
 	gboolean byte_aligned;
 	guint8 *buf;
+	const guint8 *src;
+	guint64 src_length;
 	guint char_pos;
 	int bits_per_char;
 	guint32 old_offset;
@@ -681,16 +643,15 @@ DEBUG_ENTRY("dissect_per_restricted_character_string");
 
 	buf = (guint8 *)wmem_alloc(actx->pinfo->pool, length+1);
 	old_offset=offset;
+	/* fetch all the characters' bits in one go */
+	src_length = ((offset&0x07) + (guint64)length*bits_per_char + 7)>>3;
+	if (src_length > G_MAXINT)
+		THROW(ReportedBoundsError);
+	src = tvb_get_ptr(tvb, offset>>3, (gint)src_length);
 	for(char_pos=0;char_pos<length;char_pos++){
 		guchar val;
-		int i;
-		gboolean bit;
 
-		val=0;
-		for(i=0;i<bits_per_char;i++){
-			offset=dissect_per_boolean(tvb, offset, actx, tree, -1, &bit);
-			val=(val<<1)|bit;
-		}
+		val=(guchar)per_buf_get_bits(src, (offset&0x07) + char_pos*bits_per_char, bits_per_char);
 		/* ALIGNED PER does not do any remapping of chars if
 		   bitsperchar is 8
 		*/
@@ -706,6 +667,7 @@ DEBUG_ENTRY("dissect_per_restricted_character_string");
 		}
 	}
 	buf[char_pos]=0;
+	offset += length*bits_per_char;
 	proto_tree_add_string(tree, hf_index, tvb, (old_offset>>3), (offset>>3)-(old_offset>>3), (char*)buf);
 	if (value_tvb) {
 		*value_tvb = tvb_new_child_real_data(tvb, buf, length, length);
@@ -1366,7 +1328,6 @@ dissect_per_constrained_integer_64b(tvbuff_t *tvb, guint32 offset, asn1_ctx_t *a
 	nstime_t timeval;
 	header_field_info *hfi;
 	int num_bits;
-	gboolean tmp;
 
 DEBUG_ENTRY("dissect_per_constrained_integer_64b");
 	if(has_extension){
@@ -1426,8 +1387,7 @@ DEBUG_ENTRY("dissect_per_constrained_integer_64b");
 		 * as a non-negative  binary integer in a bit field as specified in 10.3 with the minimum
 		 * number of bits necessary to represent the range.
 		 */
-		char *str;
-		int i, bit, length, str_length, str_index;
+		int i, length;
 		guint64 mask,mask2;
 		/* We only handle 64 bit integers */
 		mask  = G_GINT64_CONSTANT(0x8000000000000000);
@@ -1447,46 +1407,15 @@ DEBUG_ENTRY("dissect_per_constrained_integer_64b");
 			num_bits=1;
 		}
 
-		/* prepare the string (max number of bits + quartet separators + field name + ": ") */
-		str_length = 512+128+(int)strlen(hfi->name)+2;
-		str = (char *)wmem_alloc(wmem_packet_scope(), str_length+1);
-		str_index = g_snprintf(str, str_length+1, "%s: ", hfi->name);
-		for(bit=0;bit<((int)(offset&0x07));bit++){
-			if(bit&&(!(bit%4))){
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			if (str_index < str_length) str[str_index++] = '.';
-		}
-		/* read the bits for the int */
-		for(i=0;i<num_bits;i++){
-			if(bit&&(!(bit%4))){
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			if(bit&&(!(bit%8))){
-				length+=1;
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			bit++;
-			offset=dissect_per_boolean(tvb, offset, actx, tree, -1, &tmp);
-			val<<=1;
-			if(tmp){
-				val|=1;
-				if (str_index < str_length) str[str_index++] = '1';
-			} else {
-				if (str_index < str_length) str[str_index++] = '0';
-			}
-		}
-		for(;bit%8;bit++){
-			if(bit&&(!(bit%4))){
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			if (str_index < str_length) str[str_index++] = '.';
-		}
-		str[str_index] = '\0'; /* Terminate string */
-		val_start = (offset-num_bits)>>3; val_length = length;
-		val+=min;
+		/* read the bits for the int in one go; the octets they span make up the item */
+		length+=((offset&0x07)+num_bits-1)>>3;
+		val_start = offset>>3; val_length = length;
+		val = tvb_get_bits64(tvb, offset, num_bits, ENC_BIG_ENDIAN);
 		if (display_internal_per_fields)
-			proto_tree_add_text(tree, tvb, val_start,val_length,"Range = (%" G_GINT64_MODIFIER "u) Bitfield length %u, %s",range, num_bits, str);
+			proto_tree_add_text(tree, tvb, val_start,val_length,"Range = (%" G_GINT64_MODIFIER "u) Bitfield length %u, %s: %s",
+					    range, num_bits, hfi->name, decode_bits_in_field(offset&0x07, num_bits, val));
+		offset+=num_bits;
+		val+=min;
 	} else if(range==256){
 		/* 10.5.7.2 */
 
@@ -378,17 +378,29 @@ typedef struct
 typedef struct rlc_segment {
     guint32 frameNum;
     guint16 SN;
-    guint8 *data;
     guint16 length;
 } rlc_segment;
 
+/* A segmented SDU.  Only SDUs that are complete get their own copy; the
+   one being accumulated lives in the channel's rlc_reassembly_buffer. */
 typedef struct rlc_channel_reassembly_info
 {
-    guint16 number_of_segments;
+    guint16      number_of_segments;
     #define RLC_MAX_SEGMENTS 100
-    rlc_segment segments[RLC_MAX_SEGMENTS];
+    rlc_segment *segments;
+    guint8      *data;          /* The segments' data, one after another */
+    guint        data_length;
 } rlc_channel_reassembly_info;
 
+/* Space for accumulating a channel's SDUs, allocated the first time one
+   is segmented and reused for every SDU after that. */
+typedef struct rlc_reassembly_buffer
+{
+    rlc_channel_reassembly_info info;
+    rlc_segment segments[RLC_MAX_SEGMENTS];
+    guint       data_size;
+} rlc_reassembly_buffer;
+
 
 
 
@@ -405,8 +417,10 @@ typedef struct
     guint32  previousFrameNum;
     gboolean previousSegmentIncomplete;
 
-    /* Accumulate info about current segmented SDU */
+    /* Accumulate info about current segmented SDU; NULL if there isn't
+       one, otherwise it points into reassembly_buffer */
     struct rlc_channel_reassembly_info *reassembly_info;
+    rlc_reassembly_buffer *reassembly_buffer;
 } channel_sequence_analysis_status;
 
 /* The sequence analysis channel hash table */
@@ -455,16 +469,24 @@ static gpointer get_report_hash_key(guint16 SN, guint32 frameNumber,
 static GHashTable *reassembly_report_hash = NULL;
 
 
-/* Create a new struct for reassembly */
+/* Start reassembling a new SDU */
 static void reassembly_reset(channel_sequence_analysis_status *status)
 {
-    status->reassembly_info = wmem_new0(wmem_file_scope(), rlc_channel_reassembly_info);
+    rlc_reassembly_buffer *buffer = status->reassembly_buffer;
+
+    if (buffer == NULL) {
+        buffer = wmem_new0(wmem_file_scope(), rlc_reassembly_buffer);
+        buffer->info.segments = buffer->segments;
+        status->reassembly_buffer = buffer;
+    }
+    buffer->info.number_of_segments = 0;
+    buffer->info.data_length = 0;
+    status->reassembly_info = &buffer->info;
 }
 
-/* Hide previous one */
+/* Abandon the current one; the buffer is kept for the next */
 static void reassembly_destroy(channel_sequence_analysis_status *status)
 {
-    /* Just "leak" it. There seems to be no way to free this memory... */
     status->reassembly_info = NULL;
 }
 
@@ -473,8 +495,8 @@ static void reassembly_add_segment(channel_sequence_analysis_status *status,
                                    guint16 SN, guint32 frame,
                                    tvbuff_t *tvb, gint offset, gint length)
 {
+    rlc_reassembly_buffer *buffer = status->reassembly_buffer;
     int segment_number =  status->reassembly_info->number_of_segments;
-    guint8 *segment_data;
 
     /* Give up if reach segment limit */
     if (segment_number >= (RLC_MAX_SEGMENTS-1)) {
@@ -482,17 +504,22 @@ static void reassembly_add_segment(channel_sequence_analysis_status *status,
         return;
     }
 
-    segment_data = (guint8 *)wmem_alloc(wmem_file_scope(), length);
-    /* TODO: is there a better way to do this? */
-    memcpy(segment_data, tvb_get_ptr(tvb, offset, length), length);
+    /* Make room for the data, if the buffer hasn't already grown
+       big enough for an earlier SDU */
+    if (buffer->info.data_length + length > buffer->data_size) {
+        buffer->data_size = MAX(2 * buffer->data_size, buffer->info.data_length + length);
+        buffer->info.data = (guint8 *)wmem_realloc(wmem_file_scope(), buffer->info.data,
+                                                   buffer->data_size);
+    }
+    tvb_memcpy(tvb, buffer->info.data + buffer->info.data_length, offset, length);
+    buffer->info.data_length += length;
 
     /* Add new segment */
-    status->reassembly_info->segments[segment_number].frameNum = frame;
-    status->reassembly_info->segments[segment_number].SN = SN;
-    status->reassembly_info->segments[segment_number].data = segment_data;
-    status->reassembly_info->segments[segment_number].length = length;
+    buffer->segments[segment_number].frameNum = frame;
+    buffer->segments[segment_number].SN = SN;
+    buffer->segments[segment_number].length = length;
 
-    status->reassembly_info->number_of_segments++;
+    buffer->info.number_of_segments++;
 }
 
 
@@ -501,39 +528,34 @@ static void reassembly_add_segment(channel_sequence_analysis_status *status,
 static void reassembly_record(channel_sequence_analysis_status *status, packet_info *pinfo,
                               guint16 SN, rlc_lte_info *p_rlc_lte_info)
 {
-    /* Just store existing info in hash table */
+    rlc_channel_reassembly_info *reassembly_info = status->reassembly_info;
+    rlc_channel_reassembly_info *record;
+
+    /* Copy just what was used out of the channel's buffer, and store
+       that in the hash table */
+    record = wmem_new(wmem_file_scope(), rlc_channel_reassembly_info);
+    record->number_of_segments = reassembly_info->number_of_segments;
+    record->segments = (rlc_segment *)wmem_memdup(wmem_file_scope(), reassembly_info->segments,
+                                                  reassembly_info->number_of_segments * sizeof(rlc_segment));
+    record->data = (guint8 *)wmem_memdup(wmem_file_scope(), reassembly_info->data,
+                                         reassembly_info->data_length);
+    record->data_length = reassembly_info->data_length;
+
     g_hash_table_insert(reassembly_report_hash,
                         get_report_hash_key(SN, pinfo->fd->num, p_rlc_lte_info, TRUE),
-                        status->reassembly_info);
+                        record);
 }
 
 /* Create and return a tvb based upon contents of reassembly info */
 static tvbuff_t* reassembly_get_reassembled_tvb(rlc_channel_reassembly_info *reassembly_info,
                                                 tvbuff_t *parent_tvb, packet_info *pinfo)
 {
-    gint n;
-    guint   combined_length = 0;
-    guint8 *combined_data;
-    guint combined_offset = 0;
     tvbuff_t *reassembled_tvb;
 
-    /* Allocate buffer big enough to hold re-assembled data */
-    for (n=0; n < reassembly_info->number_of_segments; n++) {
-        combined_length += reassembly_info->segments[n].length;
-    }
-    combined_data = (guint8 *)g_malloc(combined_length);
-
-    /* Copy data into contiguous buffer */
-    for (n=0; n < reassembly_info->number_of_segments; n++) {
-        guint8 *data = reassembly_info->segments[n].data;
-        int length = reassembly_info->segments[n].length;
-        memcpy(combined_data+combined_offset, data, length);
-        combined_offset += length;
-    }
-
-    /* Create and return tvb with this data */
-    reassembled_tvb = tvb_new_child_real_data(parent_tvb, combined_data, combined_offset, combined_offset);
-    tvb_set_free_cb(reassembled_tvb, g_free);
+    /* The data was stored contiguously, and lasts as long as the file */
+    reassembled_tvb = tvb_new_child_real_data(parent_tvb, reassembly_info->data,
+                                              reassembly_info->data_length,
+                                              reassembly_info->data_length);
     add_new_data_source(pinfo, reassembled_tvb, "Reassembled SDU");
     return reassembled_tvb;
 }
@@ -547,7 +569,7 @@ static void reassembly_show_source(rlc_channel_reassembly_info *reassembly_info,
     proto_tree *source_tree;
     proto_item *segment_ti;
     proto_tree *segment_tree;
-    guint      total_length=0;
+    guint      total_length=reassembly_info->data_length;
 
     /* Create root of source info */
     source_ti = proto_tree_add_item(tree,
@@ -556,9 +578,6 @@ static void reassembly_show_source(rlc_channel_reassembly_info *reassembly_info,
     source_tree = proto_item_add_subtree(source_ti, ett_rlc_lte_reassembly_source);
     PROTO_ITEM_SET_GENERATED(source_ti);
 
-    for (n=0; n < reassembly_info->number_of_segments; n++) {
-        total_length += reassembly_info->segments[n].length;
-    }
     proto_item_append_text(source_ti, " %u segments, %u bytes", reassembly_info->number_of_segments,
                            total_length);
 
@@ -9103,8 +9103,15 @@ void proto_register_rtps(void) {
 
 
 void proto_reg_handoff_rtps(void) {
+  /* The checks dissect_rtps() starts with */
+  static const guint8 rtps_magic[] = { 'R', 'T', 'P', 'S' };
+  static const heur_precheck_t rtps_udp_precheck = { 16, 0, rtps_magic, 4 };
+  static const heur_precheck_t rtps_tcp_precheck = { 20, 4, rtps_magic, 4 };
+
   heur_dissector_add("udp", dissect_rtps_udp, proto_rtps);
   heur_dissector_add("tcp", dissect_rtps_tcp, proto_rtps);
+  heur_dissector_set_precheck("udp", dissect_rtps_udp, proto_rtps, &rtps_udp_precheck);
+  heur_dissector_set_precheck("tcp", dissect_rtps_tcp, proto_rtps, &rtps_tcp_precheck);
 }
 
 /*
@@ -40,6 +40,7 @@
 #include <epan/tap.h>
 #include <epan/exported_pdu.h>
 #include <epan/expert.h>
+#include <epan/intern.h>
 
 #include <wsutil/str_util.h>
 
@@ -924,10 +925,11 @@ static GHashTable *sip_headers_hash = NULL;     /* Hash table */
 #define MAX_CALL_ID_SIZE 128
 #define MAGIC_SOURCE_PORT 0
 
-/* Conversation-type key */
+/* Conversation-type key; the call ID and addresses of keys in the table
+ * are interned */
 typedef struct
 {
-    char call_id[MAX_CALL_ID_SIZE];
+    const char *call_id;
     address source_address;
     guint32 source_port;
     address dest_address;
@@ -966,6 +968,14 @@ typedef struct
 /************************/
 /* Hash table functions */
 
+/* Hash key by call id */
+static guint sip_hash_func(gconstpointer v)
+{
+    const sip_hash_key* key = (const sip_hash_key*)v;
+
+    return g_str_hash(key->call_id);
+}
+
 /* Equal keys */
 static gint sip_equal(gconstpointer v, gconstpointer v2)
 {
@@ -973,7 +983,7 @@ static gint sip_equal(gconstpointer v, gconstpointer v2)
     const sip_hash_key* val2 = (const sip_hash_key*)v2;
 
     /* Call id must match */
-    if (strcmp(val1->call_id, val2->call_id) != 0)
+    if (val1->call_id != val2->call_id && strcmp(val1->call_id, val2->call_id) != 0)
     {
         return 0;
     }
@@ -999,7 +1009,7 @@ sip_init_protocol(void)
         g_hash_table_destroy(sip_hash);
 
     /* Now create them again */
-    sip_hash = g_hash_table_new(g_str_hash , sip_equal);
+    sip_hash = g_hash_table_new(sip_hash_func , sip_equal);
     /* Create a hashtable with the SIP headers; it will be used to find the related hf entry (POS_x).
      * This is faster than the previously used for loop.
      * There is no g_hash_table_destroy as the lifetime is the same as the lifetime of Wireshark.
@@ -4231,7 +4241,7 @@ guint sip_is_packet_resend(packet_info *pinfo,
     /* No packet entry found, consult global hash table */
 
     /* Prepare the key */
-    g_strlcpy(key.call_id, call_id, MAX_CALL_ID_SIZE);
+    key.call_id = call_id;
 
     /*  We're only using these addresses locally (for the hash lookup) so
      *  there is no need to make a (g_malloc'd) copy of them.
@@ -4278,9 +4288,9 @@ guint sip_is_packet_resend(packet_info *pinfo,
         p_val = wmem_new0(wmem_file_scope(), sip_hash_value);
 
         /* Fill in key and value details */
-        g_snprintf(p_key->call_id, MAX_CALL_ID_SIZE, "%s", call_id);
-        WMEM_COPY_ADDRESS(wmem_file_scope(), &(p_key->dest_address), &pinfo->net_dst);
-        WMEM_COPY_ADDRESS(wmem_file_scope(), &(p_key->source_address), &pinfo->net_src);
+        p_key->call_id = intern_string(call_id);
+        intern_address(&(p_key->dest_address), &pinfo->net_dst);
+        intern_address(&(p_key->source_address), &pinfo->net_src);
         p_key->dest_port = pinfo->destport;
         if (sip_retrans_the_same_sport) {
             p_key->source_port = pinfo->srcport;
@@ -4429,7 +4439,7 @@ guint sip_find_request(packet_info *pinfo,
     /* No packet entry found, consult global hash table */
 
     /* Prepare the key */
-    g_strlcpy(key.call_id, call_id, MAX_CALL_ID_SIZE);
+    key.call_id = call_id;
 
     /* Looking for matching request, so reverse addresses for this lookup */
     SET_ADDRESS(&key.dest_address, pinfo->net_src.type, pinfo->net_src.len,
@@ -4543,7 +4553,7 @@ guint sip_find_invite(packet_info *pinfo,
     /* No packet entry found, consult global hash table */
 
     /* Prepare the key */
-    g_strlcpy(key.call_id, call_id, MAX_CALL_ID_SIZE);
+    key.call_id = call_id;
 
     /* Looking for matching INVITE */
     SET_ADDRESS(&key.dest_address, pinfo->net_dst.type, pinfo->net_dst.len,
@@ -561,6 +561,10 @@ static const value_string smb2_negotiate_context_types[] = {
 	{ 0, NULL }
 };
 
+/* NT status of the interim response to a command that completes
+   asynchronously */
+#define SMB2_STATUS_PENDING	0x00000103
+
 static const gint8 zeros[NTLMSSP_KEY_LEN] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 
 /* ExportObject preferences variable */
@@ -568,7 +572,9 @@ gboolean eosmb2_take_name_as_fid = FALSE ;
 
 /* unmatched smb_saved_info structures.
    For unmatched smb_saved_info structures we store the smb_saved_info
-   structure using the msg_id field.
+   structure using the msg_id field.  Once the response has been seen the
+   structure is only found through the per-frame data of the request and
+   response frames, so the table only holds outstanding requests.
 */
 static gint
 smb2_saved_info_equal_unmatched(gconstpointer k1, gconstpointer k2)
@@ -587,27 +593,6 @@ smb2_saved_info_hash_unmatched(gconstpointer k)
 	return hash;
 }
 
-/* matched smb_saved_info structures.
-   For matched smb_saved_info structures we store the smb_saved_info
-   structure using the msg_id field.
-*/
-static gint
-smb2_saved_info_equal_matched(gconstpointer k1, gconstpointer k2)
-{
-	const smb2_saved_info_t *key1 = (const smb2_saved_info_t *)k1;
-	const smb2_saved_info_t *key2 = (const smb2_saved_info_t *)k2;
-	return key1->msg_id == key2->msg_id;
-}
-static guint
-smb2_saved_info_hash_matched(gconstpointer k)
-{
-	const smb2_saved_info_t *key = (const smb2_saved_info_t *)k;
-	guint32 hash;
-
-	hash = (guint32) (key->msg_id&0xffffffff);
-	return hash;
-}
-
 /* For Tids of a specific conversation.
    This keeps track of tid->sharename mappings and other information about the
    tid.
@@ -664,7 +649,6 @@ smb2_conv_destroy(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_,
 {
 	smb2_conv_info_t *conv = (smb2_conv_info_t *)user_data;
 
-	g_hash_table_destroy(conv->matched);
 	g_hash_table_destroy(conv->unmatched);
 	g_hash_table_destroy(conv->sesids);
 	g_hash_table_destroy(conv->files);
@@ -7071,8 +7055,6 @@ dissect_smb2(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, gboolea
 		si->conv = wmem_new(wmem_file_scope(), smb2_conv_info_t);
 		/* qqq this leaks memory for now since we never free
 		   the hashtables */
-		si->conv->matched = g_hash_table_new(smb2_saved_info_hash_matched,
-			smb2_saved_info_equal_matched);
 		si->conv->unmatched = g_hash_table_new(smb2_saved_info_hash_unmatched,
 			smb2_saved_info_equal_unmatched);
 		si->conv->sesids = g_hash_table_new(smb2_sesid_info_hash,
@@ -7228,22 +7210,31 @@ dissect_smb2(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, gboolea
 				}
 			} else {
 				/* This is a response */
-				if (ssi) {
-					/* just  set the response frame and move it to the matched table */
+				if (ssi && (si->flags & SMB2_FLAGS_ASYNC_CMD) &&
+				    si->status == SMB2_STATUS_PENDING) {
+					/* an interim response; the final one
+					 * has the same msg_id, so leave the
+					 * request in the unmatched table for it
+					 */
+				} else if (ssi) {
+					/* just set the response frame; from now on
+					 * the request is found through the frames
+					 */
 					ssi->frame_res = pinfo->fd->num;
 					g_hash_table_remove(si->conv->unmatched, ssi);
-					g_hash_table_insert(si->conv->matched, ssi, ssi);
 				}
 			}
-		} else {
-			/* see if we can find this msg_id in the matched table */
-			ssi = (smb2_saved_info_t *)g_hash_table_lookup(si->conv->matched, &ssi_key);
-			/* if we couldn't find it in the matched table, it might still
-			* be in the unmatched table
-			*/
-			if (!ssi) {
-				ssi = (smb2_saved_info_t *)g_hash_table_lookup(si->conv->unmatched, &ssi_key);
+			if (ssi) {
+				p_add_proto_data(wmem_file_scope(), pinfo, proto_smb2,
+						 (guint32)si->msg_id, ssi);
 			}
+		} else {
+			/* see if we found this msg_id the first time around;
+			 * there may be more than one command in a frame, but
+			 * not with the same msg_id
+			 */
+			ssi = (smb2_saved_info_t *)p_get_proto_data(wmem_file_scope(), pinfo,
+								    proto_smb2, (guint32)si->msg_id);
 		}
 
 		if (ssi) {
@@ -92,9 +92,8 @@ typedef struct _smb2_sesid_info_t {
  * There is one such structure for each conversation.
  */
 typedef struct _smb2_conv_info_t {
-	/* these two tables are used to match requests with responses */
+	/* requests that haven't been matched with a response yet */
 	GHashTable *unmatched;
-	GHashTable *matched;
 	GHashTable *sesids;
 	/* table to store some infos for smb export object */
 	GHashTable *files;
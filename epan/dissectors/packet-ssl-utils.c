@@ -2511,7 +2511,8 @@ ssl_decrypt_pre_master_secret(SslDecryptSession *ssl_session,
                               SSL_PRIVATE_KEY *pk);
 static gboolean
 ssl_restore_master_key(SslDecryptSession *ssl, const char *label,
-                       gboolean is_pre_master, GHashTable *ht, StringInfo *key);
+                       gboolean is_pre_master, GHashTable *ht,
+                       GHashTable *keylog_ht, StringInfo *key);
 
 gboolean
 ssl_generate_pre_master_secret(SslDecryptSession *ssl_session,
@@ -2632,7 +2633,8 @@ ssl_generate_pre_master_secret(SslDecryptSession *ssl_session,
          * ssl key logfile stores only the first 8 bytes, so truncate it */
         encrypted_pre_master.data_len = 8;
         if (ssl_restore_master_key(ssl_session, "Encrypted pre-master secret",
-            TRUE, mk_map->pre_master, &encrypted_pre_master))
+            TRUE, mk_map->pre_master, mk_map->keylog_pre_master,
+            &encrypted_pre_master))
             return TRUE;
     }
     return FALSE;
@@ -2984,6 +2986,34 @@ static gint fmt_seq(guint32 num, guint8* buf)
     return(0);
 }
 
+static gboolean
+ssl_decoder_hmac_destroy_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_, void *user_data)
+{
+    SslDecoder *decoder = (SslDecoder *)user_data;
+
+    ssl_hmac_cleanup(&decoder->mac_ctx);
+    return FALSE;
+}
+
+/* Get the decoder's HMAC ready for a record.  It's only keyed (which
+ * costs a couple of digest blocks) for the first record; after that it's
+ * reset, which keeps the key. */
+static gint
+ssl_decoder_hmac_begin(SslDecoder *decoder, gint md)
+{
+    if (decoder->mac_ctx) {
+        gcry_md_reset(decoder->mac_ctx);
+        return 0;
+    }
+    if (ssl_hmac_init(&decoder->mac_ctx, decoder->mac_key.data, decoder->mac_key.data_len, md) != 0) {
+        decoder->mac_ctx = NULL;
+        return -1;
+    }
+    /* the decoder is in file scope, so close the handle along with it */
+    wmem_register_callback(wmem_file_scope(), ssl_decoder_hmac_destroy_cb, decoder);
+    return 0;
+}
+
 static gint
 tls_check_mac(SslDecoder*decoder, gint ct, gint ver, guint8* data,
         guint32 datalen, guint8* mac)
@@ -2998,8 +3028,9 @@ tls_check_mac(SslDecoder*decoder, gint ct, gint ver, guint8* data,
     ssl_debug_printf("tls_check_mac mac type:%s md %d\n",
         ssl_cipher_suite_dig(decoder->cipher_suite)->name, md);
 
-    if (ssl_hmac_init(&hm,decoder->mac_key.data,decoder->mac_key.data_len,md) != 0)
+    if (ssl_decoder_hmac_begin(decoder, md) != 0)
         return -1;
+    hm = decoder->mac_ctx;
 
     /* hash sequence number */
     fmt_seq(decoder->seq,buf);
@@ -3027,7 +3058,6 @@ tls_check_mac(SslDecoder*decoder, gint ct, gint ver, guint8* data,
     /* get digest and digest len*/
     len = sizeof(buf);
     ssl_hmac_final(&hm,buf,&len);
-    ssl_hmac_cleanup(&hm);
     ssl_print_data("Mac", buf, len);
     if(memcmp(mac,buf,len))
         return -1;
@@ -3113,8 +3143,9 @@ dtls_check_mac(SslDecoder*decoder, gint ct,int ver, guint8* data,
     ssl_debug_printf("dtls_check_mac mac type:%s md %d\n",
         ssl_cipher_suite_dig(decoder->cipher_suite)->name, md);
 
-    if (ssl_hmac_init(&hm,decoder->mac_key.data,decoder->mac_key.data_len,md) != 0)
+    if (ssl_decoder_hmac_begin(decoder, md) != 0)
         return -1;
+    hm = decoder->mac_ctx;
     ssl_debug_printf("dtls_check_mac seq: %d epoch: %d\n",decoder->seq,decoder->epoch);
     /* hash sequence number */
     fmt_seq(decoder->seq,buf);
@@ -3139,7 +3170,6 @@ dtls_check_mac(SslDecoder*decoder, gint ct,int ver, guint8* data,
     /* get digest and digest len */
     len = sizeof(buf);
     ssl_hmac_final(&hm,buf,&len);
-    ssl_hmac_cleanup(&hm);
     ssl_print_data("Mac", buf, len);
     if(memcmp(mac,buf,len))
         return -1;
@@ -4274,7 +4304,7 @@ ssl_get_data_info(int proto, packet_info *pinfo, gint key)
 
 /* initialize/reset per capture state data (ssl sessions cache) */
 void
-ssl_common_init(ssl_master_key_map_t *mk_map, FILE **ssl_keylog_file,
+ssl_common_init(ssl_master_key_map_t *mk_map,
                 StringInfo *decrypted_data, StringInfo *compressed_data)
 {
     if (mk_map->session)
@@ -4292,18 +4322,21 @@ ssl_common_init(ssl_master_key_map_t *mk_map, FILE **ssl_keylog_file,
     else
         mk_map->pre_master = g_hash_table_new(ssl_hash, ssl_equal);
 
+    /* the keylog maps outlive the capture file; see ssl_load_keyfile() */
+    if (!mk_map->keylog_session) {
+        mk_map->keylog_session = g_hash_table_new_full(ssl_hash, ssl_equal, g_free, g_free);
+        mk_map->keylog_crandom = g_hash_table_new_full(ssl_hash, ssl_equal, g_free, g_free);
+        mk_map->keylog_pre_master = g_hash_table_new_full(ssl_hash, ssl_equal, g_free, g_free);
+    }
+
     g_free(decrypted_data->data);
     ssl_data_alloc(decrypted_data, 32);
 
     g_free(compressed_data->data);
     ssl_data_alloc(compressed_data, 32);
 
-    /* close the previous keylog file now that the cache are cleared, this
-     * allows the cache to be filled with the full keylog file contents. */
-    if (*ssl_keylog_file) {
-        fclose(*ssl_keylog_file);
-        *ssl_keylog_file = NULL;
-    }
+    /* the keylog file is left open, as what it has said so far is still in
+     * the keylog maps; ssl_load_keyfile() reopens it if it gets replaced. */
 }
 
 /* parse ssl related preferences (private keys and ports association strings) */
@@ -4437,10 +4470,12 @@ ssl_save_master_key(const char *label, GHashTable *ht, StringInfo *key,
     ssl_print_string("stored (pre-)master secret", master_secret);
 }
 
-/** restore a (pre-)master secret given some key in the cache */
+/** restore a (pre-)master secret given some key in the cache, or failing
+ * that in what the keylog file said */
 static gboolean
 ssl_restore_master_key(SslDecryptSession *ssl, const char *label,
-                       gboolean is_pre_master, GHashTable *ht, StringInfo *key)
+                       gboolean is_pre_master, GHashTable *ht,
+                       GHashTable *keylog_ht, StringInfo *key)
 {
     StringInfo *ms;
 
@@ -4451,6 +4486,8 @@ ssl_restore_master_key(SslDecryptSession *ssl, const char *label,
     }
 
     ms = (StringInfo *)g_hash_table_lookup(ht, key);
+    if (!ms && keylog_ht)
+        ms = (StringInfo *)g_hash_table_lookup(keylog_ht, key);
     if (!ms) {
         ssl_debug_printf("%s can't find %smaster secret by %s\n", G_STRFUNC,
                          is_pre_master ? "pre-" : "", label);
@@ -4495,11 +4532,14 @@ ssl_finalize_decryption(SslDecryptSession *ssl, ssl_master_key_map_t *mk_map)
      * (an earlier packet in the capture or key logfile). */
     if (!(ssl->state & (SSL_MASTER_SECRET | SSL_PRE_MASTER_SECRET)) &&
         !ssl_restore_master_key(ssl, "Session ID", FALSE,
-                                mk_map->session, &ssl->session_id) &&
+                                mk_map->session, mk_map->keylog_session,
+                                &ssl->session_id) &&
         !ssl_restore_master_key(ssl, "Session Ticket", FALSE,
-                                mk_map->session, &ssl->session_ticket) &&
+                                mk_map->session, mk_map->keylog_session,
+                                &ssl->session_ticket) &&
         !ssl_restore_master_key(ssl, "Client Random", FALSE,
-                                mk_map->crandom, &ssl->client_random)) {
+                                mk_map->crandom, mk_map->keylog_crandom,
+                                &ssl->client_random)) {
         /* how unfortunate, the master secret could not be found */
         ssl_debug_printf("  Cannot find master secret\n");
         return;
@@ -4560,44 +4600,83 @@ ssl_is_valid_handshake_type(guint8 hs_type, gboolean is_dtls)
 
 /** keyfile handling */
 
-/* returns >0 on success and outputs regexes in regexes_out */
-static guint
-ssl_compile_keyfile_regexes(GRegex ***regexes_out)
+/* Decode the |len| bytes hex-encoded at |*in|, advancing |*in| past them;
+ * returns FALSE if there aren't that many. */
+static gboolean
+keylog_decode_hex(const char **in, guchar *out, guint len)
 {
-#define OCTET "(?:[[:xdigit:]]{2})"
-#define SSL_REGEX_MK "(" OCTET "{" G_STRINGIFY(SSL_MASTER_SECRET_LENGTH) "})"
-    const gchar *patterns[] = {
-        "RSA (" OCTET "{8}) " SSL_REGEX_MK,
-        "RSA Session-ID:(" OCTET "+) Master-Key:" SSL_REGEX_MK,
-        "CLIENT_RANDOM (" OCTET "{32}) " SSL_REGEX_MK
-    };
-#undef SSL_REGEX_MK
-#undef OCTET
-    static GRegex **regexes = NULL;
-    unsigned i;
-    GError *gerr = NULL;
-
-    if (!regexes) {
-        regexes = (GRegex**) g_malloc(array_length(patterns) * sizeof(GRegex *));
-        for (i = 0; i < array_length(patterns); i++) {
-            regexes[i] = g_regex_new(patterns[i], G_REGEX_OPTIMIZE,
-                    G_REGEX_MATCH_ANCHORED, &gerr);
-            if (gerr) {
-                ssl_debug_printf("%s failed to compile %s: %s\n", G_STRFUNC,
-                        patterns[i], gerr->message);
-                g_error_free(gerr);
-                /* failed to compile some regexes, free resources and fail */
-                while (i-- > 0)
-                    g_regex_unref(regexes[i]);
-                g_free(regexes);
-                regexes = NULL;
-                return 0;
-            }
-        }
+    const char *p = *in;
+    guint i;
+
+    for (i = 0; i < len; i++) {
+        int a = ws_xton(p[0]);
+        int b;
+
+        if (a < 0)
+            return FALSE;
+        b = ws_xton(p[1]);
+        if (b < 0)
+            return FALSE;
+        out[i] = (guchar)(a << 4 | b);
+        p += 2;
+    }
+    *in = p;
+    return TRUE;
+}
+
+/* Copy a key or secret from the keylog; it and its data are a single
+ * g_malloc'd block, with the data aligned as ssl_hash() needs it. */
+static StringInfo *
+keylog_data_new(const guchar *data, guint len)
+{
+    StringInfo *str;
+
+    str = (StringInfo *) g_malloc(sizeof(StringInfo) + len);
+    str->data = (guchar *) (str + 1);
+    str->data_len = len;
+    memcpy(str->data, data, len);
+    return str;
+}
+
+/* Parse a line of the keylog file; returns which of the keylog maps the
+ * key goes in (0 for pre_master, 1 for session, 2 for crandom) or -1 if
+ * the line isn't one we understand.  Anything after the master secret
+ * is ignored. */
+static int
+keylog_parse_line(const char *line, guchar *key, guint *key_len, guchar *ms)
+{
+    const char *p;
+    int type;
+
+    if (strncmp(line, "RSA Session-ID:", 15) == 0) {
+        /* the session ID is any number of octets */
+        p = line + 15;
+        *key_len = 0;
+        while (*key_len < 256 && keylog_decode_hex(&p, key + *key_len, 1))
+            (*key_len)++;
+        if (*key_len == 0 || strncmp(p, " Master-Key:", 12) != 0)
+            return -1;
+        p += 12;
+        type = 1;
+    } else if (strncmp(line, "RSA ", 4) == 0) {
+        p = line + 4;
+        *key_len = 8;
+        if (!keylog_decode_hex(&p, key, *key_len) || *p++ != ' ')
+            return -1;
+        type = 0;
+    } else if (strncmp(line, "CLIENT_RANDOM ", 14) == 0) {
+        p = line + 14;
+        *key_len = 32;
+        if (!keylog_decode_hex(&p, key, *key_len) || *p++ != ' ')
+            return -1;
+        type = 2;
+    } else {
+        return -1;
     }
 
-    *regexes_out = regexes;
-    return array_length(patterns);
+    if (!keylog_decode_hex(&p, ms, SSL_MASTER_SECRET_LENGTH))
+        return -1;
+    return type;
 }
 
 static gboolean
@@ -4624,13 +4703,10 @@ void
 ssl_load_keyfile(const gchar *ssl_keylog_filename, FILE **keylog_file,
                  const ssl_master_key_map_t *mk_map)
 {
-    unsigned i;
-    guint re_count;
-    GRegex **regexes = NULL;
     GHashTable *hts[] = {
-        mk_map->pre_master,
-        mk_map->session,
-        mk_map->crandom
+        mk_map->keylog_pre_master,
+        mk_map->keylog_session,
+        mk_map->keylog_crandom
     };
 
     /* no need to try if no key log file is configured. */
@@ -4658,18 +4734,23 @@ ssl_load_keyfile(const gchar *ssl_keylog_filename, FILE **keylog_file,
      *     Where yyy is the cleartext master secret (hex-encoded)
      *     (This format allows non-RSA SSL connections to be decrypted, i.e.
      *     ECDHE-RSA.)
+     *
+     * What has been read is kept in the keylog maps, which aren't cleared
+     * when a new capture file is opened, so each line is only parsed once;
+     * the file is left open, and only the lines added to it since the last
+     * call are read.
      */
-    re_count = ssl_compile_keyfile_regexes(&regexes);
-    if (re_count == 0)
-        return;
-
     ssl_debug_printf("trying to use SSL keylog in %s\n", ssl_keylog_filename);
 
-    /* if the keylog file was deleted, re-open it */
+    /* if the keylog file was deleted (or another one configured), re-open
+     * it and forget what the old one said */
     if (*keylog_file && file_needs_reopen(*keylog_file, ssl_keylog_filename)) {
         ssl_debug_printf("%s file got deleted, trying to re-open\n", G_STRFUNC);
         fclose(*keylog_file);
         *keylog_file = NULL;
+        g_hash_table_remove_all(mk_map->keylog_pre_master);
+        g_hash_table_remove_all(mk_map->keylog_session);
+        g_hash_table_remove_all(mk_map->keylog_crandom);
     }
 
     if (*keylog_file == NULL) {
@@ -4683,6 +4764,9 @@ ssl_load_keyfile(const gchar *ssl_keylog_filename, FILE **keylog_file,
     for (;;) {
         char buf[512], *line;
         gsize bytes_read;
+        guchar key[256], ms[SSL_MASTER_SECRET_LENGTH];
+        guint key_len;
+        int type;
 
         line = fgets(buf, sizeof(buf), *keylog_file);
         if (!line)
@@ -4700,33 +4784,15 @@ ssl_load_keyfile(const gchar *ssl_keylog_filename, FILE **keylog_file,
         }
 
         ssl_debug_printf("  checking keylog line: %s\n", line);
-        for (i = 0; i < re_count; i++) {
-            gchar *hex_key, *hex_ms;
-            StringInfo *ms, *key;
-            GMatchInfo *mi;
-            if (!g_regex_match(regexes[i], line, G_REGEX_MATCH_ANCHORED, &mi)) {
-                g_match_info_free(mi);
-                continue;
-            }
-
-            /* convert from hex to bytes and save to hashtable */
-            hex_key = g_match_info_fetch(mi, 1);
-            hex_ms = g_match_info_fetch(mi, 2);
-            g_match_info_free(mi);
-
-            key = (StringInfo *) wmem_alloc(wmem_file_scope(), sizeof(StringInfo));
-            ms = (StringInfo *) wmem_alloc(wmem_file_scope(), sizeof(StringInfo));
-            from_hex(key, hex_key, strlen(hex_key));
-            from_hex(ms, hex_ms, strlen(hex_ms));
-            g_hash_table_insert(hts[i], key, ms);
-            g_free(hex_key);
-            g_free(hex_ms);
-            ssl_debug_printf("    matched type %d\n", i);
-            break; /* found a match, no need to continue */
+        type = keylog_parse_line(line, key, &key_len, ms);
+        if (type < 0) {
+            ssl_debug_printf("    unrecognized line\n");
+            continue;
         }
 
-        if (i == re_count)
-            ssl_debug_printf("    unrecognized line\n");
+        g_hash_table_insert(hts[type], keylog_data_new(key, key_len),
+                            keylog_data_new(ms, SSL_MASTER_SECRET_LENGTH));
+        ssl_debug_printf("    matched type %d\n", type);
     }
 }
 
@@ -46,6 +46,7 @@
 
 #ifdef HAVE_LIBGCRYPT
 #define SSL_CIPHER_CTX gcry_cipher_hd_t
+#define SSL_MAC_CTX gcry_md_hd_t
 #ifdef SSL_FAST
 #define SSL_PRIVATE_KEY gcry_mpi_t
 #else /* SSL_FAST */
@@ -53,6 +54,7 @@
 #endif /* SSL_FAST */
 #else  /* HAVE_LIBGCRYPT */
 #define SSL_CIPHER_CTX void*
+#define SSL_MAC_CTX void*
 #define SSL_PRIVATE_KEY void
 #endif /* HAVE_LIBGCRYPT */
 
@@ -291,6 +293,7 @@ typedef struct _SslDecoder {
     StringInfo mac_key; /* for block and stream ciphers */
     StringInfo write_iv; /* for AEAD ciphers (at least GCM, CCM) */
     SSL_CIPHER_CTX evp;
+    SSL_MAC_CTX mac_ctx; /* HMAC keyed with mac_key, once a record has been checked */
     SslDecompress *decomp;
     guint32 seq;
     guint16 epoch;
@@ -438,6 +441,11 @@ typedef struct {
     GHashTable *crandom;    /* Client Random to master secret */
     GHashTable *pre_master; /* First 8 bytes of encrypted pre-master secret to
                                pre-master secret */
+    /* The same for what has been read from the key log file; these are kept
+       across capture files, so the file is only parsed once */
+    GHashTable *keylog_session;
+    GHashTable *keylog_crandom;
+    GHashTable *keylog_pre_master;
 } ssl_master_key_map_t;
 
 gint ssl_get_keyex_alg(gint cipher);
@@ -579,7 +587,7 @@ ssl_get_data_info(int proto, packet_info *pinfo, gint key);
 
 /* initialize/reset per capture state data (ssl sessions cache) */
 extern void
-ssl_common_init(ssl_master_key_map_t *master_key_map, FILE **ssl_keylog_file,
+ssl_common_init(ssl_master_key_map_t *master_key_map,
                 StringInfo *decrypted_data, StringInfo *compressed_data);
 
 /* tries to update the secrets cache from the given filename */
@@ -37,6 +37,7 @@
 #include <epan/reassemble.h>
 #include <epan/decode_as.h>
 #include <epan/in_cksum.h>
+#include <epan/field_store.h>
 
 #include "packet-tcp.h"
 #include "packet-ip.h"
@@ -498,6 +499,7 @@ static heur_dissector_list_t heur_subdissector_list;
 static dissector_handle_t data_handle;
 static dissector_handle_t sport_handle;
 static guint32 tcp_stream_count;
+static field_frame_index_t *tcp_stream_index = NULL;  /* frames in each stream */
 
 /* XXX - redefined here to not create UI dependencies */
 #define UTF8_LEFTWARDS_ARROW            "\xe2\x86\x90"      /* 8592 / 0x2190 */
@@ -708,19 +710,18 @@ init_tcp_conversation_data(packet_info *pinfo)
     tcpd=wmem_new0(wmem_file_scope(), struct tcp_analysis);
     tcpd->flow1.win_scale=-1;
     tcpd->flow1.window = G_MAXUINT32;
-    tcpd->flow1.multisegment_pdus=wmem_tree_new(wmem_file_scope());
+    tcpd->flow1.multisegment_pdus=wmem_tree_new_btree(wmem_file_scope());
     /*
     tcpd->flow1.username = NULL;
     tcpd->flow1.command = NULL;
     */
     tcpd->flow2.window = G_MAXUINT32;
     tcpd->flow2.win_scale=-1;
-    tcpd->flow2.multisegment_pdus=wmem_tree_new(wmem_file_scope());
+    tcpd->flow2.multisegment_pdus=wmem_tree_new_btree(wmem_file_scope());
     /*
     tcpd->flow2.username = NULL;
     tcpd->flow2.command = NULL;
     */
-    tcpd->acked_table=wmem_tree_new(wmem_file_scope());
     tcpd->ts_first.secs=pinfo->fd->abs_ts.secs;
     tcpd->ts_first.nsecs=pinfo->fd->abs_ts.nsecs;
     nstime_set_zero(&tcpd->ts_mru_syn);
@@ -1025,61 +1026,109 @@ pdu_store_window_scale_option(guint8 ws, struct tcp_analysis *tcpd)
 }
 
 /* when this function returns, it will (if createflag) populate the ta pointer.
+ *
+ * The analysis results are attached to the frame, keyed by the layer the
+ * TCP header is at, so once the first pass has worked them out any later
+ * pass finds them without searching anything of the conversation's.
  */
 static void
-tcp_analyze_get_acked_struct(guint32 frame, guint32 seq, guint32 ack, gboolean createflag, struct tcp_analysis *tcpd)
+tcp_analyze_get_acked_struct(packet_info *pinfo, gboolean createflag, struct tcp_analysis *tcpd)
 {
+    if (!tcpd) {
+        return;
+    }
 
-    wmem_tree_key_t key[4];
+    tcpd->ta = (struct tcp_acked *)p_get_proto_data(wmem_file_scope(), pinfo, proto_tcp, pinfo->curr_layer_num);
+    if((!tcpd->ta) && createflag) {
+        tcpd->ta = wmem_new0(wmem_file_scope(), struct tcp_acked);
+        p_add_proto_data(wmem_file_scope(), pinfo, proto_tcp, pinfo->curr_layer_num, (void *)tcpd->ta);
+    }
+}
 
-    key[0].length = 1;
-    key[0].key = &frame;
 
-    key[1].length = 1;
-    key[1].key = &seq;
+/* The i'th unacked segment of a ring */
+#define UNACKED_SEGMENT(ring, i) \
+    (&(ring)->segs[((ring)->head + (i)) & ((ring)->size - 1)])
 
-    key[2].length = 1;
-    key[2].key = &ack;
+/* Make room for a segment in a ring of unacked segments and return it;
+ * the caller fills it in.
+ */
+static tcp_unacked_t *
+tcp_unacked_insert(tcp_unacked_ring_t *ring, guint32 nextseq)
+{
+    guint32 i, lo, hi, mid;
 
-    key[3].length = 0;
-    key[3].key = NULL;
+    if (ring->count == ring->size) {
+        tcp_unacked_t *segs;
+        guint32 size = ring->size ? ring->size * 2 : 16;
 
-    if (!tcpd) {
-        return;
+        segs = wmem_alloc_array(wmem_file_scope(), tcp_unacked_t, size);
+        for (i = 0; i < ring->count; i++) {
+            segs[i] = *UNACKED_SEGMENT(ring, i);
+        }
+        if (ring->segs) {
+            wmem_free(wmem_file_scope(), ring->segs);
+        }
+        ring->segs = segs;
+        ring->size = size;
+        ring->head = 0;
     }
 
-    tcpd->ta = (struct tcp_acked *)wmem_tree_lookup32_array(tcpd->acked_table, key);
-    if((!tcpd->ta) && createflag) {
-        tcpd->ta = wmem_new0(wmem_file_scope(), struct tcp_acked);
-        wmem_tree_insert32_array(tcpd->acked_table, key, (void *)tcpd->ta);
+    /* Usually this is the highest nextseq so far, so it goes at the
+     * tail; otherwise (retransmissions and such) find its place after
+     * any segments with the same or a lower nextseq and move the rest
+     * up.
+     */
+    i = ring->count;
+    if (i > 0 && LT_SEQ(nextseq, UNACKED_SEGMENT(ring, i-1)->nextseq)) {
+        lo = 0;
+        hi = i;
+        while (lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            if (LE_SEQ(UNACKED_SEGMENT(ring, mid)->nextseq, nextseq)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (; i > lo; i--) {
+            *UNACKED_SEGMENT(ring, i) = *UNACKED_SEGMENT(ring, i-1);
+        }
     }
+    ring->count++;
+    return UNACKED_SEGMENT(ring, i);
 }
 
-
-/* fwd contains a list of all segments processed but not yet ACKed in the
+/* fwd contains the segments processed but not yet ACKed in the
  *     same direction as the current segment.
- * rev contains a list of all segments received but not yet ACKed in the
+ * rev contains the segments received but not yet ACKed in the
  *     opposite direction to the current segment.
  *
- * New segments are always added to the head of the fwd/rev lists.
+ * Both are sorted by nextseq, so an ACK only has to look at the segments
+ * it removes, plus the one after them.
  *
  */
 static void
 tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint32 seglen, guint16 flags, guint32 window, struct tcp_analysis *tcpd)
 {
     tcp_unacked_t *ual=NULL;
-    tcp_unacked_t *prevual=NULL;
+    tcp_unacked_ring_t *ring;
     guint32 nextseq;
-    int ackcount;
+    guint32 i;
+    gboolean matched;
 
 #if 0
     printf("\nanalyze_sequence numbers   frame:%u\n",pinfo->fd->num);
     printf("FWD list lastflags:0x%04x base_seq:%u:\n",tcpd->fwd->lastsegmentflags,tcpd->fwd->base_seq);
-    for(ual=tcpd->fwd->segments; ual; ual=ual->next)
+    for(i=0; i<tcpd->fwd->segments.count; i++) {
+            ual=UNACKED_SEGMENT(&tcpd->fwd->segments, i);
             printf("Frame:%d Seq:%u Nextseq:%u\n",ual->frame,ual->seq,ual->nextseq);
+    }
     printf("REV list lastflags:0x%04x base_seq:%u:\n",tcpd->rev->lastsegmentflags,tcpd->rev->base_seq);
-    for(ual=tcpd->rev->segments; ual; ual=ual->next)
+    for(i=0; i<tcpd->rev->segments.count; i++) {
+            ual=UNACKED_SEGMENT(&tcpd->rev->segments, i);
             printf("Frame:%d Seq:%u Nextseq:%u\n",ual->frame,ual->seq,ual->nextseq);
+    }
 #endif
 
     if (!tcpd) {
@@ -1130,7 +1179,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  seq==tcpd->fwd->nextseq
     &&  tcpd->rev->window==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_ZERO_WINDOW_PROBE;
         goto finished_fwd;
@@ -1143,7 +1192,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     if( window==0
     && (flags&(TH_RST|TH_FIN|TH_SYN))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_ZERO_WINDOW;
     }
@@ -1161,7 +1210,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  GT_SEQ(seq, tcpd->fwd->nextseq)
     &&  (flags&(TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_LOST_PACKET;
 
@@ -1179,7 +1228,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  seq==(tcpd->fwd->nextseq-1)
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_KEEP_ALIVE;
     }
@@ -1195,7 +1244,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  ack==tcpd->fwd->lastack
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_WINDOW_UPDATE;
     }
@@ -1213,7 +1262,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  (seq+seglen)==(tcpd->rev->lastack+(tcpd->rev->window<<(tcpd->rev->win_scale==-2?0:tcpd->rev->win_scale)))
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_WINDOW_FULL;
     }
@@ -1231,7 +1280,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     && (tcpd->rev->lastsegmentflags&TCP_A_KEEP_ALIVE)
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_KEEP_ALIVE_ACK;
         goto finished_fwd;
@@ -1251,7 +1300,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     && (tcpd->rev->lastsegmentflags&TCP_A_ZERO_WINDOW_PROBE)
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_ZERO_WINDOW_PROBE_ACK;
         goto finished_fwd;
@@ -1270,7 +1319,7 @@ tcp_analyze_sequence_number(packet_info *pinfo, guint32 seq, guint32 ack, guint3
     &&  (flags&(TH_SYN|TH_FIN|TH_RST))==0 ) {
         tcpd->fwd->dupacknum++;
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_DUPLICATE_ACK;
         tcpd->ta->dupack_num=tcpd->fwd->dupacknum;
@@ -1299,7 +1348,7 @@ finished_fwd:
     &&  GT_SEQ(ack, tcpd->rev->maxseqtobeacked )
     &&  (flags&(TH_ACK))!=0 ) {
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_ACK_LOST_PACKET;
         /* update 'max seq to be acked' in the other direction so we don't get
@@ -1345,7 +1394,7 @@ finished_fwd:
         &&  tcpd->rev->lastack==seq
         &&  t<20000000 ) {
             if(!tcpd->ta) {
-                tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+                tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
             }
             tcpd->ta->flags|=TCP_A_FAST_RETRANSMISSION;
             goto finished_checking_retransmission_type;
@@ -1360,7 +1409,7 @@ finished_fwd:
         if( t < ooo_thres
         && tcpd->fwd->nextseq != seq + seglen ) {
             if(!tcpd->ta) {
-                tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+                tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
             }
             tcpd->ta->flags|=TCP_A_OUT_OF_ORDER;
             goto finished_checking_retransmission_type;
@@ -1372,7 +1421,7 @@ finished_fwd:
          */
         if ( seq + seglen < tcpd->rev->lastack ) {
             if(!tcpd->ta){
-                tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+                tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
             }
             tcpd->ta->flags|=TCP_A_SPURIOUS_RETRANSMISSION;
             goto finished_checking_retransmission_type;
@@ -1380,7 +1429,7 @@ finished_fwd:
 
         /* Then it has to be a generic retransmission */
         if(!tcpd->ta) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         }
         tcpd->ta->flags|=TCP_A_RETRANSMISSION;
         nstime_delta(&tcpd->ta->rto_ts, &pinfo->fd->abs_ts, &tcpd->fwd->nextseqtime);
@@ -1391,18 +1440,16 @@ finished_checking_retransmission_type:
 
     nextseq = seq+seglen;
     if (seglen || flags&(TH_SYN|TH_FIN)) {
-        /* add this new sequence number to the fwd list */
-        ual = wmem_new(wmem_file_scope(), tcp_unacked_t);
-        ual->next=tcpd->fwd->segments;
-        tcpd->fwd->segments=ual;
-        ual->frame=pinfo->fd->num;
-        ual->seq=seq;
-        ual->ts=pinfo->fd->abs_ts;
-
         /* next sequence number is seglen bytes away, plus SYN/FIN which counts as one byte */
         if( (flags&(TH_SYN|TH_FIN)) ) {
             nextseq+=1;
         }
+
+        /* add this new sequence number to the fwd list */
+        ual = tcp_unacked_insert(&tcpd->fwd->segments, nextseq);
+        ual->frame=pinfo->fd->num;
+        ual->seq=seq;
+        ual->ts=pinfo->fd->abs_ts;
         ual->nextseq=nextseq;
     }
 
@@ -1447,36 +1494,28 @@ finished_checking_retransmission_type:
     }
 
 
-    /* remove all segments this ACKs and we don't need to keep around any more
+    /* remove all segments this ACKs and we don't need to keep around any more;
+     * as they're sorted by nextseq they're all at the head of the list.
+     * If several end where this ACK does, it acks the first one seen.
      */
-    ackcount=0;
-    prevual = NULL;
-    ual = tcpd->rev->segments;
-    while(ual) {
-        tcp_unacked_t *tmpual;
+    ring = &tcpd->rev->segments;
+    matched = FALSE;
+    while (ring->count > 0) {
+        ual = UNACKED_SEGMENT(ring, 0);
+
+        /* If this acknowledges a segment prior to this one, leave it and the rest alone */
+        if (GT_SEQ(ual->nextseq, ack)) {
+            break;
+        }
 
         /* If this ack matches the segment, process accordingly */
-        if(ack==ual->nextseq) {
-            tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+        if (ack==ual->nextseq && !matched) {
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
             tcpd->ta->frame_acked=ual->frame;
             nstime_delta(&tcpd->ta->ts, &pinfo->fd->abs_ts, &ual->ts);
-        }
-        /* If this acknowledges part of the segment, adjust the segment info for the acked part */
-        else if (GT_SEQ(ack, ual->seq) && LE_SEQ(ack, ual->nextseq)) {
-            ual->seq = ack;
-            continue;
-        }
-        /* If this acknowledges a segment prior to this one, leave this segment alone and move on */
-        else if (GT_SEQ(ual->nextseq,ack)) {
-            prevual = ual;
-            ual = ual->next;
-            continue;
+            matched = TRUE;
         }
 
-        /* This segment is old, or an exact match.  Delete the segment from the list */
-        ackcount++;
-        tmpual=ual->next;
-
         if (tcpd->rev->scps_capable) {
           /* Track largest segment successfully sent for SNACK analysis*/
           if ((ual->nextseq - ual->seq) > tcpd->fwd->maxsizeacked) {
@@ -1484,39 +1523,39 @@ finished_checking_retransmission_type:
           }
         }
 
-        if (!prevual) {
-            tcpd->rev->segments = tmpual;
-        }
-        else{
-            prevual->next = tmpual;
+        /* This segment is old, or an exact match.  Delete the segment from the list */
+        ring->head = (ring->head + 1) & (ring->size - 1);
+        ring->count--;
+    }
+
+    /* If this acknowledges part of the segments after those, adjust the
+     * segment info for the acked part.  (Only the ones at the head are
+     * looked at; a segment further on can only span the ACK if it
+     * overlaps one before it.)
+     */
+    for (i = 0; i < ring->count; i++) {
+        ual = UNACKED_SEGMENT(ring, i);
+        if (!GT_SEQ(ack, ual->seq)) {
+            break;
         }
-        wmem_free(wmem_file_scope(), ual);
-        ual = tmpual;
+        ual->seq = ack;
     }
 
     /* how many bytes of data are there in flight after this frame
-     * was sent
+     * was sent: from the start of the first unacked segment to the end
+     * of the last one
      */
-    ual=tcpd->fwd->segments;
-    if (tcp_track_bytes_in_flight && seglen!=0 && ual && tcpd->fwd->valid_bif) {
+    ring = &tcpd->fwd->segments;
+    if (tcp_track_bytes_in_flight && seglen!=0 && ring->count && tcpd->fwd->valid_bif) {
         guint32 first_seq, last_seq, in_flight;
 
-        first_seq = ual->seq - tcpd->fwd->base_seq;
-        last_seq = ual->nextseq - tcpd->fwd->base_seq;
-        while (ual) {
-            if ((ual->nextseq-tcpd->fwd->base_seq)>last_seq) {
-                last_seq = ual->nextseq-tcpd->fwd->base_seq;
-            }
-            if ((ual->seq-tcpd->fwd->base_seq)<first_seq) {
-                first_seq = ual->seq-tcpd->fwd->base_seq;
-            }
-            ual = ual->next;
-        }
+        first_seq = UNACKED_SEGMENT(ring, 0)->seq - tcpd->fwd->base_seq;
+        last_seq = UNACKED_SEGMENT(ring, ring->count-1)->nextseq - tcpd->fwd->base_seq;
         in_flight = last_seq-first_seq;
 
         if (in_flight>0 && in_flight<2000000000) {
             if(!tcpd->ta) {
-                tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, TRUE, tcpd);
+                tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
             }
             tcpd->ta->bytes_in_flight = in_flight;
         }
@@ -1730,7 +1769,7 @@ tcp_sequence_number_analysis_print_bytes_in_flight(packet_info * pinfo _U_,
 
 static void
 tcp_print_sequence_number_analysis(packet_info *pinfo, tvbuff_t *tvb, proto_tree *parent_tree,
-                          struct tcp_analysis *tcpd, guint32 seq, guint32 ack)
+                          struct tcp_analysis *tcpd)
 {
     struct tcp_acked *ta = NULL;
     proto_item *item;
@@ -1741,7 +1780,7 @@ tcp_print_sequence_number_analysis(packet_info *pinfo, tvbuff_t *tvb, proto_tree
         return;
     }
     if(!tcpd->ta) {
-        tcp_analyze_get_acked_struct(pinfo->fd->num, seq, ack, FALSE, tcpd);
+        tcp_analyze_get_acked_struct(pinfo, FALSE, tcpd);
     }
     ta=tcpd->ta;
     if(!ta) {
@@ -2556,8 +2595,8 @@ dissect_tcpopt_tfo(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
     item = proto_tree_add_item(opt_tree, hf_tcp_option_tfo, tvb,
                                offset, optlen, ENC_NA);
     exp_tree = proto_item_add_subtree(item, ett_tcp_option_exp);
-    proto_tree_add_item(exp_tree, hf_tcp_option_kind, tvb, offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(exp_tree, hf_tcp_option_len, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(exp_tree, hf_tcp_option_kind, tvb, offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(exp_tree, hf_tcp_option_len, tvb, offset + 1, ENC_BIG_ENDIAN);
 
     dissect_tcpopt_tfo_payload(tvb, offset, optlen, pinfo, exp_tree);
 }
@@ -2572,12 +2611,12 @@ dissect_tcpopt_exp(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
     item = proto_tree_add_item(opt_tree, hf_tcp_option_exp, tvb,
                                offset, optlen, ENC_NA);
     exp_tree = proto_item_add_subtree(item, ett_tcp_option_exp);
-    proto_tree_add_item(exp_tree, hf_tcp_option_kind, tvb, offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(exp_tree, hf_tcp_option_len, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(exp_tree, hf_tcp_option_kind, tvb, offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(exp_tree, hf_tcp_option_len, tvb, offset + 1, ENC_BIG_ENDIAN);
     if (tcp_exp_options_with_magic && ((optlen - 2) > 0)) {
         magic = tvb_get_ntohs(tvb, offset + 2);
-        proto_tree_add_item(exp_tree, hf_tcp_option_exp_magic_number, tvb,
-                            offset + 2, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(exp_tree, hf_tcp_option_exp_magic_number, tvb,
+                                   offset + 2, ENC_BIG_ENDIAN);
         switch (magic) {
         case 0xf989:  /* RFC7413, TCP Fast Open */
             dissect_tcpopt_tfo_payload(tvb, offset+2, optlen-2, pinfo, exp_tree);
@@ -2603,8 +2642,8 @@ dissect_tcpopt_sack_perm(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
     item = proto_tree_add_boolean(opt_tree, hf_tcp_option_sack_perm, tvb, offset,
                            optlen, TRUE);
     exp_tree = proto_item_add_subtree(item, ett_tcp_option_sack_perm);
-    proto_tree_add_item(exp_tree, hf_tcp_option_kind, tvb, offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(exp_tree, hf_tcp_option_len, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(exp_tree, hf_tcp_option_kind, tvb, offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(exp_tree, hf_tcp_option_len, tvb, offset + 1, ENC_BIG_ENDIAN);
     tcp_info_append_uint(pinfo, "SACK_PERM", TRUE);
 }
 
@@ -2620,9 +2659,9 @@ dissect_tcpopt_mss(const ip_tcp_opt *optp, tvbuff_t *tvb,
     item = proto_tree_add_none_format(opt_tree, hf_tcp_option_mss, tvb, offset,
         optlen, "%s: %u bytes", optp->name, mss);
     exp_tree = proto_item_add_subtree(item, ett_tcp_option_mss);
-    proto_tree_add_item(exp_tree, hf_tcp_option_kind, tvb, offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(exp_tree, hf_tcp_option_len, tvb, offset + 1, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(exp_tree, hf_tcp_option_mss_val, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(exp_tree, hf_tcp_option_kind, tvb, offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(exp_tree, hf_tcp_option_len, tvb, offset + 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(exp_tree, hf_tcp_option_mss_val, tvb, offset + 2, ENC_BIG_ENDIAN);
     tcp_info_append_uint(pinfo, "MSS", mss);
 }
 
@@ -2640,14 +2679,14 @@ dissect_tcpopt_wscale(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
 
     wscale_tree = proto_tree_add_subtree(opt_tree, tvb, offset, 3, ett_tcp_option_wscale, &wscale_pi, "Window scale: ");
 
-    proto_tree_add_item(wscale_tree, hf_tcp_option_kind, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(wscale_tree, hf_tcp_option_kind, tvb, offset, ENC_BIG_ENDIAN);
     offset += 1;
 
-    proto_tree_add_item(wscale_tree, hf_tcp_option_len, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(wscale_tree, hf_tcp_option_len, tvb, offset, ENC_BIG_ENDIAN);
     offset += 1;
 
-    shift_pi = proto_tree_add_item(wscale_tree, hf_tcp_option_wscale_shift, tvb,
-                                   offset, 1, ENC_BIG_ENDIAN);
+    shift_pi = proto_tree_add_item_uint8(wscale_tree, hf_tcp_option_wscale_shift, tvb,
+                                         offset, ENC_BIG_ENDIAN);
     shift = tvb_get_guint8(tvb, offset);
     if (shift > 14) {
         /* RFC 1323: "If a Window Scale option is received with a shift.cnt
@@ -2696,10 +2735,10 @@ dissect_tcpopt_sack(const ip_tcp_opt *optp, tvbuff_t *tvb,
     field_tree = proto_tree_add_subtree_format(opt_tree, tvb, offset, optlen,
                 *optp->subtree_index, NULL, "%s:", optp->name);
 
-    proto_tree_add_item(field_tree, hf_tcp_option_kind, tvb,
-                        offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(field_tree, hf_tcp_option_len, tvb,
-                        offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_kind, tvb,
+                              offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_len, tvb,
+                              offset + 1, ENC_BIG_ENDIAN);
 
     hidden_item = proto_tree_add_boolean(field_tree, hf_tcp_option_sack, tvb,
                                          offset, optlen, TRUE);
@@ -2768,10 +2807,10 @@ dissect_tcpopt_echo(const ip_tcp_opt *optp, tvbuff_t *tvb,
                         ett_tcp_opt_echo, NULL, "%s: %u", optp->name, echo);
     tcp_info_append_uint(pinfo, "ECHO", echo);
 
-    proto_tree_add_item(field_tree, hf_tcp_option_kind, tvb,
-                        offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(field_tree, hf_tcp_option_len, tvb,
-                        offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_kind, tvb,
+                              offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_len, tvb,
+                              offset + 1, ENC_BIG_ENDIAN);
 
 }
 
@@ -2788,19 +2827,17 @@ dissect_tcpopt_timestamp(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
 
     ts_tree = proto_tree_add_subtree(opt_tree, tvb, offset, 10, ett_tcp_option_timestamp, &ti, "Timestamps: ");
 
-    proto_tree_add_item(ts_tree, hf_tcp_option_kind, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ts_tree, hf_tcp_option_kind, tvb, offset, ENC_BIG_ENDIAN);
     offset += 1;
 
-    proto_tree_add_item(ts_tree, hf_tcp_option_len, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(ts_tree, hf_tcp_option_len, tvb, offset, ENC_BIG_ENDIAN);
     offset += 1;
 
-    proto_tree_add_item(ts_tree,  hf_tcp_option_timestamp_tsval, tvb, offset,
-                        4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint32(ts_tree,  hf_tcp_option_timestamp_tsval, tvb, offset, ENC_BIG_ENDIAN);
     ts_val = tvb_get_ntohl(tvb, offset);
     offset += 4;
 
-    proto_tree_add_item(ts_tree,  hf_tcp_option_timestamp_tsecr, tvb, offset,
-                        4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint32(ts_tree,  hf_tcp_option_timestamp_tsecr, tvb, offset, ENC_BIG_ENDIAN);
     ts_ecr = tvb_get_ntohl(tvb, offset);
     /* offset += 4; */
 
@@ -2834,21 +2871,21 @@ dissect_tcpopt_mptcp(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
 
     mptcp_tree = proto_tree_add_subtree(opt_tree, tvb, offset, optlen, ett_tcp_option_mptcp, &ti, "Multipath TCP");
 
-    proto_tree_add_item(mptcp_tree, hf_tcp_option_kind, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(mptcp_tree, hf_tcp_option_kind, tvb, offset, ENC_BIG_ENDIAN);
     offset += 1;
 
-    proto_tree_add_item(mptcp_tree, hf_tcp_option_len, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(mptcp_tree, hf_tcp_option_len, tvb, offset, ENC_BIG_ENDIAN);
     offset += 1;
 
-    proto_tree_add_item(mptcp_tree, hf_tcp_option_mptcp_subtype, tvb,
-                        offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(mptcp_tree, hf_tcp_option_mptcp_subtype, tvb,
+                              offset, ENC_BIG_ENDIAN);
 
     subtype = tvb_get_guint8(tvb, offset) >> 4;
     proto_item_append_text(ti, ": %s", val_to_str(subtype, mptcp_subtype_vs, "Unknown (%d)"));
     switch (subtype) {
         case TCPOPT_MPTCP_MP_CAPABLE:
-            proto_tree_add_item(mptcp_tree, hf_tcp_option_mptcp_version, tvb,
-                        offset, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(mptcp_tree, hf_tcp_option_mptcp_version, tvb,
+                        offset, ENC_BIG_ENDIAN);
             offset += 1;
 
             proto_tree_add_bitmask(mptcp_tree, tvb, offset, hf_tcp_option_mptcp_flags,
@@ -2878,24 +2915,20 @@ dissect_tcpopt_mptcp(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
                     mptcp_flags_tree = proto_item_add_subtree(ti,
                             ett_tcp_option_mptcp);
 
-                    proto_tree_add_item(mptcp_flags_tree,
-                            hf_tcp_option_mptcp_backup_flag, tvb, offset,
-                            1, ENC_BIG_ENDIAN);
+                    proto_tree_add_item_uint8(mptcp_flags_tree,
+                            hf_tcp_option_mptcp_backup_flag, tvb, offset, ENC_BIG_ENDIAN);
                     offset += 1;
 
-                    proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_address_id, tvb, offset,
-                            1, ENC_BIG_ENDIAN);
+                    proto_tree_add_item_uint8(mptcp_tree,
+                            hf_tcp_option_mptcp_address_id, tvb, offset, ENC_BIG_ENDIAN);
                     offset += 1;
 
-                    proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_recv_token, tvb, offset,
-                            4, ENC_BIG_ENDIAN);
+                    proto_tree_add_item_uint32(mptcp_tree,
+                            hf_tcp_option_mptcp_recv_token, tvb, offset, ENC_BIG_ENDIAN);
                     offset += 4;
 
-                    proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_sender_rand, tvb, offset,
-                            4, ENC_BIG_ENDIAN);
+                    proto_tree_add_item_uint32(mptcp_tree,
+                            hf_tcp_option_mptcp_sender_rand, tvb, offset, ENC_BIG_ENDIAN);
                     break;
 
                 case 16:
@@ -2906,14 +2939,12 @@ dissect_tcpopt_mptcp(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
                     mptcp_flags_tree = proto_item_add_subtree(ti,
                             ett_tcp_option_mptcp);
 
-                    proto_tree_add_item(mptcp_flags_tree,
-                            hf_tcp_option_mptcp_backup_flag, tvb, offset,
-                            1, ENC_BIG_ENDIAN);
+                    proto_tree_add_item_uint8(mptcp_flags_tree,
+                            hf_tcp_option_mptcp_backup_flag, tvb, offset, ENC_BIG_ENDIAN);
                     offset += 1;
 
-                    proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_address_id, tvb, offset,
-                            1, ENC_BIG_ENDIAN);
+                    proto_tree_add_item_uint8(mptcp_tree,
+                            hf_tcp_option_mptcp_address_id, tvb, offset, ENC_BIG_ENDIAN);
                     offset += 1;
 
                     proto_tree_add_item(mptcp_tree,
@@ -2921,15 +2952,13 @@ dissect_tcpopt_mptcp(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
                             8, ENC_BIG_ENDIAN);
                     offset += 8;
 
-                    proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_sender_rand, tvb, offset,
-                            4, ENC_BIG_ENDIAN);
+                    proto_tree_add_item_uint32(mptcp_tree,
+                            hf_tcp_option_mptcp_sender_rand, tvb, offset, ENC_BIG_ENDIAN);
                     break;
 
                 case 24:
-                    proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_reserved, tvb, offset,
-                            2, ENC_BIG_ENDIAN);
+                    proto_tree_add_item_uint16(mptcp_tree,
+                            hf_tcp_option_mptcp_reserved, tvb, offset, ENC_BIG_ENDIAN);
                     offset += 2;
 
                     proto_tree_add_item(mptcp_tree,
@@ -2951,16 +2980,16 @@ dissect_tcpopt_mptcp(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
                             offset, 1, flags);
             mptcp_flags_tree = proto_item_add_subtree(ti, ett_tcp_option_mptcp);
 
-            proto_tree_add_item(mptcp_flags_tree, hf_tcp_option_mptcp_F_flag,
-                            tvb, offset, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(mptcp_flags_tree, hf_tcp_option_mptcp_m_flag,
-                            tvb, offset, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(mptcp_flags_tree, hf_tcp_option_mptcp_M_flag,
-                            tvb, offset, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(mptcp_flags_tree, hf_tcp_option_mptcp_a_flag,
-                            tvb, offset, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(mptcp_flags_tree, hf_tcp_option_mptcp_A_flag,
-                            tvb, offset, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(mptcp_flags_tree, hf_tcp_option_mptcp_F_flag,
+                            tvb, offset, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(mptcp_flags_tree, hf_tcp_option_mptcp_m_flag,
+                            tvb, offset, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(mptcp_flags_tree, hf_tcp_option_mptcp_M_flag,
+                            tvb, offset, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(mptcp_flags_tree, hf_tcp_option_mptcp_a_flag,
+                            tvb, offset, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(mptcp_flags_tree, hf_tcp_option_mptcp_A_flag,
+                            tvb, offset, ENC_BIG_ENDIAN);
             offset += 1;
 
             if (flags & 1) {
@@ -2990,39 +3019,36 @@ dissect_tcpopt_mptcp(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
                     offset += 4;
                 }
 
-                proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_subflow_seq_no, tvb, offset,
-                            4, ENC_BIG_ENDIAN);
+                proto_tree_add_item_uint32(mptcp_tree,
+                            hf_tcp_option_mptcp_subflow_seq_no, tvb, offset, ENC_BIG_ENDIAN);
                 offset += 4;
 
-                proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_data_lvl_len, tvb, offset,
-                            2, ENC_BIG_ENDIAN);
+                proto_tree_add_item_uint16(mptcp_tree,
+                            hf_tcp_option_mptcp_data_lvl_len, tvb, offset, ENC_BIG_ENDIAN);
                 offset += 2;
 
                 if ((int)optlen >= offset-start_offset+4)
                 {
-                    proto_tree_add_item(mptcp_tree,
-                                hf_tcp_option_mptcp_checksum, tvb, offset,
-                                2, ENC_BIG_ENDIAN);
+                    proto_tree_add_item_uint16(mptcp_tree,
+                                hf_tcp_option_mptcp_checksum, tvb, offset, ENC_BIG_ENDIAN);
                 }
             }
             break;
 
         case TCPOPT_MPTCP_ADD_ADDR:
-            proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_ipver, tvb, offset, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(mptcp_tree,
+                            hf_tcp_option_mptcp_ipver, tvb, offset, ENC_BIG_ENDIAN);
             ipver = tvb_get_guint8(tvb, offset) & 0x0F;
             offset += 1;
 
-            proto_tree_add_item(mptcp_tree,
-                    hf_tcp_option_mptcp_address_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(mptcp_tree,
+                    hf_tcp_option_mptcp_address_id, tvb, offset, ENC_BIG_ENDIAN);
             offset += 1;
 
             switch (ipver) {
                 case 4:
-                    proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_ipv4, tvb, offset, 4, ENC_BIG_ENDIAN);
+                    proto_tree_add_item_ipv4(mptcp_tree,
+                            hf_tcp_option_mptcp_ipv4, tvb, offset, ENC_BIG_ENDIAN);
                     offset += 4;
                     break;
 
@@ -3037,16 +3063,15 @@ dissect_tcpopt_mptcp(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
             }
 
             if (optlen % 4 == 2) {
-                proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_port, tvb, offset, 2, ENC_BIG_ENDIAN);
+                proto_tree_add_item_uint16(mptcp_tree,
+                            hf_tcp_option_mptcp_port, tvb, offset, ENC_BIG_ENDIAN);
             }
             break;
 
         case TCPOPT_MPTCP_REMOVE_ADDR:
             offset += 1;
-            proto_tree_add_item(mptcp_tree,
-                            hf_tcp_option_mptcp_address_id, tvb, offset,
-                            1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(mptcp_tree,
+                            hf_tcp_option_mptcp_address_id, tvb, offset, ENC_BIG_ENDIAN);
             break;
 
         case TCPOPT_MPTCP_MP_PRIO:
@@ -3055,19 +3080,19 @@ dissect_tcpopt_mptcp(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
                             offset, 1, flags);
             mptcp_flags_tree = proto_item_add_subtree(ti, ett_tcp_option_mptcp);
 
-            proto_tree_add_item(mptcp_flags_tree, hf_tcp_option_mptcp_backup_flag,
-                            tvb, offset, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(mptcp_flags_tree, hf_tcp_option_mptcp_backup_flag,
+                            tvb, offset, ENC_BIG_ENDIAN);
             offset += 1;
 
             if (optlen == 4) {
-                proto_tree_add_item(mptcp_tree,
-                        hf_tcp_option_mptcp_address_id, tvb, offset, 1, ENC_BIG_ENDIAN);
+                proto_tree_add_item_uint8(mptcp_tree,
+                        hf_tcp_option_mptcp_address_id, tvb, offset, ENC_BIG_ENDIAN);
             }
             break;
 
         case TCPOPT_MPTCP_MP_FAIL:
-            proto_tree_add_item(mptcp_tree,
-                    hf_tcp_option_mptcp_reserved, tvb, offset,2, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint16(mptcp_tree,
+                    hf_tcp_option_mptcp_reserved, tvb, offset, ENC_BIG_ENDIAN);
             offset += 2;
 
             proto_tree_add_item(mptcp_tree,
@@ -3075,8 +3100,8 @@ dissect_tcpopt_mptcp(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
             break;
 
         case TCPOPT_MPTCP_MP_FASTCLOSE:
-            proto_tree_add_item(mptcp_tree,
-                    hf_tcp_option_mptcp_reserved, tvb, offset,2, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint16(mptcp_tree,
+                    hf_tcp_option_mptcp_reserved, tvb, offset, ENC_BIG_ENDIAN);
             offset += 2;
 
             proto_tree_add_item(mptcp_tree,
@@ -3103,10 +3128,10 @@ dissect_tcpopt_cc(const ip_tcp_opt *optp, tvbuff_t *tvb,
     field_tree = proto_tree_add_subtree_format(opt_tree, tvb, offset, optlen,
                              ett_tcp_opt_cc, NULL, "%s: %u", optp->name, cc);
     tcp_info_append_uint(pinfo, "CC", cc);
-    proto_tree_add_item(field_tree, hf_tcp_option_kind, tvb,
-                        offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(field_tree, hf_tcp_option_len, tvb,
-                        offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_kind, tvb,
+                              offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_len, tvb,
+                              offset + 1, ENC_BIG_ENDIAN);
 }
 
 static void
@@ -3128,10 +3153,10 @@ dissect_tcpopt_qs(const ip_tcp_opt *optp, tvbuff_t *tvb,
     col_append_lstr(pinfo->cinfo, COL_INFO,
         " QSresp=", val_to_str_ext_const(rate, &qs_rate_vals_ext, "Unknown"),
         COL_ADD_LSTR_TERMINATOR);
-    proto_tree_add_item(field_tree, hf_tcp_option_kind, tvb,
-                        offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(field_tree, hf_tcp_option_len, tvb,
-                        offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_kind, tvb,
+                              offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_len, tvb,
+                              offset + 1, ENC_BIG_ENDIAN);
 }
 
 
@@ -3175,13 +3200,13 @@ dissect_tcpopt_scps(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
         capvector = tvb_get_guint8(tvb, offset + 2);
         connid = tvb_get_guint8(tvb, offset + 3);
 
-        tf = proto_tree_add_item(opt_tree, hf_tcp_option_scps_vector, tvb,
-                                 offset + 2, 1, ENC_BIG_ENDIAN);
+        tf = proto_tree_add_item_uint8(opt_tree, hf_tcp_option_scps_vector, tvb,
+                                       offset + 2, ENC_BIG_ENDIAN);
         field_tree = proto_item_add_subtree(tf, ett_tcp_option_scps);
-        proto_tree_add_item(field_tree, hf_tcp_option_kind, tvb,
-                            offset, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(field_tree, hf_tcp_option_len, tvb,
-                            offset + 1, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(field_tree, hf_tcp_option_kind, tvb,
+                                  offset, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(field_tree, hf_tcp_option_len, tvb,
+                                  offset + 1, ENC_BIG_ENDIAN);
         proto_tree_add_item(field_tree, hf_tcp_scpsoption_flags_bets, tvb,
                             offset + 2, 1, ENC_BIG_ENDIAN);
         proto_tree_add_item(field_tree, hf_tcp_scpsoption_flags_snack1, tvb,
@@ -3192,8 +3217,8 @@ dissect_tcpopt_scps(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
                             offset + 2, 1, ENC_BIG_ENDIAN);
         proto_tree_add_item(field_tree, hf_tcp_scpsoption_flags_nlts, tvb,
                             offset + 2, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(field_tree, hf_tcp_scpsoption_flags_reserved, tvb,
-                            offset + 2, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(field_tree, hf_tcp_scpsoption_flags_reserved, tvb,
+                                  offset + 2, ENC_BIG_ENDIAN);
 
         if (capvector) {
             struct capvec
@@ -3227,8 +3252,8 @@ dissect_tcpopt_scps(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
             proto_item_append_text(tf, ")");
         }
 
-        proto_tree_add_item(field_tree, hf_tcp_scpsoption_connection_id, tvb,
-                            offset + 3, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(field_tree, hf_tcp_scpsoption_connection_id, tvb,
+                                  offset + 3, ENC_BIG_ENDIAN);
         flow->scps_capable = 1;
 
         if (connid)
@@ -3253,20 +3278,20 @@ dissect_tcpopt_scps(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
                                             "Illegal SCPS Extended Capabilities (%d bytes)",
                                             optlen);
             field_tree=proto_item_add_subtree(tf, ett_tcp_option_scps_extended);
-            proto_tree_add_item(field_tree, hf_tcp_option_kind, tvb,
-                                offset, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(field_tree, hf_tcp_option_len, tvb,
-                                offset + 1, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(field_tree, hf_tcp_option_kind, tvb,
+                                      offset, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(field_tree, hf_tcp_option_len, tvb,
+                                      offset + 1, ENC_BIG_ENDIAN);
         } else {
             tf = proto_tree_add_uint_format(opt_tree, hf_tcp_option_scps_vector,
                                             tvb, offset, optlen, 0,
                                             "SCPS Extended Capabilities (%d bytes)",
                                             optlen);
             field_tree=proto_item_add_subtree(tf, ett_tcp_option_scps_extended);
-            proto_tree_add_item(field_tree, hf_tcp_option_kind, tvb,
-                                offset, 1, ENC_BIG_ENDIAN);
-            proto_tree_add_item(field_tree, hf_tcp_option_len, tvb,
-                                offset + 1, 1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(field_tree, hf_tcp_option_kind, tvb,
+                                      offset, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(field_tree, hf_tcp_option_len, tvb,
+                                      offset + 1, ENC_BIG_ENDIAN);
 
             /* There may be multiple binding spaces included in a single option,
              * so we will semi-parse each of the stacked binding spaces - skipping
@@ -3287,7 +3312,7 @@ dissect_tcpopt_scps(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
                 /* Convert the extended capabilities length into bytes for display */
                 extended_cap_length = (extended_cap_length << 1);
 
-                proto_tree_add_item(field_tree, hf_tcp_option_scps_binding, tvb, offset + local_offset, 1, ENC_BIG_ENDIAN);
+                proto_tree_add_item_uint8(field_tree, hf_tcp_option_scps_binding, tvb, offset + local_offset, ENC_BIG_ENDIAN);
                 proto_tree_add_uint(field_tree, hf_tcp_option_scps_binding_len, tvb, offset + local_offset + 1, 1, extended_cap_length);
 
                 /* Step past the binding space and length octets */
@@ -3318,10 +3343,10 @@ dissect_tcpopt_user_to(const ip_tcp_opt *optp, tvbuff_t *tvb,
     gboolean g;
     guint16 to;
 
-    proto_tree_add_item(opt_tree, hf_tcp_option_kind, tvb,
-                        offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(opt_tree, hf_tcp_option_len, tvb,
-                        offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(opt_tree, hf_tcp_option_kind, tvb,
+                              offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(opt_tree, hf_tcp_option_len, tvb,
+                              offset + 1, ENC_BIG_ENDIAN);
 
     g = tvb_get_ntohs(tvb, offset + 2) & 0x8000;
     to = tvb_get_ntohs(tvb, offset + 2) & 0x7FFF;
@@ -3333,7 +3358,7 @@ dissect_tcpopt_user_to(const ip_tcp_opt *optp, tvbuff_t *tvb,
                                optlen, to, "%s: %u %s", optp->name, to, g ? "minutes" : "seconds");
     field_tree = proto_item_add_subtree(tf, *optp->subtree_index);
     proto_tree_add_item(field_tree, hf_tcp_option_user_to_granularity, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
-    proto_tree_add_item(field_tree, hf_tcp_option_user_to_val, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(field_tree, hf_tcp_option_user_to_val, tvb, offset + 2, ENC_BIG_ENDIAN);
 
     tcp_info_append_uint(pinfo, "USER_TO", to);
 }
@@ -3379,10 +3404,10 @@ dissect_tcpopt_snack(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
     char   *modifier = null_modifier;
     proto_item *hidden_item;
 
-    proto_tree_add_item(opt_tree, hf_tcp_option_kind, tvb,
-                        offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(opt_tree, hf_tcp_option_len, tvb,
-                        offset + 1, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(opt_tree, hf_tcp_option_kind, tvb,
+                              offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(opt_tree, hf_tcp_option_len, tvb,
+                              offset + 1, ENC_BIG_ENDIAN);
 
     tcpd = get_tcp_conversation_data(NULL,pinfo);
 
@@ -3548,37 +3573,37 @@ dissect_tcpopt_rvbd_probe(const ip_tcp_opt *optp _U_, tvbuff_t *tvb, int offset,
 
     /* optlen, type, ver are common for all probes */
     field_tree = proto_item_add_subtree(pitem, ett_tcp_opt_rvbd_probe);
-    proto_tree_add_item(field_tree, hf_tcp_option_len, tvb,
-                        offset + PROBE_OPTLEN_OFFSET, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(field_tree, hf_tcp_option_kind, tvb,
-                        offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_optlen, tvb,
-                        offset + PROBE_OPTLEN_OFFSET, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_len, tvb,
+                              offset + PROBE_OPTLEN_OFFSET, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_kind, tvb,
+                              offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_rvbd_probe_optlen, tvb,
+                              offset + PROBE_OPTLEN_OFFSET, ENC_BIG_ENDIAN);
 
     if (ver == PROBE_VERSION_1) {
         guint16 port;
 
-        proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_type1, tvb,
-                            offset + PROBE_VERSION_TYPE_OFFSET, 1, ENC_BIG_ENDIAN);
-        proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_version1, tvb,
-                            offset + PROBE_VERSION_TYPE_OFFSET, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(field_tree, hf_tcp_option_rvbd_probe_type1, tvb,
+                                  offset + PROBE_VERSION_TYPE_OFFSET, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(field_tree, hf_tcp_option_rvbd_probe_version1, tvb,
+                                  offset + PROBE_VERSION_TYPE_OFFSET, ENC_BIG_ENDIAN);
 
         if (type == PROBE_INTERNAL)
             return;
 
-        proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_reserved, tvb, offset + PROBE_V1_RESERVED_OFFSET, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(field_tree, hf_tcp_option_rvbd_probe_reserved, tvb, offset + PROBE_V1_RESERVED_OFFSET, ENC_BIG_ENDIAN);
 
-        proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_prober, tvb,
-                            offset + PROBE_V1_PROBER_OFFSET, 4, ENC_BIG_ENDIAN);
+        proto_tree_add_item_ipv4(field_tree, hf_tcp_option_rvbd_probe_prober, tvb,
+                                 offset + PROBE_V1_PROBER_OFFSET, ENC_BIG_ENDIAN);
 
         switch (type) {
 
         case PROBE_QUERY:
         case PROBE_QUERY_SH:
         case PROBE_TRACE:
-            proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_appli_ver, tvb,
-                                offset + PROBE_V1_APPLI_VERSION_OFFSET, 2,
-                                ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint16(field_tree, hf_tcp_option_rvbd_probe_appli_ver, tvb,
+                                       offset + PROBE_V1_APPLI_VERSION_OFFSET,
+                                       ENC_BIG_ENDIAN);
 
             proto_item_append_text(pitem, ", CSH IP: %s", tvb_ip_to_str(tvb, offset + PROBE_V1_PROBER_OFFSET));
 
@@ -3601,28 +3626,28 @@ dissect_tcpopt_rvbd_probe(const ip_tcp_opt *optp _U_, tvbuff_t *tvb, int offset,
            break;
 
         case PROBE_RESPONSE:
-            proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_proxy, tvb,
-                                offset + PROBE_V1_PROXY_ADDR_OFFSET, 4, ENC_BIG_ENDIAN);
+            proto_tree_add_item_ipv4(field_tree, hf_tcp_option_rvbd_probe_proxy, tvb,
+                                     offset + PROBE_V1_PROXY_ADDR_OFFSET, ENC_BIG_ENDIAN);
 
             port = tvb_get_ntohs(tvb, offset + PROBE_V1_PROXY_PORT_OFFSET);
-            proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_proxy_port, tvb,
-                                offset + PROBE_V1_PROXY_PORT_OFFSET, 2, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint16(field_tree, hf_tcp_option_rvbd_probe_proxy_port, tvb,
+                                       offset + PROBE_V1_PROXY_PORT_OFFSET, ENC_BIG_ENDIAN);
 
             rvbd_probe_resp_add_info(pitem, pinfo, tvb, offset + PROBE_V1_PROXY_ADDR_OFFSET, port);
             break;
 
         case PROBE_RESPONSE_SH:
-            proto_tree_add_item(field_tree,
-                                hf_tcp_option_rvbd_probe_client, tvb,
-                                offset + PROBE_V1_SH_CLIENT_ADDR_OFFSET, 4,
-                                ENC_BIG_ENDIAN);
+            proto_tree_add_item_ipv4(field_tree,
+                                     hf_tcp_option_rvbd_probe_client, tvb,
+                                     offset + PROBE_V1_SH_CLIENT_ADDR_OFFSET,
+                                     ENC_BIG_ENDIAN);
 
-            proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_proxy, tvb,
-                                offset + PROBE_V1_SH_PROXY_ADDR_OFFSET, 4, ENC_BIG_ENDIAN);
+            proto_tree_add_item_ipv4(field_tree, hf_tcp_option_rvbd_probe_proxy, tvb,
+                                     offset + PROBE_V1_SH_PROXY_ADDR_OFFSET, ENC_BIG_ENDIAN);
 
             port = tvb_get_ntohs(tvb, offset + PROBE_V1_SH_PROXY_PORT_OFFSET);
-            proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_proxy_port, tvb,
-                                offset + PROBE_V1_SH_PROXY_PORT_OFFSET, 2, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint16(field_tree, hf_tcp_option_rvbd_probe_proxy_port, tvb,
+                                       offset + PROBE_V1_SH_PROXY_PORT_OFFSET, ENC_BIG_ENDIAN);
 
             rvbd_probe_resp_add_info(pitem, pinfo, tvb, offset + PROBE_V1_SH_PROXY_ADDR_OFFSET, port);
             break;
@@ -3634,8 +3659,8 @@ dissect_tcpopt_rvbd_probe(const ip_tcp_opt *optp _U_, tvbuff_t *tvb, int offset,
         proto_tree *flag_tree;
         guint8 flags;
 
-        proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_type2, tvb,
-                            offset + PROBE_VERSION_TYPE_OFFSET, 1, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint8(field_tree, hf_tcp_option_rvbd_probe_type2, tvb,
+                                  offset + PROBE_VERSION_TYPE_OFFSET, ENC_BIG_ENDIAN);
 
         proto_tree_add_uint_format_value(
             field_tree, hf_tcp_option_rvbd_probe_version2, tvb,
@@ -3665,15 +3690,13 @@ dissect_tcpopt_rvbd_probe(const ip_tcp_opt *optp _U_, tvbuff_t *tvb, int offset,
                                 tvb, offset + PROBE_V2_INFO_OFFSET, 1, ENC_BIG_ENDIAN);
 
             if (type == PROBE_QUERY_INFO_SH)
-                proto_tree_add_item(flag_tree,
-                                    hf_tcp_option_rvbd_probe_client, tvb,
-                                    offset + PROBE_V2_INFO_CLIENT_ADDR_OFFSET,
-                                    4, ENC_BIG_ENDIAN);
+                proto_tree_add_item_ipv4(flag_tree,
+                                         hf_tcp_option_rvbd_probe_client, tvb,
+                                         offset + PROBE_V2_INFO_CLIENT_ADDR_OFFSET, ENC_BIG_ENDIAN);
             else if (type == PROBE_QUERY_INFO_SID)
-                proto_tree_add_item(flag_tree,
-                                    hf_tcp_option_rvbd_probe_storeid, tvb,
-                                    offset + PROBE_V2_INFO_STOREID_OFFSET,
-                                    4, ENC_BIG_ENDIAN);
+                proto_tree_add_item_uint32(flag_tree,
+                                           hf_tcp_option_rvbd_probe_storeid, tvb,
+                                           offset + PROBE_V2_INFO_STOREID_OFFSET, ENC_BIG_ENDIAN);
 
             if (type != PROBE_QUERY_INFO_SID &&
                 (tvb_get_guint8(tvb, 13) & (TH_SYN|TH_ACK)) == (TH_SYN|TH_ACK) &&
@@ -3684,9 +3707,8 @@ dissect_tcpopt_rvbd_probe(const ip_tcp_opt *optp _U_, tvbuff_t *tvb, int offset,
             break;
 
         case PROBE_RESPONSE_INFO:
-            flag_pi = proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_flags,
-                                          tvb, offset + PROBE_V2_INFO_OFFSET,
-                                          1, ENC_BIG_ENDIAN);
+            flag_pi = proto_tree_add_item_uint8(field_tree, hf_tcp_option_rvbd_probe_flags,
+                                                tvb, offset + PROBE_V2_INFO_OFFSET, ENC_BIG_ENDIAN);
 
             flag_tree = proto_item_add_subtree(flag_pi, ett_tcp_opt_rvbd_probe_flags);
             proto_tree_add_item(flag_tree,
@@ -3701,9 +3723,8 @@ dissect_tcpopt_rvbd_probe(const ip_tcp_opt *optp _U_, tvbuff_t *tvb, int offset,
             break;
 
         case PROBE_RST:
-            proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_flags,
-                                  tvb, offset + PROBE_V2_INFO_OFFSET,
-                                  1, ENC_BIG_ENDIAN);
+            proto_tree_add_item_uint8(field_tree, hf_tcp_option_rvbd_probe_flags,
+                                  tvb, offset + PROBE_V2_INFO_OFFSET, ENC_BIG_ENDIAN);
             break;
         }
     }
@@ -3752,17 +3773,16 @@ dissect_tcpopt_rvbd_trpy(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
         "%s", "");
 
     field_tree = proto_item_add_subtree(pitem, ett_tcp_opt_rvbd_trpy);
-    proto_tree_add_item(field_tree, hf_tcp_option_len, tvb,
-                        offset + PROBE_OPTLEN_OFFSET, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(field_tree, hf_tcp_option_kind, tvb,
-                        offset, 1, ENC_BIG_ENDIAN);
-    proto_tree_add_item(field_tree, hf_tcp_option_rvbd_probe_optlen, tvb,
-                        offset + PROBE_OPTLEN_OFFSET, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_len, tvb,
+                              offset + PROBE_OPTLEN_OFFSET, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_kind, tvb,
+                              offset, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(field_tree, hf_tcp_option_rvbd_probe_optlen, tvb,
+                              offset + PROBE_OPTLEN_OFFSET, ENC_BIG_ENDIAN);
 
     flags = tvb_get_ntohs(tvb, offset + TRPY_OPTIONS_OFFSET);
-    flag_pi = proto_tree_add_item(field_tree, hf_tcp_option_rvbd_trpy_flags,
-                                  tvb, offset + TRPY_OPTIONS_OFFSET,
-                                  2, ENC_BIG_ENDIAN);
+    flag_pi = proto_tree_add_item_uint16(field_tree, hf_tcp_option_rvbd_trpy_flags,
+                                         tvb, offset + TRPY_OPTIONS_OFFSET, ENC_BIG_ENDIAN);
 
     flag_tree = proto_item_add_subtree(flag_pi, ett_tcp_opt_rvbd_trpy_flags);
     proto_tree_add_item(flag_tree, hf_tcp_option_rvbd_trpy_flag_fw_rst_probe,
@@ -3778,19 +3798,19 @@ dissect_tcpopt_rvbd_trpy(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
     proto_tree_add_item(flag_tree, hf_tcp_option_rvbd_trpy_flag_mode,
                         tvb, offset + TRPY_OPTIONS_OFFSET, 2, ENC_BIG_ENDIAN);
 
-    proto_tree_add_item(field_tree, hf_tcp_option_rvbd_trpy_src,
-                        tvb, offset + TRPY_SRC_ADDR_OFFSET, 4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_ipv4(field_tree, hf_tcp_option_rvbd_trpy_src,
+                             tvb, offset + TRPY_SRC_ADDR_OFFSET, ENC_BIG_ENDIAN);
 
-    proto_tree_add_item(field_tree, hf_tcp_option_rvbd_trpy_dst,
-                        tvb, offset + TRPY_DST_ADDR_OFFSET, 4, ENC_BIG_ENDIAN);
+    proto_tree_add_item_ipv4(field_tree, hf_tcp_option_rvbd_trpy_dst,
+                             tvb, offset + TRPY_DST_ADDR_OFFSET, ENC_BIG_ENDIAN);
 
     sport = tvb_get_ntohs(tvb, offset + TRPY_SRC_PORT_OFFSET);
-    proto_tree_add_item(field_tree, hf_tcp_option_rvbd_trpy_src_port,
-                        tvb, offset + TRPY_SRC_PORT_OFFSET, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(field_tree, hf_tcp_option_rvbd_trpy_src_port,
+                               tvb, offset + TRPY_SRC_PORT_OFFSET, ENC_BIG_ENDIAN);
 
     dport = tvb_get_ntohs(tvb, offset + TRPY_DST_PORT_OFFSET);
-    proto_tree_add_item(field_tree, hf_tcp_option_rvbd_trpy_dst_port,
-                        tvb, offset + TRPY_DST_PORT_OFFSET, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint16(field_tree, hf_tcp_option_rvbd_trpy_dst_port,
+                               tvb, offset + TRPY_DST_PORT_OFFSET, ENC_BIG_ENDIAN);
 
     proto_item_append_text(pitem, "%s:%u -> %s:%u",
                            tvb_ip_to_str(tvb, offset + TRPY_SRC_ADDR_OFFSET), sport,
@@ -3798,8 +3818,8 @@ dissect_tcpopt_rvbd_trpy(const ip_tcp_opt *optp _U_, tvbuff_t *tvb,
 
     /* Client port only set on SYN: optlen == 18 */
     if ((flags & RVBD_FLAGS_TRPY_OOB) && (optlen > TCPOLEN_RVBD_TRPY_MIN))
-        proto_tree_add_item(field_tree, hf_tcp_option_rvbd_trpy_client_port,
-                            tvb, offset + TRPY_CLIENT_PORT_OFFSET, 2, ENC_BIG_ENDIAN);
+        proto_tree_add_item_uint16(field_tree, hf_tcp_option_rvbd_trpy_client_port,
+                                   tvb, offset + TRPY_CLIENT_PORT_OFFSET, ENC_BIG_ENDIAN);
 
     /* Despite that we have the right TCP ports for other protocols,
      * the data is related to the Riverbed Optimization Protocol and
@@ -4399,7 +4419,7 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
             if (proto_ip == (gint) GPOINTER_TO_UINT(wmem_list_frame_data(frame))) {
                 frame = wmem_list_frame_prev(frame);
                 if (proto_icmp == (gint) GPOINTER_TO_UINT(wmem_list_frame_data(frame))) {
-                    proto_tree_add_item(tcp_tree, hf_tcp_seq, tvb, offset + 4, 4, ENC_BIG_ENDIAN);
+                    proto_tree_add_item_uint32(tcp_tree, hf_tcp_seq, tvb, offset + 4, ENC_BIG_ENDIAN);
                 }
             }
         }
@@ -4439,7 +4459,7 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
             tcpd=get_tcp_conversation_data(conv,pinfo);
         }
         if(!tcpd->ta)
-            tcp_analyze_get_acked_struct(pinfo->fd->num, tcph->th_seq, tcph->th_ack, TRUE, tcpd);
+            tcp_analyze_get_acked_struct(pinfo, TRUE, tcpd);
         tcpd->ta->flags|=TCP_A_REUSED_PORTS;
     }
 
@@ -4447,6 +4467,9 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
         item = proto_tree_add_uint(tcp_tree, hf_tcp_stream, tvb, offset, 0, tcpd->stream);
         PROTO_ITEM_SET_GENERATED(item);
 
+        if (!pinfo->fd->flags.visited)
+            field_frame_index_add(tcp_stream_index, tcpd->stream, pinfo->fd->num);
+
         /* Copy the stream index into the header as well to make it available
          * to tap listeners.
          */
@@ -4857,7 +4880,7 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
     }
 
     th_urp = tvb_get_ntohs(tvb, offset + 18);
-    item = proto_tree_add_item(tcp_tree, hf_tcp_urgent_pointer, tvb, offset + 18, 2, ENC_BIG_ENDIAN);
+    item = proto_tree_add_item_uint16(tcp_tree, hf_tcp_urgent_pointer, tvb, offset + 18, ENC_BIG_ENDIAN);
     if (tcph->th_flags & TH_URG) {
         /* Export the urgent pointer, for the benefit of protocols such as
            rlogin. */
@@ -4901,16 +4924,7 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
 
     /* handle TCP seq# analysis, print any extra SEQ/ACK data for this segment*/
     if(tcp_analyze_seq) {
-        guint32 use_seq = tcph->th_seq;
-        guint32 use_ack = tcph->th_ack;
-        /* May need to recover absolute values here... */
-        if (tcp_relative_seq) {
-            use_seq += tcpd->fwd->base_seq;
-            if (tcph->th_flags & TH_ACK) {
-                use_ack += tcpd->rev->base_seq;
-            }
-        }
-        tcp_print_sequence_number_analysis(pinfo, tvb, tcp_tree, tcpd, use_seq, use_ack);
+        tcp_print_sequence_number_analysis(pinfo, tvb, tcp_tree, tcpd);
     }
 
     /* handle conversation timestamps */
@@ -5094,6 +5108,10 @@ static void
 tcp_init(void)
 {
     tcp_stream_count = 0;
+    if (tcp_stream_index == NULL)
+        tcp_stream_index = field_frame_index_new(hf_tcp_stream);
+    else
+        field_frame_index_clear(tcp_stream_index);
     reassembly_table_init(&tcp_reassembly_table,
                           &addresses_ports_reassembly_table_functions);
 }
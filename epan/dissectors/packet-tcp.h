@@ -113,13 +113,24 @@ extern struct tcp_multisegment_pdu *
 pdu_store_sequencenumber_of_next_pdu(packet_info *pinfo, guint32 seq, guint32 nxtpdu, wmem_tree_t *multisegment_pdus);
 
 typedef struct _tcp_unacked_t {
-	struct _tcp_unacked_t *next;
 	guint32 frame;
 	guint32	seq;
 	guint32	nextseq;
 	nstime_t ts;
 } tcp_unacked_t;
 
+/* The segments of a flow that haven't been ACKed yet, sorted by nextseq
+ * (and, for equal nextseqs, by when they were seen) in a ring buffer, so
+ * that an ACK removes segments from the head and a new segment, which
+ * usually has the highest nextseq so far, goes at the tail.
+ */
+typedef struct _tcp_unacked_ring_t {
+	tcp_unacked_t *segs;
+	guint32 size;		/* a power of 2, or 0 if segs isn't allocated */
+	guint32 head;		/* index of the first segment */
+	guint32 count;
+} tcp_unacked_ring_t;
+
 struct tcp_acked {
 	guint32 frame_acked;
 	nstime_t ts;
@@ -149,7 +160,7 @@ struct tcp_multisegment_pdu {
 typedef struct _tcp_flow_t {
 	gboolean base_seq_set; /* true if base seq set */
 	guint32 base_seq;	/* base seq number (used by relative sequence numbers)*/
-	tcp_unacked_t *segments;
+	tcp_unacked_ring_t segments;
 	guint32 fin;		/* frame number of the final FIN */
 	guint32 lastack;	/* last seen ack */
 	nstime_t lastacktime;	/* Time of the last ack packet */
@@ -223,10 +234,6 @@ struct tcp_analysis {
 	 * similar
 	 */
 	struct tcp_acked *ta;
-	/* This structure contains a tree containing all the various ta's
-	 * keyed by frame number.
-	 */
-	wmem_tree_t	*acked_table;
 
 	/* Remember the timestamp of the first frame seen in this tcp
 	 * conversation to be able to calculate a relative time compared
@@ -34,6 +34,7 @@
 #include <epan/in_cksum.h>
 #include <epan/prefs.h>
 #include <epan/expert.h>
+#include <epan/field_store.h>
 
 #include "packet-udp.h"
 
@@ -164,6 +165,7 @@ static dissector_table_t udp_dissector_table;
 static heur_dissector_list_t heur_subdissector_list;
 static dissector_handle_t data_handle;
 static guint32 udp_stream_count;
+static field_frame_index_t *udp_stream_index = NULL;  /* frames in each stream */
 
 /* Determine if there is a sub-dissector and call it.  This has been */
 /* separated into a stand alone routine so other protocol dissectors */
@@ -444,9 +446,26 @@ guint32 get_udp_stream_count(void)
     return udp_stream_count;
 }
 
-void
-decode_udp_ports(tvbuff_t *tvb, int offset, packet_info *pinfo,
-                 proto_tree *tree, int uh_sport, int uh_dport, int uh_ulen)
+/* Call a dissector found in the port table the way dissector_try_uint() would */
+static int
+call_udp_port_dissector(dissector_handle_t handle, guint32 port, tvbuff_t *tvb,
+                        packet_info *pinfo, proto_tree *tree)
+{
+  guint32 saved_match_uint = pinfo->match_uint;
+  int len;
+
+  pinfo->match_uint = port;
+  len = call_dissector_only(handle, tvb, pinfo, tree, NULL);
+  pinfo->match_uint = saved_match_uint;
+  return len;
+}
+
+/* "udpd" is the conversation's data if the lookups may be cached in it,
+   i.e. on the first pass for a conversation without wildcards, else NULL */
+static void
+decode_udp_ports_conv(tvbuff_t *tvb, int offset, packet_info *pinfo,
+                      proto_tree *tree, int uh_sport, int uh_dport, int uh_ulen,
+                      struct udp_analysis *udpd)
 {
   tvbuff_t *next_tvb;
   int low_port, high_port;
@@ -455,6 +474,8 @@ decode_udp_ports(tvbuff_t *tvb, int offset, packet_info *pinfo,
   /* Save curr_layer_num as it might be changed by subdissector */
   guint8 curr_layer_num = pinfo->curr_layer_num;
   heur_dtbl_entry_t *hdtbl_entry;
+  conversation_t *conversation;
+  int dir = 0;
 
   len = tvb_captured_length_remaining(tvb, offset);
   reported_len = tvb_reported_length_remaining(tvb, offset);
@@ -488,9 +509,20 @@ decode_udp_ports(tvbuff_t *tvb, int offset, packet_info *pinfo,
   /* determine if this packet is part of a conversation and call dissector */
 /* for the conversation if available */
 
-  if (try_conversation_dissector(&pinfo->dst, &pinfo->src, PT_UDP,
-                                 uh_dport, uh_sport, next_tvb, pinfo, tree, NULL)) {
-    return;
+  if (udpd != NULL)
+    dir = (udpd->fwd == &udpd->flow1) ? 0 : 1;
+  if (udpd == NULL || !udpd->no_conv_dissector[dir] ||
+      udpd->no_conv_dissector_generation[dir] != conversation_dissector_generation()) {
+    conversation = find_conversation(pinfo->fd->num, &pinfo->dst, &pinfo->src, PT_UDP,
+                                     uh_dport, uh_sport, 0);
+    if (conversation != NULL && conversation->dissector_handle != NULL) {
+      if (call_dissector_only(conversation->dissector_handle, next_tvb, pinfo, tree, NULL))
+        return;
+    } else if (udpd != NULL) {
+      /* Don't look again until some conversation gets a dissector */
+      udpd->no_conv_dissector[dir] = TRUE;
+      udpd->no_conv_dissector_generation[dir] = conversation_dissector_generation();
+    }
   }
 
   if (try_heuristic_first) {
@@ -528,12 +560,32 @@ decode_udp_ports(tvbuff_t *tvb, int offset, packet_info *pinfo,
     low_port  = uh_sport;
     high_port = uh_dport;
   }
-  if ((low_port != 0) &&
-      dissector_try_uint(udp_dissector_table, low_port, next_tvb, pinfo, tree))
-    return;
-  if ((high_port != 0) &&
-      dissector_try_uint(udp_dissector_table, high_port, next_tvb, pinfo, tree))
-    return;
+  if (udpd != NULL) {
+    /* The ports are the same for the whole conversation, so unless
+       the table has changed, so are the handles we'd find for them. */
+    if (!udpd->port_handles_valid ||
+        udpd->port_handles_generation != dissector_table_uint_generation()) {
+      udpd->low_port_handle = (low_port != 0) ?
+          dissector_get_uint_handle(udp_dissector_table, low_port) : NULL;
+      udpd->high_port_handle = (high_port != 0) ?
+          dissector_get_uint_handle(udp_dissector_table, high_port) : NULL;
+      udpd->port_handles_generation = dissector_table_uint_generation();
+      udpd->port_handles_valid = TRUE;
+    }
+    if ((udpd->low_port_handle != NULL) &&
+        call_udp_port_dissector(udpd->low_port_handle, low_port, next_tvb, pinfo, tree))
+      return;
+    if ((udpd->high_port_handle != NULL) &&
+        call_udp_port_dissector(udpd->high_port_handle, high_port, next_tvb, pinfo, tree))
+      return;
+  } else {
+    if ((low_port != 0) &&
+        dissector_try_uint(udp_dissector_table, low_port, next_tvb, pinfo, tree))
+      return;
+    if ((high_port != 0) &&
+        dissector_try_uint(udp_dissector_table, high_port, next_tvb, pinfo, tree))
+      return;
+  }
 
   if (!try_heuristic_first) {
     /* Do lookup with the heuristic subdissector table */
@@ -550,6 +602,13 @@ decode_udp_ports(tvbuff_t *tvb, int offset, packet_info *pinfo,
   call_dissector(data_handle,next_tvb, pinfo, tree);
 }
 
+void
+decode_udp_ports(tvbuff_t *tvb, int offset, packet_info *pinfo,
+                 proto_tree *tree, int uh_sport, int uh_dport, int uh_ulen)
+{
+  decode_udp_ports_conv(tvb, offset, pinfo, tree, uh_sport, uh_dport, uh_ulen, NULL);
+}
+
 
 static void
 dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, guint32 ip_proto)
@@ -831,6 +890,9 @@ dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, guint32 ip_proto)
     item = proto_tree_add_uint(udp_tree, &hfi_udp_stream, tvb, offset, 0, udpd->stream);
     PROTO_ITEM_SET_GENERATED(item);
 
+    if (!pinfo->fd->flags.visited)
+      field_frame_index_add(udp_stream_index, udpd->stream, pinfo->fd->num);
+
     /* Copy the stream index into the header as well to make it available
     * to tap listeners.
     */
@@ -874,9 +936,16 @@ dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, guint32 ip_proto)
    * We definitely don't want to do it for an error packet if there's
    * nothing left in the packet.
    */
-  if (!pinfo->flags.in_error_pkt || (tvb_captured_length_remaining(tvb, offset) > 0))
-    decode_udp_ports(tvb, offset, pinfo, tree, udph->uh_sport, udph->uh_dport,
-                     udph->uh_ulen);
+  if (!pinfo->flags.in_error_pkt || (tvb_captured_length_remaining(tvb, offset) > 0)) {
+    /* Only remember the dispatch lookups on the first pass, when packets
+       are seen in order, and only for a conversation that belongs to
+       this address/port pair alone. */
+    if (pinfo->fd->flags.visited || pinfo->flags.in_error_pkt ||
+        (conv->options & (NO_ADDR2|NO_PORT2)))
+      udpd = NULL;
+    decode_udp_ports_conv(tvb, offset, pinfo, tree, udph->uh_sport, udph->uh_dport,
+                          udph->uh_ulen, udpd);
+  }
 }
 
 static void
@@ -895,6 +964,10 @@ static void
 udp_init(void)
 {
   udp_stream_count = 0;
+  if (udp_stream_index == NULL)
+    udp_stream_index = field_frame_index_new(hfi_udp_stream.id);
+  else
+    field_frame_index_clear(udp_stream_index);
 }
 
 void
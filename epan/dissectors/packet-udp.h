@@ -81,6 +81,20 @@ struct udp_analysis {
 	 * stream index numbering
 	 */
 	guint32		stream;
+
+	/* What decode_udp_ports() found when it dispatched this
+	 * conversation's packets on the first pass, so that later packets
+	 * can skip the lookups.  The port handles are only valid while
+	 * dissector_table_uint_generation() is unchanged, and "no
+	 * conversation dissector" (per direction, indexed by whether fwd
+	 * is flow1) only while conversation_dissector_generation() is.
+	 */
+	gboolean	port_handles_valid;
+	guint32		port_handles_generation;
+	dissector_handle_t low_port_handle;
+	dissector_handle_t high_port_handle;
+	gboolean	no_conv_dissector[2];
+	guint32		no_conv_dissector_generation[2];
 };
 
 /** Associate process information with a given flow
@@ -86,7 +86,7 @@ dissect_vxlan(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
      *    VXLAN Network ID (VNI).  The remaining 7 bits (designated "R") are
      *    reserved fields and MUST be set to zero.
      */
-    flg_item = proto_tree_add_item(vxlan_tree, hf_vxlan_flags, tvb, offset, 1, ENC_BIG_ENDIAN);
+    flg_item = proto_tree_add_item_uint8(vxlan_tree, hf_vxlan_flags, tvb, offset, ENC_BIG_ENDIAN);
     flg_tree = proto_item_add_subtree(flg_item, ett_vxlan_flgs);
 
     proto_tree_add_item(flg_tree, hf_vxlan_flag_b7, tvb, offset, 1, ENC_BIG_ENDIAN);
@@ -100,14 +100,14 @@ dissect_vxlan(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
     proto_tree_add_item(flg_tree, hf_vxlan_flag_b0, tvb, offset, 1, ENC_BIG_ENDIAN);
     offset++;
 
-    proto_tree_add_item(vxlan_tree, hf_vxlan_reserved_24, tvb, offset, 3, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint24(vxlan_tree, hf_vxlan_reserved_24, tvb, offset, ENC_BIG_ENDIAN);
     offset+=3;
 
-    proto_tree_add_item(vxlan_tree, hf_vxlan_vni, tvb, offset, 3, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint24(vxlan_tree, hf_vxlan_vni, tvb, offset, ENC_BIG_ENDIAN);
     offset+=3;
 
 
-    proto_tree_add_item(vxlan_tree, hf_vxlan_reserved_8, tvb, offset, 1, ENC_BIG_ENDIAN);
+    proto_tree_add_item_uint8(vxlan_tree, hf_vxlan_reserved_8, tvb, offset, ENC_BIG_ENDIAN);
     offset++;
 
     next_tvb = tvb_new_subset_remaining(tvb, offset);
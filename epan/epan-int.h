@@ -28,6 +28,9 @@
 struct epan_session {
 	void *data;
 
+	/* conversation tables belonging to this session */
+	struct conversation_tables *conv_tables;
+
 	const nstime_t *(*get_frame_ts)(void *data, guint32 frame_num);
 	const char *(*get_interface_name)(void *data, guint32 interface_id);
 	const char *(*get_user_comment)(void *data, const frame_data *fd);
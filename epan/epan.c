@@ -51,6 +51,9 @@
 
 #ifdef HAVE_LUA
 #include <lua.h>
+#ifdef HAVE_LUAJIT
+#include <luajit.h>
+#endif
 #include <wslua/wslua.h>
 #endif
 
@@ -159,6 +162,9 @@ epan_new(void)
 	/* XXX, it should take session as param */
 	init_dissection();
 
+	/* init_dissection() created fresh conversation tables; they are ours */
+	session->conv_tables = conversation_tables_get_current();
+
 	return session;
 }
 
@@ -198,6 +204,9 @@ void
 epan_free(epan_t *session)
 {
 	if (session) {
+		/* Make sure it's our conversation tables that get destroyed */
+		conversation_tables_set_current(session->conv_tables);
+
 		/* XXX, it should take session as param */
 		cleanup_dissection();
 
@@ -281,7 +290,6 @@ epan_dissect_reset(epan_dissect_t *edt)
 
 	g_assert(edt);
 
-	g_slist_free(edt->pi.proto_data);
 	g_slist_free(edt->pi.dependent_frames);
 
 	/* Free the data sources list. */
@@ -385,7 +393,6 @@ epan_dissect_cleanup(epan_dissect_t* edt)
 {
 	g_assert(edt);
 
-	g_slist_free(edt->pi.proto_data);
 	g_slist_free(edt->pi.dependent_frames);
 
 	/* Free the data sources list. */
@@ -422,6 +429,12 @@ epan_dissect_prime_dfilter(epan_dissect_t *edt, const dfilter_t* dfcode)
     dfilter_prime_proto_tree(dfcode, edt->tree);
 }
 
+void
+epan_dissect_set_cutoff(epan_dissect_t *edt, const int *protos)
+{
+    edt->pi.cutoff_protos = protos;
+}
+
 /* ----------------------- */
 const gchar *
 epan_custom_set(epan_dissect_t *edt, GSList *field_ids,
@@ -492,7 +505,11 @@ epan_get_compiled_version_info(GString *str)
 	g_string_append(str, ", ");
 #ifdef HAVE_LUA
 	g_string_append(str, "with ");
+#ifdef HAVE_LUAJIT
+	g_string_append(str, LUAJIT_VERSION);
+#else
 	g_string_append(str, LUA_VERSION);
+#endif
 #else
 	g_string_append(str, "without Lua");
 #endif /* HAVE_LUA */
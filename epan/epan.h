@@ -205,6 +205,21 @@ WS_DLL_PUBLIC
 void
 epan_dissect_prime_dfilter(epan_dissect_t *edt, const struct epan_dfilter *dfcode);
 
+/** For the next dissection with this epan_dissect_t only, stop calling
+ * subdissectors once every protocol in protos (an array of protocol IDs
+ * ending with -1, as returned by dfilter_get_cutoff_protocols()) has been
+ * dissected; a subdissector for one of those protocols is still called.
+ *
+ * Only a filter that refers to nothing but those protocols can be relied
+ * on afterwards, and even then a protocol that turns up again further up
+ * the stack (in a tunnel, say) won't be seen the second time, nor will
+ * any fields a protocol only adds with the help of the protocols it
+ * carries, such as reassembly results. Don't use this when columns or
+ * the protocol tree are going to be shown, or with taps. */
+WS_DLL_PUBLIC
+void
+epan_dissect_set_cutoff(epan_dissect_t *edt, const int *protos);
+
 /** fill the dissect run output into the packet list columns */
 WS_DLL_PUBLIC
 void
@@ -46,6 +46,21 @@ extern "C" {
 
 enum { except_no_call, except_call };
 
+/*
+ * On BSD-derived systems, including OS X, setjmp() and longjmp() save and
+ * restore the signal mask, which costs a system call for every TRY and
+ * THROW.  Nothing in here changes the signal mask, so use the variants
+ * that leave it alone where there are any.  (__builtin_setjmp() isn't
+ * usable, as RETHROW jumps back to a buffer set in the same function.)
+ */
+#ifdef _WIN32
+#define except_setjmp(env)          setjmp(env)
+#define except_longjmp(env, val)    longjmp(env, val)
+#else
+#define except_setjmp(env)          _setjmp(env)
+#define except_longjmp(env, val)    _longjmp(env, val)
+#endif
+
 typedef struct {
     unsigned long except_group;
     unsigned long except_code;
@@ -171,7 +186,7 @@ WS_DLL_PUBLIC void except_free(void *);
         struct except_stacknode except_sn;                      \
         struct except_catch except_ch;                          \
         except_setup_try(&except_sn, &except_ch, ID, NUM);      \
-        if (setjmp(except_ch.except_jmp))                       \
+        if (except_setjmp(except_ch.except_jmp))                \
             *(PPE) = &except_ch.except_obj;                     \
         else                                                    \
             *(PPE) = 0
@@ -44,6 +44,12 @@ static int proto_malformed    = -1;
 static int expert_tap         = -1;
 static int highest_severity   =  0;
 
+/* Events counted on the first pass, by severity and by message template */
+#define SEVERITY_INDEX(severity)	(((severity) & PI_SEVERITY_MASK) >> 20)
+static guint32     severity_counts[(PI_SEVERITY_MASK >> 20) + 1];
+static GPtrArray  *tallies     = NULL;	/* expert_tally_t, in order of appearance */
+static GHashTable *tally_index = NULL;	/* the same expert_tally_t, as keys */
+
 static int ett_expert         = -1;
 static int ett_subexpert      = -1;
 
@@ -186,6 +192,69 @@ static void uat_expert_post_update_cb(void)
 	DISSECTOR_ASSERT_HINT((guint)eiindex < gpa_expertinfo.len, "Unregistered expert info!"); \
 	expinfo = gpa_expertinfo.ei[eiindex];
 
+/*
+ * Templates and protocol names are string constants, or registered
+ * strings that live as long as the program, so they are compared and
+ * hashed by address.
+ */
+static guint
+tally_hash(gconstpointer key)
+{
+	const expert_tally_t *tally = (const expert_tally_t *)key;
+
+	return g_direct_hash(tally->summary) ^ g_direct_hash(tally->protocol) ^
+		(guint)tally->group ^ (guint)tally->severity;
+}
+
+static gboolean
+tally_equal(gconstpointer a, gconstpointer b)
+{
+	const expert_tally_t *ta = (const expert_tally_t *)a;
+	const expert_tally_t *tb = (const expert_tally_t *)b;
+
+	return ta->summary == tb->summary && ta->protocol == tb->protocol &&
+		ta->group == tb->group && ta->severity == tb->severity;
+}
+
+/* Count an event the first time its frame is dissected */
+static void
+expert_tally(packet_info *pinfo, int group, int severity, const char *format)
+{
+	expert_tally_t  key;
+	expert_tally_t *tally;
+
+	severity_counts[SEVERITY_INDEX(severity)]++;
+
+	key.protocol = pinfo->current_proto;
+	key.summary  = format;
+	key.group    = group;
+	key.severity = severity;
+
+	tally = (expert_tally_t *)g_hash_table_lookup(tally_index, &key);
+	if (tally != NULL) {
+		tally->count++;
+		return;
+	}
+
+	tally = (expert_tally_t *)g_memdup(&key, sizeof key);
+	tally->count = 1;
+	tally->first_frame = PINFO_FD_NUM(pinfo);
+	g_ptr_array_add(tallies, tally);
+	g_hash_table_insert(tally_index, tally, tally);
+}
+
+static void
+expert_tally_clear(void)
+{
+	guint i;
+
+	g_hash_table_remove_all(tally_index);
+	for (i = 0; i < tallies->len; i++) {
+		g_free(g_ptr_array_index(tallies, i));
+	}
+	g_ptr_array_set_size(tallies, 0);
+}
+
 void
 expert_packet_init(void)
 {
@@ -251,6 +320,14 @@ expert_packet_init(void)
 
 	highest_severity = 0;
 
+	memset(severity_counts, 0, sizeof severity_counts);
+	if (tallies == NULL) {
+		tallies = g_ptr_array_new();
+		tally_index = g_hash_table_new(tally_hash, tally_equal);
+	} else {
+		expert_tally_clear();
+	}
+
 	proto_malformed = proto_get_id_by_filter_name("_ws.malformed");
 }
 
@@ -290,6 +367,14 @@ expert_cleanup(void)
 		g_array_free(uat_saved_fields, TRUE);
 		uat_saved_fields = NULL;
 	}
+
+	if (tallies) {
+		expert_tally_clear();
+		g_ptr_array_free(tallies, TRUE);
+		g_hash_table_destroy(tally_index);
+		tallies = NULL;
+		tally_index = NULL;
+	}
 }
 
 
@@ -306,6 +391,26 @@ expert_update_comment_count(guint64 count)
 		highest_severity = 0;
 }
 
+guint32
+expert_get_severity_count(int severity)
+{
+	return severity_counts[SEVERITY_INDEX(severity)];
+}
+
+guint
+expert_get_tally_count(void)
+{
+	return tallies ? tallies->len : 0;
+}
+
+const expert_tally_t *
+expert_get_tally(guint n)
+{
+	if (tallies == NULL || n >= tallies->len)
+		return NULL;
+	return (const expert_tally_t *)g_ptr_array_index(tallies, n);
+}
+
 expert_module_t *expert_register_protocol(int id)
 {
 	expert_module_t *module;
@@ -469,6 +574,10 @@ expert_set_info_vformat(packet_info *pinfo, proto_item *pi, int group, int sever
 		highest_severity = severity;
 	}
 
+	if (!PINFO_FD_VISITED(pinfo)) {
+		expert_tally(pinfo, group, severity, format);
+	}
+
 	/* XXX: can we get rid of these checks and make them programming errors instead now? */
 	if (pi != NULL && PITEM_FINFO(pi) != NULL) {
 		expert_set_item_flags(pi, group, severity);
@@ -479,6 +588,13 @@ expert_set_info_vformat(packet_info *pinfo, proto_item *pi, int group, int sever
 		col_add_str(pinfo->cinfo, COL_EXPERT, val_to_str(severity, expert_severity_vals, "Unknown (%u)"));
 	}
 
+	/* Without a protocol tree or a tap, nothing looks at the message,
+	   so don't bother formatting it. */
+	tap = have_tap_listener(expert_tap);
+	if (pi == NULL && !tap) {
+		return;
+	}
+
 	if (use_vaformat) {
 		g_vsnprintf(formatted, ITEM_LABEL_LENGTH, format, ap);
 	} else {
@@ -507,8 +623,6 @@ expert_set_info_vformat(packet_info *pinfo, proto_item *pi, int group, int sever
 					      "%s", val_to_str_const(group, expert_group_vals, "Unknown"));
 	PROTO_ITEM_SET_GENERATED(ti);
 
-	tap = have_tap_listener(expert_tap);
-
 	if (!tap)
 		return;
 
@@ -106,6 +106,34 @@ expert_get_highest_severity(void);
 WS_DLL_PUBLIC void
 expert_update_comment_count(guint64 count);
 
+/** Expert infos counted the first time each frame is dissected, one for
+ *  each distinct message template (the format string or registered
+ *  summary, before any arguments are filled in), protocol, group and
+ *  severity.  However many events there are, only the distinct templates
+ *  take up memory. */
+typedef struct expert_tally_s {
+	const gchar *protocol;
+	const gchar *summary;		/**< message template */
+	int          group;
+	int          severity;
+	guint32      count;		/**< number of events */
+	guint32      first_frame;	/**< frame of the first event */
+} expert_tally_t;
+
+/** Return the number of expert infos of a severity (PI_CHAT, ...) seen
+ *  the first time the frames were dissected. */
+WS_DLL_PUBLIC guint32
+expert_get_severity_count(int severity);
+
+/** Return the number of distinct message templates counted. */
+WS_DLL_PUBLIC guint
+expert_get_tally_count(void);
+
+/** Return the n-th distinct message template counted, in the order in
+ *  which they were first seen. */
+WS_DLL_PUBLIC const expert_tally_t *
+expert_get_tally(guint n);
+
 /** Add an expert info.
  Add an expert info tree to a protocol item using registered expert info item
  @param pinfo Packet info of the currently processed packet. May be NULL if
@@ -0,0 +1,878 @@
+/* field_store.c
+ * Implements a per-frame store of selected field values
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/file_util.h>
+#include <wsutil/filesystem.h>
+#include <wsutil/sha1.h>
+
+#include <epan/proto.h>
+#include <epan/epan_dissect.h>
+#include <epan/packet.h>
+#include <epan/prefs.h>
+#include <epan/prefs-int.h>
+#include <epan/uat-int.h>
+#include <epan/ex-opt.h>
+
+#include "field_store.h"
+
+/*
+ * Each field has two arrays indexed by frame number - 1: the value, and
+ * what we know about it (one of the FS_STATE_ values).  Frames past the
+ * end of the arrays haven't been recorded.
+ */
+#define FS_STATE_UNRECORDED   0
+#define FS_STATE_ABSENT       1
+#define FS_STATE_PRESENT      2
+#define FS_STATE_MULTIPLE     3
+#define FS_STATE_GENERATED    4   /* not from the packet's own bytes */
+
+typedef struct {
+  int          hfid;
+  GArray      *values;          /* guint64 */
+  GByteArray  *states;          /* FS_STATE_ */
+} field_store_column_t;
+
+struct _field_store {
+  GArray      *columns;         /* field_store_column_t */
+  gboolean     changed;         /* since it was created or loaded */
+};
+
+/*
+ * Layout of a field store cache file: a header, then for each field its
+ * name (name_len bytes, no terminating NUL), frame_count state bytes and
+ * frame_count values.  All fields are little-endian.
+ *
+ * The cache is only used if the capture file, the version of Wireshark
+ * and everything else that field_store_settings_digest() looks at are the
+ * same as when it was written, as any of them changing could change the
+ * values the fields get.  Only fields that field_store_field_ok() accepts
+ * are read from it, with the same states field_store_record() would have
+ * given them, so it can't bring back values that could since have
+ * changed.
+ */
+#define FIELD_STORE_SUFFIX    ".wsfst"
+#define FIELD_STORE_MAGIC     "WSFSTO\r\n"
+#define FIELD_STORE_VERSION   3
+
+typedef struct {
+  guint8       magic[8];        /* FIELD_STORE_MAGIC */
+  guint32      version;         /* FIELD_STORE_VERSION */
+  guint32      num_fields;
+  guint64      file_size;       /* size of the capture file */
+  gint64       file_mtime;      /* modification time of the capture file */
+  guint8       settings[20];    /* field_store_settings_digest() */
+  guint32      reserved2;
+  gchar        ws_version[32];  /* VERSION of the Wireshark that wrote it */
+  guint32      frame_count;
+  guint32      reserved;
+} field_store_file_hdr;
+
+/*
+ * The fields that can be stored.  Their values come straight from the
+ * headers of the frame they're in, so the value recorded the first time
+ * the frame is dissected is still right later on.  Fields that depend on
+ * other frames (tcp.analysis.*, dns.response_in), on the time reference
+ * or a time shift (frame.time_relative, frame.time_delta_displayed, even
+ * frame.time) or on preferences and earlier frames (relative sequence
+ * numbers) change without the frame being dissected again, so a stored
+ * value could hide frames that match a filter.
+ */
+static const char *field_store_stable_fields[] = {
+  "eth.type",
+  "vlan.id",
+  "vlan.priority",
+  "arp.opcode",
+  "arp.src.proto_ipv4",
+  "arp.dst.proto_ipv4",
+  "ip.version",
+  "ip.hdr_len",
+  "ip.dsfield",
+  "ip.dsfield.dscp",
+  "ip.len",
+  "ip.id",
+  "ip.flags",
+  "ip.frag_offset",
+  "ip.ttl",
+  "ip.proto",
+  "ip.src",
+  "ip.dst",
+  "ipv6.flow",
+  "ipv6.plen",
+  "ipv6.nxt",
+  "ipv6.hlim",
+  "icmp.type",
+  "icmp.code",
+  "icmpv6.type",
+  "icmpv6.code",
+  "tcp.srcport",
+  "tcp.dstport",
+  "tcp.hdr_len",
+  "tcp.flags",
+  "tcp.window_size_value",
+  "tcp.urgent_pointer",
+  "udp.srcport",
+  "udp.dstport",
+  "udp.length",
+  "sctp.srcport",
+  "sctp.dstport",
+  NULL
+};
+
+static gboolean
+field_store_field_ok(const header_field_info *hfinfo)
+{
+  guint i;
+
+  if (!IS_FT_UINT(hfinfo->type) && !IS_FT_INT(hfinfo->type) &&
+      !IS_FT_TIME(hfinfo->type) && hfinfo->type != FT_IPv4)
+    return FALSE;
+  for (i = 0; field_store_stable_fields[i] != NULL; i++) {
+    if (strcmp(hfinfo->abbrev, field_store_stable_fields[i]) == 0)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+gboolean
+field_store_type_is_signed(enum ftenum ftype)
+{
+  return IS_FT_INT(ftype) || IS_FT_TIME(ftype);
+}
+
+gboolean
+field_store_value(fvalue_t *fv, guint64 *value)
+{
+  const nstime_t *ts;
+
+  switch (fvalue_type_ftenum(fv)) {
+
+  case FT_UINT8:
+  case FT_UINT16:
+  case FT_UINT24:
+  case FT_UINT32:
+  case FT_FRAMENUM:
+    *value = fvalue_get_uinteger(fv);
+    return TRUE;
+
+  case FT_INT8:
+  case FT_INT16:
+  case FT_INT24:
+  case FT_INT32:
+    *value = (guint64)(gint64)fvalue_get_sinteger(fv);
+    return TRUE;
+
+  case FT_UINT64:
+  case FT_INT64:
+    *value = fvalue_get_integer64(fv);
+    return TRUE;
+
+  case FT_ABSOLUTE_TIME:
+  case FT_RELATIVE_TIME:
+    ts = (const nstime_t *)fvalue_get(fv);
+    *value = (guint64)((gint64)ts->secs * G_GINT64_CONSTANT(1000000000) + ts->nsecs);
+    return TRUE;
+
+  case FT_IPv4:
+    *value = fv->value.ipv4.addr;
+    return TRUE;
+
+  default:
+    return FALSE;
+  }
+}
+
+field_store_t *
+field_store_new(const char *fields)
+{
+  field_store_t       *fs;
+  gchar              **names;
+  header_field_info   *hfinfo;
+  field_store_column_t col;
+  guint                i, j;
+
+  if (fields == NULL)
+    return NULL;
+
+  fs = g_new(field_store_t, 1);
+  fs->columns = g_array_new(FALSE, FALSE, sizeof(field_store_column_t));
+  fs->changed = FALSE;
+
+  names = g_strsplit_set(fields, ", \t\n", -1);
+  for (i = 0; names[i] != NULL; i++) {
+    if (names[i][0] == '\0')
+      continue;
+    hfinfo = proto_registrar_get_byname(names[i]);
+    if (hfinfo == NULL || !field_store_field_ok(hfinfo))
+      continue;
+    /* Fields that share a name with another field can't be told apart
+       by a filter, so there'd be no use for them. */
+    if (hfinfo->same_name_next != NULL || hfinfo->same_name_prev_id != -1)
+      continue;
+    for (j = 0; j < fs->columns->len; j++) {
+      if (g_array_index(fs->columns, field_store_column_t, j).hfid == hfinfo->id)
+        break;
+    }
+    if (j < fs->columns->len)
+      continue;
+
+    col.hfid = hfinfo->id;
+    col.values = g_array_new(FALSE, FALSE, sizeof(guint64));
+    col.states = g_byte_array_new();
+    g_array_append_val(fs->columns, col);
+  }
+  g_strfreev(names);
+
+  if (fs->columns->len == 0) {
+    field_store_free(fs);
+    return NULL;
+  }
+  return fs;
+}
+
+void
+field_store_free(field_store_t *fs)
+{
+  field_store_column_t *col;
+  guint                 i;
+
+  if (fs == NULL)
+    return;
+
+  for (i = 0; i < fs->columns->len; i++) {
+    col = &g_array_index(fs->columns, field_store_column_t, i);
+    g_array_free(col->values, TRUE);
+    g_byte_array_free(col->states, TRUE);
+  }
+  g_array_free(fs->columns, TRUE);
+  g_free(fs);
+}
+
+void
+field_store_clear(field_store_t *fs)
+{
+  field_store_column_t *col;
+  guint                 i;
+
+  for (i = 0; i < fs->columns->len; i++) {
+    col = &g_array_index(fs->columns, field_store_column_t, i);
+    g_array_set_size(col->values, 0);
+    g_byte_array_set_size(col->states, 0);
+  }
+  fs->changed = TRUE;
+}
+
+guint
+field_store_num_fields(const field_store_t *fs)
+{
+  return fs->columns->len;
+}
+
+int
+field_store_field(const field_store_t *fs, guint n)
+{
+  g_assert(n < fs->columns->len);
+  return g_array_index(fs->columns, field_store_column_t, n).hfid;
+}
+
+void
+field_store_prime(const field_store_t *fs, epan_dissect_t *edt)
+{
+  guint i;
+
+  if (edt->tree == NULL)
+    return;
+  for (i = 0; i < fs->columns->len; i++)
+    proto_tree_prime_hfid(edt->tree,
+        g_array_index(fs->columns, field_store_column_t, i).hfid);
+}
+
+void
+field_store_record(field_store_t *fs, guint32 frame_num,
+    const epan_dissect_t *edt)
+{
+  field_store_column_t *col;
+  GPtrArray            *finfos;
+  field_info           *fi;
+  guint64               value;
+  guint8                state;
+  guint                 old_len;
+  guint                 i;
+
+  g_assert(frame_num > 0);
+
+  for (i = 0; i < fs->columns->len; i++) {
+    col = &g_array_index(fs->columns, field_store_column_t, i);
+
+    value = 0;
+    finfos = edt->tree ? proto_get_finfo_ptr_array(edt->tree, col->hfid) : NULL;
+    if (edt->tree == NULL) {
+      state = FS_STATE_UNRECORDED;
+    } else if (finfos == NULL || finfos->len == 0) {
+      state = FS_STATE_ABSENT;
+    } else if (finfos->len > 1) {
+      state = FS_STATE_MULTIPLE;
+    } else {
+      fi = (field_info *)g_ptr_array_index(finfos, 0);
+      /* A dissector can add a field that's normally in the header as a
+         generated item, e.g. one worked out from another packet. */
+      if (FI_GET_FLAG(fi, FI_GENERATED))
+        state = FS_STATE_GENERATED;
+      else
+        state = field_store_value(&fi->value, &value) ?
+            FS_STATE_PRESENT : FS_STATE_UNRECORDED;
+    }
+
+    /* Frames are normally recorded in order, so this only grows the
+       arrays by one; anything skipped over stays unrecorded. */
+    old_len = col->states->len;
+    if (old_len < frame_num) {
+      g_array_set_size(col->values, frame_num);
+      g_byte_array_set_size(col->states, frame_num);
+      memset(col->states->data + old_len, FS_STATE_UNRECORDED,
+             frame_num - old_len);
+    }
+    g_array_index(col->values, guint64, frame_num - 1) = value;
+    col->states->data[frame_num - 1] = state;
+  }
+  fs->changed = TRUE;
+}
+
+gboolean
+field_store_is_recorded(const field_store_t *fs, guint32 frame_num)
+{
+  const field_store_column_t *col;
+
+  col = &g_array_index(fs->columns, field_store_column_t, 0);
+  return frame_num != 0 && frame_num <= col->states->len &&
+         col->states->data[frame_num - 1] != FS_STATE_UNRECORDED;
+}
+
+field_store_result_t
+field_store_get(const field_store_t *fs, int hfid, guint32 frame_num,
+    guint64 *value)
+{
+  const field_store_column_t *col;
+  guint                       i;
+
+  for (i = 0; i < fs->columns->len; i++) {
+    col = &g_array_index(fs->columns, field_store_column_t, i);
+    if (col->hfid != hfid)
+      continue;
+
+    if (frame_num == 0 || frame_num > col->states->len)
+      return FIELD_STORE_UNKNOWN;
+    switch (col->states->data[frame_num - 1]) {
+
+    case FS_STATE_ABSENT:
+      return FIELD_STORE_ABSENT;
+
+    case FS_STATE_PRESENT:
+      *value = g_array_index(col->values, guint64, frame_num - 1);
+      return FIELD_STORE_PRESENT;
+
+    default:
+      return FIELD_STORE_UNKNOWN;
+    }
+  }
+  return FIELD_STORE_UNKNOWN;
+}
+
+static void
+digest_str(sha1_context *ctx, const char *str)
+{
+  /* Include the NUL, so that "ab","c" and "a","bc" differ */
+  if (str == NULL)
+    str = "";
+  sha1_update(ctx, (const guint8 *)str, (guint32)strlen(str) + 1);
+}
+
+static void
+digest_uint(sha1_context *ctx, guint64 value)
+{
+  guint64 le = GUINT64_TO_LE(value);
+
+  sha1_update(ctx, (const guint8 *)&le, sizeof le);
+}
+
+/* Add the name, size and modification time of a file, or just the name
+   if it isn't there. */
+static void
+digest_file(sha1_context *ctx, const char *path)
+{
+  ws_statb64 statb;
+
+  digest_str(ctx, path);
+  if (path != NULL && ws_stat64(path, &statb) == 0) {
+    digest_uint(ctx, (guint64)statb.st_size);
+    digest_uint(ctx, (guint64)statb.st_mtime);
+  }
+}
+
+static gint
+digest_compare_names(gconstpointer a, gconstpointer b)
+{
+  return strcmp(*(const char * const *)a, *(const char * const *)b);
+}
+
+/* Add every file under a directory, in name order, so that adding,
+   removing or changing a plugin or Lua script shows up. */
+static void
+digest_dir(sha1_context *ctx, const char *dirname, int depth)
+{
+  GDir        *dir;
+  const gchar *name;
+  GPtrArray   *names;
+  gchar       *path;
+  guint        i;
+
+  if (dirname == NULL || (dir = g_dir_open(dirname, 0, NULL)) == NULL)
+    return;
+  names = g_ptr_array_new();
+  while ((name = g_dir_read_name(dir)) != NULL)
+    g_ptr_array_add(names, g_strdup(name));
+  g_dir_close(dir);
+  g_ptr_array_sort(names, digest_compare_names);
+
+  for (i = 0; i < names->len; i++) {
+    path = g_build_filename(dirname, (const gchar *)g_ptr_array_index(names, i), NULL);
+    if (depth > 0 && g_file_test(path, G_FILE_TEST_IS_DIR))
+      digest_dir(ctx, path, depth - 1);
+    else
+      digest_file(ctx, path);
+    g_free(path);
+    g_free(g_ptr_array_index(names, i));
+  }
+  g_ptr_array_free(names, TRUE);
+}
+
+static guint
+digest_pref(pref_t *pref, gpointer user_data)
+{
+  sha1_context *ctx = (sha1_context *)user_data;
+  char         *value;
+
+  digest_str(ctx, pref->name);
+  value = prefs_pref_to_str(pref, pref_current);
+  digest_str(ctx, value);
+  g_free(value);
+  return 0;
+}
+
+static guint
+digest_module(module_t *module, gpointer user_data)
+{
+  sha1_context *ctx = (sha1_context *)user_data;
+
+  digest_str(ctx, module->name);
+  prefs_pref_foreach(module, digest_pref, ctx);
+  return 0;
+}
+
+static void
+digest_decode_as(const gchar *table_name, ftenum_t selector_type,
+    gpointer key, gpointer value, gpointer user_data)
+{
+  sha1_context      *ctx = (sha1_context *)user_data;
+  dissector_handle_t handle;
+
+  digest_str(ctx, table_name);
+  if (IS_FT_UINT(selector_type))
+    digest_uint(ctx, GPOINTER_TO_UINT(key));
+  else
+    digest_str(ctx, (const char *)key);
+  handle = dtbl_entry_get_handle((dtbl_entry_t *)value);
+  digest_str(ctx, handle ? dissector_handle_get_short_name(handle) : NULL);
+}
+
+static void
+digest_heur_entry(const gchar *table_name, heur_dtbl_entry_t *entry,
+    gpointer user_data)
+{
+  sha1_context *ctx = (sha1_context *)user_data;
+
+  digest_str(ctx, table_name);
+  digest_str(ctx, proto_get_protocol_filter_name(proto_get_id(entry->protocol)));
+  digest_uint(ctx, entry->enabled);
+}
+
+static void
+digest_heur_table(const gchar *table_name, heur_dissector_list_t *table _U_,
+    gpointer user_data)
+{
+  heur_dissector_table_foreach(table_name, digest_heur_entry, user_data);
+}
+
+static void
+digest_uat(void *uat_p, void *user_data)
+{
+  sha1_context *ctx = (sha1_context *)user_data;
+  uat_t        *uat = (uat_t *)uat_p;
+  gchar        *path;
+
+  digest_str(ctx, uat->name);
+  path = uat_get_actual_filename(uat, FALSE);
+  digest_file(ctx, path);
+  g_free(path);
+  /* Edited but not saved yet */
+  digest_uint(ctx, uat->changed);
+}
+
+/*
+ * Work out a digest of everything other than the capture file that
+ * decides the values fields get:
+ *
+ *  - the current value of every preference, which covers the global and
+ *    personal preferences files and any set on the command line;
+ *  - which protocols and heuristic dissectors are enabled, which covers
+ *    the disabled_protos and heuristic_protos files;
+ *  - the "Decode As" changes, which covers decode_as_entries;
+ *  - the UAT files, such as user DLTs and decryption keys;
+ *  - the fields registered, and the files that plugins and Lua scripts
+ *    are loaded from.
+ *
+ * Any of these changing makes a cache file written before unusable.
+ */
+static void
+field_store_settings_digest(guint8 digest[20])
+{
+  sha1_context  ctx;
+  void         *cookie;
+  int           proto_id;
+  gchar        *path;
+  gint          i, count;
+
+  sha1_starts(&ctx);
+
+  prefs_modules_foreach(digest_module, &ctx);
+
+  for (proto_id = proto_get_first_protocol(&cookie); proto_id != -1;
+       proto_id = proto_get_next_protocol(&cookie)) {
+    digest_str(&ctx, proto_get_protocol_filter_name(proto_id));
+    digest_uint(&ctx, proto_is_protocol_enabled(find_protocol_by_id(proto_id)));
+  }
+  dissector_all_heur_tables_foreach_table(digest_heur_table, &ctx, NULL);
+  dissector_all_tables_foreach_changed(digest_decode_as, &ctx);
+  uat_foreach_table(digest_uat, &ctx);
+
+  digest_uint(&ctx, proto_registrar_generation());
+  digest_dir(&ctx, get_plugin_dir(), 2);
+  path = get_plugins_pers_dir();
+  digest_dir(&ctx, path, 2);
+  g_free(path);
+  path = get_datafile_path("init.lua");
+  digest_file(&ctx, path);
+  g_free(path);
+  path = get_persconffile_path("init.lua", FALSE);
+  digest_file(&ctx, path);
+  g_free(path);
+  count = ex_opt_count("lua_script");
+  for (i = 0; i < count; i++)
+    digest_file(&ctx, ex_opt_get_nth("lua_script", i));
+
+  sha1_finish(&ctx, digest);
+}
+
+/* Fill in the parts of a cache file header that identify what it was
+   made from. */
+static gboolean
+field_store_fill_hdr(field_store_file_hdr *hdr, const char *capture_filename)
+{
+  ws_statb64  statb;
+
+  memset(hdr, 0, sizeof *hdr);
+  memcpy(hdr->magic, FIELD_STORE_MAGIC, sizeof hdr->magic);
+  hdr->version = GUINT32_TO_LE(FIELD_STORE_VERSION);
+
+  if (ws_stat64(capture_filename, &statb) == -1)
+    return FALSE;
+  hdr->file_size = GUINT64_TO_LE((guint64)statb.st_size);
+  hdr->file_mtime = GINT64_TO_LE((gint64)statb.st_mtime);
+
+  field_store_settings_digest(hdr->settings);
+
+  g_strlcpy(hdr->ws_version, VERSION, sizeof hdr->ws_version);
+  return TRUE;
+}
+
+gboolean
+field_store_save(const field_store_t *fs, const char *capture_filename,
+    guint32 frame_count, int *err)
+{
+  field_store_file_hdr  hdr;
+  const field_store_column_t *col;
+  const char           *name;
+  guint32               name_len;
+  guint64               value;
+  gchar                *path;
+  FILE                 *fp;
+  guint                 i;
+  guint32               n;
+  gboolean              ok;
+
+  *err = 0;
+  if (!fs->changed)
+    return TRUE;
+
+  /* Don't save a store that's missing some of the frames. */
+  for (i = 0; i < fs->columns->len; i++) {
+    col = &g_array_index(fs->columns, field_store_column_t, i);
+    if (col->states->len < frame_count ||
+        memchr(col->states->data, FS_STATE_UNRECORDED, frame_count) != NULL)
+      return FALSE;
+  }
+
+  if (!field_store_fill_hdr(&hdr, capture_filename)) {
+    *err = errno;
+    return FALSE;
+  }
+  hdr.num_fields = GUINT32_TO_LE(fs->columns->len);
+  hdr.frame_count = GUINT32_TO_LE(frame_count);
+
+  path = g_strconcat(capture_filename, FIELD_STORE_SUFFIX, NULL);
+  fp = ws_fopen(path, "wb");
+  if (fp == NULL) {
+    *err = errno;
+    g_free(path);
+    return FALSE;
+  }
+
+  ok = fwrite(&hdr, sizeof hdr, 1, fp) == 1;
+  for (i = 0; ok && i < fs->columns->len; i++) {
+    col = &g_array_index(fs->columns, field_store_column_t, i);
+    name = proto_registrar_get_abbrev(col->hfid);
+    name_len = GUINT32_TO_LE((guint32)strlen(name));
+    ok = fwrite(&name_len, sizeof name_len, 1, fp) == 1 &&
+         fwrite(name, strlen(name), 1, fp) == 1 &&
+         (frame_count == 0 ||
+          fwrite(col->states->data, frame_count, 1, fp) == 1);
+    for (n = 0; ok && n < frame_count; n++) {
+      value = GUINT64_TO_LE(g_array_index(col->values, guint64, n));
+      ok = fwrite(&value, sizeof value, 1, fp) == 1;
+    }
+  }
+  if (!ok) {
+    *err = errno;
+    fclose(fp);
+    ws_unlink(path);
+    g_free(path);
+    return FALSE;
+  }
+  if (fclose(fp) == EOF) {
+    *err = errno;
+    ws_unlink(path);
+    g_free(path);
+    return FALSE;
+  }
+  g_free(path);
+  return TRUE;
+}
+
+field_store_t *
+field_store_load(const char *capture_filename, const char *fields)
+{
+  field_store_t        *fs;
+  field_store_file_hdr  hdr, want;
+  field_store_column_t *col;
+  const char           *name;
+  gchar                *path;
+  FILE                 *fp;
+  guint32               name_len, frame_count, n;
+  gchar                 name_buf[256];
+  guint64               value;
+  guint                 i;
+  gboolean              ok;
+
+  fs = field_store_new(fields);
+  if (fs == NULL)
+    return NULL;
+
+  path = g_strconcat(capture_filename, FIELD_STORE_SUFFIX, NULL);
+  fp = ws_fopen(path, "rb");
+  g_free(path);
+  if (fp == NULL)
+    return fs;
+
+  /* Anything that doesn't match what we'd write now is ignored, and
+     the store is filled in from scratch. */
+  ok = field_store_fill_hdr(&want, capture_filename) &&
+       fread(&hdr, sizeof hdr, 1, fp) == 1 &&
+       memcmp(hdr.magic, want.magic, sizeof hdr.magic) == 0 &&
+       hdr.version == want.version &&
+       GUINT32_FROM_LE(hdr.num_fields) == fs->columns->len &&
+       hdr.file_size == want.file_size &&
+       hdr.file_mtime == want.file_mtime &&
+       memcmp(hdr.settings, want.settings, sizeof hdr.settings) == 0 &&
+       strncmp(hdr.ws_version, want.ws_version, sizeof hdr.ws_version) == 0;
+  frame_count = ok ? GUINT32_FROM_LE(hdr.frame_count) : 0;
+
+  for (i = 0; ok && i < fs->columns->len; i++) {
+    col = &g_array_index(fs->columns, field_store_column_t, i);
+    name = proto_registrar_get_abbrev(col->hfid);
+    ok = fread(&name_len, sizeof name_len, 1, fp) == 1;
+    name_len = GUINT32_FROM_LE(name_len);
+    ok = ok && name_len == strlen(name) && name_len < sizeof name_buf &&
+         fread(name_buf, name_len, 1, fp) == 1 &&
+         memcmp(name_buf, name, name_len) == 0;
+    if (!ok)
+      break;
+
+    g_array_set_size(col->values, frame_count);
+    g_byte_array_set_size(col->states, frame_count);
+    ok = frame_count == 0 ||
+         fread(col->states->data, frame_count, 1, fp) == 1;
+    for (n = 0; ok && n < frame_count; n++)
+      ok = col->states->data[n] <= FS_STATE_GENERATED;
+    for (n = 0; ok && n < frame_count; n++) {
+      ok = fread(&value, sizeof value, 1, fp) == 1;
+      g_array_index(col->values, guint64, n) = GUINT64_FROM_LE(value);
+    }
+  }
+  fclose(fp);
+
+  if (!ok)
+    field_store_clear(fs);
+  fs->changed = !ok;
+  return fs;
+}
+
+struct _field_frame_index {
+  int          hfid;
+  GPtrArray   *frames;          /* GArray of guint32, for each value */
+};
+
+/* Every frame index, so filters can find them by field */
+static GSList *field_frame_indexes = NULL;
+
+field_frame_index_t *
+field_frame_index_new(int hfid)
+{
+  field_frame_index_t *ffi = g_new(field_frame_index_t, 1);
+
+  ffi->hfid = hfid;
+  ffi->frames = g_ptr_array_new();
+  field_frame_indexes = g_slist_prepend(field_frame_indexes, ffi);
+  return ffi;
+}
+
+void
+field_frame_index_clear(field_frame_index_t *ffi)
+{
+  guint i;
+
+  for (i = 0; i < ffi->frames->len; i++) {
+    if (g_ptr_array_index(ffi->frames, i) != NULL)
+      g_array_free((GArray *)g_ptr_array_index(ffi->frames, i), TRUE);
+  }
+  g_ptr_array_set_size(ffi->frames, 0);
+}
+
+void
+field_frame_index_add(field_frame_index_t *ffi, guint32 value,
+    guint32 frame_num)
+{
+  GArray *frames;
+
+  if (value >= ffi->frames->len)
+    g_ptr_array_set_size(ffi->frames, value + 1);
+  frames = (GArray *)g_ptr_array_index(ffi->frames, value);
+  if (frames == NULL) {
+    frames = g_array_new(FALSE, FALSE, sizeof(guint32));
+    g_ptr_array_index(ffi->frames, value) = frames;
+  }
+
+  /* A frame can have the same value more than once, e.g. if it's
+     dissected twice or has the field in a tunnel as well; list it once. */
+  if (frames->len != 0 &&
+      g_array_index(frames, guint32, frames->len - 1) >= frame_num)
+    return;
+  g_array_append_val(frames, frame_num);
+}
+
+const guint32 *
+field_frame_index_frames(const field_frame_index_t *ffi, guint32 value,
+    guint *count)
+{
+  GArray *frames = NULL;
+
+  if (value < ffi->frames->len)
+    frames = (GArray *)g_ptr_array_index(ffi->frames, value);
+  if (frames == NULL) {
+    *count = 0;
+    return NULL;
+  }
+  *count = frames->len;
+  return (const guint32 *)frames->data;
+}
+
+field_frame_index_t *
+field_frame_index_find(int hfid)
+{
+  GSList *l;
+
+  for (l = field_frame_indexes; l != NULL; l = l->next) {
+    if (((field_frame_index_t *)l->data)->hfid == hfid)
+      return (field_frame_index_t *)l->data;
+  }
+  return NULL;
+}
+
+gboolean
+field_frame_index_has(const field_frame_index_t *ffi, guint32 value,
+    guint32 frame_num)
+{
+  const guint32 *frames;
+  guint          lo, hi, mid;
+
+  frames = field_frame_index_frames(ffi, value, &hi);
+  lo = 0;
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (frames[mid] == frame_num)
+      return TRUE;
+    if (frames[mid] < frame_num)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return FALSE;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 2
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=2 tabstop=8 expandtab:
+ * :indentSize=2:tabSize=8:noTabs=true:
+ */
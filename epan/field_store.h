@@ -0,0 +1,161 @@
+/* field_store.h
+ * Definitions for the per-frame store of selected field values
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __FIELD_STORE_H__
+#define __FIELD_STORE_H__
+
+#include <epan/epan.h>
+#include <epan/ftypes/ftypes.h>
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A field store keeps, for a chosen set of fields, the value each field
+ * had in each frame when that frame was first dissected, one array per
+ * field indexed by frame number.  Display filters and anything else that
+ * only looks at those fields can then get at the values again without
+ * dissecting the frames.
+ *
+ * Only fields on a fixed list of integer and IPv4 address fields that are
+ * taken straight from the frame's own headers, such as ip.src and
+ * tcp.dstport, can be stored; fields whose value can change without the
+ * frame being dissected again, because it depends on other frames, the
+ * time reference or preferences, can't.  Values are
+ * kept as 64-bit integers: signed fields sign-extended, IPv4 addresses in
+ * host byte order and times as nanoseconds.  A frame in which a field
+ * appears more than once records "more than one value" rather than the
+ * values themselves.
+ */
+typedef struct _field_store field_store_t;
+
+typedef enum {
+  FIELD_STORE_UNKNOWN,  /* field or frame not recorded, more than one value
+                           or a generated value */
+  FIELD_STORE_ABSENT,   /* the field isn't in the frame */
+  FIELD_STORE_PRESENT   /* the field is in the frame once, with *value */
+} field_store_result_t;
+
+/** Create a field store for the fields named in "fields", separated by
+ *  commas and/or white space.  Names that aren't fields, and fields that
+ *  can't be stored, are skipped.  Returns NULL if none are left. */
+WS_DLL_PUBLIC field_store_t *field_store_new(const char *fields);
+
+/** Free a field store. */
+WS_DLL_PUBLIC void field_store_free(field_store_t *fs);
+
+/** Forget all recorded values, e.g. because every frame is going to be
+ *  dissected from scratch. */
+WS_DLL_PUBLIC void field_store_clear(field_store_t *fs);
+
+/** Return the number of fields in the store. */
+WS_DLL_PUBLIC guint field_store_num_fields(const field_store_t *fs);
+
+/** Return the field ID of the n-th field in the store. */
+WS_DLL_PUBLIC int field_store_field(const field_store_t *fs, guint n);
+
+/** Ask for the stored fields to be kept in edt's protocol tree, so that
+ *  field_store_record() can find them.  Call before dissecting. */
+WS_DLL_PUBLIC void field_store_prime(const field_store_t *fs,
+    epan_dissect_t *edt);
+
+/** Record the values the stored fields have in the dissection edt of
+ *  frame frame_num. */
+WS_DLL_PUBLIC void field_store_record(field_store_t *fs, guint32 frame_num,
+    const epan_dissect_t *edt);
+
+/** Return TRUE if frame frame_num has been recorded. */
+WS_DLL_PUBLIC gboolean field_store_is_recorded(const field_store_t *fs,
+    guint32 frame_num);
+
+/** Look up the value field hfid had in frame frame_num. */
+WS_DLL_PUBLIC field_store_result_t field_store_get(const field_store_t *fs,
+    int hfid, guint32 frame_num, guint64 *value);
+
+/** Write the store, which must have a value for each of the first
+ *  frame_count frames, to a cache file next to capture_filename, unless
+ *  it hasn't changed since it was loaded from there.  Returns TRUE on
+ *  success, FALSE with *err set to an errno value, or to 0 if some of
+ *  the frames weren't recorded, on failure. */
+WS_DLL_PUBLIC gboolean field_store_save(const field_store_t *fs,
+    const char *capture_filename, guint32 frame_count, int *err);
+
+/** Create a field store for "fields", as field_store_new() does, and
+ *  fill it in from the cache file next to capture_filename, if there is
+ *  one and it was written for the same capture file, version of
+ *  Wireshark and fields, with the same preferences, enabled protocols,
+ *  "Decode As" settings, UATs, plugins and Lua scripts.  Returns NULL if
+ *  none of the fields can be stored. */
+WS_DLL_PUBLIC field_store_t *field_store_load(const char *capture_filename,
+    const char *fields);
+
+/** Convert a value of one of the types that can be stored to the form
+ *  in which it is stored.  Returns FALSE if the type can't be stored. */
+WS_DLL_PUBLIC gboolean field_store_value(fvalue_t *fv, guint64 *value);
+
+/** Return TRUE if values of type ftype are signed in the store. */
+WS_DLL_PUBLIC gboolean field_store_type_is_signed(enum ftenum ftype);
+
+/*
+ * A frame index is the other way round from a field store: for one
+ * unsigned integer field whose values are small, densely allocated
+ * numbers, such as tcp.stream, it lists the frames in which the field
+ * has each value.  The dissector that assigns the numbers keeps the
+ * index, adding each frame the first time it's dissected; "Follow
+ * Stream" and other filters on a single value can then visit only the
+ * frames that have it.
+ */
+typedef struct _field_frame_index field_frame_index_t;
+
+/** Create an empty frame index for field hfid, which filters will use
+ *  from then on.  Call it once, from the dissector's init routine. */
+WS_DLL_PUBLIC field_frame_index_t *field_frame_index_new(int hfid);
+
+/** Forget all the frames in the index, e.g. because a new file is being
+ *  read. */
+WS_DLL_PUBLIC void field_frame_index_clear(field_frame_index_t *ffi);
+
+/** Record that the field has value "value" in frame frame_num.  Frames
+ *  must be added in increasing order of frame number. */
+WS_DLL_PUBLIC void field_frame_index_add(field_frame_index_t *ffi,
+    guint32 value, guint32 frame_num);
+
+/** Return the frames in which the field has value "value", in increasing
+ *  order, and set *count to their number. */
+WS_DLL_PUBLIC const guint32 *field_frame_index_frames(
+    const field_frame_index_t *ffi, guint32 value, guint *count);
+
+/** Return the frame index for field hfid, or NULL if it hasn't got one. */
+WS_DLL_PUBLIC field_frame_index_t *field_frame_index_find(int hfid);
+
+/** Return TRUE if the field has value "value" in frame frame_num, which
+ *  must have been dissected since the index was last cleared. */
+WS_DLL_PUBLIC gboolean field_frame_index_has(const field_frame_index_t *ffi,
+    guint32 value, guint32 frame_num);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FIELD_STORE_H__ */
@@ -23,6 +23,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #include <epan/epan.h>
@@ -42,103 +44,135 @@ typedef struct _frame_proto_data {
   void *proto_data;
 } frame_proto_data;
 
-/* XXX - I declared this static, because it only seems to be used by
- * p_get_proto_data and p_add_proto_data
- */
-static gint
-p_compare(gconstpointer a, gconstpointer b)
+/* A proto_data_vec is a growable array of frame_proto_data kept sorted by
+   protocol and key, so a lookup is a binary search over one block rather
+   than a walk down a list of separately-allocated nodes.  Entries with the
+   same protocol and key are kept newest first, which is the order the
+   GSLists this replaced returned them in. */
+struct _proto_data_vec {
+  guint            count;
+  guint            size;
+  frame_proto_data entries[1];
+};
+
+#define PROTO_DATA_VEC_INITIAL_SIZE 2
+
+/* Index of the first entry not less than (proto, key). */
+static guint
+proto_data_vec_lower_bound(const proto_data_vec *vec, int proto, guint32 key)
 {
-  const frame_proto_data *ap = (const frame_proto_data *)a;
-  const frame_proto_data *bp = (const frame_proto_data *)b;
-
-  if (ap -> proto > bp -> proto){
-    return 1;
-  }else if (ap -> proto == bp -> proto){
-    if (ap -> key > bp -> key){
-      return 1;
-    }else if (ap -> key == bp -> key){
-      return 0;
-    }
-    return -1;
-  }else{
-    return -1;
+  guint lo = 0, hi = vec->count;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+    const frame_proto_data *p = &vec->entries[mid];
+
+    if (p->proto < proto || (p->proto == proto && p->key < key))
+      lo = mid + 1;
+    else
+      hi = mid;
   }
+  return lo;
 }
 
 void
-p_add_proto_data(wmem_allocator_t *tmp_scope, struct _packet_info* pinfo, int proto, guint32 key, void *proto_data)
+proto_data_vec_add(wmem_allocator_t *scope, proto_data_vec **vecp, int proto, guint32 key, void *proto_data)
 {
-  frame_proto_data *p1;
-  GSList** proto_list;
-  wmem_allocator_t *scope;
-
-  if (tmp_scope == pinfo->pool) {
-    scope = tmp_scope;
-    proto_list = &pinfo->proto_data;
-  } else {
-    scope = wmem_file_scope();
-    proto_list = &pinfo->fd->pfd;
+  proto_data_vec *vec = *vecp;
+  guint           i;
+
+  if (vec == NULL) {
+    vec = (proto_data_vec *)wmem_alloc(scope, sizeof(proto_data_vec) +
+                (PROTO_DATA_VEC_INITIAL_SIZE - 1) * sizeof(frame_proto_data));
+    vec->count = 0;
+    vec->size = PROTO_DATA_VEC_INITIAL_SIZE;
+  } else if (vec->count == vec->size) {
+    vec = (proto_data_vec *)wmem_realloc(scope, vec, sizeof(proto_data_vec) +
+                (2 * vec->size - 1) * sizeof(frame_proto_data));
+    vec->size *= 2;
   }
+  *vecp = vec;
+
+  i = proto_data_vec_lower_bound(vec, proto, key);
+  memmove(&vec->entries[i + 1], &vec->entries[i],
+          (vec->count - i) * sizeof(frame_proto_data));
+  vec->entries[i].proto = proto;
+  vec->entries[i].key = key;
+  vec->entries[i].proto_data = proto_data;
+  vec->count++;
+}
 
-  p1 = (frame_proto_data *)wmem_alloc(scope, sizeof(frame_proto_data));
+void *
+proto_data_vec_get(const proto_data_vec *vec, int proto, guint32 key)
+{
+  guint i;
 
-  p1->proto = proto;
-  p1->key = key;
-  p1->proto_data = proto_data;
+  if (vec == NULL)
+    return NULL;
 
-  /* Add it to the GSLIST */
-  *proto_list = g_slist_prepend(*proto_list,
-                    (gpointer *)p1);
+  i = proto_data_vec_lower_bound(vec, proto, key);
+  if (i < vec->count && vec->entries[i].proto == proto &&
+      vec->entries[i].key == key)
+    return vec->entries[i].proto_data;
+  return NULL;
 }
 
-void *
-p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, guint32 key)
+gboolean
+proto_data_vec_remove(proto_data_vec *vec, int proto, guint32 key)
 {
-  frame_proto_data  temp, *p1;
-  GSList           *item;
-
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
+  guint i;
 
-  if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->proto_data, (gpointer *)&temp, p_compare);
-  } else {
-    item = g_slist_find_custom(pinfo->fd->pfd, (gpointer *)&temp, p_compare);
-  }
+  if (vec == NULL)
+    return FALSE;
 
-  if (item) {
-    p1 = (frame_proto_data *)item->data;
-    return p1->proto_data;
-  }
+  i = proto_data_vec_lower_bound(vec, proto, key);
+  if (i == vec->count || vec->entries[i].proto != proto ||
+      vec->entries[i].key != key)
+    return FALSE;
 
-  return NULL;
+  vec->count--;
+  memmove(&vec->entries[i], &vec->entries[i + 1],
+          (vec->count - i) * sizeof(frame_proto_data));
+  return TRUE;
+}
 
+guint
+proto_data_vec_count(const proto_data_vec *vec)
+{
+  return vec ? vec->count : 0;
 }
 
 void
-p_remove_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, guint32 key)
+p_add_proto_data(wmem_allocator_t *tmp_scope, struct _packet_info* pinfo, int proto, guint32 key, void *proto_data)
 {
-  frame_proto_data  temp;
-  GSList           *item;
-  GSList** proto_list;
-
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
+  /* Packet-scoped data lives in the packet's pool and goes away with it;
+     the array holding frame-scoped data is allocated with glib, as the
+     list nodes were, so that frame_data_reset() can free it. */
+  if (tmp_scope == pinfo->pool) {
+    proto_data_vec_add(tmp_scope, &pinfo->proto_data, proto, key, proto_data);
+  } else {
+    proto_data_vec_add(NULL, &pinfo->fd->pfd, proto, key, proto_data);
+  }
+}
 
+void *
+p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, guint32 key)
+{
   if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->fd->pfd, (gpointer *)&temp, p_compare);
-    proto_list = &pinfo->proto_data;
+    return proto_data_vec_get(pinfo->proto_data, proto, key);
   } else {
-    item = g_slist_find_custom(pinfo->fd->pfd, (gpointer *)&temp, p_compare);
-    proto_list = &pinfo->fd->pfd;
+    return proto_data_vec_get(pinfo->fd->pfd, proto, key);
   }
+}
 
-  if (item) {
-    *proto_list = g_slist_remove(*proto_list, item->data);
+void
+p_remove_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, guint32 key)
+{
+  if (scope == pinfo->pool) {
+    proto_data_vec_remove(pinfo->proto_data, proto, key);
+  } else {
+    proto_data_vec_remove(pinfo->fd->pfd, proto, key);
   }
-
 }
 
 gchar *
@@ -146,9 +180,9 @@ p_get_proto_name_and_key(wmem_allocator_t *scope, struct _packet_info* pinfo, gu
   frame_proto_data  *temp;
 
   if (scope == pinfo->pool) {
-    temp = (frame_proto_data*)g_slist_nth_data(pinfo->proto_data, pfd_index);
+    temp = &pinfo->proto_data->entries[pfd_index];
   } else {
-    temp = (frame_proto_data*)g_slist_nth_data(pinfo->fd->pfd, pfd_index);
+    temp = &pinfo->fd->pfd->entries[pfd_index];
   }
 
   return wmem_strdup_printf(wmem_packet_scope(),"[%s, key %u]",proto_get_protocol_name(temp->proto), temp->key);
@@ -314,8 +348,6 @@ frame_data_init(frame_data *fdata, guint32 num,
   fdata->color_filter = NULL;
   fdata->abs_ts.secs = phdr->ts.secs;
   fdata->abs_ts.nsecs = phdr->ts.nsecs;
-  fdata->shift_offset.secs = 0;
-  fdata->shift_offset.nsecs = 0;
   fdata->frame_ref_num = 0;
   fdata->prev_dis_num = 0;
 }
@@ -376,7 +408,7 @@ frame_data_reset(frame_data *fdata)
   fdata->flags.visited = 0;
 
   if (fdata->pfd) {
-    g_slist_free(fdata->pfd);
+    g_free(fdata->pfd);
     fdata->pfd = NULL;
   }
 }
@@ -385,7 +417,7 @@ void
 frame_data_destroy(frame_data *fdata)
 {
   if (fdata->pfd) {
-    g_slist_free(fdata->pfd);
+    g_free(fdata->pfd);
     fdata->pfd = NULL;
   }
 }
@@ -57,18 +57,29 @@ typedef enum {
   PACKET_CHAR_ENC_CHAR_EBCDIC    = 1  /* EBCDIC */
 } packet_char_enc;
 
+/** Protocol data attached to a frame, packet, conversation or circuit;
+   an array kept sorted by protocol and key. */
+typedef struct _proto_data_vec proto_data_vec;
+
 /** The frame number is the ordinal number of the frame in the capture, so
    it's 1-origin.  In various contexts, 0 as a frame number means "frame
-   number unknown". */
+   number unknown".
+
+   One of these is kept for every frame in the capture, so the members are
+   ordered to avoid padding; keep it that way when adding to it.  The time
+   shift offset, which most captures never use, is kept by the
+   frame_data_sequence rather than here. */
 typedef struct _frame_data {
-  GSList      *pfd;          /**< Per frame proto data */
+  proto_data_vec *pfd;       /**< Per frame proto data */
+  gint64       file_off;     /**< File offset */
+  const void *color_filter;  /**< Per-packet matching color_filter_t object */
+  nstime_t     abs_ts;       /**< Absolute timestamp */
   guint32      num;          /**< Frame number */
   guint32      pkt_len;      /**< Packet length */
   guint32      cap_len;      /**< Amount actually captured */
   guint32      cum_bytes;    /**< Cumulative bytes into the capture */
-  gint64       file_off;     /**< File offset */
-  guint16      subnum;       /**< subframe number, for protocols that require this */
-  gint16       lnk_t;        /**< Per-packet encapsulation/data-link type */
+  guint32      frame_ref_num; /**< Previous reference frame (0 if this is one) */
+  guint32      prev_dis_num; /**< Previous displayed frame (0 if first one) */
   struct {
     unsigned int passed_dfilter : 1; /**< 1 = display, 0 = no display */
     unsigned int dependent_of_displayed : 1; /**< 1 if a displayed frame depends on this frame */
@@ -81,14 +92,9 @@ typedef struct _frame_data {
     unsigned int has_phdr_comment : 1; /** 1 = there's comment for this packet */
     unsigned int has_user_comment : 1; /** 1 = user set (also deleted) comment for this packet */
   } flags;
+  guint16      subnum;       /**< subframe number, for protocols that require this */
+  gint16       lnk_t;        /**< Per-packet encapsulation/data-link type */
   gint16       tsprec;       /**< Time stamp precision */
-
-  const void *color_filter;  /**< Per-packet matching color_filter_t object */
-
-  nstime_t     abs_ts;       /**< Absolute timestamp */
-  nstime_t     shift_offset; /**< How much the abs_tm of the frame is shifted */
-  guint32      frame_ref_num; /**< Previous reference frame (0 if this is one) */
-  guint32      prev_dis_num; /**< Previous displayed frame (0 if first one) */
 } frame_data;
 
 /* Utility routines used by packet*.c */
@@ -97,6 +103,13 @@ WS_DLL_PUBLIC void *p_get_proto_data(wmem_allocator_t *scope, struct _packet_inf
 WS_DLL_PUBLIC void p_remove_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, guint32 key);
 gchar *p_get_proto_name_and_key(wmem_allocator_t *scope, struct _packet_info* pinfo, guint pfd_index);
 
+/* Operations on a proto_data_vec, for the conversation and circuit code;
+   "scope" is the allocator the array is (re)allocated from, NULL for glib. */
+void proto_data_vec_add(wmem_allocator_t *scope, proto_data_vec **vecp, int proto, guint32 key, void *proto_data);
+void *proto_data_vec_get(const proto_data_vec *vec, int proto, guint32 key);
+gboolean proto_data_vec_remove(proto_data_vec *vec, int proto, guint32 key);
+guint proto_data_vec_count(const proto_data_vec *vec);
+
 /** compare two frame_datas */
 WS_DLL_PUBLIC gint frame_data_compare(const struct epan_session *epan, const frame_data *fdata1, const frame_data *fdata2, int field);
 
@@ -44,6 +44,8 @@
 struct _frame_data_sequence {
   guint32      count;           /* Total number of frames */
   void        *ptree_root;      /* Pointer to the root node */
+  GArray      *shift_offsets;   /* Time shift offset of each frame, or NULL
+                                   if no frame has been time shifted */
 };
 
 /*
@@ -67,6 +69,7 @@ new_frame_data_sequence(void)
   fds = (frame_data_sequence *)g_malloc(sizeof *fds);
   fds->count = 0;
   fds->ptree_root = NULL;
+  fds->shift_offsets = NULL;
   return fds;
 }
 
@@ -305,10 +308,59 @@ free_frame_data_sequence(frame_data_sequence *fds)
     free_frame_data_array(fds->ptree_root, fds->count, levels, TRUE);
   }
 
+  if (fds->shift_offsets != NULL) {
+    g_array_free(fds->shift_offsets, TRUE);
+  }
+
   /* free the header struct */
   g_free(fds);
 }
 
+/*
+ * Get the amount by which the time stamp of the specified frame has been
+ * shifted.
+ */
+void
+frame_data_sequence_get_shift_offset(frame_data_sequence *fds, guint32 num,
+                                     nstime_t *offset)
+{
+  if (fds->shift_offsets == NULL || num == 0 || num > fds->shift_offsets->len) {
+    /* This frame has never been shifted. */
+    nstime_set_zero(offset);
+    return;
+  }
+  *offset = g_array_index(fds->shift_offsets, nstime_t, num - 1);
+}
+
+/*
+ * Set the amount by which the time stamp of the specified frame has been
+ * shifted.  The offsets are only allocated once a frame is actually
+ * shifted, so captures that are never time shifted don't pay for them.
+ */
+void
+frame_data_sequence_set_shift_offset(frame_data_sequence *fds, guint32 num,
+                                     const nstime_t *offset)
+{
+  if (num == 0 || num > fds->count) {
+    /* There's no such frame. */
+    return;
+  }
+
+  if (fds->shift_offsets == NULL) {
+    if (nstime_is_zero((nstime_t *)offset)) {
+      /* Nothing to remember. */
+      return;
+    }
+    fds->shift_offsets = g_array_sized_new(FALSE, TRUE, sizeof (nstime_t),
+                                           fds->count);
+  }
+  if (num > fds->shift_offsets->len) {
+    /* Frames added since then haven't been shifted. */
+    g_array_set_size(fds->shift_offsets, fds->count);
+  }
+  g_array_index(fds->shift_offsets, nstime_t, num - 1) = *offset;
+}
+
 void
 find_and_mark_frame_depended_upon(gpointer data, gpointer user_data)
 {
@@ -45,6 +45,15 @@ WS_DLL_PUBLIC frame_data *frame_data_sequence_find(frame_data_sequence *fds,
  */
 WS_DLL_PUBLIC void free_frame_data_sequence(frame_data_sequence *fds);
 
+/*
+ * Get and set the amount by which the time stamp of a frame has been
+ * shifted; frames that have never been shifted have an offset of zero.
+ */
+WS_DLL_PUBLIC void frame_data_sequence_get_shift_offset(frame_data_sequence *fds,
+    guint32 num, nstime_t *offset);
+WS_DLL_PUBLIC void frame_data_sequence_set_shift_offset(frame_data_sequence *fds,
+    guint32 num, const nstime_t *offset);
+
 WS_DLL_PUBLIC void find_and_mark_frame_depended_upon(gpointer data, gpointer user_data);
 
 
@@ -30,19 +30,48 @@
 
 #define CMP_MATCHES cmp_matches
 
+/* The value's data belongs to someone else (see fvalue_set_bytes_ref());
+ * only the GByteArray header is ours, and it isn't a real GByteArray that
+ * can be resized */
+#define bytes_are_borrowed	fvalue_gboolean1
+
 static void
 bytes_fvalue_new(fvalue_t *fv)
 {
 	fv->value.bytes = NULL;
+	fv->bytes_are_borrowed = FALSE;
 }
 
 static void
 bytes_fvalue_free(fvalue_t *fv)
 {
 	if (fv->value.bytes) {
-		g_byte_array_free(fv->value.bytes, TRUE);
+		if (fv->bytes_are_borrowed) {
+			g_slice_free(GByteArray, fv->value.bytes);
+		}
+		else {
+			g_byte_array_free(fv->value.bytes, TRUE);
+		}
 		fv->value.bytes=NULL;
 	}
+	fv->bytes_are_borrowed = FALSE;
+}
+
+void
+fvalue_set_bytes_ref(fvalue_t *fv, const guint8 *data, guint len)
+{
+	GByteArray	*bytes;
+
+	g_assert(fv->ftype->free_value == bytes_fvalue_free);
+
+	/* Free up the old value, if we have one */
+	bytes_fvalue_free(fv);
+
+	bytes = g_slice_new(GByteArray);
+	bytes->data = (guint8 *)data;
+	bytes->len = len;
+	fv->value.bytes = bytes;
+	fv->bytes_are_borrowed = TRUE;
 }
 
 
@@ -683,12 +712,18 @@ cmp_matches(const fvalue_t *fv_a, const fvalue_t *fv_b)
 	 * warned us. For the same reason (and because we're using g_malloc()),
 	 * fv_b->value.re is not NULL.
 	 */
-	if (strcmp(fv_b->ftype->name, "FT_PCRE") != 0) {
+	if (fv_b->ftype->ftype != FT_PCRE) {
 		return FALSE;
 	}
 	if (! regex) {
 		return FALSE;
 	}
+	if (fv_b->pcre_is_literal) {
+		const char *pattern = g_regex_get_pattern(regex);
+
+		return epan_memmem(a->data, a->len, (const guint8 *)pattern,
+		    (guint)strlen(pattern)) != NULL;
+	}
 	/*
 	 * XXX - do we want G_REGEX_RAW or not?
 	 *
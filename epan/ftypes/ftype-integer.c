@@ -25,6 +25,7 @@
 #include <errno.h>
 #include "ftypes-int.h"
 #include <epan/addr_resolv.h>
+#include <epan/to_str-int.h>
 
 #include <wsutil/pint.h>
 
@@ -478,7 +479,15 @@ integer64_repr_len(fvalue_t *fv _U_, ftrepr_t rtype _U_, int field_display _U_)
 static void
 integer64_to_repr(fvalue_t *fv, ftrepr_t rtype _U_, int field_display _U_, char *buf)
 {
-	sprintf(buf, "%" G_GINT64_MODIFIER "d", fv->value.integer64);
+	guint64 val;
+
+	if ((gint64)fv->value.integer64 < 0) {
+		*buf++ = '-';
+		val = G_GUINT64_CONSTANT(0) - fv->value.integer64;
+	} else
+		val = fv->value.integer64;
+
+	guint64_to_str_buf(val, buf, 20);
 }
 
 static int
@@ -490,7 +499,7 @@ uinteger64_repr_len(fvalue_t *fv _U_, ftrepr_t rtype _U_, int field_display _U_)
 static void
 uinteger64_to_repr(fvalue_t *fv, ftrepr_t rtype _U_, int field_display _U_, char *buf)
 {
-	sprintf(buf, "%" G_GINT64_MODIFIER "u", fv->value.integer64);
+	guint64_to_str_buf(fv->value.integer64, buf, 21);
 }
 
 static gboolean
@@ -645,9 +654,7 @@ eui64_to_repr(fvalue_t *fv, ftrepr_t rtype _U_, int field_display _U_, char *buf
 	/* Copy and convert the address to network byte order. */
 	*(guint64 *)(void *)(p_eui64) = pntoh64(&(fv->value.integer64));
 
-	g_snprintf(buf, EUI64_STR_LEN, "%.2x:%.2x:%.2x:%.2x:%.2x:%.2x:%.2x:%.2x",
-	p_eui64[0], p_eui64[1], p_eui64[2], p_eui64[3],
-	p_eui64[4], p_eui64[5], p_eui64[6], p_eui64[7] );
+	*bytes_to_hexstr_punct(buf, p_eui64, 8, ':') = '\0';
 }
 
 void
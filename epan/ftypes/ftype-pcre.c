@@ -34,6 +34,7 @@ static void
 gregex_fvalue_new(fvalue_t *fv)
 {
     fv->value.re = NULL;
+    fv->pcre_is_literal = FALSE;
 }
 
 static void
@@ -67,6 +68,22 @@ raw_flag_needed(const gchar *pattern)
     return found;
 }
 
+/* Determines whether pattern matches exactly its own text, i.e. is a
+   non-empty run of printable ASCII without metacharacters */
+static gboolean
+is_literal_pattern(const gchar *pattern)
+{
+    const gchar *s;
+
+    if (*pattern == '\0')
+        return FALSE;
+    for (s = pattern; *s != '\0'; s++) {
+        if (*s < 0x20 || *s > 0x7e || strchr("\\^$.[]|()?*+{}", *s) != NULL)
+            return FALSE;
+    }
+    return TRUE;
+}
+
 /* Generate a FT_PCRE from a parsed string pattern.
  * On failure, if err_msg is non-null, set *err_msg to point to a
  * g_malloc()ed error message. */
@@ -93,6 +110,8 @@ val_from_string(fvalue_t *fv, const char *pattern, gchar **err_msg)
             &regex_error        /* Compile / study errors */
             );
 
+    fv->pcre_is_literal = is_literal_pattern(pattern);
+
     if (regex_error) {
         if (err_msg) {
             *err_msg = g_strdup(regex_error->message);
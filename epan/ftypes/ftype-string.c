@@ -51,6 +51,18 @@ string_fvalue_set_string(fvalue_t *fv, const gchar *value)
 	fv->value.string = (gchar *)g_strdup(value);
 }
 
+void
+fvalue_take_string(fvalue_t *fv, gchar *value)
+{
+	DISSECTOR_ASSERT(value != NULL);
+	g_assert(fv->ftype->free_value == string_fvalue_free);
+
+	/* Free up the old value, if we have one */
+	string_fvalue_free(fv);
+
+	fv->value.string = value;
+}
+
 static int
 string_repr_len(fvalue_t *fv, ftrepr_t rtype, int field_display _U_)
 {
@@ -207,12 +219,15 @@ cmp_matches(const fvalue_t *fv_a, const fvalue_t *fv_b)
 	 * warned us. For the same reason (and because we're using g_malloc()),
 	 * fv_b->value.re is not NULL.
 	 */
-	if (strcmp(fv_b->ftype->name, "FT_PCRE") != 0) {
+	if (fv_b->ftype->ftype != FT_PCRE) {
 		return FALSE;
 	}
 	if (! regex) {
 		return FALSE;
 	}
+	if (fv_b->pcre_is_literal) {
+		return strstr(str, g_regex_get_pattern(regex)) != NULL;
+	}
 	return g_regex_match_full(
 			regex,		/* Compiled PCRE */
 			str,		/* The data to check for the pattern... */
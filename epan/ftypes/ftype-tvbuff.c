@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include <epan/exceptions.h>
+#include <epan/strutil.h>
 
 #define CMP_MATCHES cmp_matches
 
@@ -382,7 +383,7 @@ cmp_matches(const fvalue_t *fv_a, const fvalue_t *fv_b)
 	 * warned us. For the same reason (and because we're using g_malloc()),
 	 * fv_b->value.re is not NULL.
 	 */
-	if (strcmp(fv_b->ftype->name, "FT_PCRE") != 0) {
+	if (fv_b->ftype->ftype != FT_PCRE) {
 		return FALSE;
 	}
 	if (! regex) {
@@ -391,15 +392,22 @@ cmp_matches(const fvalue_t *fv_a, const fvalue_t *fv_b)
 	TRY {
 		tvb_len = tvb_length(tvb);
 		data = (const char *)tvb_get_ptr(tvb, 0, tvb_len);
-		rc = g_regex_match_full(
-			regex,		/* Compiled PCRE */
-			data,		/* The data to check for the pattern... */
-			tvb_len,	/* ... and its length */
-			0,		/* Start offset within data */
-			(GRegexMatchFlags)0,		/* GRegexMatchFlags */
-			NULL,		/* We are not interested in the match information */
-			NULL		/* We don't want error information */
-			);
+		if (fv_b->pcre_is_literal) {
+			const char *pattern = g_regex_get_pattern(regex);
+
+			rc = epan_memmem((const guint8 *)data, tvb_len,
+			    (const guint8 *)pattern, (guint)strlen(pattern)) != NULL;
+		} else {
+			rc = g_regex_match_full(
+				regex,		/* Compiled PCRE */
+				data,		/* The data to check for the pattern... */
+				tvb_len,	/* ... and its length */
+				0,		/* Start offset within data */
+				(GRegexMatchFlags)0,		/* GRegexMatchFlags */
+				NULL,		/* We are not interested in the match information */
+				NULL		/* We don't want error information */
+				);
+		}
 		/* NOTE - DO NOT g_free(data) */
 	}
 	CATCH_ALL {
@@ -45,6 +45,11 @@ void ftype_register_time(void);
 void ftype_register_tvbuff(void);
 void ftype_register_pcre(void);
 
+/* Private flag of a FT_PCRE value: set if its pattern has no regular
+ * expression metacharacters, so that "matches" is a plain search for the
+ * pattern text and the cmp_matches functions can skip GRegex. */
+#define pcre_is_literal fvalue_gboolean1
+
 typedef void (*FvalueNewFunc)(fvalue_t*);
 typedef void (*FvalueFreeFunc)(fvalue_t*);
 
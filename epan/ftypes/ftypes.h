@@ -260,9 +260,20 @@ fvalue_set_guid(fvalue_t *fv, const e_guid_t *value);
 void
 fvalue_set_time(fvalue_t *fv, const nstime_t *value);
 
+/* Have an FT_BYTES-like fvalue point at len bytes at data, rather than
+ * hold a copy of them.  The bytes have to stay where they are for as
+ * long as the fvalue is in use. */
+void
+fvalue_set_bytes_ref(fvalue_t *fv, const guint8 *data, guint len);
+
 void
 fvalue_set_string(fvalue_t *fv, const gchar *value);
 
+/* Like fvalue_set_string(), but the fvalue takes over the g_malloc()ed
+ * value rather than copying it. */
+void
+fvalue_take_string(fvalue_t *fv, gchar *value);
+
 void
 fvalue_set_tvbuff(fvalue_t *fv, tvbuff_t *value);
 
@@ -38,6 +38,7 @@
 #include <GeoIPCity.h>
 
 #include <epan/geoip_db.h>
+#include <epan/packet.h>
 #include <epan/uat.h>
 #include <epan/prefs.h>
 #include <epan/value_string.h>
@@ -93,6 +94,50 @@ static guint num_geoip_db_paths = 0;
 static uat_t *geoip_db_paths_uat = NULL;
 UAT_DIRECTORYNAME_CB_DEF(geoip_mod, path, geoip_db_path_t)
 
+/* Lookup results, so that each address is looked up in each database once.
+ * A NULL value records that the address wasn't found. */
+typedef struct _geoip_cache_key_t {
+    guint  dbnum;
+    guint  addr_len;
+    guint8 addr[16];
+} geoip_cache_key_t;
+
+static GHashTable *geoip_cache = NULL;
+
+static guint
+geoip_cache_hash(gconstpointer k) {
+    const geoip_cache_key_t *key = (const geoip_cache_key_t *)k;
+    guint hash = key->dbnum;
+    guint i;
+
+    for (i = 0; i < key->addr_len; i++) {
+        hash = (hash << 5) - hash + key->addr[i];
+    }
+    return hash;
+}
+
+static gboolean
+geoip_cache_equal(gconstpointer k1, gconstpointer k2) {
+    const geoip_cache_key_t *key1 = (const geoip_cache_key_t *)k1;
+    const geoip_cache_key_t *key2 = (const geoip_cache_key_t *)k2;
+
+    return key1->dbnum == key2->dbnum && key1->addr_len == key2->addr_len &&
+           memcmp(key1->addr, key2->addr, key1->addr_len) == 0;
+}
+
+static void
+geoip_cache_free_val(gpointer val) {
+    wmem_free(NULL, val);
+}
+
+/* Drop the cached results: the databases changed or a new capture starts */
+static void
+geoip_cache_clear(void) {
+    if (geoip_cache) {
+        g_hash_table_remove_all(geoip_cache);
+    }
+}
+
 
 /**
  * Scan a directory for GeoIP databases and load them
@@ -145,6 +190,8 @@ static void geoip_db_post_update_cb(void) {
     /* If we have old data, clear out the whole thing
      * and start again. TODO: Just update the ones that
      * have changed for efficiency's sake. */
+    geoip_cache_clear();
+
     if (geoip_dat_arr) {
         /* skip the last two, as they are fake */
         for (i = 0; i < geoip_db_num_dbs() - 2; i++) {
@@ -226,6 +273,8 @@ geoip_db_pref_init(module_t *nameres)
                 "Wireshark will look in each directory for files beginning\n"
                 "with \"Geo\" and ending with \".dat\".",
             geoip_db_paths_uat);
+
+    register_init_routine(geoip_cache_clear);
 }
 
 guint
@@ -271,6 +320,7 @@ geoip_db_lookup_latlon4(guint32 addr, float *lat, float *lon) {
                     if(gir) {
                         *lat = gir->latitude;
                         *lon = gir->longitude;
+                        GeoIPRecord_delete(gir);
                         return 0;
                     }
                     return -1;
@@ -307,19 +357,14 @@ db_val_to_utf_8(const char *val, GeoIP *gi) {
     return wmem_strdup(NULL, val);
 }
 
-char *
-geoip_db_lookup_ipv4(guint dbnum, guint32 addr, const char *not_found) {
+/* Look up an address in the GeoIP library.  Returns NULL if it isn't found. */
+static char *
+geoip_db_lookup_ipv4_uncached(guint dbnum, guint32 addr) {
     GeoIP *gi;
     GeoIPRecord *gir;
     const char *raw_val;
     char *val, *ret = NULL;
 
-    if (dbnum > geoip_db_num_dbs()) {
-        if (not_found == NULL)
-            return NULL;
-
-        return wmem_strdup(NULL, not_found);
-    }
     gi = g_array_index(geoip_dat_arr, GeoIP *, dbnum);
     if (gi) {
         switch (gi->databaseType) {
@@ -340,6 +385,9 @@ geoip_db_lookup_ipv4(guint dbnum, guint32 addr, const char *not_found) {
                 } else if (gir && gir->city) {
                     ret = db_val_to_utf_8(gir->city, gi);
                 }
+                if (gir) {
+                    GeoIPRecord_delete(gir);
+                }
                 break;
 
             case GEOIP_ORG_EDITION:
@@ -384,13 +432,6 @@ geoip_db_lookup_ipv4(guint dbnum, guint32 addr, const char *not_found) {
         }
     }
 
-    if (ret == NULL) {
-        if (not_found == NULL)
-            return NULL;
-
-        return wmem_strdup(NULL, not_found);
-    }
-
     return ret;
 }
 
@@ -413,6 +454,7 @@ geoip_db_lookup_latlon6(geoipv6_t addr, float *lat, float *lon) {
                     if(gir) {
                         *lat = gir->latitude;
                         *lon = gir->longitude;
+                        GeoIPRecord_delete(gir);
                         return 0;
                     }
                     return -1;
@@ -431,8 +473,8 @@ geoip_db_lookup_latlon6(geoipv6_t addr _U_, float *lat _U_, float *lon _U_) {
 }
 #endif /* NUM_DB_TYPES */
 
-char *
-geoip_db_lookup_ipv6(guint dbnum, struct e_in6_addr addr, const char *not_found) {
+static char *
+geoip_db_lookup_ipv6_uncached(guint dbnum, struct e_in6_addr addr) {
     GeoIP *gi;
     geoipv6_t gaddr;
     const char *raw_val;
@@ -440,12 +482,6 @@ geoip_db_lookup_ipv6(guint dbnum, struct e_in6_addr addr, const char *not_found)
 #if NUM_DB_TYPES > 31
     GeoIPRecord *gir;
 #endif
-    if (dbnum > geoip_db_num_dbs()) {
-        if (not_found == NULL)
-            return NULL;
-
-        return wmem_strdup(NULL, not_found);
-    }
 
     memcpy(&gaddr, &addr, sizeof(addr));
 
@@ -470,6 +506,9 @@ geoip_db_lookup_ipv6(guint dbnum, struct e_in6_addr addr, const char *not_found)
                 } else if (gir && gir->city) {
                     ret = db_val_to_utf_8(gir->city, gi);
                 }
+                if (gir) {
+                    GeoIPRecord_delete(gir);
+                }
                 break;
 
             case GEOIP_ORG_EDITION_V6:
@@ -515,27 +554,74 @@ geoip_db_lookup_ipv6(guint dbnum, struct e_in6_addr addr, const char *not_found)
         }
     }
 
-    if (ret == NULL) {
+    return ret;
+}
+
+#else /* HAVE_GEOIP_V6 */
+
+static char *
+geoip_db_lookup_ipv6_uncached(guint dbnum _U_, struct e_in6_addr addr _U_) {
+    return NULL;
+}
+
+#endif /* HAVE_GEOIP_V6 */
+
+/* Look up an address in the cache, falling back to the GeoIP library */
+static char *
+geoip_db_lookup_cached(guint dbnum, const void *addr, guint addr_len, const char *not_found) {
+    geoip_cache_key_t key;
+    gpointer val;
+
+    if (dbnum > geoip_db_num_dbs()) {
         if (not_found == NULL)
             return NULL;
 
         return wmem_strdup(NULL, not_found);
     }
 
-    return ret;
-}
+    memset(&key, 0, sizeof key);
+    key.dbnum = dbnum;
+    key.addr_len = addr_len;
+    memcpy(key.addr, addr, addr_len);
 
-#else /* HAVE_GEOIP_V6 */
+    if (!geoip_cache) {
+        geoip_cache = g_hash_table_new_full(geoip_cache_hash, geoip_cache_equal, g_free, geoip_cache_free_val);
+    }
 
-char *
-geoip_db_lookup_ipv6(guint dbnum _U_, struct e_in6_addr addr _U_, const char *not_found) {
-    if (not_found == NULL)
-        return NULL;
+    if (!g_hash_table_lookup_extended(geoip_cache, &key, NULL, &val)) {
+        if (addr_len == 4) {
+            guint32 addr4;
+
+            memcpy(&addr4, addr, 4);
+            val = geoip_db_lookup_ipv4_uncached(dbnum, addr4);
+        } else {
+            struct e_in6_addr addr6;
+
+            memcpy(&addr6, addr, sizeof addr6);
+            val = geoip_db_lookup_ipv6_uncached(dbnum, addr6);
+        }
+        g_hash_table_insert(geoip_cache, g_memdup(&key, sizeof key), val);
+    }
+
+    if (val == NULL) {
+        if (not_found == NULL)
+            return NULL;
+
+        return wmem_strdup(NULL, not_found);
+    }
 
-    return wmem_strdup(NULL, not_found);
+    return wmem_strdup(NULL, (const char *)val);
 }
 
-#endif /* HAVE_GEOIP_V6 */
+char *
+geoip_db_lookup_ipv4(guint dbnum, guint32 addr, const char *not_found) {
+    return geoip_db_lookup_cached(dbnum, &addr, 4, not_found);
+}
+
+char *
+geoip_db_lookup_ipv6(guint dbnum, struct e_in6_addr addr, const char *not_found) {
+    return geoip_db_lookup_cached(dbnum, &addr, sizeof addr, not_found);
+}
 
 gchar *
 geoip_db_get_paths(void) {
@@ -36,6 +36,7 @@
 #include "config.h"
 
 #include <glib.h>
+#include <string.h>
 
 #include <epan/tvbuff.h>
 #include <epan/in_cksum.h>
@@ -98,17 +99,31 @@ in_cksum(const vec_t *vec, int veclen)
 			byte_swapped = 1;
 		}
 		/*
-		 * Unroll the loop to make overhead from
-		 * branches &c small.
+		 * Sum big chunks 32 bits at a time into a 64-bit
+		 * accumulator; as 2^16 is 1 in one's complement
+		 * arithmetic, folding that down gives the same result
+		 * as adding up the 16-bit words, in either byte order,
+		 * and the compiler can vectorize the loop.
 		 */
-		while ((mlen -= 32) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
-			sum += w[8]; sum += w[9]; sum += w[10]; sum += w[11];
-			sum += w[12]; sum += w[13]; sum += w[14]; sum += w[15];
-			w += 16;
+		if (mlen >= 32) {
+			guint64 wide = 0;
+			guint32 words[8];
+			int i;
+
+			while ((mlen -= 32) >= 0) {
+				memcpy(words, w, sizeof words);
+				for (i = 0; i < 8; i++)
+					wide += words[i];
+				w += 16;
+			}
+			mlen += 32;
+			wide = (wide >> 32) + (wide & 0xffffffff);
+			wide = (wide >> 32) + (wide & 0xffffffff);
+			wide = (wide >> 16) + (wide & 0xffff);
+			wide = (wide >> 16) + (wide & 0xffff);
+			REDUCE;
+			sum += (int)wide;
 		}
-		mlen += 32;
 		while ((mlen -= 8) >= 0) {
 			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
 			w += 4;
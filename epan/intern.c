@@ -0,0 +1,127 @@
+/* intern.c
+ * A file-scope pool of shared copies of addresses and strings
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "wmem/wmem.h"
+#include "intern.h"
+
+/*
+ * Each interned blob is stored as this header followed by its bytes;
+ * the map's keys point at the headers, and callers get the bytes.
+ */
+typedef struct {
+	gsize         len;
+	const guint8 *data;
+} intern_key_t;
+
+static wmem_map_t *intern_map = NULL;
+
+static guint
+intern_key_hash(gconstpointer k)
+{
+	const intern_key_t *key = (const intern_key_t *)k;
+
+	return wmem_strong_hash(key->data, key->len);
+}
+
+static gboolean
+intern_key_equal(gconstpointer k1, gconstpointer k2)
+{
+	const intern_key_t *key1 = (const intern_key_t *)k1;
+	const intern_key_t *key2 = (const intern_key_t *)k2;
+
+	return key1->len == key2->len &&
+	    memcmp(key1->data, key2->data, key1->len) == 0;
+}
+
+const void *
+intern_bytes(const void *data, gsize len)
+{
+	intern_key_t  lookup_key;
+	intern_key_t *key;
+	guint8       *copy;
+
+	g_assert(intern_map != NULL);
+
+	lookup_key.len = len;
+	lookup_key.data = (const guint8 *)data;
+	key = (intern_key_t *)wmem_map_lookup(intern_map, &lookup_key);
+	if (key != NULL)
+		return key->data;
+
+	/* One allocation for the key and the copy of the data */
+	key = (intern_key_t *)wmem_alloc(wmem_file_scope(), sizeof (intern_key_t) + len);
+	copy = (guint8 *)(key + 1);
+	memcpy(copy, data, len);
+	key->len = len;
+	key->data = copy;
+	wmem_map_insert(intern_map, key, key);
+	return copy;
+}
+
+const gchar *
+intern_string(const gchar *str)
+{
+	if (str == NULL)
+		return NULL;
+
+	return (const gchar *)intern_bytes(str, strlen(str) + 1);
+}
+
+void
+intern_address(address *to, const address *from)
+{
+	copy_address_shallow(to, from);
+	if (from->len > 0)
+		to->data = intern_bytes(from->data, from->len);
+}
+
+void
+intern_init(void)
+{
+	/* The map goes away with the file scope, so make a new one for each file */
+	intern_map = wmem_map_new(wmem_file_scope(), intern_key_hash, intern_key_equal);
+}
+
+void
+intern_cleanup(void)
+{
+	intern_map = NULL;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
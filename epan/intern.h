@@ -0,0 +1,84 @@
+/* intern.h
+ * Definitions for a file-scope pool of shared copies of addresses and
+ * strings
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __INTERN_H__
+#define __INTERN_H__
+
+#include <glib.h>
+
+#include "address.h"
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @file
+ * Interning: one read-only copy, in file scope, of each distinct address
+ * payload or string that's kept for the life of a capture file.  Tables
+ * keyed by addresses and identifiers (conversations, SIP transactions
+ * and the like) keep the same few hosts and IDs over and over; interning
+ * them stores each once, and two interned copies are equal exactly when
+ * their pointers are.
+ *
+ * Interned data is freed when the file scope is, and must never be
+ * modified or freed by the caller.
+ */
+
+/** Return the interned copy of the len bytes at data. */
+WS_DLL_PUBLIC const void *intern_bytes(const void *data, gsize len);
+
+/** Return the interned copy of str, or NULL if str is NULL. */
+WS_DLL_PUBLIC const gchar *intern_string(const gchar *str);
+
+/** Copy an address, pointing the copy at the interned copy of its data.
+ * This is the interning version of WMEM_COPY_ADDRESS() with
+ * wmem_file_scope().
+ *
+ * @param to [in,out] The destination address.
+ * @param from [in] The source address.
+ */
+WS_DLL_PUBLIC void intern_address(address *to, const address *from);
+
+/* For internal use by init_dissection()/cleanup_dissection() */
+extern void intern_init(void);
+extern void intern_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __INTERN_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -42,6 +42,7 @@
 #include <smi.h>
 
 static gboolean oids_init_done = FALSE;
+static gboolean mibs_deferred = FALSE;
 static gboolean load_smi_modules = FALSE;
 static gboolean suppress_smi_errors = FALSE;
 #endif
@@ -521,7 +522,7 @@ static void unregister_mibs(void) {
 }
 
 static void restart_needed_warning(void) {
-	if (oids_init_done)
+	if (oids_init_done || mibs_deferred)
 		report_failure("Wireshark needs to be restarted for these changes to take effect");
 }
 
@@ -744,8 +745,41 @@ static void register_mibs(void) {
 
 	g_array_free(etta,TRUE);
 }
+
+static void register_mibs_prefix(const char* match _U_) {
+	register_mibs();
+}
+
+/* Loading the MIBs takes a while, so put it off until an OID gets looked up
+ * or a display filter names a field of one of the configured modules. */
+static void defer_mibs(void) {
+	guint i;
+
+	if (!load_smi_modules) {
+		D(1,("OID resolution not enabled"));
+		return;
+	}
+
+	if (oids_init_done || mibs_deferred)
+		return;
+
+	mibs_deferred = TRUE;
+
+	for(i=0;i<num_smi_modules;i++) {
+		if (!smi_modules[i].name) continue;
+
+		proto_register_prefix(alnumerize(smi_modules[i].name), register_mibs_prefix);
+	}
+}
 #endif
 
+static void load_deferred_mibs(void) {
+#ifdef HAVE_LIBSMI
+	if (mibs_deferred && !oids_init_done)
+		register_mibs();
+#endif
+}
+
 void oid_pref_init(module_t *nameres)
 {
 #ifdef HAVE_LIBSMI
@@ -842,7 +876,7 @@ void oid_pref_init(module_t *nameres)
 void oids_init(void) {
 	prepopulate_oids();
 #ifdef HAVE_LIBSMI
-	register_mibs();
+	defer_mibs();
 #else
 	D(1,("libsmi disabled oid resolution not enabled"));
 #endif
@@ -1029,6 +1063,8 @@ oid_info_t* oid_get(guint len, guint32* subids, guint* matched, guint* left) {
 	oid_info_t* curr_oid = &oid_root;
 	guint i;
 
+	load_deferred_mibs();
+
 	if(!(subids && *subids <= 2)) {
 		*matched = 0;
 		*left = len;
@@ -33,6 +33,79 @@
 
 #include "packet-range.h"
 
+/* Count the marked frames and the frames in the marked ranges, using
+ * the running totals in the capture_file structure.  Only the frames
+ * between the first and last marked frames have to be looked at. */
+static void packet_range_calc_tally(packet_range_t *range) {
+    capture_file  *cf = range->cf;
+    frame_tally_t *ft = &cf->frame_tally;
+    guint32       framenum;
+    guint32       mark_low;
+    guint32       mark_high;
+    guint32       displayed_mark_low;
+    guint32       displayed_mark_high;
+    frame_data    *packet;
+
+    range->selected_packet               = cf->current_frame ? cf->current_frame->num : 0;
+    range->ignored_cnt                   = cf->ignored_count;
+    range->ignored_marked_cnt            = ft->ignored_marked_count;
+    range->displayed_cnt                 = ft->displayed_count;
+    range->displayed_plus_dependents_cnt = ft->displayed_plus_dependents_count;
+    range->displayed_marked_cnt          = ft->displayed_marked_count;
+    range->displayed_ignored_cnt         = ft->displayed_ignored_count;
+    range->displayed_ignored_marked_cnt  = ft->displayed_ignored_marked_count;
+
+    if (cf->marked_count == 0 || ft->first_marked == 0)
+        return;
+
+    /* first_marked and last_marked may be further apart than the marked
+     * frames are, if a frame at one end has been unmarked. */
+    mark_low            = 0;
+    mark_high           = 0;
+    displayed_mark_low  = 0;
+    displayed_mark_high = 0;
+    for(framenum = ft->first_marked; framenum <= ft->last_marked; framenum++) {
+        packet = frame_data_sequence_find(cf->frames, framenum);
+
+        if (packet->flags.marked) {
+            if (mark_low == 0) {
+               mark_low = framenum;
+            }
+            mark_high = framenum;
+            if (packet->flags.passed_dfilter) {
+                if (displayed_mark_low == 0) {
+                   displayed_mark_low = framenum;
+                }
+                displayed_mark_high = framenum;
+            }
+        }
+    }
+
+    /* Now that we know, save the next dialog the trouble. */
+    ft->first_marked = mark_low;
+    ft->last_marked  = mark_high;
+
+    for(framenum = mark_low; framenum != 0 && framenum <= mark_high; framenum++) {
+        packet = frame_data_sequence_find(cf->frames, framenum);
+
+        range->mark_range_cnt++;
+        if (packet->flags.ignored) {
+            range->ignored_mark_range_cnt++;
+        }
+
+        if (framenum >= displayed_mark_low &&
+            framenum <= displayed_mark_high)
+        {
+            if (packet->flags.passed_dfilter) {
+                range->displayed_mark_range_cnt++;
+                if (packet->flags.ignored) {
+                    range->displayed_ignored_mark_range_cnt++;
+                }
+            }
+        }
+    }
+}
+
 /* (re-)calculate the packet counts (except the user specified range) */
 static void packet_range_calc(packet_range_t *range) {
     guint32       framenum;
@@ -72,13 +145,13 @@ static void packet_range_calc(packet_range_t *range) {
      * for example, the case when TShark is doing a one-pass
      * read of a file or a live capture.
      *
-     * It's also horribly slow on large captures, causing it to
-     * take a long time for the Save As dialog to pop up, for
-     * example.  We should really keep these statistics in
-     * the capture_file structure, updating them whenever we
-     * filter the display, etc..
+     * Wireshark keeps running totals in the capture_file structure;
+     * if they're up to date, use them rather than looking at every
+     * frame, which is horribly slow on large captures.
      */
-    if (range->cf->frames != NULL) {
+    if (range->cf->frames != NULL && range->cf->frame_tally.valid) {
+        packet_range_calc_tally(range);
+    } else if (range->cf->frames != NULL) {
         /* The next for-loop is used to obtain the amount of packets
          * to be processed and is used to present the information in
          * the Save/Print As widget.
@@ -49,10 +49,14 @@
 #include "wmem/wmem.h"
 
 #include <epan/exceptions.h>
+#include <epan/conversation.h>
+#include <epan/intern.h>
 #include <epan/reassemble.h>
 #include <epan/stream.h>
 #include <epan/expert.h>
 #include <epan/range.h>
+#include <epan/prefs.h>
+#include <epan/dissector_profile.h>
 
 static gint proto_malformed = -1;
 static dissector_handle_t frame_handle = NULL;
@@ -79,7 +83,12 @@ struct data_source {
  * used in that table; not all of them are necessarily in the table,
  * as they may be for protocols that don't have a fixed uint value,
  * e.g. for TCP or UDP port number tables and protocols with no fixed
- * port number.
+ * port number.  It's kept sorted by protocol filter name for the UI, but
+ * since hundreds of handles are added to some tables at startup, it's only
+ * sorted when it's asked for; "dissector_handles_sorted" says whether it
+ * needs sorting, and "dissector_handle_set" holds the same handles, so
+ * that checking whether a handle is already in the list doesn't require
+ * walking it.
  *
  * "ui_name" is the name the dissector table has in the user interface.
  *
@@ -89,15 +98,49 @@ struct data_source {
  * "param" is the base in which to display the uint value for that
  * dissector table, if it's a uint dissector table, or if it's a string
  * table, TRUE/FALSE to indicate case-insensitive or not.
+ *
+ * "uint_index", if not NULL, is an array of "uint_index_size" entries,
+ * indexed by uint value, holding the same entries as "hash_table", so
+ * that a lookup is a single load.  FT_UINT8 tables always have one;
+ * FT_UINT16 tables, such as the port tables, get one once they have
+ * DTBL_INDEX_MIN_ENTRIES entries.  "uint_index_sparse" is set if a value
+ * too big for the array has been added, in which case there's no array.
  */
 struct dissector_table {
 	GHashTable	*hash_table;
 	GSList		*dissector_handles;
+	gboolean	dissector_handles_sorted;
+	GHashTable	*dissector_handle_set;
 	const char	*ui_name;
 	ftenum_t	type;
 	int		param;
+	struct dtbl_entry **uint_index;
+	guint32		uint_index_size;
+	gboolean	uint_index_sparse;
+	guint8		*lookup_bits;	/* uint patterns below DTBL_LOOKUP_BITS looked up */
+	GHashTable	*lookups;	/* other patterns looked up */
 };
 
+#define DTBL_INDEX_MIN_ENTRIES	16
+
+/*
+ * Which patterns of each table have been looked up since dissection was
+ * last (re)started, and whether an entry for one of them has been
+ * changed since.  If none has, the packets would be dissected the same
+ * way again.
+ */
+#define DTBL_LOOKUP_BITS	65536
+
+static gboolean dtbl_lookups_changed = FALSE;
+
+/*
+ * Bumped whenever an entry in a uint dissector table is added, removed
+ * or changed.
+ */
+static guint32 dtbl_uint_generation = 0;
+
+static void dtbl_forget_lookups(gpointer key, gpointer value, gpointer user_data);
+
 static GHashTable *dissector_tables = NULL;
 
 /*
@@ -107,11 +150,37 @@ static GHashTable *registered_dissectors = NULL;
 
 /*
  * A heuristics dissector list.
+ *
+ * "dispatch" is built from "dissectors" the first time the list is tried
+ * after it has changed.  dispatch[256] holds every entry, in list order;
+ * if any entry has a pre-check with magic at offset 0, dispatch[b] holds
+ * just the entries that can accept a tvb whose first byte is b, otherwise
+ * it's NULL.  Each array is NULL-terminated.
+ *
+ * "conv_matches" maps a conversation to the entries that have accepted
+ * its packets, newest first, so that the one that accepted the last
+ * packet can be tried before any other.  It's allocated in file scope
+ * and is reset by init_dissection().
  */
 struct heur_dissector_list {
 	GSList		*dissectors;
+	gboolean	dispatch_valid;
+	heur_dtbl_entry_t **dispatch[257];
+	wmem_map_t	*conv_matches;
 };
 
+/*
+ * An entry that accepted a packet of a conversation.  It's used for the
+ * frames after first_frame, up to and including last_frame, the frame it
+ * rejected, if it has rejected one.
+ */
+typedef struct heur_conv_match {
+	heur_dtbl_entry_t      *entry;
+	guint32                 first_frame;
+	guint32                 last_frame;	/* 0 if it's still in use */
+	struct heur_conv_match *prev;		/* the one used before it */
+} heur_conv_match_t;
+
 static GHashTable *heur_dissector_lists = NULL;
 
 static void
@@ -121,14 +190,33 @@ destroy_heuristic_dissector_entry(gpointer data, gpointer user_data _U_)
 	g_slice_free(heur_dtbl_entry_t, data);
 }
 
+static void
+heur_dissector_list_invalidate(heur_dissector_list_t sub_dissectors)
+{
+	int i;
+
+	for (i = 0; i < 257; i++) {
+		g_free(sub_dissectors->dispatch[i]);
+		sub_dissectors->dispatch[i] = NULL;
+	}
+	sub_dissectors->dispatch_valid = FALSE;
+}
+
 static void
 destroy_heuristic_dissector_list(void *data)
 {
-	GSList **list = (GSList**)data;
+	heur_dissector_list_t sub_dissectors = (heur_dissector_list_t)data;
 
-	g_slist_foreach(*list, destroy_heuristic_dissector_entry, NULL);
-	g_slist_free(*list);
-	*list = NULL;
+	g_slist_foreach(sub_dissectors->dissectors, destroy_heuristic_dissector_entry, NULL);
+	g_slist_free(sub_dissectors->dissectors);
+	sub_dissectors->dissectors = NULL;
+	heur_dissector_list_invalidate(sub_dissectors);
+}
+
+static void
+reset_heuristic_dissector_list(gpointer key _U_, gpointer value, gpointer user_data _U_)
+{
+	((heur_dissector_list_t)value)->conv_matches = NULL;
 }
 
 static void
@@ -137,7 +225,10 @@ destroy_dissector_table(void *data)
 	struct dissector_table *table = (struct dissector_table *)data;
 
 	g_hash_table_destroy(table->hash_table);
+	g_free(table->uint_index);
 	g_slist_free(table->dissector_handles);
+	g_hash_table_destroy(table->dissector_handle_set);
+	dtbl_forget_lookups(NULL, table, NULL);
 	g_slice_free(struct dissector_table, data);
 }
 
@@ -226,17 +317,37 @@ call_init_routine(gpointer routine, gpointer dummy _U_)
  * We should probably split that into "init" and "cleanup" routines, for
  * cleanliness' sake.
  */
+/* Set by set_memory_accounting() */
+static gboolean memory_accounting_wanted = FALSE;
+
+void
+set_memory_accounting(gboolean enable)
+{
+	memory_accounting_wanted = enable;
+}
+
 void
 init_dissection(void)
 {
 	wmem_enter_file_scope();
 
+	/* Count file-scope memory per protocol if anybody wants to know */
+	wmem_accounting_enable(wmem_file_scope(),
+	    prefs.memory_accounting || memory_accounting_wanted);
+
+	/* Dissector timings are per file as well */
+	dissector_profile_reset();
+
 	/*
 	 * Reinitialize resolution information. We do initialization here in
 	 * case we need to resolve between captures.
 	 */
 	host_name_lookup_init();
 
+	/* Start a new pool of interned addresses and strings; the old one
+	 * went away with the old file scope. */
+	intern_init();
+
 	/* Initialize the table of conversations. */
 	epan_conversation_init();
 
@@ -246,6 +357,13 @@ init_dissection(void)
 	/* Initialize protocol-specific variables. */
 	g_slist_foreach(init_routines, &call_init_routine, NULL);
 
+	/* Forget which heuristics matched in the previous file */
+	g_hash_table_foreach(heur_dissector_lists, reset_heuristic_dissector_list, NULL);
+
+	/* ...and which dissector table entries were looked up */
+	g_hash_table_foreach(dissector_tables, dtbl_forget_lookups, NULL);
+	dtbl_lookups_changed = FALSE;
+
 	/* Initialize the stream-handling tables */
 	stream_init();
 
@@ -274,6 +392,8 @@ cleanup_dissection(void)
 	/* Initialize the expert infos */
 	expert_packet_cleanup();
 
+	intern_cleanup();
+
 	wmem_leave_file_scope();
 
 	/*
@@ -488,6 +608,11 @@ dissect_record(epan_dissect_t *edt, int file_type_subtype,
 
 	EP_CHECK_CANARY(("before dissecting record %d",fd->num));
 
+	/* Don't charge this record to whatever protocol an exception
+	 * left as the owner last time */
+	if (wmem_accounting_is_active())
+		wmem_accounting_set_owner(WMEM_NO_OWNER);
+
 	TRY {
 		/* Add this tvbuffer into the data_src list */
 		add_new_data_source(&edt->pi, edt->tvb, record_type);
@@ -508,6 +633,10 @@ dissect_record(epan_dissect_t *edt, int file_type_subtype,
 	}
 	ENDTRY;
 
+	/* Close the timings of dissectors an exception got us out of */
+	if (dissector_profiling_is_active())
+		dissector_profile_unwind();
+
 	EP_CHECK_CANARY(("after dissecting record %d",fd->num));
 
 	fd->flags.visited = 1;
@@ -577,6 +706,9 @@ dissect_file(epan_dissect_t *edt, struct wtap_pkthdr *phdr,
 	}
 	ENDTRY;
 
+	if (dissector_profiling_is_active())
+		dissector_profile_unwind();
+
 	EP_CHECK_CANARY(("after dissecting file %d",fd->num));
 
 	fd->flags.visited = 1;
@@ -597,6 +729,37 @@ struct dissector_handle {
 	protocol_t	*protocol;
 };
 
+/* Call the dissector of a handle, and return what
+ * call_dissector_through_handle() does.
+ */
+static int
+call_dissector_function(dissector_handle_t handle, tvbuff_t *tvb,
+			packet_info *pinfo, proto_tree *tree, void *data)
+{
+	int len;
+
+	if (handle->is_new) {
+		EP_CHECK_CANARY(("before calling handle->dissector.new_d for %s",handle->name));
+		len = (*handle->dissector.new_d)(tvb, pinfo, tree, data);
+		EP_CHECK_CANARY(("after calling handle->dissector.new_d for %s",handle->name));
+	} else {
+		EP_CHECK_CANARY(("before calling handle->dissector.old for %s",handle->name));
+		(*handle->dissector.old)(tvb, pinfo, tree);
+		EP_CHECK_CANARY(("after calling handle->dissector.old for %s",handle->name));
+		len = tvb_length(tvb);
+		if (len == 0) {
+			/*
+			 * XXX - a tvbuff can have 0 bytes of data in
+			 * it, so we have to make sure we don't return
+			 * 0.
+			 */
+			len = 1;
+		}
+	}
+
+	return len;
+}
+
 /* This function will return
  * old style dissector :
  *   length of the payload or 1 of the payload is empty
@@ -613,33 +776,44 @@ call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 {
 	const char *saved_proto;
 	int         len;
+	int         saved_owner = WMEM_NO_OWNER;
+	gboolean    accounting = FALSE;
+	int         profile_frame = -1;
 
 	saved_proto = pinfo->current_proto;
 
 	if (handle->protocol != NULL) {
 		pinfo->current_proto =
 			proto_get_protocol_short_name(handle->protocol);
+
+		/* Charge what the dissector allocates to its protocol */
+		if (wmem_accounting_is_active()) {
+			accounting = TRUE;
+			saved_owner = wmem_accounting_set_owner(proto_get_id(handle->protocol));
+		}
+
+		if (dissector_profiling_is_active())
+			profile_frame = dissector_profile_enter(proto_get_id(handle->protocol));
 	}
 
-	if (handle->is_new) {
-		EP_CHECK_CANARY(("before calling handle->dissector.new_d for %s",handle->name));
-		len = (*handle->dissector.new_d)(tvb, pinfo, tree, data);
-		EP_CHECK_CANARY(("after calling handle->dissector.new_d for %s",handle->name));
-	} else {
-		EP_CHECK_CANARY(("before calling handle->dissector.old for %s",handle->name));
-		(*handle->dissector.old)(tvb, pinfo, tree);
-		EP_CHECK_CANARY(("after calling handle->dissector.old for %s",handle->name));
-		len = tvb_length(tvb);
-		if (len == 0) {
-			/*
-			 * XXX - a tvbuff can have 0 bytes of data in
-			 * it, so we have to make sure we don't return
-			 * 0.
-			 */
-			len = 1;
+	if (accounting) {
+		/* Give the owner back even if the dissector throws, or
+		 * whatever our caller allocates next is charged to this
+		 * protocol */
+		TRY {
+			len = call_dissector_function(handle, tvb, pinfo, tree, data);
 		}
+		FINALLY {
+			wmem_accounting_set_owner(saved_owner);
+		}
+		ENDTRY;
+	} else {
+		len = call_dissector_function(handle, tvb, pinfo, tree, data);
 	}
 
+	if (profile_frame >= 0)
+		dissector_profile_leave(profile_frame, len == 0);
+
 	pinfo->current_proto = saved_proto;
 
 	return len;
@@ -658,6 +832,31 @@ static int
 call_dissector_work_error(dissector_handle_t handle, tvbuff_t *tvb,
 			  packet_info *pinfo_arg, proto_tree *tree, void *);
 
+/*
+ * Has every protocol in pinfo->cutoff_protos already been dissected,
+ * so that protocol proto_id, which isn't one of them, has nothing to
+ * add that anybody wants?
+ */
+static gboolean
+dissection_cutoff_reached(packet_info *pinfo, int proto_id)
+{
+	const int         *protop;
+	wmem_list_frame_t *layer;
+
+	for (protop = pinfo->cutoff_protos; *protop != -1; protop++) {
+		if (*protop == proto_id)
+			return FALSE;
+		for (layer = wmem_list_head(pinfo->layers); layer != NULL;
+		    layer = wmem_list_frame_next(layer)) {
+			if (GPOINTER_TO_INT(wmem_list_frame_data(layer)) == *protop)
+				break;
+		}
+		if (layer == NULL)
+			return FALSE;
+	}
+	return TRUE;
+}
+
 static int
 call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo_arg,
 		    proto_tree *tree, gboolean add_proto_name, void *data)
@@ -676,6 +875,16 @@ call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo
 		return 0;
 	}
 
+	if (pinfo->cutoff_protos != NULL && handle->protocol != NULL &&
+	    dissection_cutoff_reached(pinfo, proto_get_id(handle->protocol))) {
+		/*
+		 * We've been asked to stop here; claim the data, so
+		 * that nobody tries to hand it to another dissector.
+		 */
+		len = tvb_captured_length(tvb);
+		return len > 0 ? len : 1;
+	}
+
 	saved_proto = pinfo->current_proto;
 	saved_can_desegment = pinfo->can_desegment;
 	saved_layers_len = wmem_list_count(pinfo->layers);
@@ -853,10 +1062,195 @@ find_dissector_table(const char *name)
 	return (dissector_table_t)g_hash_table_lookup( dissector_tables, name );
 }
 
+static void
+dtbl_index_fill(gpointer key, gpointer value, gpointer user_data)
+{
+	dissector_table_t sub_dissectors = (dissector_table_t)user_data;
+
+	sub_dissectors->uint_index[GPOINTER_TO_UINT(key)] = (dtbl_entry_t *)value;
+}
+
+/*
+ * (Re)build a uint dissector table's array from its hash table, if it's
+ * worth having one.
+ */
+static void
+dtbl_index_rebuild(dissector_table_t sub_dissectors)
+{
+	guint32 size;
+
+	g_free(sub_dissectors->uint_index);
+	sub_dissectors->uint_index = NULL;
+
+	switch (sub_dissectors->type) {
+
+	case FT_UINT8:
+		size = 256;
+		break;
+
+	case FT_UINT16:
+		if (g_hash_table_size(sub_dissectors->hash_table) < DTBL_INDEX_MIN_ENTRIES)
+			return;
+		size = 65536;
+		break;
+
+	default:
+		return;
+	}
+	if (sub_dissectors->uint_index_sparse)
+		return;
+
+	sub_dissectors->uint_index = g_new0(dtbl_entry_t *, size);
+	sub_dissectors->uint_index_size = size;
+	g_hash_table_foreach(sub_dissectors->hash_table, dtbl_index_fill, sub_dissectors);
+}
+
+/* Add an entry to a uint dissector table's hash table and array. */
+static void
+dtbl_insert_uint(dissector_table_t sub_dissectors, const guint32 pattern, dtbl_entry_t *dtbl_entry)
+{
+	dtbl_uint_generation++;
+	g_hash_table_insert( sub_dissectors->hash_table,
+			     GUINT_TO_POINTER( pattern), (gpointer)dtbl_entry);
+
+	if ((sub_dissectors->type == FT_UINT8 && pattern > 0xFF) ||
+	    (sub_dissectors->type == FT_UINT16 && pattern > 0xFFFF)) {
+		/* Not dense after all */
+		sub_dissectors->uint_index_sparse = TRUE;
+		g_free(sub_dissectors->uint_index);
+		sub_dissectors->uint_index = NULL;
+	} else if (sub_dissectors->uint_index != NULL) {
+		sub_dissectors->uint_index[pattern] = dtbl_entry;
+	} else if (sub_dissectors->type == FT_UINT16 && !sub_dissectors->uint_index_sparse &&
+		   g_hash_table_size(sub_dissectors->hash_table) >= DTBL_INDEX_MIN_ENTRIES) {
+		dtbl_index_rebuild(sub_dissectors);
+	}
+}
+
+/* Remove an entry from a uint dissector table's hash table and array. */
+static void
+dtbl_remove_uint(dissector_table_t sub_dissectors, const guint32 pattern)
+{
+	dtbl_uint_generation++;
+	if (sub_dissectors->uint_index != NULL)
+		sub_dissectors->uint_index[pattern] = NULL;
+	g_hash_table_remove(sub_dissectors->hash_table,
+			    GUINT_TO_POINTER(pattern));
+}
+
+/* Remember that a packet looked up a pattern in a uint dissector table */
+static inline void
+dtbl_note_uint_lookup(dissector_table_t sub_dissectors, const guint32 pattern)
+{
+	if (pattern < DTBL_LOOKUP_BITS) {
+		if (G_UNLIKELY(sub_dissectors->lookup_bits == NULL))
+			sub_dissectors->lookup_bits = (guint8 *)g_malloc0(DTBL_LOOKUP_BITS / 8);
+		sub_dissectors->lookup_bits[pattern >> 3] |= 1 << (pattern & 7);
+		return;
+	}
+
+	if (sub_dissectors->lookups == NULL)
+		sub_dissectors->lookups = g_hash_table_new(g_direct_hash, g_direct_equal);
+	g_hash_table_insert(sub_dissectors->lookups, GUINT_TO_POINTER(pattern),
+			    GUINT_TO_POINTER(pattern));
+}
+
+static gboolean
+dtbl_uint_looked_up(dissector_table_t sub_dissectors, const guint32 pattern)
+{
+	if (pattern < DTBL_LOOKUP_BITS)
+		return sub_dissectors->lookup_bits != NULL &&
+		    (sub_dissectors->lookup_bits[pattern >> 3] & (1 << (pattern & 7)));
+
+	return sub_dissectors->lookups != NULL &&
+	    g_hash_table_lookup_extended(sub_dissectors->lookups,
+					 GUINT_TO_POINTER(pattern), NULL, NULL);
+}
+
+/* Remember that a packet looked up a pattern in a string dissector table */
+static void
+dtbl_note_string_lookup(dissector_table_t sub_dissectors, const gchar *pattern)
+{
+	char *key;
+
+	if (sub_dissectors->lookups == NULL)
+		sub_dissectors->lookups = g_hash_table_new_full(g_str_hash,
+		    g_str_equal, g_free, NULL);
+
+	if (sub_dissectors->param == TRUE) {
+		key = g_ascii_strdown(pattern, -1);
+	} else {
+		if (g_hash_table_lookup_extended(sub_dissectors->lookups,
+						 pattern, NULL, NULL))
+			return;
+		key = g_strdup(pattern);
+	}
+	g_hash_table_replace(sub_dissectors->lookups, key, key);
+}
+
+static gboolean
+dtbl_string_looked_up(dissector_table_t sub_dissectors, const gchar *pattern)
+{
+	char     *key;
+	gboolean  ret;
+
+	if (sub_dissectors->lookups == NULL)
+		return FALSE;
+
+	if (sub_dissectors->param == TRUE) {
+		key = g_ascii_strdown(pattern, -1);
+	} else {
+		key = g_strdup(pattern);
+	}
+	ret = g_hash_table_lookup_extended(sub_dissectors->lookups, key,
+					   NULL, NULL);
+	g_free(key);
+
+	return ret;
+}
+
+static void
+dtbl_forget_lookups(gpointer key _U_, gpointer value, gpointer user_data _U_)
+{
+	dissector_table_t sub_dissectors = (dissector_table_t)value;
+
+	g_free(sub_dissectors->lookup_bits);
+	sub_dissectors->lookup_bits = NULL;
+	if (sub_dissectors->lookups != NULL) {
+		g_hash_table_destroy(sub_dissectors->lookups);
+		sub_dissectors->lookups = NULL;
+	}
+}
+
+guint32
+dissector_table_uint_generation(void)
+{
+	return dtbl_uint_generation;
+}
+
+gboolean
+dissector_table_lookups_changed(void)
+{
+	gboolean changed = dtbl_lookups_changed;
+
+	dtbl_lookups_changed = FALSE;
+	return changed;
+}
+
 /* Find an entry in a uint dissector table. */
 static dtbl_entry_t *
 find_uint_dtbl_entry(dissector_table_t sub_dissectors, const guint32 pattern)
 {
+	/*
+	 * If the table has an array, nothing has been added that's
+	 * outside it.
+	 */
+	if (sub_dissectors->uint_index != NULL) {
+		if (pattern >= sub_dissectors->uint_index_size)
+			return NULL;
+		return sub_dissectors->uint_index[pattern];
+	}
+
 	switch (sub_dissectors->type) {
 
 	case FT_UINT8:
@@ -955,8 +1349,7 @@ dissector_add_uint(const char *name, const guint32 pattern, dissector_handle_t h
 	dtbl_entry->initial = dtbl_entry->current;
 
 	/* do the table insertion */
-	g_hash_table_insert( sub_dissectors->hash_table,
-			     GUINT_TO_POINTER( pattern), (gpointer)dtbl_entry);
+	dtbl_insert_uint(sub_dissectors, pattern, dtbl_entry);
 
 	/*
 	 * Now add it to the list of handles that could be used for
@@ -1008,8 +1401,7 @@ dissector_delete_uint(const char *name, const guint32 pattern,
 		/*
 		 * Found - remove it.
 		 */
-		g_hash_table_remove(sub_dissectors->hash_table,
-				    GUINT_TO_POINTER(pattern));
+		dtbl_remove_uint(sub_dissectors, pattern);
 	}
 }
 
@@ -1041,7 +1433,10 @@ void dissector_delete_all(const char *name, dissector_handle_t handle)
 	dissector_table_t sub_dissectors = find_dissector_table(name);
 	g_assert (sub_dissectors);
 
+	dtbl_uint_generation++;
 	g_hash_table_foreach_remove (sub_dissectors->hash_table, dissector_delete_all_check, handle);
+	if (sub_dissectors->uint_index != NULL)
+		dtbl_index_rebuild(sub_dissectors);
 }
 
 /* Change the entry for a dissector in a uint dissector table
@@ -1059,8 +1454,12 @@ dissector_change_uint(const char *name, const guint32 pattern, dissector_handle_
 	 * See if the entry already exists. If so, reuse it.
 	 */
 	dtbl_entry = find_uint_dtbl_entry(sub_dissectors, pattern);
+	if ((dtbl_entry != NULL ? dtbl_entry->current : NULL) != handle &&
+	    dtbl_uint_looked_up(sub_dissectors, pattern))
+		dtbl_lookups_changed = TRUE;
 	if (dtbl_entry != NULL) {
 		dtbl_entry->current = handle;
+		dtbl_uint_generation++;
 		return;
 	}
 
@@ -1077,8 +1476,7 @@ dissector_change_uint(const char *name, const guint32 pattern, dissector_handle_
 	dtbl_entry->current = handle;
 
 	/* do the table insertion */
-	g_hash_table_insert( sub_dissectors->hash_table,
-			     GUINT_TO_POINTER( pattern), (gpointer)dtbl_entry);
+	dtbl_insert_uint(sub_dissectors, pattern, dtbl_entry);
 }
 
 /* Reset an entry in a uint dissector table to its initial value. */
@@ -1099,14 +1497,18 @@ dissector_reset_uint(const char *name, const guint32 pattern)
 	if (dtbl_entry == NULL)
 		return;
 
+	if (dtbl_entry->current != dtbl_entry->initial &&
+	    dtbl_uint_looked_up(sub_dissectors, pattern))
+		dtbl_lookups_changed = TRUE;
+
 	/*
 	 * Found - is there an initial value?
 	 */
 	if (dtbl_entry->initial != NULL) {
 		dtbl_entry->current = dtbl_entry->initial;
+		dtbl_uint_generation++;
 	} else {
-		g_hash_table_remove(sub_dissectors->hash_table,
-				    GUINT_TO_POINTER(pattern));
+		dtbl_remove_uint(sub_dissectors, pattern);
 	}
 }
 
@@ -1124,6 +1526,7 @@ dissector_try_uint_new(dissector_table_t sub_dissectors, const guint32 uint_val,
 	guint32                  saved_match_uint;
 	int len;
 
+	dtbl_note_uint_lookup(sub_dissectors, uint_val);
 	dtbl_entry = find_uint_dtbl_entry(sub_dissectors, uint_val);
 	if (dtbl_entry != NULL) {
 		/*
@@ -1182,6 +1585,7 @@ dissector_get_uint_handle(dissector_table_t const sub_dissectors, const guint32
 {
 	dtbl_entry_t *dtbl_entry;
 
+	dtbl_note_uint_lookup(sub_dissectors, uint_val);
 	dtbl_entry = find_uint_dtbl_entry(sub_dissectors, uint_val);
 	if (dtbl_entry != NULL)
 		return dtbl_entry->current;
@@ -1355,6 +1759,9 @@ dissector_change_string(const char *name, const gchar *pattern,
 	 * See if the entry already exists. If so, reuse it.
 	 */
 	dtbl_entry = find_string_dtbl_entry(sub_dissectors, pattern);
+	if ((dtbl_entry != NULL ? dtbl_entry->current : NULL) != handle &&
+	    dtbl_string_looked_up(sub_dissectors, pattern))
+		dtbl_lookups_changed = TRUE;
 	if (dtbl_entry != NULL) {
 		dtbl_entry->current = handle;
 		return;
@@ -1395,6 +1802,10 @@ dissector_reset_string(const char *name, const gchar *pattern)
 	if (dtbl_entry == NULL)
 		return;
 
+	if (dtbl_entry->current != dtbl_entry->initial &&
+	    dtbl_string_looked_up(sub_dissectors, pattern))
+		dtbl_lookups_changed = TRUE;
+
 	/*
 	 * Found - is there an initial value?
 	 */
@@ -1419,6 +1830,7 @@ dissector_try_string(dissector_table_t sub_dissectors, const gchar *string,
 
 	/* XXX ASSERT instead ? */
 	if (!string) return 0;
+	dtbl_note_string_lookup(sub_dissectors, string);
 	dtbl_entry = find_string_dtbl_entry(sub_dissectors, string);
 	if (dtbl_entry != NULL) {
 		/*
@@ -1470,6 +1882,7 @@ dissector_get_string_handle(dissector_table_t sub_dissectors,
 {
 	dtbl_entry_t *dtbl_entry;
 
+	dtbl_note_string_lookup(sub_dissectors, string);
 	dtbl_entry = find_string_dtbl_entry(sub_dissectors, string);
 	if (dtbl_entry != NULL)
 		return dtbl_entry->current;
@@ -1524,7 +1937,6 @@ void
 dissector_add_for_decode_as(const char *name, dissector_handle_t handle)
 {
 	dissector_table_t  sub_dissectors = find_dissector_table( name);
-	GSList            *entry;
 
 	/*
 	 * Make sure the dissector table exists.
@@ -1540,17 +1952,33 @@ dissector_add_for_decode_as(const char *name, dissector_handle_t handle)
 	}
 
 	/* Is it already in this list? */
-	entry = g_slist_find(sub_dissectors->dissector_handles, (gpointer)handle);
-	if (entry != NULL) {
+	if (g_hash_table_lookup(sub_dissectors->dissector_handle_set, handle) != NULL) {
 		/*
 		 * Yes - don't insert it again.
 		 */
 		return;
 	}
 
-	/* Add it to the list. */
+	/* Add it to the list; it's sorted when it's next asked for. */
+	g_hash_table_insert(sub_dissectors->dissector_handle_set, handle, handle);
+	sub_dissectors->dissector_handles =
+		g_slist_prepend(sub_dissectors->dissector_handles, (gpointer)handle);
+	sub_dissectors->dissector_handles_sorted = FALSE;
+}
+
+/* Sort a table's list of handles by filter name, if it isn't already. */
+static void
+dissector_table_sort_handles(dissector_table_t sub_dissectors)
+{
+	if (sub_dissectors->dissector_handles_sorted)
+		return;
+
+	/* g_slist_sort() is stable, so handles with the same filter
+	   name stay most recently added first, as they would have
+	   been with g_slist_insert_sorted() */
 	sub_dissectors->dissector_handles =
-		g_slist_insert_sorted(sub_dissectors->dissector_handles, (gpointer)handle, (GCompareFunc)dissector_compare_filter_name);
+		g_slist_sort(sub_dissectors->dissector_handles, (GCompareFunc)dissector_compare_filter_name);
+	sub_dissectors->dissector_handles_sorted = TRUE;
 }
 
 dissector_handle_t
@@ -1562,6 +1990,7 @@ dtbl_entry_get_initial_handle (dtbl_entry_t *dtbl_entry)
 GSList *
 dissector_table_get_dissector_handles(dissector_table_t dissector_table) {
 	if (!dissector_table) return NULL;
+	dissector_table_sort_handles(dissector_table);
 	return dissector_table->dissector_handles;
 }
 
@@ -1681,6 +2110,7 @@ dissector_table_foreach_handle(const char     *table_name,
 	dissector_table_t sub_dissectors = find_dissector_table(table_name);
 	GSList *tmp;
 
+	dissector_table_sort_handles(sub_dissectors);
 	for (tmp = sub_dissectors->dissector_handles; tmp != NULL;
 	     tmp = g_slist_next(tmp))
         func(table_name, tmp->data, user_data);
@@ -1852,9 +2282,17 @@ register_dissector_table(const char *name, const char *ui_name, const ftenum_t t
 		g_assert_not_reached();
 	}
 	sub_dissectors->dissector_handles = NULL;
+	sub_dissectors->dissector_handles_sorted = TRUE;
+	sub_dissectors->dissector_handle_set = g_hash_table_new(g_direct_hash, g_direct_equal);
 	sub_dissectors->ui_name = ui_name;
 	sub_dissectors->type    = type;
 	sub_dissectors->param   = param;
+	sub_dissectors->uint_index = NULL;
+	sub_dissectors->uint_index_size = 0;
+	sub_dissectors->uint_index_sparse = FALSE;
+	sub_dissectors->lookup_bits = NULL;
+	sub_dissectors->lookups = NULL;
+	dtbl_index_rebuild(sub_dissectors);
 	g_hash_table_insert( dissector_tables, (gpointer)name, (gpointer) sub_dissectors );
 	return sub_dissectors;
 }
@@ -1928,10 +2366,12 @@ heur_dissector_add(const char *name, heur_dissector_t dissector, const int proto
 	hdtbl_entry->protocol  = find_protocol_by_id(proto);
 	hdtbl_entry->list_name = g_strdup(name);
 	hdtbl_entry->enabled   = TRUE;
+	hdtbl_entry->precheck  = NULL;
 
 	/* do the table insertion */
 	sub_dissectors->dissectors = g_slist_prepend(sub_dissectors->dissectors,
 	    (gpointer)hdtbl_entry);
+	heur_dissector_list_invalidate(sub_dissectors);
 }
 
 
@@ -1966,6 +2406,9 @@ heur_dissector_delete(const char *name, heur_dissector_t dissector, const int pr
 		g_slice_free(heur_dtbl_entry_t, found_entry->data);
 		sub_dissectors->dissectors = g_slist_delete_link(sub_dissectors->dissectors,
 		    found_entry);
+		heur_dissector_list_invalidate(sub_dissectors);
+		/* Drop the matches too, as they may point to the entry */
+		sub_dissectors->conv_matches = NULL;
 	}
 }
 
@@ -1992,6 +2435,228 @@ heur_dissector_set_enabled(const char *name, heur_dissector_t dissector, const i
 	}
 }
 
+void
+heur_dissector_set_precheck(const char *name, heur_dissector_t dissector, const int proto, const heur_precheck_t *precheck) {
+	heur_dissector_list_t  sub_dissectors = find_heur_dissector_list(name);
+	GSList                *found_entry;
+	heur_dtbl_entry_t      hdtbl_entry;
+
+	/* sanity check */
+	g_assert(sub_dissectors != NULL);
+
+	hdtbl_entry.dissector = dissector;
+
+	hdtbl_entry.protocol  = find_protocol_by_id(proto);
+
+	found_entry = g_slist_find_custom(sub_dissectors->dissectors,
+	    (gpointer) &hdtbl_entry, find_matching_heur_dissector);
+
+	if (found_entry) {
+		heur_dtbl_entry_t *hdtbl_entry_p;
+		hdtbl_entry_p = (heur_dtbl_entry_t *)found_entry->data;
+		hdtbl_entry_p->precheck = precheck;
+		heur_dissector_list_invalidate(sub_dissectors);
+	}
+}
+
+/*
+ * Can an entry accept a tvb whose first byte is "first"?
+ */
+static gboolean
+heur_precheck_first_byte(const heur_dtbl_entry_t *hdtbl_entry, const guint8 first)
+{
+	const heur_precheck_t *precheck = hdtbl_entry->precheck;
+
+	if (precheck == NULL || precheck->magic == NULL ||
+	    precheck->magic_length == 0 || precheck->magic_offset != 0)
+		return TRUE;
+	return precheck->magic[0] == first;
+}
+
+static heur_dtbl_entry_t **
+heur_dispatch_build(GSList *dissectors, const int first)
+{
+	heur_dtbl_entry_t **table;
+	GSList             *entry;
+	guint               n = 0;
+
+	table = g_new(heur_dtbl_entry_t *, g_slist_length(dissectors) + 1);
+	for (entry = dissectors; entry != NULL; entry = g_slist_next(entry)) {
+		heur_dtbl_entry_t *hdtbl_entry = (heur_dtbl_entry_t *)entry->data;
+
+		if (first < 0 || heur_precheck_first_byte(hdtbl_entry, (guint8)first))
+			table[n++] = hdtbl_entry;
+	}
+	table[n] = NULL;
+	return table;
+}
+
+static void
+heur_dissector_list_compile(heur_dissector_list_t sub_dissectors)
+{
+	GSList  *entry;
+	gboolean by_first_byte = FALSE;
+	int      i;
+
+	heur_dissector_list_invalidate(sub_dissectors);
+
+	for (entry = sub_dissectors->dissectors; entry != NULL; entry = g_slist_next(entry)) {
+		const heur_precheck_t *precheck = ((heur_dtbl_entry_t *)entry->data)->precheck;
+
+		if (precheck != NULL && precheck->magic != NULL &&
+		    precheck->magic_length != 0 && precheck->magic_offset == 0) {
+			by_first_byte = TRUE;
+			break;
+		}
+	}
+
+	if (by_first_byte) {
+		for (i = 0; i < 256; i++)
+			sub_dissectors->dispatch[i] = heur_dispatch_build(sub_dissectors->dissectors, i);
+	}
+	sub_dissectors->dispatch[256] = heur_dispatch_build(sub_dissectors->dissectors, -1);
+	sub_dissectors->dispatch_valid = TRUE;
+}
+
+/*
+ * Run an entry's pre-check, if it has one; FALSE means the dissector
+ * would reject the tvb, so there's no need to call it.
+ */
+static gboolean
+heur_precheck_passes(const heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb)
+{
+	const heur_precheck_t *precheck = hdtbl_entry->precheck;
+
+	if (precheck == NULL)
+		return TRUE;
+	if (precheck->min_length != 0 &&
+	    !tvb_bytes_exist(tvb, 0, precheck->min_length))
+		return FALSE;
+	if (precheck->magic != NULL && precheck->magic_length != 0 &&
+	    tvb_memeql(tvb, precheck->magic_offset, precheck->magic, precheck->magic_length) != 0)
+		return FALSE;
+	return TRUE;
+}
+
+/*
+ * Call one heuristic dissector, if it's enabled and its pre-check passes,
+ * undoing what it added to the layers if it rejects the packet.
+ */
+static gboolean
+try_heuristic_entry(heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb,
+		    packet_info *pinfo, proto_tree *tree, void *data,
+		    const guint16 saved_can_desegment, const guint saved_layers_len,
+		    const gboolean accounting)
+{
+	int      proto_id;
+	int      profile_frame = -1;
+	int      saved_owner = WMEM_NO_OWNER;
+	gboolean owned = FALSE;
+	gboolean accepted;
+
+	/* XXX - why set this now and above? */
+	pinfo->can_desegment = saved_can_desegment-(saved_can_desegment>0);
+
+	if (hdtbl_entry->protocol != NULL &&
+		(!proto_is_protocol_enabled(hdtbl_entry->protocol)||(hdtbl_entry->enabled==FALSE))) {
+		/*
+		 * No - don't try this dissector.
+		 */
+		return FALSE;
+	}
+
+	if (!heur_precheck_passes(hdtbl_entry, tvb))
+		return FALSE;
+
+	proto_id = proto_get_id(hdtbl_entry->protocol);
+	if (hdtbl_entry->protocol != NULL) {
+		/* do NOT change this behavior - wslua uses the protocol short name set here in order
+		   to determine which Lua-based heurisitc dissector to call */
+		pinfo->current_proto =
+			proto_get_protocol_short_name(hdtbl_entry->protocol);
+
+		/*
+		 * Add the protocol name to the layers; we'll remove it
+		 * if the dissector fails.
+		 */
+		wmem_list_append(pinfo->layers, GINT_TO_POINTER(proto_id));
+
+		if (accounting) {
+			owned = TRUE;
+			saved_owner = wmem_accounting_set_owner(proto_id);
+		}
+
+		if (dissector_profiling_is_active())
+			profile_frame = dissector_profile_enter(proto_id);
+	}
+
+	pinfo->heur_list_name = hdtbl_entry->list_name;
+
+	EP_CHECK_CANARY(("before calling heuristic dissector for protocol: %s", proto_get_protocol_filter_name(proto_id)));
+	if (owned) {
+		/* As in call_dissector_through_handle(), give the owner
+		 * back even if the dissector throws */
+		TRY {
+			accepted = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+		}
+		FINALLY {
+			wmem_accounting_set_owner(saved_owner);
+		}
+		ENDTRY;
+	} else {
+		accepted = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+	}
+	if (profile_frame >= 0)
+		dissector_profile_leave(profile_frame, !accepted);
+	if (accepted) {
+		EP_CHECK_CANARY(("after heuristic dissector for protocol: %s has accepted and dissected packet", proto_get_protocol_filter_name(proto_id)));
+		return TRUE;
+	}
+
+	EP_CHECK_CANARY(("after heuristic dissector for protocol: %s has returned false", proto_get_protocol_filter_name(proto_id)));
+
+	/*
+	 * That dissector didn't accept the packet, so
+	 * remove its protocol's name from the list
+	 * of protocols.
+	 */
+	while (wmem_list_count(pinfo->layers) > saved_layers_len) {
+		wmem_list_remove_frame(pinfo->layers, wmem_list_tail(pinfo->layers));
+	}
+	return FALSE;
+}
+
+/*
+ * Remember that an entry accepted a frame of a conversation, unless the
+ * entry that's being tried first already did.
+ */
+static void
+heur_conv_match_add(heur_dissector_list_t sub_dissectors, conversation_t *conversation,
+		    heur_dtbl_entry_t *hdtbl_entry, const guint32 frame_num)
+{
+	heur_conv_match_t *prev = NULL;
+	heur_conv_match_t *conv_match;
+
+	if (sub_dissectors->conv_matches == NULL) {
+		sub_dissectors->conv_matches = wmem_map_new(wmem_file_scope(),
+		    g_direct_hash, g_direct_equal);
+	} else {
+		prev = (heur_conv_match_t *)wmem_map_lookup(sub_dissectors->conv_matches, conversation);
+		if (prev != NULL && prev->last_frame == 0) {
+			if (prev->entry == hdtbl_entry)
+				return;
+			prev->last_frame = frame_num;
+		}
+	}
+
+	conv_match = wmem_new(wmem_file_scope(), heur_conv_match_t);
+	conv_match->entry = hdtbl_entry;
+	conv_match->first_frame = frame_num;
+	conv_match->last_frame = 0;
+	conv_match->prev = prev;
+	wmem_map_insert(sub_dissectors->conv_matches, conversation, conv_match);
+}
+
 gboolean
 dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			packet_info *pinfo, proto_tree *tree, heur_dtbl_entry_t **heur_dtbl_entry, void *data)
@@ -1999,11 +2664,13 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 	gboolean           status;
 	const char        *saved_curr_proto;
 	const char        *saved_heur_list_name;
-	GSList            *entry;
+	heur_dtbl_entry_t **entry;
 	guint16            saved_can_desegment;
 	guint              saved_layers_len = 0;
-	heur_dtbl_entry_t *hdtbl_entry;
-	int                proto_id;
+	heur_dtbl_entry_t *first_entry = NULL;
+	heur_conv_match_t *conv_match = NULL;
+	conversation_t    *conversation = NULL;
+	gboolean           accounting;
 
 	/* can_desegment is set to 2 by anyone which offers this api/service.
 	   then everytime a subdissector is called it is decremented by one.
@@ -2025,53 +2692,62 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 	saved_layers_len = wmem_list_count(pinfo->layers);
 	*heur_dtbl_entry = NULL;
 
-	for (entry = sub_dissectors->dissectors; entry != NULL;
-	    entry = g_slist_next(entry)) {
-		/* XXX - why set this now and above? */
-		pinfo->can_desegment = saved_can_desegment-(saved_can_desegment>0);
-		hdtbl_entry = (heur_dtbl_entry_t *)entry->data;
+	if (!sub_dissectors->dispatch_valid)
+		heur_dissector_list_compile(sub_dissectors);
 
-		if (hdtbl_entry->protocol != NULL &&
-			(!proto_is_protocol_enabled(hdtbl_entry->protocol)||(hdtbl_entry->enabled==FALSE))) {
-			/*
-			 * No - don't try this dissector.
-			 */
-			continue;
-		}
+	/*
+	 * If a dissector in this list accepted the last packet of this
+	 * conversation, try it first; if it accepts this one too, none of
+	 * the others are called.  If it rejects a packet, it stops being
+	 * tried first, until a dissector accepts a later packet.  The
+	 * frames each match was used for are kept, so a frame is offered
+	 * to the dissectors in the same order on every pass.
+	 */
+	if (pinfo->ptype != PT_NONE) {
+		conversation = find_conversation(pinfo->fd->num, &pinfo->src, &pinfo->dst,
+		    pinfo->ptype, pinfo->srcport, pinfo->destport, 0);
+	}
+	if (conversation != NULL && sub_dissectors->conv_matches != NULL) {
+		conv_match = (heur_conv_match_t *)wmem_map_lookup(sub_dissectors->conv_matches, conversation);
+		while (conv_match != NULL && conv_match->first_frame >= pinfo->fd->num)
+			conv_match = conv_match->prev;
+		if (conv_match != NULL &&
+		    (conv_match->last_frame == 0 || conv_match->last_frame >= pinfo->fd->num))
+			first_entry = conv_match->entry;
+	}
 
-		proto_id = proto_get_id(hdtbl_entry->protocol);
-		if (hdtbl_entry->protocol != NULL) {
-			/* do NOT change this behavior - wslua uses the protocol short name set here in order
-			   to determine which Lua-based heurisitc dissector to call */
-			pinfo->current_proto =
-				proto_get_protocol_short_name(hdtbl_entry->protocol);
+	/* Only try the dissectors that can accept this first byte */
+	entry = sub_dissectors->dispatch[256];
+	if (tvb_length(tvb) > 0) {
+		guint8 first = tvb_get_guint8(tvb, 0);
 
-			/*
-			 * Add the protocol name to the layers; we'll remove it
-			 * if the dissector fails.
-			 */
-			wmem_list_append(pinfo->layers, GINT_TO_POINTER(proto_id));
+		if (sub_dissectors->dispatch[first] != NULL)
+			entry = sub_dissectors->dispatch[first];
+	}
+
+	accounting = wmem_accounting_is_active();
+
+	if (first_entry != NULL) {
+		if (try_heuristic_entry(first_entry, tvb, pinfo, tree, data,
+			saved_can_desegment, saved_layers_len, accounting)) {
+			*heur_dtbl_entry = first_entry;
+			status = TRUE;
+		} else if (!pinfo->fd->flags.visited && conv_match->last_frame == 0) {
+			conv_match->last_frame = pinfo->fd->num;
 		}
+	}
 
-		pinfo->heur_list_name = hdtbl_entry->list_name;
+	for (; !status && *entry != NULL; entry++) {
+		if (*entry == first_entry)
+			continue;
 
-		EP_CHECK_CANARY(("before calling heuristic dissector for protocol: %s", proto_get_protocol_filter_name(proto_id)));
-		if ((hdtbl_entry->dissector)(tvb, pinfo, tree, data)) {
-			EP_CHECK_CANARY(("after heuristic dissector for protocol: %s has accepted and dissected packet", proto_get_protocol_filter_name(proto_id)));
-			*heur_dtbl_entry = hdtbl_entry;
+		if (try_heuristic_entry(*entry, tvb, pinfo, tree, data,
+			saved_can_desegment, saved_layers_len, accounting)) {
+			*heur_dtbl_entry = *entry;
 			status = TRUE;
-			break;
-		} else {
-			EP_CHECK_CANARY(("after heuristic dissector for protocol: %s has returned false", proto_get_protocol_filter_name(proto_id)));
 
-			/*
-			 * That dissector didn't accept the packet, so
-			 * remove its protocol's name from the list
-			 * of protocols.
-			 */
-			while (wmem_list_count(pinfo->layers) > saved_layers_len) {
-				wmem_list_remove_frame(pinfo->layers, wmem_list_tail(pinfo->layers));
-			}
+			if (conversation != NULL && !pinfo->fd->flags.visited)
+				heur_conv_match_add(sub_dissectors, conversation, *entry, pinfo->fd->num);
 		}
 	}
 
@@ -2226,7 +2902,7 @@ register_heur_dissector_list(const char *name)
 
 	/* Create and register the dissector table for this name; returns */
 	/* a pointer to the dissector table. */
-	sub_dissectors = g_slice_new(struct heur_dissector_list);
+	sub_dissectors = g_slice_new0(struct heur_dissector_list);
 	sub_dissectors->dissectors = NULL;	/* initially empty */
 	g_hash_table_insert(heur_dissector_lists, (gpointer)name,
 			    (gpointer) sub_dissectors);
@@ -247,6 +247,19 @@ WS_DLL_PUBLIC void dissector_change_uint(const char *abbrev, const guint32 patte
 /* Reset an entry in a uint dissector table to its initial value. */
 WS_DLL_PUBLIC void dissector_reset_uint(const char *name, const guint32 pattern);
 
+/* Has dissector_change_uint(), dissector_reset_uint(),
+   dissector_change_string() or dissector_reset_string() changed an entry
+   that was looked up while dissecting, since dissection was last started
+   or this was last called?  If not, dissecting the packets again would
+   give the same results. */
+WS_DLL_PUBLIC gboolean dissector_table_lookups_changed(void);
+
+/* Returns a value that changes whenever an entry in any uint dissector
+   table is added, removed or changed, e.g. by "Decode As" or a port
+   preference.  Callers that remember which handle a lookup found can
+   keep using it for as long as this doesn't change. */
+WS_DLL_PUBLIC guint32 dissector_table_uint_generation(void);
+
 /* Look for a given value in a given uint dissector table and, if found,
    call the dissector with the arguments supplied, and return the number
    of bytes consumed, otherwise return 0. */
@@ -348,11 +361,23 @@ struct heur_dissector_list;
 typedef struct heur_dissector_list *heur_dissector_list_t;
 
 
+/** A cheap test of whether a heuristic dissector could accept a tvb,
+ *  made before the dissector is called; see heur_dissector_set_precheck().
+ *  Only use it for checks the dissector itself always makes.
+ */
+typedef struct {
+	guint min_length;      /* bytes that must be captured, or 0 */
+	guint magic_offset;    /* where the magic bytes are */
+	const guint8 *magic;   /* bytes that must be at magic_offset, or NULL */
+	guint magic_length;
+} heur_precheck_t;
+
 typedef struct {
 	heur_dissector_t dissector;
 	protocol_t *protocol; /* this entry's protocol */
 	gchar *list_name;     /* the list name this entry is in the list of */
 	gboolean enabled;
+	const heur_precheck_t *precheck; /* cheap test made first, or NULL */
 } heur_dtbl_entry_t;
 
 /** A protocol uses this function to register a heuristic sub-dissector list.
@@ -397,6 +422,12 @@ WS_DLL_PUBLIC gboolean has_heur_dissector_list(const gchar *name);
  *  until we find one that recognizes the protocol.
  *  Call this while the parent dissector running.
  *
+ *  Dissectors whose pre-check fails aren't called.  The dissector that
+ *  accepted the last packet of the same conversation is tried first, and
+ *  if it accepts this packet too the others aren't called, so dissectors
+ *  don't need to call conversation_set_dissector() themselves to avoid
+ *  the rest of the list.
+ *
  * @param sub_dissectors the sub-dissector list
  * @param tvb the tvbuff with the (remaining) packet data
  * @param pinfo the packet info of this packet (additional info)
@@ -444,6 +475,20 @@ WS_DLL_PUBLIC void heur_dissector_delete(const char *name, heur_dissector_t diss
  */
 extern void heur_dissector_set_enabled(const char *name, heur_dissector_t dissector, const int proto, const gboolean enabled);
 
+/** Give a sub-dissector in a heuristic dissector list a pre-check.
+ *  Call this in the proto_handoff function of the sub-dissector, after
+ *  heur_dissector_add().  Dissectors whose pre-check has magic bytes at
+ *  offset 0 are only offered packets that start with the right byte.
+ *
+ * @param name the name of the "parent" protocol, e.g. "tcp"
+ * @param dissector the sub-dissector
+ * @param proto the protocol id of the sub-dissector
+ * @param precheck the pre-check, which must stay valid while the
+ * sub-dissector is registered, or NULL for none
+ */
+WS_DLL_PUBLIC void heur_dissector_set_precheck(const char *name, heur_dissector_t dissector,
+    const int proto, const heur_precheck_t *precheck);
+
 /** Register a dissector. */
 WS_DLL_PUBLIC dissector_handle_t register_dissector(const char *name, dissector_t dissector,
     const int proto);
@@ -542,6 +587,12 @@ void init_dissection(void);
 /* Free data structures allocated for dissection. */
 void cleanup_dissection(void);
 
+/* Count the file-scope memory allocated by each protocol from the next
+   init_dissection() on, as the "memory_accounting" preference does; the
+   counts can be read with wmem_accounting_foreach(wmem_file_scope(), ...),
+   with protocol ids as owners. */
+WS_DLL_PUBLIC void set_memory_accounting(gboolean enable);
+
 /* Allow protocols to register a "cleanup" routine to be
  * run after the initial sequential run through the packets.
  * Note that the file can still be open after this; this is not
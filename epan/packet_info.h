@@ -159,7 +159,7 @@ typedef struct _packet_info {
 
   int link_dir;                 /**< 3GPP messages are sometime different UP link(UL) or Downlink(DL) */
 
-  GSList* proto_data;          /**< Per packet proto data */
+  proto_data_vec *proto_data;  /**< Per packet proto data */
 
   GSList* dependent_frames;     /**< A list of frames which this one depends on */
 
@@ -169,6 +169,7 @@ typedef struct _packet_info {
   struct epan_session *epan;
   nstime_t     rel_ts;       /**< Relative timestamp (yes, it can be negative) */
   const gchar *heur_list_name;    /**< name of heur list if this packet is being heuristically dissected */
+  const int *cutoff_protos;    /**< if not NULL, protocol IDs (ending with -1) after which nothing more is dissected; see epan_dissect_set_cutoff() */
 } packet_info;
 
 /** @} */
@@ -42,6 +42,7 @@ struct pref_module {
     wmem_tree_t *submodules;    /**< list of its submodules */
     int numprefs;               /**< number of non-obsolete preferences */
     gboolean prefs_changed;     /**< if TRUE, a preference has changed since we last checked */
+    guint effect;               /**< PREF_EFFECT_ flags given to preferences registered from now on */
     gboolean obsolete;          /**< if TRUE, this is a module that used to
                                  * exist but no longer does
                                  */
@@ -120,6 +121,7 @@ struct preference {
     int ordinal;                     /**< ordinal number of this preference */
     pref_type_t type;                /**< type of that preference */
     gui_type_t gui;                  /**< type of the GUI (QT, GTK or both) the preference is registered for */
+    guint effect;                    /**< PREF_EFFECT_ flags: what a change to it makes stale */
     union {                          /* The Qt preference code assumes that these will all be pointers (and unique) */
         guint *uint;
         gboolean *boolp;
@@ -347,6 +347,7 @@ prefs_register_module_or_subtree(module_t *parent, const char *name,
     module->submodules = NULL;    /* no submodules, to start */
     module->numprefs = 0;
     module->prefs_changed = FALSE;
+    module->effect = parent ? parent->effect : PREF_EFFECT_DISSECTION;
     module->obsolete = FALSE;
     module->use_gui = use_gui;
 
@@ -731,6 +732,7 @@ register_preference(module_t *module, const char *name, const char *title,
     preference->description = description;
     preference->type = type;
     preference->gui = GUI_ALL;  /* default */
+    preference->effect = module->effect;
     if (title != NULL)
         preference->ordinal = module->numprefs;
     else
@@ -1174,6 +1176,22 @@ prefs_register_obsolete_preference(module_t *module, const char *name)
     register_preference(module, name, NULL, NULL, PREF_OBSOLETE);
 }
 
+void
+prefs_set_module_effect(module_t *module, guint effect)
+{
+    module->effect = effect;
+}
+
+void
+prefs_set_preference_effect(module_t *module, const char *name, guint effect)
+{
+    pref_t *pref = prefs_find_preference(module, name);
+
+    if (pref == NULL)
+        g_error("Preference %s.%s hasn't been registered", module->name, name);
+    pref->effect = effect;
+}
+
 /*
  * Check to see if a preference is obsolete.
  */
@@ -2053,6 +2071,8 @@ prefs_register_modules(void)
      */
     gui_module = prefs_register_module(NULL, "gui", "User Interface",
         "User Interface", &gui_callback, FALSE);
+    /* None of these change how packets are dissected. */
+    prefs_set_module_effect(gui_module, PREF_EFFECT_DISPLAY);
 
     /* gui.console_open is placed first in the list so that any problems encountered
      *  in the following prefs can be displayed in the console window.
@@ -2301,6 +2321,16 @@ prefs_register_modules(void)
     prefs_register_string_preference(gui_module, "window_title", "Custom window title",
         "Custom window title. (Appended to existing titles.)", (const char **)&prefs.gui_window_title);
 
+    prefs_register_string_preference(gui_module, "field_store", "Fields to remember",
+        "Fields whose values are recorded for every packet when a file is read, "
+        "separated by commas, so that display filters on them can be applied "
+        "without dissecting the packets again (e.g. ip.src,tcp.dstport). "
+        "Only header fields whose values can't change later, such as IPv4 "
+        "addresses, ports and protocol numbers, can be recorded.",
+        (const char **)&prefs.gui_field_store_fields);
+    /* The values are only recorded while the packets are dissected. */
+    prefs_set_preference_effect(gui_module, "field_store", PREF_EFFECT_DISSECTION);
+
     prefs_register_string_preference(gui_module, "start_title", "Custom start page title",
         "Custom start page title", (const char**)(&prefs.gui_start_title));
 
@@ -2356,6 +2386,7 @@ prefs_register_modules(void)
      */
     console_module = prefs_register_module(NULL, "console", "Console",
         "CONSOLE", NULL, FALSE);
+    prefs_set_module_effect(console_module, 0);
 
     custom_cbs.free_cb = custom_pref_no_cb;
     custom_cbs.reset_cb = console_log_level_reset_cb;
@@ -2375,6 +2406,7 @@ prefs_register_modules(void)
      */
     capture_module = prefs_register_module(NULL, "capture", "Capture",
         "CAPTURE", NULL, FALSE);
+    prefs_set_module_effect(capture_module, 0);
 
     prefs_register_string_preference(capture_module, "device", "Default capture device",
         "Default capture device", (const char **)&prefs.capture_device);
@@ -2451,6 +2483,7 @@ prefs_register_modules(void)
     /* Printing */
     printing = prefs_register_module(NULL, "print", "Printing",
         "Printing", NULL, TRUE);
+    prefs_set_module_effect(printing, 0);
 
     prefs_register_enum_preference(printing, "format",
                                    "Format", "Can be one of \"text\" or \"postscript\"",
@@ -2472,6 +2505,7 @@ prefs_register_modules(void)
     /* Statistics */
     stats_module = prefs_register_module(NULL, "statistics", "Statistics",
         "Statistics", &stats_callback, TRUE);
+    prefs_set_module_effect(stats_module, 0);
 
     prefs_register_uint_preference(stats_module, "update_interval",
                                    "Tap update interval in ms",
@@ -2568,6 +2602,24 @@ prefs_register_modules(void)
                                    "Display byte fields with a space character between bytes",
                                    "Display all byte fields with a space character between each byte in the packet list.",
                                    &prefs.display_byte_fields_with_spaces);
+    prefs_set_preference_effect(protocols_module, "display_hidden_proto_items", PREF_EFFECT_DISPLAY);
+    prefs_set_preference_effect(protocols_module, "display_byte_fields_with_spaces", PREF_EFFECT_DISPLAY);
+
+    prefs_register_uint_preference(protocols_module, "reassembly_memory_limit",
+                                   "Reassembly memory limit (MB)",
+                                   "Once completed reassemblies hold more than this many megabytes, "
+                                   "the least recently used ones are written to a temporary file "
+                                   "and read back when needed. 0 means no limit.",
+                                   10,
+                                   &prefs.reassembly_memory_limit);
+
+    prefs_register_bool_preference(protocols_module, "memory_accounting",
+                                   "Count memory per protocol",
+                                   "Keep track of how much file-scope memory each protocol allocates, "
+                                   "and show it in the capture file properties. "
+                                   "Takes effect when the next file is read, and slows dissection down.",
+                                   &prefs.memory_accounting);
+    prefs_set_preference_effect(protocols_module, "memory_accounting", 0);
 
     /* Obsolete preferences
      * These "modules" were reorganized/renamed to correspond to their GUI
@@ -2950,6 +3002,7 @@ pre_init_prefs(void)
     prefs.gui_webbrowser             = (char *) "";
 #endif
     prefs.gui_window_title           = (char *) "";
+    prefs.gui_field_store_fields     = (char *) "";
     prefs.gui_start_title            = "The World's Most Popular Network Protocol Analyzer";
     prefs.gui_version_placement      = version_both;
     prefs.gui_auto_scroll_on_expand  = FALSE;
@@ -3008,6 +3061,8 @@ pre_init_prefs(void)
     prefs.st_sort_showfullname = FALSE;
     prefs.display_hidden_proto_items = FALSE;
     prefs.display_byte_fields_with_spaces = FALSE;
+    prefs.reassembly_memory_limit = 0;
+    prefs.memory_accounting = FALSE;
 
     prefs_pre_initialized = TRUE;
 }
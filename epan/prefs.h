@@ -174,6 +174,7 @@ typedef struct _e_prefs {
   gboolean     gui_use_pref_save;
   gchar       *gui_webbrowser;
   gchar       *gui_window_title;
+  gchar       *gui_field_store_fields;
   const gchar *gui_start_title;
   version_info_e gui_version_placement;
   gboolean     gui_auto_scroll_on_expand;
@@ -204,6 +205,8 @@ typedef struct _e_prefs {
   guint        tap_update_interval;
   gboolean     display_hidden_proto_items;
   gboolean     display_byte_fields_with_spaces;
+  guint        reassembly_memory_limit; /* MB; 0 = no limit */
+  gboolean     memory_accounting;
   gpointer     filter_expressions;/* Actually points to &head */
   gboolean     gui_update_enabled;
   software_update_channel_e gui_update_channel;
@@ -487,6 +490,28 @@ void prefs_register_custom_preference(module_t *module, const char *name,
 WS_DLL_PUBLIC void prefs_register_obsolete_preference(module_t *module,
     const char *name);
 
+/*
+ * What has to be redone to an open capture file when a preference
+ * changes.  Preferences register as PREF_EFFECT_DISSECTION unless their
+ * module or the preference itself says otherwise; 0 means the open file
+ * isn't affected at all.
+ */
+#define PREF_EFFECT_DISSECTION  (1U << 0)   /* packets must be dissected from scratch */
+#define PREF_EFFECT_FILTER      (1U << 1)   /* the display filter must be run again */
+#define PREF_EFFECT_DISPLAY     (1U << 2)   /* the packet list must be redrawn */
+
+/*
+ * Set the effect of the preferences registered in a module, and in the
+ * submodules created under it, from now on.
+ */
+WS_DLL_PUBLIC void prefs_set_module_effect(module_t *module, guint effect);
+
+/*
+ * Set the effect of a preference that has already been registered.
+ */
+WS_DLL_PUBLIC void prefs_set_preference_effect(module_t *module,
+    const char *name, guint effect);
+
 
 typedef guint (*pref_cb)(pref_t *pref, gpointer user_data);
 
@@ -31,12 +31,15 @@
 #include <epan/epan.h>
 #include <epan/epan_dissect.h>
 #include <epan/to_str.h>
+#include <epan/to_str-int.h>
 #include <epan/expert.h>
 #include <epan/packet-range.h>
 #include <epan/print.h>
 #include <epan/charsets.h>
 #include <epan/dissectors/packet-data.h>
 #include <epan/dissectors/packet-frame.h>
+#include <epan/ipv4.h>
+#include <wsutil/arrow_ipc.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/ws_version_info.h>
 #include <ftypes/ftypes-int.h>
@@ -58,15 +61,36 @@ typedef struct {
 
 typedef struct {
     int             level;
-    FILE           *fh;
+    GString        *buf;
     GSList         *src_list;
     epan_dissect_t *edt;
 } write_pdml_data;
 
+/*
+ * How to write the value of a field with -T fields, worked out when the
+ * first packet is written rather than for each item of each packet.
+ */
+typedef enum {
+    OUTPUT_FIELD_UINT,      /* FT_UINT8..FT_UINT32 and FT_FRAMENUM, in decimal */
+    OUTPUT_FIELD_INT,       /* FT_INT8..FT_INT32, in decimal */
+    OUTPUT_FIELD_UINT64,
+    OUTPUT_FIELD_INT64,
+    OUTPUT_FIELD_BOOLEAN,   /* "1" or "0" */
+    OUTPUT_FIELD_NONE,      /* "1", so that its presence can be checked */
+    OUTPUT_FIELD_REPR,      /* its display string, or else its bytes in hex */
+    OUTPUT_FIELD_NODE       /* as get_node_field_value() makes it */
+} output_field_format_e;
+
 typedef struct {
-    output_fields_t *fields;
-    epan_dissect_t  *edt;
-} write_field_data_t;
+    int                    hfid;
+    output_field_format_e  format;
+} output_field_hf_t;
+
+typedef struct {
+    GArray      *hfs;       /* output_field_hf_t's for the field, and any others with its name */
+    GArray      *cols;      /* for a "_ws.col." field, the indexes of the columns with its title */
+    arrow_type_e arrow_type; /* for -T arrow, the type of its column */
+} output_field_plan_t;
 
 struct _output_fields {
     gboolean     print_header;
@@ -74,8 +98,10 @@ struct _output_fields {
     gchar        occurrence;
     gchar        aggregator;
     GPtrArray   *fields;
-    GHashTable  *field_indicies;
-    GPtrArray  **field_values;
+    output_field_plan_t *plan;  /* one for each of fields */
+    gboolean     cols_resolved; /* the plan's columns have been looked up */
+    GString     *line;      /* the line for a packet, kept from one to the next */
+    arrow_writer_t *arrow;  /* for -T arrow */
     gchar        quote;
     gboolean     includes_col_fields;
 };
@@ -87,11 +113,26 @@ static const guint8 *get_field_data(GSList *src_list, field_info *fi);
 static void pdml_write_field_hex_value(write_pdml_data *pdata, field_info *fi);
 static gboolean print_hex_data_buffer(print_stream_t *stream, const guchar *cp,
                                       guint length, packet_char_enc encoding);
-static void print_escaped_xml(FILE *fh, const char *unescaped_string);
+static void print_escaped_xml(GString *buf, const char *unescaped_string);
+
+static void print_pdml_geninfo(proto_tree *tree, GString *buf);
 
-static void print_pdml_geninfo(proto_tree *tree, FILE *fh);
+/*
+ * The PDML, PSML, CSV and JSON writers build up a packet's output in
+ * a buffer that's kept from one packet to the next, and write it with a
+ * single fwrite(); the *_buf() variants leave writing it to the caller.
+ */
+static GString *packet_buf;
+
+static GString *
+packet_get_buf(void)
+{
+    if (packet_buf == NULL)
+        packet_buf = g_string_sized_new(8192);
+    g_string_truncate(packet_buf, 0);
+    return packet_buf;
+}
 
-static void proto_tree_get_node_field_values(proto_node *node, gpointer data);
 
 gboolean
 proto_tree_print(print_args_t *print_args, epan_dissect_t *edt,
@@ -225,24 +266,43 @@ write_pdml_preamble(FILE *fh, const gchar *filename)
 
 void
 write_pdml_proto_tree(epan_dissect_t *edt, FILE *fh)
+{
+    GString *buf = packet_get_buf();
+
+    write_pdml_proto_tree_buf(edt, buf);
+    fwrite(buf->str, 1, buf->len, fh);
+}
+
+void
+write_pdml_proto_tree_buf(epan_dissect_t *edt, GString *buf)
 {
     write_pdml_data data;
 
     /* Create the output */
     data.level    = 0;
-    data.fh       = fh;
+    data.buf      = buf;
     data.src_list = edt->pi.data_src;
     data.edt      = edt;
 
-    fprintf(fh, "<packet>\n");
+    g_string_append(buf, "<packet>\n");
 
     /* Print a "geninfo" protocol as required by PDML */
-    print_pdml_geninfo(edt->tree, fh);
+    print_pdml_geninfo(edt->tree, buf);
 
     proto_tree_children_foreach(edt->tree, proto_tree_write_node_pdml,
                                 &data);
 
-    fprintf(fh, "</packet>\n\n");
+    g_string_append(buf, "</packet>\n\n");
+}
+
+static void
+pdml_write_indent(GString *buf, int level)
+{
+    int i;
+
+    for (i = -1; i < level; i++) {
+        g_string_append_len(buf, "  ", 2);
+    }
 }
 
 /* Write out a tree's data, and any child nodes, as PDML */
@@ -251,10 +311,10 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
 {
     field_info      *fi    = PNODE_FINFO(node);
     write_pdml_data *pdata = (write_pdml_data*) data;
+    GString         *buf   = pdata->buf;
     const gchar     *label_ptr;
     gchar            label_str[ITEM_LABEL_LENGTH];
     char            *dfilter_string;
-    int              i;
     gboolean         wrap_in_fake_protocol;
 
     /* dissection with an invisible proto tree? */
@@ -268,19 +328,15 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
          (pdata->level == 0));
 
     /* Indent to the correct level */
-    for (i = -1; i < pdata->level; i++) {
-        fputs("  ", pdata->fh);
-    }
+    pdml_write_indent(buf, pdata->level);
 
     if (wrap_in_fake_protocol) {
         /* Open fake protocol wrapper */
-        fputs("<proto name=\"fake-field-wrapper\">\n", pdata->fh);
+        g_string_append(buf, "<proto name=\"fake-field-wrapper\">\n");
 
         /* Indent to increased level before writing out field */
         pdata->level++;
-        for (i = -1; i < pdata->level; i++) {
-            fputs("  ", pdata->fh);
-        }
+        pdml_write_indent(buf, pdata->level);
     }
 
     /* Text label. It's printed as a field with no name. */
@@ -294,27 +350,27 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
         }
 
         /* Show empty name since it is a required field */
-        fputs("<field name=\"", pdata->fh);
-        fputs("\" show=\"", pdata->fh);
-        print_escaped_xml(pdata->fh, label_ptr);
+        g_string_append(buf, "<field name=\"");
+        g_string_append(buf, "\" show=\"");
+        print_escaped_xml(buf, label_ptr);
 
-        fprintf(pdata->fh, "\" size=\"%d", fi->length);
+        g_string_append_printf(buf, "\" size=\"%d", fi->length);
         if (node->parent && node->parent->finfo && (fi->start < node->parent->finfo->start)) {
-            fprintf(pdata->fh, "\" pos=\"%d", node->parent->finfo->start + fi->start);
+            g_string_append_printf(buf, "\" pos=\"%d", node->parent->finfo->start + fi->start);
         } else {
-            fprintf(pdata->fh, "\" pos=\"%d", fi->start);
+            g_string_append_printf(buf, "\" pos=\"%d", fi->start);
         }
 
         if (fi->length > 0) {
-            fputs("\" value=\"", pdata->fh);
+            g_string_append(buf, "\" value=\"");
             pdml_write_field_hex_value(pdata, fi);
         }
 
         if (node->first_child != NULL) {
-            fputs("\">\n", pdata->fh);
+            g_string_append(buf, "\">\n");
         }
         else {
-            fputs("\"/>\n", pdata->fh);
+            g_string_append(buf, "\"/>\n");
         }
     }
 
@@ -323,19 +379,19 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
     else if (fi->hfinfo->id == proto_data) {
 
         /* Write out field with data */
-        fputs("<field name=\"data\" value=\"", pdata->fh);
+        g_string_append(buf, "<field name=\"data\" value=\"");
         pdml_write_field_hex_value(pdata, fi);
-        fputs("\">\n", pdata->fh);
+        g_string_append(buf, "\">\n");
     }
     /* Normal protocols and fields */
     else {
         if ((fi->hfinfo->type == FT_PROTOCOL) && (fi->hfinfo->id != proto_expert)) {
-            fputs("<proto name=\"", pdata->fh);
+            g_string_append(buf, "<proto name=\"");
         }
         else {
-            fputs("<field name=\"", pdata->fh);
+            g_string_append(buf, "<field name=\"");
         }
-        print_escaped_xml(pdata->fh, fi->hfinfo->abbrev);
+        print_escaped_xml(buf, fi->hfinfo->abbrev);
 
 #if 0
         /* PDML spec, see:
@@ -351,31 +407,31 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
          * (like it's contained in the fi->rep->representation).
          * Unfortunately, we don't have the field data representation for
          * all fields, so this isn't currently possible */
-        fputs("\" showname=\"", pdata->fh);
-        print_escaped_xml(pdata->fh, fi->hfinfo->name);
+        g_string_append(buf, "\" showname=\"");
+        print_escaped_xml(buf, fi->hfinfo->name);
 #endif
 
         if (fi->rep) {
-            fputs("\" showname=\"", pdata->fh);
-            print_escaped_xml(pdata->fh, fi->rep->representation);
+            g_string_append(buf, "\" showname=\"");
+            print_escaped_xml(buf, fi->rep->representation);
         }
         else {
             label_ptr = label_str;
             proto_item_fill_label(fi, label_str);
-            fputs("\" showname=\"", pdata->fh);
-            print_escaped_xml(pdata->fh, label_ptr);
+            g_string_append(buf, "\" showname=\"");
+            print_escaped_xml(buf, label_ptr);
         }
 
         if (PROTO_ITEM_IS_HIDDEN(node))
-            fprintf(pdata->fh, "\" hide=\"yes");
+            g_string_append(buf, "\" hide=\"yes");
 
-        fprintf(pdata->fh, "\" size=\"%d", fi->length);
+        g_string_append_printf(buf, "\" size=\"%d", fi->length);
         if (node->parent && node->parent->finfo && (fi->start < node->parent->finfo->start)) {
-            fprintf(pdata->fh, "\" pos=\"%d", node->parent->finfo->start + fi->start);
+            g_string_append_printf(buf, "\" pos=\"%d", node->parent->finfo->start + fi->start);
         } else {
-            fprintf(pdata->fh, "\" pos=\"%d", fi->start);
+            g_string_append_printf(buf, "\" pos=\"%d", fi->start);
         }
-/*      fprintf(pdata->fh, "\" id=\"%d", fi->hfinfo->id);*/
+/*      g_string_append_printf(buf, "\" id=\"%d", fi->hfinfo->id);*/
 
         /* show, value, and unmaskedvalue attributes */
         switch (fi->hfinfo->type)
@@ -383,14 +439,14 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
         case FT_PROTOCOL:
             break;
         case FT_NONE:
-            fputs("\" show=\"\" value=\"",  pdata->fh);
+            g_string_append(buf, "\" show=\"\" value=\"");
             break;
         default:
             dfilter_string = fvalue_to_string_repr(&fi->value, FTREPR_DISPLAY, fi->hfinfo->display, NULL);
             if (dfilter_string != NULL) {
 
-                fputs("\" show=\"", pdata->fh);
-                print_escaped_xml(pdata->fh, dfilter_string);
+                g_string_append(buf, "\" show=\"");
+                print_escaped_xml(buf, dfilter_string);
             }
             g_free(dfilter_string);
 
@@ -402,7 +458,7 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
              * they might be generated fields.
              */
             if (fi->length > 0) {
-                fputs("\" value=\"", pdata->fh);
+                g_string_append(buf, "\" value=\"");
 
                 if (fi->hfinfo->bitmask!=0) {
                     switch (fi->value.ftype->ftype) {
@@ -410,24 +466,24 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
                         case FT_INT16:
                         case FT_INT24:
                         case FT_INT32:
-                            fprintf(pdata->fh, "%X", (guint) fvalue_get_sinteger(&fi->value));
+                            g_string_append_printf(buf, "%X", (guint) fvalue_get_sinteger(&fi->value));
                             break;
                         case FT_UINT8:
                         case FT_UINT16:
                         case FT_UINT24:
                         case FT_UINT32:
                         case FT_BOOLEAN:
-                            fprintf(pdata->fh, "%X", fvalue_get_uinteger(&fi->value));
+                            g_string_append_printf(buf, "%X", fvalue_get_uinteger(&fi->value));
                             break;
                         case FT_INT64:
                         case FT_UINT64:
-                            fprintf(pdata->fh, "%" G_GINT64_MODIFIER "X",
+                            g_string_append_printf(buf, "%" G_GINT64_MODIFIER "X",
                                     fvalue_get_integer64(&fi->value));
                             break;
                         default:
                             g_assert_not_reached();
                     }
-                    fputs("\" unmaskedvalue=\"", pdata->fh);
+                    g_string_append(buf, "\" unmaskedvalue=\"");
                     pdml_write_field_hex_value(pdata, fi);
                 }
                 else {
@@ -437,13 +493,13 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
         }
 
         if (node->first_child != NULL) {
-            fputs("\">\n", pdata->fh);
+            g_string_append(buf, "\">\n");
         }
         else if (fi->hfinfo->id == proto_data) {
-            fputs("\">\n", pdata->fh);
+            g_string_append(buf, "\">\n");
         }
         else {
-            fputs("\"/>\n", pdata->fh);
+            g_string_append(buf, "\"/>\n");
         }
     }
 
@@ -462,26 +518,24 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
 
     if (node->first_child != NULL) {
         /* Indent to correct level */
-        for (i = -1; i < pdata->level; i++) {
-            fputs("  ", pdata->fh);
-        }
+        pdml_write_indent(buf, pdata->level);
         /* Close off current element */
         /* Data and expert "protocols" use simple tags */
         if ((fi->hfinfo->id != proto_data) && (fi->hfinfo->id != proto_expert)) {
             if (fi->hfinfo->type == FT_PROTOCOL) {
-                fputs("</proto>\n", pdata->fh);
+                g_string_append(buf, "</proto>\n");
             }
             else {
-                fputs("</field>\n", pdata->fh);
+                g_string_append(buf, "</field>\n");
             }
         } else {
-            fputs("</field>\n", pdata->fh);
+            g_string_append(buf, "</field>\n");
         }
     }
 
     /* Close off fake wrapper protocol */
     if (wrap_in_fake_protocol) {
-        fputs("</proto>\n", pdata->fh);
+        g_string_append(buf, "</proto>\n");
     }
 }
 
@@ -490,7 +544,7 @@ proto_tree_write_node_pdml(proto_node *node, gpointer data)
  * but we produce a 'geninfo' protocol in the PDML to conform to spec.
  * The 'frame' protocol follows the 'geninfo' protocol in the PDML. */
 static void
-print_pdml_geninfo(proto_tree *tree, FILE *fh)
+print_pdml_geninfo(proto_tree *tree, GString *buf)
 {
     guint32     num, len, caplen;
     nstime_t   *timestamp;
@@ -539,37 +593,36 @@ print_pdml_geninfo(proto_tree *tree, FILE *fh)
     g_ptr_array_free(finfo_array, TRUE);
 
     /* Print geninfo start */
-    fprintf(fh,
+    g_string_append_printf(buf,
             "  <proto name=\"geninfo\" pos=\"0\" showname=\"General information\" size=\"%u\">\n",
             frame_finfo->length);
 
     /* Print geninfo.num */
-    fprintf(fh,
+    g_string_append_printf(buf,
             "    <field name=\"num\" pos=\"0\" show=\"%u\" showname=\"Number\" value=\"%x\" size=\"%u\"/>\n",
             num, num, frame_finfo->length);
 
     /* Print geninfo.len */
-    fprintf(fh,
+    g_string_append_printf(buf,
             "    <field name=\"len\" pos=\"0\" show=\"%u\" showname=\"Frame Length\" value=\"%x\" size=\"%u\"/>\n",
             len, len, frame_finfo->length);
 
     /* Print geninfo.caplen */
-    fprintf(fh,
+    g_string_append_printf(buf,
             "    <field name=\"caplen\" pos=\"0\" show=\"%u\" showname=\"Captured Length\" value=\"%x\" size=\"%u\"/>\n",
             caplen, caplen, frame_finfo->length);
 
     tmp = abs_time_to_str(NULL, timestamp, ABSOLUTE_TIME_LOCAL, TRUE);
 
     /* Print geninfo.timestamp */
-    fprintf(fh,
+    g_string_append_printf(buf,
             "    <field name=\"timestamp\" pos=\"0\" show=\"%s\" showname=\"Captured Time\" value=\"%d.%09d\" size=\"%u\"/>\n",
             tmp, (int) timestamp->secs, timestamp->nsecs, frame_finfo->length);
 
     wmem_free(NULL, tmp);
 
     /* Print geninfo end */
-    fprintf(fh,
-            "  </proto>\n");
+    g_string_append(buf, "  </proto>\n");
 }
 
 void
@@ -581,7 +634,8 @@ write_pdml_finale(FILE *fh)
 void
 write_psml_preamble(column_info *cinfo, FILE *fh)
 {
-    gint i;
+    gint     i;
+    GString *buf;
 
     fputs("<?xml version=\"1.0\"?>\n", fh);
     fputs("<psml version=\"" PSML_VERSION "\" ", fh);
@@ -590,7 +644,9 @@ write_psml_preamble(column_info *cinfo, FILE *fh)
 
     for (i = 0; i < cinfo->num_cols; i++) {
         fprintf(fh, "<section>");
-        print_escaped_xml(fh, cinfo->col_title[i]);
+        buf = packet_get_buf();
+        print_escaped_xml(buf, cinfo->col_title[i]);
+        fwrite(buf->str, 1, buf->len, fh);
         fprintf(fh, "</section>\n");
     }
 
@@ -599,18 +655,27 @@ write_psml_preamble(column_info *cinfo, FILE *fh)
 
 void
 write_psml_columns(epan_dissect_t *edt, FILE *fh)
+{
+    GString *buf = packet_get_buf();
+
+    write_psml_columns_buf(edt, buf);
+    fwrite(buf->str, 1, buf->len, fh);
+}
+
+void
+write_psml_columns_buf(epan_dissect_t *edt, GString *buf)
 {
     gint i;
 
-    fprintf(fh, "<packet>\n");
+    g_string_append(buf, "<packet>\n");
 
     for (i = 0; i < edt->pi.cinfo->num_cols; i++) {
-        fprintf(fh, "<section>");
-        print_escaped_xml(fh, edt->pi.cinfo->col_data[i]);
-        fprintf(fh, "</section>\n");
+        g_string_append(buf, "<section>");
+        print_escaped_xml(buf, edt->pi.cinfo->col_data[i]);
+        g_string_append(buf, "</section>\n");
     }
 
-    fprintf(fh, "</packet>\n\n");
+    g_string_append(buf, "</packet>\n\n");
 }
 
 void
@@ -619,6 +684,394 @@ write_psml_finale(FILE *fh)
     fputs("</psml>\n", fh);
 }
 
+/*
+ * JSON and Elasticsearch bulk ("ek") output.
+ *
+ * Each packet is built up in a buffer that's kept from one packet to
+ * the next and written with a single fwrite(); numbers are formatted and
+ * strings escaped straight into it, so nothing is allocated per item
+ * other than for the string representations of large values.
+ */
+typedef struct {
+    GString        *buf;
+    int             level;
+    gboolean        first;      /* nothing written in the current object yet */
+} write_json_data;
+
+static gboolean  json_first_packet;
+
+static const char json_indent[] =
+    "                                                                ";
+
+static void
+json_write_indent(GString *buf, int level)
+{
+    gsize len = 2 * (gsize)level;
+
+    while (len > sizeof json_indent - 1) {
+        g_string_append_len(buf, json_indent, sizeof json_indent - 1);
+        len -= sizeof json_indent - 1;
+    }
+    g_string_append_len(buf, json_indent, len);
+}
+
+/* Write a string, escaping it in runs rather than a character at a time */
+static void
+json_write_string(GString *buf, const char *str)
+{
+    static const char hex[] = "0123456789abcdef";
+    const guchar *p, *run;
+    char esc[6];
+
+    g_string_append_c(buf, '"');
+    for (p = run = (const guchar *)str; *p != '\0'; p++) {
+        if (*p >= 0x20 && *p != '"' && *p != '\\')
+            continue;
+        g_string_append_len(buf, (const char *)run, p - run);
+        run = p + 1;
+        switch (*p) {
+        case '"':
+            g_string_append_len(buf, "\\\"", 2);
+            break;
+        case '\\':
+            g_string_append_len(buf, "\\\\", 2);
+            break;
+        case '\n':
+            g_string_append_len(buf, "\\n", 2);
+            break;
+        case '\r':
+            g_string_append_len(buf, "\\r", 2);
+            break;
+        case '\t':
+            g_string_append_len(buf, "\\t", 2);
+            break;
+        default:
+            esc[0] = '\\';
+            esc[1] = 'u';
+            esc[2] = '0';
+            esc[3] = '0';
+            esc[4] = hex[*p >> 4];
+            esc[5] = hex[*p & 0xf];
+            g_string_append_len(buf, esc, 6);
+            break;
+        }
+    }
+    g_string_append_len(buf, (const char *)run, p - run);
+    g_string_append_c(buf, '"');
+}
+
+static void
+json_write_uint64(GString *buf, guint64 value)
+{
+    char  num[20];
+    char *p = num + sizeof num;
+
+    do {
+        *--p = '0' + (char)(value % 10);
+        value /= 10;
+    } while (value != 0);
+    g_string_append_len(buf, p, num + sizeof num - p);
+}
+
+static void
+json_write_int64(GString *buf, gint64 value)
+{
+    if (value < 0) {
+        g_string_append_c(buf, '-');
+        json_write_uint64(buf, -(guint64)value);
+    } else {
+        json_write_uint64(buf, (guint64)value);
+    }
+}
+
+/*
+ * Write a field's value: integers as numbers, and everything else as
+ * its display string.
+ */
+static void
+json_write_field_value(GString *buf, field_info *fi)
+{
+    char  repr[256];
+    char *str;
+    int   len;
+
+    switch (fi->hfinfo->type) {
+
+    case FT_NONE:
+    case FT_PROTOCOL:
+        g_string_append_len(buf, "\"\"", 2);
+        return;
+
+    case FT_BOOLEAN:
+        g_string_append_c(buf, fvalue_get_uinteger(&fi->value) ? '1' : '0');
+        return;
+
+    case FT_UINT8:
+    case FT_UINT16:
+    case FT_UINT24:
+    case FT_UINT32:
+    case FT_FRAMENUM:
+        json_write_uint64(buf, fvalue_get_uinteger(&fi->value));
+        return;
+
+    case FT_INT8:
+    case FT_INT16:
+    case FT_INT24:
+    case FT_INT32:
+        json_write_int64(buf, fvalue_get_sinteger(&fi->value));
+        return;
+
+    case FT_UINT64:
+        json_write_uint64(buf, fvalue_get_integer64(&fi->value));
+        return;
+
+    case FT_INT64:
+        json_write_int64(buf, (gint64)fvalue_get_integer64(&fi->value));
+        return;
+
+    default:
+        break;
+    }
+
+    if (fi->value.ftype->val_to_string_repr == NULL ||
+        (len = fvalue_string_repr_len(&fi->value, FTREPR_DISPLAY, fi->hfinfo->display)) < 0) {
+        g_string_append_len(buf, "\"\"", 2);
+        return;
+    }
+    if (len < (int)sizeof repr) {
+        repr[len] = '\0';
+        str = fvalue_to_string_repr(&fi->value, FTREPR_DISPLAY, fi->hfinfo->display, repr);
+        json_write_string(buf, str);
+    } else {
+        str = fvalue_to_string_repr(&fi->value, FTREPR_DISPLAY, fi->hfinfo->display, NULL);
+        json_write_string(buf, str);
+        g_free(str);
+    }
+}
+
+/* Start a member of the current object, and write its name */
+static void
+json_write_member(write_json_data *pdata, const char *name)
+{
+    if (!pdata->first)
+        g_string_append_c(pdata->buf, ',');
+    g_string_append_c(pdata->buf, '\n');
+    pdata->first = FALSE;
+    json_write_indent(pdata->buf, pdata->level);
+    json_write_string(pdata->buf, name);
+    g_string_append_len(pdata->buf, ": ", 2);
+}
+
+static void proto_tree_write_node_json(proto_node *node, gpointer data);
+
+/* Write a node's children as the members of an object */
+static void
+json_write_children(write_json_data *pdata, proto_node *node)
+{
+    g_string_append_c(pdata->buf, '{');
+    pdata->level++;
+    pdata->first = TRUE;
+    proto_tree_children_foreach(node, proto_tree_write_node_json, pdata);
+    pdata->level--;
+    if (!pdata->first) {
+        g_string_append_c(pdata->buf, '\n');
+        json_write_indent(pdata->buf, pdata->level);
+    }
+    g_string_append_c(pdata->buf, '}');
+    pdata->first = FALSE;
+}
+
+/*
+ * Write out a tree's data, and any child nodes, as JSON.  A protocol is
+ * an object of its items; any other item is its value, followed, if it
+ * has a subtree, by "<name>_tree", an object of the items in that.
+ */
+static void
+proto_tree_write_node_json(proto_node *node, gpointer data)
+{
+    field_info      *fi    = PNODE_FINFO(node);
+    write_json_data *pdata = (write_json_data *)data;
+    const char      *name;
+
+    /* dissection with an invisible proto tree? */
+    g_assert(fi);
+
+    if (fi->hfinfo->type == FT_PROTOCOL) {
+        json_write_member(pdata, fi->hfinfo->abbrev);
+        json_write_children(pdata, node);
+        return;
+    }
+
+    if (fi->hfinfo->id == hf_text_only) {
+        name = "text";
+        json_write_member(pdata, name);
+        json_write_string(pdata->buf, fi->rep ? fi->rep->representation : "");
+    } else {
+        name = fi->hfinfo->abbrev;
+        json_write_member(pdata, name);
+        json_write_field_value(pdata->buf, fi);
+    }
+
+    if (node->first_child != NULL) {
+        g_string_append_c(pdata->buf, ',');
+        g_string_append_c(pdata->buf, '\n');
+        json_write_indent(pdata->buf, pdata->level);
+        g_string_append_c(pdata->buf, '"');
+        g_string_append(pdata->buf, name);
+        g_string_append_len(pdata->buf, "_tree\": ", 8);
+        json_write_children(pdata, node);
+    }
+}
+
+/*
+ * Get the name of the index for a packet: "packets-YYYY-MM-DD", for the
+ * day it was captured, in UTC.  It's only worked out again when the day
+ * changes.
+ */
+static const char *
+json_index_name(const nstime_t *ts)
+{
+    static char    index_name[sizeof "packets-YYYY-MM-DD" + 8];
+    static time_t  index_day = -1;
+    time_t         day = ts->secs >= 0 ? ts->secs / 86400 : -1;
+    time_t         secs;
+    struct tm     *tm;
+
+    if (day != index_day || index_name[0] == '\0') {
+        secs = day * 86400;
+        tm = gmtime(&secs);
+        if (tm != NULL)
+            strftime(index_name, sizeof index_name, "packets-%Y-%m-%d", tm);
+        else
+            g_strlcpy(index_name, "packets", sizeof index_name);
+        index_day = day;
+    }
+    return index_name;
+}
+
+void
+write_json_preamble(FILE *fh)
+{
+    fputs("[\n", fh);
+    json_first_packet = TRUE;
+}
+
+void
+write_json_proto_tree(epan_dissect_t *edt, FILE *fh)
+{
+    write_json_data data;
+    GString        *buf = packet_get_buf();
+
+    if (!json_first_packet)
+        g_string_append_len(buf, ",\n", 2);
+    json_first_packet = FALSE;
+
+    g_string_append(buf, "  {\n    \"_index\": ");
+    json_write_string(buf, json_index_name(&edt->pi.fd->abs_ts));
+    g_string_append(buf, ",\n    \"_type\": \"pcap_file\",\n"
+                         "    \"_score\": null,\n"
+                         "    \"_source\": {\n"
+                         "      \"layers\": ");
+
+    data.buf   = buf;
+    data.level = 3;
+    data.first = TRUE;
+    json_write_children(&data, edt->tree);
+
+    g_string_append(buf, "\n    }\n  }");
+    fwrite(buf->str, 1, buf->len, fh);
+}
+
+void
+write_json_finale(FILE *fh)
+{
+    fputs("\n]\n", fh);
+}
+
+/*
+ * Write the items under a protocol as members of one flat object, named
+ * "<protocol>_<field>", with the dots in field names changed to
+ * underscores, as Elasticsearch wants.
+ */
+static void
+proto_tree_write_node_ek(proto_node *node, gpointer data)
+{
+    field_info      *fi    = PNODE_FINFO(node);
+    write_json_data *pdata = (write_json_data *)data;
+    GString         *buf   = pdata->buf;
+    const char      *p;
+
+    /* dissection with an invisible proto tree? */
+    g_assert(fi);
+
+    /* Protocols inside protocols, and items with no value, just hold items */
+    if (fi->hfinfo->type != FT_PROTOCOL && fi->hfinfo->type != FT_NONE &&
+        fi->hfinfo->id != hf_text_only) {
+        if (!pdata->first)
+            g_string_append_c(buf, ',');
+        pdata->first = FALSE;
+        g_string_append_c(buf, '"');
+        for (p = fi->hfinfo->abbrev; *p != '\0'; p++)
+            g_string_append_c(buf, *p == '.' ? '_' : *p);
+        g_string_append_len(buf, "\": ", 3);
+        json_write_field_value(buf, fi);
+    }
+
+    if (node->first_child != NULL)
+        proto_tree_children_foreach(node, proto_tree_write_node_ek, pdata);
+}
+
+static void
+proto_tree_write_layer_ek(proto_node *node, gpointer data)
+{
+    field_info      *fi    = PNODE_FINFO(node);
+    write_json_data *pdata = (write_json_data *)data;
+    GString         *buf   = pdata->buf;
+    write_json_data  layer;
+
+    /* dissection with an invisible proto tree? */
+    g_assert(fi);
+
+    if (!pdata->first)
+        g_string_append_c(buf, ',');
+    pdata->first = FALSE;
+    g_string_append_c(buf, '"');
+    g_string_append(buf, fi->hfinfo->abbrev);
+    g_string_append_len(buf, "\": {", 4);
+
+    layer.buf   = buf;
+    layer.level = 0;
+    layer.first = TRUE;
+    if (fi->hfinfo->type != FT_PROTOCOL)
+        proto_tree_write_node_ek(node, &layer);
+    else
+        proto_tree_children_foreach(node, proto_tree_write_node_ek, &layer);
+    g_string_append_c(buf, '}');
+}
+
+void
+write_ek_proto_tree(epan_dissect_t *edt, FILE *fh)
+{
+    write_json_data data;
+    GString        *buf = packet_get_buf();
+    const nstime_t *ts  = &edt->pi.fd->abs_ts;
+
+    /* The bulk API action, then the document, each on a line */
+    g_string_append(buf, "{\"index\": {\"_index\": ");
+    json_write_string(buf, json_index_name(ts));
+    g_string_append(buf, ", \"_type\": \"pcap_file\"}}\n{\"timestamp\": \"");
+    json_write_int64(buf, (gint64)ts->secs * 1000 + ts->nsecs / 1000000);
+    g_string_append(buf, "\", \"layers\": {");
+
+    data.buf   = buf;
+    data.level = 0;
+    data.first = TRUE;
+    proto_tree_children_foreach(edt->tree, proto_tree_write_layer_ek, &data);
+
+    g_string_append_len(buf, "}}\n", 3);
+    fwrite(buf->str, 1, buf->len, fh);
+}
+
 static gchar *csv_massage_str(const gchar *source, const gchar *exceptions)
 {
     gchar *csv_str;
@@ -641,34 +1094,48 @@ static gchar *csv_massage_str(const gchar *source, const gchar *exceptions)
     return csv_str;
 }
 
-static void csv_write_str(const char *str, char sep, FILE *fh)
+static void csv_write_str(const char *str, char sep, GString *buf)
 {
     gchar *csv_str;
 
     /* Do not escape the UTF-8 righ arrow character */
     csv_str = csv_massage_str(str, "\xe2\x86\x92");
-    fprintf(fh, "\"%s\"%c", csv_str, sep);
+    g_string_append_c(buf, '"');
+    g_string_append(buf, csv_str);
+    g_string_append_c(buf, '"');
+    g_string_append_c(buf, sep);
     g_free(csv_str);
 }
 
 void
 write_csv_column_titles(column_info *cinfo, FILE *fh)
 {
-    gint i;
+    gint     i;
+    GString *buf = packet_get_buf();
 
     for (i = 0; i < cinfo->num_cols - 1; i++)
-        csv_write_str(cinfo->col_title[i], ',', fh);
-    csv_write_str(cinfo->col_title[i], '\n', fh);
+        csv_write_str(cinfo->col_title[i], ',', buf);
+    csv_write_str(cinfo->col_title[i], '\n', buf);
+    fwrite(buf->str, 1, buf->len, fh);
 }
 
 void
 write_csv_columns(epan_dissect_t *edt, FILE *fh)
+{
+    GString *buf = packet_get_buf();
+
+    write_csv_columns_buf(edt, buf);
+    fwrite(buf->str, 1, buf->len, fh);
+}
+
+void
+write_csv_columns_buf(epan_dissect_t *edt, GString *buf)
 {
     gint i;
 
     for (i = 0; i < edt->pi.cinfo->num_cols - 1; i++)
-        csv_write_str(edt->pi.cinfo->col_data[i], ',', fh);
-    csv_write_str(edt->pi.cinfo->col_data[i], '\n', fh);
+        csv_write_str(edt->pi.cinfo->col_data[i], ',', buf);
+    csv_write_str(edt->pi.cinfo->col_data[i], '\n', buf);
 }
 
 void
@@ -782,52 +1249,66 @@ get_field_data(GSList *src_list, field_info *fi)
 }
 
 /* Print a string, escaping out certain characters that need to
- * escaped out for XML. */
+ * escaped out for XML; runs of characters that don't are copied as is. */
 static void
-print_escaped_xml(FILE *fh, const char *unescaped_string)
+print_escaped_xml(GString *buf, const char *unescaped_string)
 {
     const char *p;
-    char        temp_str[8];
+    const char *run;
 
-    for (p = unescaped_string; *p != '\0'; p++) {
+    for (p = run = unescaped_string; *p != '\0'; p++) {
         switch (*p) {
         case '&':
-            fputs("&amp;", fh);
+        case '<':
+        case '>':
+        case '"':
+        case '\'':
+            break;
+        default:
+            if (g_ascii_isprint(*p))
+                continue;
+            break;
+        }
+
+        if (p != run)
+            g_string_append_len(buf, run, p - run);
+        run = p + 1;
+
+        switch (*p) {
+        case '&':
+            g_string_append(buf, "&amp;");
             break;
         case '<':
-            fputs("&lt;", fh);
+            g_string_append(buf, "&lt;");
             break;
         case '>':
-            fputs("&gt;", fh);
+            g_string_append(buf, "&gt;");
             break;
         case '"':
-            fputs("&quot;", fh);
+            g_string_append(buf, "&quot;");
             break;
         case '\'':
-            fputs("&#x27;", fh);
+            g_string_append(buf, "&#x27;");
             break;
         default:
-            if (g_ascii_isprint(*p))
-                fputc(*p, fh);
-            else {
-                g_snprintf(temp_str, sizeof(temp_str), "\\x%x", (guint8)*p);
-                fputs(temp_str, fh);
-            }
+            g_string_append_printf(buf, "\\x%x", (guint8)*p);
         }
     }
+    if (p != run)
+        g_string_append_len(buf, run, p - run);
 }
 
 static void
 pdml_write_field_hex_value(write_pdml_data *pdata, field_info *fi)
 {
-    int           i;
     const guint8 *pd;
+    gsize         pos;
 
     if (!fi->ds_tvb)
         return;
 
     if (fi->length > tvb_length_remaining(fi->ds_tvb, fi->start)) {
-        fprintf(pdata->fh, "field length invalid!");
+        g_string_append(pdata->buf, "field length invalid!");
         return;
     }
 
@@ -836,9 +1317,9 @@ pdml_write_field_hex_value(write_pdml_data *pdata, field_info *fi)
 
     if (pd) {
         /* Print a simple hex dump */
-        for (i = 0 ; i < fi->length; i++) {
-            fprintf(pdata->fh, "%02x", pd[i]);
-        }
+        pos = pdata->buf->len;
+        g_string_set_size(pdata->buf, pos + 2 * fi->length);
+        bytes_to_hexstr(pdata->buf->str + pos, pd, fi->length);
     }
 }
 
@@ -1002,15 +1483,17 @@ void output_fields_free(output_fields_t* fields)
     if (NULL != fields->fields) {
         gsize i;
 
-        if (NULL != fields->field_indicies) {
-            /* Keys are stored in fields->fields, values are
-             * integers.
-             */
-            g_hash_table_destroy(fields->field_indicies);
+        if (NULL != fields->plan) {
+            for (i = 0; i < fields->fields->len; ++i) {
+                g_array_free(fields->plan[i].hfs, TRUE);
+                if (NULL != fields->plan[i].cols)
+                    g_array_free(fields->plan[i].cols, TRUE);
+            }
+            g_free(fields->plan);
         }
 
-        if (NULL != fields->field_values) {
-            g_free(fields->field_values);
+        if (NULL != fields->line) {
+            g_string_free(fields->line, TRUE);
         }
 
         for(i = 0; i < fields->fields->len; ++i) {
@@ -1201,6 +1684,28 @@ gboolean output_fields_has_cols(output_fields_t* fields)
     return fields->includes_col_fields;
 }
 
+gboolean output_fields_need_labels(output_fields_t* fields)
+{
+    gsize              i;
+    header_field_info *hfinfo;
+
+    g_assert(fields);
+
+    /* Columns, protocols and text items are written using their text */
+    if (fields->includes_col_fields)
+        return TRUE;
+
+    if (fields->fields == NULL)
+        return FALSE;
+
+    for (i = 0; i < fields->fields->len; i++) {
+        hfinfo = proto_registrar_get_byname((const gchar *)g_ptr_array_index(fields->fields, i));
+        if (hfinfo == NULL || hfinfo->id == hf_text_only || hfinfo->type == FT_PROTOCOL)
+            return TRUE;
+    }
+    return FALSE;
+}
+
 void write_fields_preamble(output_fields_t* fields, FILE *fh)
 {
     gsize i;
@@ -1223,165 +1728,540 @@ void write_fields_preamble(output_fields_t* fields, FILE *fh)
     fputc('\n', fh);
 }
 
-static void format_field_values(output_fields_t* fields, gpointer field_index, const gchar* value)
+static output_field_format_e
+output_field_format(header_field_info *hfinfo)
 {
-    guint      indx;
-    GPtrArray* fv_p;
+    if (hfinfo->id == hf_text_only || hfinfo->id == proto_data)
+        return OUTPUT_FIELD_NODE;
+
+    switch (hfinfo->type) {
+    case FT_UINT8:
+    case FT_UINT16:
+    case FT_UINT24:
+    case FT_UINT32:
+    case FT_FRAMENUM:
+        return OUTPUT_FIELD_UINT;
+    case FT_INT8:
+    case FT_INT16:
+    case FT_INT24:
+    case FT_INT32:
+        return OUTPUT_FIELD_INT;
+    case FT_UINT64:
+        return OUTPUT_FIELD_UINT64;
+    case FT_INT64:
+        return OUTPUT_FIELD_INT64;
+    case FT_BOOLEAN:
+        return OUTPUT_FIELD_BOOLEAN;
+    case FT_NONE:
+        return OUTPUT_FIELD_NONE;
+    case FT_PROTOCOL:
+        return OUTPUT_FIELD_NODE;
+    default:
+        return OUTPUT_FIELD_REPR;
+    }
+}
 
-    if ((NULL == value) || ('\0' == *value))
+/*
+ * Compile the list of fields into a plan: the field IDs to get the
+ * items of, and how to write each of their values.
+ */
+static void
+output_fields_make_plan(output_fields_t *fields)
+{
+    gsize              i;
+    const gchar       *field;
+    header_field_info *hfinfo;
+    output_field_hf_t  hf;
+
+    if (NULL != fields->plan)
         return;
 
-    /* Unwrap change made to disambiguiate zero / null */
-    indx = GPOINTER_TO_UINT(field_index) - 1;
+    fields->plan = g_new0(output_field_plan_t, fields->fields->len);
+    for (i = 0; i < fields->fields->len; i++) {
+        field = (const gchar *)g_ptr_array_index(fields->fields, i);
+        fields->plan[i].hfs = g_array_new(FALSE, FALSE, sizeof(output_field_hf_t));
+        if (!strncmp(field, COLUMN_FIELD_FILTER, strlen(COLUMN_FIELD_FILTER))) {
+            fields->plan[i].cols = g_array_new(FALSE, FALSE, sizeof(gint));
+            continue;
+        }
 
-    if (fields->field_values[indx] == NULL) {
-        fields->field_values[indx] = g_ptr_array_new();
+        /* Several fields can be registered with the same name */
+        hfinfo = proto_registrar_get_byname(field);
+        for (; hfinfo != NULL; hfinfo = hfinfo->same_name_next) {
+            hf.hfid = hfinfo->id;
+            hf.format = output_field_format(hfinfo);
+            g_array_append_val(fields->plan[i].hfs, hf);
+        }
     }
+}
 
-    /* Essentially: fieldvalues[indx] is a 'GPtrArray *' with each array entry */
-    /*  pointing to a string which is (part of) the final output string.       */
+void
+output_fields_prime_edt(output_fields_t *fields, epan_dissect_t *edt)
+{
+    gsize  i;
+    guint  j;
 
-    fv_p = fields->field_values[indx];
+    g_assert(fields);
+    g_assert(fields->fields);
 
-    switch (fields->occurrence) {
-    case 'f':
-        /* print the value of only the first occurrence of the field */
-        if (g_ptr_array_len(fv_p) != 0)
-            return;
-        break;
-    case 'l':
-        /* print the value of only the last occurrence of the field */
-        g_ptr_array_set_size(fv_p, 0);
-        break;
-    case 'a':
-        /* print the value of all accurrences of the field */
-        /* If not the first, add the 'aggregator' */
-        if (g_ptr_array_len(fv_p) > 0) {
-            g_ptr_array_add(fv_p, (gpointer)g_strdup_printf("%c", fields->aggregator));
+    output_fields_make_plan(fields);
+    for (i = 0; i < fields->fields->len; i++) {
+        for (j = 0; j < fields->plan[i].hfs->len; j++) {
+            proto_tree_prime_hfid(edt->tree,
+                g_array_index(fields->plan[i].hfs, output_field_hf_t, j).hfid);
         }
-        break;
-    default:
-        g_assert_not_reached();
-        break;
     }
+}
+
+static void
+output_fields_resolve_cols(output_fields_t *fields, column_info *cinfo)
+{
+    gsize        i;
+    gint         col;
+    const gchar *field;
 
-    g_ptr_array_add(fv_p, (gpointer)value);
+    for (i = 0; i < fields->fields->len; i++) {
+        if (NULL == fields->plan[i].cols)
+            continue;
+        field = (const gchar *)g_ptr_array_index(fields->fields, i) + strlen(COLUMN_FIELD_FILTER);
+        for (col = 0; col < cinfo->num_cols; col++) {
+            if (!strcmp(field, cinfo->col_title[col]))
+                g_array_append_val(fields->plan[i].cols, col);
+        }
+    }
+    fields->cols_resolved = TRUE;
 }
 
-static void proto_tree_get_node_field_values(proto_node *node, gpointer data)
+void
+output_fields_set_cols_used(output_fields_t *fields, column_info *cinfo)
 {
-    write_field_data_t *call_data;
-    field_info *fi;
-    gpointer    field_index;
+    gsize i;
+    guint j;
 
-    call_data = (write_field_data_t *)data;
-    fi = PNODE_FINFO(node);
+    g_assert(fields);
+    g_assert(fields->fields);
 
-    /* dissection with an invisible proto tree? */
-    g_assert(fi);
+    output_fields_make_plan(fields);
+    if (!fields->cols_resolved)
+        output_fields_resolve_cols(fields, cinfo);
 
-    field_index = g_hash_table_lookup(call_data->fields->field_indicies, fi->hfinfo->abbrev);
-    if (NULL != field_index) {
-        format_field_values(call_data->fields, field_index,
-                            get_node_field_value(fi, call_data->edt) /* g_ alloc'd string */
-            );
+    col_set_all_used(cinfo, FALSE);
+    for (i = 0; i < fields->fields->len; i++) {
+        if (NULL == fields->plan[i].cols)
+            continue;
+        for (j = 0; j < fields->plan[i].cols->len; j++)
+            col_set_used(cinfo, g_array_index(fields->plan[i].cols, gint, j), TRUE);
     }
+}
 
-    /* Recurse here. */
-    if (node->first_child != NULL) {
-        proto_tree_children_foreach(node, proto_tree_get_node_field_values,
-                                    call_data);
+static void
+output_fields_append_uint64(GString *line, guint64 value)
+{
+    char  num[20];
+    char *p = num + sizeof num;
+
+    do {
+        *--p = '0' + (char)(value % 10);
+        value /= 10;
+    } while (value != 0);
+    g_string_append_len(line, p, num + sizeof num - p);
+}
+
+static void
+output_fields_append_int64(GString *line, gint64 value)
+{
+    if (value < 0) {
+        g_string_append_c(line, '-');
+        output_fields_append_uint64(line, -(guint64)value);
+    } else {
+        output_fields_append_uint64(line, (guint64)value);
     }
 }
 
+/* Append the value of an item; returns FALSE if it has none */
+static gboolean
+output_fields_append_value(GString *line, field_info *fi,
+                           output_field_format_e format, epan_dissect_t *edt)
+{
+    char   repr[256];
+    gchar *str;
+    int    len;
+
+    switch (format) {
+    case OUTPUT_FIELD_UINT:
+        output_fields_append_uint64(line, fvalue_get_uinteger(&fi->value));
+        return TRUE;
+    case OUTPUT_FIELD_INT:
+        output_fields_append_int64(line, fvalue_get_sinteger(&fi->value));
+        return TRUE;
+    case OUTPUT_FIELD_UINT64:
+        output_fields_append_uint64(line, fvalue_get_integer64(&fi->value));
+        return TRUE;
+    case OUTPUT_FIELD_INT64:
+        output_fields_append_int64(line, (gint64)fvalue_get_integer64(&fi->value));
+        return TRUE;
+    case OUTPUT_FIELD_BOOLEAN:
+        g_string_append_c(line, fvalue_get_uinteger(&fi->value) ? '1' : '0');
+        return TRUE;
+    case OUTPUT_FIELD_NONE:
+        g_string_append_c(line, '1');
+        return TRUE;
+    case OUTPUT_FIELD_REPR:
+        if (fi->value.ftype->val_to_string_repr != NULL &&
+            fi->value.ftype->len_string_repr != NULL &&
+            (len = fvalue_string_repr_len(&fi->value, FTREPR_DISPLAY, fi->hfinfo->display)) >= 0 &&
+            len < (int)sizeof repr) {
+            repr[len] = '\0';
+            fvalue_to_string_repr(&fi->value, FTREPR_DISPLAY, fi->hfinfo->display, repr);
+            if (repr[0] == '\0')
+                return FALSE;
+            g_string_append(line, repr);
+            return TRUE;
+        }
+        break;
+    case OUTPUT_FIELD_NODE:
+        break;
+    }
+
+    str = get_node_field_value(fi, edt);
+    if (str == NULL || *str == '\0') {
+        g_free(str);
+        return FALSE;
+    }
+    g_string_append(line, str);
+    g_free(str);
+    return TRUE;
+}
+
+/*
+ * Append the values of one of the fields, as the occurrence option says.
+ * Returns the number of values appended.
+ */
+static guint
+output_fields_append_field(output_fields_t *fields, output_field_plan_t *plan,
+                           epan_dissect_t *edt)
+{
+    GString           *line   = fields->line;
+    guint              nvals  = 0;
+    guint              h, f, n;
+    gsize              pos;
+    output_field_hf_t *hf;
+    GPtrArray         *finfos;
+
+    for (h = 0; h < plan->hfs->len; h++) {
+        /* For the last occurrence, go through them backwards */
+        hf = &g_array_index(plan->hfs, output_field_hf_t,
+                            fields->occurrence == 'l' ? plan->hfs->len - 1 - h : h);
+        finfos = proto_get_finfo_ptr_array(edt->tree, hf->hfid);
+        if (finfos == NULL)
+            continue;
+        for (f = 0; f < finfos->len; f++) {
+            n = fields->occurrence == 'l' ? finfos->len - 1 - f : f;
+            pos = line->len;
+            if (nvals != 0)
+                g_string_append_c(line, fields->aggregator);
+            if (!output_fields_append_value(line, (field_info *)g_ptr_array_index(finfos, n),
+                                            hf->format, edt)) {
+                g_string_truncate(line, pos);
+                continue;
+            }
+            nvals++;
+            if (fields->occurrence != 'a')
+                return nvals;
+        }
+    }
+    return nvals;
+}
+
+/*
+ * Append the values of a "_ws.col." field's columns after the nvals
+ * values of the field that start at "start" in the line, as the
+ * occurrence option says.  Returns the number of values there are now.
+ */
+static guint
+output_fields_append_cols(output_fields_t *fields, output_field_plan_t *plan,
+                          column_info *cinfo, gsize start, guint nvals)
+{
+    guint        c;
+    const gchar *col_data;
+
+    for (c = 0; c < plan->cols->len; c++) {
+        col_data = cinfo->col_data[g_array_index(plan->cols, gint, c)];
+        if (col_data == NULL || *col_data == '\0')
+            continue;
+        if (nvals != 0) {
+            if (fields->occurrence == 'f')
+                break;
+            if (fields->occurrence == 'l')
+                g_string_truncate(fields->line, start);
+            else
+                g_string_append_c(fields->line, fields->aggregator);
+        }
+        g_string_append(fields->line, col_data);
+        nvals++;
+    }
+    return nvals;
+}
+
 void write_fields_proto_tree(output_fields_t *fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh)
 {
     gsize     i;
-    gint      col;
-    gchar    *col_name;
-    gpointer  field_index;
-
-    write_field_data_t data;
+    gsize     start;
+    guint     nvals;
+    GString  *line;
+    output_field_plan_t *plan;
 
     g_assert(fields);
     g_assert(fields->fields);
     g_assert(edt);
     g_assert(fh);
 
-    data.fields = fields;
-    data.edt = edt;
+    output_fields_make_plan(fields);
+    if (fields->includes_col_fields && !fields->cols_resolved)
+        output_fields_resolve_cols(fields, cinfo);
 
-    if (NULL == fields->field_indicies) {
-        /* Prepare a lookup table from string abbreviation for field to its index. */
-        fields->field_indicies = g_hash_table_new(g_str_hash, g_str_equal);
+    if (NULL == fields->line)
+        fields->line = g_string_sized_new(256);
+    line = fields->line;
+    g_string_truncate(line, 0);
 
-        i = 0;
-        while (i < fields->fields->len) {
-            gchar *field = (gchar *)g_ptr_array_index(fields->fields, i);
-            /* Store field indicies +1 so that zero is not a valid value,
-             * and can be distinguished from NULL as a pointer.
-             */
-            ++i;
-            g_hash_table_insert(fields->field_indicies, field, GUINT_TO_POINTER(i));
+    for (i = 0; i < fields->fields->len; ++i) {
+        plan = &fields->plan[i];
+        if (0 != i) {
+            g_string_append_c(line, fields->separator);
+        }
+        start = line->len;
+        if (fields->quote != '\0') {
+            g_string_append_c(line, fields->quote);
+        }
+
+        nvals = output_fields_append_field(fields, plan, edt);
+        if (NULL != plan->cols) {
+            nvals = output_fields_append_cols(fields, plan, cinfo,
+                                              start + (fields->quote != '\0'), nvals);
+        }
+
+        if (nvals == 0) {
+            /* Nothing, not even quotes */
+            g_string_truncate(line, start);
+        } else if (fields->quote != '\0') {
+            g_string_append_c(line, fields->quote);
         }
     }
 
-    /* Array buffer to store values for this packet              */
-    /*  Allocate an array for the 'GPtrarray *' the first time   */
-    /*   ths function is invoked for a file;                     */
-    /*  Any and all 'GPtrArray *' are freed (after use) each     */
-    /*   time (each packet) this function is invoked for a flle. */
-    /* XXX: ToDo: use packet-scope'd memory & (if/when implemented) wmem ptr_array */
-    if (NULL == fields->field_values)
-        fields->field_values = g_new0(GPtrArray*, fields->fields->len);  /* free'd in output_fields_free() */
+    fwrite(line->str, 1, line->len, fh);
+}
 
-    proto_tree_children_foreach(edt->tree, proto_tree_get_node_field_values,
-                                &data);
+void write_fields_finale(output_fields_t* fields _U_ , FILE *fh _U_)
+{
+    /* Nothing to do */
+}
 
-    if (fields->includes_col_fields) {
-        for (col = 0; col < cinfo->num_cols; col++) {
-            /* Prepend COLUMN_FIELD_FILTER as the field name */
-            col_name = g_strdup_printf("%s%s", COLUMN_FIELD_FILTER, cinfo->col_title[col]);
-            field_index = g_hash_table_lookup(fields->field_indicies, col_name);
-            g_free(col_name);
+/*
+ * The type of a field's Arrow column: its own type if it has one, or
+ * else the strings -T fields would write for it.  Fields registered
+ * with the same name must all have the same type to get a column of it.
+ */
+static arrow_type_e
+output_field_arrow_type(output_field_plan_t *plan, guint *width)
+{
+    header_field_info *hfinfo;
+    guint              h;
+
+    *width = 0;
+    if (plan->hfs->len == 0 ||
+        g_array_index(plan->hfs, output_field_hf_t, 0).format == OUTPUT_FIELD_NODE)
+        return ARROW_TYPE_UTF8;
+
+    hfinfo = proto_registrar_get_nth(g_array_index(plan->hfs, output_field_hf_t, 0).hfid);
+    for (h = 1; h < plan->hfs->len; h++) {
+        if (proto_registrar_get_nth(g_array_index(plan->hfs, output_field_hf_t, h).hfid)->type != hfinfo->type)
+            return ARROW_TYPE_UTF8;
+    }
 
-            if (NULL != field_index) {
-                format_field_values(fields, field_index, g_strdup(cinfo->col_data[col]));
-            }
-        }
+    switch (hfinfo->type) {
+    case FT_BOOLEAN:
+    case FT_NONE:
+        return ARROW_TYPE_BOOL;
+    case FT_UINT8:
+        return ARROW_TYPE_UINT8;
+    case FT_UINT16:
+        return ARROW_TYPE_UINT16;
+    case FT_UINT24:
+    case FT_UINT32:
+    case FT_FRAMENUM:
+        return ARROW_TYPE_UINT32;
+    case FT_UINT64:
+        return ARROW_TYPE_UINT64;
+    case FT_INT8:
+        return ARROW_TYPE_INT8;
+    case FT_INT16:
+        return ARROW_TYPE_INT16;
+    case FT_INT24:
+    case FT_INT32:
+        return ARROW_TYPE_INT32;
+    case FT_INT64:
+        return ARROW_TYPE_INT64;
+    case FT_FLOAT:
+    case FT_DOUBLE:
+        return ARROW_TYPE_DOUBLE;
+    case FT_ABSOLUTE_TIME:
+        return ARROW_TYPE_TIMESTAMP_NS;
+    case FT_RELATIVE_TIME:
+        return ARROW_TYPE_DURATION_NS;
+    case FT_IPv4:
+        *width = 4;
+        return ARROW_TYPE_FIXED_BINARY;
+    case FT_IPv6:
+        *width = 16;
+        return ARROW_TYPE_FIXED_BINARY;
+    case FT_ETHER:
+        *width = 6;
+        return ARROW_TYPE_FIXED_BINARY;
+    default:
+        return ARROW_TYPE_UTF8;
     }
+}
 
-    for(i = 0; i < fields->fields->len; ++i) {
-        if (0 != i) {
-            fputc(fields->separator, fh);
+/* The first item of a field, or the last if the occurrence option says so */
+static field_info *
+output_fields_get_item(output_fields_t *fields, output_field_plan_t *plan,
+                       epan_dissect_t *edt)
+{
+    guint              h;
+    output_field_hf_t *hf;
+    GPtrArray         *finfos;
+
+    for (h = 0; h < plan->hfs->len; h++) {
+        hf = &g_array_index(plan->hfs, output_field_hf_t,
+                            fields->occurrence == 'l' ? plan->hfs->len - 1 - h : h);
+        finfos = proto_get_finfo_ptr_array(edt->tree, hf->hfid);
+        if (finfos == NULL || finfos->len == 0)
+            continue;
+        return (field_info *)g_ptr_array_index(finfos,
+                                               fields->occurrence == 'l' ? finfos->len - 1 : 0);
+    }
+    return NULL;
+}
+
+static void
+output_fields_set_arrow_value(arrow_writer_t *aw, guint col, arrow_type_e type,
+                              field_info *fi)
+{
+    const nstime_t *ts;
+    guint32         ipv4;
+
+    switch (type) {
+    case ARROW_TYPE_BOOL:
+        arrow_writer_set_int(aw, col, fi->hfinfo->type == FT_NONE ||
+                                      fvalue_get_uinteger(&fi->value) != 0);
+        break;
+    case ARROW_TYPE_UINT8:
+    case ARROW_TYPE_UINT16:
+    case ARROW_TYPE_UINT32:
+        arrow_writer_set_int(aw, col, fvalue_get_uinteger(&fi->value));
+        break;
+    case ARROW_TYPE_INT8:
+    case ARROW_TYPE_INT16:
+    case ARROW_TYPE_INT32:
+        arrow_writer_set_int(aw, col, fvalue_get_sinteger(&fi->value));
+        break;
+    case ARROW_TYPE_UINT64:
+    case ARROW_TYPE_INT64:
+        arrow_writer_set_int(aw, col, (gint64)fvalue_get_integer64(&fi->value));
+        break;
+    case ARROW_TYPE_DOUBLE:
+        arrow_writer_set_double(aw, col, fvalue_get_floating(&fi->value));
+        break;
+    case ARROW_TYPE_TIMESTAMP_NS:
+    case ARROW_TYPE_DURATION_NS:
+        ts = (const nstime_t *)fvalue_get(&fi->value);
+        arrow_writer_set_int(aw, col, (gint64)ts->secs * 1000000000 + ts->nsecs);
+        break;
+    case ARROW_TYPE_FIXED_BINARY:
+        if (fi->hfinfo->type == FT_IPv4) {
+            /* In network byte order, as it would be on the wire */
+            ipv4 = ipv4_get_net_order_addr((ipv4_addr *)fvalue_get(&fi->value));
+            arrow_writer_set_bytes(aw, col, (const guint8 *)&ipv4, sizeof ipv4);
+        } else {
+            arrow_writer_set_bytes(aw, col, (const guint8 *)fvalue_get(&fi->value),
+                                   fvalue_length(&fi->value));
         }
-        if (NULL != fields->field_values[i]) {
-            GPtrArray *fv_p;
-            gchar * str;
-            gsize j;
-            fv_p = fields->field_values[i];
-            if (fields->quote != '\0') {
-                fputc(fields->quote, fh);
-            }
+        break;
+    case ARROW_TYPE_UTF8:
+        break;
+    }
+}
 
-            /* Output the array of (partial) field values */
-            for (j = 0; j < g_ptr_array_len(fv_p); j++ ) {
-                str = (gchar *)g_ptr_array_index(fv_p, j);
-                fputs(str, fh);
-                g_free(str);
-            }
-            if (fields->quote != '\0') {
-                fputc(fields->quote, fh);
+void write_arrow_preamble(output_fields_t *fields, FILE *fh)
+{
+    gsize i;
+    guint width;
+
+    g_assert(fields);
+    g_assert(fields->fields);
+    g_assert(fh);
+
+    output_fields_make_plan(fields);
+    fields->arrow = arrow_writer_new(fh, 0);
+    for (i = 0; i < fields->fields->len; i++) {
+        fields->plan[i].arrow_type = output_field_arrow_type(&fields->plan[i], &width);
+        arrow_writer_add_column(fields->arrow,
+                                (const gchar *)g_ptr_array_index(fields->fields, i),
+                                fields->plan[i].arrow_type, width);
+    }
+    arrow_writer_start(fields->arrow);
+}
+
+/*
+ * Typed columns get one value, as there's nowhere to put the rest; the
+ * string columns get all the values if the occurrence option says so,
+ * joined by the aggregator.
+ */
+void write_arrow_proto_tree(output_fields_t *fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh _U_)
+{
+    gsize                i;
+    guint                nvals;
+    field_info          *fi;
+    output_field_plan_t *plan;
+
+    g_assert(fields);
+    g_assert(fields->arrow);
+    g_assert(edt);
+
+    if (fields->includes_col_fields && !fields->cols_resolved)
+        output_fields_resolve_cols(fields, cinfo);
+    if (NULL == fields->line)
+        fields->line = g_string_sized_new(256);
+
+    for (i = 0; i < fields->fields->len; i++) {
+        plan = &fields->plan[i];
+        if (plan->arrow_type == ARROW_TYPE_UTF8) {
+            g_string_truncate(fields->line, 0);
+            nvals = output_fields_append_field(fields, plan, edt);
+            if (NULL != plan->cols)
+                nvals = output_fields_append_cols(fields, plan, cinfo, 0, nvals);
+            if (nvals != 0) {
+                arrow_writer_set_bytes(fields->arrow, (guint)i,
+                                       (const guint8 *)fields->line->str, fields->line->len);
             }
-            g_ptr_array_free(fv_p, TRUE);  /* get ready for the next packet */
-            fields->field_values[i] = NULL;
+        } else {
+            fi = output_fields_get_item(fields, plan, edt);
+            if (fi != NULL)
+                output_fields_set_arrow_value(fields->arrow, (guint)i, plan->arrow_type, fi);
         }
     }
+    arrow_writer_end_row(fields->arrow);
 }
 
-void write_fields_finale(output_fields_t* fields _U_ , FILE *fh _U_)
+void write_arrow_finale(output_fields_t *fields, FILE *fh _U_)
 {
-    /* Nothing to do */
+    g_assert(fields);
+
+    if (NULL != fields->arrow) {
+        arrow_writer_finish(fields->arrow);
+        fields->arrow = NULL;
+    }
 }
 
 /* Returns an g_malloced string */
@@ -1447,21 +2327,15 @@ get_field_hex_value(GSList *src_list, field_info *fi)
     pd = get_field_data(src_list, fi);
 
     if (pd) {
-        int        i;
         gchar     *buffer;
-        gchar     *p;
         int        len;
         const int  chars_per_byte = 2;
 
         len    = chars_per_byte * fi->length;
         buffer = (gchar *)g_malloc(sizeof(gchar)*(len + 1));
-        buffer[len] = '\0'; /* Ensure NULL termination in bad cases */
-        p = buffer;
         /* Print a simple hex dump */
-        for (i = 0 ; i < fi->length; i++) {
-            g_snprintf(p, chars_per_byte+1, "%02x", pd[i]);
-            p += chars_per_byte;
-        }
+        bytes_to_hexstr(buffer, pd, fi->length);
+        buffer[len] = '\0';
         return buffer;
     } else {
         return NULL;
@@ -1476,8 +2350,10 @@ output_fields_t* output_fields_new(void)
     fields->occurrence          = 'a';
     fields->aggregator          = ',';
     fields->fields              = NULL; /*Do lazy initialisation */
-    fields->field_indicies      = NULL;
-    fields->field_values        = NULL;
+    fields->plan                = NULL;
+    fields->cols_resolved       = FALSE;
+    fields->line                = NULL;
+    fields->arrow               = NULL;
     fields->quote               ='\0';
     fields->includes_col_fields = FALSE;
     return fields;
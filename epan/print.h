@@ -93,6 +93,15 @@ WS_DLL_PUBLIC gsize output_fields_num_fields(output_fields_t* info);
 WS_DLL_PUBLIC gboolean output_fields_set_option(output_fields_t* info, gchar* option);
 WS_DLL_PUBLIC void output_fields_list_options(FILE *fh);
 WS_DLL_PUBLIC gboolean output_fields_has_cols(output_fields_t* info);
+/** TRUE if writing the fields needs the text of protocol tree items
+ *  (see proto_tree_set_labels()) rather than just their values */
+WS_DLL_PUBLIC gboolean output_fields_need_labels(output_fields_t* info);
+/** Have the fields written by write_fields_proto_tree() collected in the
+ *  dissection's tree; call before each packet is dissected */
+WS_DLL_PUBLIC void output_fields_prime_edt(output_fields_t* info, epan_dissect_t *edt);
+/** Mark the "_ws.col." fields' columns as the only ones in cinfo that are
+ *  used, for when nothing but the fields reads the columns */
+WS_DLL_PUBLIC void output_fields_set_cols_used(output_fields_t* info, column_info *cinfo);
 
 /*
  * Higher-level packet-printing code.
@@ -106,14 +115,25 @@ WS_DLL_PUBLIC gboolean print_hex_data(print_stream_t *stream, epan_dissect_t *ed
 
 WS_DLL_PUBLIC void write_pdml_preamble(FILE *fh, const gchar* filename);
 WS_DLL_PUBLIC void write_pdml_proto_tree(epan_dissect_t *edt, FILE *fh);
+/** Append a packet's PDML to buf rather than writing it to a file */
+WS_DLL_PUBLIC void write_pdml_proto_tree_buf(epan_dissect_t *edt, GString *buf);
 WS_DLL_PUBLIC void write_pdml_finale(FILE *fh);
 
 WS_DLL_PUBLIC void write_psml_preamble(column_info *cinfo, FILE *fh);
 WS_DLL_PUBLIC void write_psml_columns(epan_dissect_t *edt, FILE *fh);
+WS_DLL_PUBLIC void write_psml_columns_buf(epan_dissect_t *edt, GString *buf);
 WS_DLL_PUBLIC void write_psml_finale(FILE *fh);
 
+WS_DLL_PUBLIC void write_json_preamble(FILE *fh);
+WS_DLL_PUBLIC void write_json_proto_tree(epan_dissect_t *edt, FILE *fh);
+WS_DLL_PUBLIC void write_json_finale(FILE *fh);
+
+/** Write a packet as an Elasticsearch bulk API index action and document */
+WS_DLL_PUBLIC void write_ek_proto_tree(epan_dissect_t *edt, FILE *fh);
+
 WS_DLL_PUBLIC void write_csv_column_titles(column_info *cinfo, FILE *fh);
 WS_DLL_PUBLIC void write_csv_columns(epan_dissect_t *edt, FILE *fh);
+WS_DLL_PUBLIC void write_csv_columns_buf(epan_dissect_t *edt, GString *buf);
 
 WS_DLL_PUBLIC void write_carrays_hex_data(guint32 num, FILE *fh, epan_dissect_t *edt);
 
@@ -121,6 +141,12 @@ WS_DLL_PUBLIC void write_fields_preamble(output_fields_t* fields, FILE *fh);
 WS_DLL_PUBLIC void write_fields_proto_tree(output_fields_t* fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh);
 WS_DLL_PUBLIC void write_fields_finale(output_fields_t* fields, FILE *fh);
 
+/** Write the fields as an Apache Arrow IPC stream, with a column of
+ *  each field's own type where Arrow has one */
+WS_DLL_PUBLIC void write_arrow_preamble(output_fields_t* fields, FILE *fh);
+WS_DLL_PUBLIC void write_arrow_proto_tree(output_fields_t* fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh);
+WS_DLL_PUBLIC void write_arrow_finale(output_fields_t* fields, FILE *fh);
+
 WS_DLL_PUBLIC gchar* get_node_field_value(field_info* fi, epan_dissect_t* edt);
 
 #ifdef __cplusplus
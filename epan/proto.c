@@ -133,11 +133,15 @@ struct ptvcursor {
 	TRY_TO_FAKE_THIS_ITEM_OR_FREE(tree, hfindex, hfinfo, ((void)0))
 
 
+/* Does anybody want the text of the items in this tree? */
+#define PTREE_WANTS_LABELS(pi) \
+	(PTREE_DATA(pi)->visible && PTREE_DATA(pi)->labels)
+
 /** See inlined comments.
  @param pi the created protocol item we're about to return */
 #define TRY_TO_FAKE_THIS_REPR(pi)	\
 	g_assert(pi);			\
-	if (!(PTREE_DATA(pi)->visible)) { \
+	if (!PTREE_WANTS_LABELS(pi)) { \
 		/* If the tree (GUI) isn't visible it's pointless for us to generate the protocol \
 		 * items string representation */ \
 		return pi; \
@@ -146,7 +150,7 @@ struct ptvcursor {
 #define TRY_TO_FAKE_THIS_REPR_VOID(pi)	\
 	if (!pi)			\
 		return;			\
-	if (!(PTREE_DATA(pi)->visible)) { \
+	if (!PTREE_WANTS_LABELS(pi)) { \
 		/* If the tree (GUI) isn't visible it's pointless for us to generate the protocol \
 		 * items string representation */ \
 		return; \
@@ -167,8 +171,7 @@ static const char *hfinfo_number_vals_format(const header_field_info *hfinfo, ch
 static const char *hfinfo_number_value_format(const header_field_info *hfinfo, char buf[32], guint32 value);
 static const char *hfinfo_numeric_value_format(const header_field_info *hfinfo, char buf[32], guint32 value);
 
-static const char* hfinfo_uint64_format(const header_field_info *hfinfo);
-static const char* hfinfo_int64_format(const header_field_info *hfinfo);
+static const char *hfinfo_number64_value_format(const header_field_info *hfinfo, char buf[48], guint64 value, gboolean is_signed);
 
 static proto_item *
 proto_tree_add_node(proto_tree *tree, field_info *fi);
@@ -195,7 +198,7 @@ proto_tree_set_protocol_tvb(field_info *fi, tvbuff_t *tvb);
 static void
 proto_tree_set_bytes(field_info *fi, const guint8* start_ptr, gint length);
 static void
-proto_tree_set_bytes_tvb(field_info *fi, tvbuff_t *tvb, gint offset, gint length);
+proto_tree_set_bytes_tvb(proto_tree *tree, field_info *fi, tvbuff_t *tvb, gint offset, gint length);
 static void
 proto_tree_set_bytes_gbytearray(field_info *fi, const GByteArray *value);
 static void
@@ -289,14 +292,115 @@ struct _protocol {
 /* List of all protocols */
 static GList *protocols = NULL;
 
+/*
+ * Fields that have been primed because a filter is interested in them
+ * are given a "slot" number, counting up from 0, the first time they're
+ * primed, so that a tree can keep the field_infos it has for each of
+ * them in a small array rather than a hash table.
+ */
+static guint *hfid_to_slot = NULL;	/* slot + 1, or 0, indexed by field ID */
+static guint hfid_to_slot_len = 0;
+static GArray *slot_to_hfid = NULL;	/* field ID, indexed by slot */
+
 /* Deregistered fields */
 static GPtrArray *deregistered_fields = NULL;
 static GPtrArray *deregistered_data = NULL;
 
+/* Bumped whenever a field is registered or unregistered */
+static guint registration_generation = 0;
+
+/*
+ * A tree's proto_nodes and field_infos are all freed together when the
+ * tree is reset for the next packet, so they come from arenas of
+ * fixed-size slabs belonging to the tree rather than from the packet
+ * pool: allocating one is a pointer bump, resetting the tree just goes
+ * back to the start of the first slab, and the slabs are kept for the
+ * next packet.  Keeping the nodes apart from everything else allocated
+ * during dissection also packs them together for the walks over the
+ * tree that printing and filtering do.
+ */
+#define PROTO_ARENA_SLAB_ITEMS	256
+
+typedef struct _proto_arena_slab {
+	struct _proto_arena_slab *next;
+} proto_arena_slab;
+
+/* Keep the items in a slab suitably aligned */
+#define PROTO_ARENA_SLAB_HDR_SIZE \
+	((sizeof(proto_arena_slab) + 15) & ~(gsize)15)
+
+typedef struct {
+	gsize             item_size;
+	proto_arena_slab *first;	/* all the slabs, in the order used */
+	proto_arena_slab *current;	/* slab being allocated from, or NULL */
+	guint             used;		/* items allocated from current */
+} proto_arena;
+
+struct _proto_tree_arenas {
+	proto_arena nodes;
+	proto_arena finfos;
+};
+
+static void
+proto_arena_init(proto_arena *arena, gsize item_size)
+{
+	arena->item_size = (item_size + 7) & ~(gsize)7;
+	arena->first     = NULL;
+	arena->current   = NULL;
+	arena->used      = 0;
+}
+
+static void *
+proto_arena_alloc(proto_arena *arena)
+{
+	proto_arena_slab *slab;
+
+	if (arena->current == NULL || arena->used == PROTO_ARENA_SLAB_ITEMS) {
+		/* Move on to the next slab, making one if there's no spare */
+		slab = arena->current ? arena->current->next : arena->first;
+		if (slab == NULL) {
+			slab = (proto_arena_slab *)g_malloc(PROTO_ARENA_SLAB_HDR_SIZE +
+			    PROTO_ARENA_SLAB_ITEMS * arena->item_size);
+			slab->next = NULL;
+			if (arena->current)
+				arena->current->next = slab;
+			else
+				arena->first = slab;
+		}
+		arena->current = slab;
+		arena->used    = 0;
+	}
+
+	return (guint8 *)arena->current + PROTO_ARENA_SLAB_HDR_SIZE +
+	    arena->used++ * arena->item_size;
+}
+
+/* Make everything allocated from an arena free again, keeping the slabs */
+static void
+proto_arena_reset(proto_arena *arena)
+{
+	arena->current = NULL;
+	arena->used    = 0;
+}
+
+static void
+proto_arena_destroy(proto_arena *arena)
+{
+	proto_arena_slab *slab, *next;
+
+	for (slab = arena->first; slab != NULL; slab = next) {
+		next = slab->next;
+		g_free(slab);
+	}
+	arena->first   = NULL;
+	arena->current = NULL;
+	arena->used    = 0;
+}
+
 /* Contains information about a field when a dissector calls
  * proto_tree_add_item.  */
-#define FIELD_INFO_NEW(pool, fi)  fi = wmem_new(pool, field_info)
-#define FIELD_INFO_FREE(pool, fi) wmem_free(pool, fi)
+#define FIELD_INFO_NEW(tree, fi) \
+	fi = (field_info *)proto_arena_alloc(&PTREE_DATA(tree)->arenas->finfos)
 
 /* Contains the space for proto_nodes. */
 #define PROTO_NODE_INIT(node)			\
@@ -304,8 +408,8 @@ static GPtrArray *deregistered_data = NULL;
 	node->last_child = NULL;		\
 	node->next = NULL;
 
-#define PROTO_NODE_FREE(pool, node)			\
-	wmem_free(pool, node)
+#define PROTO_NODE_NEW(tree, node) \
+	node = (proto_node *)proto_arena_alloc(&PTREE_DATA(tree)->arenas->nodes)
 
 /* String space for protocol and field items for the GUI */
 #define ITEM_LABEL_NEW(pool, il)			\
@@ -552,6 +656,11 @@ proto_cleanup(void)
 		gpa_hfinfo.hfi           = NULL;
 	}
 
+	/* the lookups' value_string_exts are in the epan scope */
+	g_free(hf_strings_lookup);
+	hf_strings_lookup     = NULL;
+	hf_strings_lookup_len = 0;
+
 	if (deregistered_fields) {
 		g_ptr_array_free(deregistered_fields, FALSE);
 		deregistered_fields = NULL;
@@ -562,6 +671,14 @@ proto_cleanup(void)
 		deregistered_data = NULL;
 	}
 
+	g_free(hfid_to_slot);
+	hfid_to_slot = NULL;
+	hfid_to_slot_len = 0;
+	if (slot_to_hfid) {
+		g_array_free(slot_to_hfid, TRUE);
+		slot_to_hfid = NULL;
+	}
+
 	g_free(tree_is_expanded);
 	tree_is_expanded = NULL;
 }
@@ -637,28 +754,48 @@ proto_tree_children_foreach(proto_tree *tree, proto_tree_foreach_func func,
 	}
 }
 
+/* Forget the field_infos found in a tree for the interesting fields,
+ * keeping the arrays for the next packet if there is going to be one. */
 static void
-free_GPtrArray_value(gpointer key, gpointer value, gpointer user_data _U_)
+tree_data_clear_interesting(tree_data_t *tree_data, gboolean free_arrays)
 {
-	GPtrArray         *ptrs = (GPtrArray *)value;
-	gint               hfid = (gint)(long)key;
+	guint              i, slot;
+	gint               hfid;
 	header_field_info *hfinfo;
 
-	PROTO_REGISTRAR_GET_NTH(hfid, hfinfo);
-	if (hfinfo->ref_type != HF_REF_TYPE_NONE) {
-		/* when a field is referenced by a filter this also
-		   affects the refcount for the parent protocol so we need
-		   to adjust the refcount for the parent as well
-		*/
-		if (hfinfo->parent != -1) {
-			header_field_info *parent_hfinfo;
-			PROTO_REGISTRAR_GET_NTH(hfinfo->parent, parent_hfinfo);
-			parent_hfinfo->ref_type = HF_REF_TYPE_NONE;
+	for (i = 0; i < tree_data->num_interesting_used; i++) {
+		slot = tree_data->interesting_used[i];
+		hfid = g_array_index(slot_to_hfid, gint, slot);
+
+		PROTO_REGISTRAR_GET_NTH(hfid, hfinfo);
+		if (hfinfo->ref_type != HF_REF_TYPE_NONE) {
+			/* when a field is referenced by a filter this also
+			   affects the refcount for the parent protocol so we need
+			   to adjust the refcount for the parent as well
+			*/
+			if (hfinfo->parent != -1) {
+				header_field_info *parent_hfinfo;
+				PROTO_REGISTRAR_GET_NTH(hfinfo->parent, parent_hfinfo);
+				parent_hfinfo->ref_type = HF_REF_TYPE_NONE;
+			}
+			hfinfo->ref_type = HF_REF_TYPE_NONE;
 		}
-		hfinfo->ref_type = HF_REF_TYPE_NONE;
+
+		g_ptr_array_set_size(tree_data->interesting[slot], 0);
 	}
+	tree_data->num_interesting_used = 0;
 
-	g_ptr_array_free(ptrs, TRUE);
+	if (free_arrays) {
+		for (slot = 0; slot < tree_data->num_interesting; slot++) {
+			if (tree_data->interesting[slot])
+				g_ptr_array_free(tree_data->interesting[slot], TRUE);
+		}
+		g_free(tree_data->interesting);
+		g_free(tree_data->interesting_used);
+		tree_data->interesting = NULL;
+		tree_data->interesting_used = NULL;
+		tree_data->num_interesting = 0;
+	}
 }
 
 static void
@@ -679,18 +816,15 @@ proto_tree_reset(proto_tree *tree)
 	proto_tree_children_foreach(tree, proto_tree_free_node, NULL);
 
 	/* free tree data */
-	if (tree_data->interesting_hfids) {
-		/* Free all the GPtrArray's in the interesting_hfids hash. */
-		g_hash_table_foreach(tree_data->interesting_hfids,
-			free_GPtrArray_value, NULL);
-
-		/* And then remove all values. */
-		g_hash_table_remove_all(tree_data->interesting_hfids);
-	}
+	tree_data_clear_interesting(tree_data, FALSE);
 
 	/* Reset track of the number of children */
 	tree_data->count = 0;
 
+	/* Everything that came from the arenas is gone now */
+	proto_arena_reset(&tree_data->arenas->nodes);
+	proto_arena_reset(&tree_data->arenas->finfos);
+
 	PROTO_NODE_INIT(tree);
 }
 
@@ -703,14 +837,11 @@ proto_tree_free(proto_tree *tree)
 	proto_tree_children_foreach(tree, proto_tree_free_node, NULL);
 
 	/* free tree data */
-	if (tree_data->interesting_hfids) {
-		/* Free all the GPtrArray's in the interesting_hfids hash. */
-		g_hash_table_foreach(tree_data->interesting_hfids,
-			free_GPtrArray_value, NULL);
+	tree_data_clear_interesting(tree_data, TRUE);
 
-		/* And then destroy the hash. */
-		g_hash_table_destroy(tree_data->interesting_hfids);
-	}
+	proto_arena_destroy(&tree_data->arenas->nodes);
+	proto_arena_destroy(&tree_data->arenas->finfos);
+	g_free(tree_data->arenas);
 
 	g_slice_free(tree_data_t, tree_data);
 
@@ -731,6 +862,16 @@ proto_tree_set_visible(proto_tree *tree, gboolean visible)
 	return old_visible;
 }
 
+gboolean
+proto_tree_set_labels(proto_tree *tree, gboolean labels)
+{
+	gboolean old_labels = PTREE_DATA(tree)->labels;
+
+	PTREE_DATA(tree)->labels = labels;
+
+	return old_labels;
+}
+
 void
 proto_tree_set_fake_protocols(proto_tree *tree, gboolean fake_protocols)
 {
@@ -767,6 +908,12 @@ proto_field_is_referenced(proto_tree *tree, int proto_id)
 }
 
 
+guint
+proto_registrar_generation(void)
+{
+	return registration_generation;
+}
+
 /* Finds a record in the hfinfo array by id. */
 header_field_info *
 proto_registrar_get_nth(guint hfindex)
@@ -1589,23 +1736,33 @@ tree_data_add_maybe_interesting_field(tree_data_t *tree_data, field_info *fi)
 	const header_field_info *hfinfo = fi->hfinfo;
 
 	if (hfinfo->ref_type == HF_REF_TYPE_DIRECT) {
-		GPtrArray *ptrs = NULL;
-
-		if (tree_data->interesting_hfids == NULL) {
-			/* Initialize the hash because we now know that it is needed */
-			tree_data->interesting_hfids =
-				g_hash_table_new(g_direct_hash, NULL /* g_direct_equal */);
-		} else if (g_hash_table_size(tree_data->interesting_hfids)) {
-			ptrs = (GPtrArray *)g_hash_table_lookup(tree_data->interesting_hfids,
-					   GINT_TO_POINTER(hfinfo->id));
+		GPtrArray *ptrs;
+		guint      slot, old_num;
+
+		/* Only primed fields are directly referenced, and they
+		 * all have a slot */
+		slot = hfid_to_slot[hfinfo->id] - 1;
+
+		if (slot >= tree_data->num_interesting) {
+			/* Make room for all the slots there are now */
+			old_num = tree_data->num_interesting;
+			tree_data->num_interesting = slot_to_hfid->len;
+			tree_data->interesting = g_renew(GPtrArray *,
+			    tree_data->interesting, tree_data->num_interesting);
+			memset(tree_data->interesting + old_num, 0,
+			    (tree_data->num_interesting - old_num) * sizeof(GPtrArray *));
+			tree_data->interesting_used = g_renew(guint,
+			    tree_data->interesting_used, tree_data->num_interesting);
 		}
 
+		ptrs = tree_data->interesting[slot];
 		if (!ptrs) {
 			/* First element triggers the creation of pointer array */
 			ptrs = g_ptr_array_new();
-			g_hash_table_insert(tree_data->interesting_hfids,
-					    GINT_TO_POINTER(hfinfo->id), ptrs);
+			tree_data->interesting[slot] = ptrs;
 		}
+		if (ptrs->len == 0)
+			tree_data->interesting_used[tree_data->num_interesting_used++] = slot;
 
 		g_ptr_array_add(ptrs, fi);
 	}
@@ -1636,7 +1793,7 @@ proto_tree_new_item(field_info *new_fi, proto_tree *tree,
 			break;
 
 		case FT_BYTES:
-			proto_tree_set_bytes_tvb(new_fi, tvb, start, length);
+			proto_tree_set_bytes_tvb(tree, new_fi, tvb, start, length);
 			break;
 
 		case FT_UINT_BYTES:
@@ -1647,7 +1804,7 @@ proto_tree_new_item(field_info *new_fi, proto_tree *tree,
 			if (encoding)
 				encoding = ENC_LITTLE_ENDIAN;
 			n = get_uint_value(tree, tvb, start, length, encoding);
-			proto_tree_set_bytes_tvb(new_fi, tvb, start + length, n);
+			proto_tree_set_bytes_tvb(tree, new_fi, tvb, start + length, n);
 
 			/* Instead of calling proto_item_set_len(), since we don't yet
 			 * have a proto_item, we set the field_info's length ourselves. */
@@ -2151,6 +2308,69 @@ proto_tree_add_item(proto_tree *tree, int hfindex, tvbuff_t *tvb,
 	return proto_tree_add_item_new(tree, hfinfo, tvb, start, length, encoding);
 }
 
+/*
+ * proto_tree_add_item() for an integer field whose width the dissector
+ * knows when it's compiled.  That lets us skip the field length lookup
+ * and the dispatch on field type and value width; anything that isn't
+ * an FT_UINT8 through FT_UINT32 field goes the usual way.
+ */
+#define PROTO_TREE_ADD_ITEM_UINT(name, width, get_be, get_le)		\
+proto_item *								\
+name(proto_tree *tree, int hfindex, tvbuff_t *tvb, const gint start,	\
+     const guint encoding)						\
+{									\
+	register header_field_info *hfinfo;				\
+	field_info *new_fi;						\
+	guint32 value;							\
+									\
+	PROTO_REGISTRAR_GET_NTH(hfindex, hfinfo);			\
+	if (hfinfo->type < FT_UINT8 || hfinfo->type > FT_UINT32)	\
+		return proto_tree_add_item_new(tree, hfinfo, tvb,	\
+		    start, width, encoding);				\
+									\
+	test_length(hfinfo, tvb, start, width);				\
+									\
+	TRY_TO_FAKE_THIS_ITEM(tree, hfindex, hfinfo);			\
+									\
+	/* Any non-zero encoding means little-endian, as with		\
+	   proto_tree_add_item() */					\
+	value = encoding ? get_le(tvb, start) : get_be(tvb, start);	\
+	new_fi = new_field_info(tree, hfinfo, tvb, start, width);	\
+	proto_tree_set_uint(new_fi, value);				\
+	FI_SET_FLAG(new_fi, encoding ? FI_LITTLE_ENDIAN : FI_BIG_ENDIAN); \
+	return proto_tree_add_node(tree, new_fi);			\
+}
+
+PROTO_TREE_ADD_ITEM_UINT(proto_tree_add_item_uint8, 1, tvb_get_guint8, tvb_get_guint8)
+PROTO_TREE_ADD_ITEM_UINT(proto_tree_add_item_uint16, 2, tvb_get_ntohs, tvb_get_letohs)
+PROTO_TREE_ADD_ITEM_UINT(proto_tree_add_item_uint24, 3, tvb_get_ntoh24, tvb_get_letoh24)
+PROTO_TREE_ADD_ITEM_UINT(proto_tree_add_item_uint32, 4, tvb_get_ntohl, tvb_get_letohl)
+
+/* Likewise for an FT_IPv4 field */
+proto_item *
+proto_tree_add_item_ipv4(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+			 const gint start, const guint encoding)
+{
+	register header_field_info *hfinfo;
+	field_info *new_fi;
+	guint32 value;
+
+	PROTO_REGISTRAR_GET_NTH(hfindex, hfinfo);
+	if (hfinfo->type != FT_IPv4)
+		return proto_tree_add_item_new(tree, hfinfo, tvb, start,
+		    FT_IPv4_LEN, encoding);
+
+	test_length(hfinfo, tvb, start, FT_IPv4_LEN);
+
+	TRY_TO_FAKE_THIS_ITEM(tree, hfindex, hfinfo);
+
+	value = tvb_get_ipv4(tvb, start);
+	new_fi = new_field_info(tree, hfinfo, tvb, start, FT_IPv4_LEN);
+	proto_tree_set_ipv4(new_fi, encoding ? GUINT32_SWAP_LE_BE(value) : value);
+	FI_SET_FLAG(new_fi, encoding ? FI_LITTLE_ENDIAN : FI_BIG_ENDIAN);
+	return proto_tree_add_node(tree, new_fi);
+}
+
 /* which FT_ types can use proto_tree_add_bytes_item() */
 static inline gboolean
 validate_proto_tree_add_bytes_ftype(const enum ftenum type)
@@ -2270,7 +2490,7 @@ proto_tree_add_bytes_item(proto_tree *tree, int hfindex, tvbuff_t *tvb,
 	}
 	else {
 		/* n will be zero except when it's a FT_UINT_BYTES */
-		proto_tree_set_bytes_tvb(new_fi, tvb, start + n, length);
+		proto_tree_set_bytes_tvb(tree, new_fi, tvb, start + n, length);
 
 		FI_SET_FLAG(new_fi,
 			(encoding & ENC_LITTLE_ENDIAN) ? FI_LITTLE_ENDIAN : FI_BIG_ENDIAN);
@@ -2539,10 +2759,40 @@ proto_tree_set_bytes(field_info *fi, const guint8* start_ptr, gint length)
 }
 
 
+/* Is the field's data in one of the packet's data sources?  Those are
+ * kept until the packet's tree is freed. */
+static gboolean
+proto_tree_data_outlives_tree(proto_tree *tree, const field_info *fi)
+{
+	packet_info *pinfo = PTREE_DATA(tree)->pinfo;
+	GSList      *src_le;
+
+	if (pinfo == NULL || fi->ds_tvb == NULL)
+		return FALSE;
+
+	for (src_le = pinfo->data_src; src_le != NULL; src_le = src_le->next) {
+		if (get_data_source_tvb((struct data_source *)src_le->data) == fi->ds_tvb)
+			return TRUE;
+	}
+	return FALSE;
+}
+
 static void
-proto_tree_set_bytes_tvb(field_info *fi, tvbuff_t *tvb, gint offset, gint length)
+proto_tree_set_bytes_tvb(proto_tree *tree, field_info *fi, tvbuff_t *tvb, gint offset, gint length)
 {
-	proto_tree_set_bytes(fi, tvb_get_ptr(tvb, offset, length), length);
+	const guint8 *start_ptr = tvb_get_ptr(tvb, offset, length);
+
+	/*
+	 * Payload fields can be large; rather than copy them, point at
+	 * the packet data when it's sure to be there as long as the
+	 * field is.  Tvbuffs that aren't a data source may be freed by
+	 * the dissector that made them, so we copy from those.
+	 */
+	if (length > 0 && proto_tree_data_outlives_tree(tree, fi)) {
+		fvalue_set_bytes_ref(&fi->value, start_ptr, length);
+		return;
+	}
+	proto_tree_set_bytes(fi, start_ptr, length);
 }
 
 static void
@@ -3159,8 +3409,9 @@ proto_tree_set_string_tvb(field_info *fi, tvbuff_t *tvb, gint start, gint length
 		length = tvb_ensure_captured_length_remaining(tvb, start);
 	}
 
-	string = tvb_get_string_enc(wmem_packet_scope(), tvb, start, length, encoding);
-	proto_tree_set_string(fi, string);
+	/* The fvalue keeps the decoded string rather than a copy of it */
+	string = (gchar *)tvb_get_string_enc(NULL, tvb, start, length, encoding);
+	fvalue_take_string(&fi->value, string);
 }
 
 /* Set the FT_AX25 value */
@@ -3831,7 +4082,7 @@ proto_tree_add_node(proto_tree *tree, field_info *fi)
 		/* XXX - is it safe to continue here? */
 	}
 
-	pnode = wmem_new(PNODE_POOL(tree), proto_node);
+	PROTO_NODE_NEW(tree, pnode);
 	PROTO_NODE_INIT(pnode);
 	pnode->parent = tnode;
 	PNODE_FINFO(pnode) = fi;
@@ -4003,7 +4254,7 @@ new_field_info(proto_tree *tree, header_field_info *hfinfo, tvbuff_t *tvb,
 {
 	field_info *fi;
 
-	FIELD_INFO_NEW(PNODE_POOL(tree), fi);
+	FIELD_INFO_NEW(tree, fi);
 
 	fi->hfinfo     = hfinfo;
 	fi->start      = start;
@@ -4036,7 +4287,7 @@ proto_tree_set_representation_value(proto_item *pi, const char *format, va_list
 
 	/* If the tree (GUI) or item isn't visible it's pointless for us to generate the protocol
 	 * items string representation */
-	if (PTREE_DATA(pi)->visible && !PROTO_ITEM_IS_HIDDEN(pi)) {
+	if (PTREE_WANTS_LABELS(pi) && !PROTO_ITEM_IS_HIDDEN(pi)) {
 		int               ret = 0;
 		field_info        *fi = PITEM_FINFO(pi);
 		header_field_info *hf;
@@ -4089,7 +4340,7 @@ proto_tree_set_representation(proto_item *pi, const char *format, va_list ap)
 
 	DISSECTOR_ASSERT(fi);
 
-	if (!PROTO_ITEM_IS_HIDDEN(pi)) {
+	if (PTREE_WANTS_LABELS(pi) && !PROTO_ITEM_IS_HIDDEN(pi)) {
 		ITEM_LABEL_NEW(PNODE_POOL(pi), fi->rep);
 		ret = g_vsnprintf(fi->rep->representation, ITEM_LABEL_LENGTH,
 				  format, ap);
@@ -4683,8 +4934,15 @@ proto_tree_create_root(packet_info *pinfo)
 	/* Make sure we can access pinfo everywhere */
 	pnode->tree_data->pinfo = pinfo;
 
-	/* Don't initialize the tree_data_t. Wait until we know we need it */
-	pnode->tree_data->interesting_hfids = NULL;
+	pnode->tree_data->arenas = g_new(proto_tree_arenas, 1);
+	proto_arena_init(&pnode->tree_data->arenas->nodes, sizeof(proto_node));
+	proto_arena_init(&pnode->tree_data->arenas->finfos, sizeof(field_info));
+
+	/* Don't allocate the interesting field arrays. Wait until we know we need them */
+	pnode->tree_data->interesting = NULL;
+	pnode->tree_data->interesting_used = NULL;
+	pnode->tree_data->num_interesting = 0;
+	pnode->tree_data->num_interesting_used = 0;
 
 	/* Set the default to FALSE so it's easier to
 	 * find errors; if we expect to see the protocol tree
@@ -4695,6 +4953,9 @@ proto_tree_create_root(packet_info *pinfo)
 	/* Make sure that we fake protocols (if possible) */
 	pnode->tree_data->fake_protocols = TRUE;
 
+	/* Want the item text if the tree is visible */
+	pnode->tree_data->labels = TRUE;
+
 	/* Keep track of the number of children */
 	pnode->tree_data->count = 0;
 
@@ -4710,6 +4971,23 @@ proto_tree_prime_hfid(proto_tree *tree _U_, const gint hfid)
 	header_field_info *hfinfo;
 
 	PROTO_REGISTRAR_GET_NTH(hfid, hfinfo);
+
+	/* Give the field a slot if this is the first time it's been primed */
+	if ((guint)hfid >= hfid_to_slot_len) {
+		guint old_len = hfid_to_slot_len;
+
+		hfid_to_slot_len = gpa_hfinfo.len;
+		hfid_to_slot = g_renew(guint, hfid_to_slot, hfid_to_slot_len);
+		memset(hfid_to_slot + old_len, 0,
+		    (hfid_to_slot_len - old_len) * sizeof(guint));
+	}
+	if (hfid_to_slot[hfid] == 0) {
+		if (slot_to_hfid == NULL)
+			slot_to_hfid = g_array_new(FALSE, FALSE, sizeof(gint));
+		g_array_append_val(slot_to_hfid, hfid);
+		hfid_to_slot[hfid] = slot_to_hfid->len;
+	}
+
 	/* this field is referenced by a filter so increase the refcount.
 	   also increase the refcount for the parent, i.e the protocol.
 	*/
@@ -5378,6 +5656,7 @@ proto_unregister_field (const int parent, gint hf_id)
 			g_hash_table_steal(gpa_name_map, hfi->abbrev);
 			g_ptr_array_remove_index_fast(proto->fields, i);
 			g_ptr_array_add(deregistered_fields, gpa_hfinfo.hfi[hf_id]);
+			registration_generation++;
 			return;
 		}
 	}
@@ -5778,6 +6057,8 @@ proto_register_field_init(header_field_info *hfinfo, const int parent)
 
 	tmp_fld_check_assert(hfinfo);
 
+	registration_generation++;
+
 	hfinfo->parent         = parent;
 	hfinfo->same_name_next = NULL;
 	hfinfo->same_name_prev_id = -1;
@@ -6297,11 +6578,148 @@ fill_label_boolean(field_info *fi, gchar *label_str)
 	label_fill(label_str, bitfield_byte_length, hfinfo, value ? tfstring->true_string : tfstring->false_string);
 }
 
+/*
+ * Lookup structures for fields' VALS() and RVALS(), built the first
+ * time each field's value is looked up, so that labelling a field
+ * doesn't scan its strings linearly.
+ */
+typedef struct {
+	const void       *strings;    /* the hfinfo->strings they were built from */
+	value_string_ext *vse;        /* for a value_string; NULL to search it linearly */
+	guint             num_ranges; /* for a range_string whose ranges are in order and
+	                                 don't overlap; 0 to search it linearly */
+} hf_strings_lookup_t;
+
+static hf_strings_lookup_t *hf_strings_lookup = NULL;	/* indexed by field ID */
+static guint hf_strings_lookup_len = 0;
+
+/* Below this many entries, an unsorted value_string is just searched */
+#define HF_STRINGS_MIN_SORTED_COPY 8
+
+static gint
+hf_value_string_order_cmp(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	const value_string *vs = (const value_string *)user_data;
+	guint ia = *(const guint *)a;
+	guint ib = *(const guint *)b;
+
+	if (vs[ia].value != vs[ib].value)
+		return vs[ia].value < vs[ib].value ? -1 : 1;
+	/* keep equal values in their original order, so the first one wins */
+	return ia < ib ? -1 : (ia > ib ? 1 : 0);
+}
+
+static value_string_ext *
+hf_value_string_compile(const value_string *vs, const char *name)
+{
+	value_string *sorted;
+	guint        *order;
+	guint         num_entries, i, j;
+	gboolean      ascending = TRUE;
+
+	for (num_entries = 0; vs[num_entries].strptr != NULL; num_entries++) {
+		if (num_entries > 0 && vs[num_entries].value <= vs[num_entries - 1].value)
+			ascending = FALSE;
+	}
+	if (num_entries == 0)
+		return NULL;
+
+	/* value_string_ext picks an index or a binary search for these */
+	if (ascending)
+		return value_string_ext_new(vs, num_entries + 1, name);
+
+	if (num_entries < HF_STRINGS_MIN_SORTED_COPY)
+		return NULL;
+
+	/*
+	 * Binary search a sorted copy, without the entries a linear search
+	 * would never reach because an earlier one has the same value.
+	 */
+	order = g_new(guint, num_entries);
+	for (i = 0; i < num_entries; i++)
+		order[i] = i;
+	g_qsort_with_data(order, num_entries, sizeof(guint), hf_value_string_order_cmp, (gpointer)vs);
+
+	sorted = (value_string *)wmem_alloc_array(wmem_epan_scope(), value_string, num_entries + 1);
+	for (i = 0, j = 0; i < num_entries; i++) {
+		if (j > 0 && sorted[j - 1].value == vs[order[i]].value)
+			continue;
+		sorted[j++] = vs[order[i]];
+	}
+	sorted[j].value  = 0;
+	sorted[j].strptr = NULL;
+	g_free(order);
+
+	return value_string_ext_new(sorted, j + 1, name);
+}
+
+static guint
+hf_range_string_sorted_count(const range_string *rs)
+{
+	guint i;
+
+	for (i = 0; rs[i].strptr != NULL; i++) {
+		if (rs[i].value_min > rs[i].value_max)
+			return 0;
+		if (i > 0 && rs[i].value_min <= rs[i - 1].value_max)
+			return 0;
+	}
+	return i;
+}
+
+static const char *
+hf_range_string_bsearch(guint32 value, const range_string *rs, guint num_ranges)
+{
+	guint low = 0, high = num_ranges, mid;
+
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (value < rs[mid].value_min)
+			high = mid;
+		else if (value > rs[mid].value_max)
+			low = mid + 1;
+		else
+			return rs[mid].strptr;
+	}
+	return NULL;
+}
+
+static hf_strings_lookup_t *
+hf_get_strings_lookup(const header_field_info *hfinfo)
+{
+	hf_strings_lookup_t *lookup;
+	guint                old_len;
+
+	if (hfinfo->id < 0)
+		return NULL;
+
+	if ((guint)hfinfo->id >= hf_strings_lookup_len) {
+		old_len = hf_strings_lookup_len;
+		hf_strings_lookup_len = MAX(gpa_hfinfo.allocated_len, (guint)hfinfo->id + 1);
+		hf_strings_lookup = (hf_strings_lookup_t *)g_realloc(hf_strings_lookup,
+					sizeof(hf_strings_lookup_t) * hf_strings_lookup_len);
+		memset(hf_strings_lookup + old_len, 0,
+		       sizeof(hf_strings_lookup_t) * (hf_strings_lookup_len - old_len));
+	}
+
+	lookup = &hf_strings_lookup[hfinfo->id];
+	if (lookup->strings != hfinfo->strings) {
+		/* first use, or the field's strings have been replaced */
+		lookup->strings    = hfinfo->strings;
+		lookup->vse        = NULL;
+		lookup->num_ranges = 0;
+		if (hfinfo->display & BASE_RANGE_STRING)
+			lookup->num_ranges = hf_range_string_sorted_count((const range_string *) hfinfo->strings);
+		else
+			lookup->vse = hf_value_string_compile((const value_string *) hfinfo->strings, hfinfo->abbrev);
+	}
+	return lookup;
+}
+
 static const char *
 hf_try_val_to_str(guint32 value, const header_field_info *hfinfo)
 {
-	if (hfinfo->display & BASE_RANGE_STRING)
-		return try_rval_to_str(value, (const range_string *) hfinfo->strings);
+	hf_strings_lookup_t *lookup;
 
 	if (hfinfo->display & BASE_EXT_STRING)
 		return try_val_to_str_ext(value, (value_string_ext *) hfinfo->strings);
@@ -6309,6 +6727,16 @@ hf_try_val_to_str(guint32 value, const header_field_info *hfinfo)
 	if (hfinfo->display & BASE_VAL64_STRING)
 		return try_val64_to_str(value, (const val64_string *) hfinfo->strings);
 
+	lookup = hf_get_strings_lookup(hfinfo);
+
+	if (hfinfo->display & BASE_RANGE_STRING) {
+		if (lookup && lookup->num_ranges)
+			return hf_range_string_bsearch(value, (const range_string *) hfinfo->strings, lookup->num_ranges);
+		return try_rval_to_str(value, (const range_string *) hfinfo->strings);
+	}
+
+	if (lookup && lookup->vse)
+		return try_val_to_str_ext(value, lookup->vse);
 	return try_val_to_str(value, (const value_string *) hfinfo->strings);
 }
 
@@ -6443,24 +6871,16 @@ fill_label_number(field_info *fi, gchar *label_str, gboolean is_signed)
 static void
 fill_label_number64(field_info *fi, gchar *label_str, gboolean is_signed)
 {
-	const char        *format = NULL;
 	header_field_info *hfinfo = fi->hfinfo;
 	guint64            value;
-	char               tmp[ITEM_LABEL_LENGTH+1];
 
-	/* Pick the proper format string */
-	if (is_signed)
-		format = hfinfo_int64_format(hfinfo);
-	else
-		format = hfinfo_uint64_format(hfinfo);
+	char               buf[48];
+	const char        *out;
 
 	value = fvalue_get_integer64(&fi->value);
 
-	/* Format the temporary string */
-	if (IS_BASE_DUAL(hfinfo->display))
-		g_snprintf(tmp, ITEM_LABEL_LENGTH, format, value, value);
-	else
-		g_snprintf(tmp, ITEM_LABEL_LENGTH, format, value);
+	/* Format the number */
+	out = hfinfo_number64_value_format(hfinfo, buf, value, is_signed);
 
 	if (hfinfo->strings) {
 		const char *val_str = hf_try_val64_to_str_const(value, hfinfo, "Unknown");
@@ -6469,11 +6889,11 @@ fill_label_number64(field_info *fi, gchar *label_str, gboolean is_signed)
 			label_fill(label_str, 0, hfinfo, val_str);
 		}
 		else {
-			label_fill_descr(label_str, 0, hfinfo, val_str, tmp);
+			label_fill_descr(label_str, 0, hfinfo, val_str, out);
 		}
 	}
 	else {
-		label_fill(label_str, 0, hfinfo, tmp);
+		label_fill(label_str, 0, hfinfo, out);
 	}
 }
 
@@ -6651,61 +7071,43 @@ hfinfo_number_vals_format(const header_field_info *hfinfo, char buf[32], guint32
 }
 
 static const char *
-hfinfo_uint64_format(const header_field_info *hfinfo)
+hfinfo_number64_value_format(const header_field_info *hfinfo, char buf[48], guint64 value, gboolean is_signed)
 {
-	const char *format = NULL;
+	char *ptr = &buf[47];
 
-	/* Pick the proper format string */
-	switch (hfinfo->display & FIELD_DISPLAY_E_MASK) {
-		case BASE_DEC:
-			format = "%" G_GINT64_MODIFIER "u";
-			break;
-		case BASE_DEC_HEX:
-			format = "%" G_GINT64_MODIFIER "u (0x%016" G_GINT64_MODIFIER "x)";
-			break;
-		case BASE_OCT: /* I'm lazy */
-			format = "%#" G_GINT64_MODIFIER "o";
-			break;
-		case BASE_HEX:
-			format = "0x%016" G_GINT64_MODIFIER "x";
-			break;
-		case BASE_HEX_DEC:
-			format = "0x%016" G_GINT64_MODIFIER "x (%" G_GINT64_MODIFIER "u)";
-			break;
-		default:
-			DISSECTOR_ASSERT_NOT_REACHED();
-			;
-	}
-	return format;
-}
+	*ptr = '\0';
+	/* Properly format value */
+		switch (hfinfo->display & FIELD_DISPLAY_E_MASK) {
+			case BASE_DEC:
+				return is_signed ? int64_to_str_back(ptr, (gint64) value) : uint64_to_str_back(ptr, value);
 
-static const char *
-hfinfo_int64_format(const header_field_info *hfinfo)
-{
-	const char *format = NULL;
+			case BASE_DEC_HEX:
+				*(--ptr) = ')';
+				ptr = hex64_to_str_back(ptr, 16, value);
+				*(--ptr) = '(';
+				*(--ptr) = ' ';
+				ptr = is_signed ? int64_to_str_back(ptr, (gint64) value) : uint64_to_str_back(ptr, value);
+				return ptr;
 
-	/* Pick the proper format string */
-	switch (hfinfo->display & FIELD_DISPLAY_E_MASK) {
-		case BASE_DEC:
-			format = "%" G_GINT64_MODIFIER "d";
-			break;
-		case BASE_DEC_HEX:
-			format = "%" G_GINT64_MODIFIER "d (0x%016" G_GINT64_MODIFIER "x)";
-			break;
-		case BASE_OCT: /* I'm lazy */
-			format = "%#" G_GINT64_MODIFIER "o";
-			break;
-		case BASE_HEX:
-			format = "0x%016" G_GINT64_MODIFIER "x";
-			break;
-		case BASE_HEX_DEC:
-			format = "0x%016" G_GINT64_MODIFIER "x (%" G_GINT64_MODIFIER "d)";
-			break;
-		default:
-			DISSECTOR_ASSERT_NOT_REACHED();
-			;
-	}
-	return format;
+			case BASE_OCT:
+				return oct64_to_str_back(ptr, value);
+
+			case BASE_HEX:
+				return hex64_to_str_back(ptr, 16, value);
+
+			case BASE_HEX_DEC:
+				*(--ptr) = ')';
+				ptr = is_signed ? int64_to_str_back(ptr, (gint64) value) : uint64_to_str_back(ptr, value);
+				*(--ptr) = '(';
+				*(--ptr) = ' ';
+				ptr = hex64_to_str_back(ptr, 16, value);
+				return ptr;
+
+			default:
+				DISSECTOR_ASSERT_NOT_REACHED();
+				;
+		}
+	return ptr;
 }
 
 const char *
@@ -6792,27 +7194,33 @@ proto_check_for_protocol_or_field(const proto_tree* tree, const int id)
 GPtrArray *
 proto_get_finfo_ptr_array(const proto_tree *tree, const int id)
 {
+	tree_data_t *tree_data;
+	guint        slot;
+	GPtrArray   *ptrs;
+
 	if (!tree)
 		return NULL;
 
-	if (PTREE_DATA(tree)->interesting_hfids != NULL)
-		return (GPtrArray *)g_hash_table_lookup(PTREE_DATA(tree)->interesting_hfids,
-					   GINT_TO_POINTER(id));
-	else
+	tree_data = PTREE_DATA(tree);
+	if (id < 0 || (guint)id >= hfid_to_slot_len || hfid_to_slot[id] == 0)
+		return NULL;
+
+	slot = hfid_to_slot[id] - 1;
+	if (slot >= tree_data->num_interesting)
 		return NULL;
+
+	/* Empty arrays are left over from earlier packets */
+	ptrs = tree_data->interesting[slot];
+	return (ptrs != NULL && ptrs->len != 0) ? ptrs : NULL;
 }
 
 gboolean
 proto_tracking_interesting_fields(const proto_tree *tree)
 {
-	GHashTable *interesting_hfids;
-
 	if (!tree)
 		return FALSE;
 
-	interesting_hfids = PTREE_DATA(tree)->interesting_hfids;
-
-	return (interesting_hfids != NULL) && g_hash_table_size(interesting_hfids);
+	return PTREE_DATA(tree)->num_interesting_used != 0;
 }
 
 /* Helper struct for proto_find_info() and	proto_all_finfos() */
@@ -8223,6 +8631,50 @@ proto_tree_add_bits_ret_val(proto_tree *tree, const int hfindex, tvbuff_t *tvb,
 	return item;
 }
 
+proto_item *
+proto_tree_add_bits_cursor_ret_val(proto_tree *tree, const int hfindex, tvb_bit_cursor_t *bc,
+				   const gint no_of_bits, guint64 *return_value, const guint encoding)
+{
+	header_field_info *hfinfo;
+	guint		   bit_offset = bc->bit_offset;
+	guint64		   value;
+
+	PROTO_REGISTRAR_GET_NTH(hfindex, hfinfo);
+
+	DISSECTOR_ASSERT(no_of_bits > 0 && no_of_bits < 65);
+
+	/* The value comes from the cursor's window; only build an item if it's wanted */
+	value = tvb_bit_cursor_get_bits(bc, no_of_bits);
+
+	switch (hfinfo->type) {
+		case FT_INT8:
+		case FT_INT16:
+		case FT_INT24:
+		case FT_INT32:
+		case FT_INT64:
+			value = ws_sign_ext64(value, no_of_bits);
+			break;
+
+		default:
+			break;
+	}
+
+	if (return_value) {
+		*return_value = value;
+	}
+
+	TRY_TO_FAKE_THIS_ITEM(tree, hfindex, hfinfo);
+
+	return proto_tree_add_bits_ret_val(tree, hfindex, bc->tvb, bit_offset, no_of_bits, NULL, encoding);
+}
+
+proto_item *
+proto_tree_add_bits_cursor_item(proto_tree *tree, const int hfindex, tvb_bit_cursor_t *bc,
+				const gint no_of_bits, const guint encoding)
+{
+	return proto_tree_add_bits_cursor_ret_val(tree, hfindex, bc, no_of_bits, NULL, encoding);
+}
+
 static proto_item *
 _proto_tree_add_bits_format_value(proto_tree *tree, const int hfindex,
 				 tvbuff_t *tvb, const guint bit_offset,
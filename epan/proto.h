@@ -656,11 +656,19 @@ typedef struct
 #define FI_GET_BITS_OFFSET(fi) (FI_GET_FLAG(fi, FI_BITS_OFFSET(7)) >> 5)
 #define FI_GET_BITS_SIZE(fi)   (FI_GET_FLAG(fi, FI_BITS_SIZE(63)) >> 8)
 
+/** Slab arenas that a tree's proto_nodes and field_infos come from */
+typedef struct _proto_tree_arenas proto_tree_arenas;
+
 /** One of these exists for the entire protocol tree. Each proto_node
  * in the protocol tree points to the same copy. */
 typedef struct {
-    GHashTable  *interesting_hfids;
+    proto_tree_arenas *arenas;         /**< where the tree's nodes and field_infos are allocated */
+    GPtrArray  **interesting;          /**< field_info pointers for each "interesting" field slot (see proto_tree_prime_hfid()) */
+    guint       *interesting_used;     /**< slots with field_info pointers in this tree */
+    guint        num_interesting;      /**< number of elements allocated in interesting and interesting_used */
+    guint        num_interesting_used; /**< number of elements used in interesting_used */
     gboolean     visible;
+    gboolean     labels;               /**< FALSE if nobody wants the text dissectors give items */
     gboolean     fake_protocols;
     gint         count;
     struct _packet_info *pinfo;
@@ -916,10 +924,26 @@ proto_tree_set_visible(proto_tree *tree, gboolean visible);
 extern void
 proto_tree_set_fake_protocols(proto_tree *tree, gboolean fake_protocols);
 
-/** Mark a field/protocol ID as "interesting".
+/** Indicate whether the item text that dissectors supply (with the
+ _format() routines, proto_item_set_text(), proto_item_append_text() and
+ so on) is wanted for a visible tree (default = TRUE).  If it isn't, all
+ the items are still added, with their values, but none of that text is
+ formatted; anything that later asks for an item's label with
+ proto_item_fill_label() gets the one made from the field's name and
+ value on the spot, and text-only items have no text at all.  This is
+ for consumers of a full tree that only look at the values.
+ @param tree the tree to be set
+ @param labels TRUE if the item text is wanted
+ @return the old value */
+WS_DLL_PUBLIC gboolean
+proto_tree_set_labels(proto_tree *tree, gboolean labels);
+
+/** Mark a field/protocol ID as "interesting", so that the field_infos
+ for it in a tree can be got with proto_get_finfo_ptr_array().  The first
+ time a field is primed it's given a small "slot" number, which trees use
+ to index the field_infos they collect for it.
  @param tree the tree to be set (currently ignored)
- @param hfid the interesting field id
- @todo what *does* interesting mean? */
+ @param hfid the interesting field id */
 extern void
 proto_tree_prime_hfid(proto_tree *tree, const int hfid);
 
@@ -970,6 +994,43 @@ WS_DLL_PUBLIC proto_item *
 proto_tree_add_item(proto_tree *tree, int hfindex, tvbuff_t *tvb,
 		    const gint start, gint length, const guint encoding);
 
+/** Add an item to a proto_tree as proto_tree_add_item() would, for an
+   integer field 1, 2, 3 or 4 bytes long.  These are quicker for
+   FT_UINT8 through FT_UINT32 fields, as the length and type needn't be
+   looked at; other fields are handed to proto_tree_add_item().
+ @param tree the tree to append this item to
+ @param hfindex field index
+ @param tvb the tv buffer of the current data
+ @param start start of data in tvb
+ @param encoding data encoding
+ @return the newly created item */
+WS_DLL_PUBLIC proto_item *
+proto_tree_add_item_uint8(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+    const gint start, const guint encoding);
+
+WS_DLL_PUBLIC proto_item *
+proto_tree_add_item_uint16(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+    const gint start, const guint encoding);
+
+WS_DLL_PUBLIC proto_item *
+proto_tree_add_item_uint24(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+    const gint start, const guint encoding);
+
+WS_DLL_PUBLIC proto_item *
+proto_tree_add_item_uint32(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+    const gint start, const guint encoding);
+
+/** Likewise, for a 4-byte FT_IPv4 field.
+ @param tree the tree to append this item to
+ @param hfindex field index
+ @param tvb the tv buffer of the current data
+ @param start start of data in tvb
+ @param encoding data encoding
+ @return the newly created item */
+WS_DLL_PUBLIC proto_item *
+proto_tree_add_item_ipv4(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+    const gint start, const guint encoding);
+
 /** (DEPRECATED) Add a text-only node to a proto_tree.
  @param tree the tree to append this item to
  @param tvb the tv buffer of the current data
@@ -2006,6 +2067,12 @@ WS_DLL_PUBLIC const char* proto_registrar_get_abbrev(const int n);
  @return the registered item */
 WS_DLL_PUBLIC header_field_info* proto_registrar_get_nth(guint hfindex);
 
+/** Get a number that changes whenever a field or protocol is registered
+ or unregistered, so that anything looked up by field name can tell
+ whether it needs looking up again.
+ @return the current registration generation */
+WS_DLL_PUBLIC guint proto_registrar_generation(void);
+
 /** Get the header_field information based upon a field name.
  @param field_name the field name to search for
  @return the registered item */
@@ -2379,6 +2446,31 @@ proto_tree_add_split_bits_crumb(proto_tree *tree, const int hf_index, tvbuff_t *
 WS_DLL_PUBLIC proto_item *
 proto_tree_add_bits_ret_val(proto_tree *tree, const int hf_index, tvbuff_t *tvb, const guint bit_offset, const gint no_of_bits, guint64 *return_value, const guint encoding);
 
+/** Add bits to a proto_tree, using the text label registered to that item,
+   reading them from a bit cursor and moving the cursor past them.  The
+   cursor's window is used to read the value, so when the item doesn't need
+   to be built this is no more than a tvb_bit_cursor_get_bits().
+ @param tree the tree to append this item to
+ @param hf_index field index. Fields for use with this function should have bitmask==0.
+ @param bc the bit cursor to read the bits at
+ @param no_of_bits length of data in tvb expressed in bits
+ @param return_value if a pointer is passed here the value is returned.
+ @param encoding data encoding
+ @return the newly created item */
+WS_DLL_PUBLIC proto_item *
+proto_tree_add_bits_cursor_ret_val(proto_tree *tree, const int hf_index, tvb_bit_cursor_t *bc, const gint no_of_bits, guint64 *return_value, const guint encoding);
+
+/** Add bits to a proto_tree, using the text label registered to that item,
+   reading them from a bit cursor and moving the cursor past them.
+ @param tree the tree to append this item to
+ @param hf_index field index. Fields for use with this function should have bitmask==0.
+ @param bc the bit cursor to read the bits at
+ @param no_of_bits length of data in tvb expressed in bits
+ @param encoding data encoding
+ @return the newly created item */
+WS_DLL_PUBLIC proto_item *
+proto_tree_add_bits_cursor_item(proto_tree *tree, const int hf_index, tvb_bit_cursor_t *bc, const gint no_of_bits, const guint encoding);
+
 /** Add bits for a FT_UINT8, FT_UINT16, FT_UINT24 or FT_UINT32
     header field to a proto_tree, with the format generating the
     string for the value and with the field name being included automatically.
@@ -2507,6 +2599,21 @@ proto_custom_set(proto_tree* tree, GSList *field_id,
 #define proto_tree_add_item(tree, hfinfo, tvb, start, length, encoding) \
         proto_tree_add_item_new(tree, hfinfo, tvb, start, length, encoding)
 
+#define proto_tree_add_item_uint8(tree, hfinfo, tvb, start, encoding) \
+	proto_tree_add_item_uint8(tree, (hfinfo)->id, tvb, start, encoding)
+
+#define proto_tree_add_item_uint16(tree, hfinfo, tvb, start, encoding) \
+	proto_tree_add_item_uint16(tree, (hfinfo)->id, tvb, start, encoding)
+
+#define proto_tree_add_item_uint24(tree, hfinfo, tvb, start, encoding) \
+	proto_tree_add_item_uint24(tree, (hfinfo)->id, tvb, start, encoding)
+
+#define proto_tree_add_item_uint32(tree, hfinfo, tvb, start, encoding) \
+	proto_tree_add_item_uint32(tree, (hfinfo)->id, tvb, start, encoding)
+
+#define proto_tree_add_item_ipv4(tree, hfinfo, tvb, start, encoding) \
+	proto_tree_add_item_ipv4(tree, (hfinfo)->id, tvb, start, encoding)
+
 #define proto_tree_add_boolean(tree, hfinfo, tvb, start, length, value) \
 	proto_tree_add_boolean(tree, (hfinfo)->id, tvb, start, length, value)
 
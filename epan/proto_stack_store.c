@@ -0,0 +1,177 @@
+/* proto_stack_store.c
+ * Implements a per-frame store of protocol stacks
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/wmem/wmem.h>
+
+#include "proto_stack_store.h"
+
+struct _proto_stack_store {
+  GPtrArray   *stacks;          /* GArray of int, for stack number - 1 */
+  GHashTable  *stack_nums;      /* stack GArray -> stack number */
+  GArray      *frames;          /* guint32 stack number, for frame number - 1 */
+  GArray      *scratch;         /* the stack being recorded */
+};
+
+static guint
+stack_hash(gconstpointer key)
+{
+  const GArray *stack = (const GArray *)key;
+  guint         hash = 5381;
+  guint         i;
+
+  for (i = 0; i < stack->len; i++)
+    hash = hash * 33 + (guint)g_array_index(stack, int, i);
+  return hash;
+}
+
+static gboolean
+stack_equal(gconstpointer a, gconstpointer b)
+{
+  const GArray *sa = (const GArray *)a;
+  const GArray *sb = (const GArray *)b;
+
+  return sa->len == sb->len &&
+         memcmp(sa->data, sb->data, sa->len * sizeof(int)) == 0;
+}
+
+static void
+free_stacks(GPtrArray *stacks)
+{
+  guint i;
+
+  for (i = 0; i < stacks->len; i++)
+    g_array_free((GArray *)g_ptr_array_index(stacks, i), TRUE);
+  g_ptr_array_set_size(stacks, 0);
+}
+
+proto_stack_store_t *
+proto_stack_store_new(void)
+{
+  proto_stack_store_t *pss = g_new(proto_stack_store_t, 1);
+
+  pss->stacks = g_ptr_array_new();
+  pss->stack_nums = g_hash_table_new(stack_hash, stack_equal);
+  pss->frames = g_array_new(FALSE, TRUE, sizeof(guint32));
+  pss->scratch = g_array_new(FALSE, FALSE, sizeof(int));
+  return pss;
+}
+
+void
+proto_stack_store_free(proto_stack_store_t *pss)
+{
+  if (pss == NULL)
+    return;
+  g_hash_table_destroy(pss->stack_nums);
+  free_stacks(pss->stacks);
+  g_ptr_array_free(pss->stacks, TRUE);
+  g_array_free(pss->frames, TRUE);
+  g_array_free(pss->scratch, TRUE);
+  g_free(pss);
+}
+
+void
+proto_stack_store_clear(proto_stack_store_t *pss)
+{
+  g_hash_table_remove_all(pss->stack_nums);
+  free_stacks(pss->stacks);
+  g_array_set_size(pss->frames, 0);
+}
+
+void
+proto_stack_store_record(proto_stack_store_t *pss, guint32 frame_num,
+    packet_info *pinfo)
+{
+  wmem_list_frame_t *layer;
+  GArray            *stack;
+  gpointer           value;
+  guint32            stack_num;
+  int                proto_id;
+
+  if (frame_num == 0 || pinfo->layers == NULL)
+    return;
+
+  g_array_set_size(pss->scratch, 0);
+  for (layer = wmem_list_head(pinfo->layers); layer != NULL;
+       layer = wmem_list_frame_next(layer)) {
+    proto_id = GPOINTER_TO_INT(wmem_list_frame_data(layer));
+    if (proto_id >= 0)
+      g_array_append_val(pss->scratch, proto_id);
+  }
+
+  value = g_hash_table_lookup(pss->stack_nums, pss->scratch);
+  if (value != NULL) {
+    stack_num = GPOINTER_TO_UINT(value);
+  } else {
+    stack = g_array_sized_new(FALSE, FALSE, sizeof(int), pss->scratch->len);
+    g_array_append_vals(stack, pss->scratch->data, pss->scratch->len);
+    g_ptr_array_add(pss->stacks, stack);
+    stack_num = pss->stacks->len;
+    g_hash_table_insert(pss->stack_nums, stack, GUINT_TO_POINTER(stack_num));
+  }
+
+  if (frame_num > pss->frames->len)
+    g_array_set_size(pss->frames, frame_num);
+  g_array_index(pss->frames, guint32, frame_num - 1) = stack_num;
+}
+
+guint32
+proto_stack_store_get(const proto_stack_store_t *pss, guint32 frame_num)
+{
+  if (frame_num == 0 || frame_num > pss->frames->len)
+    return 0;
+  return g_array_index(pss->frames, guint32, frame_num - 1);
+}
+
+const int *
+proto_stack_store_stack(const proto_stack_store_t *pss, guint32 stack_num,
+    guint *len)
+{
+  GArray *stack;
+
+  if (stack_num == 0 || stack_num > pss->stacks->len) {
+    *len = 0;
+    return NULL;
+  }
+  stack = (GArray *)g_ptr_array_index(pss->stacks, stack_num - 1);
+  *len = stack->len;
+  return (const int *)stack->data;
+}
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 2
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=2 tabstop=8 expandtab:
+ * :indentSize=2:tabSize=8:noTabs=true:
+ */
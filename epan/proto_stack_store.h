@@ -0,0 +1,87 @@
+/* proto_stack_store.h
+ * Definitions for the per-frame store of protocol stacks
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __PROTO_STACK_STORE_H__
+#define __PROTO_STACK_STORE_H__
+
+#include <epan/packet_info.h>
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A protocol stack store keeps, for each frame, the list of protocols
+ * that dissected it (pinfo->layers) when it was dissected, so that
+ * statistics that only need the protocols in each frame - the protocol
+ * hierarchy - can be computed without dissecting the frames again.
+ *
+ * Each distinct stack is kept once and given a number starting at 1;
+ * each frame only keeps the number of its stack.
+ */
+typedef struct _proto_stack_store proto_stack_store_t;
+
+/** Create an empty protocol stack store. */
+WS_DLL_PUBLIC proto_stack_store_t *proto_stack_store_new(void);
+
+/** Free a protocol stack store. */
+WS_DLL_PUBLIC void proto_stack_store_free(proto_stack_store_t *pss);
+
+/** Forget all recorded stacks, e.g. because every frame is going to be
+ *  dissected from scratch. */
+WS_DLL_PUBLIC void proto_stack_store_clear(proto_stack_store_t *pss);
+
+/** Record the protocols in pinfo->layers as the stack of frame frame_num.
+ *  Call after dissecting the frame and before resetting the dissection. */
+WS_DLL_PUBLIC void proto_stack_store_record(proto_stack_store_t *pss,
+    guint32 frame_num, packet_info *pinfo);
+
+/** Return the number of the stack recorded for frame frame_num, or 0 if
+ *  none was recorded. */
+WS_DLL_PUBLIC guint32 proto_stack_store_get(const proto_stack_store_t *pss,
+    guint32 frame_num);
+
+/** Return the protocol IDs in stack stack_num, outermost first, and set
+ *  *len to their number. */
+WS_DLL_PUBLIC const int *proto_stack_store_stack(const proto_stack_store_t *pss,
+    guint32 stack_num, guint *len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __PROTO_STACK_STORE_H__ */
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 2
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=2 tabstop=8 expandtab:
+ * :indentSize=2:tabSize=8:noTabs=true:
+ */
@@ -26,8 +26,13 @@
 
 #include <epan/packet.h>
 #include <epan/exceptions.h>
+#include <epan/prefs.h>
 #include <epan/reassemble.h>
 #include <epan/tvbuff-int.h>
+#include <epan/wmem/wmem_user_cb.h>
+
+#include <wsutil/file_util.h>
+#include <wsutil/tempfile.h>
 
 /*
  * Functions for reassembly tables where the endpoint addresses, and a
@@ -321,6 +326,463 @@ reassembled_hash(gconstpointer k)
 	return key->frame;
 }
 
+/*
+ * Fragment index.
+ *
+ * The fragments of a reassembly are kept in a list sorted by offset (or
+ * block sequence number).  Walking that list to find where each new
+ * fragment goes, and then again to see whether we have all the data,
+ * is quadratic in the number of fragments, which hurts with heavily
+ * reordered or retransmitted streams; instead, the head keeps a skip
+ * list over the fragments, which finds the insertion point in
+ * O(log n), and remembers how far the fragments are contiguous from
+ * the start, which only has to move forward.
+ *
+ * The index is built on first use and mirrors the fragment list, which
+ * stays exactly as it was for everything else that looks at it.  It's
+ * freed as soon as the reassembly is complete, as completed reassemblies
+ * are kept for the life of the file; if more fragments are added to one
+ * later (partial reassembly), it's built again from the list.
+ */
+#define FRAGMENT_INDEX_MAX_LEVEL	16
+
+typedef struct _fragment_index_node {
+	fragment_item *fd;
+	struct _fragment_index_node *forward[1];	/* "level" entries */
+} fragment_index_node;
+
+struct _fragment_index {
+	fragment_index_node *header;
+	guint level;
+	guint32 seed;
+
+	/* the last fragment of the run that starts at offset 0, and
+	 * where that run ends */
+	fragment_item *contig_fd;
+	guint32 contig_end;
+};
+
+static fragment_index_node *
+fragment_index_node_new(fragment_item *fd, guint level)
+{
+	fragment_index_node *node;
+
+	node = (fragment_index_node *)g_malloc0(sizeof(fragment_index_node) +
+	    (level - 1) * sizeof(fragment_index_node *));
+	node->fd = fd;
+	return node;
+}
+
+static guint
+fragment_index_random_level(struct _fragment_index *idx)
+{
+	guint level = 1;
+	guint32 bits;
+
+	/* p = 1/4 per level, using the high bits of the generator */
+	idx->seed = idx->seed * 1103515245 + 12345;
+	bits = idx->seed >> 8;
+	while (level < FRAGMENT_INDEX_MAX_LEVEL && (bits & 3) == 0) {
+		bits >>= 2;
+		level++;
+	}
+	return level;
+}
+
+/*
+ * Add fd to the index, after every fragment with an offset less than
+ * or equal to its own, and return the fragment it follows, or NULL if
+ * it goes first.
+ */
+static fragment_item *
+fragment_index_insert(struct _fragment_index *idx, fragment_item *fd)
+{
+	fragment_index_node *update[FRAGMENT_INDEX_MAX_LEVEL];
+	fragment_index_node *x, *node;
+	guint i, level;
+
+	x = idx->header;
+	for (i = idx->level; i-- > 0; ) {
+		while (x->forward[i] && x->forward[i]->fd->offset <= fd->offset)
+			x = x->forward[i];
+		update[i] = x;
+	}
+
+	level = fragment_index_random_level(idx);
+	for (i = idx->level; i < level; i++)
+		update[i] = idx->header;
+	if (level > idx->level)
+		idx->level = level;
+
+	node = fragment_index_node_new(fd, level);
+	for (i = 0; i < level; i++) {
+		node->forward[i] = update[i]->forward[i];
+		update[i]->forward[i] = node;
+	}
+
+	return x->fd;
+}
+
+/*
+ * Extend the contiguous run from the start as far as the fragments
+ * now allow.  For block sequences each fragment counts as one.
+ */
+static void
+fragment_index_extend(const fragment_head *fd_head, struct _fragment_index *idx)
+{
+	fragment_item *fd_i = idx->contig_fd;
+	guint32 end;
+
+	while (fd_i->next && fd_i->next->offset <= idx->contig_end) {
+		fd_i = fd_i->next;
+		end = fd_i->offset + ((fd_head->flags & FD_BLOCKSEQUENCE) ? 1 : fd_i->len);
+		if (end > idx->contig_end)
+			idx->contig_end = end;
+	}
+	idx->contig_fd = fd_i;
+}
+
+static struct _fragment_index *
+fragment_index_get(fragment_head *fd_head)
+{
+	struct _fragment_index *idx = fd_head->frag_index;
+	fragment_item *fd_i;
+
+	if (idx == NULL) {
+		idx = g_new(struct _fragment_index, 1);
+		idx->header = fragment_index_node_new(NULL, FRAGMENT_INDEX_MAX_LEVEL);
+		idx->level = 1;
+		idx->seed = GPOINTER_TO_UINT(fd_head);
+		for (fd_i = fd_head->next; fd_i; fd_i = fd_i->next)
+			fragment_index_insert(idx, fd_i);
+		idx->contig_fd = fd_head;
+		idx->contig_end = 0;
+		fragment_index_extend(fd_head, idx);
+		fd_head->frag_index = idx;
+	}
+	return idx;
+}
+
+static void
+fragment_index_free(fragment_head *fd_head)
+{
+	struct _fragment_index *idx = fd_head->frag_index;
+	fragment_index_node *node, *next;
+
+	if (idx == NULL)
+		return;
+	for (node = idx->header; node; node = next) {
+		next = node->forward[0];
+		g_free(node);
+	}
+	g_free(idx);
+	fd_head->frag_index = NULL;
+}
+
+/*
+ * Return how far the fragments are contiguous from the start: a byte
+ * offset, or for block sequences the number of blocks.
+ */
+static guint32
+fragment_contiguous_end(fragment_head *fd_head)
+{
+	return fragment_index_get(fd_head)->contig_end;
+}
+
+/*
+ * Reassembly memory budget.
+ *
+ * Completed reassemblies keep their data for as long as the capture
+ * file is open, so that it's there when their frames are revisited.
+ * If prefs.reassembly_memory_limit is set, we track how much data the
+ * completed reassemblies of all tables hold, and once that goes over
+ * the limit the least recently used of them are written out to a
+ * temporary file and read back in when they're next looked up.
+ *
+ * A reassembly is never written out while a dissection that looked it
+ * up still exists, as that dissection's tvbuffs and fields may point into
+ * its data: each lookup made with a packet_info pins the reassembly
+ * until that packet_info's pool is freed, i.e. until the epan_dissect_t
+ * is cleaned up.  That covers the packet being dissected and, in the
+ * GUI, the selected packet, whose dissection is kept while others are
+ * dissected.  Lookups made without a packet_info only protect the
+ * reassembly while the frame last dissected is current.
+ */
+typedef struct {
+	GList	*link;		/* in reassembly_lru, or NULL if spilled */
+	gint64	spill_offset;
+	guint32	length;
+	guint32	reported_length;
+	guint32	last_frame;	/* last frame in which it was used */
+	guint	pins;		/* dissections that may be using its data */
+	wmem_allocator_t *last_pin_pool;	/* pool of the latest of them */
+	guint64	serial;		/* tells it from a later entry at the same address */
+} reassembly_budget_entry;
+
+/* A pin taken by a dissection, released when its pool is freed */
+typedef struct {
+	fragment_head	*fd_head;
+	guint64		serial;
+} reassembly_budget_pin;
+
+static GHashTable *reassembly_budget_entries;	/* fragment_head * -> reassembly_budget_entry * */
+static GQueue	reassembly_lru;		/* fragment_head *, least recently used first */
+static guint64	reassembly_bytes_held;
+static guint64	reassembly_bytes_spilled;
+static guint32	reassembly_current_frame;
+static guint64	reassembly_budget_serial;
+static int	reassembly_spill_fd = -1;
+static char	*reassembly_spill_name;
+static gint64	reassembly_spill_end;
+
+static void
+reassembly_spill_close(void)
+{
+	if (reassembly_spill_fd == -1)
+		return;
+	ws_close(reassembly_spill_fd);
+	reassembly_spill_fd = -1;
+#ifdef _WIN32
+	/* On UN*X it was removed as soon as it was opened */
+	ws_unlink(reassembly_spill_name);
+#endif
+	g_free(reassembly_spill_name);
+	reassembly_spill_name = NULL;
+	reassembly_spill_end = 0;
+}
+
+static gboolean
+reassembly_spill_write(const guint8 *data, guint32 length, gint64 *offsetp)
+{
+	char *name;
+	guint32 done;
+	int nwritten;
+
+	if (reassembly_spill_fd == -1) {
+		reassembly_spill_fd = create_tempfile(&name, "wireshark_reassembly");
+		if (reassembly_spill_fd == -1)
+			return FALSE;
+		reassembly_spill_name = g_strdup(name);
+#ifndef _WIN32
+		ws_unlink(reassembly_spill_name);
+#endif
+		reassembly_spill_end = 0;
+	}
+
+	if (ws_lseek64(reassembly_spill_fd, reassembly_spill_end, SEEK_SET) == -1)
+		return FALSE;
+	for (done = 0; done < length; done += nwritten) {
+		nwritten = (int)ws_write(reassembly_spill_fd, data + done, length - done);
+		if (nwritten <= 0)
+			return FALSE;
+	}
+	*offsetp = reassembly_spill_end;
+	reassembly_spill_end += length;
+	return TRUE;
+}
+
+static gboolean
+reassembly_spill_read(guint8 *data, guint32 length, gint64 offset)
+{
+	guint32 done;
+	int nread;
+
+	if (reassembly_spill_fd == -1 ||
+	    ws_lseek64(reassembly_spill_fd, offset, SEEK_SET) == -1)
+		return FALSE;
+	for (done = 0; done < length; done += nread) {
+		nread = (int)ws_read(reassembly_spill_fd, data + done, length - done);
+		if (nread <= 0)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/* Write out the data of a completed reassembly and free it. */
+static gboolean
+reassembly_spill(fragment_head *fd_head, reassembly_budget_entry *entry)
+{
+	guint8 *data;
+	gboolean ok;
+
+	data = (guint8 *)tvb_memdup(NULL, fd_head->tvb_data, 0, entry->length);
+	ok = reassembly_spill_write(data, entry->length, &entry->spill_offset);
+	wmem_free(NULL, data);
+	if (!ok)
+		return FALSE;
+
+	tvb_free(fd_head->tvb_data);
+	fd_head->tvb_data = NULL;
+	g_queue_delete_link(&reassembly_lru, entry->link);
+	entry->link = NULL;
+	reassembly_bytes_held -= entry->length;
+	reassembly_bytes_spilled += entry->length;
+	return TRUE;
+}
+
+static void
+reassembly_enforce_budget(void)
+{
+	guint64 limit = (guint64)prefs.reassembly_memory_limit * 1024 * 1024;
+	GList *link, *next;
+	fragment_head *fd_head;
+	reassembly_budget_entry *entry;
+
+	/* Least recently used first, skipping those that may be in use */
+	for (link = reassembly_lru.head;
+	    limit != 0 && reassembly_bytes_held > limit && link != NULL;
+	    link = next) {
+		next = link->next;
+		fd_head = (fragment_head *)link->data;
+		entry = (reassembly_budget_entry *)g_hash_table_lookup(reassembly_budget_entries, fd_head);
+		if (entry->pins != 0 || entry->last_frame == reassembly_current_frame)
+			continue;
+		if (!reassembly_spill(fd_head, entry))
+			break;
+	}
+}
+
+static gboolean
+reassembly_budget_unpin(wmem_allocator_t *allocator, wmem_cb_event_t event _U_,
+    void *user_data)
+{
+	reassembly_budget_pin *pin = (reassembly_budget_pin *)user_data;
+	reassembly_budget_entry *entry;
+
+	entry = (reassembly_budget_entry *)g_hash_table_lookup(reassembly_budget_entries, pin->fd_head);
+	/* It may have been forgotten, and its address reused, since */
+	if (entry != NULL && entry->serial == pin->serial) {
+		entry->pins--;
+		if (entry->last_pin_pool == allocator)
+			entry->last_pin_pool = NULL;
+	}
+	g_slice_free(reassembly_budget_pin, pin);
+
+	/* Only once per pin */
+	return FALSE;
+}
+
+/* Keep a reassembly's data in memory for as long as pinfo's dissection exists. */
+static void
+reassembly_budget_pin_for(fragment_head *fd_head, reassembly_budget_entry *entry,
+    const packet_info *pinfo)
+{
+	reassembly_budget_pin *pin;
+
+	if (pinfo == NULL || pinfo->pool == NULL ||
+	    entry->last_pin_pool == pinfo->pool)
+		return;
+
+	pin = g_slice_new(reassembly_budget_pin);
+	pin->fd_head = fd_head;
+	pin->serial = entry->serial;
+	wmem_register_callback(pinfo->pool, reassembly_budget_unpin, pin);
+	entry->pins++;
+	entry->last_pin_pool = pinfo->pool;
+}
+
+/* Start accounting for the data of a reassembly that has just completed. */
+static void
+reassembly_budget_track(fragment_head *fd_head, const packet_info *pinfo)
+{
+	reassembly_budget_entry *entry;
+
+	if (prefs.reassembly_memory_limit == 0 || fd_head->tvb_data == NULL ||
+	    (fd_head->flags & FD_SUBSET_TVB))
+		return;
+
+	if (reassembly_budget_entries == NULL) {
+		reassembly_budget_entries = g_hash_table_new(g_direct_hash, g_direct_equal);
+		g_queue_init(&reassembly_lru);
+	} else if (g_hash_table_lookup(reassembly_budget_entries, fd_head) != NULL)
+		return;
+
+	entry = g_slice_new(reassembly_budget_entry);
+	g_queue_push_tail(&reassembly_lru, fd_head);
+	entry->link = g_queue_peek_tail_link(&reassembly_lru);
+	entry->spill_offset = 0;
+	entry->length = tvb_captured_length(fd_head->tvb_data);
+	entry->reported_length = tvb_reported_length(fd_head->tvb_data);
+	entry->last_frame = reassembly_current_frame = pinfo->fd->num;
+	entry->pins = 0;
+	entry->last_pin_pool = NULL;
+	entry->serial = ++reassembly_budget_serial;
+	g_hash_table_insert(reassembly_budget_entries, fd_head, entry);
+	reassembly_bytes_held += entry->length;
+	reassembly_budget_pin_for(fd_head, entry, pinfo);
+
+	reassembly_enforce_budget();
+}
+
+/*
+ * A reassembly has been looked up; make sure its data is in memory, and
+ * mark it as the most recently used.
+ */
+static void
+reassembly_budget_touch(fragment_head *fd_head, const packet_info *pinfo)
+{
+	reassembly_budget_entry *entry;
+	guint8 *data;
+
+	if (fd_head == NULL || reassembly_budget_entries == NULL)
+		return;
+	entry = (reassembly_budget_entry *)g_hash_table_lookup(reassembly_budget_entries, fd_head);
+	if (entry == NULL)
+		return;
+
+	if (pinfo != NULL)
+		reassembly_current_frame = pinfo->fd->num;
+	entry->last_frame = reassembly_current_frame;
+	reassembly_budget_pin_for(fd_head, entry, pinfo);
+
+	if (entry->link != NULL) {
+		g_queue_unlink(&reassembly_lru, entry->link);
+		g_queue_push_tail_link(&reassembly_lru, entry->link);
+		return;
+	}
+
+	data = (guint8 *)g_malloc(entry->length);
+	if (!reassembly_spill_read(data, entry->length, entry->spill_offset)) {
+		g_free(data);
+		THROW_MESSAGE(ReassemblyError, "Reassembled data could not be read back from the temporary file");
+	}
+	fd_head->tvb_data = tvb_new_real_data(data, entry->length, entry->reported_length);
+	tvb_set_free_cb(fd_head->tvb_data, g_free);
+	g_queue_push_tail(&reassembly_lru, fd_head);
+	entry->link = g_queue_peek_tail_link(&reassembly_lru);
+	reassembly_bytes_spilled -= entry->length;
+	reassembly_bytes_held += entry->length;
+
+	reassembly_enforce_budget();
+}
+
+/*
+ * Stop accounting for a reassembly, because it's being freed or is
+ * being reopened to add more data.  Its data must be in memory.
+ */
+static void
+reassembly_budget_forget(fragment_head *fd_head)
+{
+	reassembly_budget_entry *entry;
+
+	if (reassembly_budget_entries == NULL)
+		return;
+	entry = (reassembly_budget_entry *)g_hash_table_lookup(reassembly_budget_entries, fd_head);
+	if (entry == NULL)
+		return;
+
+	if (entry->link != NULL) {
+		g_queue_delete_link(&reassembly_lru, entry->link);
+		reassembly_bytes_held -= entry->length;
+	} else {
+		reassembly_bytes_spilled -= entry->length;
+		if (reassembly_bytes_spilled == 0)
+			reassembly_spill_close();
+	}
+	g_hash_table_remove(reassembly_budget_entries, fd_head);
+	g_slice_free(reassembly_budget_entry, entry);
+}
+
 /*
  * For a fragment hash table entry, free the associated fragments.
  * The entry value (fd_chain) is freed herein and the entry is freed
@@ -336,11 +798,13 @@ free_all_fragments(gpointer key_arg _U_, gpointer value, gpointer user_data _U_)
 	/* g_hash_table_new_full() was used to supply a function
 	 * to free the key and anything to which it points
 	 */
+	reassembly_budget_forget((fragment_head *)value);
 	for (fd_head = (fragment_head *)value; fd_head != NULL; fd_head = tmp_fd) {
 		tmp_fd=fd_head->next;
 
 		if(fd_head->tvb_data && !(fd_head->flags&FD_SUBSET_TVB))
 			tvb_free(fd_head->tvb_data);
+		fragment_index_free(fd_head);
 		g_slice_free(fragment_item, fd_head);
 	}
 
@@ -400,11 +864,16 @@ free_fragments(gpointer data, gpointer user_data _U_)
 {
 	fragment_item *fd_head = (fragment_item *) data;
 
+	reassembly_budget_forget(fd_head);
 	if (fd_head->tvb_data)
 		tvb_free(fd_head->tvb_data);
+	fragment_index_free(fd_head);
 	g_slice_free(fragment_item, fd_head);
 }
 
+/* All initialized reassembly tables, for reassembly_table_foreach_stats() */
+static GSList *reassembly_tables;
+
 /*
  * Initialize a reassembly table, with specified functions.
  */
@@ -412,6 +881,14 @@ void
 reassembly_table_init(reassembly_table *table,
 		      const reassembly_table_functions *funcs)
 {
+	/* Not only when the hash tables are created, so that a table whose
+	   memory was reused without reassembly_table_destroy() being called
+	   can't end up on the list twice */
+	if (g_slist_find(reassembly_tables, table) == NULL)
+		reassembly_tables = g_slist_prepend(reassembly_tables, table);
+	table->fragments_added = 0;
+	table->lookups = 0;
+
 	if (table->temporary_key_func == NULL)
 		table->temporary_key_func = funcs->temporary_key_func;
 	if (table->persistent_key_func == NULL)
@@ -471,6 +948,13 @@ reassembly_table_destroy(reassembly_table *table)
 	table->temporary_key_func = NULL;
 	table->persistent_key_func = NULL;
 	table->free_temporary_key_func = NULL;
+
+	/*
+	 * Take it off the list of tables, whether or not it was ever
+	 * initialized, so the list never points at a table whose memory
+	 * has been freed.
+	 */
+	reassembly_tables = g_slist_remove_all(reassembly_tables, table);
 	if (table->fragment_table != NULL) {
 		/*
 		 * The fragment hash table exists.
@@ -515,6 +999,71 @@ reassembly_table_destroy(reassembly_table *table)
 	}
 }
 
+static void
+reassembly_stats_add_head(reassembly_table_stats *stats, const fragment_head *fd_head)
+{
+	const fragment_item *fd;
+
+	if (fd_head->flags & FD_DEFRAGMENTED) {
+		stats->completed++;
+		if (fd_head->tvb_data)
+			stats->bytes_reassembled += tvb_captured_length(fd_head->tvb_data);
+	} else
+		stats->in_progress++;
+
+	for (fd = fd_head->next; fd; fd = fd->next) {
+		stats->fragments++;
+		if (fd->flags & FD_OVERLAP)
+			stats->overlaps++;
+		if (fd->tvb_data && !(fd->flags & FD_SUBSET_TVB))
+			stats->bytes_buffered += tvb_captured_length(fd->tvb_data);
+	}
+}
+
+void
+reassembly_table_foreach_stats(reassembly_stats_func func, gpointer user_data)
+{
+	GSList *entry;
+	reassembly_table *table;
+	reassembly_table_stats stats;
+	GHashTable *seen;
+	GHashTableIter iter;
+	gpointer value;
+
+	for (entry = reassembly_tables; entry; entry = entry->next) {
+		table = (reassembly_table *)entry->data;
+
+		memset(&stats, 0, sizeof stats);
+		stats.proto_name = table->proto_name;
+		stats.fragments_added = table->fragments_added;
+		stats.lookups = table->lookups;
+
+		/* A completed reassembly is in the reassembled table once
+		 * for each of its frames, and may also still be in the
+		 * fragment table; count it once. */
+		seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+		if (table->fragment_table) {
+			g_hash_table_iter_init(&iter, table->fragment_table);
+			while (g_hash_table_iter_next(&iter, NULL, &value)) {
+				g_hash_table_insert(seen, value, value);
+				reassembly_stats_add_head(&stats, (fragment_head *)value);
+			}
+		}
+		if (table->reassembled_table) {
+			g_hash_table_iter_init(&iter, table->reassembled_table);
+			while (g_hash_table_iter_next(&iter, NULL, &value)) {
+				if (g_hash_table_lookup(seen, value) == NULL) {
+					g_hash_table_insert(seen, value, value);
+					reassembly_stats_add_head(&stats, (fragment_head *)value);
+				}
+			}
+		}
+		g_hash_table_destroy(seen);
+
+		func(&stats, user_data);
+	}
+}
+
 /*
  * Look up an fd_head in the fragment table, optionally returning the key
  * for it.
@@ -526,6 +1075,10 @@ lookup_fd_head(reassembly_table *table, const packet_info *pinfo,
 	gpointer key;
 	gpointer value;
 
+	table->lookups++;
+	if (table->proto_name == NULL)
+		table->proto_name = pinfo->current_proto;
+
 	/* Create key to search hash with */
 	key = table->temporary_key_func(pinfo, id, data);
 
@@ -538,9 +1091,26 @@ lookup_fd_head(reassembly_table *table, const packet_info *pinfo,
 	/* Free the key */
 	table->free_temporary_key_func(key);
 
+	reassembly_budget_touch((fragment_head *)value, pinfo);
 	return (fragment_head *)value;
 }
 
+/*
+ * Look up a reassembly, by the frame number and ID, in a table of
+ * completed reassemblies.
+ */
+static fragment_head *
+lookup_reassembled_head(reassembly_table *table, const packet_info *pinfo,
+			reassembled_key *key)
+{
+	fragment_head *fd_head;
+
+	table->lookups++;
+	fd_head = (fragment_head *)g_hash_table_lookup(table->reassembled_table, key);
+	reassembly_budget_touch(fd_head, pinfo);
+	return fd_head;
+}
+
 /*
  * Insert an fd_head into the fragment table, and return the key used.
  */
@@ -586,6 +1156,7 @@ fragment_delete(reassembly_table *table, const packet_info *pinfo,
 		return NULL;
 	}
 
+	reassembly_budget_forget(fd_head);
 	fd_tvb_data=fd_head->tvb_data;
 	/* loop over all partial fragments and free any tvbuffs */
 	for(fd=fd_head->next;fd;){
@@ -597,6 +1168,7 @@ fragment_delete(reassembly_table *table, const packet_info *pinfo,
 		g_slice_free(fragment_item, fd);
 		fd=tmp_fd;
 	}
+	fragment_index_free(fd_head);
 	g_slice_free(fragment_head, fd_head);
 	g_hash_table_remove(table->fragment_table, key);
 
@@ -624,6 +1196,7 @@ fragment_get_reassembled(reassembly_table *table, const guint32 id)
 	key.frame = id;
 	key.id = id;
 	fd_head = (fragment_head *)g_hash_table_lookup(table->reassembled_table, &key);
+	reassembly_budget_touch(fd_head, NULL);
 
 	return fd_head;
 }
@@ -639,6 +1212,7 @@ fragment_get_reassembled_id(reassembly_table *table, const packet_info *pinfo,
 	key.frame = pinfo->fd->num;
 	key.id = id;
 	fd_head = (fragment_head *)g_hash_table_lookup(table->reassembled_table, &key);
+	reassembly_budget_touch(fd_head, pinfo);
 
 	return fd_head;
 }
@@ -819,20 +1393,32 @@ fragment_reassembled(reassembly_table *table, fragment_head *fd_head,
 	}
 	fd_head->flags |= FD_DEFRAGMENTED;
 	fd_head->reassembled_in = pinfo->fd->num;
+	fragment_index_free(fd_head);
+	reassembly_budget_track(fd_head, pinfo);
 }
 
 static void
 LINK_FRAG(fragment_head *fd_head,fragment_item *fd)
 {
+	struct _fragment_index *idx = fragment_index_get(fd_head);
 	fragment_item *fd_i;
+	guint32 end;
 
 	/* add fragment to list, keep list sorted */
-	for(fd_i= fd_head; fd_i->next;fd_i=fd_i->next) {
-		if (fd->offset < fd_i->next->offset )
-			break;
-	}
+	fd_i = fragment_index_insert(idx, fd);
+	if (fd_i == NULL)
+		fd_i = fd_head;
 	fd->next=fd_i->next;
 	fd_i->next=fd;
+
+	/* a fragment going in before the end of the contiguous run
+	 * from the start is part of it */
+	if (idx->contig_fd != fd_head && fd->offset < idx->contig_fd->offset) {
+		end = fd->offset + ((fd_head->flags & FD_BLOCKSEQUENCE) ? 1 : fd->len);
+		if (end > idx->contig_end)
+			idx->contig_end = end;
+	}
+	fragment_index_extend(fd_head, idx);
 }
 
 /*
@@ -856,6 +1442,81 @@ LINK_FRAG(fragment_head *fd_head,fragment_item *fd)
  * with the new fragment. FD_TOOLONGFRAGMENT and FD_MULTIPLETAILS flags
  * are lowered when a new extension process is started.
  */
+/*
+ * If the fragments of fd_head, in order, make up the reassembled data
+ * exactly -- no gaps, no overlaps or retransmissions, and no data shared
+ * with an earlier reassembly of the same packet -- hand the fragments'
+ * own copies of their data over to a composite tvbuff rather than
+ * copying them all into a new buffer.
+ *
+ * If by_offset is TRUE, fragment offsets are byte offsets, otherwise
+ * they are block sequence numbers.
+ *
+ * Returns the reassembled data, or NULL if it has to be copied.
+ */
+static tvbuff_t *
+fragment_compose(fragment_head *fd_head, const guint32 size, const gboolean by_offset)
+{
+	fragment_item *fd_i;
+	fragment_item *last_fd = NULL;
+	fragment_item *first_fd = NULL;
+	guint32 dfpos = 0;
+	guint	count = 0;
+	tvbuff_t *tvb;
+
+	if (fd_head->tvb_data)
+		return NULL;
+
+	for (fd_i = fd_head->next; fd_i; fd_i = fd_i->next) {
+		if (!fd_i->tvb_data || (fd_i->flags & FD_SUBSET_TVB))
+			return NULL;
+		if (by_offset) {
+			if (fd_i->len && fd_i->offset != dfpos)
+				return NULL;
+		} else {
+			if (last_fd && last_fd->offset == fd_i->offset)
+				return NULL;
+		}
+		if (tvb_captured_length(fd_i->tvb_data) != fd_i->len ||
+		    fd_i->len > size - dfpos)
+			return NULL;
+		if (fd_i->len) {
+			if (!first_fd)
+				first_fd = fd_i;
+			dfpos += fd_i->len;
+			count++;
+		}
+		last_fd = fd_i;
+	}
+	if (dfpos != size || count == 0)
+		return NULL;
+
+	if (count == 1) {
+		tvb = first_fd->tvb_data;
+		first_fd->tvb_data = NULL;
+	} else {
+		tvb = tvb_new_composite();
+		tvb_composite_own_members(tvb);
+		for (fd_i = first_fd; fd_i; fd_i = fd_i->next) {
+			if (fd_i->len) {
+				tvb_composite_append(tvb, fd_i->tvb_data);
+				fd_i->tvb_data = NULL;
+			}
+		}
+		tvb_composite_finalize(tvb);
+	}
+
+	/* Whatever is left is zero-length */
+	for (fd_i = fd_head->next; fd_i; fd_i = fd_i->next) {
+		if (fd_i->tvb_data) {
+			tvb_free(fd_i->tvb_data);
+			fd_i->tvb_data = NULL;
+		}
+	}
+
+	return tvb;
+}
+
 static gboolean
 fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 		 const packet_info *pinfo, const guint32 frag_offset,
@@ -865,6 +1526,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	fragment_item *fd_i;
 	guint32 max, dfpos, fraglen;
 	tvbuff_t *old_tvb_data;
+	tvbuff_t *composed;
 	guint8 *data;
 
 	/* create new fd describing this fragment */
@@ -877,6 +1539,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	fd->len  = frag_data_len;
 	fd->tvb_data = NULL;
 	fd->error = NULL;
+	fd->frag_index = NULL;
 
 	/*
 	 * Are we adding to an already-completed reassembly?
@@ -905,6 +1568,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 					}
 					fd_i->flags &= (~FD_TOOLONGFRAGMENT) & (~FD_MULTIPLETAILS);
 				}
+				reassembly_budget_forget(fd_head);
 				fd_head->flags &= ~(FD_DEFRAGMENTED|FD_PARTIAL_REASSEMBLY|FD_DATALEN_SET);
 				fd_head->flags &= (~FD_TOOLONGFRAGMENT) & (~FD_MULTIPLETAILS);
 				fd_head->datalen=0;
@@ -1037,13 +1701,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	 * previous fragment, i.e. fragments that have a gap between
 	 * them and the previous fragment.)
 	 */
-	max = 0;
-	for (fd_i=fd_head->next;fd_i;fd_i=fd_i->next) {
-		if ( ((fd_i->offset)<=max) &&
-			((fd_i->offset+fd_i->len)>max) ){
-			max = fd_i->offset+fd_i->len;
-		}
-	}
+	max = fragment_contiguous_end(fd_head);
 
 	if (max < (fd_head->datalen)) {
 		/*
@@ -1057,6 +1715,16 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	/* we have received an entire packet, defragment it and
 	 * free all fragments
 	 */
+	composed = fragment_compose(fd_head, fd_head->datalen, TRUE);
+	if (composed) {
+		fd_head->tvb_data = composed;
+		fd_head->flags |= FD_DEFRAGMENTED;
+		fd_head->reassembled_in=pinfo->fd->num;
+		fragment_index_free(fd_head);
+		reassembly_budget_track(fd_head, pinfo);
+		return TRUE;
+	}
+
 	/* store old data just in case */
 	old_tvb_data=fd_head->tvb_data;
 	data = (guint8 *) g_malloc(fd_head->datalen);
@@ -1187,6 +1855,8 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	   allows us to skip any trailing fragments */
 	fd_head->flags |= FD_DEFRAGMENTED;
 	fd_head->reassembled_in=pinfo->fd->num;
+	fragment_index_free(fd_head);
+	reassembly_budget_track(fd_head, pinfo);
 
 	/* we don't throw until here to avoid leaking old_data and others */
 	if (fd_head->error) {
@@ -1211,6 +1881,8 @@ fragment_add_common(reassembly_table *table, tvbuff_t *tvb, const int offset,
 	/* dissector shouldn't give us garbage tvb info */
 	DISSECTOR_ASSERT(tvb_bytes_exist(tvb, offset, frag_data_len));
 
+	table->fragments_added++;
+
 	fd_head = lookup_fd_head(table, pinfo, id, data, NULL);
 
 #if 0
@@ -1422,7 +2094,7 @@ fragment_add_check(reassembly_table *table, tvbuff_t *tvb, const int offset,
 	if (pinfo->fd->flags.visited) {
 		reass_key.frame = pinfo->fd->num;
 		reass_key.id = id;
-		return (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
+		return lookup_reassembled_head(table, pinfo, &reass_key);
 	}
 
 	/* Looks up a key in the GHashTable, returning the original key and the associated value
@@ -1484,6 +2156,7 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 	fragment_item *last_fd = NULL;
 	guint32  dfpos = 0, size = 0;
 	tvbuff_t *old_tvb_data = NULL;
+	tvbuff_t *composed;
 	guint8 *data;
 
 	for(fd_i=fd_head->next;fd_i;fd_i=fd_i->next) {
@@ -1493,12 +2166,24 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 		last_fd=fd_i;
 	}
 
+	fd_head->len = size;		/* record size for caller	*/
+
+	/* if the fragments line up, keep their data rather than copying it */
+	composed = fragment_compose(fd_head, size, FALSE);
+	if (composed) {
+		fd_head->tvb_data = composed;
+		fd_head->flags |= FD_DEFRAGMENTED;
+		fd_head->reassembled_in=pinfo->fd->num;
+		fragment_index_free(fd_head);
+		reassembly_budget_track(fd_head, pinfo);
+		return;
+	}
+
 	/* store old data in case the fd_i->data pointers refer to it */
 	old_tvb_data=fd_head->tvb_data;
 	data = (guint8 *) g_malloc(size);
 	fd_head->tvb_data = tvb_new_real_data(data, size, size);
 	tvb_set_free_cb(fd_head->tvb_data, g_free);
-	fd_head->len = size;		/* record size for caller	*/
 
 	/* add all data fragments */
 	last_fd=NULL;
@@ -1538,6 +2223,8 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 	 */
 	fd_head->flags |= FD_DEFRAGMENTED;
 	fd_head->reassembled_in=pinfo->fd->num;
+	fragment_index_free(fd_head);
+	reassembly_budget_track(fd_head, pinfo);
 }
 
 /*
@@ -1591,6 +2278,7 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 			}
 			fd_i->flags &= (~FD_TOOLONGFRAGMENT) & (~FD_MULTIPLETAILS);
 		}
+		reassembly_budget_forget(fd_head);
 		fd_head->flags &= ~(FD_DEFRAGMENTED|FD_PARTIAL_REASSEMBLY|FD_DATALEN_SET);
 		fd_head->flags &= (~FD_TOOLONGFRAGMENT) & (~FD_MULTIPLETAILS);
 		fd_head->datalen=0;
@@ -1607,6 +2295,7 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	fd->len  = frag_data_len;
 	fd->tvb_data = NULL;
 	fd->error = NULL;
+	fd->frag_index = NULL;
 
 	if (!more_frags) {
 		/*
@@ -1753,12 +2442,7 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	 * this is easy since the list is sorted and the head is faked.
 	 * common case the whole list is scanned.
 	 */
-	max = 0;
-	for(fd_i=fd_head->next;fd_i;fd_i=fd_i->next) {
-	  if ( fd_i->offset==max ){
-		max++;
-	  }
-	}
+	max = fragment_contiguous_end(fd_head);
 	/* max will now be datalen+1 if all fragments have been seen */
 
 	if (max <= fd_head->datalen) {
@@ -1805,6 +2489,7 @@ fragment_add_seq_common(reassembly_table *table, tvbuff_t *tvb,
 	fragment_head *fd_head;
 	gpointer orig_key;
 
+	table->fragments_added++;
 	fd_head = lookup_fd_head(table, pinfo, id, data, &orig_key);
 
 	/* have we already seen this frame ?*/
@@ -1986,7 +2671,7 @@ fragment_add_seq_check_work(reassembly_table *table, tvbuff_t *tvb,
 	if (pinfo->fd->flags.visited) {
 		reass_key.frame = pinfo->fd->num;
 		reass_key.id = id;
-		return (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
+		return lookup_reassembled_head(table, pinfo, &reass_key);
 	}
 
 	fd_head = fragment_add_seq_common(table, tvb, offset, pinfo, id, data,
@@ -2087,6 +2772,7 @@ fragment_start_seq_check(reassembly_table *table, const packet_info *pinfo,
 		fd_head->len = 0;
 		fd_head->flags = FD_BLOCKSEQUENCE|FD_DATALEN_SET;
 		fd_head->tvb_data = NULL;
+		fd_head->frag_index = NULL;
 		fd_head->reassembled_in = 0;
 		fd_head->error = NULL;
 
@@ -2110,7 +2796,7 @@ fragment_end_seq_next(reassembly_table *table, const packet_info *pinfo,
 	if (pinfo->fd->flags.visited) {
 		reass_key.frame = pinfo->fd->num;
 		reass_key.id = id;
-		return (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
+		return lookup_reassembled_head(table, pinfo, &reass_key);
 	}
 
 	fd_head = lookup_fd_head(table, pinfo, id, data, &orig_key);
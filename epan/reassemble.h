@@ -29,6 +29,10 @@
 
 #include "ws_symbol_export.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
 /* only in fd_head: packet is defragmented */
 #define FD_DEFRAGMENTED		0x0001
 
@@ -98,6 +102,14 @@ typedef struct _fragment_item {
 	 * reassembly and for the fragments in a reassembly.
 	 */
 	const char *error;
+
+	/*
+	 * Only used in the reassembly head; an index of the fragments
+	 * by offset, used by the reassembly code to insert fragments
+	 * and to track how much contiguous data there is.  Private to
+	 * reassemble.c.
+	 */
+	struct _fragment_index *frag_index;
 } fragment_item, fragment_head;
 
 
@@ -133,6 +145,11 @@ typedef struct {
 	fragment_temporary_key temporary_key_func;
 	fragment_persistent_key persistent_key_func;
 	GDestroyNotify free_temporary_key_func;		/* temporary key destruction function */
+
+	/* For reassembly_table_foreach_stats() */
+	const char *proto_name;		/* protocol that first used the table */
+	guint64 fragments_added;
+	guint64 lookups;
 } reassembly_table;
 
 /*
@@ -162,7 +179,9 @@ WS_DLL_PUBLIC const reassembly_table_functions
  *
  * init: If table doesn't exist: create table;
  *       else: just remove any entries;
- * destroy: remove entries and destroy table;
+ * destroy: remove entries and destroy table, and stop reporting it in
+ *          reassembly_table_foreach_stats().  A table that isn't static
+ *          must be destroyed before its memory is freed or reused.
  */
 WS_DLL_PUBLIC void
 reassembly_table_init(reassembly_table *table,
@@ -170,6 +189,31 @@ reassembly_table_init(reassembly_table *table,
 WS_DLL_PUBLIC void
 reassembly_table_destroy(reassembly_table *table);
 
+/*
+ * Statistics for a reassembly table, as of the time they're asked for.
+ */
+typedef struct {
+	const char *proto_name;		/* protocol that uses the table, or NULL if unused */
+	guint	in_progress;		/* reassemblies still waiting for fragments */
+	guint	completed;		/* completed reassemblies */
+	guint64	fragments;		/* fragments of all of those */
+	guint64	overlaps;		/* fragments that overlapped others */
+	guint64	bytes_buffered;		/* fragment data waiting to be reassembled */
+	guint64	bytes_reassembled;	/* data of completed reassemblies held in memory */
+	guint64	fragments_added;	/* fragments passed to the table since it was initialized */
+	guint64	lookups;		/* lookups in the table since it was initialized */
+} reassembly_table_stats;
+
+typedef void (*reassembly_stats_func)(const reassembly_table_stats *stats, gpointer user_data);
+
+/*
+ * Call func with the statistics of each initialized reassembly table.
+ * This walks every reassembly in every table, so it's meant for
+ * occasional use, not for every packet.
+ */
+WS_DLL_PUBLIC void
+reassembly_table_foreach_stats(reassembly_stats_func func, gpointer user_data);
+
 /*
  * This function adds a new fragment to the reassembly table
  * If this is the first fragment seen for this datagram, a new entry
@@ -381,4 +425,8 @@ WS_DLL_PUBLIC gboolean
 show_fragment_seq_tree(fragment_head *ipfd_head, const fragment_items *fit,
     proto_tree *tree, packet_info *pinfo, tvbuff_t *tvb, proto_item **fi);
 
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
 #endif
@@ -120,6 +120,9 @@ free_stat_node(stat_node *node)
     if(node->st->cfg->free_node_pr) node->st->cfg->free_node_pr(node);
 
     if (node->hash) g_hash_table_destroy(node->hash);
+    if (node->int_hash) g_hash_table_destroy(node->int_hash);
+    g_free(node->int_children);
+    g_free(node->rng_children);
 
     while (node->bh) {
         bucket = node->bh;
@@ -141,6 +144,8 @@ stats_tree_free(stats_tree *st)
 
     g_free(st->filter);
     g_hash_table_destroy(st->names);
+    if (st->root.int_hash) g_hash_table_destroy(st->root.int_hash);
+    g_free(st->root.int_children);
     g_ptr_array_free(st->parents,TRUE);
     g_free(st->display_name);
 
@@ -226,6 +231,12 @@ stats_tree_reinit(void *p)
     }
 
     st->root.children = NULL;
+    if (st->root.int_hash) {
+        g_hash_table_destroy(st->root.int_hash);
+        st->root.int_hash = NULL;
+    }
+    g_free(st->root.int_children);
+    st->root.int_children = NULL;
     st->root.counter = 0;
     st->root.total = 0;
     st->root.minvalue = G_MAXINT;
@@ -623,32 +634,10 @@ update_burst_calc(stat_node *node, gint value)
     }
 }
 
-/*
- * Increases by delta the counter of the node whose name is given
- * if the node does not exist yet it's created (with counter=1)
- * using parent_name as parent node.
- * with_hash=TRUE to indicate that the created node will have a parent
- */
-extern int
-stats_tree_manip_node(manip_node_mode mode, stats_tree *st, const char *name,
-              int parent_id, gboolean with_hash, gint value)
+/* the body of stats_tree_manip_node() once the node's been found */
+static int
+manip_stat_node(manip_node_mode mode, stat_node *node, gint value)
 {
-    stat_node *node = NULL;
-    stat_node *parent = NULL;
-
-    g_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
-
-    parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
-
-    if( parent->hash ) {
-        node = (stat_node *)g_hash_table_lookup(parent->hash,name);
-    } else {
-        node = (stat_node *)g_hash_table_lookup(st->names,name);
-    }
-
-    if ( node == NULL )
-        node = new_stat_node(st,name,parent_id,with_hash,with_hash);
-
     switch (mode) {
         case MN_INCREASE:
                 node->counter += value;
@@ -677,12 +666,111 @@ stats_tree_manip_node(manip_node_mode mode, stats_tree *st, const char *name,
                 break;
     }
 
-    if (node)
-        return node->id;
-    else
-        return -1;
+    return node->id;
+}
+
+/*
+ * Increases by delta the counter of the node whose name is given
+ * if the node does not exist yet it's created (with counter=1)
+ * using parent_name as parent node.
+ * with_hash=TRUE to indicate that the created node will have a parent
+ */
+extern int
+stats_tree_manip_node(manip_node_mode mode, stats_tree *st, const char *name,
+              int parent_id, gboolean with_hash, gint value)
+{
+    stat_node *node = NULL;
+    stat_node *parent = NULL;
+
+    g_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
+
+    parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
+
+    if( parent->hash ) {
+        node = (stat_node *)g_hash_table_lookup(parent->hash,name);
+    } else {
+        node = (stat_node *)g_hash_table_lookup(st->names,name);
+    }
+
+    if ( node == NULL )
+        node = new_stat_node(st,name,parent_id,with_hash,with_hash);
+
+    return manip_stat_node(mode, node, value);
+}
+
+gchar *
+stats_tree_vals_name(guint32 key, const void *name_data)
+{
+    const stat_node_vals_t *nv = (const stat_node_vals_t *)name_data;
+    const gchar *str = try_val_to_str(key, nv->vals);
+
+    if (str)
+        return g_strdup(str);
+    return g_strdup_printf(nv->unknown_fmt, key);
+}
+
+/* finds the child of parent with the given integer key, or NULL */
+static stat_node *
+lookup_int_node(stat_node *parent, guint32 key)
+{
+    if (key < ST_INT_DIRECT_KEYS) {
+        return parent->int_children ? parent->int_children[key] : NULL;
+    }
+    if (parent->int_hash) {
+        return (stat_node *)g_hash_table_lookup(parent->int_hash, GUINT_TO_POINTER(key));
+    }
+    return NULL;
 }
 
+static void
+insert_int_node(stat_node *parent, guint32 key, stat_node *node)
+{
+    if (key < ST_INT_DIRECT_KEYS) {
+        if (!parent->int_children)
+            parent->int_children = g_new0(stat_node *, ST_INT_DIRECT_KEYS);
+        parent->int_children[key] = node;
+    } else {
+        if (!parent->int_hash)
+            parent->int_hash = g_hash_table_new(g_direct_hash, g_direct_equal);
+        g_hash_table_insert(parent->int_hash, GUINT_TO_POINTER(key), node);
+    }
+}
+
+/*
+ * As stats_tree_manip_node(), but the node is found by an integer key
+ * among parent_id's children, and its name is only made if it has to be
+ * created.
+ */
+extern int
+stats_tree_manip_node_int(manip_node_mode mode, stats_tree *st, guint32 key,
+              stat_node_name_func name_func, const void *name_data,
+              int parent_id, gboolean with_hash, gint value)
+{
+    stat_node *node;
+    stat_node *parent;
+
+    g_assert( parent_id >= 0 && parent_id < (int) st->parents->len );
+
+    parent = (stat_node *)g_ptr_array_index(st->parents,parent_id);
+    node = lookup_int_node(parent, key);
+
+    if ( node == NULL ) {
+        gchar *name = name_func(key, name_data);
+
+        /* it may have been created by name */
+        if( parent->hash ) {
+            node = (stat_node *)g_hash_table_lookup(parent->hash,name);
+        } else {
+            node = (stat_node *)g_hash_table_lookup(st->names,name);
+        }
+        if ( node == NULL )
+            node = new_stat_node(st,name,parent_id,with_hash,with_hash);
+        insert_int_node(parent, key, node);
+        g_free(name);
+    }
+
+    return manip_stat_node(mode, node, value);
+}
 
 extern char*
 stats_tree_get_abbr(const char *opt_arg)
@@ -761,6 +849,53 @@ get_range(char *rngstr)
 }
 
 
+static int
+range_child_cmp(const void *a, const void *b)
+{
+    const stat_node *na = *(const stat_node * const *)a;
+    const stat_node *nb = *(const stat_node * const *)b;
+
+    if (na->rng->floor < nb->rng->floor)
+        return -1;
+    return na->rng->floor > nb->rng->floor;
+}
+
+/*
+ * Sorts a range node's children by their ranges so that
+ * stats_tree_tick_range() can find a value's range by a binary search;
+ * if the ranges overlap, the first in the list has to win, so they're
+ * left to be searched in order.
+ */
+static void
+index_range_node(stat_node *rng_root)
+{
+    stat_node *child;
+    guint n = 0;
+    guint i;
+
+    for (child = rng_root->children; child; child = child->next) {
+        if (!child->rng || child->rng->floor > child->rng->ceil)
+            return;
+        n++;
+    }
+    if (n == 0)
+        return;
+
+    rng_root->rng_children = g_new(stat_node *, n);
+    for (i = 0, child = rng_root->children; child; child = child->next)
+        rng_root->rng_children[i++] = child;
+    qsort(rng_root->rng_children, n, sizeof(stat_node *), range_child_cmp);
+
+    for (i = 1; i < n; i++) {
+        if (rng_root->rng_children[i]->rng->floor <= rng_root->rng_children[i-1]->rng->ceil) {
+            g_free(rng_root->rng_children);
+            rng_root->rng_children = NULL;
+            return;
+        }
+    }
+    rng_root->num_rng_children = n;
+}
+
 extern int
 stats_tree_create_range_node(stats_tree *st, const gchar *name, int parent_id, ...)
 {
@@ -775,6 +910,7 @@ stats_tree_create_range_node(stats_tree *st, const gchar *name, int parent_id, .
         range_node->rng = get_range(curr_range);
     }
     va_end( list );
+    index_range_node(rng_root);
 
     return rng_root->id;
 }
@@ -792,6 +928,7 @@ stats_tree_create_range_node_string(stats_tree *st, const gchar *name,
         range_node = new_stat_node(st, str_ranges[i], rng_root->id, FALSE, FALSE);
         range_node->rng = get_range(str_ranges[i]);
     }
+    index_range_node(rng_root);
 
     return rng_root->id;
 }
@@ -825,11 +962,28 @@ stats_tree_range_node_with_pname(stats_tree *st, const gchar *name,
         range_node->rng = get_range(curr_range);
     }
     va_end( list );
+    index_range_node(rng_root);
 
     return rng_root->id;
 }
 
 
+/* counts a value in the range child it belongs to */
+static void
+tick_range_child(stat_node *child, int value_in_range)
+{
+    child->counter++;
+    child->total += value_in_range;
+    if (child->minvalue > value_in_range) {
+        child->minvalue = value_in_range;
+    }
+    if (child->maxvalue < value_in_range) {
+        child->maxvalue = value_in_range;
+    }
+    child->st_flags |= ST_FLG_AVERAGE;
+    update_burst_calc(child, 1);
+}
+
 extern int
 stats_tree_tick_range(stats_tree *st, const gchar *name, int parent_id,
               int value_in_range)
@@ -865,21 +1019,32 @@ stats_tree_tick_range(stats_tree *st, const gchar *name, int parent_id,
     }
     node->st_flags |= ST_FLG_AVERAGE;
 
+    if (node->rng_children) {
+        guint lo = 0;
+        guint hi = node->num_rng_children;
+
+        while (lo < hi) {
+            guint mid = (lo + hi) / 2;
+
+            child = node->rng_children[mid];
+            if (value_in_range < child->rng->floor) {
+                hi = mid;
+            } else if (value_in_range > child->rng->ceil) {
+                lo = mid + 1;
+            } else {
+                tick_range_child(child, value_in_range);
+                break;
+            }
+        }
+        return node->id;
+    }
+
     for ( child = node->children; child; child = child->next) {
         stat_floor =  child->rng->floor;
         stat_ceil = child->rng->ceil;
 
         if ( value_in_range >= stat_floor && value_in_range <= stat_ceil ) {
-            child->counter++;
-            child->total += value_in_range;
-            if (child->minvalue > value_in_range) {
-                child->minvalue = value_in_range;
-            }
-            if (child->maxvalue < value_in_range) {
-                child->maxvalue = value_in_range;
-            }
-            child->st_flags |= ST_FLG_AVERAGE;
-            update_burst_calc(child, 1);
+            tick_range_child(child, value_in_range);
             return node->id;
         }
     }
@@ -925,6 +1090,19 @@ stats_tree_tick_pivot(stats_tree *st, int pivot_id, const gchar *pivot_value)
     return pivot_id;
 }
 
+extern int
+stats_tree_tick_pivot_int(stats_tree *st, int pivot_id, guint32 key,
+              stat_node_name_func name_func, const void *name_data)
+{
+    stat_node *parent = (stat_node *)g_ptr_array_index(st->parents,pivot_id);
+
+    parent->counter++;
+    update_burst_calc(parent, 1);
+    stats_tree_manip_node_int( MN_INCREASE, st, key, name_func, name_data, pivot_id, FALSE, 1);
+
+    return pivot_id;
+}
+
 extern gchar*
 stats_tree_get_displayname (gchar* fullname)
 {
@@ -28,6 +28,7 @@
 #include <epan/packet_info.h>
 #include <epan/tap.h>
 #include <epan/stat_groups.h>
+#include <epan/value_string.h>
 #include "../register.h"
 #include "ws_symbol_export.h"
 
@@ -233,6 +234,49 @@ WS_DLL_PUBLIC int stats_tree_manip_node(manip_node_mode mode,
 #define stat_node_clear_flags(st,name,parent_id,with_children,flags)    \
     (stats_tree_manip_node(MN_CLEAR_FLAGS,(st),(name),(parent_id),(with_children),flags))
 
+/*
+ * Nodes can also be found by an integer key - a status code, a type or an
+ * interned string's id - among their parent's children instead of by
+ * name.  That's a lookup in an array or a hash of integers, and the name
+ * is only needed when the node is created: name_func is called then to
+ * make it (returning a g_malloc()ed string), with the key and name_data.
+ */
+typedef gchar *(*stat_node_name_func)(guint32 key, const void *name_data);
+
+/* A stat_node_name_func naming nodes after a value_string; name_data is
+   a stat_node_vals_t. */
+typedef struct _stat_node_vals {
+    const value_string *vals;
+    const char *unknown_fmt;    /* format for keys not in vals, e.g. "Unknown (%d)" */
+} stat_node_vals_t;
+
+WS_DLL_PUBLIC gchar *stats_tree_vals_name(guint32 key, const void *name_data);
+
+WS_DLL_PUBLIC int stats_tree_manip_node_int(manip_node_mode mode,
+                                            stats_tree *st,
+                                            guint32 key,
+                                            stat_node_name_func name_func,
+                                            const void *name_data,
+                                            int parent_id,
+                                            gboolean with_children,
+                                            gint value);
+
+#define tick_stat_node_int(st,key,name_func,name_data,parent_id,with_children) \
+    (stats_tree_manip_node_int(MN_INCREASE,(st),(key),(name_func),(name_data),(parent_id),(with_children),1))
+
+#define increase_stat_node_int(st,key,name_func,name_data,parent_id,with_children,value) \
+    (stats_tree_manip_node_int(MN_INCREASE,(st),(key),(name_func),(name_data),(parent_id),(with_children),(value)))
+
+#define avg_stat_node_add_value_int(st,key,name_func,name_data,parent_id,with_children,value) \
+    (stats_tree_manip_node_int(MN_AVERAGE,(st),(key),(name_func),(name_data),(parent_id),(with_children),(value)))
+
+/* Like stats_tree_tick_pivot(), with the value given by an integer key. */
+WS_DLL_PUBLIC int stats_tree_tick_pivot_int(stats_tree *st,
+                                            int pivot_id,
+                                            guint32 key,
+                                            stat_node_name_func name_func,
+                                            const void *name_data);
+
 #endif /* __STATS_TREE_H */
 
 /*
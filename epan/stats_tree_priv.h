@@ -34,6 +34,9 @@ extern "C" {
 #define INDENT_MAX 32
 #define NUM_BUF_SIZE 32
 
+/** integer keys below this find their node in an array */
+#define ST_INT_DIRECT_KEYS 1024
+
 /** implementations should define this to contain its own node related data
  * as well as some operations on it */
 typedef struct _st_node_pres st_node_pres;
@@ -93,9 +96,19 @@ struct _stat_node {
 	stat_node		*children;
 	stat_node		*next;
 
+	/** children nodes by integer key: keys below ST_INT_DIRECT_KEYS
+	 *  index int_children, others are in int_hash */
+	stat_node		**int_children;
+	GHashTable		*int_hash;
+
 	/** used to check if value is within range */
 	range_pair_t		*rng;
 
+	/** for a range node, its children in order of their ranges, to be
+	 *  searched by stats_tree_tick_range(); NULL if the ranges overlap */
+	stat_node		**rng_children;
+	guint			num_rng_children;
+
 	/** node presentation data */
 	st_node_pres		*pr;
 };
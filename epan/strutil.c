@@ -30,6 +30,15 @@
 #include <wsutil/str_util.h>
 #include <epan/proto.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EPAN_MEMMEM_SSE2
+#include <emmintrin.h>
+#include <wsutil/bits_ctz.h>
+#elif defined(__aarch64__) && defined(__GNUC__)
+#define EPAN_MEMMEM_NEON
+#include <arm_neon.h>
+#endif
+
 #ifdef _WIN32
 #include <windows.h>
 #include <tchar.h>
@@ -939,7 +948,10 @@ xml_escape(const gchar *unescaped)
 /* Return the first occurrence of needle in haystack.
  * If not found, return NULL.
  * If either haystack or needle has 0 length, return NULL.
- * Algorithm copied from GNU's glibc 2.3.2 memmem() under LGPL 2.1+ */
+ * Candidate positions are found with memchr() on the first byte of the
+ * needle, which skips over the rest of the haystack much faster than
+ * comparing a byte at a time.  With SSE2 or NEON, the first and last
+ * bytes are matched at 16 positions at a time before that. */
 const guint8 *
 epan_memmem(const guint8 *haystack, guint haystack_len,
         const guint8 *needle, guint needle_len)
@@ -955,10 +967,62 @@ epan_memmem(const guint8 *haystack, guint haystack_len,
         return NULL;
     }
 
-    for (begin = haystack ; begin <= last_possible; ++begin) {
-        if (begin[0] == needle[0] &&
-                !memcmp(&begin[1], needle + 1,
-                    needle_len - 1)) {
+    begin = haystack;
+
+#if defined(EPAN_MEMMEM_SSE2) || defined(EPAN_MEMMEM_NEON)
+    /*
+     * Compare the first and the last byte of the needle at 16 positions
+     * at once, and only memcmp() the rest where both of them match.
+     */
+    if (needle_len > 1) {
+#if defined(EPAN_MEMMEM_SSE2)
+        const __m128i first = _mm_set1_epi8((char)needle[0]);
+        const __m128i last = _mm_set1_epi8((char)needle[needle_len - 1]);
+
+        for (; last_possible - begin >= 15; begin += 16) {
+            __m128i block_first = _mm_loadu_si128((const __m128i *)(const void *)begin);
+            __m128i block_last = _mm_loadu_si128((const __m128i *)(const void *)(begin + needle_len - 1));
+            guint32 mask = (guint32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                                                    _mm_cmpeq_epi8(block_last, last)));
+
+            while (mask != 0) {
+                int i = ws_ctz(mask);
+
+                if (!memcmp(&begin[i + 1], needle + 1, needle_len - 2)) {
+                    return begin + i;
+                }
+                mask &= mask - 1;
+            }
+        }
+#else
+        const uint8x16_t first = vdupq_n_u8(needle[0]);
+        const uint8x16_t last = vdupq_n_u8(needle[needle_len - 1]);
+        int i;
+
+        for (; last_possible - begin >= 15; begin += 16) {
+            uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8(begin), first),
+                                     vceqq_u8(vld1q_u8(begin + needle_len - 1), last));
+
+            if (vmaxvq_u8(eq) == 0) {
+                continue;
+            }
+            for (i = 0; i < 16; i++) {
+                if (begin[i] == needle[0] && begin[i + needle_len - 1] == needle[needle_len - 1] &&
+                    !memcmp(&begin[i + 1], needle + 1, needle_len - 2)) {
+                    return begin + i;
+                }
+            }
+        }
+#endif
+    }
+#endif
+
+    for (; begin <= last_possible; ++begin) {
+        begin = (const guint8 *)memchr(begin, needle[0], last_possible - begin + 1);
+        if (begin == NULL) {
+            break;
+        }
+        if (!memcmp(&begin[1], needle + 1, needle_len - 1)) {
             return begin;
         }
     }
@@ -35,10 +35,9 @@
 #include <string.h>
 #include <epan/packet_info.h>
 #include <epan/dfilter/dfilter.h>
+#include <epan/epan_dissect.h>
 #include <epan/tap.h>
 
-static gboolean tapping_is_active=FALSE;
-
 typedef struct _tap_dissector_t {
 	struct _tap_dissector_t *next;
 	char *name;
@@ -58,9 +57,18 @@ typedef struct _tap_packet_t {
 	const void *tap_specific_data;
 } tap_packet_t;
 
-#define TAP_PACKET_QUEUE_LEN 5000
-static tap_packet_t tap_packet_array[TAP_PACKET_QUEUE_LEN];
-static guint tap_packet_index;
+/* Initial number of entries in a tap queue; it's doubled as needed */
+#define TAP_PACKET_QUEUE_INITIAL_LEN 64
+
+/* The queue of tapped packets for the packet currently being dissected */
+typedef struct _tap_queue_t {
+	gboolean tapping_is_active;
+	guint tap_packet_index;
+	guint tap_packet_array_len;
+	tap_packet_t *tap_packet_array;
+} tap_queue_t;
+
+static tap_queue_t tap_queue;
 
 typedef struct _tap_listener_t {
 	struct _tap_listener_t *next;
@@ -68,6 +76,7 @@ typedef struct _tap_listener_t {
 	gboolean needs_redraw;
 	guint flags;
 	dfilter_t *code;
+	guint filter_index;	/* of code in tap_filter_set */
 	void *tapdata;
 	tap_reset_cb reset;
 	tap_packet_cb packet;
@@ -75,6 +84,45 @@ typedef struct _tap_listener_t {
 } tap_listener_t;
 static volatile tap_listener_t *tap_listener_queue=NULL;
 
+/*
+ * The filters of all the tap listeners that have one, as one dfilter
+ * set, so that all the filters that need running for a packet are run
+ * together; built when it's first needed after a listener or its
+ * filter has come or gone.  tap_filter_wanted and tap_filter_matches
+ * are bitmasks big enough for it.
+ */
+static dfilter_set_t *tap_filter_set=NULL;
+static guint32 *tap_filter_wanted=NULL;
+static guint32 *tap_filter_matches=NULL;
+
+static void
+tap_filter_set_invalidate(void)
+{
+	dfilter_set_free(tap_filter_set);
+	tap_filter_set=NULL;
+	g_free(tap_filter_wanted);
+	tap_filter_wanted=NULL;
+	g_free(tap_filter_matches);
+	tap_filter_matches=NULL;
+}
+
+static void
+tap_filter_set_build(void)
+{
+	tap_listener_t *tl;
+	guint words;
+
+	tap_filter_set=dfilter_set_new();
+	for(tl=(tap_listener_t *)tap_listener_queue;tl;tl=tl->next){
+		if(tl->code){
+			tl->filter_index=dfilter_set_add(tap_filter_set, tl->code);
+		}
+	}
+	words=DFILTER_SET_MASK_WORDS(dfilter_set_count(tap_filter_set));
+	tap_filter_wanted=g_new0(guint32, words);
+	tap_filter_matches=g_new0(guint32, words);
+}
+
 #ifdef HAVE_PLUGINS
 
 #include <gmodule.h>
@@ -155,7 +203,10 @@ register_all_plugin_tap_listeners(void)
 void
 tap_init(void)
 {
-	tap_packet_index=0;
+	tap_queue_t *tq=&tap_queue;
+
+	tq->tapping_is_active=FALSE;
+	tq->tap_packet_index=0;
 }
 
 /* **********************************************************************
@@ -229,25 +280,30 @@ register_tap(const char *name)
 void
 tap_queue_packet(int tap_id, packet_info *pinfo, const void *tap_specific_data)
 {
+	tap_queue_t *tq;
 	tap_packet_t *tpt;
 
-	if(!tapping_is_active){
+	tq=&tap_queue;
+	if(!tq->tapping_is_active){
 		return;
 	}
 	/*
-	 * XXX - should we allocate this with an ep_allocator,
-	 * rather than having a fixed maximum number of entries?
+	 * The queue is kept, and reused, for the life of the program, so
+	 * it only has to grow when a packet is tapped more often than any
+	 * before it.
 	 */
-	if(tap_packet_index >= TAP_PACKET_QUEUE_LEN){
-		g_warning("Too many taps queued");
-		return;
+	if(tq->tap_packet_index >= tq->tap_packet_array_len){
+		tq->tap_packet_array_len=tq->tap_packet_array_len ?
+		    2*tq->tap_packet_array_len : TAP_PACKET_QUEUE_INITIAL_LEN;
+		tq->tap_packet_array=g_renew(tap_packet_t, tq->tap_packet_array,
+		    tq->tap_packet_array_len);
 	}
 
-	tpt=&tap_packet_array[tap_packet_index];
+	tpt=&tq->tap_packet_array[tq->tap_packet_index];
 	tpt->tap_id=tap_id;
 	tpt->pinfo=pinfo;
 	tpt->tap_specific_data=tap_specific_data;
-	tap_packet_index++;
+	tq->tap_packet_index++;
 }
 
 
@@ -283,14 +339,17 @@ void tap_build_interesting (epan_dissect_t *edt)
 void
 tap_queue_init(epan_dissect_t *edt)
 {
+	tap_queue_t *tq;
+
 	/* nothing to do, just return */
 	if(!tap_listener_queue){
 		return;
 	}
 
-	tapping_is_active=TRUE;
+	tq=&tap_queue;
+	tq->tapping_is_active=TRUE;
 
-	tap_packet_index=0;
+	tq->tap_packet_index=0;
 
 	tap_build_interesting (edt);
 }
@@ -301,31 +360,54 @@ tap_queue_init(epan_dissect_t *edt)
 void
 tap_push_tapped_queue(epan_dissect_t *edt)
 {
+	tap_queue_t *tq;
 	tap_packet_t *tp;
 	tap_listener_t *tl;
 	guint i;
+	gboolean any_wanted=FALSE;
+
+	tq=&tap_queue;
 
 	/* nothing to do, just return */
-	if(!tapping_is_active){
+	if(!tq->tapping_is_active){
 		return;
 	}
 
-	tapping_is_active=FALSE;
+	tq->tapping_is_active=FALSE;
 
 	/* nothing to do, just return */
-	if(!tap_packet_index){
+	if(!tq->tap_packet_index){
 		return;
 	}
 
+	/* work out which listeners' filters this packet has to be run
+	   through, and run them all in one go. */
+	if(!tap_filter_set){
+		tap_filter_set_build();
+	}
+	memset(tap_filter_wanted, 0,
+	    DFILTER_SET_MASK_WORDS(dfilter_set_count(tap_filter_set))*sizeof(guint32));
+	for(i=0;i<tq->tap_packet_index;i++){
+		for(tl=(tap_listener_t *)tap_listener_queue;tl;tl=tl->next){
+			if(tl->code && tq->tap_packet_array[i].tap_id==tl->tap_id){
+				tap_filter_wanted[tl->filter_index/32]|=1U<<(tl->filter_index%32);
+				any_wanted=TRUE;
+			}
+		}
+	}
+	if(any_wanted){
+		dfilter_set_apply(tap_filter_set, edt->tree, tap_filter_wanted, tap_filter_matches);
+	}
+
 	/* loop over all tap listeners and call the listener callback
 	   for all packets that match the filter. */
-	for(i=0;i<tap_packet_index;i++){
+	for(i=0;i<tq->tap_packet_index;i++){
 		for(tl=(tap_listener_t *)tap_listener_queue;tl;tl=tl->next){
-			tp=&tap_packet_array[i];
+			tp=&tq->tap_packet_array[i];
 			if(tp->tap_id==tl->tap_id){
 				gboolean passed=TRUE;
 				if(tl->code){
-					passed=dfilter_apply_edt(tl->code, edt);
+					passed=DFILTER_SET_MASK_TEST(tap_filter_matches, tl->filter_index);
 				}
 				if(passed && tl->packet){
 					tl->needs_redraw|=tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data);
@@ -353,22 +435,25 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 const void *
 fetch_tapped_data(int tap_id, int idx)
 {
+	tap_queue_t *tq;
 	tap_packet_t *tp;
 	guint i;
 
+	tq=&tap_queue;
+
 	/* nothing to do, just return */
-	if(!tapping_is_active){
+	if(!tq->tapping_is_active){
 		return NULL;
 	}
 
 	/* nothing to do, just return */
-	if(!tap_packet_index){
+	if(!tq->tap_packet_index){
 		return NULL;
 	}
 
 	/* loop over all tapped packets and return the one with index idx */
-	for(i=0;i<tap_packet_index;i++){
-		tp=&tap_packet_array[i];
+	for(i=0;i<tq->tap_packet_index;i++){
+		tp=&tq->tap_packet_array[i];
 		if(tp->tap_id==tap_id){
 			if(!idx--){
 				return tp->tap_specific_data;
@@ -486,7 +571,7 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 	tl->needs_redraw=TRUE;
 	tl->flags=flags;
 	if(fstring){
-		if(!dfilter_compile(fstring, &tl->code, &err_msg)){
+		if(!dfilter_compile_cached(fstring, &tl->code, &err_msg)){
 			error_string = g_string_new("");
 			g_string_printf(error_string,
 			    "Filter \"%s\" is invalid - %s",
@@ -505,6 +590,7 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 	tl->next=(tap_listener_t *)tap_listener_queue;
 
 	tap_listener_queue=tl;
+	tap_filter_set_invalidate();
 
 	return NULL;
 }
@@ -539,9 +625,10 @@ set_tap_dfilter(void *tapdata, const char *fstring)
 			dfilter_free(tl->code);
 			tl->code=NULL;
 		}
+		tap_filter_set_invalidate();
 		tl->needs_redraw=TRUE;
 		if(fstring){
-			if(!dfilter_compile(fstring, &tl->code, &err_msg)){
+			if(!dfilter_compile_cached(fstring, &tl->code, &err_msg)){
 				error_string = g_string_new("");
 				g_string_printf(error_string,
 						 "Filter \"%s\" is invalid - %s",
@@ -585,6 +672,7 @@ remove_tap_listener(void *tapdata)
 			dfilter_free(tl->code);
 		}
 		g_free(tl);
+		tap_filter_set_invalidate();
 	}
 
 	return;
@@ -610,6 +698,29 @@ tap_listeners_require_dissection(void)
 
 }
 
+/*
+ * Returns TRUE if one or more tap listeners that require dissection might
+ * want the frame frame_num, which has been dissected before; FALSE if
+ * their filters show that none of them does.
+ */
+gboolean
+tap_listeners_prefilter_stored(const struct _field_store *fs, guint32 frame_num,
+			       guint32 len, guint32 caplen)
+{
+	volatile tap_listener_t *tap_queue = tap_listener_queue;
+
+	while(tap_queue) {
+		if(!(tap_queue->flags & TL_IS_DISSECTOR_HELPER) &&
+		   (tap_queue->code == NULL ||
+		    dfilter_prefilter_stored(tap_queue->code, fs, frame_num, len, caplen)))
+			return TRUE;
+
+		tap_queue = tap_queue->next;
+	}
+
+	return FALSE;
+}
+
 /* Returns TRUE there is an active tap listener for the specified tap id. */
 gboolean
 have_tap_listener(int tap_id)
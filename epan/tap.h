@@ -226,6 +226,15 @@ WS_DLL_PUBLIC void remove_tap_listener(void *tapdata);
  */
 WS_DLL_PUBLIC gboolean tap_listeners_require_dissection(void);
 
+/**
+ * Return TRUE if one or more tap listeners that require dissection might
+ * want frame frame_num, which has been dissected before, FALSE if their
+ * filters show, from the field store fs (which may be NULL) and the frame
+ * indexes, that none of them does.
+ */
+WS_DLL_PUBLIC gboolean tap_listeners_prefilter_stored(const struct _field_store *fs,
+    guint32 frame_num, guint32 len, guint32 caplen);
+
 /** Returns TRUE there is an active tap listener for the specified tap id. */
 WS_DLL_PUBLIC gboolean have_tap_listener(int tap_id);
 
@@ -23,8 +23,40 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "timestats.h"
 
+/* Histogram bin for a sample of "us" microseconds */
+static guint
+time_stat_hist_bucket(guint64 us)
+{
+	guint msb;
+
+	if (us >= G_GUINT64_CONSTANT(0x100000000))
+		return TIMESTAT_HIST_BUCKETS - 1;
+	if (us < TIMESTAT_HIST_SUB_BUCKETS)
+		return (guint)us;
+
+	for (msb = TIMESTAT_HIST_SUB_BITS; (us >> (msb + 1)) != 0; msb++)
+		;
+	return (msb - TIMESTAT_HIST_SUB_BITS + 1) * TIMESTAT_HIST_SUB_BUCKETS
+		+ (guint)((us >> (msb - TIMESTAT_HIST_SUB_BITS)) & (TIMESTAT_HIST_SUB_BUCKETS - 1));
+}
+
+/* Largest number of microseconds that falls in histogram bin "bucket" */
+static guint64
+time_stat_hist_limit(guint bucket)
+{
+	guint shift;
+
+	if (bucket < TIMESTAT_HIST_SUB_BUCKETS)
+		return bucket;
+
+	shift = bucket / TIMESTAT_HIST_SUB_BUCKETS - 1;
+	return ((guint64)(TIMESTAT_HIST_SUB_BUCKETS + bucket % TIMESTAT_HIST_SUB_BUCKETS + 1) << shift) - 1;
+}
+
 /* Initialize a timestat_t struct */
 void
 time_stat_init(timestat_t *stats)
@@ -36,6 +68,7 @@ time_stat_init(timestat_t *stats)
 	nstime_set_zero(&stats->max);
 	nstime_set_zero(&stats->tot);
 	stats->variance = 0.0;
+	memset(stats->hist, 0, sizeof stats->hist);
 }
 
 /* Update a timestat_t struct with a new sample */
@@ -65,9 +98,52 @@ time_stat_update(timestat_t *stats, const nstime_t *delta, packet_info *pinfo)
 
 	nstime_add(&stats->tot, delta);
 
+	if (delta->secs >= 0)
+		stats->hist[time_stat_hist_bucket((guint64)delta->secs * 1000000 + delta->nsecs / 1000)]++;
+	else
+		stats->hist[0]++;
+
 	stats->num++;
 }
 
+/* Estimate a percentile of the samples from the histogram */
+void
+time_stat_percentile(const timestat_t *stats, gdouble percent, nstime_t *result)
+{
+	guint64 rank, seen = 0, us;
+	guint i;
+
+	if (stats->num == 0) {
+		nstime_set_zero(result);
+		return;
+	}
+
+	rank = (guint64)(stats->num * percent / 100.0 + 0.5);
+	if (rank < 1)
+		rank = 1;
+	if (rank > stats->num)
+		rank = stats->num;
+
+	for (i = 0; i < TIMESTAT_HIST_BUCKETS - 1; i++) {
+		seen += stats->hist[i];
+		if (seen >= rank)
+			break;
+	}
+	if (i == TIMESTAT_HIST_BUCKETS - 1) {
+		*result = stats->max;
+		return;
+	}
+
+	us = time_stat_hist_limit(i);
+	result->secs  = (time_t)(us / 1000000);
+	result->nsecs = (int)(us % 1000000) * 1000 + 999;
+
+	if (nstime_cmp(result, &stats->max) > 0)
+		*result = stats->max;
+	if (nstime_cmp(result, &stats->min) < 0)
+		*result = stats->min;
+}
+
 /*
  * get_average - function
  *
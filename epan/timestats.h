@@ -28,6 +28,14 @@
 #include "epan/packet_info.h"
 #include "wsutil/nstime.h"
 
+/* Samples are binned by microseconds: values below TIMESTAT_HIST_SUB_BUCKETS
+ * get a bin each, larger ones TIMESTAT_HIST_SUB_BUCKETS bins per power of two,
+ * so a bin is never wider than 1/TIMESTAT_HIST_SUB_BUCKETS of its value.
+ * Samples of 2^32us (about 71 minutes) or more land in the last bin. */
+#define TIMESTAT_HIST_SUB_BITS 3
+#define TIMESTAT_HIST_SUB_BUCKETS (1 << TIMESTAT_HIST_SUB_BITS)
+#define TIMESTAT_HIST_BUCKETS ((32 - TIMESTAT_HIST_SUB_BITS + 1) * TIMESTAT_HIST_SUB_BUCKETS)
+
  /* Summary of time statistics*/
 typedef struct _timestat_t {
 	guint32 num;	 /* number of samples */
@@ -37,6 +45,7 @@ typedef struct _timestat_t {
 	nstime_t max;
 	nstime_t tot;
 	gdouble variance;
+	guint32 hist[TIMESTAT_HIST_BUCKETS]; /* sample counts, for percentiles */
 } timestat_t;
 
 /* functions */
@@ -49,4 +58,9 @@ WS_DLL_PUBLIC void time_stat_update(timestat_t *stats, const nstime_t *delta, pa
 
 WS_DLL_PUBLIC gdouble get_average(const nstime_t *sum, guint32 num);
 
+/* Estimate the time below which "percent" percent of the samples fall.
+ * The result is the upper edge of the histogram bin holding that sample,
+ * clamped to the minimum and maximum. */
+WS_DLL_PUBLIC void time_stat_percentile(const timestat_t *stats, gdouble percent, nstime_t *result);
+
 #endif
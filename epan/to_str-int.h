@@ -150,4 +150,49 @@ char *uint_to_str_back_len(char *ptr, guint32 value, int len);
  */
 char *int_to_str_back(char *ptr, gint32 value);
 
+/**
+ * oct64_to_str_back()
+ *
+ * Output guint64 octal representation backward (last character will be written on ptr - 1),
+ * and return pointer to first character.
+ *
+ * String is not NUL terminated by this routine.
+ * There needs to be at least 23 bytes in the buffer.
+ */
+char *oct64_to_str_back(char *ptr, guint64 value);
+
+/**
+ * hex64_to_str_back()
+ *
+ * Output guint64 hex representation backward (last character will be written on ptr - 1),
+ * and return pointer to first character.
+ * This routine will output for sure (can output more) 'len' decimal characters (number padded with '0').
+ *
+ * String is not NUL terminated by this routine.
+ * There needs to be at least 2 + MAX(16, len) bytes in the buffer.
+ */
+char *hex64_to_str_back(char *ptr, int len, guint64 value);
+
+/**
+ * uint64_to_str_back()
+ *
+ * Output guint64 decimal representation backward (last character will be written on ptr - 1),
+ * and return pointer to first character.
+ *
+ * String is not NUL terminated by this routine.
+ * There needs to be at least 20 bytes in the buffer.
+ */
+char *uint64_to_str_back(char *ptr, guint64 value);
+
+/**
+ * int64_to_str_back()
+ *
+ * Output gint64 decimal representation backward (last character will be written on ptr - 1),
+ * and return pointer to first character.
+ *
+ * String is not NUL terminated by this routine.
+ * There needs to be at least 20 bytes in the buffer.
+ */
+char *int64_to_str_back(char *ptr, gint64 value);
+
 #endif /* __TO_STR_INT_H__ */
@@ -33,6 +33,14 @@
 #include "to_str-int.h"
 #include "strutil.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TO_STR_HEX_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__GNUC__)
+#define TO_STR_HEX_NEON
+#include <arm_neon.h>
+#endif
+
 /*
  * If a user _does_ pass in a too-small buffer, this is probably
  * going to be too long to fit.  However, even a partial string
@@ -120,12 +128,55 @@ dword_to_hex_punct(char *out, guint32 dword, char punct)
 char *
 bytes_to_hexstr(char *out, const guint8 *ad, guint32 len)
 {
-	guint32 i;
+	guint32 i = 0;
 
 	if (!ad)
 		REPORT_DISSECTOR_BUG("Null pointer passed to bytes_to_hexstr()");
 
-	for (i = 0; i < len; i++)
+#if defined(TO_STR_HEX_SSE2)
+	if (len >= 16) {
+		const __m128i nibble = _mm_set1_epi8(0x0f);
+		const __m128i nine = _mm_set1_epi8(9);
+		const __m128i zero = _mm_set1_epi8('0');
+		const __m128i letter = _mm_set1_epi8('a' - '0' - 10);
+
+		/* 16 bytes at a time: split them into nibbles, turn each
+		 * nibble into its digit and interleave high and low */
+		for (; i + 16 <= len; i += 16) {
+			__m128i in = _mm_loadu_si128((const __m128i *)(const void *)(ad + i));
+			__m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), nibble);
+			__m128i lo = _mm_and_si128(in, nibble);
+
+			hi = _mm_add_epi8(_mm_add_epi8(hi, zero),
+			                  _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letter));
+			lo = _mm_add_epi8(_mm_add_epi8(lo, zero),
+			                  _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letter));
+			_mm_storeu_si128((__m128i *)(void *)out, _mm_unpacklo_epi8(hi, lo));
+			_mm_storeu_si128((__m128i *)(void *)(out + 16), _mm_unpackhi_epi8(hi, lo));
+			out += 32;
+		}
+	}
+#elif defined(TO_STR_HEX_NEON)
+	if (len >= 16) {
+		static const guint8 hex_digits[16] = {
+			'0', '1', '2', '3', '4', '5', '6', '7',
+			'8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+		};
+		const uint8x16_t digits = vld1q_u8(hex_digits);
+
+		for (; i + 16 <= len; i += 16) {
+			uint8x16_t in = vld1q_u8(ad + i);
+			uint8x16x2_t hex;
+
+			hex.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(in, 4));
+			hex.val[1] = vqtbl1q_u8(digits, vandq_u8(in, vdupq_n_u8(0x0f)));
+			vst2q_u8((guint8 *)out, hex);
+			out += 32;
+		}
+	}
+#endif
+
+	for (; i < len; i++)
 		out = byte_to_hex(out, ad[i]);
 	return out;
 }
@@ -293,6 +344,25 @@ guint32_to_str_buf(guint32 u, gchar *buf, int buf_len)
 	uint_to_str_back(bp, u);
 }
 
+void
+guint64_to_str_buf(guint64 u, gchar *buf, int buf_len)
+{
+	gchar  tmp[20];
+	gchar *bp = &tmp[sizeof tmp];
+	int    str_len;
+
+	bp = uint64_to_str_back(bp, u);
+	str_len = (int)(&tmp[sizeof tmp] - bp);
+
+	if (buf_len < str_len + 1) {
+		g_strlcpy(buf, BUF_TOO_SMALL_ERR, buf_len);	/* Let the unexpected value alert user */
+		return;
+	}
+
+	memcpy(buf, bp, str_len);
+	buf[str_len] = '\0';
+}
+
 #define	PLURALIZE(n)	(((n) > 1) ? "s" : "")
 #define	COMMA(do_it)	((do_it) ? ", " : "")
 
@@ -1170,6 +1240,69 @@ int_to_str_back(char *ptr, gint32 value)
 	return ptr;
 }
 
+char *
+oct64_to_str_back(char *ptr, guint64 value)
+{
+	while (value) {
+		*(--ptr) = '0' + (char)(value & 0x7);
+		value >>= 3;
+	}
+
+	*(--ptr) = '0';
+	return ptr;
+}
+
+char *
+hex64_to_str_back(char *ptr, int len, guint64 value)
+{
+	do {
+		*(--ptr) = low_nibble_of_octet_to_hex((guint8)value);
+		value >>= 4;
+		len--;
+	} while (value);
+
+	/* pad */
+	while (len > 0) {
+		*(--ptr) = '0';
+		len--;
+	}
+
+	*(--ptr) = 'x';
+	*(--ptr) = '0';
+
+	return ptr;
+}
+
+char *
+uint64_to_str_back(char *ptr, guint64 value)
+{
+	char const *p;
+
+	/* Two digits at a time in 64 bits until the rest fits in 32 */
+	while (value > G_MAXUINT32) {
+		p = fast_strings[100 + (value % 100)];
+
+		value /= 100;
+
+		*(--ptr) = p[2];
+		*(--ptr) = p[1];
+	}
+
+	return uint_to_str_back(ptr, (guint32)value);
+}
+
+char *
+int64_to_str_back(char *ptr, gint64 value)
+{
+	if (value < 0) {
+		ptr = uint64_to_str_back(ptr, G_GUINT64_CONSTANT(0) - (guint64)value);
+		*(--ptr) = '-';
+	} else
+		ptr = uint64_to_str_back(ptr, value);
+
+	return ptr;
+}
+
 /*
  * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
  *
@@ -105,6 +105,41 @@ static tvbparse_elem_t* new_tok(tvbparse_t* tt,
     return tok;
 }
 
+/*
+ * The first byte tables are worked out when the wanted elements are built,
+ * so that cond_one_of(), cond_until() and tvbparse_find() can skip the
+ * alternatives and offsets that cannot match by looking at a single byte
+ * instead of calling into the elements.
+ */
+static guint8* first_bytes_new(void) {
+    return (guint8 *)g_malloc0(256);
+}
+
+static void first_bytes_add(guint8* first, const guint8* from) {
+    guint i;
+
+    for (i = 0; i < 256; i++)
+        first[i] |= from[i];
+}
+
+/*
+ * Returns a pointer to the bytes from offset up to the end of the parser's
+ * range that are actually in the tvb, and sets *len to how many there are.
+ */
+static const guint8* captured_ptr(tvbparse_t* tt, const int offset, int* len) {
+    int avail = tvb_captured_length_remaining(tt->tvb, offset);
+    int left = tt->end_offset - offset;
+
+    *len = left < avail ? left : avail;
+
+    if (*len <= 0) {
+        *len = 0;
+        return NULL;
+    }
+
+    return tvb_get_ptr(tt->tvb, offset, *len);
+}
+
 static int ignore_fcn(tvbparse_t* tt, int offset) {
     int len = 0;
     int consumed;
@@ -165,10 +200,16 @@ tvbparse_wanted_t* tvbparse_char(const int id,
                                  tvbparse_action_t before_cb,
                                  tvbparse_action_t after_cb) {
     tvbparse_wanted_t* w = (tvbparse_wanted_t *)g_malloc0(sizeof(tvbparse_wanted_t));
+    guint8* first = first_bytes_new();
+    gsize i;
+
+    for (i = 0; chr[i]; i++)
+        first[(guint8) chr[i]] = 1;
 
     w->condition = cond_char;
     w->id = id;
     w->control.str = chr;
+    w->first = first;
     w->len = 1;
     w->data = data;
     w->before = before_cb;
@@ -181,6 +222,8 @@ static int cond_chars_common(tvbparse_t* tt, int offset, const tvbparse_wanted_t
     guint length = 0;
     int start = offset;
     int left = tt->end_offset - offset;
+    const guint8* ptr;
+    int avail;
 
 #ifdef TVBPARSE_DEBUG
     if (TVBPARSE_DEBUG & TVBPARSE_DEBUG_CHARS) g_warning("cond_chars_common: control='%s'",wanted->control.str);
@@ -191,15 +234,15 @@ static int cond_chars_common(tvbparse_t* tt, int offset, const tvbparse_wanted_t
 
     left = left < (int) wanted->max ? left :  (int) wanted->max;
 
-    while( left > 0 ) {
-        guint8 t = tvb_get_guint8(tt->tvb,offset++);
-
-        if (!wanted->control.str[t])
-            break;
+    ptr = captured_ptr(tt, offset, &avail);
+    avail = avail < left ? avail : left;
 
+    while( length < (guint) avail && wanted->control.str[ptr[length]] )
         length++;
-        left--;
-    };
+
+    /* ran into the end of the captured data: let the tvb throw as usual */
+    if (length == (guint) avail && avail < left)
+        tvb_get_guint8(tt->tvb, offset + avail);
 
     if (length < wanted->min) {
         return  -1;
@@ -232,6 +275,7 @@ tvbparse_wanted_t* tvbparse_chars(const int id,
     w->condition = cond_chars_common;
     w->id = id;
     w->control.str = accept_str;
+    w->first = (const guint8 *) accept_str;
     w->min = min_len ? min_len : 1;
     w->max = max_len ? max_len : G_MAXINT/2;
     w->data = data;
@@ -280,10 +324,17 @@ tvbparse_wanted_t* tvbparse_not_char(const int id,
                                      tvbparse_action_t before_cb,
                                      tvbparse_action_t after_cb) {
     tvbparse_wanted_t* w = (tvbparse_wanted_t *)g_malloc0(sizeof(tvbparse_wanted_t));
+    guint8* first = first_bytes_new();
+    gsize i;
+
+    memset(first, 1, 256);
+    for (i = 0; chr[i]; i++)
+        first[(guint8) chr[i]] = 0;
 
     w->condition = cond_not_char;
     w->id = id;
     w->control.str = chr;
+    w->first = first;
     w->data = data;
     w->before = before_cb;
     w->after = after_cb;
@@ -312,6 +363,7 @@ tvbparse_wanted_t* tvbparse_not_chars(const int id,
     w->condition = cond_chars_common;
     w->id = id;
     w->control.str = accept_str;
+    w->first = (const guint8 *) accept_str;
     w->len = 0;
     w->min = min_len ? min_len : 1;
     w->max = max_len ? max_len : G_MAXINT/2;
@@ -354,6 +406,13 @@ tvbparse_wanted_t* tvbparse_string(const int id,
     w->id = id;
     w->control.str = str;
     w->len = (int) strlen(str);
+
+    if (w->len) {
+        guint8* first = first_bytes_new();
+        first[(guint8) str[0]] = 1;
+        w->first = first;
+    }
+
     w->data = data;
     w->before = before_cb;
     w->after = after_cb;
@@ -393,6 +452,14 @@ tvbparse_wanted_t* tvbparse_casestring(const int id,
     w->id = id;
     w->control.str = str;
     w->len = (int) strlen(str);
+
+    if (w->len) {
+        guint8* first = first_bytes_new();
+        first[(guint8) g_ascii_tolower(str[0])] = 1;
+        first[(guint8) g_ascii_toupper(str[0])] = 1;
+        w->first = first;
+    }
+
     w->data = data;
     w->before = before_cb;
     w->after = after_cb;
@@ -402,6 +469,8 @@ tvbparse_wanted_t* tvbparse_casestring(const int id,
 
 static int cond_one_of(tvbparse_t* tt, const int offset, const tvbparse_wanted_t * wanted, tvbparse_elem_t** tok) {
     guint i;
+    gboolean have_byte = FALSE;
+    guint8 byte = 0;
 #ifdef TVBPARSE_DEBUG
     if (TVBPARSE_DEBUG & TVBPARSE_DEBUG_ONEOF) g_warning("cond_one_of: START");
 #endif
@@ -409,6 +478,11 @@ static int cond_one_of(tvbparse_t* tt, const int offset, const tvbparse_wanted_t
     if ( offset > tt->end_offset )
         return -1;
 
+    if ( offset < tt->end_offset && tvb_offset_exists(tt->tvb, offset) ) {
+        byte = tvb_get_guint8(tt->tvb, offset);
+        have_byte = TRUE;
+    }
+
     for(i=0; i < wanted->control.elems->len; i++) {
         tvbparse_wanted_t* w = (tvbparse_wanted_t *)g_ptr_array_index(wanted->control.elems,i);
         tvbparse_elem_t* new_elem = NULL;
@@ -417,6 +491,9 @@ static int cond_one_of(tvbparse_t* tt, const int offset, const tvbparse_wanted_t
         if ( offset + w->len > tt->end_offset )
             continue;
 
+        if ( have_byte && w->first && !w->first[byte] )
+            continue;
+
         curr_len = w->condition(tt, offset, w,  &new_elem);
 
         if (curr_len >= 0) {
@@ -440,6 +517,8 @@ tvbparse_wanted_t* tvbparse_set_oneof(const int id,
     tvbparse_wanted_t* w = (tvbparse_wanted_t *)g_malloc0(sizeof(tvbparse_wanted_t));
     tvbparse_t* el;
     va_list ap;
+    guint8* first = first_bytes_new();
+    guint i;
 
     w->condition = cond_one_of;
     w->id = id;
@@ -456,6 +535,20 @@ tvbparse_wanted_t* tvbparse_set_oneof(const int id,
 
     va_end(ap);
 
+    for (i = 0; i < w->control.elems->len; i++) {
+        const tvbparse_wanted_t* alt = (const tvbparse_wanted_t *)g_ptr_array_index(w->control.elems,i);
+
+        if (!alt->first) {
+            g_free(first);
+            first = NULL;
+            break;
+        }
+
+        first_bytes_add(first, alt->first);
+    }
+
+    w->first = first;
+
     return w;
 }
 
@@ -530,6 +623,7 @@ tvbparse_wanted_t* tvbparse_hashed(const int id,
     w->control.hash.table = g_hash_table_new(g_str_hash,g_str_equal);
     w->control.hash.key = key;
     w->control.hash.other = other;
+    w->first = key->first;
 
     va_start(ap,other);
 
@@ -632,6 +726,10 @@ tvbparse_wanted_t* tvbparse_set_seq(const int id,
     };
 
     va_end(ap);
+
+    if (w->control.elems->len)
+        w->first = ((const tvbparse_wanted_t *)g_ptr_array_index(w->control.elems,0))->first;
+
     return w;
 }
 
@@ -718,6 +816,9 @@ tvbparse_wanted_t* tvbparse_some(const int id,
     w->after = after_cb;
     w->control.subelem = el;
 
+    if (from > 0)
+        w->first = el->first;
+
     return w;
 }
 
@@ -726,6 +827,9 @@ static int cond_until(tvbparse_t* tt, const int offset, const tvbparse_wanted_t
     tvbparse_elem_t* new_elem = NULL;
     int len = 0;
     int target_offset = offset;
+    const guint8* first = wanted->control.until.subelem->first;
+    const guint8* ptr = NULL;
+    int avail = 0;
 #ifdef TVBPARSE_DEBUG
     if (TVBPARSE_DEBUG & TVBPARSE_DEBUG_UNTIL) g_warning("cond_until: START");
 #endif
@@ -733,7 +837,16 @@ static int cond_until(tvbparse_t* tt, const int offset, const tvbparse_wanted_t
     if ( offset + wanted->control.until.subelem->len > tt->end_offset )
         return -1;
 
+    if (first)
+        ptr = captured_ptr(tt, offset, &avail);
+
     do {
+        if (target_offset - offset < avail && !first[ptr[target_offset - offset]]) {
+            target_offset++;
+            len = -1;
+            continue;
+        }
+
         len = wanted->control.until.subelem->condition(tt, target_offset++, wanted->control.until.subelem,  &new_elem);
     } while(len < 0  && target_offset+1 < tt->end_offset);
 
@@ -1325,12 +1438,22 @@ tvbparse_elem_t* tvbparse_find(tvbparse_t* tt, const tvbparse_wanted_t* wanted)
     int len = 0;
     int offset = tt->offset;
     int target_offset = offset -1;
+    const guint8* ptr = NULL;
+    int avail = 0;
 
 #ifdef TVBPARSE_DEBUG
     if (TVBPARSE_DEBUG & TVBPARSE_DEBUG_FIND) g_warning("tvbparse_get: ENTER offset=%i", tt->offset);
 #endif
 
+    if (wanted->first)
+        ptr = captured_ptr(tt, offset, &avail);
+
     do {
+        if (target_offset + 1 - offset < avail && !wanted->first[ptr[target_offset + 1 - offset]]) {
+            len = -1;
+            continue;
+        }
+
         len = wanted->condition(tt, target_offset+1, wanted,  &tok);
     } while(len < 0  && ++target_offset < tt->end_offset);
 
@@ -135,6 +135,9 @@ struct _tvbparse_wanted_t {
     guint min;
     guint max;
 
+    /* the bytes a match can start with, NULL if any (or none) */
+    const guint8* first;
+
     const void* data;
 
     tvbparse_action_t before;
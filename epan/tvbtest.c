@@ -41,6 +41,9 @@ test(tvbuff_t *tvb, const gchar* name,
 	guint			length;
 	guint			reported_length;
 	guint8			*ptr;
+	const guint8		*cptr;
+	guint8			needles[2] = { 0, 0 };
+	guchar			found_needle;
 	volatile gboolean	ex_thrown;
 	volatile guint32	val32;
 	guint32			expected32;
@@ -278,6 +281,43 @@ test(tvbuff_t *tvb, const gchar* name,
 	}
 	wmem_free(NULL, ptr);
 
+	/* Sweep across data in various sized increments checking
+	 * tvb_get_ptr() */
+	for (incr = 1; incr < length; incr++) {
+		for (i = 0; i < length - incr; i += incr) {
+			cptr = tvb_get_ptr(tvb, i, incr);
+			if (memcmp(cptr, &expected_data[i], incr) != 0) {
+				printf("13: Failed TVB=%s Offset=%d Length=%d "
+						"Bad get_ptr\n",
+						name, i, incr);
+				failed = TRUE;
+				return FALSE;
+			}
+		}
+	}
+
+	/* Search for each byte from its own offset; the first match
+	 * must be at that offset. */
+	for (i = 0; i < length; i++) {
+		if (tvb_find_guint8(tvb, i, -1, expected_data[i]) != (gint)i) {
+			printf("14: Failed TVB=%s Offset=%d "
+					"Bad find_guint8\n", name, i);
+			failed = TRUE;
+			return FALSE;
+		}
+
+		if (expected_data[i] == 0)
+			continue;
+		needles[0] = expected_data[i];
+		if (tvb_pbrk_guint8(tvb, i, -1, needles, &found_needle) != (gint)i ||
+		    found_needle != expected_data[i]) {
+			printf("15: Failed TVB=%s Offset=%d "
+					"Bad pbrk_guint8\n", name, i);
+			failed = TRUE;
+			return FALSE;
+		}
+	}
+
 
 	printf("Passed TVB=%s\n", name);
 
@@ -56,9 +56,9 @@ struct tvbuff {
 
 	/** We're either a TVBUFF_REAL_DATA or a
 	 * TVBUFF_SUBSET that has a backing buffer that
-	 * has real_data != NULL, or a TVBUFF_COMPOSITE
-	 * which has flattened its data due to a call
-	 * to tvb_get_ptr().
+	 * has real_data != NULL.  A TVBUFF_COMPOSITE never
+	 * sets this; it copies only the ranges asked for by
+	 * tvb_get_ptr() that span more than one member.
 	 */
 	const guint8		*real_data;
 
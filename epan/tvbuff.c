@@ -1767,76 +1767,94 @@ tvb_get_bits64(tvbuff_t *tvb, guint bit_offset, const gint no_of_bits, const gui
 static guint64
 _tvb_get_bits64(tvbuff_t *tvb, guint bit_offset, const gint total_no_of_bits)
 {
+	const guint8 *ptr;
 	guint64 value;
 	guint	octet_offset = bit_offset >> 3;
-	guint8	required_bits_in_first_octet = 8 - (bit_offset % 8);
+	guint	first_bit = bit_offset & 0x07;
+	gint	octet_length, i;
+	guint	right_shift;
 
-	if(required_bits_in_first_octet > total_no_of_bits)
-	{
-		/* the required bits don't extend to the end of the first octet */
-		guint8 right_shift = required_bits_in_first_octet - total_no_of_bits;
-		value = (tvb_get_guint8(tvb, octet_offset) >> right_shift) & bit_mask8[total_no_of_bits % 8];
-	}
-	else
-	{
-		guint8 remaining_bit_length = total_no_of_bits;
+	/* fetch all the octets the bits span at once */
+	octet_length = (gint)((first_bit + total_no_of_bits + 7) >> 3);
+	if (octet_length == 0)
+		octet_length = 1;
+	ptr = ensure_contiguous(tvb, octet_offset, octet_length);
+	right_shift = octet_length * 8 - first_bit - total_no_of_bits;
 
-		/* get the bits up to the first octet boundary */
-		value = 0;
-		required_bits_in_first_octet %= 8;
-		if(required_bits_in_first_octet != 0)
-		{
-			value = tvb_get_guint8(tvb, octet_offset) & bit_mask8[required_bits_in_first_octet];
-			remaining_bit_length -= required_bits_in_first_octet;
-			octet_offset ++;
-		}
-		/* take the biggest words, shorts or octets that we can */
-		while (remaining_bit_length > 7)
-		{
-			switch (remaining_bit_length >> 4)
-			{
-			case 0:
-				/* 8 - 15 bits. (note that 0 - 7 would have dropped out of the while() loop) */
-				value <<= 8;
-				value += tvb_get_guint8(tvb, octet_offset);
-				remaining_bit_length -= 8;
-				octet_offset ++;
-				break;
+	/*
+	 * Shift the octets in, leaving the last one for a partial shift so
+	 * that, for more than 64 bits, the low-order ones are what's kept.
+	 */
+	value = ptr[0] & bit_mask8[8 - first_bit];
+	if (octet_length == 1)
+		return value >> right_shift;
+	for (i = 1; i < octet_length - 1; i++)
+		value = (value << 8) | ptr[i];
+	return (value << (8 - right_shift)) | (ptr[octet_length - 1] >> right_shift);
+}
 
-			case 1:
-				/* 16 - 31 bits */
-				value <<= 16;
-				value += tvb_get_ntohs(tvb, octet_offset);
-				remaining_bit_length -= 16;
-				octet_offset += 2;
-				break;
+/* Load the octets from the one holding the cursor's next bit into its window */
+static void
+tvb_bit_cursor_refill(tvb_bit_cursor_t *bc)
+{
+	const guint8 *ptr;
+	gint	remaining, octets, i;
 
-			case 2:
-			case 3:
-				/* 32 - 63 bits */
-				value <<= 32;
-				value += tvb_get_ntohl(tvb, octet_offset);
-				remaining_bit_length -= 32;
-				octet_offset += 4;
-				break;
+	bc->window_offset = bc->bit_offset & ~0x07U;
+	bc->window = 0;
+	bc->window_bits = 0;
 
-			default:
-				/* 64 bits (or more???) */
-				value = tvb_get_ntoh64(tvb, octet_offset);
-				remaining_bit_length -= 64;
-				octet_offset += 8;
-				break;
-			}
-		}
-		/* get bits from any partial octet at the tail */
-		if(remaining_bit_length)
-		{
-			value <<= remaining_bit_length;
-			value += (tvb_get_guint8(tvb, octet_offset) >> (8 - remaining_bit_length));
-		}
+	remaining = tvb_captured_length_remaining(bc->tvb, bc->window_offset >> 3);
+	if (remaining <= 0)
+		return;
+	octets = MIN(remaining, 8);
+	ptr = ensure_contiguous(bc->tvb, bc->window_offset >> 3, octets);
+	for (i = 0; i < octets; i++)
+		bc->window = (bc->window << 8) | ptr[i];
+	bc->window <<= 8 * (8 - octets);
+	bc->window_bits = octets * 8;
+}
+
+void
+tvb_bit_cursor_init(tvb_bit_cursor_t *bc, tvbuff_t *tvb, const guint bit_offset)
+{
+	bc->tvb = tvb;
+	bc->bit_offset = bit_offset;
+	bc->window = 0;
+	bc->window_offset = 0;
+	bc->window_bits = 0;
+}
+
+guint64
+tvb_bit_cursor_peek_bits(tvb_bit_cursor_t *bc, const gint no_of_bits)
+{
+	guint skip;
+
+	if (bc->bit_offset < bc->window_offset ||
+	    bc->bit_offset - bc->window_offset + no_of_bits > bc->window_bits)
+		tvb_bit_cursor_refill(bc);
+
+	skip = bc->bit_offset - bc->window_offset;
+	if (no_of_bits <= 0 || skip + no_of_bits > bc->window_bits) {
+		/*
+		 * Past the end of the captured data (so this throws the
+		 * appropriate exception), or more bits than the window holds.
+		 */
+		return _tvb_get_bits64(bc->tvb, bc->bit_offset, no_of_bits);
 	}
+	return (bc->window << skip) >> (64 - no_of_bits);
+}
+
+guint64
+tvb_bit_cursor_get_bits(tvb_bit_cursor_t *bc, const gint no_of_bits)
+{
+	guint64 value;
+
+	value = tvb_bit_cursor_peek_bits(bc, no_of_bits);
+	bc->bit_offset += no_of_bits;
 	return value;
 }
+
 /* Get 1 - 32 bits (should be deprecated as same as tvb_get_bits32??) */
 guint32
 tvb_get_bits(tvbuff_t *tvb, const guint bit_offset, const gint no_of_bits, const guint encoding _U_)
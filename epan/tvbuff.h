@@ -219,6 +219,12 @@ WS_DLL_PUBLIC tvbuff_t *tvb_new_composite(void);
  * occur, data access can finally happen after this finalization. */
 WS_DLL_PUBLIC void tvb_composite_finalize(tvbuff_t *tvb);
 
+/** Make a composite tvbuff the owner of its members.  It is then not
+ * chained to its first member when finalized; instead, freeing the
+ * composite frees each of its members.  The members must not be in any
+ * other chain.  Must be called before tvb_composite_finalize(). */
+extern void tvb_composite_own_members(tvbuff_t *tvb);
+
 
 /* Get amount of captured data in the buffer (which is *NOT* necessarily the
  * length of the packet). You probably want tvb_reported_length instead. */
@@ -440,6 +446,35 @@ WS_DLL_PUBLIC guint64 tvb_get_bits64(tvbuff_t *tvb, guint bit_offset,
 WS_DLL_PUBLIC guint32 tvb_get_bits(tvbuff_t *tvb, const guint bit_offset,
     const gint no_of_bits, const guint encoding);
 
+/* A cursor for reading consecutive bit fields from a tvb.  It keeps up to
+ * 64 bits of the tvb's data in a window, so that most reads are a couple
+ * of shifts, and only goes back to the tvb when a field runs past the
+ * window.  Reading past the end of the data throws the same exceptions
+ * that tvb_get_bits64() does.
+ *
+ * bit_offset is the offset, in bits from the start of the tvb, of the
+ * next field; it may be changed directly to skip or align.  The other
+ * members are private. */
+typedef struct tvb_bit_cursor {
+	tvbuff_t *tvb;
+	guint     bit_offset;
+	guint64   window;         /* data from window_offset on, first bit in the MSB */
+	guint     window_offset;  /* bit offset of the window; a multiple of 8 */
+	guint     window_bits;    /* number of bits loaded into the window */
+} tvb_bit_cursor_t;
+
+/* Start a cursor at bit_offset in tvb */
+WS_DLL_PUBLIC void tvb_bit_cursor_init(tvb_bit_cursor_t *bc, tvbuff_t *tvb,
+    const guint bit_offset);
+
+/* get 1 - 64 bits at the cursor without moving it */
+WS_DLL_PUBLIC guint64 tvb_bit_cursor_peek_bits(tvb_bit_cursor_t *bc,
+    const gint no_of_bits);
+
+/* get 1 - 64 bits at the cursor and move it past them */
+WS_DLL_PUBLIC guint64 tvb_bit_cursor_get_bits(tvb_bit_cursor_t *bc,
+    const gint no_of_bits);
+
 /** Returns target for convenience. Does not suffer from possible
  * expense of tvb_get_ptr(), since this routine is smart enough
  * to copy data in chunks if the request range actually exists in
@@ -30,14 +30,30 @@
 typedef struct {
 	GSList		*tvbs;
 
-	/* Used for quick testing to see if this
-	 * is the tvbuff that a COMPOSITE is
-	 * interested in. */
+	/* Filled in by tvb_composite_finalize(): the members in order,
+	 * and the offset of each member within the composite, so that
+	 * the member holding an offset can be found with a binary search. */
+	tvbuff_t	**members;
+	guint		num_members;
 	guint		*start_offsets;
 	guint		*end_offsets;
 
+	/* Copies of ranges that tvb_get_ptr() asked for which span more
+	 * than one member; they live as long as the composite does. */
+	GSList		*windows;
+
+	/* If set, the members are freed along with the composite rather
+	 * than the composite being chained to its first member. */
+	gboolean	owns_members;
+
 } tvb_comp_t;
 
+typedef struct {
+	guint		offset;
+	guint		length;
+	guint8		data[1];	/* length bytes */
+} tvb_comp_window_t;
+
 struct tvb_composite {
 	struct tvbuff tvb;
 
@@ -49,17 +65,21 @@ composite_free(tvbuff_t *tvb)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	tvb_comp_t *composite = &composite_tvb->composite;
+	GSList	   *slist;
 
+	if (composite->owns_members) {
+		for (slist = composite->tvbs; slist != NULL; slist = slist->next)
+			tvb_free((tvbuff_t *)slist->data);
+	}
 	g_slist_free(composite->tvbs);
 
+	g_free(composite->members);
 	g_free(composite->start_offsets);
 	g_free(composite->end_offsets);
-	if (tvb->real_data) {
-		/*
-		 * XXX - do this with a union?
-		 */
-		g_free((gpointer)tvb->real_data);
-	}
+
+	for (slist = composite->windows; slist != NULL; slist = slist->next)
+		g_free(slist->data);
+	g_slist_free(composite->windows);
 }
 
 static guint
@@ -71,117 +91,170 @@ composite_offset(const tvbuff_t *tvb, const guint counter)
 	return tvb_offset_from_real_beginning_counter(member, counter);
 }
 
-static const guint8*
-composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
+/*
+ * Return the index of the member containing abs_offset, or num_members
+ * if abs_offset is at (or past) the end of the composite.
+ */
+static guint
+composite_find_member(const tvb_comp_t *composite, guint abs_offset)
+{
+	guint low = 0, high = composite->num_members;
+
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+
+		if (abs_offset > composite->end_offsets[mid])
+			low = mid + 1;
+		else if (abs_offset < composite->start_offsets[mid])
+			high = mid;
+		else
+			return mid;
+	}
+	return composite->num_members;
+}
+
+static void *
+composite_memcpy(tvbuff_t *tvb, void* _target, guint abs_offset, guint abs_length)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	guint	    i, num_members;
-	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
-	guint	    member_offset;
-	GSList	   *slist;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	guint8	   *target = (guint8 *) _target;
+	guint	    i, member_offset, member_length;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
-	/* Maybe the range specified by offset/length
-	 * is contiguous inside one of the member tvbuffs */
-	composite = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
-		return "";
+		return target;
 	}
 
+	/* Copy the part that's in each member tvb in turn until we have
+	 * copied all the data. */
 	member_offset = abs_offset - composite->start_offsets[i];
+	while (abs_length > 0) {
+		DISSECTOR_ASSERT(i < composite->num_members);
 
-	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
-		/*
-		 * The range is, in fact, contiguous within member_tvb.
-		 */
-		DISSECTOR_ASSERT(!tvb->real_data);
-		return tvb_get_ptr(member_tvb, member_offset, abs_length);
-	}
-	else {
-		tvb->real_data = (guint8 *)tvb_memdup(NULL, tvb, 0, -1);
-		return tvb->real_data + abs_offset;
+		member_length = composite->end_offsets[i] - composite->start_offsets[i] + 1 - member_offset;
+		if (member_length > abs_length)
+			member_length = abs_length;
+
+		tvb_memcpy(composite->members[i], target, member_offset, member_length);
+		target     += member_length;
+		abs_length -= member_length;
+		member_offset = 0;
+		i++;
 	}
 
-	DISSECTOR_ASSERT_NOT_REACHED();
+	return _target;
 }
 
-static void *
-composite_memcpy(tvbuff_t *tvb, void* _target, guint abs_offset, guint abs_length)
+static const guint8*
+composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	guint8 *target = (guint8 *) _target;
-
-	guint	    i, num_members;
-	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
-	guint	    member_offset, member_length;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	tvb_comp_window_t *window;
 	GSList	   *slist;
+	guint	    i, member_offset;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
-	/* Maybe the range specified by offset/length
-	 * is contiguous inside one of the member tvbuffs */
-	composite   = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
-		return target;
+		return "";
 	}
 
+	/* Maybe the range specified by offset/length
+	 * is contiguous inside one of the member tvbuffs */
 	member_offset = abs_offset - composite->start_offsets[i];
+	if (abs_length <= composite->end_offsets[i] - abs_offset + 1)
+		return tvb_get_ptr(composite->members[i], member_offset, abs_length);
+
+	/* No; reuse a copy of a range that covers this one, if we've
+	 * made one, otherwise copy just the bytes that were asked for
+	 * rather than flattening the whole composite. */
+	for (slist = composite->windows; slist != NULL; slist = slist->next) {
+		window = (tvb_comp_window_t *)slist->data;
+		if (abs_offset >= window->offset &&
+		    abs_offset - window->offset + abs_length <= window->length)
+			return window->data + (abs_offset - window->offset);
+	}
+
+	window = (tvb_comp_window_t *)g_malloc(sizeof(tvb_comp_window_t) + abs_length);
+	window->offset = abs_offset;
+	window->length = abs_length;
+	composite_memcpy(tvb, window->data, abs_offset, abs_length);
+	composite->windows = g_slist_prepend(composite->windows, window);
 
-	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
-		DISSECTOR_ASSERT(!tvb->real_data);
-		return tvb_memcpy(member_tvb, target, member_offset, abs_length);
+	return window->data;
+}
+
+static gint
+composite_find_guint8(tvbuff_t *tvb, guint abs_offset, guint limit, guint8 needle)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	guint	    i, member_offset, member_length;
+	gint	    result;
+
+	member_offset = 0;
+	i = composite_find_member(composite, abs_offset);
+	if (i < composite->num_members)
+		member_offset = abs_offset - composite->start_offsets[i];
+
+	/* Search each member in turn, without flattening. */
+	while (limit > 0 && i < composite->num_members) {
+		member_length = composite->end_offsets[i] - composite->start_offsets[i] + 1 - member_offset;
+		if (member_length > limit)
+			member_length = limit;
+
+		result = tvb_find_guint8(composite->members[i], member_offset, member_length, needle);
+		if (result != -1)
+			return composite->start_offsets[i] + result;
+
+		limit -= member_length;
+		member_offset = 0;
+		i++;
 	}
-	else {
-		/* The requested data is non-contiguous inside
-		 * the member tvb. We have to memcpy() the part that's in the member tvb,
-		 * then iterate across the other member tvb's, copying their portions
-		 * until we have copied all data.
-		 */
-		member_length = tvb_length_remaining(member_tvb, member_offset);
-
-		/* composite_memcpy() can't handle a member_length of zero. */
-		DISSECTOR_ASSERT(member_length > 0);
-
-		tvb_memcpy(member_tvb, target, member_offset, member_length);
-		abs_offset	+= member_length;
-		abs_length	-= member_length;
-
-		/* Recurse */
-		if (abs_length > 0) {
-			composite_memcpy(tvb, target + member_length, abs_offset, abs_length);
-		}
 
-		return target;
+	return -1;
+}
+
+static gint
+composite_pbrk_guint8(tvbuff_t *tvb, guint abs_offset, guint limit, const guint8 *needles, guchar *found_needle)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	guint	    i, member_offset, member_length;
+	gint	    result;
+
+	member_offset = 0;
+	i = composite_find_member(composite, abs_offset);
+	if (i < composite->num_members)
+		member_offset = abs_offset - composite->start_offsets[i];
+
+	/* Search each member in turn, without flattening. */
+	while (limit > 0 && i < composite->num_members) {
+		member_length = composite->end_offsets[i] - composite->start_offsets[i] + 1 - member_offset;
+		if (member_length > limit)
+			member_length = limit;
+
+		result = tvb_pbrk_guint8(composite->members[i], member_offset, member_length, needles, found_needle);
+		if (result != -1)
+			return composite->start_offsets[i] + result;
+
+		limit -= member_length;
+		member_offset = 0;
+		i++;
 	}
 
-	DISSECTOR_ASSERT_NOT_REACHED();
+	return -1;
 }
 
 static const struct tvb_ops tvb_composite_ops = {
@@ -191,8 +264,8 @@ static const struct tvb_ops tvb_composite_ops = {
 	composite_offset,     /* offset */
 	composite_get_ptr,    /* get_ptr */
 	composite_memcpy,     /* memcpy */
-	NULL,                 /* find_guint8 XXX */
-	NULL,                 /* pbrk_guint8 XXX */
+	composite_find_guint8, /* find_guint8 */
+	composite_pbrk_guint8, /* pbrk_guint8 */
 	NULL,                 /* clone */
 };
 
@@ -212,8 +285,12 @@ tvb_new_composite(void)
 	tvb_comp_t *composite = &composite_tvb->composite;
 
 	composite->tvbs		 = NULL;
+	composite->members	 = NULL;
+	composite->num_members	 = 0;
 	composite->start_offsets = NULL;
 	composite->end_offsets	 = NULL;
+	composite->windows	 = NULL;
+	composite->owns_members	 = FALSE;
 
 	return tvb;
 }
@@ -254,6 +331,17 @@ tvb_composite_prepend(tvbuff_t *tvb, tvbuff_t *member)
 	composite->tvbs = g_slist_prepend(composite->tvbs, member);
 }
 
+void
+tvb_composite_own_members(tvbuff_t *tvb)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+
+	DISSECTOR_ASSERT(tvb && !tvb->initialized);
+	DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops);
+
+	composite_tvb->composite.owns_members = TRUE;
+}
+
 void
 tvb_composite_finalize(tvbuff_t *tvb)
 {
@@ -278,12 +366,15 @@ tvb_composite_finalize(tvbuff_t *tvb)
 	 */
 	DISSECTOR_ASSERT(num_members);
 
+	composite->members = g_new(tvbuff_t *, num_members);
+	composite->num_members = num_members;
 	composite->start_offsets = g_new(guint, num_members);
 	composite->end_offsets = g_new(guint, num_members);
 
 	for (slist = composite->tvbs; slist != NULL; slist = slist->next) {
 		DISSECTOR_ASSERT((guint) i < num_members);
 		member_tvb = (tvbuff_t *)slist->data;
+		composite->members[i] = member_tvb;
 		composite->start_offsets[i] = tvb->length;
 		tvb->length += member_tvb->length;
 		tvb->reported_length += member_tvb->reported_length;
@@ -293,7 +384,8 @@ tvb_composite_finalize(tvbuff_t *tvb)
 
 	DISSECTOR_ASSERT(composite->tvbs);
 
-	tvb_add_to_chain((tvbuff_t *)composite->tvbs->data, tvb); /* chain composite tvb to first member */
+	if (!composite->owns_members)
+		tvb_add_to_chain((tvbuff_t *)composite->tvbs->data, tvb); /* chain composite tvb to first member */
 	tvb->initialized = TRUE;
 }
 
@@ -0,0 +1,188 @@
+/* wmem_accounting.c
+ * Wireshark Memory Manager Allocation Accounting
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "wmem_core.h"
+#include "wmem_allocator.h"
+#include "wmem_accounting.h"
+#include "wmem_accounting_int.h"
+
+typedef struct _wmem_accounting_entry_t {
+    guint64 bytes;
+    guint64 allocs;
+} wmem_accounting_entry_t;
+
+typedef struct _wmem_accounting_snapshot_t {
+    int                     owner;
+    wmem_accounting_entry_t entry;
+} wmem_accounting_snapshot_t;
+
+/* Accounting is meant for finding out where memory goes, not for everyday
+ * use, so one lock for every pool's counts is good enough. */
+#if GLIB_CHECK_VERSION(2,32,0)
+static GMutex accounting_lock;
+#define ACCOUNTING_LOCK()   g_mutex_lock(&accounting_lock)
+#define ACCOUNTING_UNLOCK() g_mutex_unlock(&accounting_lock)
+#else
+static GStaticMutex accounting_lock = G_STATIC_MUTEX_INIT;
+#define ACCOUNTING_LOCK()   g_static_mutex_lock(&accounting_lock)
+#define ACCOUNTING_UNLOCK() g_static_mutex_unlock(&accounting_lock)
+#endif
+
+/* Owners are stored offset by one, so that "no owner set yet" is NULL */
+#if GLIB_CHECK_VERSION(2,32,0)
+static GPrivate accounting_owner_key;
+
+#define accounting_owner_get() \
+    (GPOINTER_TO_INT(g_private_get(&accounting_owner_key)) - 1)
+#define accounting_owner_set(owner) \
+    g_private_set(&accounting_owner_key, GINT_TO_POINTER((owner) + 1))
+#else
+static int accounting_owner = WMEM_NO_OWNER;
+
+#define accounting_owner_get()      (accounting_owner)
+#define accounting_owner_set(owner) (accounting_owner = (owner))
+#endif
+
+static int accounting_pools = 0;
+
+static void
+wmem_accounting_entry_free(gpointer entry)
+{
+    g_free(entry);
+}
+
+void
+wmem_accounting_enable(wmem_allocator_t *allocator, gboolean enable)
+{
+    ACCOUNTING_LOCK();
+    if (enable && allocator->accounting == NULL) {
+        allocator->accounting = g_hash_table_new_full(g_direct_hash,
+                g_direct_equal, NULL, wmem_accounting_entry_free);
+        accounting_pools++;
+    }
+    else if (!enable && allocator->accounting != NULL) {
+        g_hash_table_destroy(allocator->accounting);
+        allocator->accounting = NULL;
+        accounting_pools--;
+    }
+    ACCOUNTING_UNLOCK();
+}
+
+gboolean
+wmem_accounting_is_active(void)
+{
+    return accounting_pools > 0;
+}
+
+int
+wmem_accounting_set_owner(int owner)
+{
+    int previous = accounting_owner_get();
+
+    accounting_owner_set(owner);
+
+    return previous;
+}
+
+void
+wmem_accounting_charge(wmem_allocator_t *allocator, const size_t size)
+{
+    wmem_accounting_entry_t *entry;
+    gpointer                 key;
+
+    key = GINT_TO_POINTER(accounting_owner_get());
+
+    ACCOUNTING_LOCK();
+    if (allocator->accounting != NULL) {
+        entry = (wmem_accounting_entry_t *)g_hash_table_lookup(
+                allocator->accounting, key);
+        if (entry == NULL) {
+            entry = g_new0(wmem_accounting_entry_t, 1);
+            g_hash_table_insert(allocator->accounting, key, entry);
+        }
+        entry->bytes += size;
+        entry->allocs++;
+    }
+    ACCOUNTING_UNLOCK();
+}
+
+void
+wmem_accounting_reset(wmem_allocator_t *allocator)
+{
+    ACCOUNTING_LOCK();
+    if (allocator->accounting != NULL) {
+        g_hash_table_remove_all(allocator->accounting);
+    }
+    ACCOUNTING_UNLOCK();
+}
+
+void
+wmem_accounting_foreach(wmem_allocator_t *allocator, wmem_accounting_func func,
+        void *user_data)
+{
+    GHashTableIter  iter;
+    gpointer        key, value;
+    GArray         *snapshot;
+    guint           i;
+
+    /* Copy the counts out first, so that func can allocate from the pool */
+    snapshot = g_array_new(FALSE, FALSE, sizeof(wmem_accounting_snapshot_t));
+
+    ACCOUNTING_LOCK();
+    if (allocator->accounting != NULL) {
+        g_hash_table_iter_init(&iter, allocator->accounting);
+        while (g_hash_table_iter_next(&iter, &key, &value)) {
+            wmem_accounting_snapshot_t item;
+
+            item.owner = GPOINTER_TO_INT(key);
+            item.entry = *(wmem_accounting_entry_t *)value;
+            g_array_append_val(snapshot, item);
+        }
+    }
+    ACCOUNTING_UNLOCK();
+
+    for (i = 0; i < snapshot->len; i++) {
+        wmem_accounting_snapshot_t *item =
+            &g_array_index(snapshot, wmem_accounting_snapshot_t, i);
+
+        func(item->owner, item->entry.bytes, item->entry.allocs, user_data);
+    }
+
+    g_array_free(snapshot, TRUE);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,118 @@
+/* wmem_accounting.h
+ * Definitions for the Wireshark Memory Manager Allocation Accounting
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __WMEM_ACCOUNTING_H__
+#define __WMEM_ACCOUNTING_H__
+
+#include <glib.h>
+
+#include "wmem_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @addtogroup wmem
+ *  @{
+ *    @defgroup wmem-accounting Allocation Accounting
+ *
+ *    Counting, for a pool, how much memory was allocated on behalf of each
+ *    "owner". An owner is just an integer chosen by the caller; epan uses
+ *    protocol ids. Each thread has a current owner, which is charged for
+ *    everything that thread allocates from pools with accounting turned on.
+ *
+ *    The counts are of memory allocated since the pool was last emptied
+ *    with wmem_free_all(); memory released with wmem_free() is not
+ *    subtracted, and a wmem_realloc() counts the full new size.
+ *
+ *    @{
+ */
+
+/** The owner that is charged when no owner has been set. */
+#define WMEM_NO_OWNER (-1)
+
+/** Turn accounting on or off for a pool. Turning it off discards the counts.
+ *
+ * @param allocator The pool.
+ * @param enable    TRUE to start counting, FALSE to stop.
+ */
+WS_DLL_PUBLIC
+void
+wmem_accounting_enable(wmem_allocator_t *allocator, gboolean enable);
+
+/** Return TRUE if any pool is counting allocations, so that callers can skip
+ * setting owners when nobody is listening. */
+WS_DLL_PUBLIC
+gboolean
+wmem_accounting_is_active(void);
+
+/** Set the calling thread's current owner.
+ *
+ * @param owner The new owner, or WMEM_NO_OWNER.
+ * @return      The previous owner, to restore later.
+ */
+WS_DLL_PUBLIC
+int
+wmem_accounting_set_owner(int owner);
+
+/** Function signature for wmem_accounting_foreach().
+ *
+ * owner     The owner.
+ * bytes     The number of bytes allocated on its behalf.
+ * allocs    The number of allocations made on its behalf.
+ * user_data Whatever was passed to wmem_accounting_foreach().
+ */
+typedef void (*wmem_accounting_func)(int owner, guint64 bytes, guint64 allocs,
+        void *user_data);
+
+/** Call a function for each owner that has been charged in a pool.
+ *
+ * @param allocator The pool.
+ * @param func      The function to call.
+ * @param user_data Passed to func.
+ */
+WS_DLL_PUBLIC
+void
+wmem_accounting_foreach(wmem_allocator_t *allocator, wmem_accounting_func func,
+        void *user_data);
+
+/**   @}
+ *  @} */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WMEM_ACCOUNTING_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -27,11 +27,12 @@
 #include <glib.h>
 #include <string.h>
 
+#include "wmem_core.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
-enum _wmem_allocator_type_t;
 struct _wmem_user_cb_container_t;
 
 /* See section "4. Internal Design" of doc/README.wmem for details
@@ -50,6 +51,13 @@ struct _wmem_allocator_t {
     /* Callback List */
     struct _wmem_user_cb_container_t *callbacks;
 
+    /* Per-owner counts, if accounting is turned on (see wmem_accounting.h) */
+    GHashTable *accounting;
+
+    /* Usage counters, see wmem_get_stats(); a concurrent allocator leaves
+     * them to the pool it wraps */
+    wmem_allocator_stats_t stats;
+
     /* Implementation details */
     void                        *private_data;
     enum _wmem_allocator_type_t  type;
@@ -0,0 +1,202 @@
+/* wmem_allocator_concurrent.c
+ * Wireshark Memory Manager Concurrent Allocator
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "wmem_core.h"
+#include "wmem_allocator.h"
+#include "wmem_allocator_concurrent.h"
+
+/* A pool that several threads can use at once. It serves allocations from a
+ * slab allocator (or whatever WIRESHARK_DEBUG_WMEM_OVERRIDE asks for) and
+ * holds a lock around every call into it.
+ *
+ * This is meant for pools like the file scope that are shared between
+ * threads dissecting in parallel. Pools that only one thread uses, like each
+ * thread's packet scope, should use one of the other allocators and not pay
+ * for the lock. */
+
+typedef struct _wmem_concurrent_allocator_t {
+#if GLIB_CHECK_VERSION(2,32,0)
+    GMutex            lock;
+#else
+    GMutex           *lock;
+#endif
+    wmem_allocator_t *backing;
+} wmem_concurrent_allocator_t;
+
+#if GLIB_CHECK_VERSION(2,32,0)
+#define CONCURRENT_LOCK(a)   g_mutex_lock(&(a)->lock)
+#define CONCURRENT_UNLOCK(a) g_mutex_unlock(&(a)->lock)
+#else
+#define CONCURRENT_LOCK(a)   g_mutex_lock((a)->lock)
+#define CONCURRENT_UNLOCK(a) g_mutex_unlock((a)->lock)
+#endif
+
+static void *
+wmem_concurrent_alloc(void *private_data, const size_t size)
+{
+    wmem_concurrent_allocator_t *allocator;
+    void                        *ptr;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+
+    CONCURRENT_LOCK(allocator);
+    ptr = wmem_alloc(allocator->backing, size);
+    CONCURRENT_UNLOCK(allocator);
+
+    return ptr;
+}
+
+static void
+wmem_concurrent_free(void *private_data, void *ptr)
+{
+    wmem_concurrent_allocator_t *allocator;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+
+    CONCURRENT_LOCK(allocator);
+    wmem_free(allocator->backing, ptr);
+    CONCURRENT_UNLOCK(allocator);
+}
+
+static void *
+wmem_concurrent_realloc(void *private_data, void *ptr, const size_t size)
+{
+    wmem_concurrent_allocator_t *allocator;
+    void                        *newptr;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+
+    CONCURRENT_LOCK(allocator);
+    newptr = wmem_realloc(allocator->backing, ptr, size);
+    CONCURRENT_UNLOCK(allocator);
+
+    return newptr;
+}
+
+static void
+wmem_concurrent_free_all(void *private_data)
+{
+    wmem_concurrent_allocator_t *allocator;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+
+    CONCURRENT_LOCK(allocator);
+    wmem_free_all(allocator->backing);
+    CONCURRENT_UNLOCK(allocator);
+}
+
+static void
+wmem_concurrent_gc(void *private_data)
+{
+    wmem_concurrent_allocator_t *allocator;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+
+    CONCURRENT_LOCK(allocator);
+    wmem_gc(allocator->backing);
+    CONCURRENT_UNLOCK(allocator);
+}
+
+static void
+wmem_concurrent_allocator_cleanup(void *private_data)
+{
+    wmem_concurrent_allocator_t *allocator;
+
+    allocator = (wmem_concurrent_allocator_t*) private_data;
+
+    wmem_destroy_allocator(allocator->backing);
+#if GLIB_CHECK_VERSION(2,32,0)
+    g_mutex_clear(&allocator->lock);
+#else
+    g_mutex_free(allocator->lock);
+#endif
+    wmem_free(NULL, allocator);
+}
+
+/* The counters are those of the wrapped pool, which is only touched under
+ * the lock; the wrapper doesn't keep its own. */
+void
+wmem_concurrent_allocator_get_stats(wmem_allocator_t *allocator,
+        wmem_allocator_stats_t *stats)
+{
+    wmem_concurrent_allocator_t *concurrent_allocator;
+
+    concurrent_allocator = (wmem_concurrent_allocator_t*) allocator->private_data;
+
+    CONCURRENT_LOCK(concurrent_allocator);
+    wmem_get_stats(concurrent_allocator->backing, stats);
+    CONCURRENT_UNLOCK(concurrent_allocator);
+}
+
+void
+wmem_concurrent_allocator_reset_stats(wmem_allocator_t *allocator)
+{
+    wmem_concurrent_allocator_t *concurrent_allocator;
+
+    concurrent_allocator = (wmem_concurrent_allocator_t*) allocator->private_data;
+
+    CONCURRENT_LOCK(concurrent_allocator);
+    wmem_reset_stats(concurrent_allocator->backing);
+    CONCURRENT_UNLOCK(concurrent_allocator);
+}
+
+void
+wmem_concurrent_allocator_init(wmem_allocator_t *allocator)
+{
+    wmem_concurrent_allocator_t *concurrent_allocator;
+
+    concurrent_allocator = wmem_new(NULL, wmem_concurrent_allocator_t);
+
+    allocator->alloc   = &wmem_concurrent_alloc;
+    allocator->realloc = &wmem_concurrent_realloc;
+    allocator->free    = &wmem_concurrent_free;
+
+    allocator->free_all = &wmem_concurrent_free_all;
+    allocator->gc       = &wmem_concurrent_gc;
+    allocator->cleanup  = &wmem_concurrent_allocator_cleanup;
+
+    allocator->private_data = (void*) concurrent_allocator;
+
+#if GLIB_CHECK_VERSION(2,32,0)
+    g_mutex_init(&concurrent_allocator->lock);
+#else
+    concurrent_allocator->lock = g_mutex_new();
+#endif
+    concurrent_allocator->backing = wmem_allocator_new(WMEM_ALLOCATOR_SLAB);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
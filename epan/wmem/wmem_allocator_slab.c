@@ -0,0 +1,356 @@
+/* wmem_allocator_slab.c
+ * Wireshark Memory Manager Slab Allocator
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "wmem_core.h"
+#include "wmem_allocator.h"
+#include "wmem_allocator_block.h"
+#include "wmem_allocator_slab.h"
+
+/* https://mail.gnome.org/archives/gtk-devel-list/2004-December/msg00091.html
+ * The 2*sizeof(size_t) alignment here is borrowed from GNU libc, so it should
+ * be good most everywhere. It is more conservative than is needed on some
+ * 64-bit platforms, but ia64 does require a 16-byte alignment. The SIMD
+ * extensions for x86 and ppc32 would want a larger alignment than this, but
+ * we don't need to do better than malloc.
+ */
+#define WMEM_ALIGN_AMOUNT (2 * sizeof (gsize))
+
+/* SLAB ALLOCATOR
+ *
+ * Small allocations are rounded up to one of a handful of size classes, and
+ * each class is served from its own pages, so that an object takes exactly
+ * its class size with no header in front of it. Freed objects go on a
+ * per-class free list (linked through their first word) and are handed out
+ * again before the class takes any new space from its current page.
+ *
+ * Pages are WMEM_SLAB_PAGE_SIZE bytes and aligned to that size, so the page
+ * an object is in, and from that its class, can be found from its address
+ * alone; a hash table maps page addresses to pages. Anything that isn't in a
+ * slab page was too big for any class, and was given to the block allocator
+ * that this one keeps for that purpose.
+ *
+ * Classes that are multiples of WMEM_ALIGN_AMOUNT keep that alignment, since
+ * pages are aligned. The smaller classes that aren't (8, 24 and 40 bytes)
+ * are only 8-aligned, but no object of one of those sizes needs more than
+ * that.
+ *
+ * free_all puts every page back on the allocator's list of free pages, and gc
+ * gives the memory back once no page is in use.
+ */
+
+#define WMEM_SLAB_PAGE_SIZE     (64 * 1024)
+#define WMEM_SLAB_REGION_PAGES  16
+#define WMEM_SLAB_MAX_SIZE      256
+
+#define WMEM_SLAB_PAGE_OF(PTR) \
+    ((guint8*)((gsize)(PTR) & ~(gsize)(WMEM_SLAB_PAGE_SIZE - 1)))
+
+static const guint16 wmem_slab_class_sizes[] = {
+    8, 16, 24, 32, 40, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256
+};
+
+#define WMEM_SLAB_NUM_CLASSES G_N_ELEMENTS(wmem_slab_class_sizes)
+
+typedef struct _wmem_slab_page_t {
+    guint8                    *base;
+    guint                      size_class;
+    struct _wmem_slab_page_t  *next_free;
+} wmem_slab_page_t;
+
+/* A run of pages from one malloc, with the slack needed to align them */
+typedef struct _wmem_slab_region_t {
+    void                        *mem;
+    wmem_slab_page_t             pages[WMEM_SLAB_REGION_PAGES];
+    struct _wmem_slab_region_t  *next;
+} wmem_slab_region_t;
+
+typedef struct _wmem_slab_class_t {
+    void   *free_list;
+    guint8 *bump;
+    guint8 *bump_end;
+} wmem_slab_class_t;
+
+typedef struct _wmem_slab_allocator_t {
+    wmem_slab_class_t   classes[WMEM_SLAB_NUM_CLASSES];
+    /* size class for each multiple of 8 bytes up to WMEM_SLAB_MAX_SIZE */
+    guint8              class_index[WMEM_SLAB_MAX_SIZE / 8 + 1];
+    GHashTable         *pages;
+    wmem_slab_page_t   *free_pages;
+    guint               pages_in_use;
+    wmem_slab_region_t *regions;
+    wmem_allocator_t   *large;
+} wmem_slab_allocator_t;
+
+static void
+wmem_slab_new_region(wmem_slab_allocator_t *allocator)
+{
+    wmem_slab_region_t *region;
+    guint8             *base;
+    int                 i;
+
+    region = wmem_new(NULL, wmem_slab_region_t);
+    region->mem = wmem_alloc(NULL,
+            (WMEM_SLAB_REGION_PAGES + 1) * WMEM_SLAB_PAGE_SIZE);
+    base = WMEM_SLAB_PAGE_OF((guint8*)region->mem + WMEM_SLAB_PAGE_SIZE - 1);
+
+    for (i = WMEM_SLAB_REGION_PAGES - 1; i >= 0; i--) {
+        wmem_slab_page_t *page = &region->pages[i];
+
+        page->base       = base + i * WMEM_SLAB_PAGE_SIZE;
+        page->size_class = 0;
+        page->next_free  = allocator->free_pages;
+        allocator->free_pages = page;
+        g_hash_table_insert(allocator->pages, page->base, page);
+    }
+
+    region->next = allocator->regions;
+    allocator->regions = region;
+}
+
+static void *
+wmem_slab_refill(wmem_slab_allocator_t *allocator, guint size_class)
+{
+    wmem_slab_class_t *cls = &allocator->classes[size_class];
+    wmem_slab_page_t  *page;
+    guint8            *ptr;
+
+    if (allocator->free_pages == NULL) {
+        wmem_slab_new_region(allocator);
+    }
+
+    page = allocator->free_pages;
+    allocator->free_pages = page->next_free;
+    page->next_free  = NULL;
+    page->size_class = size_class;
+    allocator->pages_in_use++;
+
+    ptr = page->base;
+    cls->bump     = ptr + wmem_slab_class_sizes[size_class];
+    cls->bump_end = page->base + WMEM_SLAB_PAGE_SIZE;
+
+    return ptr;
+}
+
+static void *
+wmem_slab_alloc(void *private_data, const size_t size)
+{
+    wmem_slab_allocator_t *allocator = (wmem_slab_allocator_t*) private_data;
+    wmem_slab_class_t     *cls;
+    guint                  size_class;
+    void                  *ptr;
+
+    if (size > WMEM_SLAB_MAX_SIZE) {
+        return wmem_alloc(allocator->large, size);
+    }
+
+    size_class = allocator->class_index[(size + 7) / 8];
+    cls = &allocator->classes[size_class];
+
+    if (cls->free_list) {
+        ptr = cls->free_list;
+        cls->free_list = *(void **)ptr;
+        return ptr;
+    }
+
+    if ((gsize)(cls->bump_end - cls->bump) >= wmem_slab_class_sizes[size_class]) {
+        ptr = cls->bump;
+        cls->bump += wmem_slab_class_sizes[size_class];
+        return ptr;
+    }
+
+    return wmem_slab_refill(allocator, size_class);
+}
+
+static wmem_slab_page_t *
+wmem_slab_find_page(wmem_slab_allocator_t *allocator, void *ptr)
+{
+    return (wmem_slab_page_t *)g_hash_table_lookup(allocator->pages,
+            WMEM_SLAB_PAGE_OF(ptr));
+}
+
+static void
+wmem_slab_free(void *private_data, void *ptr)
+{
+    wmem_slab_allocator_t *allocator = (wmem_slab_allocator_t*) private_data;
+    wmem_slab_page_t      *page;
+    wmem_slab_class_t     *cls;
+
+    page = wmem_slab_find_page(allocator, ptr);
+    if (page == NULL) {
+        wmem_free(allocator->large, ptr);
+        return;
+    }
+
+    cls = &allocator->classes[page->size_class];
+    *(void **)ptr = cls->free_list;
+    cls->free_list = ptr;
+}
+
+static void *
+wmem_slab_realloc(void *private_data, void *ptr, const size_t size)
+{
+    wmem_slab_allocator_t *allocator = (wmem_slab_allocator_t*) private_data;
+    wmem_slab_page_t      *page;
+    size_t                 old_size;
+    void                  *newptr;
+
+    page = wmem_slab_find_page(allocator, ptr);
+    if (page == NULL) {
+        if (size > WMEM_SLAB_MAX_SIZE) {
+            return wmem_realloc(allocator->large, ptr, size);
+        }
+        /* Shrinking out of the large pool; we don't know how big the old
+         * allocation was, but it was bigger than the new one */
+        newptr = wmem_slab_alloc(allocator, size);
+        memcpy(newptr, ptr, size);
+        wmem_free(allocator->large, ptr);
+        return newptr;
+    }
+
+    old_size = wmem_slab_class_sizes[page->size_class];
+    if (size <= old_size) {
+        return ptr;
+    }
+
+    newptr = wmem_slab_alloc(allocator, size);
+    memcpy(newptr, ptr, old_size);
+    wmem_slab_free(allocator, ptr);
+
+    return newptr;
+}
+
+static void
+wmem_slab_free_all(void *private_data)
+{
+    wmem_slab_allocator_t *allocator = (wmem_slab_allocator_t*) private_data;
+    wmem_slab_region_t    *region;
+    int                    i;
+
+    memset(allocator->classes, 0, sizeof(allocator->classes));
+
+    allocator->free_pages = NULL;
+    for (region = allocator->regions; region; region = region->next) {
+        for (i = WMEM_SLAB_REGION_PAGES - 1; i >= 0; i--) {
+            region->pages[i].next_free = allocator->free_pages;
+            allocator->free_pages = &region->pages[i];
+        }
+    }
+    allocator->pages_in_use = 0;
+
+    wmem_free_all(allocator->large);
+}
+
+static void
+wmem_slab_free_regions(wmem_slab_allocator_t *allocator)
+{
+    wmem_slab_region_t *region, *next;
+
+    for (region = allocator->regions; region; region = next) {
+        next = region->next;
+        wmem_free(NULL, region->mem);
+        wmem_free(NULL, region);
+    }
+    allocator->regions    = NULL;
+    allocator->free_pages = NULL;
+    g_hash_table_remove_all(allocator->pages);
+}
+
+static void
+wmem_slab_gc(void *private_data)
+{
+    wmem_slab_allocator_t *allocator = (wmem_slab_allocator_t*) private_data;
+
+    /* Objects can't be moved, so pages only go back once they're all free */
+    if (allocator->pages_in_use == 0) {
+        wmem_slab_free_regions(allocator);
+    }
+
+    wmem_gc(allocator->large);
+}
+
+static void
+wmem_slab_allocator_cleanup(void *private_data)
+{
+    wmem_slab_allocator_t *allocator = (wmem_slab_allocator_t*) private_data;
+
+    wmem_slab_free_regions(allocator);
+    g_hash_table_destroy(allocator->pages);
+    wmem_destroy_allocator(allocator->large);
+    wmem_free(NULL, allocator);
+}
+
+void
+wmem_slab_allocator_init(wmem_allocator_t *allocator)
+{
+    wmem_slab_allocator_t *slab_allocator;
+    guint                  size_class, i;
+
+    slab_allocator = wmem_new0(NULL, wmem_slab_allocator_t);
+
+    allocator->alloc   = &wmem_slab_alloc;
+    allocator->realloc = &wmem_slab_realloc;
+    allocator->free    = &wmem_slab_free;
+
+    allocator->free_all = &wmem_slab_free_all;
+    allocator->gc       = &wmem_slab_gc;
+    allocator->cleanup  = &wmem_slab_allocator_cleanup;
+
+    allocator->private_data = (void*) slab_allocator;
+
+    size_class = 0;
+    for (i = 0; i < G_N_ELEMENTS(slab_allocator->class_index); i++) {
+        while (wmem_slab_class_sizes[size_class] < i * 8) {
+            size_class++;
+        }
+        slab_allocator->class_index[i] = (guint8)size_class;
+    }
+
+    slab_allocator->pages = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    /* Not wmem_allocator_new(), so that WIRESHARK_DEBUG_WMEM_OVERRIDE (which
+     * applies to this allocator as a whole) doesn't apply twice */
+    slab_allocator->large = wmem_new0(NULL, wmem_allocator_t);
+    slab_allocator->large->type      = WMEM_ALLOCATOR_BLOCK;
+    slab_allocator->large->callbacks = NULL;
+    slab_allocator->large->accounting = NULL;
+    slab_allocator->large->in_scope  = TRUE;
+    wmem_block_allocator_init(slab_allocator->large);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
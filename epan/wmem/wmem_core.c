@@ -29,11 +29,14 @@
 #include "wmem_scopes.h"
 #include "wmem_map_int.h"
 #include "wmem_user_cb_int.h"
+#include "wmem_accounting_int.h"
 #include "wmem_allocator.h"
 #include "wmem_allocator_simple.h"
 #include "wmem_allocator_block.h"
 #include "wmem_allocator_block_fast.h"
 #include "wmem_allocator_strict.h"
+#include "wmem_allocator_concurrent.h"
+#include "wmem_allocator_slab.h"
 
 /* Set according to the WIRESHARK_DEBUG_WMEM_OVERRIDE environment variable in
  * wmem_init. Should not be set again. */
@@ -53,6 +56,15 @@ wmem_alloc(wmem_allocator_t *allocator, const size_t size)
         return NULL;
     }
 
+    if (G_UNLIKELY(allocator->accounting != NULL)) {
+        wmem_accounting_charge(allocator, size);
+    }
+
+    if (allocator->type != WMEM_ALLOCATOR_CONCURRENT) {
+        allocator->stats.allocs++;
+        allocator->stats.bytes_since_free_all += size;
+    }
+
     return allocator->alloc(allocator->private_data, size);
 }
 
@@ -84,6 +96,10 @@ wmem_free(wmem_allocator_t *allocator, void *ptr)
         return;
     }
 
+    if (allocator->type != WMEM_ALLOCATOR_CONCURRENT) {
+        allocator->stats.frees++;
+    }
+
     allocator->free(allocator->private_data, ptr);
 }
 
@@ -105,6 +121,15 @@ wmem_realloc(wmem_allocator_t *allocator, void *ptr, const size_t size)
 
     g_assert(allocator->in_scope);
 
+    if (G_UNLIKELY(allocator->accounting != NULL)) {
+        wmem_accounting_charge(allocator, size);
+    }
+
+    if (allocator->type != WMEM_ALLOCATOR_CONCURRENT) {
+        allocator->stats.reallocs++;
+        allocator->stats.bytes_since_free_all += size;
+    }
+
     return allocator->realloc(allocator->private_data, ptr, size);
 }
 
@@ -114,6 +139,20 @@ wmem_free_all_real(wmem_allocator_t *allocator, gboolean final)
     wmem_call_callbacks(allocator,
             final ? WMEM_CB_DESTROY_EVENT : WMEM_CB_FREE_EVENT);
     allocator->free_all(allocator->private_data);
+    if (allocator->accounting != NULL) {
+        wmem_accounting_reset(allocator);
+    }
+
+    if (allocator->type != WMEM_ALLOCATOR_CONCURRENT) {
+        wmem_allocator_stats_t *stats = &allocator->stats;
+
+        stats->free_alls++;
+        stats->bytes += stats->bytes_since_free_all;
+        if (stats->bytes_since_free_all > stats->peak_bytes) {
+            stats->peak_bytes = stats->bytes_since_free_all;
+        }
+        stats->bytes_since_free_all = 0;
+    }
 }
 
 void
@@ -125,14 +164,48 @@ wmem_free_all(wmem_allocator_t *allocator)
 void
 wmem_gc(wmem_allocator_t *allocator)
 {
+    if (allocator->type != WMEM_ALLOCATOR_CONCURRENT) {
+        allocator->stats.gcs++;
+    }
+
     allocator->gc(allocator->private_data);
 }
 
+void
+wmem_get_stats(wmem_allocator_t *allocator, wmem_allocator_stats_t *stats)
+{
+    if (allocator->type == WMEM_ALLOCATOR_CONCURRENT) {
+        wmem_concurrent_allocator_get_stats(allocator, stats);
+        return;
+    }
+
+    *stats = allocator->stats;
+
+    /* "bytes" only takes in a cycle when it ends, to keep it off the
+     * allocation path */
+    stats->bytes += stats->bytes_since_free_all;
+    if (stats->bytes_since_free_all > stats->peak_bytes) {
+        stats->peak_bytes = stats->bytes_since_free_all;
+    }
+}
+
+void
+wmem_reset_stats(wmem_allocator_t *allocator)
+{
+    if (allocator->type == WMEM_ALLOCATOR_CONCURRENT) {
+        wmem_concurrent_allocator_reset_stats(allocator);
+        return;
+    }
+
+    memset(&allocator->stats, 0, sizeof(allocator->stats));
+}
+
 void
 wmem_destroy_allocator(wmem_allocator_t *allocator)
 {
 
     wmem_free_all_real(allocator, TRUE);
+    wmem_accounting_enable(allocator, FALSE);
     allocator->cleanup(allocator->private_data);
     wmem_free(NULL, allocator);
 }
@@ -143,7 +216,9 @@ wmem_allocator_new(const wmem_allocator_type_t type)
     wmem_allocator_t      *allocator;
     wmem_allocator_type_t  real_type;
 
-    if (do_override) {
+    /* The concurrent allocator applies the override to the pool it
+     * wraps, so that it stays safe to use from several threads */
+    if (do_override && type != WMEM_ALLOCATOR_CONCURRENT) {
         real_type = override_type;
     }
     else {
@@ -151,9 +226,11 @@ wmem_allocator_new(const wmem_allocator_type_t type)
     }
 
     allocator = wmem_new(NULL, wmem_allocator_t);
-    allocator->type      = real_type;
-    allocator->callbacks = NULL;
-    allocator->in_scope  = TRUE;
+    allocator->type       = real_type;
+    allocator->callbacks  = NULL;
+    allocator->accounting = NULL;
+    allocator->in_scope   = TRUE;
+    memset(&allocator->stats, 0, sizeof(allocator->stats));
 
     switch (real_type) {
         case WMEM_ALLOCATOR_SIMPLE:
@@ -168,6 +245,12 @@ wmem_allocator_new(const wmem_allocator_type_t type)
         case WMEM_ALLOCATOR_STRICT:
             wmem_strict_allocator_init(allocator);
             break;
+        case WMEM_ALLOCATOR_CONCURRENT:
+            wmem_concurrent_allocator_init(allocator);
+            break;
+        case WMEM_ALLOCATOR_SLAB:
+            wmem_slab_allocator_init(allocator);
+            break;
         default:
             g_assert_not_reached();
             /* This is necessary to squelch MSVC errors; is there
@@ -207,6 +290,9 @@ wmem_init(void)
         else if (strncmp(override_env, "block_fast", strlen("block_fast")) == 0) {
             override_type = WMEM_ALLOCATOR_BLOCK_FAST;
         }
+        else if (strncmp(override_env, "slab", strlen("slab")) == 0) {
+            override_type = WMEM_ALLOCATOR_SLAB;
+        }
         else {
             g_warning("Unrecognized wmem override");
             do_override = FALSE;
@@ -61,11 +61,19 @@ typedef enum _wmem_allocator_type_t {
                 memory usage via things like canaries and scrubbing freed
                 memory. Valgrind is the better choice on platforms that support
                 it. */
-    WMEM_ALLOCATOR_BLOCK_FAST /**< A block allocator like WMEM_ALLOCATOR_BLOCK
+    WMEM_ALLOCATOR_BLOCK_FAST, /**< A block allocator like WMEM_ALLOCATOR_BLOCK
                 but even faster by tracking absolutely minimal metadata and
                 making 'free' a no-op. Useful only for very short-lived scopes
                 where there's no reason to free individual allocations because
                 the next free_all is always just around the corner. */
+    WMEM_ALLOCATOR_CONCURRENT, /**< An allocator that several threads can
+                allocate from at once, at the cost of taking a lock on every
+                call. Intended for pools, like the file scope, that are shared
+                between threads dissecting in parallel. */
+    WMEM_ALLOCATOR_SLAB /**< An allocator that rounds small allocations up to
+                one of a few size classes and serves each class from its own
+                pages, with no header on each allocation. Designed for pools
+                that hold very many small, long-lived objects. */
 } wmem_allocator_type_t;
 
 /** Allocate the requested amount of memory in the given pool.
@@ -183,6 +191,41 @@ WS_DLL_PUBLIC
 void
 wmem_gc(wmem_allocator_t *allocator);
 
+/** Usage counters for an allocator, as returned by wmem_get_stats(). Sizes
+ * are what callers asked for, not what the allocator used to serve them.
+ */
+typedef struct _wmem_allocator_stats_t {
+    guint64 allocs;     /**< Calls to wmem_alloc() and wmem_alloc0() */
+    guint64 reallocs;   /**< Calls to wmem_realloc() */
+    guint64 frees;      /**< Calls to wmem_free() */
+    guint64 bytes;      /**< Bytes asked for by allocs and reallocs */
+    guint64 free_alls;  /**< Calls to wmem_free_all() */
+    guint64 gcs;        /**< Calls to wmem_gc() */
+    guint64 bytes_since_free_all; /**< Bytes asked for since the last
+                                       wmem_free_all() */
+    guint64 peak_bytes; /**< The most bytes asked for between two calls to
+                             wmem_free_all() (e.g. the biggest packet, for
+                             the packet scope) */
+} wmem_allocator_stats_t;
+
+/** Get the usage counters of an allocator. They are kept for every
+ * allocator and cost a few additions per call.
+ *
+ * @param allocator The allocator.
+ * @param stats     Filled in with the counters.
+ */
+WS_DLL_PUBLIC
+void
+wmem_get_stats(wmem_allocator_t *allocator, wmem_allocator_stats_t *stats);
+
+/** Set the usage counters of an allocator back to zero.
+ *
+ * @param allocator The allocator.
+ */
+WS_DLL_PUBLIC
+void
+wmem_reset_stats(wmem_allocator_t *allocator);
+
 /** Destroy the given allocator, freeing all memory allocated in it. Once this
  * function has been called, no memory allocated with the allocator is valid.
  *
@@ -21,6 +21,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <string.h>
+
 #include <glib.h>
 
 #include "wmem_core.h"
@@ -44,14 +46,31 @@ wmem_init_hashing(void)
     postseed = g_random_int();
 }
 
-typedef struct _wmem_map_item_t {
+/* The map is an open-addressing table in the style of Google's "Swiss
+ * tables". Keys and values are stored inline in an array of slots, and a
+ * parallel array holds one control byte per slot. A control byte is either
+ * EMPTY, DELETED, or (for a full slot) the low 7 bits of the key's hash. A
+ * probe loads a group of WMEM_MAP_GROUP_WIDTH control bytes at once and
+ * compares them all against the 7-bit hash, so the equality function is
+ * only called on slots that are very likely to match.
+ *
+ * The control array has WMEM_MAP_GROUP_WIDTH extra bytes at the end which
+ * mirror the first bytes of the table, so that a group can be loaded from
+ * any position without wrapping. */
+#define WMEM_MAP_GROUP_WIDTH 16
+
+#define CTRL_EMPTY   ((guint8)0x80)
+#define CTRL_DELETED ((guint8)0xFE)
+#define CTRL_IS_FULL(C) (((C) & 0x80) == 0)
+
+typedef struct _wmem_map_slot_t {
     const void *key;
     void *value;
-    struct _wmem_map_item_t *next;
-} wmem_map_item_t;
+} wmem_map_slot_t;
 
 struct _wmem_map_t {
-    guint count; /* number of items stored */
+    guint count;       /* number of items stored */
+    guint growth_left; /* number of EMPTY slots we may still fill */
 
     /* The base-2 logarithm of the actual size of the table. We store this
      * value for efficiency in hashing, since finding the actual capacity
@@ -59,7 +78,8 @@ struct _wmem_map_t {
      * logarithms is expensive. */
     guint capacity;
 
-    wmem_map_item_t **table;
+    guint8          *ctrl;
+    wmem_map_slot_t *slots;
 
     GHashFunc  hash_func;
     GEqualFunc eql_func;
@@ -68,18 +88,124 @@ struct _wmem_map_t {
 };
 
 /* As per the comment on the 'capacity' member of the wmem_map_t struct, this is
- * the base-2 logarithm, meaning the actual default capacity is 2^5 = 32 */
+ * the base-2 logarithm, meaning the actual default capacity is 2^5 = 32. It
+ * must be at least log2(WMEM_MAP_GROUP_WIDTH). */
 #define WMEM_MAP_DEFAULT_CAPACITY 5
 
 /* Macro for calculating the real capacity of the map by using a left-shift to
  * do the 2^x operation. */
 #define CAPACITY(MAP) ((guint)(1 << (MAP)->capacity))
 
+/* The table is kept at most 7/8 full so that every probe sequence reaches
+ * an EMPTY slot quickly. */
+#define MAX_LOAD(MAP) (CAPACITY(MAP) - CAPACITY(MAP) / 8)
+
 /* Efficient universal integer hashing:
  * https://en.wikipedia.org/wiki/Universal_hashing#Avoiding_modular_arithmetic
+ * followed by a finalizer, so that both the high bits (used to pick the
+ * starting slot) and the low bits (stored in the control byte) are well
+ * mixed.
  */
-#define HASH(MAP, KEY) \
-    ((guint32)(((MAP)->hash_func(KEY) * x) >> (32 - (MAP)->capacity)))
+static inline guint32
+wmem_map_hash(const wmem_map_t *map, const void *key)
+{
+    guint32 h = (guint32)map->hash_func(key) * x;
+
+    h ^= h >> 16;
+    h *= 0x85EBCA6BU;
+    h ^= h >> 13;
+    return h;
+}
+
+#define HASH_POS(MAP, H) ((H) >> (32 - (MAP)->capacity))
+#define HASH_CTRL(H)     ((guint8)((H) & 0x7F))
+
+/* Bitmask helpers over one group of control bytes: bit i of the result is
+ * set if byte i of the group matches. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+static inline guint32
+group_match(const guint8 *group, guint8 c)
+{
+    __m128i g = _mm_loadu_si128((const __m128i *)group);
+    return (guint32)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)c)));
+}
+
+static inline guint32
+group_match_empty_or_deleted(const guint8 *group)
+{
+    /* EMPTY and DELETED are the only control bytes with the top bit set */
+    return (guint32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+}
+#else
+static inline guint32
+group_match(const guint8 *group, guint8 c)
+{
+    guint32 mask = 0;
+    int i;
+
+    for (i = 0; i < WMEM_MAP_GROUP_WIDTH; i++) {
+        if (group[i] == c) {
+            mask |= 1U << i;
+        }
+    }
+    return mask;
+}
+
+static inline guint32
+group_match_empty_or_deleted(const guint8 *group)
+{
+    guint32 mask = 0;
+    int i;
+
+    for (i = 0; i < WMEM_MAP_GROUP_WIDTH; i++) {
+        if (!CTRL_IS_FULL(group[i])) {
+            mask |= 1U << i;
+        }
+    }
+    return mask;
+}
+#endif
+
+/* Index of the lowest set bit; the mask must be non-zero. */
+static inline guint
+lowest_bit(guint32 mask)
+{
+#if defined(__GNUC__) && ((__GNUC__ > 3) || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
+    return (guint)__builtin_ctz(mask);
+#else
+    guint i = 0;
+
+    while (!(mask & 1)) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+/* Set a control byte, keeping the mirrored copy at the end of the array in
+ * sync. */
+static inline void
+set_ctrl(wmem_map_t *map, guint i, guint8 c)
+{
+    guint mask = CAPACITY(map) - 1;
+
+    map->ctrl[i] = c;
+    map->ctrl[((i - WMEM_MAP_GROUP_WIDTH) & mask) + WMEM_MAP_GROUP_WIDTH] = c;
+}
+
+static void
+wmem_map_alloc_table(wmem_map_t *map)
+{
+    guint cap = CAPACITY(map);
+
+    map->ctrl  = (guint8 *)wmem_alloc(map->allocator, cap + WMEM_MAP_GROUP_WIDTH);
+    memset(map->ctrl, CTRL_EMPTY, cap + WMEM_MAP_GROUP_WIDTH);
+    map->slots = wmem_alloc_array(map->allocator, wmem_map_slot_t, cap);
+    map->growth_left = MAX_LOAD(map) - map->count;
+}
 
 wmem_map_t *
 wmem_map_new(wmem_allocator_t *allocator,
@@ -91,78 +217,133 @@ wmem_map_new(wmem_allocator_t *allocator,
 
     map->count     = 0;
     map->capacity  = WMEM_MAP_DEFAULT_CAPACITY;
-    map->table     = wmem_alloc0_array(allocator, wmem_map_item_t*, CAPACITY(map));
     map->hash_func = hash_func;
     map->eql_func  = eql_func;
     map->allocator = allocator;
 
+    wmem_map_alloc_table(map);
+
     return map;
 }
 
-static inline void
-wmem_map_grow(wmem_map_t *map)
+/* Find the first EMPTY or DELETED slot on the probe sequence for hash h.
+ * There is always one, since the table is never completely full. */
+static inline guint
+wmem_map_find_free(const wmem_map_t *map, guint32 h)
 {
-    wmem_map_item_t **old_table, *cur, *nxt;
-    guint             old_cap, i, slot;
-
-    /* store the old table and capacity */
-    old_table = map->table;
-    old_cap   = CAPACITY(map);
-
-    /* double the size (capacity is base-2 logarithm, so this just means
-     * increment it) and allocate new table */
-    map->capacity++;
-    map->table = wmem_alloc0_array(map->allocator, wmem_map_item_t*, CAPACITY(map));
-
-    /* copy all the elements over from the old table */
-    for (i=0; i<old_cap; i++) {
-        cur = old_table[i];
-        while (cur) {
-            nxt              = cur->next;
-            slot             = HASH(map, cur->key);
-            cur->next        = map->table[slot];
-            map->table[slot] = cur;
-            cur              = nxt;
+    guint    mask  = CAPACITY(map) - 1;
+    guint    pos   = HASH_POS(map, h);
+    guint    step  = 0;
+    guint32  match;
+
+    for (;;) {
+        match = group_match_empty_or_deleted(map->ctrl + pos);
+        if (match) {
+            return (pos + lowest_bit(match)) & mask;
         }
+        step += WMEM_MAP_GROUP_WIDTH;
+        pos = (pos + step) & mask;
     }
+}
 
-    /* free the old table */
-    wmem_free(map->allocator, old_table);
+/* Find the slot holding key, or return -1. */
+static inline gint
+wmem_map_find(const wmem_map_t *map, const void *key, guint32 h)
+{
+    guint    mask  = CAPACITY(map) - 1;
+    guint    pos   = HASH_POS(map, h);
+    guint    step  = 0;
+    guint8   c     = HASH_CTRL(h);
+    guint32  match;
+    guint    i;
+
+    for (;;) {
+        match = group_match(map->ctrl + pos, c);
+        while (match) {
+            i = (pos + lowest_bit(match)) & mask;
+            if (map->eql_func(key, map->slots[i].key)) {
+                return (gint)i;
+            }
+            match &= match - 1;
+        }
+        if (group_match(map->ctrl + pos, CTRL_EMPTY)) {
+            return -1;
+        }
+        /* Triangular probing over groups visits every group once when the
+         * number of groups is a power of two. */
+        step += WMEM_MAP_GROUP_WIDTH;
+        pos = (pos + step) & mask;
+    }
 }
 
-void *
-wmem_map_insert(wmem_map_t *map, const void *key, void *value)
+/* Rebuild the table with the given capacity (base-2 logarithm), dropping
+ * all DELETED slots. */
+static void
+wmem_map_resize(wmem_map_t *map, guint capacity)
 {
-    wmem_map_item_t **item;
-    void *old_val;
-
-    /* get a pointer to the slot */
-    item = &(map->table[HASH(map, key)]);
-
-    /* check existing items in that slot */
-    while (*item) {
-        if (map->eql_func(key, (*item)->key)) {
-            /* replace and return old value for this key */
-            old_val = (*item)->value;
-            (*item)->value = value;
-            return old_val;
+    guint8          *old_ctrl  = map->ctrl;
+    wmem_map_slot_t *old_slots = map->slots;
+    guint            old_cap   = CAPACITY(map);
+    guint            i, j;
+    guint32          h;
+
+    map->capacity = capacity;
+    wmem_map_alloc_table(map);
+
+    for (i = 0; i < old_cap; i++) {
+        if (CTRL_IS_FULL(old_ctrl[i])) {
+            h = wmem_map_hash(map, old_slots[i].key);
+            j = wmem_map_find_free(map, h);
+            set_ctrl(map, j, HASH_CTRL(h));
+            map->slots[j] = old_slots[i];
         }
-        item = &((*item)->next);
     }
 
-    /* insert new item */
-    (*item) = wmem_new(map->allocator, wmem_map_item_t);
+    wmem_free(map->allocator, old_ctrl);
+    wmem_free(map->allocator, old_slots);
+}
 
-    (*item)->key   = key;
-    (*item)->value = value;
-    (*item)->next  = NULL;
+void *
+wmem_map_insert(wmem_map_t *map, const void *key, void *value)
+{
+    guint32 h;
+    gint    found;
+    guint   i;
+    void   *old_val;
+
+    h = wmem_map_hash(map, key);
+
+    /* check for an existing item with this key */
+    found = wmem_map_find(map, key, h);
+    if (found >= 0) {
+        /* replace and return old value for this key */
+        old_val = map->slots[found].value;
+        map->slots[found].value = value;
+        return old_val;
+    }
 
-    map->count++;
+    i = wmem_map_find_free(map, h);
+
+    /* Reusing a DELETED slot doesn't use up an EMPTY one, but if we need a
+     * fresh slot and have none left, rebuild: in place if most of the
+     * load is tombstones, otherwise at double the size. */
+    if (map->ctrl[i] == CTRL_EMPTY && map->growth_left == 0) {
+        if (map->count < MAX_LOAD(map) / 2) {
+            wmem_map_resize(map, map->capacity);
+        }
+        else {
+            wmem_map_resize(map, map->capacity + 1);
+        }
+        i = wmem_map_find_free(map, h);
+    }
 
-    /* increase size if we are over-full */
-    if (map->count >= CAPACITY(map)) {
-        wmem_map_grow(map);
+    if (map->ctrl[i] == CTRL_EMPTY) {
+        map->growth_left--;
     }
+    set_ctrl(map, i, HASH_CTRL(h));
+    map->slots[i].key   = key;
+    map->slots[i].value = value;
+    map->count++;
 
     /* no previous entry, return NULL */
     return NULL;
@@ -171,47 +352,29 @@ wmem_map_insert(wmem_map_t *map, const void *key, void *value)
 void *
 wmem_map_lookup(wmem_map_t *map, const void *key)
 {
-    wmem_map_item_t *item;
-
-    /* find correct slot */
-    item = map->table[HASH(map, key)];
+    gint found;
 
-    /* scan list of items in this slot for the correct value */
-    while (item) {
-        if (map->eql_func(key, item->key)) {
-            return item->value;
-        }
-        item = item->next;
-    }
+    found = wmem_map_find(map, key, wmem_map_hash(map, key));
 
-    return NULL;
+    return found >= 0 ? map->slots[found].value : NULL;
 }
 
 void *
 wmem_map_remove(wmem_map_t *map, const void *key)
 {
-    wmem_map_item_t **item, *tmp;
-    void *value;
+    gint found;
 
-    /* get a pointer to the slot */
-    item = &(map->table[HASH(map, key)]);
-
-    /* check the items in that slot */
-    while (*item) {
-        if (map->eql_func(key, (*item)->key)) {
-            /* found it */
-            tmp     = (*item);
-            value   = tmp->value;
-            (*item) = tmp->next;
-            wmem_free(map->allocator, tmp);
-            map->count--;
-            return value;
-        }
-        item = &((*item)->next);
+    found = wmem_map_find(map, key, wmem_map_hash(map, key));
+    if (found < 0) {
+        /* didn't find it */
+        return NULL;
     }
 
-    /* didn't find it */
-    return NULL;
+    /* Leave a tombstone so that probe sequences passing through this slot
+     * keep going; it is reused by a later insert or dropped on resize. */
+    set_ctrl(map, (guint)found, CTRL_DELETED);
+    map->count--;
+    return map->slots[found].value;
 }
 
 /* Borrowed from Perl 5.18. This is based on Bob Jenkin's one-at-a-time
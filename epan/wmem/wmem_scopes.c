@@ -47,25 +47,73 @@
  * perfect, but it should stop most of the bad behaviour that emem permitted.
  */
 
-/* TODO: Make these thread-local */
-static wmem_allocator_t *packet_scope = NULL;
+/* The packet scope is per thread, so that threads dissecting in parallel each
+ * have their own; it is created the first time a thread uses it. The file
+ * scope is shared by all of them and uses the concurrent allocator. */
+#if GLIB_CHECK_VERSION(2,32,0)
+static void
+packet_scope_destroy(gpointer pool)
+{
+    wmem_destroy_allocator((wmem_allocator_t *)pool);
+}
+
+static GPrivate packet_scope_key = G_PRIVATE_INIT(packet_scope_destroy);
+
+#define packet_scope_get() \
+    ((wmem_allocator_t *)g_private_get(&packet_scope_key))
+#define packet_scope_set(pool) \
+    g_private_set(&packet_scope_key, (pool))
+#else
+static wmem_allocator_t *packet_scope_pool = NULL;
+
+#define packet_scope_get()          (packet_scope_pool)
+#define packet_scope_set(pool)      (packet_scope_pool = (pool))
+#endif
+
 static wmem_allocator_t *file_scope   = NULL;
 static wmem_allocator_t *epan_scope   = NULL;
 
 /* Packet Scope */
 
+static wmem_allocator_t *
+packet_scope_new(void)
+{
+    wmem_allocator_t *pool;
+
+    pool = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
+    /* Scopes are initialized to TRUE by default on creation */
+    pool->in_scope = FALSE;
+    packet_scope_set(pool);
+
+    return pool;
+}
+
+static wmem_allocator_t *
+packet_scope_current(void)
+{
+    wmem_allocator_t *pool;
+
+    g_assert(file_scope);
+
+    pool = packet_scope_get();
+    if (G_UNLIKELY(pool == NULL)) {
+        pool = packet_scope_new();
+    }
+
+    return pool;
+}
+
 wmem_allocator_t *
 wmem_packet_scope(void)
 {
-    g_assert(packet_scope);
-
-    return packet_scope;
+    return packet_scope_current();
 }
 
 void
 wmem_enter_packet_scope(void)
 {
-    g_assert(packet_scope);
+    wmem_allocator_t *packet_scope = packet_scope_current();
+
     g_assert(file_scope->in_scope);
     g_assert(!packet_scope->in_scope);
 
@@ -75,7 +123,8 @@ wmem_enter_packet_scope(void)
 void
 wmem_leave_packet_scope(void)
 {
-    g_assert(packet_scope);
+    wmem_allocator_t *packet_scope = packet_scope_current();
+
     g_assert(packet_scope->in_scope);
 
     wmem_free_all(packet_scope);
@@ -104,16 +153,20 @@ wmem_enter_file_scope(void)
 void
 wmem_leave_file_scope(void)
 {
+    wmem_allocator_t *packet_scope = packet_scope_get();
+
     g_assert(file_scope);
     g_assert(file_scope->in_scope);
-    g_assert(!packet_scope->in_scope);
+    g_assert(packet_scope == NULL || !packet_scope->in_scope);
 
     wmem_free_all(file_scope);
     file_scope->in_scope = FALSE;
 
     /* this seems like a good time to do garbage collection */
     wmem_gc(file_scope);
-    wmem_gc(packet_scope);
+    if (packet_scope) {
+        wmem_gc(packet_scope);
+    }
 }
 
 /* Epan Scope */
@@ -131,22 +184,23 @@ wmem_epan_scope(void)
 void
 wmem_init_scopes(void)
 {
-    g_assert(packet_scope == NULL);
+    g_assert(packet_scope_get() == NULL);
     g_assert(file_scope   == NULL);
     g_assert(epan_scope   == NULL);
 
-    packet_scope = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
-    file_scope   = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    packet_scope_new();
+    file_scope   = wmem_allocator_new(WMEM_ALLOCATOR_CONCURRENT);
     epan_scope   = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
 
     /* Scopes are initialized to TRUE by default on creation */
-    packet_scope->in_scope = FALSE;
     file_scope->in_scope   = FALSE;
 }
 
 void
 wmem_cleanup_scopes(void)
 {
+    wmem_allocator_t *packet_scope = packet_scope_get();
+
     g_assert(packet_scope);
     g_assert(file_scope);
     g_assert(epan_scope);
@@ -154,11 +208,12 @@ wmem_cleanup_scopes(void)
     g_assert(packet_scope->in_scope == FALSE);
     g_assert(file_scope->in_scope   == FALSE);
 
+    /* Other threads' packet scopes are freed when those threads exit */
     wmem_destroy_allocator(packet_scope);
     wmem_destroy_allocator(file_scope);
     wmem_destroy_allocator(epan_scope);
 
-    packet_scope = NULL;
+    packet_scope_set(NULL);
     file_scope   = NULL;
     epan_scope   = NULL;
 }
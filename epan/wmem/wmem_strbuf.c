@@ -154,6 +154,22 @@ wmem_strbuf_append(wmem_strbuf_t *strbuf, const gchar *str)
     strbuf->len = MIN(strbuf->len + append_len, strbuf->alloc_len - 1);
 }
 
+void
+wmem_strbuf_append_len(wmem_strbuf_t *strbuf, const gchar *str, gsize len)
+{
+    if (len == 0) {
+        return;
+    }
+
+    wmem_strbuf_grow(strbuf, len);
+
+    /* as wmem_strbuf_append(), cut it short if it runs into max_len */
+    len = MIN(len, WMEM_STRBUF_ROOM(strbuf));
+    memcpy(&strbuf->str[strbuf->len], str, len);
+    strbuf->len += len;
+    strbuf->str[strbuf->len] = '\0';
+}
+
 static void
 wmem_strbuf_append_vprintf(wmem_strbuf_t *strbuf, const gchar *fmt, va_list ap)
 {
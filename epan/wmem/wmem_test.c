@@ -30,7 +30,9 @@
 #include "wmem_allocator.h"
 #include "wmem_allocator_block.h"
 #include "wmem_allocator_block_fast.h"
+#include "wmem_allocator_concurrent.h"
 #include "wmem_allocator_simple.h"
+#include "wmem_allocator_slab.h"
 #include "wmem_allocator_strict.h"
 
 #define STRING_80               "12345678901234567890123456789012345678901234567890123456789012345678901234567890"
@@ -51,7 +53,9 @@ wmem_allocator_force_new(const wmem_allocator_type_t type)
     allocator = wmem_new(NULL, wmem_allocator_t);
     allocator->type = type;
     allocator->callbacks = NULL;
+    allocator->accounting = NULL;
     allocator->in_scope = TRUE;
+    memset(&allocator->stats, 0, sizeof(allocator->stats));
 
     switch (type) {
         case WMEM_ALLOCATOR_SIMPLE:
@@ -66,6 +70,12 @@ wmem_allocator_force_new(const wmem_allocator_type_t type)
         case WMEM_ALLOCATOR_STRICT:
             wmem_strict_allocator_init(allocator);
             break;
+        case WMEM_ALLOCATOR_CONCURRENT:
+            wmem_concurrent_allocator_init(allocator);
+            break;
+        case WMEM_ALLOCATOR_SLAB:
+            wmem_slab_allocator_init(allocator);
+            break;
         default:
             g_assert_not_reached();
             /* This is necessary to squelch MSVC errors; is there
@@ -377,6 +387,408 @@ wmem_test_allocator_strict(void)
     wmem_test_allocator_jumbo(WMEM_ALLOCATOR_STRICT, &wmem_strict_check_canaries);
 }
 
+static void
+wmem_test_allocator_slab(void)
+{
+    wmem_test_allocator(WMEM_ALLOCATOR_SLAB, NULL,
+            MAX_SIMULTANEOUS_ALLOCS*64);
+    wmem_test_allocator_jumbo(WMEM_ALLOCATOR_SLAB, NULL);
+}
+
+static void
+wmem_test_allocator_concurrent(void)
+{
+    wmem_test_allocator(WMEM_ALLOCATOR_CONCURRENT, NULL,
+            MAX_SIMULTANEOUS_ALLOCS*64);
+    wmem_test_allocator_jumbo(WMEM_ALLOCATOR_CONCURRENT, NULL);
+}
+
+#if GLIB_CHECK_VERSION(2,32,0)
+#define CONCURRENT_THREADS 4
+
+static gpointer
+wmem_test_concurrent_thread(gpointer data)
+{
+    wmem_allocator_t *allocator = (wmem_allocator_t *)data;
+    guint8           *ptrs[64];
+    guint             sizes[64];
+    guint             i, j, k;
+
+    for (i=0; i<1024; i++) {
+        for (j=0; j<G_N_ELEMENTS(ptrs); j++) {
+            sizes[j] = (i + j) % 256 + 1;
+            ptrs[j] = (guint8 *)wmem_alloc(allocator, sizes[j]);
+            memset(ptrs[j], (int)j, sizes[j]);
+        }
+        for (j=0; j<G_N_ELEMENTS(ptrs); j++) {
+            for (k=0; k<sizes[j]; k++) {
+                if (ptrs[j][k] != (guint8)j) {
+                    return GINT_TO_POINTER(1);
+                }
+            }
+            if (j % 2) {
+                ptrs[j] = (guint8 *)wmem_realloc(allocator, ptrs[j], sizes[j] * 2);
+            }
+            wmem_free(allocator, ptrs[j]);
+        }
+    }
+
+    return NULL;
+}
+
+static void
+wmem_test_allocator_concurrent_threads(void)
+{
+    wmem_allocator_t *allocator;
+    GThread          *threads[CONCURRENT_THREADS];
+    int               i;
+
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_CONCURRENT);
+
+    for (i=0; i<CONCURRENT_THREADS; i++) {
+        threads[i] = g_thread_new("wmem_test", wmem_test_concurrent_thread,
+                allocator);
+    }
+    for (i=0; i<CONCURRENT_THREADS; i++) {
+        g_assert(g_thread_join(threads[i]) == NULL);
+    }
+
+    wmem_destroy_allocator(allocator);
+}
+#endif
+
+static void
+wmem_test_accounting_cb(int owner, guint64 bytes, guint64 allocs,
+        void *user_data)
+{
+    guint64 *totals = (guint64 *)user_data;
+
+    g_assert(owner >= WMEM_NO_OWNER && owner <= 1);
+    totals[(owner + 1) * 2]     = bytes;
+    totals[(owner + 1) * 2 + 1] = allocs;
+}
+
+static void
+wmem_test_allocator_accounting(void)
+{
+    wmem_allocator_t *allocator;
+    guint64           totals[6];
+    int               previous;
+
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_STRICT);
+
+    /* nothing is counted until accounting is turned on */
+    wmem_alloc(allocator, 100);
+    g_assert(!wmem_accounting_is_active());
+    wmem_accounting_enable(allocator, TRUE);
+    g_assert(wmem_accounting_is_active());
+
+    previous = wmem_accounting_set_owner(0);
+    wmem_alloc(allocator, 10);
+    wmem_alloc(allocator, 20);
+    wmem_accounting_set_owner(1);
+    wmem_alloc(allocator, 5);
+    wmem_accounting_set_owner(WMEM_NO_OWNER);
+    wmem_alloc(allocator, 7);
+
+    memset(totals, 0, sizeof totals);
+    wmem_accounting_foreach(allocator, wmem_test_accounting_cb, totals);
+    g_assert(totals[0] == 7  && totals[1] == 1);
+    g_assert(totals[2] == 30 && totals[3] == 2);
+    g_assert(totals[4] == 5  && totals[5] == 1);
+
+    /* emptying the pool empties the counts */
+    wmem_free_all(allocator);
+    memset(totals, 0, sizeof totals);
+    wmem_accounting_foreach(allocator, wmem_test_accounting_cb, totals);
+    g_assert(totals[0] == 0 && totals[2] == 0 && totals[4] == 0);
+
+    wmem_accounting_set_owner(previous);
+    wmem_accounting_enable(allocator, FALSE);
+    g_assert(!wmem_accounting_is_active());
+
+    wmem_destroy_allocator(allocator);
+}
+
+static void
+wmem_test_allocator_stats(void)
+{
+    wmem_allocator_t       *allocator;
+    wmem_allocator_stats_t  stats;
+    void                   *ptr;
+
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_BLOCK);
+
+    wmem_get_stats(allocator, &stats);
+    g_assert(stats.allocs == 0 && stats.bytes == 0 && stats.peak_bytes == 0);
+
+    ptr = wmem_alloc(allocator, 10);
+    wmem_alloc0(allocator, 20);
+    ptr = wmem_realloc(allocator, ptr, 40);
+    wmem_free(allocator, ptr);
+
+    wmem_get_stats(allocator, &stats);
+    g_assert(stats.allocs == 2 && stats.reallocs == 1 && stats.frees == 1);
+    g_assert(stats.bytes == 70 && stats.bytes_since_free_all == 70);
+    g_assert(stats.peak_bytes == 70);
+
+    /* the peak is kept across cycles, the running count isn't */
+    wmem_free_all(allocator);
+    wmem_alloc(allocator, 5);
+    wmem_gc(allocator);
+
+    wmem_get_stats(allocator, &stats);
+    g_assert(stats.free_alls == 1 && stats.gcs == 1);
+    g_assert(stats.bytes == 75 && stats.bytes_since_free_all == 5);
+    g_assert(stats.peak_bytes == 70);
+
+    wmem_reset_stats(allocator);
+    wmem_get_stats(allocator, &stats);
+    g_assert(stats.allocs == 0 && stats.bytes == 0 && stats.peak_bytes == 0);
+
+    wmem_destroy_allocator(allocator);
+
+    /* a concurrent allocator reports the pool it wraps, counted once */
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_CONCURRENT);
+    wmem_alloc(allocator, 8);
+    wmem_free_all(allocator);
+
+    wmem_get_stats(allocator, &stats);
+    g_assert(stats.allocs == 1 && stats.bytes == 8 && stats.free_alls == 1);
+
+    wmem_destroy_allocator(allocator);
+
+    /* a slab allocator counts what goes to its pool for large blocks the
+     * same as what it serves from its slabs */
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_SLAB);
+
+    wmem_get_stats(allocator, &stats);
+    g_assert(stats.allocs == 0 && stats.bytes == 0 && stats.peak_bytes == 0);
+
+    ptr = wmem_alloc(allocator, 16);
+    wmem_free(allocator, wmem_alloc(allocator, 1024));
+    ptr = wmem_realloc(allocator, ptr, 512);
+
+    wmem_get_stats(allocator, &stats);
+    g_assert(stats.allocs == 2 && stats.reallocs == 1 && stats.frees == 1);
+    g_assert(stats.bytes == 1552 && stats.peak_bytes == 1552);
+
+    wmem_free_all(allocator);
+    wmem_alloc(allocator, 2048);
+    wmem_alloc(allocator, 8);
+    wmem_free_all(allocator);
+
+    wmem_get_stats(allocator, &stats);
+    g_assert(stats.allocs == 4 && stats.free_alls == 2);
+    g_assert(stats.bytes == 3608 && stats.bytes_since_free_all == 0);
+    g_assert(stats.peak_bytes == 2056);
+
+    wmem_destroy_allocator(allocator);
+}
+
+/* ALLOCATOR TIMING FUNCTIONS (/wmem/performance/) */
+
+/* Allocation traces that look like what dissection asks of the scopes. The
+ * packet trace is a packet scope: per packet, a few dozen to a couple of
+ * hundred allocations, mostly small structs and strings, some buffers that
+ * grow by doubling, a few frees, and everything freed at the end. The file
+ * trace is a file scope: small, long-lived allocations and the odd free.
+ * Compare them with what "-z mem,scope" reports for real captures. */
+#define TRACE_PACKETS      4000
+#define TRACE_FILE_ALLOCS  (TRACE_PACKETS*20)
+#define TRACE_SLOTS        256
+
+typedef enum {
+    TRACE_ALLOC,
+    TRACE_REALLOC,
+    TRACE_FREE,
+    TRACE_FREE_ALL
+} wmem_trace_op_t;
+
+typedef struct {
+    wmem_trace_op_t op;
+    guint32         slot;
+    guint32         size;
+} wmem_trace_entry_t;
+
+static guint32
+wmem_trace_size(GRand *rand)
+{
+    gint32 dice = g_rand_int_range(rand, 0, 100);
+
+    if (dice < 70) {
+        return g_rand_int_range(rand, 8, 48);
+    }
+    if (dice < 92) {
+        return g_rand_int_range(rand, 48, 256);
+    }
+    return g_rand_int_range(rand, 256, 2048);
+}
+
+static GArray *
+wmem_trace_packets(void)
+{
+    GArray             *trace;
+    GRand              *rand;
+    wmem_trace_entry_t  entry;
+    guint32             sizes[TRACE_SLOTS];
+    int                 packet, i, count;
+
+    trace = g_array_new(FALSE, FALSE, sizeof(wmem_trace_entry_t));
+    rand = g_rand_new_with_seed(20150101);
+
+    for (packet = 0; packet < TRACE_PACKETS; packet++) {
+        memset(sizes, 0, sizeof sizes);
+        count = g_rand_int_range(rand, 30, 200);
+
+        for (i = 0; i < count; i++) {
+            entry.slot = g_rand_int_range(rand, 0, TRACE_SLOTS);
+            if (sizes[entry.slot] != 0 && g_rand_int_range(rand, 0, 100) < 5) {
+                /* a growing buffer, e.g. a wmem_strbuf */
+                entry.op = TRACE_REALLOC;
+                entry.size = sizes[entry.slot] * 2;
+            }
+            else if (sizes[entry.slot] != 0 && g_rand_int_range(rand, 0, 100) < 3) {
+                entry.op = TRACE_FREE;
+                entry.size = 0;
+            }
+            else {
+                entry.op = TRACE_ALLOC;
+                entry.size = wmem_trace_size(rand);
+            }
+            sizes[entry.slot] = entry.size;
+            g_array_append_val(trace, entry);
+        }
+
+        entry.op = TRACE_FREE_ALL;
+        entry.slot = 0;
+        entry.size = 0;
+        g_array_append_val(trace, entry);
+    }
+
+    g_rand_free(rand);
+    return trace;
+}
+
+static GArray *
+wmem_trace_file(void)
+{
+    GArray             *trace;
+    GRand              *rand;
+    wmem_trace_entry_t  entry;
+    gboolean            used[TRACE_SLOTS];
+    int                 i;
+
+    trace = g_array_new(FALSE, FALSE, sizeof(wmem_trace_entry_t));
+    rand = g_rand_new_with_seed(20150102);
+    memset(used, 0, sizeof used);
+
+    for (i = 0; i < TRACE_FILE_ALLOCS; i++) {
+        entry.slot = g_rand_int_range(rand, 0, TRACE_SLOTS);
+        if (used[entry.slot] && g_rand_int_range(rand, 0, 100) < 2) {
+            entry.op = TRACE_FREE;
+            entry.size = 0;
+            used[entry.slot] = FALSE;
+        }
+        else {
+            entry.op = TRACE_ALLOC;
+            entry.size = g_rand_int_range(rand, 16, 128);
+            used[entry.slot] = TRUE;
+        }
+        g_array_append_val(trace, entry);
+    }
+
+    entry.op = TRACE_FREE_ALL;
+    entry.slot = 0;
+    entry.size = 0;
+    g_array_append_val(trace, entry);
+
+    g_rand_free(rand);
+    return trace;
+}
+
+/* Replays a trace and returns how long it took, in seconds */
+static double
+wmem_trace_replay(wmem_allocator_t *allocator, const GArray *trace)
+{
+    void   *slots[TRACE_SLOTS];
+    GTimer *timer;
+    double  elapsed;
+    guint   i;
+
+    memset(slots, 0, sizeof slots);
+    timer = g_timer_new();
+
+    for (i = 0; i < trace->len; i++) {
+        const wmem_trace_entry_t *entry = &g_array_index(trace, wmem_trace_entry_t, i);
+
+        switch (entry->op) {
+            case TRACE_ALLOC:
+                slots[entry->slot] = wmem_alloc(allocator, entry->size);
+                break;
+            case TRACE_REALLOC:
+                slots[entry->slot] = wmem_realloc(allocator, slots[entry->slot], entry->size);
+                break;
+            case TRACE_FREE:
+                wmem_free(allocator, slots[entry->slot]);
+                slots[entry->slot] = NULL;
+                break;
+            case TRACE_FREE_ALL:
+                wmem_free_all(allocator);
+                memset(slots, 0, sizeof slots);
+                break;
+        }
+    }
+
+    g_timer_stop(timer);
+    elapsed = g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+
+    return elapsed;
+}
+
+static void
+wmem_time_allocators(void)
+{
+    static const struct {
+        wmem_allocator_type_t  type;
+        const char            *name;
+    } types[] = {
+        { WMEM_ALLOCATOR_SIMPLE,     "simple" },
+        { WMEM_ALLOCATOR_BLOCK,      "block" },
+        { WMEM_ALLOCATOR_BLOCK_FAST, "block_fast" },
+        { WMEM_ALLOCATOR_SLAB,       "slab" },
+        { WMEM_ALLOCATOR_CONCURRENT, "concurrent" },
+        { WMEM_ALLOCATOR_STRICT,     "strict" }
+    };
+    GArray                 *packet_trace, *file_trace;
+    wmem_allocator_t       *allocator;
+    wmem_allocator_stats_t  stats;
+    double                  packet_secs, file_secs;
+    guint                   i;
+
+    packet_trace = wmem_trace_packets();
+    file_trace = wmem_trace_file();
+
+    printf("\n%-12s %12s %12s %12s\n", "Allocator", "Packet (s)", "File (s)", "Peak bytes");
+    for (i = 0; i < G_N_ELEMENTS(types); i++) {
+        allocator = wmem_allocator_force_new(types[i].type);
+        packet_secs = wmem_trace_replay(allocator, packet_trace);
+        wmem_get_stats(allocator, &stats);
+        wmem_destroy_allocator(allocator);
+
+        allocator = wmem_allocator_force_new(types[i].type);
+        file_secs = wmem_trace_replay(allocator, file_trace);
+        wmem_destroy_allocator(allocator);
+
+        printf("%-12s %12.5f %12.5f %12" G_GINT64_MODIFIER "u\n",
+                types[i].name, packet_secs, file_secs, stats.peak_bytes);
+    }
+
+    g_array_free(packet_trace, TRUE);
+    g_array_free(file_trace, TRUE);
+}
+
 /* UTILITY TESTING FUNCTIONS (/wmem/utils/) */
 
 static void
@@ -660,6 +1072,30 @@ wmem_test_map(void)
     }
     wmem_free_all(allocator);
 
+    /* repeated insertion and removal of a small working set, which leaves
+     * deleted slots behind that must be reused or cleared out */
+    map = wmem_map_new(allocator, g_direct_hash, g_direct_equal);
+    g_assert(map);
+
+    for (i=0; i<CONTAINER_ITERS*100; i++) {
+        ret = wmem_map_insert(map, GINT_TO_POINTER(i), GINT_TO_POINTER(i));
+        g_assert(ret == NULL);
+        if (i >= 10) {
+            ret = wmem_map_remove(map, GINT_TO_POINTER(i-10));
+            g_assert(ret == GINT_TO_POINTER(i-10));
+        }
+    }
+    for (i=0; i<CONTAINER_ITERS*100; i++) {
+        ret = wmem_map_lookup(map, GINT_TO_POINTER(i));
+        if (i >= CONTAINER_ITERS*100 - 10) {
+            g_assert(ret == GINT_TO_POINTER(i));
+        }
+        else {
+            g_assert(ret == NULL);
+        }
+    }
+    wmem_free_all(allocator);
+
     map = wmem_map_new(allocator, wmem_str_hash, g_str_equal);
     g_assert(map);
 
@@ -782,6 +1218,10 @@ wmem_test_strbuf(void)
     g_assert_cmpstr(wmem_strbuf_get_str(strbuf), ==, "TES");
     g_assert(wmem_strbuf_get_len(strbuf) == 3);
 
+    wmem_strbuf_append_len(strbuf, "FUZZ", 2);
+    g_assert_cmpstr(wmem_strbuf_get_str(strbuf), ==, "TESFU");
+    g_assert(wmem_strbuf_get_len(strbuf) == 5);
+
     strbuf = wmem_strbuf_sized_new(allocator, 10, 10);
     g_assert(strbuf);
     g_assert_cmpstr(wmem_strbuf_get_str(strbuf), ==, "");
@@ -803,6 +1243,10 @@ wmem_test_strbuf(void)
     g_assert_cmpstr(wmem_strbuf_get_str(strbuf), ==, "FUZZ3abcd");
     g_assert(wmem_strbuf_get_len(strbuf) == 9);
 
+    wmem_strbuf_append_len(strbuf, "xy", 2);
+    g_assert_cmpstr(wmem_strbuf_get_str(strbuf), ==, "FUZZ3abcd");
+    g_assert(wmem_strbuf_get_len(strbuf) == 9);
+
     wmem_strbuf_append_unichar(strbuf, g_utf8_get_char("\xC2\xA9"));
     g_assert_cmpstr(wmem_strbuf_get_str(strbuf), ==, "FUZZ3abcd");
     g_assert(wmem_strbuf_get_len(strbuf) == 9);
@@ -982,6 +1426,113 @@ wmem_test_tree(void)
     wmem_destroy_allocator(allocator);
 }
 
+static gboolean
+wmem_test_btree_order_cb(void *value, void *user_data)
+{
+    guint32 *last = (guint32 *)user_data;
+
+    /* values are the keys, so they must come out in increasing order */
+    g_assert(GPOINTER_TO_UINT(value) > *last);
+    *last = GPOINTER_TO_UINT(value);
+
+    return FALSE;
+}
+
+static void
+wmem_test_btree(void)
+{
+    wmem_allocator_t   *allocator, *extra_allocator;
+    wmem_tree_t        *tree, *rb_tree;
+    guint32             i, last;
+    wmem_tree_key_t     keys[3];
+    guint32             key_parts[2];
+
+    allocator       = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+    extra_allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+
+    tree = wmem_tree_new_btree(allocator);
+    g_assert(tree);
+    g_assert(wmem_tree_is_empty(tree));
+
+    /* test basic 32-bit key operations */
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert(wmem_tree_lookup32(tree, i) == NULL);
+        if (i > 0) {
+            g_assert(wmem_tree_lookup32_le(tree, i) == GINT_TO_POINTER(i-1));
+        }
+        wmem_tree_insert32(tree, i, GINT_TO_POINTER(i));
+        g_assert(wmem_tree_lookup32(tree, i) == GINT_TO_POINTER(i));
+        g_assert(!wmem_tree_is_empty(tree));
+    }
+    wmem_free_all(allocator);
+
+    /* random keys, checked against a red/black tree */
+    tree    = wmem_tree_new_btree(allocator);
+    rb_tree = wmem_tree_new(allocator);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        guint32 rand_int = g_test_rand_int_range(1, 1000000);
+        wmem_tree_insert32(tree, rand_int, GINT_TO_POINTER(rand_int));
+        wmem_tree_insert32(rb_tree, rand_int, GINT_TO_POINTER(rand_int));
+    }
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        guint32 rand_int = g_test_rand_int_range(0, 1000001);
+        g_assert(wmem_tree_lookup32(tree, rand_int) ==
+                wmem_tree_lookup32(rb_tree, rand_int));
+        g_assert(wmem_tree_lookup32_le(tree, rand_int) ==
+                wmem_tree_lookup32_le(rb_tree, rand_int));
+    }
+    g_assert(wmem_tree_lookup32_le(tree, 0) == NULL);
+
+    last = 0;
+    wmem_tree_foreach(tree, wmem_test_btree_order_cb, &last);
+    g_assert(last == GPOINTER_TO_UINT(wmem_tree_lookup32_le(rb_tree, G_MAXUINT32)));
+    wmem_free_all(allocator);
+
+    /* test auto-reset functionality */
+    tree = wmem_tree_new_autoreset_btree(allocator, extra_allocator);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        wmem_tree_insert32(tree, i, GINT_TO_POINTER(i));
+    }
+    wmem_free_all(extra_allocator);
+    g_assert(wmem_tree_is_empty(tree));
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert(wmem_tree_lookup32(tree, i) == NULL);
+        g_assert(wmem_tree_lookup32_le(tree, i) == NULL);
+    }
+    wmem_free_all(allocator);
+
+    /* test array keys, which create subtrees of the same kind */
+    tree = wmem_tree_new_btree(allocator);
+    keys[0].length = 2;
+    keys[0].key    = key_parts;
+    keys[1].length = 0;
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        key_parts[0] = i % 7;
+        key_parts[1] = i * 4;
+        wmem_tree_insert32_array(tree, keys, GINT_TO_POINTER(i));
+    }
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        key_parts[0] = i % 7;
+        key_parts[1] = i * 4;
+        g_assert(wmem_tree_lookup32_array(tree, keys) == GINT_TO_POINTER(i));
+        key_parts[1] = i * 4 + 3;
+        g_assert(wmem_tree_lookup32_array_le(tree, keys) == GINT_TO_POINTER(i));
+    }
+
+    cb_called_count    = 0;
+    cb_continue_count  = CONTAINER_ITERS;
+    expected_user_data = GINT_TO_POINTER(g_test_rand_int());
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        value_seen[i] = FALSE;
+    }
+    wmem_tree_foreach(tree, wmem_test_foreach_cb, expected_user_data);
+    g_assert(cb_called_count   == CONTAINER_ITERS);
+    g_assert(cb_continue_count == 0);
+
+    wmem_destroy_allocator(extra_allocator);
+    wmem_destroy_allocator(allocator);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -995,7 +1546,20 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/allocator/blk_fast",  wmem_test_allocator_block_fast);
     g_test_add_func("/wmem/allocator/simple",    wmem_test_allocator_simple);
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
+    g_test_add_func("/wmem/allocator/slab",      wmem_test_allocator_slab);
+    g_test_add_func("/wmem/allocator/concurrent", wmem_test_allocator_concurrent);
+#if GLIB_CHECK_VERSION(2,32,0)
+    g_test_add_func("/wmem/allocator/concurrent_threads",
+            wmem_test_allocator_concurrent_threads);
+#endif
     g_test_add_func("/wmem/allocator/callbacks", wmem_test_allocator_callbacks);
+    g_test_add_func("/wmem/allocator/accounting", wmem_test_allocator_accounting);
+    g_test_add_func("/wmem/allocator/stats",     wmem_test_allocator_stats);
+
+    /* Only with "-m perf" */
+    if (g_test_perf()) {
+        g_test_add_func("/wmem/performance/allocators", wmem_time_allocators);
+    }
 
     g_test_add_func("/wmem/utils/misc",    wmem_test_miscutls);
     g_test_add_func("/wmem/utils/strings", wmem_test_strutls);
@@ -1007,6 +1571,7 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/datastruct/stack",  wmem_test_stack);
     g_test_add_func("/wmem/datastruct/strbuf", wmem_test_strbuf);
     g_test_add_func("/wmem/datastruct/tree",   wmem_test_tree);
+    g_test_add_func("/wmem/datastruct/btree",  wmem_test_btree);
 
     ret = g_test_run();
 
@@ -51,12 +51,33 @@ struct _wmem_tree_node_t {
 
 typedef struct _wmem_tree_node_t wmem_tree_node_t;
 
+/* B+tree nodes, used instead of red/black nodes by trees created with
+ * wmem_tree_new_btree(). Inner nodes hold n keys and n+1 children, where
+ * keys[i] is the smallest key stored under ptr[i+1]. Leaves hold n keys and
+ * their data, and are chained together in key order for wmem_tree_foreach().
+ * Keys are never removed, so every key used as a separator is still present
+ * in the leaf it came from. */
+#define WMEM_BTREE_MAX_KEYS 32
+
+struct _wmem_btree_node_t {
+    guint16  n;
+    guint16  is_leaf;
+    guint32  subtree_mask; /* leaves only: bit i set if ptr[i] is a subtree */
+    struct _wmem_btree_node_t *next; /* leaves only */
+    guint32  keys[WMEM_BTREE_MAX_KEYS];
+    void    *ptr[WMEM_BTREE_MAX_KEYS + 1];
+};
+
+typedef struct _wmem_btree_node_t wmem_btree_node_t;
+
 struct _wmem_tree_t {
-    wmem_allocator_t *master;
-    wmem_allocator_t *allocator;
-    wmem_tree_node_t *root;
-    guint             master_cb_id;
-    guint             slave_cb_id;
+    wmem_allocator_t  *master;
+    wmem_allocator_t  *allocator;
+    wmem_tree_node_t  *root;
+    wmem_btree_node_t *btree_root;
+    gboolean           is_btree;
+    guint              master_cb_id;
+    guint              slave_cb_id;
 };
 
 static wmem_tree_node_t *
@@ -225,9 +246,22 @@ wmem_tree_new(wmem_allocator_t *allocator)
     wmem_tree_t *tree;
 
     tree = wmem_new(allocator, wmem_tree_t);
-    tree->master    = allocator;
-    tree->allocator = allocator;
-    tree->root      = NULL;
+    tree->master     = allocator;
+    tree->allocator  = allocator;
+    tree->root       = NULL;
+    tree->btree_root = NULL;
+    tree->is_btree   = FALSE;
+
+    return tree;
+}
+
+wmem_tree_t *
+wmem_tree_new_btree(wmem_allocator_t *allocator)
+{
+    wmem_tree_t *tree;
+
+    tree = wmem_tree_new(allocator);
+    tree->is_btree = TRUE;
 
     return tree;
 }
@@ -238,7 +272,8 @@ wmem_tree_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event,
 {
     wmem_tree_t *tree = (wmem_tree_t *)user_data;
 
-    tree->root = NULL;
+    tree->root       = NULL;
+    tree->btree_root = NULL;
 
     if (event == WMEM_CB_DESTROY_EVENT) {
         wmem_unregister_callback(tree->master, tree->master_cb_id);
@@ -265,9 +300,11 @@ wmem_tree_new_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave)
     wmem_tree_t *tree;
 
     tree = wmem_new(master, wmem_tree_t);
-    tree->master    = master;
-    tree->allocator = slave;
-    tree->root      = NULL;
+    tree->master     = master;
+    tree->allocator  = slave;
+    tree->root       = NULL;
+    tree->btree_root = NULL;
+    tree->is_btree   = FALSE;
 
     tree->master_cb_id = wmem_register_callback(master, wmem_tree_destroy_cb,
             tree);
@@ -277,10 +314,21 @@ wmem_tree_new_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave)
     return tree;
 }
 
+wmem_tree_t *
+wmem_tree_new_autoreset_btree(wmem_allocator_t *master, wmem_allocator_t *slave)
+{
+    wmem_tree_t *tree;
+
+    tree = wmem_tree_new_autoreset(master, slave);
+    tree->is_btree = TRUE;
+
+    return tree;
+}
+
 gboolean
 wmem_tree_is_empty(wmem_tree_t *tree)
 {
-    return tree->root == NULL;
+    return tree->root == NULL && tree->btree_root == NULL;
 }
 
 static wmem_tree_node_t *
@@ -305,6 +353,191 @@ create_node(wmem_allocator_t *allocator, wmem_tree_node_t *parent, guint32 key,
 }
 
 #define CREATE_DATA(TRANSFORM, DATA) ((TRANSFORM) ? (TRANSFORM)(DATA) : (DATA))
+
+static wmem_btree_node_t *
+btree_new_node(wmem_allocator_t *allocator, gboolean is_leaf)
+{
+    wmem_btree_node_t *node;
+
+    node = wmem_new(allocator, wmem_btree_node_t);
+
+    node->n            = 0;
+    node->is_leaf      = is_leaf;
+    node->subtree_mask = 0;
+    node->next         = NULL;
+
+    return node;
+}
+
+/* Returns the number of keys in the node that are <= key, which is the
+ * index of the child to descend into for an inner node. */
+static inline guint
+btree_upper_bound(const wmem_btree_node_t *node, guint32 key)
+{
+    guint lo = 0, hi = node->n, mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (node->keys[mid] <= key) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/* Split the full child at index idx of the (non-full) inner node parent. */
+static void
+btree_split_child(wmem_allocator_t *allocator, wmem_btree_node_t *parent,
+        guint idx)
+{
+    wmem_btree_node_t *child = (wmem_btree_node_t *)parent->ptr[idx];
+    wmem_btree_node_t *right;
+    guint32 separator;
+    guint mid = WMEM_BTREE_MAX_KEYS / 2;
+
+    right = btree_new_node(allocator, child->is_leaf);
+
+    if (child->is_leaf) {
+        /* the upper half moves to the new leaf, and its first key is
+         * copied up */
+        right->n = WMEM_BTREE_MAX_KEYS - mid;
+        memcpy(right->keys, child->keys + mid, right->n * sizeof(guint32));
+        memcpy(right->ptr, child->ptr + mid, right->n * sizeof(void *));
+        right->subtree_mask = child->subtree_mask >> mid;
+        child->subtree_mask &= (1U << mid) - 1;
+        right->next = child->next;
+        child->next = right;
+        separator = right->keys[0];
+    }
+    else {
+        /* the middle key moves up, the keys after it move to the new node */
+        separator = child->keys[mid];
+        right->n = WMEM_BTREE_MAX_KEYS - mid - 1;
+        memcpy(right->keys, child->keys + mid + 1, right->n * sizeof(guint32));
+        memcpy(right->ptr, child->ptr + mid + 1,
+                (right->n + 1) * sizeof(void *));
+    }
+    child->n = mid;
+
+    memmove(parent->keys + idx + 1, parent->keys + idx,
+            (parent->n - idx) * sizeof(guint32));
+    memmove(parent->ptr + idx + 2, parent->ptr + idx + 1,
+            (parent->n - idx) * sizeof(void *));
+    parent->keys[idx]    = separator;
+    parent->ptr[idx + 1] = right;
+    parent->n++;
+}
+
+static void *
+btree_lookup_or_insert32(wmem_tree_t *tree, guint32 key,
+        void*(*func)(void*), void* data, gboolean is_subtree, gboolean replace)
+{
+    wmem_btree_node_t *node, *new_root;
+    guint i;
+
+    if (!tree->btree_root) {
+        tree->btree_root = btree_new_node(tree->allocator, TRUE);
+    }
+
+    /* Nodes are split on the way down whenever they are full, so there is
+     * always room for whatever a split below pushes up. */
+    node = tree->btree_root;
+    if (node->n == WMEM_BTREE_MAX_KEYS) {
+        new_root = btree_new_node(tree->allocator, FALSE);
+        new_root->ptr[0] = node;
+        btree_split_child(tree->allocator, new_root, 0);
+        tree->btree_root = new_root;
+        node = new_root;
+    }
+
+    while (!node->is_leaf) {
+        i = btree_upper_bound(node, key);
+        if (((wmem_btree_node_t *)node->ptr[i])->n == WMEM_BTREE_MAX_KEYS) {
+            btree_split_child(tree->allocator, node, i);
+            if (key >= node->keys[i]) {
+                i++;
+            }
+        }
+        node = (wmem_btree_node_t *)node->ptr[i];
+    }
+
+    i = btree_upper_bound(node, key);
+    if (i > 0 && node->keys[i - 1] == key) {
+        /* this key already exists, so just return the data pointer */
+        if (replace) {
+            node->ptr[i - 1] = CREATE_DATA(func, data);
+        }
+        return node->ptr[i - 1];
+    }
+
+    memmove(node->keys + i + 1, node->keys + i, (node->n - i) * sizeof(guint32));
+    memmove(node->ptr + i + 1, node->ptr + i, (node->n - i) * sizeof(void *));
+    node->subtree_mask = (node->subtree_mask & ((1U << i) - 1)) |
+                         (guint32)((guint64)(node->subtree_mask >> i) << (i + 1));
+    if (is_subtree) {
+        node->subtree_mask |= 1U << i;
+    }
+    node->keys[i] = key;
+    node->ptr[i]  = CREATE_DATA(func, data);
+    node->n++;
+
+    return node->ptr[i];
+}
+
+/* Returns the leaf that key would be stored in, and in *idx the number of
+ * keys in that leaf that are <= key. */
+static inline wmem_btree_node_t *
+btree_find_leaf(wmem_tree_t *tree, guint32 key, guint *idx)
+{
+    wmem_btree_node_t *node = tree->btree_root;
+
+    if (!node) {
+        return NULL;
+    }
+
+    while (!node->is_leaf) {
+        node = (wmem_btree_node_t *)node->ptr[btree_upper_bound(node, key)];
+    }
+    *idx = btree_upper_bound(node, key);
+
+    return node;
+}
+
+static void *
+btree_lookup32(wmem_tree_t *tree, guint32 key)
+{
+    wmem_btree_node_t *node;
+    guint i = 0;
+
+    node = btree_find_leaf(tree, key, &i);
+    if (node && i > 0 && node->keys[i - 1] == key) {
+        return node->ptr[i - 1];
+    }
+
+    return NULL;
+}
+
+static void *
+btree_lookup32_le(wmem_tree_t *tree, guint32 key)
+{
+    wmem_btree_node_t *node;
+    guint i = 0;
+
+    /* Every leaf except the leftmost one holds the separator that led to
+     * it, which is <= key, so if there is no smaller key in this leaf there
+     * is none in the tree. */
+    node = btree_find_leaf(tree, key, &i);
+    if (node && i > 0) {
+        return node->ptr[i - 1];
+    }
+
+    return NULL;
+}
+
 static void *
 lookup_or_insert32(wmem_tree_t *tree, guint32 key,
         void*(*func)(void*), void* data, gboolean is_subtree, gboolean replace)
@@ -312,6 +545,11 @@ lookup_or_insert32(wmem_tree_t *tree, guint32 key,
     wmem_tree_node_t *node     = tree->root;
     wmem_tree_node_t *new_node = NULL;
 
+    if (tree->is_btree) {
+        return btree_lookup_or_insert32(tree, key, func, data, is_subtree,
+                replace);
+    }
+
     /* is this the first node ?*/
     if (!node) {
         new_node = create_node(tree->allocator, NULL, key,
@@ -374,6 +612,10 @@ wmem_tree_lookup32(wmem_tree_t *tree, guint32 key)
 {
     wmem_tree_node_t *node = tree->root;
 
+    if (tree->is_btree) {
+        return btree_lookup32(tree, key);
+    }
+
     while (node) {
         if (key == node->key32) {
             return node->data;
@@ -394,6 +636,10 @@ wmem_tree_lookup32_le(wmem_tree_t *tree, guint32 key)
 {
     wmem_tree_node_t *node = tree->root;
 
+    if (tree->is_btree) {
+        return btree_lookup32_le(tree, key);
+    }
+
     while (node) {
         if (key == node->key32) {
             return node->data;
@@ -545,7 +791,12 @@ wmem_tree_lookup_string(wmem_tree_t* tree, const gchar* k, guint32 flags)
 static void *
 create_sub_tree(void* d)
 {
-    return wmem_tree_new(((wmem_tree_t *)d)->allocator);
+    wmem_tree_t *parent = (wmem_tree_t *)d;
+
+    if (parent->is_btree) {
+        return wmem_tree_new_btree(parent->allocator);
+    }
+    return wmem_tree_new(parent->allocator);
 }
 
 void
@@ -656,10 +907,46 @@ wmem_tree_foreach_nodes(wmem_tree_node_t* node, wmem_foreach_func callback,
     return FALSE;
 }
 
+static gboolean
+wmem_btree_foreach(wmem_tree_t* tree, wmem_foreach_func callback,
+        void *user_data)
+{
+    wmem_btree_node_t *node = tree->btree_root;
+    guint i;
+
+    if (!node) {
+        return FALSE;
+    }
+
+    /* walk down to the leftmost leaf, then along the leaf chain */
+    while (!node->is_leaf) {
+        node = (wmem_btree_node_t *)node->ptr[0];
+    }
+
+    for (; node; node = node->next) {
+        for (i = 0; i < node->n; i++) {
+            if (node->subtree_mask & (1U << i)) {
+                if (wmem_tree_foreach((wmem_tree_t *)node->ptr[i],
+                            callback, user_data)) {
+                    return TRUE;
+                }
+            }
+            else if (callback(node->ptr[i], user_data)) {
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
 gboolean
 wmem_tree_foreach(wmem_tree_t* tree, wmem_foreach_func callback,
         void *user_data)
 {
+    if (tree->is_btree)
+        return wmem_btree_foreach(tree, callback, user_data);
+
     if(!tree->root)
         return FALSE;
 
@@ -695,6 +982,32 @@ wmem_tree_print_nodes(const char *prefix, wmem_tree_node_t *node, guint32 level)
         wmem_print_subtree((wmem_tree_t *)node->data, level+1);
 }
 
+static void
+wmem_btree_print_nodes(wmem_btree_node_t *node, guint32 level)
+{
+    guint32 i, j;
+
+    for (i=0; i<level; i++) {
+        printf("    ");
+    }
+
+    printf("%sNODE:%p keys:%u", node->is_leaf?"LEAF-":"INNER-", (void *)node,
+            node->n);
+    for (j=0; j<node->n; j++) {
+        printf(" %u", node->keys[j]);
+    }
+    printf("\n");
+
+    for (j=0; j<node->n + (node->is_leaf ? 0 : 1); j++) {
+        if (!node->is_leaf) {
+            wmem_btree_print_nodes((wmem_btree_node_t *)node->ptr[j], level+1);
+        }
+        else if (node->subtree_mask & (1U << j)) {
+            wmem_print_subtree((wmem_tree_t *)node->ptr[j], level+1);
+        }
+    }
+}
+
 static void
 wmem_print_subtree(wmem_tree_t *tree, guint32 level)
 {
@@ -707,6 +1020,15 @@ wmem_print_subtree(wmem_tree_t *tree, guint32 level)
         printf("    ");
     }
 
+    if (tree->is_btree) {
+        printf("WMEM btree:%p root:%p\n", (void *)tree,
+                (void *)tree->btree_root);
+        if (tree->btree_root) {
+            wmem_btree_print_nodes(tree->btree_root, level);
+        }
+        return;
+    }
+
     printf("WMEM tree:%p root:%p\n", (void *)tree, (void *)tree->root);
     if (tree->root) {
         wmem_tree_print_nodes("Root-", tree->root, level);
@@ -72,6 +72,27 @@ wmem_tree_t *
 wmem_tree_new_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave)
 G_GNUC_MALLOC;
 
+/** Creates a tree like wmem_tree_new(), but stored as a B+tree instead of a
+ * red/black tree. Each node holds up to 32 keys, so lookups touch only a few
+ * nodes even with millions of keys, and each key costs far less memory than a
+ * red/black node. The functions that operate on trees work the same way for
+ * both kinds, and subtrees created by wmem_tree_insert32_array() are of the
+ * same kind as the tree they were inserted into. This is a good choice for
+ * large trees keyed by frame or sequence numbers, but is wasteful for trees
+ * that only ever hold a handful of keys.
+ */
+WS_DLL_PUBLIC
+wmem_tree_t *
+wmem_tree_new_btree(wmem_allocator_t *allocator)
+G_GNUC_MALLOC;
+
+/** Creates a tree like wmem_tree_new_autoreset(), but stored as a B+tree (see
+ * wmem_tree_new_btree()). */
+WS_DLL_PUBLIC
+wmem_tree_t *
+wmem_tree_new_autoreset_btree(wmem_allocator_t *master, wmem_allocator_t *slave)
+G_GNUC_MALLOC;
+
 /** Returns true if the tree is empty (has no nodes). */
 WS_DLL_PUBLIC
 gboolean
@@ -235,6 +235,13 @@ struct _wslua_tap {
     int draw_ref;
     int reset_ref;
     gboolean all_fields;
+    /* batched delivery, see Listener:set_batch() */
+    int batch_ref;
+    guint batch_size;
+    guint batch_count;
+    int batch_packets_ref;
+    int batch_fields_ref;
+    GPtrArray* batch_fields;
 };
 
 /* a "File" object can be different things under the hood. It can either
@@ -707,6 +714,7 @@ extern TreeItem* push_TreeItem(lua_State* L, TreeItem ti);
 extern void clear_outstanding_TreeItem(void);
 
 extern void clear_outstanding_FieldInfo(void);
+extern int push_FieldInfo_value(lua_State* L, field_info* ws_fi);
 
 extern void wslua_print_stack(char* s, lua_State* L);
 
@@ -47,7 +47,30 @@ static GPtrArray* outstanding_FieldInfo = NULL;
 
 #define PUSH_FIELDINFO(L,fi) {g_ptr_array_add(outstanding_FieldInfo,fi);pushFieldInfo(L,fi);}
 
-CLEAR_OUTSTANDING(FieldInfo,expired,TRUE)
+/* Field extractors make a FieldInfo for every value they return, so
+   they're allocated from GSlice rather than malloc. */
+static FieldInfo new_FieldInfo(field_info* ws_fi) {
+    FieldInfo fi = g_slice_new(struct _wslua_field_info);
+    fi->ws_fi = ws_fi;
+    fi->expired = FALSE;
+    return fi;
+}
+
+static void free_FieldInfo(FieldInfo fi) {
+    if (!fi->expired)
+        fi->expired = TRUE;
+    else
+        /* do NOT free fi->ws_fi */
+        g_slice_free(struct _wslua_field_info, fi);
+}
+
+void clear_outstanding_FieldInfo(void) {
+    while (outstanding_FieldInfo->len) {
+        FieldInfo fi = (FieldInfo)g_ptr_array_remove_index_fast(outstanding_FieldInfo,0);
+        if (fi)
+            free_FieldInfo(fi);
+    }
+}
 
 /* WSLUA_ATTRIBUTE FieldInfo_len RO The length of this field. */
 WSLUA_METAMETHOD FieldInfo__len(lua_State* L) {
@@ -71,101 +94,88 @@ WSLUA_METAMETHOD FieldInfo__unm(lua_State* L) {
     return 1;
 }
 
-/* WSLUA_ATTRIBUTE FieldInfo_value RO The value of this field. */
-WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
-    /*
-       Obtain the Value of the field.
-
-       Previous to 1.11.4, this function retrieved the value for most field types,
-       but for `ftypes.UINT_BYTES` it retrieved the `ByteArray` of the field's entire `TvbRange`.
-       In other words, it returned a `ByteArray` that included the leading length byte(s),
-       instead of just the *value* bytes. That was a bug, and has been changed in 1.11.4.
-       Furthermore, it retrieved an `ftypes.GUID` as a `ByteArray`, which is also incorrect.
-
-       If you wish to still get a `ByteArray` of the `TvbRange`, use `FieldInfo:get_range()`
-       to get the `TvbRange`, and then use `Tvb:bytes()` to convert it to a `ByteArray`.
-       */
-    FieldInfo fi = checkFieldInfo(L,1);
-
-    switch(fi->ws_fi->hfinfo->type) {
+/* Push the value of a field, as FieldInfo__call() gives it; returns the
+   number of values pushed, which is 0 for a field with no value */
+int push_FieldInfo_value(lua_State* L, field_info* ws_fi) {
+    switch(ws_fi->hfinfo->type) {
         case FT_BOOLEAN:
-                lua_pushboolean(L,(int)fvalue_get_uinteger(&(fi->ws_fi->value)));
+                lua_pushboolean(L,(int)fvalue_get_uinteger(&(ws_fi->value)));
                 return 1;
         case FT_UINT8:
         case FT_UINT16:
         case FT_UINT24:
         case FT_UINT32:
         case FT_FRAMENUM:
-                lua_pushnumber(L,(lua_Number)(fvalue_get_uinteger(&(fi->ws_fi->value))));
+                lua_pushnumber(L,(lua_Number)(fvalue_get_uinteger(&(ws_fi->value))));
                 return 1;
         case FT_INT8:
         case FT_INT16:
         case FT_INT24:
         case FT_INT32:
-                lua_pushnumber(L,(lua_Number)(fvalue_get_sinteger(&(fi->ws_fi->value))));
+                lua_pushnumber(L,(lua_Number)(fvalue_get_sinteger(&(ws_fi->value))));
                 return 1;
         case FT_FLOAT:
         case FT_DOUBLE:
-                lua_pushnumber(L,(lua_Number)(fvalue_get_floating(&(fi->ws_fi->value))));
+                lua_pushnumber(L,(lua_Number)(fvalue_get_floating(&(ws_fi->value))));
                 return 1;
         case FT_INT64: {
-                pushInt64(L,(Int64)(fvalue_get_integer64(&(fi->ws_fi->value))));
+                pushInt64(L,(Int64)(fvalue_get_integer64(&(ws_fi->value))));
                 return 1;
             }
         case FT_UINT64: {
-                pushUInt64(L,fvalue_get_integer64(&(fi->ws_fi->value)));
+                pushUInt64(L,fvalue_get_integer64(&(ws_fi->value)));
                 return 1;
             }
         case FT_ETHER: {
                 Address eth = (Address)g_malloc(sizeof(address));
                 eth->type = AT_ETHER;
-                eth->len = fi->ws_fi->length;
-                eth->data = tvb_memdup(NULL,fi->ws_fi->ds_tvb,fi->ws_fi->start,fi->ws_fi->length);
+                eth->len = ws_fi->length;
+                eth->data = tvb_memdup(NULL,ws_fi->ds_tvb,ws_fi->start,ws_fi->length);
                 pushAddress(L,eth);
                 return 1;
             }
         case FT_IPv4:{
                 Address ipv4 = (Address)g_malloc(sizeof(address));
                 ipv4->type = AT_IPv4;
-                ipv4->len = fi->ws_fi->length;
-                ipv4->data = tvb_memdup(NULL,fi->ws_fi->ds_tvb,fi->ws_fi->start,fi->ws_fi->length);
+                ipv4->len = ws_fi->length;
+                ipv4->data = tvb_memdup(NULL,ws_fi->ds_tvb,ws_fi->start,ws_fi->length);
                 pushAddress(L,ipv4);
                 return 1;
             }
         case FT_IPv6: {
                 Address ipv6 = (Address)g_malloc(sizeof(address));
                 ipv6->type = AT_IPv6;
-                ipv6->len = fi->ws_fi->length;
-                ipv6->data = tvb_memdup(NULL,fi->ws_fi->ds_tvb,fi->ws_fi->start,fi->ws_fi->length);
+                ipv6->len = ws_fi->length;
+                ipv6->data = tvb_memdup(NULL,ws_fi->ds_tvb,ws_fi->start,ws_fi->length);
                 pushAddress(L,ipv6);
                 return 1;
             }
         case FT_FCWWN: {
                 Address fcwwn = (Address)g_malloc(sizeof(address));
                 fcwwn->type = AT_FCWWN;
-                fcwwn->len = fi->ws_fi->length;
-                fcwwn->data = tvb_memdup(NULL,fi->ws_fi->ds_tvb,fi->ws_fi->start,fi->ws_fi->length);
+                fcwwn->len = ws_fi->length;
+                fcwwn->data = tvb_memdup(NULL,ws_fi->ds_tvb,ws_fi->start,ws_fi->length);
                 pushAddress(L,fcwwn);
                 return 1;
             }
         case FT_IPXNET:{
                 Address ipx = (Address)g_malloc(sizeof(address));
                 ipx->type = AT_IPX;
-                ipx->len = fi->ws_fi->length;
-                ipx->data = tvb_memdup(NULL,fi->ws_fi->ds_tvb,fi->ws_fi->start,fi->ws_fi->length);
+                ipx->len = ws_fi->length;
+                ipx->data = tvb_memdup(NULL,ws_fi->ds_tvb,ws_fi->start,ws_fi->length);
                 pushAddress(L,ipx);
                 return 1;
             }
         case FT_ABSOLUTE_TIME:
         case FT_RELATIVE_TIME: {
                 NSTime nstime = (NSTime)g_malloc(sizeof(nstime_t));
-                *nstime = *(NSTime)fvalue_get(&(fi->ws_fi->value));
+                *nstime = *(NSTime)fvalue_get(&(ws_fi->value));
                 pushNSTime(L,nstime);
                 return 1;
             }
         case FT_STRING:
         case FT_STRINGZ: {
-                gchar* repr = fvalue_to_string_repr(&fi->ws_fi->value,FTREPR_DISPLAY,BASE_NONE,NULL);
+                gchar* repr = fvalue_to_string_repr(&ws_fi->value,FTREPR_DISPLAY,BASE_NONE,NULL);
                 if (repr)
                     lua_pushstring(L,repr);
                 else
@@ -174,10 +184,10 @@ WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
                 return 1;
             }
         case FT_NONE:
-                if (fi->ws_fi->length > 0 && fi->ws_fi->rep) {
+                if (ws_fi->length > 0 && ws_fi->rep) {
                     /* it has a length, but calling fvalue_get() on an FT_NONE asserts,
                        so get the label instead (it's a FT_NONE, so a label is what it basically is) */
-                    lua_pushstring(L, fi->ws_fi->rep->representation);
+                    lua_pushstring(L, ws_fi->rep->representation);
                     return 1;
                 }
                 return 0;
@@ -188,15 +198,15 @@ WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
         case FT_OID:
             {
                 ByteArray ba = g_byte_array_new();
-                g_byte_array_append(ba, (const guint8 *) fvalue_get(&fi->ws_fi->value),
-                                    fvalue_length(&fi->ws_fi->value));
+                g_byte_array_append(ba, (const guint8 *) fvalue_get(&ws_fi->value),
+                                    fvalue_length(&ws_fi->value));
                 pushByteArray(L,ba);
                 return 1;
             }
         case FT_PROTOCOL:
             {
                 ByteArray ba = g_byte_array_new();
-                tvbuff_t* tvb = (tvbuff_t *) fvalue_get(&fi->ws_fi->value);
+                tvbuff_t* tvb = (tvbuff_t *) fvalue_get(&ws_fi->value);
                 g_byte_array_append(ba, (const guint8 *)tvb_memdup(wmem_packet_scope(), tvb, 0,
                                             tvb_captured_length(tvb)), tvb_captured_length(tvb));
                 pushByteArray(L,ba);
@@ -210,6 +220,25 @@ WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
     }
 }
 
+/* WSLUA_ATTRIBUTE FieldInfo_value RO The value of this field. */
+WSLUA_METAMETHOD FieldInfo__call(lua_State* L) {
+    /*
+       Obtain the Value of the field.
+
+       Previous to 1.11.4, this function retrieved the value for most field types,
+       but for `ftypes.UINT_BYTES` it retrieved the `ByteArray` of the field's entire `TvbRange`.
+       In other words, it returned a `ByteArray` that included the leading length byte(s),
+       instead of just the *value* bytes. That was a bug, and has been changed in 1.11.4.
+       Furthermore, it retrieved an `ftypes.GUID` as a `ByteArray`, which is also incorrect.
+
+       If you wish to still get a `ByteArray` of the `TvbRange`, use `FieldInfo:get_range()`
+       to get the `TvbRange`, and then use `Tvb:bytes()` to convert it to a `ByteArray`.
+       */
+    FieldInfo fi = checkFieldInfo(L,1);
+
+    return push_FieldInfo_value(L,fi->ws_fi);
+}
+
 /* WSLUA_ATTRIBUTE FieldInfo_label RO The string representing this field */
 WSLUA_METAMETHOD FieldInfo__tostring(lua_State* L) {
     /* The string representation of the field. */
@@ -358,11 +387,7 @@ static int FieldInfo__gc(lua_State* L _U_) {
 
     if (!fi) return 0;
 
-    if (!fi->expired)
-        fi->expired = TRUE;
-    else
-        /* do NOT free fi->ws_fi */
-        g_free(fi);
+    free_FieldInfo(fi);
 
     return 0;
 }
@@ -422,9 +447,7 @@ WSLUA_FUNCTION wslua_all_field_infos(lua_State* L) {
 
     if (found) {
         for (i=0; i<found->len; i++) {
-            FieldInfo fi = (FieldInfo)g_malloc(sizeof(struct _wslua_field_info));
-            fi->ws_fi = (field_info *)g_ptr_array_index(found,i);
-            fi->expired = FALSE;
+            FieldInfo fi = new_FieldInfo((field_info *)g_ptr_array_index(found,i));
 
             PUSH_FIELDINFO(L,fi);
             items_found++;
@@ -604,9 +627,7 @@ WSLUA_METAMETHOD Field__call (lua_State* L) {
         guint i;
         if (found) {
             for (i=0; i<found->len; i++) {
-                FieldInfo fi = (FieldInfo)g_malloc(sizeof(struct _wslua_field_info));
-                fi->ws_fi = (field_info *)g_ptr_array_index(found,i);
-                fi->expired = FALSE;
+                FieldInfo fi = new_FieldInfo((field_info *)g_ptr_array_index(found,i));
 
                 PUSH_FIELDINFO(L,fi);
                 items_found++;
@@ -618,6 +639,45 @@ WSLUA_METAMETHOD Field__call (lua_State* L) {
     WSLUA_RETURN(items_found); /* All the values of this field */
 }
 
+WSLUA_METHOD Field_values(lua_State* L) {
+    /* Obtain the values of all the instances of this field in the current packet,
+       in a table, as if each `FieldInfo` returned by calling the `Field` were
+       called in turn, but without creating the `FieldInfo` objects.
+       Instances that have no value (`ftypes.NONE` fields without a label)
+       are left out.
+
+       @since 1.99.2
+     */
+    Field f = checkField(L,1);
+    header_field_info* in = *f;
+    int n = 0;
+
+    if (! in) {
+        luaL_error(L,"invalid field");
+        return 0;
+    }
+
+    if (! lua_pinfo ) {
+        WSLUA_ERROR(Field_values,"Fields cannot be used outside dissectors or taps");
+        return 0;
+    }
+
+    lua_newtable(L);
+    while (in) {
+        GPtrArray* found = proto_get_finfo_ptr_array(lua_tree->tree, in->id);
+        guint i;
+        if (found) {
+            for (i=0; i<found->len; i++) {
+                if (push_FieldInfo_value(L,(field_info *)g_ptr_array_index(found,i)) > 0)
+                    lua_rawseti(L,-2,++n);
+            }
+        }
+        in = (in->same_name_prev_id != -1) ? proto_registrar_get_nth(in->same_name_prev_id) : NULL;
+    }
+
+    WSLUA_RETURN(1); /* A table of the values of this field */
+}
+
 WSLUA_METAMETHOD Field__tostring(lua_State* L) {
     /* Obtain a string with the field name. */
     Field f = checkField(L,1);
@@ -639,6 +699,7 @@ static int Field__gc(lua_State* L _U_) {
 WSLUA_METHODS Field_methods[] = {
     WSLUA_CLASS_FNREG(Field,new),
     WSLUA_CLASS_FNREG(Field,list),
+    WSLUA_CLASS_FNREG(Field,values),
     { NULL, NULL }
 };
 
@@ -81,10 +81,179 @@ static int tap_packet_cb_error_handler(lua_State* L) {
 }
 
 
+static void lua_tap_batch_discard(Listener tap) {
+    if (tap->batch_packets_ref != LUA_NOREF) {
+        luaL_unref(tap->L, LUA_REGISTRYINDEX, tap->batch_packets_ref);
+        tap->batch_packets_ref = LUA_NOREF;
+    }
+    if (tap->batch_fields_ref != LUA_NOREF) {
+        luaL_unref(tap->L, LUA_REGISTRYINDEX, tap->batch_fields_ref);
+        tap->batch_fields_ref = LUA_NOREF;
+    }
+    tap->batch_count = 0;
+}
+
+static void lua_tap_batch_push_address(lua_State* L, const address* addr, const gchar* name) {
+    gchar* str = address_to_str(NULL, addr);
+    lua_pushstring(L,str);
+    lua_setfield(L,-2,name);
+    wmem_free(NULL, str);
+}
+
+/* Copies what the batch callback gets of the current packet into the pending
+   tables; called through lua_pcall() as the tap extractor and field values
+   may raise errors.  The Listener and the tap data are the arguments. */
+static int lua_tap_batch_add(lua_State* L) {
+    Listener tap = (Listener)lua_touserdata(L,1);
+    const void* data = lua_touserdata(L,2);
+    guint n = tap->batch_count + 1;
+    guint i;
+
+    if (tap->batch_packets_ref == LUA_NOREF) {
+        lua_createtable(L,tap->batch_size,0);
+        tap->batch_packets_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+        lua_createtable(L,tap->batch_fields->len,0);
+        for (i = 0; i < tap->batch_fields->len; i++) {
+            lua_createtable(L,tap->batch_size,0);
+            lua_rawseti(L,-2,i+1);
+        }
+        tap->batch_fields_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+
+    lua_rawgeti(L, LUA_REGISTRYINDEX, tap->batch_packets_ref);
+    lua_createtable(L,0,10);
+    lua_pushnumber(L,(lua_Number)lua_pinfo->fd->num);
+    lua_setfield(L,-2,"number");
+    lua_pushnumber(L,(lua_Number)nstime_to_sec(&lua_pinfo->fd->abs_ts));
+    lua_setfield(L,-2,"abs_ts");
+    lua_pushnumber(L,(lua_Number)nstime_to_sec(&lua_pinfo->rel_ts));
+    lua_setfield(L,-2,"rel_ts");
+    lua_pushnumber(L,(lua_Number)lua_pinfo->fd->pkt_len);
+    lua_setfield(L,-2,"len");
+    lua_pushnumber(L,(lua_Number)lua_pinfo->fd->cap_len);
+    lua_setfield(L,-2,"caplen");
+    lua_tap_batch_push_address(L,&lua_pinfo->src,"src");
+    lua_tap_batch_push_address(L,&lua_pinfo->dst,"dst");
+    lua_pushnumber(L,(lua_Number)lua_pinfo->srcport);
+    lua_setfield(L,-2,"src_port");
+    lua_pushnumber(L,(lua_Number)lua_pinfo->destport);
+    lua_setfield(L,-2,"dst_port");
+    if (tap->extractor) {
+        tap->extractor(L,data);
+        lua_setfield(L,-2,"tapinfo");
+    }
+    lua_rawseti(L,-2,n);
+    lua_pop(L,1);
+
+    /* the first value of each of the fields, if the packet has one */
+    lua_rawgeti(L, LUA_REGISTRYINDEX, tap->batch_fields_ref);
+    for (i = 0; i < tap->batch_fields->len; i++) {
+        header_field_info* in = *((Field)g_ptr_array_index(tap->batch_fields,i));
+        gboolean pushed = FALSE;
+
+        lua_rawgeti(L,-1,i+1);
+        while (in && !pushed) {
+            GPtrArray* found = proto_get_finfo_ptr_array(lua_tree->tree, in->id);
+            guint j;
+            if (found) {
+                for (j = 0; j < found->len && !pushed; j++) {
+                    if (push_FieldInfo_value(L,(field_info *)g_ptr_array_index(found,j)) > 0) {
+                        lua_rawseti(L,-2,n);
+                        pushed = TRUE;
+                    }
+                }
+            }
+            in = (in->same_name_prev_id != -1) ? proto_registrar_get_nth(in->same_name_prev_id) : NULL;
+        }
+        lua_pop(L,1);
+    }
+    lua_pop(L,1);
+
+    tap->batch_count = n;
+    return 0;
+}
+
+static void lua_tap_batch_flush(Listener tap) {
+    lua_State* L = tap->L;
+
+    if (tap->batch_count == 0 || tap->batch_ref == LUA_NOREF) {
+        lua_tap_batch_discard(tap);
+        return;
+    }
+
+    lua_settop(L,0);
+
+    lua_pushcfunction(L,tap_packet_cb_error_handler);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, tap->batch_ref);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, tap->batch_packets_ref);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, tap->batch_fields_ref);
+    lua_pushnumber(L,(lua_Number)tap->batch_count);
+
+    /* the callback may keep the tables, so start new ones for the next batch */
+    lua_tap_batch_discard(tap);
+
+    switch ( lua_pcall(L,3,0,1) ) {
+        case 0:
+        case LUA_ERRRUN:
+            break;
+        case LUA_ERRMEM:
+            g_warning("Memory alloc error while calling listener tap callback batch");
+            break;
+        default:
+            g_assert_not_reached();
+            break;
+    }
+
+    lua_settop(L,0);
+}
+
+static int lua_tap_batch_packet(Listener tap, packet_info *pinfo, epan_dissect_t *edt, const void *data) {
+    struct _wslua_treeitem tree_item;
+
+    lua_settop(tap->L,0);
+
+    lua_pushcfunction(tap->L,tap_packet_cb_error_handler);
+    lua_pushcfunction(tap->L,lua_tap_batch_add);
+    lua_pushlightuserdata(tap->L,tap);
+    lua_pushlightuserdata(tap->L,(void*)data);
+
+    lua_pinfo = pinfo;
+    tree_item.tree = edt->tree;
+    tree_item.item = NULL;
+    tree_item.expired = FALSE;
+    lua_tree = &tree_item;
+
+    switch ( lua_pcall(tap->L,2,0,1) ) {
+        case 0:
+        case LUA_ERRRUN:
+            break;
+        case LUA_ERRMEM:
+            g_warning("Memory alloc error while batching listener tap data");
+            break;
+        default:
+            g_assert_not_reached();
+            break;
+    }
+
+    clear_outstanding_FieldInfo();
+
+    if (tap->batch_count >= tap->batch_size)
+        lua_tap_batch_flush(tap);
+
+    lua_pinfo = NULL;
+    lua_tree = NULL;
+
+    /* have draw() called, to deliver what's left of the batch */
+    return 1;
+}
+
 static int lua_tap_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt, const void *data) {
     Listener tap = (Listener)tapdata;
     int retval = 0;
 
+    if (tap->batch_ref != LUA_NOREF && tap->batch_size > 0)
+        return lua_tap_batch_packet(tap, pinfo, edt, data);
+
     if (tap->packet_ref == LUA_NOREF) return 0;
 
     lua_settop(tap->L,0);
@@ -141,6 +310,9 @@ static int tap_reset_cb_error_handler(lua_State* L) {
 static void lua_tap_reset(void *tapdata) {
     Listener tap = (Listener)tapdata;
 
+    /* the packets are about to be tapped again */
+    lua_tap_batch_discard(tap);
+
     if (tap->reset_ref == LUA_NOREF) return;
 
     lua_pushcfunction(tap->L,tap_reset_cb_error_handler);
@@ -164,6 +336,9 @@ static void lua_tap_reset(void *tapdata) {
 static void lua_tap_draw(void *tapdata) {
     Listener tap = (Listener)tapdata;
     const gchar* error;
+
+    lua_tap_batch_flush(tap);
+
     if (tap->draw_ref == LUA_NOREF) return;
 
     lua_pushcfunction(tap->L,tap_reset_cb_error_handler);
@@ -210,6 +385,12 @@ WSLUA_CONSTRUCTOR Listener_new(lua_State* L) {
     tap->draw_ref = LUA_NOREF;
     tap->reset_ref = LUA_NOREF;
     tap->all_fields = all_fields;
+    tap->batch_ref = LUA_NOREF;
+    tap->batch_size = 0;
+    tap->batch_count = 0;
+    tap->batch_packets_ref = LUA_NOREF;
+    tap->batch_fields_ref = LUA_NOREF;
+    tap->batch_fields = g_ptr_array_new();
 
     /*
      * XXX - do all Lua taps require the protocol tree?  If not, it might
@@ -221,6 +402,7 @@ WSLUA_CONSTRUCTOR Listener_new(lua_State* L) {
     error = register_tap_listener(tap_type, tap, tap->filter, TL_REQUIRES_PROTO_TREE, lua_tap_reset, lua_tap_packet, lua_tap_draw);
 
     if (error) {
+        g_ptr_array_free(tap->batch_fields,TRUE);
         g_free(tap->filter);
         g_free(tap->name);
         g_free(tap);
@@ -281,6 +463,59 @@ WSLUA_METHOD Listener_remove(lua_State* L) {
     }
 
     remove_tap_listener(tap);
+    lua_tap_batch_discard(tap);
+
+    return 0;
+}
+
+WSLUA_METHOD Listener_set_batch(lua_State* L) {
+    /* Has the `Listener` collect matching packets and give them to its `batch` function
+       a number at a time, instead of calling its `packet` function for each one.  What's
+       left of a batch is given to `batch` before `draw` is called.
+
+       @since 1.99.2
+     */
+#define WSLUA_ARG_Listener_set_batch_SIZE 2 /* The number of packets in a batch. */
+#define WSLUA_OPTARG_Listener_set_batch_FIELDS 3 /* An array table of `Field` extractors whose
+                                                    values are to be collected with the packets. */
+    Listener tap = checkListener(L,1);
+    lua_Integer size = luaL_checkinteger(L,WSLUA_ARG_Listener_set_batch_SIZE);
+    int i;
+
+    if (size < 1) {
+        WSLUA_ARG_ERROR(Listener_set_batch,SIZE,"must be at least 1");
+        return 0;
+    }
+
+    if (!lua_isnoneornil(L,WSLUA_OPTARG_Listener_set_batch_FIELDS)) {
+        luaL_checktype(L,WSLUA_OPTARG_Listener_set_batch_FIELDS,LUA_TTABLE);
+        for (i = 1; ; i++) {
+            lua_rawgeti(L,WSLUA_OPTARG_Listener_set_batch_FIELDS,i);
+            if (lua_isnil(L,-1)) {
+                lua_pop(L,1);
+                break;
+            }
+            checkField(L,-1);
+            lua_pop(L,1);
+        }
+    }
+
+    /* anything collected so far was for the old settings */
+    lua_tap_batch_discard(tap);
+    tap->batch_size = (guint)size;
+    g_ptr_array_set_size(tap->batch_fields,0);
+
+    if (!lua_isnoneornil(L,WSLUA_OPTARG_Listener_set_batch_FIELDS)) {
+        for (i = 1; ; i++) {
+            lua_rawgeti(L,WSLUA_OPTARG_Listener_set_batch_FIELDS,i);
+            if (lua_isnil(L,-1)) {
+                lua_pop(L,1);
+                break;
+            }
+            g_ptr_array_add(tap->batch_fields,checkField(L,-1));
+            lua_pop(L,1);
+        }
+    }
 
     return 0;
 }
@@ -310,6 +545,24 @@ WSLUA_METAMETHOD Listener__tostring(lua_State* L) {
 WSLUA_ATTRIBUTE_FUNC_SETTER(Listener,packet);
 
 
+/* WSLUA_ATTRIBUTE Listener_batch WO A function that will be called with a batch of the packets
+    that matched the `Listener` filter, once `Listener:set_batch()` has been called.
+
+    When later called by Wireshark, the `batch` function will be given:
+      1. An array table of the packets, each one a table with the fields `number`, `abs_ts`,
+         `rel_ts`, `len`, `caplen`, `src`, `dst`, `src_port`, `dst_port` and, if the
+         `Listener`'s type has one, `tapinfo`.
+      2. An array table with one array table per `Field` given to `Listener:set_batch()`,
+         holding the field's first value in each packet at the packet's index, or nil.
+      3. The number of packets.
+
+    @code function tap.batch(packets,fields,count) ... end @endcode
+
+    @since 1.99.2
+*/
+WSLUA_ATTRIBUTE_FUNC_SETTER(Listener,batch);
+
+
 /* WSLUA_ATTRIBUTE Listener_draw WO A function that will be called once every few seconds to redraw the GUI objects;
             in Tshark this funtion is called only at the very end of the capture file.
 
@@ -339,6 +592,7 @@ static int Listener__gc(lua_State* L _U_) {
  */
 WSLUA_ATTRIBUTES Listener_attributes[] = {
     WSLUA_ATTRIBUTE_WOREG(Listener,packet),
+    WSLUA_ATTRIBUTE_WOREG(Listener,batch),
     WSLUA_ATTRIBUTE_WOREG(Listener,draw),
     WSLUA_ATTRIBUTE_WOREG(Listener,reset),
     { NULL, NULL, NULL }
@@ -347,6 +601,7 @@ WSLUA_ATTRIBUTES Listener_attributes[] = {
 WSLUA_METHODS Listener_methods[] = {
     WSLUA_CLASS_FNREG(Listener,new),
     WSLUA_CLASS_FNREG(Listener,remove),
+    WSLUA_CLASS_FNREG(Listener,set_batch),
     WSLUA_CLASS_FNREG(Listener,list),
     { NULL, NULL }
 };
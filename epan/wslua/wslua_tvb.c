@@ -408,6 +408,14 @@ static GPtrArray* outstanding_TvbRange = NULL;
 #define PUSH_TVB(L,t) {g_ptr_array_add(outstanding_Tvb,t);pushTvb(L,t);}
 #define PUSH_TVBRANGE(L,t) {g_ptr_array_add(outstanding_TvbRange,t);pushTvbRange(L,t);}
 
+/* Every TvbRange made by push_TvbRange() has a Tvb of its own; scripts
+   make one for nearly every value they read, so the two are allocated
+   together, from GSlice rather than malloc. */
+typedef struct {
+    struct _wslua_tvbrange tvbr;
+    struct _wslua_tvb tvb;
+} tvbrange_block_t;
+
 static void free_Tvb(Tvb tvb) {
     if (!tvb) return;
 
@@ -433,8 +441,8 @@ static void free_TvbRange(TvbRange tvbr) {
     if (!tvbr->tvb->expired) {
         tvbr->tvb->expired = TRUE;
     } else {
-        free_Tvb(tvbr->tvb);
-        g_free(tvbr);
+        /* tvbr->tvb is part of the block, and never needs a tvb_free() */
+        g_slice_free(tvbrange_block_t, (tvbrange_block_t *)tvbr);
     }
 }
 
@@ -588,6 +596,7 @@ WSLUA_CLASS_DEFINE(TvbRange,FAIL_ON_NULL("TvbRange"),NOP);
  */
 
 gboolean push_TvbRange(lua_State* L, tvbuff_t* ws_tvb, int offset, int len) {
+    tvbrange_block_t* block;
     TvbRange tvbr;
 
     if (!ws_tvb) {
@@ -606,8 +615,9 @@ gboolean push_TvbRange(lua_State* L, tvbuff_t* ws_tvb, int offset, int len) {
         return FALSE;
     }
 
-    tvbr = (TvbRange)g_malloc(sizeof(struct _wslua_tvbrange));
-    tvbr->tvb = (Tvb)g_malloc(sizeof(struct _wslua_tvb));
+    block = g_slice_new(tvbrange_block_t);
+    tvbr = &block->tvbr;
+    tvbr->tvb = &block->tvb;
     tvbr->tvb->ws_tvb = ws_tvb;
     tvbr->tvb->expired = FALSE;
     tvbr->tvb->need_free = FALSE;
@@ -674,6 +684,114 @@ WSLUA_METHOD Tvb_raw(lua_State* L) {
     WSLUA_RETURN(1); /* A Lua string of the binary bytes in the `Tvb`. */
 }
 
+/* Check that a Tvb is usable and that len octets at offset are in it */
+static gboolean check_Tvb_span(lua_State* L, Tvb tvb, int offset, int len) {
+    if (!tvb) return FALSE;
+    if (tvb->expired) {
+        luaL_error(L,"expired tvb");
+        return FALSE;
+    }
+    if (offset < 0 || len < 0 || (guint)(len + offset) > tvb_captured_length(tvb->ws_tvb)) {
+        luaL_error(L,"Range is out of bounds");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+WSLUA_METHOD Tvb_uint(lua_State* L) {
+    /* Get a Big Endian (network order) unsigned integer from a `Tvb`, as
+       `tvb(offset,length):uint()` does, but without creating a `TvbRange`.
+       The length must be 1, 2, 3 or 4 octets.
+
+       @since 1.99.2
+     */
+#define WSLUA_ARG_Tvb_uint_OFFSET 2 /* The offset (in octets) of the integer. */
+#define WSLUA_ARG_Tvb_uint_LENGTH 3 /* The length (in octets) of the integer. */
+    Tvb tvb = checkTvb(L,1);
+    int offset = (int) luaL_checkinteger(L,WSLUA_ARG_Tvb_uint_OFFSET);
+    int len = (int) luaL_checkinteger(L,WSLUA_ARG_Tvb_uint_LENGTH);
+
+    if (!check_Tvb_span(L,tvb,offset,len)) return 0;
+
+    switch (len) {
+        case 1:
+            lua_pushnumber(L,tvb_get_guint8(tvb->ws_tvb,offset));
+            return 1;
+        case 2:
+            lua_pushnumber(L,tvb_get_ntohs(tvb->ws_tvb,offset));
+            return 1;
+        case 3:
+            lua_pushnumber(L,tvb_get_ntoh24(tvb->ws_tvb,offset));
+            return 1;
+        case 4:
+            lua_pushnumber(L,tvb_get_ntohl(tvb->ws_tvb,offset));
+            WSLUA_RETURN(1); /* The unsigned integer value. */
+        default:
+            luaL_error(L,"Tvb:uint() does not handle %d byte integers",len);
+            return 0;
+    }
+}
+
+WSLUA_METHOD Tvb_le_uint(lua_State* L) {
+    /* Get a Little Endian unsigned integer from a `Tvb`, as
+       `tvb(offset,length):le_uint()` does, but without creating a `TvbRange`.
+       The length must be 1, 2, 3 or 4 octets.
+
+       @since 1.99.2
+     */
+#define WSLUA_ARG_Tvb_le_uint_OFFSET 2 /* The offset (in octets) of the integer. */
+#define WSLUA_ARG_Tvb_le_uint_LENGTH 3 /* The length (in octets) of the integer. */
+    Tvb tvb = checkTvb(L,1);
+    int offset = (int) luaL_checkinteger(L,WSLUA_ARG_Tvb_le_uint_OFFSET);
+    int len = (int) luaL_checkinteger(L,WSLUA_ARG_Tvb_le_uint_LENGTH);
+
+    if (!check_Tvb_span(L,tvb,offset,len)) return 0;
+
+    switch (len) {
+        case 1:
+            lua_pushnumber(L,tvb_get_guint8(tvb->ws_tvb,offset));
+            return 1;
+        case 2:
+            lua_pushnumber(L,tvb_get_letohs(tvb->ws_tvb,offset));
+            return 1;
+        case 3:
+            lua_pushnumber(L,tvb_get_letoh24(tvb->ws_tvb,offset));
+            return 1;
+        case 4:
+            lua_pushnumber(L,tvb_get_letohl(tvb->ws_tvb,offset));
+            WSLUA_RETURN(1); /* The unsigned integer value. */
+        default:
+            luaL_error(L,"Tvb:le_uint() does not handle %d byte integers",len);
+            return 0;
+    }
+}
+
+WSLUA_METHOD Tvb_data_pointer(lua_State* L) {
+    /* Obtain a read-only pointer to the captured bytes of a `Tvb`, as a light userdata,
+       and their length, for use with LuaJIT's FFI; for example
+       `local p, len = tvb:data_pointer(); local bytes = ffi.cast("const uint8_t *", p)`.
+       The bytes are only valid during the current listener or dissector call, and
+       must not be modified or read past the length.
+
+       @since 1.99.2
+     */
+    Tvb tvb = checkTvb(L,1);
+    guint len;
+
+    if (!tvb) return 0;
+    if (tvb->expired) {
+        luaL_error(L,"expired tvb");
+        return 0;
+    }
+
+    len = tvb_captured_length(tvb->ws_tvb);
+    /* tvb_get_ptr() makes the data contiguous, if it isn't already */
+    lua_pushlightuserdata(L, (void *)(len ? tvb_get_ptr(tvb->ws_tvb, 0, len) : NULL));
+    lua_pushnumber(L,(lua_Number)len);
+
+    WSLUA_RETURN(2); /* The pointer and the number of bytes it points to. */
+}
+
 WSLUA_METHODS Tvb_methods[] = {
     WSLUA_CLASS_FNREG(Tvb,range),
     WSLUA_CLASS_FNREG(Tvb,len),
@@ -681,6 +799,9 @@ WSLUA_METHODS Tvb_methods[] = {
     WSLUA_CLASS_FNREG(Tvb,reported_len),
     WSLUA_CLASS_FNREG(Tvb,reported_length_remaining),
     WSLUA_CLASS_FNREG(Tvb,raw),
+    WSLUA_CLASS_FNREG(Tvb,uint),
+    WSLUA_CLASS_FNREG(Tvb,le_uint),
+    WSLUA_CLASS_FNREG(Tvb,data_pointer),
     { NULL, NULL }
 };
 
@@ -0,0 +1,557 @@
+/* epanbench.c
+ * Dissection benchmark: replays capture files through epan_dissect_run()
+ * in several configurations and reports how fast that went, in JSON.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Usage: epanbench [-n <runs>] [-Y <display filter>] [-t <tap>] <file> ...
+ *
+ * Each file is read through wiretap and dissected once per configuration:
+ *
+ *   no-tree       no protocol tree, as tshark without -V, -Y or taps
+ *   fake-tree     a protocol tree that isn't visible (only interesting
+ *                 fields are kept)
+ *   visible-tree  a visible protocol tree, as tshark -V
+ *   filter        a fake tree primed for, and checked against, -Y
+ *                 (only if -Y is given)
+ *   tap           a fake tree with a listener on the -t tap ("frame"
+ *                 by default)
+ *
+ * Each configuration is run -n times (default 3) and the fastest run is
+ * reported, with packets per second, nanoseconds per packet, g_malloc()
+ * calls per packet (where GLib still lets us count them; null otherwise)
+ * and the largest RSS seen.  The output is one JSON object, with the keys
+ * always in the same order, for comparing runs across commits.
+ */
+
+#include <config.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <locale.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#include <glib.h>
+
+#include <epan/epan.h>
+#include <epan/epan_dissect.h>
+#include <epan/timestamp.h>
+#include <epan/prefs.h>
+#include <epan/tap.h>
+#include <epan/app_mem_usage.h>
+#include <epan/dfilter/dfilter.h>
+
+#ifdef HAVE_PLUGINS
+#include <wsutil/plugins.h>
+#endif
+#include <wsutil/filesystem.h>
+#include <wsutil/privileges.h>
+#include <wsutil/report_err.h>
+#include <wsutil/ws_version_info.h>
+
+#include <wiretap/wtap.h>
+
+#ifndef HAVE_GETOPT_LONG
+#include "wsutil/wsgetopt.h"
+#endif
+
+#include "frame_tvbuff.h"
+#include "register.h"
+
+typedef enum {
+	BENCH_NO_TREE,
+	BENCH_FAKE_TREE,
+	BENCH_VISIBLE_TREE,
+	BENCH_FILTER,
+	BENCH_TAP
+} bench_config_e;
+
+static const char *bench_config_names[] = {
+	"no-tree",
+	"fake-tree",
+	"visible-tree",
+	"filter",
+	"tap"
+};
+
+typedef struct {
+	guint32		packets;
+	guint32		passed;
+	double		seconds;
+	gint64		mallocs;	/* -1 if they can't be counted */
+	gsize		peak_rss;
+} bench_result_t;
+
+static void failure_message(const char *msg_format, va_list ap);
+static void open_failure_message(const char *filename, int err,
+	gboolean for_writing);
+static void read_failure_message(const char *filename, int err);
+static void write_failure_message(const char *filename, int err);
+
+/*
+ * Counting g_malloc() and friends.  GLib 2.46 made g_mem_set_vtable()
+ * a no-op, so this only works with older GLibs.
+ */
+#if !GLIB_CHECK_VERSION(2,46,0)
+#define COUNT_MALLOCS
+static volatile gint64 malloc_count;
+
+static gpointer
+counting_malloc(gsize n_bytes)
+{
+	malloc_count++;
+	return malloc(n_bytes);
+}
+
+static gpointer
+counting_realloc(gpointer mem, gsize n_bytes)
+{
+	malloc_count++;
+	return realloc(mem, n_bytes);
+}
+
+static gpointer
+counting_calloc(gsize n_blocks, gsize n_block_bytes)
+{
+	malloc_count++;
+	return calloc(n_blocks, n_block_bytes);
+}
+
+static GMemVTable counting_vtable = {
+	counting_malloc,
+	counting_realloc,
+	free,
+	counting_calloc,
+	counting_malloc,
+	counting_realloc
+};
+#endif
+
+/* For epan_get_frame_ts(); we only keep the frames dissection looks back at */
+static frame_data	ref_frame;
+static frame_data	*ref;
+static frame_data	prev_dis_frame;
+static frame_data	*prev_dis;
+
+static const nstime_t *
+bench_get_frame_ts(void *data _U_, guint32 frame_num)
+{
+	if (ref && ref->num == frame_num)
+		return &ref->abs_ts;
+
+	if (prev_dis && prev_dis->num == frame_num)
+		return &prev_dis->abs_ts;
+
+	return NULL;
+}
+
+static gboolean
+bench_tap_packet(void *tapdata, packet_info *pinfo _U_,
+		 epan_dissect_t *edt _U_, const void *data _U_)
+{
+	(*(guint32 *)tapdata)++;
+	return FALSE;
+}
+
+static gsize
+current_rss(void)
+{
+	const char *name;
+	gsize value;
+	guint i;
+
+	for (i = 0; (name = memory_usage_get(i, &value)) != NULL; i++) {
+		if (strcmp(name, "RSS") == 0)
+			return value;
+	}
+	return 0;
+}
+
+/* Dissect every packet in the file once; returns FALSE on a read error */
+static gboolean
+bench_run(const char *fname, bench_config_e config, dfilter_t *dfcode,
+	  const char *tap_name, bench_result_t *result)
+{
+	wtap		*wth;
+	int		err;
+	gchar		*err_info;
+	gint64		data_offset;
+	epan_t		*epan;
+	epan_dissect_t	edt;
+	frame_data	fdata;
+	nstime_t	elapsed_time;
+	guint32		cum_bytes = 0;
+	guint32		tap_count = 0;
+	GString		*tap_error;
+	GTimer		*timer;
+	gsize		rss;
+
+	memset(result, 0, sizeof(*result));
+
+	wth = wtap_open_offline(fname, WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+	if (wth == NULL) {
+		fprintf(stderr, "epanbench: can't open \"%s\": %s\n", fname,
+			wtap_strerror(err));
+		g_free(err_info);
+		return FALSE;
+	}
+
+	if (config == BENCH_TAP) {
+		tap_error = register_tap_listener(tap_name, &tap_count, NULL, 0,
+						  NULL, bench_tap_packet, NULL);
+		if (tap_error) {
+			fprintf(stderr, "epanbench: can't register the %s tap: %s\n",
+				tap_name, tap_error->str);
+			g_string_free(tap_error, TRUE);
+			wtap_close(wth);
+			return FALSE;
+		}
+	}
+
+	epan = epan_new();
+	epan->data = NULL;
+	epan->get_frame_ts = bench_get_frame_ts;
+	epan->get_interface_name = NULL;
+	epan->get_user_comment = NULL;
+
+	ref = NULL;
+	prev_dis = NULL;
+	nstime_set_zero(&elapsed_time);
+
+	epan_dissect_init(&edt, epan, config != BENCH_NO_TREE,
+			  config == BENCH_VISIBLE_TREE);
+
+	timer = g_timer_new();
+#ifdef COUNT_MALLOCS
+	malloc_count = 0;
+#endif
+
+	while (wtap_read(wth, &err, &err_info, &data_offset)) {
+		struct wtap_pkthdr *whdr = wtap_phdr(wth);
+
+		result->packets++;
+		frame_data_init(&fdata, result->packets, whdr, data_offset, cum_bytes);
+
+		if (config == BENCH_FILTER)
+			epan_dissect_prime_dfilter(&edt, dfcode);
+
+		frame_data_set_before_dissect(&fdata, &elapsed_time, &ref, prev_dis);
+		if (ref == &fdata) {
+			ref_frame = fdata;
+			ref = &ref_frame;
+		}
+
+		epan_dissect_run_with_taps(&edt, wtap_file_type_subtype(wth), whdr,
+			frame_tvbuff_new(&fdata, wtap_buf_ptr(wth)), &fdata, NULL);
+
+		if (config != BENCH_FILTER || dfilter_apply_edt(dfcode, &edt)) {
+			result->passed++;
+			frame_data_set_after_dissect(&fdata, &cum_bytes);
+			prev_dis_frame = fdata;
+			prev_dis = &prev_dis_frame;
+		}
+
+		epan_dissect_reset(&edt);
+		frame_data_destroy(&fdata);
+
+		/* Reading /proc for every packet would swamp the measurement */
+		if ((result->packets & 0x3ff) == 0) {
+			rss = current_rss();
+			if (rss > result->peak_rss)
+				result->peak_rss = rss;
+		}
+	}
+
+	g_timer_stop(timer);
+	result->seconds = g_timer_elapsed(timer, NULL);
+	g_timer_destroy(timer);
+#ifdef COUNT_MALLOCS
+	result->mallocs = malloc_count;
+#else
+	result->mallocs = -1;
+#endif
+	rss = current_rss();
+	if (rss > result->peak_rss)
+		result->peak_rss = rss;
+
+	epan_dissect_cleanup(&edt);
+	epan_free(epan);
+	if (config == BENCH_TAP)
+		remove_tap_listener(&tap_count);
+	wtap_close(wth);
+
+	if (err != 0) {
+		fprintf(stderr, "epanbench: error reading \"%s\": %s\n", fname,
+			wtap_strerror(err));
+		g_free(err_info);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+print_json_string(const char *str)
+{
+	putchar('"');
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			printf("\\%c", *str);
+		else if ((guchar)*str < 0x20)
+			printf("\\u%04x", (guchar)*str);
+		else
+			putchar(*str);
+	}
+	putchar('"');
+}
+
+static void
+print_result(const char *config_name, const bench_result_t *result, gboolean last)
+{
+	double per_packet = result->packets ? result->seconds / result->packets : 0.0;
+
+	printf("        {\"config\": ");
+	print_json_string(config_name);
+	printf(", \"packets\": %u, \"passed\": %u, \"seconds\": %.6f, ",
+	       result->packets, result->passed, result->seconds);
+	printf("\"packets_per_second\": %.1f, \"ns_per_packet\": %.1f, ",
+	       result->seconds > 0.0 ? result->packets / result->seconds : 0.0,
+	       per_packet * 1e9);
+	if (result->mallocs >= 0 && result->packets)
+		printf("\"mallocs_per_packet\": %.2f, ",
+		       (double)result->mallocs / result->packets);
+	else
+		printf("\"mallocs_per_packet\": null, ");
+	printf("\"peak_rss_bytes\": %" G_GSIZE_FORMAT "}%s\n",
+	       result->peak_rss, last ? "" : ",");
+}
+
+static void
+print_usage(FILE *output)
+{
+	fprintf(output, "Usage: epanbench [-n <runs>] [-Y <display filter>] [-t <tap>] <file> ...\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	char		*init_progfile_dir_error;
+	char		*gpf_path, *pf_path;
+	int		gpf_open_errno, gpf_read_errno;
+	int		pf_open_errno, pf_read_errno;
+	dfilter_t	*dfcode = NULL;
+	gchar		*err_msg;
+	const char	*dfilter = NULL;
+	const char	*tap_name = "frame";
+	int		runs = 3;
+	int		opt;
+	int		i, run, config, last_config;
+	bench_result_t	result, best;
+	gboolean	ok = TRUE;
+
+#ifdef COUNT_MALLOCS
+	/* This has to come before anything else allocates */
+	g_mem_set_vtable(&counting_vtable);
+#endif
+
+	while ((opt = getopt(argc, argv, "hn:t:Y:")) != -1) {
+		switch (opt) {
+		case 'n':
+			runs = atoi(optarg);
+			if (runs < 1) {
+				fprintf(stderr, "epanbench: the number of runs must be at least 1\n");
+				exit(1);
+			}
+			break;
+		case 't':
+			tap_name = optarg;
+			break;
+		case 'Y':
+			dfilter = optarg;
+			break;
+		case 'h':
+			print_usage(stdout);
+			exit(0);
+		default:
+			print_usage(stderr);
+			exit(1);
+		}
+	}
+	if (optind >= argc) {
+		print_usage(stderr);
+		exit(1);
+	}
+
+	/*
+	 * Get credential information for later use.
+	 */
+	init_process_policies();
+
+	init_progfile_dir_error = init_progfile_dir(argv[0], main);
+	if (init_progfile_dir_error != NULL) {
+		fprintf(stderr, "epanbench: Can't get pathname of epanbench program: %s.\n",
+			init_progfile_dir_error);
+	}
+
+	init_report_err(failure_message, open_failure_message,
+			read_failure_message, write_failure_message);
+
+	timestamp_set_type(TS_RELATIVE);
+	timestamp_set_seconds_type(TS_SECONDS_DEFAULT);
+
+	wtap_init();
+
+#ifdef HAVE_PLUGINS
+	/* Register all the plugin types we have. */
+	epan_register_plugin_types(); /* Types known to libwireshark */
+	wtap_register_plugin_types(); /* Types known to libwiretap */
+
+	/* Scan for plugins.  This does *not* call their registration routines;
+	   that's done later. */
+	scan_plugins();
+
+	/* Register all libwiretap plugin modules. */
+	register_all_wiretap_modules();
+#endif
+
+	epan_init(register_all_protocols, register_all_protocol_handoffs,
+		  NULL, NULL);
+
+	/* set the c-language locale to the native environment. */
+	setlocale(LC_ALL, "");
+
+	read_prefs(&gpf_open_errno, &gpf_read_errno, &gpf_path,
+		&pf_open_errno, &pf_read_errno, &pf_path);
+	prefs_apply_all();
+
+	if (dfilter != NULL) {
+		if (!dfilter_compile(dfilter, &dfcode, &err_msg)) {
+			fprintf(stderr, "epanbench: %s\n", err_msg);
+			g_free(err_msg);
+			epan_cleanup();
+			exit(2);
+		}
+	}
+	last_config = BENCH_TAP;
+
+	printf("{\n");
+	printf("  \"version\": ");
+	print_json_string(get_ws_vcs_version_info());
+	printf(",\n  \"runs\": %d,\n", runs);
+	printf("  \"filter\": ");
+	if (dfilter)
+		print_json_string(dfilter);
+	else
+		printf("null");
+	printf(",\n  \"tap\": ");
+	print_json_string(tap_name);
+	printf(",\n  \"files\": [\n");
+
+	for (i = optind; i < argc; i++) {
+		printf("    {\"file\": ");
+		print_json_string(argv[i]);
+		printf(", \"results\": [\n");
+
+		for (config = BENCH_NO_TREE; config <= last_config; config++) {
+			if (config == BENCH_FILTER && dfcode == NULL)
+				continue;
+
+			memset(&best, 0, sizeof(best));
+			for (run = 0; run < runs; run++) {
+				if (!bench_run(argv[i], (bench_config_e)config, dfcode, tap_name, &result)) {
+					ok = FALSE;
+					break;
+				}
+				if (run == 0 || result.seconds < best.seconds)
+					best = result;
+			}
+			print_result(bench_config_names[config], &best, config == last_config);
+		}
+
+		printf("    ]}%s\n", i + 1 < argc ? "," : "");
+	}
+
+	printf("  ]\n}\n");
+
+	if (dfcode)
+		dfilter_free(dfcode);
+	epan_cleanup();
+	exit(ok ? 0 : 2);
+}
+
+/*
+ * General errors are reported with an console message in "epanbench".
+ */
+static void
+failure_message(const char *msg_format, va_list ap)
+{
+	fprintf(stderr, "epanbench: ");
+	vfprintf(stderr, msg_format, ap);
+	fprintf(stderr, "\n");
+}
+
+/*
+ * Open/create errors are reported with an console message in "epanbench".
+ */
+static void
+open_failure_message(const char *filename, int err, gboolean for_writing)
+{
+	fprintf(stderr, "epanbench: ");
+	fprintf(stderr, file_open_error_message(err, for_writing), filename);
+	fprintf(stderr, "\n");
+}
+
+/*
+ * Read errors are reported with an console message in "epanbench".
+ */
+static void
+read_failure_message(const char *filename, int err)
+{
+	fprintf(stderr, "epanbench: An error occurred while reading from the file \"%s\": %s.\n",
+		filename, g_strerror(err));
+}
+
+/*
+ * Write errors are reported with an console message in "epanbench".
+ */
+static void
+write_failure_message(const char *filename, int err)
+{
+	fprintf(stderr, "epanbench: An error occurred while writing to the file \"%s\": %s.\n",
+		filename, g_strerror(err));
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
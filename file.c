@@ -110,6 +110,20 @@ static int read_packet(capture_file *cf, dfilter_t *dfcode, epan_dissect_t *edt,
 
 static void rescan_packets(capture_file *cf, const char *action, const char *action_item, gboolean redissect);
 
+/* The progress dialog lets the event loop run while rescan_packets() is
+   going, so the user can apply another display filter in the middle of a
+   scan.  Rather than starting a second scan inside the first one, the new
+   filter is recorded and the running scan stops and starts over with it. */
+static gboolean rescan_in_progress = FALSE;
+static gboolean rescan_restart = FALSE;
+
+/* TRUE if every frame's passed_dfilter flag reflects cf->dfilter, i.e. the
+   last scan wasn't cut short.  When it is, and the new filter only adds
+   terms to the current one with "&&", frames that are hidden now will stay
+   hidden and rescan_packets() needn't look at them again. */
+static gboolean frames_match_dfilter = TRUE;
+static gboolean rescan_refine = FALSE;
+
 typedef enum {
   MR_NOTMATCHED,
   MR_MATCHED,
@@ -152,6 +166,12 @@ static void ref_time_packets(capture_file *cf);
 #define MIN_QUANTUM         200000
 #define MIN_NUMBER_OF_PACKET 1500
 
+/* Keep this many bytes of recently read records, so that going back to
+   a packet doesn't mean another seek and read of the file. */
+#define RECORD_CACHE_SIZE   (16 * 1024 * 1024)
+/* When packets are read in order, read this many ahead at a time. */
+#define READ_AHEAD_COUNT    64
+
 /*
  * We could probably use g_signal_...() instead of the callbacks below but that
  * would require linking our CLI programs to libgobject and creating an object
@@ -295,16 +315,14 @@ ws_epan_new(capture_file *cf)
   return epan;
 }
 
-cf_status_t
-cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_tempfile, int *err)
+/*
+ * Set up to read a capture file that's been opened; fname is its name,
+ * or that of the first file of a set of files being read as one.
+ */
+static void
+cf_open_wth(capture_file *cf, wtap *wth, const char *fname, unsigned int type,
+            gboolean is_tempfile, char **set_filenames)
 {
-  wtap  *wth;
-  gchar *err_info;
-
-  wth = wtap_open_offline(fname, type, err, &err_info, TRUE);
-  if (wth == NULL)
-    goto fail;
-
   /* The open succeeded.  Close whatever capture file we had open,
      and fill in the information for this file. */
   cf_close(cf);
@@ -321,11 +339,25 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
    */
   cf->epan = ws_epan_new(cf);
 
+  /* Remember the values of the fields the user asked for as we read the
+     packets, unless we remembered them the last time the file was read. */
+  if (is_tempfile || set_filenames != NULL)
+    cf->field_store = field_store_new(prefs.gui_field_store_fields);
+  else
+    cf->field_store = field_store_load(fname, prefs.gui_field_store_fields);
+
+  /* Remember the protocols in each packet, for the protocol hierarchy. */
+  cf->proto_stacks = proto_stack_store_new();
+
   /* We're about to start reading the file. */
   cf->state = FILE_READ_IN_PROGRESS;
+  frames_match_dfilter = TRUE;
 
   cf->wth = wth;
   cf->f_datalen = 0;
+  wtap_set_record_cache_size(cf->wth, RECORD_CACHE_SIZE);
+  cf->last_read = 0;
+  cf->read_ahead_to = 0;
 
   /* Set the file name because we need it to set the follow stream filter.
      XXX - is that still true?  We need it for other reasons, though,
@@ -335,6 +367,9 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
   /* Indicate whether it's a permanent or temporary file. */
   cf->is_tempfile = is_tempfile;
 
+  /* And whether it's the first of a set of files. */
+  cf->set_filenames = set_filenames;
+
   /* No user changes yet. */
   cf->unsaved_changes = FALSE;
 
@@ -349,6 +384,9 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
   cf->marked_count = 0;
   cf->ignored_count = 0;
   cf->ref_time_count = 0;
+  memset(&cf->frame_tally, 0, sizeof cf->frame_tally);
+  cf->frame_tally.valid = TRUE;
+  cf->frame_tally.marked_times_valid = TRUE;
   cf->drops_known = FALSE;
   cf->drops     = 0;
   cf->snap      = wtap_snapshot_length(cf->wth);
@@ -381,12 +419,46 @@ cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_temp
 
   wtap_set_cb_new_ipv4(cf->wth, add_ipv4_name);
   wtap_set_cb_new_ipv6(cf->wth, (wtap_new_ipv6_callback_t) add_ipv6_name);
+}
 
+cf_status_t
+cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_tempfile, int *err)
+{
+  wtap  *wth;
+  gchar *err_info;
+
+  wth = wtap_open_offline(fname, type, err, &err_info, TRUE);
+  if (wth == NULL) {
+    cf_open_failure_alert_box(fname, *err, err_info, FALSE, 0);
+    return CF_ERROR;
+  }
+  cf_open_wth(cf, wth, fname, type, is_tempfile, NULL);
   return CF_OK;
+}
 
-fail:
-  cf_open_failure_alert_box(fname, *err, err_info, FALSE, 0);
-  return CF_ERROR;
+cf_status_t
+cf_open_set(capture_file *cf, guint count, const char *const *fnames,
+            unsigned int type, int *err)
+{
+  wtap  *wth;
+  gchar *err_info;
+  guint  err_fileno;
+  guint  i;
+  char **set_filenames;
+
+  wth = wtap_open_offline_set(count, fnames, type, err, &err_info, &err_fileno);
+  if (wth == NULL) {
+    cf_open_failure_alert_box(count != 0 ? fnames[err_fileno] : "", *err,
+                              err_info, FALSE, 0);
+    return CF_ERROR;
+  }
+
+  set_filenames = g_new(char *, count + 1);
+  for (i = 0; i < count; i++)
+    set_filenames[i] = g_strdup(fnames[i]);
+  set_filenames[count] = NULL;
+  cf_open_wth(cf, wth, fnames[0], type, FALSE, set_filenames);
+  return CF_OK;
 }
 
 /*
@@ -420,6 +492,15 @@ cf_close(capture_file *cf)
   /* close things, if not already closed before */
   color_filters_cleanup();
 
+  /* Save the field values for the next time the file is read.  This is
+     only a cache, so it doesn't matter if it fails. */
+  if (cf->field_store != NULL && cf->filename != NULL && !cf->is_tempfile &&
+      cf->set_filenames == NULL) {
+    int err;
+
+    field_store_save(cf->field_store, cf->filename, cf->count, &err);
+  }
+
   if (cf->wth) {
     wtap_close(cf->wth);
     cf->wth = NULL;
@@ -432,6 +513,8 @@ cf_close(capture_file *cf)
     g_free(cf->filename);
     cf->filename = NULL;
   }
+  g_strfreev(cf->set_filenames);
+  cf->set_filenames = NULL;
   /* ...which means we have no changes to that file to save. */
   cf->unsaved_changes = FALSE;
 
@@ -450,6 +533,10 @@ cf_close(capture_file *cf)
     free_frame_data_sequence(cf->frames);
     cf->frames = NULL;
   }
+  field_store_free(cf->field_store);
+  cf->field_store = NULL;
+  proto_stack_store_free(cf->proto_stacks);
+  cf->proto_stacks = NULL;
 #ifdef WANT_PACKET_EDITOR
   if (cf->edited_frames) {
     g_tree_destroy(cf->edited_frames);
@@ -466,6 +553,7 @@ cf_close(capture_file *cf)
 
   /* No frames, no frame selected, no field in that frame selected. */
   cf->count = 0;
+  memset(&cf->frame_tally, 0, sizeof cf->frame_tally);
   cf->current_frame = 0;
   cf->current_row = 0;
   cf->finfo_selected = NULL;
@@ -541,6 +629,8 @@ cf_read(capture_file *cf, gboolean reloading)
   volatile gboolean    create_proto_tree;
   guint                tap_flags;
   gboolean             compiled;
+  gboolean             progressive;
+  volatile gboolean    selected_during_load = FALSE;
 
   /* Compile the current display filter.
    * We assume this will not fail since cf->dfilter is only set in
@@ -551,8 +641,11 @@ cf_read(capture_file *cf, gboolean reloading)
 
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
+  /* The field store needs protocol trees to get the field values from,
+     unless it got them from its cache. */
   create_proto_tree =
-    (dfcode != NULL || have_filtering_tap_listeners() || (tap_flags & TL_REQUIRES_PROTO_TREE));
+    (dfcode != NULL || have_filtering_tap_listeners() || (tap_flags & TL_REQUIRES_PROTO_TREE) ||
+     (cf->field_store != NULL && !field_store_is_recorded(cf->field_store, 1)));
 
   reset_tap_listeners();
 
@@ -567,8 +660,12 @@ cf_read(capture_file *cf, gboolean reloading)
      XXX - do we know this at open time? */
   cf->iscompressed = wtap_iscompressed(cf->wth);
 
-  /* The packet list window will be empty until the file is completly loaded */
-  packet_list_freeze();
+  /* If the packet list can show packets as they are read, let the user
+     look at them while the rest of the file loads; otherwise the packet
+     list window will be empty until the file is completely loaded. */
+  progressive = packet_list_begin_progressive_load();
+  if (!progressive)
+    packet_list_freeze();
 
   stop_flag = FALSE;
   g_get_current_time(&start_time);
@@ -643,6 +740,13 @@ cf_read(capture_file *cf, gboolean reloading)
               }
             }
 #endif /* HAVE_LIBPCAP */
+            if (progressive) {
+              packet_list_update_progressive_load();
+              if (!selected_during_load && cf->first_displayed != 0) {
+                packet_list_select_first_row();
+                selected_during_load = TRUE;
+              }
+            }
             update_progress_dlg(progbar, progbar_val, status_str);
           }
           progbar_nextstep += progbar_quantum;
@@ -708,10 +812,17 @@ cf_read(capture_file *cf, gboolean reloading)
      WTAP_ENCAP_PER_PACKET). */
   cf->lnk_t = wtap_file_encap(cf->wth);
 
-  cf->current_frame = frame_data_sequence_find(cf->frames, cf->first_displayed);
-  cf->current_row = 0;
+  /* If the user has been looking at packets while the file was loading,
+     leave their selection alone. */
+  if (!selected_during_load) {
+    cf->current_frame = frame_data_sequence_find(cf->frames, cf->first_displayed);
+    cf->current_row = 0;
+  }
 
-  packet_list_thaw();
+  if (progressive)
+    packet_list_end_progressive_load();
+  else
+    packet_list_thaw();
   if (reloading)
     cf_callback_invoke(cf_cb_file_reload_finished, cf);
   else
@@ -719,7 +830,7 @@ cf_read(capture_file *cf, gboolean reloading)
 
   /* If we have any displayed packets to select, select the first of those
      packets by making the first row the selected row. */
-  if (cf->first_displayed != 0) {
+  if (cf->first_displayed != 0 && !selected_during_load) {
     packet_list_select_first_row();
   }
 
@@ -799,13 +910,15 @@ cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
   create_proto_tree =
-    (dfcode != NULL || have_filtering_tap_listeners() || (tap_flags & TL_REQUIRES_PROTO_TREE));
+    (dfcode != NULL || cf->field_store != NULL || have_filtering_tap_listeners() ||
+     (tap_flags & TL_REQUIRES_PROTO_TREE));
 
   *err = 0;
 
   packet_list_check_end();
   /* Don't freeze/thaw the list when doing live capture */
   /*packet_list_freeze();*/
+  packet_list_begin_live_update();
 
   /*g_log(NULL, G_LOG_LEVEL_MESSAGE, "cf_continue_tail: %u new: %u", cf->count, to_read);*/
 
@@ -873,8 +986,7 @@ cf_continue_tail(capture_file *cf, volatile int to_read, int *err)
 
   /* moving to the end of the packet list - if the user requested so and
      we have some new packets. */
-  if (newly_displayed_packets && auto_scroll_live && cf->count != 0)
-      packet_list_moveto_end();
+  packet_list_end_live_update(newly_displayed_packets && auto_scroll_live && cf->count != 0);
 
   if (cf->state == FILE_READ_ABORTED) {
     /* Well, the user decided to exit Wireshark.  Return CF_READ_ABORTED
@@ -927,7 +1039,8 @@ cf_finish_tail(capture_file *cf, int *err)
   tap_flags = union_of_tap_listener_flags();
   cinfo = (tap_flags & TL_REQUIRES_COLUMNS) ? &cf->cinfo : NULL;
   create_proto_tree =
-    (dfcode != NULL || have_filtering_tap_listeners() || (tap_flags & TL_REQUIRES_PROTO_TREE));
+    (dfcode != NULL || cf->field_store != NULL || have_filtering_tap_listeners() ||
+     (tap_flags & TL_REQUIRES_PROTO_TREE));
 
   if (cf->wth == NULL) {
     cf_close(cf);
@@ -937,6 +1050,7 @@ cf_finish_tail(capture_file *cf, int *err)
   packet_list_check_end();
   /* Don't freeze/thaw the list when doing live capture */
   /*packet_list_freeze();*/
+  packet_list_begin_live_update();
 
   epan_dissect_init(&edt, cf->epan, create_proto_tree, FALSE);
 
@@ -959,6 +1073,7 @@ cf_finish_tail(capture_file *cf, int *err)
 
   /* Don't freeze/thaw the list when doing live capture */
   /*packet_list_thaw();*/
+  packet_list_end_live_update(cf->state != FILE_READ_ABORTED && auto_scroll_live && cf->count != 0);
 
   if (cf->state == FILE_READ_ABORTED) {
     /* Well, the user decided to abort the read.  We're only called
@@ -970,9 +1085,6 @@ cf_finish_tail(capture_file *cf, int *err)
     return CF_READ_ABORTED;
   }
 
-  if (auto_scroll_live && cf->count != 0)
-    packet_list_moveto_end();
-
   /* We're done reading sequentially through the file. */
   cf->state = FILE_READ_DONE;
 
@@ -1112,12 +1224,190 @@ void cf_set_rfcode(capture_file *cf, dfilter_t *rfcode)
   cf->rfcode = rfcode;
 }
 
+/*
+ * cf->frame_tally is kept up to date as frames change.  A frame's share
+ * of the counts that depend on its flags is taken out before one of them
+ * changes and put back afterwards.  Time ranges can only grow that way,
+ * so the marked frames' range is recomputed by cf_update_frame_tally()
+ * if a frame at one end of it is unmarked, and the displayed frames'
+ * range is started over when the packet list is rescanned.
+ */
+
+/* Widen the range from "start" to "stop" to include "t"; "count" is the
+   number of time-stamped frames in the range, including this one. */
+static void
+tally_time(double *start, double *stop, guint32 count, double t)
+{
+  if (count == 1) {
+    *start = t;
+    *stop = t;
+  } else {
+    if (t < *start)
+      *start = t;
+    if (t > *stop)
+      *stop = t;
+  }
+}
+
+/* Count a frame that's just been read. */
+static void
+tally_new_frame(capture_file *cf, const frame_data *fdata)
+{
+  frame_tally_t *ft = &cf->frame_tally;
+  double         t  = nstime_to_sec(&fdata->abs_ts);
+
+  ft->bytes += fdata->pkt_len;
+  if (fdata->num == 1) {
+    /* The summary has always started out with the first frame's time
+       stamp, whether or not it has one. */
+    ft->start_time = t;
+    ft->stop_time = t;
+  }
+  if (fdata->flags.has_ts) {
+    ft->count_ts++;
+    if (t < ft->start_time)
+      ft->start_time = t;
+    if (t > ft->stop_time)
+      ft->stop_time = t;
+  }
+}
+
+/* Add (sign 1) or take out (sign -1) a frame's share of the counts of
+   displayed frames.  Unsigned arithmetic makes taking out work. */
+static void
+tally_displayed_frame(capture_file *cf, const frame_data *fdata, int sign)
+{
+  frame_tally_t *ft = &cf->frame_tally;
+
+  if (fdata->flags.passed_dfilter || fdata->flags.dependent_of_displayed)
+    ft->displayed_plus_dependents_count += sign;
+  if (!fdata->flags.passed_dfilter)
+    return;
+
+  ft->displayed_count += sign;
+  ft->displayed_bytes += (guint64)(gint64)sign * fdata->pkt_len;
+  if (fdata->flags.has_ts) {
+    ft->displayed_count_ts += sign;
+    if (sign > 0)
+      tally_time(&ft->displayed_start, &ft->displayed_stop,
+                 ft->displayed_count_ts, nstime_to_sec(&fdata->abs_ts));
+  }
+  if (fdata->flags.marked)
+    ft->displayed_marked_count += sign;
+  if (fdata->flags.ignored) {
+    ft->displayed_ignored_count += sign;
+    if (fdata->flags.marked)
+      ft->displayed_ignored_marked_count += sign;
+  }
+}
+
+/* Likewise for the counts of marked frames. */
+static void
+tally_marked_frame(capture_file *cf, const frame_data *fdata, int sign)
+{
+  frame_tally_t *ft = &cf->frame_tally;
+
+  if (!fdata->flags.marked)
+    return;
+
+  ft->marked_bytes += (guint64)(gint64)sign * fdata->pkt_len;
+  if (fdata->flags.has_ts) {
+    ft->marked_count_ts += sign;
+    if (sign > 0)
+      tally_time(&ft->marked_start, &ft->marked_stop,
+                 ft->marked_count_ts, nstime_to_sec(&fdata->abs_ts));
+  }
+  if (fdata->flags.ignored)
+    ft->ignored_marked_count += sign;
+  if (sign > 0) {
+    if (ft->first_marked == 0 || fdata->num < ft->first_marked)
+      ft->first_marked = fdata->num;
+    if (fdata->num > ft->last_marked)
+      ft->last_marked = fdata->num;
+  }
+}
+
+/* Forget the counts of displayed frames, before the packet list is
+   rescanned and they're counted again. */
+static void
+tally_reset_displayed(capture_file *cf)
+{
+  frame_tally_t *ft = &cf->frame_tally;
+
+  ft->displayed_count = 0;
+  ft->displayed_count_ts = 0;
+  ft->displayed_bytes = 0;
+  ft->displayed_start = 0;
+  ft->displayed_stop = 0;
+  ft->displayed_plus_dependents_count = 0;
+  ft->displayed_marked_count = 0;
+  ft->displayed_ignored_count = 0;
+  ft->displayed_ignored_marked_count = 0;
+}
+
+/* find_and_mark_frame_depended_upon(), counting the frames that are
+   displayed only because another frame depends on them. */
+static void
+mark_frame_depended_upon(gpointer data, gpointer user_data)
+{
+  guint32       dependent_frame = GPOINTER_TO_UINT(data);
+  capture_file *cf              = (capture_file *)user_data;
+  frame_data   *dependent_fd;
+
+  if (dependent_frame && cf->frames) {
+    dependent_fd = frame_data_sequence_find(cf->frames, dependent_frame);
+    if (!dependent_fd->flags.passed_dfilter &&
+        !dependent_fd->flags.dependent_of_displayed)
+      cf->frame_tally.displayed_plus_dependents_count++;
+    dependent_fd->flags.dependent_of_displayed = 1;
+  }
+}
+
+void
+cf_update_frame_tally(capture_file *cf)
+{
+  frame_tally_t *ft = &cf->frame_tally;
+  guint32        framenum;
+  frame_data    *fdata;
+
+  if (cf->frames == NULL)
+    return;
+
+  if (!ft->valid) {
+    /* Count everything again. */
+    memset(ft, 0, sizeof *ft);
+    for (framenum = 1; framenum <= cf->count; framenum++) {
+      fdata = frame_data_sequence_find(cf->frames, framenum);
+      tally_new_frame(cf, fdata);
+      tally_displayed_frame(cf, fdata, 1);
+      tally_marked_frame(cf, fdata, 1);
+    }
+    ft->valid = TRUE;
+    ft->marked_times_valid = TRUE;
+  } else if (!ft->marked_times_valid) {
+    /* Only the marked frames' time range is out of date. */
+    ft->marked_count_ts = 0;
+    for (framenum = ft->first_marked;
+         framenum != 0 && framenum <= ft->last_marked; framenum++) {
+      fdata = frame_data_sequence_find(cf->frames, framenum);
+      if (fdata->flags.marked && fdata->flags.has_ts) {
+        ft->marked_count_ts++;
+        tally_time(&ft->marked_start, &ft->marked_stop,
+                   ft->marked_count_ts, nstime_to_sec(&fdata->abs_ts));
+      }
+    }
+    ft->marked_times_valid = TRUE;
+  }
+}
+
 static int
 add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
     epan_dissect_t *edt, dfilter_t *dfcode, column_info *cinfo,
     struct wtap_pkthdr *phdr, const guint8 *buf, gboolean add_to_packet_list)
 {
   gint            row               = -1;
+  gboolean        record_fields;
+  gboolean        dissected         = TRUE;
 
   frame_data_set_before_dissect(fdata, &cf->elapsed_time,
                                 &cf->ref, cf->prev_dis);
@@ -1127,11 +1417,26 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
       epan_dissect_prime_dfilter(edt, dfcode);
   }
 
-  /* Dissect the frame. */
-  epan_dissect_run_with_taps(edt, cf->cd_t, phdr, frame_tvbuff_new(fdata, buf), fdata, cinfo);
+  /* Record the fields in the field store the first time the frame is
+     dissected, unless they were loaded from its cache; they can't change
+     after that. */
+  record_fields = cf->field_store != NULL && !fdata->flags.visited &&
+                  !field_store_is_recorded(cf->field_store, fdata->num);
+  if (record_fields)
+    field_store_prime(cf->field_store, edt);
+
+  if (dfcode != NULL && fdata->flags.visited &&
+      !tap_listeners_require_dissection() &&
+      !dfilter_prefilter_packet(dfcode, fdata->num, phdr, buf)) {
+    /* We're rescanning, so this frame has been dissected before and
+       any state that other frames need from it already exists; and
+       the display filter rejects it without needing a dissection. */
+    fdata->flags.passed_dfilter = 0;
+    dissected = FALSE;
+  } else if (dfcode != NULL) {
+    /* Dissect the frame. */
+    epan_dissect_run_with_taps(edt, cf->cd_t, phdr, frame_tvbuff_new(fdata, buf), fdata, cinfo);
 
-  /* If we don't have a display filter, set "passed_dfilter" to 1. */
-  if (dfcode != NULL) {
     fdata->flags.passed_dfilter = dfilter_apply_edt(dfcode, edt) ? 1 : 0;
 
     if (fdata->flags.passed_dfilter) {
@@ -1139,13 +1444,27 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
        * (potentially not displayed) frames.  Find those frames and mark them
        * as depended upon.
        */
-      g_slist_foreach(edt->pi.dependent_frames, find_and_mark_frame_depended_upon, cf->frames);
+      g_slist_foreach(edt->pi.dependent_frames, mark_frame_depended_upon, cf);
     }
-  } else
+  } else {
+    /* Dissect the frame. */
+    epan_dissect_run_with_taps(edt, cf->cd_t, phdr, frame_tvbuff_new(fdata, buf), fdata, cinfo);
+
+    /* We don't have a display filter, so set "passed_dfilter" to 1. */
     fdata->flags.passed_dfilter = 1;
+  }
+
+  if (record_fields && fdata->flags.visited)
+    field_store_record(cf->field_store, fdata->num, edt);
+
+  /* Likewise the protocols in the frame, if it was dissected. */
+  if (cf->proto_stacks != NULL && dissected && fdata->flags.visited &&
+      proto_stack_store_get(cf->proto_stacks, fdata->num) == 0)
+    proto_stack_store_record(cf->proto_stacks, fdata->num, &edt->pi);
 
   if (fdata->flags.passed_dfilter || fdata->flags.ref_time)
     cf->displayed_count++;
+  tally_displayed_frame(cf, fdata, 1);
 
   if (add_to_packet_list) {
     /* We fill the needed columns from new_packet_list */
@@ -1181,6 +1500,31 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
   return row;
 }
 
+/*
+ * Mark a frame as displayed without dissecting it.  This is used when
+ * rescanning the packet list with no display filter and nothing that
+ * needs the dissection results, in which case every frame is displayed
+ * and dissecting it would only be wasted effort.
+ */
+static void
+add_undissected_packet_to_packet_list(frame_data *fdata, capture_file *cf)
+{
+  frame_data_set_before_dissect(fdata, &cf->elapsed_time,
+                                &cf->ref, cf->prev_dis);
+  cf->prev_cap = fdata;
+
+  fdata->flags.passed_dfilter = 1;
+  cf->displayed_count++;
+  tally_displayed_frame(cf, fdata, 1);
+
+  frame_data_set_after_dissect(fdata, &cf->cum_bytes);
+  cf->prev_dis = fdata;
+
+  if (cf->first_displayed == 0)
+    cf->first_displayed = fdata->num;
+  cf->last_displayed = fdata->num;
+}
+
 /* read in a new packet */
 /* returns the row of the new packet in the packet list or -1 if not displayed */
 static int
@@ -1225,6 +1569,7 @@ read_packet(capture_file *cf, dfilter_t *dfcode, epan_dissect_t *edt,
     fdata = frame_data_sequence_add(cf->frames, &fdlocal);
 
     cf->count++;
+    tally_new_frame(cf, fdata);
     if (phdr->opt_comment != NULL)
       cf->packet_comment_count++;
     cf->f_datalen = offset + fdlocal.cap_len;
@@ -1646,6 +1991,47 @@ cf_merge_files(char **out_filenamep, int in_file_count,
     return CF_OK;
 }
 
+/* Return TRUE if the display filter text "filter_new" is "filter_old",
+   optionally parenthesized, with "&& ..." or "and ..." after it.  "&&" has
+   the lowest precedence in the filter grammar, so the new filter is the old
+   one AND'ed with something and can only match frames the old one matched. */
+static gboolean
+dfilter_text_is_refinement(const char *filter_old, const char *filter_new)
+{
+  size_t      old_len = strlen(filter_old);
+  const char *p = filter_new;
+
+  if (old_len == 0)
+    return FALSE;
+
+  if (*p == '(' && strncmp(p + 1, filter_old, old_len) == 0 &&
+      p[old_len + 1] == ')') {
+    p += old_len + 2;
+  } else if (strncmp(p, filter_old, old_len) == 0) {
+    p += old_len;
+    /* "tcp" followed by ".port == 80" isn't a refinement of "tcp". */
+    if (!g_ascii_isspace(*p) && *p != '&')
+      return FALSE;
+  } else {
+    return FALSE;
+  }
+
+  while (g_ascii_isspace(*p))
+    p++;
+  if (strncmp(p, "&&", 2) == 0) {
+    p += 2;
+  } else if (g_ascii_strncasecmp(p, "and", 3) == 0 &&
+             (g_ascii_isspace(p[3]) || p[3] == '(' || p[3] == '!')) {
+    p += 3;
+  } else {
+    return FALSE;
+  }
+
+  while (g_ascii_isspace(*p))
+    p++;
+  return *p != '\0';
+}
+
 cf_status_t
 cf_filter_packets(capture_file *cf, gchar *dftext, gboolean force)
 {
@@ -1654,6 +2040,7 @@ cf_filter_packets(capture_file *cf, gchar *dftext, gboolean force)
   dfilter_t  *dfcode;
   gchar      *err_msg;
   GTimeVal    start_time;
+  gboolean    refine;
 
   /* if new filter equals old one, do nothing unless told to do so */
   if (!force && strcmp(filter_new, filter_old) == 0) {
@@ -1672,7 +2059,7 @@ cf_filter_packets(capture_file *cf, gchar *dftext, gboolean force)
      * and try to compile it.
      */
     dftext = g_strdup(dftext);
-    if (!dfilter_compile(dftext, &dfcode, &err_msg)) {
+    if (!dfilter_compile_cached(dftext, &dfcode, &err_msg)) {
       /* The attempt failed; report an error. */
       simple_message_box(ESD_TYPE_ERROR, NULL,
           "See the help for a description of the display filter syntax.",
@@ -1691,18 +2078,35 @@ cf_filter_packets(capture_file *cf, gchar *dftext, gboolean force)
     }
   }
 
+  /* If the new filter only narrows the one that's applied, only the frames
+     that are shown now need to be looked at. */
+  refine = dftext != NULL && cf->dfilter != NULL && frames_match_dfilter &&
+           !rescan_in_progress && dfilter_text_is_refinement(cf->dfilter, dftext);
+
   /* We have a valid filter.  Replace the current filter. */
   g_free(cf->dfilter);
   cf->dfilter = dftext;
   g_get_current_time(&start_time);
 
+  if (rescan_in_progress) {
+    /* We were called from the event loop while a scan is running; have
+       it start over with the new filter. */
+    rescan_restart = TRUE;
+    dfilter_free(dfcode);
+    return CF_OK;
+  }
 
   /* Now rescan the packet list, applying the new filter, but not
      throwing away information constructed on a previous pass. */
   if (dftext == NULL) {
     rescan_packets(cf, "Resetting", "Filter", FALSE);
   } else {
-    rescan_packets(cf, "Filtering", dftext, FALSE);
+    /* The filter text can be replaced while we're scanning. */
+    gchar *action_item = g_strdup(dftext);
+
+    rescan_refine = refine;
+    rescan_packets(cf, "Filtering", action_item, FALSE);
+    g_free(action_item);
   }
 
   /* Cleanup and release all dfilter resources */
@@ -1725,6 +2129,35 @@ cf_redissect_packets(capture_file *cf)
   }
 }
 
+/*
+ * If the frames are being read in order, as when scrolling through the
+ * packet list, read the next ones into the record cache as a batch
+ * before we get to them.
+ */
+static void
+cf_read_ahead(capture_file *cf, const frame_data *fdata)
+{
+  gint64      offsets[READ_AHEAD_COUNT];
+  guint       count = 0;
+  guint32     num;
+  frame_data *next;
+  gboolean    in_order = (fdata->num == cf->last_read + 1);
+
+  cf->last_read = fdata->num;
+  if (!in_order || fdata->num + READ_AHEAD_COUNT / 2 <= cf->read_ahead_to)
+    return;
+
+  for (num = MAX(fdata->num, cf->read_ahead_to) + 1;
+       num <= cf->count && count < READ_AHEAD_COUNT; num++) {
+    next = frame_data_sequence_find(cf->frames, num);
+    if (next == NULL || next->file_off == -1)
+      break;
+    offsets[count++] = next->file_off;
+  }
+  cf->read_ahead_to = num - 1;
+  wtap_seek_read_ahead(cf->wth, offsets, count);
+}
+
 gboolean
 cf_read_record_r(capture_file *cf, const frame_data *fdata,
                  struct wtap_pkthdr *phdr, Buffer *buf)
@@ -1770,6 +2203,7 @@ cf_read_record_r(capture_file *cf, const frame_data *fdata,
     g_free(display_basename);
     return FALSE;
   }
+  cf_read_ahead(cf, fdata);
   return TRUE;
 }
 
@@ -1815,7 +2249,16 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
   guint       tap_flags;
   gboolean    add_to_packet_list = FALSE;
   gboolean    compiled;
+  gboolean    do_dissection;
   guint32     frames_count;
+  gboolean    progressive = FALSE;
+  gboolean    refine;
+  gboolean    use_stored;
+
+  rescan_in_progress = TRUE;
+  rescan_restart = FALSE;
+  refine = rescan_refine && !redissect;
+  rescan_refine = FALSE;
 
   /* Compile the current display filter.
    * We assume this will not fail since cf->dfilter is only set in
@@ -1828,7 +2271,25 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
   tap_flags = union_of_tap_listener_flags();
   cinfo = (tap_flags & TL_REQUIRES_COLUMNS) ? &cf->cinfo : NULL;
   create_proto_tree =
-    (dfcode != NULL || have_filtering_tap_listeners() || (tap_flags & TL_REQUIRES_PROTO_TREE));
+    (dfcode != NULL || have_filtering_tap_listeners() || (tap_flags & TL_REQUIRES_PROTO_TREE) ||
+     (redissect && cf->field_store != NULL));
+
+  /* If we're not redissecting, have no display filter and nothing is
+     tapping the packets, every frame will be displayed and nothing will
+     look at the dissection results, so don't bother dissecting. */
+  do_dissection = redissect || dfcode != NULL || tap_listeners_require_dissection();
+
+  /* Tap listeners expect to see every frame, so we can only skip the
+     hidden ones if nothing is tapping. */
+  if (tap_listeners_require_dissection())
+    refine = FALSE;
+
+  /* The values in the field store, or the frame indexes the dissectors
+     keep (e.g. of the frames in each TCP stream), may be enough to tell
+     that a frame that's been dissected before doesn't pass the filter and
+     isn't wanted by any tap, as long as we're not redissecting. */
+  use_stored = dfcode != NULL && !redissect;
+  frames_match_dfilter = FALSE;
 
   reset_tap_listeners();
   /* Which frame, if any, is the currently selected frame?
@@ -1840,9 +2301,14 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
   /* Mark frame num as not found */
   selected_frame_num = -1;
 
-  /* Freeze the packet list while we redo it, so we don't get any
-     screen updates while it happens. */
-  packet_list_freeze();
+  /* When we're only filtering, show the frames that pass as we find them
+     if the packet list can do that.  Otherwise freeze the packet list
+     while we redo it, so we don't get any screen updates while it
+     happens. */
+  if (!redissect)
+    progressive = packet_list_begin_progressive_filter();
+  if (!progressive)
+    packet_list_freeze();
 
   if (redissect) {
     /* We need to re-initialize all the state information that protocols
@@ -1854,6 +2320,12 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
        want to dissect those before their time. */
     cf->redissecting = TRUE;
 
+    /* The dissectors might now come up with different field values. */
+    if (cf->field_store != NULL)
+      field_store_clear(cf->field_store);
+    if (cf->proto_stacks != NULL)
+      proto_stack_store_clear(cf->proto_stacks);
+
     /* 'reset' dissection session */
     epan_free(cf->epan);
     cf->epan = ws_epan_new(cf);
@@ -1871,6 +2343,7 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
 
   /* We currently don't display any packets */
   cf->displayed_count = 0;
+  tally_reset_displayed(cf);
 
   /* Iterate through the list of frames.  Call a routine for each frame
      to check whether it should be displayed and, if so, add it to
@@ -1934,6 +2407,8 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
       progbar_val = (gfloat) count / frames_count;
 
       if (progbar != NULL) {
+        if (progressive)
+          packet_list_update_progressive_filter(framenum - 1);
         g_snprintf(status_str, sizeof(status_str),
                   "%4u of %u frames", count, frames_count);
         update_progress_dlg(progbar, progbar_val, status_str);
@@ -1942,6 +2417,12 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
       progbar_nextstep += progbar_quantum;
     }
 
+    if (rescan_restart && !redissect) {
+      /* A new filter was applied while the progress dialog ran the event
+         loop; there is no point in finishing this one. */
+      break;
+    }
+
     if (stop_flag) {
       /* Well, the user decided to abort the filtering.  Just stop.
 
@@ -1972,7 +2453,29 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
     /* Frame dependencies from the previous dissection/filtering are no longer valid. */
     fdata->flags.dependent_of_displayed = 0;
 
-    if (!cf_read_record(cf, fdata))
+    if (!fdata->flags.ref_time &&
+        ((refine && !fdata->flags.passed_dfilter) ||
+         (use_stored && fdata->flags.visited &&
+          !dfilter_prefilter_stored(dfcode, cf->field_store, fdata->num,
+                                    fdata->pkt_len, fdata->cap_len) &&
+          !tap_listeners_prefilter_stored(cf->field_store, fdata->num,
+                                          fdata->pkt_len, fdata->cap_len)))) {
+      /* Either the old filter rejected this frame, so the new one will
+         too, or the recorded field values show that the new one does
+         and no tap wants it; all we have to do is keep the time stamps
+         of the following frames right. */
+      fdata->flags.passed_dfilter = 0;
+      frame_data_set_before_dissect(fdata, &cf->elapsed_time,
+                                    &cf->ref, cf->prev_dis);
+      cf->prev_cap = fdata;
+      if (fdata == selected_frame)
+        selected_frame_seen = TRUE;
+      prev_frame_num = fdata->num;
+      prev_frame = fdata;
+      continue;
+    }
+
+    if (do_dissection && !cf_read_record(cf, fdata))
       break; /* error reading the frame */
 
     /* If the previous frame is displayed, and we haven't yet seen the
@@ -1983,10 +2486,14 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
       preceding_frame = prev_frame;
     }
 
-    add_packet_to_packet_list(fdata, cf, &edt, dfcode,
-                                    cinfo, &cf->phdr,
-                                    ws_buffer_start_ptr(&cf->buf),
-                                    add_to_packet_list);
+    if (do_dissection) {
+      add_packet_to_packet_list(fdata, cf, &edt, dfcode,
+                                      cinfo, &cf->phdr,
+                                      ws_buffer_start_ptr(&cf->buf),
+                                      add_to_packet_list);
+    } else {
+      add_undissected_packet_to_packet_list(fdata, cf);
+    }
 
     /* If this frame is displayed, and this is the first frame we've
        seen displayed after the selected frame, remember this frame -
@@ -2010,6 +2517,16 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
 
   epan_dissect_cleanup(&edt);
 
+  /* If we got through all the frames, their passed_dfilter flags now
+     reflect the current filter. */
+  if (framenum > frames_count)
+    frames_match_dfilter = TRUE;
+  else {
+    /* Frames we didn't get to still have the old filter's flags, and
+       weren't counted. */
+    cf->frame_tally.valid = FALSE;
+  }
+
   /* We are done redissecting the packet list. */
   cf->redissecting = FALSE;
 
@@ -2042,7 +2559,8 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
   /* Compute the time it took to filter the file */
   compute_elapsed(cf, &start_time);
 
-  packet_list_thaw();
+  if (!progressive)
+    packet_list_thaw();
 
   if (selected_frame_num == -1) {
     /* The selected frame didn't pass the filter. */
@@ -2105,6 +2623,13 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
 
   /* Cleanup and release all dfilter resources */
   dfilter_free(dfcode);
+
+  rescan_in_progress = FALSE;
+  if (rescan_restart) {
+    /* Start over with the filter that was applied during this scan. */
+    rescan_restart = FALSE;
+    rescan_packets(cf, cf->dfilter ? "Filtering" : "Resetting", "Filter", FALSE);
+  }
 }
 
 
@@ -2404,6 +2929,51 @@ cf_retap_packets(capture_file *cf)
   return CF_READ_OK;
 }
 
+cf_read_status_t
+cf_retap_frames(capture_file *cf, const guint32 *frame_nums, guint num_frames)
+{
+  epan_dissect_t        edt;
+  column_info          *cinfo;
+  gboolean              construct_protocol_tree;
+  guint                 tap_flags;
+  guint                 i;
+  frame_data           *fdata;
+  cf_read_status_t      ret = CF_READ_OK;
+
+  /* Presumably the user closed the capture file. */
+  if (cf == NULL) {
+    return CF_READ_ABORTED;
+  }
+
+  tap_flags = union_of_tap_listener_flags();
+  construct_protocol_tree = have_filtering_tap_listeners() ||
+                            (tap_flags & TL_REQUIRES_PROTO_TREE);
+  cinfo = (tap_flags & TL_REQUIRES_COLUMNS) ? &cf->cinfo : NULL;
+
+  reset_tap_listeners();
+
+  epan_dissect_init(&edt, cf->epan, construct_protocol_tree, FALSE);
+
+  for (i = 0; i < num_frames; i++) {
+    fdata = frame_data_sequence_find(cf->frames, frame_nums[i]);
+    if (fdata == NULL)
+      continue;
+
+    if (!cf_read_record(cf, fdata)) {
+      /* cf_read_record() has reported the error */
+      ret = CF_READ_ERROR;
+      break;
+    }
+
+    epan_dissect_run_with_taps(&edt, cf->cd_t, &cf->phdr, frame_tvbuff_new_buffer(fdata, &cf->buf), fdata, cinfo);
+    epan_dissect_reset(&edt);
+  }
+
+  epan_dissect_cleanup(&edt);
+
+  return ret;
+}
+
 typedef struct {
   print_args_t *print_args;
   gboolean      print_header_line;
@@ -2743,28 +3313,155 @@ typedef struct {
   epan_dissect_t edt;
 } write_packet_callback_args_t;
 
+/*
+ * PDML, PSML and CSV exports.
+ *
+ * The packets still have to be dissected one at a time, in order, on
+ * this thread - dissectors keep state from one packet to the next, and
+ * the dissection engine isn't thread-safe - but they're formatted into
+ * chunks in memory rather than written as they're dissected, and a
+ * writer thread writes the chunks out, in order, while the next packets
+ * are dissected.  A few chunks are kept in flight; once they're all
+ * waiting to be written, dissection waits for the disk.
+ */
+#define EXPORT_CHUNK_SIZE   (256 * 1024)  /* hand a chunk over once it's this big */
+#define EXPORT_CHUNKS       8
+
+typedef struct {
+  FILE          *fh;
+  GString       *chunk;       /* the chunk being filled */
+  GAsyncQueue   *full;        /* chunks to write, then the writer itself to stop */
+  GAsyncQueue   *empty;       /* chunks that have been written */
+  GThread       *thread;
+  volatile gint  write_error; /* set by the writer thread */
+} export_writer_t;
+
+typedef struct {
+  export_writer_t writer;
+  epan_dissect_t  edt;
+} export_packet_callback_args_t;
+
+static gpointer
+export_write_thread(gpointer data)
+{
+  export_writer_t *writer = (export_writer_t *)data;
+  gpointer         item;
+  GString         *chunk;
+
+  while ((item = g_async_queue_pop(writer->full)) != writer) {
+    chunk = (GString *)item;
+    /* After an error, just hand the chunks back until we're stopped */
+    if (!g_atomic_int_get(&writer->write_error) &&
+        fwrite(chunk->str, 1, chunk->len, writer->fh) != chunk->len)
+      g_atomic_int_set(&writer->write_error, TRUE);
+    g_string_truncate(chunk, 0);
+    g_async_queue_push(writer->empty, chunk);
+  }
+  return NULL;
+}
+
+static void
+export_writer_start(export_writer_t *writer, FILE *fh)
+{
+  int i;
+
+#if !GLIB_CHECK_VERSION(2,31,0)
+  if (!g_thread_supported())
+    g_thread_init(NULL);
+#endif
+  writer->fh = fh;
+  writer->full = g_async_queue_new();
+  writer->empty = g_async_queue_new();
+  for (i = 0; i < EXPORT_CHUNKS; i++)
+    g_async_queue_push(writer->empty, g_string_sized_new(EXPORT_CHUNK_SIZE + 64 * 1024));
+  writer->chunk = (GString *)g_async_queue_pop(writer->empty);
+  writer->write_error = FALSE;
+#if GLIB_CHECK_VERSION(2,31,0)
+  writer->thread = g_thread_new("export writer", export_write_thread, writer);
+#else
+  writer->thread = g_thread_create(export_write_thread, writer, TRUE, NULL);
+#endif
+}
+
+/*
+ * A packet has been added to the current chunk; hand it over if it's
+ * full.  Returns FALSE if a write has failed.
+ */
+static gboolean
+export_writer_packet_done(export_writer_t *writer)
+{
+  if (writer->chunk->len >= EXPORT_CHUNK_SIZE) {
+    g_async_queue_push(writer->full, writer->chunk);
+    writer->chunk = (GString *)g_async_queue_pop(writer->empty);
+  }
+  return !g_atomic_int_get(&writer->write_error);
+}
+
+/*
+ * Write what's left, stop the writer thread and free the chunks.
+ * Returns FALSE if any write failed.
+ */
+static gboolean
+export_writer_finish(export_writer_t *writer)
+{
+  GString *chunk;
+
+  g_async_queue_push(writer->full, writer->chunk);
+  g_async_queue_push(writer->full, writer);
+  g_thread_join(writer->thread);
+
+  while ((chunk = (GString *)g_async_queue_try_pop(writer->empty)) != NULL)
+    g_string_free(chunk, TRUE);
+  g_async_queue_unref(writer->full);
+  g_async_queue_unref(writer->empty);
+  return !writer->write_error && !ferror(writer->fh);
+}
+
+/*
+ * Run the export: the preamble has been written to fh, the epan_dissect_t
+ * has been initialized, and the callback adds each packet to the current
+ * chunk of args->writer.
+ */
+static psp_return_t
+export_specified_records(capture_file *cf, print_args_t *print_args,
+                         const char *string1,
+                         gboolean (*callback)(capture_file *, frame_data *,
+                                              struct wtap_pkthdr *, const guint8 *, void *),
+                         export_packet_callback_args_t *args, FILE *fh)
+{
+  psp_return_t ret;
+
+  export_writer_start(&args->writer, fh);
+  ret = process_specified_records(cf, &print_args->range, string1,
+                                  "selected packets", TRUE,
+                                  callback, args);
+  if (!export_writer_finish(&args->writer))
+    ret = PSP_FAILED;
+  return ret;
+}
+
 static gboolean
 write_pdml_packet(capture_file *cf, frame_data *fdata,
                   struct wtap_pkthdr *phdr, const guint8 *pd,
           void *argsp)
 {
-  write_packet_callback_args_t *args = (write_packet_callback_args_t *)argsp;
+  export_packet_callback_args_t *args = (export_packet_callback_args_t *)argsp;
 
   /* Create the protocol tree, but don't fill in the column information. */
   epan_dissect_run(&args->edt, cf->cd_t, phdr, frame_tvbuff_new(fdata, pd), fdata, NULL);
 
-  /* Write out the information in that tree. */
-  write_pdml_proto_tree(&args->edt, args->fh);
+  /* Add the information in that tree to the chunk being written. */
+  write_pdml_proto_tree_buf(&args->edt, args->writer.chunk);
 
   epan_dissect_reset(&args->edt);
 
-  return !ferror(args->fh);
+  return export_writer_packet_done(&args->writer);
 }
 
 cf_print_status_t
 cf_write_pdml_packets(capture_file *cf, print_args_t *print_args)
 {
-  write_packet_callback_args_t callback_args;
+  export_packet_callback_args_t callback_args;
   FILE         *fh;
   psp_return_t  ret;
 
@@ -2778,14 +3475,12 @@ cf_write_pdml_packets(capture_file *cf, print_args_t *print_args)
     return CF_PRINT_WRITE_ERROR;
   }
 
-  callback_args.fh = fh;
   epan_dissect_init(&callback_args.edt, cf->epan, TRUE, TRUE);
 
   /* Iterate through the list of packets, printing the packets we were
      told to print. */
-  ret = process_specified_records(cf, &print_args->range, "Writing PDML",
-                                  "selected packets", TRUE,
-                                  write_pdml_packet, &callback_args);
+  ret = export_specified_records(cf, print_args, "Writing PDML",
+                                 write_pdml_packet, &callback_args, fh);
 
   epan_dissect_cleanup(&callback_args.edt);
 
@@ -2822,25 +3517,25 @@ write_psml_packet(capture_file *cf, frame_data *fdata,
                   struct wtap_pkthdr *phdr, const guint8 *pd,
           void *argsp)
 {
-  write_packet_callback_args_t *args = (write_packet_callback_args_t *)argsp;
+  export_packet_callback_args_t *args = (export_packet_callback_args_t *)argsp;
 
   /* Fill in the column information */
   col_custom_prime_edt(&args->edt, &cf->cinfo);
   epan_dissect_run(&args->edt, cf->cd_t, phdr, frame_tvbuff_new(fdata, pd), fdata, &cf->cinfo);
   epan_dissect_fill_in_columns(&args->edt, FALSE, TRUE);
 
-  /* Write out the column information. */
-  write_psml_columns(&args->edt, args->fh);
+  /* Add the column information to the chunk being written. */
+  write_psml_columns_buf(&args->edt, args->writer.chunk);
 
   epan_dissect_reset(&args->edt);
 
-  return !ferror(args->fh);
+  return export_writer_packet_done(&args->writer);
 }
 
 cf_print_status_t
 cf_write_psml_packets(capture_file *cf, print_args_t *print_args)
 {
-  write_packet_callback_args_t callback_args;
+  export_packet_callback_args_t callback_args;
   FILE         *fh;
   psp_return_t  ret;
 
@@ -2856,8 +3551,6 @@ cf_write_psml_packets(capture_file *cf, print_args_t *print_args)
     return CF_PRINT_WRITE_ERROR;
   }
 
-  callback_args.fh = fh;
-
   /* Fill in the column information, only create the protocol tree
      if having custom columns. */
   proto_tree_needed = have_custom_cols(&cf->cinfo);
@@ -2865,9 +3558,8 @@ cf_write_psml_packets(capture_file *cf, print_args_t *print_args)
 
   /* Iterate through the list of packets, printing the packets we were
      told to print. */
-  ret = process_specified_records(cf, &print_args->range, "Writing PSML",
-                                  "selected packets", TRUE,
-                                  write_psml_packet, &callback_args);
+  ret = export_specified_records(cf, print_args, "Writing PSML",
+                                 write_psml_packet, &callback_args, fh);
 
   epan_dissect_cleanup(&callback_args.edt);
 
@@ -2904,25 +3596,25 @@ write_csv_packet(capture_file *cf, frame_data *fdata,
                  struct wtap_pkthdr *phdr, const guint8 *pd,
                  void *argsp)
 {
-  write_packet_callback_args_t *args = (write_packet_callback_args_t *)argsp;
+  export_packet_callback_args_t *args = (export_packet_callback_args_t *)argsp;
 
   /* Fill in the column information */
   col_custom_prime_edt(&args->edt, &cf->cinfo);
   epan_dissect_run(&args->edt, cf->cd_t, phdr, frame_tvbuff_new(fdata, pd), fdata, &cf->cinfo);
   epan_dissect_fill_in_columns(&args->edt, FALSE, TRUE);
 
-  /* Write out the column information. */
-  write_csv_columns(&args->edt, args->fh);
+  /* Add the column information to the chunk being written. */
+  write_csv_columns_buf(&args->edt, args->writer.chunk);
 
   epan_dissect_reset(&args->edt);
 
-  return !ferror(args->fh);
+  return export_writer_packet_done(&args->writer);
 }
 
 cf_print_status_t
 cf_write_csv_packets(capture_file *cf, print_args_t *print_args)
 {
-  write_packet_callback_args_t callback_args;
+  export_packet_callback_args_t callback_args;
   gboolean        proto_tree_needed;
   FILE         *fh;
   psp_return_t  ret;
@@ -2937,17 +3629,14 @@ cf_write_csv_packets(capture_file *cf, print_args_t *print_args)
     return CF_PRINT_WRITE_ERROR;
   }
 
-  callback_args.fh = fh;
-
   /* only create the protocol tree if having custom columns. */
   proto_tree_needed = have_custom_cols(&cf->cinfo);
   epan_dissect_init(&callback_args.edt, cf->epan, proto_tree_needed, proto_tree_needed);
 
   /* Iterate through the list of packets, printing the packets we were
      told to print. */
-  ret = process_specified_records(cf, &print_args->range, "Writing CSV",
-                                  "selected packets", TRUE,
-                                  write_csv_packet, &callback_args);
+  ret = export_specified_records(cf, print_args, "Writing CSV",
+                                 write_csv_packet, &callback_args, fh);
 
   epan_dissect_cleanup(&callback_args.edt);
 
@@ -3311,6 +4000,7 @@ match_narrow(capture_file *cf, frame_data *fdata, void *criterion)
   guint32       i;
   guint8        c_char;
   size_t        c_match    = 0;
+  const guint8 *found;
 
   /* Load the frame's data. */
   if (!cf_read_record(cf, fdata)) {
@@ -3321,11 +4011,19 @@ match_narrow(capture_file *cf, frame_data *fdata, void *criterion)
   result = MR_NOTMATCHED;
   buf_len = fdata->cap_len;
   pd = ws_buffer_start_ptr(&cf->buf);
+  if (!cf->case_type) {
+    /* An exact match; let epan_memmem() skip ahead */
+    found = epan_memmem(pd, buf_len, ascii_text, (guint)textlen);
+    if (found != NULL) {
+      result = MR_MATCHED;
+      cf->search_pos = (guint32)(found - pd + textlen - 1); /* Save the position of the last character
+                                                               for highlighting the field. */
+    }
+    return result;
+  }
   i = 0;
   while (i < buf_len) {
-    c_char = pd[i];
-    if (cf->case_type)
-      c_char = toupper(c_char);
+    c_char = toupper(pd[i]);
     if (c_char == ascii_text[c_match]) {
       c_match += 1;
       if (c_match == textlen) {
@@ -3402,8 +4100,7 @@ match_binary(capture_file *cf, frame_data *fdata, void *criterion)
   match_result  result;
   guint32       buf_len;
   guint8       *pd;
-  guint32       i;
-  size_t        c_match     = 0;
+  const guint8 *found;
 
   /* Load the frame's data. */
   if (!cf_read_record(cf, fdata)) {
@@ -3414,23 +4111,11 @@ match_binary(capture_file *cf, frame_data *fdata, void *criterion)
   result = MR_NOTMATCHED;
   buf_len = fdata->cap_len;
   pd = ws_buffer_start_ptr(&cf->buf);
-  i = 0;
-  while (i < buf_len) {
-    if (pd[i] == binary_data[c_match]) {
-      c_match += 1;
-      if (c_match == datalen) {
-        result = MR_MATCHED;
-        cf->search_pos = i; /* Save the position of the last character
-                               for highlighting the field. */
-        break;
-      }
-    }
-    else {
-      g_assert(i>=c_match);
-      i -= (guint32)c_match;
-      c_match = 0;
-    }
-    i += 1;
+  found = epan_memmem(pd, buf_len, binary_data, (guint)datalen);
+  if (found != NULL) {
+    result = MR_MATCHED;
+    cf->search_pos = (guint32)(found - pd + datalen - 1); /* Save the position of the last character
+                                                             for highlighting the field. */
   }
   return result;
 }
@@ -3866,7 +4551,10 @@ void
 cf_mark_frame(capture_file *cf, frame_data *frame)
 {
   if (! frame->flags.marked) {
+    tally_displayed_frame(cf, frame, -1);
     frame->flags.marked = TRUE;
+    tally_displayed_frame(cf, frame, 1);
+    tally_marked_frame(cf, frame, 1);
     if (cf->count > cf->marked_count)
       cf->marked_count++;
   }
@@ -3879,9 +4567,23 @@ void
 cf_unmark_frame(capture_file *cf, frame_data *frame)
 {
   if (frame->flags.marked) {
+    frame_tally_t *ft = &cf->frame_tally;
+    double         t  = nstime_to_sec(&frame->abs_ts);
+
+    /* If this frame is at one end of the marked frames' time range,
+       the range shrinks, and we don't know how far. */
+    if (frame->flags.has_ts && (t == ft->marked_start || t == ft->marked_stop))
+      ft->marked_times_valid = FALSE;
+    tally_displayed_frame(cf, frame, -1);
+    tally_marked_frame(cf, frame, -1);
     frame->flags.marked = FALSE;
+    tally_displayed_frame(cf, frame, 1);
     if (cf->marked_count > 0)
       cf->marked_count--;
+    if (cf->marked_count == 0) {
+      ft->first_marked = 0;
+      ft->last_marked = 0;
+    }
   }
 }
 
@@ -3892,7 +4594,11 @@ void
 cf_ignore_frame(capture_file *cf, frame_data *frame)
 {
   if (! frame->flags.ignored) {
+    tally_displayed_frame(cf, frame, -1);
+    tally_marked_frame(cf, frame, -1);
     frame->flags.ignored = TRUE;
+    tally_displayed_frame(cf, frame, 1);
+    tally_marked_frame(cf, frame, 1);
     if (cf->count > cf->ignored_count)
       cf->ignored_count++;
   }
@@ -3905,7 +4611,11 @@ void
 cf_unignore_frame(capture_file *cf, frame_data *frame)
 {
   if (frame->flags.ignored) {
+    tally_displayed_frame(cf, frame, -1);
+    tally_marked_frame(cf, frame, -1);
     frame->flags.ignored = FALSE;
+    tally_displayed_frame(cf, frame, 1);
+    tally_marked_frame(cf, frame, 1);
     if (cf->ignored_count > 0)
       cf->ignored_count--;
   }
@@ -4273,6 +4983,12 @@ cf_can_write_with_wiretap(capture_file *cf)
 gboolean
 cf_can_save(capture_file *cf)
 {
+  if (cf->set_filenames != NULL) {
+    /* There's no one file to save it over; it can only be saved as a
+       new file. */
+    return FALSE;
+  }
+
   if (cf->unsaved_changes && wtap_dump_can_write(cf->linktypes, 0)) {
     /* Saved changes, and we can write it out with Wiretap. */
     return TRUE;
@@ -4395,6 +5111,10 @@ rescan_file(capture_file *cf, const char *fname, gboolean is_tempfile, int *err)
   /* Indicate whether it's a permanent or temporary file. */
   cf->is_tempfile = is_tempfile;
 
+  /* It's one file now, even if it was saved from a set of them. */
+  g_strfreev(cf->set_filenames);
+  cf->set_filenames = NULL;
+
   /* No user changes yet. */
   cf->unsaved_changes = FALSE;
 
@@ -5227,9 +5947,11 @@ cf_close_failure_alert_box(const char *filename, int err)
 /* Reload the current capture file. */
 void
 cf_reload(capture_file *cf) {
-  gchar    *filename;
-  gboolean  is_tempfile;
-  int       err;
+  gchar      *filename;
+  gchar     **set_filenames;
+  gboolean    is_tempfile;
+  cf_status_t status;
+  int         err;
 
   /* If the file could be opened, "cf_open()" calls "cf_close()"
      to get rid of state for the old capture file before filling in state
@@ -5244,7 +5966,15 @@ cf_reload(capture_file *cf) {
   filename = g_strdup(cf->filename);
   is_tempfile = cf->is_tempfile;
   cf->is_tempfile = FALSE;
-  if (cf_open(cf, filename, cf->open_type, is_tempfile, &err) == CF_OK) {
+  if (cf->set_filenames != NULL) {
+    /* Reopen the whole set; cf_close() frees the names. */
+    set_filenames = g_strdupv(cf->set_filenames);
+    status = cf_open_set(cf, g_strv_length(set_filenames),
+                         (const char *const *)set_filenames, cf->open_type, &err);
+    g_strfreev(set_filenames);
+  } else
+    status = cf_open(cf, filename, cf->open_type, is_tempfile, &err);
+  if (status == CF_OK) {
     switch (cf_read(cf, TRUE)) {
 
     case CF_READ_OK:
@@ -131,6 +131,21 @@ cf_callback_remove(cf_callback_t func, gpointer user_data);
  */
 cf_status_t cf_open(capture_file *cf, const char *fname, unsigned int type, gboolean is_tempfile, int *err);
 
+/**
+ * Open a set of capture files, such as the files of a ring buffer, as
+ * one capture, with the packets of all of them in time order.  The
+ * files aren't merged into a new file; cf->filename is the name of
+ * the first of them.
+ *
+ * @param cf the capture file to be opened
+ * @param count the number of files
+ * @param fnames their names
+ * @param type WTAP_TYPE_AUTO for automatic or index to direct open routine
+ * @param err error code
+ * @return one of cf_status_t
+ */
+cf_status_t cf_open_set(capture_file *cf, guint count, const char *const *fnames, unsigned int type, int *err);
+
 /**
  * Close a capture file.
  *
@@ -414,6 +429,18 @@ void cf_redissect_packets(capture_file *cf);
  */
 cf_read_status_t cf_retap_packets(capture_file *cf);
 
+/**
+ * Run the taps over the given frames only, in the order given, without a
+ * progress bar.  For tap users that already know which frames they want,
+ * such as a single TCP stream.
+ *
+ * @param cf the capture file
+ * @param frame_nums the numbers of the frames to dissect
+ * @param num_frames the number of entries in frame_nums
+ * @return one of cf_read_status_t
+ */
+cf_read_status_t cf_retap_frames(capture_file *cf, const guint32 *frame_nums, guint num_frames);
+
 /**
  * Adjust timestamp precision if auto is selected.
  *
@@ -639,6 +666,15 @@ void cf_ignore_frame(capture_file *cf, frame_data *frame);
  */
 void cf_unignore_frame(capture_file *cf, frame_data *frame);
 
+/**
+ * Bring the running totals in cf->frame_tally up to date.  This only
+ * has to look at the frames if something happened that the totals
+ * couldn't follow, such as a display filter scan being cut short.
+ *
+ * @param cf the capture file
+ */
+void cf_update_frame_tally(capture_file *cf);
+
 /**
  * Merge two (or more) capture files into one.
  * @todo is this the right place for this function? It doesn't have to do a lot with capture_file.
@@ -0,0 +1,195 @@
+/* packet_ring.c
+ * Rings that pass captured packets between threads without locking
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <config.h>
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "wiretap/wtap.h"
+
+#include "packet_ring.h"
+
+/* Packet data to allow for per packet when only a packet limit is given;
+   enough for a full-sized Ethernet frame. */
+#define PACKET_RING_BYTES_PER_PACKET    2048
+
+/* Packets to allow for per byte of packet data when only a byte limit is
+   given; no Ethernet frame is smaller than 64 bytes. */
+#define PACKET_RING_MIN_PACKET_SIZE     64
+
+typedef struct {
+    struct pcap_pkthdr phdr;
+    guint              offset;      /* of the packet data in ring->data */
+} packet_ring_slot;
+
+/*
+ * The slots and the packet data are both used circularly.  A packet's
+ * data is never split: if it runs past the end of the data area it goes
+ * on into a spare packet's worth of room after the end, and the next
+ * packet starts where it would have been had the area been circular.
+ * The bytes at the start of the area that the packet would have used are
+ * counted as in use until it's removed, so what's past the end can never
+ * run into a packet that's still in the ring.
+ *
+ * Each counter below is written by only one of the two threads and is
+ * read and written with g_atomic_int_get() and g_atomic_int_set(), which
+ * are full memory barriers.  The producer fills in a slot before it
+ * publishes the new packets_put, and the consumer is done with a slot
+ * before it publishes the new packets_got, so neither ever looks at a
+ * slot the other one owns.  The counters wrap; only their differences
+ * matter.
+ */
+struct packet_ring {
+    packet_ring_slot  *slots;
+    guint              num_slots;
+    u_char            *data;
+    guint              data_size;
+
+    /* producer */
+    guint              put_slot;
+    guint              put_offset;
+    volatile gint      packets_put;
+    volatile gint      bytes_put;
+
+    /* consumer */
+    guint              get_slot;
+    volatile gint      packets_got;
+    volatile gint      bytes_got;
+};
+
+packet_ring *
+packet_ring_new(guint max_packets, guint max_bytes)
+{
+    packet_ring *ring;
+
+    g_assert(max_packets != 0 || max_bytes != 0);
+    if (max_packets == 0)
+        max_packets = MAX(max_bytes / PACKET_RING_MIN_PACKET_SIZE, 1);
+    if (max_bytes == 0)
+        max_bytes = max_packets * PACKET_RING_BYTES_PER_PACKET;
+
+    ring = g_new0(packet_ring, 1);
+    ring->num_slots = max_packets;
+    ring->slots = g_new(packet_ring_slot, max_packets);
+    ring->data_size = max_bytes;
+    ring->data = (u_char *)g_malloc(max_bytes + WTAP_MAX_PACKET_SIZE);
+    return ring;
+}
+
+void
+packet_ring_free(packet_ring *ring)
+{
+    g_free(ring->data);
+    g_free(ring->slots);
+    g_free(ring);
+}
+
+gboolean
+packet_ring_put(packet_ring *ring, const struct pcap_pkthdr *phdr,
+                const u_char *pd)
+{
+    guint             packets_put = (guint)g_atomic_int_get(&ring->packets_put);
+    guint             bytes_put = (guint)g_atomic_int_get(&ring->bytes_put);
+    guint             bytes_used;
+    packet_ring_slot *slot;
+
+    if (phdr->caplen > WTAP_MAX_PACKET_SIZE)
+        return FALSE;
+    if (packets_put - (guint)g_atomic_int_get(&ring->packets_got) >= ring->num_slots)
+        return FALSE;
+    /* Like the old queue, let a packet bigger than the limit through if
+       the ring is otherwise empty. */
+    bytes_used = bytes_put - (guint)g_atomic_int_get(&ring->bytes_got);
+    if (bytes_used != 0 && bytes_used + phdr->caplen > ring->data_size)
+        return FALSE;
+
+    slot = &ring->slots[ring->put_slot];
+    slot->phdr = *phdr;
+    slot->offset = ring->put_offset;
+    memcpy(ring->data + ring->put_offset, pd, phdr->caplen);
+
+    ring->put_offset = (ring->put_offset + phdr->caplen) % ring->data_size;
+    if (++ring->put_slot == ring->num_slots)
+        ring->put_slot = 0;
+    g_atomic_int_set(&ring->bytes_put, (gint)(bytes_put + phdr->caplen));
+    g_atomic_int_set(&ring->packets_put, (gint)(packets_put + 1));
+    return TRUE;
+}
+
+guint
+packet_ring_get(packet_ring *ring, guint max_packets, pcap_handler cb,
+                u_char *user)
+{
+    guint             packets_got = (guint)g_atomic_int_get(&ring->packets_got);
+    guint             bytes_got = (guint)g_atomic_int_get(&ring->bytes_got);
+    guint             n, i;
+    packet_ring_slot *slot;
+
+    n = (guint)g_atomic_int_get(&ring->packets_put) - packets_got;
+    if (n > max_packets)
+        n = max_packets;
+    for (i = 0; i < n; i++) {
+        slot = &ring->slots[ring->get_slot];
+        cb(user, &slot->phdr, ring->data + slot->offset);
+        bytes_got += slot->phdr.caplen;
+        if (++ring->get_slot == ring->num_slots)
+            ring->get_slot = 0;
+    }
+    if (n != 0) {
+        g_atomic_int_set(&ring->bytes_got, (gint)bytes_got);
+        g_atomic_int_set(&ring->packets_got, (gint)(packets_got + n));
+    }
+    return n;
+}
+
+const struct pcap_pkthdr *
+packet_ring_peek(packet_ring *ring)
+{
+    if ((guint)g_atomic_int_get(&ring->packets_put) ==
+        (guint)g_atomic_int_get(&ring->packets_got))
+        return NULL;
+    return &ring->slots[ring->get_slot].phdr;
+}
+
+void
+packet_ring_fill(packet_ring *ring, guint *packets, guint *bytes)
+{
+    *packets = (guint)g_atomic_int_get(&ring->packets_put) -
+               (guint)g_atomic_int_get(&ring->packets_got);
+    *bytes = (guint)g_atomic_int_get(&ring->bytes_put) -
+             (guint)g_atomic_int_get(&ring->bytes_got);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
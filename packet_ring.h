@@ -0,0 +1,91 @@
+/* packet_ring.h
+ * Definitions for the rings that pass captured packets between threads
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __PACKET_RING_H__
+#define __PACKET_RING_H__
+
+#include <glib.h>
+#include <pcap.h>
+
+/*
+ * A packet ring hands packets from exactly one thread, the producer, to
+ * exactly one other thread, the consumer, without locking.  The packet
+ * headers and data are copied into space allocated when the ring is
+ * created, so nothing is allocated or freed per packet.
+ */
+typedef struct packet_ring packet_ring;
+
+/*
+ * Create a ring holding at most max_packets packets and max_bytes bytes
+ * of packet data.  A limit of 0 takes a default based on the other one;
+ * they can't both be 0.
+ */
+packet_ring *
+packet_ring_new(guint max_packets, guint max_bytes);
+
+void
+packet_ring_free(packet_ring *ring);
+
+/*
+ * Producer: copy a packet into the ring.  Returns FALSE, without copying
+ * it, if there isn't room for it.
+ */
+gboolean
+packet_ring_put(packet_ring *ring, const struct pcap_pkthdr *phdr,
+                const u_char *pd);
+
+/*
+ * Consumer: pass up to max_packets of the oldest packets in the ring to
+ * cb, in order, and then remove them.  Returns the number passed.
+ */
+guint
+packet_ring_get(packet_ring *ring, guint max_packets, pcap_handler cb,
+                u_char *user);
+
+/*
+ * Consumer: get the header of the oldest packet in the ring, without
+ * removing it.  Returns NULL if the ring is empty.
+ */
+const struct pcap_pkthdr *
+packet_ring_peek(packet_ring *ring);
+
+/*
+ * Get the number of packets and bytes of packet data in the ring.  Only
+ * a snapshot if called while the other thread is using the ring.
+ */
+void
+packet_ring_fill(packet_ring *ring, guint *packets, guint *bytes);
+
+#endif /* __PACKET_RING_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
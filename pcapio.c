@@ -47,12 +47,18 @@
 #ifdef HAVE_SYS_TIME_H
 #include <sys/time.h>
 #endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 #ifdef _WIN32
 #include <Windows.h>
+#include <io.h>
 #endif
 
 #include <glib.h>
 
+#include <wsutil/file_util.h>
+
 #include "pcapio.h"
 
 /* Magic numbers in "libpcap" files.
@@ -176,6 +182,76 @@ struct option {
 #define ISB_USRDELIV      8
 #define ADD_PADDING(x) ((((x) + 3) >> 2) << 2)
 
+/* Output buffers of the dump files opened with pcapio_fdopen(), by
+   stream; a file may be closed in a different thread from the one that
+   opened it. */
+static GHashTable *write_buffers;
+G_LOCK_DEFINE_STATIC(write_buffers);
+
+FILE *
+pcapio_fdopen(int fd, int *err)
+{
+        FILE *pfile;
+        char *buffer;
+
+        pfile = ws_fdopen(fd, "wb");
+        if (pfile == NULL) {
+                *err = errno;
+                return NULL;
+        }
+        buffer = (char *)g_malloc(PCAPIO_WRITE_BUFFER_SIZE);
+        if (setvbuf(pfile, buffer, _IOFBF, PCAPIO_WRITE_BUFFER_SIZE) != 0) {
+                /* Not fatal; the stream keeps its default buffer. */
+                g_free(buffer);
+                return pfile;
+        }
+        G_LOCK(write_buffers);
+        if (write_buffers == NULL)
+                write_buffers = g_hash_table_new(g_direct_hash, g_direct_equal);
+        g_hash_table_insert(write_buffers, pfile, buffer);
+        G_UNLOCK(write_buffers);
+        return pfile;
+}
+
+gboolean
+pcapio_sync(FILE* pfile, int *err)
+{
+        if (fflush(pfile) == EOF) {
+                *err = errno;
+                return FALSE;
+        }
+#ifdef _WIN32
+        if (_commit(_fileno(pfile)) == -1) {
+#else
+        if (fsync(fileno(pfile)) == -1) {
+#endif
+                *err = errno;
+                return FALSE;
+        }
+        return TRUE;
+}
+
+gboolean
+pcapio_close(FILE* pfile, int *err)
+{
+        gboolean  ok = TRUE;
+        char     *buffer = NULL;
+
+        /* fclose() flushes the buffer, so free it afterwards. */
+        if (fclose(pfile) == EOF) {
+                *err = errno;
+                ok = FALSE;
+        }
+        G_LOCK(write_buffers);
+        if (write_buffers != NULL) {
+                buffer = (char *)g_hash_table_lookup(write_buffers, pfile);
+                g_hash_table_remove(write_buffers, pfile);
+        }
+        G_UNLOCK(write_buffers);
+        g_free(buffer);
+        return ok;
+}
+
 /* Write to capture file */
 static gboolean
 write_to_file(FILE* pfile, const guint8* data, size_t data_length,
@@ -515,7 +591,9 @@ pcapng_write_enhanced_packet_block(FILE* pfile,
         guint32 block_total_length;
         guint64 timestamp;
         guint32 options_length;
-        const guint32 padding = 0;
+        /* padding, flags option, end of options and block length */
+        guint8 trailer[3 + 2 * sizeof(struct option) + 2 * sizeof(guint32)];
+        size_t trailer_length = 0;
 
         block_total_length = (guint32)(sizeof(struct epb) +
                                        ADD_PADDING(caplen) +
@@ -543,30 +621,43 @@ pcapng_write_enhanced_packet_block(FILE* pfile,
                 return FALSE;
         if (!write_to_file(pfile, pd, caplen, bytes_written, err))
                 return FALSE;
+
+        /* This is done for every packet, so everything after the packet
+           data is put together and written at once. */
         if (caplen % 4) {
-                if (!write_to_file(pfile, (const guint8*)&padding, 4 - caplen % 4, bytes_written, err))
+                trailer_length = 4 - caplen % 4;
+                memset(trailer, 0, trailer_length);
+        }
+        if (comment != NULL) {
+                /* Rare; write what we have so far and the comment. */
+                if (trailer_length != 0) {
+                        if (!write_to_file(pfile, trailer, trailer_length, bytes_written, err))
+                                return FALSE;
+                        trailer_length = 0;
+                }
+                if (!pcapng_write_string_option(pfile, OPT_COMMENT, comment,
+                                                bytes_written, err))
                         return FALSE;
         }
-        if (!pcapng_write_string_option(pfile, OPT_COMMENT, comment,
-                                        bytes_written, err))
-                return FALSE;
         if (flags != 0) {
                 option.type = EPB_FLAGS;
                 option.value_length = sizeof(guint32);
-                if (!write_to_file(pfile, (const guint8*)&option, sizeof(struct option), bytes_written, err))
-                        return FALSE;
-                if (!write_to_file(pfile, (const guint8*)&flags, sizeof(guint32), bytes_written, err))
-                        return FALSE;
+                memcpy(trailer + trailer_length, &option, sizeof(struct option));
+                trailer_length += sizeof(struct option);
+                memcpy(trailer + trailer_length, &flags, sizeof(guint32));
+                trailer_length += sizeof(guint32);
         }
         if (options_length != 0) {
-                /* write end of options */
+                /* end of options */
                 option.type = OPT_ENDOFOPT;
                 option.value_length = 0;
-                if (!write_to_file(pfile, (const guint8*)&option, sizeof(struct option), bytes_written, err))
-                        return FALSE;
+                memcpy(trailer + trailer_length, &option, sizeof(struct option));
+                trailer_length += sizeof(struct option);
         }
+        memcpy(trailer + trailer_length, &block_total_length, sizeof(guint32));
+        trailer_length += sizeof(guint32);
 
-       return write_to_file(pfile, (const guint8*)&block_total_length, sizeof(guint32), bytes_written, err);
+        return write_to_file(pfile, trailer, trailer_length, bytes_written, err);
 }
 
 gboolean
@@ -578,6 +669,8 @@ pcapng_write_interface_statistics_block(FILE* pfile,
                                         guint64 isb_endtime,   /* ISB_ENDTIME           3 */
                                         guint64 isb_ifrecv,    /* ISB_IFRECV            4 */
                                         guint64 isb_ifdrop,    /* ISB_IFDROP            5 */
+                                        guint64 isb_osdrop,    /* ISB_OSDROP            7 */
+                                        guint64 isb_usrdeliv,  /* ISB_USRDELIV          8 */
                                         int *err)
 {
         struct isb isb;
@@ -640,6 +733,14 @@ pcapng_write_interface_statistics_block(FILE* pfile,
                 options_length += (guint32)(sizeof(struct option) +
                                             sizeof(guint64));
         }
+        if (isb_osdrop != G_MAXUINT64) {
+                options_length += (guint32)(sizeof(struct option) +
+                                            sizeof(guint64));
+        }
+        if (isb_usrdeliv != G_MAXUINT64) {
+                options_length += (guint32)(sizeof(struct option) +
+                                            sizeof(guint64));
+        }
         /* OPT_COMMENT */
         options_length += pcapng_count_string_option(comment);
         if (isb_starttime !=0) {
@@ -719,6 +820,24 @@ pcapng_write_interface_statistics_block(FILE* pfile,
                 if (!write_to_file(pfile, (const guint8*)&isb_ifdrop, sizeof(guint64), bytes_written, err))
                         return FALSE;
         }
+        if (isb_osdrop != G_MAXUINT64) {
+                option.type = ISB_OSDROP;
+                option.value_length = sizeof(guint64);
+                if (!write_to_file(pfile, (const guint8*)&option, sizeof(struct option), bytes_written, err))
+                        return FALSE;
+
+                if (!write_to_file(pfile, (const guint8*)&isb_osdrop, sizeof(guint64), bytes_written, err))
+                        return FALSE;
+        }
+        if (isb_usrdeliv != G_MAXUINT64) {
+                option.type = ISB_USRDELIV;
+                option.value_length = sizeof(guint64);
+                if (!write_to_file(pfile, (const guint8*)&option, sizeof(struct option), bytes_written, err))
+                        return FALSE;
+
+                if (!write_to_file(pfile, (const guint8*)&isb_usrdeliv, sizeof(guint64), bytes_written, err))
+                        return FALSE;
+        }
         if (options_length != 0) {
                 /* write end of options */
                 option.type = OPT_ENDOFOPT;
@@ -23,6 +23,28 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+/* Opening and closing dump files */
+
+/* Size of the output buffer each dump file gets */
+#define PCAPIO_WRITE_BUFFER_SIZE (1024 * 1024)
+
+/** Open a dump file for writing on the file descriptor fd, with a
+   PCAPIO_WRITE_BUFFER_SIZE output buffer, so that the blocks written to
+   it reach the OS in large writes.
+   Returns the stream, or NULL with "*err" set to an error code. */
+extern FILE *
+pcapio_fdopen(int fd, int *err);
+
+/** Flush a dump file and ask the OS to write what it has of it to disk.
+   Returns TRUE on success, FALSE with "*err" set to an error code. */
+extern gboolean
+pcapio_sync(FILE* pfile, int *err);
+
+/** Close a dump file opened with pcapio_fdopen().
+   Returns TRUE on success, FALSE with "*err" set to an error code. */
+extern gboolean
+pcapio_close(FILE* pfile, int *err);
+
 /* Writing pcap files */
 
 /** Write the file header to a dump file.
@@ -88,6 +110,8 @@ pcapng_write_interface_statistics_block(FILE* pfile,
                                         guint64 isb_endtime,   /* ISB_ENDTIME           3 */
                                         guint64 isb_ifrecv,    /* ISB_IFRECV            4 */
                                         guint64 isb_ifdrop,    /* ISB_IFDROP            5 */
+                                        guint64 isb_osdrop,    /* ISB_OSDROP            7 */
+                                        guint64 isb_usrdeliv,  /* ISB_USRDELIV          8 */
                                         int *err);
 
 extern gboolean
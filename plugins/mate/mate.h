@@ -156,8 +156,8 @@ typedef struct _mate_cfg_gop {
 	gint ett_times;
 	gint ett_children;
 
-	GHashTable* gop_index;
-	GHashTable* gog_index;
+	GHashTable* gop_index; /* k=AVPL_Key v=gop */
+	GHashTable* gog_index; /* k=AVPL_Key v=gog */
 } mate_cfg_gop;
 
 
@@ -272,6 +272,9 @@ typedef struct _mate_runtime_data {
 
 	GHashTable* frames; /* k=frame.num v=pdus */
 
+	GPtrArray* released_gogs; /* gogs whose keys will be dropped once they expire */
+	guint next_sweep; /* frame at which to look for expired gogs again */
+
 } mate_runtime_data;
 
 typedef struct _mate_pdu mate_pdu;
@@ -306,6 +309,7 @@ struct _mate_gop {
 	mate_cfg_gop* cfg;
 
 	gchar* gop_key;
+	AVPL_Key* index_key; /* the key under which this gop is stored in the gops hash */
 	AVPL* avpl; /* the attributes of the pdu/gop/gog */
 	guint last_n;
 
@@ -339,6 +343,7 @@ struct _mate_gog {
 	guint last_n; /* the number of attributes the avpl had the last time we checked */
 
 	gboolean released; /* has this gop been released? */
+	gboolean sweeping; /* is it in the list of released gogs? */
 
 	float expiration; /* when will it expire after release (all gops releases if gog)? */
 	float idle_expiration; /* when will it expire if no new pdus are assigned to it */
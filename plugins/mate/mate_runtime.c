@@ -40,10 +40,13 @@ typedef struct _tmp_pdu_data {
 
 
 typedef struct _gogkey {
-	gchar* key;
+	AVPL_Key* key;
 	mate_cfg_gop* cfg;
 } gogkey;
 
+/* how many frames to analyze between looks for expired gogs */
+#define MATE_SWEEP_INTERVAL 1024
+
 
 static mate_runtime_data* rd = NULL;
 static mate_config* mc = NULL;
@@ -68,14 +71,16 @@ static gboolean destroy_mate_gops(gpointer k _U_, gpointer v, gpointer p _U_) {
 
 	if (gop->avpl) delete_avpl(gop->avpl,TRUE);
 
-	if (gop->gop_key) {
-		if (g_hash_table_lookup(gop->cfg->gop_index,gop->gop_key) == gop) {
-			g_hash_table_remove(gop->cfg->gop_index,gop->gop_key);
+	if (gop->index_key) {
+		if (g_hash_table_lookup(gop->cfg->gop_index,gop->index_key) == gop) {
+			g_hash_table_remove(gop->cfg->gop_index,gop->index_key);
 		}
 
-		g_free(gop->gop_key);
+		delete_avpl_key(gop->index_key);
 	}
 
+	g_free(gop->gop_key);
+
 	g_slice_free(mate_max_size,(mate_max_size*)gop);
 
 	return TRUE;
@@ -115,11 +120,11 @@ static void destroy_gops_in_cfg(gpointer k _U_, gpointer v, gpointer p _U_) {
 
 	g_hash_table_foreach_remove(c->gop_index,return_true,NULL);
 	g_hash_table_destroy(c->gop_index);
-	c->gop_index = g_hash_table_new(g_str_hash,g_str_equal);
+	c->gop_index = g_hash_table_new(avpl_key_hash,avpl_key_equal);
 
 	g_hash_table_foreach_remove(c->gog_index,return_true,NULL);
 	g_hash_table_destroy(c->gog_index);
-	c->gog_index = g_hash_table_new(g_str_hash,g_str_equal);
+	c->gog_index = g_hash_table_new(avpl_key_hash,avpl_key_equal);
 
 	g_hash_table_foreach_remove(c->items,destroy_mate_gops,NULL);
 	c->last_id = 0;
@@ -144,12 +149,15 @@ extern void initialize_mate_runtime(void) {
 			g_hash_table_foreach(mc->gogcfgs,destroy_gogs_in_cfg,NULL);
 
 			g_hash_table_destroy(rd->frames);
+			g_ptr_array_free(rd->released_gogs,TRUE);
 		}
 
 		rd->current_items = 0;
 		rd->now = -1.0f;
 		rd->highest_analyzed_frame = 0;
 		rd->frames = g_hash_table_new(g_direct_hash,g_direct_equal);
+		rd->released_gogs = g_ptr_array_new();
+		rd->next_sweep = MATE_SWEEP_INTERVAL;
 
 
 		/*mc->dbg_gop_lvl = 5;
@@ -169,15 +177,17 @@ extern void initialize_mate_runtime(void) {
 }
 
 
-static mate_gop* new_gop(mate_cfg_gop* cfg, mate_pdu* pdu, gchar* key) {
+static mate_gop* new_gop(mate_cfg_gop* cfg, mate_pdu* pdu, AVPL_Key* key) {
 	mate_gop* gop = (mate_gop*)g_slice_new(mate_max_size);
 
 	gop->id = ++(cfg->last_id);
 	gop->cfg = cfg;
 
-	dbg_print(dbg_gop, 1, dbg_facility, "new_gop: %s: ``%s:%d''", key, gop->cfg->name, gop->id);
+	gop->index_key = key;
+	gop->gop_key = avpl_key_to_str(key);
+
+	dbg_print(dbg_gop, 1, dbg_facility, "new_gop: %s: ``%s:%d''", gop->gop_key, gop->cfg->name, gop->id);
 
-	gop->gop_key = key;
 	gop->avpl = new_avpl(cfg->name);
 	gop->last_n = 0;
 
@@ -205,7 +215,7 @@ static mate_gop* new_gop(mate_cfg_gop* cfg, mate_pdu* pdu, gchar* key) {
 	pdu->is_start = TRUE;
 	pdu->time_in_gop = 0.0f;
 
-	g_hash_table_insert(cfg->gop_index,gop->gop_key,gop);
+	g_hash_table_replace(cfg->gop_index,gop->index_key,gop);
 	return gop;
 }
 
@@ -257,6 +267,7 @@ static mate_gog* new_gog(mate_cfg_gog* cfg, mate_gop* gop) {
 	gog->num_of_counting_gops = 0;
 	gog->num_of_released_gops = 0;
 
+	gog->sweeping = FALSE;
 	gog->gog_keys = g_ptr_array_new();
 
 	adopt_gop(gog,gop);
@@ -295,12 +306,54 @@ static void gog_remove_keys (mate_gog* gog) {
 			g_hash_table_remove(gog_key->cfg->gog_index,gog_key->key);
 		}
 
-		g_free(gog_key->key);
+		delete_avpl_key(gog_key->key);
 		g_free(gog_key);
 	}
 
 }
 
+/*
+ * Once a released gog has expired no new gop is going to be grouped into it,
+ * so its keys and those of its released gops can go away, otherwise the
+ * indexes would keep growing with every gog seen in the capture.
+ * The gops and gogs themselves stay, the tree still shows them.
+ */
+static void expire_gogs(void) {
+	mate_gog* gog;
+	mate_gop* gop;
+	guint i = 0;
+
+	while (i < rd->released_gogs->len) {
+		gog = (mate_gog *)g_ptr_array_index(rd->released_gogs,i);
+
+		if (gog->released && gog->expiration >= rd->now) {
+			i++;
+			continue;
+		}
+
+		if (gog->released) {
+			dbg_print (dbg_gog,2,dbg_facility,"expire_gogs: %s:%d has expired",gog->cfg->name,gog->id);
+
+			gog_remove_keys(gog);
+
+			for (gop = gog->gops; gop; gop = gop->next) {
+				if (gop->released && gop->index_key) {
+					if (g_hash_table_lookup(gop->cfg->gop_index,gop->index_key) == gop) {
+						g_hash_table_remove(gop->cfg->gop_index,gop->index_key);
+					}
+
+					delete_avpl_key(gop->index_key);
+					gop->index_key = NULL;
+				}
+			}
+		}
+
+		/* an unreleased gog gets back in the list when it gets released again */
+		gog->sweeping = FALSE;
+		g_ptr_array_remove_index_fast(rd->released_gogs,i);
+	}
+}
+
 static void reanalyze_gop(mate_gop* gop) {
 	LoAL* gog_keys = NULL;
 	AVPL* curr_gogkey = NULL;
@@ -337,13 +390,13 @@ static void reanalyze_gop(mate_gop* gop) {
 
 				gog_key = (gogkey *)g_malloc(sizeof(gogkey));
 
-				gog_key->key = avpl_to_str(gogkey_match);
+				gog_key->key = new_avpl_key(gogkey_match,TRUE);
 				delete_avpl(gogkey_match,FALSE);
 
 				gog_key->cfg = gop_cfg;
 
 				if (g_hash_table_lookup(gop_cfg->gog_index,gog_key->key)) {
-					g_free(gog_key->key);
+					delete_avpl_key(gog_key->key);
 					g_free(gog_key);
 					gog_key = NULL;
 				}
@@ -353,7 +406,7 @@ static void reanalyze_gop(mate_gop* gop) {
 							we should try to merge (non released) gogs
 					        that happen to have equal keys */
 				} else {
-					dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: new key for gog=%s:%d : %s",gog->cfg->name,gog->id,gog_key->key);
+					dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: new key for gog=%s:%d",gog->cfg->name,gog->id);
 					g_ptr_array_add(gog->gog_keys,gog_key);
 					g_hash_table_insert(gog_key->cfg->gog_index,gog_key->key,gog);
 				}
@@ -367,6 +420,11 @@ static void reanalyze_gop(mate_gop* gop) {
 	if (gog->num_of_released_gops == gog->num_of_counting_gops) {
 		gog->released =  TRUE;
 		gog->expiration = gog->cfg->expiration + rd->now;
+
+		if (! gog->sweeping) {
+			gog->sweeping = TRUE;
+			g_ptr_array_add(rd->released_gogs,gog);
+		}
 	} else {
 		gog->released =  FALSE;
 	}
@@ -379,7 +437,7 @@ static void analyze_gop(mate_gop* gop) {
 	void* cookie = NULL;
 	AVPL* gogkey_match = NULL;
 	mate_gog* gog = NULL;
-	gchar* key = NULL;
+	AVPL_Key* key = NULL;
 
 	if ( ! gop->gog  ) {
 		/* no gog, let's either find one or create it if due */
@@ -399,9 +457,9 @@ static void analyze_gop(mate_gop* gop) {
 		while (( curr_gogkey = get_next_avpl(gog_keys,&cookie) )) {
 			if (( gogkey_match = new_avpl_exact_match(gop->cfg->name,gop->avpl,curr_gogkey,TRUE) )) {
 
-				key = avpl_to_str(gogkey_match);
+				key = new_avpl_key(gogkey_match,FALSE);
 
-				dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: got gogkey_match: %s",key);
+				dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: got gogkey_match");
 
 				if (( gog = (mate_gog *)g_hash_table_lookup(gop->cfg->gog_index,key) )) {
 					dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: got already a matching gog");
@@ -445,10 +503,10 @@ static void analyze_gop(mate_gop* gop) {
 				g_assert_not_reached();
 			}
 
-			dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: no gogkey_match: %s",key);
+			dbg_print (dbg_gog,1,dbg_facility,"analyze_gop: no gogkey_match");
 		} /* while */
 
-		g_free(key);
+		if (key) delete_avpl_key(key);
 		key = NULL;
 
 		if (gogkey_match) delete_avpl(gogkey_match,TRUE);
@@ -466,8 +524,7 @@ static void analyze_pdu(mate_pdu* pdu) {
 	*/
 	mate_cfg_gop* cfg = NULL;
 	mate_gop* gop = NULL;
-	gchar* gop_key;
-	gchar* orig_gop_key = NULL;
+	AVPL_Key* gop_key;
 	AVPL* candidate_start = NULL;
 	AVPL* candidate_stop = NULL;
 	AVPL* is_start = NULL;
@@ -477,7 +534,8 @@ static void analyze_pdu(mate_pdu* pdu) {
 	AVPL* curr_gogkey = NULL;
 	void* cookie = NULL;
 	AVPL* gogkey_match = NULL;
-	gchar* gogkey_str = NULL;
+	AVPL_Key* gogkey = NULL;
+	gboolean has_gog;
 
 	dbg_print (dbg_gop,1,dbg_facility,"analyze_pdu: %s",pdu->cfg->name);
 
@@ -485,13 +543,11 @@ static void analyze_pdu(mate_pdu* pdu) {
 		return;
 
 	if ((gopkey_match = new_avpl_exact_match("gop_key_match",pdu->avpl,cfg->key, TRUE))) {
-		gop_key = avpl_to_str(gopkey_match);
-
-		g_hash_table_lookup_extended(cfg->gop_index,(gconstpointer)gop_key,(gpointer *)&orig_gop_key,(gpointer *)&gop);
+		gop_key = new_avpl_key(gopkey_match,FALSE);
+		gop = (mate_gop *)g_hash_table_lookup(cfg->gop_index,gop_key);
+		delete_avpl_key(gop_key);
 
 		if ( gop ) {
-			g_free(gop_key);
-
 			/* is the gop dead ? */
 			if ( ! gop->released &&
 				 ( ( gop->cfg->lifetime > 0.0 && gop->time_to_die >= rd->now) ||
@@ -504,9 +560,7 @@ static void analyze_pdu(mate_pdu* pdu) {
 
 			/* TODO: is the gop expired? */
 
-			gop_key = orig_gop_key;
-
-			dbg_print (dbg_gop,2,dbg_facility,"analyze_pdu: got gop: %s",gop_key);
+			dbg_print (dbg_gop,2,dbg_facility,"analyze_pdu: got gop: %s",gop->gop_key);
 
 			if (( candidate_start = cfg->start )) {
 
@@ -517,10 +571,10 @@ static void analyze_pdu(mate_pdu* pdu) {
 					if ( gop->released ) {
 						dbg_print (dbg_gop,3,dbg_facility,"analyze_pdu: start on released gop, let's create a new gop");
 
+						gop_key = gop->index_key;
 						g_hash_table_remove(cfg->gop_index,gop_key);
-						gop->gop_key = NULL;
+						gop->index_key = NULL;
 						gop = new_gop(cfg,pdu,gop_key);
-						g_hash_table_insert(cfg->gop_index,gop_key,gop);
 					} else {
 						dbg_print (dbg_gop,1,dbg_facility,"analyze_pdu: duplicate start on gop");
 					}
@@ -540,6 +594,9 @@ static void analyze_pdu(mate_pdu* pdu) {
 
 			dbg_print (dbg_gop,1,dbg_facility,"analyze_pdu: no gop already");
 
+			/* the key has to be taken before the extras get into gopkey_match */
+			gop_key = new_avpl_key(gopkey_match,TRUE);
+
 			if ( ! cfg->start ) {
 				/* there is no GopStart, we'll check for matching GogKeys
 				if we have one we'll create the Gop */
@@ -552,29 +609,26 @@ static void analyze_pdu(mate_pdu* pdu) {
 
 					while (( curr_gogkey = get_next_avpl(gog_keys,&cookie) )) {
 						if (( gogkey_match = new_avpl_exact_match(cfg->name,gopkey_match,curr_gogkey,FALSE) )) {
-							gogkey_str = avpl_to_str(gogkey_match);
+							gogkey = new_avpl_key(gogkey_match,FALSE);
+							has_gog = g_hash_table_lookup(cfg->gog_index,gogkey) != NULL;
+							delete_avpl_key(gogkey);
+							delete_avpl(gogkey_match,FALSE);
 
-							if (g_hash_table_lookup(cfg->gog_index,gogkey_str)) {
+							if (has_gog) {
 								gop = new_gop(cfg,pdu,gop_key);
-								g_hash_table_insert(cfg->gop_index,gop_key,gop);
-								delete_avpl(gogkey_match,FALSE);
-								g_free(gogkey_str);
 								break;
-							} else {
-								delete_avpl(gogkey_match,FALSE);
-								g_free(gogkey_str);
 							}
 						}
 					}
 
 					if ( ! gop ) {
-						g_free(gop_key);
+						delete_avpl_key(gop_key);
 						delete_avpl(gopkey_match,TRUE);
 						return;
 					}
 
 				} else {
-					g_free(gop_key);
+					delete_avpl_key(gop_key);
 					delete_avpl(gopkey_match,TRUE);
 					return;
 				}
@@ -586,7 +640,8 @@ static void analyze_pdu(mate_pdu* pdu) {
 					delete_avpl(is_start,FALSE);
 					gop = new_gop(cfg,pdu,gop_key);
 				} else {
-					g_free(gop_key);
+					delete_avpl_key(gop_key);
+					delete_avpl(gopkey_match,TRUE);
 					return;
 				}
 
@@ -910,6 +965,11 @@ extern void mate_analyze_frame(packet_info *pinfo, proto_tree* tree) {
 		}
 
 		rd->highest_analyzed_frame = pinfo->fd->num;
+
+		if (rd->highest_analyzed_frame >= rd->next_sweep) {
+			expire_gogs();
+			rd->next_sweep = rd->highest_analyzed_frame + MATE_SWEEP_INTERVAL;
+		}
 	}
 }
 
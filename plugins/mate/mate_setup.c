@@ -103,8 +103,8 @@ extern mate_cfg_gop* new_gopcfg(gchar* name) {
 
 	cfg->my_hfids = g_hash_table_new(g_str_hash,g_str_equal);
 
-	cfg->gop_index = g_hash_table_new(g_str_hash,g_str_equal);
-	cfg->gog_index = g_hash_table_new(g_str_hash,g_str_equal);
+	cfg->gop_index = g_hash_table_new(avpl_key_hash,avpl_key_equal);
+	cfg->gog_index = g_hash_table_new(avpl_key_hash,avpl_key_equal);
 
 	g_hash_table_insert(matecfg->gopcfgs,(gpointer) cfg->name, (gpointer) cfg);
 
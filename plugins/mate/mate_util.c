@@ -697,6 +697,113 @@ extern void delete_avpl(AVPL* avpl, gboolean avps_too) {
 	g_slice_free(any_avp_type,(any_avp_type*)avpl);
 }
 
+/**
+ * new_avpl_key:
+ * @param avpl the avpl for which to create the key.
+ * @param subscribe whether the key should hold its own references to the strings.
+ *
+ * Creates a key made of the interned names and values of the avps in an avpl,
+ * two avpls whose avps are equal have equal keys. A key that is not subscribed
+ * is only valid as long as the avps of the avpl live, it can be used for lookups
+ * but not to be stored in a table.
+ *
+ * Return value: a pointer to the newly created key.
+ *
+ **/
+extern AVPL_Key* new_avpl_key(AVPL* avpl, gboolean subscribe) {
+	AVPL_Key* key = (AVPL_Key*)g_malloc(sizeof(AVPL_Key));
+	AVPN* c;
+	guint i = 0;
+	guint h = avpl->len;
+
+	key->len = avpl->len;
+	key->subscribed = subscribe;
+	key->nv = (gchar**)g_malloc(sizeof(gchar*) * (avpl->len * 2 + 1));
+	key->ops = (gchar*)g_malloc(avpl->len + 1);
+
+	for(c=avpl->null.next; c->avp; c = c->next) {
+		if (subscribe) {
+			key->nv[i*2] = scs_subscribe(avp_strings, c->avp->n);
+			key->nv[i*2+1] = scs_subscribe(avp_strings, c->avp->v);
+		} else {
+			key->nv[i*2] = c->avp->n;
+			key->nv[i*2+1] = c->avp->v;
+		}
+
+		key->ops[i] = c->avp->o;
+
+		h = (h * 31) + g_direct_hash(key->nv[i*2]);
+		h = (h * 31) + g_direct_hash(key->nv[i*2+1]);
+		h = (h * 31) + (guint) key->ops[i];
+
+		i++;
+	}
+
+	key->nv[i*2] = NULL;
+	key->ops[i] = '\0';
+	key->hash = h;
+
+	return key;
+}
+
+/**
+ * avpl_key_to_str:
+ * @param key the key to represent.
+ *
+ * Creates a newly allocated string containing a representation of the avpl
+ * the key was created from.
+ *
+ * Return value: a pointer to the newly allocated string.
+ *
+ **/
+extern gchar* avpl_key_to_str(AVPL_Key* key) {
+	GString* s = g_string_new("");
+	guint i;
+
+	for (i = 0; i < key->len; i++) {
+		g_string_append_printf(s," %s%c%s;",key->nv[i*2],key->ops[i],key->nv[i*2+1]);
+	}
+
+	return g_string_free(s,FALSE);
+}
+
+/**
+ * delete_avpl_key:
+ * @param key the key to be deleted.
+ *
+ * Destroys an avpl key, releasing its strings if it holds them.
+ *
+ **/
+extern void delete_avpl_key(AVPL_Key* key) {
+	guint i;
+
+	if (key->subscribed) {
+		for (i = 0; i < key->len * 2; i++) {
+			scs_unsubscribe(avp_strings, key->nv[i]);
+		}
+	}
+
+	g_free(key->nv);
+	g_free(key->ops);
+	g_free(key);
+}
+
+extern guint avpl_key_hash(gconstpointer k) {
+	return ((const AVPL_Key*)k)->hash;
+}
+
+/* as the strings are interned comparing the pointers is enough */
+extern gboolean avpl_key_equal(gconstpointer a, gconstpointer b) {
+	const AVPL_Key* ka = (const AVPL_Key*)a;
+	const AVPL_Key* kb = (const AVPL_Key*)b;
+
+	if (ka->hash != kb->hash || ka->len != kb->len)
+		return FALSE;
+
+	return memcmp(ka->nv, kb->nv, sizeof(gchar*) * ka->len * 2) == 0
+		&& memcmp(ka->ops, kb->ops, ka->len) == 0;
+}
+
 
 
 /**
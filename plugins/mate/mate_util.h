@@ -89,6 +89,15 @@ typedef struct _avp_list {
 	AVPN null;
 } AVPL;
 
+/* an avpl key is a hashable snapshot of the interned names and values of an avpl */
+typedef struct _avpl_key {
+	guint hash;
+	guint len;
+	gboolean subscribed; /* whether it holds references to its strings */
+	gchar** nv; /* name, value, name, value... */
+	gchar* ops;
+} AVPL_Key;
+
 
 
 /* an avpl transformation operation */
@@ -236,6 +245,23 @@ extern gchar* avpl_to_dotstr(AVPL*);
 /* deletes an avp list  and eventually its contents */
 extern void delete_avpl(AVPL* avpl, gboolean avps_too);
 
+/*
+ * AVPL keys
+ */
+
+/* creates a key for an avpl, if subscribe is FALSE the key is only valid while the avpl lives */
+extern AVPL_Key* new_avpl_key(AVPL* avpl, gboolean subscribe);
+
+/* returns a newly allocated string with the same representation avpl_to_str gives the avpl */
+extern gchar* avpl_key_to_str(AVPL_Key* key);
+
+/* deletes an avpl key */
+extern void delete_avpl_key(AVPL_Key* key);
+
+/* GHashFunc and GEqualFunc for tables indexed by avpl keys */
+extern guint avpl_key_hash(gconstpointer k);
+extern gboolean avpl_key_equal(gconstpointer a, gconstpointer b);
+
 /*
  *  AVPL transformations
  */
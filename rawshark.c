@@ -147,6 +147,7 @@ static print_format_e print_format = PR_FMT_TEXT;
 static gboolean want_pcap_pkthdr;
 
 cf_status_t raw_cf_open(capture_file *cf, const char *fname);
+static ssize_t raw_pipe_fill(guchar *ptr, size_t len);
 static gboolean load_cap_file(capture_file *cf);
 static gboolean process_packet(capture_file *cf, epan_dissect_t *edt, gint64 offset,
                                struct wtap_pkthdr *whdr, const guchar *pd);
@@ -839,15 +840,10 @@ main(int argc, char *argv[])
 
         /* Do we need to PCAP header and magic? */
         if (skip_pcap_header) {
-            size_t bytes_left = sizeof(struct pcap_hdr) + sizeof(guint32);
-            gchar buf[sizeof(struct pcap_hdr) + sizeof(guint32)];
-            while (bytes_left != 0) {
-                ssize_t bytes = read(fd, buf, (int)bytes_left);
-                if (bytes <= 0) {
-                    cmdarg_err("Not enough bytes for pcap header.");
-                    exit(2);
-                }
-                bytes_left -= bytes;
+            guchar buf[sizeof(struct pcap_hdr) + sizeof(guint32)];
+            if (raw_pipe_fill(buf, sizeof buf) != (ssize_t)sizeof buf) {
+                cmdarg_err("Not enough bytes for pcap header.");
+                exit(2);
             }
         }
 
@@ -869,6 +865,50 @@ main(int argc, char *argv[])
     return 0;
 }
 
+/*
+ * Data read from the pipe but not consumed yet.  Reading the pipe in large
+ * chunks, rather than a record header or a packet at a time, takes far
+ * fewer system calls when records arrive faster than they're dissected;
+ * read() returns whatever is available, so a record never waits for the
+ * buffer to fill up.
+ */
+#define RAW_PIPE_BUFFER_SIZE (256 * 1024)
+static guchar raw_pipe_buf[RAW_PIPE_BUFFER_SIZE];
+static guchar *raw_pipe_buf_rp = raw_pipe_buf;
+static size_t raw_pipe_buf_len = 0;
+
+/**
+ * Copy data from the raw pipe, refilling the pipe buffer as needed.
+ * @param ptr [OUT] Where to put the data.
+ * @param len [IN] The number of bytes wanted.
+ * @return The number of bytes copied, which is less than len only at
+ *         the end of the input, or -1 on a read error, with errno set.
+ */
+static ssize_t
+raw_pipe_fill(guchar *ptr, size_t len) {
+    size_t copied = 0;
+    size_t chunk;
+
+    while (copied < len) {
+        if (raw_pipe_buf_len == 0) {
+            ssize_t bytes_read = read(fd, raw_pipe_buf, (int)RAW_PIPE_BUFFER_SIZE);
+            if (bytes_read < 0) {
+                return -1;
+            } else if (bytes_read == 0) {
+                break;
+            }
+            raw_pipe_buf_rp = raw_pipe_buf;
+            raw_pipe_buf_len = bytes_read;
+        }
+        chunk = MIN(len - copied, raw_pipe_buf_len);
+        memcpy(ptr + copied, raw_pipe_buf_rp, chunk);
+        raw_pipe_buf_rp += chunk;
+        raw_pipe_buf_len -= chunk;
+        copied += chunk;
+    }
+    return (ssize_t)copied;
+}
+
 /**
  * Read data from a raw pipe.  The "raw" data consists of a libpcap
  * packet header followed by the payload.
@@ -893,22 +933,17 @@ raw_pipe_read(struct wtap_pkthdr *phdr, guchar * pd, int *err, gchar **err_info,
         ptr = (guchar*) &mem_hdr;
     }
 
-    /* Copied from capture_loop.c */
-    while (bytes_needed > 0) {
-        bytes_read = read(fd, ptr, (int)bytes_needed);
-        if (bytes_read == 0) {
-            *err = 0;
-            *err_info = NULL;
-            return FALSE;
-        } else if (bytes_read < 0) {
-            *err = errno;
-            *err_info = NULL;
-            return FALSE;
-        }
-        bytes_needed -= bytes_read;
-        *data_offset += bytes_read;
-        ptr += bytes_read;
+    bytes_read = raw_pipe_fill(ptr, bytes_needed);
+    if (bytes_read < 0) {
+        *err = errno;
+        *err_info = NULL;
+        return FALSE;
+    } else if ((size_t)bytes_read < bytes_needed) {
+        *err = 0;
+        *err_info = NULL;
+        return FALSE;
     }
+    *data_offset += bytes_read;
 
     if (want_pcap_pkthdr) {
         phdr->ts.secs = mem_hdr.ts.tv_sec;
@@ -939,22 +974,17 @@ raw_pipe_read(struct wtap_pkthdr *phdr, guchar * pd, int *err, gchar **err_info,
         return FALSE;
     }
 
-    ptr = pd;
-    while (bytes_needed > 0) {
-        bytes_read = read(fd, ptr, (int)bytes_needed);
-        if (bytes_read == 0) {
-            *err = WTAP_ERR_SHORT_READ;
-            *err_info = NULL;
-            return FALSE;
-        } else if (bytes_read < 0) {
-            *err = errno;
-            *err_info = NULL;
-            return FALSE;
-        }
-        bytes_needed -= bytes_read;
-        *data_offset += bytes_read;
-        ptr += bytes_read;
+    bytes_read = raw_pipe_fill(pd, bytes_needed);
+    if (bytes_read < 0) {
+        *err = errno;
+        *err_info = NULL;
+        return FALSE;
+    } else if ((size_t)bytes_read < bytes_needed) {
+        *err = WTAP_ERR_SHORT_READ;
+        *err_info = NULL;
+        return FALSE;
     }
+    *data_offset += bytes_read;
     return TRUE;
 }
 
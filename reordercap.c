@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <glib.h>
 
 #ifdef HAVE_UNISTD_H
@@ -41,12 +42,14 @@
 #endif
 
 #include "wtap.h"
+#include "merge.h"
 
 #ifndef HAVE_GETOPT_LONG
 #include "wsutil/wsgetopt.h"
 #endif
 
 #include <wsutil/file_util.h>
+#include <wsutil/tempfile.h>
 #include <wsutil/crash_info.h>
 #include <wsutil/ws_version_info.h>
 
@@ -59,9 +62,20 @@ print_usage(FILE *output)
     fprintf(output, "\n");
     fprintf(output, "Options:\n");
     fprintf(output, "  -n        don't write to output file if the input file is ordered.\n");
+    fprintf(output, "  -w <frames>  sort in a single pass, holding at most <frames>\n");
+    fprintf(output, "               frames in memory; falls back to an external sort\n");
+    fprintf(output, "               if a frame is further out of place than that.\n");
+    fprintf(output, "  -c <frames>  sort externally, in sorted runs of <frames> frames\n");
+    fprintf(output, "               written to temporary files and then merged.\n");
     fprintf(output, "  -h        display this help and exit.\n");
 }
 
+/*
+ * Frames per run for the external sort, if a windowed sort has to fall
+ * back to one and no run size was given.
+ */
+#define DEFAULT_RUN_FRAMES  500000
+
 /* Remember where this frame was in the file */
 typedef struct FrameRecord_t {
     gint64       offset;
@@ -70,6 +84,18 @@ typedef struct FrameRecord_t {
     nstime_t     time;
 } FrameRecord_t;
 
+/* A copy of a whole frame, for the windowed and external sorts */
+typedef struct FrameCopy_t {
+    guint              num;
+    nstime_t           time;
+
+    struct wtap_pkthdr phdr;
+    guint8            *data;
+} FrameCopy_t;
+
+/* Temporary files holding the runs of an external sort */
+static GPtrArray *run_files = NULL;
+
 
 /**************************************************/
 /* Debugging only                                 */
@@ -85,6 +111,23 @@ typedef struct FrameRecord_t {
 /**************************************************/
 
 
+static void
+frame_dump(wtap_dumper *pdh, const struct wtap_pkthdr *phdr, const guint8 *pd)
+{
+    int    err;
+    gchar  *err_info;
+
+    if (!wtap_dump(pdh, phdr, pd, &err, &err_info)) {
+        fprintf(stderr, "reordercap: Error (%s) writing frame to outfile\n",
+                wtap_strerror(err));
+        if (err_info != NULL) {
+            fprintf(stderr, "(%s)\n", err_info);
+            g_free(err_info);
+        }
+        exit(1);
+    }
+}
+
 static void
 frame_write(FrameRecord_t *frame, wtap *wth, wtap_dumper *pdh,
             struct wtap_pkthdr *phdr, Buffer *buf, const char *infile)
@@ -117,15 +160,7 @@ frame_write(FrameRecord_t *frame, wtap *wth, wtap_dumper *pdh,
     phdr->ts = frame->time;
 
     /* Dump frame to outfile */
-    if (!wtap_dump(pdh, phdr, ws_buffer_start_ptr(buf), &err, &err_info)) {
-        fprintf(stderr, "reordercap: Error (%s) writing frame to outfile\n",
-                wtap_strerror(err));
-        if (err_info != NULL) {
-            fprintf(stderr, "(%s)\n", err_info);
-            g_free(err_info);
-        }
-        exit(1);
-    }
+    frame_dump(pdh, phdr, ws_buffer_start_ptr(buf));
 }
 
 /* Comparing timestamps between 2 frames.
@@ -145,6 +180,369 @@ frames_compare(gconstpointer a, gconstpointer b)
     return nstime_cmp(time1, time2);
 }
 
+/* Copy the frame that's just been read, so it can outlive the next read */
+static FrameCopy_t *
+frame_copy_new(wtap *wth, guint num)
+{
+    struct wtap_pkthdr *phdr = wtap_phdr(wth);
+    FrameCopy_t *frame = g_slice_new(FrameCopy_t);
+
+    frame->num = num;
+    if (phdr->presence_flags & WTAP_HAS_TS) {
+        frame->time = phdr->ts;
+    } else {
+        nstime_set_unset(&frame->time);
+    }
+    frame->phdr = *phdr;
+    frame->phdr.opt_comment = g_strdup(phdr->opt_comment);
+    ws_buffer_init(&frame->phdr.ft_specific_data,
+                   ws_buffer_length(&phdr->ft_specific_data));
+    ws_buffer_append(&frame->phdr.ft_specific_data,
+                     ws_buffer_start_ptr(&phdr->ft_specific_data),
+                     ws_buffer_length(&phdr->ft_specific_data));
+    frame->data = (guint8 *)g_memdup(wtap_buf_ptr(wth), phdr->caplen);
+    return frame;
+}
+
+static void
+frame_copy_free(FrameCopy_t *frame)
+{
+    g_free(frame->phdr.opt_comment);
+    wtap_phdr_cleanup(&frame->phdr);
+    g_free(frame->data);
+    g_slice_free(FrameCopy_t, frame);
+}
+
+/* As frames_compare(), but frames with the same time stamp stay in the
+   order in which they were read */
+static int
+frame_copy_cmp(const FrameCopy_t *frame1, const FrameCopy_t *frame2)
+{
+    int cmp = nstime_cmp(&frame1->time, &frame2->time);
+
+    if (cmp != 0)
+        return cmp;
+    return frame1->num < frame2->num ? -1 : frame1->num > frame2->num;
+}
+
+static int
+frame_copies_compare(gconstpointer a, gconstpointer b)
+{
+    return frame_copy_cmp(*(const FrameCopy_t *const *) a,
+                          *(const FrameCopy_t *const *) b);
+}
+
+/* Min-heap of frame copies, earliest first */
+static void
+frame_heap_push(GPtrArray *heap, FrameCopy_t *frame)
+{
+    guint i = heap->len;
+
+    g_ptr_array_add(heap, frame);
+    while (i > 0) {
+        guint parent = (i - 1) / 2;
+
+        if (frame_copy_cmp(frame, (FrameCopy_t *)heap->pdata[parent]) >= 0)
+            break;
+        heap->pdata[i] = heap->pdata[parent];
+        i = parent;
+    }
+    heap->pdata[i] = frame;
+}
+
+static FrameCopy_t *
+frame_heap_pop(GPtrArray *heap)
+{
+    FrameCopy_t *top = (FrameCopy_t *)heap->pdata[0];
+    FrameCopy_t *last = (FrameCopy_t *)heap->pdata[heap->len - 1];
+    guint i = 0;
+
+    g_ptr_array_set_size(heap, heap->len - 1);
+    if (heap->len == 0)
+        return top;
+    for (;;) {
+        guint child = 2 * i + 1;
+
+        if (child >= heap->len)
+            break;
+        if (child + 1 < heap->len &&
+            frame_copy_cmp((FrameCopy_t *)heap->pdata[child + 1],
+                           (FrameCopy_t *)heap->pdata[child]) < 0)
+            child++;
+        if (frame_copy_cmp(last, (FrameCopy_t *)heap->pdata[child]) <= 0)
+            break;
+        heap->pdata[i] = heap->pdata[child];
+        i = child;
+    }
+    heap->pdata[i] = last;
+    return top;
+}
+
+static void
+report_read_error(const char *infile, int err, gchar *err_info)
+{
+    /* Print a message noting that the read failed somewhere along the line. */
+    fprintf(stderr,
+            "reordercap: An error occurred while reading \"%s\": %s.\n",
+            infile, wtap_strerror(err));
+    if (err_info != NULL) {
+        fprintf(stderr, "(%s)\n", err_info);
+        g_free(err_info);
+    }
+}
+
+static wtap_dumper *
+open_outfile(const char *outfile, wtap *wth, wtapng_section_t *shb_hdr,
+             wtapng_iface_descriptions_t *idb_inf)
+{
+    wtap_dumper *pdh;
+    int err;
+
+    /* Open outfile (same filetype/encap as input file) */
+    pdh = wtap_dump_open_ng(outfile, wtap_file_type_subtype(wth), wtap_file_encap(wth),
+                            65535, FALSE, shb_hdr, idb_inf, &err);
+    if (pdh == NULL) {
+        fprintf(stderr, "reordercap: Failed to open output file: (%s) - error %s\n",
+                outfile, wtap_strerror(err));
+        exit(1);
+    }
+    return pdh;
+}
+
+/*
+ * Sort frames that are never more than "window" frames out of place in a
+ * single pass, holding just "window" frames in memory.  Returns FALSE if
+ * a frame turns up that is further out of place than that, in which case
+ * the output is incomplete and has to be redone some other way.
+ */
+static gboolean
+reorder_window(wtap *wth, wtap_dumper *pdh, guint window, const char *infile,
+               guint *frame_count, guint *wrong_order_count)
+{
+    GPtrArray *heap = g_ptr_array_sized_new(window + 1);
+    FrameCopy_t *frame;
+    nstime_t prev_time, last_written;
+    gboolean have_prev = FALSE, written = FALSE, in_window = TRUE;
+    int err;
+    gchar *err_info;
+    gint64 data_offset;
+
+    while (wtap_read(wth, &err, &err_info, &data_offset)) {
+        frame = frame_copy_new(wth, ++*frame_count);
+
+        if (have_prev && nstime_cmp(&frame->time, &prev_time) < 0) {
+            (*wrong_order_count)++;
+        }
+        prev_time = frame->time;
+        have_prev = TRUE;
+
+        if (written && nstime_cmp(&frame->time, &last_written) < 0) {
+            /* It belongs before something we've already written. */
+            frame_copy_free(frame);
+            in_window = FALSE;
+            break;
+        }
+
+        frame_heap_push(heap, frame);
+        if (heap->len > window) {
+            frame = frame_heap_pop(heap);
+            frame_dump(pdh, &frame->phdr, frame->data);
+            last_written = frame->time;
+            written = TRUE;
+            frame_copy_free(frame);
+        }
+    }
+    if (in_window && err != 0) {
+        report_read_error(infile, err, err_info);
+    }
+
+    /* Write out, or throw away, what's left in the window */
+    while (heap->len > 0) {
+        frame = frame_heap_pop(heap);
+        if (in_window) {
+            frame_dump(pdh, &frame->phdr, frame->data);
+        }
+        frame_copy_free(frame);
+    }
+    g_ptr_array_free(heap, TRUE);
+
+    return in_window;
+}
+
+static void
+remove_run_files(void)
+{
+    guint i;
+
+    if (run_files == NULL)
+        return;
+    for (i = 0; i < run_files->len; i++) {
+        ws_unlink((const char *)run_files->pdata[i]);
+        g_free(run_files->pdata[i]);
+    }
+    g_ptr_array_set_size(run_files, 0);
+}
+
+/* Write a sorted run, and free its frames */
+static void
+run_write(GPtrArray *run, wtap_dumper *pdh)
+{
+    guint i;
+
+    for (i = 0; i < run->len; i++) {
+        FrameCopy_t *frame = (FrameCopy_t *)run->pdata[i];
+
+        frame_dump(pdh, &frame->phdr, frame->data);
+        frame_copy_free(frame);
+    }
+    g_ptr_array_set_size(run, 0);
+}
+
+/* Merge the sorted runs in run_files into the output file */
+static void
+runs_merge(wtap_dumper *pdh)
+{
+    int count = (int)run_files->len;
+    char **names = g_new(char *, count);
+    merge_in_file_t *in_files, *in_file;
+    int i, err, err_fileno;
+    gchar *err_info;
+
+    /*
+     * The merge takes frames with the same time stamp from later files
+     * first, so give it the runs in reverse order; that way such frames
+     * stay in the order in which they were read.
+     */
+    for (i = 0; i < count; i++)
+        names[i] = (char *)run_files->pdata[count - 1 - i];
+
+    if (!merge_open_in_files(count, names, &in_files, &err, &err_info,
+                             &err_fileno)) {
+        fprintf(stderr, "reordercap: Can't open temporary file %s: %s\n",
+                names[err_fileno], wtap_strerror(err));
+        if (err_info != NULL) {
+            fprintf(stderr, "(%s)\n", err_info);
+            g_free(err_info);
+        }
+        exit(1);
+    }
+
+    while ((in_file = merge_read_packet(count, in_files, &err, &err_info)) != NULL) {
+        if (err != 0) {
+            report_read_error(in_file->filename, err, err_info);
+            exit(1);
+        }
+        frame_dump(pdh, wtap_phdr(in_file->wth), wtap_buf_ptr(in_file->wth));
+    }
+
+    merge_close_in_files(count, in_files);
+    g_free(in_files);
+    g_free(names);
+}
+
+/*
+ * Sort frames in any order with an external merge sort: read them in
+ * runs of "run_frames" frames, sort each run in memory and write it to a
+ * temporary file, then merge the runs.  The input, the runs and the
+ * output are all read and written sequentially.
+ */
+static void
+reorder_external(wtap *wth, wtap_dumper *pdh, guint run_frames,
+                 wtapng_section_t *shb_hdr, wtapng_iface_descriptions_t *idb_inf,
+                 const char *infile, guint *frame_count, guint *wrong_order_count)
+{
+    GPtrArray *run = g_ptr_array_new();
+    FrameCopy_t *frame;
+    nstime_t prev_time;
+    gboolean have_prev = FALSE, more = TRUE;
+    int err;
+    gchar *err_info;
+    gint64 data_offset;
+
+    if (run_files == NULL) {
+        run_files = g_ptr_array_new();
+        atexit(remove_run_files);
+    }
+
+    while (more) {
+        char *tmpname;
+        int fd;
+        wtap_dumper *run_pdh;
+
+        /* Read the next run */
+        while ((more = wtap_read(wth, &err, &err_info, &data_offset))) {
+            frame = frame_copy_new(wth, ++*frame_count);
+            if (have_prev && nstime_cmp(&frame->time, &prev_time) < 0) {
+                (*wrong_order_count)++;
+            }
+            prev_time = frame->time;
+            have_prev = TRUE;
+
+            g_ptr_array_add(run, frame);
+            if (run->len == run_frames)
+                break;
+        }
+        if (!more && err != 0) {
+            report_read_error(infile, err, err_info);
+        }
+        if (run->len == 0)
+            break;
+
+        g_ptr_array_sort(run, frame_copies_compare);
+
+        if (!more && run_files->len == 0) {
+            /* It all fitted in one run, so just write it out. */
+            run_write(run, pdh);
+            break;
+        }
+
+        fd = create_tempfile(&tmpname, "reordercap_");
+        if (fd < 0) {
+            fprintf(stderr, "reordercap: Couldn't create temporary file: %s\n",
+                    g_strerror(errno));
+            exit(1);
+        }
+        g_ptr_array_add(run_files, g_strdup(tmpname));
+        run_pdh = wtap_dump_fdopen_ng(fd, wtap_file_type_subtype(wth),
+                                      wtap_file_encap(wth), 65535, FALSE,
+                                      shb_hdr, idb_inf, &err);
+        if (run_pdh == NULL) {
+            fprintf(stderr, "reordercap: Failed to open temporary file: (%s) - error %s\n",
+                    tmpname, wtap_strerror(err));
+            exit(1);
+        }
+        run_write(run, run_pdh);
+        if (!wtap_dump_close(run_pdh, &err)) {
+            fprintf(stderr, "reordercap: Error closing %s: %s\n", tmpname,
+                    wtap_strerror(err));
+            exit(1);
+        }
+    }
+    g_ptr_array_free(run, TRUE);
+
+    if (run_files->len > 0) {
+        runs_merge(pdh);
+        remove_run_files();
+    }
+}
+
+static guint
+get_frame_count(const char *string, const char *name)
+{
+    char *p;
+    unsigned long number;
+
+    errno = 0;
+    number = strtoul(string, &p, 10);
+    if (p == string || *p != '\0' || errno != 0 || number == 0 ||
+        number > G_MAXUINT / 2) {
+        fprintf(stderr, "reordercap: The %s \"%s\" is not a valid number of frames\n",
+                name, string);
+        exit(1);
+    }
+    return (guint)number;
+}
+
 static void
 get_reordercap_compiled_info(GString *str)
 {
@@ -188,7 +586,10 @@ main(int argc, char *argv[])
     gint64 data_offset;
     const struct wtap_pkthdr *phdr;
     guint wrong_order_count = 0;
+    guint frame_count = 0;
     gboolean write_output_regardless = TRUE;
+    guint window = 0;
+    guint run_frames = 0;
     guint i;
     wtapng_section_t            *shb_hdr;
     wtapng_iface_descriptions_t *idb_inf;
@@ -221,11 +622,17 @@ main(int argc, char *argv[])
       get_ws_vcs_version_info(), comp_info_str->str, runtime_info_str->str);
 
     /* Process the options first */
-    while ((opt = getopt_long(argc, argv, "hnv", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "c:hnvw:", long_options, NULL)) != -1) {
         switch (opt) {
+            case 'c':
+                run_frames = get_frame_count(optarg, "run size");
+                break;
             case 'n':
                 write_output_regardless = FALSE;
                 break;
+            case 'w':
+                window = get_frame_count(optarg, "window size");
+                break;
             case 'h':
                 printf("Reordercap (Wireshark) %s\n"
                        "Reorder timestamps of input file frames into output file.\n"
@@ -258,7 +665,8 @@ main(int argc, char *argv[])
     /* Open infile */
     /* TODO: if reordercap is ever changed to give the user a choice of which
        open_routine reader to use, then the following needs to change. */
-    wth = wtap_open_offline(infile, WTAP_TYPE_AUTO, &err, &err_info, TRUE);
+    wth = wtap_open_offline(infile, WTAP_TYPE_AUTO, &err, &err_info,
+                            window == 0 && run_frames == 0);
     if (wth == NULL) {
         fprintf(stderr, "reordercap: Can't open %s: %s\n", infile,
                 wtap_strerror(err));
@@ -273,15 +681,62 @@ main(int argc, char *argv[])
     shb_hdr = wtap_file_get_shb_info(wth);
     idb_inf = wtap_file_get_idb_info(wth);
 
-    /* Open outfile (same filetype/encap as input file) */
-    pdh = wtap_dump_open_ng(outfile, wtap_file_type_subtype(wth), wtap_file_encap(wth),
-                            65535, FALSE, shb_hdr, idb_inf, &err);
-    g_free(idb_inf);
-    if (pdh == NULL) {
-        fprintf(stderr, "reordercap: Failed to open output file: (%s) - error %s\n",
-                outfile, wtap_strerror(err));
-        g_free(shb_hdr);
-        exit(1);
+    pdh = open_outfile(outfile, wth, shb_hdr, idb_inf);
+
+    if (window > 0 || run_frames > 0) {
+        /*
+         * Sort without seeking around in the input file, holding a
+         * bounded number of frames in memory.
+         */
+        if (window > 0 &&
+            !reorder_window(wth, pdh, window, infile, &frame_count,
+                            &wrong_order_count)) {
+            if (strcmp(infile, "-") == 0) {
+                fprintf(stderr, "reordercap: Frames are more than %u out of place, and the standard input can't be reread\n",
+                        window);
+                exit(1);
+            }
+            printf("Frames are more than %u out of place; doing an external sort\n",
+                   window);
+
+            /* Start again from the beginning */
+            wtap_close(wth);
+            wth = wtap_open_offline(infile, WTAP_TYPE_AUTO, &err, &err_info, FALSE);
+            if (wth == NULL) {
+                fprintf(stderr, "reordercap: Can't reopen %s: %s\n", infile,
+                        wtap_strerror(err));
+                if (err_info != NULL) {
+                    fprintf(stderr, "(%s)\n", err_info);
+                    g_free(err_info);
+                }
+                exit(1);
+            }
+            wtap_dump_close(pdh, &err);
+            g_free(idb_inf);
+            g_free(shb_hdr);
+            shb_hdr = wtap_file_get_shb_info(wth);
+            idb_inf = wtap_file_get_idb_info(wth);
+            pdh = open_outfile(outfile, wth, shb_hdr, idb_inf);
+            frame_count = 0;
+            wrong_order_count = 0;
+            if (run_frames == 0)
+                run_frames = MAX(window, DEFAULT_RUN_FRAMES);
+            reorder_external(wth, pdh, run_frames, shb_hdr, idb_inf, infile,
+                             &frame_count, &wrong_order_count);
+        } else if (window == 0) {
+            reorder_external(wth, pdh, run_frames, shb_hdr, idb_inf, infile,
+                             &frame_count, &wrong_order_count);
+        }
+
+        printf("%u frames, %u out of order\n", frame_count, wrong_order_count);
+
+        if (!write_output_regardless && (wrong_order_count == 0)) {
+            /* We've written it already; start the output file again. */
+            wtap_dump_close(pdh, &err);
+            pdh = open_outfile(outfile, wth, shb_hdr, idb_inf);
+            printf("Not writing output file because input file is already in order!\n");
+        }
+        goto close_outfile;
     }
 
     /* Allocate the array of frame pointers. */
@@ -310,14 +765,7 @@ main(int argc, char *argv[])
         prevFrame = newFrameRecord;
     }
     if (err != 0) {
-      /* Print a message noting that the read failed somewhere along the line. */
-      fprintf(stderr,
-              "reordercap: An error occurred while reading \"%s\": %s.\n",
-              infile, wtap_strerror(err));
-      if (err_info != NULL) {
-          fprintf(stderr, "(%s)\n", err_info);
-          g_free(err_info);
-      }
+      report_read_error(infile, err, err_info);
     }
 
     printf("%u frames, %u out of order\n", frames->len, wrong_order_count);
@@ -349,13 +797,16 @@ main(int argc, char *argv[])
     /* Free the whole array */
     g_ptr_array_free(frames, TRUE);
 
+close_outfile:
     /* Close outfile */
     if (!wtap_dump_close(pdh, &err)) {
         fprintf(stderr, "reordercap: Error closing %s: %s\n", outfile,
                 wtap_strerror(err));
+        g_free(idb_inf);
         g_free(shb_hdr);
         exit(1);
     }
+    g_free(idb_inf);
     g_free(shb_hdr);
 
     /* Finally, close infile */
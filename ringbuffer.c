@@ -38,6 +38,15 @@
  * the files at switch and not the capture stop, and by closing them which
  * makes possible their move or deletion after a switch).
  *
+ * Switching files is kept off the capture path: a background thread
+ * closes (and, if asked to, syncs) the old file, deletes the file that
+ * drops out of the ring, and creates and preallocates the file to be
+ * switched to next under a temporary name.  The switch itself only
+ * renames that file and starts writing to it.
+ *
+ * Optionally, each file is also compressed once it's finished, and/or
+ * given a frame index sidecar, by a pool of threads.
+ *
  */
 
 #include <config.h>
@@ -61,7 +70,16 @@
 
 #include <glib.h>
 
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
 #include "ringbuffer.h"
+#include "pcapio.h"
+#include "wiretap/frame_index.h"
 #include <wsutil/file_util.h>
 
 
@@ -70,6 +88,24 @@ typedef struct _rb_file {
   gchar         *name;
 } rb_file;
 
+/*
+ * Windows can't rename a file that's open, so there the next file isn't
+ * created in advance.
+ */
+#ifndef _WIN32
+#define RINGBUF_PREPARE_NEXT
+#endif
+
+/* Work for the background thread */
+typedef struct _rb_job {
+  FILE         *pdh;                 /* file to close, or NULL */
+  gchar        *pdh_name;            /* its name, if it's to be post-processed */
+  wtap_frame_index *fidx;            /* its frame index, or NULL */
+  gchar        *unlink_name;         /* file to delete, or NULL */
+  gboolean      prepare;             /* TRUE to create the next file */
+  gboolean      stop;                /* TRUE to end the thread */
+} rb_job;
+
 /* Ringbuffer data structure */
 typedef struct _ringbuf_data {
   rb_file      *files;
@@ -82,20 +118,64 @@ typedef struct _ringbuf_data {
   int           fd;                  /* Current ringbuffer file descriptor */
   FILE         *pdh;
   gboolean      group_read_access;   /* TRUE if files need to be opened with group read access */
+  guint64       file_size;           /* Size to preallocate files to, or 0 */
+  gboolean      sync_on_close;       /* TRUE if files are synced to disk before closing */
+
+  GThread      *worker;              /* Background thread, or NULL */
+  GAsyncQueue  *jobs;                /* rb_job's for it */
+  GAsyncQueue  *prepared;            /* Pointers to the file descriptors of next files */
+  gboolean      next_pending;        /* TRUE if a next file has been asked for */
+  gchar        *next_name;           /* Temporary name of the next file */
+  volatile gint worker_err;          /* First error the background thread got */
+
+  GThreadPool  *post_pool;           /* Threads post-processing finished files, or NULL */
+  wtap_frame_index *fidx;            /* Frame index of the current file, or NULL */
 } ringbuf_data;
 
 static ringbuf_data rb_data;
 
+/* What to do with finished files; kept across ringbuf_init() calls */
+static struct {
+  ringbuf_compression compression;
+  gboolean      frame_index;
+  int           file_type_subtype;
+  guint         num_threads;
+} rb_post = { RINGBUF_COMPRESS_NONE, FALSE, WTAP_FILE_TYPE_SUBTYPE_UNKNOWN, 1 };
+
+/* A finished file to post-process */
+typedef struct _rb_finished {
+  gchar        *name;
+  wtap_frame_index *fidx;            /* or NULL */
+} rb_finished;
+
+#define RINGBUF_COPY_BUFFER_SIZE (64 * 1024)
+
 
 /*
- * create the next filename and open a new binary file with that name
+ * create the filename for the current file number and time
  */
-static int ringbuf_open_file(rb_file *rfile, int *err)
+static gchar *ringbuf_file_name(void)
 {
   char    filenum[5+1];
   char    timestr[14+1];
   time_t  current_time;
 
+#ifdef _WIN32
+  _tzset();
+#endif
+  current_time = time(NULL);
+
+  g_snprintf(filenum, sizeof(filenum), "%05u", (rb_data.curr_file_num + 1) % RINGBUFFER_MAX_NUM_FILES);
+  strftime(timestr, sizeof(timestr), "%Y%m%d%H%M%S", localtime(&current_time));
+  return g_strconcat(rb_data.fprefix, "_", filenum, "_", timestr,
+                     rb_data.fsuffix, NULL);
+}
+
+/*
+ * create the next filename and open a new binary file with that name
+ */
+static int ringbuf_open_file(rb_file *rfile, int *err)
+{
   if (rfile->name != NULL) {
     if (rb_data.unlimited == FALSE) {
       /* remove old file (if any, so ignore error) */
@@ -104,15 +184,7 @@ static int ringbuf_open_file(rb_file *rfile, int *err)
     g_free(rfile->name);
   }
 
-#ifdef _WIN32
-  _tzset();
-#endif
-  current_time = time(NULL);
-
-  g_snprintf(filenum, sizeof(filenum), "%05u", (rb_data.curr_file_num + 1) % RINGBUFFER_MAX_NUM_FILES);
-  strftime(timestr, sizeof(timestr), "%Y%m%d%H%M%S", localtime(&current_time));
-  rfile->name = g_strconcat(rb_data.fprefix, "_", filenum, "_", timestr,
-                            rb_data.fsuffix, NULL);
+  rfile->name = ringbuf_file_name();
 
   if (rfile->name == NULL) {
     if (err != NULL)
@@ -130,11 +202,454 @@ static int ringbuf_open_file(rb_file *rfile, int *err)
   return rb_data.fd;
 }
 
+/*
+ * Flush a file, give back the space preallocated past its end, sync it
+ * if asked to and close it
+ */
+static gboolean
+ringbuf_finish_file(FILE *pdh, int *err)
+{
+  int close_err;
+
+#ifdef HAVE_POSIX_FALLOCATE
+  if (rb_data.file_size != 0) {
+    off_t size;
+
+    if (fflush(pdh) == EOF) {
+      *err = errno;
+      pcapio_close(pdh, &close_err);
+      return FALSE;
+    }
+    size = ws_lseek64(fileno(pdh), 0, SEEK_CUR);
+    if (size != -1 && ftruncate(fileno(pdh), size) == -1) {
+      *err = errno;
+      pcapio_close(pdh, &close_err);
+      return FALSE;
+    }
+  }
+#endif
+  if (rb_data.sync_on_close && !pcapio_sync(pdh, err)) {
+    pcapio_close(pdh, &close_err);
+    return FALSE;
+  }
+  return pcapio_close(pdh, err);
+}
+
+#ifdef RINGBUF_PREPARE_NEXT
+/*
+ * create the next file under its temporary name
+ */
+static int
+ringbuf_prepare_file(void)
+{
+  int fd;
+
+  fd = ws_open(rb_data.next_name, O_RDWR|O_BINARY|O_TRUNC|O_CREAT,
+               rb_data.group_read_access ? 0640 : 0600);
+#ifdef HAVE_POSIX_FALLOCATE
+  /* Only an optimization, so failing is fine */
+  if (fd != -1 && rb_data.file_size != 0)
+    posix_fallocate(fd, 0, (off_t)rb_data.file_size);
+#endif
+  return fd;
+}
+#endif
+
+static const gchar *
+ringbuf_compression_suffix(ringbuf_compression compression)
+{
+  switch (compression) {
+  case RINGBUF_COMPRESS_GZIP:
+    return ".gz";
+  case RINGBUF_COMPRESS_ZSTD:
+    return ".zst";
+  default:
+    return "";
+  }
+}
+
+/*
+ * delete a file that drops out of the ring, along with what was made
+ * from it after it was finished
+ */
+static void
+ringbuf_remove_file(const gchar *name)
+{
+  gchar *other;
+
+  ws_unlink(name);
+  if (rb_post.compression != RINGBUF_COMPRESS_NONE) {
+    other = g_strconcat(name, ringbuf_compression_suffix(rb_post.compression), NULL);
+    ws_unlink(other);
+    g_free(other);
+  }
+  if (rb_post.frame_index) {
+    other = wtap_frame_index_filename(name);
+    ws_unlink(other);
+    g_free(other);
+    if (rb_post.compression != RINGBUF_COMPRESS_NONE) {
+      gchar *compressed = g_strconcat(name, ringbuf_compression_suffix(rb_post.compression), NULL);
+
+      other = wtap_frame_index_filename(compressed);
+      ws_unlink(other);
+      g_free(other);
+      g_free(compressed);
+    }
+  }
+}
+
+#ifdef HAVE_LIBZ
+static gboolean
+ringbuf_compress_gzip(int in_fd, int out_fd, guint8 *buf, int *err)
+{
+  gzFile  gz;
+  int     nread;
+
+  gz = gzdopen(out_fd, "wb");
+  if (gz == NULL) {
+    *err = errno != 0 ? errno : ENOMEM;
+    ws_close(out_fd);
+    return FALSE;
+  }
+  while ((nread = (int)ws_read(in_fd, buf, RINGBUF_COPY_BUFFER_SIZE)) > 0) {
+    if (gzwrite(gz, buf, (unsigned)nread) != nread) {
+      *err = EIO;
+      gzclose(gz);
+      return FALSE;
+    }
+  }
+  if (nread < 0) {
+    *err = errno;
+    gzclose(gz);
+    return FALSE;
+  }
+  if (gzclose(gz) != Z_OK) {
+    *err = EIO;
+    return FALSE;
+  }
+  return TRUE;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+static gboolean
+ringbuf_compress_zstd(int in_fd, int out_fd, guint8 *buf, int *err)
+{
+  ZSTD_CStream  *zcs;
+  size_t         out_size = ZSTD_CStreamOutSize();
+  guint8        *out_buf;
+  ZSTD_inBuffer  in;
+  ZSTD_outBuffer out;
+  size_t         ret = 0;
+  int            nread;
+  gboolean       ok = TRUE;
+
+  zcs = ZSTD_createCStream();
+  if (zcs == NULL || ZSTD_isError(ZSTD_initCStream(zcs, 3))) {
+    *err = ENOMEM;
+    ZSTD_freeCStream(zcs);
+    ws_close(out_fd);
+    return FALSE;
+  }
+  out_buf = (guint8 *)g_malloc(out_size);
+  while (ok && (nread = (int)ws_read(in_fd, buf, RINGBUF_COPY_BUFFER_SIZE)) != 0) {
+    if (nread < 0) {
+      *err = errno;
+      ok = FALSE;
+      break;
+    }
+    in.src = buf;
+    in.size = nread;
+    in.pos = 0;
+    while (in.pos < in.size) {
+      out.dst = out_buf;
+      out.size = out_size;
+      out.pos = 0;
+      ret = ZSTD_compressStream(zcs, &out, &in);
+      if (ZSTD_isError(ret) || ws_write(out_fd, out_buf, (unsigned)out.pos) != (int)out.pos) {
+        *err = ZSTD_isError(ret) ? EIO : errno;
+        ok = FALSE;
+        break;
+      }
+    }
+  }
+  while (ok) {
+    out.dst = out_buf;
+    out.size = out_size;
+    out.pos = 0;
+    ret = ZSTD_endStream(zcs, &out);
+    if (ZSTD_isError(ret) || ws_write(out_fd, out_buf, (unsigned)out.pos) != (int)out.pos) {
+      *err = ZSTD_isError(ret) ? EIO : errno;
+      ok = FALSE;
+    } else if (ret == 0) {
+      break;
+    }
+  }
+  g_free(out_buf);
+  ZSTD_freeCStream(zcs);
+  if (ws_close(out_fd) == -1 && ok) {
+    *err = errno;
+    ok = FALSE;
+  }
+  return ok;
+}
+#endif
+
+/*
+ * compress a finished file into out_name
+ */
+static gboolean
+ringbuf_compress_file(const gchar *name, const gchar *out_name, int *err)
+{
+  int       in_fd, out_fd;
+  guint8   *buf;
+  gboolean  ok = FALSE;
+
+  in_fd = ws_open(name, O_RDONLY|O_BINARY, 0000);
+  if (in_fd == -1) {
+    *err = errno;
+    return FALSE;
+  }
+  out_fd = ws_open(out_name, O_WRONLY|O_BINARY|O_TRUNC|O_CREAT,
+                   rb_data.group_read_access ? 0640 : 0600);
+  if (out_fd == -1) {
+    *err = errno;
+    ws_close(in_fd);
+    return FALSE;
+  }
+
+  buf = (guint8 *)g_malloc(RINGBUF_COPY_BUFFER_SIZE);
+  switch (rb_post.compression) {
+#ifdef HAVE_LIBZ
+  case RINGBUF_COMPRESS_GZIP:
+    ok = ringbuf_compress_gzip(in_fd, out_fd, buf, err);
+    break;
+#endif
+#ifdef HAVE_ZSTD
+  case RINGBUF_COMPRESS_ZSTD:
+    ok = ringbuf_compress_zstd(in_fd, out_fd, buf, err);
+    break;
+#endif
+  default:
+    *err = EINVAL;
+    ws_close(out_fd);
+    break;
+  }
+  g_free(buf);
+  ws_close(in_fd);
+  return ok;
+}
+
+/*
+ * Pool thread: compress and/or index a finished file.  Failures here
+ * don't lose any packets, so they aren't reported: a file that can't be
+ * compressed is kept as it is, and one that can't be indexed is just
+ * read the slow way.
+ */
+static void
+ringbuf_post_process(gpointer data, gpointer user_data _U_)
+{
+  rb_finished *finished = (rb_finished *)data;
+  gchar       *out_name = NULL;
+  const gchar *name = finished->name;
+  int          err;
+
+  if (rb_post.compression != RINGBUF_COMPRESS_NONE) {
+    out_name = g_strconcat(finished->name,
+                           ringbuf_compression_suffix(rb_post.compression), NULL);
+    if (ringbuf_compress_file(finished->name, out_name, &err)) {
+      ws_unlink(finished->name);
+      name = out_name;
+    } else {
+      ws_unlink(out_name);
+    }
+  }
+  if (finished->fidx != NULL) {
+    /* The offsets are into the uncompressed data, as wiretap wants */
+    wtap_frame_index_write(finished->fidx, name, &err);
+    wtap_frame_index_free(finished->fidx);
+  }
+  g_free(out_name);
+  g_free(finished->name);
+  g_free(finished);
+}
+
+/*
+ * hand a finished file to the post-processing threads, taking over
+ * name and fidx
+ */
+static void
+ringbuf_queue_finished(gchar *name, wtap_frame_index *fidx)
+{
+  rb_finished *finished;
+
+  if (rb_data.post_pool == NULL) {
+    g_free(name);
+    if (fidx != NULL)
+      wtap_frame_index_free(fidx);
+    return;
+  }
+  finished = g_new(rb_finished, 1);
+  finished->name = name;
+  finished->fidx = fidx;
+  g_thread_pool_push(rb_data.post_pool, finished, NULL);
+}
+
+/*
+ * Background thread doing the slow parts of switching files
+ */
+static gpointer
+ringbuf_worker(gpointer data _U_)
+{
+  rb_job *job;
+  int     err;
+
+  for (;;) {
+    job = (rb_job *)g_async_queue_pop(rb_data.jobs);
+    if (job->stop) {
+      g_free(job);
+      break;
+    }
+    if (job->pdh != NULL) {
+      if (ringbuf_finish_file(job->pdh, &err)) {
+        ringbuf_queue_finished(job->pdh_name, job->fidx);
+      } else {
+        /* Reported at the next switch or close */
+        g_atomic_int_compare_and_exchange(&rb_data.worker_err, 0,
+                                          err != 0 ? err : EIO);
+        g_free(job->pdh_name);
+        if (job->fidx != NULL)
+          wtap_frame_index_free(job->fidx);
+      }
+    }
+    if (job->unlink_name != NULL) {
+      ringbuf_remove_file(job->unlink_name);
+      g_free(job->unlink_name);
+    }
+#ifdef RINGBUF_PREPARE_NEXT
+    if (job->prepare) {
+      int *fdp = g_new(int, 1);
+
+      *fdp = ringbuf_prepare_file();
+      g_async_queue_push(rb_data.prepared, fdp);
+    }
+#endif
+    g_free(job);
+  }
+  return NULL;
+}
+
+#ifdef RINGBUF_PREPARE_NEXT
+/*
+ * Wait for the next file the background thread was asked to create
+ */
+static int
+ringbuf_take_prepared(void)
+{
+  int *fdp = (int *)g_async_queue_pop(rb_data.prepared);
+  int  fd = *fdp;
+
+  g_free(fdp);
+  rb_data.next_pending = FALSE;
+  return fd;
+}
+#endif
+
+/*
+ * Hand the slow parts of a switch to the background thread
+ */
+static void
+ringbuf_queue_job(FILE *pdh, gchar *pdh_name, wtap_frame_index *fidx,
+                  gchar *unlink_name)
+{
+  rb_job *job = g_new0(rb_job, 1);
+
+  job->pdh = pdh;
+  job->pdh_name = pdh_name;
+  job->fidx = fidx;
+  job->unlink_name = unlink_name;
+#ifdef RINGBUF_PREPARE_NEXT
+  job->prepare = TRUE;
+  rb_data.next_pending = TRUE;
+#endif
+  g_async_queue_push(rb_data.jobs, job);
+}
+
+/*
+ * Wait for the background thread to finish its work and end it
+ */
+static void
+ringbuf_stop_worker(void)
+{
+  rb_job *job;
+
+  if (rb_data.worker == NULL)
+    return;
+
+  job = g_new0(rb_job, 1);
+  job->stop = TRUE;
+  g_async_queue_push(rb_data.jobs, job);
+  g_thread_join(rb_data.worker);
+  rb_data.worker = NULL;
+
+#ifdef RINGBUF_PREPARE_NEXT
+  /* throw away the next file */
+  if (rb_data.next_pending) {
+    int fd = ringbuf_take_prepared();
+
+    if (fd != -1)
+      ws_close(fd);
+    ws_unlink(rb_data.next_name);
+  }
+#endif
+  g_async_queue_unref(rb_data.jobs);
+  rb_data.jobs = NULL;
+  g_async_queue_unref(rb_data.prepared);
+  rb_data.prepared = NULL;
+}
+
+/*
+ * Set what's done with each file once it's finished; call before
+ * ringbuf_init()
+ */
+void
+ringbuf_set_post_processing(ringbuf_compression compression, gboolean frame_index,
+                            int file_type_subtype, guint num_threads)
+{
+  rb_post.compression = compression;
+  rb_post.frame_index = frame_index;
+  rb_post.file_type_subtype = file_type_subtype;
+  rb_post.num_threads = num_threads != 0 ? num_threads : 1;
+}
+
+/*
+ * Add a packet just written to the current file to its frame index
+ */
+void
+ringbuf_index_packet(gint64 offset, time_t secs, int nsecs,
+                     guint32 caplen, guint32 len)
+{
+  struct wtap_pkthdr phdr;
+
+  if (rb_data.fidx == NULL)
+    return;
+
+  memset(&phdr, 0, sizeof phdr);
+  phdr.rec_type = REC_TYPE_PACKET;
+  phdr.presence_flags = WTAP_HAS_TS|WTAP_HAS_CAP_LEN;
+  phdr.ts.secs = secs;
+  phdr.ts.nsecs = nsecs;
+  phdr.caplen = caplen;
+  phdr.len = len;
+  wtap_frame_index_add(rb_data.fidx, offset, &phdr);
+}
+
 /*
  * Initialize the ringbuffer data structures
  */
 int
-ringbuf_init(const char *capfile_name, guint num_files, gboolean group_read_access)
+ringbuf_init(const char *capfile_name, guint num_files, gboolean group_read_access,
+             guint64 file_size, gboolean sync_on_close)
 {
   unsigned int i;
   char        *pfx, *last_pathsep;
@@ -148,6 +663,14 @@ ringbuf_init(const char *capfile_name, guint num_files, gboolean group_read_acce
   rb_data.fd = -1;
   rb_data.pdh = NULL;
   rb_data.group_read_access = group_read_access;
+  rb_data.file_size = file_size;
+  rb_data.sync_on_close = sync_on_close;
+  rb_data.worker = NULL;
+  rb_data.next_pending = FALSE;
+  rb_data.next_name = NULL;
+  rb_data.worker_err = 0;
+  rb_data.post_pool = NULL;
+  rb_data.fidx = NULL;
 
   /* just to be sure ... */
   if (num_files <= RINGBUFFER_MAX_NUM_FILES) {
@@ -214,6 +737,28 @@ ringbuf_init(const char *capfile_name, guint num_files, gboolean group_read_acce
     return -1;
   }
 
+  /* start the background thread, and have it create the next file */
+  rb_data.jobs = g_async_queue_new();
+  rb_data.prepared = g_async_queue_new();
+#ifdef RINGBUF_PREPARE_NEXT
+  rb_data.next_name = g_strconcat(rb_data.fprefix, "_next",
+                                  rb_data.fsuffix, NULL);
+#endif
+#if GLIB_CHECK_VERSION(2,31,0)
+  rb_data.worker = g_thread_new("Ring buffer", ringbuf_worker, NULL);
+#else
+  rb_data.worker = g_thread_create(ringbuf_worker, NULL, TRUE, NULL);
+#endif
+  ringbuf_queue_job(NULL, NULL, NULL, NULL);
+
+  /* start the post-processing threads */
+  if (rb_post.compression != RINGBUF_COMPRESS_NONE || rb_post.frame_index) {
+    rb_data.post_pool = g_thread_pool_new(ringbuf_post_process, NULL,
+                                          (gint)rb_post.num_threads, TRUE, NULL);
+  }
+  if (rb_post.frame_index)
+    rb_data.fidx = wtap_frame_index_new(rb_post.file_type_subtype);
+
   return rb_data.fd;
 }
 
@@ -224,15 +769,17 @@ const gchar *ringbuf_current_filename(void)
 }
 
 /*
- * Calls ws_fdopen() for the current ringbuffer file
+ * Calls pcapio_fdopen() for the current ringbuffer file
  */
 FILE *
 ringbuf_init_libpcap_fdopen(int *err)
 {
-  rb_data.pdh = ws_fdopen(rb_data.fd, "wb");
+  int open_err;
+
+  rb_data.pdh = pcapio_fdopen(rb_data.fd, &open_err);
   if (rb_data.pdh == NULL) {
     if (err != NULL) {
-      *err = errno;
+      *err = open_err;
     }
   }
   return rb_data.pdh;
@@ -244,38 +791,89 @@ ringbuf_init_libpcap_fdopen(int *err)
 gboolean
 ringbuf_switch_file(FILE **pdh, gchar **save_file, int *save_file_fd, int *err)
 {
-  int     next_file_index;
+  int      next_file_index;
   rb_file *next_rfile = NULL;
-
-  /* close current file */
-
-  if (fclose(rb_data.pdh) == EOF) {
+  gchar   *old_name;
+  gchar   *finished_name = NULL;
+  gint     worker_err;
+  FILE    *old_pdh;
+  int      fd = -1;
+  int      open_err;
+
+  /* give up if the last file couldn't be closed */
+  worker_err = g_atomic_int_get(&rb_data.worker_err);
+  if (worker_err != 0) {
     if (err != NULL) {
-      *err = errno;
+      *err = worker_err;
     }
-    ws_close(rb_data.fd);  /* XXX - the above should have closed this already */
-    rb_data.pdh = NULL;    /* it's still closed, we just got an error while closing */
-    rb_data.fd = -1;
     return FALSE;
   }
 
-  rb_data.pdh = NULL;
-  rb_data.fd  = -1;
+  /* get the next file number; the file that had its slot in the ring is
+     deleted (unless there's no limit on files) after the switch */
 
-  /* get the next file number and open it */
+  if (rb_data.post_pool != NULL)
+    finished_name = g_strdup(rb_data.files[rb_data.curr_file_num % rb_data.num_files].name);
 
   rb_data.curr_file_num++ /* = next_file_num*/;
   next_file_index = (rb_data.curr_file_num) % rb_data.num_files;
   next_rfile = &rb_data.files[next_file_index];
-
-  if (ringbuf_open_file(next_rfile, err) == -1) {
+  old_name = next_rfile->name;
+  next_rfile->name = ringbuf_file_name();
+
+#ifdef RINGBUF_PREPARE_NEXT
+  /* take the file the background thread made ready, normally long ago */
+  if (rb_data.next_pending) {
+    fd = ringbuf_take_prepared();
+    if (fd != -1 && ws_rename(rb_data.next_name, next_rfile->name) == -1) {
+      ws_close(fd);
+      ws_unlink(rb_data.next_name);
+      fd = -1;
+    }
+  }
+#endif
+  if (fd == -1) {
+    fd = ws_open(next_rfile->name, O_RDWR|O_BINARY|O_TRUNC|O_CREAT,
+                 rb_data.group_read_access ? 0640 : 0600);
+  }
+  if (fd == -1) {
+    if (err != NULL) {
+      *err = errno;
+    }
+    /* stay with the current file; it's closed when capturing stops */
+    g_free(next_rfile->name);
+    next_rfile->name = old_name;
+    rb_data.curr_file_num--;
+    g_free(finished_name);
     return FALSE;
   }
 
-  if (ringbuf_init_libpcap_fdopen(err) == NULL) {
+  old_pdh = rb_data.pdh;
+  rb_data.fd = fd;
+  if (ringbuf_init_libpcap_fdopen(&open_err) == NULL) {
+    if (err != NULL) {
+      *err = open_err;
+    }
+    ws_close(fd);
+    ws_unlink(next_rfile->name);
+    g_free(next_rfile->name);
+    next_rfile->name = old_name;
+    rb_data.curr_file_num--;
+    rb_data.pdh = old_pdh;
+    rb_data.fd = fileno(old_pdh);
+    g_free(finished_name);
     return FALSE;
   }
 
+  /* the rest is done in the background */
+  if (rb_data.unlimited) {
+    g_free(old_name);
+    old_name = NULL;
+  }
+  ringbuf_queue_job(old_pdh, finished_name, rb_data.fidx, old_name);
+  if (rb_post.frame_index)
+    rb_data.fidx = wtap_frame_index_new(rb_post.file_type_subtype);
+
   /* switch to the new file */
   *save_file = next_rfile->name;
   *save_file_fd = rb_data.fd;
@@ -285,26 +883,50 @@ ringbuf_switch_file(FILE **pdh, gchar **save_file, int *save_file_fd, int *err)
 }
 
 /*
- * Calls fclose() for the current ringbuffer file
+ * Calls pcapio_close() for the current ringbuffer file
  */
 gboolean
 ringbuf_libpcap_dump_close(gchar **save_file, int *err)
 {
   gboolean  ret_val = TRUE;
+  int       close_err;
+  gint      worker_err;
 
   /* close current file, if it's open */
   if (rb_data.pdh != NULL) {
-    if (fclose(rb_data.pdh) == EOF) {
+    if (!ringbuf_finish_file(rb_data.pdh, &close_err)) {
       if (err != NULL) {
-        *err = errno;
+        *err = close_err;
       }
-      ws_close(rb_data.fd);
       ret_val = FALSE;
     }
     rb_data.pdh = NULL;
     rb_data.fd  = -1;
   }
 
+  /* let the background thread finish closing the earlier files */
+  ringbuf_stop_worker();
+  worker_err = g_atomic_int_get(&rb_data.worker_err);
+  if (ret_val && worker_err != 0) {
+    if (err != NULL) {
+      *err = worker_err;
+    }
+    ret_val = FALSE;
+  }
+
+  /* post-process the last file too, and wait for all of them to be done */
+  if (rb_data.post_pool != NULL) {
+    if (ret_val) {
+      ringbuf_queue_finished(g_strdup(rb_data.files[rb_data.curr_file_num % rb_data.num_files].name),
+                             rb_data.fidx);
+    } else if (rb_data.fidx != NULL) {
+      wtap_frame_index_free(rb_data.fidx);
+    }
+    rb_data.fidx = NULL;
+    g_thread_pool_free(rb_data.post_pool, FALSE, TRUE);
+    rb_data.post_pool = NULL;
+  }
+
   /* set the save file name to the current file */
   *save_file = rb_data.files[rb_data.curr_file_num % rb_data.num_files].name;
   return ret_val;
@@ -336,6 +958,8 @@ ringbuf_free(void)
     g_free(rb_data.fsuffix);
     rb_data.fsuffix = NULL;
   }
+  g_free(rb_data.next_name);
+  rb_data.next_name = NULL;
 }
 
 /*
@@ -346,9 +970,21 @@ ringbuf_error_cleanup(void)
 {
   unsigned int i;
 
+  ringbuf_stop_worker();
+  if (rb_data.post_pool != NULL) {
+    g_thread_pool_free(rb_data.post_pool, TRUE, TRUE);
+    rb_data.post_pool = NULL;
+  }
+  if (rb_data.fidx != NULL) {
+    wtap_frame_index_free(rb_data.fidx);
+    rb_data.fidx = NULL;
+  }
+
   /* try to close via wtap */
   if (rb_data.pdh != NULL) {
-    if (fclose(rb_data.pdh) == 0) {
+    int close_err;
+
+    if (pcapio_close(rb_data.pdh, &close_err)) {
       rb_data.fd = -1;
     }
     rb_data.pdh = NULL;
@@ -36,12 +36,24 @@
 /* Maximum number for FAT filesystems */
 #define RINGBUFFER_WARN_NUM_FILES 65535
 
-int ringbuf_init(const char *capture_name, guint num_files, gboolean group_read_access);
+/* What to do with each ringbuffer file once it's finished */
+typedef enum {
+  RINGBUF_COMPRESS_NONE,
+  RINGBUF_COMPRESS_GZIP,        /* replace it with a gzipped copy, "<file>.gz" */
+  RINGBUF_COMPRESS_ZSTD         /* replace it with a zstd copy, "<file>.zst" */
+} ringbuf_compression;
+
+void ringbuf_set_post_processing(ringbuf_compression compression, gboolean frame_index,
+                                 int file_type_subtype, guint num_threads);
+int ringbuf_init(const char *capture_name, guint num_files, gboolean group_read_access,
+                 guint64 file_size, gboolean sync_on_close);
 const gchar *ringbuf_current_filename(void);
 FILE *ringbuf_init_libpcap_fdopen(int *err);
 gboolean ringbuf_switch_file(FILE **pdh, gchar **save_file, int *save_file_fd,
                              int *err);
 gboolean ringbuf_libpcap_dump_close(gchar **save_file, int *err);
+void ringbuf_index_packet(gint64 offset, time_t secs, int nsecs,
+                          guint32 caplen, guint32 len);
 void ringbuf_free(void);
 void ringbuf_error_cleanup(void);
 
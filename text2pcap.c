@@ -465,18 +465,23 @@ parse_num (const char *str, int offset)
 }
 
 /*----------------------------------------------------------------------
- * Write this byte into current packet
+ * Write a run of bytes into current packet.  The scanner hands us a
+ * whole run of two-digit hex bytes separated by whitespace at once, so
+ * decode them here rather than one strtoul() per byte.
  */
 static void
 write_byte (const char *str)
 {
-    guint32 num;
-
-    num = parse_num(str, FALSE);
-    packet_buf[curr_offset] = (guint8) num;
-    curr_offset++;
-    if (curr_offset - header_length >= max_offset) /* packet full */
-        start_new_packet(TRUE);
+    while (g_ascii_isxdigit(str[0]) && g_ascii_isxdigit(str[1])) {
+        packet_buf[curr_offset] = (guint8) ((g_ascii_xdigit_value(str[0]) << 4) |
+                                            g_ascii_xdigit_value(str[1]));
+        curr_offset++;
+        if (curr_offset - header_length >= max_offset) /* packet full */
+            start_new_packet(TRUE);
+        str += 2;
+        while (*str == ' ' || *str == '\t')
+            str++;
+    }
 }
 
 /*----------------------------------------------------------------------
@@ -976,6 +981,8 @@ write_file_trailer (void)
                                                           0,
                                                           num_packets_written,
                                                           num_packets_written - num_packets_written,
+                                                          G_MAXUINT64,
+                                                          G_MAXUINT64,
                                                           &err);
 
     } else {
@@ -1296,7 +1303,7 @@ parse_token (token_t token, char *str)
     case READ_OFFSET:
         switch (token) {
         case T_BYTE:
-            /* Record the byte */
+            /* Record the bytes */
             state = READ_BYTE;
             if (!str) goto fail_null_str;
             write_byte(str);
@@ -1318,7 +1325,7 @@ parse_token (token_t token, char *str)
     case READ_BYTE:
         switch (token) {
         case T_BYTE:
-            /* Record the byte */
+            /* Record the bytes */
             write_byte(str);
             break;
         case T_TEXT:
@@ -1870,6 +1877,9 @@ parse_options (int argc, char *argv[])
         output_filename = "Standard output";
         output_file = stdout;
     }
+    /* Packets are written a block at a time; don't let a small stdio
+       buffer turn that into a write per packet */
+    setvbuf(output_file, NULL, _IOFBF, PCAPIO_WRITE_BUFFER_SIZE);
 
     /* Some validation */
     if (pcap_link_type != 1 && hdr_ethernet) {
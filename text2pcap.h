@@ -33,7 +33,7 @@
 #define TEXT2PCAP_H
 
 typedef enum {
-    T_BYTE = 1,
+    T_BYTE = 1,         /* one or more bytes, separated by whitespace */
     T_OFFSET,
     T_DIRECTIVE,
     T_TEXT,
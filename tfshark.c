@@ -1670,6 +1670,9 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt, frame_data *fd
 
     col_custom_prime_edt(edt, &cf->cinfo);
 
+    if (print_packet_info && output_action == WRITE_FIELDS)
+      output_fields_prime_edt(output_fields, edt);
+
     /* We only need the columns if either
          1) some tap needs the columns
        or
@@ -2087,6 +2090,9 @@ process_packet(capture_file *cf, epan_dissect_t *edt, gint64 offset,
 
     col_custom_prime_edt(edt, &cf->cinfo);
 
+    if (print_packet_info && output_action == WRITE_FIELDS)
+      output_fields_prime_edt(output_fields, edt);
+
     /* We only need the columns if either
          1) some tap needs the columns
        or
@@ -0,0 +1,198 @@
+#!/usr/bin/env perl
+#
+# Rewrite proto_tree_add_item() calls with a constant length of 1, 2, 3
+# or 4 bytes, for fields registered in the same file as FT_UINT8 through
+# FT_UINT32 or as FT_IPv4, as calls to proto_tree_add_item_uint8(),
+# _uint16(), _uint24(), _uint32() or _ipv4(), which skip the length and
+# type dispatch.  It's only worth doing in dissectors that add a lot of
+# items per packet.
+#
+# Usage: convert-proto-tree-add-item-fixed.pl <file or files>
+#
+# The files are rewritten in place; the number of calls converted in
+# each is printed.
+#
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+use strict;
+use warnings;
+
+my %FUNC_FOR_LENGTH = (1 => "proto_tree_add_item_uint8",
+                       2 => "proto_tree_add_item_uint16",
+                       3 => "proto_tree_add_item_uint24",
+                       4 => "proto_tree_add_item_uint32");
+
+# Split the text between a call's parentheses into its arguments,
+# leaving commas inside nested parentheses, brackets and strings alone.
+sub split_args {
+    my ($text) = @_;
+    my @args;
+    my $depth = 0;
+    my $in_string = '';
+    my $cur = '';
+
+    for (my $i = 0; $i < length($text); $i++) {
+        my $c = substr($text, $i, 1);
+
+        if ($in_string) {
+            $cur .= $c;
+            if ($c eq '\\') {
+                $cur .= substr($text, ++$i, 1);
+            } elsif ($c eq $in_string) {
+                $in_string = '';
+            }
+            next;
+        }
+        if ($c eq '"' || $c eq "'") {
+            $in_string = $c;
+        } elsif ($c eq '(' || $c eq '[' || $c eq '{') {
+            $depth++;
+        } elsif ($c eq ')' || $c eq ']' || $c eq '}') {
+            $depth--;
+        } elsif ($c eq ',' && $depth == 0) {
+            push @args, $cur;
+            $cur = '';
+            next;
+        }
+        $cur .= $c;
+    }
+    push @args, $cur;
+    return @args;
+}
+
+# Return the offset just past the parenthesis matching the one at $open.
+sub find_close {
+    my ($text, $open) = @_;
+    my $depth = 0;
+    my $in_string = '';
+
+    for (my $i = $open; $i < length($text); $i++) {
+        my $c = substr($text, $i, 1);
+
+        if ($in_string) {
+            $i++ if ($c eq '\\');
+            $in_string = '' if ($c eq $in_string);
+            next;
+        }
+        if ($c eq '"' || $c eq "'") {
+            $in_string = $c;
+        } elsif ($c eq '(') {
+            $depth++;
+        } elsif ($c eq ')') {
+            return $i + 1 if (--$depth == 0);
+        }
+    }
+    return -1;
+}
+
+# Find the type of each field registered in the file, whether in an
+# hf_register_info array or as a header_field_info (NEW_PROTO_TREE_API).
+sub field_types {
+    my ($text) = @_;
+    my %types;
+    my $str = qr/"(?:[^"\\]|\\.)*"/;
+
+    while ($text =~ /\{\s*&\s*(hf_\w+)\s*,\s*\{\s*$str\s*,\s*$str\s*,\s*(FT_\w+)/g) {
+        $types{$1} = $2;
+    }
+    while ($text =~ /header_field_info\s+(hfi_\w+)\s+\w*\s*=\s*\{\s*$str\s*,\s*$str\s*,\s*(FT_\w+)/g) {
+        $types{"&$1"} = $2;
+    }
+    return %types;
+}
+
+foreach my $file (@ARGV) {
+    my $text;
+    my $out = '';
+    my $count = 0;
+    my %types;
+
+    open(my $fh, '<', $file) or die "Can't open $file: $!";
+    { local $/; $text = <$fh>; }
+    close($fh);
+
+    %types = field_types($text);
+
+    while ($text =~ /\bproto_tree_add_item\s*\(/g) {
+        my $start = $-[0];
+        my $open = $+[0] - 1;
+        my $close = find_close($text, $open);
+
+        next if ($close < 0);
+
+        my @args = split_args(substr($text, $open + 1, $close - $open - 2));
+        next if (@args != 6);
+
+        my ($length) = $args[4] =~ /^\s*([1-4])\s*$/;
+        next if (!defined $length);
+
+        my ($field) = $args[1] =~ /^\s*(.*?)\s*$/;
+        my $type = $types{$field};
+        my $func;
+
+        next if (!defined $type);
+        if ($type =~ /^FT_UINT(8|16|24|32)$/) {
+            $func = $FUNC_FOR_LENGTH{$length};
+        } elsif ($type eq "FT_IPv4" && $length == 4) {
+            $func = "proto_tree_add_item_ipv4";
+        } else {
+            next;
+        }
+
+        # Keep the layout of the other arguments, dropping the length
+        # along with the whitespace and comma before it.  Arguments on
+        # continuation lines lined up after the parenthesis are moved
+        # over to stay lined up.
+        my $line_start = rindex($text, "\n", $start) + 1;
+        my $column = $open + 1 - $line_start;
+        my $shift = " " x (length($func) - length("proto_tree_add_item"));
+        my $call = $func . "(" .
+            join(",", @args[0..3]) . "," . $args[5] . ")";
+
+        $call =~ s/\n( {$column})(?=\S)/\n$1$shift/g
+            if (substr($text, $line_start, $start - $line_start) !~ /\t/);
+
+        $out .= substr($text, 0, $start) . $call;
+        $text = substr($text, $close);
+        $count++;
+        pos($text) = 0;
+    }
+    $out .= $text;
+
+    if ($count > 0) {
+        open($fh, '>', $file) or die "Can't write $file: $!";
+        print $fh $out;
+        close($fh);
+    }
+    print "$file: $count\n";
+}
+
+#
+# Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+#
+# Local variables:
+# c-basic-offset: 4
+# tab-width: 8
+# indent-tabs-mode: nil
+# End:
+#
+# vi: set shiftwidth=4 tabstop=8 expandtab:
+# :indentSize=4:tabSize=8:noTabs=true:
+#
@@ -82,6 +82,7 @@
 #include "globals.h"
 #include <epan/timestamp.h>
 #include <epan/packet.h>
+#include <epan/wmem/wmem.h>
 #ifdef HAVE_LUA
 #include <epan/wslua/init_wslua.h>
 #endif
@@ -123,6 +124,8 @@
 #endif /* _WIN32 */
 #include <capchild/capture_session.h>
 #include <capchild/capture_sync.h>
+#include "caputils/capture_shm.h"
+#include <wiretap/pcap-encap.h>
 #endif /* HAVE_LIBPCAP */
 #include "log.h"
 #include <epan/funnel.h>
@@ -155,7 +158,10 @@ static gboolean perform_two_pass_analysis;
 typedef enum {
   WRITE_TEXT,   /* summary or detail text */
   WRITE_XML,    /* PDML or PSML */
-  WRITE_FIELDS  /* User defined list of fields */
+  WRITE_FIELDS, /* User defined list of fields */
+  WRITE_JSON,   /* JSON */
+  WRITE_EK,     /* JSON bulk insert to Elasticsearch */
+  WRITE_ARROW   /* User defined list of fields, as an Arrow IPC stream */
   /* Add CSV and the like here */
 } output_action_e;
 
@@ -182,9 +188,60 @@ static const char *separator = "";
  */
 static gboolean print_packet_counts;
 
+/*
+ * TRUE if we're to stop dissecting a packet once we've dissected all
+ * the protocols the display filter refers to.
+ */
+static gboolean filter_cutoff;
+
+/*
+ * If non-zero, the dissection session is thrown away and a new one
+ * started after that many packets have been dissected, or once the
+ * protocols have allocated more than that many bytes of file-scope
+ * memory, so that a capture that runs indefinitely doesn't keep
+ * conversation and reassembly state for ever.
+ */
+static guint32 epan_auto_reset_count;
+static guint64 epan_auto_reset_memory;
+static guint32 epan_reset_packets;
+
+/* How often, in packets, the file-scope memory is checked */
+#define EPAN_MEMORY_CHECK_INTERVAL 1000
+
+#define LONGOPT_FILTER_CUTOFF   (MIN_NON_CAPTURE_LONGOPT+0)
+#define LONGOPT_SESSION_MEMORY  (MIN_NON_CAPTURE_LONGOPT+1)
+#define LONGOPT_STARTUP_PROFILE (MIN_NON_CAPTURE_LONGOPT+2)
+
+/*
+ * --startup-profile: time each step of startup, including each
+ * dissector's registration and handoff routine, and report them
+ * before the first packet is read.  Each step runs until the next one
+ * starts.
+ */
+typedef struct {
+  const char *phase;
+  gchar      *name;
+  gdouble     secs;
+} startup_step_t;
+
+static gboolean startup_profile;
+static GTimer  *startup_timer;
+static GArray  *startup_steps;
+
+/* Number of steps listed individually in the report */
+#define STARTUP_PROFILE_TOP_STEPS 25
+
 static capture_options global_capture_opts;
 static capture_session global_capture_session;
 
+#ifdef HAVE_CAPTURE_SHM
+/* Ring through which dumpcap hands us the packets it writes, or NULL
+   if we're reading them from the capture file */
+static capture_shm *capture_ring;
+/* Packets we've taken from the ring */
+static guint32 capture_ring_packets;
+#endif
+
 #ifdef SIGINFO
 static gboolean infodelay;      /* if TRUE, don't print capture info in SIGINFO handler */
 static gboolean infoprint;      /* if TRUE, print capture info after clearing infodelay */
@@ -208,6 +265,9 @@ static char *output_file_name;
 #endif /* HAVE_LIBPCAP */
 
 static int load_cap_file(capture_file *, char *, int, gboolean, int, gint64);
+static epan_dissect_t *new_packet_edt(capture_file *cf, gboolean create_proto_tree);
+static void reset_epan_mem(capture_file *cf, epan_dissect_t **edt);
+static void set_used_columns(capture_file *cf, guint tap_flags);
 static gboolean process_packet(capture_file *cf, epan_dissect_t *edt, gint64 offset,
     struct wtap_pkthdr *whdr, const guchar *pd,
     guint tap_flags);
@@ -341,6 +401,14 @@ print_usage(FILE *output)
   fprintf(output, "  -R <read filter>         packet Read filter in Wireshark display filter syntax\n");
   fprintf(output, "  -Y <display filter>      packet displaY filter in Wireshark display filter\n");
   fprintf(output, "                           syntax\n");
+  fprintf(output, "  --filter-cutoff          stop dissecting a packet after the protocols\n");
+  fprintf(output, "                           the display filter refers to\n");
+  fprintf(output, "  -M <packet count>        start a new dissection session after this many\n");
+  fprintf(output, "                           packets, freeing all conversation and\n");
+  fprintf(output, "                           reassembly state\n");
+  fprintf(output, "  --session-memory <MiB>   start a new dissection session once the\n");
+  fprintf(output, "                           protocols hold this much memory\n");
+  fprintf(output, "  --startup-profile        report how long each part of startup took\n");
   fprintf(output, "  -n                       disable all name resolutions (def: all enabled)\n");
   fprintf(output, "  -N <name resolve flags>  enable specific name resolution(s): \"mntC\"\n");
   fprintf(output, "  -d %s ...\n", decode_as_arg_template);
@@ -362,10 +430,10 @@ print_usage(FILE *output)
   fprintf(output, "  -P                       print packet summary even when writing to a file\n");
   fprintf(output, "  -S <separator>           the line separator to print between packets\n");
   fprintf(output, "  -x                       add output of hex and ASCII dump (Packet Bytes)\n");
-  fprintf(output, "  -T pdml|ps|psml|text|fields\n");
+  fprintf(output, "  -T pdml|ps|psml|json|ek|text|fields|arrow\n");
   fprintf(output, "                           format of text output (def: text)\n");
-  fprintf(output, "  -e <field>               field to print if -Tfields selected (e.g. tcp.port,\n");
-  fprintf(output, "                           _ws.col.Info)\n");
+  fprintf(output, "  -e <field>               field to print if -Tfields or -Tarrow selected (e.g.\n");
+  fprintf(output, "                           tcp.port, _ws.col.Info)\n");
   fprintf(output, "                           this option can be repeated to print multiple fields\n");
   fprintf(output, "  -E<fieldsoption>=<value> set options for output when -Tfields selected:\n");
   fprintf(output, "     header=y|n            switch headers on and off\n");
@@ -941,6 +1009,134 @@ get_tshark_runtime_version_info(GString *str)
     epan_get_runtime_version_info(str);
 }
 
+/* End the current startup step, if any, and start a new one */
+static void
+startup_profile_mark(const char *phase, const char *name)
+{
+  startup_step_t  step;
+  startup_step_t *last;
+  gdouble         now;
+
+  if (!startup_profile)
+    return;
+
+  if (startup_timer == NULL) {
+    startup_timer = g_timer_new();
+    startup_steps = g_array_new(FALSE, FALSE, sizeof (startup_step_t));
+  }
+  now = g_timer_elapsed(startup_timer, NULL);
+
+  /* the open step's secs holds its start time until it's ended */
+  if (startup_steps->len > 0) {
+    last = &g_array_index(startup_steps, startup_step_t, startup_steps->len - 1);
+    last->secs = now - last->secs;
+  }
+
+  if (phase == NULL)
+    return;
+  step.phase = phase;
+  step.name = g_strdup(name);
+  step.secs = now;
+  g_array_append_val(startup_steps, step);
+}
+
+/* Called by libwireshark before each registration and handoff routine */
+static void
+startup_profile_cb(register_action_e action, const char *message, gpointer client_data _U_)
+{
+  const char *phase;
+
+  switch (action) {
+  case RA_REGISTER:
+    phase = "registration";
+    break;
+  case RA_PLUGIN_REGISTER:
+    phase = "plugin registration";
+    break;
+  case RA_HANDOFF:
+    phase = "handoff";
+    break;
+  case RA_PLUGIN_HANDOFF:
+    phase = "plugin handoff";
+    break;
+  case RA_LUA_PLUGINS:
+    phase = "Lua plugins";
+    break;
+  default:
+    phase = "libwireshark";
+    break;
+  }
+  startup_profile_mark(phase, message);
+}
+
+static gint
+startup_step_compare(gconstpointer a, gconstpointer b)
+{
+  const startup_step_t *step_a = (const startup_step_t *)a;
+  const startup_step_t *step_b = (const startup_step_t *)b;
+
+  if (step_a->secs > step_b->secs)
+    return -1;
+  if (step_a->secs < step_b->secs)
+    return 1;
+  return 0;
+}
+
+/* End the current step and write the phase totals and the slowest steps
+   to the standard error */
+static void
+startup_profile_report(void)
+{
+  GArray         *phases;
+  startup_step_t *step;
+  startup_step_t *phase;
+  gdouble         total = 0.0;
+  guint           i, j;
+
+  if (!startup_profile || startup_steps == NULL)
+    return;
+  startup_profile_mark(NULL, NULL);
+
+  /* Phase totals, in the order the phases first appeared */
+  phases = g_array_new(FALSE, FALSE, sizeof (startup_step_t));
+  for (i = 0; i < startup_steps->len; i++) {
+    step = &g_array_index(startup_steps, startup_step_t, i);
+    total += step->secs;
+    for (j = 0; j < phases->len; j++) {
+      phase = &g_array_index(phases, startup_step_t, j);
+      if (strcmp(phase->phase, step->phase) == 0) {
+        phase->secs += step->secs;
+        break;
+      }
+    }
+    if (j == phases->len)
+      g_array_append_vals(phases, step, 1);
+  }
+
+  fprintf(stderr, "Startup profile: %.3f seconds\n", total);
+  fprintf(stderr, "  By phase:\n");
+  for (j = 0; j < phases->len; j++) {
+    phase = &g_array_index(phases, startup_step_t, j);
+    fprintf(stderr, "  %9.3f  %s\n", phase->secs, phase->phase);
+  }
+  g_array_free(phases, TRUE);
+
+  g_array_sort(startup_steps, startup_step_compare);
+  fprintf(stderr, "  Slowest steps:\n");
+  for (i = 0; i < startup_steps->len && i < STARTUP_PROFILE_TOP_STEPS; i++) {
+    step = &g_array_index(startup_steps, startup_step_t, i);
+    fprintf(stderr, "  %9.3f  %s%s%s\n", step->secs, step->phase,
+            step->name ? ": " : "", step->name ? step->name : "");
+  }
+
+  for (i = 0; i < startup_steps->len; i++)
+    g_free(g_array_index(startup_steps, startup_step_t, i).name);
+  g_array_free(startup_steps, TRUE);
+  startup_steps = NULL;
+  g_timer_destroy(startup_timer);
+  startup_timer = NULL;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -951,6 +1147,9 @@ main(int argc, char *argv[])
   static const struct option long_options[] = {
     {(char *)"help", no_argument, NULL, 'h'},
     {(char *)"version", no_argument, NULL, 'v'},
+    {(char *)"filter-cutoff", no_argument, NULL, LONGOPT_FILTER_CUTOFF},
+    {(char *)"session-memory", required_argument, NULL, LONGOPT_SESSION_MEMORY},
+    {(char *)"startup-profile", no_argument, NULL, LONGOPT_STARTUP_PROFILE},
     LONGOPT_CAPTURE_COMMON
     {0, 0, 0, 0 }
   };
@@ -1018,7 +1217,7 @@ main(int argc, char *argv[])
  * We do *not* use a leading - because the behavior of a leading - is
  * platform-dependent.
  */
-#define OPTSTRING "+2" OPTSTRING_CAPTURE_COMMON "C:d:e:E:F:gG:hH:" "K:lnN:o:O:PqQr:R:S:t:T:u:vVw:W:xX:Y:z:"
+#define OPTSTRING "+2" OPTSTRING_CAPTURE_COMMON "C:d:e:E:F:gG:hH:" "K:lM:nN:o:O:PqQr:R:S:t:T:u:vVw:W:xX:Y:z:"
 
   static const char    optstring[] = OPTSTRING;
 
@@ -1126,6 +1325,10 @@ main(int argc, char *argv[])
     case 'X':
       ex_opt_add(optarg);
       break;
+    case LONGOPT_STARTUP_PROFILE:
+      startup_profile = TRUE;
+      startup_profile_mark("startup", "early initialization");
+      break;
     default:
       break;
     }
@@ -1188,6 +1391,7 @@ main(int argc, char *argv[])
 
   /* Scan for plugins.  This does *not* call their registration routines;
      that's done later. */
+  startup_profile_mark("plugins", "scanning for plugins");
   scan_plugins();
 
   /* Register all libwiretap plugin modules. */
@@ -1198,7 +1402,10 @@ main(int argc, char *argv[])
      "-G" flag, as the "-G" flag dumps information registered by the
      dissectors, and we must do it before we read the preferences, in
      case any dissectors register preferences. */
-  epan_init(register_all_protocols, register_all_protocol_handoffs, NULL, NULL);
+  startup_profile_mark("libwireshark", "core initialization");
+  epan_init(register_all_protocols, register_all_protocol_handoffs,
+            startup_profile ? startup_profile_cb : NULL, NULL);
+  startup_profile_mark("tap listeners", NULL);
 
   /* Register all tap listeners; we do this before we parse the arguments,
      as the "-z" argument can specify a registered tap. */
@@ -1270,8 +1477,10 @@ main(int argc, char *argv[])
     return 0;
   }
 
+  startup_profile_mark("preferences", "reading preferences files");
   prefs_p = read_prefs(&gpf_open_errno, &gpf_read_errno, &gpf_path,
                      &pf_open_errno, &pf_read_errno, &pf_path);
+  startup_profile_mark("startup", "command-line options");
   if (gpf_path != NULL) {
     if (gpf_open_errno != 0) {
       cmdarg_err("Can't open global preferences file \"%s\": %s.",
@@ -1498,6 +1707,9 @@ main(int argc, char *argv[])
       arg_error = TRUE;
 #endif
       break;
+    case 'M':        /* Start a new dissection session every N packets */
+      epan_auto_reset_count = get_positive_int(optarg, "session auto reset count");
+      break;
     case 'n':        /* No name resolution */
       gbl_resolv_flags.mac_name = FALSE;
       gbl_resolv_flags.network_name = FALSE;
@@ -1611,10 +1823,31 @@ main(int argc, char *argv[])
         output_action = WRITE_FIELDS;
         print_details = TRUE;   /* Need full tree info */
         print_summary = FALSE;  /* Don't allow summary */
+      } else if (strcmp(optarg, "json") == 0) {
+        output_action = WRITE_JSON;
+        print_details = TRUE;   /* Need details */
+        print_summary = FALSE;  /* Don't allow summary */
+      } else if (strcmp(optarg, "ek") == 0) {
+        output_action = WRITE_EK;
+        print_details = TRUE;   /* Need details */
+        print_summary = FALSE;  /* Don't allow summary */
+      } else if (strcmp(optarg, "arrow") == 0) {
+        output_action = WRITE_ARROW;
+        print_details = TRUE;   /* Need full tree info */
+        print_summary = FALSE;  /* Don't allow summary */
+#ifdef _WIN32
+        _setmode(fileno(stdout), O_BINARY);
+#endif
       } else {
         cmdarg_err("Invalid -T parameter \"%s\"; it must be one of:", optarg);                   /* x */
-        cmdarg_err_cont("\t\"fields\" The values of fields specified with the -e option, in a form\n"
+        cmdarg_err_cont("\t\"arrow\"  The values of fields specified with the -e option, as an\n"
+                        "\t         Apache Arrow IPC stream with a column for each field.\n"
+                        "\t\"ek\"     Newline delimited JSON for bulk inserts into Elasticsearch,\n"
+                        "\t         with the values of each protocol's fields.\n"
+                        "\t\"fields\" The values of fields specified with the -e option, in a form\n"
                         "\t         specified by the -E option.\n"
+                        "\t\"json\"   A JSON array of the packets, with the details of each decoded\n"
+                        "\t         packet, equivalent to those printed with the -V flag.\n"
                         "\t\"pdml\"   Packet Details Markup Language, an XML-based format for the\n"
                         "\t         details of a decoded packet. This information is equivalent to\n"
                         "\t         the packet details printed with the -V flag.\n"
@@ -1689,6 +1922,15 @@ main(int argc, char *argv[])
         return 1;
       }
       break;
+    case LONGOPT_FILTER_CUTOFF:
+      filter_cutoff = TRUE;
+      break;
+    case LONGOPT_SESSION_MEMORY:
+      epan_auto_reset_memory = (guint64)get_positive_int(optarg, "session memory limit") * 1024 * 1024;
+      break;
+    case LONGOPT_STARTUP_PROFILE:
+      /* already processed; just ignore it now */
+      break;
     default:
     case '?':        /* Bad flag - print usage message */
       switch(optopt) {
@@ -1704,13 +1946,16 @@ main(int argc, char *argv[])
   }
 
   /* If we specified output fields, but not the output field type... */
-  if (WRITE_FIELDS != output_action && 0 != output_fields_num_fields(output_fields)) {
+  if (WRITE_FIELDS != output_action && WRITE_ARROW != output_action &&
+      0 != output_fields_num_fields(output_fields)) {
         cmdarg_err("Output fields were specified with \"-e\", "
-            "but \"-Tfields\" was not specified.");
+            "but \"-Tfields\" or \"-Tarrow\" was not specified.");
         return 1;
-  } else if (WRITE_FIELDS == output_action && 0 == output_fields_num_fields(output_fields)) {
-        cmdarg_err("\"-Tfields\" was specified, but no fields were "
-                    "specified with \"-e\".");
+  } else if ((WRITE_FIELDS == output_action || WRITE_ARROW == output_action) &&
+             0 == output_fields_num_fields(output_fields)) {
+        cmdarg_err("\"-T%s\" was specified, but no fields were "
+                    "specified with \"-e\".",
+                    WRITE_ARROW == output_action ? "arrow" : "fields");
 
         return 1;
   }
@@ -1816,6 +2061,17 @@ main(int argc, char *argv[])
     return 1;
   }
 
+  if ((epan_auto_reset_count != 0 || epan_auto_reset_memory != 0) &&
+      perform_two_pass_analysis) {
+    cmdarg_err("-M and --session-memory can't be used with -2, as the second pass needs the state of the first.");
+    return 1;
+  }
+
+  /* Count the protocols' file-scope memory so that we know when to
+     start a new session. */
+  if (epan_auto_reset_memory != 0)
+    set_memory_accounting(TRUE);
+
 #ifdef HAVE_LIBPCAP
   if (list_link_layer_types) {
     /* We're supposed to list the link-layer types for an interface;
@@ -1972,7 +2228,9 @@ main(int argc, char *argv[])
   /* Notify all registered modules that have had any of their preferences
      changed either from one of the preferences file or from the command
      line that their preferences have changed. */
+  startup_profile_mark("preferences", "applying preferences");
   prefs_apply_all();
+  startup_profile_mark("startup", "statistics and output setup");
 
   /* At this point MATE will have registered its field array so we can
      have a tap filter with one of MATE's late-registered fields as part
@@ -2026,6 +2284,7 @@ main(int argc, char *argv[])
   capture_opts_trim_ring_num_files(&global_capture_opts);
 #endif
 
+  startup_profile_mark("filters", "compiling filters");
   if (rfilter != NULL) {
     if (!dfilter_compile(rfilter, &rfcode, &err_msg)) {
       cmdarg_err("%s", err_msg);
@@ -2111,10 +2370,12 @@ main(int argc, char *argv[])
     /*
      * We're reading a capture file.
      */
+    startup_profile_mark("capture file", "opening the file");
     if (cf_open(&cfile, cf_name, in_file_type, FALSE, &err) != CF_OK) {
       epan_cleanup();
       return 2;
     }
+    startup_profile_report();
 
     /* Process the packets in the file */
     TRY {
@@ -2228,6 +2489,7 @@ main(int argc, char *argv[])
      * be an easy fix.  We just ignore the return value for now.
      * Instead, pass on the exit status from the capture child.
      */
+    startup_profile_report();
     capture();
     exit_status = global_capture_session.fork_child_status;
 
@@ -2503,6 +2765,18 @@ capture(void)
   fflush(stderr);
   g_string_free(str, TRUE);
 
+#ifdef HAVE_CAPTURE_SHM
+  /* If we're going to read every packet dumpcap writes, and there's only
+     one file, have dumpcap hand us the packets in memory as well. */
+  if (do_dissection && !global_capture_opts.multi_files_on) {
+    int shm_err;
+
+    capture_ring = capture_shm_create(CAPTURE_SHM_DEFAULT_SIZE, &shm_err);
+    if (capture_ring != NULL)
+      global_capture_session.shm_fd = capture_shm_fd(capture_ring);
+  }
+#endif
+
   ret = sync_pipe_start(&global_capture_opts, &global_capture_session, NULL);
 
   if (!ret)
@@ -2662,6 +2936,8 @@ capture_input_new_file(capture_session *cap_session, gchar *new_file)
     /* Attempt to open the capture file and set up to read from it. */
     switch(cf_open((capture_file *)cap_session->cf, capture_opts->save_file, WTAP_TYPE_AUTO, is_tempfile, &err)) {
     case CF_OK:
+      /* dumpcap is still writing it */
+      wtap_set_file_growing(((capture_file *)cap_session->cf)->wth);
       break;
     case CF_ERROR:
       /* Don't unlink (delete) the save file - leave it around,
@@ -2678,6 +2954,70 @@ capture_input_new_file(capture_session *cap_session, gchar *new_file)
 }
 
 
+#ifdef HAVE_CAPTURE_SHM
+/*
+ * Process up to to_read packets from the capture ring.  If the ring runs
+ * out, because dumpcap stopped using it, or has a packet that needs a
+ * pseudo-header that only wiretap can supply, skip over the packets
+ * already processed in the capture file and stop using the ring; the
+ * rest are read from the file.  Returns the number of packets left to
+ * read.
+ */
+static int
+read_capture_ring(capture_session *cap_session, capture_file *cf,
+                  epan_dissect_t **edt, int to_read, guint tap_flags)
+{
+  capture_shm_record  rec;
+  const guint8       *pd;
+  struct wtap_pkthdr  phdr;
+  int                 err;
+  gchar              *err_info;
+  gint64              data_offset;
+
+  while (to_read > 0 && cf->wth) {
+    if (!capture_shm_peek(capture_ring, &rec, &pd) ||
+        wtap_encap_requires_phdr(rec.linktype)) {
+      while (capture_ring_packets != 0 && cf->wth) {
+        wtap_cleareof(cf->wth);
+        if (!wtap_read(cf->wth, &err, &err_info, &data_offset)) {
+          /* read from file failed, tell the capture child to stop */
+          sync_pipe_stop(cap_session);
+          wtap_close(cf->wth);
+          cf->wth = NULL;
+        }
+        capture_ring_packets--;
+      }
+      capture_shm_free(capture_ring);
+      capture_ring = NULL;
+      break;
+    }
+
+    memset(&phdr, 0, sizeof phdr);
+    phdr.rec_type = REC_TYPE_PACKET;
+    phdr.presence_flags = WTAP_HAS_TS|WTAP_HAS_CAP_LEN;
+    if (wtap_file_type_subtype(cf->wth) == WTAP_FILE_TYPE_SUBTYPE_PCAPNG) {
+      phdr.presence_flags |= WTAP_HAS_INTERFACE_ID;
+      phdr.interface_id = rec.interface_id;
+    }
+    phdr.ts.secs = (time_t)rec.secs;
+    phdr.ts.nsecs = (int)rec.nsecs;
+    phdr.caplen = rec.caplen;
+    phdr.len = rec.len;
+    phdr.pkt_encap = wtap_pcap_encap_to_wtap_encap(rec.linktype);
+    phdr.pkt_tsprec = wtap_file_tsprec(cf->wth);
+    if (process_packet(cf, *edt, rec.file_offset, &phdr, pd, tap_flags)) {
+      /* packet successfully read and gone through the "Read Filter" */
+      packet_count++;
+    }
+    reset_epan_mem(cf, edt);
+    capture_shm_remove(capture_ring, &rec);
+    capture_ring_packets++;
+    to_read--;
+  }
+  return to_read;
+}
+#endif
+
 /* capture child tells us we have new packets to read */
 void
 capture_input_new_packets(capture_session *cap_session, int to_read)
@@ -2704,6 +3044,7 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
 
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
+  set_used_columns(cf, tap_flags);
 
   if (do_dissection) {
     gboolean create_proto_tree;
@@ -2715,11 +3056,12 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
     else
       create_proto_tree = FALSE;
 
-    /* The protocol tree will be "visible", i.e., printed, only if we're
-       printing packet details, which is true if we're printing stuff
-       ("print_packet_info" is true) and we're in verbose mode
-       ("packet_details" is true). */
-    edt = epan_dissect_new(cf->epan, create_proto_tree, print_packet_info && print_details);
+    edt = new_packet_edt(cf, create_proto_tree);
+
+#ifdef HAVE_CAPTURE_SHM
+    if (capture_ring != NULL)
+      to_read = read_capture_ring(cap_session, cf, &edt, to_read, tap_flags);
+#endif
 
     while (to_read-- && cf->wth) {
       wtap_cleareof(cf->wth);
@@ -2733,6 +3075,7 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
         ret = process_packet(cf, edt, data_offset, wtap_phdr(cf->wth),
                              wtap_buf_ptr(cf->wth),
                              tap_flags);
+        reset_epan_mem(cf, &edt);
       }
       if (ret != FALSE) {
         /* packet successfully read and gone through the "Read Filter" */
@@ -2981,6 +3324,80 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
   return passed;
 }
 
+/*
+ * Create the epan_dissect_t used to dissect packets.
+ *
+ * The protocol tree will be "visible", i.e., printed, only if we're
+ * printing packet details, which is true if we're printing stuff
+ * ("print_packet_info" is true) and we're in verbose mode
+ * ("packet_details" is true).  If all we're printing is the values of
+ * fields, the tree only needs the fields we print, which are primed with
+ * output_fields_prime_edt(), so it needn't be visible; if we print all
+ * the fields' values, don't bother formatting the text of the items.
+ */
+static epan_dissect_t *
+new_packet_edt(capture_file *cf, gboolean create_proto_tree)
+{
+  epan_dissect_t *edt;
+  gboolean        visible = print_packet_info && print_details;
+
+  if ((output_action == WRITE_FIELDS || output_action == WRITE_ARROW) &&
+      !output_fields_need_labels(output_fields))
+    visible = FALSE;
+  edt = epan_dissect_new(cf->epan, create_proto_tree, visible);
+  if (edt->tree && visible && output_action == WRITE_EK)
+    proto_tree_set_labels(edt->tree, FALSE);
+  return edt;
+}
+
+static void
+sum_file_scope_memory(int owner _U_, guint64 bytes, guint64 allocs _U_,
+                      void *user_data)
+{
+  *(guint64 *)user_data += bytes;
+}
+
+/*
+ * Called after each packet is dissected in a single pass; if -M or
+ * --session-memory says it's time, throw away the dissection session,
+ * and with it everything the dissectors have kept in file scope
+ * (conversations, reassembly tables, per-frame protocol data), and
+ * start a new one.  Frame numbers carry on from where they were, but
+ * any conversation or reassembly in progress is started afresh.
+ */
+static void
+reset_epan_mem(capture_file *cf, epan_dissect_t **edt)
+{
+  gboolean reset = FALSE;
+  gboolean create_proto_tree;
+
+  if (epan_auto_reset_count == 0 && epan_auto_reset_memory == 0)
+    return;
+
+  epan_reset_packets++;
+  if (epan_auto_reset_count != 0 && epan_reset_packets >= epan_auto_reset_count)
+    reset = TRUE;
+  if (!reset && epan_auto_reset_memory != 0 &&
+      epan_reset_packets % EPAN_MEMORY_CHECK_INTERVAL == 0) {
+    guint64 bytes = 0;
+
+    /* The counts don't go down when memory is freed, so this is an
+       upper bound on what's in use. */
+    wmem_accounting_foreach(wmem_file_scope(), sum_file_scope_memory, &bytes);
+    if (bytes >= epan_auto_reset_memory)
+      reset = TRUE;
+  }
+  if (!reset)
+    return;
+
+  create_proto_tree = (*edt)->tree != NULL;
+  epan_dissect_free(*edt);
+  epan_free(cf->epan);
+  cf->epan = tshark_epan_new(cf);
+  *edt = new_packet_edt(cf, create_proto_tree);
+  epan_reset_packets = 0;
+}
+
 static gboolean
 process_packet_second_pass(capture_file *cf, epan_dissect_t *edt, frame_data *fdata,
                struct wtap_pkthdr *phdr, Buffer *buf,
@@ -3010,6 +3427,10 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt, frame_data *fd
 
     col_custom_prime_edt(edt, &cf->cinfo);
 
+    if (print_packet_info &&
+        (output_action == WRITE_FIELDS || output_action == WRITE_ARROW))
+      output_fields_prime_edt(output_fields, edt);
+
     /* We only need the columns if either
          1) some tap needs the columns
        or
@@ -3028,11 +3449,20 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt, frame_data *fd
       ref = &ref_frame;
     }
 
-    epan_dissect_run_with_taps(edt, cf->cd_t, phdr, frame_tvbuff_new_buffer(fdata, buf), fdata, cinfo);
+    /* The first pass has already built up whatever state later packets
+       depend on, so a packet that the display filter rejects from its
+       frame header and raw bytes alone needn't be dissected again,
+       unless some tap wants to see every packet. */
+    if (cf->dfcode && !tap_listeners_require_dissection() &&
+        !dfilter_prefilter_packet(cf->dfcode, fdata->num, phdr, ws_buffer_start_ptr(buf))) {
+      passed = FALSE;
+    } else {
+      epan_dissect_run_with_taps(edt, cf->cd_t, phdr, frame_tvbuff_new_buffer(fdata, buf), fdata, cinfo);
 
-    /* Run the read/display filter if we have one. */
-    if (cf->dfcode)
-      passed = dfilter_apply_edt(cf->dfcode, edt);
+      /* Run the read/display filter if we have one. */
+      if (cf->dfcode)
+        passed = dfilter_apply_edt(cf->dfcode, edt);
+    }
   }
 
   if (passed) {
@@ -3081,6 +3511,20 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt, frame_data *fd
   return passed || fdata->flags.dependent_of_displayed;
 }
 
+/*
+ * If the only thing that reads the columns is "_ws.col." fields, don't
+ * have the dissectors fill in the other columns.
+ */
+static void
+set_used_columns(capture_file *cf, guint tap_flags)
+{
+  if (!(tap_flags & TL_REQUIRES_COLUMNS) && print_packet_info && !print_summary &&
+      output_fields_has_cols(output_fields))
+    output_fields_set_cols_used(output_fields, &cf->cinfo);
+  else
+    col_set_all_used(&cf->cinfo, TRUE);
+}
+
 static int
 load_cap_file(capture_file *cf, char *save_file, int out_file_type,
     gboolean out_file_name_res, int max_packet_count, gint64 max_byte_count)
@@ -3191,6 +3635,7 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
 
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
+  set_used_columns(cf, tap_flags);
 
   if (perform_two_pass_analysis) {
     frame_data *fdata;
@@ -3251,11 +3696,7 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
       else
            create_proto_tree = FALSE;
 
-      /* The protocol tree will be "visible", i.e., printed, only if we're
-         printing packet details, which is true if we're printing stuff
-         ("print_packet_info" is true) and we're in verbose mode
-         ("packet_details" is true). */
-      edt = epan_dissect_new(cf->epan, create_proto_tree, print_packet_info && print_details);
+      edt = new_packet_edt(cf, create_proto_tree);
     }
 
     for (framenum = 1; err == 0 && framenum <= cf->count; framenum++) {
@@ -3367,11 +3808,7 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
       else
         create_proto_tree = FALSE;
 
-      /* The protocol tree will be "visible", i.e., printed, only if we're
-         printing packet details, which is true if we're printing stuff
-         ("print_packet_info" is true) and we're in verbose mode
-         ("packet_details" is true). */
-      edt = epan_dissect_new(cf->epan, create_proto_tree, print_packet_info && print_details);
+      edt = new_packet_edt(cf, create_proto_tree);
     }
 
     while (wtap_read(cf->wth, &err, &err_info, &data_offset)) {
@@ -3458,6 +3895,8 @@ load_cap_file(capture_file *cf, char *save_file, int out_file_type,
         err = 0; /* This is not an error */
         break;
       }
+      if (edt)
+        reset_epan_mem(cf, &edt);
     }
 
     if (edt) {
@@ -3597,6 +4036,10 @@ process_packet(capture_file *cf, epan_dissect_t *edt, gint64 offset, struct wtap
 
     col_custom_prime_edt(edt, &cf->cinfo);
 
+    if (print_packet_info &&
+        (output_action == WRITE_FIELDS || output_action == WRITE_ARROW))
+      output_fields_prime_edt(output_fields, edt);
+
     /* We only need the columns if either
          1) some tap needs the columns
        or
@@ -3616,6 +4059,13 @@ process_packet(capture_file *cf, epan_dissect_t *edt, gint64 offset, struct wtap
       ref = &ref_frame;
     }
 
+    /* If all we want to know is whether the packet passes the filter,
+       there's no need to go any further up the stack than the protocols
+       the filter refers to, if we've been asked not to. */
+    if (filter_cutoff && cf->dfcode && !print_packet_info && cinfo == NULL &&
+        !tap_listeners_require_dissection())
+      epan_dissect_set_cutoff(edt, dfilter_get_cutoff_protocols(cf->dfcode));
+
     epan_dissect_run_with_taps(edt, cf->cd_t, whdr, frame_tvbuff_new(&fdata, pd), &fdata, cinfo);
 
     /* Run the filter if we have it. */
@@ -3695,6 +4145,17 @@ write_preamble(capture_file *cf)
     write_fields_preamble(output_fields, stdout);
     return !ferror(stdout);
 
+  case WRITE_JSON:
+    write_json_preamble(stdout);
+    return !ferror(stdout);
+
+  case WRITE_EK:
+    return TRUE;
+
+  case WRITE_ARROW:
+    write_arrow_preamble(output_fields, stdout);
+    return !ferror(stdout);
+
   default:
     g_assert_not_reached();
     return FALSE;
@@ -3996,6 +4457,9 @@ print_packet(capture_file *cf, epan_dissect_t *edt)
         write_psml_columns(edt, stdout);
         return !ferror(stdout);
       case WRITE_FIELDS: /*No non-verbose "fields" format */
+      case WRITE_JSON:
+      case WRITE_EK:
+      case WRITE_ARROW:
         g_assert_not_reached();
         break;
       }
@@ -4034,6 +4498,15 @@ print_packet(capture_file *cf, epan_dissect_t *edt)
       write_fields_proto_tree(output_fields, edt, &cf->cinfo, stdout);
       printf("\n");
       return !ferror(stdout);
+    case WRITE_JSON:
+      write_json_proto_tree(edt, stdout);
+      return !ferror(stdout);
+    case WRITE_EK:
+      write_ek_proto_tree(edt, stdout);
+      return !ferror(stdout);
+    case WRITE_ARROW:
+      write_arrow_proto_tree(output_fields, edt, &cf->cinfo, stdout);
+      return !ferror(stdout);
     }
   }
   if (print_hex) {
@@ -4068,6 +4541,17 @@ write_finale(void)
     write_fields_finale(output_fields, stdout);
     return !ferror(stdout);
 
+  case WRITE_JSON:
+    write_json_finale(stdout);
+    return !ferror(stdout);
+
+  case WRITE_EK:
+    return TRUE;
+
+  case WRITE_ARROW:
+    write_arrow_finale(output_fields, stdout);
+    return !ferror(stdout);
+
   default:
     g_assert_not_reached();
     return FALSE;
@@ -0,0 +1,153 @@
+/* tap-cpustat.c
+ * Dissector timing statistics for tshark
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/* This module reports, at the end of the run, how often each protocol's
+ * dissectors were called and how long they took.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/dissector_profile.h>
+
+void register_tap_listener_cpustat(void);
+
+static int already_enabled = 0;
+
+static int
+cpustat_packet(void *dummy _U_, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *dummy2 _U_)
+{
+	/* The profiler keeps the counts */
+	return 0;
+}
+
+static void
+cpustat_collect(const dissector_profile_t *profile, void *user_data)
+{
+	GArray *protos = (GArray *)user_data;
+
+	g_array_append_val(protos, *profile);
+}
+
+static gint
+cpustat_compare(gconstpointer a, gconstpointer b)
+{
+	const dissector_profile_t *pa = (const dissector_profile_t *)a;
+	const dissector_profile_t *pb = (const dissector_profile_t *)b;
+
+	/* Slowest first */
+	if (pa->self_ns != pb->self_ns)
+		return pa->self_ns < pb->self_ns ? 1 : -1;
+	return pa->proto_id - pb->proto_id;
+}
+
+static void
+cpustat_draw(void *dummy _U_)
+{
+	GArray *protos;
+	guint64 total_ns = 0;
+	guint i;
+
+	protos = g_array_new(FALSE, FALSE, sizeof(dissector_profile_t));
+	dissector_profile_foreach(cpustat_collect, protos);
+	g_array_sort(protos, cpustat_compare);
+
+	for (i = 0; i < protos->len; i++)
+		total_ns += g_array_index(protos, dissector_profile_t, i).self_ns;
+
+	printf("\n");
+	printf("=========================================================================================\n");
+	printf("Dissector Time by Protocol:\n");
+	printf("%-24s %12s %12s %12s %7s %12s\n",
+	       "Protocol", "Calls", "Rejected", "Self (ms)", "Self %", "Total (ms)");
+	for (i = 0; i < protos->len; i++) {
+		dissector_profile_t *profile = &g_array_index(protos, dissector_profile_t, i);
+
+		printf("%-24s %12" G_GINT64_MODIFIER "u %12" G_GINT64_MODIFIER "u"
+		       " %12.3f %6.2f%% %12.3f\n",
+		       proto_get_protocol_short_name(find_protocol_by_id(profile->proto_id)),
+		       profile->calls, profile->rejected,
+		       profile->self_ns / 1e6,
+		       total_ns ? 100.0 * profile->self_ns / total_ns : 0.0,
+		       profile->total_ns / 1e6);
+	}
+	printf("%-24s %12s %12s %12.3f\n", "Total", "", "", total_ns / 1e6);
+	printf("=========================================================================================\n");
+
+	g_array_free(protos, TRUE);
+}
+
+static void
+cpustat_init(const char *opt_arg _U_, void *userdata _U_)
+{
+	GString *error_string;
+
+	if (already_enabled) {
+		return;
+	}
+	already_enabled = 1;
+
+	set_dissector_profiling(TRUE);
+
+	error_string = register_tap_listener("frame", NULL, NULL, 0, NULL, cpustat_packet, cpustat_draw);
+	if (error_string) {
+		fprintf(stderr, "tshark: Couldn't register cpu,proto tap: %s\n",
+			error_string->str);
+		g_string_free(error_string, TRUE);
+		exit(1);
+	}
+}
+
+static stat_tap_ui cpustat_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	"cpu,proto",
+	cpustat_init,
+	-1,
+	0,
+	NULL
+};
+
+void
+register_tap_listener_cpustat(void)
+{
+	register_stat_tap_ui(&cpustat_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
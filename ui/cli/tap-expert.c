@@ -56,13 +56,40 @@ typedef struct expert_entry
 } expert_entry;
 
 
+/* What makes an entry distinct */
+typedef struct expert_key
+{
+    const gchar *protocol;
+    const gchar *summary;
+} expert_key;
+
 /* Overall struct for storing all data seen */
 typedef struct expert_tapdata_t {
     GArray       *ei_array[max_level]; /* expert info items */
+    GHashTable   *ei_index[max_level]; /* expert_key -> index in ei_array + 1 */
     GStringChunk *text;         /* for efficient storage of summary strings */
 } expert_tapdata_t;
 
 
+static guint
+expert_key_hash(gconstpointer k)
+{
+    const expert_key *key = (const expert_key *)k;
+
+    return g_str_hash(key->summary) ^ g_str_hash(key->protocol);
+}
+
+static gboolean
+expert_key_equal(gconstpointer a, gconstpointer b)
+{
+    const expert_key *ka = (const expert_key *)a;
+    const expert_key *kb = (const expert_key *)b;
+
+    return strcmp(ka->summary, kb->summary) == 0 &&
+           strcmp(ka->protocol, kb->protocol) == 0;
+}
+
+
 /* Reset expert stats */
 static void
 expert_stat_reset(void *tapdata)
@@ -77,6 +104,7 @@ expert_stat_reset(void *tapdata)
     /* Empty each of the arrays */
     for (n=0; n < max_level; n++) {
         g_array_set_size(etd->ei_array[n], 0);
+        g_hash_table_remove_all(etd->ei_index[n]);
     }
 }
 
@@ -90,7 +118,9 @@ expert_stat_packet(void *tapdata, packet_info *pinfo _U_, epan_dissect_t *edt _U
     severity_level_t     severity_level;
     expert_entry         tmp_entry;
     expert_entry        *entry;
-    guint                n;
+    expert_key           key;
+    expert_key          *new_key;
+    gpointer             idx;
 
     switch (ei->severity) {
         case PI_CHAT:
@@ -115,15 +145,15 @@ expert_stat_packet(void *tapdata, packet_info *pinfo _U_, epan_dissect_t *edt _U
         return 1;
     }
 
-    /* If a duplicate just bump up frequency.
-       TODO: could make more efficient by avoiding linear search...*/
-    for (n=0; n < data->ei_array[severity_level]->len; n++) {
-        entry = &g_array_index(data->ei_array[severity_level], expert_entry, n);
-        if ((strcmp(ei->protocol, entry->protocol) == 0) &&
-            (strcmp(ei->summary, entry->summary) == 0)) {
-            entry->frequency++;
-            return 1;
-        }
+    /* If a duplicate just bump up frequency. */
+    key.protocol = ei->protocol;
+    key.summary = ei->summary;
+    idx = g_hash_table_lookup(data->ei_index[severity_level], &key);
+    if (idx != NULL) {
+        entry = &g_array_index(data->ei_array[severity_level], expert_entry,
+                               GPOINTER_TO_UINT(idx) - 1);
+        entry->frequency++;
+        return 1;
     }
 
     /* Else Add new item to end of list for severity level */
@@ -136,6 +166,13 @@ expert_stat_packet(void *tapdata, packet_info *pinfo _U_, epan_dissect_t *edt _U
     /* Store a copy of the expert entry */
     g_array_append_val(data->ei_array[severity_level], tmp_entry);
 
+    /* And index it by its (stored) strings */
+    new_key = g_new(expert_key, 1);
+    new_key->protocol = entry->protocol;
+    new_key->summary = entry->summary;
+    g_hash_table_insert(data->ei_index[severity_level], new_key,
+                        GUINT_TO_POINTER(data->ei_array[severity_level]->len));
+
     return 1;
 }
 
@@ -242,6 +279,8 @@ static void expert_stat_init(const char *opt_arg, void *userdata _U_)
     /* Allocate GArray for each severity level */
     for (n=0; n < max_level; n++) {
         hs->ei_array[n] = g_array_sized_new(FALSE, FALSE, sizeof(expert_entry), 1000);
+        hs->ei_index[n] = g_hash_table_new_full(expert_key_hash, expert_key_equal,
+                                                g_free, NULL);
     }
 
     /**********************************************/
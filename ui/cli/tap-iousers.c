@@ -50,6 +50,22 @@ iousers_draw(void *arg)
 	printf("================================================================================\n");
 	printf("%s Conversations\n", iu->type);
 	printf("Filter:%s\n", iu->filter ? iu->filter : "<No Filter>");
+	if (iu->hash.max_items) {
+		double error;
+		guint64 distinct = conversation_table_distinct(&iu->hash, &error);
+		guint64 max_err = 0;
+
+		for (i=0; (iu->hash.conv_array && i < iu->hash.conv_array->len); i++) {
+			conv_item_t *item = &g_array_index(iu->hash.conv_array, conv_item_t, i);
+
+			if (item->err_frames > max_err) {
+				max_err = item->err_frames;
+			}
+		}
+		printf("Approximate: the %u busiest of about %" G_GINT64_MODIFIER "u conversations (+/-%.1f%%),\n",
+			iu->hash.max_items, distinct, 100.0 * error);
+		printf("             frame counts may be up to %" G_GINT64_MODIFIER "u low\n", max_err);
+	}
 
 	switch (timestamp_get_type()) {
 	case TS_ABSOLUTE:
@@ -216,12 +232,21 @@ void init_iousers(struct register_ct *ct, const char *filter)
 {
 	io_users_t *iu;
 	GString *error_string;
+	guint top;
+	int len;
 
 	iu = g_new0(io_users_t, 1);
 	iu->type = proto_get_protocol_short_name(find_protocol_by_id(get_conversation_proto_id(ct)));
-	iu->filter = g_strdup(filter);
 	iu->hash.user_data = iu;
 
+	/* "top=<n>" before the filter makes the table approximate */
+	if (filter && sscanf(filter, "top=%u%n", &top, &len) == 1 &&
+	    (filter[len] == '\0' || filter[len] == ',')) {
+		iu->hash.max_items = top;
+		filter = filter[len] ? filter + len + 1 : NULL;
+	}
+	iu->filter = g_strdup(filter);
+
 	error_string = register_tap_listener(proto_get_protocol_filter_name(get_conversation_proto_id(ct)), &iu->hash, filter, 0, NULL, get_conversation_packet_func(ct), iousers_draw);
 	if (error_string) {
 		g_free(iu);
@@ -134,8 +134,13 @@ typedef struct mac_lte_stat_t {
     guint16 number_of_rntis;
 
     mac_lte_ep_t  *ep_list;
+    mac_lte_ep_t  *ep_tail;     /* Last entry in ep_list */
+    GHashTable    *ep_table;    /* RNTI and UEId -> entry in ep_list */
 } mac_lte_stat_t;
 
+/* Key for ep_table */
+#define MAC_LTE_EP_KEY(rnti, ueid) GUINT_TO_POINTER(((guint)(rnti) << 16) | (ueid))
+
 
 /* Reset the statistics window */
 static void
@@ -143,6 +148,7 @@ mac_lte_stat_reset(void *phs)
 {
     mac_lte_stat_t *mac_lte_stat = (mac_lte_stat_t *)phs;
     mac_lte_ep_t *list = mac_lte_stat->ep_list;
+    mac_lte_ep_t *next;
 
     /* Reset counts of unique ueids & rntis */
     memset(mac_lte_stat->used_ueids, 0, 65535);
@@ -157,7 +163,13 @@ mac_lte_stat_reset(void *phs)
         return;
     }
 
+    g_hash_table_remove_all(mac_lte_stat->ep_table);
+    for (; list; list = next) {
+        next = list->next;
+        g_free(list);
+    }
     mac_lte_stat->ep_list = NULL;
+    mac_lte_stat->ep_tail = NULL;
 }
 
 
@@ -225,7 +237,7 @@ mac_lte_stat_packet(void *phs, packet_info *pinfo, epan_dissect_t *edt _U_,
 {
     /* Get reference to stat window instance */
     mac_lte_stat_t *hs = (mac_lte_stat_t *)phs;
-    mac_lte_ep_t *tmp = NULL, *te = NULL;
+    mac_lte_ep_t *te = NULL;
 
     /* Cast tap info struct */
     const struct mac_lte_tap_info *si = (const struct mac_lte_tap_info *)phi;
@@ -276,40 +288,22 @@ mac_lte_stat_packet(void *phs, packet_info *pinfo, epan_dissect_t *edt _U_,
             break;
     }
 
-    /* For per-UE data, must create a new row if none already existing */
-    if (!hs->ep_list) {
-        /* Allocate new list */
-        hs->ep_list = alloc_mac_lte_ep(si, pinfo);
-        /* Make it the first/only entry */
-        te = hs->ep_list;
-
-        /* Update counts of unique ueids & rntis */
-        update_ueid_rnti_counts(si->rnti, si->ueid, hs);
-    } else {
-        /* Look among existing rows for this RNTI */
-        for (tmp = hs->ep_list;(tmp != NULL); tmp = tmp->next) {
-            /* Match only by RNTI and UEId together */
-            if ((tmp->stats.rnti == si->rnti) &&
-                (tmp->stats.ueid == si->ueid)) {
-                te = tmp;
-                break;
+    /* For per-UE data, must create a new row if none already existing.
+       Match only by RNTI and UEId together */
+    te = (mac_lte_ep_t *)g_hash_table_lookup(hs->ep_table, MAC_LTE_EP_KEY(si->rnti, si->ueid));
+    if (te == NULL) {
+        if ((te = alloc_mac_lte_ep(si, pinfo))) {
+            /* Add new item to end of list */
+            if (hs->ep_tail) {
+                hs->ep_tail->next = te;
+            } else {
+                hs->ep_list = te;
             }
-        }
+            hs->ep_tail = te;
+            g_hash_table_insert(hs->ep_table, MAC_LTE_EP_KEY(si->rnti, si->ueid), te);
 
-        /* Not found among existing, so create a new one anyway */
-        if (te == NULL) {
-            if ((te = alloc_mac_lte_ep(si, pinfo))) {
-                /* Add new item to end of list */
-                mac_lte_ep_t *p = hs->ep_list;
-                while (p->next) {
-                    p = p->next;
-                }
-                p->next = te;
-                te->next = NULL;
-
-                /* Update counts of unique ueids & rntis */
-                update_ueid_rnti_counts(si->rnti, si->ueid, hs);
-            }
+            /* Update counts of unique ueids & rntis */
+            update_ueid_rnti_counts(si->rnti, si->ueid, hs);
         }
     }
 
@@ -527,6 +521,7 @@ static void mac_lte_stat_init(const char *opt_arg, void *userdata _U_)
     /* Create struct */
     hs = g_new0(mac_lte_stat_t, 1);
     hs->ep_list = NULL;
+    hs->ep_table = g_hash_table_new(g_direct_hash, g_direct_equal);
 
     error_string = register_tap_listener("mac-lte", hs,
                                          filter, 0,
@@ -535,6 +530,7 @@ static void mac_lte_stat_init(const char *opt_arg, void *userdata _U_)
                                          mac_lte_stat_draw);
     if (error_string) {
         g_string_free(error_string, TRUE);
+        g_hash_table_destroy(hs->ep_table);
         g_free(hs);
         exit(1);
     }
@@ -0,0 +1,217 @@
+/* tap-memstat.c
+ * File-scope memory by protocol for tshark
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/* This module reports, at the end of the run, how much file-scope memory
+ * each protocol allocated, and how much each memory scope was used.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+
+void register_tap_listener_memstat(void);
+
+typedef struct _memstat_proto_t {
+	int     proto_id;
+	guint64 bytes;
+	guint64 allocs;
+} memstat_proto_t;
+
+static int already_enabled = 0;
+static int scope_already_enabled = 0;
+
+static int
+memstat_packet(void *dummy _U_, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *dummy2 _U_)
+{
+	/* wmem keeps the counts */
+	return 0;
+}
+
+static void
+memstat_collect(int owner, guint64 bytes, guint64 allocs, void *user_data)
+{
+	GArray *protos = (GArray *)user_data;
+	memstat_proto_t item;
+
+	item.proto_id = owner;
+	item.bytes = bytes;
+	item.allocs = allocs;
+	g_array_append_val(protos, item);
+}
+
+static gint
+memstat_compare(gconstpointer a, gconstpointer b)
+{
+	const memstat_proto_t *pa = (const memstat_proto_t *)a;
+	const memstat_proto_t *pb = (const memstat_proto_t *)b;
+
+	/* Biggest first */
+	if (pa->bytes != pb->bytes)
+		return pa->bytes < pb->bytes ? 1 : -1;
+	return pa->proto_id - pb->proto_id;
+}
+
+static void
+memstat_draw(void *dummy _U_)
+{
+	GArray *protos;
+	guint64 total = 0;
+	guint i;
+
+	protos = g_array_new(FALSE, FALSE, sizeof(memstat_proto_t));
+	wmem_accounting_foreach(wmem_file_scope(), memstat_collect, protos);
+	g_array_sort(protos, memstat_compare);
+
+	printf("\n");
+	printf("=======================================================\n");
+	printf("File Scope Memory by Protocol:\n");
+	printf("%-24s %14s %14s\n", "Protocol", "Bytes", "Allocations");
+	for (i = 0; i < protos->len; i++) {
+		memstat_proto_t *item = &g_array_index(protos, memstat_proto_t, i);
+		const char *name;
+
+		if (item->proto_id == WMEM_NO_OWNER)
+			name = "(no protocol)";
+		else
+			name = proto_get_protocol_short_name(find_protocol_by_id(item->proto_id));
+		printf("%-24s %14" G_GINT64_MODIFIER "u %14" G_GINT64_MODIFIER "u\n",
+		       name, item->bytes, item->allocs);
+		total += item->bytes;
+	}
+	printf("%-24s %14" G_GINT64_MODIFIER "u\n", "Total", total);
+	printf("=======================================================\n");
+
+	g_array_free(protos, TRUE);
+}
+
+static void
+memstat_init(const char *opt_arg _U_, void *userdata _U_)
+{
+	GString *error_string;
+
+	if (already_enabled) {
+		return;
+	}
+	already_enabled = 1;
+
+	set_memory_accounting(TRUE);
+
+	error_string = register_tap_listener("frame", NULL, NULL, 0, NULL, memstat_packet, memstat_draw);
+	if (error_string) {
+		fprintf(stderr, "tshark: Couldn't register mem,proto tap: %s\n",
+			error_string->str);
+		g_string_free(error_string, TRUE);
+		exit(1);
+	}
+}
+
+static void
+memstat_scope_draw_pool(const char *name, wmem_allocator_t *pool)
+{
+	wmem_allocator_stats_t stats;
+
+	wmem_get_stats(pool, &stats);
+	printf("%-14s %12" G_GINT64_MODIFIER "u %10" G_GINT64_MODIFIER "u %10" G_GINT64_MODIFIER "u"
+	       " %14" G_GINT64_MODIFIER "u %10" G_GINT64_MODIFIER "u %12.1f %12" G_GINT64_MODIFIER "u\n",
+	       name, stats.allocs, stats.reallocs, stats.frees, stats.bytes, stats.free_alls,
+	       stats.free_alls ? (double)stats.bytes / stats.free_alls : 0.0,
+	       stats.peak_bytes);
+}
+
+static void
+memstat_scope_draw(void *dummy _U_)
+{
+	printf("\n");
+	printf("==============================================================================================\n");
+	printf("Memory Scope Usage:\n");
+	printf("%-14s %12s %10s %10s %14s %10s %12s %12s\n",
+	       "Scope", "Allocs", "Reallocs", "Frees", "Bytes", "Emptied", "Bytes/Empty", "Peak Bytes");
+	/* The packet scope is emptied after each packet */
+	memstat_scope_draw_pool("packet", wmem_packet_scope());
+	memstat_scope_draw_pool("file", wmem_file_scope());
+	memstat_scope_draw_pool("epan", wmem_epan_scope());
+	printf("==============================================================================================\n");
+}
+
+static void
+memstat_scope_init(const char *opt_arg _U_, void *userdata _U_)
+{
+	GString *error_string;
+
+	if (scope_already_enabled) {
+		return;
+	}
+	scope_already_enabled = 1;
+
+	error_string = register_tap_listener("frame", &scope_already_enabled, NULL, 0, NULL, memstat_packet, memstat_scope_draw);
+	if (error_string) {
+		fprintf(stderr, "tshark: Couldn't register mem,scope tap: %s\n",
+			error_string->str);
+		g_string_free(error_string, TRUE);
+		exit(1);
+	}
+}
+
+static stat_tap_ui memstat_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	"mem,proto",
+	memstat_init,
+	-1,
+	0,
+	NULL
+};
+
+static stat_tap_ui memstat_scope_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	"mem,scope",
+	memstat_scope_init,
+	-1,
+	0,
+	NULL
+};
+
+void
+register_tap_listener_memstat(void)
+{
+	register_stat_tap_ui(&memstat_ui, NULL);
+	register_stat_tap_ui(&memstat_scope_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
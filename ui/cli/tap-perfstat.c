@@ -0,0 +1,228 @@
+/* tap-perfstat.c
+ * Processing rate and cache statistics for tshark
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/* This module reports how fast packets were dissected, how often the
+ * display filter and host name caches were hit, and how much each memory
+ * scope has used.  The report is shown at
+ * the end of the run and, on UNIX, to the standard error whenever tshark
+ * gets a SIGUSR1.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/addr_resolv.h>
+#include <epan/dfilter/dfilter.h>
+
+void register_tap_listener_perfstat(void);
+
+typedef struct _perfstat_t {
+	char    *filter;
+	GTimer  *timer;         /* started when the tap was registered */
+	guint64  packets;       /* packets dissected */
+	guint64  bytes;         /* bytes in them */
+	guint64  matched;       /* packets that matched the filter, if any */
+} perfstat_t;
+
+static int already_enabled = 0;
+
+#ifdef SIGUSR1
+static volatile sig_atomic_t perfstat_dump_requested = 0;
+
+static void
+perfstat_sigusr1(int sig _U_)
+{
+	perfstat_dump_requested = 1;
+}
+#endif
+
+static void
+perfstat_print_hits(FILE *fp, const char *name, guint64 lookups, guint64 hits)
+{
+	fprintf(fp, "%-24s %12" G_GINT64_MODIFIER "u %12" G_GINT64_MODIFIER "u",
+		name, lookups, hits);
+	if (lookups != 0)
+		fprintf(fp, " %7.2f%%\n", 100.0 * (double)hits / (double)lookups);
+	else
+		fprintf(fp, " %8s\n", "-");
+}
+
+static void
+perfstat_print_pool(FILE *fp, const char *name, wmem_allocator_t *pool)
+{
+	wmem_allocator_stats_t stats;
+
+	wmem_get_stats(pool, &stats);
+	fprintf(fp, "%-24s %12" G_GINT64_MODIFIER "u %12" G_GINT64_MODIFIER "u\n",
+		name, stats.bytes, stats.peak_bytes);
+}
+
+static void
+perfstat_print(FILE *fp, perfstat_t *ps)
+{
+	gdouble elapsed;
+	guint64 lookups, hits;
+
+	elapsed = g_timer_elapsed(ps->timer, NULL);
+
+	fprintf(fp, "\n");
+	fprintf(fp, "=====================================================================\n");
+	fprintf(fp, "Performance Statistics:\n");
+	if (ps->filter)
+		fprintf(fp, "Filter: %s\n", ps->filter);
+	fprintf(fp, "Elapsed: %.3f s\n", elapsed);
+	fprintf(fp, "%-24s %12s %14s %14s\n", "", "Count", "Per second", "Bytes/s");
+	fprintf(fp, "%-24s %12" G_GINT64_MODIFIER "u %14.1f %14.1f\n",
+		"Packets dissected", ps->packets,
+		elapsed > 0.0 ? (double)ps->packets / elapsed : 0.0,
+		elapsed > 0.0 ? (double)ps->bytes / elapsed : 0.0);
+	if (ps->filter)
+		fprintf(fp, "%-24s %12" G_GINT64_MODIFIER "u %14.1f\n",
+			"Packets matched", ps->matched,
+			elapsed > 0.0 ? (double)ps->matched / elapsed : 0.0);
+	fprintf(fp, "---------------------------------------------------------------------\n");
+	fprintf(fp, "%-24s %12s %12s %8s\n", "Cache", "Lookups", "Hits", "Hit rate");
+	dfilter_cache_get_stats(&lookups, &hits);
+	perfstat_print_hits(fp, "Display filters", lookups, hits);
+	host_name_lookup_get_stats(&lookups, &hits);
+	perfstat_print_hits(fp, "Host names", lookups, hits);
+	fprintf(fp, "---------------------------------------------------------------------\n");
+	fprintf(fp, "%-24s %12s %12s\n", "Memory scope", "Bytes", "Peak bytes");
+	perfstat_print_pool(fp, "packet", wmem_packet_scope());
+	perfstat_print_pool(fp, "file", wmem_file_scope());
+	perfstat_print_pool(fp, "epan", wmem_epan_scope());
+	fprintf(fp, "=====================================================================\n");
+}
+
+static int
+perfstat_packet(void *prs, packet_info *pinfo, epan_dissect_t *edt _U_, const void *dummy _U_)
+{
+	perfstat_t *ps = (perfstat_t *)prs;
+
+	ps->packets++;
+	ps->bytes += pinfo->fd->pkt_len;
+
+#ifdef SIGUSR1
+	/* Not from the signal handler, where stdio isn't safe to use */
+	if (perfstat_dump_requested) {
+		perfstat_dump_requested = 0;
+		perfstat_print(stderr, ps);
+	}
+#endif
+	return 0;
+}
+
+/* Only called when a filter was given, for the packets that match it */
+static int
+perfstat_matched_packet(void *pmatched, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *dummy _U_)
+{
+	guint64 *matched = (guint64 *)pmatched;
+
+	(*matched)++;
+	return 0;
+}
+
+static void
+perfstat_draw(void *prs)
+{
+	perfstat_t *ps = (perfstat_t *)prs;
+
+	perfstat_print(stdout, ps);
+}
+
+static void
+perfstat_init(const char *opt_arg, void *userdata _U_)
+{
+	perfstat_t *ps;
+	const char *filter = NULL;
+	GString    *error_string;
+
+	if (already_enabled) {
+		return;
+	}
+	already_enabled = 1;
+
+	if (!strncmp(opt_arg, "perf,", 5)) {
+		filter = opt_arg + 5;
+	}
+
+	ps = g_new0(perfstat_t, 1);
+	ps->filter = g_strdup(filter);
+	ps->timer = g_timer_new();
+
+	error_string = register_tap_listener("frame", ps, NULL, 0, NULL, perfstat_packet, perfstat_draw);
+	if (error_string == NULL && filter != NULL) {
+		error_string = register_tap_listener("frame", &ps->matched, filter, 0, NULL, perfstat_matched_packet, NULL);
+		if (error_string != NULL)
+			remove_tap_listener(ps);
+	}
+	if (error_string) {
+		g_timer_destroy(ps->timer);
+		g_free(ps->filter);
+		g_free(ps);
+
+		fprintf(stderr, "tshark: Couldn't register perf tap: %s\n",
+			error_string->str);
+		g_string_free(error_string, TRUE);
+		exit(1);
+	}
+
+#ifdef SIGUSR1
+	signal(SIGUSR1, perfstat_sigusr1);
+#endif
+}
+
+static stat_tap_ui perfstat_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	"perf",
+	perfstat_init,
+	-1,
+	0,
+	NULL
+};
+
+void
+register_tap_listener_perfstat(void)
+{
+	register_stat_tap_ui(&perfstat_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
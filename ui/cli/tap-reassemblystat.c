@@ -0,0 +1,128 @@
+/* tap-reassemblystat.c
+ * Reassembly table statistics for tshark
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/* This module reports, at the end of the run, how much each reassembly
+ * table holds and how much it was used.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/reassemble.h>
+
+void register_tap_listener_reassemblystat(void);
+
+static int already_enabled = 0;
+
+static int
+reassemblystat_packet(void *dummy _U_, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *dummy2 _U_)
+{
+	/* The tables keep their own counts */
+	return 0;
+}
+
+static void
+reassemblystat_draw_table(const reassembly_table_stats *stats, gpointer user_data _U_)
+{
+	/* Tables that no protocol has used yet have nothing to show */
+	if (stats->proto_name == NULL)
+		return;
+
+	printf("%-16s %8u %8u %10" G_GINT64_MODIFIER "u %8" G_GINT64_MODIFIER "u"
+	       " %12" G_GINT64_MODIFIER "u %12" G_GINT64_MODIFIER "u"
+	       " %10" G_GINT64_MODIFIER "u %10" G_GINT64_MODIFIER "u\n",
+	       stats->proto_name,
+	       stats->in_progress,
+	       stats->completed,
+	       stats->fragments,
+	       stats->overlaps,
+	       stats->bytes_buffered,
+	       stats->bytes_reassembled,
+	       stats->fragments_added,
+	       stats->lookups);
+}
+
+static void
+reassemblystat_draw(void *dummy _U_)
+{
+	printf("\n");
+	printf("=====================================================================================================\n");
+	printf("Reassembly Table Statistics:\n");
+	printf("%-16s %8s %8s %10s %8s %12s %12s %10s %10s\n",
+	       "Protocol", "Pending", "Complete", "Fragments", "Overlaps",
+	       "Buffered", "Reassembled", "Added", "Lookups");
+	reassembly_table_foreach_stats(reassemblystat_draw_table, NULL);
+	printf("=====================================================================================================\n");
+}
+
+static void
+reassemblystat_init(const char *opt_arg _U_, void *userdata _U_)
+{
+	GString *error_string;
+
+	if (already_enabled) {
+		return;
+	}
+	already_enabled = 1;
+
+	error_string = register_tap_listener("frame", NULL, NULL, 0, NULL, reassemblystat_packet, reassemblystat_draw);
+	if (error_string) {
+		fprintf(stderr, "tshark: Couldn't register reassembly,stat tap: %s\n",
+			error_string->str);
+		g_string_free(error_string, TRUE);
+		exit(1);
+	}
+}
+
+static stat_tap_ui reassemblystat_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	"reassembly,stat",
+	reassemblystat_init,
+	-1,
+	0,
+	NULL
+};
+
+void
+register_tap_listener_reassemblystat(void)
+{
+	register_stat_tap_ui(&reassemblystat_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
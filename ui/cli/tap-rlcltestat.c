@@ -100,6 +100,8 @@ typedef struct rlc_lte_ep {
 /* Used to keep track of all RLC LTE statistics */
 typedef struct rlc_lte_stat_t {
     rlc_lte_ep_t  *ep_list;
+    rlc_lte_ep_t  *ep_tail;     /* Last entry in ep_list */
+    GHashTable    *ep_table;    /* UEId -> entry in ep_list */
     guint32       total_frames;
 
     /* Common stats */
@@ -114,6 +116,7 @@ rlc_lte_stat_reset(void *phs)
 {
     rlc_lte_stat_t *rlc_lte_stat = (rlc_lte_stat_t *)phs;
     rlc_lte_ep_t *list = rlc_lte_stat->ep_list;
+    rlc_lte_ep_t *next;
 
     rlc_lte_stat->total_frames = 0;
     memset(&rlc_lte_stat->common_stats, 0, sizeof(rlc_lte_common_stats));
@@ -122,7 +125,13 @@ rlc_lte_stat_reset(void *phs)
         return;
     }
 
+    g_hash_table_remove_all(rlc_lte_stat->ep_table);
+    for (; list; list = next) {
+        next = list->next;
+        g_free(list);
+    }
     rlc_lte_stat->ep_list = NULL;
+    rlc_lte_stat->ep_tail = NULL;
 }
 
 
@@ -169,7 +178,7 @@ rlc_lte_stat_packet(void *phs, packet_info *pinfo, epan_dissect_t *edt _U_,
 {
     /* Get reference to stats struct */
     rlc_lte_stat_t *hs = (rlc_lte_stat_t *)phs;
-    rlc_lte_ep_t *tmp = NULL, *te = NULL;
+    rlc_lte_ep_t *te = NULL;
 
     /* Cast tap info struct */
     const struct rlc_lte_tap_info *si = (const struct rlc_lte_tap_info *)phi;
@@ -200,31 +209,17 @@ rlc_lte_stat_packet(void *phs, packet_info *pinfo, epan_dissect_t *edt _U_,
     }
 
     /* For per-UE data, must create a new row if none already existing */
-    if (!hs->ep_list) {
-        /* Allocate new list */
-        hs->ep_list = alloc_rlc_lte_ep(si, pinfo);
-        /* Make it the first/only entry */
-        te = hs->ep_list;
-    } else {
-        /* Look among existing rows for this UEId */
-        for (tmp = hs->ep_list; (tmp != NULL); tmp = tmp->next) {
-            if (tmp->stats.ueid == si->ueid) {
-                te = tmp;
-                break;
-            }
-        }
-
-        /* Not found among existing, so create a new one anyway */
-        if (te == NULL) {
-            if ((te = alloc_rlc_lte_ep(si, pinfo))) {
-                /* Add new item to end of list */
-                rlc_lte_ep_t *p = hs->ep_list;
-                while (p->next) {
-                    p = p->next;
-                }
-                p->next = te;
-                te->next = NULL;
+    te = (rlc_lte_ep_t *)g_hash_table_lookup(hs->ep_table, GUINT_TO_POINTER(si->ueid));
+    if (te == NULL) {
+        if ((te = alloc_rlc_lte_ep(si, pinfo))) {
+            /* Add new item to end of list */
+            if (hs->ep_tail) {
+                hs->ep_tail->next = te;
+            } else {
+                hs->ep_list = te;
             }
+            hs->ep_tail = te;
+            g_hash_table_insert(hs->ep_table, GUINT_TO_POINTER(si->ueid), te);
         }
     }
 
@@ -380,6 +375,7 @@ static void rlc_lte_stat_init(const char *opt_arg, void *userdata _U_)
     /* Create top-level struct */
     hs = g_new0(rlc_lte_stat_t, 1);
     hs->ep_list = NULL;
+    hs->ep_table = g_hash_table_new(g_direct_hash, g_direct_equal);
 
 
     /**********************************************/
@@ -393,6 +389,7 @@ static void rlc_lte_stat_init(const char *opt_arg, void *userdata _U_)
                                          rlc_lte_stat_draw);
     if (error_string) {
         g_string_free(error_string, TRUE);
+        g_hash_table_destroy(hs->ep_table);
         g_free(hs);
         exit(1);
     }
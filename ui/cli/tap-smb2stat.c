@@ -0,0 +1,174 @@
+/* tap-smb2stat.c
+ * SMB2 service response time statistics
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epan/packet_info.h"
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include "epan/value_string.h"
+#include <epan/dissectors/packet-smb2.h>
+#include "epan/timestats.h"
+
+#define MICROSECS_PER_SEC   1000000
+#define NANOSECS_PER_SEC    1000000000
+
+void register_tap_listener_smb2stat(void);
+
+/* used to keep track of the statistics for an entire program interface */
+typedef struct _smb2stat_t {
+	char *filter;
+	timestat_t proc[256];
+} smb2stat_t;
+
+
+
+static int
+smb2stat_packet(void *pss, packet_info *pinfo, epan_dissect_t *edt _U_, const void *psi)
+{
+	smb2stat_t *ss = (smb2stat_t *)pss;
+	const smb2_info_t *si = (const smb2_info_t *)psi;
+	nstime_t t, deltat;
+
+	/* we are only interested in response packets */
+	if (!(si->flags & SMB2_FLAGS_RESPONSE)) {
+		return 0;
+	}
+	/* if we havnt seen the request, just ignore it */
+	if (!si->saved || !si->saved->frame_req) {
+		return 0;
+	}
+	/* only count the response that completed the request, not interim
+	 * responses to async commands or retransmissions */
+	if (si->saved->frame_res != pinfo->fd->num) {
+		return 0;
+	}
+	if (si->opcode >= 256) {
+		return 0;
+	}
+
+	/* calculate time delta between request and response */
+	t = pinfo->fd->abs_ts;
+	nstime_delta(&deltat, &t, &si->saved->req_time);
+
+	time_stat_update(&ss->proc[si->opcode], &deltat, pinfo);
+
+	return 1;
+}
+
+static void
+smb2stat_draw(void *pss)
+{
+	smb2stat_t *ss = (smb2stat_t *)pss;
+	guint32 i;
+	guint64 td;
+	printf("\n");
+	printf("=================================================================\n");
+	printf("SMB2 SRT Statistics:\n");
+	printf("Filter: %s\n", ss->filter ? ss->filter : "");
+	printf("Commands                   Calls    Min SRT    Max SRT    Avg SRT\n");
+	for (i=0; i<256; i++) {
+		/* nothing seen, nothing to do */
+		if (ss->proc[i].num == 0) {
+			continue;
+		}
+
+		/* Scale the average SRT in units of 1us and round to the nearest us. */
+		td = ((guint64)(ss->proc[i].tot.secs)) * NANOSECS_PER_SEC + ss->proc[i].tot.nsecs;
+		td = ((td / ss->proc[i].num) + 500) / 1000;
+
+		printf("%-25s %6d %3d.%06d %3d.%06d %3" G_GINT64_MODIFIER "u.%06" G_GINT64_MODIFIER "u\n",
+		       val_to_str_ext(i, &smb2_cmd_vals_ext, "Unknown (0x%02x)"),
+		       ss->proc[i].num,
+		       (int)(ss->proc[i].min.secs), (ss->proc[i].min.nsecs+500)/1000,
+		       (int)(ss->proc[i].max.secs), (ss->proc[i].max.nsecs+500)/1000,
+		       td/MICROSECS_PER_SEC, td%MICROSECS_PER_SEC
+		);
+	}
+
+	printf("=================================================================\n");
+}
+
+
+static void
+smb2stat_init(const char *opt_arg, void *userdata _U_)
+{
+	smb2stat_t *ss;
+	const char *filter = NULL;
+	GString *error_string;
+
+	if (!strncmp(opt_arg, "smb2,srt,", 9)) {
+		filter = opt_arg + 9;
+	} else {
+		filter = NULL;
+	}
+
+	ss = g_new0(smb2stat_t, 1);
+	if (filter) {
+		ss->filter = g_strdup(filter);
+	}
+
+	error_string = register_tap_listener("smb2", ss, filter, 0, NULL, smb2stat_packet, smb2stat_draw);
+	if (error_string) {
+		/* error, we failed to attach to the tap. clean up */
+		g_free(ss->filter);
+		g_free(ss);
+
+		fprintf(stderr, "tshark: Couldn't register smb2,srt tap: %s\n",
+			error_string->str);
+		g_string_free(error_string, TRUE);
+		exit(1);
+	}
+}
+
+static stat_tap_ui smb2stat_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	"smb2,srt",
+	smb2stat_init,
+	-1,
+	0,
+	NULL
+};
+
+void
+register_tap_listener_smb2stat(void)
+{
+	register_stat_tap_ui(&smb2stat_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -41,11 +41,104 @@
 #include <epan/tap.h>
 
 #include <wsutil/file_util.h>
+#include <wsutil/tempfile.h>
 
 #include <ui/alert_box.h>
 
 #include "export_object.h"
 
+/*
+ * Payloads are appended to one temporary file, which is removed when the
+ * last entry using it is freed.
+ */
+static int spool_fd = -1;
+static gchar *spool_filename = NULL;
+static gint64 spool_end = 0;
+static guint spool_refs = 0;
+
+#define SPOOL_CHUNK_SIZE 65536
+
+static gboolean
+eo_spool_write(const guint8 *data, gint64 len)
+{
+    gint64 bytes_left = len;
+    int bytes_to_write;
+    ssize_t bytes_written;
+
+    if (spool_fd == -1) {
+        char *tmpname;
+
+        spool_fd = create_tempfile(&tmpname, "wireshark_eo");
+        if (spool_fd == -1)
+            return FALSE;
+        spool_filename = g_strdup(tmpname);
+        spool_end = 0;
+    }
+
+    if (ws_lseek64(spool_fd, spool_end, SEEK_SET) < 0)
+        return FALSE;
+
+    while (bytes_left != 0) {
+        if (bytes_left > 0x40000000)
+            bytes_to_write = 0x40000000;
+        else
+            bytes_to_write = (int)bytes_left;
+        bytes_written = ws_write(spool_fd, data, bytes_to_write);
+        if (bytes_written <= 0)
+            return FALSE;
+        bytes_left -= bytes_written;
+        data += bytes_written;
+    }
+    return TRUE;
+}
+
+static void
+eo_spool_release(void)
+{
+    if (--spool_refs > 0)
+        return;
+
+    ws_close(spool_fd);
+    ws_unlink(spool_filename);
+    g_free(spool_filename);
+    spool_filename = NULL;
+    spool_fd = -1;
+    spool_end = 0;
+}
+
+void
+eo_entry_set_payload(export_object_entry_t *entry, const guint8 *data, gint64 len)
+{
+    entry->payload_len = len;
+    entry->payload_data = NULL;
+    entry->payload_spooled = FALSE;
+    entry->payload_spool_offset = 0;
+
+    if (len <= 0)
+        return;
+
+    if (eo_spool_write(data, len)) {
+        entry->payload_spooled = TRUE;
+        entry->payload_spool_offset = spool_end;
+        spool_end += len;
+        spool_refs++;
+    } else {
+        entry->payload_data = (guint8 *)g_memdup(data, (guint)len);
+    }
+}
+
+void
+eo_free_entry(export_object_entry_t *entry)
+{
+    g_free(entry->hostname);
+    g_free(entry->content_type);
+    g_free(entry->filename);
+    g_free(entry->payload_data);
+    if (entry->payload_spooled)
+        eo_spool_release();
+    g_free(entry);
+}
+
 gboolean
 eo_save_entry(const gchar *save_as_filename, export_object_entry_t *entry, gboolean show_err)
 {
@@ -54,6 +147,7 @@ eo_save_entry(const gchar *save_as_filename, export_object_entry_t *entry, gbool
     int bytes_to_write;
     ssize_t bytes_written;
     guint8 *ptr;
+    guint8 *chunk = NULL;
     int err;
 
     to_fd = ws_open(save_as_filename, O_WRONLY | O_CREAT | O_EXCL |
@@ -79,8 +173,32 @@ eo_save_entry(const gchar *save_as_filename, export_object_entry_t *entry, gbool
      */
     ptr = entry->payload_data;
     bytes_left = entry->payload_len;
+    if (entry->payload_spooled) {
+        /* Copy the payload from the spool a chunk at a time */
+        if (ws_lseek64(spool_fd, entry->payload_spool_offset, SEEK_SET) < 0) {
+            if (show_err)
+                read_failure_alert_box(spool_filename, errno);
+            ws_close(to_fd);
+            return FALSE;
+        }
+        chunk = (guint8 *)g_malloc(SPOOL_CHUNK_SIZE);
+    }
     while (bytes_left != 0) {
-        if (bytes_left > 0x40000000)
+        if (chunk) {
+            ssize_t bytes_read;
+
+            bytes_to_write = (int)MIN(bytes_left, SPOOL_CHUNK_SIZE);
+            bytes_read = ws_read(spool_fd, chunk, bytes_to_write);
+            if (bytes_read <= 0) {
+                if (show_err)
+                    read_failure_alert_box(spool_filename, bytes_read < 0 ? errno : EIO);
+                g_free(chunk);
+                ws_close(to_fd);
+                return FALSE;
+            }
+            bytes_to_write = (int)bytes_read;
+            ptr = chunk;
+        } else if (bytes_left > 0x40000000)
             bytes_to_write = 0x40000000;
         else
             bytes_to_write = (int)bytes_left;
@@ -92,12 +210,18 @@ eo_save_entry(const gchar *save_as_filename, export_object_entry_t *entry, gbool
                 err = WTAP_ERR_SHORT_WRITE;
             if (show_err)
                 write_failure_alert_box(save_as_filename, err);
+            g_free(chunk);
             ws_close(to_fd);
             return FALSE;
         }
         bytes_left -= bytes_written;
         ptr += bytes_written;
+        if (chunk && bytes_written < bytes_to_write) {
+            /* Read the rest of the chunk again */
+            ws_lseek64(spool_fd, bytes_written - bytes_to_write, SEEK_CUR);
+        }
     }
+    g_free(chunk);
     if (ws_close(to_fd) < 0) {
         if (show_err)
             write_failure_alert_box(save_as_filename, errno);
@@ -42,12 +42,24 @@ typedef struct _export_object_entry_t {
     /* We need to store a 64 bit integer to hold a file length
       (was guint payload_len;) */
     gint64 payload_len;
-    guint8 *payload_data;
+    guint8 *payload_data;       /* NULL if the payload is spooled */
+    gboolean payload_spooled;   /* the payload is in the spool file */
+    gint64 payload_spool_offset;
 } export_object_entry_t;
 
 void object_list_add_entry(export_object_list_t *object_list, export_object_entry_t *entry);
 export_object_entry_t *object_list_get_entry(export_object_list_t *object_list, int row);
 
+/** Give an entry a copy of len bytes of payload.  The copy is written to
+ * a temporary spool file shared by all entries, so that a list of many
+ * large objects doesn't have to be kept in memory; if the spool can't be
+ * written, the copy is kept in memory instead.
+ */
+void eo_entry_set_payload(export_object_entry_t *entry, const guint8 *data, gint64 len);
+
+/** Free an entry, its strings and its payload. */
+void eo_free_entry(export_object_entry_t *entry);
+
 gboolean eo_save_entry(const gchar *save_as_filename, export_object_entry_t *entry, gboolean show_err);
 GString *eo_massage_str(const gchar *in_str, gsize maxlen, int dup);
 const char *ct2ext(const char *content_type);
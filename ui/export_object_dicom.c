@@ -54,8 +54,9 @@ eo_dicom_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_,
         entry->hostname = eo_info->hostname;
         entry->content_type = eo_info->content_type;
         entry->filename = g_strdup(g_path_get_basename(eo_info->filename));
-        entry->payload_len  = eo_info->payload_len;
-        entry->payload_data = eo_info->payload_data;
+        /* The payload is ours to free once it's been copied */
+        eo_entry_set_payload(entry, eo_info->payload_data, eo_info->payload_len);
+        g_free(eo_info->payload_data);
 
         object_list_add_entry(object_list, entry);
 
@@ -49,9 +49,7 @@ eo_http_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_,
         entry->hostname = g_strdup(eo_info->hostname);
         entry->content_type = g_strdup(eo_info->content_type);
         entry->filename = g_strdup(g_path_get_basename(eo_info->filename));
-        entry->payload_len = eo_info->payload_len;
-        entry->payload_data = (guint8 *)g_memdup(eo_info->payload_data,
-                           eo_info->payload_len);
+        eo_entry_set_payload(entry, eo_info->payload_data, eo_info->payload_len);
 
         object_list_add_entry(object_list, entry);
 
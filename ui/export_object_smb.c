@@ -353,6 +353,9 @@ eo_smb_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_, const
         entry = (export_object_entry_t *)g_malloc(sizeof(export_object_entry_t));
         entry->payload_data = NULL;
         entry->payload_len = 0;
+        /* Chunks arrive in any order, so SMB payloads stay in memory */
+        entry->payload_spooled = FALSE;
+        entry->payload_spool_offset = 0;
         new_file = (active_file *)g_malloc(sizeof(active_file));
         new_file->tid = incoming_file.tid;
         new_file->uid = incoming_file.uid;
@@ -53,6 +53,7 @@ eo_tftp_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_,
 
     GSList *block_iterator;
     guint  payload_data_offset = 0;
+    guint8 *payload_data;
     eo_info_dynamic_t *dynamic_info;
 
     /* These values will be freed when the Export Object window is closed. */
@@ -64,15 +65,21 @@ eo_tftp_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_,
     /* Copy filename */
     entry->filename = g_strdup(g_path_get_basename(eo_info->filename));
 
-    /* Iterate over list of blocks and concatenate into contiguous memory */
-    entry->payload_len = eo_info->payload_len;
-    entry->payload_data = (guint8 *)g_try_malloc((gsize)entry->payload_len);
-    for (block_iterator = eo_info->block_list; block_iterator; block_iterator = block_iterator->next) {
-        file_block_t *block = (file_block_t*)block_iterator->data;
-        memcpy(entry->payload_data + payload_data_offset,
-               block->data,
-               block->length);
-        payload_data_offset += block->length;
+    /* Iterate over list of blocks and concatenate into contiguous memory,
+       for the entry to spool */
+    payload_data = (guint8 *)g_try_malloc((gsize)eo_info->payload_len);
+    if (payload_data) {
+        for (block_iterator = eo_info->block_list; block_iterator; block_iterator = block_iterator->next) {
+            file_block_t *block = (file_block_t*)block_iterator->data;
+            memcpy(payload_data + payload_data_offset,
+                   block->data,
+                   block->length);
+            payload_data_offset += block->length;
+        }
+        eo_entry_set_payload(entry, payload_data, eo_info->payload_len);
+        g_free(payload_data);
+    } else {
+        eo_entry_set_payload(entry, NULL, 0);
     }
 
     /* These 2 fields not used */
@@ -102,6 +102,20 @@ static GSList *color_filter_tmp_list = NULL;
 #define COLOR_FILTER_LIST       "color_filter_list"
 
 
+/* Show how many packets a filter colored, so that the busiest filters
+ * can be moved up the list */
+static void
+color_filter_hits_data_func(GtkTreeViewColumn *column _U_, GtkCellRenderer *renderer,
+                            GtkTreeModel *model, GtkTreeIter *iter, gpointer user_data _U_)
+{
+  color_filter_t *colorf;
+  gchar           hits_str[21];
+
+  gtk_tree_model_get(model, iter, 5, &colorf, -1);
+  g_snprintf(hits_str, sizeof(hits_str), "%" G_GINT64_MODIFIER "u", colorf->hits);
+  g_object_set(renderer, "text", hits_str, NULL);
+}
+
 /* Callback for the "Display:Coloring Rules" menu item. */
 void
 color_display_cb(GtkWidget *w _U_, gpointer d _U_)
@@ -194,7 +208,7 @@ colorize_dialog_new (char *filter)
   GtkCellRenderer   *renderer;
   GtkTreeViewColumn *column;
   GtkTreeSelection  *selection;
-  static const gchar *titles[] = { "Name", "String" };
+  static const gchar *titles[] = { "Name", "String", "Hits" };
 
 
 
@@ -315,6 +329,15 @@ colorize_dialog_new (char *filter)
                                                     NULL);
   gtk_tree_view_column_set_fixed_width(column, 300);
   gtk_tree_view_append_column(GTK_TREE_VIEW(color_filters), column);
+  renderer = gtk_cell_renderer_text_new();
+  g_object_set(renderer, "xalign", 1.0, NULL);
+  column = gtk_tree_view_column_new_with_attributes(titles[2], renderer,
+                                                    "foreground", 2,
+                                                    "background", 3,
+                                                    "strikethrough", 4,
+                                                    NULL);
+  gtk_tree_view_column_set_cell_data_func(column, renderer, color_filter_hits_data_func, NULL, NULL);
+  gtk_tree_view_append_column(GTK_TREE_VIEW(color_filters), column);
   gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(color_filters), TRUE);
   gtk_tree_view_set_headers_clickable(GTK_TREE_VIEW(color_filters), FALSE);
 
@@ -132,10 +132,10 @@ static void
 conversation_info_to_texbuff(GtkTextBuffer *buffer)
 {
     gchar string_buff[CONV_STR_BUF_MAX];
-    GHashTable *conversation_hashtable_exact;
-    GHashTable *conversation_hashtable_no_addr2;
-    GHashTable *conversation_hashtable_no_port2;
-    GHashTable *conversation_hashtable_no_addr2_or_port2;
+    conversation_hashtable_t *conversation_hashtable_exact;
+    conversation_hashtable_t *conversation_hashtable_no_addr2;
+    conversation_hashtable_t *conversation_hashtable_no_port2;
+    conversation_hashtable_t *conversation_hashtable_no_addr2_or_port2;
 
     g_snprintf(string_buff, CONV_STR_BUF_MAX, "Conversation hastables info:\n");
     gtk_text_buffer_insert_at_cursor (buffer, string_buff, -1);
@@ -143,15 +143,15 @@ conversation_info_to_texbuff(GtkTextBuffer *buffer)
     conversation_hashtable_exact = get_conversation_hashtable_exact();
     if(conversation_hashtable_exact){
         g_snprintf(string_buff, CONV_STR_BUF_MAX, "conversation_hashtable_exact %i entries\n#\n",
-            g_hash_table_size(conversation_hashtable_exact));
+            conversation_hashtable_size(conversation_hashtable_exact));
         gtk_text_buffer_insert_at_cursor (buffer, string_buff, -1);
-        g_hash_table_foreach( conversation_hashtable_exact, conversation_hashtable_exact_to_texbuff, buffer);
+        conversation_hashtable_foreach(conversation_hashtable_exact, conversation_hashtable_exact_to_texbuff, buffer);
     }
 
     conversation_hashtable_no_addr2 = get_conversation_hashtable_no_addr2();
     if(conversation_hashtable_no_addr2){
         g_snprintf(string_buff, CONV_STR_BUF_MAX, "conversation_hashtable_no_addr2 %i entries\n#\n",
-            g_hash_table_size(conversation_hashtable_no_addr2));
+            conversation_hashtable_size(conversation_hashtable_no_addr2));
         gtk_text_buffer_insert_at_cursor (buffer, string_buff, -1);
 
     }
@@ -159,7 +159,7 @@ conversation_info_to_texbuff(GtkTextBuffer *buffer)
     conversation_hashtable_no_port2 = get_conversation_hashtable_no_port2();
     if(conversation_hashtable_no_port2){
         g_snprintf(string_buff, CONV_STR_BUF_MAX, "conversation_hashtable_no_port2 %i entries\n#\n",
-            g_hash_table_size(conversation_hashtable_no_port2));
+            conversation_hashtable_size(conversation_hashtable_no_port2));
         gtk_text_buffer_insert_at_cursor (buffer, string_buff, -1);
 
     }
@@ -167,7 +167,7 @@ conversation_info_to_texbuff(GtkTextBuffer *buffer)
     conversation_hashtable_no_addr2_or_port2 = get_conversation_hashtable_no_addr2_or_port2();
     if(conversation_hashtable_no_addr2_or_port2){
         g_snprintf(string_buff, CONV_STR_BUF_MAX, "conversation_hashtable_no_addr2_or_port2 %i entries\n#\n",
-            g_hash_table_size(conversation_hashtable_no_addr2_or_port2));
+            conversation_hashtable_size(conversation_hashtable_no_addr2_or_port2));
         gtk_text_buffer_insert_at_cursor (buffer, string_buff, -1);
 
     }
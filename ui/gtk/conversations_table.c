@@ -2048,6 +2048,7 @@ init_ct_table_page(conversations_table *conversations, GtkWidget *vbox, gboolean
 
     conversations->hash.conv_array = NULL;
     conversations->hash.hashtable = NULL;
+    conversations->hash.max_items = 0;
     conversations->hash.user_data = conversations;
 
     sel = gtk_tree_view_get_selection(GTK_TREE_VIEW(conversations->table));
@@ -122,6 +122,12 @@ GSList *decode_dimmable = NULL;
  */
 enum action_type  requested_action = (enum action_type)-1;
 
+/*
+ * Set when a change was made other than through the dissector tables,
+ * so that we can't tell whether any packet is affected by it.
+ */
+static gboolean decode_untracked_change = FALSE;
+
 
 /**************************************************/
 /*            Global Functions                    */
@@ -674,8 +680,12 @@ decode_simple (GtkWidget *notebook_pg)
         value_ptr = entry->values[requested_index].build_values[value_loop](&cfile.edt->pi);
         if (abbrev != NULL && strcmp(abbrev, "(default)") == 0) {
             add_reset_list = entry->reset_value(table_name, value_ptr);
+            if (entry->reset_value != decode_as_default_reset)
+                decode_untracked_change = TRUE;
         } else {
             add_reset_list = entry->change_value(table_name, value_ptr, &handle, abbrev);
+            if (entry->change_value != decode_as_default_change)
+                decode_untracked_change = TRUE;
         }
 
         if (add_reset_list) {
@@ -689,6 +699,25 @@ decode_simple (GtkWidget *notebook_pg)
 }
 
 
+/*
+ * Redissect the packets if the changes just made can affect them: only
+ * if a packet looked up one of the dissector table entries that were
+ * changed (e.g. a conversation on the TCP port that was mapped to
+ * another protocol), or if we can't tell.
+ */
+static void
+decode_redissect_changed(void)
+{
+    gboolean lookups_changed = dissector_table_lookups_changed();
+
+    if (lookups_changed || decode_untracked_change) {
+        redissect_packets();
+        redissect_all_packet_windows();
+    }
+    decode_untracked_change = FALSE;
+}
+
+
 /**************************************************/
 /*      Signals from the "Decode As..." dialog    */
 /**************************************************/
@@ -731,8 +760,7 @@ decode_ok_cb (GtkWidget *ok_bt _U_, gpointer parent_w)
     g_slist_free(decode_dimmable);
     decode_dimmable = NULL;
 
-    redissect_packets();
-    redissect_all_packet_windows();
+    decode_redissect_changed();
 }
 
 /*
@@ -761,8 +789,7 @@ decode_apply_cb (GtkWidget *apply_bt _U_, gpointer parent_w)
     func = (void (*)(GtkWidget *))g_object_get_data(G_OBJECT(notebook_pg), E_PAGE_ACTION);
     func(notebook_pg);
 
-    redissect_packets();
-    redissect_all_packet_windows();
+    decode_redissect_changed();
 }
 
 /*
@@ -998,6 +998,7 @@ init_hostlist_table_page(hostlist_table *hosttable, GtkWidget *vbox, gboolean hi
 
     hosttable->hash.conv_array = NULL;
     hosttable->hash.hashtable = NULL;
+    hosttable->hash.max_items = 0;
     hosttable->hash.user_data = hosttable;
 
     sel = gtk_tree_view_get_selection(GTK_TREE_VIEW(hosttable->table));
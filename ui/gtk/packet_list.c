@@ -831,6 +831,46 @@ packet_list_thaw(void)
 	packets_bar_update();
 }
 
+gboolean
+packet_list_begin_progressive_load(void)
+{
+	/* Appending to an attached GtkTreeView is too slow for large files */
+	return FALSE;
+}
+
+void
+packet_list_update_progressive_load(void)
+{
+}
+
+void
+packet_list_end_progressive_load(void)
+{
+}
+
+void
+packet_list_begin_live_update(void)
+{
+}
+
+void
+packet_list_end_live_update(gboolean scroll_to_end)
+{
+	if (scroll_to_end)
+		packet_list_moveto_end();
+}
+
+gboolean
+packet_list_begin_progressive_filter(void)
+{
+	return FALSE;
+}
+
+void
+packet_list_update_progressive_filter(guint32 framenum _U_)
+{
+}
+
 void
 packet_list_recreate_visible_rows(void)
 {
@@ -50,6 +50,8 @@
 #include "ui/gtk/keys.h"
 #include "ui/gtk/uat_gui.h"
 #include "ui/gtk/file_dlg.h"
+#include "ui/gtk/packet_list.h"
+#include "ui/gtk/packet_panes.h"
 #include "ui/gtk/packet_win.h"
 #include "simple_dialog.h"
 
@@ -1134,7 +1136,7 @@ pref_fetch(pref_t *pref, gpointer user_data)
 static guint
 module_prefs_fetch(module_t *module, gpointer user_data)
 {
-  gboolean *must_redissect_p = (gboolean *)user_data;
+  guint *effect_p = (guint *)user_data;
 
   /* Ignore any preferences with their own interface */
   if (!module->use_gui) {
@@ -1142,15 +1144,9 @@ module_prefs_fetch(module_t *module, gpointer user_data)
   }
 
   /* For all preferences in this module, fetch its value from this
-     module's notebook page.  Find out whether any of them changed. */
-  module->prefs_changed = FALSE;        /* assume none of them changed */
-  prefs_pref_foreach(module, pref_fetch, &module->prefs_changed);
-
-  /* If any of them changed, indicate that we must redissect and refilter
-     the current capture (if we have one), as the preference change
-     could cause packets to be dissected differently. */
-  if (module->prefs_changed)
-    *must_redissect_p = TRUE;
+     module's notebook page.  Find out whether any of them changed, and
+     what that makes stale in the current capture (if we have one). */
+  *effect_p |= prefs_module_fetch_effect(module, pref_fetch);
 
   return 0;     /* keep fetching module preferences */
 }
@@ -1241,7 +1237,7 @@ module_prefs_clean_stash(module_t *module, gpointer user_data _U_)
 
 /* fetch all pref values from all pages */
 static gboolean
-prefs_main_fetch_all(GtkWidget *dlg, gboolean *must_redissect)
+prefs_main_fetch_all(GtkWidget *dlg, guint *effect)
 {
   pref_t *badpref;
 
@@ -1290,7 +1286,7 @@ prefs_main_fetch_all(GtkWidget *dlg, gboolean *must_redissect)
 #endif /* HAVE_LIBPCAP */
   filter_expressions_prefs_fetch((GtkWidget *)g_object_get_data(G_OBJECT(dlg),
     E_FILTER_EXPRESSIONS_PAGE_KEY));
-  prefs_modules_foreach(module_prefs_fetch, must_redissect);
+  prefs_modules_foreach(module_prefs_fetch, effect);
 
   return TRUE;
 }
@@ -1428,12 +1424,30 @@ prefs_main_save(gpointer parent_w)
   }
 }
 
+/* Do as little as the changed preferences allow to bring the current
+   capture up to date */
+static void
+prefs_main_update_capture(guint effect)
+{
+  if (effect & PREF_EFFECT_DISSECTION) {
+    /* Redissect all the packets, and re-evaluate the display filter. */
+    redissect_packets();
+    redissect_all_packet_windows();
+  } else if ((effect & PREF_EFFECT_FILTER) && cfile.state != FILE_CLOSED && cfile.dfilter) {
+    /* Re-evaluate the display filter, keeping what's been dissected. */
+    cf_filter_packets(&cfile, cfile.dfilter, TRUE);
+  } else if (effect & (PREF_EFFECT_FILTER|PREF_EFFECT_DISPLAY)) {
+    packet_list_recreate();
+    redraw_packet_bytes_all();
+  }
+}
+
 static void
 prefs_main_ok_cb(GtkWidget *ok_bt _U_, gpointer parent_w)
 {
-  gboolean must_redissect = FALSE;
+  guint effect = 0;
 
-  if (!prefs_main_fetch_all((GtkWidget *)parent_w, &must_redissect))
+  if (!prefs_main_fetch_all((GtkWidget *)parent_w, &effect))
     return; /* Errors in some preference setting - already reported */
 
   /* if we don't have a Save button, just save the settings now */
@@ -1449,7 +1463,7 @@ prefs_main_ok_cb(GtkWidget *ok_bt _U_, gpointer parent_w)
   airpcap_load_decryption_keys(airpcap_if_list);
 #endif
 
-  prefs_main_apply_all((GtkWidget *)parent_w, must_redissect);
+  prefs_main_apply_all((GtkWidget *)parent_w, (effect & PREF_EFFECT_DISSECTION) != 0);
 
   /* Fill in capture options with values from the preferences */
   prefs_to_capture_opts();
@@ -1461,20 +1475,16 @@ prefs_main_ok_cb(GtkWidget *ok_bt _U_, gpointer parent_w)
   /* Now destroy the "Preferences" dialog. */
   window_destroy(GTK_WIDGET(parent_w));
 
-  if (must_redissect) {
-    /* Redissect all the packets, and re-evaluate the display filter. */
-    redissect_packets();
-    redissect_all_packet_windows();
-  }
+  prefs_main_update_capture(effect);
 
 }
 
 static void
 prefs_main_apply_cb(GtkWidget *apply_bt _U_, gpointer parent_w)
 {
-  gboolean must_redissect = FALSE;
+  guint effect = 0;
 
-  if (!prefs_main_fetch_all((GtkWidget *)parent_w, &must_redissect))
+  if (!prefs_main_fetch_all((GtkWidget *)parent_w, &effect))
     return; /* Errors in some preference setting - already reported */
 
   /* if we don't have a Save button, just save the settings now */
@@ -1483,7 +1493,7 @@ prefs_main_apply_cb(GtkWidget *apply_bt _U_, gpointer parent_w)
     prefs_copy();     /* save prefs for reverting if Cancel */
   }
 
-  prefs_main_apply_all((GtkWidget *)parent_w, must_redissect);
+  prefs_main_apply_all((GtkWidget *)parent_w, (effect & PREF_EFFECT_DISSECTION) != 0);
 
   /* Fill in capture options with values from the preferences */
   prefs_to_capture_opts();
@@ -1492,19 +1502,15 @@ prefs_main_apply_cb(GtkWidget *apply_bt _U_, gpointer parent_w)
   prefs_airpcap_update();
 #endif
 
-  if (must_redissect) {
-    /* Redissect all the packets, and re-evaluate the display filter. */
-    redissect_packets();
-    redissect_all_packet_windows();
-  }
+  prefs_main_update_capture(effect);
 }
 
 static void
 prefs_main_save_cb(GtkWidget *save_bt _U_, gpointer parent_w)
 {
-  gboolean must_redissect = FALSE;
+  guint effect = 0;
 
-  if (!prefs_main_fetch_all((GtkWidget *)parent_w, &must_redissect))
+  if (!prefs_main_fetch_all((GtkWidget *)parent_w, &effect))
     return; /* Errors in some preference setting - already reported */
 
   prefs_main_save(parent_w);
@@ -1520,26 +1526,22 @@ prefs_main_save_cb(GtkWidget *save_bt _U_, gpointer parent_w)
         2) the next time they fire Wireshark up, those preferences will
            apply;
 
-        3) we'd have to buffer "must_redissect" so that if they do
+        3) we'd have to buffer "effect" so that if they do
            "Apply" after this, we know we have to redissect;
 
         4) we did apply the protocol preferences, at least, in the past. */
-  prefs_main_apply_all((GtkWidget *)parent_w, must_redissect);
+  prefs_main_apply_all((GtkWidget *)parent_w, (effect & PREF_EFFECT_DISSECTION) != 0);
 
   /* Fill in capture options with values from the preferences */
   prefs_to_capture_opts();
 
-  if (must_redissect) {
-    /* Redissect all the packets, and re-evaluate the display filter. */
-    redissect_packets();
-    redissect_all_packet_windows();
-  }
+  prefs_main_update_capture(effect);
 }
 
 static guint
 module_prefs_revert(module_t *module, gpointer user_data)
 {
-  gboolean *must_redissect_p = (gboolean *)user_data;
+  guint *effect_p = (guint *)user_data;
 
   /* Ignore any preferences with their own interface */
   if (!module->use_gui) {
@@ -1549,14 +1551,7 @@ module_prefs_revert(module_t *module, gpointer user_data)
   /* For all preferences in this module, revert its value to the value
      it had when we popped up the Preferences dialog.  Find out whether
      this changes any of them. */
-  module->prefs_changed = FALSE;        /* assume none of them changed */
-  prefs_pref_foreach(module, pref_unstash, &module->prefs_changed);
-
-  /* If any of them changed, indicate that we must redissect and refilter
-     the current capture (if we have one), as the preference change
-     could cause packets to be dissected differently. */
-  if (module->prefs_changed)
-    *must_redissect_p = TRUE;
+  *effect_p |= prefs_module_fetch_effect(module, pref_unstash);
   return 0;     /* keep processing modules */
 }
 
@@ -1564,25 +1559,21 @@ module_prefs_revert(module_t *module, gpointer user_data)
 static void
 prefs_main_cancel_cb(GtkWidget *cancel_bt _U_, gpointer parent_w)
 {
-  gboolean must_redissect = FALSE;
+  guint effect = 0;
 
   /* Free up the current preferences and copy the saved preferences to the
      current preferences. */
   cfile.columns_changed = FALSE; /* [XXX: "columns_changed" should treally be stored in prefs struct ??] */
 
   /* Now revert the registered preferences. */
-  prefs_modules_foreach(module_prefs_revert, &must_redissect);
+  prefs_modules_foreach(module_prefs_revert, &effect);
 
   /* Now apply the reverted-to preferences. */
-  prefs_main_apply_all((GtkWidget *)parent_w, must_redissect);
+  prefs_main_apply_all((GtkWidget *)parent_w, (effect & PREF_EFFECT_DISSECTION) != 0);
 
   window_destroy(GTK_WIDGET(parent_w));
 
-  if (must_redissect) {
-    /* Redissect all the packets, and re-evaluate the display filter. */
-    redissect_packets();
-    redissect_all_packet_windows();
-  }
+  prefs_main_update_capture(effect);
 }
 
 /* Treat this as a cancel, by calling "prefs_main_cancel_cb()" */
@@ -188,11 +188,18 @@ typedef struct _rtp_channel_info {
 	guint32 num_packets;
 } rtp_channel_info_t;
 
-/* defines a RTP packet */
+/* defines a RTP packet: what the decoder needs of it, kept in the stream's
+ * rtp_packets array with its payload in the stream's rtp_payloads buffer,
+ * so that long calls don't cost a copy of the dissected info and two
+ * allocations per packet */
 typedef struct _rtp_packet {
-	struct _rtp_info *info;	/* the RTP dissected info */
 	double arrive_offset;	/* arrive offset time since the beginning of the stream in ms */
-	guint8* payload_data;
+	guint32 timestamp;
+	guint16 seq_num;
+	guint8 payload_type;
+	const gchar *payload_type_str;
+	guint32 payload_offset;	/* offset of the payload in rtp_payloads */
+	guint32 payload_len;	/* 0 if the payload wasn't captured */
 } rtp_packet_t;
 
 /* defines the two RTP channels to be played */
@@ -251,21 +258,9 @@ static void
 rtp_stream_value_destroy(gpointer rsi_arg)
 {
 	rtp_stream_info_t *rsi = (rtp_stream_info_t *)rsi_arg;
-	GList*  rtp_packet_list;
-	rtp_packet_t *rp;
-
-	rtp_packet_list = g_list_first(rsi->rtp_packet_list);
-	while (rtp_packet_list)
-	{
-		rp = (rtp_packet_t *)rtp_packet_list->data;
 
-		g_free(rp->info);
-		g_free(rp->payload_data);
-		g_free(rp);
-		rp = NULL;
-
-		rtp_packet_list = g_list_next(rtp_packet_list);
-	}
+	g_array_free(rsi->rtp_packets, TRUE);
+	g_byte_array_free(rsi->rtp_payloads, TRUE);
 	g_free((void *)(rsi->src_addr.data));
 	g_free((void *)(rsi->dest_addr.data));
 	g_free(rsi);
@@ -341,7 +336,7 @@ void
 add_rtp_packet(const struct _rtp_info *rtp_info, packet_info *pinfo)
 {
 	rtp_stream_info_t *stream_info = NULL;
-	rtp_packet_t *new_rtp_packet;
+	rtp_packet_t new_rtp_packet;
 	GString *key_str = NULL;
 
 	/* create the streams hash if it doen't exist */
@@ -369,6 +364,8 @@ add_rtp_packet(const struct _rtp_info *rtp_info, packet_info *pinfo)
 		stream_info->ssrc = rtp_info->info_sync_src;
 		stream_info->start_fd = pinfo->fd;
 		stream_info->start_rel_time = pinfo->rel_ts;
+		stream_info->rtp_packets = g_array_new(FALSE, FALSE, sizeof(rtp_packet_t));
+		stream_info->rtp_payloads = g_byte_array_new();
 
 		g_hash_table_insert(rtp_streams_hash, g_strdup(key_str->str), stream_info);
 
@@ -379,21 +376,22 @@ add_rtp_packet(const struct _rtp_info *rtp_info, packet_info *pinfo)
 	/* increment the number of packets in this stream, this is used for the progress bar and statistics */
     stream_info->packet_count++;
 
-	/* Add the RTP packet to the list */
-    new_rtp_packet = g_new0(rtp_packet_t, 1);
-	new_rtp_packet->info = (struct _rtp_info *)g_malloc(sizeof(struct _rtp_info));
-
-	memcpy(new_rtp_packet->info, rtp_info, sizeof(struct _rtp_info));
-    new_rtp_packet->arrive_offset = nstime_to_msec(&pinfo->rel_ts) - nstime_to_msec(&stream_info->start_rel_time);
-	/* copy the RTP payload to the rtp_packet to be decoded later */
+	/* Add the RTP packet to the stream */
+	new_rtp_packet.arrive_offset = nstime_to_msec(&pinfo->rel_ts) - nstime_to_msec(&stream_info->start_rel_time);
+	new_rtp_packet.timestamp = rtp_info->info_timestamp;
+	new_rtp_packet.seq_num = rtp_info->info_seq_num;
+	new_rtp_packet.payload_type = rtp_info->info_payload_type;
+	new_rtp_packet.payload_type_str = rtp_info->info_payload_type_str;
+	new_rtp_packet.payload_offset = stream_info->rtp_payloads->len;
+	/* copy the RTP payload to be decoded later */
 	if (rtp_info->info_all_data_present && (rtp_info->info_payload_len != 0)) {
-		new_rtp_packet->payload_data = (guint8 *)g_malloc(rtp_info->info_payload_len);
-		memcpy(new_rtp_packet->payload_data, &(rtp_info->info_data[rtp_info->info_payload_offset]), rtp_info->info_payload_len);
+		new_rtp_packet.payload_len = rtp_info->info_payload_len;
+		g_byte_array_append(stream_info->rtp_payloads, &(rtp_info->info_data[rtp_info->info_payload_offset]), rtp_info->info_payload_len);
 	} else {
-		new_rtp_packet->payload_data = NULL;
+		new_rtp_packet.payload_len = 0;
 	}
 
-    stream_info->rtp_packet_list = g_list_append(stream_info->rtp_packet_list, new_rtp_packet);
+	g_array_append_val(stream_info->rtp_packets, new_rtp_packet);
 
 	g_string_free(key_str, TRUE);
 }
@@ -456,7 +454,7 @@ mark_all_rtp_stream_to_decode(gchar *key _U_ , rtp_stream_info_t *rsi, gpointer
  * Return the number of decoded bytes
  */
 static int
-decode_rtp_packet(rtp_packet_t *rp, SAMPLE **out_buff, GHashTable *decoders_hash)
+decode_rtp_packet(rtp_packet_t *rp, const guint8 *payload_data, SAMPLE **out_buff, GHashTable *decoders_hash)
 {
 	unsigned int  payload_type;
 	const gchar *p;
@@ -465,11 +463,11 @@ decode_rtp_packet(rtp_packet_t *rp, SAMPLE **out_buff, GHashTable *decoders_hash
 	int tmp_buff_len;
 	int decoded_bytes = 0;
 
-	if ((rp->payload_data == NULL) || (rp->info->info_payload_len == 0) ) {
+	if (rp->payload_len == 0) {
 		return 0;
 	}
 
-	payload_type = rp->info->info_payload_type;
+	payload_type = rp->payload_type;
 
 	/* Look for registered codecs */
 	decoder = (rtp_decoder_t *)g_hash_table_lookup(decoders_hash, GUINT_TO_POINTER(payload_type));
@@ -478,8 +476,8 @@ decode_rtp_packet(rtp_packet_t *rp, SAMPLE **out_buff, GHashTable *decoders_hash
 		decoder->handle = NULL;
 		decoder->context = NULL;
 
-		if (rp->info->info_payload_type_str && find_codec(rp->info->info_payload_type_str)) {
-			p = rp->info->info_payload_type_str;
+		if (rp->payload_type_str && find_codec(rp->payload_type_str)) {
+			p = rp->payload_type_str;
 		} else {
 			p = try_val_to_str_ext(payload_type, &rtp_payload_type_short_vals_ext);
 		}
@@ -492,9 +490,9 @@ decode_rtp_packet(rtp_packet_t *rp, SAMPLE **out_buff, GHashTable *decoders_hash
 		g_hash_table_insert(decoders_hash, GUINT_TO_POINTER(payload_type), decoder);
 	}
 	if (decoder->handle) {  /* Decode with registered codec */
-		tmp_buff_len = codec_decode(decoder->handle, decoder->context, rp->payload_data, rp->info->info_payload_len, NULL, NULL);
+		tmp_buff_len = codec_decode(decoder->handle, decoder->context, payload_data, rp->payload_len, NULL, NULL);
 		tmp_buff = (SAMPLE *)g_malloc(tmp_buff_len);
-		decoded_bytes = codec_decode(decoder->handle, decoder->context, rp->payload_data, rp->info->info_payload_len, tmp_buff, &tmp_buff_len);
+		decoded_bytes = codec_decode(decoder->handle, decoder->context, payload_data, rp->payload_len, tmp_buff, &tmp_buff_len);
 		*out_buff = tmp_buff;
 
 		channels = codec_get_channels(decoder->handle, decoder->context);
@@ -529,7 +527,7 @@ decode_rtp_stream(rtp_stream_info_t *rsi, gpointer ptr)
 	GString *key_str = NULL;
 	rtp_channel_info_t *rci;
 	gboolean first = TRUE;
-	GList*  rtp_packet_list;
+	guint packet_index;
 	rtp_packet_t *rp;
 
 	int i;
@@ -642,8 +640,7 @@ decode_rtp_stream(rtp_stream_info_t *rsi, gpointer ptr)
 
 	status = S_NORMAL;
 
-	rtp_packet_list = g_list_first(rsi->rtp_packet_list);
-	while (rtp_packet_list)
+	for (packet_index = 0; packet_index < rsi->rtp_packets->len; packet_index++)
 	{
 
 		if (progbar_count >= progbar_nextstep) {
@@ -657,23 +654,23 @@ decode_rtp_stream(rtp_stream_info_t *rsi, gpointer ptr)
 		}
 
 
-		rp = (rtp_packet_t *)rtp_packet_list->data;
+		rp = &g_array_index(rsi->rtp_packets, rtp_packet_t, packet_index);
 		if (first == TRUE) {
 /* defined start_timestmp to avoid overflow in timestamp. TODO: handle the timestamp correctly */
 /* XXX: if timestamps (RTP) are missing/ignored try use packet arrive time only (see also "rtp_time") */
-			start_timestamp = rp->info->info_timestamp;
+			start_timestamp = rp->timestamp;
 			start_rtp_time = 0;
 			rtp_time_prev = start_rtp_time;
 			first = FALSE;
-			seq = rp->info->info_seq_num - 1;
+			seq = rp->seq_num - 1;
 		}
 
-		decoded_bytes = decode_rtp_packet(rp, &out_buff, decoders_hash);
+		decoded_bytes = decode_rtp_packet(rp, rsi->rtp_payloads->data + rp->payload_offset, &out_buff, decoders_hash);
 		if (decoded_bytes == 0) {
-			seq = rp->info->info_seq_num;
+			seq = rp->seq_num;
 		}
 
-		rtp_time = (double)(rp->info->info_timestamp-start_timestamp)/sample_rate - start_rtp_time;
+		rtp_time = (double)(rp->timestamp-start_timestamp)/sample_rate - start_rtp_time;
 
 		if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(cb_use_rtp_timestamp))) {
 			arrive_time = rtp_time;
@@ -681,11 +678,11 @@ decode_rtp_stream(rtp_stream_info_t *rsi, gpointer ptr)
 			arrive_time = (double)rp->arrive_offset/1000 - start_time;
 		}
 
-		if (rp->info->info_seq_num != seq+1){
+		if (rp->seq_num != seq+1){
 			rci->out_of_seq++;
 			status = S_WRONG_SEQ;
 		}
-		seq = rp->info->info_seq_num;
+		seq = rp->seq_num;
 
 		diff = arrive_time - rtp_time;
 
@@ -693,7 +690,7 @@ decode_rtp_stream(rtp_stream_info_t *rsi, gpointer ptr)
 
 #ifdef DEBUG
 		total_time = (double)rp->arrive_offset/1000;
-		printf("seq = %d arr = %f abs_diff = %f index = %d tim = %f ji=%d jb=%f\n",rp->info->info_seq_num,
+		printf("seq = %d arr = %f abs_diff = %f index = %d tim = %f ji=%d jb=%f\n",rp->seq_num,
 			total_time, diff, rci->samples->len, ((double)rci->samples->len / sample_rate - total_time) * 1000, 0,
 				(mean_delay + 4 * variation) * 1000);
 		fflush(stdout);
@@ -730,7 +727,7 @@ decode_rtp_stream(rtp_stream_info_t *rsi, gpointer ptr)
 				decoded_bytes_prev = 0;
 /* defined start_timestmp to avoid overflow in timestamp. TODO: handle the timestamp correctly */
 /* XXX: if timestamps (RTP) are missing/ignored try use packet arrive time only (see also "rtp_time") */
-				start_timestamp = rp->info->info_timestamp;
+				start_timestamp = rp->timestamp;
 				start_rtp_time = 0;
 				start_time = (double)rp->arrive_offset/1000;
 				rtp_time_prev = 0;
@@ -785,7 +782,6 @@ decode_rtp_stream(rtp_stream_info_t *rsi, gpointer ptr)
 			g_free(out_buff);
 			out_buff = NULL;
 		}
-		rtp_packet_list = g_list_next (rtp_packet_list);
 		progbar_count++;
 	}
 	rci->max_frame_index = rci->samples->len;
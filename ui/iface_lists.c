@@ -114,6 +114,8 @@ scan_local_interfaces(void (*update_cb)(void))
     if_list = capture_interface_list(&global_capture_opts.ifaces_err,
                                      &global_capture_opts.ifaces_err_info,
                                      update_cb);
+    /* Get all the interfaces' capabilities from one dumpcap run */
+    capture_prefetch_if_capabilities(if_list, prefs_capture_device_monitor_mode, update_cb);
     count = 0;
     for (if_entry = if_list; if_entry != NULL; if_entry = g_list_next(if_entry)) {
         if_info = (if_info_t *)if_entry->data;
@@ -136,6 +136,149 @@ GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_u
     return err_str;
 }
 
+io_graph_pyramid_t *io_graph_pyramid_new(guint32 base_interval)
+{
+    io_graph_pyramid_t *pyr = g_new0(io_graph_pyramid_t, 1);
+    guint level;
+
+    for (level = 0; level < IO_GRAPH_PYRAMID_LEVELS; level++) {
+        pyr->levels[level] = g_array_new(FALSE, TRUE, sizeof(io_graph_item_t));
+    }
+    io_graph_pyramid_reset(pyr, base_interval);
+    return pyr;
+}
+
+void io_graph_pyramid_reset(io_graph_pyramid_t *pyr, guint32 base_interval)
+{
+    guint level;
+
+    for (level = 0; level < IO_GRAPH_PYRAMID_LEVELS; level++) {
+        g_array_set_size(pyr->levels[level], 0);
+    }
+    pyr->base_interval = base_interval > 0 ? base_interval : 1;
+    pyr->last_idx = -1;
+    pyr->dirty_from = 0;
+}
+
+void io_graph_pyramid_free(io_graph_pyramid_t *pyr)
+{
+    guint level;
+
+    if (!pyr) {
+        return;
+    }
+    for (level = 0; level < IO_GRAPH_PYRAMID_LEVELS; level++) {
+        g_array_free(pyr->levels[level], TRUE);
+    }
+    g_free(pyr);
+}
+
+gboolean io_graph_pyramid_update(io_graph_pyramid_t *pyr, int idx, packet_info *pinfo,
+                                 epan_dissect_t *edt, int hf_index, int item_unit)
+{
+    GArray *base = pyr->levels[0];
+
+    if (idx < 0) {
+        return FALSE;
+    }
+    /* The array is cleared as it grows, and a zeroed item is a reset one. */
+    if ((guint)idx >= base->len) {
+        g_array_set_size(base, idx + 1);
+    }
+    if (idx > pyr->last_idx) {
+        pyr->last_idx = idx;
+    }
+
+    /* LOAD spreads a call's time back over the items before this one. */
+    if (item_unit == IOG_ITEM_UNIT_CALC_LOAD) {
+        pyr->dirty_from = 0;
+    } else if ((guint)idx < pyr->dirty_from) {
+        pyr->dirty_from = idx;
+    }
+
+    return update_io_graph_item((io_graph_item_t *)(void *)base->data, idx, pinfo, edt,
+                                hf_index, item_unit, pyr->base_interval);
+}
+
+/* Rebuild the items of the levels above 0 that cover changed base items. */
+static void io_graph_pyramid_build(io_graph_pyramid_t *pyr)
+{
+    guint level, first, i;
+    guint base_len = pyr->levels[0]->len;
+
+    first = pyr->dirty_from;
+    for (level = 1; level < IO_GRAPH_PYRAMID_LEVELS; level++) {
+        GArray *below = pyr->levels[level - 1];
+        GArray *cur = pyr->levels[level];
+        guint len = (below->len + IO_GRAPH_PYRAMID_FANOUT - 1) / IO_GRAPH_PYRAMID_FANOUT;
+
+        first /= IO_GRAPH_PYRAMID_FANOUT;
+        g_array_set_size(cur, len);
+        for (i = first; i < len; i++) {
+            io_graph_item_t *item = &g_array_index(cur, io_graph_item_t, i);
+            guint child = i * IO_GRAPH_PYRAMID_FANOUT;
+            guint end = MIN(child + IO_GRAPH_PYRAMID_FANOUT, below->len);
+
+            reset_io_graph_items(item, 1);
+            for (; child < end; child++) {
+                merge_io_graph_item(item, &g_array_index(below, io_graph_item_t, child));
+            }
+        }
+        if (len <= 1) {
+            break;
+        }
+    }
+    pyr->dirty_from = base_len;
+}
+
+int io_graph_pyramid_num_items(const io_graph_pyramid_t *pyr, guint32 interval)
+{
+    guint32 ratio = interval / pyr->base_interval;
+
+    if (pyr->last_idx < 0 || ratio == 0) {
+        return 0;
+    }
+    return pyr->last_idx / ratio + 1;
+}
+
+void io_graph_pyramid_get_item(io_graph_pyramid_t *pyr, guint32 interval, int idx,
+                               io_graph_item_t *item)
+{
+    guint64 ratio = interval / pyr->base_interval;
+    guint64 lo, hi;
+
+    reset_io_graph_items(item, 1);
+    if (idx < 0 || ratio == 0) {
+        return;
+    }
+    if (pyr->dirty_from < pyr->levels[0]->len) {
+        io_graph_pyramid_build(pyr);
+    }
+
+    lo = (guint64)idx * ratio;
+    hi = MIN(lo + ratio, (guint64)pyr->levels[0]->len);
+
+    /*
+     * Cover [lo, hi) from left to right with the largest aligned blocks
+     * that fit, so that no more than FANOUT - 1 items of each level are
+     * merged on each side.
+     */
+    while (lo < hi) {
+        guint level = 0;
+        guint64 span = 1;
+
+        while (level + 1 < IO_GRAPH_PYRAMID_LEVELS &&
+               lo % (span * IO_GRAPH_PYRAMID_FANOUT) == 0 &&
+               lo + span * IO_GRAPH_PYRAMID_FANOUT <= hi &&
+               lo / (span * IO_GRAPH_PYRAMID_FANOUT) < pyr->levels[level + 1]->len) {
+            span *= IO_GRAPH_PYRAMID_FANOUT;
+            level++;
+        }
+        merge_io_graph_item(item, &g_array_index(pyr->levels[level], io_graph_item_t, (guint)(lo / span)));
+        lo += span;
+    }
+}
+
 /*
  * Editor modelines
  *
@@ -101,6 +101,54 @@ reset_io_graph_items(io_graph_item_t *items, gsize count) {
     }
 }
 
+/** Add the values of one io_graph_item_t to another, so that items
+ * calculated for short intervals can be combined into one for an interval
+ * that spans them. The items must have been updated with the same field and
+ * item unit, and src must follow dst in time.
+ *
+ * @param dst [in,out] The item to add to.
+ * @param src [in] The item to add.
+ */
+static inline void
+merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src) {
+    if (src->fields != 0) {
+        if (dst->fields == 0) {
+            dst->int_max    = src->int_max;
+            dst->int_min    = src->int_min;
+            dst->float_max  = src->float_max;
+            dst->float_min  = src->float_min;
+            dst->double_max = src->double_max;
+            dst->double_min = src->double_min;
+            dst->time_max   = src->time_max;
+            dst->time_min   = src->time_min;
+        } else {
+            if (src->int_max > dst->int_max) dst->int_max = src->int_max;
+            if (src->int_min < dst->int_min) dst->int_min = src->int_min;
+            if (src->float_max > dst->float_max) dst->float_max = src->float_max;
+            if (src->float_min < dst->float_min) dst->float_min = src->float_min;
+            if (src->double_max > dst->double_max) dst->double_max = src->double_max;
+            if (src->double_min < dst->double_min) dst->double_min = src->double_min;
+            if (nstime_cmp(&src->time_max, &dst->time_max) > 0) dst->time_max = src->time_max;
+            if (nstime_cmp(&src->time_min, &dst->time_min) < 0) dst->time_min = src->time_min;
+        }
+    }
+
+    dst->frames     += src->frames;
+    dst->bytes      += src->bytes;
+    dst->fields     += src->fields;
+    dst->int_tot    += src->int_tot;
+    dst->float_tot  += src->float_tot;
+    dst->double_tot += src->double_tot;
+    nstime_add(&dst->time_tot, &src->time_tot);
+
+    if (dst->first_frame_in_invl == 0) {
+        dst->first_frame_in_invl = src->first_frame_in_invl;
+    }
+    if (src->last_frame_in_invl != 0) {
+        dst->last_frame_in_invl = src->last_frame_in_invl;
+    }
+}
+
 /** Get the interval (array index) for a packet
  *
  * It is up to the caller to determine if the return value is valid.
@@ -317,6 +365,73 @@ update_io_graph_item(io_graph_item_t *items, int idx, packet_info *pinfo, epan_d
     return TRUE;
 }
 
+/*
+ * A pyramid of io_graph_item_t, like a mipmap: level 0 holds the items
+ * for a base interval, and each level above holds items for intervals
+ * IO_GRAPH_PYRAMID_FANOUT times as long as the one below, each the merge
+ * of the items under it.  The items for any multiple of the base interval
+ * can then be made from a few items of the right levels rather than by
+ * merging every base item.  Levels only take as much memory as the time
+ * the packets span.
+ */
+#define IO_GRAPH_PYRAMID_FANOUT 10
+#define IO_GRAPH_PYRAMID_LEVELS 8
+
+typedef struct _io_graph_pyramid_t {
+    guint32  base_interval;     /* interval of the level 0 items, in ms */
+    GArray  *levels[IO_GRAPH_PYRAMID_LEVELS];
+    int      last_idx;          /* last level 0 item updated, or -1 */
+    guint    dirty_from;        /* first level 0 item changed since the levels above were built */
+} io_graph_pyramid_t;
+
+/** Create an empty pyramid.
+ *
+ * @param base_interval [in] Interval of the finest items, in ms.
+ * @return The new pyramid, to be freed with io_graph_pyramid_free().
+ */
+io_graph_pyramid_t *io_graph_pyramid_new(guint32 base_interval);
+
+/** Empty a pyramid and give it a new base interval.
+ *
+ * @param pyr [in,out] The pyramid.
+ * @param base_interval [in] Interval of the finest items, in ms.
+ */
+void io_graph_pyramid_reset(io_graph_pyramid_t *pyr, guint32 base_interval);
+
+void io_graph_pyramid_free(io_graph_pyramid_t *pyr);
+
+/** Update the base item for a packet, as update_io_graph_item() does.
+ *
+ * @param pyr [in,out] The pyramid.
+ * @param idx [in] Index of the base item, from get_io_graph_index() with the base interval.
+ * @param pinfo [in] Packet containing update information.
+ * @param edt [in] Dissection information for advanced statistics. May be NULL.
+ * @param hf_index [in] Header field index for advanced statistics.
+ * @param item_unit [in] The type of unit to calculate. From IOG_ITEM_UNITS.
+ * @return TRUE if the update was successful, otherwise FALSE.
+ */
+gboolean io_graph_pyramid_update(io_graph_pyramid_t *pyr, int idx, packet_info *pinfo,
+                                 epan_dissect_t *edt, int hf_index, int item_unit);
+
+/** Get the number of items there are at an interval, up to and including
+ * the last one updated.
+ *
+ * @param pyr [in] The pyramid.
+ * @param interval [in] A multiple of the base interval, in ms.
+ * @return The number of items.
+ */
+int io_graph_pyramid_num_items(const io_graph_pyramid_t *pyr, guint32 interval);
+
+/** Get the item for an interval.
+ *
+ * @param pyr [in,out] The pyramid. Levels are rebuilt if needed.
+ * @param interval [in] A multiple of the base interval, in ms.
+ * @param idx [in] Index of the item at that interval.
+ * @param item [out] The item.
+ */
+void io_graph_pyramid_get_item(io_graph_pyramid_t *pyr, guint32 interval, int idx,
+                               io_graph_item_t *item);
+
 
 #ifdef __cplusplus
 }
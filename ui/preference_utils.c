@@ -189,6 +189,41 @@ reset_stashed_pref(pref_t *pref) {
   }
 }
 
+typedef struct {
+  pref_cb   fetch_cb;
+  gboolean  changed;
+  guint     effect;
+} fetch_effect_arg_t;
+
+static guint
+pref_fetch_effect(pref_t *pref, gpointer user_data)
+{
+  fetch_effect_arg_t *arg = (fetch_effect_arg_t *)user_data;
+  gboolean pref_changed = FALSE;
+  guint ret;
+
+  ret = arg->fetch_cb(pref, &pref_changed);
+  if (pref_changed) {
+    arg->changed = TRUE;
+    arg->effect |= pref->effect;
+  }
+  return ret;
+}
+
+guint
+prefs_module_fetch_effect(module_t *module, pref_cb fetch_cb)
+{
+  fetch_effect_arg_t arg;
+
+  arg.fetch_cb = fetch_cb;
+  arg.changed = FALSE;
+  arg.effect = 0;
+  prefs_pref_foreach(module, pref_fetch_effect, &arg);
+  module->prefs_changed = arg.changed;
+
+  return arg.effect;
+}
+
 guint
 pref_clean_stash(pref_t *pref, gpointer unused _U_)
 {
@@ -67,6 +67,18 @@ extern guint pref_clean_stash(pref_t *pref, gpointer unused _U_);
  */
 extern void reset_stashed_pref(pref_t *pref);
 
+/** Fetch or unstash each preference in a module and find out what the
+ * changes make stale.
+ *
+ * @param module A preference module. Its prefs_changed flag is set
+ * according to whether any of its preferences changed.
+ * @param fetch_cb pref_unstash() or a routine like it, which sets the gboolean
+ * its user_data points to when the preference changes.
+ *
+ * @return The PREF_EFFECT_ flags of the preferences that changed, or 0.
+ */
+extern guint prefs_module_fetch_effect(module_t *module, pref_cb fetch_cb);
+
 
 /** If autoscroll in live captures is active or not
  */
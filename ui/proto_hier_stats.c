@@ -131,13 +131,48 @@ process_tree(proto_tree *protocol_tree, ph_stats_t* ps, guint pkt_len)
 	process_node(ptree_node, ps->stats_tree, ps, pkt_len);
 }
 
+/* Count a frame whose protocols were recorded when it was dissected. */
+static void
+process_stack(const int *stack, guint len, ph_stats_t* ps, guint pkt_len)
+{
+	GNode			*stat_node = ps->stats_tree;
+	ph_stats_node_t		*stats = NULL;
+	guint			i;
+
+	for (i = 0; i < len; i++) {
+		stat_node = find_stat_node(stat_node, proto_registrar_get_nth(stack[i]));
+		stats = STAT_NODE_STATS(stat_node);
+		stats->num_pkts_total++;
+		stats->num_bytes_total += pkt_len;
+	}
+
+	if (stats) {
+		stats->num_pkts_last++;
+		stats->num_bytes_last += pkt_len;
+	}
+}
+
+static void
+process_times(frame_data *frame, ph_stats_t* ps)
+{
+	double				cur_time;
+
+	if (frame->flags.has_ts) {
+		/* Update times */
+		cur_time = nstime_to_sec(&frame->abs_ts);
+		if (cur_time < ps->first_time)
+			ps->first_time = cur_time;
+		if (cur_time > ps->last_time)
+			ps->last_time = cur_time;
+	}
+}
+
 static gboolean
 process_record(frame_data *frame, column_info *cinfo, ph_stats_t* ps)
 {
 	epan_dissect_t			edt;
 	struct wtap_pkthdr              phdr;
 	Buffer				buf;
-	double				cur_time;
 
 	wtap_phdr_init(&phdr);
 
@@ -155,14 +190,7 @@ process_record(frame_data *frame, column_info *cinfo, ph_stats_t* ps)
 	/* Get stats from this protocol tree */
 	process_tree(edt.tree, ps, frame->pkt_len);
 
-	if (frame->flags.has_ts) {
-		/* Update times */
-		cur_time = nstime_to_sec(&frame->abs_ts);
-		if (cur_time < ps->first_time)
-			ps->first_time = cur_time;
-		if (cur_time > ps->last_time)
-			ps->last_time = cur_time;
-	}
+	process_times(frame, ps);
 
 	/* Free our memory. */
 	epan_dissect_cleanup(&edt);
@@ -187,6 +215,9 @@ ph_stats_new(void)
 	gchar		status_str[100];
 	int		progbar_nextstep;
 	int		progbar_quantum;
+	guint32		stack_num;
+	const int	*stack;
+	guint		stack_len;
 
 	/* Initialize the data */
 	ps = g_new(ph_stats_t, 1);
@@ -271,8 +302,18 @@ ph_stats_new(void)
 				}
 			}
 
+			/* If we recorded the protocols in the frame when
+			   we read it, we don't need to dissect it again. */
+			stack_num = cfile.proto_stacks != NULL ?
+			    proto_stack_store_get(cfile.proto_stacks, framenum) : 0;
+			if (stack_num != 0) {
+				stack = proto_stack_store_stack(cfile.proto_stacks,
+				    stack_num, &stack_len);
+				process_stack(stack, stack_len, ps, frame->pkt_len);
+				process_times(frame, ps);
+			}
 			/* we don't care about colinfo */
-			if (!process_record(frame, NULL, ps)) {
+			else if (!process_record(frame, NULL, ps)) {
 				/*
 				 * Give up, and set "stop_flag" so we
 				 * just abort rather than popping up
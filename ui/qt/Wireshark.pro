@@ -213,6 +213,7 @@ FORMS += \
     column_editor_frame.ui \
     compiled_filter_output.ui \
     decode_as_dialog.ui \
+    dissector_timing_dialog.ui \
     export_object_dialog.ui \
     export_pdu_dialog.ui \
     file_set_dialog.ui \
@@ -237,6 +238,7 @@ FORMS += \
     preferences_dialog.ui \
     print_dialog.ui \
     profile_dialog.ui \
+    reassembly_statistics_dialog.ui \
     remote_capture_dialog.ui  \
     remote_settings_dialog.ui  \
     sctp_all_assocs_dialog.ui   \
@@ -267,6 +269,7 @@ HEADERS += $$HEADERS_WS_C \
     compiled_filter_output.h \
     conversation_dialog.h \
     decode_as_dialog.h \
+    dissector_timing_dialog.h \
     elided_label.h \
     endpoint_dialog.h \
     export_dissection_dialog.h \
@@ -290,6 +293,7 @@ HEADERS += $$HEADERS_WS_C \
     preferences_dialog.h \
     print_dialog.h \
     profile_dialog.h \
+    reassembly_statistics_dialog.h \
     remote_capture_dialog.h  \
     remote_settings_dialog.h    \
     sctp_all_assocs_dialog.h  \
@@ -608,6 +612,7 @@ SOURCES += \
     compiled_filter_output.cpp \
     conversation_dialog.cpp \
     decode_as_dialog.cpp \
+    dissector_timing_dialog.cpp \
     display_filter_combo.cpp \
     display_filter_edit.cpp \
     elided_label.cpp \
@@ -650,6 +655,7 @@ SOURCES += \
     proto_tree.cpp \
     qcustomplot.cpp \
     qt_ui_utils.cpp \
+    reassembly_statistics_dialog.cpp \
     recent_file_status.cpp \
     related_packet_delegate.cpp \
     remote_capture_dialog.cpp  \
@@ -31,6 +31,7 @@
 
 #include <QActionGroup>
 #include <QMouseEvent>
+#include <QPaintEvent>
 #include <QPainter>
 #include <QScrollBar>
 
@@ -43,6 +44,10 @@
 // would like to add support for this you'll probably have to call
 // QPainter::drawText for each individual character.
 
+// Rows are formatted once and kept, so that scrolling back and changing
+// the highlight only repaints. Enough for a few screenfuls.
+const int max_cached_lines_ = 1024;
+
 Q_DECLARE_METATYPE(bytes_view_type)
 
 ByteViewText::ByteViewText(QWidget *parent, tvbuff_t *tvb, proto_tree *tree, QTreeWidget *tree_widget, packet_char_enc encoding) :
@@ -60,8 +65,14 @@ ByteViewText::ByteViewText(QWidget *parent, tvbuff_t *tvb, proto_tree *tree, QTr
     show_offset_(true),
     show_hex_(true),
     show_ascii_(true),
-    row_width_(16)
+    row_width_(16),
+    one_em_(0),
+    font_width_(0),
+    line_spacing_(0),
+    margin_(0)
 {
+    line_cache_.setMaxCost(max_cached_lines_);
+
     QAction *action;
 
     action = format_actions_->addAction(tr("Show bytes as hexadecimal"));
@@ -83,6 +94,7 @@ ByteViewText::ByteViewText(QWidget *parent, tvbuff_t *tvb, proto_tree *tree, QTr
 void ByteViewText::setEncoding(packet_char_enc encoding)
 {
     encoding_ = encoding;
+    line_cache_.clear();
     viewport()->update();
 }
 
@@ -94,25 +106,22 @@ bool ByteViewText::hasDataSource(const tvbuff_t *ds_tvb) {
 
 void ByteViewText::setProtocolHighlight(int start, int end)
 {
-    p_bound_ = QPair<guint, guint>(qMax(0, start), qMax(0, end));
+    setBound(p_bound_, QPair<guint, guint>(qMax(0, start), qMax(0, end)));
     p_bound_save_ = p_bound_;
-    viewport()->update();
 }
 
 void ByteViewText::setFieldHighlight(int start, int end, guint32 mask, int mask_le)
 {
     Q_UNUSED(mask);
     Q_UNUSED(mask_le);
-    f_bound_ = QPair<guint, guint>(qMax(0, start), qMax(0, end));
+    setBound(f_bound_, QPair<guint, guint>(qMax(0, start), qMax(0, end)));
     f_bound_save_ = f_bound_;
-    viewport()->update();
 }
 
 void ByteViewText::setFieldAppendixHighlight(int start, int end)
 {
-    fa_bound_ = QPair<guint, guint>(qMax(0, start), qMax(0, end));
+    setBound(fa_bound_, QPair<guint, guint>(qMax(0, start), qMax(0, end)));
     fa_bound_save_ = f_bound_;
-    viewport()->update();
 }
 
 void ByteViewText::setMonospaceFont(const QFont &mono_font)
@@ -129,11 +138,12 @@ void ByteViewText::setMonospaceFont(const QFont &mono_font)
 
     setFont(mono_font);
 
+    x_pos_to_column_.clear();
     updateScrollbars();
     viewport()->update();
 }
 
-void ByteViewText::paintEvent(QPaintEvent *)
+void ByteViewText::paintEvent(QPaintEvent *event)
 {
     QPainter painter(viewport());
     painter.translate(-horizontalScrollBar()->value() * font_width_, 0);
@@ -161,8 +171,7 @@ void ByteViewText::paintEvent(QPaintEvent *)
     }
 
     // Map window coordinates to byte offsets
-    x_pos_to_column_.clear();
-    for (guint i = 0; i < row_width_; i++) {
+    for (guint i = 0; x_pos_to_column_.isEmpty() && i < row_width_; i++) {
         int sep_width = (i / separator_interval_) * font_width_;
         if (show_hex_) {
             // Hittable pixels extend 1/2 space on either side of the hex digits
@@ -180,11 +189,17 @@ void ByteViewText::paintEvent(QPaintEvent *)
         }
     }
 
-    // Data rows
+    // Data rows. Skip the ones outside of the area being repainted, e.g.
+    // when only the highlight changed.
     int widget_height = height();
+    int first_y = event->rect().top();
+    int last_y = event->rect().bottom();
+    guint tvb_len = tvb_captured_length(tvb_);
     painter.save();
-    while(row_y + line_spacing_ < widget_height && offset < tvb_captured_length(tvb_)) {
-        drawOffsetLine(painter, offset, row_y);
+    while(row_y + line_spacing_ < widget_height && row_y <= last_y && offset < tvb_len) {
+        if (row_y + line_spacing_ > first_y) {
+            drawOffsetLine(painter, offset, row_y);
+        }
         offset += row_width_;
         row_y += line_spacing_;
     }
@@ -204,15 +219,11 @@ void ByteViewText::mousePressEvent (QMouseEvent *event) {
     QPoint pos = event->pos();
     field_info *fi = fieldAtPixel(pos);
 
-    if (fi && tree_widget_) {
-        // XXX - This should probably be a ProtoTree method.
-        QTreeWidgetItemIterator iter(tree_widget_);
-        while (*iter) {
-            if (fi == (*iter)->data(0, Qt::UserRole).value<field_info *>()) {
-                tree_widget_->setCurrentItem((*iter));
-            }
-
-            iter++;
+    ProtoTree *proto_tree = qobject_cast<ProtoTree *>(tree_widget_);
+    if (fi && proto_tree) {
+        QTreeWidgetItem *item = proto_tree->itemForField(fi);
+        if (item) {
+            proto_tree->setCurrentItem(item);
         }
     }
 }
@@ -222,10 +233,9 @@ void ByteViewText::mouseMoveEvent(QMouseEvent *event)
     QString field_str;
     if (!event) {
         emit byteFieldHovered(field_str);
-        p_bound_ = p_bound_save_;
-        f_bound_ = f_bound_save_;
-        fa_bound_ = fa_bound_save_;
-        viewport()->update();
+        setBound(p_bound_, p_bound_save_);
+        setBound(f_bound_, f_bound_save_);
+        setBound(fa_bound_, fa_bound_save_);
         return;
     }
     QPoint pos = event->pos();
@@ -242,26 +252,24 @@ void ByteViewText::mouseMoveEvent(QMouseEvent *event)
         field_str += QString(": %1 (%2)")
                 .arg(fi->hfinfo->name)
                 .arg(fi->hfinfo->abbrev);
-        f_bound_ = QPair<guint, guint>(fi->start, fi->start + fi->length);
-        p_bound_ = QPair<guint, guint>(0, 0);
-        fa_bound_ = QPair<guint, guint>(0, 0);
+        setBound(f_bound_, QPair<guint, guint>(fi->start, fi->start + fi->length));
+        setBound(p_bound_, QPair<guint, guint>(0, 0));
+        setBound(fa_bound_, QPair<guint, guint>(0, 0));
     } else {
-        p_bound_ = p_bound_save_;
-        f_bound_ = f_bound_save_;
-        fa_bound_ = fa_bound_save_;
+        setBound(p_bound_, p_bound_save_);
+        setBound(f_bound_, f_bound_save_);
+        setBound(fa_bound_, fa_bound_save_);
     }
     emit byteFieldHovered(field_str);
-    viewport()->update();
 }
 
 void ByteViewText::leaveEvent(QEvent *event)
 {
     QString empty;
     emit byteFieldHovered(empty);
-    p_bound_ = p_bound_save_;
-    f_bound_ = f_bound_save_;
-    fa_bound_ = fa_bound_save_;
-    viewport()->update();
+    setBound(p_bound_, p_bound_save_);
+    setBound(f_bound_, f_bound_save_);
+    setBound(fa_bound_, fa_bound_save_);
     QAbstractScrollArea::leaveEvent(event);
 }
 
@@ -274,137 +282,138 @@ void ByteViewText::contextMenuEvent(QContextMenuEvent *event)
 
 const int ByteViewText::separator_interval_ = 8; // Insert a space after this many bytes
 
-// Draw a line of byte view text for a given offset.
-// Text with different styles are split into fragments and passed to
-// flushOffsetFragment. Font character widths aren't necessarily whole
-// numbers so we track our X coordinate position using using floats.
-void ByteViewText::drawOffsetLine(QPainter &painter, const guint offset, const int row_y)
+// Format the hex and ASCII text of the row at offset, or fetch it from
+// the cache. Byte i of the row starts at character i * stride +
+// i / separator_interval_ of either string, where the stride is one
+// byte's characters plus the space after them.
+const ByteViewText::FormattedLine *ByteViewText::formattedLine(guint offset, guint len)
 {
-    if (!tvb_) {
-        return;
+    FormattedLine *line = line_cache_.object(offset);
+    if (line) {
+        return line;
     }
-    guint tvb_len = tvb_captured_length(tvb_);
-    guint max_pos = qMin(offset + row_width_, tvb_len);
-    const guint8 *pd = tvb_get_ptr(tvb_, 0, -1);
 
-    static const guchar hexchars[16] = {
+    static const char hexchars[16] = {
         '0', '1', '2', '3', '4', '5', '6', '7',
         '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
 
-    QString text;
-    highlight_state state = StateNormal, offset_state = StateOffsetNormal;
-    qreal hex_x = offsetPixels() + margin_;
-    qreal ascii_x = offsetPixels() + hexPixels() + margin_;
+    const guint8 *pd = tvb_get_ptr(tvb_, offset, len);
+    QByteArray hex, ascii;
+
+    hex.reserve(row_width_ * 9 + row_width_ / separator_interval_);
+    ascii.reserve(row_width_ + row_width_ / separator_interval_);
+    for (guint i = 0; i < len; i++) {
+        if (i > 0) {
+            hex += ' ';
+            /* insert a space every separator_interval_ bytes */
+            if ((i % separator_interval_) == 0) {
+                hex += ' ';
+                ascii += ' ';
+            }
+        }
 
-    // Hex
-    if (show_hex_) {
-        for (guint tvb_pos = offset; tvb_pos < max_pos; tvb_pos++) {
-            highlight_state hex_state = StateNormal;
-            bool add_space = tvb_pos != offset;
+        switch (format_) {
+        case BYTES_HEX:
+            hex += hexchars[(pd[i] & 0xf0) >> 4];
+            hex += hexchars[pd[i] & 0x0f];
+            break;
+        case BYTES_BITS:
+            /* XXX, bitmask */
+            for (int j = 7; j >= 0; j--)
+                hex += (pd[i] & (1 << j)) ? '1' : '0';
+            break;
+        }
 
-            if ((tvb_pos >= f_bound_.first && tvb_pos < f_bound_.second) || (tvb_pos >= fa_bound_.first && tvb_pos < fa_bound_.second)) {
-                hex_state = StateField;
-                offset_state = StateOffsetField;
-            } else if (tvb_pos >= p_bound_.first && tvb_pos < p_bound_.second) {
-                hex_state = StateProtocol;
-            }
+        guchar c = (encoding_ == PACKET_CHAR_ENC_CHAR_EBCDIC) ?
+                    EBCDIC_to_ASCII1(pd[i]) :
+                    pd[i];
 
-            if (hex_state != state) {
-                if ((state == StateNormal || (state == StateProtocol && hex_state == StateField)) && add_space) {
-                    add_space = false;
-                    text += ' ';
-                    /* insert a space every separator_interval_ bytes */
-                    if ((tvb_pos % separator_interval_) == 0)
-                        text += ' ';
-                }
-                hex_x += flushOffsetFragment(painter, hex_x, row_y, state, text);
-                state = hex_state;
-            }
+        ascii += g_ascii_isprint(c) ? (char) c : '.';
+    }
 
-            if (add_space) {
-                text += ' ';
-                /* insert a space every separator_interval_ bytes */
-                if ((tvb_pos % separator_interval_) == 0)
-                    text += ' ';
-            }
+    line = new FormattedLine;
+    line->hex = QString::fromLatin1(hex);
+    line->ascii = QString::fromLatin1(ascii);
+    line_cache_.insert(offset, line);
+    return line;
+}
 
-            switch (format_) {
-            case BYTES_HEX:
-                text += hexchars[(pd[tvb_pos] & 0xf0) >> 4];
-                text += hexchars[pd[tvb_pos] & 0x0f];
-                break;
-            case BYTES_BITS:
-                /* XXX, bitmask */
-                for (int j = 7; j >= 0; j--)
-                    text += (pd[tvb_pos] & (1 << j)) ? '1' : '0';
-                break;
-            }
-        }
+ByteViewText::highlight_state ByteViewText::byteState(guint pos)
+{
+    if ((pos >= f_bound_.first && pos < f_bound_.second) || (pos >= fa_bound_.first && pos < fa_bound_.second)) {
+        return StateField;
+    } else if (pos >= p_bound_.first && pos < p_bound_.second) {
+        return StateProtocol;
+    }
+    return StateNormal;
+}
+
+// Draw a line of byte view text for a given offset.
+void ByteViewText::drawOffsetLine(QPainter &painter, const guint offset, const int row_y)
+{
+    if (!tvb_) {
+        return;
     }
-    if (text.length() > 0) {
-        flushOffsetFragment(painter, hex_x, row_y, state, text);
+    guint tvb_len = tvb_captured_length(tvb_);
+    guint max_pos = qMin(offset + row_width_, tvb_len);
+    const FormattedLine *line = formattedLine(offset, max_pos - offset);
+    int byte_chars = format_ == BYTES_HEX ? 2 : 8;
+
+    // Hex
+    if (show_hex_) {
+        drawLineText(painter, offsetPixels() + margin_, row_y, line->hex, offset, max_pos - offset, byte_chars, byte_chars + 1);
     }
-    state = StateNormal;
 
     // ASCII
     if (show_ascii_) {
-        for (guint tvb_pos = offset; tvb_pos < max_pos; tvb_pos++) {
-            highlight_state ascii_state = StateNormal;
-            bool add_space = tvb_pos != offset;
+        drawLineText(painter, offsetPixels() + hexPixels() + margin_, row_y, line->ascii, offset, max_pos - offset, 1, 1);
+    }
 
-            if ((tvb_pos >= f_bound_.first && tvb_pos < f_bound_.second) || (tvb_pos >= fa_bound_.first && tvb_pos < fa_bound_.second)) {
-                ascii_state = StateField;
+    // Offset
+    if (show_offset_) {
+        highlight_state offset_state = StateOffsetNormal;
+        for (guint tvb_pos = offset; tvb_pos < max_pos; tvb_pos++) {
+            if (byteState(tvb_pos) == StateField) {
                 offset_state = StateOffsetField;
-            } else if (tvb_pos >= p_bound_.first && tvb_pos < p_bound_.second) {
-                ascii_state = StateProtocol;
-            }
-
-            if (ascii_state != state) {
-                if ((state == StateNormal || (state == StateProtocol && ascii_state == StateField)) && add_space) {
-                    add_space = false;
-                    /* insert a space every separator_interval_ bytes */
-                    if ((tvb_pos % separator_interval_) == 0)
-                        text += ' ';
-                }
-                ascii_x += flushOffsetFragment(painter, ascii_x, row_y, state, text);
-                state = ascii_state;
+                break;
             }
+        }
+        drawFragment(painter, margin_, row_y, offset_state, QString("%1").arg(offset, offsetChars(), 16, QChar('0')));
+    }
+}
 
-            if (add_space) {
-                /* insert a space every separator_interval_ bytes */
-                if ((tvb_pos % separator_interval_) == 0)
-                    text += ' ';
-            }
+// Draw the text of a row split into fragments with the same highlight.
+// The spaces between two fragments go with the less highlighted one.
+void ByteViewText::drawLineText(QPainter &painter, qreal x, int y, const QString &text, guint offset, guint len, int byte_chars, int stride)
+{
+    highlight_state state = StateNormal;
+    int start = 0;
 
-            guchar c = (encoding_ == PACKET_CHAR_ENC_CHAR_EBCDIC) ?
-                        EBCDIC_to_ASCII1(pd[tvb_pos]) :
-                        pd[tvb_pos];
+    for (guint i = 0; i < len; i++) {
+        highlight_state byte_state = byteState(offset + i);
 
-            text += g_ascii_isprint(c) ? c : '.';
+        if (byte_state != state) {
+            int end = i * stride + i / separator_interval_;
+            if (i > 0 && (state == StateNormal || (state == StateProtocol && byte_state == StateField))) {
+                end = (i - 1) * stride + (i - 1) / separator_interval_ + byte_chars;
+            }
+            drawFragment(painter, x + start * font_width_, y, state, text.mid(start, end - start));
+            start = end;
+            state = byte_state;
         }
     }
-    if (text.length() > 0) {
-        flushOffsetFragment(painter, ascii_x, row_y, state, text);
-    }
-    state = StateNormal;
-
-    // Offset. Must be drawn last in order for offset_state to be set.
-    if (show_offset_) {
-        text = QString("%1").arg(offset, offsetChars(), 16, QChar('0'));
-        flushOffsetFragment(painter, margin_, row_y, offset_state, text);
-    }
+    drawFragment(painter, x + start * font_width_, y, state, text.mid(start));
 }
 
 // Draws a fragment of byte view text at the specifiec location using colors
-// for the specified state. Clears the text and returns the pixel width of the
-// drawn text.
-qreal ByteViewText::flushOffsetFragment(QPainter &painter, qreal x, int y, highlight_state state, QString &text)
+// for the specified state. The font is monospaced, so the width of the
+// text follows from its length.
+void ByteViewText::drawFragment(QPainter &painter, qreal x, int y, highlight_state state, const QString &text)
 {
     if (text.length() < 1) {
-        return 0;
+        return;
     }
-    QFontMetricsF fm(mono_font_);
-    qreal width = fm.width(text);
+    qreal width = text.length() * font_width_;
     // Background
     if (state == StateField) {
         painter.fillRect(QRectF(x, y, width, line_spacing_), palette().highlight());
@@ -433,8 +442,34 @@ qreal ByteViewText::flushOffsetFragment(QPainter &painter, qreal x, int y, highl
 
     painter.setPen(QPen(text_brush.color()));
     painter.drawText(QRectF(x, y, width, line_spacing_), Qt::AlignTop, text);
-    text.clear();
-    return width;
+}
+
+// Change a highlight, repainting the rows it covered and now covers.
+void ByteViewText::setBound(QPair<guint,guint> &bound, const QPair<guint,guint> &new_bound)
+{
+    if (bound == new_bound) {
+        return;
+    }
+    updateBytes(bound);
+    bound = new_bound;
+    updateBytes(bound);
+}
+
+// Repaint the visible rows holding the bytes in bound.
+void ByteViewText::updateBytes(const QPair<guint,guint> &bound)
+{
+    if (bound.second <= bound.first || line_spacing_ < 1) {
+        return;
+    }
+
+    qint64 top_row = verticalScrollBar()->value();
+    qint64 first_row = qMax((qint64) bound.first / row_width_ - top_row, (qint64) 0);
+    qint64 last_row = qMin((qint64) (bound.second - 1) / row_width_ - top_row, (qint64) viewport()->height() / line_spacing_);
+
+    if (first_row > last_row) {
+        return;
+    }
+    viewport()->update(0, first_row * line_spacing_, viewport()->width(), (last_row - first_row + 1) * line_spacing_);
 }
 
 void ByteViewText::scrollToByte(int byte)
@@ -521,6 +556,8 @@ void ByteViewText::setHexDisplayFormat(QAction *action)
 
     format_ = action->data().value<bytes_view_type>();
     row_width_ = format_ == BYTES_HEX ? 16 : 8;
+    line_cache_.clear();
+    x_pos_to_column_.clear();
     viewport()->update();
 }
 
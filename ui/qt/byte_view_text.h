@@ -31,6 +31,7 @@
 #include "proto_tree.h"
 
 #include <QAbstractScrollArea>
+#include <QCache>
 #include <QMenu>
 
 class QActionGroup;
@@ -79,8 +80,19 @@ private:
         StateOffsetField
     } highlight_state;
 
+    // The hex and ASCII text of a row, without highlighting
+    struct FormattedLine {
+        QString hex;
+        QString ascii;
+    };
+
+    const FormattedLine *formattedLine(guint offset, guint len);
+    highlight_state byteState(guint pos);
     void drawOffsetLine(QPainter &painter, const guint offset, const int row_y);
-    qreal flushOffsetFragment(QPainter &painter, qreal x, int y, highlight_state state, QString &text);
+    void drawLineText(QPainter &painter, qreal x, int y, const QString &text, guint offset, guint len, int byte_chars, int stride);
+    void drawFragment(QPainter &painter, qreal x, int y, highlight_state state, const QString &text);
+    void setBound(QPair<guint,guint> &bound, const QPair<guint,guint> &new_bound);
+    void updateBytes(const QPair<guint,guint> &bound);
     void scrollToByte(int byte);
     int offsetChars();
     int offsetPixels();
@@ -108,6 +120,7 @@ private:
     bytes_view_type format_;    // bytes in hex or bytes as bits
     QActionGroup *format_actions_;
     QMenu ctx_menu_;
+    QCache<guint, FormattedLine> line_cache_;   // Keyed by row offset
 
     // Data highlight
     QPair<guint,guint> p_bound_;
@@ -26,6 +26,9 @@
 
 #include "summary.h"
 
+#include <epan/packet.h>
+#include <epan/wmem/wmem.h>
+
 #include "wsutil/str_util.h"
 #include "wsutil/ws_version_info.h"
 
@@ -36,6 +39,27 @@
 #include <QPushButton>
 #include <QTextStream>
 
+// Bytes and allocations counted for one protocol
+struct ProtoMemory {
+    int proto_id;
+    guint64 bytes;
+    guint64 allocs;
+};
+
+static void
+collectProtoMemory(int owner, guint64 bytes, guint64 allocs, void *user_data)
+{
+    QList<ProtoMemory> *protos = (QList<ProtoMemory> *) user_data;
+    ProtoMemory pm = { owner, bytes, allocs };
+    protos->append(pm);
+}
+
+static bool
+protoMemoryGreaterThan(const ProtoMemory &a, const ProtoMemory &b)
+{
+    return a.bytes > b.bytes;
+}
+
 // To do:
 // - Add file hashes
 // - Add formats (HTML, plain text, YAML)?
@@ -478,6 +502,75 @@ QString CaptureFilePropertiesDialog::summaryToHtml()
 
     out << table_end;
 
+    // Memory by protocol, if the "memory_accounting" preference is on
+    if (!file_closed_ && wmem_accounting_is_active()) {
+        QList<ProtoMemory> protos;
+
+        wmem_accounting_foreach(wmem_file_scope(), collectProtoMemory, &protos);
+        qSort(protos.begin(), protos.end(), protoMemoryGreaterThan);
+
+        out << section_tmpl.arg(tr("Memory by Protocol"));
+        out << table_begin;
+
+        out << table_ul_row_begin
+            << table_hheader25_tmpl.arg(tr("Protocol"))
+            << table_hheader25_tmpl.arg(tr("File scope memory"))
+            << table_hheader25_tmpl.arg(tr("Allocations"))
+            << table_row_end;
+
+        foreach (ProtoMemory pm, protos) {
+            QString proto_name = pm.proto_id == WMEM_NO_OWNER
+                    ? tr("(no protocol)")
+                    : proto_get_protocol_short_name(find_protocol_by_id(pm.proto_id));
+
+            out << table_row_begin
+                << table_data_tmpl.arg(proto_name)
+                << table_data_tmpl.arg(gchar_free_to_qstring(format_size(pm.bytes, format_size_unit_bytes|format_size_prefix_iec)))
+                << table_data_tmpl.arg((qulonglong) pm.allocs)
+                << table_row_end;
+        }
+
+        out << table_end;
+    }
+
+    // Memory pools
+    if (!file_closed_) {
+        const struct {
+            QString name;
+            wmem_allocator_t *pool;
+        } pools[] = {
+            { tr("Packet scope"), wmem_packet_scope() },
+            { tr("File scope"), wmem_file_scope() },
+            { tr("Program scope"), wmem_epan_scope() }
+        };
+
+        out << section_tmpl.arg(tr("Memory Pools"));
+        out << table_begin;
+
+        out << table_ul_row_begin
+            << table_hheader20_tmpl.arg(tr("Pool"))
+            << table_hheader20_tmpl.arg(tr("Allocations"))
+            << table_hheader20_tmpl.arg(tr("Requested"))
+            << table_hheader20_tmpl.arg(tr("Times emptied"))
+            << table_hheader20_tmpl.arg(tr("Most between emptyings"))
+            << table_row_end;
+
+        for (size_t i = 0; i < sizeof(pools) / sizeof(pools[0]); i++) {
+            wmem_allocator_stats_t stats;
+
+            wmem_get_stats(pools[i].pool, &stats);
+            out << table_row_begin
+                << table_data_tmpl.arg(pools[i].name)
+                << table_data_tmpl.arg((qulonglong) (stats.allocs + stats.reallocs))
+                << table_data_tmpl.arg(gchar_free_to_qstring(format_size(stats.bytes, format_size_unit_bytes|format_size_prefix_iec)))
+                << table_data_tmpl.arg((qulonglong) stats.free_alls)
+                << table_data_tmpl.arg(gchar_free_to_qstring(format_size(stats.peak_bytes, format_size_unit_bytes|format_size_prefix_iec)))
+                << table_row_end;
+        }
+
+        out << table_end;
+    }
+
     return summary_str;
 }
 
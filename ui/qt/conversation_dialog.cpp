@@ -326,67 +326,93 @@ const double min_bw_calc_duration_ = 5 / 1000.0; // seconds
 const QString bps_na_ = QObject::tr("N/A");
 
 const int ci_col_ = 0;
-const int pkts_col_ = 1;
 class ConversationTreeWidgetItem : public TrafficTableTreeWidgetItem
 {
 public:
-    ConversationTreeWidgetItem(QTreeWidget *tree) : TrafficTableTreeWidgetItem(tree)  {}
-    ConversationTreeWidgetItem(QTreeWidget *parent, const QStringList &strings)
-                   : TrafficTableTreeWidgetItem (parent, strings)  {}
+    ConversationTreeWidgetItem(conv_item_t *conv_item) : TrafficTableTreeWidgetItem()  {
+        setData(ci_col_, Qt::UserRole, qVariantFromValue(conv_item));
+    }
+
+    // Column text is cooked when the view asks for it, which it only
+    // does for the rows it shows.
+    QVariant data(int column, int role) const {
+        switch (role) {
+        case Qt::DisplayRole:
+            return displayText(column);
+        case Qt::TextAlignmentRole:
+            if (column != CONV_COLUMN_SRC_ADDR && column != CONV_COLUMN_DST_ADDR) {
+                return (int) Qt::AlignRight;
+            }
+            break;
+        default:
+            break;
+        }
+        return TrafficTableTreeWidgetItem::data(column, role);
+    }
 
-    // Set column text to its cooked representation.
-    void update(gboolean resolve_names) {
+    QString displayText(int col) const {
         conv_item_t *conv_item = data(ci_col_, Qt::UserRole).value<conv_item_t *>();
-        bool ok;
-        quint64 cur_packets = data(pkts_col_, Qt::UserRole).toULongLong(&ok);
-        char *src_addr, *dst_addr, *src_port, *dst_port;
+        TrafficTableTreeWidget *tree = static_cast<TrafficTableTreeWidget *>(treeWidget());
+        bool resolve_names = tree && tree->nameResolutionEnabled();
+        char *str;
+        QString col_str;
 
         if (!conv_item) {
-            return;
-        }
-
-        quint64 packets = conv_item->tx_frames + conv_item->rx_frames;
-        if (ok && cur_packets == packets) {
-            return;
+            return QString();
         }
 
-        src_addr = (char*)get_conversation_address(NULL, &conv_item->src_address, resolve_names);
-        dst_addr = (char*)get_conversation_address(NULL, &conv_item->dst_address, resolve_names);
-        src_port = (char*)get_conversation_port(NULL, conv_item->src_port, conv_item->ptype, resolve_names);
-        dst_port = (char*)get_conversation_port(NULL, conv_item->dst_port, conv_item->ptype, resolve_names);
-        setText(CONV_COLUMN_SRC_ADDR, src_addr);
-        setText(CONV_COLUMN_SRC_PORT, src_port);
-        setText(CONV_COLUMN_DST_ADDR, dst_addr);
-        setText(CONV_COLUMN_DST_PORT, dst_port);
-        wmem_free(NULL, src_addr);
-        wmem_free(NULL, dst_addr);
-        wmem_free(NULL, src_port);
-        wmem_free(NULL, dst_port);
-
         double duration = nstime_to_sec(&conv_item->stop_time) - nstime_to_sec(&conv_item->start_time);
-        QString col_str, bps_ab = bps_na_, bps_ba = bps_na_;
-
-        col_str = QString("%L1").arg(packets);
-        setText(CONV_COLUMN_PACKETS, col_str);
-        col_str = gchar_free_to_qstring(format_size(conv_item->tx_bytes + conv_item->rx_bytes, format_size_unit_none|format_size_prefix_si));
-        setText(CONV_COLUMN_BYTES, col_str);
-        col_str = QString("%L1").arg(conv_item->tx_frames);
-        setText(CONV_COLUMN_PKT_AB, QString::number(conv_item->tx_frames));
-        col_str = gchar_free_to_qstring(format_size(conv_item->tx_bytes, format_size_unit_none|format_size_prefix_si));
-        setText(CONV_COLUMN_BYTES_AB, col_str);
-        col_str = QString("%L1").arg(conv_item->rx_frames);
-        setText(CONV_COLUMN_PKT_BA, QString::number(conv_item->rx_frames));
-        col_str = gchar_free_to_qstring(format_size(conv_item->rx_bytes, format_size_unit_none|format_size_prefix_si));
-        setText(CONV_COLUMN_BYTES_BA, col_str);
-        setText(CONV_COLUMN_START, QString::number(nstime_to_sec(&conv_item->start_time), 'f', 9));
-        setText(CONV_COLUMN_DURATION, QString::number(duration, 'f', 6));
-        if (duration > min_bw_calc_duration_) {
-            bps_ab = gchar_free_to_qstring(format_size((gint64) conv_item->tx_bytes * 8 / duration, format_size_unit_none|format_size_prefix_si));
-            bps_ba = gchar_free_to_qstring(format_size((gint64) conv_item->rx_bytes * 8 / duration, format_size_unit_none|format_size_prefix_si));
+
+        switch (col) {
+        case CONV_COLUMN_SRC_ADDR:
+            str = (char*)get_conversation_address(NULL, &conv_item->src_address, resolve_names);
+            col_str = str;
+            wmem_free(NULL, str);
+            return col_str;
+        case CONV_COLUMN_SRC_PORT:
+            str = (char*)get_conversation_port(NULL, conv_item->src_port, conv_item->ptype, resolve_names);
+            col_str = str;
+            wmem_free(NULL, str);
+            return col_str;
+        case CONV_COLUMN_DST_ADDR:
+            str = (char*)get_conversation_address(NULL, &conv_item->dst_address, resolve_names);
+            col_str = str;
+            wmem_free(NULL, str);
+            return col_str;
+        case CONV_COLUMN_DST_PORT:
+            str = (char*)get_conversation_port(NULL, conv_item->dst_port, conv_item->ptype, resolve_names);
+            col_str = str;
+            wmem_free(NULL, str);
+            return col_str;
+        case CONV_COLUMN_PACKETS:
+            return QString("%L1").arg(conv_item->tx_frames + conv_item->rx_frames);
+        case CONV_COLUMN_BYTES:
+            return gchar_free_to_qstring(format_size(conv_item->tx_bytes + conv_item->rx_bytes, format_size_unit_none|format_size_prefix_si));
+        case CONV_COLUMN_PKT_AB:
+            return QString::number(conv_item->tx_frames);
+        case CONV_COLUMN_BYTES_AB:
+            return gchar_free_to_qstring(format_size(conv_item->tx_bytes, format_size_unit_none|format_size_prefix_si));
+        case CONV_COLUMN_PKT_BA:
+            return QString::number(conv_item->rx_frames);
+        case CONV_COLUMN_BYTES_BA:
+            return gchar_free_to_qstring(format_size(conv_item->rx_bytes, format_size_unit_none|format_size_prefix_si));
+        case CONV_COLUMN_START:
+            return QString::number(nstime_to_sec(&conv_item->start_time), 'f', 9);
+        case CONV_COLUMN_DURATION:
+            return QString::number(duration, 'f', 6);
+        case CONV_COLUMN_BPS_AB:
+            if (duration > min_bw_calc_duration_) {
+                return gchar_free_to_qstring(format_size((gint64) conv_item->tx_bytes * 8 / duration, format_size_unit_none|format_size_prefix_si));
+            }
+            return bps_na_;
+        case CONV_COLUMN_BPS_BA:
+            if (duration > min_bw_calc_duration_) {
+                return gchar_free_to_qstring(format_size((gint64) conv_item->rx_bytes * 8 / duration, format_size_unit_none|format_size_prefix_si));
+            }
+            return bps_na_;
+        default:
+            return QString();
         }
-        setText(CONV_COLUMN_BPS_AB, bps_ab);
-        setText(CONV_COLUMN_BPS_BA, bps_ba);
-        setData(pkts_col_, Qt::UserRole, qVariantFromValue(packets));
     }
 
     // Return a QString, qulonglong, double, or invalid QVariant representing the raw column data.
@@ -667,31 +693,17 @@ void ConversationTreeWidget::updateItems() {
     }
 
     setSortingEnabled(false);
+    QList<QTreeWidgetItem *> new_items;
     for (int i = topLevelItemCount(); i < (int) hash_.conv_array->len; i++) {
-        ConversationTreeWidgetItem *ctwi = new ConversationTreeWidgetItem(this);
         conv_item_t *conv_item = &g_array_index(hash_.conv_array, conv_item_t, i);
-        ctwi->setData(ci_col_, Qt::UserRole, qVariantFromValue(conv_item));
-        addTopLevelItem(ctwi);
-
-        for (int col = 0; col < columnCount(); col++) {
-            switch (col) {
-            case CONV_COLUMN_SRC_ADDR:
-            case CONV_COLUMN_DST_ADDR:
-            break;
-            default:
-                ctwi->setTextAlignment(col, Qt::AlignRight);
-                break;
-            }
-        }
-    }
-    QTreeWidgetItemIterator iter(this);
-    while (*iter) {
-        ConversationTreeWidgetItem *ci = static_cast<ConversationTreeWidgetItem *>(*iter);
-        ci->update(resolve_names_);
-        ++iter;
+        new_items << new ConversationTreeWidgetItem(conv_item);
     }
+    addTopLevelItems(new_items);
     setSortingEnabled(true);
 
+    // Existing rows may have new counts or names.
+    viewport()->update();
+
     for (int col = 0; col < columnCount(); col++) {
         resizeColumnToContents(col);
     }
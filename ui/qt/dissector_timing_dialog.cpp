@@ -0,0 +1,145 @@
+/* dissector_timing_dialog.cpp
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "dissector_timing_dialog.h"
+#include "ui_dissector_timing_dialog.h"
+
+#include <epan/packet.h>
+#include <epan/dissector_profile.h>
+
+#include "wireshark_application.h"
+
+#include <QPushButton>
+#include <QTreeWidget>
+
+enum {
+    col_protocol_,
+    col_calls_,
+    col_rejected_,
+    col_self_us_,
+    col_self_pct_,
+    col_total_us_
+};
+
+static void
+sum_self_time(const dissector_profile_t *profile, void *total_ptr)
+{
+    *static_cast<guint64 *>(total_ptr) += profile->self_ns;
+}
+
+static void
+add_profile(const dissector_profile_t *profile, void *tree_ptr)
+{
+    QTreeWidget *tree = static_cast<QTreeWidget *>(tree_ptr);
+    guint64 total_ns = tree->property("total_ns").toULongLong();
+
+    QTreeWidgetItem *ti = new QTreeWidgetItem(tree);
+    ti->setText(col_protocol_, proto_get_protocol_short_name(find_protocol_by_id(profile->proto_id)));
+    // Set numbers as data so that they sort as numbers.
+    ti->setData(col_calls_, Qt::DisplayRole, (qulonglong) profile->calls);
+    ti->setData(col_rejected_, Qt::DisplayRole, (qulonglong) profile->rejected);
+    ti->setData(col_self_us_, Qt::DisplayRole, (qulonglong) (profile->self_ns / 1000));
+    ti->setData(col_self_pct_, Qt::DisplayRole,
+                total_ns ? qRound(profile->self_ns * 1000.0 / total_ns) / 10.0 : 0.0);
+    ti->setData(col_total_us_, Qt::DisplayRole, (qulonglong) (profile->total_ns / 1000));
+    for (int col = col_calls_; col <= col_total_us_; col++) {
+        ti->setTextAlignment(col, Qt::AlignRight);
+    }
+}
+
+DissectorTimingDialog::DissectorTimingDialog(QWidget &parent, CaptureFile &capture_file) :
+    WiresharkDialog(parent, capture_file),
+    ui(new Ui::DissectorTimingDialog)
+{
+    ui->setupUi(this);
+
+    QPushButton *button = ui->buttonBox->button(QDialogButtonBox::Reset);
+    if (button) {
+        button->setText(tr("Refresh"));
+    }
+
+    ui->timeCheckBox->setChecked(dissector_profiling_is_active());
+
+    setWindowSubtitle(tr("Dissector Timing"));
+    updateWidgets();
+    ui->statsTreeWidget->sortByColumn(col_self_us_, Qt::DescendingOrder);
+}
+
+DissectorTimingDialog::~DissectorTimingDialog()
+{
+    // Timing slows dissection down; don't leave it on behind the user's back.
+    set_dissector_profiling(FALSE);
+    delete ui;
+}
+
+void DissectorTimingDialog::updateWidgets()
+{
+    guint64 total_ns = 0;
+
+    dissector_profile_foreach(sum_self_time, &total_ns);
+
+    ui->statsTreeWidget->setSortingEnabled(false);
+    ui->statsTreeWidget->clear();
+    ui->statsTreeWidget->setProperty("total_ns", (qulonglong) total_ns);
+    dissector_profile_foreach(add_profile, ui->statsTreeWidget);
+    ui->statsTreeWidget->setSortingEnabled(true);
+
+    for (int col = 0; col < ui->statsTreeWidget->columnCount(); col++) {
+        ui->statsTreeWidget->resizeColumnToContents(col);
+    }
+
+    ui->totalLabel->setText(tr("%1 ms spent in dissectors").arg(total_ns / 1000000.0, 0, 'f', 3));
+
+    WiresharkDialog::updateWidgets();
+}
+
+void DissectorTimingDialog::on_timeCheckBox_toggled(bool checked)
+{
+    if (checked == (bool) dissector_profiling_is_active()) return;
+
+    set_dissector_profiling(checked);
+
+    // Dissect the file again so that there is something to show.
+    if (checked && cap_file_.isValid()) {
+        wsApp->emitAppSignal(WiresharkApplication::PacketDissectionChanged);
+        updateWidgets();
+    }
+}
+
+void DissectorTimingDialog::on_buttonBox_clicked(QAbstractButton *button)
+{
+    if (button == ui->buttonBox->button(QDialogButtonBox::Reset)) {
+        updateWidgets();
+    }
+}
+
+/*
+ * Editor modelines
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * ex: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
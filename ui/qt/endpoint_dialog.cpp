@@ -212,79 +212,102 @@ void init_endpoint_table(struct register_ct* ct, const char *filter)
 // TrafficTableTreeWidgetItem / QTreeWidgetItem subclass that allows sorting
 
 const int ei_col_ = 0;
-const int pkts_col_ = 1;
 
 const char *geoip_none_ = "-";
 
 class EndpointTreeWidgetItem : public TrafficTableTreeWidgetItem
 {
 public:
-    EndpointTreeWidgetItem(QTreeWidget *tree) : TrafficTableTreeWidgetItem(tree)  {}
-    EndpointTreeWidgetItem(QTreeWidget *parent, const QStringList &strings)
-                   : TrafficTableTreeWidgetItem (parent, strings)  {}
+    EndpointTreeWidgetItem(hostlist_talker_t *endp_item) : TrafficTableTreeWidgetItem()  {
+        setData(ei_col_, Qt::UserRole, qVariantFromValue(endp_item));
+    }
+
+    // Column text is cooked when the view asks for it, which it only
+    // does for the rows it shows. The GeoIP columns don't change, so
+    // they're looked up once and stored.
+    QVariant data(int column, int role) const {
+        if (column < ENDP_NUM_COLUMNS) {
+            switch (role) {
+            case Qt::DisplayRole:
+                return displayText(column);
+            case Qt::TextAlignmentRole:
+                if (column != ENDP_COLUMN_ADDR) {
+                    return (int) Qt::AlignRight;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        return TrafficTableTreeWidgetItem::data(column, role);
+    }
 
-    // Set column text to its cooked representation.
-    void update(gboolean resolve_names) {
+    QString displayText(int col) const {
         hostlist_talker_t *endp_item = data(ei_col_, Qt::UserRole).value<hostlist_talker_t *>();
-        bool ok;
-        quint64 cur_packets = data(pkts_col_, Qt::UserRole).toULongLong(&ok);
-        char *addr_str, *port_str;
+        TrafficTableTreeWidget *tree = static_cast<TrafficTableTreeWidget *>(treeWidget());
+        bool resolve_names = tree && tree->nameResolutionEnabled();
+        char *str;
+        QString col_str;
 
         if (!endp_item) {
-            return;
+            return QString();
         }
 
-        quint64 packets = endp_item->tx_frames + endp_item->rx_frames;
-        if (ok && cur_packets == packets) {
-            return;
+        switch (col) {
+        case ENDP_COLUMN_ADDR:
+            str = (char*)get_conversation_address(NULL, &endp_item->myaddress, resolve_names);
+            col_str = str;
+            wmem_free(NULL, str);
+            return col_str;
+        case ENDP_COLUMN_PORT:
+            str = (char*)get_conversation_port(NULL, endp_item->port, endp_item->ptype, resolve_names);
+            col_str = str;
+            wmem_free(NULL, str);
+            return col_str;
+        case ENDP_COLUMN_PACKETS:
+            return QString("%L1").arg(endp_item->tx_frames + endp_item->rx_frames);
+        case ENDP_COLUMN_BYTES:
+            return gchar_free_to_qstring(format_size(endp_item->tx_bytes + endp_item->rx_bytes, format_size_unit_none|format_size_prefix_si));
+        case ENDP_COLUMN_PKT_AB:
+            return QString::number(endp_item->tx_frames);
+        case ENDP_COLUMN_BYTES_AB:
+            return gchar_free_to_qstring(format_size(endp_item->tx_bytes, format_size_unit_none|format_size_prefix_si));
+        case ENDP_COLUMN_PKT_BA:
+            return QString::number(endp_item->rx_frames);
+        case ENDP_COLUMN_BYTES_BA:
+            return gchar_free_to_qstring(format_size(endp_item->rx_bytes, format_size_unit_none|format_size_prefix_si));
+        default:
+            return QString();
         }
+    }
 
-        addr_str = (char*)get_conversation_address(NULL, &endp_item->myaddress, resolve_names);
-        port_str = (char*)get_conversation_port(NULL, endp_item->port, endp_item->ptype, resolve_names);
-        setText(ENDP_COLUMN_ADDR, addr_str);
-        setText(ENDP_COLUMN_PORT, port_str);
-        wmem_free(NULL, addr_str);
-        wmem_free(NULL, port_str);
-
-        QString col_str;
+#ifdef HAVE_GEOIP
+    // Filled in from the GeoIP config, if any
+    void setGeoIPText(const EndpointTreeWidget *ep_tree) {
+        hostlist_talker_t *endp_item = data(ei_col_, Qt::UserRole).value<hostlist_talker_t *>();
 
-        col_str = QString("%L1").arg(packets);
-        setText(ENDP_COLUMN_PACKETS, col_str);
-        col_str = gchar_free_to_qstring(format_size(endp_item->tx_bytes + endp_item->rx_bytes, format_size_unit_none|format_size_prefix_si));
-        setText(ENDP_COLUMN_BYTES, col_str);
-        col_str = QString("%L1").arg(endp_item->tx_frames);
-        setText(ENDP_COLUMN_PKT_AB, QString::number(endp_item->tx_frames));
-        col_str = gchar_free_to_qstring(format_size(endp_item->tx_bytes, format_size_unit_none|format_size_prefix_si));
-        setText(ENDP_COLUMN_BYTES_AB, col_str);
-        col_str = QString("%L1").arg(endp_item->rx_frames);
-        setText(ENDP_COLUMN_PKT_BA, QString::number(endp_item->rx_frames));
-        col_str = gchar_free_to_qstring(format_size(endp_item->rx_bytes, format_size_unit_none|format_size_prefix_si));
-        setText(ENDP_COLUMN_BYTES_BA, col_str);
-        setData(pkts_col_, Qt::UserRole, qVariantFromValue(packets));
+        if (!endp_item) {
+            return;
+        }
 
-#ifdef HAVE_GEOIP
-        /* Filled in from the GeoIP config, if any */
-        EndpointTreeWidget *ep_tree = qobject_cast<EndpointTreeWidget *>(treeWidget());
-        if (ep_tree) {
-            for (int col = ENDP_NUM_COLUMNS; col < ep_tree->columnCount(); col++) {
-                char *col_text = NULL;
-                foreach (unsigned db, ep_tree->columnToDb(col)) {
-                    if (endp_item->myaddress.type == AT_IPv4) {
-                        col_text = geoip_db_lookup_ipv4(db, pntoh32(endp_item->myaddress.data), NULL);
-                    } else if (endp_item->myaddress.type == AT_IPv6) {
-                        const struct e_in6_addr *addr = (const struct e_in6_addr *) endp_item->myaddress.data;
-                        col_text = geoip_db_lookup_ipv6(db, *addr, NULL);
-                    }
-                    if (col_text) {
-                        break;
-                    }
+        for (int col = ENDP_NUM_COLUMNS; col < ep_tree->columnCount(); col++) {
+            char *col_text = NULL;
+            foreach (unsigned db, ep_tree->columnToDb(col)) {
+                if (endp_item->myaddress.type == AT_IPv4) {
+                    col_text = geoip_db_lookup_ipv4(db, pntoh32(endp_item->myaddress.data), NULL);
+                } else if (endp_item->myaddress.type == AT_IPv6) {
+                    const struct e_in6_addr *addr = (const struct e_in6_addr *) endp_item->myaddress.data;
+                    col_text = geoip_db_lookup_ipv6(db, *addr, NULL);
+                }
+                if (col_text) {
+                    break;
                 }
-                setText(col, col_text ? col_text : geoip_none_);
-                wmem_free(NULL, col_text);
             }
+            setText(col, col_text ? col_text : geoip_none_);
+            wmem_free(NULL, col_text);
         }
-#endif
     }
+#endif
 
     // Return a string, qulonglong, double, or invalid QVariant representing the raw column data.
     QVariant colData(int col, bool resolve_names) const {
@@ -560,26 +583,21 @@ void EndpointTreeWidget::updateItems()
 #endif
 
     setSortingEnabled(false);
+    QList<QTreeWidgetItem *> new_items;
     for (int i = topLevelItemCount(); i < (int) hash_.conv_array->len; i++) {
-        EndpointTreeWidgetItem *etwi = new EndpointTreeWidgetItem(this);
         hostlist_talker_t *endp_item = &g_array_index(hash_.conv_array, hostlist_talker_t, i);
-        etwi->setData(ei_col_, Qt::UserRole, qVariantFromValue(endp_item));
-        addTopLevelItem(etwi);
-
-        for (int col = 0; col < columnCount(); col++) {
-            if (col != ENDP_COLUMN_ADDR && col < ENDP_NUM_COLUMNS) {
-                etwi->setTextAlignment(col, Qt::AlignRight);
-            }
-        }
-    }
-    QTreeWidgetItemIterator iter(this);
-    while (*iter) {
-        EndpointTreeWidgetItem *ei = static_cast<EndpointTreeWidgetItem *>(*iter);
-        ei->update(resolve_names_);
-        ++iter;
+        EndpointTreeWidgetItem *etwi = new EndpointTreeWidgetItem(endp_item);
+#ifdef HAVE_GEOIP
+        etwi->setGeoIPText(this);
+#endif
+        new_items << etwi;
     }
+    addTopLevelItems(new_items);
     setSortingEnabled(true);
 
+    // Existing rows may have new counts or names.
+    viewport()->update();
+
     for (int col = 0; col < columnCount(); col++) {
         resizeColumnToContents(col);
     }
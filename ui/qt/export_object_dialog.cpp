@@ -125,9 +125,20 @@ ExportObjectDialog::ExportObjectDialog(QWidget &parent, CaptureFile &cf, ObjectT
 
 ExportObjectDialog::~ExportObjectDialog()
 {
-    delete eo_ui_;
     export_object_list_.eod = NULL;
     remove_tap_listener((void *)&export_object_list_);
+    freeObjectEntries();
+    delete eo_ui_;
+}
+
+void ExportObjectDialog::freeObjectEntries()
+{
+    for (int i = 0; i < eo_ui_->objectTree->topLevelItemCount(); i++) {
+        QTreeWidgetItem *item = eo_ui_->objectTree->topLevelItem(i);
+        export_object_entry_t *entry = item->data(0, Qt::UserRole).value<export_object_entry_t *>();
+        if (entry) eo_free_entry(entry);
+    }
+    eo_ui_->objectTree->clear();
 }
 
 void ExportObjectDialog::addObjectEntry(export_object_entry_t *entry)
@@ -166,6 +177,7 @@ export_object_entry_t *ExportObjectDialog::objectEntry(int row)
 void ExportObjectDialog::resetObjects()
 {
     if (eo_protocoldata_resetfn_) eo_protocoldata_resetfn_();
+    freeObjectEntries();
     if (save_bt_) save_bt_->setEnabled(false);
     if (save_all_bt_) save_all_bt_->setEnabled(false);
 }
@@ -280,11 +292,20 @@ void ExportObjectDialog::saveAllEntries()
 
     if (file_path.length() < 1 || file_path.length() > MAXFILELEN) return;
 
-    for (i = 0, item = eo_ui_->objectTree->topLevelItem(i); item != NULL; i++) {
+    // Payloads are copied from the spool file one object at a time.
+    int num_items = eo_ui_->objectTree->topLevelItemCount();
+    eo_ui_->progressLabel->setText(tr("Saving"));
+    eo_ui_->progressBar->setRange(0, num_items);
+    eo_ui_->progressFrame->show();
+
+    for (i = 0; (item = eo_ui_->objectTree->topLevelItem(i)) != NULL; i++) {
         int count = 0;
         QString file_name;
         export_object_entry_t *entry = item->data(0, Qt::UserRole).value<export_object_entry_t *>();
 
+        eo_ui_->progressBar->setValue(i);
+        wsApp->processEvents();
+
         if (!entry) continue;
 
         do {
@@ -306,10 +327,11 @@ void ExportObjectDialog::saveAllEntries()
             }
             file_name = path.filePath(safe_filename->str);
             g_string_free(safe_filename, TRUE);
-        } while (g_file_test(file_path.toUtf8().constData(), G_FILE_TEST_EXISTS) && ++count < 1000);
-        if (!eo_save_entry(file_path.toUtf8().constData(), entry, FALSE))
+        } while (g_file_test(file_name.toUtf8().constData(), G_FILE_TEST_EXISTS) && ++count < 1000);
+        if (!eo_save_entry(file_name.toUtf8().constData(), entry, FALSE))
             all_saved = false;
     }
+    eo_ui_->progressFrame->hide();
     if (!all_saved) {
         QMessageBox::warning(
                     this,
@@ -79,6 +79,7 @@ private slots:
 private:
     void saveCurrentEntry();
     void saveAllEntries();
+    void freeObjectEntries();
 
     /* When a protocol needs intermediate data structures to construct the
     export objects, then it must specifiy a function that cleans up all
@@ -54,13 +54,18 @@ fileset_dlg_add_file(fileset_entry *entry, void *window) {
 FileSetDialog::FileSetDialog(QWidget *parent) :
     QDialog(parent),
     fs_ui_(new Ui::FileSetDialog),
-    close_button_(NULL)
+    close_button_(NULL),
+    view_all_button_(NULL)
 {
     fs_ui_->setupUi(this);
 
     fs_ui_->fileSetTree->headerItem();
 
     close_button_ = fs_ui_->buttonBox->button(QDialogButtonBox::Close);
+    view_all_button_ = fs_ui_->buttonBox->addButton(tr("View All as One"), QDialogButtonBox::ActionRole);
+    view_all_button_->setToolTip(tr("Open all the files of the set as one capture, in time order"));
+    view_all_button_->setEnabled(false);
+    connect(view_all_button_, SIGNAL(clicked()), this, SLOT(viewAllButtonClicked()));
     addFile();
 }
 
@@ -80,6 +85,7 @@ void FileSetDialog::fileOpened(const capture_file *cf) {
 void FileSetDialog::fileClosed() {
     fileset_delete();
     fs_ui_->fileSetTree->clear();
+    view_all_button_->setEnabled(false);
 }
 
 #include <QDebug>
@@ -137,6 +143,7 @@ void FileSetDialog::addFile(fileset_entry *entry) {
 
     if (close_button_)
         close_button_->setEnabled(true);
+    view_all_button_->setEnabled(true);
 
     fs_ui_->fileSetTree->addTopLevelItem(entry_item);
     for (int i = 0; i < fs_ui_->fileSetTree->columnCount(); i++)
@@ -186,6 +193,21 @@ void FileSetDialog::on_fileSetTree_currentItemChanged(QTreeWidgetItem *current,
         emit fileSetOpenCaptureFile(new_cf_path);
 }
 
+void FileSetDialog::viewAllButtonClicked()
+{
+    QStringList cf_paths;
+
+    for (int i = 0; i < fs_ui_->fileSetTree->topLevelItemCount(); i++) {
+        fileset_entry *entry = fs_ui_->fileSetTree->topLevelItem(i)->data(0, Qt::UserRole).value<fileset_entry *>();
+
+        if (entry)
+            cf_paths << entry->fullname;
+    }
+
+    if (cf_paths.size() > 0)
+        emit fileSetOpenCaptureFileSet(cf_paths);
+}
+
 /*
  * Editor modelines
  *
@@ -50,16 +50,19 @@ public:
 
 signals:
     void fileSetOpenCaptureFile(QString &);
+    void fileSetOpenCaptureFileSet(QStringList &);
 
 private slots:
     void on_buttonBox_helpRequested();
     void on_fileSetTree_currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
+    void viewAllButtonClicked();
 
 private:
     QString nameToDate(const char *name);
 
     Ui::FileSetDialog *fs_ui_;
     QPushButton *close_button_;
+    QPushButton *view_all_button_;
 };
 
 #endif // FILE_SET_DIALOG_H
@@ -71,6 +71,11 @@ FollowStreamDialog::FollowStreamDialog(QWidget &parent, CaptureFile &cf, follow_
     ui(new Ui::FollowStreamDialog),
     follow_type_(type),
     truncated_(false),
+    cur_page_(0),
+    client_port_(0),
+    total_client_packets_(0),
+    total_server_packets_(0),
+    total_turns_(0),
     save_as_(false)
 {
     ui->setupUi(this);
@@ -104,6 +109,13 @@ FollowStreamDialog::FollowStreamDialog(QWidget &parent, CaptureFile &cf, follow_
     b_save_ = ui->buttonBox->addButton(tr("Save as..."), QDialogButtonBox::ActionRole);
     connect(b_save_, SIGNAL(clicked()), this, SLOT(saveAs()));
 
+    b_prev_page_ = ui->buttonBox->addButton(tr("Previous Page"), QDialogButtonBox::ActionRole);
+    connect(b_prev_page_, SIGNAL(clicked()), this, SLOT(previousPage()));
+
+    b_next_page_ = ui->buttonBox->addButton(tr("Next Page"), QDialogButtonBox::ActionRole);
+    connect(b_next_page_, SIGNAL(clicked()), this, SLOT(nextPage()));
+    updatePageButtons();
+
     connect(ui->buttonBox, SIGNAL(helpRequested()), this, SLOT(helpButton()));
     connect(ui->teStreamContent, SIGNAL(mouseMovedToTextCursorPosition(int)),
             this, SLOT(fillHintLabel(int)));
@@ -154,6 +166,10 @@ void FollowStreamDialog::fillHintLabel(int text_pos)
             .arg(ColorUtils::fromColorT(prefs.st_server_bg).name())
             + tr("%Ln turn(s).", "", turns_);
 
+    if (stream_pages_.size() > 1) {
+        hint += QString(tr(" Page %1 of %2.")).arg(cur_page_ + 1).arg(stream_pages_.size());
+    }
+
     if (pkt > 0) {
         hint.append(QString(tr(" Click to select.")));
     }
@@ -215,22 +231,25 @@ void FollowStreamDialog::findText(bool go_back)
 void FollowStreamDialog::saveAs()
 {
     QString file_name = QFileDialog::getSaveFileName(this, wsApp->windowTitleString(tr("Save Stream Content As" UTF8_HORIZONTAL_ELLIPSIS)));
+    if (file_name.isEmpty()) return;
+
     file_.setFileName(file_name);
-    file_.open( QIODevice::WriteOnly );
-    QTextStream out(&file_);
+    if (!file_.open(QIODevice::WriteOnly)) {
+        QMessageBox::warning(this, tr("Error saving stream."),
+                             QString(tr("Could not open %1: %2")).arg(file_name).arg(file_.errorString()));
+        return;
+    }
 
+    // The whole stream, not just the page on show, is written straight
+    // to the file as it's read.
     save_as_ = true;
-
     readStream();
-
-    if (follow_info_.show_type != SHOW_RAW)
-    {
-        out << ui->teStreamContent->toPlainText();
-    }
-
     save_as_ = false;
 
     file_.close();
+
+    // Saving went through the state used for showing; show the page again.
+    readStream();
 }
 
 void FollowStreamDialog::helpButton()
@@ -245,6 +264,34 @@ void FollowStreamDialog::filterOut()
     close();
 }
 
+void FollowStreamDialog::previousPage()
+{
+    if (cur_page_ <= 0) return;
+    cur_page_--;
+    readStream();
+    updatePageButtons();
+    fillHintLabel(-1);
+}
+
+void FollowStreamDialog::nextPage()
+{
+    if (cur_page_ + 1 >= stream_pages_.size()) return;
+    cur_page_++;
+    readStream();
+    updatePageButtons();
+    fillHintLabel(-1);
+}
+
+void FollowStreamDialog::updatePageButtons()
+{
+    bool paged = stream_pages_.size() > 1;
+
+    b_prev_page_->setVisible(paged);
+    b_next_page_->setVisible(paged);
+    b_prev_page_->setEnabled(cur_page_ > 0);
+    b_next_page_->setEnabled(cur_page_ + 1 < stream_pages_.size());
+}
+
 void FollowStreamDialog::on_cbDirections_currentIndexChanged(int index)
 {
     switch(index)
@@ -326,12 +373,16 @@ void FollowStreamDialog::resetStream()
     g_list_free(follow_info_.payload);
     follow_info_.payload = NULL;
     follow_info_.client_port = 0;
+    stream_pages_.clear();
+    cur_page_ = 0;
+    updatePageButtons();
 }
 
 frs_return_t
 FollowStreamDialog::readStream()
 {
     ui->teStreamContent->clear();
+    text_pos_to_packet_.clear();
     truncated_ = false;
     frs_return_t ret;
 
@@ -345,8 +396,25 @@ FollowStreamDialog::readStream()
     switch(follow_type_) {
 
     case FOLLOW_TCP :
-        ret = readTcpStream();
+    {
+        if (stream_pages_.isEmpty() && !indexTcpStream()) {
+            ret = FRS_READ_ERROR;
+            break;
+        }
+        if (save_as_) {
+            stream_page_t start;
+            memset(&start, 0, sizeof(start));
+            ret = readTcpStream(start, -1);
+        } else {
+            ret = readTcpStream(stream_pages_[cur_page_],
+                                cur_page_ + 1 < stream_pages_.size() ? stream_pages_[cur_page_ + 1].offset : -1);
+        }
+        // The counts are for the whole stream, not the page.
+        client_packet_count_ = total_client_packets_;
+        server_packet_count_ = total_server_packets_;
+        turns_ = total_turns_;
         break;
+    }
 
     case FOLLOW_UDP :
         ret = readUdpStream();
@@ -528,6 +596,8 @@ FollowStreamDialog::followStream()
 
     follow_info_.is_ipv6 = stats.is_ipv6;
 
+    // Index the stream again now that we know the address length.
+    stream_pages_.clear();
     readStream();
 }
 
@@ -538,17 +608,7 @@ void FollowStreamDialog::addText(QString text, gboolean is_from_server, guint32
 {
     if (save_as_ == true)
     {
-        //FILE *fh = (FILE *)arg;
-        size_t nwritten;
-        int FileDescriptor = file_.handle();
-        FILE* fh = fdopen(dup(FileDescriptor), "wb");
-        nwritten = fwrite(text.toUtf8().constData(), text.length(), 1, fh);
-        fclose(fh);
-        if ((int)nwritten != text.length()) {
-#if 0
-            report_an_error_maybe();
-#endif
-        }
+        file_.write(text.toUtf8());
         return;
     }
 
@@ -685,6 +745,11 @@ FollowStreamDialog::showBuffer(char *buffer, size_t nchars, gboolean is_from_ser
 
     case SHOW_RAW: // UTF-8
     {
+        if (save_as_) {
+            // Save the bytes themselves.
+            file_.write(buffer, (qint64)nchars);
+            break;
+        }
         // The QString docs say that invalid characters will be replaced with
         // replacement characters or removed. It would be nice if we could
         // explicitly choose one or the other.
@@ -1267,52 +1332,152 @@ void FollowStreamDialog::captureFileClosing()
  * This might or might not be the reason why C arrays display
  * correctly but get extra blank lines very other line when printed.
  */
+const guint32 FollowStreamDialog::page_bytes_ = 256 * 1024; // Well under max_document_length_ as a hex dump
+
+// Read the chunk headers in the temporary file, skipping the data, to
+// find where each page of the stream starts and to count the packets
+// and turns in the whole stream.
+bool
+FollowStreamDialog::indexTcpStream()
+{
+    QFile               data_out_fp(data_out_filename_);
+    tcp_stream_chunk    sc;
+    qint64              nchars;
+    int                 iplen;
+    gboolean            is_server;
+    guint32             page_len = 0;
+    stream_page_t       state;
+
+    iplen = (follow_info_.is_ipv6) ? 16 : 4;
+
+    stream_pages_.clear();
+    cur_page_ = 0;
+    client_addr_.clear();
+    client_port_ = 0;
+    total_client_packets_ = 0;
+    total_server_packets_ = 0;
+    total_turns_ = 0;
+    memset(&state, 0, sizeof(state));
+
+    if (!data_out_fp.open(QIODevice::ReadOnly)) {
+        QMessageBox::critical(this, "Error",
+                      QString(tr("Could not open temporary file %1: %2"))
+                      .arg(data_out_filename_)
+                      .arg(data_out_fp.errorString()));
+        return false;
+    }
+
+    stream_pages_.append(state);
+    while ((nchars = data_out_fp.read((char *)&sc, sizeof(sc))) > 0) {
+        if (nchars != (qint64)sizeof(sc)) {
+            break;
+        }
+        if (client_addr_.isEmpty()) {
+            client_addr_ = QByteArray((const char *)sc.src_addr, iplen);
+            client_port_ = sc.src_port;
+        }
+        is_server = !(memcmp(client_addr_.constData(), sc.src_addr, iplen) == 0 &&
+                      client_port_ == sc.src_port);
+
+        if (page_len > 0 && page_len + sc.dlen > page_bytes_) {
+            state.offset = data_out_fp.pos() - sizeof(sc);
+            stream_pages_.append(state);
+            page_len = 0;
+        }
+        page_len += sc.dlen;
+
+        // What showBuffer() would do with the chunk.
+        if (sc.dlen > 0) {
+            if (is_server) {
+                state.server_pos += sc.dlen;
+                state.server_buffers += (sc.dlen + FLT_BUF_SIZE - 1) / FLT_BUF_SIZE;
+                if (sc.packet_num != state.last_packet) state.server_yaml++;
+            } else {
+                state.client_pos += sc.dlen;
+                state.client_buffers += (sc.dlen + FLT_BUF_SIZE - 1) / FLT_BUF_SIZE;
+                if (sc.packet_num != state.last_packet) state.client_yaml++;
+            }
+            if (state.last_packet == 0) {
+                state.last_from_server = is_server;
+            }
+            if (sc.packet_num != state.last_packet) {
+                state.last_packet = sc.packet_num;
+                if (is_server) {
+                    total_server_packets_++;
+                } else {
+                    total_client_packets_++;
+                }
+                if (state.last_from_server != is_server) {
+                    state.last_from_server = is_server;
+                    total_turns_++;
+                }
+            }
+        }
+
+        if (!data_out_fp.seek(data_out_fp.pos() + sc.dlen)) {
+            break;
+        }
+    }
+
+    data_out_fp.close();
+    updatePageButtons();
+    return true;
+}
+
+/*
+ * Show, or save, the chunks of the stream from the one that starts
+ * at start.offset in the temporary file up to the one at end, or to
+ * the end of the file if end is -1.
+ */
 frs_return_t
-FollowStreamDialog::readTcpStream()
+FollowStreamDialog::readTcpStream(const stream_page_t &start, qint64 end)
 {
-    FILE *data_out_fp;
+    QFile               data_out_fp(data_out_filename_);
     tcp_stream_chunk    sc;
     size_t              bcount;
     size_t              bytes_read;
     int                 iplen;
-    guint8              client_addr[MAX_IPADDR_LEN];
-    guint16             client_port = 0;
     gboolean            is_server;
-    guint32             global_client_pos = 0, global_server_pos = 0;
+    guint32             global_client_pos = start.client_pos, global_server_pos = start.server_pos;
     guint32             *global_pos;
     gboolean            skip;
     char                buffer[FLT_BUF_SIZE+1]; /* +1 to fix ws bug 1043 */
-    size_t              nchars;
+    qint64              nchars;
     frs_return_t        frs_return;
 
     iplen = (follow_info_.is_ipv6) ? 16 : 4;
 
-    data_out_fp = ws_fopen(data_out_filename_.toUtf8().constData(), "rb");
-    if (data_out_fp == NULL) {
+    if (follow_info_.show_type == SHOW_YAML) {
+        client_buffer_count_ = start.client_yaml;
+        server_buffer_count_ = start.server_yaml;
+    } else {
+        client_buffer_count_ = start.client_buffers;
+        server_buffer_count_ = start.server_buffers;
+    }
+    last_packet_ = start.last_packet;
+    last_from_server_ = start.last_from_server;
+
+    if (!data_out_fp.open(QIODevice::ReadOnly) || !data_out_fp.seek(start.offset)) {
         QMessageBox::critical(this, "Error",
-                      "Could not open temporary file %1: %2", data_out_filename_,
-                      g_strerror(errno));
+                      QString(tr("Could not open temporary file %1: %2"))
+                      .arg(data_out_filename_)
+                      .arg(data_out_fp.errorString()));
         return FRS_OPEN_ERROR;
     }
 
-    while ((nchars=fread(&sc, 1, sizeof(sc), data_out_fp))) {
-        if (nchars != sizeof(sc)) {
+    while ((end < 0 || data_out_fp.pos() < end) &&
+           (nchars = data_out_fp.read((char *)&sc, sizeof(sc))) > 0) {
+        if (nchars != (qint64)sizeof(sc)) {
             QMessageBox::critical(this, "Error",
                           QString(tr("Short read from temporary file %1: expected %2, got %3"))
                           .arg(data_out_filename_)
                           .arg(sizeof(sc))
                           .arg(nchars));
-            fclose(data_out_fp);
-            data_out_fp = NULL;
             return FRS_READ_ERROR;
         }
-        if (client_port == 0) {
-            memcpy(client_addr, sc.src_addr, iplen);
-            client_port = sc.src_port;
-        }
         skip = FALSE;
-        if (memcmp(client_addr, sc.src_addr, iplen) == 0 &&
-                client_port == sc.src_port) {
+        if (memcmp(client_addr_.constData(), sc.src_addr, iplen) == 0 &&
+                client_port_ == sc.src_port) {
             is_server = FALSE;
             global_pos = &global_client_pos;
             if (follow_info_.show_stream == FROM_SERVER) {
@@ -1326,39 +1491,35 @@ FollowStreamDialog::readTcpStream()
             }
         }
 
+        if (skip) {
+            if (!data_out_fp.seek(data_out_fp.pos() + sc.dlen))
+                break;
+            continue;
+        }
+
         bytes_read = 0;
         while (bytes_read < sc.dlen) {
             bcount = ((sc.dlen-bytes_read) < FLT_BUF_SIZE) ? (sc.dlen-bytes_read) : FLT_BUF_SIZE;
-            nchars = fread(buffer, 1, bcount, data_out_fp);
-            if (nchars == 0)
+            nchars = data_out_fp.read(buffer, (qint64)bcount);
+            if (nchars <= 0)
                 break;
             /* XXX - if we don't get "bcount" bytes, is that an error? */
-            bytes_read += nchars;
-
-            if (!skip)
-            {
-                frs_return = showBuffer(buffer,
-                                         nchars, is_server, sc.packet_num, global_pos);
-                if(frs_return == FRS_PRINT_ERROR) {
-                    fclose(data_out_fp);
-                    data_out_fp = NULL;
-                    return frs_return;
-                }
+            bytes_read += (size_t)nchars;
 
+            frs_return = showBuffer(buffer,
+                                     (size_t)nchars, is_server, sc.packet_num, global_pos);
+            if(frs_return == FRS_PRINT_ERROR) {
+                return frs_return;
             }
         }
     }
 
-    if (ferror(data_out_fp)) {
+    if (data_out_fp.error() != QFile::NoError) {
         QMessageBox::critical(this, tr("Error reading temporary file"),
-                           QString("%1: %2").arg(data_out_filename_).arg(g_strerror(errno)));
-        fclose(data_out_fp);
-        data_out_fp = NULL;
+                           QString("%1: %2").arg(data_out_filename_).arg(data_out_fp.errorString()));
         return FRS_READ_ERROR;
     }
 
-    fclose(data_out_fp);
-    data_out_fp = NULL;
     return FRS_OK;
 }
 
@@ -38,9 +38,11 @@
 
 #include "wireshark_dialog.h"
 
+#include <QByteArray>
 #include <QFile>
 #include <QMap>
 #include <QPushButton>
+#include <QVector>
 
 extern "C" {
 WS_DLL_PUBLIC FILE *data_out_file;
@@ -91,6 +93,8 @@ private slots:
     void printStream();
     void fillHintLabel(int text_pos);
     void goToPacketForTextPos(int text_pos);
+    void previousPage();
+    void nextPage();
 
     void on_streamNumberSpinBox_valueChanged(int stream_num);
 
@@ -101,6 +105,21 @@ signals:
     void goToPacket(int packet_num);
 
 private:
+    // Where a page of a TCP stream starts in the temporary file, and what
+    // showBuffer() needs to carry on from there as if it had shown the
+    // stream up to that point.
+    typedef struct {
+        qint64      offset;
+        guint32     client_pos;
+        guint32     server_pos;
+        int         client_buffers;     // C arrays
+        int         server_buffers;
+        int         client_yaml;        // YAML
+        int         server_yaml;
+        guint32     last_packet;
+        gboolean    last_from_server;
+    } stream_page_t;
+
     void removeStreamControls();
     void resetStream(void);
     void updateWidgets(bool follow_in_progress);
@@ -110,7 +129,9 @@ private:
                 guint32 packet_num, guint32 *global_pos);
 
     frs_return_t readStream();
-    frs_return_t readTcpStream();
+    bool indexTcpStream();
+    frs_return_t readTcpStream(const stream_page_t &start, qint64 end);
+    void updatePageButtons();
     frs_return_t readUdpStream();
     frs_return_t readSslStream();
 
@@ -123,6 +144,8 @@ private:
     QPushButton             *b_find_;
     QPushButton             *b_print_;
     QPushButton             *b_save_;
+    QPushButton             *b_prev_page_;
+    QPushButton             *b_next_page_;
 
     follow_type_t           follow_type_;
     follow_info_t           follow_info_;
@@ -139,6 +162,17 @@ private:
     int                     turns_;
     QMap<int,guint32>       text_pos_to_packet_;
 
+    // A TCP stream is shown a page at a time, so that only that much of
+    // it is ever held in memory however big the stream is.
+    static const guint32    page_bytes_;
+    QVector<stream_page_t>  stream_pages_;
+    int                     cur_page_;
+    QByteArray              client_addr_;
+    guint16                 client_port_;
+    int                     total_client_packets_;
+    int                     total_server_packets_;
+    int                     total_turns_;
+
     bool                    save_as_;
     QFile                   file_;
 };
@@ -946,6 +946,14 @@ void IOGraphDialog::updateStatistics()
 
     if (need_retap_ && !file_closed_) {
         need_retap_ = false;
+        int interval = ui->intervalComboBox->itemData(ui->intervalComboBox->currentIndex()).toInt();
+        int tap_interval = tapInterval(interval);
+        for (int i = 0; i < ui->graphTreeWidget->topLevelItemCount(); i++) {
+            IOGraph *iog = ui->graphTreeWidget->topLevelItem(i)->data(name_col_, Qt::UserRole).value<IOGraph *>();
+            if (iog) {
+                iog->setTapInterval(tap_interval);
+            }
+        }
         cap_file_.retapPackets();
         ui->ioPlot->setFocus();
     } else {
@@ -972,6 +980,30 @@ void IOGraphDialog::updateStatistics()
     }
 }
 
+// The interval to tap packets at when the given interval is shown: the
+// finest one in the interval list that divides it and still leaves room
+// for the whole capture, so that the interval can later be made coarser by
+// merging intervals instead of retapping. The interval shown is used as is
+// while the capture is still being read, as it may keep growing.
+int IOGraphDialog::tapInterval(int interval)
+{
+    capture_file *cf = cap_file_.capFile();
+
+    if (!cf || cf->state != FILE_READ_DONE) {
+        return interval;
+    }
+
+    guint64 elapsed_ms = (guint64) cf->elapsed_time.secs * 1000 + cf->elapsed_time.nsecs / 1000000;
+    for (int i = 0; i < ui->intervalComboBox->count(); i++) {
+        int tap_interval = ui->intervalComboBox->itemData(i).toInt();
+        if (tap_interval > 0 && tap_interval <= interval && interval % tap_interval == 0 &&
+                elapsed_ms / tap_interval < (guint64) max_io_items_ / 2) {
+            return tap_interval;
+        }
+    }
+    return interval;
+}
+
 // We're done editing a treewidgetitem. Set its values based on its
 // widgets, remove each widget, then sync with our associated graph.
 void IOGraphDialog::itemEditingFinished(QTreeWidgetItem *item)
@@ -1118,14 +1150,15 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int index)
     int interval = ui->intervalComboBox->itemData(ui->intervalComboBox->currentIndex()).toInt();
     bool need_retap = false;
 
+    // Graphs that were tapped at a finer interval that divides this one can
+    // just merge their intervals.
     for (int i = 0; i < ui->graphTreeWidget->topLevelItemCount(); i++) {
         QTreeWidgetItem *item = ui->graphTreeWidget->topLevelItem(i);
         IOGraph *iog = NULL;
         if (item) {
             iog = item->data(name_col_, Qt::UserRole).value<IOGraph *>();
             if (iog) {
-                iog->setInterval(interval);
-                if (iog->visible()) {
+                if (iog->setInterval(interval) && iog->visible()) {
                     need_retap = true;
                 }
             }
@@ -1134,6 +1167,8 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int index)
 
     if (need_retap) {
         scheduleRetap(true);
+    } else {
+        scheduleRecalc(true);
     }
 }
 
@@ -1509,9 +1544,13 @@ IOGraph::IOGraph(QCustomPlot *parent) :
     graph_(NULL),
     bars_(NULL),
     hf_index_(-1),
-    cur_idx_(-1)
+    interval_(1000),
+    cur_idx_(-1),
+    tap_interval_(1000),
+    view_idx_(-1)
 {
     Q_ASSERT(parent_ != NULL);
+    pyramid_ = io_graph_pyramid_new(tap_interval_);
     graph_ = parent_->addGraph(parent_->xAxis, parent_->yAxis);
     Q_ASSERT(graph_ != NULL);
 
@@ -1534,6 +1573,7 @@ IOGraph::IOGraph(QCustomPlot *parent) :
 
 IOGraph::~IOGraph() {
     remove_tap_listener(this);
+    io_graph_pyramid_free(pyramid_);
     if (graph_) {
         parent_->removeGraph(graph_);
     }
@@ -1590,9 +1630,12 @@ void IOGraph::setFilter(const QString &filter)
         g_string_free(error_string, TRUE);
         return;
     } else {
-        if (filter_.compare(filter) && visible_) {
+        // The Y field is part of the tap filter, so this also catches a
+        // change of field.
+        if (tap_filter_.compare(full_filter) && visible_) {
             emit requestRetap();
         }
+        tap_filter_ = full_filter;
         filter_ = filter;
     }
 }
@@ -1724,7 +1767,12 @@ void IOGraph::setValueUnits(int val_units)
 
         if (old_val_units != val_units) {
             setFilter(filter_); // Check config & prime vu field
-            if (val_units < IOG_ITEM_UNIT_CALC_SUM) {
+            // Every statistic of the Y field is kept for each interval, so
+            // switching between them only needs a recalculation, except
+            // that LOAD adds up relative times differently.
+            if (visible_ && (old_val_units == IOG_ITEM_UNIT_CALC_LOAD || val_units == IOG_ITEM_UNIT_CALC_LOAD)) {
+                emit requestRetap();
+            } else {
                 emit requestRecalc();
             }
         }
@@ -1773,8 +1821,10 @@ double IOGraph::startOffset()
 int IOGraph::packetFromTime(double ts)
 {
     int idx = ts * 1000 / interval_;
-    if (idx >= 0 && idx < (int) cur_idx_) {
-        return items_[idx].last_frame_in_invl;
+    if (idx >= 0 && idx < view_idx_) {
+        io_graph_item_t item;
+        io_graph_pyramid_get_item(pyramid_, interval_, idx, &item);
+        return item.last_frame_in_invl;
     }
     return -1;
 }
@@ -1782,7 +1832,8 @@ int IOGraph::packetFromTime(double ts)
 void IOGraph::clearAllData()
 {
     cur_idx_ = -1;
-    reset_io_graph_items(items_, max_io_items_);
+    io_graph_pyramid_reset(pyramid_, tap_interval_);
+    view_idx_ = -1;
     if (graph_) {
         graph_->clearData();
     }
@@ -1856,7 +1907,15 @@ void IOGraph::recalcGraphData(capture_file *cap_file)
         x_axis = bars_->keyAxis();
     }
 
-    if (moving_avg_period_ > 0 && cur_idx_ >= 0) {
+    // Items can only be made for multiples of the tap interval; until the
+    // next retap, show nothing.
+    int base_interval = (int) pyramid_->base_interval;
+    view_idx_ = -1;
+    if (interval_ >= base_interval && interval_ % base_interval == 0) {
+        view_idx_ = io_graph_pyramid_num_items(pyramid_, interval_) - 1;
+    }
+
+    if (moving_avg_period_ > 0 && view_idx_ >= 0) {
         /* "Warm-up phase" - calculate average on some data not displayed;
          * just to make sure average on leftmost and rightmost displayed
          * values is as reliable as possible
@@ -1872,7 +1931,7 @@ void IOGraph::recalcGraphData(capture_file *cap_file)
         mavg_in_average_count++;
         for (warmup_interval = interval_;
             ((warmup_interval < (0 + (moving_avg_period_ / 2) * (guint64)interval_)) &&
-             (warmup_interval <= (cur_idx_ * (guint64)interval_)));
+             (warmup_interval <= (view_idx_ * (guint64)interval_)));
              warmup_interval += interval_) {
 
             mavg_cumulated += getItemValue((int)warmup_interval / interval_, cap_file);
@@ -1882,7 +1941,7 @@ void IOGraph::recalcGraphData(capture_file *cap_file)
         mavg_to_add = warmup_interval;
     }
 
-    for (int i = 0; i < cur_idx_; i++) {
+    for (int i = 0; i < view_idx_; i++) {
         double ts = (double) i * interval_ / 1000;
         if (x_axis && x_axis->tickLabelType() == QCPAxis::ltDateTime) {
             ts += start_time_;
@@ -1898,7 +1957,7 @@ void IOGraph::recalcGraphData(capture_file *cap_file)
                     mavg_cumulated -= getItemValue((int)mavg_to_remove / interval_, cap_file);
                     mavg_to_remove += interval_;
                 }
-                if (mavg_to_add <= (unsigned int) cur_idx_ * interval_) {
+                if (mavg_to_add <= (unsigned int) view_idx_ * interval_) {
                     mavg_in_average_count++;
                     mavg_cumulated += getItemValue((int)mavg_to_add / interval_, cap_file);
                     mavg_to_add += interval_;
@@ -1923,9 +1982,22 @@ void IOGraph::recalcGraphData(capture_file *cap_file)
     emit requestReplot();
 }
 
-void IOGraph::setInterval(int interval)
+// Set the interval shown. Returns true if the packets have to be tapped
+// again to show it, that is if it isn't a multiple of the interval they
+// were last tapped at.
+bool IOGraph::setInterval(int interval)
 {
+    int base_interval = (int) pyramid_->base_interval;
+
     interval_ = interval;
+    return interval_ < base_interval || interval_ % base_interval != 0;
+}
+
+// Set the interval to collect data for on the next retap. This must divide
+// the interval shown.
+void IOGraph::setTapInterval(int tap_interval)
+{
+    tap_interval_ = tap_interval;
 }
 
 // Get the value at the given interval (idx) for the current value unit.
@@ -1934,12 +2006,11 @@ double IOGraph::getItemValue(int idx, capture_file *cap_file)
 {
     double     value = 0;          /* FIXME: loss of precision, visible on the graph for small values */
     int        adv_type;
-    io_graph_item_t *item;
+    io_graph_item_t item_buf;
+    io_graph_item_t *item = &item_buf;
     guint32    interval;
 
-    g_assert(idx < max_io_items_);
-
-    item = &items_[idx];
+    io_graph_pyramid_get_item(pyramid_, interval_, idx, item);
 
     // Basic units
     switch (val_units_) {
@@ -2064,7 +2135,7 @@ double IOGraph::getItemValue(int idx, capture_file *cap_file)
             }
             break;
         case IOG_ITEM_UNIT_CALC_LOAD:
-            if (idx == (int)cur_idx_ && cap_file) {
+            if (idx == view_idx_ && cap_file) {
                 interval = (guint32)((cap_file->elapsed_time.secs*1000) +
                        ((cap_file->elapsed_time.nsecs+500000)/1000000));
                 interval -= (interval_ * idx);
@@ -2102,7 +2173,7 @@ gboolean IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dissect_t *e
         return FALSE;
     }
 
-    int idx = get_io_graph_index(pinfo, iog->interval_);
+    int idx = get_io_graph_index(pinfo, iog->tap_interval_);
     bool recalc = false;
 
     /* some sanity checks */
@@ -2131,7 +2202,7 @@ gboolean IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dissect_t *e
         adv_edt = edt;
     }
 
-    if (!update_io_graph_item(iog->items_, idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->interval_)) {
+    if (!io_graph_pyramid_update(iog->pyramid_, idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_)) {
         return FALSE;
     }
 
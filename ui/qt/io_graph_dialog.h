@@ -45,7 +45,8 @@
 #include <QTreeWidgetItem>
 #include "qcustomplot.h"
 
-// GTK+ sets this to 100000 (NUM_IO_ITEMS)
+// GTK+ sets this to 100000 (NUM_IO_ITEMS). This is the most intervals of
+// the tap interval a graph collects.
 const int max_io_items_ = 250000;
 
 // XXX - Move to its own file?
@@ -73,7 +74,8 @@ public:
     const QString valueUnitField() { return vu_field_; }
     void setValueUnitField(const QString &vu_field);
     unsigned int movingAveragePeriod() { return moving_avg_period_; }
-    void setInterval(int interval);
+    bool setInterval(int interval);
+    void setTapInterval(int tap_interval);
     bool addToLegend();
     QCPGraph *graph() { return graph_; }
     QCPBars *bars() { return bars_; }
@@ -110,6 +112,7 @@ private:
     QCPGraph *graph_;
     QCPBars *bars_;
     QString filter_;
+    QString tap_filter_;
     QBrush color_;
     io_graph_item_unit_t val_units_;
     QString vu_field_;
@@ -118,9 +121,12 @@ private:
     double start_time_;
 
     // Cached data. We should be able to change the Y axis without retapping as
-    // much as is feasible.
-    io_graph_item_t items_[max_io_items_];
+    // much as is feasible. The pyramid's finest items are for intervals of
+    // tap_interval_, which may be finer than interval_.
+    io_graph_pyramid_t *pyramid_;
     int cur_idx_;
+    int tap_interval_;
+    int view_idx_;
 };
 
 namespace Ui {
@@ -190,6 +196,7 @@ private:
     QRectF getZoomRanges(QRect zoom_rect);
     void itemEditingFinished(QTreeWidgetItem *item);
     void loadProfileGraphs();
+    int tapInterval(int interval);
 
 private slots:
     void updateWidgets();
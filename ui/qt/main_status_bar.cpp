@@ -216,6 +216,15 @@ void MainStatusBar::expertUpdate() {
         break;
     }
 
+    if (expert_get_highest_severity() > PI_COMMENT) {
+        // Counted as the packets were read, so this costs nothing.
+        tt_text.append(tr(": %1 errors, %2 warnings, %3 notes, %4 chats")
+                       .arg(expert_get_severity_count(PI_ERROR))
+                       .arg(expert_get_severity_count(PI_WARN))
+                       .arg(expert_get_severity_count(PI_NOTE))
+                       .arg(expert_get_severity_count(PI_CHAT)));
+    }
+
     img_text.append(".png\"></img>");
     expert_status_.setText(img_text);
     expert_status_.setToolTip(tt_text);
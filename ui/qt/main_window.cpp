@@ -328,6 +328,10 @@ MainWindow::MainWindow(QWidget *parent) :
             this, SLOT(recreatePacketList()));
     connect(wsApp, SIGNAL(packetDissectionChanged()),
             this, SLOT(redissectPackets()));
+    connect(wsApp, SIGNAL(packetFilterChanged()),
+            this, SLOT(refilterPackets()));
+    connect(wsApp, SIGNAL(packetDisplayChanged()),
+            packet_list_, SLOT(redrawVisiblePackets()));
     connect(wsApp, SIGNAL(appInitialized()),
             this, SLOT(filterExpressionsChanged()));
     connect(wsApp, SIGNAL(filterExpressionsChanged()),
@@ -401,6 +405,8 @@ MainWindow::MainWindow(QWidget *parent) :
 
     connect(&file_set_dialog_, SIGNAL(fileSetOpenCaptureFile(QString&)),
             this, SLOT(openCaptureFile(QString&)));
+    connect(&file_set_dialog_, SIGNAL(fileSetOpenCaptureFileSet(QStringList&)),
+            this, SLOT(openCaptureFileSet(QStringList&)));
 
 #ifdef HAVE_LIBPCAP
     QTreeWidget *iface_tree = findChild<QTreeWidget *>("interfaceTree");
@@ -183,6 +183,7 @@ signals:
 public slots:
     // in main_window_slots.cpp
     void openCaptureFile(QString& cf_path = *new QString(), QString& display_filter = *new QString(), unsigned int type = WTAP_TYPE_AUTO);
+    void openCaptureFileSet(QStringList& cf_paths);
     void filterPackets(QString& new_filter = *new QString(), bool force = false);
     void updateForUnsavedChanges();
     void layoutPanes();
@@ -223,6 +224,7 @@ private slots:
     void interfaceSelectionChanged();
     void captureFilterSyntaxChanged(bool valid);
     void redissectPackets();
+    void refilterPackets();
     void recreatePacketList();
     void fieldsChanged();
     void showColumnEditor(int column);
@@ -375,6 +377,8 @@ private slots:
     void on_actionCaptureStop_triggered();
 
     void on_actionStatisticsCaptureFileProperties_triggered();
+    void on_actionStatisticsReassemblyTables_triggered();
+    void on_actionStatisticsDissectorTiming_triggered();
     void on_actionStatisticsFlowGraph_triggered();
     void openTcpStreamDialog(int graph_type);
     void on_actionStatisticsTcpStreamStevens_triggered();
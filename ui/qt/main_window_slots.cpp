@@ -75,6 +75,7 @@
 #include "capture_file_properties_dialog.h"
 #include "conversation_dialog.h"
 #include "decode_as_dialog.h"
+#include "dissector_timing_dialog.h"
 #include "endpoint_dialog.h"
 #include "export_object_dialog.h"
 #include "export_pdu_dialog.h"
@@ -88,6 +89,7 @@
 #include "print_dialog.h"
 #include "profile_dialog.h"
 #include "qt_ui_utils.h"
+#include "reassembly_statistics_dialog.h"
 #include "sctp_all_assocs_dialog.h"
 #include "sctp_assoc_analyse_dialog.h"
 #include "sctp_graph_dialog.h"
@@ -102,6 +104,7 @@
 #include <QMessageBox>
 #include <QMetaObject>
 #include <QToolBar>
+#include <QVector>
 
 #include <QDebug>
 
@@ -216,6 +219,43 @@ void MainWindow::openCaptureFile(QString& cf_path, QString& read_filter, unsigne
     main_ui_->statusBar->showExpert();
 }
 
+// Open the files of a file set as one capture, rather than merging them.
+void MainWindow::openCaptureFileSet(QStringList& cf_paths)
+{
+    QList<QByteArray> utf8_paths;
+    QVector<const char *> paths;
+    int err;
+
+    if (cf_paths.isEmpty())
+        return;
+
+    testCaptureFileClose(false);
+
+    for (int i = 0; i < cf_paths.size(); i++)
+        utf8_paths << cf_paths.at(i).toUtf8();
+    for (int i = 0; i < utf8_paths.size(); i++)
+        paths << utf8_paths.at(i).constData();
+
+    CaptureFile::globalCapFile()->window = this;
+    if (cf_open_set(CaptureFile::globalCapFile(), paths.size(), paths.constData(), WTAP_TYPE_AUTO, &err) != CF_OK) {
+        CaptureFile::globalCapFile()->window = NULL;
+        return;
+    }
+
+    switch (cf_read(CaptureFile::globalCapFile(), FALSE)) {
+
+    case CF_READ_OK:
+    case CF_READ_ERROR:
+        break;
+
+    case CF_READ_ABORTED:
+        capture_file_.setCapFile(NULL);
+        return;
+    }
+
+    main_ui_->statusBar->showExpert();
+}
+
 void MainWindow::filterPackets(QString& new_filter, bool force)
 {
     cf_status_t cf_status;
@@ -1235,6 +1275,20 @@ void MainWindow::redissectPackets()
     main_ui_->statusBar->expertUpdate();
 }
 
+// Run the display filter again without throwing away what's been dissected.
+void MainWindow::refilterPackets()
+{
+    capture_file *cf = capture_file_.capFile();
+
+    if (!cf || cf->state == FILE_CLOSED) return;
+
+    if (cf->dfilter) {
+        cf_filter_packets(cf, cf->dfilter, TRUE);
+    } else {
+        packet_list_->redrawVisiblePackets();
+    }
+}
+
 void MainWindow::recreatePacketList()
 {
     prefs.num_cols = g_list_length(prefs.col_list);
@@ -2685,6 +2739,18 @@ void MainWindow::on_actionStatisticsCaptureFileProperties_triggered()
     capture_file_properties_dialog->show();
 }
 
+void MainWindow::on_actionStatisticsReassemblyTables_triggered()
+{
+    ReassemblyStatisticsDialog *reassembly_statistics_dialog = new ReassemblyStatisticsDialog(*this, capture_file_);
+    reassembly_statistics_dialog->show();
+}
+
+void MainWindow::on_actionStatisticsDissectorTiming_triggered()
+{
+    DissectorTimingDialog *dissector_timing_dialog = new DissectorTimingDialog(*this, capture_file_);
+    dissector_timing_dialog->show();
+}
+
 #ifdef HAVE_LIBPCAP
 void MainWindow::on_actionCaptureOptions_triggered()
 {
@@ -70,6 +70,7 @@
 static PacketList *gbl_cur_packet_list = NULL;
 
 const int max_comments_to_fetch_ = 20000000; // Arbitrary
+const int live_update_interval_ = 100; // ms; a few screen refreshes
 
 guint
 packet_list_append(column_info *cinfo, frame_data *fdata)
@@ -111,6 +112,7 @@ packet_list_select_first_row(void)
 {
     if (!gbl_cur_packet_list)
         return;
+    gbl_cur_packet_list->flushLiveUpdate();
     gbl_cur_packet_list->goFirstPacket();
     gbl_cur_packet_list->setFocus();
 }
@@ -132,6 +134,7 @@ packet_list_select_last_row(void)
 gboolean
 packet_list_select_row_from_data(frame_data *fdata_needle)
 {
+    gbl_cur_packet_list->flushLiveUpdate();
     int row = gbl_cur_packet_list->packetListModel()->visibleIndexOf(fdata_needle);
     if (row >= 0) {
         gbl_cur_packet_list->setCurrentIndex(gbl_cur_packet_list->packetListModel()->index(row,0));
@@ -189,6 +192,74 @@ packet_list_thaw(void)
     packets_bar_update();
 }
 
+gboolean
+packet_list_begin_progressive_load(void)
+{
+    if (!gbl_cur_packet_list || !gbl_cur_packet_list->packetListModel()) {
+        return FALSE;
+    }
+
+    gbl_cur_packet_list->packetListModel()->setAppendDeferred(true);
+    return TRUE;
+}
+
+void
+packet_list_update_progressive_load(void)
+{
+    if (gbl_cur_packet_list && gbl_cur_packet_list->packetListModel()) {
+        gbl_cur_packet_list->packetListModel()->flushAppendedRows();
+    }
+
+    packets_bar_update();
+}
+
+void
+packet_list_end_progressive_load(void)
+{
+    if (gbl_cur_packet_list && gbl_cur_packet_list->packetListModel()) {
+        gbl_cur_packet_list->packetListModel()->setAppendDeferred(false);
+    }
+
+    packets_bar_update();
+}
+
+void
+packet_list_begin_live_update(void)
+{
+    if (gbl_cur_packet_list) {
+        gbl_cur_packet_list->beginLiveUpdate();
+    }
+}
+
+void
+packet_list_end_live_update(gboolean scroll_to_end)
+{
+    if (gbl_cur_packet_list) {
+        gbl_cur_packet_list->endLiveUpdate(scroll_to_end);
+    }
+}
+
+gboolean
+packet_list_begin_progressive_filter(void)
+{
+    if (!gbl_cur_packet_list || !gbl_cur_packet_list->packetListModel()) {
+        return FALSE;
+    }
+
+    gbl_cur_packet_list->packetListModel()->beginRefilter();
+    return TRUE;
+}
+
+void
+packet_list_update_progressive_filter(guint32 framenum)
+{
+    if (gbl_cur_packet_list && gbl_cur_packet_list->packetListModel()) {
+        gbl_cur_packet_list->packetListModel()->refilterUpTo(framenum);
+    }
+
+    packets_bar_update();
+}
+
 void
 packet_list_recreate_visible_rows(void)
 {
@@ -239,7 +310,11 @@ PacketList::PacketList(QWidget *parent) :
     byte_view_tab_(NULL),
     cap_file_(NULL),
     decode_as_(NULL),
-    ctx_column_(-1)
+    ctx_column_(-1),
+    prefetch_row_(0),
+    prefetch_end_(0),
+    prefetch_last_top_(0),
+    live_scroll_pending_(false)
 {
     QMenu *submenu, *subsubmenu;
     QAction *action;
@@ -424,6 +499,15 @@ PacketList::PacketList(QWidget *parent) :
     header()->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(header(), SIGNAL(customContextMenuRequested(QPoint)),
                 SLOT(showHeaderMenu(QPoint)));
+
+    // A zero timeout fires only once there are no other events to handle.
+    prefetch_timer_.setInterval(0);
+    connect(&prefetch_timer_, SIGNAL(timeout()), this, SLOT(prefetchRows()));
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(schedulePrefetch()));
+
+    live_update_timer_.setSingleShot(true);
+    live_update_timer_.setInterval(live_update_interval_);
+    connect(&live_update_timer_, SIGNAL(timeout()), this, SLOT(liveUpdateTimeout()));
 }
 
 void PacketList::setProtoTree (ProtoTree *proto_tree) {
@@ -622,6 +706,53 @@ void PacketList::initHeaderContextMenu()
 }
 
 // Redraw the packet list and detail
+// Queue up the page of rows past the viewport in the direction we're
+// scrolling.
+void PacketList::schedulePrefetch()
+{
+    if (!cap_file_ || model() != packet_list_model_) return;
+
+    QModelIndex top = indexAt(viewport()->rect().topLeft());
+    QModelIndex bottom = indexAt(viewport()->rect().bottomLeft());
+    if (!top.isValid()) return;
+
+    int top_row = top.row();
+    int bottom_row = bottom.isValid() ? bottom.row() : packet_list_model_->rowCount() - 1;
+    int page = bottom_row - top_row + 1;
+
+    if (top_row >= prefetch_last_top_) {
+        prefetch_row_ = bottom_row + 1;
+        prefetch_end_ = qMin(bottom_row + page, packet_list_model_->rowCount() - 1);
+    } else {
+        prefetch_row_ = qMax(top_row - page, 0);
+        prefetch_end_ = top_row - 1;
+    }
+    prefetch_last_top_ = top_row;
+
+    if (prefetch_row_ <= prefetch_end_ && !prefetch_timer_.isActive()) {
+        prefetch_timer_.start();
+    }
+}
+
+void PacketList::prefetchRows()
+{
+    // Do a few rows at a time so that we never hold up user input.
+    const int rows_per_slice = 8;
+
+    if (!cap_file_ || cap_file_->state == FILE_CLOSED || model() != packet_list_model_) {
+        prefetch_timer_.stop();
+        return;
+    }
+
+    for (int i = 0; i < rows_per_slice && prefetch_row_ <= prefetch_end_; i++, prefetch_row_++) {
+        packet_list_model_->prefetchRow(prefetch_row_);
+    }
+
+    if (prefetch_row_ > prefetch_end_) {
+        prefetch_timer_.stop();
+    }
+}
+
 void PacketList::redrawVisiblePackets() {
     if (!cap_file_) return;
 
@@ -660,9 +791,46 @@ void PacketList::thaw()
     }
 }
 
+void PacketList::beginLiveUpdate()
+{
+    packet_list_model_->setAppendDeferred(true);
+}
+
+void PacketList::endLiveUpdate(bool scroll_to_end)
+{
+    // Stop deferring without flushing, so that anything else appending
+    // rows gets them shown straight away, after those held back here.
+    packet_list_model_->setAppendDeferred(false, false);
+    if (scroll_to_end) {
+        live_scroll_pending_ = true;
+    }
+    if ((packet_list_model_->hasAppendedRows() || live_scroll_pending_) &&
+            !live_update_timer_.isActive()) {
+        live_update_timer_.start();
+    }
+}
+
+// Show the rows held back by live updates now.
+void PacketList::flushLiveUpdate()
+{
+    packet_list_model_->flushAppendedRows();
+}
+
+void PacketList::liveUpdateTimeout()
+{
+    packet_list_model_->flushAppendedRows();
+    packets_bar_update();
+    if (live_scroll_pending_) {
+        live_scroll_pending_ = false;
+        goLastPacket();
+    }
+}
+
 void PacketList::clear() {
     //    packet_history_clear();
     related_packet_delegate_.clear();
+    live_update_timer_.stop();
+    live_scroll_pending_ = false;
     packet_list_model_->clear();
     proto_tree_->clear();
     byte_view_tab_->clear();
@@ -28,6 +28,7 @@
 #include "proto_tree.h"
 #include "related_packet_delegate.h"
 
+#include <QTimer>
 #include <QTreeView>
 #include <QTreeWidget>
 #include <QMenu>
@@ -57,6 +58,9 @@ public:
     void freeze();
     void thaw();
     void clear();
+    void beginLiveUpdate();
+    void endLiveUpdate(bool scroll_to_end);
+    void flushLiveUpdate();
     void writeRecent(FILE *rf);
     bool contextMenuActive();
     QString &getFilterFromRowAndColumn();
@@ -86,6 +90,17 @@ private:
     int header_ctx_column_;
     QAction *show_hide_separator_;
     QList<QAction *>show_hide_actions_;
+    // Rows just past the viewport are dissected in the background so
+    // that scrolling finds their column text already cached.
+    QTimer prefetch_timer_;
+    int prefetch_row_;
+    int prefetch_end_;
+    int prefetch_last_top_;
+    // During live capture, appended rows are shown and scrolled to at
+    // most once per live_update_timer_ interval, however many updates
+    // come in, so that a high packet rate doesn't swamp the view.
+    QTimer live_update_timer_;
+    bool live_scroll_pending_;
 
     void markFramesReady();
     void setFrameMark(gboolean set, frame_data *fdata);
@@ -121,6 +136,9 @@ private slots:
     void showHeaderMenu(QPoint pos);
     void headerMenuTriggered();
     void columnVisibilityTriggered();
+    void schedulePrefetch();
+    void prefetchRows();
+    void liveUpdateTimeout();
 };
 
 #endif // PACKET_LIST_H
@@ -34,10 +34,13 @@
 #include "wireshark_application.h"
 #include <QColor>
 #include <QFontMetrics>
+#include <qnumeric.h>
 #include <QModelIndex>
 
 PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
-    QAbstractItemModel(parent)
+    QAbstractItemModel(parent),
+    append_deferred_(false),
+    refilter_pos_(0)
 {
     setCaptureFile(cf);
 }
@@ -74,33 +77,78 @@ int PacketListModel::packetNumberToRow(int packet_num) const
     return number_to_row_.value(packet_num, -1);
 }
 
+void PacketListModel::setNumberToRow(guint32 num, int row)
+{
+    int old_size = number_to_row_.size();
+
+    if ((int) num >= old_size) {
+        // Grow geometrically so that appending stays cheap.
+        if ((int) num >= number_to_row_.capacity()) {
+            number_to_row_.reserve(qMax((int) num + 1, old_size * 2));
+        }
+        number_to_row_.resize(num + 1);
+        for (int i = old_size; i < (int) num; i++) {
+            number_to_row_[i] = -1;
+        }
+    }
+    number_to_row_[num] = row;
+}
+
 guint PacketListModel::recreateVisibleRows()
 {
-    int pos = visible_rows_.count();
     PacketListRecord *record;
 
     beginResetModel();
     visible_rows_.clear();
-    number_to_row_.clear();
+    appended_rows_.clear();
     if (cap_file_) {
         PacketListRecord::resetColumns(&cap_file_->cinfo);
     }
-    endResetModel();
-    beginInsertRows(QModelIndex(), pos, pos);
+    // Frames are numbered from 1 and physical_rows_ holds them in order.
+    number_to_row_.fill(-1, physical_rows_.count() + 1);
+    visible_rows_.reserve(physical_rows_.count());
     foreach (record, physical_rows_) {
         if (record->frameData()->flags.passed_dfilter || record->frameData()->flags.ref_time) {
+            number_to_row_[record->frameData()->num] = visible_rows_.count();
             visible_rows_ << record;
-            number_to_row_[record->frameData()->num] = visible_rows_.count() - 1;
         }
     }
-    endInsertRows();
+    endResetModel();
     return visible_rows_.count();
 }
 
+void PacketListModel::beginRefilter()
+{
+    beginResetModel();
+    visible_rows_.clear();
+    appended_rows_.clear();
+    number_to_row_.fill(-1, physical_rows_.count() + 1);
+    refilter_pos_ = 0;
+    endResetModel();
+}
+
+void PacketListModel::refilterUpTo(guint32 framenum)
+{
+    PacketListRecord *record;
+
+    // Frames are numbered from 1 and physical_rows_ holds them in order.
+    int end = qMin((int) framenum, physical_rows_.count());
+    for (; refilter_pos_ < end; refilter_pos_++) {
+        record = physical_rows_[refilter_pos_];
+        if (record->frameData()->flags.passed_dfilter || record->frameData()->flags.ref_time) {
+            appended_rows_ << record;
+        }
+    }
+    flushAppendedRows();
+}
+
 void PacketListModel::clear() {
     beginResetModel();
+    PacketListRecord::clearColumnCache();
+    sort_key_column_ = -1;
     physical_rows_.clear();
     visible_rows_.clear();
+    appended_rows_.clear();
     number_to_row_.clear();
     endResetModel();
 }
@@ -146,6 +194,13 @@ int PacketListModel::text_sort_column_;
 Qt::SortOrder PacketListModel::sort_order_;
 capture_file *PacketListModel::sort_cap_file_;
 
+int PacketListModel::sort_key_column_ = -1;
+unsigned PacketListModel::sort_key_ver_ = 0;
+bool PacketListModel::sort_key_numeric_ = false;
+QVector<double> PacketListModel::sort_num_keys_;
+QVector<QByteArray> PacketListModel::sort_text_keys_;
+QBitArray PacketListModel::sort_key_valid_;
+
 void PacketListModel::sort(int column, Qt::SortOrder order)
 {
     if (!cap_file_ || visible_rows_.count() < 1) {
@@ -158,7 +213,14 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
     sort_cap_file_ = cap_file_;
 
     beginResetModel();
-    qSort(visible_rows_.begin(), visible_rows_.end(), recordLessThan);
+    if (sort_column_ >= 0 && text_sort_column_ >= 0) {
+        // Pull each record's key out once instead of asking for its column
+        // text in every comparison.
+        updateSortKeys(sort_column_);
+        qSort(visible_rows_.begin(), visible_rows_.end(), sortKeyLessThan);
+    } else {
+        qSort(visible_rows_.begin(), visible_rows_.end(), recordLessThan);
+    }
     for (int i = 0; i < visible_rows_.count(); i++) {
         number_to_row_[visible_rows_[i]->frameData()->num] = i;
     }
@@ -169,62 +231,115 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
     }
 }
 
+// Should the given custom column be sorted as numbers?
+bool PacketListModel::columnIsNumeric(int column)
+{
+    header_field_info *hfi;
+
+    if (sort_cap_file_->cinfo.col_fmt[column] != COL_CUSTOM) {
+        return false;
+    }
+
+    hfi = proto_registrar_get_byname(sort_cap_file_->cinfo.col_custom_field[column]);
+    return hfi && (hfi->strings == NULL) &&
+            (((IS_FT_INT(hfi->type) || IS_FT_UINT(hfi->type)) &&
+              ((hfi->display == BASE_DEC) || (hfi->display == BASE_DEC_HEX) ||
+               (hfi->display == BASE_OCT))) ||
+             (hfi->type == FT_DOUBLE) || (hfi->type == FT_FLOAT) ||
+             (hfi->type == FT_BOOLEAN) || (hfi->type == FT_FRAMENUM) ||
+             (hfi->type == FT_RELATIVE_TIME));
+}
+
+void PacketListModel::updateSortKeys(int column)
+{
+    if (sort_key_column_ != column || sort_key_ver_ != PacketListRecord::columnDataVersion()) {
+        sort_num_keys_.clear();
+        sort_text_keys_.clear();
+        sort_key_valid_.clear();
+        sort_key_column_ = column;
+        sort_key_ver_ = PacketListRecord::columnDataVersion();
+        sort_key_numeric_ = columnIsNumeric(column);
+    }
+
+    // Live captures and file loads keep adding records.
+    int count = physical_rows_.count();
+    if (sort_key_valid_.size() < count) {
+        sort_key_valid_.resize(count);
+        if (sort_key_numeric_) {
+            sort_num_keys_.resize(count);
+        } else {
+            sort_text_keys_.resize(count);
+        }
+    }
+
+    // Only the visible records are sorted, so only they need keys.
+    foreach (PacketListRecord *record, visible_rows_) {
+        int idx = record->frameData()->num - 1;
+
+        if (sort_key_valid_.testBit(idx)) continue;
+
+        QVariant col_text = record->columnString(sort_cap_file_, column);
+        if (sort_key_numeric_) {
+            bool ok;
+            double num = col_text.toDouble(&ok);
+            sort_num_keys_[idx] = ok ? num : qQNaN();
+        } else {
+            sort_text_keys_[idx] = col_text.toByteArray();
+        }
+        sort_key_valid_.setBit(idx);
+    }
+}
+
+// Same ordering as recordLessThan, using the keys from updateSortKeys.
+bool PacketListModel::sortKeyLessThan(PacketListRecord *r1, PacketListRecord *r2)
+{
+    int idx1 = r1->frameData()->num - 1;
+    int idx2 = r2->frameData()->num - 1;
+    int cmp_val = 0;
+
+    if (sort_key_numeric_) {
+        double num_r1 = sort_num_keys_[idx1];
+        double num_r2 = sort_num_keys_[idx2];
+        bool ok_r1 = !qIsNaN(num_r1);
+        bool ok_r2 = !qIsNaN(num_r2);
+
+        if (!ok_r1 && !ok_r2) {
+            cmp_val = 0;
+        } else if (!ok_r1 || num_r1 < num_r2) {
+            cmp_val = -1;
+        } else if (!ok_r2 || num_r1 > num_r2) {
+            cmp_val = 1;
+        }
+    } else {
+        cmp_val = qstrcmp(sort_text_keys_[idx1], sort_text_keys_[idx2]);
+    }
+
+    if (cmp_val == 0) {
+        // Last resort. Compare column numbers.
+        cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
+    }
+
+    if (sort_order_ == Qt::AscendingOrder) {
+        return cmp_val < 0;
+    } else {
+        return cmp_val > 0;
+    }
+}
+
 bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
 {
     int cmp_val = 0;
 
-    // Wherein we try to cram the logic of packet_list_compare_records,
-    // _packet_list_compare_records, and packet_list_compare_custom from
-    // gtk/packet_list_store.c into one function
+    // Wherein we try to cram the logic of packet_list_compare_records and
+    // _packet_list_compare_records from gtk/packet_list_store.c into one
+    // function. Text columns are compared by sortKeyLessThan.
 
     if (sort_column_ < 0) {
         // No column.
         cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
-    } else if (text_sort_column_ < 0) {
+    } else {
         // Column comes directly from frame data
         cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), sort_cap_file_->cinfo.col_fmt[sort_column_]);
-    } else  {
-        if (r1->columnString(sort_cap_file_, sort_column_).toByteArray().data() == r2->columnString(sort_cap_file_, sort_column_).toByteArray().data()) {
-            cmp_val = 0;
-        } else if (sort_cap_file_->cinfo.col_fmt[sort_column_] == COL_CUSTOM) {
-            header_field_info *hfi;
-
-            // Column comes from custom data
-            hfi = proto_registrar_get_byname(sort_cap_file_->cinfo.col_custom_field[sort_column_]);
-
-            if (hfi == NULL) {
-                cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
-            } else if ((hfi->strings == NULL) &&
-                       (((IS_FT_INT(hfi->type) || IS_FT_UINT(hfi->type)) &&
-                         ((hfi->display == BASE_DEC) || (hfi->display == BASE_DEC_HEX) ||
-                          (hfi->display == BASE_OCT))) ||
-                        (hfi->type == FT_DOUBLE) || (hfi->type == FT_FLOAT) ||
-                        (hfi->type == FT_BOOLEAN) || (hfi->type == FT_FRAMENUM) ||
-                        (hfi->type == FT_RELATIVE_TIME)))
-            {
-                /* Attempt to convert to numbers */
-                bool ok_r1, ok_r2;
-                double num_r1 = r1->columnString(sort_cap_file_, sort_column_).toDouble(&ok_r1);
-                double num_r2 = r2->columnString(sort_cap_file_, sort_column_).toDouble(&ok_r2);
-
-                if (!ok_r1 && !ok_r2) {
-                    cmp_val = 0;
-                } else if (!ok_r1 || num_r1 < num_r2) {
-                    cmp_val = -1;
-                } else if (!ok_r2 || num_r1 > num_r2) {
-                    cmp_val = 1;
-                }
-            } else {
-                cmp_val = strcmp(r1->columnString(sort_cap_file_, sort_column_).toByteArray().data(), r2->columnString(sort_cap_file_, sort_column_).toByteArray().data());
-            }
-        } else {
-            cmp_val = strcmp(r1->columnString(sort_cap_file_, sort_column_).toByteArray().data(), r2->columnString(sort_cap_file_, sort_column_).toByteArray().data());
-        }
-
-        if (cmp_val == 0) {
-            // Last resort. Compare column numbers.
-            cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
-        }
     }
 
     if (sort_order_ == Qt::AscendingOrder) {
@@ -346,16 +461,58 @@ gint PacketListModel::appendPacket(frame_data *fdata)
     physical_rows_ << record;
 
     if (fdata->flags.passed_dfilter || fdata->flags.ref_time) {
-        beginInsertRows(QModelIndex(), pos, pos);
-        visible_rows_ << record;
-        number_to_row_[fdata->num] = visible_rows_.count() - 1;
-        endInsertRows();
+        if (append_deferred_) {
+            appended_rows_ << record;
+            pos += appended_rows_.count() - 1;
+        } else {
+            if (!appended_rows_.isEmpty()) {
+                // Rows held back from a live update go first.
+                flushAppendedRows();
+                pos = visible_rows_.count();
+            }
+            beginInsertRows(QModelIndex(), pos, pos);
+            visible_rows_ << record;
+            setNumberToRow(fdata->num, visible_rows_.count() - 1);
+            endInsertRows();
+        }
     } else {
         pos = -1;
     }
     return pos;
 }
 
+void PacketListModel::setAppendDeferred(bool deferred, bool flush)
+{
+    if (!deferred && flush) {
+        flushAppendedRows();
+    }
+    append_deferred_ = deferred;
+}
+
+void PacketListModel::flushAppendedRows()
+{
+    PacketListRecord *record;
+    int pos = visible_rows_.count();
+
+    if (appended_rows_.isEmpty()) return;
+
+    beginInsertRows(QModelIndex(), pos, pos + appended_rows_.count() - 1);
+    foreach (record, appended_rows_) {
+        visible_rows_ << record;
+        setNumberToRow(record->frameData()->num, visible_rows_.count() - 1);
+    }
+    endInsertRows();
+    appended_rows_.clear();
+}
+
+void PacketListModel::prefetchRow(int row)
+{
+    if (!cap_file_ || row < 0 || row >= visible_rows_.count())
+        return;
+
+    visible_rows_[row]->columnString(cap_file_, 0);
+}
+
 frame_data *PacketListModel::getRowFdata(int row) {
     if (row < 0 || row >= visible_rows_.count())
         return NULL;
@@ -367,12 +524,10 @@ frame_data *PacketListModel::getRowFdata(int row) {
 
 int PacketListModel::visibleIndexOf(frame_data *fdata) const
 {
-    int row = 0;
-    foreach (PacketListRecord *record, visible_rows_) {
-        if (record->frameData() == fdata) {
-            return row;
-        }
-        row++;
+    int row = packetNumberToRow(fdata->num);
+
+    if (row >= 0 && row < visible_rows_.count() && visible_rows_[row]->frameData() == fdata) {
+        return row;
     }
 
     return -1;
@@ -31,6 +31,7 @@
 #include <epan/packet.h>
 
 #include <QAbstractItemModel>
+#include <QBitArray>
 #include <QFont>
 #include <QVector>
 
@@ -49,6 +50,11 @@ public:
     QModelIndex parent(const QModelIndex &index) const;
     int packetNumberToRow(int packet_num) const;
     guint recreateVisibleRows();
+    // Show no rows, then add rows for the frames that pass the filter as
+    // refilterUpTo() is called with increasing frame numbers.
+    // recreateVisibleRows() finishes the job.
+    void beginRefilter();
+    void refilterUpTo(guint32 framenum);
     void clear();
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
@@ -58,7 +64,16 @@ public:
                              int role = Qt::DisplayRole) const;
 
     gint appendPacket(frame_data *fdata);
+    // While deferred, appended rows are held back until flushAppendedRows()
+    // so that an attached view sees them in batches instead of one by one.
+    // Turning deferral off flushes them unless flush is false, in which
+    // case they're shown with the next row appended or flush.
+    void setAppendDeferred(bool deferred, bool flush = true);
+    void flushAppendedRows();
+    bool hasAppendedRows() const { return !appended_rows_.isEmpty(); }
     frame_data *getRowFdata(int row);
+    // Dissect a row and cache its column text if it isn't cached already.
+    void prefetchRow(int row);
     int visibleIndexOf(frame_data *fdata) const;
     void resetColumns();
     void resetColorized();
@@ -77,7 +92,14 @@ private:
     QList<QString> col_names_;
     QVector<PacketListRecord *> visible_rows_;
     QVector<PacketListRecord *> physical_rows_;
-    QMap<int, int> number_to_row_;
+    QVector<PacketListRecord *> appended_rows_;
+    bool append_deferred_;
+    int refilter_pos_;
+    // Row of each frame number, or -1 if the frame isn't visible. Frame
+    // numbers are dense, so a flat vector is both smaller and faster than a
+    // map.
+    QVector<int> number_to_row_;
+    void setNumberToRow(guint32 num, int row);
 
     int header_height_;
 
@@ -86,6 +108,20 @@ private:
     static Qt::SortOrder sort_order_;
     static capture_file *sort_cap_file_;
     static bool recordLessThan(PacketListRecord *r1, PacketListRecord *r2);
+
+    // Sort keys for text columns, indexed by frame number - 1. Numeric
+    // columns keep a double (NaN if the text isn't a number) and other
+    // columns keep their text. They are kept after sorting so that sorting
+    // the same column again doesn't have to dissect anything.
+    static int sort_key_column_;
+    static unsigned sort_key_ver_;
+    static bool sort_key_numeric_;
+    static QVector<double> sort_num_keys_;
+    static QVector<QByteArray> sort_text_keys_;
+    static QBitArray sort_key_valid_;
+    static bool columnIsNumeric(int column);
+    void updateSortKeys(int column);
+    static bool sortKeyLessThan(PacketListRecord *r1, PacketListRecord *r2);
 };
 
 #endif // PACKET_LIST_MODEL_H
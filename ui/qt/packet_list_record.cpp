@@ -36,13 +36,90 @@
 QMap<int, int> PacketListRecord::cinfo_column_;
 unsigned PacketListRecord::col_data_ver_ = 1;
 
+PacketListRecord *PacketListRecord::lru_head_ = NULL;
+PacketListRecord *PacketListRecord::lru_tail_ = NULL;
+size_t PacketListRecord::col_cache_bytes_ = 0;
+// Enough for a few hundred thousand rows of typical column text.
+const size_t PacketListRecord::col_cache_budget_ = 64 * 1024 * 1024;
+bool PacketListRecord::col_cache_limited_ = true;
+
 PacketListRecord::PacketListRecord(frame_data *frameData) :
+    lru_prev_(NULL),
+    lru_next_(NULL),
+    col_text_bytes_(0),
     fdata_(frameData),
     data_ver_(0),
     colorized_(false)
 {
 }
 
+PacketListRecord::~PacketListRecord()
+{
+    dropColumnStrings();
+}
+
+void PacketListRecord::clearColumnCache()
+{
+    while (lru_head_) {
+        lru_head_->dropColumnStrings();
+    }
+}
+
+void PacketListRecord::setColumnCacheLimited(bool limited)
+{
+    col_cache_limited_ = limited;
+    trimColumnCache(NULL);
+}
+
+// Make room by dropping the text of the least recently used records.
+void PacketListRecord::trimColumnCache(PacketListRecord *keep)
+{
+    if (!col_cache_limited_) return;
+
+    while (col_cache_bytes_ > col_cache_budget_ && lru_tail_ && lru_tail_ != keep) {
+        lru_tail_->dropColumnStrings();
+    }
+}
+
+void PacketListRecord::lruUnlink()
+{
+    if (lru_prev_) {
+        lru_prev_->lru_next_ = lru_next_;
+    } else if (lru_head_ == this) {
+        lru_head_ = lru_next_;
+    }
+    if (lru_next_) {
+        lru_next_->lru_prev_ = lru_prev_;
+    } else if (lru_tail_ == this) {
+        lru_tail_ = lru_prev_;
+    }
+    lru_prev_ = lru_next_ = NULL;
+}
+
+// Move this record to the most recently used end of the list.
+void PacketListRecord::lruTouch()
+{
+    if (lru_head_ == this) return;
+
+    lruUnlink();
+    lru_next_ = lru_head_;
+    if (lru_head_) {
+        lru_head_->lru_prev_ = this;
+    }
+    lru_head_ = this;
+    if (!lru_tail_) {
+        lru_tail_ = this;
+    }
+}
+
+void PacketListRecord::dropColumnStrings()
+{
+    lruUnlink();
+    col_text_.clear();
+    col_cache_bytes_ -= col_text_bytes_;
+    col_text_bytes_ = 0;
+}
+
 const QVariant PacketListRecord::columnString(capture_file *cap_file, int column)
 {
     // packet_list_store.c:packet_list_get_value
@@ -55,6 +132,9 @@ const QVariant PacketListRecord::columnString(capture_file *cap_file, int column
     if (column >= col_text_.size() || col_text_[column].isNull() || data_ver_ != col_data_ver_ || !colorized_) {
         dissect(cap_file, !colorized_);
     }
+    if (!col_text_.isEmpty()) {
+        lruTouch();
+    }
 
     return col_text_.value(column, QByteArray());
 }
@@ -171,7 +251,7 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
         return;
     }
 
-    col_text_.clear();
+    dropColumnStrings();
 
     for (int column = 0; column < cinfo->num_cols; ++column) {
 
@@ -246,6 +326,13 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
         }
 #endif // MINIMIZE_STRING_COPYING
     }
+
+    foreach (const QByteArray &col_text, col_text_) {
+        col_text_bytes_ += sizeof(QByteArray) + col_text.size();
+    }
+    col_cache_bytes_ += col_text_bytes_;
+    lruTouch();
+    trimColumnCache(this);
 }
 
 /*
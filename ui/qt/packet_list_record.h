@@ -39,20 +39,45 @@ class PacketListRecord
 {
 public:
     PacketListRecord(frame_data *frameData);
+    ~PacketListRecord();
     // Return the string value for a column. Data is cached if possible.
     const QVariant columnString(capture_file *cap_file, int column);
     frame_data *frameData() const { return fdata_; }
     // packet_list->col_to_text in gtk/packet_list_store.c
     static int textColumn(int column) { return cinfo_column_.value(column, -1); }
+    // Changes whenever the column text of every record is invalidated.
+    static unsigned columnDataVersion() { return col_data_ver_; }
 
     int columnTextSize(const char *str);
     static void resetColumns(column_info *cinfo);
     void resetColorized();
+    // Drop the cached column text of every record.
+    static void clearColumnCache();
+    // Let the column cache grow without limit while an operation that
+    // visits every record (such as sorting) runs.
+    static void setColumnCacheLimited(bool limited);
 
 private:
     /** The column text for some columns */
     QList<QByteArray> col_text_;
 
+    /** Records with column text are kept on a most-recently-used list so
+     *  that the text of the least recently used ones can be dropped when
+     *  the cache grows past col_cache_budget_ bytes. */
+    static PacketListRecord *lru_head_;
+    static PacketListRecord *lru_tail_;
+    static size_t col_cache_bytes_;
+    static const size_t col_cache_budget_;
+    static bool col_cache_limited_;
+    PacketListRecord *lru_prev_;
+    PacketListRecord *lru_next_;
+    size_t col_text_bytes_;
+
+    void lruUnlink();
+    void lruTouch();
+    void dropColumnStrings();
+    static void trimColumnCache(PacketListRecord *keep);
+
     frame_data *fdata_;
     static QMap<int, int> cinfo_column_;
 
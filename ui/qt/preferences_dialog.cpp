@@ -209,22 +209,12 @@ module_prefs_show(module_t *module, gpointer ti_ptr)
 static guint
 module_prefs_unstash(module_t *module, gpointer data)
 {
-    gboolean *must_redissect_p = (gboolean *)data;
+    guint *effect_p = (guint *)data;
 
-    module->prefs_changed = FALSE;        /* assume none of them changed */
-    for (GList *pref_l = module->prefs; pref_l && pref_l->data; pref_l = g_list_next(pref_l)) {
-        pref_t *pref = (pref_t *) pref_l->data;
-
-        if (pref->type == PREF_OBSOLETE || pref->type == PREF_STATIC_TEXT) continue;
-
-        pref_unstash(pref, &module->prefs_changed);
-    }
-
-    /* If any of them changed, indicate that we must redissect and refilter
-       the current capture (if we have one), as the preference change
-       could cause packets to be dissected differently. */
-    if (module->prefs_changed)
-        *must_redissect_p = TRUE;
+    /* Collect what the changes make stale in the current capture (if we
+       have one): its dissection, the display filter's results, or just
+       what's drawn. */
+    *effect_p |= prefs_module_fetch_effect(module, pref_unstash);
 
     if(prefs_module_has_submodules(module))
         return prefs_modules_foreach_submodules(module, module_prefs_unstash, data);
@@ -789,13 +779,12 @@ void PreferencesDialog::rangePrefEditingFinished()
 
 void PreferencesDialog::on_buttonBox_accepted()
 {
-    gboolean must_redissect = FALSE;
+    guint effect = 0;
 
     // XXX - We should validate preferences as the user changes them, not here.
-    // XXX - We're also too enthusiastic about setting must_redissect.
 //    if (!prefs_main_fetch_all(parent_w, &must_redissect))
 //        return; /* Errors in some preference setting - already reported */
-    prefs_modules_foreach_submodules(NULL, module_prefs_unstash, (gpointer) &must_redissect);
+    prefs_modules_foreach_submodules(NULL, module_prefs_unstash, (gpointer) &effect);
 
     pd_ui_->columnFrame->unstash();
     pd_ui_->filterExpressonsFrame->unstash();
@@ -825,9 +814,14 @@ void PreferencesDialog::on_buttonBox_accepted()
     /* Now destroy the "Preferences" dialog. */
 //    window_destroy(GTK_WIDGET(parent_w));
 
-    if (must_redissect) {
+    if (effect & PREF_EFFECT_DISSECTION) {
         /* Redissect all the packets, and re-evaluate the display filter. */
         app_signals_ << WiresharkApplication::PacketDissectionChanged;
+    } else if (effect & PREF_EFFECT_FILTER) {
+        /* Re-evaluate the display filter, keeping what's been dissected. */
+        app_signals_ << WiresharkApplication::PacketFilterChanged;
+    } else if (effect & PREF_EFFECT_DISPLAY) {
+        app_signals_ << WiresharkApplication::PacketDisplayChanged;
     }
     app_signals_ << WiresharkApplication::PreferencesChanged;
 }
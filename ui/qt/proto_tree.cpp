@@ -105,10 +105,6 @@ proto_tree_draw_node(proto_node *node, gpointer data)
             item->setData(0, Qt::ForegroundRole, pal.link());
             font.setUnderline(true);
             item->setData(0, Qt::FontRole, font);
-
-            if (fi->hfinfo->type == FT_FRAMENUM) {
-                proto_tree->emitRelatedFrame(fi->value.value.uinteger);
-            }
         }
     }
 
@@ -146,17 +142,59 @@ proto_tree_draw_node(proto_node *node, gpointer data)
     if (is_branch) {
         if (tree_expanded(fi->tree_type)) {
             item->setExpanded(true);
+            proto_tree_children_foreach(node, proto_tree_draw_node, item);
         } else {
+            // Huge subtrees are mostly collapsed. Wait until the user
+            // opens them before making their items.
             item->setExpanded(false);
+            proto_tree->deferChildren(item, node);
         }
+    }
+}
 
-        proto_tree_children_foreach(node, proto_tree_draw_node, item);
+/* Tell the packet list about the frames this one refers to, including
+ * those in collapsed subtrees that don't have items yet. */
+static void
+proto_tree_related_frames(proto_node *node, gpointer data)
+{
+    field_info *fi = PNODE_FINFO(node);
+    ProtoTree  *proto_tree = (ProtoTree *)data;
+
+    if (PROTO_ITEM_IS_HIDDEN(node) && !prefs.display_hidden_proto_items)
+        return;
+
+    if (fi && fi->hfinfo && fi->hfinfo->type == FT_FRAMENUM) {
+        proto_tree->emitRelatedFrame(fi->value.value.uinteger);
+    }
+
+    if (node->first_child != NULL) {
+        proto_tree_children_foreach(node, proto_tree_related_frames, data);
+    }
+}
+
+/* Find the path from the root down to the node for fi */
+static bool
+proto_tree_find_path(proto_node *node, field_info *fi, QList<proto_node *> &path)
+{
+    proto_node *child;
+
+    for (child = node->first_child; child != NULL; child = child->next) {
+        if (PROTO_ITEM_IS_HIDDEN(child) && !prefs.display_hidden_proto_items)
+            continue;
+
+        path.append(child);
+        if (PNODE_FINFO(child) == fi || proto_tree_find_path(child, fi, path)) {
+            return true;
+        }
+        path.removeLast();
     }
+    return false;
 }
 
 ProtoTree::ProtoTree(QWidget *parent) :
     QTreeWidget(parent),
-    decode_as_(NULL)
+    decode_as_(NULL),
+    root_node_(NULL)
 {
     QMenu *submenu, *subsubmenu;
     QAction *action;
@@ -261,6 +299,8 @@ ProtoTree::ProtoTree(QWidget *parent) :
 
 void ProtoTree::clear() {
     updateSelectionStatus(NULL);
+    deferred_children_.clear();
+    root_node_ = NULL;
     QTreeWidget::clear();
 }
 
@@ -281,8 +321,66 @@ void ProtoTree::setMonospaceFont(const QFont &mono_font)
 void ProtoTree::fillProtocolTree(proto_tree *protocol_tree) {
     clear();
     setFont(mono_font_);
+    root_node_ = protocol_tree;
 
     proto_tree_children_foreach(protocol_tree, proto_tree_draw_node, invisibleRootItem());
+    proto_tree_children_foreach(protocol_tree, proto_tree_related_frames, this);
+}
+
+void ProtoTree::deferChildren(QTreeWidgetItem *item, proto_node *node)
+{
+    item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+    deferred_children_.insert(item, node);
+}
+
+// Add the children of an item that were put off, and optionally those of
+// all of its descendants.
+void ProtoTree::fillChildren(QTreeWidgetItem *item, bool recursive)
+{
+    if (!item) {
+        return;
+    }
+
+    proto_node *node = deferred_children_.take(item);
+    if (node) {
+        item->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
+        proto_tree_children_foreach(node, proto_tree_draw_node, item);
+    }
+
+    if (recursive) {
+        for (int i = 0; i < item->childCount(); i++) {
+            fillChildren(item->child(i), true);
+        }
+    }
+}
+
+// Find the item for a field, adding the items above it if they were put
+// off. Returns NULL if the field isn't shown.
+QTreeWidgetItem *ProtoTree::itemForField(field_info *fi)
+{
+    QList<proto_node *> path;
+
+    if (!fi || !root_node_ || !proto_tree_find_path(root_node_, fi, path)) {
+        return NULL;
+    }
+
+    QTreeWidgetItem *item = invisibleRootItem();
+    foreach (proto_node *node, path) {
+        QTreeWidgetItem *child_item = NULL;
+
+        fillChildren(item);
+        for (int i = 0; i < item->childCount(); i++) {
+            if (item->child(i)->data(0, Qt::UserRole).value<field_info *>() == PNODE_FINFO(node)) {
+                child_item = item->child(i);
+                break;
+            }
+        }
+        if (!child_item) {
+            return NULL;
+        }
+        item = child_item;
+    }
+    return item;
 }
 
 void ProtoTree::emitRelatedFrame(int related_frame)
@@ -353,6 +451,8 @@ void ProtoTree::expand(const QModelIndex & index) {
     fi = index.data(Qt::UserRole).value<field_info *>();
     g_assert(fi);
 
+    fillChildren(itemFromIndex(index));
+
     if(prefs.gui_auto_scroll_on_expand) {
         ScrollHint scroll_hint = PositionAtTop;
         if (prefs.gui_auto_scroll_percentage > 66) {
@@ -409,6 +509,8 @@ void ProtoTree::expandSubtrees()
         top_sel = top_sel->parent();
     }
 
+    fillChildren(top_sel, true);
+
     QTreeWidgetItemIterator iter(top_sel);
     while (*iter) {
         if ((*iter) != top_sel && (*iter)->parent() == NULL) {
@@ -426,6 +528,7 @@ void ProtoTree::expandAll()
     for(i=0; i < num_tree_types; i++) {
         tree_expanded_set(i, TRUE);
     }
+    fillChildren(invisibleRootItem(), true);
     QTreeWidget::expandAll();
 }
 
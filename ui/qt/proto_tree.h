@@ -26,6 +26,7 @@
 
 #include <epan/proto.h>
 
+#include <QHash>
 #include <QTreeWidget>
 #include <QMenu>
 
@@ -37,6 +38,8 @@ class ProtoTree : public QTreeWidget
 public:
     explicit ProtoTree(QWidget *parent = 0);
     void fillProtocolTree(proto_tree *protocol_tree);
+    void deferChildren(QTreeWidgetItem *item, proto_node *node);
+    QTreeWidgetItem *itemForField(field_info *fi);
     void emitRelatedFrame(int related_frame);
     void clear();
 
@@ -47,6 +50,11 @@ private:
     QMenu ctx_menu_;
     QAction *decode_as_;
     QFont mono_font_;
+    proto_tree *root_node_;
+    // Collapsed branches whose children haven't been added yet
+    QHash<QTreeWidgetItem *, proto_node *> deferred_children_;
+
+    void fillChildren(QTreeWidgetItem *item, bool recursive = false);
 
 signals:
     void protoItemSelected(QString &);
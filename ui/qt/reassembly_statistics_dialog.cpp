@@ -0,0 +1,120 @@
+/* reassembly_statistics_dialog.cpp
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "reassembly_statistics_dialog.h"
+#include "ui_reassembly_statistics_dialog.h"
+
+#include <epan/packet.h>
+#include <epan/reassemble.h>
+
+#include <QPushButton>
+#include <QTreeWidget>
+
+enum {
+    col_protocol_,
+    col_pending_,
+    col_completed_,
+    col_fragments_,
+    col_overlaps_,
+    col_buffered_,
+    col_reassembled_,
+    col_added_,
+    col_lookups_
+};
+
+static void
+add_table_stats(const reassembly_table_stats *stats, gpointer tree_ptr)
+{
+    QTreeWidget *tree = static_cast<QTreeWidget *>(tree_ptr);
+
+    // Tables that no protocol has used yet have nothing to show.
+    if (!stats->proto_name) return;
+
+    QTreeWidgetItem *ti = new QTreeWidgetItem(tree);
+    ti->setText(col_protocol_, stats->proto_name);
+    // Set numbers as data so that they sort as numbers.
+    ti->setData(col_pending_, Qt::DisplayRole, stats->in_progress);
+    ti->setData(col_completed_, Qt::DisplayRole, stats->completed);
+    ti->setData(col_fragments_, Qt::DisplayRole, (qulonglong) stats->fragments);
+    ti->setData(col_overlaps_, Qt::DisplayRole, (qulonglong) stats->overlaps);
+    ti->setData(col_buffered_, Qt::DisplayRole, (qulonglong) stats->bytes_buffered);
+    ti->setData(col_reassembled_, Qt::DisplayRole, (qulonglong) stats->bytes_reassembled);
+    ti->setData(col_added_, Qt::DisplayRole, (qulonglong) stats->fragments_added);
+    ti->setData(col_lookups_, Qt::DisplayRole, (qulonglong) stats->lookups);
+    for (int col = col_pending_; col <= col_lookups_; col++) {
+        ti->setTextAlignment(col, Qt::AlignRight);
+    }
+}
+
+ReassemblyStatisticsDialog::ReassemblyStatisticsDialog(QWidget &parent, CaptureFile &capture_file) :
+    WiresharkDialog(parent, capture_file),
+    ui(new Ui::ReassemblyStatisticsDialog)
+{
+    ui->setupUi(this);
+
+    QPushButton *button = ui->buttonBox->button(QDialogButtonBox::Reset);
+    if (button) {
+        button->setText(tr("Refresh"));
+    }
+
+    setWindowSubtitle(tr("Reassembly Tables"));
+    updateWidgets();
+    ui->statsTreeWidget->sortByColumn(col_protocol_, Qt::AscendingOrder);
+}
+
+ReassemblyStatisticsDialog::~ReassemblyStatisticsDialog()
+{
+    delete ui;
+}
+
+void ReassemblyStatisticsDialog::updateWidgets()
+{
+    ui->statsTreeWidget->setSortingEnabled(false);
+    ui->statsTreeWidget->clear();
+    reassembly_table_foreach_stats(add_table_stats, ui->statsTreeWidget);
+    ui->statsTreeWidget->setSortingEnabled(true);
+
+    for (int col = 0; col < ui->statsTreeWidget->columnCount(); col++) {
+        ui->statsTreeWidget->resizeColumnToContents(col);
+    }
+
+    WiresharkDialog::updateWidgets();
+}
+
+void ReassemblyStatisticsDialog::on_buttonBox_clicked(QAbstractButton *button)
+{
+    if (button == ui->buttonBox->button(QDialogButtonBox::Reset)) {
+        updateWidgets();
+    }
+}
+
+/*
+ * Editor modelines
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * ex: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,68 @@
+/* reassembly_statistics_dialog.h
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef REASSEMBLY_STATISTICS_DIALOG_H
+#define REASSEMBLY_STATISTICS_DIALOG_H
+
+#include <config.h>
+
+#include <glib.h>
+
+#include "wireshark_dialog.h"
+
+namespace Ui {
+class ReassemblyStatisticsDialog;
+}
+
+class QAbstractButton;
+
+// Shows how much each reassembly table holds and how much it has been
+// used, so that reassembly preferences can be tuned per protocol.
+class ReassemblyStatisticsDialog : public WiresharkDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ReassemblyStatisticsDialog(QWidget &parent, CaptureFile &capture_file);
+    ~ReassemblyStatisticsDialog();
+
+private:
+    Ui::ReassemblyStatisticsDialog *ui;
+
+private slots:
+    void updateWidgets();
+    void on_buttonBox_clicked(QAbstractButton *button);
+};
+
+#endif // REASSEMBLY_STATISTICS_DIALOG_H
+
+/*
+ * Editor modelines
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * ex: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -30,34 +30,21 @@
 #include <QPalette>
 #include <QPen>
 #include <QPointF>
+#include <QtCore/qmath.h>
 
 const int max_comment_em_width_ = 20;
 
 // UML-like network node sequence diagrams.
 // http://www.ibm.com/developerworks/rational/library/3101.html
 
-WSCPSeqData::WSCPSeqData() :
-  key(0),
-  value(NULL)
-{
-}
-
-WSCPSeqData::WSCPSeqData(double key, seq_analysis_item_t *value) :
-  key(key),
-  value(value)
-{
-}
-
 SequenceDiagram::SequenceDiagram(QCPAxis *keyAxis, QCPAxis *valueAxis, QCPAxis *commentAxis) :
     QCPAbstractPlottable(keyAxis, valueAxis),
     key_axis_(keyAxis),
     value_axis_(valueAxis),
     comment_axis_(commentAxis),
-    data_(NULL),
     sainfo_(NULL),
     selected_packet_(0)
 {
-    data_ = new WSCPSeqDataMap();
     // xaxis (value): Address
     // yaxis (key): Time
     // yaxis2 (comment): Extra info ("Comment" in GTK+)
@@ -91,35 +78,23 @@ SequenceDiagram::SequenceDiagram(QCPAxis *keyAxis, QCPAxis *valueAxis, QCPAxis *
 
 //    setTickVectorLabels
     //    valueAxis->setTickLabelRotation(30);
+
+    connect(key_axis_, SIGNAL(rangeChanged(QCPRange)), this, SLOT(keyRangeChanged(QCPRange)));
 }
 
 void SequenceDiagram::setData(seq_analysis_info_t *sainfo)
 {
-    data_->clear();
+    items_.clear();
     sainfo_ = sainfo;
     if (!sainfo) return;
 
-    double cur_key = 0.0;
-    QVector<double> key_ticks, val_ticks;
-    QVector<QString> key_labels, val_labels, com_labels;
-    QFontMetrics com_fm(comment_axis_->tickLabelFont());
-    int elide_w = com_fm.height() * max_comment_em_width_;
+    QVector<double> val_ticks;
+    QVector<QString> val_labels;
     char* addr_str;
 
+    items_.reserve(g_queue_get_length(sainfo->items));
     for (GList *cur = g_queue_peek_nth_link(sainfo->items, 0); cur; cur = g_list_next(cur)) {
-        seq_analysis_item_t *sai = (seq_analysis_item_t *) cur->data;
-        WSCPSeqData new_data;
-
-        new_data.key = cur_key;
-        new_data.value = sai;
-        data_->insertMulti(new_data.key, new_data);
-
-        key_ticks.append(cur_key);
-        key_labels.append(sai->time_str);
-
-        com_labels.append(com_fm.elidedText(sai->comment, Qt::ElideRight, elide_w));
-
-        cur_key++;
+        items_.append((seq_analysis_item_t *) cur->data);
     }
 
     for (unsigned int i = 0; i < sainfo_->num_nodes; i++) {
@@ -132,14 +107,47 @@ void SequenceDiagram::setData(seq_analysis_info_t *sainfo)
 
         wmem_free(NULL, addr_str);
     }
-    keyAxis()->setTickVector(key_ticks);
-    keyAxis()->setTickVectorLabels(key_labels);
     valueAxis()->setTickVector(val_ticks);
     valueAxis()->setTickVectorLabels(val_labels);
+    keyRangeChanged(key_axis_->range());
+}
+
+// Time and comment labels are only made for the items in view; making
+// (and eliding) them for every item doesn't scale to large captures.
+void SequenceDiagram::keyRangeChanged(const QCPRange &range)
+{
+    QVector<double> key_ticks;
+    QVector<QString> key_labels, com_labels;
+    QFontMetrics com_fm(comment_axis_->tickLabelFont());
+    int elide_w = com_fm.height() * max_comment_em_width_;
+    int first, last;
+
+    if (visibleKeys(range, first, last)) {
+        for (int cur_key = first; cur_key <= last; cur_key++) {
+            seq_analysis_item_t *sai = items_[cur_key];
+
+            key_ticks.append(cur_key);
+            key_labels.append(sai->time_str);
+            com_labels.append(com_fm.elidedText(sai->comment, Qt::ElideRight, elide_w));
+        }
+    }
+
+    keyAxis()->setTickVector(key_ticks);
+    keyAxis()->setTickVectorLabels(key_labels);
     comment_axis_->setTickVector(key_ticks);
     comment_axis_->setTickVectorLabels(com_labels);
 }
 
+// The keys of the items in range, plus one on either side for partly visible rows.
+bool SequenceDiagram::visibleKeys(const QCPRange &range, int &first, int &last) const
+{
+    if (items_.isEmpty()) return false;
+
+    first = qMax(0, qFloor(range.lower) - 1);
+    last = qMin(items_.size() - 1, qCeil(range.upper) + 1);
+    return first <= last;
+}
+
 void SequenceDiagram::setSelectedPacket(int selected_packet)
 {
     if (selected_packet > 0) {
@@ -154,8 +162,8 @@ seq_analysis_item_t *SequenceDiagram::itemForPosY(int ypos)
 {
     double key_pos = qRound(key_axis_->pixelToCoord(ypos));
 
-    if (key_pos >= 0 && key_pos < data_->size()) {
-        return data_->value(key_pos).value;
+    if (key_pos >= 0 && key_pos < items_.size()) {
+        return items_[(int) key_pos];
     }
     return NULL;
 }
@@ -167,7 +175,7 @@ double SequenceDiagram::selectTest(const QPointF &pos, bool onlySelectable, QVar
 
     double key_pos = qRound(key_axis_->pixelToCoord(pos.y()));
 
-    if (key_pos >= 0 && key_pos < data_->size()) {
+    if (key_pos >= 0 && key_pos < items_.size()) {
         return 1.0;
     }
 
@@ -193,10 +201,12 @@ void SequenceDiagram::draw(QCPPainter *painter)
     painter->restore();
     fg_pen = mainPen();
 
-    WSCPSeqDataMap::const_iterator it;
-    for (it = data_->constBegin(); it != data_->constEnd(); ++it) {
-        double cur_key = it.key();
-        seq_analysis_item_t *sai = it.value().value;
+    int first_key, last_key;
+    if (!visibleKeys(key_axis_->range(), first_key, last_key)) return;
+
+    for (int key = first_key; key <= last_key; key++) {
+        double cur_key = key;
+        seq_analysis_item_t *sai = items_[key];
         QPen fg_pen(mainPen());
 
         if (sai->fd->num == selected_packet_) {
@@ -297,18 +307,10 @@ QCPRange SequenceDiagram::getKeyRange(bool &validRange, QCPAbstractPlottable::Si
     QCPRange range;
     bool valid = false;
 
-    WSCPSeqDataMap::const_iterator it = data_->constBegin();
-    while (it != data_->constEnd()) {
-        double cur_key = it.key();
-        if (!valid) {
-            range.lower = range.upper = cur_key;
-            valid = true;
-        } else if (cur_key < range.lower) {
-            range.lower = cur_key;
-        } else if (cur_key > range.upper) {
-            range.upper = cur_key;
-        }
-        ++it;
+    if (!items_.isEmpty()) {
+        range.lower = 0;
+        range.upper = items_.size() - 1;
+        valid = true;
     }
     validRange = valid;
     return range;
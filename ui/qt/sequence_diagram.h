@@ -31,24 +31,9 @@
 #include "ui/tap-sequence-analysis.h"
 
 #include <QObject>
-#include <QMultiMap>
+#include <QVector>
 #include "qcustomplot.h"
 
-// Most of this is probably unnecessary
-class WSCPSeqData
-{
-public:
-  WSCPSeqData();
-  WSCPSeqData(double key, seq_analysis_item_t *value);
-  double key;
-  seq_analysis_item_t *value;
-};
-Q_DECLARE_TYPEINFO(WSCPSeqData, Q_MOVABLE_TYPE);
-
-typedef QMap<double, WSCPSeqData> WSCPSeqDataMap;
-typedef QMapIterator<double, WSCPSeqData> WSCPSeqDataMapIterator;
-typedef QMutableMapIterator<double, WSCPSeqData> WSCPSeqDataMutableMapIterator;
-
 class SequenceDiagram : public QCPAbstractPlottable
 {
     Q_OBJECT
@@ -64,12 +49,15 @@ public:
     seq_analysis_item_t *itemForPosY(int ypos);
 
     // reimplemented virtual methods:
-    virtual void clearData() { data_->clear(); }
+    virtual void clearData() { items_.clear(); }
     virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const;
 
 public slots:
     void setSelectedPacket(int selected_packet);
 
+private slots:
+    void keyRangeChanged(const QCPRange &range);
+
 protected:
     virtual void draw(QCPPainter *painter);
     virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const;
@@ -80,9 +68,13 @@ private:
     QCPAxis *key_axis_;
     QCPAxis *value_axis_;
     QCPAxis *comment_axis_;
-    WSCPSeqDataMap *data_;
+    // Item keys are their indexes, so the items in view can be found without
+    // going through all of them.
+    QVector<seq_analysis_item_t *> items_;
     seq_analysis_info_t *sainfo_;
     guint32 selected_packet_;
+
+    bool visibleKeys(const QCPRange &range, int &first, int &last) const;
 };
 
 #endif // SEQUENCE_DIAGRAM_H
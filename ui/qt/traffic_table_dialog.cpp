@@ -281,6 +281,7 @@ TrafficTableTreeWidget::TrafficTableTreeWidget(QWidget *parent, register_ct_t *t
     resolve_names_(false)
 {
     setRootIsDecorated(false);
+    setUniformRowHeights(true);
     sortByColumn(0, Qt::AscendingOrder);
 
     connect(wsApp, SIGNAL(addressResolutionChanged()), this, SLOT(updateItems()));
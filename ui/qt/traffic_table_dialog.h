@@ -49,6 +49,7 @@ class TrafficTableDialog;
 class TrafficTableTreeWidgetItem : public QTreeWidgetItem
 {
 public:
+    TrafficTableTreeWidgetItem() : QTreeWidgetItem()  {}
     TrafficTableTreeWidgetItem(QTreeWidget *tree) : QTreeWidgetItem(tree)  {}
     TrafficTableTreeWidgetItem(QTreeWidget *parent, const QStringList &strings)
                    : QTreeWidgetItem (parent, strings)  {}
@@ -65,6 +66,7 @@ public:
     // String, int, or double data for each column in a row.
     // Passing -1 returns titles.
     QList<QVariant> rowData(int row) const;
+    bool nameResolutionEnabled() const { return resolve_names_; }
 
 public slots:
     void setNameResolutionEnabled(bool enable);
@@ -547,6 +547,12 @@ void WiresharkApplication::emitAppSignal(AppSignal signal)
     case PacketDissectionChanged:
         emit packetDissectionChanged();
         break;
+    case PacketFilterChanged:
+        emit packetFilterChanged();
+        break;
+    case PacketDisplayChanged:
+        emit packetDisplayChanged();
+        break;
     case StaticRecentFilesRead:
         emit recentFilesRead();
         break;
@@ -69,6 +69,8 @@ public:
         ColumnsChanged,
         FilterExpressionsChanged,
         PacketDissectionChanged,
+        PacketFilterChanged,
+        PacketDisplayChanged,
         PreferencesChanged,
         StaticRecentFilesRead,
         FieldsChanged
@@ -128,6 +130,8 @@ signals:
     void columnsChanged(); // XXX This recreates the packet list. We might want to rename it accordingly.
     void filterExpressionsChanged();
     void packetDissectionChanged();
+    void packetFilterChanged();
+    void packetDisplayChanged();
     void preferencesChanged();
     void addressResolutionChanged();
     void fieldsChanged();
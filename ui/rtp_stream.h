@@ -76,7 +76,8 @@ typedef struct _rtp_stream_info {
     gboolean        tag_diffserv_error;
 
     gboolean        decode; /**< Decode this stream */
-    GList          *rtp_packet_list; /**< List of RTP rtp_packet_t */
+    GArray         *rtp_packets; /**< The RTP player's per-packet records */
+    GByteArray     *rtp_payloads; /**< The payloads of rtp_packets, one after another */
 
     tap_rtp_stat_t  rtp_stats;  /**< here goes the RTP statistics info */
     gboolean        problem;    /**< if the streams had wrong sequence numbers or wrong timerstamps */
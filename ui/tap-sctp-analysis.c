@@ -45,6 +45,9 @@
 
 static sctp_allassocs_info_t sctp_tapinfo_struct = {0, NULL, FALSE, NULL};
 
+/* The associations in assoc_info_list, keyed by assoc_id */
+static GHashTable *assoc_table = NULL;
+
 static
 void free_first(gpointer data, gpointer user_data _U_)
 {
@@ -153,6 +156,11 @@ static void reset(void *arg)
 		list = g_list_next(list);
 	}
 	g_list_free(tapdata->assoc_info_list);
+	if (assoc_table != NULL)
+	{
+		g_hash_table_destroy(assoc_table);
+		assoc_table = NULL;
+	}
 	tapdata->sum_tvbs = 0;
 	tapdata->assoc_info_list = NULL;
 }
@@ -207,23 +215,19 @@ static sctp_assoc_info_t *calc_checksum(const struct _sctp_info *check_data, sct
 
 static sctp_assoc_info_t * find_assoc(sctp_tmp_info_t * needle)
 {
-	sctp_allassocs_info_t *assoc_info;
-	sctp_assoc_info_t *info = NULL;
-	GList* list;
+	if (assoc_table == NULL)
+		return NULL;
 
-	assoc_info = &sctp_tapinfo_struct;
-	if ((list = g_list_last(assoc_info->assoc_info_list))!=NULL)
-	{
-		while (list)
-		{
-		    info = (sctp_assoc_info_t*)(list->data);
-		    if (needle->assoc_id == info->assoc_id)
-		        return info;
+	return (sctp_assoc_info_t *)g_hash_table_lookup(assoc_table, GUINT_TO_POINTER(needle->assoc_id));
+}
 
-			list = g_list_previous(list);
-		}
-	}
-	return NULL;
+static void add_assoc(sctp_assoc_info_t * info)
+{
+	if (assoc_table == NULL)
+		assoc_table = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+	g_hash_table_insert(assoc_table, GUINT_TO_POINTER(info->assoc_id), info);
+	sctp_tapinfo_struct.assoc_info_list = g_list_append(sctp_tapinfo_struct.assoc_info_list, info);
 }
 
 static sctp_assoc_info_t * add_chunk_count(address * vadd, sctp_assoc_info_t * info, guint32 direction, guint32 type)
@@ -735,7 +739,7 @@ packet(void *tapdata _U_, packet_info *pinfo , epan_dissect_t *edt _U_ , const v
 					info->tsn1 = g_list_prepend(info->tsn1, tsn);
 				if (sackchunk == TRUE)
 					info->sack2 = g_list_prepend(info->sack2, sack);
-				sctp_tapinfo_struct.assoc_info_list = g_list_append(sctp_tapinfo_struct.assoc_info_list, info);
+				add_assoc(info);
 			}
 			else
 			{
@@ -64,6 +64,8 @@ void sequence_analysis_info_free(seq_analysis_info_t *sainfo)
 
     g_queue_free(sainfo->items);
     g_hash_table_destroy(sainfo->ht);
+    if (sainfo->node_ht)
+        g_hash_table_destroy(sainfo->node_ht);
 
     g_free(sainfo);
 }
@@ -336,6 +338,8 @@ sequence_analysis_list_free(seq_analysis_info_t *sainfo)
         sainfo->nodes[i].data = NULL;
     }
     sainfo->num_nodes = 0;
+    if (sainfo->node_ht)
+        g_hash_table_remove_all(sainfo->node_ht);
 }
 
 /****************************************************************************/
@@ -398,8 +402,19 @@ static void overwrite (GString *gstr, char *text_to_insert, guint32 p1, guint32
     g_free(ins_str);
 }
 
-/* Return the index array if the node is in the array. Return -1 if there is room in the array
- * and Return -2 if the array is full
+static guint node_hash(gconstpointer key) {
+    return add_address_to_hash(0, (const address *)key);
+}
+
+static gboolean node_equal(gconstpointer key1, gconstpointer key2) {
+    return ADDRESSES_EQUAL((const address *)key1, (const address *)key2);
+}
+
+/* Return the index array if the node is in the array, adding it if there is
+ * room. Return NODE_OVERFLOW if the array is full.
+ * Each item has two addresses to look up, so the nodes are found with a
+ * hash table, keyed by the addresses in the nodes array, rather than by
+ * comparing with every node.
  */
 /****************************************************************************/
 static guint add_or_get_node(seq_analysis_info_t *sainfo, address *node) {
@@ -407,15 +422,25 @@ static guint add_or_get_node(seq_analysis_info_t *sainfo, address *node) {
 
     if (node->type == AT_NONE) return NODE_OVERFLOW;
 
-    for (i=0; i<MAX_NUM_NODES && i < sainfo->num_nodes ; i++) {
-        if ( CMP_ADDRESS(&(sainfo->nodes[i]), node) == 0 ) return i; /* it is in the array */
+    if (!sainfo->node_ht)
+        sainfo->node_ht = g_hash_table_new(node_hash, node_equal);
+
+    /* The nodes array may have been emptied behind our back (see graph_analysis.c) */
+    if (sainfo->num_nodes == 0)
+        g_hash_table_remove_all(sainfo->node_ht);
+
+    i = GPOINTER_TO_UINT(g_hash_table_lookup(sainfo->node_ht, node));
+    if (i > 0 && i <= sainfo->num_nodes && ADDRESSES_EQUAL(&(sainfo->nodes[i - 1]), node)) {
+        return i - 1; /* it is in the array */
     }
 
+    i = sainfo->num_nodes;
     if (i >= MAX_NUM_NODES) {
         return  NODE_OVERFLOW;
     } else {
         sainfo->num_nodes++;
         COPY_ADDRESS(&(sainfo->nodes[i]), node);
+        g_hash_table_insert(sainfo->node_ht, &(sainfo->nodes[i]), GUINT_TO_POINTER(i + 1));
         return i;
     }
 }
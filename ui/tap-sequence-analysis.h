@@ -75,6 +75,7 @@ typedef struct _seq_analysis_info {
     GHashTable *ht;          /**< hash table for retrieving graph analysis items */
     address nodes[MAX_NUM_NODES]; /**< horizontal node list */
     guint32 num_nodes;       /**< actual number of nodes */
+    GHashTable *node_ht;     /**< hash table for finding nodes by address */
 } seq_analysis_info_t;
 
 /** Create and initialize a seq_analysis_info_t struct
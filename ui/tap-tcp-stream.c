@@ -45,8 +45,82 @@ typedef struct _tcp_scan_t {
     int                     direction;
     struct tcp_graph       *tg;
     struct segment         *last;
+    gboolean                build_index;
 } tcp_scan_t;
 
+/*
+ * The frames of each TCP stream, recorded while scanning the whole file
+ * for one graph, so that graphs of other streams (or of the same one
+ * again) only have to dissect that stream's frames.  The index belongs to
+ * one epan session and is thrown away when the file or its number of
+ * frames or streams changes.
+ */
+static struct {
+    epan_t     *epan;
+    guint32     frame_count;
+    guint32     stream_count;
+    GPtrArray  *stream_frames; /* GArray of guint32 frame numbers, by stream */
+} stream_index;
+
+static void
+stream_index_free(void)
+{
+    guint i;
+
+    if (stream_index.stream_frames) {
+        for (i = 0; i < stream_index.stream_frames->len; i++) {
+            GArray *frames = (GArray *)g_ptr_array_index(stream_index.stream_frames, i);
+            if (frames)
+                g_array_free(frames, TRUE);
+        }
+        g_ptr_array_free(stream_index.stream_frames, TRUE);
+        stream_index.stream_frames = NULL;
+    }
+    stream_index.epan = NULL;
+}
+
+static void
+stream_index_add(guint32 stream, guint32 frame_num)
+{
+    GArray *frames;
+
+    if (stream >= stream_index.stream_frames->len)
+        g_ptr_array_set_size(stream_index.stream_frames, stream + 1);
+
+    frames = (GArray *)g_ptr_array_index(stream_index.stream_frames, stream);
+    if (!frames) {
+        frames = g_array_new(FALSE, FALSE, sizeof(guint32));
+        g_ptr_array_index(stream_index.stream_frames, stream) = frames;
+    }
+
+    /* A frame can carry more than one segment of a stream (tunnels) */
+    if (frames->len == 0 || g_array_index(frames, guint32, frames->len - 1) != frame_num)
+        g_array_append_val(frames, frame_num);
+}
+
+/* The frames of the stream, or NULL if the index isn't usable */
+static GArray *
+stream_index_get(capture_file *cf, guint32 stream)
+{
+    if (!stream_index.stream_frames
+            || stream_index.epan != cf->epan
+            || stream_index.frame_count != cf->count
+            || stream_index.stream_count != get_tcp_stream_count()) {
+        stream_index_free();
+        return NULL;
+    }
+
+    if (stream >= stream_index.stream_frames->len) {
+        /* Not in the index, so it has no frames */
+        static GArray *no_frames = NULL;
+        if (!no_frames)
+            no_frames = g_array_new(FALSE, FALSE, sizeof(guint32));
+        return no_frames;
+    }
+
+    return (GArray *)g_ptr_array_index(stream_index.stream_frames, stream);
+}
+
 
 static gboolean
 tapall_tcpip_packet(void *pct, packet_info *pinfo, epan_dissect_t *edt _U_, const void *vip)
@@ -55,6 +129,9 @@ tapall_tcpip_packet(void *pct, packet_info *pinfo, epan_dissect_t *edt _U_, cons
     struct tcp_graph *tg  = ts->tg;
     const struct tcpheader *tcphdr = (const struct tcpheader *)vip;
 
+    if (ts->build_index)
+        stream_index_add(tcphdr->th_stream, pinfo->fd->num);
+
     if (tg->stream == tcphdr->th_stream
             && (tg->src_address.type == AT_NONE || tg->dst_address.type == AT_NONE)) {
         /*
@@ -118,6 +195,7 @@ graph_segment_list_get(capture_file *cf, struct tcp_graph *tg, gboolean stream_k
     struct segment current;
     GString    *error_string;
     tcp_scan_t  ts;
+    GArray     *frames;
 
     g_log(NULL, G_LOG_LEVEL_DEBUG, "graph_segment_list_get()");
 
@@ -149,6 +227,11 @@ graph_segment_list_get(capture_file *cf, struct tcp_graph *tg, gboolean stream_k
     ts.current = &current;
     ts.tg      = tg;
     ts.last    = NULL;
+    frames = stream_index_get(cf, tg->stream);
+    ts.build_index = (frames == NULL);
+    if (ts.build_index) {
+        stream_index.stream_frames = g_ptr_array_new();
+    }
     error_string = register_tap_listener("tcp", &ts, "tcp", 0, NULL, tapall_tcpip_packet, NULL);
     if (error_string) {
         fprintf(stderr, "wireshark: Couldn't register tcp_graph tap: %s\n",
@@ -156,7 +239,16 @@ graph_segment_list_get(capture_file *cf, struct tcp_graph *tg, gboolean stream_k
         g_string_free(error_string, TRUE);
         exit(1);   /* XXX: fix this */
     }
-    cf_retap_packets(cf);
+    if (frames) {
+        cf_retap_frames(cf, (const guint32 *)(void *)frames->data, frames->len);
+    } else if (cf_retap_packets(cf) == CF_READ_OK) {
+        stream_index.epan = cf->epan;
+        stream_index.frame_count = cf->count;
+        stream_index.stream_count = get_tcp_stream_count();
+    } else {
+        /* The scan didn't see every frame */
+        stream_index_free();
+    }
     remove_tap_listener(&ts);
 }
 
@@ -64,6 +64,28 @@ void packet_list_clear(void);
 void packet_list_freeze(void);
 void packet_list_recreate_visible_rows(void);
 void packet_list_thaw(void);
+/* Show packets in the list as they are read, instead of freezing it until the
+   whole file has been read.  Returns FALSE if this packet list can't do that,
+   in which case the caller should freeze it instead. */
+gboolean packet_list_begin_progressive_load(void);
+/* Show the packets appended since the last update. */
+void packet_list_update_progressive_load(void);
+void packet_list_end_progressive_load(void);
+/* During live capture, the packets appended from here until
+   packet_list_end_live_update() may be shown a little later, together with
+   those of the next few updates, rather than straight away.  If
+   scroll_to_end is TRUE, the list is scrolled to its end once they're
+   shown. */
+void packet_list_begin_live_update(void);
+void packet_list_end_live_update(gboolean scroll_to_end);
+/* Empty the packet list and then show the frames that pass the display
+   filter as it is applied, instead of freezing the list until filtering is
+   done.  Returns FALSE if this packet list can't do that, in which case the
+   caller should freeze it instead.  Filtering is finished off with
+   packet_list_recreate_visible_rows(). */
+gboolean packet_list_begin_progressive_filter(void);
+/* Show the frames up to and including framenum that passed the filter. */
+void packet_list_update_progressive_filter(guint32 framenum);
 void packet_list_next(void);
 void packet_list_prev(void);
 guint packet_list_append(column_info *cinfo, frame_data *fdata);
@@ -287,6 +287,8 @@ voip_calls_reset_all_taps(voip_calls_tapinfo_t *tapinfo)
     }
     g_list_free(tapinfo->rtp_stream_list);
     tapinfo->rtp_stream_list = NULL;
+    if(NULL!=tapinfo->rtp_stream_hash)
+        g_hash_table_remove_all (tapinfo->rtp_stream_hash);
 
     if (!tapinfo->h245_labels) {
         tapinfo->h245_labels = g_new0(h245_labels_t, 1);
@@ -551,6 +553,8 @@ rtp_reset(void *tap_offset_ptr)
     }
     g_list_free(tapinfo->rtp_stream_list);
     tapinfo->rtp_stream_list = NULL;
+    if(NULL!=tapinfo->rtp_stream_hash)
+        g_hash_table_remove_all (tapinfo->rtp_stream_hash);
     tapinfo->nrtp_streams = 0;
 
     if (tapinfo->tap_reset) {
@@ -560,6 +564,27 @@ rtp_reset(void *tap_offset_ptr)
     return;
 }
 
+/****************************************************************************/
+/* rtp_stream_hash is keyed by the streams themselves, on their setup frame
+   and SSRC; there's at most one open stream for each */
+static guint
+rtp_stream_hash_func(gconstpointer key)
+{
+    const rtp_stream_info_t *strinfo = (const rtp_stream_info_t *)key;
+
+    return strinfo->setup_frame_number ^ strinfo->ssrc;
+}
+
+static gboolean
+rtp_stream_equal_func(gconstpointer key1, gconstpointer key2)
+{
+    const rtp_stream_info_t *strinfo1 = (const rtp_stream_info_t *)key1;
+    const rtp_stream_info_t *strinfo2 = (const rtp_stream_info_t *)key2;
+
+    return strinfo1->setup_frame_number == strinfo2->setup_frame_number
+        && strinfo1->ssrc == strinfo2->ssrc;
+}
+
 /****************************************************************************/
 /* whenever a RTP packet is seen by the tap listener */
 static gboolean
@@ -568,7 +593,7 @@ rtp_packet(void *tap_offset_ptr, packet_info *pinfo, epan_dissect_t *edt, void c
     voip_calls_tapinfo_t *tapinfo = tap_id_to_base(tap_offset_ptr, tap_id_offset_rtp_);
     rtp_stream_info_t *tmp_listinfo;
     rtp_stream_info_t *strinfo = NULL;
-    GList *list;
+    rtp_stream_info_t stream_key;
     struct _rtp_conversation_info *p_conv_data = NULL;
 
     const struct _rtp_info *rtp_info = (const struct _rtp_info *)rtp_info_ptr;
@@ -582,23 +607,22 @@ rtp_packet(void *tap_offset_ptr, packet_info *pinfo, epan_dissect_t *edt, void c
         tapinfo->tap_packet(tapinfo, pinfo, edt, rtp_info_ptr);
     }
 
-    /* check whether we already have a RTP stream with this setup frame and ssrc in the list */
-    list = g_list_first(tapinfo->rtp_stream_list);
-    while (list)
-    {
-        tmp_listinfo=(rtp_stream_info_t *)list->data;
-        if ( (tmp_listinfo->setup_frame_number == rtp_info->info_setup_frame_num)
-                && (tmp_listinfo->ssrc == rtp_info->info_sync_src) && (tmp_listinfo->end_stream == FALSE)) {
-            /* if the payload type has changed, we mark the stream as finished to create a new one
-               this is to show multiple payload changes in the Graph for example for DTMF RFC2833 */
-            if ( tmp_listinfo->payload_type != rtp_info->info_payload_type ) {
-                tmp_listinfo->end_stream = TRUE;
-            } else {
-                strinfo = (rtp_stream_info_t*)(list->data);
-                break;
-            }
+    if (NULL==tapinfo->rtp_stream_hash) {
+        tapinfo->rtp_stream_hash = g_hash_table_new(rtp_stream_hash_func, rtp_stream_equal_func);
+    }
+
+    /* check whether we already have an open RTP stream with this setup frame and ssrc */
+    stream_key.setup_frame_number = rtp_info->info_setup_frame_num;
+    stream_key.ssrc = rtp_info->info_sync_src;
+    tmp_listinfo = (rtp_stream_info_t *)g_hash_table_lookup(tapinfo->rtp_stream_hash, &stream_key);
+    if (tmp_listinfo && (tmp_listinfo->end_stream == FALSE)) {
+        /* if the payload type has changed, we mark the stream as finished to create a new one
+           this is to show multiple payload changes in the Graph for example for DTMF RFC2833 */
+        if ( tmp_listinfo->payload_type != rtp_info->info_payload_type ) {
+            tmp_listinfo->end_stream = TRUE;
+        } else {
+            strinfo = tmp_listinfo;
         }
-        list = g_list_next(list);
     }
 
     /* if this is a duplicated RTP Event End, just return */
@@ -636,6 +660,8 @@ rtp_packet(void *tap_offset_ptr, packet_info *pinfo, epan_dissect_t *edt, void c
         strinfo->setup_frame_number = rtp_info->info_setup_frame_num;
         strinfo->rtp_event = -1;
         tapinfo->rtp_stream_list = g_list_prepend(tapinfo->rtp_stream_list, strinfo);
+        /* the new stream replaces any finished one with the same key */
+        g_hash_table_replace(tapinfo->rtp_stream_hash, strinfo, strinfo);
     }
 
     /* Add the info to the existing RTP stream */
@@ -715,7 +741,7 @@ rtp_draw(void *tap_offset_ptr)
                 new_gai->display=FALSE;
                 new_gai->line_style = 2;  /* the arrow line will be 2 pixels width */
                 g_queue_push_tail(tapinfo->graph_analysis->items, new_gai);
-                g_hash_table_insert(tapinfo->graph_analysis->ht, &rtp_listinfo->start_fd, new_gai);
+                g_hash_table_insert(tapinfo->graph_analysis->ht, &rtp_listinfo->start_fd->num, new_gai);
             }
         }
         rtp_streams_list = g_list_next(rtp_streams_list);
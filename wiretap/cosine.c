@@ -25,6 +25,7 @@
 #include "wtap-int.h"
 #include "cosine.h"
 #include "file_wrappers.h"
+#include "hex_dump.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -482,23 +483,15 @@ parse_cosine_hex_dump(FILE_T fh, struct wtap_pkthdr *phdr, int pkt_len,
 static int
 parse_single_hex_dump_line(char* rec, guint8 *buf, guint byte_offset)
 {
-	int num_items_scanned, i;
-	unsigned int bytes[16];
-
-	num_items_scanned = sscanf(rec, "%02x %02x %02x %02x %02x %02x %02x %02x %02x %02x %02x %02x %02x %02x %02x %02x",
-			       &bytes[0], &bytes[1], &bytes[2], &bytes[3],
-			       &bytes[4], &bytes[5], &bytes[6], &bytes[7],
-			       &bytes[8], &bytes[9], &bytes[10], &bytes[11],
-			       &bytes[12], &bytes[13], &bytes[14], &bytes[15]);
-	if (num_items_scanned == 0)
-		return -1;
+	int num_items_scanned;
 
-	if (num_items_scanned > 16)
-		num_items_scanned = 16;
+	while (g_ascii_isspace(*rec))
+		rec++;
 
-	for (i=0; i<num_items_scanned; i++) {
-		buf[byte_offset + i] = (guint8)bytes[i];
-	}
+	num_items_scanned = wtap_hex_dump_to_bytes(rec, -1, ' ',
+	    &buf[byte_offset], 16, NULL);
+	if (num_items_scanned <= 0)
+		return -1;
 
 	return num_items_scanned;
 }
@@ -22,6 +22,7 @@
 #include "wtap-int.h"
 #include "dbs-etherwatch.h"
 #include "file_wrappers.h"
+#include "hex_dump.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -575,35 +576,13 @@ parse_single_hex_dump_line(char* rec, guint8 *buf, int byte_offset) {
 /* Parse a hex dump */
 static guint
 parse_hex_dump(char* dump, guint8 *buf, char seperator, char end) {
-    int     pos, count;
+    const char *stop;
+    int         count;
 
-    /* Parse the hex dump */
-    pos = 0;
-    count = 0;
-    while(dump[pos] != end) {
-        /* Check the hex value */
-        if(!(g_ascii_isxdigit(dump[pos]) &&
-            g_ascii_isxdigit(dump[pos + 1]))) {
-            return 0;
-        }
-        /* Get the hex value value */
-        if(g_ascii_isdigit(dump[pos])) {
-            buf[count] = (dump[pos] - '0') << 4;
-        } else {
-            buf[count] = (g_ascii_toupper(dump[pos]) - 'A' + 10) << 4;
-        }
-        pos++;
-        if(g_ascii_isdigit(dump[pos])) {
-            buf[count] += dump[pos] - '0';
-        } else {
-            buf[count] += g_ascii_toupper(dump[pos]) - 'A' + 10;
-        }
-        pos++;
-        count++;
-        /* Skip the seperator characters */
-        while(dump[pos] == seperator) {
-            pos++;
-        }
+    /* Parse the hex dump, skipping the seperator characters */
+    count = wtap_hex_dump_to_bytes(dump, -1, seperator, buf, G_MAXINT, &stop);
+    if(count < 0 || *stop != end) {
+        return 0;
     }
     return count;
 }
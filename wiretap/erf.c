@@ -67,6 +67,8 @@ static gboolean erf_read(wtap *wth, int *err, gchar **err_info,
 static gboolean erf_seek_read(wtap *wth, gint64 seek_off,
                               struct wtap_pkthdr *phdr, Buffer *buf,
                               int *err, gchar **err_info);
+static guint erf_read_batch(wtap *wth, wtap_batch_rec *recs, guint nrecs,
+                            int *err, gchar **err_info);
 
 static const struct {
   int erf_encap_value;
@@ -281,6 +283,7 @@ extern wtap_open_return_val erf_open(wtap *wth, int *err, gchar **err_info)
 
   wth->subtype_read = erf_read;
   wth->subtype_seek_read = erf_seek_read;
+  wth->subtype_read_batch = erf_read_batch;
   wth->file_tsprec = WTAP_TSPREC_NSEC;
 
   erf_populate_interfaces(wth);
@@ -289,8 +292,9 @@ extern wtap_open_return_val erf_open(wtap *wth, int *err, gchar **err_info)
 }
 
 /* Read the next packet */
-static gboolean erf_read(wtap *wth, int *err, gchar **err_info,
-                         gint64 *data_offset)
+static gboolean erf_read_record(wtap *wth, struct wtap_pkthdr *phdr,
+                                Buffer *buf, int *err, gchar **err_info,
+                                gint64 *data_offset)
 {
   erf_header_t erf_header;
   guint32      packet_size, bytes_read;
@@ -299,12 +303,12 @@ static gboolean erf_read(wtap *wth, int *err, gchar **err_info,
 
   do {
     if (!erf_read_header(wth->fh,
-                         &wth->phdr, &erf_header,
+                         phdr, &erf_header,
                          err, err_info, &bytes_read, &packet_size)) {
       return FALSE;
     }
 
-    if (!wtap_read_packet_bytes(wth->fh, wth->frame_buffer, packet_size,
+    if (!wtap_read_packet_bytes(wth->fh, buf, packet_size,
                                 err, err_info))
       return FALSE;
 
@@ -313,6 +317,26 @@ static gboolean erf_read(wtap *wth, int *err, gchar **err_info,
   return TRUE;
 }
 
+static gboolean erf_read(wtap *wth, int *err, gchar **err_info,
+                         gint64 *data_offset)
+{
+  return erf_read_record(wth, &wth->phdr, wth->frame_buffer, err, err_info,
+                         data_offset);
+}
+
+static guint erf_read_batch(wtap *wth, wtap_batch_rec *recs, guint nrecs,
+                            int *err, gchar **err_info)
+{
+  guint n;
+
+  for (n = 0; n < nrecs; n++) {
+    if (!erf_read_record(wth, &recs[n].phdr, &recs[n].buf, err, err_info,
+                         &recs[n].data_offset))
+      break;
+  }
+  return n;
+}
+
 static gboolean erf_seek_read(wtap *wth, gint64 seek_off,
                               struct wtap_pkthdr *phdr, Buffer *buf,
                               int *err, gchar **err_info)
@@ -37,6 +37,7 @@
 
 #include "wtap-int.h"
 #include "file_wrappers.h"
+#include "frame_index.h"
 #include <wsutil/buffer.h>
 #include "lanalyzer.h"
 #include "ngsniffer.h"
@@ -852,6 +853,9 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 	if (wth->random_fh) {
 		wth->fast_seek = g_ptr_array_new();
 
+		/* Pick up any seek points saved by wtap_fast_seek_save() */
+		file_fast_seek_load(wth->fast_seek, filename);
+
 		file_set_random_access(wth->fh, FALSE, wth->fast_seek);
 		file_set_random_access(wth->random_fh, TRUE, wth->fast_seek);
 	}
@@ -1140,6 +1144,22 @@ wtap_fdreopen(wtap *wth, const char *filename, int *err)
 	return TRUE;
 }
 
+/*
+ * Reopen the sequential stream's file descriptor after wtap_fdclose(),
+ * e.g. because the caller is reading more files than it can keep open;
+ * the stream is read from where it had got to.
+ */
+gboolean
+wtap_sequential_fdreopen(wtap *wth, const char *filename, int *err)
+{
+	errno = WTAP_ERR_CANT_OPEN;
+	if (wth->fh == NULL || !file_fdreopen(wth->fh, filename)) {
+		*err = errno;
+		return FALSE;
+	}
+	return TRUE;
+}
+
 /* Table of the file types and subtypes we know about.
    Entries must be sorted by WTAP_FILE_TYPE_SUBTYPE_xxx values in ascending
    order.
@@ -2320,9 +2340,15 @@ gboolean
 wtap_dump(wtap_dumper *wdh, const struct wtap_pkthdr *phdr,
 	  const guint8 *pd, int *err, gchar **err_info)
 {
+	gint64 data_offset = wdh->bytes_dumped;
+
 	*err = 0;
 	*err_info = NULL;
-	return (wdh->subtype_write)(wdh, phdr, pd, err, err_info);
+	if (!(wdh->subtype_write)(wdh, phdr, pd, err, err_info))
+		return FALSE;
+	if (wdh->frame_index != NULL)
+		wtap_frame_index_add(wdh->frame_index, data_offset, phdr);
+	return TRUE;
 }
 
 void
@@ -2365,6 +2391,17 @@ wtap_dump_close(wtap_dumper *wdh, int *err)
 		/* as we don't close stdout, at least try to flush it */
 		wtap_dump_flush(wdh);
 	}
+	if (wdh->frame_index != NULL) {
+		int idx_err;
+
+		/* The index is only a shortcut; without it, readers just
+		   go through the whole file */
+		if (ret)
+			wtap_frame_index_write(wdh->frame_index,
+			    wdh->frame_index_for, &idx_err);
+		wtap_frame_index_free(wdh->frame_index);
+		g_free(wdh->frame_index_for);
+	}
 	if (wdh->priv != NULL)
 		g_free(wdh->priv);
 	g_free(wdh);
@@ -2393,6 +2430,31 @@ wtap_dump_set_addrinfo_list(wtap_dumper *wdh, addrinfo_lists_t *addrinfo_lists)
 	return TRUE;
 }
 
+gboolean
+wtap_dump_set_frame_index(wtap_dumper *wdh, const char *filename)
+{
+	/*
+	 * The readers of these formats hand wtap_seek_read() the offset
+	 * of the record header, which is where the writers start each
+	 * record.
+	 */
+	switch (wdh->file_type_subtype) {
+
+	case WTAP_FILE_TYPE_SUBTYPE_PCAP:
+	case WTAP_FILE_TYPE_SUBTYPE_PCAP_NSEC:
+	case WTAP_FILE_TYPE_SUBTYPE_PCAPNG:
+		break;
+
+	default:
+		return FALSE;
+	}
+	if (wdh->fh == stdout || wdh->frame_index != NULL)
+		return FALSE;
+	wdh->frame_index = wtap_frame_index_new(wdh->file_type_subtype);
+	wdh->frame_index_for = g_strdup(filename);
+	return TRUE;
+}
+
 /* internally open a file for writing (compressed or not) */
 #ifdef HAVE_LIBZ
 static WFILE_T
@@ -0,0 +1,500 @@
+/* file_set.c
+ * Reading a set of capture files, such as the files of a ring buffer,
+ * as one capture
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <wsutil/file_util.h>
+
+#include "wtap-int.h"
+#include "frame_index.h"
+
+/*
+ * The records of the set are handed out in time stamp order, and the
+ * offset of each is that of the record in its own file with the number
+ * of the file in the bits above SET_OFFSET_BITS, so that
+ * wtap_seek_read() can find it again.
+ */
+#define SET_OFFSET_BITS		47
+#define SET_OFFSET_MASK		((G_GINT64_CONSTANT(1) << SET_OFFSET_BITS) - 1)
+#define SET_MAX_FILES		65536
+
+/* Files kept open at once, apart from those being read sequentially */
+#define SET_MAX_OPEN		32
+
+typedef enum {
+	MEMBER_UNREAD,		/* not yet reached; next_ts is its first record's */
+	MEMBER_READING,		/* its next record has been read into its wth */
+	MEMBER_DONE		/* all its records have been handed out */
+} member_state_e;
+
+typedef struct {
+	gchar		*filename;
+	gint64		size;
+	wtap		*wth;		/* NULL if the file isn't open */
+	member_state_e	state;
+	nstime_t	next_ts;
+	gint64		next_offset;	/* of the record read, if READING */
+	guint64		last_used;	/* for picking which file to close */
+} set_member;
+
+typedef struct {
+	unsigned int	type;		/* for wtap_open_offline() */
+	guint		count;
+	set_member	*members;
+	guint		*heap;		/* members not DONE, earliest next_ts first */
+	guint		heap_len;
+	guint		n_open;
+	guint64		use_clock;
+	gint64		size;		/* of all the files */
+	gint64		bytes_done;	/* of the DONE files */
+	gchar		*comment;	/* of the last record handed out */
+	int		pending_err;	/* from reading ahead in a file */
+	gchar		*pending_err_info;
+} file_set_t;
+
+static gboolean
+member_before(const file_set_t *fs, guint a, guint b)
+{
+	int cmp = nstime_cmp(&fs->members[a].next_ts, &fs->members[b].next_ts);
+
+	/* Ties go to the file that comes first in the set */
+	return cmp < 0 || (cmp == 0 && a < b);
+}
+
+static void
+heap_sift_down(file_set_t *fs, guint i)
+{
+	guint child, tmp;
+
+	for (;;) {
+		child = 2 * i + 1;
+		if (child >= fs->heap_len)
+			break;
+		if (child + 1 < fs->heap_len &&
+		    member_before(fs, fs->heap[child + 1], fs->heap[child]))
+			child++;
+		if (!member_before(fs, fs->heap[child], fs->heap[i]))
+			break;
+		tmp = fs->heap[i];
+		fs->heap[i] = fs->heap[child];
+		fs->heap[child] = tmp;
+		i = child;
+	}
+}
+
+static void
+heap_pop(file_set_t *fs)
+{
+	fs->heap[0] = fs->heap[--fs->heap_len];
+	heap_sift_down(fs, 0);
+}
+
+/*
+ * Make room for one more open file by closing the one used least
+ * recently of those that aren't being read sequentially.
+ */
+static void
+set_close_one(file_set_t *fs)
+{
+	guint i, lru = fs->count;
+
+	for (i = 0; i < fs->count; i++) {
+		if (fs->members[i].wth == NULL ||
+		    fs->members[i].state == MEMBER_READING)
+			continue;
+		if (lru == fs->count ||
+		    fs->members[i].last_used < fs->members[lru].last_used)
+			lru = i;
+	}
+	if (lru == fs->count)
+		return;
+	wtap_close(fs->members[lru].wth);
+	fs->members[lru].wth = NULL;
+	fs->n_open--;
+}
+
+static gboolean
+set_member_open(file_set_t *fs, set_member *m, int *err, gchar **err_info)
+{
+	if (m->wth == NULL) {
+		if (fs->n_open >= SET_MAX_OPEN)
+			set_close_one(fs);
+		m->wth = wtap_open_offline(m->filename, fs->type, err, err_info,
+		    TRUE);
+		if (m->wth == NULL)
+			return FALSE;
+		fs->n_open++;
+		if (m->state == MEMBER_DONE)
+			wtap_sequential_close(m->wth);
+	}
+	m->last_used = ++fs->use_clock;
+	return TRUE;
+}
+
+/*
+ * Start reading the file at the top of the heap, which has got to the
+ * time stamp of its first record.
+ */
+static gboolean
+set_member_start(file_set_t *fs, int *err, gchar **err_info)
+{
+	set_member *m = &fs->members[fs->heap[0]];
+
+	if (!set_member_open(fs, m, err, err_info))
+		return FALSE;
+	if (!wtap_read(m->wth, err, err_info, &m->next_offset)) {
+		if (*err != 0)
+			return FALSE;
+		/* No records after all */
+		wtap_sequential_close(m->wth);
+		m->state = MEMBER_DONE;
+		fs->bytes_done += m->size;
+		heap_pop(fs);
+		return TRUE;
+	}
+	m->state = MEMBER_READING;
+	m->next_ts = m->wth->phdr.ts;
+	heap_sift_down(fs, 0);
+	return TRUE;
+}
+
+/* Make the record read from a file the set's current record */
+static void
+set_copy_record(file_set_t *fs, wtap *wth, wtap *member_wth)
+{
+	struct wtap_pkthdr *src = &member_wth->phdr;
+	Buffer ft_specific_data = wth->phdr.ft_specific_data;
+
+	g_free(fs->comment);
+	fs->comment = g_strdup(src->opt_comment);
+
+	wth->phdr = *src;
+	wth->phdr.opt_comment = fs->comment;
+	wth->phdr.ft_specific_data = ft_specific_data;
+	ws_buffer_clean(&wth->phdr.ft_specific_data);
+	ws_buffer_append_buffer(&wth->phdr.ft_specific_data,
+	    &src->ft_specific_data);
+
+	ws_buffer_assure_space(wth->frame_buffer, src->caplen);
+	memcpy(ws_buffer_start_ptr(wth->frame_buffer),
+	    ws_buffer_start_ptr(member_wth->frame_buffer), src->caplen);
+}
+
+static gboolean
+set_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
+{
+	file_set_t *fs = (file_set_t *)wth->priv;
+	set_member *m;
+	guint i;
+
+	if (fs->pending_err != 0) {
+		*err = fs->pending_err;
+		*err_info = fs->pending_err_info;
+		fs->pending_err = 0;
+		fs->pending_err_info = NULL;
+		return FALSE;
+	}
+
+	for (;;) {
+		if (fs->heap_len == 0)
+			return FALSE;
+		i = fs->heap[0];
+		m = &fs->members[i];
+		if (m->state == MEMBER_READING)
+			break;
+		if (!set_member_start(fs, err, err_info))
+			return FALSE;
+	}
+
+	if (m->next_offset < 0 || m->next_offset > SET_OFFSET_MASK) {
+		*err = WTAP_ERR_UNSUPPORTED;
+		*err_info = g_strdup_printf("file_set: %s is too large to be read as part of a set",
+		    m->filename);
+		return FALSE;
+	}
+	set_copy_record(fs, wth, m->wth);
+	*data_offset = ((gint64)i << SET_OFFSET_BITS) | m->next_offset;
+
+	/* Read ahead in that file, to find where it goes in the heap */
+	m->last_used = ++fs->use_clock;
+	if (wtap_read(m->wth, err, err_info, &m->next_offset)) {
+		m->next_ts = m->wth->phdr.ts;
+		heap_sift_down(fs, 0);
+	} else {
+		/* Report any error with the next record */
+		fs->pending_err = *err;
+		fs->pending_err_info = *err_info;
+		*err = 0;
+		*err_info = NULL;
+		wtap_sequential_close(m->wth);
+		m->state = MEMBER_DONE;
+		fs->bytes_done += m->size;
+		heap_pop(fs);
+	}
+	return TRUE;
+}
+
+static gboolean
+set_seek_read(wtap *wth, gint64 seek_off, struct wtap_pkthdr *phdr,
+    Buffer *buf, int *err, gchar **err_info)
+{
+	file_set_t *fs = (file_set_t *)wth->priv;
+	guint i = (guint)(seek_off >> SET_OFFSET_BITS);
+	set_member *m;
+
+	if (i >= fs->count) {
+		*err = WTAP_ERR_INTERNAL;
+		*err_info = g_strdup_printf("file_set: no file %u in the set", i);
+		return FALSE;
+	}
+	m = &fs->members[i];
+	if (!set_member_open(fs, m, err, err_info))
+		return FALSE;
+	phdr->pkt_encap = m->wth->file_encap;
+	phdr->pkt_tsprec = m->wth->file_tsprec;
+	return wtap_seek_read(m->wth, seek_off & SET_OFFSET_MASK, phdr, buf,
+	    err, err_info);
+}
+
+static gint64
+set_file_size(wtap *wth, int *err _U_)
+{
+	return ((file_set_t *)wth->priv)->size;
+}
+
+static gint64
+set_read_so_far(wtap *wth)
+{
+	file_set_t *fs = (file_set_t *)wth->priv;
+	gint64 so_far = fs->bytes_done;
+	guint i;
+
+	/* Only the files whose records overlap are being read at once,
+	   so there are only ever a few of these. */
+	for (i = 0; i < fs->heap_len; i++) {
+		if (fs->members[fs->heap[i]].state == MEMBER_READING)
+			so_far += wtap_read_so_far(fs->members[fs->heap[i]].wth);
+	}
+	return so_far;
+}
+
+static void
+set_close(wtap *wth)
+{
+	file_set_t *fs = (file_set_t *)wth->priv;
+	guint i;
+
+	for (i = 0; i < fs->count; i++) {
+		if (fs->members[i].wth != NULL)
+			wtap_close(fs->members[i].wth);
+		g_free(fs->members[i].filename);
+	}
+	g_free(fs->members);
+	g_free(fs->heap);
+	g_free(fs->comment);
+	g_free(fs->pending_err_info);
+	/* wtap_close() frees fs itself */
+}
+
+/* Take the set's file-wide information from its first file */
+static void
+set_copy_file_info(wtap *wth, wtap *first)
+{
+	wtapng_if_descr_t descr;
+	guint i;
+
+	wth->file_type_subtype = first->file_type_subtype;
+	wth->file_encap = first->file_encap;
+	wth->file_tsprec = first->file_tsprec;
+	wth->snapshot_length = first->snapshot_length;
+
+	wth->shb_hdr.section_length = -1;
+	wth->shb_hdr.opt_comment = g_strdup(first->shb_hdr.opt_comment);
+	wth->shb_hdr.shb_hardware = g_strdup(first->shb_hdr.shb_hardware);
+	wth->shb_hdr.shb_os = g_strdup(first->shb_hdr.shb_os);
+	wth->shb_hdr.shb_user_appl = g_strdup(first->shb_hdr.shb_user_appl);
+
+	/* The files of a set were written by one capture, with the same
+	   interfaces in the same order; the statistics are left out, as
+	   they'd be those of the first file only. */
+	for (i = 0; i < first->interface_data->len; i++) {
+		descr = g_array_index(first->interface_data, wtapng_if_descr_t, i);
+		descr.opt_comment = g_strdup(descr.opt_comment);
+		descr.if_name = g_strdup(descr.if_name);
+		descr.if_description = g_strdup(descr.if_description);
+		descr.if_filter_str = g_strdup(descr.if_filter_str);
+		descr.if_filter_bpf_bytes = (gchar *)g_memdup(descr.if_filter_bpf_bytes,
+		    descr.bpf_filter_len);
+		descr.if_os = g_strdup(descr.if_os);
+		descr.num_stat_entries = 0;
+		descr.interface_statistics = NULL;
+		g_array_append_val(wth->interface_data, descr);
+	}
+}
+
+/*
+ * Find the time stamp of the first record of a file other than the
+ * first, from its frame index if it has one, so that it needn't be
+ * opened until the set gets to it, or else by reading that record.
+ */
+static gboolean
+set_member_peek(file_set_t *fs, wtap *wth, set_member *m, int *err,
+    gchar **err_info)
+{
+	wtap_frame_index *fidx;
+	wtap *member_wth;
+	gint64 data_offset;
+	gboolean have_record;
+
+	fidx = wtap_frame_index_open(m->filename, wth->file_type_subtype);
+	if (fidx != NULL) {
+		have_record = wtap_frame_index_get(fidx, 1, NULL, &m->next_ts,
+		    NULL, NULL);
+		wtap_frame_index_free(fidx);
+		m->state = have_record ? MEMBER_UNREAD : MEMBER_DONE;
+		return TRUE;
+	}
+
+	member_wth = wtap_open_offline(m->filename, fs->type, err, err_info,
+	    FALSE);
+	if (member_wth == NULL)
+		return FALSE;
+	have_record = wtap_read(member_wth, err, err_info, &data_offset);
+	if (have_record) {
+		m->next_ts = member_wth->phdr.ts;
+		m->state = MEMBER_UNREAD;
+	} else {
+		m->state = MEMBER_DONE;
+	}
+	if (member_wth->file_encap != wth->file_encap)
+		wth->file_encap = WTAP_ENCAP_PER_PACKET;
+	if (member_wth->snapshot_length > wth->snapshot_length)
+		wth->snapshot_length = member_wth->snapshot_length;
+	wtap_close(member_wth);
+	return have_record || *err == 0;
+}
+
+wtap *
+wtap_open_offline_set(guint count, const char *const *filenames,
+    unsigned int type, int *err, gchar **err_info, guint *err_fileno)
+{
+	wtap *wth;
+	file_set_t *fs;
+	set_member *m;
+	ws_statb64 statb;
+	guint i;
+
+	*err = 0;
+	*err_info = NULL;
+	*err_fileno = 0;
+	if (count == 0 || count > SET_MAX_FILES) {
+		*err = WTAP_ERR_UNSUPPORTED;
+		*err_info = g_strdup_printf("file_set: a set must have between 1 and %u files",
+		    SET_MAX_FILES);
+		return NULL;
+	}
+
+	wth = (wtap *)g_malloc0(sizeof(wtap));
+	wth->interface_data = g_array_new(FALSE, FALSE, sizeof(wtapng_if_descr_t));
+	fs = g_new0(file_set_t, 1);
+	fs->type = type;
+	fs->count = count;
+	fs->members = g_new0(set_member, count);
+	fs->heap = g_new(guint, count);
+	for (i = 0; i < count; i++)
+		fs->members[i].filename = g_strdup(filenames[i]);
+	wth->priv = fs;
+	wth->subtype_read = set_read;
+	wth->subtype_seek_read = set_seek_read;
+	wth->subtype_close = set_close;
+	wth->subtype_file_size = set_file_size;
+	wth->subtype_read_so_far = set_read_so_far;
+
+	for (i = 0; i < count; i++) {
+		m = &fs->members[i];
+		*err_fileno = i;
+		if (ws_stat64(m->filename, &statb) == -1) {
+			*err = errno;
+			goto fail;
+		}
+		m->size = statb.st_size;
+		fs->size += m->size;
+
+		if (i == 0) {
+			/* This one decides what the set looks like; it's
+			   read from the start straight away. */
+			if (!set_member_open(fs, m, err, err_info))
+				goto fail;
+			set_copy_file_info(wth, m->wth);
+			m->state = MEMBER_UNREAD;
+			nstime_set_zero(&m->next_ts);
+			fs->heap[fs->heap_len++] = i;
+			if (!set_member_start(fs, err, err_info))
+				goto fail;
+			continue;
+		}
+
+		if (!set_member_peek(fs, wth, m, err, err_info))
+			goto fail;
+		if (m->state == MEMBER_DONE) {
+			fs->bytes_done += m->size;
+		} else {
+			/* Sift it up */
+			guint j = fs->heap_len++, parent;
+
+			fs->heap[j] = i;
+			while (j > 0) {
+				parent = (j - 1) / 2;
+				if (!member_before(fs, fs->heap[j], fs->heap[parent]))
+					break;
+				fs->heap[j] = fs->heap[parent];
+				fs->heap[parent] = i;
+				j = parent;
+			}
+		}
+	}
+
+	wth->frame_buffer = (struct Buffer *)g_malloc(sizeof(struct Buffer));
+	ws_buffer_init(wth->frame_buffer, 1500);
+	return wth;
+
+fail:
+	wtap_close(wth);
+	return NULL;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -59,9 +59,21 @@
 #include <zlib.h>
 #endif /* HAVE_LIBZ */
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif /* HAVE_ZSTD */
+
+#ifdef HAVE_LZ4
+#include <lz4frame.h>
+#endif /* HAVE_LZ4 */
+
 /*
  * See RFC 1952 for a description of the gzip file format.
  *
+ * See RFC 8878 for a description of the Zstandard format, and
+ * https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md for a
+ * description of the LZ4 frame format.
+ *
  * Some other compressed file formats we might want to support:
  *
  *      XZ format: http://tukaani.org/xz/
@@ -78,6 +90,12 @@
 static const char *compressed_file_extensions[] = {
 #ifdef HAVE_LIBZ
     "gz",
+#endif
+#ifdef HAVE_ZSTD
+    "zst",
+#endif
+#ifdef HAVE_LZ4
+    "lz4",
 #endif
     NULL
 };
@@ -103,14 +121,46 @@ wtap_get_compressed_file_extensions(void)
 /* #define GZBUFSIZE 8192 */
 #define GZBUFSIZE 4096
 
-/* values for wtap_reader compression */
+/*
+ * Uncompressed data in a memory-mapped file is handed out straight from
+ * the mapping, this much at a time, rather than being copied into the
+ * output buffer; the chunking just keeps file_tell_raw() meaningful for
+ * progress reporting.
+ */
+#define MAPPED_CHUNK_SIZE       (1024*1024)
+
+#ifndef S_ISREG
+#define S_ISREG(mode)   (((mode) & S_IFMT) == S_IFREG)
+#endif
+
+/*
+ * Don't map files bigger than this if we have a 32-bit address space;
+ * we'd rather not use up the address space the rest of the program
+ * needs.
+ */
+#define MAX_MAPPED_SIZE_32BIT   G_GINT64_CONSTANT(268435456)
+
+/*
+ * values for wtap_reader compression
+ *
+ * These are written to fast seek sidecar files (see file_fast_seek_save()),
+ * so each one has a fixed value that doesn't depend on which libraries
+ * this build has; don't renumber them.
+ */
 typedef enum {
-    UNKNOWN,       /* unknown - look for a gzip header */
-    UNCOMPRESSED,  /* uncompressed - copy input directly */
+    UNKNOWN = 0,            /* unknown - look for a gzip header */
+    UNCOMPRESSED = 1,       /* uncompressed - copy input directly */
 #ifdef HAVE_LIBZ
-    ZLIB,          /* decompress a zlib stream */
-    GZIP_AFTER_HEADER
+    ZLIB = 2,               /* decompress a zlib stream */
+    GZIP_AFTER_HEADER = 3,
+#endif
+#ifdef HAVE_ZSTD
+    ZSTD = 4,               /* decompress a Zstandard stream */
+#endif
+#ifdef HAVE_LZ4
+    LZ4 = 5,                /* decompress an LZ4 frame stream */
 #endif
+    COMPRESSION_END = 6
 } compression_t;
 
 struct wtap_reader {
@@ -141,18 +191,70 @@ struct wtap_reader {
     /* zlib inflate stream */
     z_stream strm;             /* stream structure in-place (not a pointer) */
     gboolean dont_check_crc;   /* TRUE if we aren't supposed to check the CRC */
+#endif
+#ifdef HAVE_ZSTD
+    ZSTD_DStream *zstd;        /* Zstandard stream, once we've seen one */
+#endif
+#ifdef HAVE_LZ4
+    LZ4F_dctx *lz4;            /* LZ4 frame decompression context, once we've seen one */
+#endif
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+    gboolean in_frame;         /* TRUE if we're in the middle of a Zstandard or LZ4 frame */
 #endif
     /* fast seeking */
     GPtrArray *fast_seek;
     void *fast_seek_cur;
+    /* memory-mapped file, if any */
+    GMappedFile *mapped;       /* mapping of the file, or NULL */
+    const unsigned char *map_data; /* start of the mapped data */
+    gint64 map_len;            /* length of the mapped data */
+    gboolean out_mapped;       /* TRUE if next points into the mapping rather than out */
+    gboolean no_map;           /* TRUE if it mustn't be mapped, e.g. because it's still being written */
 };
 
+/*
+ * Set the position of the next raw read.  If the file is mapped, reads
+ * within the mapping don't use the file descriptor, and raw_read()
+ * positions it itself before reading past the end of the mapping.
+ */
+static int
+raw_seek(FILE_T state, gint64 offset)
+{
+    if (state->mapped == NULL) {
+        if (ws_lseek64(state->fd, offset, SEEK_SET) == -1)
+            return -1;
+    }
+    state->raw_pos = offset;
+    return 0;
+}
+
 static int     /* gz_load */
 raw_read(FILE_T state, unsigned char *buf, unsigned int count, guint *have)
 {
     ssize_t ret;
 
     *have = 0;
+    if (state->mapped != NULL) {
+        if (state->raw_pos < state->map_len) {
+            /* Copy from the mapping rather than reading. */
+            *have = (gint64)count < state->map_len - state->raw_pos ?
+                count : (unsigned)(state->map_len - state->raw_pos);
+            memcpy(buf, state->map_data + state->raw_pos, *have);
+            state->raw_pos += *have;
+            if (*have == count)
+                return 0;
+        }
+
+        /*
+         * We've run off the end of the mapping; the file may have
+         * grown since we mapped it, so read the rest.
+         */
+        if (ws_lseek64(state->fd, state->raw_pos, SEEK_SET) == -1) {
+            state->err = errno;
+            state->err_info = NULL;
+            return -1;
+        }
+    }
     do {
         ret = read(state->fd, buf + *have, count - *have);
         if (ret <= 0)
@@ -170,6 +272,27 @@ raw_read(FILE_T state, unsigned char *buf, unsigned int count, guint *have)
     return 0;
 }
 
+/*
+ * Hand out the next chunk of uncompressed data straight from the
+ * mapping.  Returns FALSE if we're past the end of the mapping, in
+ * which case the caller should read the data instead.
+ */
+static gboolean
+mapped_fill_out_buffer(FILE_T state)
+{
+    gint64 left;
+
+    if (state->mapped == NULL || state->raw_pos >= state->map_len)
+        return FALSE;
+
+    left = state->map_len - state->raw_pos;
+    state->have = left > MAPPED_CHUNK_SIZE ? MAPPED_CHUNK_SIZE : (guint)left;
+    state->next = (unsigned char *)state->map_data + state->raw_pos;
+    state->out_mapped = TRUE;
+    state->raw_pos += state->have;
+    return TRUE;
+}
+
 static int /* gz_avail */
 fill_in_buffer(FILE_T state)
 {
@@ -574,6 +697,174 @@ zlib_read(FILE_T state, unsigned char *buf, unsigned int count)
 }
 #endif
 
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+/*
+ * Zstandard and LZ4 frames can each be decompressed without anything
+ * from the frames before them, so the start of each frame is a fast seek
+ * point; unlike zlib seek points, they don't need an inflate window.
+ */
+static void
+frame_fast_seek_add(FILE_T state, compression_t compression, gint64 in_pos,
+                    gint64 out_pos)
+{
+    struct fast_seek_point *item;
+
+    /* it's for sure after the first frame header, so state->fast_seek->len != 0 */
+    item = (struct fast_seek_point *)state->fast_seek->pdata[state->fast_seek->len - 1];
+    if (item->out + SPAN < out_pos) {
+        struct fast_seek_point *val = g_new(struct fast_seek_point,1);
+
+        val->in = in_pos;
+        val->out = out_pos;
+        val->compression = compression;
+        g_ptr_array_add(state->fast_seek, val);
+    }
+}
+#endif
+
+#ifdef HAVE_ZSTD
+static void
+zstd_read(FILE_T state, unsigned char *buf, unsigned int count)
+{
+    ZSTD_outBuffer output;
+    ZSTD_inBuffer input;
+    size_t ret;
+
+    output.dst = buf;
+    output.size = count;
+    output.pos = 0;
+
+    /* fill output buffer up to end of input or error */
+    while (output.pos < output.size) {
+        /* get more input */
+        if (state->avail_in == 0 && fill_in_buffer(state) == -1)
+            break;
+        if (state->avail_in == 0) {
+            if (state->in_frame) {
+                /* EOF in the middle of a frame */
+                state->err = WTAP_ERR_SHORT_READ;
+                state->err_info = NULL;
+            }
+            break;
+        }
+
+        input.src = state->next_in;
+        input.size = state->avail_in;
+        input.pos = 0;
+        ret = ZSTD_decompressStream(state->zstd, &output, &input);
+        state->next_in += input.pos;
+        state->avail_in -= (guint)input.pos;
+        if (ZSTD_isError(ret)) {
+            state->err = WTAP_ERR_DECOMPRESS;
+            state->err_info = ZSTD_getErrorName(ret);
+            break;
+        }
+        state->in_frame = (ret != 0);
+        if (ret == 0 && state->fast_seek) {
+            /* end of a frame; the next one starts here */
+            frame_fast_seek_add(state, ZSTD, state->raw_pos - state->avail_in,
+                                state->pos + (gint64)output.pos);
+        }
+    }
+
+    state->next = buf;
+    state->have = (guint)output.pos;
+}
+#endif
+
+#ifdef HAVE_LZ4
+static void
+lz4_read(FILE_T state, unsigned char *buf, unsigned int count)
+{
+    size_t out_len, in_len, ret;
+    guint have = 0;
+
+    /* fill output buffer up to end of input or error */
+    while (have < count) {
+        /* get more input */
+        if (state->avail_in == 0 && fill_in_buffer(state) == -1)
+            break;
+        if (state->avail_in == 0) {
+            if (state->in_frame) {
+                /* EOF in the middle of a frame */
+                state->err = WTAP_ERR_SHORT_READ;
+                state->err_info = NULL;
+            }
+            break;
+        }
+
+        out_len = count - have;
+        in_len = state->avail_in;
+        ret = LZ4F_decompress(state->lz4, buf + have, &out_len,
+                              state->next_in, &in_len, NULL);
+        state->next_in += in_len;
+        state->avail_in -= (guint)in_len;
+        have += (guint)out_len;
+        if (LZ4F_isError(ret)) {
+            state->err = WTAP_ERR_DECOMPRESS;
+            state->err_info = LZ4F_getErrorName(ret);
+            break;
+        }
+        state->in_frame = (ret != 0);
+        if (ret == 0 && state->fast_seek) {
+            /* end of a frame; the next one starts here */
+            frame_fast_seek_add(state, LZ4, state->raw_pos - state->avail_in,
+                                state->pos + have);
+        }
+    }
+
+    state->next = buf;
+    state->have = have;
+}
+#endif
+
+/*
+ * Get a Zstandard or LZ4 decompressor ready to start on a new frame,
+ * creating it if we haven't needed one before.  Returns -1, with
+ * state->err set, if we run out of memory.
+ */
+static int
+frame_decomp_reset(FILE_T state, compression_t compression)
+{
+    switch (compression) {
+
+#ifdef HAVE_ZSTD
+    case ZSTD:
+        if (state->zstd == NULL)
+            state->zstd = ZSTD_createDStream();
+        if (state->zstd == NULL || ZSTD_isError(ZSTD_initDStream(state->zstd))) {
+            state->err = ENOMEM;
+            state->err_info = NULL;
+            return -1;
+        }
+        break;
+#endif
+
+#ifdef HAVE_LZ4
+    case LZ4:
+        /* Older versions of liblz4 don't have LZ4F_resetDecompressionContext() */
+        if (state->lz4 != NULL) {
+            LZ4F_freeDecompressionContext(state->lz4);
+            state->lz4 = NULL;
+        }
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&state->lz4, LZ4F_VERSION))) {
+            state->lz4 = NULL;
+            state->err = ENOMEM;
+            state->err_info = NULL;
+            return -1;
+        }
+        break;
+#endif
+
+    default:
+        break;
+    }
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+    state->in_frame = FALSE;
+#endif
+    return 0;
+}
+
 static int
 gz_head(FILE_T state)
 {
@@ -687,6 +978,35 @@ gz_head(FILE_T state)
 #ifdef HAVE_LIBXZ
     /* { 0xFD, '7', 'z', 'X', 'Z', 0x00 } */
     /* FD 37 7A 58 5A 00 */
+#endif
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+    /*
+     * Zstandard and LZ4 frames start with a 4-byte little-endian magic
+     * number; leave it in the input, as the decompressors want to see it.
+     */
+    if (state->have == 0 && state->avail_in >= 4) {
+        compression_t compression = UNKNOWN;
+
+#ifdef HAVE_ZSTD
+        /* 28 B5 2F FD */
+        if (memcmp(state->next_in, "\x28\xb5\x2f\xfd", 4) == 0)
+            compression = ZSTD;
+#endif
+#ifdef HAVE_LZ4
+        /* 04 22 4D 18 */
+        if (memcmp(state->next_in, "\x04\x22\x4d\x18", 4) == 0)
+            compression = LZ4;
+#endif
+        if (compression != UNKNOWN) {
+            if (frame_decomp_reset(state, compression) == -1)
+                return -1;
+            state->compression = compression;
+            state->is_compressed = TRUE;
+            if (state->fast_seek)
+                fast_seek_header(state, state->raw_pos - state->avail_in, state->pos, compression);
+            return 0;
+        }
+    }
 #endif
     if (state->fast_seek)
         fast_seek_header(state, state->raw_pos - state->avail_in - state->have, state->pos, UNCOMPRESSED);
@@ -696,6 +1016,7 @@ gz_head(FILE_T state)
        the input buffer, which also assures space for gzungetc() */
     state->raw = state->pos;
     state->next = state->out;
+    state->out_mapped = FALSE;
     if (state->avail_in) {
         memcpy(state->next + state->have, state->next_in, state->avail_in);
         state->have += state->avail_in;
@@ -715,13 +1036,29 @@ fill_out_buffer(FILE_T state)
             return 0;
     }
     if (state->compression == UNCOMPRESSED) {           /* straight copy */
+        if (mapped_fill_out_buffer(state))
+            return 0;
         if (raw_read(state, state->out, state->size /* << 1 */, &(state->have)) == -1)
             return -1;
         state->next = state->out;
+        state->out_mapped = FALSE;
     }
 #ifdef HAVE_LIBZ
     else if (state->compression == ZLIB) {      /* decompress */
         zlib_read(state, state->out, state->size << 1);
+        state->out_mapped = FALSE;
+    }
+#endif
+#ifdef HAVE_ZSTD
+    else if (state->compression == ZSTD) {
+        zstd_read(state, state->out, state->size << 1);
+        state->out_mapped = FALSE;
+    }
+#endif
+#ifdef HAVE_LZ4
+    else if (state->compression == LZ4) {
+        lz4_read(state, state->out, state->size << 1);
+        state->out_mapped = FALSE;
     }
 #endif
     return 0;
@@ -775,6 +1112,7 @@ gz_reset(FILE_T state)
     state->err_info = NULL;
     state->pos = 0;               /* no uncompressed data yet */
     state->avail_in = 0;          /* no input data yet */
+    state->out_mapped = FALSE;
 }
 
 FILE_T
@@ -796,6 +1134,10 @@ file_fdopen(int fd)
 
     state->fast_seek_cur = NULL;
     state->fast_seek = NULL;
+    state->mapped = NULL;
+    state->map_data = NULL;
+    state->map_len = 0;
+    state->no_map = FALSE;
 
     /* open the file with the appropriate mode (or just use fd) */
     state->fd = fd;
@@ -855,11 +1197,90 @@ file_fdopen(int fd)
 
     /* for now, assume we should check the crc */
     state->dont_check_crc = FALSE;
+#endif
+#ifdef HAVE_ZSTD
+    state->zstd = NULL;
+#endif
+#ifdef HAVE_LZ4
+    state->lz4 = NULL;
 #endif
     /* return stream */
     return state;
 }
 
+/*
+ * Map a file we're reading, so that we can read it without system calls
+ * and hand out uncompressed data without copying it.  If it can't be
+ * mapped, or isn't worth mapping, we just read it.
+ *
+ * The mapping is made from the descriptor we already have open, so that
+ * it's of the same file even if the name now refers to another one.
+ *
+ * Touching a page of the mapping that's past the end of the file, because
+ * the file was truncated after we mapped it, gets us a SIGBUS rather than
+ * the short read() we'd otherwise get.  A finished capture file isn't
+ * expected to shrink, but files that are still being written, by a live
+ * capture or a ring buffer, are never mapped; see file_set_no_map().
+ */
+static void
+file_map(FILE_T state)
+{
+#if GLIB_CHECK_VERSION(2,32,0)
+    GMappedFile *mapped;
+    ws_statb64 st;
+
+    if (state->no_map)
+        return;
+    if (ws_fstat64(state->fd, &st) == -1 || !S_ISREG(st.st_mode))
+        return;
+    if (st.st_size == 0) {
+        /* Probably a capture file that's just being started */
+        return;
+    }
+    if (sizeof (void *) < 8 && st.st_size > MAX_MAPPED_SIZE_32BIT)
+        return;
+
+    mapped = g_mapped_file_new_from_fd(state->fd, FALSE, NULL);
+    if (mapped == NULL)
+        return;
+    if (g_mapped_file_get_length(mapped) == 0) {
+        g_mapped_file_unref(mapped);
+        return;
+    }
+    state->mapped = mapped;
+    state->map_data = (const unsigned char *)g_mapped_file_get_contents(mapped);
+    state->map_len = (gint64)g_mapped_file_get_length(mapped);
+#else
+    /* We can only map a file by name, which might not be the one we have open */
+    (void)state;
+#endif
+}
+
+static void
+file_unmap(FILE_T state)
+{
+    if (state->mapped == NULL)
+        return;
+
+    if (state->out_mapped) {
+        /*
+         * Give back what we haven't delivered from the mapping; it'll
+         * be read again, from wherever we get it next.
+         */
+        state->raw_pos -= state->have;
+        state->have = 0;
+        state->out_mapped = FALSE;
+    }
+#if GLIB_CHECK_VERSION(2,22,0)
+    g_mapped_file_unref(state->mapped);
+#else
+    g_mapped_file_free(state->mapped);
+#endif
+    state->mapped = NULL;
+    state->map_data = NULL;
+    state->map_len = 0;
+}
+
 FILE_T
 file_open(const char *path)
 {
@@ -888,6 +1309,9 @@ file_open(const char *path)
         return NULL;
     }
 
+    /* It's a file we opened ourselves, so it might be worth mapping */
+    file_map(ft);
+
 #ifdef HAVE_LIBZ
     /*
      * If this file's name ends in ".caz", it's probably a compressed
@@ -918,6 +1342,211 @@ file_set_random_access(FILE_T stream, gboolean random_flag _U_, GPtrArray *seek)
     stream->fast_seek = seek;
 }
 
+/*
+ * The fast seek points for a compressed file can be saved in a sidecar
+ * file next to it, so that the next time it's opened, random access doesn't
+ * have to wait for a sequential pass through the whole file.
+ *
+ * The sidecar is a header followed by one entry per seek point, each
+ * followed by the 32K inflate window if it's a zlib seek point.  All
+ * fields are little-endian, and the compression field is a compression_t.
+ *
+ * Version 1 stored compression_t values whose numbering depended on the
+ * libraries the writer was built with, so those files are ignored.
+ */
+#define FAST_SEEK_SUFFIX        ".wsgzidx"
+#define FAST_SEEK_MAGIC         "WSGZIDX\n"
+#define FAST_SEEK_VERSION       2
+
+struct fast_seek_file_hdr {
+    guint8  magic[8];
+    guint32 version;
+    guint32 count;          /* number of seek points */
+    guint64 file_size;      /* size of the compressed file */
+    gint64  file_mtime;     /* modification time of the compressed file */
+};
+
+struct fast_seek_file_entry {
+    gint64  out;
+    gint64  in;
+    guint32 compression;
+    guint32 bits;
+    guint32 adler;
+    guint32 total_out;
+};
+
+gboolean
+file_fast_seek_save(GPtrArray *fast_seek, const char *path, int *err)
+{
+    ws_statb64 st;
+    struct fast_seek_file_hdr hdr;
+    struct fast_seek_file_entry entry;
+    struct fast_seek_point *item;
+    gchar *idx_path;
+    FILE *fp;
+    guint i;
+    gboolean ok = TRUE;
+
+    if (ws_stat64(path, &st) == -1) {
+        *err = errno;
+        return FALSE;
+    }
+
+    memset(&hdr, 0, sizeof hdr);
+    memcpy(hdr.magic, FAST_SEEK_MAGIC, sizeof hdr.magic);
+    hdr.version = GUINT32_TO_LE(FAST_SEEK_VERSION);
+    hdr.count = GUINT32_TO_LE(fast_seek->len);
+    hdr.file_size = GUINT64_TO_LE((guint64)st.st_size);
+    hdr.file_mtime = GINT64_TO_LE((gint64)st.st_mtime);
+
+    idx_path = g_strconcat(path, FAST_SEEK_SUFFIX, NULL);
+    fp = ws_fopen(idx_path, "wb");
+    if (fp == NULL) {
+        *err = errno;
+        g_free(idx_path);
+        return FALSE;
+    }
+
+    if (fwrite(&hdr, sizeof hdr, 1, fp) != 1)
+        ok = FALSE;
+    for (i = 0; ok && i < fast_seek->len; i++) {
+        item = (struct fast_seek_point *)fast_seek->pdata[i];
+
+        memset(&entry, 0, sizeof entry);
+        entry.out = GINT64_TO_LE(item->out);
+        entry.in = GINT64_TO_LE(item->in);
+        entry.compression = GUINT32_TO_LE((guint32)item->compression);
+#ifdef HAVE_LIBZ
+        if (item->compression == ZLIB) {
+#ifdef HAVE_INFLATEPRIME
+            entry.bits = GUINT32_TO_LE((guint32)item->data.zlib.bits);
+#endif
+            entry.adler = GUINT32_TO_LE(item->data.zlib.adler);
+            entry.total_out = GUINT32_TO_LE(item->data.zlib.total_out);
+        }
+#endif
+        if (fwrite(&entry, sizeof entry, 1, fp) != 1)
+            ok = FALSE;
+#ifdef HAVE_LIBZ
+        else if (item->compression == ZLIB &&
+                 fwrite(item->data.zlib.window, ZLIB_WINSIZE, 1, fp) != 1)
+            ok = FALSE;
+#endif
+    }
+    if (!ok)
+        *err = errno;
+    if (fclose(fp) == EOF && ok) {
+        *err = errno;
+        ok = FALSE;
+    }
+    if (!ok)
+        ws_unlink(idx_path);
+    g_free(idx_path);
+    return ok;
+}
+
+gboolean
+file_fast_seek_load(GPtrArray *fast_seek, const char *path)
+{
+    ws_statb64 st;
+    struct fast_seek_file_hdr hdr;
+    struct fast_seek_file_entry entry;
+    struct fast_seek_point *item;
+    gchar *idx_path;
+    FILE *fp;
+    guint32 i, count;
+
+    g_assert(fast_seek->len == 0);
+
+    if (ws_stat64(path, &st) == -1)
+        return FALSE;
+
+    idx_path = g_strconcat(path, FAST_SEEK_SUFFIX, NULL);
+    fp = ws_fopen(idx_path, "rb");
+    g_free(idx_path);
+    if (fp == NULL)
+        return FALSE;
+
+    if (fread(&hdr, sizeof hdr, 1, fp) != 1 ||
+        memcmp(hdr.magic, FAST_SEEK_MAGIC, sizeof hdr.magic) != 0 ||
+        GUINT32_FROM_LE(hdr.version) != FAST_SEEK_VERSION ||
+        GUINT64_FROM_LE(hdr.file_size) != (guint64)st.st_size ||
+        GINT64_FROM_LE(hdr.file_mtime) != (gint64)st.st_mtime) {
+        /* Not ours, or it's for an older version of the file */
+        fclose(fp);
+        return FALSE;
+    }
+
+    count = GUINT32_FROM_LE(hdr.count);
+    for (i = 0; i < count; i++) {
+        if (fread(&entry, sizeof entry, 1, fp) != 1)
+            goto fail;
+
+        item = g_new(struct fast_seek_point, 1);
+        g_ptr_array_add(fast_seek, item);
+        item->out = GINT64_FROM_LE(entry.out);
+        item->in = GINT64_FROM_LE(entry.in);
+        switch (GUINT32_FROM_LE(entry.compression)) {
+
+        case UNCOMPRESSED:
+            item->compression = UNCOMPRESSED;
+            break;
+
+#ifdef HAVE_LIBZ
+        case GZIP_AFTER_HEADER:
+            item->compression = GZIP_AFTER_HEADER;
+            break;
+
+        case ZLIB:
+            item->compression = ZLIB;
+#ifdef HAVE_INFLATEPRIME
+            item->data.zlib.bits = (int)GUINT32_FROM_LE(entry.bits);
+#else
+            if (entry.bits != 0) {
+                /* We can't use this point without inflatePrime() */
+                goto fail;
+            }
+#endif
+            item->data.zlib.adler = GUINT32_FROM_LE(entry.adler);
+            item->data.zlib.total_out = GUINT32_FROM_LE(entry.total_out);
+            if (fread(item->data.zlib.window, ZLIB_WINSIZE, 1, fp) != 1)
+                goto fail;
+            break;
+#endif
+
+#ifdef HAVE_ZSTD
+        case ZSTD:
+            item->compression = ZSTD;
+            break;
+#endif
+
+#ifdef HAVE_LZ4
+        case LZ4:
+            item->compression = LZ4;
+            break;
+#endif
+
+        default:
+            /* A compression type we don't support */
+            goto fail;
+        }
+
+        /* fast_seek_find() relies on the points being in order */
+        if (i != 0 &&
+            item->out <= ((struct fast_seek_point *)fast_seek->pdata[i - 1])->out)
+            goto fail;
+    }
+    fclose(fp);
+    return TRUE;
+
+fail:
+    for (i = 0; i < fast_seek->len; i++)
+        g_free(fast_seek->pdata[i]);
+    g_ptr_array_set_size(fast_seek, 0);
+    fclose(fp);
+    return FALSE;
+}
+
 gint64
 file_seek(FILE_T file, gint64 offset, int whence, int *err)
 {
@@ -952,7 +1581,7 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
     /*
      * Are we seeking backwards and, if so, do we have data in the buffer?
      */
-    if (offset < 0 && file->next) {
+    if (offset < 0 && file->next && !file->out_mapped) {
         /*
          * Yes.
          *
@@ -1017,18 +1646,22 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
             off2 = here->out;
         } else
 #endif
+        if (here->compression != UNCOMPRESSED) {
+            /* Start of a Zstandard or LZ4 frame */
+            off = here->in;
+            off2 = here->out;
+        } else
         {
             off2 = (file->pos + offset);
             off = here->in + (off2 - here->out);
         }
 
-        if (ws_lseek64(file->fd, off, SEEK_SET) == -1) {
+        if (raw_seek(file, off) == -1) {
             *err = errno;
             return -1;
         }
         fast_seek_reset(file);
 
-        file->raw_pos = off;
         file->have = 0;
         file->eof = FALSE;
         file->seek_pending = FALSE;
@@ -1069,7 +1702,14 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
             file->compression = ZLIB;
         } else
 #endif
+        {
+            /* A Zstandard or LZ4 frame starts afresh */
+            if (frame_decomp_reset(file, here->compression) == -1) {
+                *err = file->err;
+                return -1;
+            }
             file->compression = here->compression;
+        }
 
         offset = (file->pos + offset) - off2;
         file->pos = off2;
@@ -1090,20 +1730,19 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
      *
      * Again, note that this will never be true on a pipe, as
      * file_set_random_access() should never be called if we're
-     * reading from a pipe.
+     * reading from a pipe, and pipes are never mapped.
      */
     if (file->compression == UNCOMPRESSED && file->pos + offset >= file->raw
         && (offset < 0 || offset >= file->have)
-        && (file->fast_seek))
+        && (file->fast_seek || file->mapped != NULL))
     {
         /*
          * Yes.  Just seek there within the file.
          */
-        if (ws_lseek64(file->fd, offset - file->have, SEEK_CUR) == -1) {
+        if (raw_seek(file, file->raw_pos + (offset - file->have)) == -1) {
             *err = errno;
             return -1;
         }
-        file->raw_pos += (offset - file->have);
         file->have = 0;
         file->eof = FALSE;
         file->seek_pending = FALSE;
@@ -1131,12 +1770,11 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
         /* rewind, then skip to offset */
 
         /* back up and start over */
-        if (ws_lseek64(file->fd, file->start, SEEK_SET) == -1) {
+        if (raw_seek(file, file->start) == -1) {
             *err = errno;
             return -1;
         }
         fast_seek_reset(file);
-        file->raw_pos = file->start;
         gz_reset(file);
     }
 
@@ -1435,10 +2073,19 @@ file_clearerr(FILE_T stream)
 void
 file_fdclose(FILE_T file)
 {
+    /* The mapping would keep the file open, too. */
+    file_unmap(file);
     ws_close(file->fd);
     file->fd = -1;
 }
 
+void
+file_set_no_map(FILE_T file)
+{
+    file->no_map = TRUE;
+    file_unmap(file);
+}
+
 gboolean
 file_fdreopen(FILE_T file, const char *path)
 {
@@ -1447,6 +2094,18 @@ file_fdreopen(FILE_T file, const char *path)
     if ((fd = ws_open(path, O_RDONLY|O_BINARY, 0000)) == -1)
         return FALSE;
     file->fd = fd;
+    file_map(file);
+
+    /*
+     * Reads from a mapping position the descriptor themselves; otherwise
+     * put it where the old one was, so a sequential stream carries on
+     * from where it had got to.
+     */
+    if (file->mapped == NULL && ws_lseek64(fd, file->raw_pos, SEEK_SET) == -1) {
+        ws_close(fd);
+        file->fd = -1;
+        return FALSE;
+    }
     return TRUE;
 }
 
@@ -1459,11 +2118,20 @@ file_close(FILE_T file)
     if (file->size) {
 #ifdef HAVE_LIBZ
         inflateEnd(&(file->strm));
+#endif
+#ifdef HAVE_ZSTD
+        if (file->zstd != NULL)
+            ZSTD_freeDStream(file->zstd);
+#endif
+#ifdef HAVE_LZ4
+        if (file->lz4 != NULL)
+            LZ4F_freeDecompressionContext(file->lz4);
 #endif
         g_free(file->out);
         g_free(file->in);
     }
     g_free(file->fast_seek_cur);
+    file_unmap(file);
     file->err = 0;
     file->err_info = NULL;
     g_free(file);
@@ -29,6 +29,8 @@
 extern FILE_T file_open(const char *path);
 extern FILE_T file_fdopen(int fildes);
 extern void file_set_random_access(FILE_T stream, gboolean random_flag, GPtrArray *seek);
+extern gboolean file_fast_seek_save(GPtrArray *fast_seek, const char *path, int *err);
+extern gboolean file_fast_seek_load(GPtrArray *fast_seek, const char *path);
 WS_DLL_PUBLIC gint64 file_seek(FILE_T stream, gint64 offset, int whence, int *err);
 extern gboolean file_skip(FILE_T file, gint64 delta, int *err);
 WS_DLL_PUBLIC gint64 file_tell(FILE_T stream);
@@ -43,6 +45,7 @@ WS_DLL_PUBLIC int file_eof(FILE_T stream);
 WS_DLL_PUBLIC int file_error(FILE_T fh, gchar **err_info);
 extern void file_clearerr(FILE_T stream);
 extern void file_fdclose(FILE_T file);
+extern void file_set_no_map(FILE_T file);
 extern int file_fdreopen(FILE_T file, const char *path);
 extern void file_close(FILE_T file);
 
@@ -0,0 +1,268 @@
+/* frame_index.c
+ * Capture file frame index sidecar files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <wsutil/file_util.h>
+
+#include "frame_index.h"
+
+/*
+ * Layout of a sidecar file: a header followed by one entry per record.
+ * All fields are little-endian.
+ */
+#define FRAME_INDEX_SUFFIX	".wsidx"
+#define FRAME_INDEX_MAGIC	"WSFIDX\r\n"
+#define FRAME_INDEX_VERSION	1
+
+typedef struct {
+	guint8	magic[8];		/* FRAME_INDEX_MAGIC */
+	guint32	version;		/* FRAME_INDEX_VERSION */
+	guint32	file_type_subtype;	/* WTAP_FILE_TYPE_SUBTYPE_ of the capture file */
+	guint64	file_size;		/* size of the capture file */
+	gint64	file_mtime;		/* modification time of the capture file */
+	guint32	record_count;		/* number of entries following */
+	guint32	reserved;
+} frame_index_hdr;
+
+typedef struct {
+	guint64	data_offset;		/* offset to pass to wtap_seek_read() */
+	gint64	ts_secs;
+	guint32	ts_nsecs;
+	guint32	caplen;
+	guint32	len;
+	guint32	presence_flags;
+} frame_index_entry;
+
+struct wtap_frame_index {
+	int		file_type_subtype;
+	GArray		*entries;	/* entries being built, or NULL */
+	GMappedFile	*mapped;	/* sidecar file, or NULL */
+	const frame_index_entry *map_entries;
+	guint32		count;
+};
+
+gchar *
+wtap_frame_index_filename(const char *capture_filename)
+{
+	return g_strconcat(capture_filename, FRAME_INDEX_SUFFIX, NULL);
+}
+
+wtap_frame_index *
+wtap_frame_index_new(int file_type_subtype)
+{
+	wtap_frame_index *fidx = g_new0(wtap_frame_index, 1);
+
+	fidx->file_type_subtype = file_type_subtype;
+	fidx->entries = g_array_new(FALSE, FALSE, sizeof(frame_index_entry));
+	return fidx;
+}
+
+void
+wtap_frame_index_add(wtap_frame_index *fidx, gint64 data_offset,
+    const struct wtap_pkthdr *phdr)
+{
+	frame_index_entry entry;
+
+	g_assert(fidx->entries != NULL);
+
+	entry.data_offset = GUINT64_TO_LE((guint64)data_offset);
+	entry.ts_secs = GINT64_TO_LE((gint64)phdr->ts.secs);
+	entry.ts_nsecs = GUINT32_TO_LE((guint32)phdr->ts.nsecs);
+	entry.caplen = GUINT32_TO_LE(phdr->caplen);
+	entry.len = GUINT32_TO_LE(phdr->len);
+	entry.presence_flags = GUINT32_TO_LE(phdr->presence_flags);
+	g_array_append_val(fidx->entries, entry);
+	fidx->count++;
+}
+
+gboolean
+wtap_frame_index_write(const wtap_frame_index *fidx,
+    const char *capture_filename, int *err)
+{
+	ws_statb64 statb;
+	frame_index_hdr hdr;
+	gchar *idx_filename;
+	FILE *fp;
+	size_t entries_len;
+
+	g_assert(fidx->entries != NULL);
+
+	if (ws_stat64(capture_filename, &statb) == -1) {
+		*err = errno;
+		return FALSE;
+	}
+
+	memset(&hdr, 0, sizeof hdr);
+	memcpy(hdr.magic, FRAME_INDEX_MAGIC, sizeof hdr.magic);
+	hdr.version = GUINT32_TO_LE(FRAME_INDEX_VERSION);
+	hdr.file_type_subtype = GUINT32_TO_LE((guint32)fidx->file_type_subtype);
+	hdr.file_size = GUINT64_TO_LE((guint64)statb.st_size);
+	hdr.file_mtime = GINT64_TO_LE((gint64)statb.st_mtime);
+	hdr.record_count = GUINT32_TO_LE(fidx->count);
+
+	idx_filename = wtap_frame_index_filename(capture_filename);
+	fp = ws_fopen(idx_filename, "wb");
+	if (fp == NULL) {
+		*err = errno;
+		g_free(idx_filename);
+		return FALSE;
+	}
+
+	entries_len = fidx->entries->len * sizeof(frame_index_entry);
+	if (fwrite(&hdr, sizeof hdr, 1, fp) != 1 ||
+	    (entries_len != 0 && fwrite(fidx->entries->data, entries_len, 1, fp) != 1)) {
+		*err = errno;
+		fclose(fp);
+		ws_unlink(idx_filename);
+		g_free(idx_filename);
+		return FALSE;
+	}
+	if (fclose(fp) == EOF) {
+		*err = errno;
+		ws_unlink(idx_filename);
+		g_free(idx_filename);
+		return FALSE;
+	}
+	g_free(idx_filename);
+	return TRUE;
+}
+
+static void
+frame_index_unmap(GMappedFile *mapped)
+{
+#if GLIB_CHECK_VERSION(2,22,0)
+	g_mapped_file_unref(mapped);
+#else
+	g_mapped_file_free(mapped);
+#endif
+}
+
+wtap_frame_index *
+wtap_frame_index_open(const char *capture_filename, int file_type_subtype)
+{
+	ws_statb64 statb;
+	gchar *idx_filename;
+	GMappedFile *mapped;
+	const frame_index_hdr *hdr;
+	gsize map_len;
+	guint32 count;
+	wtap_frame_index *fidx;
+
+	if (ws_stat64(capture_filename, &statb) == -1)
+		return NULL;
+
+	idx_filename = wtap_frame_index_filename(capture_filename);
+	mapped = g_mapped_file_new(idx_filename, FALSE, NULL);
+	g_free(idx_filename);
+	if (mapped == NULL)
+		return NULL;
+
+	map_len = g_mapped_file_get_length(mapped);
+	hdr = (const frame_index_hdr *)g_mapped_file_get_contents(mapped);
+	if (map_len < sizeof *hdr ||
+	    memcmp(hdr->magic, FRAME_INDEX_MAGIC, sizeof hdr->magic) != 0 ||
+	    GUINT32_FROM_LE(hdr->version) != FRAME_INDEX_VERSION ||
+	    (int)GUINT32_FROM_LE(hdr->file_type_subtype) != file_type_subtype ||
+	    GUINT64_FROM_LE(hdr->file_size) != (guint64)statb.st_size ||
+	    GINT64_FROM_LE(hdr->file_mtime) != (gint64)statb.st_mtime) {
+		/* Not ours, or it's for an older version of the file. */
+		frame_index_unmap(mapped);
+		return NULL;
+	}
+
+	count = GUINT32_FROM_LE(hdr->record_count);
+	if ((map_len - sizeof *hdr) / sizeof(frame_index_entry) < count) {
+		/* Truncated */
+		frame_index_unmap(mapped);
+		return NULL;
+	}
+
+	fidx = g_new0(wtap_frame_index, 1);
+	fidx->file_type_subtype = file_type_subtype;
+	fidx->mapped = mapped;
+	fidx->map_entries = (const frame_index_entry *)(hdr + 1);
+	fidx->count = count;
+	return fidx;
+}
+
+guint32
+wtap_frame_index_count(const wtap_frame_index *fidx)
+{
+	return fidx->count;
+}
+
+gboolean
+wtap_frame_index_get(const wtap_frame_index *fidx, guint32 recno,
+    gint64 *data_offset, nstime_t *ts, guint32 *caplen, guint32 *len)
+{
+	const frame_index_entry *entry;
+
+	if (recno == 0 || recno > fidx->count)
+		return FALSE;
+
+	if (fidx->mapped != NULL)
+		entry = &fidx->map_entries[recno - 1];
+	else
+		entry = &g_array_index(fidx->entries, frame_index_entry, recno - 1);
+
+	if (data_offset != NULL)
+		*data_offset = (gint64)GUINT64_FROM_LE(entry->data_offset);
+	if (ts != NULL) {
+		ts->secs = (time_t)GINT64_FROM_LE(entry->ts_secs);
+		ts->nsecs = (int)GUINT32_FROM_LE(entry->ts_nsecs);
+	}
+	if (caplen != NULL)
+		*caplen = GUINT32_FROM_LE(entry->caplen);
+	if (len != NULL)
+		*len = GUINT32_FROM_LE(entry->len);
+	return TRUE;
+}
+
+void
+wtap_frame_index_free(wtap_frame_index *fidx)
+{
+	if (fidx == NULL)
+		return;
+	if (fidx->entries != NULL)
+		g_array_free(fidx->entries, TRUE);
+	if (fidx->mapped != NULL)
+		frame_index_unmap(fidx->mapped);
+	g_free(fidx);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
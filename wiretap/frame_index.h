@@ -0,0 +1,94 @@
+/* frame_index.h
+ * Definitions for capture file frame index sidecar files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __FRAME_INDEX_H__
+#define __FRAME_INDEX_H__
+
+#include <glib.h>
+#include "wtap.h"
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A frame index records, for every record in a capture file, the offset
+ * to hand to wtap_seek_read() along with the record's time stamp and
+ * lengths.  It is kept in a sidecar file next to the capture file, so a
+ * program that has already read the whole capture once can later go
+ * straight to the records it wants instead of reading everything before
+ * them.
+ *
+ * The sidecar records the size and modification time of the capture file
+ * it was made for, and is ignored if the capture file has changed since.
+ */
+typedef struct wtap_frame_index wtap_frame_index;
+
+/** Return the name of the frame index sidecar for a capture file;
+ *  the name must be freed with g_free(). */
+WS_DLL_PUBLIC
+gchar *wtap_frame_index_filename(const char *capture_filename);
+
+/** Create a new, empty frame index for a capture file of the given
+ *  type/subtype, to be filled in with wtap_frame_index_add(). */
+WS_DLL_PUBLIC
+wtap_frame_index *wtap_frame_index_new(int file_type_subtype);
+
+/** Append the next record of the capture file to a frame index created
+ *  with wtap_frame_index_new(). */
+WS_DLL_PUBLIC
+void wtap_frame_index_add(wtap_frame_index *fidx, gint64 data_offset,
+    const struct wtap_pkthdr *phdr);
+
+/** Write a frame index to the sidecar file for capture_filename.
+ *  Returns TRUE on success, FALSE with *err set on failure. */
+WS_DLL_PUBLIC
+gboolean wtap_frame_index_write(const wtap_frame_index *fidx,
+    const char *capture_filename, int *err);
+
+/** Map the sidecar file for capture_filename into memory.  Returns NULL
+ *  if there's no sidecar, or if it is not valid for the capture file as it
+ *  is now (different size, modification time or file type/subtype). */
+WS_DLL_PUBLIC
+wtap_frame_index *wtap_frame_index_open(const char *capture_filename,
+    int file_type_subtype);
+
+/** Return the number of records in a frame index. */
+WS_DLL_PUBLIC
+guint32 wtap_frame_index_count(const wtap_frame_index *fidx);
+
+/** Look up record number recno (1-based).  Returns FALSE if there's no
+ *  such record; any of the result pointers may be NULL. */
+WS_DLL_PUBLIC
+gboolean wtap_frame_index_get(const wtap_frame_index *fidx, guint32 recno,
+    gint64 *data_offset, nstime_t *ts, guint32 *caplen, guint32 *len);
+
+/** Free a frame index, unmapping it if it was read from a sidecar file. */
+WS_DLL_PUBLIC
+void wtap_frame_index_free(wtap_frame_index *fidx);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FRAME_INDEX_H__ */
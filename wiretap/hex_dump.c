@@ -0,0 +1,163 @@
+/* hex_dump.c
+ * Routines for converting text hex dumps in capture files to binary
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "hex_dump.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HEX_DUMP_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__GNUC__)
+#define HEX_DUMP_NEON
+#include <arm_neon.h>
+#endif
+
+/* Value of a hex digit, or -1 if it isn't one */
+static inline int
+hex_nibble(guchar c)
+{
+	if ((guchar)(c - '0') < 10)
+		return c - '0';
+	c |= 0x20;
+	if ((guchar)(c - 'a') < 6)
+		return c - 'a' + 10;
+	return -1;
+}
+
+#if defined(HEX_DUMP_SSE2) || defined(HEX_DUMP_NEON)
+/*
+ * Convert 32 hex digits at "s" to 16 bytes at "out".  Returns FALSE,
+ * having stored nothing, if they aren't all hex digits.
+ */
+static inline gboolean
+hex_dump_32_digits(const char *s, guint8 *out)
+{
+#if defined(HEX_DUMP_SSE2)
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i below_zero = _mm_set1_epi8('0' - 1);
+	const __m128i above_nine = _mm_set1_epi8('9' + 1);
+	const __m128i below_a = _mm_set1_epi8('a' - 1);
+	const __m128i above_f = _mm_set1_epi8('f' + 1);
+	const __m128i lower = _mm_set1_epi8(0x20);
+	const __m128i a_minus_10 = _mm_set1_epi8('a' - 10);
+	const __m128i low_nibble = _mm_set1_epi16(0x00f0);
+	__m128i pairs[2];
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		__m128i c = _mm_loadu_si128((const __m128i *)(const void *)(s + 16 * i));
+		__m128i l = _mm_or_si128(c, lower);
+		__m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, below_zero),
+		                              _mm_cmplt_epi8(c, above_nine));
+		__m128i letter = _mm_and_si128(_mm_cmpgt_epi8(l, below_a),
+		                               _mm_cmplt_epi8(l, above_f));
+		__m128i nibbles;
+
+		if (_mm_movemask_epi8(_mm_or_si128(digit, letter)) != 0xffff)
+			return FALSE;
+		nibbles = _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(c, zero)),
+		                       _mm_and_si128(letter, _mm_sub_epi8(l, a_minus_10)));
+		/* Each 16-bit lane holds the high nibble in its low byte and
+		 * the low nibble in its high byte */
+		pairs[i] = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(nibbles, 4), low_nibble),
+		                        _mm_srli_epi16(nibbles, 8));
+	}
+	_mm_storeu_si128((__m128i *)(void *)out, _mm_packus_epi16(pairs[0], pairs[1]));
+	return TRUE;
+#else
+	uint8x16x2_t c = vld2q_u8((const guint8 *)s);
+	uint8x16_t nibbles[2];
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		uint8x16_t d = vsubq_u8(c.val[i], vdupq_n_u8('0'));
+		uint8x16_t l = vsubq_u8(vorrq_u8(c.val[i], vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+		uint8x16_t digit = vcltq_u8(d, vdupq_n_u8(10));
+		uint8x16_t letter = vcltq_u8(l, vdupq_n_u8(6));
+
+		if (vminvq_u8(vorrq_u8(digit, letter)) != 0xff)
+			return FALSE;
+		nibbles[i] = vbslq_u8(digit, d, vaddq_u8(l, vdupq_n_u8(10)));
+	}
+	vst1q_u8(out, vorrq_u8(vshlq_n_u8(nibbles[0], 4), nibbles[1]));
+	return TRUE;
+#endif
+}
+#endif
+
+int
+wtap_hex_dump_to_bytes(const char *s, gssize len, char separator,
+    guint8 *out, int max_bytes, const char **endp)
+{
+	const char *p = s;
+	const char *end;
+	int         count = 0;
+	int         hi, lo;
+
+	end = s + (len < 0 ? (gssize)strlen(s) : len);
+	while (count < max_bytes) {
+#if defined(HEX_DUMP_SSE2) || defined(HEX_DUMP_NEON)
+		/* Long runs of digits without separators, e.g. iSeries
+		 * dumps, go 16 bytes at a time */
+		if (end - p >= 32 && max_bytes - count >= 16 &&
+		    hex_dump_32_digits(p, out + count)) {
+			p += 32;
+			count += 16;
+			continue;
+		}
+#endif
+		if (p == end || (hi = hex_nibble(*p)) < 0)
+			break;
+		if (p + 1 == end || (lo = hex_nibble(p[1])) < 0) {
+			if (endp != NULL)
+				*endp = p + 1;
+			return -1;
+		}
+		out[count++] = (guint8)((hi << 4) | lo);
+		p += 2;
+
+		if (separator != '\0') {
+			while (p < end && *p == separator)
+				p++;
+		}
+	}
+
+	if (endp != NULL)
+		*endp = p;
+	return count;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -0,0 +1,56 @@
+/* hex_dump.h
+ * Definitions for converting text hex dumps in capture files to binary
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HEX_DUMP_H__
+#define __HEX_DUMP_H__
+
+#include <glib.h>
+
+/*
+ * Convert hex digits at "s" to bytes at "out", for the readers of text
+ * capture formats.  Each byte is two adjacent hex digits, in either case;
+ * bytes may be separated by any number of "separator" characters (pass
+ * '\0' if they can't be).  Conversion stops at the first other character,
+ * at the end of the string, after "len" characters if "len" isn't -1, or
+ * after "max_bytes" bytes.
+ *
+ * Returns the number of bytes stored, or -1 if it stopped halfway through
+ * a byte.  If "endp" isn't NULL, it's set to point to where the
+ * conversion stopped.
+ */
+int wtap_hex_dump_to_bytes(const char *s, gssize len, char separator,
+    guint8 *out, int max_bytes, const char **endp);
+
+#endif /* __HEX_DUMP_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
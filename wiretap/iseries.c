@@ -152,6 +152,7 @@ Number  S/R  Length    Timer                        MAC Address   MAC Address
 #include "wtap-int.h"
 #include "iseries.h"
 #include "file_wrappers.h"
+#include "hex_dump.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -881,29 +882,12 @@ iseries_UNICODE_to_ASCII (guint8 * buf, guint bytes)
 static gboolean
 iseries_parse_hex_string (const char * ascii, guint8 * buf, size_t len)
 {
-  size_t i;
-  int byte;
-  gint   hexvalue;
-  guint8 bytevalue;
+  int bytes;
 
-  byte = 0;
-  for (i = 0; i < len; i++)
-    {
-      hexvalue = g_ascii_xdigit_value(ascii[i]);
-      i++;
-      if (hexvalue == -1)
-        return FALSE;        /* not a valid hex digit */
-      bytevalue = (guint8)(hexvalue << 4);
-      if (i >= len)
-        return FALSE;        /* only one hex digit of the byte is present */
-      hexvalue = g_ascii_xdigit_value(ascii[i]);
-      if (hexvalue == -1)
-        return FALSE;        /* not a valid hex digit */
-      bytevalue |= (guint8) hexvalue;
-      buf[byte] = bytevalue;
-      byte++;
-    }
-  return TRUE;
+  /* Fails on a non-hex digit or a byte with only one digit present */
+  bytes = wtap_hex_dump_to_bytes (ascii, (gssize) len, '\0', buf, G_MAXINT,
+                                  NULL);
+  return bytes >= 0 && (size_t) bytes * 2 == len;
 }
 
 /*
@@ -47,6 +47,7 @@ typedef struct {
 	swapped_type_t lengths_swapped;
 	guint16	version_major;
 	guint16	version_minor;
+	gint64	first_rec_offset;
 } libpcap_t;
 
 /* On some systems, the FDDI MAC addresses are bit-swapped. */
@@ -63,6 +64,10 @@ static gboolean libpcap_read(wtap *wth, int *err, gchar **err_info,
     gint64 *data_offset);
 static gboolean libpcap_seek_read(wtap *wth, gint64 seek_off,
     struct wtap_pkthdr *phdr, Buffer *buf, int *err, gchar **err_info);
+static guint libpcap_read_batch(wtap *wth, wtap_batch_rec *recs, guint nrecs,
+    int *err, gchar **err_info);
+static gboolean libpcap_seek_to_time(wtap *wth, const nstime_t *ts, int *err,
+    gchar **err_info);
 static gboolean libpcap_read_packet(wtap *wth, FILE_T fh,
     struct wtap_pkthdr *phdr, Buffer *buf, int *err, gchar **err_info);
 static gboolean libpcap_dump(wtap_dumper *wdh, const struct wtap_pkthdr *phdr,
@@ -263,9 +268,14 @@ wtap_open_return_val libpcap_open(wtap *wth, int *err, gchar **err_info)
 	libpcap->byte_swapped = byte_swapped;
 	libpcap->version_major = hdr.version_major;
 	libpcap->version_minor = hdr.version_minor;
+	libpcap->first_rec_offset = file_tell(wth->fh);
 	wth->priv = (void *)libpcap;
 	wth->subtype_read = libpcap_read;
 	wth->subtype_seek_read = libpcap_seek_read;
+	wth->subtype_read_batch = libpcap_read_batch;
+	wth->batch_can_skip_data = TRUE;
+	wth->read_from_any_record = TRUE;
+	wth->subtype_seek_to_time = libpcap_seek_to_time;
 	wth->file_encap = file_encap;
 	wth->snapshot_length = hdr.snaplen;
 
@@ -620,6 +630,21 @@ static gboolean libpcap_read(wtap *wth, int *err, gchar **err_info,
 	    wth->frame_buffer, err, err_info);
 }
 
+/* Read the next nrecs packets, straight into the caller's records */
+static guint libpcap_read_batch(wtap *wth, wtap_batch_rec *recs, guint nrecs,
+    int *err, gchar **err_info)
+{
+	guint n;
+
+	for (n = 0; n < nrecs; n++) {
+		recs[n].data_offset = file_tell(wth->fh);
+		if (!libpcap_read_packet(wth, wth->fh, &recs[n].phdr,
+		    wth->batch_headers_only ? NULL : &recs[n].buf, err, err_info))
+			break;
+	}
+	return n;
+}
+
 static gboolean
 libpcap_seek_read(wtap *wth, gint64 seek_off, struct wtap_pkthdr *phdr,
     Buffer *buf, int *err, gchar **err_info)
@@ -636,6 +661,139 @@ libpcap_seek_read(wtap *wth, gint64 seek_off, struct wtap_pkthdr *phdr,
 	return TRUE;
 }
 
+/*
+ * Once the part of the file libpcap_seek_to_time() is bisecting is
+ * smaller than this, go through the records in it one at a time.
+ */
+#define LIBPCAP_BISECT_MIN	(256 * 1024)
+
+/*
+ * How many record headers in a row, each where the one before says the
+ * next one is, must look right before we believe we've found the start
+ * of a record in the middle of the file.
+ */
+#define LIBPCAP_SYNC_RECORDS	3
+
+static void
+libpcap_header_ts(wtap *wth, const struct pcaprec_ss990915_hdr *hdr,
+    nstime_t *ts)
+{
+	ts->secs = hdr->hdr.ts_sec;
+	if (wth->file_tsprec == WTAP_TSPREC_NSEC)
+		ts->nsecs = hdr->hdr.ts_usec;
+	else
+		ts->nsecs = hdr->hdr.ts_usec * 1000;
+}
+
+/*
+ * Find the first record that starts at or after offset and before limit,
+ * by looking for a record header followed by more that look right, in
+ * time order, or by the end of the file.
+ *
+ * Returns -1 on an I/O error, 0 if there's none, or 1, with the record's
+ * offset and time stamp filled in, if there is one.
+ */
+static int
+libpcap_find_record(wtap *wth, gint64 offset, gint64 limit,
+    gint64 *rec_offset, nstime_t *rec_ts, int *err, gchar **err_info)
+{
+	struct pcaprec_ss990915_hdr hdr;
+	nstime_t ts, prev_ts;
+	gint64 next;
+	int i, ret = 0;
+
+	for (; offset < limit; offset++) {
+		next = offset;
+		for (i = 0; i < LIBPCAP_SYNC_RECORDS; i++) {
+			if (file_seek(wth->fh, next, SEEK_SET, err) == -1)
+				return -1;
+			ret = libpcap_try_header(wth, wth->fh, err, err_info, &hdr);
+			if (ret == -1) {
+				if (*err != 0 && *err != WTAP_ERR_SHORT_READ)
+					return -1;
+				break;
+			}
+			if (ret != 0)
+				break;
+			libpcap_header_ts(wth, &hdr, &ts);
+			if (i == 0)
+				*rec_ts = ts;
+			else if (nstime_cmp(&ts, &prev_ts) < 0)
+				break;
+			prev_ts = ts;
+			next = file_tell(wth->fh) + hdr.hdr.incl_len;
+		}
+		/* A clean end of file after a record is as good as a header */
+		if (i == LIBPCAP_SYNC_RECORDS || (i > 0 && ret == -1 && *err == 0)) {
+			*err = 0;
+			*rec_offset = offset;
+			return 1;
+		}
+		*err = 0;
+	}
+	return 0;
+}
+
+/*
+ * Go to the first record whose time stamp is at or after ts, by bisecting
+ * the file.  The records are taken to be in time order.
+ */
+static gboolean
+libpcap_seek_to_time(wtap *wth, const nstime_t *ts, int *err,
+    gchar **err_info)
+{
+	libpcap_t *libpcap = (libpcap_t *)wth->priv;
+	struct pcaprec_ss990915_hdr hdr;
+	gint64 lo, hi, mid, rec_offset;
+	nstime_t rec_ts;
+	int ret;
+
+	/* Seeking around in a compressed file means inflating it again */
+	if (file_iscompressed(wth->fh))
+		return FALSE;
+
+	/*
+	 * lo is the start of a record at or before the one we want;
+	 * the one we want is at or before the first record at or after hi.
+	 */
+	lo = libpcap->first_rec_offset;
+	hi = wtap_file_size(wth, err);
+	if (hi == -1)
+		return FALSE;
+	while (hi - lo > LIBPCAP_BISECT_MIN) {
+		mid = lo + (hi - lo) / 2;
+		ret = libpcap_find_record(wth, mid, hi, &rec_offset, &rec_ts,
+		    err, err_info);
+		if (ret == -1)
+			return FALSE;
+		if (ret == 1 && nstime_cmp(&rec_ts, ts) < 0)
+			lo = rec_offset;
+		else
+			hi = mid;
+	}
+
+	/* Go through the rest one record at a time */
+	if (file_seek(wth->fh, lo, SEEK_SET, err) == -1)
+		return FALSE;
+	for (;;) {
+		rec_offset = file_tell(wth->fh);
+		if (!libpcap_read_header(wth, wth->fh, err, err_info, &hdr)) {
+			if (*err != 0)
+				return FALSE;
+			break;	/* they're all before ts */
+		}
+		libpcap_header_ts(wth, &hdr, &rec_ts);
+		if (nstime_cmp(&rec_ts, ts) >= 0)
+			break;
+		if (!file_skip(wth->fh, hdr.hdr.incl_len, err)) {
+			if (*err != 0)
+				return FALSE;
+			break;	/* cut short; let the read report that */
+		}
+	}
+	return file_seek(wth->fh, rec_offset, SEEK_SET, err) != -1;
+}
+
 static gboolean
 libpcap_read_packet(wtap *wth, FILE_T fh, struct wtap_pkthdr *phdr,
     Buffer *buf, int *err, gchar **err_info)
@@ -717,8 +875,11 @@ libpcap_read_packet(wtap *wth, FILE_T fh, struct wtap_pkthdr *phdr,
 	phdr->len = orig_size;
 
 	/*
-	 * Read the packet data.
+	 * Read the packet data, unless we've been asked only for the
+	 * header, in which case skip over it.
 	 */
+	if (buf == NULL)
+		return file_skip(fh, packet_size, err);
 	if (!wtap_read_packet_bytes(fh, buf, packet_size, err, err_info))
 		return FALSE;	/* failed */
 
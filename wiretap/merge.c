@@ -37,9 +37,143 @@
 #include <sys/time.h>
 #endif
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
 #include <string.h>
 #include "merge.h"
 
+/*
+ * Upper bound on the number of input files we keep open at once; the
+ * rest have their file descriptors closed until they're read again.
+ */
+#define MERGE_MAX_OPEN_FILES  256
+#define MERGE_MIN_OPEN_FILES  4
+
+/*
+ * State of a merge, kept in the same allocation as, and just after, the
+ * array of input files, so that callers can go on freeing the array with
+ * g_free().
+ */
+typedef struct {
+  int               max_open;    /* most file descriptors we'll keep open */
+  int               open_count;  /* number of file descriptors open */
+  guint64           read_clock;  /* incremented on each read, for last_read */
+  int               primed;      /* number of files that have been read from and put in the heap */
+  int               heap_len;    /* number of files in the heap */
+  merge_in_file_t  *heap[1];     /* files with a packet, earliest packet first */
+} merge_state_t;
+
+static merge_state_t *
+merge_state(int in_file_count, merge_in_file_t in_files[])
+{
+  return (merge_state_t *)(void *)&in_files[in_file_count];
+}
+
+static int
+merge_max_open_files(void)
+{
+#ifndef _WIN32
+  struct rlimit rl;
+
+  /*
+   * Leave half the descriptors for the output file and whoever's
+   * calling us.
+   */
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY &&
+      rl.rlim_cur / 2 < MERGE_MAX_OPEN_FILES) {
+    if (rl.rlim_cur / 2 < MERGE_MIN_OPEN_FILES)
+      return MERGE_MIN_OPEN_FILES;
+    return (int)(rl.rlim_cur / 2);
+  }
+#endif
+  return MERGE_MAX_OPEN_FILES;
+}
+
+/*
+ * Close the file descriptor of an input file; its wtap stays usable, and
+ * merge_reopen_file() will reopen it where it left off.  We can't do that
+ * with the standard input.
+ */
+static void
+merge_park_file(merge_state_t *state, merge_in_file_t *file)
+{
+  if (file->fd_closed || strcmp(file->filename, "-") == 0)
+    return;
+  wtap_fdclose(file->wth);
+  file->fd_closed = TRUE;
+  state->open_count--;
+}
+
+/*
+ * Make room for another open file, if we're at the limit, by closing the
+ * descriptor of the open file that was read from longest ago.
+ */
+static void
+merge_make_room(int in_file_count, merge_in_file_t in_files[],
+                merge_state_t *state, merge_in_file_t *keep)
+{
+  int i;
+  merge_in_file_t *victim = NULL;
+
+  if (state->open_count < state->max_open)
+    return;
+
+  for (i = 0; i < in_file_count; i++) {
+    if (&in_files[i] == keep || in_files[i].fd_closed ||
+        strcmp(in_files[i].filename, "-") == 0)
+      continue;
+    if (victim == NULL || in_files[i].last_read < victim->last_read)
+      victim = &in_files[i];
+  }
+  if (victim != NULL)
+    merge_park_file(state, victim);
+}
+
+static gboolean
+merge_reopen_file(int in_file_count, merge_in_file_t in_files[],
+                  merge_state_t *state, merge_in_file_t *file, int *err)
+{
+  if (!file->fd_closed)
+    return TRUE;
+  merge_make_room(in_file_count, in_files, state, file);
+  if (!wtap_sequential_fdreopen(file->wth, file->filename, err))
+    return FALSE;
+  file->fd_closed = FALSE;
+  state->open_count++;
+  return TRUE;
+}
+
+/*
+ * Read the next packet from an input file, reopening it first if need be,
+ * and set its state accordingly.  Returns FALSE on a read error.
+ */
+static gboolean
+merge_read_file(int in_file_count, merge_in_file_t in_files[],
+                merge_in_file_t *file, int *err, gchar **err_info)
+{
+  merge_state_t *state = merge_state(in_file_count, in_files);
+
+  if (!merge_reopen_file(in_file_count, in_files, state, file, err)) {
+    *err_info = NULL;
+    file->state = GOT_ERROR;
+    return FALSE;
+  }
+  file->last_read = ++state->read_clock;
+  if (!wtap_read(file->wth, err, err_info, &file->data_offset)) {
+    if (*err != 0) {
+      file->state = GOT_ERROR;
+      return FALSE;
+    }
+    /* We won't need this one again. */
+    file->state = AT_EOF;
+    merge_park_file(state, file);
+  } else
+    file->state = PACKET_PRESENT;
+  return TRUE;
+}
+
 /*
  * Scan through the arguments and open the input files
  */
@@ -50,19 +184,30 @@ merge_open_in_files(int in_file_count, char *const *in_file_names,
 {
   gint i;
   gint j;
-  size_t files_size = in_file_count * sizeof(merge_in_file_t);
+  size_t files_size = in_file_count * sizeof(merge_in_file_t) +
+                      sizeof(merge_state_t) + in_file_count * sizeof(merge_in_file_t *);
   merge_in_file_t *files;
+  merge_state_t *state;
   gint64 size;
 
   files = (merge_in_file_t *)g_malloc(files_size);
   *in_files = files;
+  state = merge_state(in_file_count, files);
+  state->max_open   = merge_max_open_files();
+  state->open_count = 0;
+  state->read_clock = 0;
+  state->primed     = 0;
+  state->heap_len   = 0;
 
   for (i = 0; i < in_file_count; i++) {
+    merge_make_room(i, files, state, NULL);
     files[i].filename    = in_file_names[i];
     files[i].wth         = wtap_open_offline(in_file_names[i], WTAP_TYPE_AUTO, err, err_info, FALSE);
     files[i].data_offset = 0;
     files[i].state       = PACKET_NOT_PRESENT;
     files[i].packet_num  = 0;
+    files[i].fd_closed   = FALSE;
+    files[i].last_read   = 0;
     if (!files[i].wth) {
       /* Close the files we've already opened. */
       for (j = 0; j < i; j++)
@@ -70,6 +215,7 @@ merge_open_in_files(int in_file_count, char *const *in_file_names,
       *err_fileno = i;
       return FALSE;
     }
+    state->open_count++;
     size = wtap_file_size(files[i].wth, err);
     if (size == -1) {
       for (j = 0; j + 1 > j && j <= i; j++)
@@ -162,6 +308,59 @@ is_earlier(nstime_t *l, nstime_t *r) /* XXX, move to nstime.c */
   return TRUE;
 }
 
+/*
+ * returns TRUE if the next packet of the first file comes before that of
+ * the second.  Packets with the same time stamp are taken from the later
+ * file in the list first, as they always have been.
+ */
+static gboolean
+merge_file_before(merge_in_file_t *l, merge_in_file_t *r)
+{
+  nstime_t *lts = &wtap_phdr(l->wth)->ts;
+  nstime_t *rts = &wtap_phdr(r->wth)->ts;
+
+  if (lts->secs == rts->secs && lts->nsecs == rts->nsecs)
+    return l > r;
+  return is_earlier(lts, rts);
+}
+
+static void
+merge_heap_sift_up(merge_state_t *state, int i)
+{
+  merge_in_file_t *file = state->heap[i];
+
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+
+    if (!merge_file_before(file, state->heap[parent]))
+      break;
+    state->heap[i] = state->heap[parent];
+    i = parent;
+  }
+  state->heap[i] = file;
+}
+
+static void
+merge_heap_sift_down(merge_state_t *state, int i)
+{
+  merge_in_file_t *file = state->heap[i];
+
+  for (;;) {
+    int child = 2 * i + 1;
+
+    if (child >= state->heap_len)
+      break;
+    if (child + 1 < state->heap_len &&
+        merge_file_before(state->heap[child + 1], state->heap[child]))
+      child++;
+    if (!merge_file_before(state->heap[child], file))
+      break;
+    state->heap[i] = state->heap[child];
+    i = child;
+  }
+  state->heap[i] = file;
+}
+
 /*
  * Read the next packet, in chronological order, from the set of files
  * to be merged.
@@ -179,59 +378,58 @@ merge_in_file_t *
 merge_read_packet(int in_file_count, merge_in_file_t in_files[],
                   int *err, gchar **err_info)
 {
-  int i;
-  int ei = -1;
-  nstime_t tv = { sizeof(time_t) > sizeof(int) ? LONG_MAX : INT_MAX, INT_MAX };
-  struct wtap_pkthdr *phdr;
+  merge_state_t *state = merge_state(in_file_count, in_files);
+  merge_in_file_t *file;
 
   /*
-   * Make sure we have a packet available from each file, if there are any
-   * packets left in the file in question, and search for the packet
-   * with the earliest time stamp.
+   * The first time through, read the first packet of each file and
+   * put the files that have one in the heap.
    */
-  for (i = 0; i < in_file_count; i++) {
-    if (in_files[i].state == PACKET_NOT_PRESENT) {
-      /*
-       * No packet available, and we haven't seen an error or EOF yet,
-       * so try to read the next packet.
-       */
-      if (!wtap_read(in_files[i].wth, err, err_info, &in_files[i].data_offset)) {
-        if (*err != 0) {
-          in_files[i].state = GOT_ERROR;
-          return &in_files[i];
-        }
-        in_files[i].state = AT_EOF;
-      } else
-        in_files[i].state = PACKET_PRESENT;
+  while (state->primed < in_file_count) {
+    file = &in_files[state->primed];
+    if (!merge_read_file(in_file_count, in_files, file, err, err_info))
+      return file;
+    state->primed++;
+    if (file->state == PACKET_PRESENT) {
+      state->heap[state->heap_len++] = file;
+      merge_heap_sift_up(state, state->heap_len - 1);
     }
+  }
 
-    if (in_files[i].state == PACKET_PRESENT) {
-      phdr = wtap_phdr(in_files[i].wth);
-      if (is_earlier(&phdr->ts, &tv)) {
-        tv = phdr->ts;
-        ei = i;
-      }
-    }
+  /*
+   * The file whose packet we returned last time is still at the top of
+   * the heap; get its next packet and put it back where it belongs.
+   */
+  if (state->heap_len > 0 && state->heap[0]->state == PACKET_NOT_PRESENT) {
+    file = state->heap[0];
+    if (!merge_read_file(in_file_count, in_files, file, err, err_info))
+      return file;
+    if (file->state == AT_EOF)
+      state->heap[0] = state->heap[--state->heap_len];
+    if (state->heap_len > 0)
+      merge_heap_sift_down(state, 0);
   }
 
-  if (ei == -1) {
+  if (state->heap_len == 0) {
     /* All the streams are at EOF.  Return an EOF indication. */
     *err = 0;
     return NULL;
   }
 
+  file = state->heap[0];
+
   /* We'll need to read another packet from this file. */
-  in_files[ei].state = PACKET_NOT_PRESENT;
+  file->state = PACKET_NOT_PRESENT;
 
   /* Count this packet. */
-  in_files[ei].packet_num++;
+  file->packet_num++;
 
   /*
    * Return a pointer to the merge_in_file_t of the file from which the
    * packet was read.
    */
   *err = 0;
-  return &in_files[ei];
+  return file;
 }
 
 /*
@@ -259,15 +457,13 @@ merge_append_read_packet(int in_file_count, merge_in_file_t in_files[],
   for (i = 0; i < in_file_count; i++) {
     if (in_files[i].state == AT_EOF)
       continue; /* This file is already at EOF */
-    if (wtap_read(in_files[i].wth, err, err_info, &in_files[i].data_offset))
-      break; /* We have a packet */
-    if (*err != 0) {
+    if (!merge_read_file(in_file_count, in_files, &in_files[i], err, err_info)) {
       /* Read error - quit immediately. */
-      in_files[i].state = GOT_ERROR;
       return &in_files[i];
     }
-    /* EOF - flag this file as being at EOF, and try the next one. */
-    in_files[i].state = AT_EOF;
+    if (in_files[i].state == PACKET_PRESENT)
+      break; /* We have a packet */
+    /* EOF - this file has been flagged as being at EOF; try the next one. */
   }
   if (i == in_file_count) {
     /* All the streams are at EOF.  Return an EOF indication. */
@@ -48,13 +48,24 @@ typedef struct merge_in_file_s {
   gint64          size;		      /* file size */
   guint32         interface_id;   /* identifier of the interface.
 								   * Used for fake interfaces when writing WTAP_ENCAP_PER_PACKET */
+  gboolean        fd_closed;      /* TRUE if the file descriptor has been closed to stay
+                                   * within the open file limit; it's reopened when needed */
+  guint64         last_read;      /* when we last read from the file, for picking which
+                                   * file descriptor to close */
 } merge_in_file_t;
 
 /** Open a number of input files to merge.
+ *
+ * Only a bounded number of the files are kept open at once; the others
+ * have their file descriptors closed, and reopened when they're next
+ * read, so that hundreds of files can be merged without running into
+ * the process's open file limit.  The wtap handles of all the files
+ * remain valid.
  *
  * @param in_file_count number of entries in in_file_names and in_files
  * @param in_file_names filenames of the input files
- * @param in_files input file array to be filled (>= sizeof(merge_in_file_t) * in_file_count)
+ * @param in_files set to the input file array, which also holds the
+ * merge state; free it with g_free() after merge_close_in_files()
  * @param err wiretap error, if failed
  * @param err_info wiretap error string, if failed
  * @param err_fileno file on which open failed, if failed
@@ -94,6 +105,9 @@ merge_max_snapshot_length(int in_file_count, merge_in_file_t in_files[]);
 /** Read the next packet, in chronological order, from the set of files to
  * be merged.
  *
+ * The files are kept in a heap ordered by the time stamp of their next
+ * packet, so each packet costs O(log in_file_count) comparisons.
+ *
  * @param in_file_count number of entries in in_files
  * @param in_files input file array
  * @param err wiretap error, if failed
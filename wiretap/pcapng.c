@@ -60,6 +60,9 @@ pcapng_read(wtap *wth, int *err, gchar **err_info,
 static gboolean
 pcapng_seek_read(wtap *wth, gint64 seek_off,
                  struct wtap_pkthdr *phdr, Buffer *buf, int *err, gchar **err_info);
+static guint
+pcapng_read_batch(wtap *wth, wtap_batch_rec *recs, guint nrecs,
+                  int *err, gchar **err_info);
 static void
 pcapng_close(wtap *wth);
 
@@ -368,6 +371,7 @@ typedef struct {
     guint16 version_minor;
     GArray *interfaces;          /**< Interfaces found in the capture file. */
     gint8 if_fcslen;
+    gboolean skip_data;          /**< Skip over packet data rather than reading it */
     wtap_new_ipv4_callback_t add_new_ipv4;
     wtap_new_ipv6_callback_t add_new_ipv6;
 } pcapng_t;
@@ -1293,8 +1297,11 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wta
     wblock->packet_header->ts.nsecs = (int)(((ts % iface_info.time_units_per_second) * 1000000000) / iface_info.time_units_per_second);
 
     /* "(Enhanced) Packet Block" read capture data */
-    if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
-                                packet.cap_len - pseudo_header_len, err, err_info))
+    if (pn->skip_data) {
+        if (!file_skip(fh, packet.cap_len - pseudo_header_len, err))
+            return FALSE;
+    } else if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
+                                       packet.cap_len - pseudo_header_len, err, err_info))
         return FALSE;
     block_read += packet.cap_len - pseudo_header_len;
 
@@ -1429,9 +1436,10 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *pn, wta
         }
     }
 
-    pcap_read_post_process(WTAP_FILE_TYPE_SUBTYPE_PCAPNG, iface_info.wtap_encap,
-                           wblock->packet_header, ws_buffer_start_ptr(wblock->frame_buffer),
-                           pn->byte_swapped, fcslen);
+    if (!pn->skip_data)
+        pcap_read_post_process(WTAP_FILE_TYPE_SUBTYPE_PCAPNG, iface_info.wtap_encap,
+                               wblock->packet_header, ws_buffer_start_ptr(wblock->frame_buffer),
+                               pn->byte_swapped, fcslen);
     return TRUE;
 }
 
@@ -1582,8 +1590,11 @@ pcapng_read_simple_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *
     memset((void *)&wblock->packet_header->pseudo_header, 0, sizeof(union wtap_pseudo_header));
 
     /* "Simple Packet Block" read capture data */
-    if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
-                                simple_packet.cap_len, err, err_info))
+    if (pn->skip_data) {
+        if (!file_skip(fh, simple_packet.cap_len, err))
+            return FALSE;
+    } else if (!wtap_read_packet_bytes(fh, wblock->frame_buffer,
+                                       simple_packet.cap_len, err, err_info))
         return FALSE;
 
     /* jump over potential padding bytes at end of the packet data */
@@ -1592,9 +1603,10 @@ pcapng_read_simple_packet_block(FILE_T fh, pcapng_block_header_t *bh, pcapng_t *
             return FALSE;
     }
 
-    pcap_read_post_process(WTAP_FILE_TYPE_SUBTYPE_PCAPNG, iface_info.wtap_encap,
-                           wblock->packet_header, ws_buffer_start_ptr(wblock->frame_buffer),
-                           pn->byte_swapped, pn->if_fcslen);
+    if (!pn->skip_data)
+        pcap_read_post_process(WTAP_FILE_TYPE_SUBTYPE_PCAPNG, iface_info.wtap_encap,
+                               wblock->packet_header, ws_buffer_start_ptr(wblock->frame_buffer),
+                               pn->byte_swapped, pn->if_fcslen);
     return TRUE;
 }
 
@@ -2304,6 +2316,7 @@ pcapng_open(wtap *wth, int *err, gchar **err_info)
     /* we don't know the byte swapping of the file yet */
     pn.byte_swapped = FALSE;
     pn.if_fcslen = -1;
+    pn.skip_data = FALSE;
     pn.version_major = -1;
     pn.version_minor = -1;
     pn.interfaces = NULL;
@@ -2366,6 +2379,9 @@ pcapng_open(wtap *wth, int *err, gchar **err_info)
 
     wth->subtype_read = pcapng_read;
     wth->subtype_seek_read = pcapng_seek_read;
+    wth->subtype_read_batch = pcapng_read_batch;
+    wth->batch_can_skip_data = TRUE;
+    wth->read_from_any_record = TRUE;
     wth->subtype_close = pcapng_close;
     wth->file_type_subtype = WTAP_FILE_TYPE_SUBTYPE_PCAPNG;
 
@@ -2415,17 +2431,18 @@ pcapng_open(wtap *wth, int *err, gchar **err_info)
 }
 
 
-/* classic wtap: read packet */
+/* read the next packet into phdr and buf */
 static gboolean
-pcapng_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
+pcapng_read_record(wtap *wth, struct wtap_pkthdr *phdr, Buffer *buf,
+                   int *err, gchar **err_info, gint64 *data_offset)
 {
     pcapng_t *pcapng = (pcapng_t *)wth->priv;
     wtapng_block_t wblock;
     wtapng_if_descr_t *wtapng_if_descr;
     wtapng_if_stats_t if_stats;
 
-    wblock.frame_buffer  = wth->frame_buffer;
-    wblock.packet_header = &wth->phdr;
+    wblock.frame_buffer  = buf;
+    wblock.packet_header = phdr;
 
     pcapng->add_new_ipv4 = wth->add_new_ipv4;
     pcapng->add_new_ipv6 = wth->add_new_ipv6;
@@ -2444,8 +2461,8 @@ pcapng_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
 
             case(BLOCK_TYPE_SHB):
                 /* We don't currently support multi-section files. */
-                wth->phdr.pkt_encap = WTAP_ENCAP_UNKNOWN;
-                wth->phdr.pkt_tsprec = WTAP_TSPREC_UNKNOWN;
+                phdr->pkt_encap = WTAP_ENCAP_UNKNOWN;
+                phdr->pkt_tsprec = WTAP_TSPREC_UNKNOWN;
                 *err = WTAP_ERR_UNSUPPORTED;
                 *err_info = g_strdup_printf("pcapng: multi-section files not currently supported");
                 return FALSE;
@@ -2508,12 +2525,38 @@ pcapng_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
 
 got_packet:
 
-    /*pcapng_debug2("Read length: %u Packet length: %u", bytes_read, wth->phdr.caplen);*/
+    /*pcapng_debug2("Read length: %u Packet length: %u", bytes_read, phdr->caplen);*/
     pcapng_debug1("pcapng_read: data_offset is finally %" G_GINT64_MODIFIER "d", *data_offset);
 
     return TRUE;
 }
 
+/* classic wtap: read packet */
+static gboolean
+pcapng_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
+{
+    return pcapng_read_record(wth, &wth->phdr, wth->frame_buffer, err,
+                              err_info, data_offset);
+}
+
+/* read the next nrecs packets, straight into the caller's records */
+static guint
+pcapng_read_batch(wtap *wth, wtap_batch_rec *recs, guint nrecs,
+                  int *err, gchar **err_info)
+{
+    pcapng_t *pcapng = (pcapng_t *)wth->priv;
+    guint n;
+
+    pcapng->skip_data = wth->batch_headers_only;
+    for (n = 0; n < nrecs; n++) {
+        if (!pcapng_read_record(wth, &recs[n].phdr, &recs[n].buf, err,
+                                err_info, &recs[n].data_offset))
+            break;
+    }
+    pcapng->skip_data = FALSE;
+    return n;
+}
+
 
 /* classic wtap: seek to file position and read packet */
 static gboolean
@@ -3373,6 +3416,10 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh,
     struct option option_hdr;
     guint32 comment_len = 0, comment_pad_len = 0;
     wtapng_if_descr_t int_data;
+    guint8 header[sizeof bh + sizeof epb];
+    /* padding, flags option, end of options and block length */
+    guint8 trailer[3 + sizeof option_hdr + 4 + sizeof option_hdr + 4];
+    guint32 trailer_len;
 
     /* Don't write anything we're not willing to read. */
     if (phdr->caplen > WTAP_MAX_PACKET_SIZE) {
@@ -3411,11 +3458,7 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh,
     bh.block_type = BLOCK_TYPE_EPB;
     bh.block_total_length = (guint32)sizeof(bh) + (guint32)sizeof(epb) + phdr_len + phdr->caplen + pad_len + options_total_length + 4;
 
-    if (!wtap_dump_file_write(wdh, &bh, sizeof bh, err))
-        return FALSE;
-    wdh->bytes_dumped += sizeof bh;
-
-    /* write block fixed content */
+    /* block fixed content */
     if (phdr->presence_flags & WTAP_HAS_INTERFACE_ID)
         epb.interface_id        = phdr->interface_id;
     else {
@@ -3446,9 +3489,16 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh,
     epb.captured_len        = phdr->caplen + phdr_len;
     epb.packet_len          = phdr->len + phdr_len;
 
-    if (!wtap_dump_file_write(wdh, &epb, sizeof epb, err))
+    /*
+     * Most packets have no options, so the block header and fixed
+     * content, and the padding, options and footer, are each written
+     * in one go.
+     */
+    memcpy(header, &bh, sizeof bh);
+    memcpy(header + sizeof bh, &epb, sizeof epb);
+    if (!wtap_dump_file_write(wdh, header, sizeof header, err))
         return FALSE;
-    wdh->bytes_dumped += sizeof epb;
+    wdh->bytes_dumped += sizeof header;
 
     /* write pseudo header */
     if (!pcap_write_phdr(wdh, phdr->pkt_encap, pseudo_header, err)) {
@@ -3461,12 +3511,9 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh,
         return FALSE;
     wdh->bytes_dumped += phdr->caplen;
 
-    /* write padding (if any) */
-    if (pad_len != 0) {
-        if (!wtap_dump_file_write(wdh, &zero_pad, pad_len, err))
-            return FALSE;
-        wdh->bytes_dumped += pad_len;
-    }
+    /* padding (if any) */
+    memset(trailer, 0, pad_len);
+    trailer_len = pad_len;
 
     /* XXX - write (optional) block options */
     /* options defined in Section 2.5 (Options)
@@ -3492,9 +3539,11 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh,
     if (phdr->opt_comment) {
         option_hdr.type         = OPT_COMMENT;
         option_hdr.value_length = comment_len;
-        if (!wtap_dump_file_write(wdh, &option_hdr, 4, err))
+        memcpy(trailer + trailer_len, &option_hdr, 4);
+        trailer_len += 4;
+        if (!wtap_dump_file_write(wdh, trailer, trailer_len, err))
             return FALSE;
-        wdh->bytes_dumped += 4;
+        wdh->bytes_dumped += trailer_len;
 
         /* Write the comments string */
         pcapng_debug3("pcapng_write_enhanced_packet_block, comment:'%s' comment_len %u comment_pad_len %u" , phdr->opt_comment, comment_len, comment_pad_len);
@@ -3502,12 +3551,9 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh,
             return FALSE;
         wdh->bytes_dumped += comment_len;
 
-        /* write padding (if any) */
-        if (comment_pad_len != 0) {
-            if (!wtap_dump_file_write(wdh, &zero_pad, comment_pad_len, err))
-                return FALSE;
-            wdh->bytes_dumped += comment_pad_len;
-        }
+        /* padding (if any) */
+        memset(trailer, 0, comment_pad_len);
+        trailer_len = comment_pad_len;
 
         pcapng_debug2("pcapng_write_enhanced_packet_block: Wrote Options comments: comment_len %u, comment_pad_len %u",
                       comment_len,
@@ -3516,26 +3562,25 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh,
     if (phdr->presence_flags & WTAP_HAS_PACK_FLAGS) {
         option_hdr.type         = OPT_EPB_FLAGS;
         option_hdr.value_length = 4;
-        if (!wtap_dump_file_write(wdh, &option_hdr, 4, err))
-            return FALSE;
-        wdh->bytes_dumped += 4;
-        if (!wtap_dump_file_write(wdh, &phdr->pack_flags, 4, err))
-            return FALSE;
-        wdh->bytes_dumped += 4;
+        memcpy(trailer + trailer_len, &option_hdr, 4);
+        memcpy(trailer + trailer_len + 4, &phdr->pack_flags, 4);
+        trailer_len += 8;
         pcapng_debug1("pcapng_write_enhanced_packet_block: Wrote Options packet flags: %x", phdr->pack_flags);
     }
-    /* Write end of options if we have otions */
+    /* End of options if we have otions */
     if (have_options) {
-        if (!wtap_dump_file_write(wdh, &zero_pad, 4, err))
-            return FALSE;
-        wdh->bytes_dumped += 4;
+        memcpy(trailer + trailer_len, &zero_pad, 4);
+        trailer_len += 4;
     }
 
-    /* write block footer */
-    if (!wtap_dump_file_write(wdh, &bh.block_total_length,
-                              sizeof bh.block_total_length, err))
+    /* block footer */
+    memcpy(trailer + trailer_len, &bh.block_total_length,
+           sizeof bh.block_total_length);
+    trailer_len += (guint32)sizeof bh.block_total_length;
+
+    if (!wtap_dump_file_write(wdh, trailer, trailer_len, err))
         return FALSE;
-    wdh->bytes_dumped += sizeof bh.block_total_length;
+    wdh->bytes_dumped += trailer_len;
 
     return TRUE;
 }
@@ -22,6 +22,7 @@
 #include "wtap-int.h"
 #include "toshiba.h"
 #include "file_wrappers.h"
+#include "hex_dump.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -381,17 +382,21 @@ parse_toshiba_packet(FILE_T fh, struct wtap_pkthdr *phdr, Buffer *buf,
  * we are passed to validate the record. We place the bytes in the buffer
  * at the specified offset.
  *
- * In the process, we're going to write all over the string.
+ * In the process, we're going to write over the offset.
  *
  * Returns TRUE if good hex dump, FALSE if bad.
  */
 static gboolean
 parse_single_hex_dump_line(char* rec, guint8 *buf, guint byte_offset) {
 
-	int		pos, i;
+	size_t		line_len;
 	char		*s;
 	unsigned long	value;
-	guint16		word_value;
+
+	line_len = strlen(rec);
+	if (line_len <= START_POS) {
+		return FALSE;
+	}
 
 	/* Get the byte_offset directly from the record */
 	rec[4] = '\0';
@@ -402,30 +407,11 @@ parse_single_hex_dump_line(char* rec, guint8 *buf, guint byte_offset) {
 		return FALSE;
 	}
 
-	/* Go through the substring representing the values and:
-	 *      1. Replace any spaces with '0's
-	 *      2. Place \0's every 5 bytes (to terminate the string)
-	 *
-	 * Then read the eight sets of hex bytes
-	 */
-
-	for (pos = START_POS; pos < START_POS + HEX_LENGTH; pos++) {
-		if (rec[pos] == ' ') {
-			rec[pos] = '0';
-		}
-	}
-
-	pos = START_POS;
-	for (i = 0; i < 8; i++) {
-		rec[pos+4] = '\0';
-
-		word_value = (guint16) strtoul(&rec[pos], NULL, 16);
-		buf[byte_offset + i * 2 + 0] = (guint8) (word_value >> 8);
-		buf[byte_offset + i * 2 + 1] = (guint8) (word_value & 0x00ff);
-		pos += 5;
-	}
-
-	return TRUE;
+	/* Read the eight sets of hex bytes; the last line of a packet
+	 * may have fewer */
+	return wtap_hex_dump_to_bytes(&rec[START_POS],
+	    (gssize)MIN(line_len - START_POS, HEX_LENGTH), ' ',
+	    &buf[byte_offset], 16, NULL) >= 0;
 }
 
 /*
@@ -44,6 +44,10 @@ typedef gboolean (*subtype_read_func)(struct wtap*, int*, char**, gint64*);
 typedef gboolean (*subtype_seek_read_func)(struct wtap*, gint64,
                                            struct wtap_pkthdr *, Buffer *buf,
                                            int *, char **);
+typedef guint (*subtype_read_batch_func)(struct wtap*, wtap_batch_rec *,
+                                         guint, int *, char **);
+typedef gboolean (*subtype_seek_to_time_func)(struct wtap*, const nstime_t *,
+                                              int *, char **);
 /**
  * Struct holding data of the currently read file.
  */
@@ -63,8 +67,15 @@ struct wtap {
 
     subtype_read_func           subtype_read;
     subtype_seek_read_func      subtype_seek_read;
+    subtype_read_batch_func     subtype_read_batch;     /**< NULL if records are read one at a time */
+    gboolean                    batch_can_skip_data;    /**< TRUE if subtype_read_batch can skip the records' data */
+    gboolean                    batch_headers_only;     /**< TRUE if it should */
+    gboolean                    read_from_any_record;   /**< TRUE if wtap_read() can carry on from the seek offset of any record */
+    subtype_seek_to_time_func   subtype_seek_to_time;   /**< NULL if records can't be found by time without reading from the start */
     void                        (*subtype_sequential_close)(struct wtap*);
     void                        (*subtype_close)(struct wtap*);
+    gint64                      (*subtype_file_size)(struct wtap*, int*);  /**< NULL if it's the size of fh */
+    gint64                      (*subtype_read_so_far)(struct wtap*);     /**< NULL if it's how far into fh we are */
     int                         file_encap;    /* per-file, for those
                                                 * file formats that have
                                                 * per-file encapsulation
@@ -84,6 +95,7 @@ struct wtap {
     wtap_new_ipv4_callback_t    add_new_ipv4;
     wtap_new_ipv6_callback_t    add_new_ipv6;
     GPtrArray                   *fast_seek;
+    struct wtap_record_cache    *record_cache;  /**< Records read by wtap_seek_read(), or NULL if not kept */
 };
 
 struct wtap_dumper;
@@ -118,6 +130,8 @@ struct wtap_dumper {
     addrinfo_lists_t        *addrinfo_lists;        /**< Struct containing lists of resolved addresses */
     struct wtapng_section_s *shb_hdr;
     GArray                  *interface_data;        /**< An array holding the interface data from pcapng IDB:s or equivalent(?) NULL if not present.*/
+    struct wtap_frame_index *frame_index;           /**< Index of the records written, NULL if not wanted */
+    gchar                   *frame_index_for;       /**< File the frame index is to be written for */
 };
 
 WS_DLL_PUBLIC gboolean wtap_dump_file_write(wtap_dumper *wdh, const void *buf,
@@ -38,6 +38,7 @@
 #include "wtap-int.h"
 
 #include "file_wrappers.h"
+#include "frame_index.h"
 #include <wsutil/file_util.h>
 #include <wsutil/buffer.h>
 
@@ -119,6 +120,8 @@ wtap_file_size(wtap *wth, int *err)
 {
 	ws_statb64 statb;
 
+	if (wth->subtype_file_size != NULL)
+		return wth->subtype_file_size(wth, err);
 	if (file_fstat((wth->fh == NULL) ? wth->random_fh : wth->fh,
 	    &statb, err) == -1)
 		return -1;
@@ -146,6 +149,8 @@ wtap_file_type_subtype(wtap *wth)
 gboolean
 wtap_iscompressed(wtap *wth)
 {
+	if (wth->fh == NULL && wth->random_fh == NULL)
+		return FALSE;	/* e.g. a set of files */
 	return file_iscompressed((wth->fh == NULL) ? wth->random_fh : wth->fh);
 }
 
@@ -956,6 +961,15 @@ wtap_fdclose(wtap *wth)
 		file_fdclose(wth->random_fh);
 }
 
+void
+wtap_set_file_growing(wtap *wth)
+{
+	if (wth->fh != NULL)
+		file_set_no_map(wth->fh);
+	if (wth->random_fh != NULL)
+		file_set_no_map(wth->random_fh);
+}
+
 void
 wtap_close(wtap *wth)
 {
@@ -1015,13 +1029,15 @@ wtap_close(wtap *wth)
 		}
 	}
 	g_array_free(wth->interface_data, TRUE);
+	wtap_set_record_cache_size(wth, 0);
 	g_free(wth);
 }
 
 void
 wtap_cleareof(wtap *wth) {
 	/* Reset EOF */
-	file_clearerr(wth->fh);
+	if (wth->fh != NULL)
+		file_clearerr(wth->fh);
 }
 
 void wtap_set_cb_new_ipv4(wtap *wth, wtap_new_ipv4_callback_t add_new_ipv4) {
@@ -1062,7 +1078,7 @@ wtap_read(wtap *wth, int *err, gchar **err_info, gint64 *data_offset)
 		 * got enough compressed data to decompress the
 		 * last packet of the file.
 		 */
-		if (*err == 0)
+		if (*err == 0 && wth->fh != NULL)
 			*err = file_error(wth->fh, err_info);
 		return FALSE;	/* failure */
 	}
@@ -1169,6 +1185,8 @@ wtap_read_packet_bytes(FILE_T fh, Buffer *buf, guint length, int *err,
 gint64
 wtap_read_so_far(wtap *wth)
 {
+	if (wth->subtype_read_so_far != NULL)
+		return wth->subtype_read_so_far(wth);
 	return file_tell_raw(wth->fh);
 }
 
@@ -1197,10 +1215,169 @@ wtap_phdr_cleanup(struct wtap_pkthdr *phdr)
 	ws_buffer_free(&phdr->ft_specific_data);
 }
 
+/*
+ * Records read with wtap_seek_read(), kept so that reading them again -
+ * as a GUI does whenever the user goes back to a packet - is a copy
+ * rather than a seek and read.  The least recently used records are
+ * discarded once they add up to more than max_bytes.
+ */
+typedef struct record_cache_entry {
+	GList link;			/* in lru; data points to this entry */
+	gint64 seek_off;		/* hash key */
+	struct wtap_pkthdr phdr;	/* with our own comment and ft_specific_data */
+	guint8 *data;
+	gsize size;			/* bytes charged against max_bytes */
+} record_cache_entry;
+
+struct wtap_record_cache {
+	GHashTable *entries;		/* record_cache_entry, by seek_off */
+	GQueue lru;			/* most recently used first */
+	gsize bytes;
+	gsize max_bytes;
+};
+
+static void
+record_cache_entry_free(gpointer data)
+{
+	record_cache_entry *entry = (record_cache_entry *)data;
+
+	g_free(entry->phdr.opt_comment);
+	ws_buffer_free(&entry->phdr.ft_specific_data);
+	g_free(entry->data);
+	g_free(entry);
+}
+
+static void
+record_cache_trim(struct wtap_record_cache *rc)
+{
+	record_cache_entry *entry;
+
+	while (rc->bytes > rc->max_bytes && rc->lru.tail != NULL) {
+		entry = (record_cache_entry *)rc->lru.tail->data;
+		g_queue_unlink(&rc->lru, &entry->link);
+		rc->bytes -= entry->size;
+		g_hash_table_remove(rc->entries, &entry->seek_off);
+	}
+}
+
+static void
+record_cache_add(struct wtap_record_cache *rc, gint64 seek_off,
+    const struct wtap_pkthdr *phdr, Buffer *buf)
+{
+	record_cache_entry *entry;
+
+	if (g_hash_table_lookup(rc->entries, &seek_off) != NULL)
+		return;
+
+	entry = g_new(record_cache_entry, 1);
+	entry->link.data = entry;
+	entry->link.prev = entry->link.next = NULL;
+	entry->seek_off = seek_off;
+	entry->phdr = *phdr;
+	entry->phdr.opt_comment = g_strdup(phdr->opt_comment);
+	ws_buffer_init(&entry->phdr.ft_specific_data, 0);
+	ws_buffer_append_buffer(&entry->phdr.ft_specific_data,
+	    (Buffer *)&phdr->ft_specific_data);
+	entry->data = (guint8 *)g_memdup(ws_buffer_start_ptr(buf), phdr->caplen);
+	entry->size = sizeof *entry + phdr->caplen +
+	    ws_buffer_length(&entry->phdr.ft_specific_data) +
+	    (entry->phdr.opt_comment != NULL ? strlen(entry->phdr.opt_comment) : 0);
+
+	g_hash_table_insert(rc->entries, &entry->seek_off, entry);
+	g_queue_push_head_link(&rc->lru, &entry->link);
+	rc->bytes += entry->size;
+	record_cache_trim(rc);
+}
+
+/* Copy a cached record out as wtap_seek_read() would have read it */
+static void
+record_cache_copy_out(struct wtap_record_cache *rc, record_cache_entry *entry,
+    struct wtap_pkthdr *phdr, Buffer *buf)
+{
+	Buffer ft_specific_data = phdr->ft_specific_data;
+
+	g_queue_unlink(&rc->lru, &entry->link);
+	g_queue_push_head_link(&rc->lru, &entry->link);
+
+	*phdr = entry->phdr;
+	phdr->opt_comment = g_strdup(entry->phdr.opt_comment);
+	phdr->ft_specific_data = ft_specific_data;
+	ws_buffer_clean(&phdr->ft_specific_data);
+	ws_buffer_append_buffer(&phdr->ft_specific_data,
+	    &entry->phdr.ft_specific_data);
+
+	ws_buffer_assure_space(buf, entry->phdr.caplen);
+	memcpy(ws_buffer_start_ptr(buf), entry->data, entry->phdr.caplen);
+}
+
+void
+wtap_set_record_cache_size(wtap *wth, gsize max_bytes)
+{
+	struct wtap_record_cache *rc = wth->record_cache;
+
+	if (max_bytes == 0) {
+		if (rc != NULL) {
+			g_hash_table_destroy(rc->entries);
+			g_free(rc);
+			wth->record_cache = NULL;
+		}
+		return;
+	}
+
+	if (rc == NULL) {
+		rc = g_new0(struct wtap_record_cache, 1);
+		rc->entries = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+		    NULL, record_cache_entry_free);
+		g_queue_init(&rc->lru);
+		wth->record_cache = rc;
+	}
+	rc->max_bytes = max_bytes;
+	record_cache_trim(rc);
+}
+
+void
+wtap_seek_read_ahead(wtap *wth, const gint64 *seek_offs, guint count)
+{
+	struct wtap_pkthdr phdr;
+	Buffer buf;
+	int err;
+	gchar *err_info;
+	guint i;
+
+	if (wth->record_cache == NULL || count == 0)
+		return;
+
+	wtap_phdr_init(&phdr);
+	ws_buffer_init(&buf, 1500);
+	for (i = 0; i < count; i++) {
+		if (g_hash_table_lookup(wth->record_cache->entries, &seek_offs[i]) != NULL)
+			continue;
+		err_info = NULL;
+		if (!wtap_seek_read(wth, seek_offs[i], &phdr, &buf, &err, &err_info)) {
+			g_free(err_info);
+			break;
+		}
+		g_free(phdr.opt_comment);
+		phdr.opt_comment = NULL;
+	}
+	ws_buffer_free(&buf);
+	wtap_phdr_cleanup(&phdr);
+}
+
 gboolean
 wtap_seek_read(wtap *wth, gint64 seek_off,
 	struct wtap_pkthdr *phdr, Buffer *buf, int *err, gchar **err_info)
 {
+	record_cache_entry *entry;
+
+	if (wth->record_cache != NULL) {
+		entry = (record_cache_entry *)g_hash_table_lookup(wth->record_cache->entries, &seek_off);
+		if (entry != NULL) {
+			record_cache_copy_out(wth->record_cache, entry, phdr, buf);
+			return TRUE;
+		}
+	}
+
 	if (!wth->subtype_seek_read(wth, seek_off, phdr, buf, err, err_info))
 		return FALSE;
 
@@ -1219,6 +1396,160 @@ wtap_seek_read(wtap *wth, gint64 seek_off,
 	 */
 	g_assert(phdr->pkt_encap != WTAP_ENCAP_PER_PACKET);
 
+	if (wth->record_cache != NULL)
+		record_cache_add(wth->record_cache, seek_off, phdr, buf);
+
+	return TRUE;
+}
+
+/*
+ * Read the record at a given offset into the buffers used by wtap_read(),
+ * so that it can be processed exactly as if it had been read sequentially.
+ * This reads from the random-access stream, so the file must have been
+ * opened with do_random set.
+ */
+gboolean
+wtap_read_at(wtap *wth, gint64 seek_off, int *err, gchar **err_info)
+{
+	wth->phdr.pkt_encap = wth->file_encap;
+	wth->phdr.pkt_tsprec = wth->file_tsprec;
+
+	*err = 0;
+	*err_info = NULL;
+	return wtap_seek_read(wth, seek_off, &wth->phdr, wth->frame_buffer,
+	    err, err_info);
+}
+
+gboolean
+wtap_seek_to_record(wtap *wth, const wtap_frame_index *fidx, guint32 recno,
+    int *err)
+{
+	gint64 data_offset;
+
+	*err = 0;
+	if (!wth->read_from_any_record ||
+	    !wtap_frame_index_get(fidx, recno, &data_offset, NULL, NULL, NULL))
+		return FALSE;
+	return file_seek(wth->fh, data_offset, SEEK_SET, err) != -1;
+}
+
+gboolean
+wtap_seek_to_time(wtap *wth, const wtap_frame_index *fidx,
+    const nstime_t *ts, guint32 *recno, int *err, gchar **err_info)
+{
+	guint32 lo, hi, mid;
+	nstime_t rec_ts;
+
+	*err = 0;
+	*err_info = NULL;
+	*recno = 0;
+	if (fidx != NULL) {
+		if (!wth->read_from_any_record)
+			return FALSE;
+
+		/* Find the first record at or after ts */
+		lo = 1;
+		hi = wtap_frame_index_count(fidx) + 1;
+		while (lo < hi) {
+			mid = lo + (hi - lo) / 2;
+			wtap_frame_index_get(fidx, mid, NULL, &rec_ts, NULL, NULL);
+			if (nstime_cmp(&rec_ts, ts) < 0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		*recno = lo;
+		if (lo > wtap_frame_index_count(fidx)) {
+			/* They're all before ts */
+			return file_seek(wth->fh, 0, SEEK_END, err) != -1;
+		}
+		return wtap_seek_to_record(wth, fidx, lo, err);
+	}
+
+	if (wth->subtype_seek_to_time == NULL)
+		return FALSE;
+	return wth->subtype_seek_to_time(wth, ts, err, err_info);
+}
+
+gboolean
+wtap_fast_seek_save(wtap *wth, const char *filename, int *err)
+{
+	if (wth->fast_seek == NULL || wth->fh == NULL ||
+	    !file_iscompressed(wth->fh) || !file_eof(wth->fh)) {
+		/* Nothing to save, or we don't have all of it yet. */
+		return TRUE;
+	}
+	return file_fast_seek_save(wth->fast_seek, filename, err);
+}
+
+void
+wtap_batch_recs_init(wtap_batch_rec *recs, guint nrecs)
+{
+	guint i;
+
+	for (i = 0; i < nrecs; i++) {
+		memset(&recs[i].phdr, 0, sizeof recs[i].phdr);
+		ws_buffer_init(&recs[i].buf, 1500);
+		recs[i].data_offset = 0;
+	}
+}
+
+void
+wtap_batch_recs_cleanup(wtap_batch_rec *recs, guint nrecs)
+{
+	guint i;
+
+	for (i = 0; i < nrecs; i++)
+		ws_buffer_free(&recs[i].buf);
+}
+
+/*
+ * Read a batch of records.  File types that can read a batch of records
+ * themselves set subtype_read_batch; for the others, read the records
+ * one at a time and copy them into the batch.
+ */
+guint
+wtap_read_batch(wtap *wth, wtap_batch_rec *recs, guint nrecs, int *err,
+    gchar **err_info)
+{
+	guint i, n;
+
+	*err = 0;
+	*err_info = NULL;
+	if (wth->subtype_read_batch != NULL) {
+		/* See wtap_read() */
+		for (i = 0; i < nrecs; i++) {
+			recs[i].phdr.pkt_encap = wth->file_encap;
+			recs[i].phdr.pkt_tsprec = wth->file_tsprec;
+		}
+		n = wth->subtype_read_batch(wth, recs, nrecs, err, err_info);
+		if (n < nrecs && *err == 0)
+			*err = file_error(wth->fh, err_info);
+		for (i = 0; i < n; i++) {
+			if (recs[i].phdr.caplen > recs[i].phdr.len)
+				recs[i].phdr.caplen = recs[i].phdr.len;
+			g_assert(recs[i].phdr.pkt_encap != WTAP_ENCAP_PER_PACKET);
+		}
+		return n;
+	}
+
+	for (n = 0; n < nrecs; n++) {
+		if (!wtap_read(wth, err, err_info, &recs[n].data_offset))
+			break;
+		recs[n].phdr = wth->phdr;
+		ws_buffer_assure_space(&recs[n].buf, wth->phdr.caplen);
+		memcpy(ws_buffer_start_ptr(&recs[n].buf),
+		    ws_buffer_start_ptr(wth->frame_buffer), wth->phdr.caplen);
+	}
+	return n;
+}
+
+gboolean
+wtap_set_batch_headers_only(wtap *wth, gboolean headers_only)
+{
+	if (headers_only && !wth->batch_can_skip_data)
+		return FALSE;
+	wth->batch_headers_only = headers_only;
 	return TRUE;
 }
 
@@ -1428,6 +1428,27 @@ WS_DLL_PUBLIC
 struct wtap* wtap_open_offline(const char *filename, unsigned int type, int *err,
     gchar **err_info, gboolean do_random);
 
+/** Open a set of capture files, such as the files of a ring buffer, to be
+ * read as one capture, with the records of all of them in time stamp
+ * order.  The first file is opened straight away and decides the file
+ * type and the interfaces of the set; the others are only opened when
+ * the set's records get to theirs, using their frame indexes, if they
+ * have them, to find where that is.  The set is always opened for random
+ * access; no more than a few dozen of the files are kept open for that
+ * at once.  Files with no frame index are read through their first
+ * record when the set is opened.
+ *
+ * @param count the number of files, up to 65536
+ * @param filenames their names
+ * @param type as for wtap_open_offline(), for all the files
+ * @param err as for wtap_open_offline()
+ * @param err_info as for wtap_open_offline()
+ * @param err_fileno on failure, set to the index of the file it was with
+ */
+WS_DLL_PUBLIC
+struct wtap* wtap_open_offline_set(guint count, const char *const *filenames,
+    unsigned int type, int *err, gchar **err_info, guint *err_fileno);
+
 /**
  * If we were compiled with zlib and we're at EOF, unset EOF so that
  * wtap_read/gzread has a chance to succeed. This is necessary if
@@ -1459,6 +1480,90 @@ WS_DLL_PUBLIC
 gboolean wtap_seek_read (wtap *wth, gint64 seek_off,
         struct wtap_pkthdr *phdr, Buffer *buf, int *err, gchar **err_info);
 
+/** Keep up to max_bytes worth of the records most recently read with
+ * wtap_seek_read(), so that reading them again doesn't require another
+ * seek and read (and, for a compressed file, decompression).  0, the
+ * default, keeps none. */
+WS_DLL_PUBLIC
+void wtap_set_record_cache_size(wtap *wth, gsize max_bytes);
+
+/** Read the records at the count offsets in seek_offs into the record
+ * cache, if there is one, so that reading them with wtap_seek_read()
+ * later doesn't need to touch the file.  Stops at the first error; the
+ * error will be reported when that record is actually read. */
+WS_DLL_PUBLIC
+void wtap_seek_read_ahead(wtap *wth, const gint64 *seek_offs, guint count);
+
+/** Read the record at seek_off as if it were the next record returned by
+ * wtap_read(), so that it is available through wtap_phdr() and
+ * wtap_buf_ptr().  The file must have been opened with do_random TRUE.
+ * Returns TRUE if read was successful. FALSE if failure. */
+WS_DLL_PUBLIC
+gboolean wtap_read_at(wtap *wth, gint64 seek_off, int *err, gchar **err_info);
+
+struct wtap_frame_index;
+
+/** Go to record recno (1-based) of fidx, the frame index for the file, so
+ * that it is the next record wtap_read() returns.  Returns FALSE, with
+ * *err 0, if there's no such record or records in files of this type
+ * can't be read from the middle of the file; the caller should then
+ * read from where it is. */
+WS_DLL_PUBLIC
+gboolean wtap_seek_to_record(wtap *wth, const struct wtap_frame_index *fidx,
+        guint32 recno, int *err);
+
+/** Go to the first record whose time stamp is at or after ts, so that it
+ * is the next record wtap_read() returns, taking the records to be in time
+ * order.  If fidx, the frame index for the file, isn't NULL, it's
+ * looked up there; otherwise, for formats that allow it, the file is
+ * bisected.  *recno is set to the record's number, or 0 if that isn't
+ * known.  Returns FALSE, with *err 0, if this can't be done for the file;
+ * the caller should then read from where it is. */
+WS_DLL_PUBLIC
+gboolean wtap_seek_to_time(wtap *wth, const struct wtap_frame_index *fidx,
+        const nstime_t *ts, guint32 *recno, int *err, gchar **err_info);
+
+/** If the file is compressed, save the points that random access to it
+ * can start inflating from in a sidecar file (filename with ".wsgzidx"
+ * appended), so that they're available as soon as it's opened again with
+ * do_random TRUE, rather than only after it's been read sequentially.
+ * That's only done once the whole file has been read with wtap_read();
+ * otherwise, or if the file isn't compressed, nothing is saved.
+ * Returns FALSE, with *err set, if the sidecar couldn't be written. */
+WS_DLL_PUBLIC
+gboolean wtap_fast_seek_save(wtap *wth, const char *filename, int *err);
+
+/** A record read by wtap_read_batch(). */
+typedef struct wtap_batch_rec {
+    struct wtap_pkthdr phdr;        /**< the record's header */
+    Buffer             buf;         /**< the record's data */
+    gint64             data_offset; /**< as for wtap_read() */
+} wtap_batch_rec;
+
+/** Initialize, or free the data of, an array of nrecs wtap_batch_recs. */
+WS_DLL_PUBLIC
+void wtap_batch_recs_init(wtap_batch_rec *recs, guint nrecs);
+WS_DLL_PUBLIC
+void wtap_batch_recs_cleanup(wtap_batch_rec *recs, guint nrecs);
+
+/** Read up to nrecs records into recs, which must have been initialized
+ * with wtap_batch_recs_init().  Returns the number of records read; if
+ * that's less than nrecs, *err is set to 0 at the end of the file, or to
+ * the error that stopped the read otherwise.  It's equivalent to calling
+ * wtap_read() for each record, except that the records are not available
+ * through wtap_phdr() and wtap_buf_ptr(), and that it's cheaper for the
+ * file types that read batches themselves. */
+WS_DLL_PUBLIC
+guint wtap_read_batch(wtap *wth, wtap_batch_rec *recs, guint nrecs,
+    int *err, gchar **err_info);
+
+/** Have wtap_read_batch() fill in only the records' headers, skipping over
+ * their data rather than reading it, for callers that only look at the
+ * headers.  The records' buffers are then left as they were.  Returns
+ * FALSE, and changes nothing, if the file type can't do that. */
+WS_DLL_PUBLIC
+gboolean wtap_set_batch_headers_only(wtap *wth, gboolean headers_only);
+
 /*** get various information snippets about the current packet ***/
 WS_DLL_PUBLIC
 struct wtap_pkthdr *wtap_phdr(wtap *wth);
@@ -1502,10 +1607,21 @@ void wtap_write_shb_comment(wtap *wth, gchar *comment);
 WS_DLL_PUBLIC
 void wtap_fdclose(wtap *wth);
 
+/*** say that the current file is still being written, e.g. by a capture
+ *** in progress, so that it's read with read() rather than through a
+ *** memory mapping, which would crash if the file were truncated ***/
+WS_DLL_PUBLIC
+void wtap_set_file_growing(wtap *wth);
+
 /*** reopen the random file descriptor for the current file ***/
 WS_DLL_PUBLIC
 gboolean wtap_fdreopen(wtap *wth, const char *filename, int *err);
 
+/*** reopen the sequential file descriptor for the current file, after
+ *** wtap_fdclose(), so that reading carries on where it left off ***/
+WS_DLL_PUBLIC
+gboolean wtap_sequential_fdreopen(wtap *wth, const char *filename, int *err);
+
 /*** close the current file ***/
 WS_DLL_PUBLIC
 void wtap_sequential_close(wtap *wth);
@@ -1573,6 +1689,16 @@ void wtap_set_bytes_dumped(wtap_dumper *wdh, gint64 bytes_dumped);
 struct addrinfo;
 WS_DLL_PUBLIC
 gboolean wtap_dump_set_addrinfo_list(wtap_dumper *wdh, addrinfo_lists_t *addrinfo_lists);
+/**
+ * Build a frame index of the records written to a dump file, and write it
+ * to the frame index sidecar for filename when the dump file is closed,
+ * so the file can be read at random without a first pass through it.
+ * Must be called before any records are written.  Returns FALSE if the offsets of records in files of this type aren't
+ * known to the writer.  Failing to write the sidecar doesn't make
+ * wtap_dump_close() fail.
+ */
+WS_DLL_PUBLIC
+gboolean wtap_dump_set_frame_index(wtap_dumper *wdh, const char *filename);
 WS_DLL_PUBLIC
 gboolean wtap_dump_close(wtap_dumper *, int *);
 
@@ -0,0 +1,636 @@
+/* arrow_ipc.c
+ * Write Apache Arrow IPC streams
+ * Based on the Arrow columnar format and IPC specifications
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/arrow_ipc.h>
+
+/*
+ * Each message of a stream is a continuation marker, the length of the
+ * message's metadata, the metadata - a Message flatbuffer, padded to a
+ * multiple of 8 bytes - and the message body.  The body of a record
+ * batch is the buffers of its columns, each padded to a multiple of 8
+ * bytes; the metadata says where each buffer starts and how long it is.
+ *
+ * The flatbuffers are small and have a fixed shape, so rather than use
+ * the flatbuffers library we lay them out ourselves, front to back:
+ * each table is preceded by its vtable, and the tables, vectors and
+ * strings it refers to come after it, with the offsets to them filled
+ * in once they've been written.
+ */
+#define ARROW_CONTINUATION          0xFFFFFFFFU
+#define ARROW_METADATA_V5           4
+
+/* MessageHeader union */
+#define ARROW_HEADER_SCHEMA         1
+#define ARROW_HEADER_RECORD_BATCH   3
+
+/* Type union */
+#define ARROW_TYPE_ID_INT           2
+#define ARROW_TYPE_ID_FLOATING_POINT 3
+#define ARROW_TYPE_ID_UTF8          5
+#define ARROW_TYPE_ID_BOOL          6
+#define ARROW_TYPE_ID_TIMESTAMP     10
+#define ARROW_TYPE_ID_FIXED_SIZE_BINARY 15
+#define ARROW_TYPE_ID_DURATION      18
+
+#define ARROW_PRECISION_DOUBLE      2
+#define ARROW_UNIT_NANOSECOND       3
+
+#define ARROW_DEFAULT_BATCH_ROWS    65536
+
+/*
+ * Write out a batch early if a string column's data gets this big, so
+ * that its 32-bit offsets can't overflow.
+ */
+#define ARROW_MAX_STRING_BYTES      (64 * 1024 * 1024)
+
+#define ARROW_PAD8(n)               (((n) + 7) & ~(guint64)7)
+
+typedef struct {
+    gchar        *name;
+    arrow_type_e  type;
+    guint         width;        /* bytes per value; 0 for booleans and strings */
+    GByteArray   *validity;     /* bitmap of the rows that aren't null */
+    GByteArray   *offsets;      /* for strings, where each row's string starts */
+    GByteArray   *values;       /* the values, a bitmap of them or string data */
+    guint64       null_count;
+    gboolean      set;          /* set in the current row */
+} arrow_column_t;
+
+struct arrow_writer {
+    FILE         *fh;
+    guint         batch_rows;
+    GArray       *columns;      /* arrow_column_t's */
+    guint64       rows;         /* in the current batch */
+    GByteArray   *fb;           /* the flatbuffer being built */
+};
+
+static void
+put_le(guint8 *p, guint64 value, guint size)
+{
+    guint i;
+
+    for (i = 0; i < size; i++) {
+        p[i] = (guint8)value;
+        value >>= 8;
+    }
+}
+
+static guint
+fb_append(GByteArray *fb, guint64 value, guint size)
+{
+    guint8 bytes[8];
+    guint  pos = fb->len;
+
+    put_le(bytes, value, size);
+    g_byte_array_append(fb, bytes, size);
+    return pos;
+}
+
+static void
+bytes_append_zeroes(GByteArray *bytes, guint len)
+{
+    guint old_len = bytes->len;
+
+    g_byte_array_set_size(bytes, old_len + len);
+    memset(bytes->data + old_len, 0, len);
+}
+
+/* Pad so that an item "skip" bytes on is aligned */
+static void
+fb_align(GByteArray *fb, guint align, guint skip)
+{
+    static const guint8 zeroes[8] = { 0 };
+
+    g_byte_array_append(fb, zeroes, (align - (fb->len + skip) % align) % align);
+}
+
+/* Point the offset at "at" to "target", which comes after it */
+static void
+fb_patch(GByteArray *fb, guint at, guint target)
+{
+    put_le(fb->data + at, target - at, 4);
+}
+
+typedef struct {
+    guint    slot;
+    guint    size;      /* 1, 2, 4 or 8; 4 for an offset */
+    guint64  value;     /* 0 for an offset, which is patched later */
+    guint    pos;       /* set to where the field was written */
+} fb_field_t;
+
+/*
+ * Write a vtable and the table with the given fields, in that order,
+ * and return where the table is.
+ */
+static guint
+fb_table(GByteArray *fb, guint nslots, fb_field_t *fields, guint nfields)
+{
+    guint i, slot, off, rel;
+    guint align = 4;
+    guint vtable, table;
+
+    /* The table starts with the offset back to its vtable */
+    off = 4;
+    for (i = 0; i < nfields; i++) {
+        off = (off + fields[i].size - 1) & ~(fields[i].size - 1);
+        fields[i].pos = off;
+        off += fields[i].size;
+        if (fields[i].size > align)
+            align = fields[i].size;
+    }
+
+    fb_align(fb, 2, 0);
+    vtable = fb_append(fb, 4 + 2 * nslots, 2);
+    fb_append(fb, off, 2);
+    for (slot = 0; slot < nslots; slot++) {
+        rel = 0;
+        for (i = 0; i < nfields; i++) {
+            if (fields[i].slot == slot)
+                rel = fields[i].pos;
+        }
+        fb_append(fb, rel, 2);
+    }
+
+    fb_align(fb, align, 0);
+    table = fb->len;
+    fb_append(fb, table - vtable, 4);
+    for (i = 0; i < nfields; i++) {
+        fb_align(fb, fields[i].size, 0);
+        fields[i].pos = fb_append(fb, fields[i].value, fields[i].size);
+    }
+    return table;
+}
+
+static guint
+fb_string(GByteArray *fb, const char *str)
+{
+    guint len = (guint)strlen(str);
+    guint pos;
+
+    fb_align(fb, 4, 0);
+    pos = fb_append(fb, len, 4);
+    g_byte_array_append(fb, (const guint8 *)str, len + 1);
+    return pos;
+}
+
+/*
+ * Write a vector of n offsets, to be patched; the i'th is at the
+ * returned position + 4 + 4 * i.
+ */
+static guint
+fb_offset_vector(GByteArray *fb, guint n)
+{
+    guint pos, i;
+
+    fb_align(fb, 4, 0);
+    pos = fb_append(fb, n, 4);
+    for (i = 0; i < n; i++)
+        fb_append(fb, 0, 4);
+    return pos;
+}
+
+/* Write a vector of n FieldNode or Buffer structs, each a pair of longs */
+static guint
+fb_pair_vector(GByteArray *fb, const guint64 *pairs, guint n)
+{
+    guint pos, i;
+
+    fb_align(fb, 8, 4);
+    pos = fb_append(fb, n, 4);
+    for (i = 0; i < 2 * n; i++)
+        fb_append(fb, pairs[i], 8);
+    return pos;
+}
+
+/*
+ * Start a Message flatbuffer; returns where the offset to its header
+ * is to go.
+ */
+static guint
+fb_message(GByteArray *fb, guint header_type, guint64 body_length)
+{
+    fb_field_t message[] = {
+        { 3, 8, 0, 0 },                 /* bodyLength */
+        { 2, 4, 0, 0 },                 /* header */
+        { 0, 2, ARROW_METADATA_V5, 0 }, /* version */
+        { 1, 1, 0, 0 }                  /* header_type */
+    };
+
+    message[0].value = body_length;
+    message[3].value = header_type;
+    g_byte_array_set_size(fb, 0);
+    fb_append(fb, 0, 4);
+    fb_patch(fb, 0, fb_table(fb, 5, message, G_N_ELEMENTS(message)));
+    return message[1].pos;
+}
+
+static guint
+fb_schema_field(GByteArray *fb, const arrow_column_t *col)
+{
+    fb_field_t field[] = {
+        { 0, 4, 0, 0 },                 /* name */
+        { 3, 4, 0, 0 },                 /* type */
+        { 5, 4, 0, 0 },                 /* children */
+        { 1, 1, 1, 0 },                 /* nullable */
+        { 2, 1, 0, 0 }                  /* type_type */
+    };
+    fb_field_t type[2];
+    guint      ntype = 0;
+    guint      nslots = 0;
+    guint      table;
+
+    switch (col->type) {
+    case ARROW_TYPE_BOOL:
+        field[4].value = ARROW_TYPE_ID_BOOL;
+        break;
+    case ARROW_TYPE_INT8:
+    case ARROW_TYPE_INT16:
+    case ARROW_TYPE_INT32:
+    case ARROW_TYPE_INT64:
+    case ARROW_TYPE_UINT8:
+    case ARROW_TYPE_UINT16:
+    case ARROW_TYPE_UINT32:
+    case ARROW_TYPE_UINT64:
+        field[4].value = ARROW_TYPE_ID_INT;
+        type[0].slot = 0;               /* bitWidth */
+        type[0].size = 4;
+        type[0].value = col->width * 8;
+        type[1].slot = 1;               /* is_signed */
+        type[1].size = 1;
+        type[1].value = col->type <= ARROW_TYPE_INT64;
+        ntype = nslots = 2;
+        break;
+    case ARROW_TYPE_DOUBLE:
+        field[4].value = ARROW_TYPE_ID_FLOATING_POINT;
+        type[0].slot = 0;               /* precision */
+        type[0].size = 2;
+        type[0].value = ARROW_PRECISION_DOUBLE;
+        ntype = nslots = 1;
+        break;
+    case ARROW_TYPE_UTF8:
+        field[4].value = ARROW_TYPE_ID_UTF8;
+        break;
+    case ARROW_TYPE_FIXED_BINARY:
+        field[4].value = ARROW_TYPE_ID_FIXED_SIZE_BINARY;
+        type[0].slot = 0;               /* byteWidth */
+        type[0].size = 4;
+        type[0].value = col->width;
+        ntype = nslots = 1;
+        break;
+    case ARROW_TYPE_TIMESTAMP_NS:
+        field[4].value = ARROW_TYPE_ID_TIMESTAMP;
+        type[0].slot = 1;               /* timezone */
+        type[0].size = 4;
+        type[0].value = 0;
+        type[1].slot = 0;               /* unit */
+        type[1].size = 2;
+        type[1].value = ARROW_UNIT_NANOSECOND;
+        ntype = nslots = 2;
+        break;
+    case ARROW_TYPE_DURATION_NS:
+        field[4].value = ARROW_TYPE_ID_DURATION;
+        type[0].slot = 0;               /* unit */
+        type[0].size = 2;
+        type[0].value = ARROW_UNIT_NANOSECOND;
+        ntype = nslots = 1;
+        break;
+    }
+    type[0].pos = type[1].pos = 0;
+
+    table = fb_table(fb, 6, field, G_N_ELEMENTS(field));
+    fb_patch(fb, field[0].pos, fb_string(fb, col->name));
+    fb_patch(fb, field[1].pos, fb_table(fb, nslots, type, ntype));
+    if (col->type == ARROW_TYPE_TIMESTAMP_NS)
+        fb_patch(fb, type[0].pos, fb_string(fb, "UTC"));
+    fb_patch(fb, field[2].pos, fb_offset_vector(fb, 0));
+    return table;
+}
+
+/* Write the message in the flatbuffer, and its body if it has one */
+static gboolean
+arrow_write_message(arrow_writer_t *aw, guint64 body_length)
+{
+    guint8      prefix[8];
+    guint       i;
+    static const guint8 zeroes[8] = { 0 };
+    arrow_column_t *col;
+
+    fb_align(aw->fb, 8, 0);
+    put_le(prefix, ARROW_CONTINUATION, 4);
+    put_le(prefix + 4, aw->fb->len, 4);
+    fwrite(prefix, 1, sizeof prefix, aw->fh);
+    fwrite(aw->fb->data, 1, aw->fb->len, aw->fh);
+
+    if (body_length != 0) {
+        for (i = 0; i < aw->columns->len; i++) {
+            col = &g_array_index(aw->columns, arrow_column_t, i);
+            fwrite(col->validity->data, 1, col->validity->len, aw->fh);
+            fwrite(zeroes, 1, ARROW_PAD8(col->validity->len) - col->validity->len, aw->fh);
+            if (col->offsets != NULL) {
+                fwrite(col->offsets->data, 1, col->offsets->len, aw->fh);
+                fwrite(zeroes, 1, ARROW_PAD8(col->offsets->len) - col->offsets->len, aw->fh);
+            }
+            fwrite(col->values->data, 1, col->values->len, aw->fh);
+            fwrite(zeroes, 1, ARROW_PAD8(col->values->len) - col->values->len, aw->fh);
+        }
+    }
+    return !ferror(aw->fh);
+}
+
+static void
+arrow_column_reset(arrow_column_t *col)
+{
+    g_byte_array_set_size(col->validity, 0);
+    g_byte_array_set_size(col->values, 0);
+    if (col->offsets != NULL) {
+        g_byte_array_set_size(col->offsets, 0);
+        fb_append(col->offsets, 0, 4);
+    }
+    col->null_count = 0;
+    col->set = FALSE;
+}
+
+static gboolean
+arrow_write_batch(arrow_writer_t *aw)
+{
+    guint           ncols = aw->columns->len;
+    guint64        *nodes = g_new(guint64, 2 * ncols);
+    guint64        *buffers = g_new(guint64, 6 * ncols);
+    guint           nbuffers = 0;
+    guint64         body_length = 0;
+    guint           i, header;
+    arrow_column_t *col;
+    gboolean        ok;
+    fb_field_t      batch[] = {
+        { 0, 8, 0, 0 },                 /* length */
+        { 1, 4, 0, 0 },                 /* nodes */
+        { 2, 4, 0, 0 }                  /* buffers */
+    };
+
+#define ADD_BUFFER(len) \
+    buffers[2 * nbuffers] = body_length; \
+    buffers[2 * nbuffers + 1] = (len); \
+    body_length += ARROW_PAD8(len); \
+    nbuffers++
+
+    for (i = 0; i < ncols; i++) {
+        col = &g_array_index(aw->columns, arrow_column_t, i);
+        nodes[2 * i] = aw->rows;
+        nodes[2 * i + 1] = col->null_count;
+        ADD_BUFFER(col->validity->len);
+        if (col->offsets != NULL) {
+            ADD_BUFFER(col->offsets->len);
+        }
+        ADD_BUFFER(col->values->len);
+    }
+#undef ADD_BUFFER
+
+    batch[0].value = aw->rows;
+    header = fb_message(aw->fb, ARROW_HEADER_RECORD_BATCH, body_length);
+    fb_patch(aw->fb, header, fb_table(aw->fb, 3, batch, G_N_ELEMENTS(batch)));
+    fb_patch(aw->fb, batch[1].pos, fb_pair_vector(aw->fb, nodes, ncols));
+    fb_patch(aw->fb, batch[2].pos, fb_pair_vector(aw->fb, buffers, nbuffers));
+    g_free(nodes);
+    g_free(buffers);
+
+    ok = arrow_write_message(aw, body_length);
+
+    for (i = 0; i < ncols; i++)
+        arrow_column_reset(&g_array_index(aw->columns, arrow_column_t, i));
+    aw->rows = 0;
+    return ok;
+}
+
+arrow_writer_t *
+arrow_writer_new(FILE *fh, guint batch_rows)
+{
+    arrow_writer_t *aw = g_new(arrow_writer_t, 1);
+
+    aw->fh = fh;
+    aw->batch_rows = batch_rows != 0 ? batch_rows : ARROW_DEFAULT_BATCH_ROWS;
+    aw->columns = g_array_new(FALSE, FALSE, sizeof(arrow_column_t));
+    aw->rows = 0;
+    aw->fb = g_byte_array_new();
+    return aw;
+}
+
+void
+arrow_writer_add_column(arrow_writer_t *aw, const char *name,
+                        arrow_type_e type, guint width)
+{
+    arrow_column_t col;
+
+    col.name = g_strdup(name);
+    col.type = type;
+    switch (type) {
+    case ARROW_TYPE_INT8:
+    case ARROW_TYPE_UINT8:
+        col.width = 1;
+        break;
+    case ARROW_TYPE_INT16:
+    case ARROW_TYPE_UINT16:
+        col.width = 2;
+        break;
+    case ARROW_TYPE_INT32:
+    case ARROW_TYPE_UINT32:
+        col.width = 4;
+        break;
+    case ARROW_TYPE_INT64:
+    case ARROW_TYPE_UINT64:
+    case ARROW_TYPE_DOUBLE:
+    case ARROW_TYPE_TIMESTAMP_NS:
+    case ARROW_TYPE_DURATION_NS:
+        col.width = 8;
+        break;
+    case ARROW_TYPE_FIXED_BINARY:
+        col.width = width;
+        break;
+    default:
+        col.width = 0;
+        break;
+    }
+    col.validity = g_byte_array_new();
+    col.offsets = type == ARROW_TYPE_UTF8 ? g_byte_array_new() : NULL;
+    col.values = g_byte_array_new();
+    arrow_column_reset(&col);
+    g_array_append_val(aw->columns, col);
+}
+
+gboolean
+arrow_writer_start(arrow_writer_t *aw)
+{
+    fb_field_t  schema[] = {
+        { 1, 4, 0, 0 }                  /* fields */
+    };
+    guint       header, fields, i;
+
+    header = fb_message(aw->fb, ARROW_HEADER_SCHEMA, 0);
+    fb_patch(aw->fb, header, fb_table(aw->fb, 4, schema, G_N_ELEMENTS(schema)));
+    fields = fb_offset_vector(aw->fb, aw->columns->len);
+    fb_patch(aw->fb, schema[0].pos, fields);
+    for (i = 0; i < aw->columns->len; i++) {
+        fb_patch(aw->fb, fields + 4 + 4 * i,
+                 fb_schema_field(aw->fb, &g_array_index(aw->columns, arrow_column_t, i)));
+    }
+    return arrow_write_message(aw, 0);
+}
+
+/* Set or clear the bit for a row, growing the bitmap to hold it */
+static void
+bitmap_set(GByteArray *bitmap, guint64 row, gboolean bit)
+{
+    static const guint8 zero = 0;
+
+    while (bitmap->len <= row / 8)
+        g_byte_array_append(bitmap, &zero, 1);
+    if (bit)
+        bitmap->data[row / 8] |= 1 << (row % 8);
+}
+
+void
+arrow_writer_set_int(arrow_writer_t *aw, guint col_num, gint64 value)
+{
+    arrow_column_t *col = &g_array_index(aw->columns, arrow_column_t, col_num);
+
+    if (col->set)
+        return;
+    if (col->type == ARROW_TYPE_BOOL)
+        bitmap_set(col->values, aw->rows, value != 0);
+    else
+        fb_append(col->values, (guint64)value, col->width);
+    col->set = TRUE;
+}
+
+void
+arrow_writer_set_double(arrow_writer_t *aw, guint col_num, double value)
+{
+    arrow_column_t *col = &g_array_index(aw->columns, arrow_column_t, col_num);
+    guint64         bits;
+
+    if (col->set)
+        return;
+    memcpy(&bits, &value, sizeof bits);
+    fb_append(col->values, bits, 8);
+    col->set = TRUE;
+}
+
+void
+arrow_writer_set_bytes(arrow_writer_t *aw, guint col_num,
+                       const guint8 *data, gsize len)
+{
+    arrow_column_t *col = &g_array_index(aw->columns, arrow_column_t, col_num);
+
+    if (col->type == ARROW_TYPE_UTF8) {
+        g_byte_array_append(col->values, data, (guint)len);
+    } else {
+        if (col->set)
+            return;
+        /* Truncate or zero-pad it to the column's width */
+        if (len > col->width)
+            len = col->width;
+        g_byte_array_append(col->values, data, (guint)len);
+        bytes_append_zeroes(col->values, col->width - (guint)len);
+    }
+    col->set = TRUE;
+}
+
+gboolean
+arrow_writer_end_row(arrow_writer_t *aw)
+{
+    guint           i;
+    gboolean        full;
+    arrow_column_t *col;
+
+    full = aw->rows + 1 >= aw->batch_rows;
+    for (i = 0; i < aw->columns->len; i++) {
+        col = &g_array_index(aw->columns, arrow_column_t, i);
+        bitmap_set(col->validity, aw->rows, col->set);
+        if (!col->set) {
+            /* Null; it still takes up a value's space */
+            col->null_count++;
+            if (col->type == ARROW_TYPE_BOOL) {
+                bitmap_set(col->values, aw->rows, FALSE);
+            } else {
+                bytes_append_zeroes(col->values, col->width);
+            }
+        }
+        if (col->offsets != NULL) {
+            fb_append(col->offsets, col->values->len, 4);
+            if (col->values->len >= ARROW_MAX_STRING_BYTES)
+                full = TRUE;
+        }
+        col->set = FALSE;
+    }
+    aw->rows++;
+
+    if (full)
+        return arrow_write_batch(aw);
+    return TRUE;
+}
+
+gboolean
+arrow_writer_finish(arrow_writer_t *aw)
+{
+    gboolean        ok = TRUE;
+    guint8          eos[8];
+    guint           i;
+    arrow_column_t *col;
+
+    if (aw->rows != 0)
+        ok = arrow_write_batch(aw);
+    put_le(eos, ARROW_CONTINUATION, 4);
+    put_le(eos + 4, 0, 4);
+    fwrite(eos, 1, sizeof eos, aw->fh);
+    if (ferror(aw->fh))
+        ok = FALSE;
+
+    for (i = 0; i < aw->columns->len; i++) {
+        col = &g_array_index(aw->columns, arrow_column_t, i);
+        g_free(col->name);
+        g_byte_array_free(col->validity, TRUE);
+        if (col->offsets != NULL)
+            g_byte_array_free(col->offsets, TRUE);
+        g_byte_array_free(col->values, TRUE);
+    }
+    g_array_free(aw->columns, TRUE);
+    g_byte_array_free(aw->fb, TRUE);
+    g_free(aw);
+    return ok;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,123 @@
+/* arrow_ipc.h
+ * Declarations for writing Apache Arrow IPC streams
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __ARROW_IPC_H__
+#define __ARROW_IPC_H__
+
+#include <stdio.h>
+
+#include <glib.h>
+
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * A writer of the Arrow IPC streaming format: a schema, then record
+ * batches of rows held column by column, then an end-of-stream marker.
+ * pyarrow, Arrow's other libraries and the tools built on them (pandas,
+ * DuckDB, Polars, Spark) can read it, or convert it to Parquet, without
+ * parsing any text.
+ *
+ * Every column is nullable; a value that isn't set in a row is null.
+ */
+typedef enum {
+    ARROW_TYPE_BOOL,
+    ARROW_TYPE_INT8,
+    ARROW_TYPE_INT16,
+    ARROW_TYPE_INT32,
+    ARROW_TYPE_INT64,
+    ARROW_TYPE_UINT8,
+    ARROW_TYPE_UINT16,
+    ARROW_TYPE_UINT32,
+    ARROW_TYPE_UINT64,
+    ARROW_TYPE_DOUBLE,
+    ARROW_TYPE_UTF8,
+    ARROW_TYPE_FIXED_BINARY,    /* of the width given for the column */
+    ARROW_TYPE_TIMESTAMP_NS,    /* nanoseconds since the Epoch, UTC */
+    ARROW_TYPE_DURATION_NS      /* nanoseconds */
+} arrow_type_e;
+
+typedef struct arrow_writer arrow_writer_t;
+
+/*
+ * Create a writer that writes to fh, in record batches of at most
+ * batch_rows rows (0 for the default).
+ */
+WS_DLL_PUBLIC arrow_writer_t *arrow_writer_new(FILE *fh, guint batch_rows);
+
+/*
+ * Add a column; width is only used for ARROW_TYPE_FIXED_BINARY.  All
+ * the columns must be added before arrow_writer_start() is called.
+ */
+WS_DLL_PUBLIC void arrow_writer_add_column(arrow_writer_t *aw, const char *name,
+                                           arrow_type_e type, guint width);
+
+/* Write the schema; returns FALSE on a write error. */
+WS_DLL_PUBLIC gboolean arrow_writer_start(arrow_writer_t *aw);
+
+/*
+ * Set the value of a column in the current row.  arrow_writer_set_int()
+ * is for the boolean, integer, timestamp and duration columns (unsigned
+ * 64-bit values are passed cast to gint64), arrow_writer_set_double()
+ * for the floating-point ones and arrow_writer_set_bytes() for the UTF-8
+ * and fixed-size binary ones.  A fixed-width value is only set once in a
+ * row, but a string is added to by each call, so it can be built up in
+ * pieces.
+ */
+WS_DLL_PUBLIC void arrow_writer_set_int(arrow_writer_t *aw, guint col, gint64 value);
+WS_DLL_PUBLIC void arrow_writer_set_double(arrow_writer_t *aw, guint col, double value);
+WS_DLL_PUBLIC void arrow_writer_set_bytes(arrow_writer_t *aw, guint col,
+                                          const guint8 *data, gsize len);
+
+/*
+ * Finish the current row, writing out a record batch if it fills one;
+ * returns FALSE on a write error.
+ */
+WS_DLL_PUBLIC gboolean arrow_writer_end_row(arrow_writer_t *aw);
+
+/*
+ * Write any rows that are left and the end of the stream, and free the
+ * writer; returns FALSE on a write error.  The file isn't closed.
+ */
+WS_DLL_PUBLIC gboolean arrow_writer_finish(arrow_writer_t *aw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __ARROW_IPC_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -28,7 +28,20 @@
 #include "config.h"
 
 #include <glib.h>
+#include <string.h>
 #include <wsutil/crc32.h>
+#ifdef HAVE_SSE4_2
+#include "ws_cpuid.h"
+#endif
+
+/*
+ * ARMv8 has CRC32C instructions too, but they're optional in v8.0, so
+ * we only use them if the compiler has been told they're there.
+ */
+#if defined(__ARM_FEATURE_CRC32) && defined(__aarch64__)
+#define HAVE_ARM_CRC32C
+#include <arm_acle.h>
+#endif
 
 #define CRC32_ACCUMULATE(c,d,table) (c=(c>>8)^(table)[(c^(d))&0xFF])
 
@@ -308,26 +321,71 @@ crc32_ccitt_table_lookup (guchar pos)
 	return crc32_ccitt_table[pos];
 }
 
-guint32
-crc32c_calculate(const void *buf, int len, guint32 crc)
+#ifdef HAVE_ARM_CRC32C
+static guint32
+crc32c_arm(const void *buf, int len, guint32 crc)
 {
 	const guint8 *p = (const guint8 *)buf;
-	crc = CRC32C_SWAP(crc);
-	while (len-- > 0) {
-		CRC32C(crc, *p++);
+
+	while (len > 0 && ((gsize)p & 7) != 0) {
+		crc = __crc32cb(crc, *p++);
+		len--;
 	}
-	return CRC32C_SWAP(crc);
+	while (len >= 8) {
+		guint64 word;
+
+		memcpy(&word, p, sizeof word);
+		crc = __crc32cd(crc, word);
+		p += 8;
+		len -= 8;
+	}
+	while (len-- > 0)
+		crc = __crc32cb(crc, *p++);
+
+	return crc;
 }
+#endif
 
-guint32
-crc32c_calculate_no_swap(const void *buf, int len, guint32 crc)
+/*
+ * Run the CRC over the data with whatever the CPU gives us; this is
+ * what SCTP and iSCSI spend their time in when checking CRCs.
+ */
+static guint32
+crc32c_accumulate(const void *buf, int len, guint32 crc)
 {
+#ifdef HAVE_ARM_CRC32C
+	return crc32c_arm(buf, len, crc);
+#else
 	const guint8 *p = (const guint8 *)buf;
+#ifdef HAVE_SSE4_2
+	static int have_sse42 = -1;
+
+	if G_UNLIKELY(have_sse42 < 0)
+		have_sse42 = ws_cpuid_sse42();
+
+	if (have_sse42)
+		return _crc32c_sse42(buf, len, crc);
+#endif
+
 	while (len-- > 0) {
 		CRC32C(crc, *p++);
 	}
-
 	return crc;
+#endif
+}
+
+guint32
+crc32c_calculate(const void *buf, int len, guint32 crc)
+{
+	crc = CRC32C_SWAP(crc);
+	crc = crc32c_accumulate(buf, len, crc);
+	return CRC32C_SWAP(crc);
+}
+
+guint32
+crc32c_calculate_no_swap(const void *buf, int len, guint32 crc)
+{
+	return crc32c_accumulate(buf, len, crc);
 }
 
 guint32
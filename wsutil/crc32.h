@@ -65,6 +65,10 @@ WS_DLL_PUBLIC guint32 crc32c_calculate(const void *buf, int len, guint32 crc);
  @return The CRC32C checksum. */
 WS_DLL_PUBLIC guint32 crc32c_calculate_no_swap(const void *buf, int len, guint32 crc);
 
+#ifdef HAVE_SSE4_2
+guint32 _crc32c_sse42(const void *buf, int len, guint32 crc);
+#endif
+
 /** Compute CRC32 CCITT checksum of a buffer of data.
  @param buf The buffer containing the data.
  @param len The number of bytes to include in the computation.
@@ -0,0 +1,91 @@
+/* crc32c_sse42.c
+ * CRC32C using the SSE 4.2 crc32 instruction
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#ifdef HAVE_SSE4_2
+
+#include <glib.h>
+
+#include <nmmintrin.h>
+#include <string.h>
+#include "crc32.h"
+
+/*
+ * The crc32 instruction computes the same reflected CRC, with the
+ * Castagnoli polynomial, as crc32c_calculate_no_swap(): no final swap
+ * and no inversion.
+ */
+guint32
+_crc32c_sse42(const void *buf, int len, guint32 crc)
+{
+	const guint8 *p = (const guint8 *)buf;
+
+	/* Get to an 8-byte boundary a byte at a time */
+	while (len > 0 && ((gsize)p & 7) != 0) {
+		crc = _mm_crc32_u8(crc, *p++);
+		len--;
+	}
+
+#if defined(__x86_64__) || defined(_M_X64)
+	{
+		guint64 crc64 = crc;
+
+		while (len >= 8) {
+			guint64 word;
+
+			memcpy(&word, p, sizeof word);
+			crc64 = _mm_crc32_u64(crc64, word);
+			p += 8;
+			len -= 8;
+		}
+		crc = (guint32)crc64;
+	}
+#endif
+	while (len >= 4) {
+		guint32 word;
+
+		memcpy(&word, p, sizeof word);
+		crc = _mm_crc32_u32(crc, word);
+		p += 4;
+		len -= 4;
+	}
+	while (len-- > 0)
+		crc = _mm_crc32_u8(crc, *p++);
+
+	return crc;
+}
+
+#endif /* HAVE_SSE4_2 */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
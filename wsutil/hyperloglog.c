@@ -0,0 +1,164 @@
+/* hyperloglog.c
+ * Estimate the number of distinct items in a stream
+ * Based on "HyperLogLog: the analysis of a near-optimal cardinality
+ * estimation algorithm", Flajolet, Fusy, Gandouet and Meunier, 2007
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <math.h>
+
+#include <glib.h>
+
+#include <wsutil/hyperloglog.h>
+
+/*
+ * The top precision bits of an item's hash pick one of 2^precision
+ * registers, and the register keeps the largest "rank" - the position of
+ * the first 1 bit in the rest of the hash - seen for it.  A register that
+ * has seen n items has a rank of about log2(n), and the harmonic mean of
+ * the registers, suitably scaled, estimates the number of items.
+ */
+struct hyperloglog {
+    guint    precision;
+    guint    num_registers;
+    guint8  *registers;
+};
+
+hyperloglog_t *
+hyperloglog_new(guint precision)
+{
+    hyperloglog_t *hll = g_new(hyperloglog_t, 1);
+
+    if (precision < HYPERLOGLOG_MIN_PRECISION)
+        precision = HYPERLOGLOG_MIN_PRECISION;
+    else if (precision > HYPERLOGLOG_MAX_PRECISION)
+        precision = HYPERLOGLOG_MAX_PRECISION;
+    hll->precision = precision;
+    hll->num_registers = 1U << precision;
+    hll->registers = g_new0(guint8, hll->num_registers);
+    return hll;
+}
+
+void
+hyperloglog_free(hyperloglog_t *hll)
+{
+    if (!hll)
+        return;
+    g_free(hll->registers);
+    g_free(hll);
+}
+
+/*
+ * The estimate relies on every bit of the hash being equally likely to
+ * be set, which the callers' hashes (typically of addresses and ports)
+ * aren't, so mix them first (the splitmix64 finalizer).
+ */
+static inline guint64
+hyperloglog_mix(guint64 hash)
+{
+    hash ^= hash >> 30;
+    hash *= G_GUINT64_CONSTANT(0xbf58476d1ce4e5b9);
+    hash ^= hash >> 27;
+    hash *= G_GUINT64_CONSTANT(0x94d049bb133111eb);
+    hash ^= hash >> 31;
+    return hash;
+}
+
+void
+hyperloglog_add(hyperloglog_t *hll, guint64 hash)
+{
+    guint idx;
+    guint8 rank;
+    guint8 max_rank;
+
+    hash = hyperloglog_mix(hash);
+    idx = (guint)(hash >> (64 - hll->precision));
+    hash <<= hll->precision;
+
+    max_rank = (guint8)(64 - hll->precision + 1);
+    for (rank = 1; rank < max_rank && !(hash & G_GUINT64_CONSTANT(0x8000000000000000)); rank++)
+        hash <<= 1;
+
+    if (rank > hll->registers[idx])
+        hll->registers[idx] = rank;
+}
+
+guint64
+hyperloglog_estimate(const hyperloglog_t *hll)
+{
+    double m = hll->num_registers;
+    double alpha;
+    double sum = 0.0;
+    double estimate;
+    guint zeros = 0;
+    guint i;
+
+    switch (hll->num_registers) {
+    case 16:
+        alpha = 0.673;
+        break;
+    case 32:
+        alpha = 0.697;
+        break;
+    case 64:
+        alpha = 0.709;
+        break;
+    default:
+        alpha = 0.7213 / (1.0 + 1.079 / m);
+        break;
+    }
+
+    for (i = 0; i < hll->num_registers; i++) {
+        sum += ldexp(1.0, -(int)hll->registers[i]);
+        if (hll->registers[i] == 0)
+            zeros++;
+    }
+    estimate = alpha * m * m / sum;
+
+    /*
+     * With few items many registers are still empty and the raw estimate
+     * is biased upwards; counting the empty ones ("linear counting") is
+     * better there.  With 64-bit hashes there are no collisions worth
+     * correcting for at the top end.
+     */
+    if (estimate <= 2.5 * m && zeros != 0)
+        estimate = m * log(m / zeros);
+
+    return (guint64)(estimate + 0.5);
+}
+
+double
+hyperloglog_error(const hyperloglog_t *hll)
+{
+    return 1.04 / sqrt((double)hll->num_registers);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,80 @@
+/* hyperloglog.h
+ * Declarations for estimating the number of distinct items in a stream
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __HYPERLOGLOG_H__
+#define __HYPERLOGLOG_H__
+
+#include <glib.h>
+
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * A HyperLogLog sketch: an estimate of how many distinct items have been
+ * added to it, in a fixed 2^precision bytes however many there are.  The
+ * relative standard error of the estimate is about 1.04 / sqrt(2^precision),
+ * e.g. 0.8% for a precision of 14 (16 KiB).
+ *
+ * Items are added by a 64-bit hash of them; the hash needn't be well
+ * mixed, but equal items must have equal hashes.  Adding an item twice
+ * has no effect, so a caller that can tell it has seen an item before
+ * needn't add it again.
+ */
+typedef struct hyperloglog hyperloglog_t;
+
+#define HYPERLOGLOG_MIN_PRECISION   4
+#define HYPERLOGLOG_MAX_PRECISION   18
+
+/* Create an empty sketch; precision is clamped to the range above. */
+WS_DLL_PUBLIC hyperloglog_t *hyperloglog_new(guint precision);
+
+WS_DLL_PUBLIC void hyperloglog_free(hyperloglog_t *hll);
+
+WS_DLL_PUBLIC void hyperloglog_add(hyperloglog_t *hll, guint64 hash);
+
+/* The estimated number of distinct items added. */
+WS_DLL_PUBLIC guint64 hyperloglog_estimate(const hyperloglog_t *hll);
+
+/* The relative standard error of the estimate. */
+WS_DLL_PUBLIC double hyperloglog_error(const hyperloglog_t *hll);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __HYPERLOGLOG_H__ */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -22,6 +22,10 @@
 
 #include "config.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
 #include "time_util.h"
 
 /* converts a broken down date representation, relative to UTC,
@@ -62,6 +66,33 @@ mktime_utc(struct tm *tm)
 #endif /* !HAVE_TIMEGM */
 }
 
+/* The "coarse" clocks only tick every few milliseconds, which is too slow
+ * for timing dissectors or filter instructions. */
+guint64
+monotonic_time_ns(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER        count;
+
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (guint64)(count.QuadPart / freq.QuadPart) * G_GUINT64_CONSTANT(1000000000) +
+	    (guint64)(count.QuadPart % freq.QuadPart) * G_GUINT64_CONSTANT(1000000000) / freq.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + ts.tv_nsec;
+#else
+	GTimeVal tv;
+
+	g_get_current_time(&tv);
+	return (guint64)tv.tv_sec * G_GUINT64_CONSTANT(1000000000) + tv.tv_usec * 1000;
+#endif
+}
+
 /*
  * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
  *
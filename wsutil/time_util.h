@@ -26,7 +26,14 @@
 
 #include <time.h>
 
+#include <glib.h>
+
 WS_DLL_PUBLIC
 time_t mktime_utc(struct tm *tm);
 
+/* A monotonic clock in nanoseconds, cheap enough to read around short
+ * pieces of code; only differences between two readings mean anything. */
+WS_DLL_PUBLIC
+guint64 monotonic_time_ns(void);
+
 #endif /* __TIME_UTIL_H__ */
@@ -20,8 +20,24 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <string.h>
+
 #include "unicode-utils.h"
 
+/*
+ * As in ws_mempbrk.c, SSE2 and Advanced SIMD (NEON) are part of the
+ * x86-64 and AArch64 base instruction sets, so we can use them whenever
+ * the compiler is targeting one of those.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WS_ASCII_SSE2
+#include <emmintrin.h>
+#include "bits_ctz.h"
+#elif defined(__aarch64__) && defined(__GNUC__)
+#define WS_ASCII_NEON
+#include <arm_neon.h>
+#endif
+
 int
 ws_utf8_char_len(guint8 ch)
 {
@@ -34,6 +50,47 @@ ws_utf8_char_len(guint8 ch)
   else            return  1;
 }
 
+size_t
+ws_ascii_span(const guint8 *ptr, size_t len)
+{
+  const guint8 *start = ptr;
+  const guint8 *end = ptr + len;
+
+#if defined(WS_ASCII_SSE2)
+  while (end - ptr >= 16) {
+    /* movemask collects the top bit of each byte */
+    guint32 mask = (guint32)_mm_movemask_epi8(
+        _mm_loadu_si128((const __m128i *) (const void *) ptr));
+
+    if (mask)
+      return (ptr - start) + ws_ctz(mask);
+    ptr += 16;
+  }
+#elif defined(WS_ASCII_NEON)
+  while (end - ptr >= 16) {
+    uint8x16_t data = vld1q_u8(ptr);
+
+    if (vmaxvq_u8(data) >= 0x80)
+      break;
+    ptr += 16;
+  }
+#else
+  while (end - ptr >= 8) {
+    guint64 word;
+
+    memcpy(&word, ptr, sizeof word);
+    if (word & G_GUINT64_CONSTANT(0x8080808080808080))
+      break;
+    ptr += 8;
+  }
+#endif
+
+  while (ptr < end && *ptr < 0x80)
+    ptr++;
+
+  return ptr - start;
+}
+
 
 #ifdef _WIN32
 
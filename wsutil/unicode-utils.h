@@ -37,6 +37,19 @@
 WS_DLL_PUBLIC
 int ws_utf8_char_len(guint8 ch);
 
+/** Return the number of bytes at the start of a buffer that are 7-bit
+ * ASCII, that is, the offset of the first byte with the high-order bit
+ * set, or len if there's none.  It looks at 16 bytes at a time where
+ * the CPU allows, so it's a cheap way to find out that a string needs
+ * no conversion.
+ *
+ * @param ptr The bytes to look at.
+ * @param len The number of bytes.
+ * @return The length of the ASCII prefix.
+ */
+WS_DLL_PUBLIC
+size_t ws_ascii_span(const guint8 *ptr, size_t len);
+
 #ifdef _WIN32
 
 #include <windows.h>
@@ -0,0 +1,143 @@
+/* xxhash64.c
+ * Compute the 64-bit xxHash (XXH64) of a buffer
+ * Based on the description of the algorithm by Yann Collet
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <wsutil/xxhash64.h>
+
+#define PRIME64_1 G_GUINT64_CONSTANT(0x9E3779B185EBCA87)
+#define PRIME64_2 G_GUINT64_CONSTANT(0xC2B2AE3D27D4EB4F)
+#define PRIME64_3 G_GUINT64_CONSTANT(0x165667B19E3779F9)
+#define PRIME64_4 G_GUINT64_CONSTANT(0x85EBCA77C2B2AE63)
+#define PRIME64_5 G_GUINT64_CONSTANT(0x27D4EB2F165667C5)
+
+#define ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static inline guint64
+read64(const guint8 *p)
+{
+  guint64 v;
+
+  memcpy(&v, p, sizeof v);
+  return GUINT64_FROM_LE(v);
+}
+
+static inline guint32
+read32(const guint8 *p)
+{
+  guint32 v;
+
+  memcpy(&v, p, sizeof v);
+  return GUINT32_FROM_LE(v);
+}
+
+static inline guint64
+xxh64_round(guint64 acc, guint64 input)
+{
+  acc += input * PRIME64_2;
+  acc = ROTL64(acc, 31);
+  return acc * PRIME64_1;
+}
+
+static inline guint64
+xxh64_merge_round(guint64 acc, guint64 val)
+{
+  acc ^= xxh64_round(0, val);
+  return acc * PRIME64_1 + PRIME64_4;
+}
+
+guint64
+xxhash64(const guint8 *buf, size_t len, guint64 seed)
+{
+  const guint8 *p = buf;
+  const guint8 *end = buf + len;
+  guint64 h64;
+
+  if (len >= 32) {
+    /* Four lanes of 8 bytes at a time */
+    const guint8 *limit = end - 32;
+    guint64 v1 = seed + PRIME64_1 + PRIME64_2;
+    guint64 v2 = seed + PRIME64_2;
+    guint64 v3 = seed;
+    guint64 v4 = seed - PRIME64_1;
+
+    do {
+      v1 = xxh64_round(v1, read64(p));
+      v2 = xxh64_round(v2, read64(p + 8));
+      v3 = xxh64_round(v3, read64(p + 16));
+      v4 = xxh64_round(v4, read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h64 = ROTL64(v1, 1) + ROTL64(v2, 7) + ROTL64(v3, 12) + ROTL64(v4, 18);
+    h64 = xxh64_merge_round(h64, v1);
+    h64 = xxh64_merge_round(h64, v2);
+    h64 = xxh64_merge_round(h64, v3);
+    h64 = xxh64_merge_round(h64, v4);
+  } else {
+    h64 = seed + PRIME64_5;
+  }
+
+  h64 += (guint64)len;
+
+  /* What's left over */
+  while (p + 8 <= end) {
+    h64 ^= xxh64_round(0, read64(p));
+    h64 = ROTL64(h64, 27) * PRIME64_1 + PRIME64_4;
+    p += 8;
+  }
+  if (p + 4 <= end) {
+    h64 ^= (guint64)read32(p) * PRIME64_1;
+    h64 = ROTL64(h64, 23) * PRIME64_2 + PRIME64_3;
+    p += 4;
+  }
+  while (p < end) {
+    h64 ^= (*p) * PRIME64_5;
+    h64 = ROTL64(h64, 11) * PRIME64_1;
+    p++;
+  }
+
+  /* Avalanche */
+  h64 ^= h64 >> 33;
+  h64 *= PRIME64_2;
+  h64 ^= h64 >> 29;
+  h64 *= PRIME64_3;
+  h64 ^= h64 >> 32;
+
+  return h64;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 2
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=2 tabstop=8 expandtab:
+ * :indentSize=2:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,44 @@
+/* xxhash64.h
+ * Declarations for the 64-bit xxHash non-cryptographic hash
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __XXHASH64_H__
+#define __XXHASH64_H__
+
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * Compute the XXH64 hash of len bytes at buf, with the given seed.  It's
+ * fast, and good at telling different data apart, but it's no use
+ * against someone deliberately making data that collides; use it for
+ * hash tables and duplicate detection, not for anything security related.
+ */
+WS_DLL_PUBLIC guint64 xxhash64(const guint8 *buf, size_t len, guint64 seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __XXHASH64_H__ */
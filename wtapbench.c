@@ -0,0 +1,449 @@
+/* wtapbench.c
+ * Wiretap benchmark: reads capture files with wtap_read() and
+ * wtap_seek_read(), without dissecting them, and reports how fast that
+ * went, in JSON.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Usage: wtapbench [-n <runs>] [-b <batch size>] <file> ...
+ *
+ * Each file is read once per access pattern:
+ *
+ *   read          wtap_read() from start to end, as tshark and capinfos do
+ *   read-batch    wtap_read_batch() from start to end, -b records at a
+ *                 time (default 64)
+ *   seek-read     wtap_seek_read() of every record in file order, as
+ *                 Wireshark does when redissecting
+ *   seek-random   wtap_seek_read() of every record in a shuffled (but
+ *                 always the same) order, as when clicking around in
+ *                 the packet list
+ *
+ * The seek patterns first read the file sequentially, untimed, to learn
+ * where the records are (and, for compressed files, to build the fast
+ * seek points), the way Wireshark does.
+ *
+ * Each pattern is run -n times (default 3) and the fastest run is
+ * reported, with records per second and megabytes (of the file as
+ * stored, compressed or not) per second, along with the file type and
+ * whether the file is compressed.  The output is one JSON object, with
+ * the keys always in the same order, for comparing runs across commits.
+ */
+
+#include <config.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <locale.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#include <glib.h>
+
+#ifdef HAVE_PLUGINS
+#include <wsutil/plugins.h>
+#endif
+#include <wsutil/buffer.h>
+#include <wsutil/filesystem.h>
+#include <wsutil/privileges.h>
+#include <wsutil/report_err.h>
+#include <wsutil/time_util.h>
+#include <wsutil/ws_version_info.h>
+
+#include <wiretap/wtap.h>
+
+#ifndef HAVE_GETOPT_LONG
+#include "wsutil/wsgetopt.h"
+#endif
+
+typedef enum {
+	BENCH_READ,
+	BENCH_READ_BATCH,
+	BENCH_SEEK_READ,
+	BENCH_SEEK_RANDOM
+} bench_pattern_e;
+
+static const char *bench_pattern_names[] = {
+	"read",
+	"read-batch",
+	"seek-read",
+	"seek-random"
+};
+
+typedef struct {
+	guint32		records;
+	guint64		data_bytes;	/* record data, as captured */
+	gint64		file_bytes;	/* the file as stored */
+	double		seconds;
+} bench_result_t;
+
+/* So that seek-random does the same seeks every time */
+#define SHUFFLE_SEED	0x5eed
+
+#ifdef HAVE_PLUGINS
+/*
+ *  Don't report failures to load plugins because most (non-wiretap) plugins
+ *  *should* fail to load (because we're not linked against libwireshark and
+ *  dissector plugins need libwireshark).
+ */
+static void
+failure_message(const char *msg_format _U_, va_list ap _U_)
+{
+	return;
+}
+#endif
+
+static gboolean
+report_read_error(const char *fname, int err, gchar *err_info)
+{
+	fprintf(stderr, "wtapbench: error reading \"%s\": %s\n", fname,
+		wtap_strerror(err));
+	if (err_info != NULL) {
+		fprintf(stderr, "(%s)\n", err_info);
+		g_free(err_info);
+	}
+	return FALSE;
+}
+
+/* Read the whole file sequentially, noting where each record is if
+ * offsets isn't NULL */
+static gboolean
+read_all(const char *fname, wtap *wth, GArray *offsets, bench_result_t *result)
+{
+	int		err;
+	gchar		*err_info = NULL;
+	gint64		data_offset;
+
+	while (wtap_read(wth, &err, &err_info, &data_offset)) {
+		result->records++;
+		result->data_bytes += wtap_phdr(wth)->caplen;
+		if (offsets != NULL)
+			g_array_append_val(offsets, data_offset);
+	}
+	if (err != 0)
+		return report_read_error(fname, err, err_info);
+	return TRUE;
+}
+
+static gboolean
+read_all_batched(const char *fname, wtap *wth, guint batch_size,
+		 bench_result_t *result)
+{
+	wtap_batch_rec	*recs;
+	guint		nread, i;
+	int		err;
+	gchar		*err_info = NULL;
+
+	recs = g_new(wtap_batch_rec, batch_size);
+	wtap_batch_recs_init(recs, batch_size);
+	do {
+		nread = wtap_read_batch(wth, recs, batch_size, &err, &err_info);
+		for (i = 0; i < nread; i++) {
+			result->records++;
+			result->data_bytes += recs[i].phdr.caplen;
+		}
+	} while (nread == batch_size);
+	wtap_batch_recs_cleanup(recs, batch_size);
+	g_free(recs);
+
+	if (err != 0)
+		return report_read_error(fname, err, err_info);
+	return TRUE;
+}
+
+static gboolean
+seek_read_all(const char *fname, wtap *wth, GArray *offsets,
+	      bench_result_t *result)
+{
+	struct wtap_pkthdr	phdr;
+	Buffer			buf;
+	guint			i;
+	int			err = 0;
+	gchar			*err_info = NULL;
+
+	wtap_phdr_init(&phdr);
+	ws_buffer_init(&buf, 1500);
+	for (i = 0; i < offsets->len; i++) {
+		if (!wtap_seek_read(wth, g_array_index(offsets, gint64, i),
+				    &phdr, &buf, &err, &err_info))
+			break;
+		result->records++;
+		result->data_bytes += phdr.caplen;
+	}
+	ws_buffer_free(&buf);
+	wtap_phdr_cleanup(&phdr);
+
+	if (i < offsets->len)
+		return report_read_error(fname, err, err_info);
+	return TRUE;
+}
+
+/* Fisher-Yates, with a fixed seed */
+static void
+shuffle_offsets(GArray *offsets)
+{
+	GRand	*rand = g_rand_new_with_seed(SHUFFLE_SEED);
+	guint	i, j;
+	gint64	tmp;
+
+	for (i = offsets->len; i > 1; i--) {
+		j = (guint)g_rand_int_range(rand, 0, (gint32)i);
+		tmp = g_array_index(offsets, gint64, i - 1);
+		g_array_index(offsets, gint64, i - 1) = g_array_index(offsets, gint64, j);
+		g_array_index(offsets, gint64, j) = tmp;
+	}
+	g_rand_free(rand);
+}
+
+/* Read the file once with one access pattern; returns FALSE on an error */
+static gboolean
+bench_run(const char *fname, bench_pattern_e pattern, guint batch_size,
+	  bench_result_t *result, int *file_type, gboolean *compressed)
+{
+	wtap		*wth;
+	int		err;
+	gchar		*err_info = NULL;
+	GArray		*offsets = NULL;
+	bench_result_t	untimed;
+	guint64		start;
+	gboolean	ok;
+
+	memset(result, 0, sizeof(*result));
+
+	wth = wtap_open_offline(fname, WTAP_TYPE_AUTO, &err, &err_info,
+				pattern == BENCH_SEEK_READ || pattern == BENCH_SEEK_RANDOM);
+	if (wth == NULL) {
+		fprintf(stderr, "wtapbench: can't open \"%s\": %s\n", fname,
+			wtap_strerror(err));
+		g_free(err_info);
+		return FALSE;
+	}
+	*file_type = wtap_file_type_subtype(wth);
+	*compressed = wtap_iscompressed(wth);
+	result->file_bytes = wtap_file_size(wth, &err);
+
+	if (pattern == BENCH_SEEK_READ || pattern == BENCH_SEEK_RANDOM) {
+		offsets = g_array_new(FALSE, FALSE, sizeof(gint64));
+		memset(&untimed, 0, sizeof(untimed));
+		if (!read_all(fname, wth, offsets, &untimed)) {
+			g_array_free(offsets, TRUE);
+			wtap_close(wth);
+			return FALSE;
+		}
+		wtap_sequential_close(wth);
+		if (pattern == BENCH_SEEK_RANDOM)
+			shuffle_offsets(offsets);
+	}
+
+	start = monotonic_time_ns();
+	switch (pattern) {
+
+	case BENCH_READ:
+		ok = read_all(fname, wth, NULL, result);
+		break;
+
+	case BENCH_READ_BATCH:
+		ok = read_all_batched(fname, wth, batch_size, result);
+		break;
+
+	default:
+		ok = seek_read_all(fname, wth, offsets, result);
+		break;
+	}
+	result->seconds = (monotonic_time_ns() - start) / 1e9;
+
+	if (offsets != NULL)
+		g_array_free(offsets, TRUE);
+	wtap_close(wth);
+	return ok;
+}
+
+static void
+print_json_string(const char *str)
+{
+	putchar('"');
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			printf("\\%c", *str);
+		else if ((guchar)*str < 0x20)
+			printf("\\u%04x", (guchar)*str);
+		else
+			putchar(*str);
+	}
+	putchar('"');
+}
+
+static void
+print_result(const char *pattern_name, const bench_result_t *result, gboolean last)
+{
+	double seconds = result->seconds > 0.0 ? result->seconds : 0.0;
+
+	printf("        {\"pattern\": ");
+	print_json_string(pattern_name);
+	printf(", \"records\": %u, \"data_bytes\": %" G_GINT64_MODIFIER "u, \"seconds\": %.6f, ",
+	       result->records, result->data_bytes, result->seconds);
+	printf("\"records_per_second\": %.1f, \"megabytes_per_second\": %.2f}%s\n",
+	       seconds > 0.0 ? result->records / seconds : 0.0,
+	       seconds > 0.0 && result->file_bytes > 0 ? result->file_bytes / seconds / 1e6 : 0.0,
+	       last ? "" : ",");
+}
+
+static void
+print_usage(FILE *output)
+{
+	fprintf(output, "Usage: wtapbench [-n <runs>] [-b <batch size>] <file> ...\n");
+}
+
+int
+main(int argc, char **argv)
+{
+#ifdef HAVE_PLUGINS
+	char		*init_progfile_dir_error;
+#endif
+	int		runs = 3;
+	int		batch_size = 64;
+	int		opt;
+	int		i, run, pattern;
+	int		file_type = WTAP_FILE_TYPE_SUBTYPE_UNKNOWN;
+	gboolean	compressed = FALSE;
+	gint64		file_bytes = 0;
+	bench_result_t	result, best[BENCH_SEEK_RANDOM + 1];
+	gboolean	ok = TRUE, file_ok;
+
+	while ((opt = getopt(argc, argv, "b:hn:")) != -1) {
+		switch (opt) {
+		case 'b':
+			batch_size = atoi(optarg);
+			if (batch_size < 1) {
+				fprintf(stderr, "wtapbench: the batch size must be at least 1\n");
+				exit(1);
+			}
+			break;
+		case 'n':
+			runs = atoi(optarg);
+			if (runs < 1) {
+				fprintf(stderr, "wtapbench: the number of runs must be at least 1\n");
+				exit(1);
+			}
+			break;
+		case 'h':
+			print_usage(stdout);
+			exit(0);
+		default:
+			print_usage(stderr);
+			exit(1);
+		}
+	}
+	if (optind >= argc) {
+		print_usage(stderr);
+		exit(1);
+	}
+
+	/*
+	 * Get credential information for later use.
+	 */
+	init_process_policies();
+	init_open_routines();
+
+#ifdef HAVE_PLUGINS
+	if ((init_progfile_dir_error = init_progfile_dir(argv[0], main))) {
+		g_warning("wtapbench: init_progfile_dir(): %s", init_progfile_dir_error);
+		g_free(init_progfile_dir_error);
+	} else {
+		/* Register all the plugin types we have. */
+		wtap_register_plugin_types(); /* Types known to libwiretap */
+
+		init_report_err(failure_message, NULL, NULL, NULL);
+
+		/* Scan for plugins.  This does *not* call their registration routines;
+		   that's done later. */
+		scan_plugins();
+
+		/* Register all libwiretap plugin modules. */
+		register_all_wiretap_modules();
+	}
+#endif
+
+	/* set the c-language locale to the native environment. */
+	setlocale(LC_ALL, "");
+
+	printf("{\n");
+	printf("  \"version\": ");
+	print_json_string(get_ws_vcs_version_info());
+	printf(",\n  \"runs\": %d,\n", runs);
+	printf("  \"batch_size\": %d,\n", batch_size);
+	printf("  \"files\": [\n");
+
+	for (i = optind; i < argc; i++) {
+		file_ok = TRUE;
+		for (pattern = BENCH_READ; pattern <= BENCH_SEEK_RANDOM && file_ok; pattern++) {
+			memset(&best[pattern], 0, sizeof(best[pattern]));
+			for (run = 0; run < runs; run++) {
+				if (!bench_run(argv[i], (bench_pattern_e)pattern, batch_size,
+					       &result, &file_type, &compressed)) {
+					file_ok = FALSE;
+					break;
+				}
+				if (run == 0 || result.seconds < best[pattern].seconds)
+					best[pattern] = result;
+			}
+			file_bytes = best[pattern].file_bytes;
+		}
+		if (!file_ok)
+			ok = FALSE;
+
+		printf("    {\"file\": ");
+		print_json_string(argv[i]);
+		printf(", \"file_type\": ");
+		if (file_type != WTAP_FILE_TYPE_SUBTYPE_UNKNOWN)
+			print_json_string(wtap_file_type_subtype_short_string(file_type));
+		else
+			printf("null");
+		printf(", \"compressed\": %s, \"file_bytes\": %" G_GINT64_MODIFIER "d, \"results\": [\n",
+		       compressed ? "true" : "false", file_bytes);
+		if (file_ok) {
+			for (pattern = BENCH_READ; pattern <= BENCH_SEEK_RANDOM; pattern++)
+				print_result(bench_pattern_names[pattern], &best[pattern],
+					     pattern == BENCH_SEEK_RANDOM);
+		}
+		printf("    ]}%s\n", i + 1 < argc ? "," : "");
+	}
+
+	printf("  ]\n}\n");
+
+	exit(ok ? 0 : 2);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */